@@ -0,0 +1,401 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  ta_benchmark.cpp
+ *  Mar 10, 2017
+ *
+ */
+
+// Benchmark suite for tracking performance across builds and releases. It
+// covers tile kernels, the distributed evaluation engines, communication
+// patterns, and one iteration of a CCSD-like doubles residual, and writes
+// the results as JSON. Each time is the slowest time over all processes.
+//
+// usage: ta_benchmark [--output file] [--repeat n] [--scale x] [--filter group]
+//
+// --output  The JSON output file [ default = standard output ]
+// --repeat  The number of timed repetitions of each benchmark [ default = 5 ]
+// --scale   Scale the problem sizes by this factor [ default = 1.0 ]
+// --filter  Only run the benchmarks of this group: tile, dist_eval, comm, or cc
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tiledarray.h>
+
+namespace {
+
+  struct Options {
+    std::string output; ///< The output file, or empty for standard output
+    unsigned int repeat = 5u; ///< The number of timed repetitions
+    double scale = 1.0; ///< The problem size scale factor
+    std::string filter; ///< The group to run, or empty for all groups
+
+    std::size_t size(const std::size_t n) const {
+      return std::max<std::size_t>(std::size_t(double(n) * scale), 1ul);
+    }
+  }; // struct Options
+
+  struct Result {
+    std::string group; ///< The benchmark group
+    std::string name; ///< The benchmark name
+    std::map<std::string, double> params; ///< The problem parameters
+    std::vector<double> times; ///< The time of each repetition, in s
+    double flops = 0.0; ///< The floating point operations of a repetition
+    double bytes = 0.0; ///< The bytes moved by a repetition
+  }; // struct Result
+
+  /// Time a benchmark
+
+  /// \c op is called once to warm up and then \c repeat times. The time of
+  /// each repetition is the largest time over all processes.
+  template <typename Op>
+  Result run(TiledArray::World& world, const Options& options,
+      const std::string& group, const std::string& name,
+      const std::map<std::string, double>& params, const double flops,
+      const double bytes, Op&& op)
+  {
+    Result result;
+    result.group = group;
+    result.name = name;
+    result.params = params;
+    result.flops = flops;
+    result.bytes = bytes;
+
+    op();
+    world.gop.fence();
+    for(unsigned int r = 0u; r < options.repeat; ++r) {
+      const double start = madness::wall_time();
+      op();
+      world.gop.fence();
+      double time = madness::wall_time() - start;
+      world.gop.max(time);
+      result.times.push_back(time);
+    }
+
+    if(world.rank() == 0)
+      std::cerr << group << "." << name << ": "
+                << *std::min_element(result.times.begin(), result.times.end())
+                << " s\n";
+    return result;
+  }
+
+  std::string json_number(const double value) {
+    std::stringstream ss;
+    ss.precision(9);
+    ss << value;
+    return ss.str();
+  }
+
+  void write_json(std::ostream& out, TiledArray::World& world,
+      const Options& options, const std::vector<Result>& results)
+  {
+    out << "{\n  \"tiledarray\": {\"revision\": \"" << TILEDARRAY_REVISION
+        << "\", \"nproc\": " << world.size()
+        << ", \"threads\": " << madness::ThreadPool::size() + 1
+        << ", \"repeat\": " << options.repeat
+        << ", \"scale\": " << json_number(options.scale) << "},\n"
+        << "  \"benchmarks\": [";
+    for(std::size_t i = 0ul; i < results.size(); ++i) {
+      const Result& result = results[i];
+      const double min = *std::min_element(result.times.begin(), result.times.end());
+      const double max = *std::max_element(result.times.begin(), result.times.end());
+      const double mean = std::accumulate(result.times.begin(),
+          result.times.end(), 0.0) / double(result.times.size());
+
+      out << (i ? ",\n" : "\n") << "    {\"group\": \"" << result.group
+          << "\", \"name\": \"" << result.name << "\", \"params\": {";
+      bool first = true;
+      for(const auto& param : result.params) {
+        out << (first ? "" : ", ") << "\"" << param.first << "\": "
+            << json_number(param.second);
+        first = false;
+      }
+      out << "}, \"time_min\": " << json_number(min)
+          << ", \"time_mean\": " << json_number(mean)
+          << ", \"time_max\": " << json_number(max);
+      if(result.flops > 0.0)
+        out << ", \"gflops\": " << json_number(result.flops / min * 1.0e-9);
+      if(result.bytes > 0.0)
+        out << ", \"gbytes_per_s\": " << json_number(result.bytes / min * 1.0e-9);
+      out << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  TiledArray::TiledRange1 blocking(const std::size_t extent, const std::size_t block) {
+    std::vector<std::size_t> bounds;
+    for(std::size_t i = 0ul; i < extent; i += block)
+      bounds.push_back(i);
+    bounds.push_back(extent);
+    return TiledArray::TiledRange1(bounds.begin(), bounds.end());
+  }
+
+  TiledArray::Tensor<double> random_tensor(const TiledArray::Range& range) {
+    TiledArray::Tensor<double> tensor(range);
+    for(auto& value : tensor)
+      value = double(std::rand()) / RAND_MAX;
+    return tensor;
+  }
+
+  // Tile kernels --------------------------------------------------------------
+
+  void tile_benchmarks(TiledArray::World& world, const Options& options,
+      std::vector<Result>& results)
+  {
+    using TiledArray::Range;
+    using TiledArray::Tensor;
+
+    const std::size_t n = options.size(256ul);
+    const double n2 = double(n) * double(n);
+    const Tensor<double> a = random_tensor(Range(n, n));
+    const Tensor<double> b = random_tensor(Range(n, n));
+
+    results.push_back(run(world, options, "tile", "gemm", {{"n", n}},
+        2.0 * n2 * double(n), 0.0, [&] () {
+          const TiledArray::math::GemmHelper helper(madness::cblas::NoTrans,
+              madness::cblas::NoTrans, 2u, 2u, 2u);
+          Tensor<double> c = a.gemm(b, 1.0, helper);
+        }));
+
+    results.push_back(run(world, options, "tile", "add", {{"n", n}},
+        n2, 3.0 * n2 * sizeof(double), [&] () {
+          Tensor<double> c = a.add(b);
+        }));
+
+    results.push_back(run(world, options, "tile", "norm", {{"n", n}},
+        2.0 * n2, n2 * sizeof(double), [&] () {
+          volatile double norm = a.norm();
+          (void)norm;
+        }));
+
+    const std::size_t m = options.size(64ul);
+    const double m4 = double(m) * double(m) * double(m) * double(m);
+    const Tensor<double> t = random_tensor(Range(m, m, m, m));
+    const TiledArray::Permutation perm({2, 3, 0, 1});
+    results.push_back(run(world, options, "tile", "permute", {{"n", m}},
+        0.0, 2.0 * m4 * sizeof(double), [&] () {
+          Tensor<double> p = t.permute(perm);
+        }));
+  }
+
+  // Distributed evaluation engines ---------------------------------------------
+
+  void dist_eval_benchmarks(TiledArray::World& world, const Options& options,
+      std::vector<Result>& results)
+  {
+    using namespace TiledArray;
+
+    const std::size_t n = options.size(2048ul);
+    const std::size_t block = std::max<std::size_t>(options.size(128ul), 1ul);
+    const double n2 = double(n) * double(n);
+    const TiledRange1 tr1 = blocking(n, block);
+    const TiledRange trange({ tr1, tr1 });
+
+    TArrayD a(world, trange), b(world, trange), c;
+    a.fill(1.0);
+    b.fill(1.0);
+    const std::map<std::string, double> params = {{"n", n}, {"block", block}};
+
+    results.push_back(run(world, options, "dist_eval", "summa_dense", params,
+        2.0 * n2 * double(n), 0.0, [&] () { c("m,n") = a("m,k") * b("k,n"); }));
+
+    results.push_back(run(world, options, "dist_eval", "binary_add", params,
+        n2, 3.0 * n2 * sizeof(double), [&] () { c("m,n") = a("m,n") + b("m,n"); }));
+
+    results.push_back(run(world, options, "dist_eval", "unary_permute_scale",
+        params, n2, 2.0 * n2 * sizeof(double),
+        [&] () { c("m,n") = 2.0 * a("n,m"); }));
+
+    // Sparse arrays with one half of the tiles non-zero
+    Tensor<float> norms(trange.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; i < norms.size(); i += 2ul)
+      norms[i] = std::sqrt(float(block * block));
+    const SparseShape<float> shape(norms, trange);
+    TSpArrayD sa(world, trange, shape), sb(world, trange, shape), sc;
+    sa.fill(1.0);
+    sb.fill(1.0);
+    std::map<std::string, double> sparse_params = params;
+    sparse_params["sparsity"] = shape.sparsity();
+
+    results.push_back(run(world, options, "dist_eval", "summa_sparse",
+        sparse_params, 0.0, 0.0, [&] () { sc("m,n") = sa("m,k") * sb("k,n"); }));
+  }
+
+  // Communication patterns ----------------------------------------------------
+
+  void comm_benchmarks(TiledArray::World& world, const Options& options,
+      std::vector<Result>& results)
+  {
+    using namespace TiledArray;
+
+    const std::size_t bytes = options.size(1ul << 24);
+    std::vector<char> buffer(bytes, 0);
+    results.push_back(run(world, options, "comm", "broadcast",
+        {{"bytes", bytes}}, 0.0, double(bytes), [&] () {
+          world.gop.broadcast(buffer.data(), bytes, 0);
+        }));
+
+    std::vector<double> values(options.size(1ul << 20), 1.0);
+    results.push_back(run(world, options, "comm", "allreduce",
+        {{"elements", values.size()}}, 0.0, double(values.size() * sizeof(double)),
+        [&] () { world.gop.sum(values.data(), values.size()); }));
+
+    // Every process fetches all tiles of a distributed array
+    const std::size_t n = options.size(1024ul);
+    const std::size_t block = std::max<std::size_t>(options.size(128ul), 1ul);
+    const TiledRange1 tr1 = blocking(n, block);
+    TArrayD a(world, TiledRange({ tr1, tr1 }));
+    a.fill(1.0);
+    results.push_back(run(world, options, "comm", "tile_fetch",
+        {{"n", n}, {"block", block}},
+        0.0, double(world.size()) * double(n) * double(n) * sizeof(double),
+        [&] () {
+          std::vector<Future<TArrayD::value_type> > tiles;
+          for(std::size_t i = 0ul; i < a.trange().tiles_range().volume(); ++i)
+            tiles.push_back(a.find(i));
+          for(auto& tile : tiles)
+            tile.get();
+        }));
+  }
+
+  // CCSD iteration ------------------------------------------------------------
+
+  void cc_benchmarks(TiledArray::World& world, const Options& options,
+      std::vector<Result>& results)
+  {
+    using namespace TiledArray;
+
+    const std::size_t o = options.size(20ul);
+    const std::size_t v = options.size(160ul);
+    const TiledRange1 occ = blocking(o, std::max<std::size_t>(o / 2ul, 1ul));
+    const TiledRange1 vir = blocking(v, std::max<std::size_t>(options.size(40ul), 1ul));
+
+    auto make = [&] (const std::initializer_list<TiledRange1> ranges) {
+      TArrayD array(world, TiledRange(ranges));
+      for(auto it = array.begin(); it != array.end(); ++it)
+        *it = random_tensor(array.trange().make_tile_range(it.ordinal()));
+      return array;
+    };
+
+    TArrayD t1 = make({ vir, occ });
+    TArrayD t2 = make({ vir, vir, occ, occ });
+    TArrayD f_oo = make({ occ, occ });
+    TArrayD f_vv = make({ vir, vir });
+    TArrayD g_abij = make({ vir, vir, occ, occ });
+    TArrayD g_abcd = make({ vir, vir, vir, vir });
+    TArrayD g_ijkl = make({ occ, occ, occ, occ });
+    TArrayD g_iajb = make({ occ, vir, occ, vir });
+    TArrayD g_abci = make({ vir, vir, vir, occ });
+    TArrayD r2;
+
+    results.push_back(run(world, options, "cc", "ccsd_doubles_residual",
+        {{"o", o}, {"v", v}}, 0.0, 0.0, [&] () {
+          TArrayD tau;
+          tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
+          r2("a,b,i,j") = g_abij("a,b,i,j")
+              + f_vv("a,c") * t2("c,b,i,j") - f_oo("k,i") * t2("a,b,k,j")
+              + 0.5 * g_abcd("a,b,c,d") * tau("c,d,i,j")
+              + 0.5 * g_ijkl("k,l,i,j") * tau("a,b,k,l")
+              - g_iajb("k,a,j,c") * t2("c,b,i,k")
+              + g_abci("a,b,c,j") * t1("c,i");
+        }));
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int rc = 0;
+
+  try {
+    // Initialize runtime
+    TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+    // Get command line arguments
+    Options options;
+    for(int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if((i + 1) >= argc) {
+        std::cerr << "Error: missing value for " << arg << "\n";
+        return 1;
+      }
+      if(arg == "--output")
+        options.output = argv[++i];
+      else if(arg == "--repeat")
+        options.repeat = std::max(std::atoi(argv[++i]), 1);
+      else if(arg == "--scale")
+        options.scale = std::atof(argv[++i]);
+      else if(arg == "--filter")
+        options.filter = argv[++i];
+      else {
+        std::cerr << "Error: unknown argument " << arg << "\n";
+        return 1;
+      }
+    }
+    if(options.scale <= 0.0) {
+      std::cerr << "Error: scale must be greater than zero.\n";
+      return 1;
+    }
+
+    std::srand(world.rank() + 1);
+    std::vector<Result> results;
+    if(options.filter.empty() || options.filter == "tile")
+      tile_benchmarks(world, options, results);
+    if(options.filter.empty() || options.filter == "dist_eval")
+      dist_eval_benchmarks(world, options, results);
+    if(options.filter.empty() || options.filter == "comm")
+      comm_benchmarks(world, options, results);
+    if(options.filter.empty() || options.filter == "cc")
+      cc_benchmarks(world, options, results);
+
+    if(world.rank() == 0) {
+      if(options.output.empty()) {
+        write_json(std::cout, world, options, results);
+      } else {
+        std::ofstream out(options.output);
+        write_json(out, world, options, results);
+      }
+    }
+
+    world.gop.fence();
+    TiledArray::finalize();
+
+  } catch(TiledArray::Exception& e) {
+    std::cerr << "!! TiledArray exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(madness::MadnessException& e) {
+    std::cerr << "!! MADNESS exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(SafeMPI::Exception& e) {
+    std::cerr << "!! SafeMPI exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(std::exception& e) {
+    std::cerr << "!! std exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(...) {
+    std::cerr << "!! exception: unknown exception\n";
+    rc = 1;
+  }
+
+  return rc;
+}
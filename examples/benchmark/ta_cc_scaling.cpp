@@ -0,0 +1,321 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  ta_cc_scaling.cpp
+ *  May 30, 2017
+ *
+ */
+
+// Strong and weak scaling of the dominant CCSD contractions on synthetic,
+// block-sparse problems. The occupied and virtual ranges are tiled
+// uniformly, and each tile of the amplitudes and integrals is non-zero with
+// probability 1 - sparsity; the shapes are identical on all processes. The
+// contractions are evaluated on sub-worlds of 1, 2, 4, ... processes of the
+// world, and the remaining processes wait. In a strong scaling sweep every
+// sub-world solves the same problem; in a weak scaling sweep o and v grow
+// with p^(1/6), so the flops of the abcd ladder, o^2 v^4, grow with p.
+//
+// For each sub-world size and contraction, the driver prints the time, the
+// flop rate of the non-zero tile contractions, the parallel efficiency
+// relative to one process, rate(p) / (p rate(1)), and the communication
+// fraction, which is the average time per process that a SUMMA broadcast
+// was in flight, relative to the time of the contraction. Broadcasts
+// overlap each other and the tile GEMMs, so the fraction is an upper bound
+// of the time lost to communication; it approaches or exceeds one when the
+// contraction is communication bound.
+//
+// usage: ta_cc_scaling [--occ o] [--vir v] [--occ-block b] [--vir-block b]
+//                      [--sparsity s] [--weak] [--repeat n]
+//
+// --occ        The number of occupied orbitals on one process [ default = 20 ]
+// --vir        The number of virtual orbitals on one process [ default = 160 ]
+// --occ-block  The occupied tile size [ default = 10 ]
+// --vir-block  The virtual tile size [ default = 40 ]
+// --sparsity   The fraction of zero tiles [ default = 0.0 ]
+// --weak       Run a weak scaling sweep instead of a strong scaling sweep
+// --repeat     The number of timed repetitions [ default = 3 ]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tiledarray.h>
+
+namespace {
+
+  struct Options {
+    std::size_t occ = 20ul; ///< The occupied orbitals on one process
+    std::size_t vir = 160ul; ///< The virtual orbitals on one process
+    std::size_t occ_block = 10ul; ///< The occupied tile size
+    std::size_t vir_block = 40ul; ///< The virtual tile size
+    double sparsity = 0.0; ///< The fraction of zero tiles
+    bool weak = false; ///< Weak instead of strong scaling
+    unsigned int repeat = 3u; ///< The number of timed repetitions
+  }; // struct Options
+
+  /// The measurements of one contraction on one sub-world
+  struct Result {
+    double time = 0.0; ///< The smallest time of a repetition, in s
+    double flops = 0.0; ///< The flops of the non-zero tile contractions
+    double bcast_time = 0.0; ///< The summed SUMMA broadcast latency, in s
+  }; // struct Result
+
+  TiledArray::TiledRange1 blocking(const std::size_t extent, const std::size_t block) {
+    std::vector<std::size_t> bounds;
+    for(std::size_t i = 0ul; i < extent; i += block)
+      bounds.push_back(i);
+    bounds.push_back(extent);
+    return TiledArray::TiledRange1(bounds.begin(), bounds.end());
+  }
+
+  /// Make a block-sparse array
+
+  /// Tile \c i is non-zero when a hash of \c i and \c seed exceeds
+  /// \c sparsity , so the shape is the same on all processes.
+  TiledArray::TSpArrayD make_array(TiledArray::World& world,
+      const TiledArray::TiledRange& trange, const double sparsity,
+      const unsigned int seed)
+  {
+    using namespace TiledArray;
+
+    const double value = 0.1;
+    Tensor<float> norms(trange.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; i < norms.size(); ++i) {
+      const unsigned long hash = (i + 1ul) * 2654435761ul + seed * 40503ul;
+      if(double(hash % 1000003ul) / 1000003.0 >= sparsity)
+        norms[i] = value * std::sqrt(float(trange.make_tile_range(i).volume()));
+    }
+    // Keep at least one tile, so that no contraction is empty
+    if(norms[0] == 0.0f)
+      norms[0] = value * std::sqrt(float(trange.make_tile_range(0).volume()));
+
+    TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+    array.fill(value);
+    return array;
+  }
+
+  /// Time a contraction
+
+  /// \c op is called once to warm up and then \c repeat times. The flops are
+  /// taken from the expression profile and the broadcast time from the
+  /// communication counters of the last repetition.
+  template <typename Op>
+  Result run(TiledArray::World& world, const Options& options, Op&& op) {
+    using TiledArray::expressions::ExprProfiler;
+
+    op();
+    world.gop.fence();
+
+    Result result;
+    result.time = -1.0;
+    for(unsigned int r = 0u; r < options.repeat; ++r) {
+      TiledArray::reset_comm_stats();
+      const double start = madness::wall_time();
+      op();
+      world.gop.fence();
+      double time = madness::wall_time() - start;
+      world.gop.max(time);
+      if((result.time < 0.0) || (time < result.time))
+        result.time = time;
+    }
+
+    ExprProfiler::instance().last()->reduce(world);
+    result.flops = ExprProfiler::instance().last()->flops();
+    const TiledArray::CommCounters bcast =
+        TiledArray::comm_stats(world, TiledArray::CommCategory::summa_bcast);
+    result.bcast_time = bcast.latency_mean * double(bcast.latency_count);
+    return result;
+  }
+
+  /// Run the contractions on a sub-world
+
+  /// \param world The sub-world
+  /// \param options The benchmark options
+  /// \param scale The scale factor of the orbital ranges
+  /// \return The results of the contractions
+  std::vector<Result> cc_contractions(TiledArray::World& world,
+      const Options& options, const double scale)
+  {
+    using namespace TiledArray;
+
+    auto popper = push_default_world(world);
+    const std::size_t o = std::max<std::size_t>(std::size_t(double(options.occ) * scale), 1ul);
+    const std::size_t v = std::max<std::size_t>(std::size_t(double(options.vir) * scale), 1ul);
+    const TiledRange1 occ = blocking(o, options.occ_block);
+    const TiledRange1 vir = blocking(v, options.vir_block);
+
+    TSpArrayD t2 = make_array(world, TiledRange({ vir, vir, occ, occ }), options.sparsity, 1u);
+    TSpArrayD g_abcd = make_array(world, TiledRange({ vir, vir, vir, vir }), options.sparsity, 2u);
+    TSpArrayD g_ijkl = make_array(world, TiledRange({ occ, occ, occ, occ }), options.sparsity, 3u);
+    TSpArrayD g_iajb = make_array(world, TiledRange({ occ, vir, occ, vir }), options.sparsity, 4u);
+    TSpArrayD g_ijab = make_array(world, TiledRange({ occ, occ, vir, vir }), options.sparsity, 5u);
+    TSpArrayD r2, w_klij;
+
+    std::vector<Result> results;
+    // abcd ladder, o^2 v^4
+    results.push_back(run(world, options,
+        [&] () { r2("a,b,i,j") = g_abcd("a,b,c,d") * t2("c,d,i,j"); }));
+    // ring, o^3 v^3
+    results.push_back(run(world, options,
+        [&] () { r2("a,b,i,j") = g_iajb("k,a,j,c") * t2("c,b,i,k"); }));
+    // ijkl intermediate, o^4 v^2
+    results.push_back(run(world, options,
+        [&] () { w_klij("k,l,i,j") = g_ijab("k,l,c,d") * t2("c,d,i,j"); }));
+    // ijkl ladder, o^4 v^2
+    results.push_back(run(world, options,
+        [&] () { r2("a,b,i,j") = g_ijkl("k,l,i,j") * t2("a,b,k,l"); }));
+
+    if(world.rank() == 0)
+      std::cout << "p=" << world.size() << "  o=" << o << "  v=" << v << "\n";
+    return results;
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int rc = 0;
+
+  try {
+    // Initialize runtime
+    TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+    // Get command line arguments
+    Options options;
+    for(int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if(arg == "--weak") {
+        options.weak = true;
+        continue;
+      }
+      if((i + 1) >= argc) {
+        std::cerr << "Error: missing value for " << arg << "\n";
+        return 1;
+      }
+      if(arg == "--occ")
+        options.occ = std::atol(argv[++i]);
+      else if(arg == "--vir")
+        options.vir = std::atol(argv[++i]);
+      else if(arg == "--occ-block")
+        options.occ_block = std::atol(argv[++i]);
+      else if(arg == "--vir-block")
+        options.vir_block = std::atol(argv[++i]);
+      else if(arg == "--sparsity")
+        options.sparsity = std::atof(argv[++i]);
+      else if(arg == "--repeat")
+        options.repeat = std::max(std::atoi(argv[++i]), 1);
+      else {
+        std::cerr << "Error: unknown argument " << arg << "\n";
+        return 1;
+      }
+    }
+    if((options.occ == 0ul) || (options.vir == 0ul) ||
+        (options.occ_block == 0ul) || (options.vir_block == 0ul))
+    {
+      std::cerr << "Error: orbital ranges and tile sizes must be greater than zero.\n";
+      return 1;
+    }
+    if((options.sparsity < 0.0) || (options.sparsity >= 1.0)) {
+      std::cerr << "Error: sparsity must be in [0,1).\n";
+      return 1;
+    }
+
+    if(world.rank() == 0)
+      std::cout << "TiledArray: CCSD contraction scaling..."
+                << "\nGit HASH: " << TILEDARRAY_REVISION
+                << "\nNumber of nodes     = " << world.size()
+                << "\nScaling             = " << (options.weak ? "weak" : "strong")
+                << "\nocc size            = " << options.occ
+                << "\nvir size            = " << options.vir
+                << "\nocc block size      = " << options.occ_block
+                << "\nvir block size      = " << options.vir_block
+                << "\nSparsity            = " << options.sparsity
+                << "\n";
+
+    const bool profile = TiledArray::expressions::ExprProfiler::instance().enabled();
+    const bool stats = TiledArray::comm_stats_enabled();
+    TiledArray::expressions::ExprProfiler::instance().enable();
+    TiledArray::comm_stats_enable();
+
+    // Sub-world sizes 1, 2, 4, ..., and the world size
+    std::vector<int> sizes;
+    for(int p = 1; p < world.size(); p *= 2)
+      sizes.push_back(p);
+    sizes.push_back(world.size());
+
+    const char* names[] = { "abcd_ladder", "ring", "ijkl_intermediate", "ijkl_ladder" };
+    std::vector<std::vector<Result> > results;
+    for(const int p : sizes) {
+      const double scale = (options.weak ? std::pow(double(p), 1.0 / 6.0) : 1.0);
+      const bool member = world.rank() < p;
+      std::shared_ptr<TiledArray::World> sub =
+          TiledArray::split_world(world, (member ? 0 : 1));
+      if(member)
+        results.push_back(cc_contractions(*sub, options, scale));
+      sub.reset();
+      world.gop.fence();
+    }
+
+    // Print results
+    if(world.rank() == 0) {
+      std::cout << "\n" << std::left << std::setw(20) << "contraction"
+                << std::right << std::setw(6) << "p" << std::setw(12) << "time(s)"
+                << std::setw(12) << "GFLOPS" << std::setw(12) << "efficiency"
+                << std::setw(12) << "comm.frac" << "\n";
+      for(std::size_t c = 0ul; c < 4ul; ++c) {
+        const Result& base = results.front()[c];
+        const double base_rate = base.flops / base.time;
+        for(std::size_t s = 0ul; s < sizes.size(); ++s) {
+          const Result& result = results[s][c];
+          const double rate = result.flops / result.time;
+          std::cout << std::left << std::setw(20) << names[c] << std::right
+                    << std::setw(6) << sizes[s]
+                    << std::setw(12) << result.time
+                    << std::setw(12) << rate * 1.0e-9
+                    << std::setw(12) << rate / (double(sizes[s]) * base_rate)
+                    << std::setw(12) << result.bcast_time / (double(sizes[s]) * result.time)
+                    << "\n";
+        }
+      }
+    }
+
+    TiledArray::expressions::ExprProfiler::instance().enable(profile);
+    TiledArray::comm_stats_enable(stats);
+    world.gop.fence();
+    TiledArray::finalize();
+
+  } catch(TiledArray::Exception& e) {
+    std::cerr << "!! TiledArray exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(madness::MadnessException& e) {
+    std::cerr << "!! MADNESS exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(SafeMPI::Exception& e) {
+    std::cerr << "!! SafeMPI exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(std::exception& e) {
+    std::cerr << "!! std exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(...) {
+    std::cerr << "!! exception: unknown exception\n";
+    rc = 1;
+  }
+
+  return rc;
+}
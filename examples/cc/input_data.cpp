@@ -148,20 +148,8 @@ InputData::make_f(TiledArray::World& w, const Spin s, const RangeOV ov1, const R
   TiledArray::TiledRange tr = trange(s, ov1, ov2);
 //  std::cout << tr << "\n";
 
-  TiledArray::TSpArrayD f(w, tr, make_sparse_shape(tr, f_));
-
-  // Initialize tiles
-  f.fill(0.0);
-
-  // Set the tile data
-  TiledArray::TSpArrayD::range_type::index index;
-  for(array2d::const_iterator it = f_.begin(); it != f_.end(); ++it) {
-    if(f.trange().elements_range().includes(it->first)) {
-      index = f.trange().element_to_tile(it->first);
-      if(f.is_local(index))
-        f.find(index).get()[it->first] = it->second;
-    }
-  }
+  TiledArray::TSpArrayD f =
+      TiledArray::coo_to_array<TiledArray::TSpArrayD>(w, tr, local_elements(w, tr, f_));
 
   return f;
 }
@@ -171,20 +159,8 @@ InputData::make_v_ab(TiledArray::World& w, const RangeOV ov1, const RangeOV ov2,
   // Construct the array
   TiledArray::TiledRange tr = trange(alpha, beta, ov1, ov2, ov3, ov4);
 //  std::cout << tr << "\n";
-  TiledArray::TSpArrayD v_ab(w, tr,make_sparse_shape(tr, v_ab_));
-
-  // Initialize tiles
-  v_ab.fill(0.0);
-
-  // Set the tile data
-  TiledArray::TSpArrayD::range_type::index index;
-  for(array4d::const_iterator it = v_ab_.begin(); it != v_ab_.end(); ++it) {
-    if(v_ab.trange().elements_range().includes(it->first)) {
-      index = v_ab.trange().element_to_tile(it->first);
-      if(v_ab.is_local(index))
-        v_ab.find(index).get()[it->first] = it->second;
-    }
-  }
+  TiledArray::TSpArrayD v_ab =
+      TiledArray::coo_to_array<TiledArray::TSpArrayD>(w, tr, local_elements(w, tr, v_ab_));
 
   return v_ab;
 }
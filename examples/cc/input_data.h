@@ -78,21 +78,19 @@ private:
   TiledArray::TiledRange trange(const Spin s1, const Spin s2, const RangeOV ov1, const RangeOV ov2,
       const RangeOV ov3, const RangeOV ov4) const;
 
-  template <typename R, typename T>
-  TiledArray::SparseShape<float> make_sparse_shape(const R& r, const T& t) const {
-    TiledArray::Tensor<float> tile_norms(r.tiles_range(), 0.0f);
-
-    // Find and store the tile for each element in the tensor.
-    for(typename T::const_iterator it = t.begin(); it != t.end(); ++it) {
-      if (r.elements_range().includes(it->first)) {
-        tile_norms[r.element_to_tile(it->first)] += it->second * it->second;
-      }
-    }
-
-    tile_norms.inplace_unary([](float& x) { x = std::sqrt(x); });
-
-
-    return TiledArray::SparseShape<float>(tile_norms, r);
+  /// The elements of \c t in \c r that this process contributes
+
+  /// Every process holds all elements, so each one contributes an equal
+  /// share of them to \c TiledArray::coo_to_array() .
+  template <typename T>
+  static T local_elements(TiledArray::World& w, const TiledArray::TiledRange& r, const T& t) {
+    const std::size_t first = (t.size() * w.rank()) / w.size();
+    const std::size_t last = (t.size() * (w.rank() + 1)) / w.size();
+    T result;
+    for(typename T::const_iterator it = t.begin() + first; it != t.begin() + last; ++it)
+      if (r.elements_range().includes(it->first))
+        result.push_back(*it);
+    return result;
   }
 
 public:
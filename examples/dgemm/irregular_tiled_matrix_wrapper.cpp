@@ -22,7 +22,7 @@ public:
 void *tilearray_future_get_tile(void *future, void *eu, void *task)
 {
     void *res;
-    typedef TiledArray::Tensor<double, Eigen::aligned_allocator<double> > static_tile_type;
+    typedef TiledArray::TensorD static_tile_type;
     typedef madness::Future<static_tile_type> static_future_type;
     static_future_type *Future = reinterpret_cast <static_future_type*>(future);
 
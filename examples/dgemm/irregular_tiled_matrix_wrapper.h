@@ -24,7 +24,7 @@ namespace Parsec {
 
     private:
         irregular_tiled_matrix_desc_t                             _ddesc;
-        std::vector< TiledArray::Future < TiledArray::Tensor< double, Eigen::aligned_allocator<double> > > > _tiles;
+        std::vector< TiledArray::Future < TiledArray::TensorD > > _tiles;
         
     public:
         IrregularTiledMatrix(TiledArray::detail::DistEval<Tile, Policy> &de, std::size_t P) {
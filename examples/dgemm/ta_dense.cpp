@@ -85,6 +85,7 @@ int main(int argc, char** argv) {
                 << " GB\nNumber of blocks    = " << block_count
                 << "\nAverage blocks/node = " << double(block_count) / double(world.size())
                 << "\nComplex             = " << (use_complex ? "true" : "false")
+                << "\nComm. progress      = " << (TiledArray::comm_progress_running() ? "on" : "off")
                 << "\n";
 
     // Construct TiledRange
@@ -184,6 +185,10 @@ gemm_(TiledArray::World& world, const TiledArray::TiledRange& trange, long repea
                 << " sec\nAverage GFLOPS      = "
                 << total_gflop_rate / double(repeat) << "\n";
 
+    // Print the communication counters, when TA_COMM_STATS is set
+    if (TiledArray::comm_stats_enabled())
+      TiledArray::print_comm_stats(world, std::cout);
+
   }  // array lifetime scope
   memtrace("stop");
 }
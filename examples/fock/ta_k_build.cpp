@@ -274,6 +274,23 @@ int main(int argc, char** argv) {
     std::cout << "K3 GFlops = " << k3_gflops << std::endl;
   }
 
+  // build the exchange with the batched density-fitting kernel
+  {
+    world.gop.fence();
+    const double k4_time_start = madness::wall_time();
+    for(int i = 0; i < repeat; ++i) {
+      array_type B;
+      B("X,mu,nu") = M_oh_inv("X,Y") * Eri("mu,nu,Y");
+      K = TA::df_exchange(B, C);
+      world.gop.fence();
+      madness::print_meminfo(world.rank(), "made K with df_exchange");
+    }
+    const double k4_time_stop = madness::wall_time();
+    if(world.rank() == 0)
+      std::cout << "\nAverage df_exchange time = "
+                << (k4_time_stop - k4_time_start) / double(repeat) << std::endl;
+  }
+
   // build the whole exchange as in MPQC4
   {
     auto compute_G = [&]() -> array_type {
@@ -17,86 +17,284 @@
  *
  */
 
+// Evaluate process maps for the contraction c(m,n) = a(m,k) * b(k,n) on the
+// processes of the world, without evaluating the contraction. Tensors of
+// higher rank are evaluated with their outer and contracted dimensions fused
+// into matrix dimensions. The tile owners are computed with the process
+// maps themselves, and the contraction is assumed to run on the owners of
+// the result tiles, as with SUMMA. For each family of process maps, the
+// tool prints:
+//
+// flop_imb   The largest flops of a process relative to the mean
+// mem_imb    The largest bytes of non-zero tiles of a, b, and c held by a
+//            process relative to the mean
+// comm(MB)   The bytes of the argument tiles sent to the processes that use
+//            them, or the bytes of the replicas for replicated arguments
+// fanout     The mean and the largest number of processes that receive an
+//            argument tile, i.e. the size of its SUMMA broadcast group
+//
+// The maps are the blocked, cyclic (with the SUMMA process grid), hash,
+// replicated (with a blocked result), and cost balanced sparse maps. Tile
+// (i,j) of a and b is non-zero when a hash of its ordinal exceeds the
+// sparsity, so the shapes are identical on all processes.
+//
+// usage: pmap [m k n [block [sparsity [verbose]]]]
+//
+// m, k, n   The number of tiles of the m, k, and n dimensions [ default = 20 10 20 ]
+// block     The tile size of all dimensions [ default = 100 ]
+// sparsity  The fraction of zero tiles of a and b [ default = 0.0 ]
+// verbose   Print the owners of the tiles of c for each map when non-zero
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+#include <vector>
 #include "tiledarray.h"
 #include "TiledArray/pmap/cyclic_pmap.h"
 #include "TiledArray/pmap/hash_pmap.h"
 
-std::vector<ProcessID> make_map(std::size_t m, std::size_t n, std::shared_ptr<TiledArray::Pmap>& pmap) {
-  std::vector<ProcessID> map;
+namespace {
 
-  const std::size_t end = m * n;
-  map.reserve(end);
-  for(std::size_t i = 0ul; i < end; ++i)
-    map.push_back(pmap->owner(i));
+  /// The process maps of one contraction
+  struct PmapSet {
+    std::string name; ///< The name of the map family
+    std::shared_ptr<TiledArray::Pmap> a; ///< The map of the left argument
+    std::shared_ptr<TiledArray::Pmap> b; ///< The map of the right argument
+    std::shared_ptr<TiledArray::Pmap> c; ///< The map of the result
+  }; // struct PmapSet
 
-  return map;
-}
+  /// The quality metrics of a process map family
+  struct PmapQuality {
+    double flop_imbalance = 0.0; ///< max/mean flops per process
+    double memory_imbalance = 0.0; ///< max/mean bytes per process
+    double comm_bytes = 0.0; ///< Bytes of argument tiles sent
+    double mean_fanout = 0.0; ///< Mean receivers of a non-zero argument tile
+    std::size_t max_fanout = 0ul; ///< Largest receivers of an argument tile
+  }; // struct PmapQuality
 
-void print_map(std::size_t m, std::size_t n, const std::vector<ProcessID>& map) {
-  for(std::size_t i = 0ul; i < m; ++i) {
-    for(std::size_t j = 0ul; j < n; ++j)
-      std::cout << map[i * n + j] << " ";
-    std::cout << "\n";
-  }
-}
+  /// A block-sparse matrix shape
 
-void print_local(TiledArray::World& world, const std::shared_ptr<TiledArray::Pmap>& pmap) {
-  for(ProcessID r = 0; r < world.size(); ++r) {
-    world.gop.fence();
-    if(r == world.rank()) {
-      std::cout << r << ": { ";
-      for(TiledArray::Pmap::const_iterator it = pmap->begin(); it != pmap->end(); ++it)
-        std::cout << *it << " ";
-      std::cout << "}\n";
+  /// \param trange The tiled range of the matrix
+  /// \param sparsity The fraction of zero tiles
+  /// \param seed The seed of the tile hash
+  TiledArray::SparseShape<float> make_shape(const TiledArray::TiledRange& trange,
+      const double sparsity, const unsigned long seed)
+  {
+    TiledArray::Tensor<float> norms(trange.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; i < norms.size(); ++i) {
+      const unsigned long hash = (i + 1ul) * 2654435761ul + seed * 40503ul;
+      if(double(hash % 1000003ul) / 1000003.0 >= sparsity)
+        norms[i] = std::sqrt(float(trange.make_tile_range(i).volume()));
     }
+    return TiledArray::SparseShape<float>(norms, trange);
   }
-}
 
-int main(int argc, char** argv) {
-  TiledArray::World& world = TiledArray::initialize(argc,argv);
+  /// \return max/mean of \c values , or one if all values are zero
+  double imbalance(const std::vector<double>& values) {
+    const double total = std::accumulate(values.begin(), values.end(), 0.0);
+    if(total == 0.0)
+      return 1.0;
+    return *std::max_element(values.begin(), values.end()) * double(values.size()) / total;
+  }
 
-  std::size_t m = 20;
-  std::size_t n = 10;
-  std::size_t M = 200;
-  std::size_t N = 100;
+  /// Evaluate the process maps of a contraction
 
-  std::shared_ptr<TiledArray::Pmap> blocked_pmap(new TiledArray::detail::BlockedPmap(world, m * n));
-  std::vector<ProcessID> blocked_map = make_map(m, n, blocked_pmap);
+  /// \param procs The number of processes
+  /// \param m, k, n The number of tiles of each dimension
+  /// \param block The tile size
+  /// \param a_shape, b_shape The argument shapes
+  /// \param pmaps The process maps
+  /// \return The quality metrics of \c pmaps
+  PmapQuality evaluate(const std::size_t procs, const std::size_t m,
+      const std::size_t k, const std::size_t n, const std::size_t block,
+      const TiledArray::SparseShape<float>& a_shape,
+      const TiledArray::SparseShape<float>& b_shape, const PmapSet& pmaps)
+  {
+    const double tile_bytes = double(block * block * sizeof(double));
+    const double tile_flops = 2.0 * double(block) * double(block) * double(block);
 
-  std::shared_ptr<TiledArray::Pmap> cyclic_pmap(new TiledArray::detail::CyclicPmap(world, m, n, M, N));
-  std::vector<ProcessID> cyclic_map = make_map(m, n, cyclic_pmap);
+    // Flops and memory of each process, with the result on its owner
+    std::vector<double> flops(procs, 0.0), memory(procs, 0.0);
+    std::vector<bool> c_nonzero(m * n, false);
+    for(std::size_t i = 0ul; i < m; ++i)
+      for(std::size_t j = 0ul; j < n; ++j) {
+        std::size_t terms = 0ul;
+        for(std::size_t l = 0ul; l < k; ++l)
+          if(! a_shape.is_zero(i * k + l) && ! b_shape.is_zero(l * n + j))
+            ++terms;
+        if(terms) {
+          c_nonzero[i * n + j] = true;
+          flops[pmaps.c->owner(i * n + j)] += double(terms) * tile_flops;
+          memory[pmaps.c->owner(i * n + j)] += tile_bytes;
+        }
+      }
 
-  std::shared_ptr<TiledArray::Pmap> hash_pmap(new TiledArray::detail::HashPmap(world, m * n));
-  std::vector<ProcessID> hash_map = make_map(m, n, hash_pmap);
+    PmapQuality quality;
+    const bool replicated = pmaps.a->is_replicated();
+    std::size_t tiles = 0ul;
+    std::size_t receivers = 0ul;
 
-  if(world.rank() == 0) {
-    std::cout << "Block\n";
-    print_map(m, n, blocked_map);
-    std::cout << "\n";
+    // Receivers of the argument tiles
+    for(std::size_t i = 0ul; i < m; ++i)
+      for(std::size_t l = 0ul; l < k; ++l) {
+        if(a_shape.is_zero(i * k + l))
+          continue;
+        ++tiles;
+        if(replicated) {
+          for(std::size_t p = 0ul; p < procs; ++p)
+            memory[p] += tile_bytes;
+          continue;
+        }
+        const std::size_t owner = pmaps.a->owner(i * k + l);
+        memory[owner] += tile_bytes;
+        std::set<std::size_t> dest;
+        for(std::size_t j = 0ul; j < n; ++j)
+          if(c_nonzero[i * n + j] && ! b_shape.is_zero(l * n + j))
+            dest.insert(pmaps.c->owner(i * n + j));
+        dest.erase(owner);
+        receivers += dest.size();
+        quality.max_fanout = std::max(quality.max_fanout, dest.size());
+      }
+    for(std::size_t l = 0ul; l < k; ++l)
+      for(std::size_t j = 0ul; j < n; ++j) {
+        if(b_shape.is_zero(l * n + j))
+          continue;
+        ++tiles;
+        if(replicated) {
+          for(std::size_t p = 0ul; p < procs; ++p)
+            memory[p] += tile_bytes;
+          continue;
+        }
+        const std::size_t owner = pmaps.b->owner(l * n + j);
+        memory[owner] += tile_bytes;
+        std::set<std::size_t> dest;
+        for(std::size_t i = 0ul; i < m; ++i)
+          if(c_nonzero[i * n + j] && ! a_shape.is_zero(i * k + l))
+            dest.insert(pmaps.c->owner(i * n + j));
+        dest.erase(owner);
+        receivers += dest.size();
+        quality.max_fanout = std::max(quality.max_fanout, dest.size());
+      }
+
+    // Replicated arguments are sent to every other process once
+    if(replicated)
+      receivers = tiles * (procs - 1ul);
+
+    quality.flop_imbalance = imbalance(flops);
+    quality.memory_imbalance = imbalance(memory);
+    quality.comm_bytes = double(receivers) * tile_bytes;
+    quality.mean_fanout = (tiles && ! replicated ? double(receivers) / double(tiles) : 0.0);
+    return quality;
+  }
+
+  void print_map(std::size_t m, std::size_t n, const TiledArray::Pmap& pmap) {
+    for(std::size_t i = 0ul; i < m; ++i) {
+      for(std::size_t j = 0ul; j < n; ++j)
+        std::cout << pmap.owner(i * n + j) << " ";
+      std::cout << "\n";
+    }
   }
 
-  print_local(world, blocked_pmap);
+} // namespace
 
-  world.gop.fence();
+int main(int argc, char** argv) {
+  TiledArray::World& world = TiledArray::initialize(argc,argv);
 
-  if(world.rank() == 0) {
+  using namespace TiledArray;
 
-    std::cout << "\n\nCyclic\n";
-    print_map(m, n, cyclic_map);
-    std::cout << "\n";
+  const std::size_t m = (argc > 3 ? std::atol(argv[1]) : 20l);
+  const std::size_t k = (argc > 3 ? std::atol(argv[2]) : 10l);
+  const std::size_t n = (argc > 3 ? std::atol(argv[3]) : 20l);
+  const std::size_t block = (argc > 4 ? std::atol(argv[4]) : 100l);
+  const double sparsity = (argc > 5 ? std::atof(argv[5]) : 0.0);
+  const bool verbose = (argc > 6 ? std::atoi(argv[6]) != 0 : false);
+  if((m == 0ul) || (k == 0ul) || (n == 0ul) || (block == 0ul)) {
+    std::cerr << "Error: the tile counts and the block size must be greater than zero.\n";
+    return 1;
   }
 
-  print_local(world, cyclic_pmap);
+  auto blocking = [block] (const std::size_t tiles) {
+    std::vector<std::size_t> bounds;
+    for(std::size_t t = 0ul; t <= tiles; ++t)
+      bounds.push_back(t * block);
+    return TiledRange1(bounds.begin(), bounds.end());
+  };
+  const TiledRange1 tr_m = blocking(m), tr_k = blocking(k), tr_n = blocking(n);
+  const SparseShape<float> a_shape = make_shape(TiledRange({ tr_m, tr_k }), sparsity, 1ul);
+  const SparseShape<float> b_shape = make_shape(TiledRange({ tr_k, tr_n }), sparsity, 2ul);
 
-  world.gop.fence();
+  // The flops of each result tile, for the cost balanced map
+  std::vector<double> c_costs(m * n, 0.0);
+  for(std::size_t i = 0ul; i < m; ++i)
+    for(std::size_t l = 0ul; l < k; ++l)
+      if(! a_shape.is_zero(i * k + l))
+        for(std::size_t j = 0ul; j < n; ++j)
+          if(! b_shape.is_zero(l * n + j))
+            c_costs[i * n + j] += 1.0;
+
+  const detail::ProcGrid proc_grid(world, m, n, m * block, n * block);
+  const std::vector<PmapSet> pmaps = {
+    { "blocked",
+      std::make_shared<detail::BlockedPmap>(world, m * k),
+      std::make_shared<detail::BlockedPmap>(world, k * n),
+      std::make_shared<detail::BlockedPmap>(world, m * n) },
+    { "cyclic",
+      proc_grid.make_row_phase_pmap(k),
+      proc_grid.make_col_phase_pmap(k),
+      proc_grid.make_pmap() },
+    { "hash",
+      std::make_shared<detail::HashPmap>(world, m * k),
+      std::make_shared<detail::HashPmap>(world, k * n),
+      std::make_shared<detail::HashPmap>(world, m * n) },
+    { "replicated",
+      std::make_shared<detail::ReplicatedPmap>(world, m * k),
+      std::make_shared<detail::ReplicatedPmap>(world, k * n),
+      std::make_shared<detail::BlockedPmap>(world, m * n) },
+    { "sparse",
+      std::make_shared<detail::SparsePmap>(world, a_shape),
+      std::make_shared<detail::SparsePmap>(world, b_shape),
+      std::make_shared<detail::SparsePmap>(world, c_costs) }
+  };
 
+  // The owners are the same on all processes, so process 0 evaluates all maps
   if(world.rank() == 0) {
-    std::cout << "\n\nHash\n";
-    print_map(m, n, hash_map);
-    std::cout << "\n";
+    std::cout << "c(m,n) = a(m,k) * b(k,n) with " << m << "x" << k << "x" << n
+              << " tiles of size " << block << " on " << world.size()
+              << " processes\nsparsity(a) = " << a_shape.sparsity()
+              << " sparsity(b) = " << b_shape.sparsity()
+              << " process grid = " << proc_grid.proc_rows() << "x"
+              << proc_grid.proc_cols() << "\n\n";
+    std::cout << std::left << std::setw(12) << "pmap" << std::right
+              << std::setw(10) << "flop_imb" << std::setw(10) << "mem_imb"
+              << std::setw(12) << "comm(MB)" << std::setw(10) << "fanout"
+              << std::setw(8) << "max" << "\n";
+    for(const PmapSet& set : pmaps) {
+      const PmapQuality quality =
+          evaluate(world.size(), m, k, n, block, a_shape, b_shape, set);
+      std::cout << std::left << std::setw(12) << set.name << std::right
+                << std::fixed << std::setprecision(2)
+                << std::setw(10) << quality.flop_imbalance
+                << std::setw(10) << quality.memory_imbalance
+                << std::setw(12) << quality.comm_bytes * 1.0e-6
+                << std::setw(10) << quality.mean_fanout
+                << std::setw(8) << quality.max_fanout << "\n";
+    }
+
+    if(verbose) {
+      for(const PmapSet& set : pmaps) {
+        std::cout << "\n" << set.name << " c\n";
+        print_map(m, n, *set.c);
+      }
+    }
   }
 
-  print_local(world, hash_pmap);
+  world.gop.fence();
   TiledArray::finalize();
 
   return 0;
@@ -0,0 +1,97 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  permute.cpp
+ *  Feb 6, 2017
+ *
+ */
+
+// Measure the throughput of tensor permutations that are typical of coupled-
+// cluster methods, compared with an element-wise permutation of the ordinal
+// indices. All permutations are run on a single thread.
+//
+// usage: tensor_permute [extent [repeat]]
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <madness/world/timers.h>
+#include <tiledarray.h>
+
+int main(int argc, char** argv) {
+  madness::World& world = madness::initialize(argc,argv);
+
+  // The default size is that of a 32^4 element tile
+  const std::size_t extent = (argc > 1 ? std::atol(argv[1]) : 32l);
+  const std::size_t repeat = (argc > 2 ? std::atol(argv[2]) : 100l);
+
+  if(world.rank() == 0) {
+    const TiledArray::Range range(std::vector<std::size_t>(4, extent));
+    TiledArray::TensorD a(range);
+    for(std::size_t i = 0ul; i < a.size(); ++i)
+      a[i] = double(i);
+
+    std::cout << "extent = " << extent << " repeat = " << repeat << "\n";
+
+    // Report the throughput in GB/s, where each permutation reads and writes
+    // one tensor.
+    auto report = [=] (const char* name, const double time) {
+      std::cout << "  " << std::left << std::setw(10) << name << std::right
+          << std::fixed << std::setprecision(3) << std::setw(10) << time << " s "
+          << std::setw(10) << (double(2ul * a.size() * sizeof(double) * repeat) / time * 1.0e-9)
+          << " GB/s\n";
+    };
+
+    const std::vector<std::vector<unsigned int> > perms = {
+        {0,2,1,3}, {3,2,1,0}, {1,0,3,2}, {2,3,0,1}, {0,1,3,2}, {2,0,3,1} };
+
+    for(const auto& p : perms) {
+      const TiledArray::Permutation perm(p);
+      std::cout << perm << ":\n";
+
+      // Element-wise permutation of ordinal indices
+      const TiledArray::Range perm_range = perm * range;
+      TiledArray::TensorD b(perm_range);
+      TiledArray::detail::PermIndex perm_index(range, perm);
+      double start = madness::wall_time();
+      for(std::size_t r = 0ul; r < repeat; ++r)
+        for(std::size_t i = 0ul; i < a.size(); ++i)
+          b[perm_index(i)] = a[i];
+      double stop = madness::wall_time();
+      report("ordinal", stop - start);
+
+      // Tensor permutation
+      TiledArray::TensorD c;
+      start = madness::wall_time();
+      for(std::size_t r = 0ul; r < repeat; ++r)
+        c = a.permute(perm);
+      stop = madness::wall_time();
+      report("tensor", stop - start);
+
+      for(std::size_t i = 0ul; i < c.size(); ++i) {
+        if(c[i] != b[i]) {
+          std::cout << "  error: result mismatch at " << i << "\n";
+          break;
+        }
+      }
+    }
+  }
+
+  madness::finalize();
+
+  return 0;
+}
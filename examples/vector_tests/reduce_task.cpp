@@ -0,0 +1,140 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  reduce_task.cpp
+ *  Feb 6, 2017
+ *
+ */
+
+// Compare the throughput of a reduce task with a single shared result and
+// with several partial results. The arguments are produced by tasks, so many
+// of them become ready at the same time on different threads, as the tile
+// contractions of a hot result tile do in SUMMA.
+//
+// usage: reduce_task [size [arguments [partials [repeat]]]]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <tiledarray.h>
+#include <TiledArray/reduce_task.h>
+
+struct VectorSum {
+  typedef std::vector<double> result_type;
+  typedef std::vector<double> argument_type;
+
+  VectorSum() : size_(0ul) { }
+  explicit VectorSum(const std::size_t size) : size_(size) { }
+
+  result_type operator()() const { return result_type(size_, 0.0); }
+
+  const result_type& operator()(const result_type& result) const {
+    return result;
+  }
+
+  void operator()(result_type& result, const argument_type& arg) const {
+    for(std::size_t i = 0ul; i < size_; ++i)
+      result[i] += arg[i];
+  }
+
+private:
+  std::size_t size_;
+}; // struct VectorSum
+
+std::vector<double> make_argument(const std::size_t size, const double value) {
+  return std::vector<double>(size, value);
+}
+
+double benchmark(TiledArray::World& world, const std::size_t size,
+    const std::size_t arguments, const unsigned int partials,
+    const std::size_t repeat)
+{
+  double total = 0.0;
+  for(std::size_t r = 0ul; r < repeat; ++r) {
+    const double start = madness::wall_time();
+
+    TiledArray::detail::ReduceTask<VectorSum> reduce_task(world,
+        VectorSum(size), nullptr, madness::TaskAttributes::hipri(), partials);
+    for(std::size_t i = 0ul; i < arguments; ++i)
+      reduce_task.add(world.taskq.add(& make_argument, size, 1.0));
+    const std::vector<double> result = reduce_task.submit().get();
+
+    total += madness::wall_time() - start;
+
+    if(result.front() != double(arguments))
+      throw std::runtime_error("reduce_task: incorrect reduction result");
+  }
+
+  return total / double(repeat);
+}
+
+int main(int argc, char** argv) {
+  int rc = 0;
+
+  try {
+    // Initialize runtime
+    TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+    const std::size_t size = (argc >= 2 ? atol(argv[1]) : 4096);
+    const std::size_t arguments = (argc >= 3 ? atol(argv[2]) : 4096);
+    const unsigned int partials = (argc >= 4 ? atol(argv[3]) :
+        madness::ThreadPool::size() + 1);
+    const std::size_t repeat = (argc >= 5 ? atol(argv[4]) : 5);
+    if((size == 0ul) || (arguments == 0ul) || (partials == 0u) || (repeat == 0ul)) {
+      std::cerr << "Error: all arguments must be greater than zero.\n";
+      return 1;
+    }
+
+    if(world.rank() == 0) {
+      std::cout << "TiledArray: reduce task test..."
+                << "\nThreads:   " << madness::ThreadPool::size() + 1
+                << "\nSize:      " << size
+                << "\nArguments: " << arguments
+                << "\nRepeat:    " << repeat << "\n";
+
+      for(unsigned int p : { 1u, partials }) {
+        const double time = benchmark(world, size, arguments, p, repeat);
+        std::cout << "partials=" << std::setw(4) << p
+                  << "   time=" << std::fixed << std::setprecision(6) << time
+                  << " s   " << std::setprecision(3)
+                  << (double(size * arguments * sizeof(double)) / time * 1.0e-9)
+                  << " GB/s\n";
+      }
+    }
+
+    world.gop.fence();
+    TiledArray::finalize();
+
+  } catch(TiledArray::Exception& e) {
+    std::cerr << "!! TiledArray exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(madness::MadnessException& e) {
+    std::cerr << "!! MADNESS exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(SafeMPI::Exception& e) {
+    std::cerr << "!! SafeMPI exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(std::exception& e) {
+    std::cerr << "!! std exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(...) {
+    std::cerr << "!! exception: unknown exception\n";
+    rc = 1;
+  }
+
+  return rc;
+}
@@ -0,0 +1,159 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  simd_vector.cpp
+ *  Jan 30, 2017
+ *
+ */
+
+// Compare the throughput of the generic, lambda based, vector operations with
+// the explicitly vectorized kernels of each supported instruction set. All
+// kernels are run on a single thread.
+//
+// usage: simd_vector [size [repeat]]
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <madness/world/timers.h>
+#include "TiledArray/math/vector_op.h"
+#include "TiledArray/math/simd_vector_op.h"
+
+template <typename T>
+void benchmark(const std::size_t n, const std::size_t repeat) {
+  using namespace TiledArray::math;
+
+  T* a = NULL;
+  T* b = NULL;
+  T* c = NULL;
+  if(posix_memalign(reinterpret_cast<void**>(&a), 128, sizeof(T) * n) != 0)
+    return;
+  if(posix_memalign(reinterpret_cast<void**>(&b), 128, sizeof(T) * n) != 0)
+    return;
+  if(posix_memalign(reinterpret_cast<void**>(&c), 128, sizeof(T) * n) != 0)
+    return;
+  std::fill_n(a, n, T(2));
+  std::fill_n(b, n, T(3));
+  std::fill_n(c, n, T(0));
+
+  const T factor = T(3);
+  T x = T(0);
+
+  // Report the throughput in GB/s, where a kernel that reads or writes
+  // vectors touches vectors * n elements per repetition.
+  auto report = [=] (const char* name, const std::size_t vectors,
+      const double time)
+  {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+        << std::fixed << std::setprecision(3) << std::setw(10) << time << " s "
+        << std::setw(10) << (double(vectors * n * sizeof(T) * repeat) / time * 1.0e-9)
+        << " GB/s\n";
+  };
+
+  auto run = [=] (const char* name, const std::size_t vectors,
+      const std::function<void()>& generic_op,
+      const std::function<void(const SimdKernelTable<T>&)>& simd_op)
+  {
+    std::cout << name << ":\n";
+
+    double start = madness::wall_time();
+    for(std::size_t r = 0ul; r < repeat; ++r)
+      generic_op();
+    double stop = madness::wall_time();
+    report("generic", vectors, stop - start);
+
+    for(SimdIsa isa : { SimdIsa::scalar, SimdIsa::neon, SimdIsa::avx2, SimdIsa::avx512 }) {
+      if(! simd_isa_supported(isa))
+        continue;
+      simd_isa(isa);
+      const SimdKernelTable<T>& kernels = simd_kernels<T>();
+
+      start = madness::wall_time();
+      for(std::size_t r = 0ul; r < repeat; ++r)
+        simd_op(kernels);
+      stop = madness::wall_time();
+      report(simd_isa_name(isa), vectors, stop - start);
+    }
+  };
+
+  run("add", 3ul,
+      [=] () { vector_op_serial([] (const T l, const T r) { return l + r; },
+          n, c, a, b); },
+      [=] (const SimdKernelTable<T>& k) { k.binary[simd_add](n, c, a, b); });
+
+  run("scal_add", 3ul,
+      [=] () { vector_op_serial([=] (const T l, const T r) { return (l + r) * factor; },
+          n, c, a, b); },
+      [=] (const SimdKernelTable<T>& k) { k.scal_binary[simd_add](n, c, a, b, factor); });
+
+  run("mult", 3ul,
+      [=] () { vector_op_serial([] (const T l, const T r) { return l * r; },
+          n, c, a, b); },
+      [=] (const SimdKernelTable<T>& k) { k.binary[simd_mult](n, c, a, b); });
+
+  run("add_to", 3ul,
+      [=] () { inplace_vector_op_serial([] (T& l, const T r) { l += r; },
+          n, c, a); },
+      [=] (const SimdKernelTable<T>& k) { k.inplace[simd_add](n, c, a); });
+
+  run("scale_to", 2ul,
+      [=] () { inplace_vector_op_serial([=] (T& l) { l *= factor; }, n, c); },
+      [=] (const SimdKernelTable<T>& k) { k.scale_to(n, c, factor); });
+
+  run("sum", 1ul,
+      [=, &x] () { x = T(0);
+          reduce_op_serial([] (T& res, const T arg) { res += arg; }, n, x, a); },
+      [=, &x] (const SimdKernelTable<T>& k) { x = k.sum(n, a); });
+
+  run("dot", 2ul,
+      [=, &x] () { x = T(0);
+          reduce_op_serial([] (T& res, const T l, const T r) { res += l * r; },
+          n, x, a, b); },
+      [=, &x] (const SimdKernelTable<T>& k) { x = k.dot(n, a, b); });
+
+  // Use the reduction result so that it cannot be optimized away
+  std::cout << "  (result " << x << ")\n";
+
+  free(a);
+  free(b);
+  free(c);
+}
+
+int main(int argc, char** argv) {
+  madness::World& world = madness::initialize(argc,argv);
+
+  // The default size is that of a 64^3 element tile
+  const std::size_t n = (argc > 1 ? std::atol(argv[1]) : 262144l);
+  const std::size_t repeat = (argc > 2 ? std::atol(argv[2]) : 1000l);
+
+  if(world.rank() == 0) {
+    const TiledArray::math::SimdIsa isa = TiledArray::math::simd_isa();
+    std::cout << "size = " << n << " repeat = " << repeat
+        << " default instruction set = " << TiledArray::math::simd_isa_name(isa)
+        << "\n\ndouble\n";
+    benchmark<double>(n, repeat);
+    std::cout << "\nfloat\n";
+    benchmark<float>(n, repeat);
+    TiledArray::math::simd_isa(isa);
+  }
+
+  madness::finalize();
+
+  return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  vector_bench.cpp
+ *  May 31, 2017
+ *
+ */
+
+// Bandwidth benchmark of the element-wise kernels of math/vector_op.h, the
+// tensor kernels of tensor/kernels.h (through the Tensor arithmetic), and
+// math/partial_reduce.h. The working set of each kernel is swept from the
+// L1 cache to DRAM, and each kernel is reported in GB/s and relative to
+// the STREAM triad, a[i] = b[i] + s * c[i], which is measured with a plain
+// loop on the same working set; so the numbers of one machine can be
+// compared across builds, e.g. before and after a kernel is vectorized or
+// fused. Each measurement is repeated until it takes at least the minimum
+// time, and the best of five measurements is reported. The vector_op
+// kernels are the serial variants; the Tensor kernels use the TBB variants
+// when TiledArray is built with TBB, so they may exceed the serial STREAM
+// triad.
+//
+// usage: vector_bench [min_bytes [max_bytes [min_time]]]
+//
+// min_bytes  The smallest working set in bytes [ default = 4096 ]
+// max_bytes  The largest working set in bytes [ default = 268435456 ]
+// min_time   The minimum time of a measurement in s [ default = 0.02 ]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <tiledarray.h>
+#include <TiledArray/math/partial_reduce.h>
+#include <TiledArray/math/vector_op.h>
+
+namespace {
+
+  /// Best throughput of a kernel
+
+  /// \param op The kernel
+  /// \param bytes The bytes read and written by one call of \c op
+  /// \param min_time The minimum time of a measurement
+  /// \return The throughput in GB/s
+  double measure(const std::function<void()>& op, const double bytes,
+      const double min_time)
+  {
+    // Find the number of calls that takes at least min_time
+    std::size_t calls = 1ul;
+    op();
+    for(;;) {
+      const double start = madness::wall_time();
+      for(std::size_t c = 0ul; c < calls; ++c)
+        op();
+      const double time = madness::wall_time() - start;
+      if(time >= min_time)
+        break;
+      calls *= (time > 0.0 ? std::max<std::size_t>(std::ceil(min_time / time), 2ul) : 16ul);
+    }
+
+    double best = 0.0;
+    for(int r = 0; r < 5; ++r) {
+      const double start = madness::wall_time();
+      for(std::size_t c = 0ul; c < calls; ++c)
+        op();
+      const double time = madness::wall_time() - start;
+      best = std::max(best, bytes * double(calls) / time * 1.0e-9);
+    }
+    return best;
+  }
+
+  /// A benchmarked kernel
+  struct Kernel {
+    std::string name; ///< The kernel name
+    double bytes; ///< The bytes read and written by one call
+    std::function<void()> op; ///< The kernel
+  }; // struct Kernel
+
+  /// Benchmark the kernels for a working set of \c bytes
+
+  /// \param bytes The working set of the STREAM triad, i.e. three vectors
+  /// \param min_time The minimum time of a measurement
+  void benchmark(const std::size_t bytes, const double min_time) {
+    using namespace TiledArray;
+    using namespace TiledArray::math;
+
+    const std::size_t n = std::max<std::size_t>(bytes / (3ul * sizeof(double)), 16ul);
+    const double factor = 3.0;
+    volatile double sink = 0.0;
+
+    Tensor<double> ta(Range(n), 2.0), tb(Range(n), 3.0), tc(Range(n), 0.0);
+    double* const a = ta.data();
+    double* const b = tb.data();
+    double* const c = tc.data();
+
+    // A square matrix with the working set of one vector
+    const std::size_t m = std::max<std::size_t>(std::sqrt(double(n)), 4ul);
+    std::vector<double> matrix(m * m, 1.0), x(m, 1.0), y(m, 0.0);
+
+    const double stream = measure([=] () {
+          for(std::size_t i = 0ul; i < n; ++i)
+            a[i] = b[i] + factor * c[i];
+        }, 3.0 * n * sizeof(double), min_time);
+
+    // The bytes of a vector and of the partial reductions
+    const double v = double(n * sizeof(double));
+    const double mv = double((m * m + 2ul * m) * sizeof(double));
+
+    const std::vector<Kernel> kernels = {
+      { "stream_copy", 2.0 * v, [=] () {
+          for(std::size_t i = 0ul; i < n; ++i)
+            c[i] = a[i];
+        } },
+      { "vector_op.add", 3.0 * v, [=] () {
+          vector_op_serial([] (const double l, const double r) { return l + r; },
+              n, c, a, b);
+        } },
+      { "vector_op.scal_add", 3.0 * v, [=] () {
+          vector_op_serial([=] (const double l, const double r) { return (l + r) * factor; },
+              n, c, a, b);
+        } },
+      { "vector_op.add_to", 3.0 * v, [=] () {
+          inplace_vector_op_serial([] (double& l, const double r) { l += r; },
+              n, c, a);
+        } },
+      { "vector_op.scale_to", 2.0 * v, [=] () {
+          inplace_vector_op_serial([] (double& l) { l *= 1.0000001; }, n, c);
+        } },
+      { "vector_op.sum", v, [=, &sink] () {
+          double result = 0.0;
+          reduce_op_serial([] (double& res, const double arg) { res += arg; },
+              n, result, a);
+          sink = result;
+        } },
+      { "vector_op.dot", 2.0 * v, [=, &sink] () {
+          double result = 0.0;
+          reduce_op_serial([] (double& res, const double l, const double r) { res += l * r; },
+              n, result, a, b);
+          sink = result;
+        } },
+      { "tensor.add", 3.0 * v, [&] () { tc = ta.add(tb); } },
+      { "tensor.add_to", 3.0 * v, [&] () { tc.add_to(ta); } },
+      { "tensor.scale_to", 2.0 * v, [&] () { tc.scale_to(1.0000001); } },
+      { "tensor.mult_to", 3.0 * v, [&] () { tc.mult_to(tb); } },
+      { "tensor.dot", 2.0 * v, [&] () { sink = ta.dot(tb); } },
+      { "tensor.sum", v, [&] () { sink = ta.sum(); } },
+      { "partial_reduce.row", mv, [&] () {
+          row_reduce(m, m, matrix.data(), x.data(), y.data(),
+              [] (double& res, const double l, const double r) { res += l * r; });
+        } },
+      { "partial_reduce.col", mv, [&] () {
+          col_reduce(m, m, matrix.data(), x.data(), y.data(),
+              [] (double& res, const double l, const double r) { res += l * r; });
+        } }
+    };
+
+    std::cout << std::left << std::setw(22) << "stream_triad" << std::right
+        << std::setw(12) << bytes << std::fixed << std::setprecision(2)
+        << std::setw(10) << stream << std::setw(10) << 1.0 << "\n";
+    for(const Kernel& kernel : kernels) {
+      const double rate = measure(kernel.op, kernel.bytes, min_time);
+      std::cout << std::left << std::setw(22) << kernel.name << std::right
+          << std::setw(12) << bytes << std::setw(10) << rate
+          << std::setw(10) << rate / stream << "\n";
+    }
+    (void)sink;
+  }
+
+} // namespace
+
+int main(int argc, char** argv) {
+  madness::World& world = madness::initialize(argc,argv);
+
+  const std::size_t min_bytes = (argc > 1 ? std::atol(argv[1]) : 4096l);
+  const std::size_t max_bytes = (argc > 2 ? std::atol(argv[2]) : 268435456l);
+  const double min_time = (argc > 3 ? std::atof(argv[3]) : 0.02);
+
+  if(world.rank() == 0) {
+    std::cout << std::left << std::setw(22) << "kernel" << std::right
+        << std::setw(12) << "bytes" << std::setw(10) << "GB/s"
+        << std::setw(10) << "/triad" << "\n";
+    for(std::size_t bytes = std::max<std::size_t>(min_bytes, 1ul);
+        bytes <= max_bytes; bytes *= 4ul)
+      benchmark(bytes, min_time);
+  }
+
+  madness::finalize();
+
+  return 0;
+}
@@ -0,0 +1,12 @@
+# -*- mode: cmake -*-
+
+# Check for CUDA and cuBLAS
+find_package(CUDA REQUIRED)
+
+if (NOT CUDA_CUBLAS_LIBRARIES)
+  message(FATAL_ERROR "CUDA found at ${CUDA_TOOLKIT_ROOT_DIR}, but cuBLAS was not found")
+endif()
+
+set(TILEDARRAY_HAS_CUDA 1)
+list(APPEND TiledArray_CONFIG_INCLUDE_DIRS ${CUDA_INCLUDE_DIRS})
+list(APPEND TiledArray_CONFIG_LIBRARIES ${CUDA_CUBLAS_LIBRARIES} ${CUDA_LIBRARIES})
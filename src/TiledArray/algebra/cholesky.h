@@ -0,0 +1,315 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  cholesky.h
+ *  Mar 22, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_ALGEBRA_CHOLESKY_H__INCLUDED
+#define TILEDARRAY_ALGEBRA_CHOLESKY_H__INCLUDED
+
+#include <vector>
+#include <TiledArray/conversions/eigen.h>
+#include <TiledArray/conversions/truncate.h>
+#include "../dist_array.h"
+
+namespace TiledArray {
+
+  namespace detail {
+
+    /// Shape of a factor with a known tile structure
+
+    /// \param shape The shape of the input array
+    /// \return \c shape , since dense arrays have no structural zeros
+    inline DenseShape structure_shape(const DenseShape& shape, const TiledRange&,
+        const std::vector<bool>&)
+    { return shape; }
+
+    /// Shape of a factor with a known tile structure
+
+    /// The non-zero tiles are given a per-element norm of one; the actual
+    /// norms are computed by truncating the factor once it is evaluated.
+    /// \param trange The tiled range of the factor
+    /// \param nonzero The structurally non-zero tiles, by ordinal index
+    /// \return A shape that has the given non-zero tiles
+    template <typename T>
+    inline SparseShape<T> structure_shape(const SparseShape<T>&,
+        const TiledRange& trange, const std::vector<bool>& nonzero)
+    {
+      Tensor<T> norms(trange.tiles_range(), T(0));
+      for(std::size_t ord = 0ul; ord < nonzero.size(); ++ord)
+        if(nonzero[ord])
+          norms[ord] = trange.make_tile_range(ord).volume();
+      return SparseShape<T>(norms, trange);
+    }
+
+    /// Tile Cholesky factorization, <tt>A = L L^H</tt>
+
+    /// \param a A Hermitian positive definite tile; only its lower triangle
+    /// is referenced
+    /// \return The lower triangular factor
+    /// \throw TiledArray::Exception When \c a is not positive definite.
+    template <typename T, typename A>
+    inline Tensor<T,A> tile_potrf(const Tensor<T,A>& a) {
+      typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> matrix_type;
+      const std::size_t n = a.range().extent_data()[0];
+      Eigen::LLT<matrix_type> llt(eigen_map(a, n, n));
+      if(llt.info() != Eigen::Success)
+        TA_EXCEPTION("cholesky: the matrix is not positive definite.");
+      Tensor<T,A> result(a.range());
+      eigen_map(result, n, n) = llt.matrixL();
+      return result;
+    }
+
+    /// Tile Cholesky panel update, <tt>A L^-H</tt>
+
+    /// \param a The tile to be solved, which is overwritten
+    /// \param l A lower triangular diagonal tile of the factor
+    /// \return <tt>a L^-H</tt>
+    template <typename T, typename A>
+    inline Tensor<T,A> tile_trsm_right(Tensor<T,A> a, const Tensor<T,A>& l) {
+      const std::size_t m = a.range().extent_data()[0];
+      const std::size_t n = l.range().extent_data()[0];
+      auto a_map = eigen_map(a, m, n);
+      eigen_map(l, n, n).template triangularView<Eigen::Lower>().adjoint().
+          template solveInPlace<Eigen::OnTheRight>(a_map);
+      return a;
+    }
+
+    /// Tile forward or backward substitution
+
+    /// \param b The right-hand side tile, viewed as a matrix whose rows
+    /// are the first dimension, which is overwritten
+    /// \param l A lower triangular diagonal tile of the factor
+    /// \param adjoint Solve with <tt>L^H</tt> instead of \c L
+    /// \return <tt>L^-1 b</tt> or <tt>L^-H b</tt>
+    template <typename T, typename A>
+    inline Tensor<T,A> tile_trsm_left(Tensor<T,A> b, const Tensor<T,A>& l,
+        const bool adjoint)
+    {
+      const std::size_t m = l.range().extent_data()[0];
+      auto b_map = eigen_map(b, m, b.range().volume() / m);
+      const auto l_tri = eigen_map(l, m, m).template triangularView<Eigen::Lower>();
+      if(adjoint)
+        l_tri.adjoint().solveInPlace(b_map);
+      else
+        l_tri.solveInPlace(b_map);
+      return b;
+    }
+
+    /// Initial value of a tile that is updated in place
+
+    /// \param array The input array
+    /// \param ord The ordinal index of the tile
+    /// \return A copy of the tile of \c array , or a zero tile
+    template <typename T, typename A, typename Policy>
+    inline Future<Tensor<T,A> >
+    updatable_tile(const DistArray<Tensor<T,A>,Policy>& array, const std::size_t ord) {
+      if(array.is_zero(ord))
+        return Future<Tensor<T,A> >(Tensor<T,A>(array.trange().make_tile_range(ord), T(0)));
+      return array.world().taskq.add(
+          [] (const Tensor<T,A>& tile) { return tile.clone(); }, array.find(ord));
+    }
+
+  }  // namespace detail
+
+  /// Tiled Cholesky factorization
+
+  /// The Hermitian positive definite matrix \c a is factorized as
+  /// <tt>A = L L^H</tt> in place of its distribution, without gathering it on
+  /// one process. Each process spawns the tasks of the tiles of \c L that it
+  /// owns: the updates <tt>L_ij -= L_ik L_jk^H</tt>, the panel solves
+  /// <tt>L_ij = L_ij L_jj^-H</tt>, and the diagonal factorizations. The
+  /// tasks form a dataflow graph through the futures of the tiles of \c L ,
+  /// so the factorization proceeds right-looking as tiles become ready, and
+  /// remote tiles are fetched as they are needed. For sparse arrays the
+  /// tile structure of \c L , including fill-in, is determined symbolically
+  /// from the shape of \c a , updates with zero tiles are skipped, and the
+  /// shape of \c L is truncated after the factorization. This function is
+  /// collective.
+  /// \param a A square matrix whose row and column tilings are equal; only
+  /// its lower triangle is referenced
+  /// \return The lower triangular factor \c L , with the distribution of
+  /// \c a
+  /// \throw TiledArray::Exception When \c a is not a square matrix; when it
+  /// is not positive definite, the exception is thrown when the tiles are
+  /// accessed.
+  template <typename T, typename A, typename Policy>
+  inline DistArray<Tensor<T,A>,Policy>
+  cholesky(const DistArray<Tensor<T,A>,Policy>& a) {
+    typedef DistArray<Tensor<T,A>,Policy> array_type;
+    typedef Tensor<T,A> tile_type;
+    const TiledRange& trange = a.trange();
+    TA_USER_ASSERT(trange.tiles_range().rank() == 2u &&
+        trange.data()[0] == trange.data()[1],
+        "cholesky: the array must be a square matrix with equal row and column tilings.");
+    const std::size_t nt = trange.data()[0].tile_extent();
+    const auto ord = [nt] (const std::size_t i, const std::size_t j) { return i * nt + j; };
+
+    // Symbolic factorization of the tile structure
+    std::vector<bool> nonzero(nt * nt, false);
+    for(std::size_t j = 0ul; j < nt; ++j) {
+      nonzero[ord(j, j)] = true;
+      for(std::size_t i = j + 1ul; i < nt; ++i) {
+        bool nz = ! a.is_zero(ord(i, j));
+        for(std::size_t k = 0ul; k < j && ! nz; ++k)
+          nz = nonzero[ord(i, k)] && nonzero[ord(j, k)];
+        nonzero[ord(i, j)] = nz;
+      }
+    }
+
+    array_type l(a.world(), trange,
+        detail::structure_shape(a.shape(), trange, nonzero), a.pmap());
+
+    for(std::size_t j = 0ul; j < nt; ++j) {
+      for(std::size_t i = j; i < nt; ++i) {
+        const std::size_t ij = ord(i, j);
+        if(l.is_zero(ij) || ! l.is_local(ij))
+          continue;
+
+        Future<tile_type> tile = detail::updatable_tile(a, ij);
+        for(std::size_t k = 0ul; k < j; ++k) {
+          if(l.is_zero(ord(i, k)) || l.is_zero(ord(j, k)))
+            continue;
+          tile = a.world().taskq.add(
+              [] (tile_type c, const tile_type& lik, const tile_type& ljk) {
+                const std::size_t m = c.range().extent_data()[0];
+                const std::size_t n = c.range().extent_data()[1];
+                const std::size_t nk = lik.range().extent_data()[1];
+                eigen_map(c, m, n).noalias() -=
+                    eigen_map(lik, m, nk) * eigen_map(ljk, n, nk).adjoint();
+                return c;
+              }, tile, l.find(ord(i, k)), l.find(ord(j, k)));
+        }
+
+        if(i == j)
+          tile = a.world().taskq.add(& detail::tile_potrf<T,A>, tile);
+        else
+          tile = a.world().taskq.add(& detail::tile_trsm_right<T,A>, tile,
+              l.find(ord(j, j)));
+        l.set(ij, tile);
+      }
+
+      // The upper triangle of a dense factor is zero
+      for(std::size_t i = 0ul; i < j; ++i)
+        if(! l.is_zero(ord(i, j)) && l.is_local(ord(i, j)))
+          l.set(ord(i, j), tile_type(trange.make_tile_range(ord(i, j)), T(0)));
+    }
+
+    truncate(l);
+    return l;
+  }
+
+  /// Tiled triangular solve with a Cholesky factor
+
+  /// This solves <tt>L X = B</tt> , or <tt>L^H X = B</tt> when \c adjoint
+  /// is \c true , where \c B may have any rank: its first dimension is
+  /// solved for, and its other dimensions are flattened into the columns of
+  /// each tile, e.g. the auxiliary index of three-index integrals. The
+  /// solve is distributed like \c cholesky() : each process spawns the
+  /// substitution tasks of the tiles of \c X that it owns, with the
+  /// distribution of \c b , and tiles of \c L and \c X are fetched as they
+  /// become ready. For sparse arrays the tile structure of \c X is
+  /// determined symbolically from the shapes of \c l and \c b , and the
+  /// shape of \c X is truncated after the solve. This function is
+  /// collective.
+  /// \param l The lower triangular factor, as returned by \c cholesky()
+  /// \param b The right-hand sides, whose first dimension is tiled like
+  /// the rows of \c l
+  /// \param adjoint Solve with <tt>L^H</tt> [default = false]
+  /// \return The solution \c X , with the distribution of \c b
+  /// \throw TiledArray::Exception When the tilings of \c l and \c b do not
+  /// match.
+  template <typename T, typename A, typename Policy>
+  inline DistArray<Tensor<T,A>,Policy>
+  triangular_solve(const DistArray<Tensor<T,A>,Policy>& l,
+      const DistArray<Tensor<T,A>,Policy>& b, const bool adjoint = false)
+  {
+    typedef DistArray<Tensor<T,A>,Policy> array_type;
+    typedef Tensor<T,A> tile_type;
+    const TiledRange& trange = b.trange();
+    TA_USER_ASSERT(l.trange().tiles_range().rank() == 2u &&
+        l.trange().data()[0] == trange.data()[0],
+        "triangular_solve: the first dimension of the right-hand sides must be tiled like the factor.");
+    const std::size_t nt = trange.data()[0].tile_extent();
+    const std::size_t nc = trange.tiles_range().volume() / nt;
+    const auto l_ord = [nt] (const std::size_t i, const std::size_t j) { return i * nt + j; };
+
+    // The rows of X in substitution order, and the coupling of row i with
+    // row k in L (or L^H)
+    std::vector<std::size_t> rows(nt);
+    for(std::size_t n = 0ul; n < nt; ++n)
+      rows[n] = (adjoint ? nt - 1ul - n : n);
+    const auto coupling = [&] (const std::size_t i, const std::size_t k) {
+      return (adjoint ? l_ord(k, i) : l_ord(i, k));
+    };
+
+    // Symbolic substitution of the tile structure
+    std::vector<bool> nonzero(nt * nc, false);
+    for(std::size_t n = 0ul; n < nt; ++n) {
+      const std::size_t i = rows[n];
+      for(std::size_t c = 0ul; c < nc; ++c) {
+        bool nz = ! b.is_zero(i * nc + c);
+        for(std::size_t p = 0ul; p < n && ! nz; ++p)
+          nz = ! l.is_zero(coupling(i, rows[p])) && nonzero[rows[p] * nc + c];
+        nonzero[i * nc + c] = nz;
+      }
+    }
+
+    array_type x(b.world(), trange,
+        detail::structure_shape(b.shape(), trange, nonzero), b.pmap());
+
+    for(std::size_t n = 0ul; n < nt; ++n) {
+      const std::size_t i = rows[n];
+      for(std::size_t c = 0ul; c < nc; ++c) {
+        const std::size_t ic = i * nc + c;
+        if(x.is_zero(ic) || ! x.is_local(ic))
+          continue;
+
+        Future<tile_type> tile = detail::updatable_tile(b, ic);
+        for(std::size_t p = 0ul; p < n; ++p) {
+          const std::size_t k = rows[p];
+          if(l.is_zero(coupling(i, k)) || x.is_zero(k * nc + c))
+            continue;
+          tile = b.world().taskq.add(
+              [adjoint] (tile_type r, const tile_type& lik, const tile_type& xk) {
+                const std::size_t m = r.range().extent_data()[0];
+                const std::size_t mk = xk.range().extent_data()[0];
+                const std::size_t n = r.range().volume() / m;
+                auto r_map = eigen_map(r, m, n);
+                if(adjoint)
+                  r_map.noalias() -= eigen_map(lik, mk, m).adjoint() *
+                      eigen_map(xk, mk, n);
+                else
+                  r_map.noalias() -= eigen_map(lik, m, mk) * eigen_map(xk, mk, n);
+                return r;
+              }, tile, l.find(coupling(i, k)), x.find(k * nc + c));
+        }
+
+        x.set(ic, b.world().taskq.add(& detail::tile_trsm_left<T,A>, tile,
+            l.find(l_ord(i, i)), adjoint));
+      }
+    }
+
+    truncate(x);
+    return x;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_ALGEBRA_CHOLESKY_H__INCLUDED
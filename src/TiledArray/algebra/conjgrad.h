@@ -26,6 +26,7 @@
 #ifndef TILEDARRAY_ALGEBRA_CONJGRAD_H__INCLUDED
 #define TILEDARRAY_ALGEBRA_CONJGRAD_H__INCLUDED
 
+#include <array>
 #include <sstream>
 #include <TiledArray/algebra/diis.h>
 #include <TiledArray/algebra/utils.h>
@@ -52,10 +53,36 @@ namespace TiledArray {
   ///   \li <tt> void axpy(D& y, value_type a, const D& x) </tt>
   ///   \li <tt> void assign(D&, const D&) </tt>
   ///   \li <tt> double norm2(const D&) </tt>
+  ///
+  /// If the tile norms of the residuals are known to be current, e.g. if
+  /// \c axpy() truncates sparse arrays, the residual norm of the convergence
+  /// check can be computed from the shape of the residual with
+  /// \c norm2_estimate() , which saves a pass over the residual and a
+  /// collective reduction per iteration (see \c shape_norms() ).
   template <typename D, typename F>
   struct ConjugateGradientSolver {
     typedef typename D::element_type value_type;
 
+    /// \param shape_norms If \c true , the residual norms are estimated
+    /// with \c norm2_estimate() [default = false]
+    explicit ConjugateGradientSolver(const bool shape_norms = false) :
+      shape_norms_(shape_norms)
+    { }
+
+    /// Residual norm estimation query
+
+    /// \return \c true if the residual norms are estimated from the tile
+    /// norms of the residuals
+    bool shape_norms() const { return shape_norms_; }
+
+    /// Estimate the residual norms from the tile norms of the residuals
+
+    /// The estimate of sparse arrays equals the norm if the tile norms of
+    /// the residuals are current, and is an upper bound otherwise, which
+    /// may prevent convergence; other vectors are reduced with \c norm2() .
+    /// \param shape_norms If \c true , the residual norms are estimated
+    void shape_norms(const bool shape_norms) { shape_norms_ = shape_norms; }
+
     /// \param a object of type F
     /// \param b RHS
     /// \param x unknown
@@ -124,43 +151,43 @@ namespace TiledArray {
       PP_i = copy(ZZ_i);
 
       unsigned int iter = 0;
+      value_type rz_norm2 = dot_product(RR_i, ZZ_i);
       while (not converged) {
 
         // alpha_i = (r_i . z_i) / (p_i . A . p_i)
-        value_type rz_norm2 = dot_product(RR_i, ZZ_i);
         a(PP_i,APP_i);
 
         const value_type pAp_i = dot_product(PP_i, APP_i);
         const value_type alpha_i = rz_norm2 / pAp_i;
 
-        // x_i += alpha_i p_i
-        axpy(XX_i, alpha_i, PP_i);
+        // x_i += alpha_i p_i, r_i -= alpha_i Ap_i, z_i = D^-1 . r_i, and
+        // the products r_i . z_i and r_i . r_i, in one pass
+        auto rz_rr = cg_update(XX_i, RR_i, ZZ_i, PP_i, APP_i, preconditioner,
+            alpha_i, shape_norms_);
 
-        // r_i -= alpha_i Ap_i
-        axpy(RR_i, -alpha_i, APP_i);
-
-        if (use_diis)
+        if (use_diis) {
           diis.extrapolate(XX_i, RR_i, true);
+          ZZ_i = copy(RR_i);
+          vec_multiply(ZZ_i, preconditioner);
+          const value_type r_norm =
+              (shape_norms_ ? norm2_estimate(RR_i) : norm2(RR_i));
+          rz_rr[0] = dot_product(ZZ_i, RR_i);
+          rz_rr[1] = r_norm * r_norm;
+        }
 
-        const value_type r_ip1_norm = norm2(RR_i) / rhs_size;
+        const value_type r_ip1_norm = std::sqrt(std::abs(rz_rr[1])) / rhs_size;
         if (r_ip1_norm < convergence_target) {
           converged = true;
           rnorm2 = r_ip1_norm;
         }
 
-        // z_i = D^-1 . r_i
-        ZZ_i = copy(RR_i);
-        vec_multiply(ZZ_i, preconditioner);
-
-        const value_type rz_ip1_norm2 = dot_product(ZZ_i, RR_i);
+        const value_type rz_ip1_norm2 = rz_rr[0];
 
         const value_type beta_i = rz_ip1_norm2 / rz_norm2;
+        rz_norm2 = rz_ip1_norm2;
 
         // p_i = z_i+1 + beta_i p_i
-        // 1) scale p_i by beta_i
-        // 2) add z_i+1 (i.e. current contents of z_i)
-        scale(PP_i, beta_i);
-        axpy(PP_i, 1.0, ZZ_i);
+        cg_direction(PP_i, ZZ_i, beta_i);
 
         ++iter;
         //std::cout << "iter=" << iter << " dnorm=" << r_ip1_norm << std::endl;
@@ -173,6 +200,125 @@ namespace TiledArray {
 
       assign(x, XX_i);
 
+      return rnorm2;
+    }
+
+  private:
+    bool shape_norms_; ///< \c true if residual norms are estimated
+  };
+
+  /// Solves linear system <tt> a(x) = b </tt> using pipelined conjugate gradient
+
+  /// This solver uses the pipelined, preconditioned conjugate gradient method
+  /// of P. Ghysels and W. Vanroose, Parallel Comput. 40, 224 (2014). It
+  /// computes the same iterates as \c ConjugateGradientSolver in exact
+  /// arithmetic, but needs one collective reduction per iteration, which is
+  /// started before and completed after the preconditioner application and
+  /// the product of \c a with a vector, so its latency is hidden by the
+  /// product. The vector updates of an iteration are fused into one pass
+  /// over the local tiles by \c pipelined_cg_update() . It holds four more
+  /// vectors than \c ConjugateGradientSolver and may be less stable for
+  /// ill-conditioned systems.
+  /// \tparam D type of \c x and \c b, as well as the preconditioner;
+  /// \tparam F type that evaluates the LHS, will call \c F::operator()(x,result)
+  /// \sa ConjugateGradientSolver for the functions that \c D must provide
+  template <typename D, typename F>
+  struct PipelinedConjugateGradientSolver {
+    typedef typename D::element_type value_type;
+
+    /// \param a object of type F
+    /// \param b RHS
+    /// \param x unknown
+    /// \param preconditioner
+    /// \param convergence_target The convergence target [default = -1.0]
+    /// \return The 2-norm of the residual, a(x) - b, divided by the number of
+    /// elements in the residual.
+    value_type operator()(F& a, const D& b, D& x, const D& preconditioner,
+        value_type convergence_target = -1.0)
+    {
+      std::size_t n = size(x);
+      assert(n == size(preconditioner));
+
+      const value_type precond_min = minabs_value(preconditioner);
+      const value_type precond_max = maxabs_value(preconditioner);
+      const value_type cond_number = precond_max / precond_min;
+      if (convergence_target < 0.0) {
+        convergence_target = 1e-15 * cond_number;
+      }
+      else {
+        if (convergence_target < 1e-15 * cond_number)
+          std::cout << "WARNING: PipelinedConjugateGradient convergence target ("
+                    << convergence_target
+                    << ") may be too low for 64-bit precision" << std::endl;
+      }
+
+      const unsigned int max_niter = n;
+      const std::size_t rhs_size = size(b);
+
+      // starting guess: x_0 = D^-1 . b
+      D XX_i = copy(b);
+      vec_multiply(XX_i, preconditioner);
+
+      // r_0 = b - a(x_0)
+      D RR_i = clone(b);
+      a(XX_i, RR_i);
+      scale(RR_i, -1.0);
+      axpy(RR_i, 1.0, b);
+
+      // u_0 = D^-1 . r_0 , w_0 = a(u_0)
+      D UU_i = copy(RR_i);
+      vec_multiply(UU_i, preconditioner);
+      D WW_i = clone(b);
+      a(UU_i, WW_i);
+
+      // the recurrence vectors, which are scaled by beta_0 = 0
+      D ZZ_i = copy(b);
+      zero(ZZ_i);
+      D QQ_i = copy(ZZ_i), SS_i = copy(ZZ_i), PP_i = copy(ZZ_i);
+
+      // m_i = D^-1 . w_i , n_i = a(m_i)
+      D MM_i;
+      D NN_i = clone(b);
+
+      const value_type r_0_norm = norm2(RR_i);
+      Future<std::array<value_type, 3> > products(std::array<value_type, 3>{{
+          dot_product(RR_i, UU_i), dot_product(WW_i, UU_i), r_0_norm * r_0_norm }});
+
+      value_type gamma_prev = 0.0, alpha_prev = 0.0, rnorm2 = 0.0;
+      for (unsigned int iter = 0; ; ++iter) {
+        if (iter >= max_niter) {
+          assign(x, XX_i);
+          throw std::domain_error("PipelinedConjugateGradient: max # of iterations exceeded");
+        }
+
+        // the reduction of the products overlaps with these
+        MM_i = copy(WW_i);
+        vec_multiply(MM_i, preconditioner);
+        a(MM_i, NN_i);
+
+        // gamma_i = r_i . u_i , delta_i = w_i . u_i
+        const std::array<value_type, 3> rw_u = products.get();
+        const value_type gamma_i = rw_u[0];
+        const value_type delta_i = rw_u[1];
+
+        rnorm2 = std::sqrt(std::abs(rw_u[2])) / rhs_size;
+        if (rnorm2 < convergence_target)
+          break;
+
+        const value_type beta_i = (iter > 0 ? gamma_i / gamma_prev : 0.0);
+        const value_type alpha_i = (iter > 0 ?
+            gamma_i / (delta_i - beta_i * gamma_i / alpha_prev) :
+            gamma_i / delta_i);
+
+        products = pipelined_cg_update(XX_i, RR_i, UU_i, WW_i, ZZ_i, QQ_i,
+            SS_i, PP_i, MM_i, NN_i, alpha_i, beta_i);
+
+        gamma_prev = gamma_i;
+        alpha_prev = alpha_i;
+      } // solver loop
+
+      assign(x, XX_i);
+
       return rnorm2;
     }
   };
@@ -0,0 +1,328 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  davidson.h
+ *  Mar 20, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_ALGEBRA_DAVIDSON_H__INCLUDED
+#define TILEDARRAY_ALGEBRA_DAVIDSON_H__INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <TiledArray/math/eigen.h>
+#include <TiledArray/algebra/utils.h>
+#include "../dist_array.h"
+
+namespace TiledArray {
+
+  /// Block Davidson solver for the lowest eigenpairs of a symmetric operator
+
+  /// The solver holds an orthonormal subspace \c V and its images
+  /// <tt>A V</tt>. Each iteration diagonalizes the subspace matrix
+  /// <tt>V^T A V</tt>, forms the residuals of the unconverged Ritz vectors in
+  /// one pass over <tt>[V, A V]</tt>, preconditions them, and adds them to
+  /// the subspace after orthogonalization. All trial vectors of an iteration
+  /// are handed to the sigma builder at once, so that it can evaluate them
+  /// in one batch, e.g. as one contraction with a stacked tensor. Overlaps
+  /// are computed with \c inner_products() and subspace updates with
+  /// \c linear_combinations() , so orthogonalizing a batch against the
+  /// subspace costs one reduction. When the subspace is full, it is
+  /// collapsed to the current Ritz vectors.
+  ///
+  /// With the Jacobi-Davidson correction, the preconditioned residual
+  /// \c t = M^-1 r of each root is replaced by the approximate solution of
+  /// the correction equation <tt>t - e M^-1 x</tt> (Olsen), with
+  /// <tt>e = x^T M^-1 r / x^T M^-1 x</tt>, which keeps \c t orthogonal to
+  /// the Ritz vector \c x in the metric of \c M .
+  /// \tparam D The vector type, a \c DistArray of real elements
+  template <typename D>
+  class DavidsonSolver {
+  public:
+    typedef typename D::element_type value_type; ///< The element type
+    typedef Eigen::Matrix<value_type, Eigen::Dynamic, Eigen::Dynamic>
+        matrix_type; ///< The subspace matrix type
+
+    /// Sigma builder type
+
+    /// The builder computes <tt>sigma[i] = A x[i]</tt> for all vectors
+    /// of a batch; \c sigma has the size of \c x on entry.
+    typedef std::function<void(const std::vector<D>& x, std::vector<D>& sigma)>
+        sigma_type;
+
+    /// Preconditioner type
+
+    /// The preconditioner replaces \c x[i] with an approximation of
+    /// <tt>(A - shift[i])^-1 x[i]</tt> , e.g. by dividing it by the shifted
+    /// diagonal of \c A .
+    typedef std::function<void(const std::vector<value_type>& shift,
+        std::vector<D>& x)> preconditioner_type;
+
+  private:
+    unsigned int max_subspace_; ///< The largest subspace size
+    unsigned int max_iter_; ///< The largest number of iterations
+    value_type tolerance_; ///< The residual norm convergence threshold
+    bool jacobi_davidson_; ///< Use the Jacobi-Davidson correction
+    value_type linear_dependence_; ///< The relative overlap eigenvalue threshold
+    unsigned int iterations_; ///< The number of iterations of the last solve
+    std::vector<value_type> residual_norms_; ///< The last residual norms
+
+    /// Orthonormalize new vectors against an orthonormal subspace
+
+    /// The overlaps of \c t with <tt>[v, t]</tt> are computed with one
+    /// reduction. The vectors are projected out of \c v and orthonormalized
+    /// symmetrically; linearly dependent directions are dropped.
+    /// \param v The orthonormal subspace
+    /// \param t The new vectors
+    /// \return The orthonormal complement of \c v spanned by \c t
+    std::vector<D> orthonormalize(const std::vector<D>& v,
+        const std::vector<D>& t) const
+    {
+      const std::size_t nv = v.size(), nt = t.size();
+      std::vector<D> vt(v);
+      vt.insert(vt.end(), t.begin(), t.end());
+      const std::vector<value_type> g = inner_products(vt, t);
+
+      // Overlap of the projected vectors, S = T^T T - (V^T T)^T (V^T T)
+      matrix_type g1(nv, nt), s(nt, nt);
+      for(std::size_t i = 0ul; i < nv; ++i)
+        for(std::size_t j = 0ul; j < nt; ++j)
+          g1(i, j) = g[i * nt + j];
+      for(std::size_t i = 0ul; i < nt; ++i)
+        for(std::size_t j = 0ul; j < nt; ++j)
+          s(i, j) = g[(nv + i) * nt + j];
+      if(nv)
+        s -= g1.transpose() * g1;
+
+      Eigen::SelfAdjointEigenSolver<matrix_type> eig(s);
+      const value_type max_eval = (nt ? eig.eigenvalues().maxCoeff() : 0);
+      std::vector<std::size_t> kept;
+      for(std::size_t k = 0ul; k < nt; ++k)
+        if(eig.eigenvalues()(k) > linear_dependence_ * max_eval &&
+            eig.eigenvalues()(k) > value_type(0))
+          kept.push_back(k);
+      if(kept.empty())
+        return std::vector<D>();
+
+      // N = (T - V g1) U s^-1/2, as one combination of [V, T]
+      matrix_type u(nt, kept.size());
+      for(std::size_t k = 0ul; k < kept.size(); ++k)
+        u.col(k) = eig.eigenvectors().col(kept[k]) /
+            std::sqrt(eig.eigenvalues()(kept[k]));
+      matrix_type c(nv + nt, kept.size());
+      if(nv)
+        c.topRows(nv) = - g1 * u;
+      c.bottomRows(nt) = u;
+
+      return linear_combinations(vt, to_vector(c), kept.size());
+    }
+
+    /// \return The elements of \c c in row-major order
+    static std::vector<value_type> to_vector(const matrix_type& c) {
+      std::vector<value_type> result(c.size());
+      const std::size_t rows = c.rows(), cols = c.cols();
+      for(std::size_t i = 0ul; i < rows; ++i)
+        for(std::size_t j = 0ul; j < cols; ++j)
+          result[i * cols + j] = c(i, j);
+      return result;
+    }
+
+  public:
+
+    /// Constructor
+
+    /// \param max_subspace The largest subspace size, which must be at
+    /// least twice the number of roots [default = 40]
+    /// \param max_iter The largest number of iterations [default = 100]
+    /// \param tolerance The convergence threshold of the residual 2-norms
+    /// [default = 1e-6]
+    /// \param jacobi_davidson Use the Jacobi-Davidson correction
+    /// [default = false]
+    /// \param linear_dependence The threshold of the overlap eigenvalues of
+    /// new vectors, relative to the largest one, below which directions are
+    /// dropped [default = 1e-10]
+    explicit DavidsonSolver(const unsigned int max_subspace = 40u,
+        const unsigned int max_iter = 100u, const value_type tolerance = 1e-6,
+        const bool jacobi_davidson = false,
+        const value_type linear_dependence = 1e-10) :
+      max_subspace_(max_subspace), max_iter_(max_iter), tolerance_(tolerance),
+      jacobi_davidson_(jacobi_davidson), linear_dependence_(linear_dependence),
+      iterations_(0u), residual_norms_()
+    { }
+
+    /// Compute the lowest eigenpairs
+
+    /// \param sigma The sigma builder
+    /// \param preconditioner The preconditioner
+    /// \param x The guess vectors on entry, one per root; the eigenvectors
+    /// on exit
+    /// \return The eigenvalues, in ascending order
+    /// \throw TiledArray::Exception When no guess vector is given, when the
+    /// guess vectors are linearly dependent, or when the subspace is too
+    /// small for the number of roots.
+    std::vector<value_type> operator()(const sigma_type& sigma,
+        const preconditioner_type& preconditioner, std::vector<D>& x)
+    {
+      const std::size_t nroots = x.size();
+      TA_USER_ASSERT(nroots > 0ul, "DavidsonSolver: no guess vectors.");
+      TA_USER_ASSERT(max_subspace_ >= 2ul * nroots,
+          "DavidsonSolver: the subspace must hold at least twice the number of roots.");
+
+      std::vector<D> v = orthonormalize(std::vector<D>(), x);
+      TA_USER_ASSERT(v.size() == nroots,
+          "DavidsonSolver: the guess vectors are linearly dependent.");
+      std::vector<D> av(v.size());
+      sigma(v, av);
+
+      // The subspace matrix, V^T A V
+      matrix_type h(nroots, nroots);
+      {
+        const std::vector<value_type> vav = inner_products(v, av);
+        for(std::size_t i = 0ul; i < nroots; ++i)
+          for(std::size_t j = 0ul; j < nroots; ++j)
+            h(i, j) = vav[i * nroots + j];
+        h = (h + h.transpose()) * value_type(0.5);
+      }
+
+      std::vector<value_type> theta(nroots);
+      std::vector<D> ritz;
+      residual_norms_.assign(nroots, value_type(0));
+      for(iterations_ = 1u; iterations_ <= max_iter_; ++iterations_) {
+        const std::size_t nv = v.size();
+        Eigen::SelfAdjointEigenSolver<matrix_type> eig(h);
+        const matrix_type c = eig.eigenvectors().leftCols(nroots);
+        for(std::size_t j = 0ul; j < nroots; ++j)
+          theta[j] = eig.eigenvalues()(j);
+
+        // Ritz vectors X = V c, their images A X = A V c, and residuals
+        // R = A X - X theta, in one pass over [V, A V]
+        std::vector<D> vav(v);
+        vav.insert(vav.end(), av.begin(), av.end());
+        matrix_type coeffs = matrix_type::Zero(2 * nv, 3 * nroots);
+        for(std::size_t j = 0ul; j < nroots; ++j) {
+          coeffs.block(0, j, nv, 1) = c.col(j);
+          coeffs.block(nv, nroots + j, nv, 1) = c.col(j);
+          coeffs.block(0, 2 * nroots + j, nv, 1) = - theta[j] * c.col(j);
+          coeffs.block(nv, 2 * nroots + j, nv, 1) = c.col(j);
+        }
+        std::vector<D> xaxr =
+            linear_combinations(vav, to_vector(coeffs), 3 * nroots);
+        ritz.assign(xaxr.begin(), xaxr.begin() + nroots);
+        std::vector<D> aritz(xaxr.begin() + nroots, xaxr.begin() + 2 * nroots);
+        std::vector<D> r(xaxr.begin() + 2 * nroots, xaxr.end());
+
+        const std::vector<value_type> rr = inner_products(r, r);
+        std::vector<value_type> shift;
+        std::vector<D> t, tx;
+        for(std::size_t j = 0ul; j < nroots; ++j) {
+          residual_norms_[j] = std::sqrt(std::abs(rr[j * nroots + j]));
+          if(residual_norms_[j] > tolerance_) {
+            shift.push_back(theta[j]);
+            t.push_back(r[j]);
+            tx.push_back(ritz[j]);
+          }
+        }
+        if(t.empty()) {
+          x = ritz;
+          return theta;
+        }
+
+        // Correction vectors
+        if(jacobi_davidson_) {
+          const std::size_t nt = t.size();
+          std::vector<value_type> shifts(shift);
+          shifts.insert(shifts.end(), shift.begin(), shift.end());
+          // The preconditioner may modify the tiles of its arguments, which
+          // are shared with the Ritz vectors
+          std::vector<D> mt(t);
+          for(const D& ritz_j : tx)
+            mt.push_back(ritz_j.clone());
+          preconditioner(shifts, mt);
+          const std::vector<value_type> xm = inner_products(tx, mt);
+          std::vector<value_type> tc(2 * nt * nt, value_type(0));
+          for(std::size_t j = 0ul; j < nt; ++j) {
+            const value_type xmx = xm[j * 2 * nt + nt + j];
+            tc[j * nt + j] = 1;
+            if(xmx != value_type(0))
+              tc[(nt + j) * nt + j] = - xm[j * 2 * nt + j] / xmx;
+          }
+          t = linear_combinations(mt, tc, nt);
+        } else {
+          preconditioner(shift, t);
+        }
+
+        // Collapse the subspace to the Ritz vectors when it is full
+        if(nv + t.size() > max_subspace_) {
+          v = ritz;
+          av = aritz;
+          h = matrix_type::Zero(nroots, nroots);
+          for(std::size_t j = 0ul; j < nroots; ++j)
+            h(j, j) = theta[j];
+        }
+
+        std::vector<D> n = orthonormalize(v, t);
+        if(n.empty()) {
+          // The corrections are in the subspace; no progress is possible
+          x = ritz;
+          return theta;
+        }
+        std::vector<D> an(n.size());
+        sigma(n, an);
+
+        // Extend the subspace matrix with <[V, N] | A N> in one reduction
+        const std::size_t nv_old = v.size(), nn = n.size();
+        v.insert(v.end(), n.begin(), n.end());
+        av.insert(av.end(), an.begin(), an.end());
+        const std::vector<value_type> van = inner_products(v, an);
+        matrix_type hn(nv_old + nn, nv_old + nn);
+        hn.topLeftCorner(nv_old, nv_old) = h;
+        for(std::size_t i = 0ul; i < nv_old + nn; ++i)
+          for(std::size_t j = 0ul; j < nn; ++j) {
+            hn(i, nv_old + j) = van[i * nn + j];
+            if(i < nv_old)
+              hn(nv_old + j, i) = van[i * nn + j];
+          }
+        hn.bottomRightCorner(nn, nn) = (hn.bottomRightCorner(nn, nn) +
+            hn.bottomRightCorner(nn, nn).transpose().eval()) * value_type(0.5);
+        h = hn;
+      }
+
+      x = ritz;
+      iterations_ = max_iter_;
+      if(x.front().world().rank() == 0)
+        std::cout << "WARNING: DavidsonSolver did not converge in "
+                  << max_iter_ << " iterations" << std::endl;
+      return theta;
+    }
+
+    /// \return The number of iterations of the last solve
+    unsigned int iterations() const { return iterations_; }
+
+    /// \return The residual 2-norms of the roots at the last iteration
+    const std::vector<value_type>& residual_norms() const {
+      return residual_norms_;
+    }
+
+  }; // class DavidsonSolver
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_ALGEBRA_DAVIDSON_H__INCLUDED
@@ -29,10 +29,219 @@
 #include <deque>
 #include <TiledArray/math/eigen.h>
 #include <TiledArray/algebra/utils.h>
+#include <TiledArray/conversions/to_new_tile_type.h>
+#include <TiledArray/tile_spill.h>
 #include "../dist_array.h"
 
 namespace TiledArray {
 
+  /// Storage of DIIS history vectors
+  enum class DIISStorage {
+    full,    ///< Vectors are held in memory
+    reduced, ///< Vectors are held in memory in single precision
+    spill    ///< Vectors are held in arrays whose tiles are spilled to disk
+  }; // enum class DIISStorage
+
+  namespace detail {
+
+    /// Single precision array type of DIIS history vectors
+
+    /// \tparam D The vector type
+    template <typename D>
+    struct diis_reduced_array { typedef D type; };
+
+    template <typename A, typename Policy>
+    struct diis_reduced_array<DistArray<Tensor<double, A>, Policy> > {
+      typedef DistArray<Tensor<float>, Policy> type;
+    };
+
+    template <typename A, typename Policy>
+    struct diis_reduced_array<DistArray<Tensor<std::complex<double>, A>, Policy> > {
+      typedef DistArray<Tensor<std::complex<float> >, Policy> type;
+    };
+
+    /// History of DIIS vectors
+
+    /// The vectors are stored as given (\c DIISStorage::full ), converted to
+    /// single precision (\c DIISStorage::reduced ), or copied into arrays
+    /// whose local tiles are spilled to disk beyond a working-set limit
+    /// (\c DIISStorage::spill ). Stored vectors are only used in dot
+    /// products and linear combinations, which convert or read their tiles
+    /// one at a time, in tasks, so stored vectors are never restored.
+    /// \tparam D The vector type
+    template <typename D>
+    class DIISHistory {
+    public:
+      typedef typename D::value_type tile_type; ///< The tile type
+      typedef typename D::element_type element_type; ///< The element type
+      typedef typename diis_reduced_array<D>::type reduced_type;
+          ///< The single precision vector type
+      typedef typename reduced_type::value_type reduced_tile_type;
+          ///< The single precision tile type
+
+      /// \c true if vectors of type \c D can be stored in single precision
+      static constexpr bool has_reduced = ! std::is_same<reduced_type, D>::value;
+
+    private:
+      DIISStorage storage_; ///< The storage of the vectors
+      std::string directory_; ///< The spill directory
+      std::size_t max_bytes_; ///< The spill working-set limit
+      std::deque<D> full_; ///< Vectors held as given or spilled
+      std::deque<reduced_type> reduced_; ///< Vectors held in single precision
+
+      /// \return A copy of \c x whose local tiles are spilled to disk
+      D spilled(const D& x) const {
+        D result(x.world(), x.trange(), x.shape(), x.pmap());
+        result.spill(directory_, max_bytes_);
+        for(const auto index : *x.pmap()) {
+          if(! x.is_zero(index))
+            result.set(index, x.world().taskq.add(
+                [] (const tile_type& tile) { return tile.clone(); }, x.find(index)));
+        }
+        return result;
+      }
+
+      reduced_type reduce(const D& x, std::true_type) const {
+        return to_new_tile_type(x,
+            [] (const tile_type& tile) { return reduced_tile_type(tile); });
+      }
+
+      reduced_type reduce(const D& x, std::false_type) const { return x; }
+
+      /// \return Copies of the \c n vectors of \c vectors starting at \c first
+      template <typename Array>
+      static std::vector<Array> range(const std::deque<Array>& vectors,
+          const std::size_t first, const std::size_t n)
+      {
+        TA_ASSERT(first + n <= vectors.size());
+        return std::vector<Array>(vectors.begin() + first,
+            vectors.begin() + first + n);
+      }
+
+    public:
+
+      DIISHistory() :
+        storage_(DIISStorage::full), directory_(), max_bytes_(0ul),
+        full_(), reduced_()
+      { }
+
+      /// Select the storage of the vectors
+
+      /// \param storage The storage of the vectors
+      /// \param directory The spill directory
+      /// \param max_bytes The working-set limit of the local tiles of each
+      /// spilled vector
+      /// \throw TiledArray::Exception When vectors are already stored, when
+      /// single precision storage is selected for a vector type that has
+      /// no single precision type, or when no spill directory is given.
+      void storage(const DIISStorage storage, const std::string& directory,
+          const std::size_t max_bytes)
+      {
+        TA_USER_ASSERT(size() == 0ul,
+            "DIIS: the history storage must be selected before the first extrapolation.");
+        TA_USER_ASSERT(storage != DIISStorage::reduced || has_reduced,
+            "DIIS: single precision storage requires double precision Tensor tiles.");
+        TA_USER_ASSERT(storage != DIISStorage::spill || ! directory.empty(),
+            "DIIS: spilled storage requires a spill directory.");
+        storage_ = storage;
+        directory_ = directory;
+        max_bytes_ = max_bytes;
+      }
+
+      /// \return The storage of the vectors
+      DIISStorage storage() const { return storage_; }
+
+      /// \return The number of stored vectors
+      std::size_t size() const { return full_.size() + reduced_.size(); }
+
+      /// \return \c true if no vectors are stored
+      bool empty() const { return size() == 0ul; }
+
+      void push_back(const D& x) {
+        switch(storage_) {
+          case DIISStorage::full: full_.push_back(x); break;
+          case DIISStorage::spill: full_.push_back(spilled(x)); break;
+          case DIISStorage::reduced:
+            reduced_.push_back(reduce(x, std::integral_constant<bool, has_reduced>()));
+            break;
+        }
+      }
+
+      void push_front(const D& x) {
+        switch(storage_) {
+          case DIISStorage::full: full_.push_front(x); break;
+          case DIISStorage::spill: full_.push_front(spilled(x)); break;
+          case DIISStorage::reduced:
+            reduced_.push_front(reduce(x, std::integral_constant<bool, has_reduced>()));
+            break;
+        }
+      }
+
+      void pop_front() {
+        if(storage_ == DIISStorage::reduced)
+          reduced_.pop_front();
+        else
+          full_.pop_front();
+      }
+
+      void clear() {
+        full_.clear();
+        reduced_.clear();
+      }
+
+      /// Linear combination of stored vectors
+
+      /// The combination reads each stored vector once; see
+      /// \c TiledArray::linear_combination() .
+      /// \param[out] y The combination, <tt>y = sum_k c[k] * v[first + k]</tt>
+      /// <tt>+ sum_k c_other[k] * other.v[first + k]</tt>
+      /// \param c The coefficients of the vectors of this history
+      /// \param first The index of the first combined vector
+      /// \param other Another history with the same storage, or null
+      /// \param c_other The coefficients of the vectors of \c other
+      void linear_combination(D& y, const std::vector<element_type>& c,
+          const std::size_t first, const DIISHistory* other = nullptr,
+          const std::vector<element_type>& c_other = std::vector<element_type>()) const
+      {
+        TA_ASSERT(! other || (other->storage_ == storage_));
+        std::vector<element_type> coefficients(c);
+        if(other)
+          coefficients.insert(coefficients.end(), c_other.begin(), c_other.end());
+
+        if(storage_ == DIISStorage::reduced) {
+          std::vector<reduced_type> vectors = range(reduced_, first, c.size());
+          if(other) {
+            const std::vector<reduced_type> others =
+                range(other->reduced_, first, c_other.size());
+            vectors.insert(vectors.end(), others.begin(), others.end());
+          }
+          TiledArray::linear_combination(vectors.begin(), vectors.end(),
+              coefficients, y);
+        } else {
+          std::vector<D> vectors = range(full_, first, c.size());
+          if(other) {
+            const std::vector<D> others = range(other->full_, first, c_other.size());
+            vectors.insert(vectors.end(), others.begin(), others.end());
+          }
+          TiledArray::linear_combination(vectors.begin(), vectors.end(),
+              coefficients, y);
+        }
+      }
+
+      /// Dot products of the stored vectors with \c w
+
+      /// \param w The common vector
+      /// \return The dot products, with one collective reduction
+      std::vector<element_type> dot_products(const D& w) const {
+        if(storage_ == DIISStorage::reduced)
+          return TiledArray::dot_products(reduced_.begin(), reduced_.end(), w);
+        return TiledArray::dot_products(full_.begin(), full_.end(), w);
+      }
+
+    }; // class DIISHistory
+
+  } // namespace detail
+
   /// DIIS (``direct inversion of iterative subspace'') extrapolation
 
   /// The DIIS class provides DIIS extrapolation to an iterative solver of
@@ -76,6 +285,10 @@ namespace TiledArray {
   ///
   /// The original DIIS reference: P. Pulay, Chem. Phys. Lett. 73, 393 (1980).
   ///
+  /// DIIS keeps \c ndiis vectors and errors, which may be stored in single
+  /// precision or spilled to disk to reduce the memory footprint of large
+  /// subspaces; see \c set_storage().
+  ///
   /// \tparam D type of \c x
   template <typename D>
   class DIIS {
@@ -124,6 +337,31 @@ namespace TiledArray {
         x_extrap_.clear();
       }
 
+      /// Select the storage of the history vectors
+
+      /// The stored vectors and errors are only used in dot products and
+      /// axpy operations during extrapolation. In single precision storage
+      /// (\c DIISStorage::reduced ) they take half of the memory, and their
+      /// tiles are converted back to double precision one at a time; the
+      /// extrapolation coefficients then carry single precision errors. In
+      /// spilled storage (\c DIISStorage::spill ) they are copied into
+      /// arrays whose local tiles are written to files in \c directory once
+      /// they exceed \c max_bytes per vector, and are read back tile by tile
+      /// when they are used. This must be called before the first call to
+      /// \c extrapolate() .
+      /// \param storage The storage of the history vectors
+      /// \param directory The spill directory [ default = \c TA_SPILL_DIR ]
+      /// \param max_bytes The working-set limit of the local tiles of each
+      /// spilled vector [ default = \c TA_SPILL_MAX_BYTES ]
+      void set_storage(const DIISStorage storage,
+          const std::string& directory = detail::spill_directory(),
+          const std::size_t max_bytes = detail::spill_max_bytes())
+      {
+        x_.storage(storage, directory, max_bytes);
+        errors_.storage(storage, directory, max_bytes);
+        x_extrap_.storage(storage, directory, max_bytes);
+      }
+
       /// \param[in,out] x On input, the most recent solution guess; on output,
       ///   the extrapolated guess
       /// \param[in,out] error On input, the most recent error; on output, the
@@ -160,16 +398,17 @@ namespace TiledArray {
         TA_USER_ASSERT(x_.size() == errors_.size(),
                        "DIIS: numbers of guess and error vectors do not match, likely due to a programming error");
 
-        // and compute the most recent elements of B, B(i,j) = <ei|ej>
-        for (unsigned int i=0; i < nvec-1; i++)
-          B_(i,nvec-1) = B_(nvec-1,i) = dot_product(errors_[i], errors_[nvec-1]);
-        B_(nvec-1,nvec-1) = dot_product(errors_[nvec-1], errors_[nvec-1]);
+        // and compute the most recent elements of B, B(i,j) = <ei|ej>; the
+        // other elements are kept from the previous iterations, and the new
+        // row is computed with a single reduction
+        const auto Brow = errors_.dot_products(error);
+        for (unsigned int i=0; i < nvec; i++)
+          B_(i,nvec-1) = B_(nvec-1,i) = Brow[i];
 
         if (iter == 1) { // the first iteration
           if (not x_extrap_.empty() && do_mixing) {
-            zero(x);
-            axpy(x, (1.0-mixing_fraction), x_[0]);
-            axpy(x, mixing_fraction, x_extrap_[0]);
+            x_.linear_combination(x, {value_type(1.0-mixing_fraction)}, 0,
+                                  &x_extrap_, {value_type(mixing_fraction)});
           }
         }
         else if (iter > start && (((iter - start) % ngroup) < ngroupdiis)) { // not the first iteration and need to extrapolate?
@@ -232,18 +471,32 @@ namespace TiledArray {
           --nskip; // undo the last ++ :-(
 
           {
-
-            zero(x);
-            for (unsigned int k=nskip, kk=1; k < nvec; ++k, ++kk) {
-              if (not do_mixing || x_extrap_.empty()) {
-                //std::cout << "contrib " << k << " c=" << c[kk] << ":" << std::endl << x_[k] << std::endl;
-                axpy(x, c[kk], x_[k]);
-                if (extrapolate_error)
-                  axpy(error, c[kk], errors_[k]);
-              } else {
-                axpy(x, c[kk] * (1.0 - mixing_fraction), x_[k]);
-                axpy(x, c[kk] * mixing_fraction, x_extrap_[k]);
+            // the extrapolated vectors are computed in one pass over the
+            // stored vectors
+            std::vector<value_type> cx(nvec - nskip);
+            for (unsigned int kk=1; kk <= cx.size(); ++kk)
+              cx[kk-1] = c[kk];
+            if (not do_mixing || x_extrap_.empty()) {
+              x_.linear_combination(x, cx, nskip);
+              if (extrapolate_error) {
+                // the combination is added to the input error, which is the
+                // most recent stored error; a stored error of reduced
+                // precision is not used in its place
+                if (errors_.storage() == DIISStorage::reduced) {
+                  const D e = error;
+                  errors_.linear_combination(error, cx, nskip);
+                  axpy(error, value_type(1), e);
+                } else {
+                  std::vector<value_type> ce(cx);
+                  ce.back() += value_type(1);
+                  errors_.linear_combination(error, ce, nskip);
+                }
               }
+            } else {
+              std::vector<value_type> cxe(cx);
+              for (auto& ck : cx) ck *= (1.0 - mixing_fraction);
+              for (auto& ck : cxe) ck *= mixing_fraction;
+              x_.linear_combination(x, cx, nskip, &x_extrap_, cxe);
             }
           }
         } // do DIIS
@@ -284,9 +537,9 @@ namespace TiledArray {
 
       EigenMatrixX B_; //!< B(i,j) = <ei|ej>
 
-      std::deque<D> x_; //!< set of most recent x given as input (i.e. not exrapolated)
-      std::deque<D> errors_; //!< set of most recent errors
-      std::deque<D> x_extrap_; //!< set of most recent extrapolated x
+      detail::DIISHistory<D> x_; //!< set of most recent x given as input (i.e. not exrapolated)
+      detail::DIISHistory<D> errors_; //!< set of most recent errors
+      detail::DIISHistory<D> x_extrap_; //!< set of most recent extrapolated x
 
       void set_error(scalar_type e) { error_ = e; errorset_ = true; }
       scalar_type error() { return error_; }
@@ -0,0 +1,316 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  orthogonalize.h
+ *  Mar 21, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_ALGEBRA_ORTHOGONALIZE_H__INCLUDED
+#define TILEDARRAY_ALGEBRA_ORTHOGONALIZE_H__INCLUDED
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <TiledArray/conversions/eigen.h>
+#include <TiledArray/algebra/utils.h>
+#include <TiledArray/reduce_task.h>
+#include "../dist_array.h"
+
+namespace TiledArray {
+
+  namespace detail {
+
+    /// Gram matrix reduction of the tile rows of a tall-skinny matrix
+
+    /// Each argument holds the tiles of one tile row; the result is the
+    /// dense <tt>n x n</tt> matrix <tt>A^H A</tt> of the reduced rows.
+    /// \tparam Tile The tile type, a row-major \c Tensor
+    template <typename Tile>
+    class GramReduction {
+    public:
+      typedef typename Tile::value_type value_type; ///< The element type
+      typedef Eigen::Matrix<value_type, Eigen::Dynamic, Eigen::Dynamic>
+          result_type; ///< The Gram matrix type
+      typedef std::vector<Tile> argument_type; ///< The tiles of one tile row
+
+    private:
+      std::vector<std::size_t> offset_; ///< The first column of each column tile
+      std::size_t n_; ///< The number of columns
+
+    public:
+
+      /// Constructor
+
+      /// \param offset The first column of each column tile, relative to
+      /// the first column of the matrix
+      /// \param n The number of columns
+      GramReduction(const std::vector<std::size_t>& offset, const std::size_t n) :
+        offset_(offset), n_(n)
+      { }
+
+      result_type operator()() const { return result_type::Zero(n_, n_); }
+
+      const result_type& operator()(const result_type& result) const {
+        return result;
+      }
+
+      void operator()(result_type& result, const result_type& arg) const {
+        result += arg;
+      }
+
+      void operator()(result_type& result, const argument_type& row) const {
+        for(std::size_t c1 = 0ul; c1 < row.size(); ++c1) {
+          const Tile& left = row[c1];
+          const std::size_t m = left.range().extent_data()[0];
+          const std::size_t n1 = left.range().extent_data()[1];
+          for(std::size_t c2 = c1; c2 < row.size(); ++c2) {
+            const Tile& right = row[c2];
+            const std::size_t n2 = right.range().extent_data()[1];
+            auto block = result.block(offset_[c1], offset_[c2], n1, n2);
+            block.noalias() += eigen_map(left, m, n1).adjoint() *
+                eigen_map(right, m, n2);
+            if(c2 != c1)
+              result.block(offset_[c2], offset_[c1], n2, n1) = block.adjoint();
+          }
+        }
+      }
+
+    }; // class GramReduction
+
+    /// The first column of each column tile of a matrix
+
+    /// \param trange The tiled range of the matrix
+    /// \return The offsets of the column tiles, relative to the first column
+    inline std::vector<std::size_t> column_offsets(const TiledRange& trange) {
+      const TiledRange1& cols = trange.data()[1];
+      std::vector<std::size_t> offset;
+      for(auto c = cols.tiles_range().first; c != cols.tiles_range().second; ++c)
+        offset.push_back(cols.tile(c).first - cols.elements_range().first);
+      return offset;
+    }
+
+    /// The futures of the tiles of one tile row of a matrix
+
+    /// \param a The matrix
+    /// \param r The tile row index
+    /// \return The tiles of row \c r , in column order
+    template <typename Tile, typename Policy>
+    inline std::vector<Future<Tile> >
+    tile_row(const DistArray<Tile,Policy>& a, const std::size_t r) {
+      const TiledRange1& cols = a.trange().data()[1];
+      std::vector<Future<Tile> > row;
+      for(auto c = cols.tiles_range().first; c != cols.tiles_range().second; ++c)
+        row.push_back(a.find(a.trange().tiles_range().ordinal(r, c)));
+      return row;
+    }
+
+    /// Gram matrix of a tall-skinny matrix
+
+    /// The Gram matrix of each local tile row is accumulated in a local
+    /// reduction task, and the local results are summed over all processes.
+    /// A tile row is reduced by the owner of its first tile. This function
+    /// is collective.
+    /// \param a The matrix
+    /// \return The Gram matrix, <tt>A^H A</tt>
+    template <typename Tile, typename Policy>
+    inline typename GramReduction<Tile>::result_type
+    gram_matrix(const DistArray<Tile,Policy>& a) {
+      const TiledRange& trange = a.trange();
+      const TiledRange1& rows = trange.data()[0];
+      const TiledRange1& cols = trange.data()[1];
+      GramReduction<Tile> op(column_offsets(trange), cols.extent());
+      ReduceTask<GramReduction<Tile> > reduce_task(a.world(), op);
+      for(auto r = rows.tiles_range().first; r != rows.tiles_range().second; ++r) {
+        if(! a.is_local(trange.tiles_range().ordinal(r, cols.tiles_range().first)))
+          continue;
+        reduce_task.add(a.world().taskq.add(
+            [] (const std::vector<Future<Tile> >& row) {
+              std::vector<Tile> result;
+              result.reserve(row.size());
+              for(const Future<Tile>& tile : row)
+                result.push_back(tile.get());
+              return result;
+            }, tile_row(a, r)));
+      }
+
+      typename GramReduction<Tile>::result_type g = reduce_task.submit().get();
+      a.world().gop.sum(g.data(), g.size());
+      return g;
+    }
+
+    /// Upper triangular Cholesky factor of a Gram matrix
+
+    /// When \c g is not numerically positive definite, a diagonal shift
+    /// proportional to its trace and to the unit roundoff is added, as in
+    /// shifted Cholesky QR.
+    /// \param g The Gram matrix of an <tt>m x n</tt> matrix
+    /// \param m The number of rows of the matrix
+    /// \param[out] shifted \c true if the Gram matrix was shifted
+    /// \return \c R , where <tt>g = R^H R</tt>
+    template <typename Matrix>
+    inline Matrix cholesky_factor(Matrix g, const std::size_t m, bool& shifted) {
+      typedef typename Matrix::RealScalar real_type;
+      Eigen::LLT<Matrix> llt(g);
+      shifted = (llt.info() != Eigen::Success);
+      if(shifted) {
+        const std::size_t n = g.rows();
+        const real_type shift = real_type(11) * real_type(m * n + n * (n + 1)) *
+            std::numeric_limits<real_type>::epsilon() * std::abs(g.trace());
+        g.diagonal().array() += shift;
+        llt.compute(g);
+        TA_USER_ASSERT(llt.info() == Eigen::Success,
+            "cholesky_qr2: the matrix columns are not linearly independent.");
+      }
+      return llt.matrixU();
+    }
+
+    /// Multiply a tall-skinny matrix by the inverse of a triangular factor
+
+    /// Each local tile of the result is computed from the tile row of \c a
+    /// by one task.
+    /// \param a The matrix
+    /// \param r The upper triangular factor
+    /// \return <tt>A R^-1</tt>
+    template <typename T, typename A, typename Matrix>
+    inline DistArray<Tensor<T,A>, DensePolicy>
+    multiply_inverse(const DistArray<Tensor<T,A>, DensePolicy>& a, const Matrix& r) {
+      typedef Tensor<T,A> tile_type;
+      const std::size_t n = r.rows();
+      const Matrix r_inv = r.template triangularView<Eigen::Upper>().solve(
+          Matrix::Identity(n, n));
+      const std::vector<std::size_t> offset = column_offsets(a.trange());
+
+      DistArray<tile_type, DensePolicy> q(a.world(), a.trange(), a.pmap());
+      const TiledRange1& cols = a.trange().data()[1];
+      const auto first_col = cols.tiles_range().first;
+      for(const auto index : *a.pmap()) {
+        const auto idx = a.trange().tiles_range().idx(index);
+        const std::size_t c = idx[1] - first_col;
+        q.set(index, a.world().taskq.add(
+            [r_inv, offset, c] (const Range& range,
+                const std::vector<Future<tile_type> >& row)
+            {
+              tile_type result(range, T(0));
+              const std::size_t m = range.extent_data()[0];
+              const std::size_t nc = range.extent_data()[1];
+              auto q_block = eigen_map(result, m, nc);
+              for(std::size_t k = 0ul; k <= c; ++k) {
+                const tile_type& tile = row[k].get();
+                const std::size_t nk = tile.range().extent_data()[1];
+                q_block.noalias() += eigen_map(tile, m, nk) *
+                    r_inv.block(offset[k], offset[c], nk, nc);
+              }
+              return result;
+            }, a.trange().make_tile_range(index), tile_row(a, idx[0])));
+      }
+      return q;
+    }
+
+  }  // namespace detail
+
+  /// Cholesky QR2 factorization of a tall-skinny matrix
+
+  /// The matrix is factorized as <tt>A = Q R</tt>, where \c Q has
+  /// orthonormal columns and \c R is upper triangular, without gathering
+  /// \c A on one process: each pass computes the Gram matrix
+  /// <tt>A^H A</tt> with a local reduction over the tile rows and one
+  /// reduction over the processes, factorizes it redundantly on every
+  /// process, and forms <tt>A R^-1</tt> tile by tile. Two passes give \c Q
+  /// orthonormal to working precision when \c A is not too ill-conditioned;
+  /// when the Gram matrix is not positive definite, the first pass is
+  /// shifted and a third pass is made (shifted Cholesky QR3). The columns of
+  /// \c A should fit in a small dense matrix.
+  /// \param a A dense matrix with more rows than columns
+  /// \param[out] r The triangular factor, or \c nullptr
+  /// \return The orthonormal factor \c Q , with the distribution of \c a
+  /// \throw TiledArray::Exception When \c a is not a matrix, or when its
+  /// columns are linearly dependent.
+  template <typename T, typename A>
+  inline DistArray<Tensor<T,A>, DensePolicy>
+  cholesky_qr2(const DistArray<Tensor<T,A>, DensePolicy>& a,
+      Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>* r = nullptr)
+  {
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrix_type;
+    TA_USER_ASSERT(a.trange().tiles_range().rank() == 2u,
+        "cholesky_qr2: the array must be a matrix.");
+    const std::size_t m = a.trange().data()[0].extent();
+
+    bool shifted = false;
+    matrix_type r_total = detail::cholesky_factor(detail::gram_matrix(a), m, shifted);
+    DistArray<Tensor<T,A>, DensePolicy> q = detail::multiply_inverse(a, r_total);
+    for(unsigned int pass = (shifted ? 0u : 1u); pass < 2u; ++pass) {
+      bool unused = false;
+      const matrix_type r_pass =
+          detail::cholesky_factor(detail::gram_matrix(q), m, unused);
+      q = detail::multiply_inverse(q, r_pass);
+      r_total = (r_pass * r_total).eval();
+    }
+
+    if(r)
+      *r = r_total.template triangularView<Eigen::Upper>();
+    return q;
+  }
+
+  /// Orthonormalize a set of arrays
+
+  /// The arrays are orthonormalized with Cholesky QR2, as in
+  /// \c cholesky_qr2(), where the Gram matrix of each pass is computed with
+  /// \c inner_products() and the new arrays with \c linear_combinations() ,
+  /// so each pass costs one reduction over the processes and one task per
+  /// tile. The arrays may have any tile type and shape, and must have real
+  /// elements.
+  /// \param v The arrays, which must have the same tiled range
+  /// \return Orthonormal arrays that span the arrays of \c v , in the same
+  /// order, i.e. the \c Q factor of \c v
+  /// \throw TiledArray::Exception When the arrays are linearly dependent.
+  template <typename Tile, typename Policy>
+  inline std::vector<DistArray<Tile,Policy> >
+  orthonormalize(const std::vector<DistArray<Tile,Policy> >& v) {
+    typedef typename DistArray<Tile,Policy>::element_type element_type;
+    typedef Eigen::Matrix<element_type, Eigen::Dynamic, Eigen::Dynamic> matrix_type;
+    if(v.empty())
+      return v;
+    const std::size_t n = v.size();
+    const std::size_t m = v.front().trange().elements_range().volume();
+
+    std::vector<DistArray<Tile,Policy> > q = v;
+    bool shifted = false;
+    for(unsigned int pass = 0u; pass < (shifted ? 3u : 2u); ++pass) {
+      const std::vector<element_type> products = inner_products(q, q);
+      matrix_type g(n, n);
+      for(std::size_t i = 0ul; i < n; ++i)
+        for(std::size_t j = 0ul; j < n; ++j)
+          g(i, j) = products[i * n + j];
+      bool pass_shifted = false;
+      const matrix_type r = detail::cholesky_factor(g, m, pass_shifted);
+      shifted = shifted || pass_shifted;
+      const matrix_type r_inv = r.template triangularView<Eigen::Upper>().solve(
+          matrix_type::Identity(n, n));
+      std::vector<element_type> c(n * n);
+      for(std::size_t i = 0ul; i < n; ++i)
+        for(std::size_t j = 0ul; j < n; ++j)
+          c[i * n + j] = r_inv(i, j);
+      q = linear_combinations(q, c, n);
+    }
+
+    return q;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_ALGEBRA_ORTHOGONALIZE_H__INCLUDED
@@ -26,7 +26,13 @@
 #ifndef TILEDARRAY_ALGEBRA_UTILS_H__INCLUDED
 #define TILEDARRAY_ALGEBRA_UTILS_H__INCLUDED
 
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <iterator>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "../dist_array.h"
 #include "../expressions/expr.h"
@@ -43,6 +49,24 @@ namespace TiledArray {
       return oss.str();
     }
 
+    /// Dot products of one tile with a set of tiles
+
+    /// \param w The tile of the common vector
+    /// \param v The tiles of the other vectors, which are converted to the
+    /// type of \c w ; empty tiles are zero
+    /// \return The dot products of the tiles of \c v with \c w
+    template <typename Result, typename Tile, typename VTile>
+    inline std::vector<Result>
+    tile_dot_products(const Tile& w, const std::vector<Future<VTile> >& v) {
+      std::vector<Result> result(v.size(), Result(0));
+      for(std::size_t k = 0ul; k < v.size(); ++k) {
+        const VTile& tile = v[k].get();
+        if(! tile.empty())
+          result[k] = dot(Tile(tile), w);
+      }
+      return result;
+    }
+
   } // namespace detail
 
   template <typename Tile, typename Policy>
@@ -91,6 +115,365 @@ namespace TiledArray {
     return a1(vars).dot(a2(vars)).get();
   }
 
+  /// Dot products of a set of arrays with one array
+
+  /// This computes the dot products of each array in [\c first, \c last )
+  /// with \c w in one pass over the local tiles of \c w , with one task per
+  /// tile, and one vector-valued reduction over the processes, instead of
+  /// one reduction per product. The arrays must have the tiled range of
+  /// \c w ; tiles of other distributions are fetched from their owners, and
+  /// tiles of another type, e.g. of lower precision, are converted to the
+  /// tile type of \c w . This function is collective.
+  /// \tparam Iterator An input iterator over \c DistArray objects
+  /// \param first The first array
+  /// \param last The end of the arrays
+  /// \param w The common array
+  /// \return The dot products, in the order of the arrays
+  template <typename Iterator, typename Tile, typename Policy>
+  inline std::vector<typename DistArray<Tile,Policy>::element_type>
+  dot_products(Iterator first, Iterator last, const DistArray<Tile,Policy>& w) {
+    typedef typename DistArray<Tile,Policy>::element_type result_type;
+    typedef typename std::iterator_traits<Iterator>::value_type array_type;
+    typedef typename array_type::value_type value_type;
+
+    const std::vector<const array_type*> arrays = [&] () {
+      std::vector<const array_type*> arrays;
+      for(; first != last; ++first) {
+        TA_USER_ASSERT(first->trange() == w.trange(),
+            "dot_products: the arrays must have the same tiled range.");
+        arrays.push_back(& (*first));
+      }
+      return arrays;
+    }();
+
+    // Spawn one task for the dot products of each local tile
+    std::vector<Future<std::vector<result_type> > > partials;
+    for(const auto index : *w.pmap()) {
+      if(w.is_zero(index))
+        continue;
+      std::vector<Future<value_type> > tiles;
+      tiles.reserve(arrays.size());
+      for(const array_type* array : arrays)
+        tiles.push_back(array->is_zero(index) ? Future<value_type>(value_type()) :
+            array->find(index));
+      partials.push_back(w.world().taskq.add(
+          & detail::tile_dot_products<result_type, Tile, value_type>,
+          w.find(index), tiles));
+    }
+
+    // Sum the local products and reduce them over all processes at once
+    std::vector<result_type> result(arrays.size(), result_type(0));
+    for(Future<std::vector<result_type> >& partial : partials) {
+      const std::vector<result_type>& products = partial.get();
+      for(std::size_t k = 0ul; k < products.size(); ++k)
+        result[k] += products[k];
+    }
+    if(! result.empty())
+      w.world().gop.sum(result.data(), result.size());
+
+    return result;
+  }
+
+  /// Inner products of two sets of arrays
+
+  /// This computes the matrix of the dot products of each array of \c a
+  /// with each array of \c b in one pass over the local tiles, with one task
+  /// per tile, and one reduction over the processes. All arrays must have
+  /// the same tiled range; tiles of other distributions than \c b[0] are
+  /// fetched from their owners. This function is collective.
+  /// \param a The left-hand arrays
+  /// \param b The right-hand arrays, which must not be empty
+  /// \return The products, where element <tt>i * b.size() + j</tt> is the
+  /// dot product of \c a[i] and \c b[j]
+  template <typename Tile, typename Policy>
+  inline std::vector<typename DistArray<Tile,Policy>::element_type>
+  inner_products(const std::vector<DistArray<Tile,Policy> >& a,
+      const std::vector<DistArray<Tile,Policy> >& b)
+  {
+    typedef typename DistArray<Tile,Policy>::element_type result_type;
+    TA_USER_ASSERT(! b.empty(), "inner_products: no right-hand arrays.");
+    const DistArray<Tile,Policy>& first = b.front();
+    for(const auto& array : a)
+      TA_USER_ASSERT(array.trange() == first.trange(),
+          "inner_products: the arrays must have the same tiled range.");
+    for(const auto& array : b)
+      TA_USER_ASSERT(array.trange() == first.trange(),
+          "inner_products: the arrays must have the same tiled range.");
+
+    const std::size_t na = a.size(), nb = b.size();
+    const auto tile = [] (const DistArray<Tile,Policy>& array, const std::size_t index) {
+      return (array.is_zero(index) ? Future<Tile>(Tile()) : array.find(index));
+    };
+
+    // Spawn one task for the products of each local tile
+    std::vector<Future<std::vector<result_type> > > partials;
+    for(const auto index : *first.pmap()) {
+      std::vector<Future<Tile> > a_tiles, b_tiles;
+      a_tiles.reserve(na);
+      b_tiles.reserve(nb);
+      for(const auto& array : a)
+        a_tiles.push_back(tile(array, index));
+      for(const auto& array : b)
+        b_tiles.push_back(tile(array, index));
+      partials.push_back(first.world().taskq.add(
+          [na, nb] (const std::vector<Future<Tile> >& a_tiles,
+              const std::vector<Future<Tile> >& b_tiles)
+          {
+            std::vector<result_type> result(na * nb, result_type(0));
+            for(std::size_t i = 0ul; i < na; ++i) {
+              const Tile& left = a_tiles[i].get();
+              if(left.empty())
+                continue;
+              for(std::size_t j = 0ul; j < nb; ++j) {
+                const Tile& right = b_tiles[j].get();
+                if(! right.empty())
+                  result[i * nb + j] = dot(left, right);
+              }
+            }
+            return result;
+          }, a_tiles, b_tiles));
+    }
+
+    // Sum the local products and reduce them over all processes at once
+    std::vector<result_type> result(na * nb, result_type(0));
+    for(Future<std::vector<result_type> >& partial : partials) {
+      const std::vector<result_type>& products = partial.get();
+      for(std::size_t k = 0ul; k < products.size(); ++k)
+        result[k] += products[k];
+    }
+    if(! result.empty())
+      first.world().gop.sum(result.data(), result.size());
+
+    return result;
+  }
+
+  /// Linear combinations of a set of arrays
+
+  /// This computes <tt>y[j] = sum_i c[i * ny + j] * x[i]</tt> for all \c j in
+  /// one pass over the local tiles, with one task per tile, instead of one
+  /// expression per term. The shape of \c y[j] is the sum of the shapes of
+  /// \c x[i] scaled by the coefficients. All arrays of \c x must have the
+  /// same tiled range; tiles of other distributions than \c x[0] are
+  /// fetched from their owners. This function is collective.
+  /// \param x The arrays, which must not be empty
+  /// \param c The coefficients, a row-major <tt>x.size()</tt> by \c ny matrix
+  /// \param ny The number of combinations
+  /// \return The combinations, with the distribution of \c x[0]
+  template <typename Tile, typename Policy>
+  inline std::vector<DistArray<Tile,Policy> >
+  linear_combinations(const std::vector<DistArray<Tile,Policy> >& x,
+      const std::vector<typename DistArray<Tile,Policy>::element_type>& c,
+      const std::size_t ny)
+  {
+    typedef DistArray<Tile,Policy> array_type;
+    typedef typename array_type::element_type element_type;
+    typedef typename array_type::shape_type shape_type;
+    TA_USER_ASSERT(! x.empty(), "linear_combinations: no arrays.");
+    TA_USER_ASSERT(c.size() == x.size() * ny,
+        "linear_combinations: the coefficient matrix does not match the arrays.");
+    const array_type& first = x.front();
+    for(const auto& array : x)
+      TA_USER_ASSERT(array.trange() == first.trange(),
+          "linear_combinations: the arrays must have the same tiled range.");
+    const std::size_t nx = x.size();
+
+    std::vector<array_type> y;
+    y.reserve(ny);
+    for(std::size_t j = 0ul; j < ny; ++j) {
+      shape_type shape = x[0].shape().scale(c[j]);
+      for(std::size_t i = 1ul; i < nx; ++i)
+        shape = shape.add(x[i].shape().scale(c[i * ny + j]));
+      y.emplace_back(first.world(), first.trange(), shape, first.pmap());
+    }
+
+    for(const auto index : *first.pmap()) {
+      std::vector<Future<Tile> > y_tiles;
+      std::vector<std::size_t> y_index;
+      for(std::size_t j = 0ul; j < ny; ++j) {
+        if(y[j].is_zero(index))
+          continue;
+        y_tiles.emplace_back();
+        y_index.push_back(j);
+        y[j].set(index, y_tiles.back());
+      }
+      if(y_tiles.empty())
+        continue;
+
+      std::vector<Future<Tile> > x_tiles;
+      x_tiles.reserve(nx);
+      for(const auto& array : x)
+        x_tiles.push_back(array.is_zero(index) ? Future<Tile>(Tile()) :
+            array.find(index));
+      first.world().taskq.add(
+          [c, ny, y_tiles, y_index] (const std::vector<Future<Tile> >& x_tiles) {
+            for(std::size_t k = 0ul; k < y_tiles.size(); ++k) {
+              const std::size_t j = y_index[k];
+              Tile result;
+              for(std::size_t i = 0ul; i < x_tiles.size(); ++i) {
+                const Tile& tile = x_tiles[i].get();
+                const element_type factor = c[i * ny + j];
+                if(tile.empty() || factor == element_type(0))
+                  continue;
+                if(result.empty())
+                  result = scale(tile, factor);
+                else
+                  add_to(result, tile, factor);
+              }
+              if(result.empty()) {
+                // All terms vanish, but the shape has a non-zero tile
+                for(const Future<Tile>& tile : x_tiles)
+                  if(! tile.get().empty()) {
+                    result = scale(tile.get(), element_type(0));
+                    break;
+                  }
+              }
+              Future<Tile> y_tile = y_tiles[k];
+              y_tile.set(result);
+            }
+          }, x_tiles);
+    }
+
+    return y;
+  }
+
+  namespace detail {
+
+    /// Linear combination of tiles
+
+    /// \param c The coefficients
+    /// \param x The tiles, which are converted to \c Tile ; empty tiles are
+    /// zero
+    /// \return <tt>sum_k c[k] * x[k]</tt>, or an empty tile if all tiles of
+    /// \c x are empty
+    template <typename Tile, typename T, typename VTile>
+    inline Tile tile_linear_combination(const std::vector<T>& c,
+        const std::vector<Future<VTile> >& x)
+    {
+      Tile result;
+      for(std::size_t k = 0ul; k < x.size(); ++k) {
+        const VTile& tile = x[k].get();
+        if(tile.empty())
+          continue;
+        if(result.empty())
+          result = scale(Tile(tile), c[k]);
+        else
+          add_to(result, Tile(tile), c[k]);
+      }
+      return result;
+    }
+
+    /// Linear combination of \c Tensor tiles in one pass
+
+    /// The result is computed in blocks that stay in the L1 cache, so each
+    /// tile of \c x is read once and the result is written once, instead of
+    /// once per term. Elements of other types, e.g. single precision
+    /// elements, are converted in the loop.
+    /// \sa tile_linear_combination()
+    template <typename Tile, typename T, typename U, typename B,
+        typename std::enable_if<std::is_same<Tile, Tensor<T,
+            typename Tile::allocator_type> >::value>::type* = nullptr>
+    inline Tile tile_linear_combination(const std::vector<T>& c,
+        const std::vector<Future<Tensor<U, B> > >& x)
+    {
+      constexpr std::size_t block = 512ul;
+
+      std::vector<std::pair<T, const U*> > terms;
+      terms.reserve(x.size());
+      const Tensor<U, B>* first = nullptr;
+      for(std::size_t k = 0ul; k < x.size(); ++k) {
+        const Tensor<U, B>& tile = x[k].get();
+        if(tile.empty())
+          continue;
+        if(! first)
+          first = & tile;
+        TA_ASSERT(tile.range() == first->range());
+        terms.emplace_back(c[k], tile.data());
+      }
+      if(! first)
+        return Tile();
+
+      Tile result(first->range());
+      T* MADNESS_RESTRICT const data = result.data();
+      const std::size_t volume = result.range().volume();
+      for(std::size_t i = 0ul; i < volume; i += block) {
+        const std::size_t n = std::min(block, volume - i);
+        {
+          const T factor = terms.front().first;
+          const U* MADNESS_RESTRICT const tile = terms.front().second + i;
+          for(std::size_t e = 0ul; e < n; ++e)
+            data[i + e] = factor * T(tile[e]);
+        }
+        for(std::size_t k = 1ul; k < terms.size(); ++k) {
+          const T factor = terms[k].first;
+          const U* MADNESS_RESTRICT const tile = terms[k].second + i;
+          for(std::size_t e = 0ul; e < n; ++e)
+            data[i + e] += factor * T(tile[e]);
+        }
+      }
+      return result;
+    }
+
+  } // namespace detail
+
+  /// Linear combination of a set of arrays
+
+  /// This computes <tt>y = sum_k c[k] * x[k]</tt> , where \c x[k] are the
+  /// arrays in [\c first, \c last ), with one task per local tile that
+  /// reads the tile of each array once, instead of one pass over \c y per
+  /// term. The shape of \c y is the sum of the shapes of \c x[k] scaled by
+  /// the coefficients. All arrays must have the same tiled range; tiles of
+  /// other distributions than the first array are fetched from their
+  /// owners, and tiles of another type, e.g. of lower precision, are
+  /// converted to \c Tile . This function is collective.
+  /// \tparam Iterator An input iterator over \c DistArray objects
+  /// \param first The first array
+  /// \param last The end of the arrays, which must not be empty
+  /// \param c The coefficients, one per array
+  /// \param[out] y The combination, with the distribution of the first array
+  template <typename Iterator, typename Tile, typename Policy>
+  inline void linear_combination(Iterator first, Iterator last,
+      const std::vector<typename DistArray<Tile,Policy>::element_type>& c,
+      DistArray<Tile,Policy>& y)
+  {
+    typedef typename std::iterator_traits<Iterator>::value_type array_type;
+    typedef typename array_type::value_type value_type;
+    typedef typename DistArray<Tile,Policy>::shape_type shape_type;
+
+    std::vector<const array_type*> arrays;
+    for(; first != last; ++first)
+      arrays.push_back(& (*first));
+    TA_USER_ASSERT(! arrays.empty(), "linear_combination: no arrays.");
+    TA_USER_ASSERT(c.size() == arrays.size(),
+        "linear_combination: the coefficients do not match the arrays.");
+    const array_type& front = *arrays.front();
+    for(const array_type* array : arrays)
+      TA_USER_ASSERT(array->trange() == front.trange(),
+          "linear_combination: the arrays must have the same tiled range.");
+
+    shape_type shape = front.shape().scale(c[0]);
+    for(std::size_t k = 1ul; k < arrays.size(); ++k)
+      shape = shape.add(arrays[k]->shape().scale(c[k]));
+    DistArray<Tile,Policy> result(front.world(), front.trange(), shape,
+        front.pmap());
+
+    // Spawn one task for the combination of each local tile
+    for(const auto index : *front.pmap()) {
+      if(result.is_zero(index))
+        continue;
+      std::vector<Future<value_type> > tiles;
+      tiles.reserve(arrays.size());
+      for(const array_type* array : arrays)
+        tiles.push_back(array->is_zero(index) ? Future<value_type>(value_type()) :
+            array->find(index));
+      result.set(index, front.world().taskq.add(
+          [c] (const std::vector<Future<value_type> >& tiles) {
+            return detail::tile_linear_combination<Tile>(c, tiles);
+          }, tiles));
+    }
+
+    y = result;
+  }
+
   template <typename Left, typename Right>
   inline typename TiledArray::expressions::ExprTrait<Left>::scalar_type
   dot(const TiledArray::expressions::Expr<Left>& a1,
@@ -131,6 +514,313 @@ namespace TiledArray {
     return std::sqrt(a(detail::dummy_annotation(a.trange().tiles_range().rank())).squared_norm());
   }
 
+  /// Norm of a vector estimated without reading its data
+
+  /// Vectors that carry no tile norms are reduced with \c norm2() .
+  /// \param a The vector
+  /// \return The 2-norm of \c a
+  template <typename D>
+  inline auto norm2_estimate(const D& a) -> decltype(norm2(a)) {
+    return norm2(a);
+  }
+
+  /// Norm of a sparse array estimated from its shape
+
+  /// The norm is computed from the tile norms of the shape of \c a , on each
+  /// process, without a pass over the tiles or a collective reduction. It
+  /// is exact if the tile norms are current, e.g. after \c truncate() , and
+  /// an upper bound if the shape was estimated from the shapes of the
+  /// arguments of an expression (see \c SparseShape::norm() ).
+  /// \param a The array
+  /// \return The 2-norm of \c a , or an upper bound of it
+  template <typename Tile>
+  inline typename DistArray<Tile,SparsePolicy>::scalar_type
+  norm2_estimate(const DistArray<Tile,SparsePolicy>& a) {
+    return a.shape().norm();
+  }
+
+  namespace detail {
+
+    /// Sum reduction of fixed-size arrays of partial results
+    template <typename T, std::size_t N>
+    struct ArraySumReduction {
+      typedef std::array<T, N> result_type;
+      typedef result_type argument_type;
+
+      result_type operator()() const {
+        result_type result;
+        result.fill(T(0));
+        return result;
+      }
+
+      const result_type& operator()(const result_type& result) const { return result; }
+
+      void operator()(result_type& result, const result_type& arg) const {
+        for(std::size_t i = 0ul; i < N; ++i)
+          result[i] += arg[i];
+      }
+    }; // struct ArraySumReduction
+
+    struct FusedUpdateTag { };
+
+    /// Element-wise update of several dense arrays in one pass
+
+    /// For each local tile, a task reads the tiles of \c inputs , applies
+    /// <tt>op(in, out, dots)</tt> to each element, where \c in holds the
+    /// elements of the inputs, \c out receives the elements of the outputs,
+    /// and \c dots accumulates the partial dot products of the tile, and sets
+    /// the tiles of the outputs. The partial dot products of all tiles are
+    /// summed in one all-reduce, which does not block; an output may also be
+    /// an input. This function is collective.
+    /// \tparam NDot The number of dot products
+    /// \param outputs The arrays to be updated
+    /// \param inputs The arrays to be read, which must have the same tiled
+    /// range and process map
+    /// \param op The element-wise operation
+    /// \return A future to the dot products
+    template <std::size_t NDot, typename T, typename A, std::size_t NOut,
+        std::size_t NIn, typename Op>
+    inline Future<std::array<T, NDot> >
+    fused_update(const std::array<DistArray<Tensor<T, A>, DensePolicy>*, NOut>& outputs,
+        const std::array<const DistArray<Tensor<T, A>, DensePolicy>*, NIn>& inputs,
+        const Op& op)
+    {
+      typedef DistArray<Tensor<T, A>, DensePolicy> array_type;
+      typedef Tensor<T, A> tile_type;
+      typedef std::array<T, NDot> dots_type;
+
+      const array_type& first = *inputs[0];
+      World& world = first.world();
+      for(const array_type* input : inputs)
+        TA_USER_ASSERT(input->trange() == first.trange(),
+            "fused_update: the arrays must have the same tiled range.");
+
+      std::array<array_type, NOut> results;
+      for(array_type& result : results)
+        result = array_type(world, first.trange(), first.shape(), first.pmap());
+
+      std::vector<Future<dots_type> > partials;
+      for(const auto index : *first.pmap()) {
+        std::vector<Future<tile_type> > tiles;
+        tiles.reserve(NIn);
+        for(const array_type* input : inputs)
+          tiles.push_back(input->find(index));
+        std::vector<Future<tile_type> > tile_outputs(NOut);
+        for(std::size_t k = 0ul; k < NOut; ++k)
+          results[k].set(index, tile_outputs[k]);
+
+        partials.push_back(world.taskq.add(
+            [tile_outputs, op] (const std::vector<Future<tile_type> >& tiles) {
+              const std::size_t volume = tiles[0].get().range().volume();
+              std::array<const T*, NIn> in_data;
+              for(std::size_t k = 0ul; k < NIn; ++k)
+                in_data[k] = tiles[k].get().data();
+              std::array<tile_type, NOut> out_tiles;
+              std::array<T*, NOut> out_data;
+              for(std::size_t k = 0ul; k < NOut; ++k) {
+                out_tiles[k] = tile_type(tiles[0].get().range());
+                out_data[k] = out_tiles[k].data();
+              }
+
+              dots_type dots;
+              dots.fill(T(0));
+              std::array<T, NIn> in;
+              std::array<T, NOut> out;
+              for(std::size_t i = 0ul; i < volume; ++i) {
+                for(std::size_t k = 0ul; k < NIn; ++k)
+                  in[k] = in_data[k][i];
+                op(in, out, dots);
+                for(std::size_t k = 0ul; k < NOut; ++k)
+                  out_data[k][i] = out[k];
+              }
+
+              for(std::size_t k = 0ul; k < NOut; ++k) {
+                Future<tile_type> tile_output = tile_outputs[k];
+                tile_output.set(out_tiles[k]);
+              }
+              return dots;
+            }, tiles));
+      }
+
+      for(std::size_t k = 0ul; k < NOut; ++k)
+        *outputs[k] = results[k];
+
+      // Sum the partial dot products of the local tiles, then all processes
+      const ArraySumReduction<T, NDot> sum;
+      if(NDot == 0ul)
+        return Future<dots_type>(sum());
+      Future<dots_type> local = world.taskq.add(
+          [sum] (const std::vector<Future<dots_type> >& partials) {
+            dots_type result = sum();
+            for(const Future<dots_type>& partial : partials)
+              sum(result, partial.get());
+            return result;
+          }, partials);
+      typedef madness::TaggedKey<madness::uniqueidT, FusedUpdateTag> key_type;
+      return world.gop.all_reduce(key_type(world.unique_obj_id()), local, sum);
+    }
+
+  } // namespace detail
+
+  /// Conjugate gradient update of the solution and residual
+
+  /// Computes \f$ x \mathrel{+}= \alpha p \f$, \f$ r \mathrel{-}= \alpha Ap \f$,
+  /// and \f$ z = M r \f$, where \f$ M \f$ is a diagonal preconditioner,
+  /// and returns \f$ r \cdot z \f$ and \f$ r \cdot r \f$. For dense arrays
+  /// of \c Tensor tiles, this is a single pass over the local tiles with one
+  /// collective reduction; see \c cg_update(DistArray<Tensor<T,A>,DensePolicy>&,...) .
+  /// \param[in,out] x The solution
+  /// \param[in,out] r The residual
+  /// \param[out] z The preconditioned residual
+  /// \param p The search direction
+  /// \param ap The product of the matrix and \c p
+  /// \param m The diagonal preconditioner
+  /// \param alpha The step length
+  /// \param estimate_norm If \c true , \f$ r \cdot r \f$ is computed with
+  /// \c norm2_estimate() [default = false]
+  /// \return \f$ r \cdot z \f$ and \f$ r \cdot r \f$
+  template <typename D>
+  inline std::array<typename D::element_type, 2>
+  cg_update(D& x, D& r, D& z, const D& p, const D& ap, const D& m,
+      const typename D::element_type alpha, const bool estimate_norm = false)
+  {
+    axpy(x, alpha, p);
+    axpy(r, -alpha, ap);
+    z = copy(r);
+    vec_multiply(z, m);
+    const auto r_norm = (estimate_norm ? norm2_estimate(r) : norm2(r));
+    return {{ dot_product(z, r), r_norm * r_norm }};
+  }
+
+  /// Conjugate gradient update of dense arrays in one pass
+
+  /// \f$ r \cdot r \f$ is reduced with \f$ r \cdot z \f$ , so it is not
+  /// estimated.
+  /// \sa cg_update()
+  template <typename T, typename A>
+  inline std::array<T, 2>
+  cg_update(DistArray<Tensor<T, A>, DensePolicy>& x,
+      DistArray<Tensor<T, A>, DensePolicy>& r,
+      DistArray<Tensor<T, A>, DensePolicy>& z,
+      const DistArray<Tensor<T, A>, DensePolicy>& p,
+      const DistArray<Tensor<T, A>, DensePolicy>& ap,
+      const DistArray<Tensor<T, A>, DensePolicy>& m, const T alpha,
+      const bool = false)
+  {
+    typedef DistArray<Tensor<T, A>, DensePolicy> array_type;
+    return detail::fused_update<2ul>(
+        std::array<array_type*, 3>{{ &x, &r, &z }},
+        std::array<const array_type*, 5>{{ &x, &r, &p, &ap, &m }},
+        [alpha] (const std::array<T, 5>& in, std::array<T, 3>& out,
+            std::array<T, 2>& dots)
+        {
+          out[0] = in[0] + alpha * in[2];
+          out[1] = in[1] - alpha * in[3];
+          out[2] = in[4] * out[1];
+          dots[0] += out[1] * out[2];
+          dots[1] += std::norm(out[1]);
+        }).get();
+  }
+
+  /// Conjugate gradient update of the search direction
+
+  /// Computes \f$ p = z + \beta p \f$ .
+  /// \param[in,out] p The search direction
+  /// \param z The preconditioned residual
+  /// \param beta The direction update factor
+  template <typename D>
+  inline void cg_direction(D& p, const D& z, const typename D::element_type beta) {
+    scale(p, beta);
+    axpy(p, 1.0, z);
+  }
+
+  /// Conjugate gradient update of the search direction of dense arrays
+
+  /// \sa cg_direction()
+  template <typename T, typename A>
+  inline void cg_direction(DistArray<Tensor<T, A>, DensePolicy>& p,
+      const DistArray<Tensor<T, A>, DensePolicy>& z, const T beta)
+  {
+    typedef DistArray<Tensor<T, A>, DensePolicy> array_type;
+    detail::fused_update<0ul>(std::array<array_type*, 1>{{ &p }},
+        std::array<const array_type*, 2>{{ &p, &z }},
+        [beta] (const std::array<T, 2>& in, std::array<T, 1>& out,
+            std::array<T, 0>&)
+        { out[0] = in[1] + beta * in[0]; });
+  }
+
+  /// Pipelined conjugate gradient update
+
+  /// Performs the recurrences of one iteration of the pipelined, preconditioned
+  /// conjugate gradient method of Ghysels and Vanroose (Parallel Comput. 40,
+  /// 224 (2014)):
+  /// \f$ z = n + \beta z \f$, \f$ q = m + \beta q \f$, \f$ s = w + \beta s \f$,
+  /// \f$ p = u + \beta p \f$, \f$ x \mathrel{+}= \alpha p \f$,
+  /// \f$ r \mathrel{-}= \alpha s \f$, \f$ u \mathrel{-}= \alpha q \f$,
+  /// \f$ w \mathrel{-}= \alpha z \f$, and starts the reduction of
+  /// \f$ r \cdot u \f$, \f$ w \cdot u \f$, and \f$ r \cdot r \f$ for the
+  /// next iteration. The reduction does not block, so it can overlap with
+  /// the next preconditioner application and matrix-vector product.
+  /// \return A future to \f$ r \cdot u \f$, \f$ w \cdot u \f$, and
+  /// \f$ r \cdot r \f$
+  template <typename D>
+  inline Future<std::array<typename D::element_type, 3> >
+  pipelined_cg_update(D& x, D& r, D& u, D& w, D& z, D& q, D& s, D& p,
+      const D& m, const D& n, const typename D::element_type alpha,
+      const typename D::element_type beta)
+  {
+    typedef typename D::element_type value_type;
+    cg_direction(z, n, beta);
+    cg_direction(q, m, beta);
+    cg_direction(s, w, beta);
+    cg_direction(p, u, beta);
+    axpy(x, alpha, p);
+    axpy(r, -alpha, s);
+    axpy(u, -alpha, q);
+    axpy(w, -alpha, z);
+    const auto r_norm = norm2(r);
+    return Future<std::array<value_type, 3> >(std::array<value_type, 3>{{
+        dot_product(r, u), dot_product(w, u), value_type(r_norm * r_norm) }});
+  }
+
+  /// Pipelined conjugate gradient update of dense arrays in one pass
+
+  /// \sa pipelined_cg_update()
+  template <typename T, typename A>
+  inline Future<std::array<T, 3> >
+  pipelined_cg_update(DistArray<Tensor<T, A>, DensePolicy>& x,
+      DistArray<Tensor<T, A>, DensePolicy>& r,
+      DistArray<Tensor<T, A>, DensePolicy>& u,
+      DistArray<Tensor<T, A>, DensePolicy>& w,
+      DistArray<Tensor<T, A>, DensePolicy>& z,
+      DistArray<Tensor<T, A>, DensePolicy>& q,
+      DistArray<Tensor<T, A>, DensePolicy>& s,
+      DistArray<Tensor<T, A>, DensePolicy>& p,
+      const DistArray<Tensor<T, A>, DensePolicy>& m,
+      const DistArray<Tensor<T, A>, DensePolicy>& n,
+      const T alpha, const T beta)
+  {
+    typedef DistArray<Tensor<T, A>, DensePolicy> array_type;
+    return detail::fused_update<3ul>(
+        std::array<array_type*, 8>{{ &x, &r, &u, &w, &z, &q, &s, &p }},
+        std::array<const array_type*, 10>{{ &x, &r, &u, &w, &z, &q, &s, &p, &m, &n }},
+        [alpha, beta] (const std::array<T, 10>& in, std::array<T, 8>& out,
+            std::array<T, 3>& dots)
+        {
+          out[4] = in[9] + beta * in[4]; // z = n + beta z
+          out[5] = in[8] + beta * in[5]; // q = m + beta q
+          out[6] = in[3] + beta * in[6]; // s = w + beta s
+          out[7] = in[2] + beta * in[7]; // p = u + beta p
+          out[0] = in[0] + alpha * out[7]; // x += alpha p
+          out[1] = in[1] - alpha * out[6]; // r -= alpha s
+          out[2] = in[2] - alpha * out[5]; // u -= alpha q
+          out[3] = in[3] - alpha * out[4]; // w -= alpha z
+          dots[0] += out[1] * out[2];
+          dots[1] += out[3] * out[2];
+          dots[2] += std::norm(out[1]);
+        });
+  }
+
   template <typename Tile, typename Policy>
   inline void print(const DistArray<Tile,Policy>& a, const char* label) {
     std::cout << label << ":\n" << a << "\n";
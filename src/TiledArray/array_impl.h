@@ -26,10 +26,19 @@
 #ifndef TILEDARRAY_ARRAY_IMPL_H__INCLUDED
 #define TILEDARRAY_ARRAY_IMPL_H__INCLUDED
 
+#include <TiledArray/block_range.h>
+#include <TiledArray/dist_eval/lazy_tile_cache.h>
+#include <TiledArray/dist_eval/summa_bcast_cache.h>
+#include <TiledArray/expressions/expr_cache.h>
 #include <TiledArray/tensor_impl.h>
 #include <TiledArray/distributed_storage.h>
+#include <TiledArray/rma_window.h>
+#include <TiledArray/tile_interface/shift.h>
 #include <TiledArray/transform_iterator.h>
 #include <TiledArray/type_traits.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
@@ -401,6 +410,98 @@ namespace TiledArray {
     private:
 
       storage_type data_; ///< Tile container
+      std::vector<float> tile_norms_; ///< The cached norms of the local tiles
+      std::atomic<unsigned long> version_; ///< The number of modifications
+      std::shared_ptr<RmaWindow<value_type> > rma_window_; ///< The one-sided window of the tiles, if exposed
+      std::shared_ptr<TileCache> permutation_cache_; ///< Permuted local tiles, if cached
+      std::shared_ptr<ArrayImpl_> parent_; ///< The array of a view, or null
+      BlockRange view_block_; ///< The tiles of \c parent_ held by a view
+      std::vector<long> to_parent_; ///< The shift of view tiles to \c parent_
+      std::vector<long> from_parent_; ///< The shift of \c parent_ tiles to a view
+
+      /// Ordinal of a tile of a view in its array
+
+      /// \tparam Index The index type
+      /// \param i The index of a tile of this view
+      /// \return The ordinal of tile \c i in \c parent_
+      template <typename Index>
+      size_type parent_ordinal(const Index& i) const {
+        return view_block_.ordinal(TensorImpl_::trange().tiles_range().ordinal(i));
+      }
+
+      /// Shape of a view
+
+      /// \param parent The array of the view
+      /// \param block The block of tiles of \c parent
+      /// \return The block of the shape of \c parent
+      static shape_type view_shape(const ArrayImpl_& parent, const BlockRange& block) {
+        const std::vector<size_type> lower(block.lobound_data(),
+            block.lobound_data() + block.rank());
+        const std::vector<size_type> upper(block.upbound_data(),
+            block.upbound_data() + block.rank());
+        return parent.shape().block(lower, upper);
+      }
+
+      /// Shift the range of a tile
+
+      /// \param tile The tile
+      /// \param bound_shift The shift of the tile range
+      /// \return A tile with the shifted range, which shares the data of
+      /// \c tile if the tile type supports it (see \c Tensor::shift() )
+      static value_type shift_tile(const value_type& tile,
+          const std::vector<long>& bound_shift)
+      {
+        using TiledArray::shift;
+        return value_type(shift(tile, bound_shift));
+      }
+
+      /// Shift the range of a future tile
+
+      /// \param f The future tile
+      /// \param bound_shift The shift of the tile range
+      /// \return The future of the shifted tile
+      future shift_tile(const future& f, const std::vector<long>& bound_shift) const {
+        if(f.probe())
+          return future(shift_tile(f.get(), bound_shift));
+        value_type (*op)(const value_type&, const std::vector<long>&) =
+            & ArrayImpl_::shift_tile;
+        return TensorImpl_::world().taskq.add(op, f, bound_shift);
+      }
+
+      /// Shift the range of a tile value
+
+      /// \tparam Value The value type, which is convertible to \c future
+      /// \param value The object that contains the tile value
+      /// \param bound_shift The shift of the tile range
+      /// \return The future of the shifted tile
+      template <typename Value>
+      future shift_tile(const Value& value, const std::vector<long>& bound_shift) const {
+        return shift_tile(future(value), bound_shift);
+      }
+
+      /// Record a modification of the tiles or the shape
+      void modified() {
+        ++version_;
+        if(permutation_cache_)
+          permutation_cache_->clear();
+      }
+
+      /// Expose tiles that are held in one contiguous buffer
+      void rma_expose(std::true_type) {
+        rma_window_ = std::make_shared<RmaWindow<value_type> >(
+            TensorImpl_::world(), TensorImpl_::trange(), TensorImpl_::shape(),
+            TensorImpl_::pmap(), [this] (const size_type i) { return data_.get(i); });
+        // Readers hold the window weakly, so this array is its only owner
+        std::weak_ptr<RmaWindow<value_type> > window = rma_window_;
+        World* world = & TensorImpl_::world();
+        data_.remote_reader([window,world] (const size_type i) -> future {
+          return world->taskq.add(& rma_fetch<value_type>, window, i,
+              madness::TaskAttributes::hipri());
+        });
+      }
+
+      /// Other tiles are read with active messages
+      void rma_expose(std::false_type) { }
 
     public:
 
@@ -416,12 +517,79 @@ namespace TiledArray {
       ArrayImpl(World& world, const trange_type& trange, const shape_type& shape,
           const std::shared_ptr<pmap_interface>& pmap) :
         TensorImpl_(world, trange, shape, pmap),
-        data_(world, trange.tiles_range().volume(), pmap)
-      { }
+        data_(world, trange.tiles_range().volume(), pmap),
+        tile_norms_((shape.is_dense() ? 0ul : trange.tiles_range().volume()), -1.0f),
+        version_(0ul), rma_window_(), permutation_cache_(), parent_(),
+        view_block_(), to_parent_(), from_parent_()
+      {
+        // Tiles that have not been set are expected to hold one element of
+        // numeric_type per element of their range
+        data_.expected_bytes([this] (const size_type i) -> std::size_t {
+          return TensorImpl_::trange().make_tile_range(i).volume() *
+              sizeof(numeric_type);
+        });
+      }
+
+      /// View constructor
+
+      /// A view is an array whose tiles are a block of the tiles of another
+      /// array. It holds no tiles: getting a tile of the view gets the tile of
+      /// the array and shifts its range, which does not copy the data of
+      /// tiles that share data (see \c Tensor::shift() ), and setting a tile
+      /// of the view sets the tile of the array. The tiles are held by the
+      /// owners of the array tiles. The shape of the view is the block of the
+      /// shape of the array when the view is constructed, see
+      /// \c update_view() .
+      /// \param parent The array
+      /// \param block The block of tiles of \c parent
+      /// \param trange The tiled range of the view, which is the tiled range
+      /// of \c block shifted to the origin
+      /// \param pmap The tile-process map of the view, which must map tiles
+      /// to the owners of the \c parent tiles
+      ArrayImpl(const std::shared_ptr<ArrayImpl_>& parent, const BlockRange& block,
+          const trange_type& trange, const std::shared_ptr<pmap_interface>& pmap) :
+        ArrayImpl(parent->world(), trange, view_shape(*parent, block), pmap)
+      {
+        TA_ASSERT(trange.tiles_range().volume() == block.volume());
+        parent_ = parent;
+        view_block_ = block;
+        const std::vector<size_type> lower(block.lobound_data(),
+            block.lobound_data() + block.rank());
+        const range_type base = parent->trange().make_tile_range(lower);
+        for(unsigned int d = 0u; d < base.rank(); ++d) {
+          to_parent_.push_back(long(base.lobound(d)));
+          from_parent_.push_back(-long(base.lobound(d)));
+        }
+      }
 
       /// Virtual destructor
       virtual ~ArrayImpl() { }
 
+      /// View query
+
+      /// \return \c true if this is a view of a block of another array
+      bool is_view() const { return static_cast<bool>(parent_); }
+
+      /// Viewed array accessor
+
+      /// \return The array of this view, or null if this is not a view
+      const std::shared_ptr<ArrayImpl_>& view_parent() const { return parent_; }
+
+      /// Viewed block accessor
+
+      /// \return The block of tiles of the array that is held by this view
+      const BlockRange& view_block() const { return view_block_; }
+
+      /// Update the shape of a view
+
+      /// The shape of this view is replaced by the block of the current shape
+      /// of the array, e.g. after the block of the array was assigned.
+      void update_view() {
+        TA_ASSERT(parent_);
+        TensorImpl_::shape(view_shape(*parent_, view_block_));
+        modified();
+      }
+
       /// Tile future accessor
 
       /// \tparam Index The index type
@@ -431,6 +599,8 @@ namespace TiledArray {
       template <typename Index>
       future get(const Index& i) const {
         TA_ASSERT(! TensorImpl_::is_zero(i));
+        if(parent_)
+          return shift_tile(parent_->get(parent_ordinal(i)), from_parent_);
         return data_.get(TensorImpl_::trange().tiles_range().ordinal(i));
       }
 
@@ -445,6 +615,133 @@ namespace TiledArray {
         return get<std::initializer_list<Integer>>(i);
       }
 
+      /// Prefetch a remote or spilled tile
+
+      /// Request a copy of tile \c i , if it is remote and non-zero, or read
+      /// it back, if it is local and was spilled to disk, so that a later
+      /// call to \c get() does not wait for the communication or the file.
+      /// \tparam Index The index type
+      /// \param i The tile index
+      template <typename Index>
+      void prefetch(const Index& i) const {
+        if(TensorImpl_::is_zero(i))
+          return;
+        if(parent_)
+          parent_->prefetch(parent_ordinal(i));
+        else
+          data_.prefetch(TensorImpl_::trange().tiles_range().ordinal(i));
+      }
+
+      /// Prefetch cache capacity accessor
+
+      /// \return The largest number of remote tiles held by the prefetch
+      /// cache
+      size_type prefetch_capacity() const { return data_.prefetch_capacity(); }
+
+      /// Set the prefetch cache capacity
+
+      /// \param capacity The largest number of remote tiles held by the
+      /// prefetch cache; zero disables prefetching
+      void prefetch_capacity(const size_type capacity) {
+        data_.prefetch_capacity(capacity);
+      }
+
+      /// Remove all prefetched remote tiles from the cache
+
+      /// This must not be called while other threads access tiles.
+      /// \sa DistributedStorage::clear_prefetch()
+      void clear_prefetch() { data_.clear_prefetch(); }
+
+      /// Make the tiles of this array read-only
+
+      /// The tiles of a view are those of the viewed array, which is frozen.
+      /// \sa DistributedStorage::freeze()
+      void freeze() {
+        if(parent_)
+          parent_->freeze();
+        else
+          data_.freeze();
+      }
+
+      /// Frozen array query
+
+      /// \return \c true if the tiles of this array are read-only
+      bool is_frozen() const {
+        return (parent_ ? parent_->is_frozen() : data_.is_frozen());
+      }
+
+      /// Memory footprint of this array on this process
+
+      /// \return The footprint of the local tiles and prefetched tiles
+      /// \sa DistributedStorage::memory_usage()
+      MemoryUsage memory_usage() const { return data_.memory_usage(); }
+
+      /// Spill local tiles to disk
+
+      /// \param directory The directory of the spill files
+      /// \param max_bytes The largest size of the local tiles held in memory
+      /// \sa DistributedStorage::spill()
+      void spill(const std::string& directory, const std::size_t max_bytes) {
+        data_.spill(directory, max_bytes);
+      }
+
+      /// Number of spilled tiles
+
+      /// \return The number of local tiles that are held on disk
+      size_type spilled_size() const { return data_.spilled_size(); }
+
+      /// Hold local tiles in a flat array
+
+      /// The caller must synchronize the processes before remote tiles are
+      /// accessed.
+      /// \sa DistributedStorage::indexed_storage()
+      void indexed_storage() { data_.indexed_storage(); }
+
+      /// Aggregate small remote sets and gets
+
+      /// The caller must synchronize the processes before tiles are
+      /// accessed.
+      /// \param bytes The size of aggregated messages, or zero
+      /// \sa DistributedStorage::aggregate_bytes()
+      void aggregate_bytes(const std::size_t bytes) { data_.aggregate_bytes(bytes); }
+
+      /// Number of tile set and get messages sent by this process
+
+      /// \sa DistributedStorage::messages_sent()
+      size_type messages_sent() const { return data_.messages_sent(); }
+
+      /// Number of tiles set or requested by the messages of this process
+
+      /// \sa DistributedStorage::elements_sent()
+      size_type tiles_sent() const { return data_.elements_sent(); }
+
+      /// Indexed storage query
+
+      /// \return \c true if local tiles are held in indexed storage
+      bool is_indexed_storage() const { return data_.is_indexed(); }
+
+      /// Generate tiles on demand
+
+      /// \tparam Op The tile operation type
+      /// \param op A thread-safe function that returns a tile given its range
+      /// \param cache If \c true , generated tiles are stored
+      /// \sa DistributedStorage::generator()
+      template <typename Op>
+      void generator(const Op& op, const bool cache) {
+        TA_USER_ASSERT(! parent_, "Tiles of array views cannot be generated.");
+        const trange_type trange = TensorImpl_::trange();
+        data_.generator([=] (const size_type i) -> value_type {
+          return op(trange.make_tile_range(i));
+        }, cache);
+      }
+
+      /// Lazy array query
+
+      /// \return \c true if the tiles of this array are generated on demand
+      bool is_lazy() const {
+        return (parent_ ? parent_->is_lazy() : data_.is_generated());
+      }
+
       /// Set tile
 
       /// Set the tile at \c i with \c value . \c Value type may be \c value_type ,
@@ -457,9 +754,211 @@ namespace TiledArray {
       template <typename Index, typename Value>
       void set(const Index& i, const Value& value) {
         TA_ASSERT(! TensorImpl_::is_zero(i));
-        data_.set(TensorImpl_::trange().tiles_range().ordinal(i), value);
+        TA_USER_ASSERT(! is_lazy(), "Tiles of lazy arrays cannot be set.");
+        TA_USER_ASSERT(! rma_window_, "Tiles of arrays that are exposed for one-sided access cannot be set.");
+        if(parent_)
+          parent_->set(parent_ordinal(i), shift_tile(value, to_parent_));
+        else
+          data_.set(TensorImpl_::trange().tiles_range().ordinal(i), value);
+        modified();
+      }
+
+      /// Add a contribution to a tile
+
+      /// \tparam Index The index type
+      /// \param i The index of the tile
+      /// \param value The contribution to tile \c i
+      /// \sa DistributedStorage::accumulate()
+      template <typename Index>
+      void accumulate(const Index& i, const value_type& value) {
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+        TA_USER_ASSERT(! is_lazy(), "Tiles of lazy arrays cannot be accumulated.");
+        TA_USER_ASSERT(! rma_window_, "Tiles of arrays that are exposed for one-sided access cannot be accumulated.");
+        if(parent_)
+          parent_->accumulate(parent_ordinal(i), shift_tile(value, to_parent_));
+        else
+          data_.accumulate(TensorImpl_::trange().tiles_range().ordinal(i), value);
+        modified();
+      }
+
+      /// Set many tiles with one message per owner
+
+      /// \param indices The ordinal indices of the tiles to be set
+      /// \param tiles The futures of the tiles in \c indices
+      /// \sa DistributedStorage::set_bulk()
+      void set_bulk(const std::vector<size_type>& indices,
+          const std::vector<future>& tiles)
+      {
+        TA_USER_ASSERT(! is_lazy(), "Tiles of lazy arrays cannot be set.");
+        TA_USER_ASSERT(! rma_window_, "Tiles of arrays that are exposed for one-sided access cannot be set.");
+        if(parent_) {
+          std::vector<size_type> parent_indices;
+          std::vector<future> parent_tiles;
+          parent_indices.reserve(indices.size());
+          parent_tiles.reserve(tiles.size());
+          for(size_type k = 0ul; k < indices.size(); ++k) {
+            parent_indices.push_back(parent_ordinal(indices[k]));
+            parent_tiles.push_back(shift_tile(tiles[k], to_parent_));
+          }
+          parent_->set_bulk(parent_indices, parent_tiles);
+        } else {
+          data_.set_bulk(indices, tiles);
+        }
+        modified();
+      }
+
+      /// Expose the tiles for one-sided access
+
+      /// \sa RmaWindow
+      void rma_expose() {
+        TA_USER_ASSERT(! is_lazy(), "Tiles of lazy arrays cannot be exposed for one-sided access.");
+        TA_USER_ASSERT(! parent_, "Tiles of array views cannot be exposed for one-sided access.");
+        TA_ASSERT(! rma_window_);
+        rma_expose(is_zero_copy_tile<value_type>());
+      }
+
+      /// Release the one-sided window of the tiles
+
+      /// \sa RmaWindow::release()
+      void rma_release() {
+        if(! rma_window_)
+          return;
+        data_.remote_reader(std::function<future(size_type)>());
+        rma_window_->release();
+        rma_window_.reset();
+      }
+
+      /// One-sided access query
+
+      /// \return \c true if the tiles are exposed for one-sided access
+      bool is_rma_exposed() const { return static_cast<bool>(rma_window_); }
+
+      /// Cache the norm of a local tile
+
+      /// The Frobenius norm of a tile that is known when the tile is
+      /// produced may be stored alongside the tile, so the shape can be
+      /// updated without another pass over the tile data. Norms are only
+      /// cached by arrays with a sparse shape. Norms of different tiles may be
+      /// cached concurrently.
+      /// \param i The ordinal index of the tile
+      /// \param norm The Frobenius norm of tile \c i , or a negative value to
+      /// remove the cached norm
+      void tile_norm(const size_type i, const float norm) {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        if(! tile_norms_.empty())
+          tile_norms_[i] = norm;
+      }
+
+      /// Cached norm accessor
+
+      /// \param i The ordinal index of the tile
+      /// \return The cached Frobenius norm of local tile \c i , or a negative
+      /// value when it is not cached
+      float tile_norm(const size_type i) const {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        return (tile_norms_.empty() ? -1.0f : tile_norms_[i]);
+      }
+
+      /// Replace the shape and remove the local tiles that became zero
+
+      /// Local tiles that are non-zero in the current shape and zero in
+      /// \c shape are removed from the tile container. Tiles that are zero in
+      /// the current shape must also be zero in \c shape . The id of this
+      /// array does not change, so the caches that identify arrays by their
+      /// id, i.e. the expression, lazy tile, and SUMMA broadcast caches, are
+      /// cleared; this function is therefore collective.
+      /// \param shape The new shape of this array
+      void update_shape(const shape_type& shape) {
+        TA_USER_ASSERT(! is_lazy(), "The shape of a lazy array cannot be updated.");
+        TA_USER_ASSERT(! parent_, "The shape of an array view cannot be updated.");
+        for(const size_type i : *TensorImpl_::pmap()) {
+          if(TensorImpl_::is_zero(i)) {
+            TA_ASSERT(shape.is_zero(i));
+            continue;
+          }
+          if(shape.is_zero(i)) {
+            data_.erase(i);
+            tile_norm(i, -1.0f);
+          }
+        }
+        TensorImpl_::shape(shape);
+        modified();
+        TiledArray::clear_expression_cache();
+        TiledArray::clear_lazy_tile_cache();
+        TiledArray::clear_summa_bcast_cache();
+      }
+
+      /// Replace the shape and remove the local tiles of a block
+
+      /// The local tiles of \c block that are non-zero in the current shape
+      /// are removed from the tile container, so the block can be set again.
+      /// Only the tiles of \c block are visited. \c shape must be identical
+      /// to the current shape outside \c block . The id of this array does
+      /// not change, so the caches that identify arrays by their id, i.e.
+      /// the expression, lazy tile, and SUMMA broadcast caches, are cleared;
+      /// this function is therefore collective.
+      /// \param block The tile block of this array that is replaced
+      /// \param shape The new shape of this array
+      void update_block(const BlockRange& block, const shape_type& shape) {
+        TA_USER_ASSERT(! is_lazy(), "The shape of a lazy array cannot be updated.");
+        TA_USER_ASSERT(! parent_, "The shape of an array view cannot be updated.");
+        TA_USER_ASSERT(! rma_window_, "Tiles of arrays that are exposed for one-sided access cannot be set.");
+        const size_type volume = block.volume();
+        for(size_type b = 0ul; b < volume; ++b) {
+          const size_type i = block.ordinal(b);
+          if(TensorImpl_::is_local(i) && ! TensorImpl_::is_zero(i)) {
+            data_.erase(i);
+            tile_norm(i, -1.0f);
+          }
+        }
+        TensorImpl_::shape(shape);
+        modified();
+        TiledArray::clear_expression_cache();
+        TiledArray::clear_lazy_tile_cache();
+        TiledArray::clear_summa_bcast_cache();
       }
 
+      /// Permutation cache capacity accessor
+
+      /// \return The largest number of bytes held by the permutation cache of
+      /// this array on this process, or zero if it is disabled
+      std::size_t permutation_cache_capacity() const {
+        return (permutation_cache_ ? permutation_cache_->capacity() : 0ul);
+      }
+
+      /// Set the permutation cache capacity
+
+      /// \param capacity The largest number of bytes held by the permutation
+      /// cache of this array on this process; zero disables the cache and
+      /// releases the cached tiles
+      void permutation_cache_capacity(const std::size_t capacity) {
+        if(capacity == 0ul)
+          permutation_cache_.reset();
+        else if(permutation_cache_)
+          permutation_cache_->capacity(capacity);
+        else
+          permutation_cache_ = std::make_shared<TileCache>(capacity,
+              CachePriority::permuted_tiles);
+      }
+
+      /// Permutation cache accessor
+
+      /// \return The permutation cache of this array, or null if it is
+      /// disabled
+      const std::shared_ptr<TileCache>& permutation_cache() const {
+        return permutation_cache_;
+      }
+
+      /// Modification counter accessor
+
+      /// The counter is incremented on this process each time tiles are set
+      /// or the shape is updated through this process. A new array, e.g. the
+      /// result of an expression assignment, is a new object with its own
+      /// counter, so an array is unchanged when both its \c id() and its
+      /// version are unchanged.
+      /// \return The number of modifications of this array by this process
+      unsigned long version() const { return version_; }
+
       /// Array begin iterator
 
       /// \return A const iterator to the first element of the array.
@@ -515,30 +1014,30 @@ namespace TiledArray {
 #ifndef TILEDARRAY_HEADER_ONLY
 
     extern template
-    class ArrayImpl<Tensor<double, Eigen::aligned_allocator<double> >, DensePolicy>;
+    class ArrayImpl<Tensor<double, PoolAllocator<double> >, DensePolicy>;
     extern template
     class ArrayImpl<Tensor<float, Eigen::aligned_allocator<float> >, DensePolicy>;
     extern template
     class ArrayImpl<Tensor<int, Eigen::aligned_allocator<int> >, DensePolicy>;
     extern template
     class ArrayImpl<Tensor<long, Eigen::aligned_allocator<long> >, DensePolicy>;
-//    extern template
-//    class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, DensePolicy>;
-//    extern template
-//    class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>;
+    extern template
+    class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, DensePolicy>;
+    extern template
+    class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>;
 
     extern template
-    class ArrayImpl<Tensor<double, Eigen::aligned_allocator<double> >, SparsePolicy>;
+    class ArrayImpl<Tensor<double, PoolAllocator<double> >, SparsePolicy>;
     extern template
     class ArrayImpl<Tensor<float, Eigen::aligned_allocator<float> >, SparsePolicy>;
     extern template
     class ArrayImpl<Tensor<int, Eigen::aligned_allocator<int> >, SparsePolicy>;
     extern template
     class ArrayImpl<Tensor<long, Eigen::aligned_allocator<long> >, SparsePolicy>;
-//    extern template
-//    class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, SparsePolicy>;
-//    extern template
-//    class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, SparsePolicy>;
+    extern template
+    class ArrayImpl<Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >, SparsePolicy>;
+    extern template
+    class ArrayImpl<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, SparsePolicy>;
 
 #endif // TILEDARRAY_HEADER_ONLY
 
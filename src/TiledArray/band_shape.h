@@ -0,0 +1,629 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  band_shape.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_BAND_SHAPE_H__INCLUDED
+#define TILEDARRAY_BAND_SHAPE_H__INCLUDED
+
+#include <TiledArray/bitset.h>
+#include <TiledArray/error.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/range.h>
+#include <TiledArray/type_traits.h>
+#include <algorithm>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Structured shape of a matrix
+
+  /// The non-zero tiles of each tile row are a contiguous range of tile
+  /// columns, e.g. in banded and block-diagonal matrices, so the shape is
+  /// stored with two numbers per tile row instead of one norm per tile,
+  /// and the shapes of expressions are computed from the ranges, in
+  /// O(rows) time when the rows are monotone, i.e. the ranges of later rows
+  /// do not start or end before those of earlier rows, and in time
+  /// proportional to the number of non-zero tiles otherwise. A shape that
+  /// cannot be represented exactly, e.g. the sum of two bands with a gap
+  /// between them, is rounded up to the smallest ranges that hold all of its
+  /// non-zero tiles, which may add zero tiles but never drops a non-zero
+  /// one. There are no norms, so tiles are never screened and thresholds are
+  /// ignored. Rank-1 shapes, e.g. the result of \c sum_over() , hold a
+  /// single row.
+  /// \code
+  /// // A tridiagonal matrix of tiles
+  /// const BandShape band = BandShape::band(trange.tiles_range(), 1ul, 1ul);
+  /// DistArray<TensorD, BandPolicy> a(world, trange, band);
+  /// \endcode
+  class BandShape {
+  public:
+    typedef BandShape BandShape_; ///< This object type
+    typedef std::size_t size_type; ///< Size type
+
+  private:
+
+    Range range_; ///< The tiles range
+    size_type rows_; ///< The number of tile rows
+    size_type cols_; ///< The number of tile columns
+    std::vector<size_type> first_; ///< The first non-zero column of each row
+    std::vector<size_type> last_; ///< The non-zero columns of each row end
+        ///< before this column; empty rows have <tt>first == last</tt>
+    size_type nonzero_; ///< The number of non-zero tiles
+    bool monotone_; ///< All rows are non-empty, and their ranges do not
+        ///< start or end before those of earlier rows
+
+    /// Add a column range to the smallest range that holds both
+
+    /// \param[in,out] first The first column of the range
+    /// \param[in,out] last The end of the range
+    /// \param f The first column of the added range
+    /// \param l The end of the added range
+    static void hull(size_type& first, size_type& last, const size_type f,
+        const size_type l)
+    {
+      if(f >= l)
+        return;
+      if(first >= last) {
+        first = f;
+        last = l;
+      } else {
+        first = std::min(first, f);
+        last = std::max(last, l);
+      }
+    }
+
+    /// Intersect two column ranges
+
+    /// \param[in,out] first The first column of the range
+    /// \param[in,out] last The end of the range
+    /// \param f The first column of the other range
+    /// \param l The end of the other range
+    static void intersect(size_type& first, size_type& last, const size_type f,
+        const size_type l)
+    {
+      first = std::max(first, f);
+      last = std::min(last, l);
+      if(first >= last)
+        first = last = 0ul;
+    }
+
+    /// Count the non-zero tiles and check that the rows are monotone
+    void init() {
+      TA_ASSERT(first_.size() == rows_);
+      TA_ASSERT(last_.size() == rows_);
+      nonzero_ = 0ul;
+      monotone_ = true;
+      for(size_type i = 0ul; i < rows_; ++i) {
+        TA_ASSERT(last_[i] <= cols_);
+        if(first_[i] >= last_[i]) {
+          first_[i] = last_[i] = 0ul;
+          monotone_ = false;
+          continue;
+        }
+        nonzero_ += last_[i] - first_[i];
+        if((i > 0ul) && ((first_[i] < first_[i - 1ul]) || (last_[i] < last_[i - 1ul])))
+          monotone_ = false;
+      }
+    }
+
+    /// Construct a shape with all rows empty
+
+    /// \param range The tiles range
+    explicit BandShape(const Range& range, std::nullptr_t) :
+      range_(range),
+      rows_(range.rank() == 2u ? range.extent_data()[0] : 1ul),
+      cols_(range.extent_data()[range.rank() - 1u]),
+      first_(rows_, 0ul), last_(rows_, 0ul), nonzero_(0ul), monotone_(false)
+    {
+      TA_USER_ASSERT((range.rank() == 1u) || (range.rank() == 2u),
+          "BandShape: only rank 1 and rank 2 tile ranges are supported.");
+    }
+
+    /// The tile row and column of the bounds of a block
+
+    /// \tparam Index The bound type
+    /// \param bound The lower or upper bound of a block
+    /// \param row The tile row of a rank-1 shape
+    /// \return The row and the column of \c bound
+    template <typename Index>
+    std::pair<size_type, size_type> row_col(const Index& bound,
+        const size_type row) const
+    {
+      TA_ASSERT(detail::size(bound) == range_.rank());
+      const auto* const data = detail::data(bound);
+      return (range_.rank() == 2u ?
+          std::make_pair(size_type(data[0]), size_type(data[1])) :
+          std::make_pair(row, size_type(data[0])));
+    }
+
+    /// The transpose of a rank-2 shape
+
+    /// \return The shape of the transposed matrix
+    BandShape_ transpose() const {
+      TA_ASSERT(range_.rank() == 2u);
+      BandShape_ result(Permutation{ 1u, 0u } * range_, nullptr);
+      if(monotone_) {
+        // The rows of column j are those that end after j and start at or
+        // before j, which are contiguous.
+        size_type begin = 0ul, end = 0ul;
+        for(size_type j = 0ul; j < cols_; ++j) {
+          while((begin < rows_) && (last_[begin] <= j))
+            ++begin;
+          while((end < rows_) && (first_[end] <= j))
+            ++end;
+          hull(result.first_[j], result.last_[j], begin, std::max(begin, end));
+        }
+      } else {
+        for(size_type i = 0ul; i < rows_; ++i)
+          for(size_type j = first_[i]; j < last_[i]; ++j)
+            hull(result.first_[j], result.last_[j], i, i + 1ul);
+      }
+      result.init();
+      return result;
+    }
+
+    /// Combine the rows of two shapes
+
+    /// \tparam Op The row operation type
+    /// \param other The other shape
+    /// \param op The row operation, which is \c hull() or \c intersect()
+    /// \return The combined shape
+    template <typename Op>
+    BandShape_ combine(const BandShape_& other, const Op& op) const {
+      TA_ASSERT(range_ == other.range_);
+      BandShape_ result(*this);
+      for(size_type i = 0ul; i < rows_; ++i)
+        op(result.first_[i], result.last_[i], other.first_[i], other.last_[i]);
+      result.init();
+      return result;
+    }
+
+  public:
+
+    /// Default constructor
+
+    /// Constructs an empty shape.
+    BandShape() :
+      range_(), rows_(0ul), cols_(0ul), first_(), last_(), nonzero_(0ul),
+      monotone_(false)
+    { }
+
+    /// Constructor
+
+    /// \param range The tiles range, which has rank 1 or 2
+    /// \param first The first non-zero tile column of each tile row
+    /// \param last The non-zero tile columns of each tile row end before this
+    /// column; rows where it is not greater than \c first are zero
+    BandShape(const Range& range, std::vector<size_type> first,
+        std::vector<size_type> last) :
+      BandShape(range, nullptr)
+    {
+      TA_USER_ASSERT((first.size() == rows_) && (last.size() == rows_),
+          "BandShape: the column ranges must be given for each tile row.");
+      for(size_type i = 0ul; i < rows_; ++i)
+        TA_USER_ASSERT(last[i] <= cols_,
+            "BandShape: the column ranges must be inside the tiles range.");
+      first_ = std::move(first);
+      last_ = std::move(last);
+      init();
+    }
+
+    /// Construct a band shape
+
+    /// Tile \f$(i,j)\f$ is non-zero when \f$i - lower \le j \le i + upper\f$ .
+    /// \param range The rank-2 tiles range
+    /// \param lower The number of tile diagonals below the main diagonal
+    /// \param upper The number of tile diagonals above the main diagonal
+    /// \return The band shape
+    static BandShape_ band(const Range& range, const size_type lower,
+        const size_type upper)
+    {
+      TA_USER_ASSERT(range.rank() == 2u, "BandShape::band(): the range must have rank 2.");
+      BandShape_ result(range, nullptr);
+      for(size_type i = 0ul; i < result.rows_; ++i) {
+        result.first_[i] = (i > lower ? i - lower : 0ul);
+        result.last_[i] = std::min(i + upper + 1ul, result.cols_);
+      }
+      result.init();
+      return result;
+    }
+
+    /// Construct a block-diagonal shape
+
+    /// \param range The rank-2 tiles range
+    /// \param blocks The number of tile rows and columns of each diagonal
+    /// block, which must add up to the number of tile rows and of tile
+    /// columns
+    /// \return The block-diagonal shape
+    static BandShape_ block_diagonal(const Range& range,
+        const std::vector<size_type>& blocks)
+    {
+      TA_USER_ASSERT(range.rank() == 2u,
+          "BandShape::block_diagonal(): the range must have rank 2.");
+      BandShape_ result(range, nullptr);
+      size_type first = 0ul;
+      for(const size_type block : blocks) {
+        TA_USER_ASSERT(first + block <= std::min(result.rows_, result.cols_),
+            "BandShape::block_diagonal(): the blocks do not fit in the range.");
+        for(size_type i = first; i < first + block; ++i) {
+          result.first_[i] = first;
+          result.last_[i] = first + block;
+        }
+        first += block;
+      }
+      TA_USER_ASSERT((first == result.rows_) && (first == result.cols_),
+          "BandShape::block_diagonal(): the blocks must cover the range.");
+      result.init();
+      return result;
+    }
+
+    /// Construct a shape where all tiles are non-zero
+
+    /// \param range The tiles range
+    /// \return The full shape
+    static BandShape_ full(const Range& range) {
+      BandShape_ result(range, nullptr);
+      std::fill(result.last_.begin(), result.last_.end(), result.cols_);
+      result.init();
+      return result;
+    }
+
+    /// Collective initialization of a shape
+
+    /// No operation, since all processes construct the same shape.
+    static void collective_init(World&) { }
+
+    /// Validate shape range
+
+    /// \return \c true when range matches the range of this shape
+    bool validate(const Range& range) const {
+      return (! empty()) && (range == range_);
+    }
+
+    /// Check that a tile is zero
+
+    /// \tparam Index The type of the index
+    /// \param i The ordinal or the coordinate index of the tile
+    /// \return \c true if tile \c i is outside of the range of its row
+    template <typename Index>
+    bool is_zero(const Index& i) const {
+      TA_ASSERT(! empty());
+      const size_type ordinal = range_.ordinal(i);
+      const size_type row = ordinal / cols_;
+      const size_type col = ordinal - row * cols_;
+      return (col < first_[row]) || (col >= last_[row]);
+    }
+
+    /// Check density
+
+    /// \return false
+    static constexpr bool is_dense() { return false; }
+
+    /// Sparsity of the shape
+
+    /// \return The fraction of tiles that are zero.
+    float sparsity() const {
+      TA_ASSERT(! empty());
+      return 1.0f - float(nonzero_) / float(range_.volume());
+    }
+
+    /// Initialization check
+
+    /// \return \c true when this shape has been initialized.
+    bool empty() const { return first_.empty(); }
+
+    /// \return The tiles range
+    const Range& range() const { return range_; }
+
+    /// \param row The tile row
+    /// \return The first non-zero tile column of \c row
+    size_type first(const size_type row) const { return first_[row]; }
+
+    /// \param row The tile row
+    /// \return The end of the non-zero tile columns of \c row
+    size_type last(const size_type row) const { return last_[row]; }
+
+    /// \return \c true if all rows are non-empty and their ranges do not
+    /// start or end before those of earlier rows
+    bool is_monotone() const { return monotone_; }
+
+    /// Mask the shape with another shape
+
+    /// \param mask_shape The mask
+    /// \return The tiles that are non-zero in both shapes
+    BandShape_ mask(const BandShape_& mask_shape) const {
+      return combine(mask_shape, & BandShape_::intersect);
+    }
+
+    /// Mask the shape with a tile mask
+
+    /// The range of each row is reduced to the range of its tiles that are
+    /// set in \c tile_mask .
+    /// \tparam Block The bitset block type
+    /// \param tile_mask The tile mask, with one bit per tile in ordinal order
+    /// \return The masked shape
+    template <typename Block>
+    BandShape_ mask(const detail::Bitset<Block>& tile_mask) const {
+      TA_ASSERT(tile_mask.size() == range_.volume());
+      BandShape_ result(range_, nullptr);
+      for(size_type i = 0ul; i < rows_; ++i)
+        for(size_type j = first_[i]; j < last_[i]; ++j)
+          if(tile_mask[i * cols_ + j])
+            hull(result.first_[i], result.last_[i], j, j + 1ul);
+      result.init();
+      return result;
+    }
+
+    /// Zero threshold
+
+    /// Band shapes have no norms, so thresholds are ignored.
+    /// \return A copy of this shape
+    template <typename Scalar>
+    BandShape_ with_threshold(const Scalar) const { return *this; }
+
+    /// Replace a sub-block of the shape
+
+    /// \tparam Index The upper and lower bound array type
+    /// \param lower_bound The lower bound of the sub-block
+    /// \param upper_bound The upper bound of the sub-block
+    /// \param other The shape of the sub-block
+    /// \return The updated shape
+    template <typename Index>
+    BandShape_ update_block(const Index& lower_bound, const Index& upper_bound,
+        const BandShape_& other) const
+    {
+      const auto lower = row_col(lower_bound, 0ul);
+      const auto upper = row_col(upper_bound, 1ul);
+      BandShape_ result(*this);
+      for(size_type i = lower.first; i < upper.first; ++i) {
+        size_type first = 0ul, last = 0ul;
+        hull(first, last, first_[i], std::min(last_[i], lower.second));
+        hull(first, last, std::max(first_[i], upper.second), last_[i]);
+        const size_type r = i - lower.first;
+        hull(first, last, other.first_[r] + lower.second,
+            other.last_[r] + lower.second);
+        result.first_[i] = first;
+        result.last_[i] = last;
+      }
+      result.init();
+      return result;
+    }
+
+    /// Create a copy of a sub-block of the shape
+
+    /// \tparam Index The upper and lower bound array type
+    /// \param lower_bound The lower bound of the sub-block
+    /// \param upper_bound The upper bound of the sub-block
+    /// \return The shape of the sub-block
+    template <typename Index>
+    BandShape_ block(const Index& lower_bound, const Index& upper_bound) const {
+      const auto lower = row_col(lower_bound, 0ul);
+      const auto upper = row_col(upper_bound, 1ul);
+      TA_ASSERT((lower.first < upper.first) && (upper.first <= rows_));
+      TA_ASSERT((lower.second < upper.second) && (upper.second <= cols_));
+
+      std::vector<size_type> extent(range_.rank());
+      for(unsigned int d = 0u; d < range_.rank(); ++d)
+        extent[d] = detail::data(upper_bound)[d] - detail::data(lower_bound)[d];
+      BandShape_ result(Range(extent), nullptr);
+      for(size_type i = lower.first; i < upper.first; ++i) {
+        size_type first = first_[i], last = last_[i];
+        intersect(first, last, lower.second, upper.second);
+        if(first < last) {
+          result.first_[i - lower.first] = first - lower.second;
+          result.last_[i - lower.first] = last - lower.second;
+        }
+      }
+      result.init();
+      return result;
+    }
+
+    template <typename Index, typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    BandShape_ block(const Index& lower_bound, const Index& upper_bound,
+        const Scalar) const
+    { return block(lower_bound, upper_bound); }
+
+    template <typename Index>
+    BandShape_ block(const Index& lower_bound, const Index& upper_bound,
+        const Permutation& perm) const
+    { return block(lower_bound, upper_bound).perm(perm); }
+
+    template <typename Index, typename Scalar>
+    BandShape_ block(const Index& lower_bound, const Index& upper_bound,
+        const Scalar, const Permutation& perm) const
+    { return block(lower_bound, upper_bound).perm(perm); }
+
+    /// Permute the shape
+
+    /// \param perm The permutation, which is the identity or, for rank-2
+    /// shapes, the transpose
+    /// \return The permuted shape
+    BandShape_ perm(const Permutation& perm) const {
+      if(! perm)
+        return *this;
+      TA_ASSERT(perm.dim() == range_.rank());
+      return transpose();
+    }
+
+    template <typename Scalar>
+    BandShape_ scale(const Scalar) const { return *this; }
+
+    template <typename Scalar>
+    BandShape_ scale(const Scalar, const Permutation& perm) const
+    { return this->perm(perm); }
+
+    BandShape_ add(const BandShape_& other) const
+    { return combine(other, & BandShape_::hull); }
+
+    BandShape_ add(const BandShape_& other, const Permutation& perm) const
+    { return add(other).perm(perm); }
+
+    template <typename Scalar>
+    BandShape_ add(const BandShape_& other, const Scalar) const
+    { return add(other); }
+
+    template <typename Scalar>
+    BandShape_ add(const BandShape_& other, const Scalar, const Permutation& perm) const
+    { return add(other).perm(perm); }
+
+    template <typename Scalar>
+    BandShape_ add(const Scalar) const { return full(range_); }
+
+    template <typename Scalar>
+    BandShape_ add(const Scalar, const Permutation& perm) const
+    { return full(perm * range_); }
+
+    BandShape_ subt(const BandShape_& other) const { return add(other); }
+
+    BandShape_ subt(const BandShape_& other, const Permutation& perm) const
+    { return add(other, perm); }
+
+    template <typename Scalar>
+    BandShape_ subt(const BandShape_& other, const Scalar) const
+    { return add(other); }
+
+    template <typename Scalar>
+    BandShape_ subt(const BandShape_& other, const Scalar, const Permutation& perm) const
+    { return add(other, perm); }
+
+    template <typename Scalar>
+    BandShape_ subt(const Scalar) const { return full(range_); }
+
+    template <typename Scalar>
+    BandShape_ subt(const Scalar, const Permutation& perm) const
+    { return full(perm * range_); }
+
+    BandShape_ mult(const BandShape_& other) const
+    { return combine(other, & BandShape_::intersect); }
+
+    BandShape_ mult(const BandShape_& other, const Permutation& perm) const
+    { return mult(other).perm(perm); }
+
+    template <typename Scalar>
+    BandShape_ mult(const BandShape_& other, const Scalar) const
+    { return mult(other); }
+
+    template <typename Scalar>
+    BandShape_ mult(const BandShape_& other, const Scalar, const Permutation& perm) const
+    { return mult(other).perm(perm); }
+
+    /// Contract two shapes
+
+    /// Row \c i of the result holds the columns of the rows \c k of
+    /// \c other where tile \f$(i,k)\f$ of this shape is non-zero. When the
+    /// rows of \c other are monotone, these are the columns from the first
+    /// column of its row <tt>first(i)</tt> to the last column of its row
+    /// <tt>last(i) - 1</tt> , so the result is computed in O(rows) time.
+    /// Only matrix products are supported.
+    /// \tparam Scalar The scaling factor type
+    /// \param other The right-hand shape
+    /// \param gemm_helper The contraction helper
+    /// \return The shape of the product
+    template <typename Scalar>
+    BandShape_ gemm(const BandShape_& other, const Scalar,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_USER_ASSERT((range_.rank() == 2u) && (other.range_.rank() == 2u) &&
+          (gemm_helper.result_rank() == 2u),
+          "BandShape::gemm(): only matrix products are supported.");
+      TA_ASSERT(cols_ == other.rows_);
+
+      BandShape_ result(gemm_helper.make_result_range<Range>(range_,
+          other.range_), nullptr);
+      for(size_type i = 0ul; i < rows_; ++i) {
+        if(first_[i] >= last_[i])
+          continue;
+        if(other.monotone_) {
+          result.first_[i] = other.first_[first_[i]];
+          result.last_[i] = other.last_[last_[i] - 1ul];
+        } else {
+          for(size_type k = first_[i]; k < last_[i]; ++k)
+            hull(result.first_[i], result.last_[i], other.first_[k], other.last_[k]);
+        }
+      }
+      result.init();
+      return result;
+    }
+
+    template <typename Scalar>
+    BandShape_ gemm(const BandShape_& other, const Scalar factor,
+        const math::GemmHelper& gemm_helper, const Permutation& perm) const
+    { return gemm(other, factor, gemm_helper).perm(perm); }
+
+    template <typename Scalar, typename Block>
+    BandShape_ gemm(const BandShape_& other, const Scalar factor,
+        const math::GemmHelper& gemm_helper,
+        const detail::Bitset<Block>& tile_mask) const
+    { return gemm(other, factor, gemm_helper).mask(tile_mask); }
+
+    template <typename Scalar, typename Block>
+    BandShape_ gemm(const BandShape_& other, const Scalar factor,
+        const math::GemmHelper& gemm_helper, const Permutation& perm,
+        const detail::Bitset<Block>& tile_mask) const
+    { return gemm(other, factor, gemm_helper, tile_mask).perm(perm); }
+
+    /// Sum over dimensions
+
+    /// \param dims The summed dimensions
+    /// \return The rank-1 shape of the dimension that is not summed, or a
+    /// copy of this shape if \c dims is empty
+    BandShape_ sum_over(const std::vector<unsigned int>& dims) const {
+      if(dims.empty())
+        return *this;
+      TA_ASSERT((range_.rank() == 2u) && (dims.size() == 1ul) && (dims[0] < 2u));
+      const bool rows = (dims[0] == 1u);
+      BandShape_ result(Range(std::vector<size_type>(1ul,
+          range_.extent_data()[rows ? 0u : 1u])), nullptr);
+      for(size_type i = 0ul; i < rows_; ++i) {
+        if(rows && (first_[i] < last_[i]))
+          hull(result.first_[0], result.last_[0], i, i + 1ul);
+        else if(! rows)
+          hull(result.first_[0], result.last_[0], first_[i], last_[i]);
+      }
+      result.init();
+      return result;
+    }
+
+  }; // class BandShape
+
+  namespace detail {
+
+    /// Compare two band shapes
+
+    /// \return \c true if the shapes have the same range and non-zero tiles
+    inline bool is_same_shape(const BandShape& left, const BandShape& right) {
+      if(! (left.range() == right.range()))
+        return false;
+      const std::size_t rows = (left.range().rank() == 2u ?
+          left.range().extent_data()[0] : 1ul);
+      for(std::size_t i = 0ul; i < rows; ++i)
+        if((left.first(i) != right.first(i)) || (left.last(i) != right.last(i)))
+          return false;
+      return true;
+    }
+
+  } // namespace detail
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_BAND_SHAPE_H__INCLUDED
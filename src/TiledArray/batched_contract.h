@@ -0,0 +1,402 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  batched_contract.h
+ *  Mar 6, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_BATCHED_CONTRACT_H__INCLUDED
+#define TILEDARRAY_BATCHED_CONTRACT_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/math/blas.h>
+#include <TiledArray/tensor/type_traits.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The structure of a contraction with batch indices
+
+    /// The indices of the arguments are classified as batch indices, which
+    /// are in both arguments and in the result, inner indices, which are in
+    /// both arguments and are summed, and outer indices, which are in one
+    /// argument and in the result. The argument tiles are permuted to
+    /// (batch, left outer, inner) and (batch, inner, right outer) order, so
+    /// each batch element is a matrix multiplication of contiguous
+    /// sub-matrices.
+    class BatchedContraction {
+    public:
+      /// The position of an argument dimension in the result or inner indices
+      struct Source {
+        bool inner; ///< \c true if the dimension is an inner index
+        unsigned int dim; ///< The result or inner dimension
+      }; // struct Source
+
+      unsigned int batch_rank; ///< The number of batch indices
+      unsigned int left_outer_rank; ///< The number of left outer indices
+      unsigned int inner_rank; ///< The number of inner indices
+      std::vector<Source> left_sources; ///< The source of each left dimension
+      std::vector<Source> right_sources; ///< The source of each right dimension
+      std::vector<std::pair<bool, unsigned int> > result_dims; ///< The
+          ///< argument (\c true for left) and dimension of each result dimension
+      Permutation left_perm; ///< Permutes left tiles to (batch, outer, inner)
+      Permutation right_perm; ///< Permutes right tiles to (batch, inner, outer)
+      Permutation result_perm; ///< Permutes (batch, left outer, right outer)
+          ///< tiles to the result
+
+      /// Constructor
+
+      /// \param left The left-hand variable list
+      /// \param right The right-hand variable list
+      /// \param result The result variable list
+      /// \throw TiledArray::Exception When an index is in only one argument
+      /// and not in the result, or a result index is in neither argument
+      BatchedContraction(const expressions::VariableList& left,
+          const expressions::VariableList& right,
+          const expressions::VariableList& result) :
+        batch_rank(0u), left_outer_rank(0u), inner_rank(0u),
+        left_sources(left.dim()), right_sources(right.dim()),
+        result_dims(result.dim())
+      {
+        const auto find = [] (const expressions::VariableList& vars,
+            const std::string& var) -> unsigned int
+        {
+          unsigned int i = 0u;
+          for(; i < vars.dim(); ++i)
+            if(vars[i] == var)
+              break;
+          return i;
+        };
+
+        std::vector<std::string> batch, left_outer, inner, right_outer;
+        for(unsigned int i = 0u; i < left.dim(); ++i) {
+          const bool in_right = find(right, left[i]) < right.dim();
+          const bool in_result = find(result, left[i]) < result.dim();
+          TA_USER_ASSERT(in_right || in_result,
+              "batched_contract(): the left-hand index is not in the right-hand argument or the result.");
+          if(in_right && in_result)
+            batch.push_back(left[i]);
+          else if(in_right)
+            inner.push_back(left[i]);
+          else
+            left_outer.push_back(left[i]);
+        }
+        for(unsigned int i = 0u; i < right.dim(); ++i) {
+          if(find(left, right[i]) < left.dim())
+            continue;
+          TA_USER_ASSERT(find(result, right[i]) < result.dim(),
+              "batched_contract(): the right-hand index is not in the left-hand argument or the result.");
+          right_outer.push_back(right[i]);
+        }
+        TA_USER_ASSERT(result.dim() ==
+            batch.size() + left_outer.size() + right_outer.size(),
+            "batched_contract(): the result index is not in the arguments.");
+        batch_rank = batch.size();
+        left_outer_rank = left_outer.size();
+        inner_rank = inner.size();
+
+        // Compute the permutations of the tiles
+        std::vector<std::string> left_vars(batch), right_vars(batch),
+            result_vars(batch);
+        left_vars.insert(left_vars.end(), left_outer.begin(), left_outer.end());
+        left_vars.insert(left_vars.end(), inner.begin(), inner.end());
+        right_vars.insert(right_vars.end(), inner.begin(), inner.end());
+        right_vars.insert(right_vars.end(), right_outer.begin(), right_outer.end());
+        result_vars.insert(result_vars.end(), left_outer.begin(), left_outer.end());
+        result_vars.insert(result_vars.end(), right_outer.begin(), right_outer.end());
+        left_perm = expressions::VariableList(left_vars.begin(),
+            left_vars.end()).permutation(left);
+        right_perm = expressions::VariableList(right_vars.begin(),
+            right_vars.end()).permutation(right);
+        result_perm = result.permutation(
+            expressions::VariableList(result_vars.begin(), result_vars.end()));
+
+        // Map the argument dimensions to the result and inner dimensions
+        const expressions::VariableList inner_vars(inner.begin(), inner.end());
+        for(unsigned int i = 0u; i < left.dim(); ++i) {
+          const unsigned int r = find(result, left[i]);
+          left_sources[i] = (r < result.dim() ? Source{ false, r } :
+              Source{ true, find(inner_vars, left[i]) });
+          if(r < result.dim())
+            result_dims[r] = std::make_pair(true, i);
+        }
+        for(unsigned int i = 0u; i < right.dim(); ++i) {
+          const unsigned int r = find(result, right[i]);
+          right_sources[i] = (r < result.dim() ? Source{ false, r } :
+              Source{ true, find(inner_vars, right[i]) });
+          if((r < result.dim()) && (find(left, right[i]) == left.dim()))
+            result_dims[r] = std::make_pair(false, i);
+        }
+      }
+
+      /// Argument tile index
+
+      /// \tparam Index The index type
+      /// \param sources The sources of the argument dimensions
+      /// \param result The result tile index
+      /// \param inner The inner tile index
+      /// \return The argument tile index
+      template <typename Index>
+      static std::vector<std::size_t> arg_index(const std::vector<Source>& sources,
+          const Index& result, const std::vector<std::size_t>& inner)
+      {
+        std::vector<std::size_t> index;
+        index.reserve(sources.size());
+        for(const Source& source : sources)
+          index.push_back(source.inner ? inner[source.dim] : result[source.dim]);
+        return index;
+      }
+
+    }; // class BatchedContraction
+
+    /// Visit the non-zero argument tile pairs of a result tile
+
+    /// \tparam Left The left-hand array type
+    /// \tparam Right The right-hand array type
+    /// \tparam Op The visitor type
+    /// \param contraction The contraction structure
+    /// \param left The left-hand array
+    /// \param right The right-hand array
+    /// \param inner_range The range of the inner tile indices
+    /// \param index The result tile index
+    /// \param op The visitor, which takes the ordinal indices of a left- and
+    /// a right-hand tile
+    template <typename Left, typename Right, typename Index, typename Op>
+    inline void batched_contract_pairs(const BatchedContraction& contraction,
+        const Left& left, const Right& right, const Range& inner_range,
+        const Index& index, const Op& op)
+    {
+      const auto visit = [&] (const std::vector<std::size_t>& inner) {
+        const std::size_t l = left.trange().tiles_range().ordinal(
+            BatchedContraction::arg_index(contraction.left_sources, index, inner));
+        const std::size_t r = right.trange().tiles_range().ordinal(
+            BatchedContraction::arg_index(contraction.right_sources, index, inner));
+        if(! (left.is_zero(l) || right.is_zero(r)))
+          op(l, r);
+      };
+
+      if(contraction.inner_rank == 0u) {
+        visit(std::vector<std::size_t>());
+      } else {
+        for(auto it = inner_range.begin(); it != inner_range.end(); ++it) {
+          const auto& inner = *it;
+          visit(std::vector<std::size_t>(inner.begin(), inner.end()));
+        }
+      }
+    }
+
+    /// Dense result shape of a contraction with batch indices
+    template <typename Left, typename Right>
+    inline DenseShape
+    batched_contract_shape(const BatchedContraction&, const Left&, const Right&,
+        const TiledRange&, const Range&, const DenseShape&)
+    { return DenseShape(); }
+
+    /// Sparse result shape of a contraction with batch indices
+
+    /// The norm of a result tile is bounded by the sum of the products of
+    /// the norms of its argument tile pairs.
+    template <typename Left, typename Right, typename T>
+    inline SparseShape<T>
+    batched_contract_shape(const BatchedContraction& contraction,
+        const Left& left, const Right& right, const TiledRange& trange,
+        const Range& inner_range, const SparseShape<T>&)
+    {
+      const auto tile_norm = [] (const TiledRange& trange,
+          const SparseShape<T>& shape, const std::size_t i)
+      {
+        return shape[i] * T(trange.make_tile_range(i).volume());
+      };
+
+      Tensor<T> norms(trange.tiles_range(), T(0));
+      for(std::size_t i = 0ul; i < norms.size(); ++i)
+        batched_contract_pairs(contraction, left, right, inner_range,
+            trange.tiles_range().idx(i),
+            [&] (const std::size_t l, const std::size_t r) {
+              norms[i] += tile_norm(left.trange(), left.shape(), l) *
+                  tile_norm(right.trange(), right.shape(), r);
+            });
+      return SparseShape<T>(norms, trange);
+    }
+
+    /// Contract the tile pairs of a result tile with batch indices
+
+    /// \tparam Tile The tile type
+    /// \param contraction The contraction structure
+    /// \param range The range of the result tile
+    /// \param left The left-hand tiles
+    /// \param right The right-hand tiles
+    /// \return The sum of the batched contractions of the tile pairs
+    template <typename Tile>
+    inline Tile batched_contract_tile(
+        const std::shared_ptr<const BatchedContraction>& contraction,
+        const Range& range, const std::vector<Future<Tile> >& left,
+        const std::vector<Future<Tile> >& right)
+    {
+      typedef typename Tile::numeric_type numeric_type;
+      TA_ASSERT(left.size() == right.size());
+      if(left.empty())
+        return Tile(range, numeric_type(0));
+
+      const auto product = [] (const Range& r, const unsigned int first,
+          const unsigned int last) {
+        std::size_t n = 1ul;
+        for(unsigned int d = first; d < last; ++d)
+          n *= r.extent(d);
+        return n;
+      };
+
+      Tile result;
+      std::size_t batch = 0ul, m = 0ul, n = 0ul;
+      for(std::size_t p = 0ul; p < left.size(); ++p) {
+        const Tile l = (contraction->left_perm ?
+            left[p].get().permute(contraction->left_perm) : left[p].get());
+        const Tile r = (contraction->right_perm ?
+            right[p].get().permute(contraction->right_perm) : right[p].get());
+        const unsigned int outer_end = contraction->batch_rank +
+            contraction->left_outer_rank;
+        const unsigned int inner_end = contraction->batch_rank +
+            contraction->inner_rank;
+        const std::size_t k = product(l.range(), outer_end, l.range().rank());
+
+        if(p == 0ul) {
+          // Construct the result tile in (batch, left outer, right outer)
+          // order
+          std::vector<std::size_t> lower(l.range().lobound_data(),
+              l.range().lobound_data() + outer_end);
+          std::vector<std::size_t> upper(l.range().upbound_data(),
+              l.range().upbound_data() + outer_end);
+          lower.insert(lower.end(), r.range().lobound_data() + inner_end,
+              r.range().lobound_data() + r.range().rank());
+          upper.insert(upper.end(), r.range().upbound_data() + inner_end,
+              r.range().upbound_data() + r.range().rank());
+          result = Tile(Range(lower, upper), numeric_type(0));
+          batch = product(l.range(), 0u, contraction->batch_rank);
+          m = product(l.range(), contraction->batch_rank, outer_end);
+          n = product(r.range(), inner_end, r.range().rank());
+        }
+
+        // Contract each batch element
+        for(std::size_t b = 0ul; b < batch; ++b)
+          math::gemm(madness::cblas::NoTrans, madness::cblas::NoTrans, m, n, k,
+              numeric_type(1), l.data() + b * m * k, k, r.data() + b * k * n, n,
+              numeric_type(1), result.data() + b * m * n, n);
+      }
+
+      if(contraction->result_perm)
+        result = result.permute(contraction->result_perm);
+      TA_ASSERT(result.range() == range);
+      return result;
+    }
+
+  }  // namespace detail
+
+  /// Contraction with batch (Hadamard) indices
+
+  /// Indices that are in both arguments and in the result, e.g. \c j in
+  /// <tt>c("i,j,a") = a("i,j,k") * b("k,j,a")</tt> , are batch indices:
+  /// each batch element is a separate contraction over the inner indices,
+  /// which are in both arguments but not in the result. Contractions
+  /// without batch indices are better evaluated with expressions.
+  /// Every result tile is computed by a task on the process that owns the
+  /// tile, which contracts the argument tile pairs of the tile, so all
+  /// batch elements are evaluated in parallel and distributed like the
+  /// result. Each batch element of a tile pair is contracted with a matrix
+  /// multiplication. The shape of sparse results is bounded by the norms of
+  /// the argument tile pairs. This function is collective.
+  /// \tparam Tile The tile type, which must be a \c Tensor
+  /// \tparam Policy The array policy type
+  /// \param left The left-hand array
+  /// \param left_vars The indices of the left-hand array
+  /// \param right The right-hand array
+  /// \param right_vars The indices of the right-hand array
+  /// \param result_vars The indices of the result
+  /// \return The result array, distributed with the default process map
+  /// \throw TiledArray::Exception When the indices are not a contraction,
+  /// or the tiling of an index differs between the arguments
+  template <typename Tile, typename Policy>
+  inline DistArray<Tile, Policy>
+  batched_contract(const DistArray<Tile, Policy>& left, const std::string& left_vars,
+      const DistArray<Tile, Policy>& right, const std::string& right_vars,
+      const std::string& result_vars)
+  {
+    static_assert(detail::is_tensor<Tile>::value,
+        "batched_contract(): the tile type must be a Tensor.");
+    const expressions::VariableList lvars(left_vars), rvars(right_vars),
+        cvars(result_vars);
+    TA_USER_ASSERT(lvars.dim() == left.trange().tiles_range().rank(),
+        "batched_contract(): the left-hand indices do not match the array.");
+    TA_USER_ASSERT(rvars.dim() == right.trange().tiles_range().rank(),
+        "batched_contract(): the right-hand indices do not match the array.");
+    const std::shared_ptr<const detail::BatchedContraction> contraction =
+        std::make_shared<const detail::BatchedContraction>(lvars, rvars, cvars);
+
+    // Construct the result tiled range and the range of the inner tiles
+    std::vector<TiledRange1> result_trange1;
+    for(const auto& dim : contraction->result_dims)
+      result_trange1.push_back(dim.first ? left.trange().data()[dim.second] :
+          right.trange().data()[dim.second]);
+    std::vector<std::size_t> inner_lower(contraction->inner_rank),
+        inner_upper(contraction->inner_rank);
+    for(unsigned int i = 0u; i < lvars.dim(); ++i) {
+      const detail::BatchedContraction::Source& source =
+          contraction->left_sources[i];
+      for(unsigned int j = 0u; j < rvars.dim(); ++j)
+        if(rvars[j] == lvars[i])
+          TA_USER_ASSERT(left.trange().data()[i] == right.trange().data()[j],
+              "batched_contract(): the tiling of an index differs between the arguments.");
+      if(source.inner) {
+        inner_lower[source.dim] = left.trange().data()[i].tiles_range().first;
+        inner_upper[source.dim] = left.trange().data()[i].tiles_range().second;
+      }
+    }
+    const TiledRange trange(result_trange1.begin(), result_trange1.end());
+    const Range inner_range = (contraction->inner_rank ?
+        Range(inner_lower, inner_upper) : Range());
+
+    typedef typename DistArray<Tile, Policy>::shape_type shape_type;
+    const shape_type shape = detail::batched_contract_shape(*contraction, left,
+        right, trange, inner_range, left.shape());
+    DistArray<Tile, Policy> result(left.world(), trange, shape);
+
+    // Contract the tile pairs of the local result tiles
+    for(const std::size_t index : *result.pmap()) {
+      if(result.is_zero(index))
+        continue;
+      std::vector<Future<Tile> > left_tiles, right_tiles;
+      detail::batched_contract_pairs(*contraction, left, right, inner_range,
+          trange.tiles_range().idx(index),
+          [&] (const std::size_t l, const std::size_t r) {
+            left_tiles.push_back(left.find(l));
+            right_tiles.push_back(right.find(r));
+          });
+      result.set(index, left.world().taskq.add(
+          & detail::batched_contract_tile<Tile>, contraction,
+          trange.make_tile_range(index), left_tiles, right_tiles));
+    }
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_BATCHED_CONTRACT_H__INCLUDED
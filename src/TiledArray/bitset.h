@@ -25,10 +25,60 @@
 #include <climits>
 #include <iosfwd>
 #include <iomanip>
+#include <type_traits>
 
 namespace TiledArray {
   namespace detail {
 
+    /// Count the set bits of a word
+
+    /// \tparam Block An integral type
+    /// \param block The word
+    /// \return The number of set bits in \c block
+    template <typename Block>
+    inline unsigned int bit_count(const Block block) {
+      typedef typename std::make_unsigned<Block>::type word_type;
+      const word_type word = block;
+#if defined(__GNUC__) || defined(__clang__)
+      if(sizeof(word_type) <= sizeof(unsigned int))
+        return __builtin_popcount(word);
+      else if(sizeof(word_type) <= sizeof(unsigned long))
+        return __builtin_popcountl(word);
+      else
+        return __builtin_popcountll(word);
+#else
+      unsigned int c = 0u;
+      for(word_type w = word; w; w &= w - 1u)
+        ++c;
+      return c;
+#endif // defined(__GNUC__) || defined(__clang__)
+    }
+
+    /// Index of the lowest set bit of a word
+
+    /// \tparam Block An integral type
+    /// \param block The word, which must not be zero
+    /// \return The number of trailing zero bits of \c block
+    template <typename Block>
+    inline unsigned int trailing_zeros(const Block block) {
+      typedef typename std::make_unsigned<Block>::type word_type;
+      const word_type word = block;
+      TA_ASSERT(word != word_type(0));
+#if defined(__GNUC__) || defined(__clang__)
+      if(sizeof(word_type) <= sizeof(unsigned int))
+        return __builtin_ctz(word);
+      else if(sizeof(word_type) <= sizeof(unsigned long))
+        return __builtin_ctzl(word);
+      else
+        return __builtin_ctzll(word);
+#else
+      unsigned int c = 0u;
+      for(word_type w = word; ! (w & word_type(1)); w >>= 1)
+        ++c;
+      return c;
+#endif // defined(__GNUC__) || defined(__clang__)
+    }
+
     /// Fixed size bitset
 
     /// Bitset is similar to \c std::bitset except the size is set at runtime.
@@ -235,8 +285,10 @@ namespace TiledArray {
       /// \throw std::range_error If the bitset sizes are not equal.
       Bitset<Block>& operator|=(const Bitset<Block>& other) {
         TA_ASSERT(size_ == other.size_);
+        block_type* MADNESS_RESTRICT const left = set_;
+        const block_type* MADNESS_RESTRICT const right = other.set_;
         for(size_type i = 0; i < blocks_; ++i)
-          set_[i] |= other.set_[i];
+          left[i] |= right[i];
 
         return *this;
       }
@@ -248,8 +300,10 @@ namespace TiledArray {
       /// \throw std::range_error If the bitset sizes are not equal.
       Bitset<Block>& operator&=(const Bitset<Block>& other) {
         TA_ASSERT(size_ == other.size_);
+        block_type* MADNESS_RESTRICT const left = set_;
+        const block_type* MADNESS_RESTRICT const right = other.set_;
         for(size_type i = 0; i < blocks_; ++i)
-          set_[i] &= other.set_[i];
+          left[i] &= right[i];
 
         return *this;
       }
@@ -262,12 +316,54 @@ namespace TiledArray {
       /// \throw std::range_error If the bitset sizes are not equal.
       Bitset<Block>& operator^=(const Bitset<Block>& other) {
         TA_ASSERT(size_ == other.size_);
+        block_type* MADNESS_RESTRICT const left = set_;
+        const block_type* MADNESS_RESTRICT const right = other.set_;
+        for(size_type i = 0; i < blocks_; ++i)
+          left[i] ^= right[i];
+
+        return *this;
+      }
+
+      /// Subtract-assignment operator
+
+      /// Clear the bits of this bitset that are set in \c other
+      /// \param other The bitset to be subtracted from this bitset
+      /// \throw std::range_error If the bitset sizes are not equal.
+      Bitset<Block>& operator-=(const Bitset<Block>& other) {
+        TA_ASSERT(size_ == other.size_);
+        block_type* MADNESS_RESTRICT const left = set_;
+        const block_type* MADNESS_RESTRICT const right = other.set_;
         for(size_type i = 0; i < blocks_; ++i)
-          set_[i] ^= other.set_[i];
+          left[i] &= ~right[i];
 
         return *this;
       }
 
+      /// Check for common bits
+
+      /// \param other The bitset to be compared to this bitset
+      /// \return \c true when a bit is set in both bitsets
+      bool intersects(const Bitset<Block>& other) const {
+        TA_ASSERT(size_ == other.size_);
+        for(size_type i = 0; i < blocks_; ++i)
+          if(set_[i] & other.set_[i])
+            return true;
+        return false;
+      }
+
+      /// Count the common bits
+
+      /// \param other The bitset to be compared to this bitset
+      /// \return The number of bits that are set in both bitsets, i.e.
+      /// <tt>(*this & other).count()</tt> without the temporary bitset
+      size_type count_and(const Bitset<Block>& other) const {
+        TA_ASSERT(size_ == other.size_);
+        size_type c = 0ul;
+        for(size_type i = 0; i < blocks_; ++i)
+          c += bit_count(block_type(set_[i] & other.set_[i]));
+        return c;
+      }
+
     private:
 
       static void left_shift(Bitset<Block>& dest, const Bitset<Block>& source, size_type n) {
@@ -519,16 +615,40 @@ namespace TiledArray {
       /// \return The number of non-zero bits
       size_type count() const {
         size_type c = 0ul;
-        for(size_type i = 0ul; i < blocks_; ++i) {
-          block_type v = set_[i]; // temp
-          v = v - ((v >> 1) & xffff / 3);
-          v = (v & xffff / 15 * 3) + ((v >> 2) & xffff / 15 * 3);
-          v = (v + (v >> 4)) & xffff / 255 * 15;
-          c += block_type(v * (xffff / 255)) >> (sizeof(block_type) - 1) * CHAR_BIT; // count
-        }
+        for(size_type i = 0ul; i < blocks_; ++i)
+          c += bit_count(set_[i]);
         return c;
       }
 
+      /// Find the first set bit
+
+      /// \return The index of the first set bit, or \c size() when no bit
+      /// is set
+      size_type find_first() const {
+        for(size_type b = 0ul; b < blocks_; ++b)
+          if(set_[b])
+            return b * block_bits + trailing_zeros(set_[b]);
+        return size_;
+      }
+
+      /// Find the next set bit
+
+      /// \param i The bit index after which the search is started
+      /// \return The index of the first set bit after \c i , or \c size()
+      /// when no bit is set after \c i
+      size_type find_next(size_type i) const {
+        if(++i >= size_)
+          return size_;
+        size_type b = block_index(i);
+        block_type block = set_[b] & (xffff << bit_index(i));
+        while(! block) {
+          if(++b == blocks_)
+            return size_;
+          block = set_[b];
+        }
+        return b * block_bits + trailing_zeros(block);
+      }
+
       /// Data pointer accessor
 
       /// The pointer to the data points to a contiguous block of memory of type
@@ -594,6 +714,82 @@ namespace TiledArray {
       b0.swap(b1);
     }
 
+    /// Apply an operation to each set bit of a bitset
+
+    /// The set bits are visited in order, one block at a time, so the cost
+    /// is proportional to the number of blocks and set bits.
+    /// \tparam Block The bitset block type
+    /// \tparam Op The operation type, with signature <tt>void(std::size_t)</tt>
+    /// \param bits The bitset
+    /// \param op The operation, which is called with the index of each set
+    /// bit
+    template <typename Block, typename Op>
+    inline void for_each_set_bit(const Bitset<Block>& bits, Op&& op) {
+      const std::size_t block_bits = 8ul * sizeof(Block);
+      for(std::size_t b = 0ul; b < bits.num_blocks(); ++b) {
+        typename std::make_unsigned<Block>::type block = bits.get()[b];
+        while(block) {
+          op(b * block_bits + trailing_zeros(block));
+          block &= block - 1u;
+        }
+      }
+    }
+
+    /// Apply an operation to each run of equal bits of a bitset
+
+    /// \c op is called with the first and last (exclusive) indices of each
+    /// maximal run of set or cleared bits, in order. Blocks with all bits
+    /// set or cleared are handled without testing their bits, so masks with
+    /// long runs are applied with few calls of \c op .
+    /// \tparam Block The bitset block type
+    /// \tparam Op The run operation type, with signature
+    /// <tt>void(std::size_t first, std::size_t last, bool value)</tt>
+    /// \param bits The bitset
+    /// \param op The run operation
+    template <typename Block, typename Op>
+    inline void for_each_bit_run(const Bitset<Block>& bits, Op&& op) {
+      const std::size_t block_bits = 8ul * sizeof(Block);
+      const std::size_t size = bits.size();
+      std::size_t first = 0ul;
+      bool value = false;
+      auto add_run = [&] (const std::size_t i, const bool v) {
+        if(v != value) {
+          if(i > first)
+            op(first, i, value);
+          first = i;
+          value = v;
+        }
+      };
+
+      for(std::size_t b = 0ul; b < bits.num_blocks(); ++b) {
+        const Block block = bits.get()[b];
+        const std::size_t begin = b * block_bits;
+        const std::size_t end = std::min(begin + block_bits, size);
+        if(block == Block(0)) {
+          add_run(begin, false);
+        } else if((block == Block(~Block(0))) && (end - begin == block_bits)) {
+          add_run(begin, true);
+        } else {
+          // Jump to the end of each run within the block
+          typedef typename std::make_unsigned<Block>::type word_type;
+          word_type word = block;
+          std::size_t i = begin;
+          while(i < end) {
+            const bool v = word & word_type(1);
+            add_run(i, v);
+            const word_type rest = (v ? word_type(~word) : word);
+            const std::size_t n = (rest ? trailing_zeros(rest) : block_bits);
+            if(n >= (end - i))
+              break;
+            i += n;
+            word >>= n;
+          }
+        }
+      }
+      if(size > first)
+        op(first, size, value);
+    }
+
     // Bitset static constant data
     template <typename Block>
     const std::size_t Bitset<Block>::block_bits =
@@ -630,6 +826,18 @@ namespace TiledArray {
     }
 
 
+    /// Bitwise difference operator of bitset.
+
+    /// \tparam Block The bitset block type
+    /// \param left The left-hand bitset
+    /// \param right The right-hand bitset
+    /// \return The bits of \c left that are not set in \c right
+    template <typename Block>
+    Bitset<Block> operator-(Bitset<Block> left, const Bitset<Block>& right) {
+      left -= right;
+      return left;
+    }
+
     /// Bitwise xor operator of bitset.
 
     /// \tparam Block The bitset block type
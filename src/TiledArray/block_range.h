@@ -53,7 +53,7 @@ namespace TiledArray {
           [](const size_type l, const size_type r) { return l <= r; }));
 
       // Initialize the block range data members
-      data_ = new size_type[range.rank() << 2];
+      data_ = allocate(range.rank());
       offset_ = range.offset();
       volume_ = 1ul;
       rank_ = range.rank();
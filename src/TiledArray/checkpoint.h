@@ -0,0 +1,503 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  checkpoint.h
+ *  Feb 15, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CHECKPOINT_H__INCLUDED
+#define TILEDARRAY_CHECKPOINT_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/dense_shape.h>
+#include <TiledArray/sparse_shape.h>
+#include <madness/world/vector_archive.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Checkpoint format version
+    constexpr std::uint64_t checkpoint_version = 1ul;
+
+    /// Checkpoint file magic number, "TACHKPT" followed by a zero byte
+    inline const char* checkpoint_magic() { return "TACHKPT"; }
+
+    /// Checkpoint metadata file path
+
+    /// \param prefix The checkpoint path prefix
+    /// \return The path of the metadata file
+    inline std::string checkpoint_meta_path(const std::string& prefix) {
+      return prefix + ".meta";
+    }
+
+    /// Checkpoint tile data file path
+
+    /// \param prefix The checkpoint path prefix
+    /// \param rank The rank of the process that wrote the file
+    /// \return The path of the tile data file that was written by \c rank
+    inline std::string checkpoint_data_path(const std::string& prefix,
+        const ProcessID rank)
+    {
+      return prefix + "." + std::to_string(rank);
+    }
+
+    /// Checkpoint tile index file path
+
+    /// \param prefix The checkpoint path prefix
+    /// \param rank The rank of the process that wrote the file
+    /// \return The path of the tile index file that was written by \c rank
+    inline std::string checkpoint_index_path(const std::string& prefix,
+        const ProcessID rank)
+    {
+      return checkpoint_data_path(prefix, rank) + ".index";
+    }
+
+    inline void checkpoint_write(std::ostream& os, const std::uint64_t value) {
+      os.write(reinterpret_cast<const char*>(& value), sizeof(value));
+    }
+
+    inline std::uint64_t checkpoint_read(std::istream& is) {
+      std::uint64_t value = 0ul;
+      is.read(reinterpret_cast<char*>(& value), sizeof(value));
+      if(! is)
+        TA_EXCEPTION("Unexpected end of checkpoint file.");
+      return value;
+    }
+
+    inline void checkpoint_write_magic(std::ostream& os) {
+      os.write(checkpoint_magic(), 8);
+      checkpoint_write(os, checkpoint_version);
+    }
+
+    inline void checkpoint_read_magic(std::istream& is) {
+      char magic[8];
+      is.read(magic, 8);
+      if((! is) || (std::memcmp(magic, checkpoint_magic(), 8) != 0))
+        TA_EXCEPTION("Invalid checkpoint file.");
+      if(checkpoint_read(is) != checkpoint_version)
+        TA_EXCEPTION("Unsupported checkpoint file version.");
+    }
+
+    /// Write the tile boundaries of each dimension of \c trange
+    inline void checkpoint_write(std::ostream& os, const TiledRange& trange) {
+      checkpoint_write(os, trange.rank());
+      for(const TiledRange1& trange1 : trange.data()) {
+        checkpoint_write(os, trange1.tile_extent());
+        for(const TiledRange1::range_type& tile : trange1)
+          checkpoint_write(os, tile.first);
+        checkpoint_write(os, trange1.elements_range().second);
+      }
+    }
+
+    inline TiledRange checkpoint_read_trange(std::istream& is) {
+      std::vector<TiledRange1> ranges(checkpoint_read(is));
+      for(TiledRange1& trange1 : ranges) {
+        std::vector<std::size_t> boundaries(checkpoint_read(is) + 1ul);
+        for(std::size_t& boundary : boundaries)
+          boundary = checkpoint_read(is);
+        trange1 = TiledRange1(boundaries.begin(), boundaries.end());
+      }
+      return TiledRange(ranges.begin(), ranges.end());
+    }
+
+    inline void checkpoint_write(std::ostream&, const DenseShape&,
+        const TiledRange&)
+    { }
+
+    /// Write the tile norms of \c shape
+
+    /// The norms are written as the Frobenius norm of each tile, so that the
+    /// shape is normalized again, with the current zero threshold, when it
+    /// is read.
+    template <typename T>
+    void checkpoint_write(std::ostream& os, const SparseShape<T>& shape,
+        const TiledRange& trange)
+    {
+      const Tensor<T>& norms = shape.data();
+      std::vector<double> buffer(norms.size());
+      for(std::size_t i = 0ul; i < norms.size(); ++i)
+        buffer[i] = double(norms[i]) * double(trange.make_tile_range(i).volume());
+      os.write(reinterpret_cast<const char*>(buffer.data()),
+          buffer.size() * sizeof(double));
+    }
+
+    inline DenseShape checkpoint_read_shape(World&, std::istream&,
+        const TiledRange&, const DenseShape*)
+    { return DenseShape(); }
+
+    template <typename T>
+    SparseShape<T> checkpoint_read_shape(World&, std::istream& is,
+        const TiledRange& trange, const SparseShape<T>*)
+    {
+      std::vector<double> buffer(trange.tiles_range().volume());
+      is.read(reinterpret_cast<char*>(buffer.data()),
+          buffer.size() * sizeof(double));
+      if(! is)
+        TA_EXCEPTION("Unexpected end of checkpoint file.");
+
+      Tensor<T> norms(trange.tiles_range());
+      for(std::size_t i = 0ul; i < buffer.size(); ++i)
+        norms[i] = T(buffer[i]);
+      return SparseShape<T>(norms, trange);
+    }
+
+    /// The capacity of the write-behind buffer of checkpoint data files
+
+    /// The capacity is read from the \c TA_CHECKPOINT_BUFFER environment
+    /// variable, in bytes; the default is 64 MiB.
+    /// \return The buffer capacity in bytes
+    inline std::size_t checkpoint_buffer_capacity() {
+      static const std::size_t capacity = [] () -> std::size_t {
+        const char* capacity = getenv("TA_CHECKPOINT_BUFFER");
+        if(capacity)
+          return std::strtoul(capacity, nullptr, 10);
+        return 67108864ul;
+      }();
+      return capacity;
+    }
+
+    /// Write the checkpoint metadata file
+
+    /// The file is written by rank 0 only.
+    /// \param world The world of the array
+    /// \param prefix The checkpoint path prefix
+    /// \param element_size The size of the elements of the tiles
+    /// \param trange The tiled range of the array
+    /// \param shape The shape of the array
+    /// \throw TiledArray::Exception When the file cannot be written
+    template <typename Shape>
+    void checkpoint_write_meta(World& world, const std::string& prefix,
+        const std::size_t element_size, const TiledRange& trange,
+        const Shape& shape)
+    {
+      if(world.rank() != 0)
+        return;
+
+      std::ofstream meta(checkpoint_meta_path(prefix),
+          std::ios::binary | std::ios::trunc);
+      if(! meta)
+        TA_EXCEPTION("Unable to open checkpoint file.");
+
+      checkpoint_write_magic(meta);
+      checkpoint_write(meta, world.size());
+      checkpoint_write(meta, Shape::is_dense() ? 0ul : 1ul);
+      checkpoint_write(meta, element_size);
+      checkpoint_write(meta, trange);
+      checkpoint_write(meta, shape, trange);
+      if(! meta)
+        TA_EXCEPTION("Unable to write checkpoint file.");
+    }
+
+    /// Write-behind writer of the tile data and index files of one process
+
+    /// Tiles are written by \c write() as they are evaluated, in any order
+    /// and from any thread. Each tile is serialized by the calling thread,
+    /// and appended to a buffer that is written to the data file when it
+    /// holds more than \c capacity bytes, so the file is written in large
+    /// blocks while other threads continue to evaluate tiles, and at most
+    /// \c capacity bytes, and one tile per thread, are held by the writer.
+    /// \c close() writes the rest of the buffer and the index file.
+    class CheckpointWriter {
+      std::ofstream data_; ///< The tile data file
+      std::string index_path_; ///< The path of the tile index file
+      std::vector<unsigned char> buffer_; ///< Tile data that is not written yet
+      std::vector<std::uint64_t> index_; ///< The ordinal, offset, and size of each tile
+      std::uint64_t offset_; ///< The data file offset of the next tile
+      std::size_t capacity_; ///< The capacity of \c buffer_
+      madness::Mutex mutex_; ///< Protects the buffer, the index, and the file
+
+      CheckpointWriter(const CheckpointWriter&);
+      CheckpointWriter& operator=(const CheckpointWriter&);
+
+      void flush() {
+        data_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+        buffer_.clear();
+      }
+
+    public:
+
+      /// \param prefix The checkpoint path prefix
+      /// \param rank The rank of this process
+      /// \param capacity The capacity of the write-behind buffer in bytes
+      /// \throw TiledArray::Exception When the data file cannot be opened
+      CheckpointWriter(const std::string& prefix, const ProcessID rank,
+          const std::size_t capacity = checkpoint_buffer_capacity()) :
+        data_(checkpoint_data_path(prefix, rank),
+            std::ios::binary | std::ios::trunc),
+        index_path_(checkpoint_index_path(prefix, rank)), buffer_(), index_(),
+        offset_(0ul), capacity_(capacity), mutex_()
+      {
+        if(! data_)
+          TA_EXCEPTION("Unable to open checkpoint file.");
+      }
+
+      /// Append a tile to the data file
+
+      /// \param ordinal The ordinal index of the tile
+      /// \param tile The tile
+      template <typename Tile>
+      void write(const std::size_t ordinal, const Tile& tile) {
+        std::vector<unsigned char> buffer;
+        madness::archive::VectorOutputArchive ar(buffer);
+        ar & tile;
+
+        madness::ScopedMutex<madness::Mutex> lock(mutex_);
+        index_.push_back(ordinal);
+        index_.push_back(offset_);
+        index_.push_back(buffer.size());
+        offset_ += buffer.size();
+        if(buffer_.empty())
+          buffer_.swap(buffer);
+        else
+          buffer_.insert(buffer_.end(), buffer.begin(), buffer.end());
+        if(buffer_.size() >= capacity_)
+          flush();
+      }
+
+      /// Write the rest of the data and the index file
+
+      /// \throw TiledArray::Exception When a file cannot be written
+      void close() {
+        madness::ScopedMutex<madness::Mutex> lock(mutex_);
+        flush();
+        data_.close();
+        if(! data_)
+          TA_EXCEPTION("Unable to write checkpoint file.");
+
+        std::ofstream index_file(index_path_, std::ios::binary | std::ios::trunc);
+        if(! index_file)
+          TA_EXCEPTION("Unable to open checkpoint file.");
+        checkpoint_write_magic(index_file);
+        checkpoint_write(index_file, index_.size() / 3ul);
+        for(const std::uint64_t value : index_)
+          checkpoint_write(index_file, value);
+        index_file.close();
+        if(! index_file)
+          TA_EXCEPTION("Unable to write checkpoint file.");
+      }
+
+    }; // class CheckpointWriter
+
+  }  // namespace detail
+
+  /// Write a checkpoint of an array
+
+  /// The checkpoint is made of one metadata file, \c prefix.meta , which is
+  /// written by rank 0 and holds the tiled range and the shape, and of one
+  /// tile data file and one tile index file per process, \c prefix.rank and
+  /// \c prefix.rank.index . Each process writes its own local tiles as they
+  /// are evaluated, so tiles are not gathered. The files must be written to
+  /// a file system that is visible to all processes that will read the
+  /// checkpoint. This function is collective.
+  /// \tparam Tile The array tile type
+  /// \tparam Policy The array policy type
+  /// \param array The array to be saved
+  /// \param prefix The path prefix of the checkpoint files
+  /// \throw TiledArray::Exception When a file cannot be written
+  template <typename Tile, typename Policy>
+  void save_array(const DistArray<Tile, Policy>& array, const std::string& prefix) {
+    World& world = array.world();
+
+    detail::checkpoint_write_meta(world, prefix,
+        sizeof(typename DistArray<Tile, Policy>::element_type), array.trange(),
+        array.shape());
+
+    // Write each local tile when it is evaluated
+    detail::CheckpointWriter writer(prefix, world.rank());
+    std::vector<Future<bool> > done;
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      const std::size_t ordinal = it.ordinal();
+      done.push_back(world.taskq.add([&writer, ordinal] (const Tile& tile) {
+          writer.write(ordinal, tile);
+          return true;
+        }, *it));
+    }
+    for(Future<bool>& f : done)
+      f.get();
+    writer.close();
+
+    world.gop.fence();
+  }
+
+  /// Evaluate an expression into a checkpoint
+
+  /// The result tiles are written by a write-behind writer as they are
+  /// evaluated, so the file output overlaps the evaluation of the other
+  /// tiles, and each tile is released when it is written; the result array
+  /// is never held in memory. The checkpoint has the same format as that of
+  /// \c save_array() , where the tiles are in the order of the variables of
+  /// the expression, and it is read with \c load_array() . The size of the
+  /// write buffer of each process is set with the \c TA_CHECKPOINT_BUFFER
+  /// environment variable. This function is collective.
+  /// \code
+  /// save_expr(a("i,k") * b("k,j"), "c");
+  /// TArrayD c;
+  /// load_array(c, world, "c");
+  /// \endcode
+  /// \tparam D The expression type
+  /// \param expr The expression to be evaluated
+  /// \param prefix The path prefix of the checkpoint files
+  /// \param world The world where the expression is evaluated
+  /// \throw TiledArray::Exception When a file cannot be written
+  template <typename D>
+  void save_expr(const expressions::Expr<D>& expr, const std::string& prefix,
+      World& world = get_default_world())
+  {
+    typedef typename expressions::Expr<D>::engine_type engine_type;
+    typedef typename engine_type::value_type value_type;
+    typedef typename expressions::EngineTrait<engine_type>::eval_type eval_type;
+    typedef typename engine_type::dist_eval_type dist_eval_type;
+
+    // Construct the expression engine
+    engine_type engine(expr.derived());
+    engine.init(world, std::shared_ptr<typename engine_type::pmap_interface>(),
+        expressions::VariableList());
+
+    detail::checkpoint_write_meta(world, prefix,
+        sizeof(typename eval_type::value_type), engine.trange(), engine.shape());
+
+    // Create the distributed evaluator, and write each local tile when it is
+    // evaluated. The tiles are moved out of dist_eval, so each is held only
+    // until it is written.
+    dist_eval_type dist_eval = engine.make_dist_eval();
+    dist_eval.eval();
+
+    detail::CheckpointWriter writer(prefix, world.rank());
+    std::vector<Future<bool> > done;
+    done.reserve(dist_eval.pmap()->local_size());
+    typename dist_eval_type::pmap_interface::const_iterator it =
+        dist_eval.pmap()->begin();
+    const typename dist_eval_type::pmap_interface::const_iterator end =
+        dist_eval.pmap()->end();
+    for(; it != end; ++it) {
+      if(dist_eval.is_zero(*it))
+        continue;
+      const std::size_t ordinal = *it;
+      done.push_back(world.taskq.add([&writer, ordinal] (const value_type& tile) {
+          const eval_type eval_tile(tile);
+          writer.write(ordinal, eval_tile);
+          return true;
+        }, dist_eval.get(ordinal)));
+    }
+
+    dist_eval.wait();
+    for(Future<bool>& f : done)
+      f.get();
+    writer.close();
+
+    world.gop.fence();
+  }
+
+  /// Read a checkpoint that was written by \c save_array()
+
+  /// The checkpoint may be read by any number of processes and with any
+  /// process map. Each process reads the index files of all processes that
+  /// wrote the checkpoint, and then reads only its own local tiles. The shape
+  /// of sparse arrays is normalized with the current zero threshold. This
+  /// function is collective.
+  /// \tparam Tile The array tile type
+  /// \tparam Policy The array policy type
+  /// \param[out] array The array that will hold the checkpoint
+  /// \param world The world of the array
+  /// \param prefix The path prefix of the checkpoint files
+  /// \param pmap The process map of the array; the default process map is
+  /// used when it is null
+  /// \throw TiledArray::Exception When the checkpoint is not valid, or it
+  /// was written with a different policy or numeric type.
+  template <typename Tile, typename Policy>
+  void load_array(DistArray<Tile, Policy>& array, World& world,
+      const std::string& prefix,
+      const std::shared_ptr<typename DistArray<Tile, Policy>::pmap_interface>& pmap =
+          std::shared_ptr<typename DistArray<Tile, Policy>::pmap_interface>())
+  {
+    typedef DistArray<Tile, Policy> array_type;
+    typedef typename array_type::shape_type shape_type;
+
+    std::ifstream meta(detail::checkpoint_meta_path(prefix), std::ios::binary);
+    if(! meta)
+      TA_EXCEPTION("Unable to open checkpoint file.");
+    detail::checkpoint_read_magic(meta);
+    const std::uint64_t nproc = detail::checkpoint_read(meta);
+    if(detail::checkpoint_read(meta) != (shape_type::is_dense() ? 0ul : 1ul))
+      TA_EXCEPTION("The checkpoint was written with a different array policy.");
+    if(detail::checkpoint_read(meta) != sizeof(typename array_type::element_type))
+      TA_EXCEPTION("The checkpoint was written with a different numeric type.");
+    const TiledRange trange = detail::checkpoint_read_trange(meta);
+    const shape_type shape = detail::checkpoint_read_shape(world, meta, trange,
+        static_cast<const shape_type*>(nullptr));
+    meta.close();
+
+    array_type result(world, trange, shape, pmap);
+
+    // Read the local tiles from the files of all processes
+    std::vector<bool> found(trange.tiles_range().volume(), false);
+    std::vector<unsigned char> buffer;
+    for(std::uint64_t rank = 0ul; rank < nproc; ++rank) {
+      std::ifstream index(detail::checkpoint_index_path(prefix, rank),
+          std::ios::binary);
+      if(! index)
+        TA_EXCEPTION("Unable to open checkpoint file.");
+      detail::checkpoint_read_magic(index);
+
+      std::ifstream data;
+      const std::uint64_t ntiles = detail::checkpoint_read(index);
+      for(std::uint64_t t = 0ul; t < ntiles; ++t) {
+        const std::uint64_t ordinal = detail::checkpoint_read(index);
+        const std::uint64_t offset = detail::checkpoint_read(index);
+        const std::uint64_t size = detail::checkpoint_read(index);
+        if(ordinal >= found.size())
+          TA_EXCEPTION("Invalid checkpoint file.");
+        if((! result.is_local(ordinal)) || result.is_zero(ordinal))
+          continue;
+
+        if(! data.is_open()) {
+          data.open(detail::checkpoint_data_path(prefix, rank), std::ios::binary);
+          if(! data)
+            TA_EXCEPTION("Unable to open checkpoint file.");
+        }
+        buffer.resize(size);
+        data.seekg(offset);
+        data.read(reinterpret_cast<char*>(buffer.data()), size);
+        if(! data)
+          TA_EXCEPTION("Unexpected end of checkpoint file.");
+
+        Tile tile;
+        madness::archive::VectorInputArchive ar(buffer);
+        ar & tile;
+        result.set(ordinal, tile);
+        found[ordinal] = true;
+      }
+    }
+
+    // Check that all local tiles were found
+    for(auto it = result.pmap()->begin(); it != result.pmap()->end(); ++it)
+      if((! result.is_zero(*it)) && (! found[*it]))
+        TA_EXCEPTION("The checkpoint does not contain all non-zero tiles.");
+
+    array = result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CHECKPOINT_H__INCLUDED
@@ -0,0 +1,136 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  comm_progress.cpp
+ *  May 27, 2017
+ *
+ */
+
+#include <TiledArray/comm_progress.h>
+#include <TiledArray/madness.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace TiledArray {
+  namespace {
+
+    /// The communication progress thread
+    class CommProgress {
+      std::mutex lock_; ///< Serializes start and stop
+      std::thread thread_; ///< The progress thread
+      std::atomic<bool> stop_{false}; ///< The stop flag of the thread
+      std::atomic<std::size_t> polls_{0ul}; ///< The number of polls
+      std::atomic<std::size_t> pending_polls_{0ul}; ///< The number of polls with a pending message
+
+      /// Poll MPI until the stop flag is set
+      void run(MPI_Comm comm) {
+        const std::chrono::microseconds interval(comm_progress_interval());
+        while(! stop_.load(std::memory_order_acquire)) {
+          int flag = 0;
+          MPI_Status status;
+          MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm, &flag, &status);
+          polls_.fetch_add(1ul, std::memory_order_relaxed);
+          if(flag)
+            pending_polls_.fetch_add(1ul, std::memory_order_relaxed);
+          if(interval.count())
+            std::this_thread::sleep_for(interval);
+          else
+            std::this_thread::yield();
+        }
+      }
+
+    public:
+
+      ~CommProgress() { stop(); }
+
+      bool start(World& world) {
+        std::lock_guard<std::mutex> guard(lock_);
+        if(thread_.joinable())
+          return true;
+
+        int level = MPI_THREAD_SINGLE;
+        MPI_Query_thread(&level);
+        if(level != MPI_THREAD_MULTIPLE)
+          return false;
+
+        stop_ = false;
+        polls_ = 0ul;
+        pending_polls_ = 0ul;
+        const MPI_Comm comm = world.mpi.comm().Get_mpi_comm();
+        thread_ = std::thread([this, comm] () { this->run(comm); });
+        return true;
+      }
+
+      void stop() {
+        std::lock_guard<std::mutex> guard(lock_);
+        if(! thread_.joinable())
+          return;
+        stop_.store(true, std::memory_order_release);
+        thread_.join();
+      }
+
+      bool running() {
+        std::lock_guard<std::mutex> guard(lock_);
+        return thread_.joinable();
+      }
+
+      CommProgressStats stats() const {
+        return CommProgressStats{ polls_.load(), pending_polls_.load() };
+      }
+    }; // class CommProgress
+
+    CommProgress& comm_progress() {
+      static CommProgress progress;
+      return progress;
+    }
+
+  }  // namespace
+
+  bool comm_progress_start(World& world) {
+    return comm_progress().start(world);
+  }
+
+  void comm_progress_stop() { comm_progress().stop(); }
+
+  bool comm_progress_running() { return comm_progress().running(); }
+
+  std::size_t comm_progress_interval() {
+    static const std::size_t interval = [] () -> std::size_t {
+      const char* interval = getenv("TA_COMM_PROGRESS_INTERVAL");
+      if(interval)
+        return std::strtoul(interval, nullptr, 10);
+      return 20ul;
+    }();
+    return interval;
+  }
+
+  CommProgressStats comm_progress_stats() { return comm_progress().stats(); }
+
+  namespace detail {
+
+    void comm_progress_initialize(World& world) {
+      const char* flag = getenv("TA_COMM_PROGRESS");
+      if(flag && std::strtol(flag, nullptr, 10) != 0l)
+        comm_progress_start(world);
+    }
+
+  }  // namespace detail
+
+} // namespace TiledArray
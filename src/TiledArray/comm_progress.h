@@ -0,0 +1,93 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  comm_progress.h
+ *  May 27, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_COMM_PROGRESS_H__INCLUDED
+#define TILEDARRAY_COMM_PROGRESS_H__INCLUDED
+
+#include <cstddef>
+
+namespace madness {
+  class World;
+} // namespace madness
+
+namespace TiledArray {
+
+  /// Communication progress thread counters
+  struct CommProgressStats {
+    std::size_t polls; ///< The number of times the thread polled MPI
+    std::size_t pending_polls; ///< The number of polls that found a pending message
+  }; // struct CommProgressStats
+
+  /// Start the communication progress thread
+
+  /// Many MPI libraries only progress large, rendezvous-protocol messages,
+  /// e.g. the tiles of SUMMA broadcasts and remote tile gets, inside MPI
+  /// calls, so a transfer may stall while all worker threads are busy with
+  /// long tile GEMMs, and the next SUMMA step starts late. The progress
+  /// thread polls MPI on the communicator of \c world every
+  /// \c comm_progress_interval() microseconds, which drives the transfers
+  /// while the workers compute. It does not receive messages; those are
+  /// still handled by MADNESS. The thread occupies a core while it polls,
+  /// so the number of MADNESS threads should be reduced by one, e.g. with
+  /// \c MAD_NUM_THREADS . The thread is started by
+  /// \c TiledArray::initialize() when the \c TA_COMM_PROGRESS environment
+  /// variable is set to a non-zero value, and stopped by
+  /// \c TiledArray::finalize() .
+  /// \note MPI must be initialized with \c MPI_THREAD_MULTIPLE ; otherwise
+  /// the thread is not started.
+  /// \param world The world whose communicator is polled
+  /// \return \c true if the thread is running
+  bool comm_progress_start(madness::World& world);
+
+  /// Stop the communication progress thread
+
+  /// This function does nothing if the thread is not running.
+  void comm_progress_stop();
+
+  /// \return \c true if the communication progress thread is running
+  bool comm_progress_running();
+
+  /// Polling interval of the communication progress thread
+
+  /// The interval is read from the \c TA_COMM_PROGRESS_INTERVAL
+  /// environment variable; the default interval is 20 microseconds. An
+  /// interval of zero makes the thread poll continuously.
+  /// \return The polling interval in microseconds
+  std::size_t comm_progress_interval();
+
+  /// Communication progress counters of this process
+
+  /// \return The counters accumulated since the thread was started
+  CommProgressStats comm_progress_stats();
+
+  namespace detail {
+
+    /// Start the progress thread if \c TA_COMM_PROGRESS is set
+
+    /// \param world The world whose communicator is polled
+    void comm_progress_initialize(madness::World& world);
+
+  }  // namespace detail
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_COMM_PROGRESS_H__INCLUDED
@@ -0,0 +1,247 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  comm_stats.cpp
+ *  May 29, 2017
+ *
+ */
+
+#include <TiledArray/comm_stats.h>
+#include <TiledArray/madness.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <vector>
+
+namespace TiledArray {
+  namespace {
+
+    /// The number of latency histogram buckets
+    constexpr std::size_t latency_buckets = 128ul;
+
+    /// The number of latency histogram buckets per power of two
+    constexpr double buckets_per_octave = 4.0;
+
+    /// Latency histogram bucket of a sample
+
+    /// \param ns The latency in nanoseconds
+    /// \return The bucket of \c ns
+    std::size_t latency_bucket(const unsigned long ns) {
+      if(ns <= 1ul)
+        return 0ul;
+      const std::size_t bucket = std::log2(double(ns)) * buckets_per_octave;
+      return std::min(bucket, latency_buckets - 1ul);
+    }
+
+    /// \param bucket A latency histogram bucket
+    /// \return The geometric center of \c bucket in seconds
+    double latency_value(const std::size_t bucket) {
+      return std::exp2((double(bucket) + 0.5) / buckets_per_octave) * 1.0e-9;
+    }
+
+    /// The counters of one communication category
+
+    /// The counters are flattened into an array of \c size() values, which
+    /// is summed over processes by \c comm_stats().
+    class CategoryCounters {
+      std::atomic<unsigned long> messages_{0ul}; ///< The number of messages
+      std::atomic<unsigned long> bytes_{0ul}; ///< The number of bytes
+      std::atomic<unsigned long> latency_ns_{0ul}; ///< The sum of the latencies in nanoseconds
+      std::atomic<unsigned long> histogram_[latency_buckets]; ///< The latency histogram
+
+    public:
+
+      /// \return The number of flattened counters
+      static constexpr std::size_t size() { return 3ul + latency_buckets; }
+
+      CategoryCounters() { clear(); }
+
+      void clear() {
+        messages_ = 0ul;
+        bytes_ = 0ul;
+        latency_ns_ = 0ul;
+        for(std::atomic<unsigned long>& count : histogram_)
+          count = 0ul;
+      }
+
+      void record(const std::size_t messages, const std::size_t bytes) {
+        messages_.fetch_add(messages, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+      }
+
+      void record_latency(const double seconds) {
+        const unsigned long ns = (seconds > 0.0 ? seconds * 1.0e9 : 0.0);
+        latency_ns_.fetch_add(ns, std::memory_order_relaxed);
+        histogram_[latency_bucket(ns)].fetch_add(1ul, std::memory_order_relaxed);
+      }
+
+      /// \param[out] values The \c size() flattened counters
+      void flatten(unsigned long* const values) const {
+        values[0] = messages_.load();
+        values[1] = bytes_.load();
+        values[2] = latency_ns_.load();
+        for(std::size_t b = 0ul; b < latency_buckets; ++b)
+          values[3ul + b] = histogram_[b].load();
+      }
+    }; // class CategoryCounters
+
+    CategoryCounters* comm_counters() {
+      static CategoryCounters counters[comm_category_count];
+      return counters;
+    }
+
+    CategoryCounters& comm_counters(const CommCategory category) {
+      return comm_counters()[std::size_t(category)];
+    }
+
+    /// Convert flattened counters
+
+    /// \param values The \c CategoryCounters::size() flattened counters
+    /// \return The counters with the latency mean and percentiles
+    CommCounters make_counters(const unsigned long* const values) {
+      const unsigned long* const histogram = values + 3ul;
+      const std::size_t samples =
+          std::accumulate(histogram, histogram + latency_buckets, 0ul);
+
+      CommCounters result{ values[0], values[1], samples, 0.0, 0.0, 0.0, 0.0 };
+      if(samples == 0ul)
+        return result;
+
+      result.latency_mean = double(values[2]) * 1.0e-9 / double(samples);
+      auto percentile = [=] (const double p) -> double {
+        const double rank = p * double(samples);
+        std::size_t count = 0ul;
+        for(std::size_t b = 0ul; b < latency_buckets; ++b) {
+          count += histogram[b];
+          if(double(count) >= rank)
+            return latency_value(b);
+        }
+        return latency_value(latency_buckets - 1ul);
+      };
+      result.latency_p50 = percentile(0.50);
+      result.latency_p90 = percentile(0.90);
+      result.latency_p99 = percentile(0.99);
+      return result;
+    }
+
+    /// Print one row of counters
+    void print_counters(std::ostream& os, const char* name,
+        const CommCounters& counters)
+    {
+      os << "  " << std::left << std::setw(14) << name << std::right
+          << std::setw(12) << counters.messages
+          << std::setw(16) << counters.bytes
+          << std::setw(10) << counters.latency_count
+          << std::setw(12) << counters.latency_mean * 1.0e6
+          << std::setw(12) << counters.latency_p50 * 1.0e6
+          << std::setw(12) << counters.latency_p90 * 1.0e6
+          << std::setw(12) << counters.latency_p99 * 1.0e6 << "\n";
+    }
+
+  }  // namespace
+
+  const char* comm_category_name(const CommCategory category) {
+    switch(category) {
+      case CommCategory::summa_bcast: return "summa_bcast";
+      case CommCategory::storage_get: return "storage_get";
+      case CommCategory::storage_set: return "storage_set";
+      case CommCategory::shape_reduce: return "shape_reduce";
+      case CommCategory::replication: return "replication";
+    }
+    return "unknown";
+  }
+
+  void comm_stats_enable(const bool flag) {
+    detail::comm_stats_flag() = flag;
+  }
+
+  void reset_comm_stats() {
+    for(std::size_t c = 0ul; c < comm_category_count; ++c)
+      comm_counters()[c].clear();
+  }
+
+  CommCounters comm_stats(const CommCategory category) {
+    std::vector<unsigned long> values(CategoryCounters::size());
+    comm_counters(category).flatten(values.data());
+    return make_counters(values.data());
+  }
+
+  CommCounters comm_stats(World& world, const CommCategory category) {
+    std::vector<unsigned long> values(CategoryCounters::size());
+    comm_counters(category).flatten(values.data());
+    world.gop.sum(values.data(), values.size());
+    return make_counters(values.data());
+  }
+
+  void print_comm_stats(World& world, std::ostream& os) {
+    std::vector<CommCounters> local, global;
+    for(std::size_t c = 0ul; c < comm_category_count; ++c) {
+      local.push_back(comm_stats(CommCategory(c)));
+      global.push_back(comm_stats(world, CommCategory(c)));
+    }
+    if(world.rank() != 0)
+      return;
+
+    auto header = [&] (const char* title) {
+      os << title << "\n  " << std::left << std::setw(14) << "category"
+          << std::right << std::setw(12) << "messages" << std::setw(16)
+          << "bytes" << std::setw(10) << "samples" << std::setw(12)
+          << "mean(us)" << std::setw(12) << "p50(us)" << std::setw(12)
+          << "p90(us)" << std::setw(12) << "p99(us)" << "\n";
+    };
+    header("Communication on process 0:");
+    for(std::size_t c = 0ul; c < comm_category_count; ++c)
+      print_counters(os, comm_category_name(CommCategory(c)), local[c]);
+    header("Communication on all processes:");
+    for(std::size_t c = 0ul; c < comm_category_count; ++c)
+      print_counters(os, comm_category_name(CommCategory(c)), global[c]);
+  }
+
+  namespace detail {
+
+    std::atomic<bool>& comm_stats_flag() {
+      static std::atomic<bool> flag([] () -> bool {
+        const char* comm_stats = getenv("TA_COMM_STATS");
+        if(comm_stats)
+          return std::strtol(comm_stats, nullptr, 10) != 0l;
+        return false;
+      }());
+      return flag;
+    }
+
+    void comm_stats_record(const CommCategory category,
+        const std::size_t messages, const std::size_t bytes)
+    {
+      comm_counters(category).record(messages, bytes);
+    }
+
+    void comm_stats_record_latency(const CommCategory category,
+        const std::size_t bytes, const double begin)
+    {
+      CategoryCounters& counters = comm_counters(category);
+      counters.record(0ul, bytes);
+      counters.record_latency(comm_stats_time() - begin);
+    }
+
+    double comm_stats_time() { return madness::wall_time(); }
+
+  }  // namespace detail
+
+} // namespace TiledArray
@@ -0,0 +1,201 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  comm_stats.h
+ *  May 29, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_COMM_STATS_H__INCLUDED
+#define TILEDARRAY_COMM_STATS_H__INCLUDED
+
+#include <madness/world/MADworld.h>
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+
+namespace TiledArray {
+
+  /// Categories of TiledArray communication
+  enum class CommCategory {
+    summa_bcast,  ///< Tile broadcasts of SUMMA contractions
+    storage_get,  ///< Remote tile gets of \c DistributedStorage
+    storage_set,  ///< Remote tile sets of \c DistributedStorage
+    shape_reduce, ///< Tile norm reductions of sparse shapes
+    replication   ///< Chunks of tiles sent by \c Replicator
+  }; // enum class CommCategory
+
+  /// The number of communication categories
+  constexpr std::size_t comm_category_count = 5ul;
+
+  /// \param category A communication category
+  /// \return The name of \c category
+  const char* comm_category_name(const CommCategory category);
+
+  /// Communication counters of one category
+  struct CommCounters {
+    std::size_t messages; ///< The number of messages sent
+    std::size_t bytes; ///< The number of bytes sent or received
+    std::size_t latency_count; ///< The number of latency samples
+    double latency_mean; ///< The mean latency in seconds
+    double latency_p50; ///< The median latency in seconds
+    double latency_p90; ///< The 90th percentile of the latency in seconds
+    double latency_p99; ///< The 99th percentile of the latency in seconds
+  }; // struct CommCounters
+
+  /// Communication counters
+
+  /// When the counters are enabled, TiledArray counts its own messages and
+  /// bytes by category, and samples their latency:
+  /// \li \c summa_bcast : the root counts one message per receiver and the
+  /// tile bytes; the receivers sample the time from the start of the
+  /// broadcast to the arrival of the tile.
+  /// \li \c storage_get : the requester counts the requests and the bytes
+  /// of the returned tiles, and samples the time from the request to the
+  /// arrival of the tile.
+  /// \li \c storage_set : the sender counts the messages and tile bytes.
+  /// \li \c shape_reduce : each process counts the norm reductions and the
+  /// bytes it contributes, and samples the time of the reduction.
+  /// \li \c replication : each process counts the chunks it sends or
+  /// forwards and their bytes; the source of a chunk samples the time from
+  /// the send to the acknowledgement.
+  ///
+  /// Latencies are kept in a logarithmic histogram with four buckets per
+  /// power of two, so percentiles are accurate to about 10%. The counters
+  /// are disabled by default; they are enabled when the \c TA_COMM_STATS
+  /// environment variable is set to a non-zero value, or by calling
+  /// \c comm_stats_enable(). Disabled counters cost one relaxed atomic load
+  /// per message.
+  /// \return \c true if the communication counters are enabled
+  inline bool comm_stats_enabled();
+
+  /// Enable or disable the communication counters
+
+  /// \param flag The new flag
+  void comm_stats_enable(const bool flag = true);
+
+  /// Reset the communication counters of this process
+  void reset_comm_stats();
+
+  /// Communication counters of this process
+
+  /// \param category The communication category
+  /// \return The counters of \c category on this process
+  CommCounters comm_stats(const CommCategory category);
+
+  /// Communication counters of all processes
+
+  /// The counts and latency histograms of all processes are summed. This
+  /// function is collective.
+  /// \param world The world whose counters are summed
+  /// \param category The communication category
+  /// \return The counters of \c category summed over all processes
+  CommCounters comm_stats(madness::World& world, const CommCategory category);
+
+  /// Print the communication counters
+
+  /// The counters of this process and of all processes are printed by
+  /// process 0, one row per category. This function is collective.
+  /// \param world The world whose counters are printed
+  /// \param os The output stream
+  void print_comm_stats(madness::World& world, std::ostream& os);
+
+  namespace detail {
+
+    /// Communication counters flag
+
+    /// The flag is initialized with the \c TA_COMM_STATS environment
+    /// variable.
+    /// \return A reference to the flag
+    std::atomic<bool>& comm_stats_flag();
+
+    /// Count messages
+
+    /// \param category The communication category
+    /// \param messages The number of messages
+    /// \param bytes The number of bytes
+    void comm_stats_record(const CommCategory category,
+        const std::size_t messages, const std::size_t bytes);
+
+    /// Count bytes and sample the latency of one transfer
+
+    /// \param category The communication category
+    /// \param bytes The number of bytes
+    /// \param begin The wall time at the start of the transfer
+    void comm_stats_record_latency(const CommCategory category,
+        const std::size_t bytes, const double begin);
+
+    /// \return The wall time used for latency samples
+    double comm_stats_time();
+
+    /// Callback that samples the latency of a transfer when it arrives
+
+    /// \tparam T The transferred object type
+    /// \tparam Bytes The type of the function that returns the bytes of the
+    /// transferred object
+    template <typename T, typename Bytes>
+    class CommLatency : public madness::CallbackInterface {
+      CommCategory category_; ///< The communication category
+      madness::Future<T> future_; ///< The transferred object
+      Bytes bytes_; ///< Returns the bytes of the transferred object
+      double begin_; ///< The wall time at the start of the transfer
+
+    public:
+
+      CommLatency(const CommCategory category, const madness::Future<T>& f,
+          const Bytes& bytes) :
+        category_(category), future_(f), bytes_(bytes),
+        begin_(comm_stats_time())
+      { }
+
+      virtual ~CommLatency() { }
+
+      virtual void notify() {
+        comm_stats_record_latency(category_, bytes_(future_.get()), begin_);
+        delete this;
+      }
+    }; // class CommLatency
+
+    /// Sample the latency of a transfer that starts now
+
+    /// The latency is sampled when \c f is set, and the bytes returned by
+    /// \c bytes(f.get()) are counted. Nothing is sampled when the counters
+    /// are disabled.
+    /// \tparam T The transferred object type
+    /// \tparam Bytes The type of the function that returns the bytes of the
+    /// transferred object
+    /// \param category The communication category
+    /// \param f The future of the transferred object
+    /// \param bytes The function that returns the bytes of the object
+    template <typename T, typename Bytes>
+    void comm_stats_track(const CommCategory category, madness::Future<T>& f,
+        const Bytes& bytes)
+    {
+      if(comm_stats_enabled())
+        f.register_callback(new CommLatency<T, Bytes>(category, f, bytes));
+    }
+
+  }  // namespace detail
+
+  inline bool comm_stats_enabled() {
+    static std::atomic<bool>& flag = detail::comm_stats_flag();
+    return flag.load(std::memory_order_relaxed);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_COMM_STATS_H__INCLUDED
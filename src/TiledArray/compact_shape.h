@@ -0,0 +1,262 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  compact_shape.h
+ *  May 26, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_COMPACT_SHAPE_H__INCLUDED
+#define TILEDARRAY_COMPACT_SHAPE_H__INCLUDED
+
+#include <TiledArray/sparse_shape.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Storage formats of \c CompactShape
+  enum class ShapeStorage {
+    sparse, ///< {ordinal,norm} pairs of the non-zero tiles
+    log16,  ///< Ordinals and 16-bit logarithmic norms of the non-zero tiles
+    log8    ///< Ordinals and 8-bit logarithmic norms of the non-zero tiles
+  }; // enum class ShapeStorage
+
+  /// Compact storage of a sparse shape
+
+  /// Only the non-zero tiles of a \c SparseShape are stored, so the memory
+  /// of the shape is proportional to the number of non-zero tiles instead
+  /// of the number of tiles, e.g. to keep the shapes of large, sparse
+  /// arrays replicated on every process. The norms of the non-zero tiles
+  /// are stored in the precision of the shape (\c ShapeStorage::sparse ),
+  /// or quantized on a logarithmic scale between the smallest and largest
+  /// non-zero norm (\c ShapeStorage::log16 and \c ShapeStorage::log8 ).
+  /// Quantized norms are rounded up, so they are upper bounds of the
+  /// norms, with a relative error less than \c tolerance() ; since
+  /// screening only needs upper bounds, shapes that are expanded by
+  /// \c shape() can be used in expressions like other shapes.
+  /// \tparam T The norm value type
+  template <typename T>
+  class CompactShape {
+  public:
+    typedef T value_type; ///< The norm value type
+    typedef std::size_t size_type; ///< Size type
+
+  private:
+    typedef typename SparseShape<T>::vector_type vector_type;
+
+    ShapeStorage storage_ = ShapeStorage::sparse; ///< The storage format
+    Range range_; ///< The range of the tiles
+    std::shared_ptr<vector_type> size_vectors_; ///< The tile sizes of each dimension
+    std::vector<size_type> index_; ///< The sorted ordinals of the non-zero tiles
+    std::vector<value_type> norms_; ///< The norms of the non-zero tiles, in sparse storage
+    std::vector<std::uint16_t> codes16_; ///< The 16-bit quantized norms of the non-zero tiles
+    std::vector<std::uint8_t> codes8_; ///< The 8-bit quantized norms of the non-zero tiles
+    double log_min_ = 0.0; ///< The base 2 logarithm of the smallest norm
+    double log_step_ = 0.0; ///< The base 2 logarithm of the quantization step
+    value_type max_ = value_type(0); ///< The largest norm
+    value_type zero_threshold_ = value_type(0); ///< The zero threshold of the shape
+    bool bounds_ = false; ///< The norms are upper bounds, not computed norms
+
+    /// The largest code of the storage format
+    std::uint16_t max_code() const {
+      return (storage_ == ShapeStorage::log8 ? 255u : 65535u);
+    }
+
+    /// Decode a quantized norm
+
+    /// \param code The quantized norm
+    /// \return The norm of \c code
+    value_type decode(const std::uint16_t code) const {
+      if(code == max_code())
+        return max_;
+      return value_type(std::exp2(log_min_ + double(code) * log_step_));
+    }
+
+    /// Quantize a norm
+
+    /// \param norm A non-zero norm
+    /// \return The smallest code whose norm is not less than \c norm
+    std::uint16_t encode(const value_type norm) const {
+      const std::uint16_t last = max_code();
+      if(log_step_ <= 0.0)
+        return last;
+      double code = std::ceil((std::log2(double(norm)) - log_min_) / log_step_);
+      code = std::min(std::max(code, 0.0), double(last));
+      std::uint16_t result = std::uint16_t(code);
+      while((result < last) && (decode(result) < norm))
+        ++result;
+      return result;
+    }
+
+    /// Position of a tile in the list of non-zero tiles
+
+    /// \param ord The ordinal of the tile
+    /// \return The position of \c ord in \c index_, or \c index_.size()
+    /// when the tile is zero
+    size_type find(const size_type ord) const {
+      const auto it = std::lower_bound(index_.begin(), index_.end(), ord);
+      return ((it != index_.end()) && (*it == ord) ?
+          size_type(it - index_.begin()) : index_.size());
+    }
+
+    /// Norm of the \c n -th non-zero tile
+    value_type norm(const size_type n) const {
+      switch(storage_) {
+        case ShapeStorage::log16: return decode(codes16_[n]);
+        case ShapeStorage::log8: return decode(codes8_[n]);
+        default: return norms_[n];
+      }
+    }
+
+  public:
+
+    /// Construct an empty shape
+    CompactShape() = default;
+
+    /// Construct a compact copy of a shape
+
+    /// \param shape The shape to be stored
+    /// \param storage The storage format
+    CompactShape(const SparseShape<T>& shape,
+        const ShapeStorage storage = ShapeStorage::sparse) :
+      storage_(storage), range_(shape.data().range()),
+      size_vectors_(shape.size_vectors_),
+      zero_threshold_(shape.zero_threshold()), bounds_(shape.is_bound())
+    {
+      TA_ASSERT(! shape.empty());
+      const value_type* const data = shape.data().data();
+      const size_type volume = range_.volume();
+
+      // Collect the non-zero tiles
+      value_type min = value_type(0);
+      for(size_type i = 0ul; i < volume; ++i) {
+        const value_type norm = data[i];
+        if((norm > value_type(0)) && (norm >= zero_threshold_)) {
+          index_.push_back(i);
+          min = (index_.size() == 1ul ? norm : std::min(min, norm));
+          max_ = std::max(max_, norm);
+        }
+      }
+
+      if(storage_ == ShapeStorage::sparse) {
+        norms_.reserve(index_.size());
+        for(const size_type i : index_)
+          norms_.push_back(data[i]);
+        return;
+      }
+
+      // Quantize the norms between the smallest and largest norm
+      if(! index_.empty()) {
+        log_min_ = std::log2(double(min));
+        log_step_ = (std::log2(double(max_)) - log_min_) / double(max_code());
+      }
+      if(storage_ == ShapeStorage::log16) {
+        codes16_.reserve(index_.size());
+        for(const size_type i : index_)
+          codes16_.push_back(encode(data[i]));
+      } else {
+        codes8_.reserve(index_.size());
+        for(const size_type i : index_)
+          codes8_.push_back(std::uint8_t(encode(data[i])));
+      }
+      bounds_ = true;
+    }
+
+    /// \return The storage format
+    ShapeStorage storage() const { return storage_; }
+
+    /// \return The range of the tiles
+    const Range& range() const { return range_; }
+
+    /// \return \c true when this shape has not been initialized
+    bool empty() const { return range_.volume() == 0ul; }
+
+    /// \return The number of non-zero tiles
+    size_type nnz() const { return index_.size(); }
+
+    /// \return The fraction of tiles that are zero
+    float sparsity() const {
+      TA_ASSERT(! empty());
+      return float(range_.volume() - index_.size()) / float(range_.volume());
+    }
+
+    /// \return The zero threshold of the shape
+    value_type zero_threshold() const { return zero_threshold_; }
+
+    /// The largest relative error of the stored norms
+
+    /// \return The largest relative error of a stored norm, which is zero
+    /// in sparse storage
+    double tolerance() const {
+      return (storage_ == ShapeStorage::sparse ? 0.0 :
+          std::exp2(log_step_) - 1.0);
+    }
+
+    /// \return The size of the norms and indices, in bytes
+    size_type bytes() const {
+      return index_.size() * sizeof(size_type) +
+          norms_.size() * sizeof(value_type) +
+          codes16_.size() * sizeof(std::uint16_t) +
+          codes8_.size() * sizeof(std::uint8_t);
+    }
+
+    /// Check that a tile is zero
+
+    /// \tparam Index The type of the index
+    /// \param i The ordinal or coordinate index of the tile
+    /// \return \c true when tile \c i is zero
+    template <typename Index>
+    bool is_zero(const Index& i) const {
+      TA_ASSERT(! empty());
+      return find(range_.ordinal(i)) == index_.size();
+    }
+
+    /// Tile norm accessor
+
+    /// \tparam Index The type of the index
+    /// \param i The ordinal or coordinate index of the tile
+    /// \return The normalized norm of tile \c i , or its upper bound in
+    /// quantized storage
+    template <typename Index>
+    value_type operator[](const Index& i) const {
+      TA_ASSERT(! empty());
+      const size_type n = find(range_.ordinal(i));
+      return (n == index_.size() ? value_type(0) : norm(n));
+    }
+
+    /// Expand the shape
+
+    /// \return A shape with the stored norms, which are upper bounds of the
+    /// norms in quantized storage (see \c SparseShape::is_bound() )
+    SparseShape<T> shape() const {
+      TA_ASSERT(! empty());
+      Tensor<value_type> tile_norms(range_, value_type(0));
+      value_type* const data = tile_norms.data();
+      for(size_type n = 0ul; n < index_.size(); ++n)
+        data[index_[n]] = norm(n);
+      return SparseShape<T>(tile_norms, size_vectors_,
+          range_.volume() - index_.size(), zero_threshold_, bounds_);
+    }
+
+  }; // class CompactShape
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_COMPACT_SHAPE_H__INCLUDED
@@ -0,0 +1,501 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  compressed_bitset.h
+ *  Mar 31, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_COMPRESSED_BITSET_H__INCLUDED
+#define TILEDARRAY_COMPRESSED_BITSET_H__INCLUDED
+
+#include <TiledArray/bitset.h>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Compressed bitset for large, sparse sets of bits
+
+    /// The bits are partitioned into chunks of 2^16 bits, and only the
+    /// chunks with set bits are stored, as in roaring bitmaps. A chunk with
+    /// at most 4096 set bits is stored as a sorted array of the 16-bit
+    /// offsets of those bits, and a denser chunk as a plain bitmap of 1024
+    /// 64-bit words, so a chunk never uses more than 8 KiB and a sparse set
+    /// of tiles, e.g. the non-zero tiles of a grid with 10^8 tiles, uses a
+    /// few bytes per set bit. Intersections and unions are computed chunk by
+    /// chunk with merges of arrays and word-level operations of bitmaps.
+    class CompressedBitset {
+    public:
+      typedef std::size_t size_type; ///< Bit index type
+
+    private:
+      typedef std::uint64_t word_type; ///< Bitmap word type
+
+      static constexpr size_type chunk_bits = 1ul << 16; ///< The bits of a chunk
+      static constexpr size_type word_bits = 64ul; ///< The bits of a word
+      static constexpr size_type chunk_words = chunk_bits / word_bits; ///< The words of a bitmap
+      static constexpr size_type array_max = 4096ul; ///< The largest array chunk
+
+      /// A chunk of bits
+      struct Chunk {
+        size_type key; ///< The chunk index
+        size_type count; ///< The number of set bits
+        std::vector<std::uint16_t> array; ///< Sorted offsets of the set bits of an array chunk
+        std::vector<word_type> bitmap; ///< The words of a bitmap chunk, or empty for an array chunk
+
+        explicit Chunk(const size_type k) : key(k), count(0ul), array(), bitmap() { }
+
+        /// \return \c true when the chunk is stored as a bitmap
+        bool is_bitmap() const { return ! bitmap.empty(); }
+
+        /// Check a bit of the chunk
+        bool test(const std::uint16_t offset) const {
+          if(is_bitmap())
+            return (bitmap[offset / word_bits] >> (offset % word_bits)) & word_type(1);
+          return std::binary_search(array.begin(), array.end(), offset);
+        }
+
+        /// Convert an array chunk to a bitmap chunk
+        void to_bitmap() {
+          bitmap.assign(chunk_words, word_type(0));
+          for(const std::uint16_t offset : array)
+            bitmap[offset / word_bits] |= word_type(1) << (offset % word_bits);
+          std::vector<std::uint16_t>().swap(array);
+        }
+
+        /// Convert a bitmap chunk to an array chunk
+        void to_array() {
+          array.clear();
+          array.reserve(count);
+          for(size_type w = 0ul; w < chunk_words; ++w)
+            for(word_type word = bitmap[w]; word; word &= word - 1u)
+              array.push_back(std::uint16_t(w * word_bits + trailing_zeros(word)));
+          std::vector<word_type>().swap(bitmap);
+        }
+
+        /// Store the chunk in the smallest format
+        void normalize() {
+          if(is_bitmap() && (count <= array_max))
+            to_array();
+          else if(! is_bitmap() && (count > array_max))
+            to_bitmap();
+        }
+
+        /// Apply an operation to each set bit of the chunk, in order
+        template <typename Op>
+        void for_each(Op&& op) const {
+          const size_type base = key * chunk_bits;
+          if(is_bitmap()) {
+            for(size_type w = 0ul; w < chunk_words; ++w)
+              for(word_type word = bitmap[w]; word; word &= word - 1u)
+                op(base + w * word_bits + trailing_zeros(word));
+          } else {
+            for(const std::uint16_t offset : array)
+              op(base + offset);
+          }
+        }
+      }; // struct Chunk
+
+      size_type size_; ///< The number of bits
+      std::vector<Chunk> chunks_; ///< The chunks with set bits, sorted by key
+
+      /// Find a chunk
+
+      /// \param key The chunk index
+      /// \return An iterator to the first chunk whose index is not less than
+      /// \c key
+      std::vector<Chunk>::iterator lower_bound(const size_type key) {
+        return std::lower_bound(chunks_.begin(), chunks_.end(), key,
+            [] (const Chunk& chunk, const size_type k) { return chunk.key < k; });
+      }
+
+      std::vector<Chunk>::const_iterator lower_bound(const size_type key) const {
+        return std::lower_bound(chunks_.begin(), chunks_.end(), key,
+            [] (const Chunk& chunk, const size_type k) { return chunk.key < k; });
+      }
+
+      /// Intersect two chunks with the same key
+
+      /// \param left The left-hand chunk
+      /// \param right The right-hand chunk
+      /// \return The intersection of \c left and \c right
+      static Chunk intersect(const Chunk& left, const Chunk& right) {
+        Chunk result(left.key);
+        if(left.is_bitmap() && right.is_bitmap()) {
+          result.bitmap.resize(chunk_words);
+          for(size_type w = 0ul; w < chunk_words; ++w) {
+            result.bitmap[w] = left.bitmap[w] & right.bitmap[w];
+            result.count += bit_count(result.bitmap[w]);
+          }
+          result.normalize();
+        } else if(left.is_bitmap() || right.is_bitmap()) {
+          const Chunk& array = (left.is_bitmap() ? right : left);
+          const Chunk& bitmap = (left.is_bitmap() ? left : right);
+          for(const std::uint16_t offset : array.array)
+            if(bitmap.test(offset))
+              result.array.push_back(offset);
+          result.count = result.array.size();
+        } else {
+          std::set_intersection(left.array.begin(), left.array.end(),
+              right.array.begin(), right.array.end(),
+              std::back_inserter(result.array));
+          result.count = result.array.size();
+        }
+        return result;
+      }
+
+      /// Count the common bits of two chunks with the same key
+
+      /// \param left The left-hand chunk
+      /// \param right The right-hand chunk
+      /// \return The number of bits that are set in both chunks
+      static size_type count_and(const Chunk& left, const Chunk& right) {
+        size_type c = 0ul;
+        if(left.is_bitmap() && right.is_bitmap()) {
+          for(size_type w = 0ul; w < chunk_words; ++w)
+            c += bit_count(word_type(left.bitmap[w] & right.bitmap[w]));
+        } else if(left.is_bitmap() || right.is_bitmap()) {
+          const Chunk& array = (left.is_bitmap() ? right : left);
+          const Chunk& bitmap = (left.is_bitmap() ? left : right);
+          for(const std::uint16_t offset : array.array)
+            c += bitmap.test(offset);
+        } else {
+          auto l = left.array.begin();
+          auto r = right.array.begin();
+          while((l != left.array.end()) && (r != right.array.end())) {
+            if(*l < *r) {
+              ++l;
+            } else if(*r < *l) {
+              ++r;
+            } else {
+              ++c;
+              ++l;
+              ++r;
+            }
+          }
+        }
+        return c;
+      }
+
+      /// Unite two chunks with the same key
+
+      /// \param[in,out] left The left-hand chunk, which is replaced by the
+      /// union
+      /// \param right The right-hand chunk
+      static void unite(Chunk& left, const Chunk& right) {
+        if(! left.is_bitmap() && ! right.is_bitmap()) {
+          std::vector<std::uint16_t> array;
+          array.reserve(left.array.size() + right.array.size());
+          std::set_union(left.array.begin(), left.array.end(),
+              right.array.begin(), right.array.end(), std::back_inserter(array));
+          left.array.swap(array);
+          left.count = left.array.size();
+          left.normalize();
+          return;
+        }
+
+        if(! left.is_bitmap())
+          left.to_bitmap();
+        left.count = 0ul;
+        if(right.is_bitmap()) {
+          for(size_type w = 0ul; w < chunk_words; ++w)
+            left.bitmap[w] |= right.bitmap[w];
+        } else {
+          for(const std::uint16_t offset : right.array)
+            left.bitmap[offset / word_bits] |= word_type(1) << (offset % word_bits);
+        }
+        for(size_type w = 0ul; w < chunk_words; ++w)
+          left.count += bit_count(left.bitmap[w]);
+      }
+
+    public:
+
+      /// Construct a compressed bitset that contains \c s cleared bits
+
+      /// \param s The number of bits
+      explicit CompressedBitset(const size_type s = 0ul) : size_(s), chunks_() { }
+
+      /// Construct a compressed bitset from a bitset
+
+      /// \tparam Block The bitset block type
+      /// \param bits The bitset to be compressed
+      template <typename Block>
+      explicit CompressedBitset(const Bitset<Block>& bits) :
+        size_(bits.size()), chunks_()
+      {
+        for_each_set_bit(bits, [this] (const size_type i) { this->push_back(i); });
+      }
+
+      /// \return The number of bits
+      size_type size() const { return size_; }
+
+      /// \return The number of set bits
+      size_type count() const {
+        size_type c = 0ul;
+        for(const Chunk& chunk : chunks_)
+          c += chunk.count;
+        return c;
+      }
+
+      /// \return The number of bytes used to store the set bits
+      size_type memory() const {
+        size_type bytes = chunks_.capacity() * sizeof(Chunk);
+        for(const Chunk& chunk : chunks_)
+          bytes += chunk.array.capacity() * sizeof(std::uint16_t) +
+              chunk.bitmap.capacity() * sizeof(word_type);
+        return bytes;
+      }
+
+      /// Bit accessor
+
+      /// \param i The bit index
+      /// \return The value of the \c i -th bit
+      bool operator[](const size_type i) const {
+        TA_ASSERT(i < size_);
+        auto it = lower_bound(i / chunk_bits);
+        return (it != chunks_.end()) && (it->key == i / chunk_bits) &&
+            it->test(i % chunk_bits);
+      }
+
+      /// Set a bit
+
+      /// \param i The bit to be set
+      void set(const size_type i) {
+        TA_ASSERT(i < size_);
+        const size_type key = i / chunk_bits;
+        const std::uint16_t offset = i % chunk_bits;
+        auto it = lower_bound(key);
+        if((it == chunks_.end()) || (it->key != key))
+          it = chunks_.insert(it, Chunk(key));
+        if(it->is_bitmap()) {
+          word_type& word = it->bitmap[offset / word_bits];
+          const word_type mask = word_type(1) << (offset % word_bits);
+          if(! (word & mask)) {
+            word |= mask;
+            ++it->count;
+          }
+        } else {
+          auto pos = std::lower_bound(it->array.begin(), it->array.end(), offset);
+          if((pos == it->array.end()) || (*pos != offset)) {
+            it->array.insert(pos, offset);
+            ++it->count;
+            it->normalize();
+          }
+        }
+      }
+
+      /// Set a bit that follows all set bits
+
+      /// This is faster than \c set() when the bits are set in order.
+      /// \param i The bit to be set, which must be larger than all set bits
+      void push_back(const size_type i) {
+        TA_ASSERT(i < size_);
+        const size_type key = i / chunk_bits;
+        TA_ASSERT(chunks_.empty() || (chunks_.back().key <= key));
+        if(chunks_.empty() || (chunks_.back().key != key))
+          chunks_.emplace_back(key);
+        Chunk& chunk = chunks_.back();
+        const std::uint16_t offset = i % chunk_bits;
+        if(chunk.is_bitmap()) {
+          chunk.bitmap[offset / word_bits] |= word_type(1) << (offset % word_bits);
+        } else {
+          TA_ASSERT(chunk.array.empty() || (chunk.array.back() < offset));
+          chunk.array.push_back(offset);
+        }
+        ++chunk.count;
+        if(! chunk.is_bitmap() && (chunk.count > array_max))
+          chunk.to_bitmap();
+      }
+
+      /// Reset a bit
+
+      /// \param i The bit to be reset
+      void reset(const size_type i) {
+        TA_ASSERT(i < size_);
+        const size_type key = i / chunk_bits;
+        const std::uint16_t offset = i % chunk_bits;
+        auto it = lower_bound(key);
+        if((it == chunks_.end()) || (it->key != key))
+          return;
+        if(it->is_bitmap()) {
+          word_type& word = it->bitmap[offset / word_bits];
+          const word_type mask = word_type(1) << (offset % word_bits);
+          if(word & mask) {
+            word &= ~mask;
+            --it->count;
+            it->normalize();
+          }
+        } else {
+          auto pos = std::lower_bound(it->array.begin(), it->array.end(), offset);
+          if((pos != it->array.end()) && (*pos == offset)) {
+            it->array.erase(pos);
+            --it->count;
+          }
+        }
+        if(it->count == 0ul)
+          chunks_.erase(it);
+      }
+
+      /// Reset all bits
+      void reset() { chunks_.clear(); }
+
+      /// And-assignment operator
+
+      /// \param other The bitset to be and-assigned to this bitset
+      /// \return A reference to this bitset
+      CompressedBitset& operator&=(const CompressedBitset& other) {
+        TA_ASSERT(size_ == other.size_);
+        std::vector<Chunk> chunks;
+        auto l = chunks_.begin();
+        auto r = other.chunks_.begin();
+        while((l != chunks_.end()) && (r != other.chunks_.end())) {
+          if(l->key < r->key) {
+            ++l;
+          } else if(r->key < l->key) {
+            ++r;
+          } else {
+            Chunk chunk = intersect(*l, *r);
+            if(chunk.count)
+              chunks.push_back(std::move(chunk));
+            ++l;
+            ++r;
+          }
+        }
+        chunks_.swap(chunks);
+        return *this;
+      }
+
+      /// Or-assignment operator
+
+      /// \param other The bitset to be or-assigned to this bitset
+      /// \return A reference to this bitset
+      CompressedBitset& operator|=(const CompressedBitset& other) {
+        TA_ASSERT(size_ == other.size_);
+        std::vector<Chunk> chunks;
+        chunks.reserve(chunks_.size() + other.chunks_.size());
+        auto l = chunks_.begin();
+        auto r = other.chunks_.begin();
+        while((l != chunks_.end()) || (r != other.chunks_.end())) {
+          if((r == other.chunks_.end()) || ((l != chunks_.end()) && (l->key < r->key))) {
+            chunks.push_back(std::move(*l++));
+          } else if((l == chunks_.end()) || (r->key < l->key)) {
+            chunks.push_back(*r++);
+          } else {
+            unite(*l, *r++);
+            chunks.push_back(std::move(*l++));
+          }
+        }
+        chunks_.swap(chunks);
+        return *this;
+      }
+
+      /// Check for common bits
+
+      /// \param other The bitset to be compared to this bitset
+      /// \return \c true when a bit is set in both bitsets
+      bool intersects(const CompressedBitset& other) const {
+        TA_ASSERT(size_ == other.size_);
+        auto l = chunks_.begin();
+        auto r = other.chunks_.begin();
+        while((l != chunks_.end()) && (r != other.chunks_.end())) {
+          if(l->key < r->key) {
+            ++l;
+          } else if(r->key < l->key) {
+            ++r;
+          } else {
+            if(count_and(*l, *r))
+              return true;
+            ++l;
+            ++r;
+          }
+        }
+        return false;
+      }
+
+      /// Count the common bits
+
+      /// \param other The bitset to be compared to this bitset
+      /// \return The number of bits that are set in both bitsets
+      size_type count_and(const CompressedBitset& other) const {
+        TA_ASSERT(size_ == other.size_);
+        size_type c = 0ul;
+        auto l = chunks_.begin();
+        auto r = other.chunks_.begin();
+        while((l != chunks_.end()) && (r != other.chunks_.end())) {
+          if(l->key < r->key) {
+            ++l;
+          } else if(r->key < l->key) {
+            ++r;
+          } else {
+            c += count_and(*l, *r);
+            ++l;
+            ++r;
+          }
+        }
+        return c;
+      }
+
+      /// Apply an operation to each set bit
+
+      /// \tparam Op The operation type, with signature <tt>void(std::size_t)</tt>
+      /// \param op The operation, which is called with the index of each set
+      /// bit, in order
+      template <typename Op>
+      void for_each(Op&& op) const {
+        for(const Chunk& chunk : chunks_)
+          chunk.for_each(op);
+      }
+
+      /// Expand this bitset
+
+      /// \return A bitset with the same bits
+      Bitset<> to_bitset() const {
+        Bitset<> result(size_);
+        for_each([&result] (const size_type i) { result.set(i); });
+        return result;
+      }
+
+    }; // class CompressedBitset
+
+    /// Bitwise and operator of compressed bitsets
+
+    /// \param left The left-hand bitset
+    /// \param right The right-hand bitset
+    /// \return The intersection of the \c left and \c right bitsets
+    inline CompressedBitset operator&(CompressedBitset left, const CompressedBitset& right) {
+      left &= right;
+      return left;
+    }
+
+    /// Bitwise or operator of compressed bitsets
+
+    /// \param left The left-hand bitset
+    /// \param right The right-hand bitset
+    /// \return The union of the \c left and \c right bitsets
+    inline CompressedBitset operator|(CompressedBitset left, const CompressedBitset& right) {
+      left |= right;
+      return left;
+    }
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_COMPRESSED_BITSET_H__INCLUDED
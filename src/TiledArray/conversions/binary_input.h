@@ -0,0 +1,157 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  binary_input.h
+ *  May 17, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_BINARY_INPUT_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_BINARY_INPUT_H__INCLUDED
+
+#include <TiledArray/conversions/coo.h>
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/tensor.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Read an array from a dense binary file
+
+  /// The file holds all elements of the array in row-major order, as raw
+  /// values of the element type, starting with the element at the lower
+  /// bound of the elements range. Each process reads only the elements of
+  /// its own tiles, with one read per tile row, so the file is read once in
+  /// total and no process reads it all. The shape of sparse arrays is the
+  /// norm of the tiles that are read, so tiles that hold only zeros are zero
+  /// tiles. The file must be visible to all processes. This function is
+  /// collective.
+  /// \tparam T The element type
+  /// \tparam A The tile allocator type
+  /// \tparam Policy The array policy type
+  /// \param[out] array The array that will hold the file
+  /// \param world The world of the array
+  /// \param path The path of the file
+  /// \param trange The tiled range of the array
+  /// \param pmap The process map of the array; the default process map is
+  /// used when it is null
+  /// \throw TiledArray::Exception When the file cannot be read or is too
+  /// small.
+  template <typename T, typename A, typename Policy>
+  void read_dense_binary(DistArray<Tensor<T, A>, Policy>& array, World& world,
+      const std::string& path, const TiledRange& trange,
+      std::shared_ptr<typename DistArray<Tensor<T, A>, Policy>::pmap_interface> pmap =
+          std::shared_ptr<typename DistArray<Tensor<T, A>, Policy>::pmap_interface>())
+  {
+    typedef Tensor<T, A> tile_type;
+    if(! pmap)
+      pmap = Policy::default_pmap(world, trange.tiles_range().volume());
+
+    std::ifstream file(path, std::ios::binary);
+    if(! file)
+      TA_EXCEPTION("Unable to open binary array file.");
+
+    const Range& elements = trange.elements_range();
+    std::unordered_map<std::size_t, tile_type> tiles;
+    for(const std::size_t i : *pmap) {
+      tile_type tile(trange.make_tile_range(i));
+      const Range& range = tile.range();
+      const std::size_t row = range.extent_data()[range.rank() - 1u];
+      for(std::size_t first = 0ul; first < tile.size(); first += row) {
+        file.seekg(elements.ordinal(range.idx(first)) * sizeof(T));
+        file.read(reinterpret_cast<char*>(tile.data() + first), row * sizeof(T));
+        if(! file)
+          TA_EXCEPTION("Unexpected end of binary array file.");
+      }
+      tiles.emplace(i, std::move(tile));
+    }
+    file.close();
+
+    array = detail::array_from_local_tiles<tile_type, Policy>(world, trange, pmap, tiles);
+  }
+
+  /// Read an array from a binary element list
+
+  /// The file is a list of records, each of which holds the element index,
+  /// as one 64-bit unsigned integer per dimension, followed by the element
+  /// value, as a raw value of the element type, without padding. The
+  /// records are split evenly among the processes, and each process reads
+  /// only its own part of the file and sends each element to the owner of
+  /// its tile, with one all-to-all exchange. Elements that are not listed
+  /// are zero, and the values of repeated elements are summed. The shape of
+  /// sparse arrays is the norm of the tiles that are read, so tiles with no
+  /// listed elements are zero tiles. The file must be visible to all
+  /// processes. This function is collective.
+  /// \tparam T The element type
+  /// \tparam A The tile allocator type
+  /// \tparam Policy The array policy type
+  /// \param[out] array The array that will hold the file
+  /// \param world The world of the array
+  /// \param path The path of the file
+  /// \param trange The tiled range of the array
+  /// \param pmap The process map of the array; the default process map is
+  /// used when it is null
+  /// \throw TiledArray::Exception When the file cannot be read, its size is
+  /// not a multiple of the record size, or an element is not in \c trange .
+  template <typename T, typename A, typename Policy>
+  void read_element_list_binary(DistArray<Tensor<T, A>, Policy>& array,
+      World& world, const std::string& path, const TiledRange& trange,
+      std::shared_ptr<typename DistArray<Tensor<T, A>, Policy>::pmap_interface> pmap =
+          std::shared_ptr<typename DistArray<Tensor<T, A>, Policy>::pmap_interface>())
+  {
+    typedef Tensor<T, A> tile_type;
+    if(! pmap)
+      pmap = Policy::default_pmap(world, trange.tiles_range().volume());
+
+    const std::size_t rank = trange.rank();
+    const std::size_t record = rank * sizeof(std::uint64_t) + sizeof(T);
+    const std::size_t nproc = world.size();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if(! file)
+      TA_EXCEPTION("Unable to open binary array file.");
+    const std::size_t bytes = file.tellg();
+    if(bytes % record)
+      TA_EXCEPTION("The size of the binary element list is not a multiple of the record size.");
+
+    // Read the records of this process and bucket them by the owner of their tile
+    const std::size_t nrecords = bytes / record;
+    const std::size_t first = (nrecords * world.rank()) / nproc;
+    const std::size_t last = (nrecords * (world.rank() + 1ul)) / nproc;
+    std::vector<unsigned char> buffer((last - first) * record);
+    file.seekg(first * record);
+    file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if(! file)
+      TA_EXCEPTION("Unexpected end of binary array file.");
+    file.close();
+
+    detail::CooBuckets<T> buckets(world, trange, pmap);
+    for(std::size_t r = 0ul; r < buffer.size(); r += record)
+      buckets.add_record(buffer.data() + r);
+    std::vector<unsigned char>().swap(buffer);
+
+    array = buckets.template make_array<tile_type, Policy>(world);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_BINARY_INPUT_H__INCLUDED
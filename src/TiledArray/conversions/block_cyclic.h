@@ -0,0 +1,641 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  block_cyclic.h
+ *  Mar 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_BLOCK_CYCLIC_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_BLOCK_CYCLIC_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/madness.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/tiled_range.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Two-dimensional block-cyclic distribution of a matrix
+
+  /// The matrix is divided into \c mb by \c nb blocks, which are dealt
+  /// cyclically to an \c nprow by \c npcol process grid: element \c (i,j)
+  /// belongs to grid row <tt>(i / mb) % nprow</tt> and grid column
+  /// <tt>(j / nb) % npcol</tt> . This is the ScaLAPACK layout, with the
+  /// first block on grid position \c (0,0) ; with <tt>mb = nb = 1</tt> it is
+  /// the element-cyclic layout of Elemental. Grid position \c (p,q) is
+  /// process <tt>p * npcol + q</tt> when the grid is row-major, the BLACS
+  /// default, or process <tt>p + q * nprow</tt> when it is column-major.
+  class BlockCyclicLayout {
+  public:
+    typedef std::size_t size_type; ///< Size type
+
+  private:
+    size_type rows_; ///< The number of matrix rows
+    size_type cols_; ///< The number of matrix columns
+    size_type mb_; ///< The number of rows of a block
+    size_type nb_; ///< The number of columns of a block
+    size_type nprow_; ///< The number of process grid rows
+    size_type npcol_; ///< The number of process grid columns
+    bool row_major_; ///< The process order of the grid
+
+    /// The number of indices that a process holds
+
+    /// This is the ScaLAPACK \c NUMROC function.
+    /// \param n The number of indices
+    /// \param block The block size
+    /// \param iproc The grid coordinate of the process
+    /// \param nprocs The number of processes along the grid dimension
+    /// \return The number of indices held by \c iproc
+    static size_type numroc(const size_type n, const size_type block,
+        const size_type iproc, const size_type nprocs)
+    {
+      const size_type nblocks = n / block;
+      size_type result = (nblocks / nprocs) * block;
+      const size_type extra = nblocks % nprocs;
+      if(iproc < extra)
+        result += block;
+      else if(iproc == extra)
+        result += n % block;
+      return result;
+    }
+
+  public:
+
+    /// Constructor
+
+    /// \param rows The number of matrix rows
+    /// \param cols The number of matrix columns
+    /// \param mb The number of rows of a block
+    /// \param nb The number of columns of a block
+    /// \param nprow The number of process grid rows
+    /// \param npcol The number of process grid columns
+    /// \param row_major The process order of the grid [ default = true ]
+    BlockCyclicLayout(const size_type rows, const size_type cols,
+        const size_type mb, const size_type nb, const size_type nprow,
+        const size_type npcol, const bool row_major = true) :
+      rows_(rows), cols_(cols), mb_(mb), nb_(nb), nprow_(nprow), npcol_(npcol),
+      row_major_(row_major)
+    {
+      TA_USER_ASSERT((mb_ > 0ul) && (nb_ > 0ul),
+          "The block sizes of a block-cyclic layout must be positive.");
+      TA_USER_ASSERT((nprow_ > 0ul) && (npcol_ > 0ul),
+          "The process grid of a block-cyclic layout must not be empty.");
+    }
+
+    /// Constructor
+
+    /// The process grid is the most square row-major grid of \c nproc
+    /// processes, with no more rows than columns.
+    /// \param rows The number of matrix rows
+    /// \param cols The number of matrix columns
+    /// \param mb The number of rows of a block
+    /// \param nb The number of columns of a block
+    /// \param nproc The number of processes
+    BlockCyclicLayout(const size_type rows, const size_type cols,
+        const size_type mb, const size_type nb, const size_type nproc) :
+      BlockCyclicLayout(rows, cols, mb, nb, grid_rows(nproc),
+          nproc / grid_rows(nproc))
+    { }
+
+    /// The number of rows of the most square process grid
+
+    /// \param nproc The number of processes
+    /// \return The largest divisor of \c nproc that is not greater than its
+    /// square root
+    static size_type grid_rows(const size_type nproc) {
+      size_type nprow = std::max<size_type>(std::sqrt(double(nproc)), 1ul);
+      while(nproc % nprow)
+        --nprow;
+      return nprow;
+    }
+
+    /// \return The number of matrix rows
+    size_type rows() const { return rows_; }
+    /// \return The number of matrix columns
+    size_type cols() const { return cols_; }
+    /// \return The number of rows of a block
+    size_type mb() const { return mb_; }
+    /// \return The number of columns of a block
+    size_type nb() const { return nb_; }
+    /// \return The number of process grid rows
+    size_type nprow() const { return nprow_; }
+    /// \return The number of process grid columns
+    size_type npcol() const { return npcol_; }
+    /// \return The number of processes of the grid
+    size_type nproc() const { return nprow_ * npcol_; }
+    /// \return \c true if the process order of the grid is row-major
+    bool row_major() const { return row_major_; }
+
+    /// \param i A matrix row
+    /// \return The grid row that holds row \c i
+    size_type grid_row(const size_type i) const { return (i / mb_) % nprow_; }
+
+    /// \param j A matrix column
+    /// \return The grid column that holds column \c j
+    size_type grid_col(const size_type j) const { return (j / nb_) % npcol_; }
+
+    /// \param p A grid row
+    /// \param q A grid column
+    /// \return The process at grid position \c (p,q)
+    ProcessID rank(const size_type p, const size_type q) const {
+      return (row_major_ ? p * npcol_ + q : p + q * nprow_);
+    }
+
+    /// Grid position of a process
+
+    /// \param rank A process
+    /// \param[out] p The grid row of \c rank
+    /// \param[out] q The grid column of \c rank
+    /// \return \c false if \c rank is not in the grid
+    bool position(const ProcessID rank, size_type& p, size_type& q) const {
+      if(size_type(rank) >= nproc())
+        return false;
+      p = (row_major_ ? rank / npcol_ : rank % nprow_);
+      q = (row_major_ ? rank % npcol_ : rank / nprow_);
+      return true;
+    }
+
+    /// \param i A matrix row
+    /// \param j A matrix column
+    /// \return The process that holds element \c (i,j)
+    ProcessID owner(const size_type i, const size_type j) const {
+      return rank(grid_row(i), grid_col(j));
+    }
+
+    /// \param p A grid row
+    /// \return The number of matrix rows held by grid row \c p
+    size_type local_rows(const size_type p) const {
+      return numroc(rows_, mb_, p, nprow_);
+    }
+
+    /// \param q A grid column
+    /// \return The number of matrix columns held by grid column \c q
+    size_type local_cols(const size_type q) const {
+      return numroc(cols_, nb_, q, npcol_);
+    }
+
+    /// \param i A matrix row
+    /// \return The local row of \c i on its grid row
+    size_type local_row(const size_type i) const {
+      return (i / (mb_ * nprow_)) * mb_ + i % mb_;
+    }
+
+    /// \param j A matrix column
+    /// \return The local column of \c j on its grid column
+    size_type local_col(const size_type j) const {
+      return (j / (nb_ * npcol_)) * nb_ + j % nb_;
+    }
+
+    /// \param li A local row
+    /// \param p A grid row
+    /// \return The matrix row of local row \c li of grid row \c p
+    size_type global_row(const size_type li, const size_type p) const {
+      return ((li / mb_) * nprow_ + p) * mb_ + li % mb_;
+    }
+
+    /// \param lj A local column
+    /// \param q A grid column
+    /// \return The matrix column of local column \c lj of grid column \c q
+    size_type global_col(const size_type lj, const size_type q) const {
+      return ((lj / nb_) * npcol_ + q) * nb_ + lj % nb_;
+    }
+
+    /// Visit the segments of a row or column range that have one owner
+
+    /// \tparam Op The visitor type
+    /// \param first The first index of the range
+    /// \param last One past the last index of the range
+    /// \param block The block size of the range dimension
+    /// \param nprocs The number of processes along the grid dimension
+    /// \param op The visitor, which is called as <tt>op(iproc, begin, end)</tt>
+    /// for each segment \c [begin,end) held by grid coordinate \c iproc , in
+    /// ascending order
+    template <typename Op>
+    static void segments(size_type first, const size_type last,
+        const size_type block, const size_type nprocs, Op&& op)
+    {
+      while(first < last) {
+        const size_type end = std::min(last, (first / block + 1ul) * block);
+        op((first / block) % nprocs, first, end);
+        first = end;
+      }
+    }
+
+    /// ScaLAPACK array descriptor
+
+    /// \param context The BLACS context of the process grid
+    /// \param lld The leading dimension of the local matrix
+    /// \return The descriptor of a matrix with this layout
+    std::array<int, 9> descriptor(const int context, const size_type lld) const {
+      return {{ 1, context, int(rows_), int(cols_), int(mb_), int(nb_), 0, 0,
+          int(lld) }};
+    }
+
+  }; // class BlockCyclicLayout
+
+
+  /// The local part of a block-cyclic matrix
+
+  /// The local elements are stored in column-major order, as required by
+  /// ScaLAPACK, with a leading dimension of \c lld() . Processes that are not
+  /// in the process grid hold no elements.
+  /// \tparam T The element type
+  template <typename T>
+  class BlockCyclicMatrix {
+  public:
+    typedef BlockCyclicLayout::size_type size_type; ///< Size type
+    typedef T value_type; ///< Element type
+
+  private:
+    BlockCyclicLayout layout_; ///< The matrix layout
+    bool in_grid_; ///< \c true if this process is in the grid
+    size_type p_; ///< The grid row of this process
+    size_type q_; ///< The grid column of this process
+    size_type local_rows_; ///< The number of local rows
+    size_type local_cols_; ///< The number of local columns
+    std::vector<T> data_; ///< The local elements
+
+  public:
+
+    /// Constructor
+
+    /// The local elements are initialized to zero.
+    /// \param world The world that holds the matrix
+    /// \param layout The matrix layout, whose grid has at most
+    /// <tt>world.size()</tt> processes
+    BlockCyclicMatrix(World& world, const BlockCyclicLayout& layout) :
+      layout_(layout), in_grid_(layout.position(world.rank(), p_, q_)),
+      local_rows_(in_grid_ ? layout.local_rows(p_) : 0ul),
+      local_cols_(in_grid_ ? layout.local_cols(q_) : 0ul),
+      data_(local_rows_ * local_cols_, T(0))
+    {
+      TA_USER_ASSERT(layout.nproc() <= size_type(world.size()),
+          "The process grid is larger than the world.");
+    }
+
+    /// \return The matrix layout
+    const BlockCyclicLayout& layout() const { return layout_; }
+
+    /// \return \c true if this process holds part of the matrix
+    bool in_grid() const { return in_grid_; }
+
+    /// \return The grid row of this process
+    size_type grid_row() const { return p_; }
+
+    /// \return The grid column of this process
+    size_type grid_col() const { return q_; }
+
+    /// \return The number of local rows
+    size_type local_rows() const { return local_rows_; }
+
+    /// \return The number of local columns
+    size_type local_cols() const { return local_cols_; }
+
+    /// \return The leading dimension of the local elements
+    size_type lld() const { return std::max<size_type>(local_rows_, 1ul); }
+
+    /// \return A pointer to the local elements
+    T* data() { return data_.data(); }
+
+    /// \return A const pointer to the local elements
+    const T* data() const { return data_.data(); }
+
+    /// Local element accessor
+
+    /// \param li The local row
+    /// \param lj The local column
+    /// \return A reference to local element \c (li,lj)
+    T& local(const size_type li, const size_type lj) {
+      TA_ASSERT((li < local_rows_) && (lj < local_cols_));
+      return data_[li + lj * local_rows_];
+    }
+
+    /// Local element accessor
+
+    /// \param li The local row
+    /// \param lj The local column
+    /// \return A const reference to local element \c (li,lj)
+    const T& local(const size_type li, const size_type lj) const {
+      TA_ASSERT((li < local_rows_) && (lj < local_cols_));
+      return data_[li + lj * local_rows_];
+    }
+
+    /// ScaLAPACK array descriptor
+
+    /// \param context The BLACS context of the process grid
+    /// \return The descriptor of this matrix
+    std::array<int, 9> descriptor(const int context) const {
+      return layout_.descriptor(context, lld());
+    }
+
+  }; // class BlockCyclicMatrix
+
+
+  namespace detail {
+
+    /// Exchange buffers between all processes
+
+    /// Each process sends \c send[p] to process \c p and receives
+    /// \c recv[p] from process \c p with nonblocking messages, which are
+    /// split into segments of at most 1 GB. The receive buffers must be
+    /// sized by the caller. This function is collective and must be called
+    /// in the same order on all processes.
+    /// \tparam T The element type
+    /// \param world The world of the exchange
+    /// \param send The send buffers of each process
+    /// \param recv The receive buffers of each process
+    template <typename T>
+    inline void exchange_buffers(World& world, std::vector<std::vector<T> >& send,
+        std::vector<std::vector<T> >& recv)
+    {
+      TA_ASSERT(send.size() == std::size_t(world.size()));
+      TA_ASSERT(recv.size() == std::size_t(world.size()));
+      const int tag = world.mpi.unique_tag();
+      const ProcessID me = world.rank();
+      const std::size_t segment =
+          std::max<std::size_t>((std::size_t(1) << 30) / sizeof(T), 1ul);
+
+      std::vector<SafeMPI::Request> requests;
+      for(ProcessID p = 0; p < world.size(); ++p) {
+        if(p == me)
+          continue;
+        for(std::size_t first = 0ul; first < recv[p].size(); first += segment)
+          requests.push_back(world.mpi.Irecv(recv[p].data() + first,
+              std::min(segment, recv[p].size() - first) * sizeof(T), MPI_BYTE,
+              p, tag));
+        for(std::size_t first = 0ul; first < send[p].size(); first += segment)
+          requests.push_back(world.mpi.Isend(send[p].data() + first,
+              std::min(segment, send[p].size() - first) * sizeof(T), MPI_BYTE,
+              p, tag));
+      }
+
+      TA_ASSERT(send[me].size() == recv[me].size());
+      recv[me].swap(send[me]);
+
+      for(SafeMPI::Request& request : requests)
+        World::await(request);
+    }
+
+  } // namespace detail
+
+
+  /// Convert an array into a block-cyclic matrix
+
+  /// The local tiles of \c array are packed into one buffer per destination
+  /// process, and the buffers are exchanged in a single all-to-all step, so
+  /// no process gathers the whole matrix. The element layout of the buffers
+  /// is implied by the tiled range, shape, and process map of \c array ,
+  /// which every process knows, so no indices are sent. Zero tiles are not
+  /// sent and are zero in the result. This function is collective.
+  /// \tparam T The element type
+  /// \tparam A The tile allocator type
+  /// \tparam Policy The array policy type
+  /// \param array A matrix
+  /// \param layout The layout of the result, which has the dimensions of
+  /// \c array
+  /// \return The local part of the block-cyclic matrix
+  template <typename T, typename A, typename Policy>
+  BlockCyclicMatrix<T>
+  array_to_block_cyclic(const DistArray<Tensor<T, A>, Policy>& array,
+      const BlockCyclicLayout& layout)
+  {
+    typedef BlockCyclicLayout::size_type size_type;
+    const TiledRange& trange = array.trange();
+    TA_USER_ASSERT(trange.tiles_range().rank() == 2u,
+        "Only matrices can be converted to a block-cyclic layout.");
+    const auto* lobound = trange.elements_range().lobound_data();
+    const auto* extent = trange.elements_range().extent_data();
+    TA_USER_ASSERT((size_type(extent[0]) == layout.rows()) &&
+        (size_type(extent[1]) == layout.cols()),
+        "The block-cyclic layout does not match the dimensions of the array.");
+    const size_type r0 = lobound[0], c0 = lobound[1];
+
+    World& world = array.world();
+    BlockCyclicMatrix<T> result(world, layout);
+    const size_type nproc = world.size();
+
+    // The local, non-zero tiles in ascending order
+    std::vector<size_type> indices;
+    for(const size_type i : *array.pmap())
+      if(! array.is_zero(i))
+        indices.push_back(i);
+    std::sort(indices.begin(), indices.end());
+
+    // Count the elements sent to each process
+    std::vector<size_type> row_counts(layout.nprow()), col_counts(layout.npcol());
+    auto count = [&] (const Range& range) {
+      std::fill(row_counts.begin(), row_counts.end(), 0ul);
+      std::fill(col_counts.begin(), col_counts.end(), 0ul);
+      BlockCyclicLayout::segments(range.lobound(0) - r0, range.upbound(0) - r0,
+          layout.mb(), layout.nprow(), [&] (size_type p, size_type first, size_type last)
+          { row_counts[p] += last - first; });
+      BlockCyclicLayout::segments(range.lobound(1) - c0, range.upbound(1) - c0,
+          layout.nb(), layout.npcol(), [&] (size_type q, size_type first, size_type last)
+          { col_counts[q] += last - first; });
+    };
+    std::vector<std::vector<T> > send(nproc), recv(nproc);
+    {
+      std::vector<size_type> send_counts(nproc, 0ul);
+      for(const size_type i : indices) {
+        count(trange.make_tile_range(i));
+        for(size_type p = 0ul; p < layout.nprow(); ++p)
+          for(size_type q = 0ul; q < layout.npcol(); ++q)
+            send_counts[layout.rank(p, q)] += row_counts[p] * col_counts[q];
+      }
+      for(size_type p = 0ul; p < nproc; ++p)
+        send[p].reserve(send_counts[p]);
+    }
+
+    // Pack the local tiles, row by row
+    for(const size_type i : indices) {
+      const Tensor<T, A> tile = array.find(i).get();
+      const Range& range = tile.range();
+      const size_type ncols = range.extent(1);
+      for(size_type row = range.lobound(0); row < size_type(range.upbound(0)); ++row) {
+        const size_type p = layout.grid_row(row - r0);
+        const T* const tile_row = tile.data() + (row - range.lobound(0)) * ncols;
+        BlockCyclicLayout::segments(range.lobound(1) - c0, range.upbound(1) - c0,
+            layout.nb(), layout.npcol(), [&] (size_type q, size_type first, size_type last)
+            {
+              std::vector<T>& buffer = send[layout.rank(p, q)];
+              buffer.insert(buffer.end(), tile_row + (first + c0 - range.lobound(1)),
+                  tile_row + (last + c0 - range.lobound(1)));
+            });
+      }
+    }
+
+    // Size the receive buffers from the tiles held by each process
+    if(result.in_grid()) {
+      std::vector<size_type> recv_counts(nproc, 0ul);
+      for(size_type i = 0ul; i < trange.tiles_range().volume(); ++i) {
+        if(array.is_zero(i))
+          continue;
+        count(trange.make_tile_range(i));
+        recv_counts[array.owner(i)] +=
+            row_counts[result.grid_row()] * col_counts[result.grid_col()];
+      }
+      for(size_type p = 0ul; p < nproc; ++p)
+        recv[p].resize(recv_counts[p]);
+    }
+
+    detail::exchange_buffers(world, send, recv);
+    send.clear();
+
+    // Unpack the elements in the order they were packed
+    if(result.in_grid()) {
+      std::vector<size_type> positions(nproc, 0ul);
+      for(size_type i = 0ul; i < trange.tiles_range().volume(); ++i) {
+        if(array.is_zero(i))
+          continue;
+        const std::vector<T>& buffer = recv[array.owner(i)];
+        size_type& position = positions[array.owner(i)];
+        const Range range = trange.make_tile_range(i);
+        for(size_type row = range.lobound(0) - r0; row < range.upbound(0) - r0; ++row) {
+          if(layout.grid_row(row) != result.grid_row())
+            continue;
+          const size_type li = layout.local_row(row);
+          BlockCyclicLayout::segments(range.lobound(1) - c0, range.upbound(1) - c0,
+              layout.nb(), layout.npcol(), [&] (size_type q, size_type first, size_type last)
+              {
+                if(q != result.grid_col())
+                  return;
+                for(size_type col = first; col < last; ++col)
+                  result.local(li, layout.local_col(col)) = buffer[position++];
+              });
+        }
+      }
+    }
+
+    return result;
+  }
+
+  /// Convert a block-cyclic matrix into an array
+
+  /// The local elements of \c matrix are packed into one buffer per tile
+  /// owner, and the buffers are exchanged in a single all-to-all step. Each
+  /// process then assembles its tiles from the buffers. This function is
+  /// collective.
+  /// \tparam T The element type
+  /// \param world The world of the result
+  /// \param matrix The local part of a block-cyclic matrix
+  /// \param trange The tiled range of the result, which has the dimensions
+  /// of \c matrix
+  /// \param pmap The process map of the result [ default = the default
+  /// process map of a dense array ]
+  /// \return A dense array that holds the elements of \c matrix
+  template <typename T>
+  DistArray<Tensor<T>, DensePolicy>
+  block_cyclic_to_array(World& world, const BlockCyclicMatrix<T>& matrix,
+      const TiledRange& trange,
+      std::shared_ptr<DensePolicy::pmap_interface> pmap = nullptr)
+  {
+    typedef BlockCyclicLayout::size_type size_type;
+    const BlockCyclicLayout& layout = matrix.layout();
+    TA_USER_ASSERT(trange.tiles_range().rank() == 2u,
+        "Only matrices can be converted from a block-cyclic layout.");
+    const auto* lobound = trange.elements_range().lobound_data();
+    const auto* extent = trange.elements_range().extent_data();
+    TA_USER_ASSERT((size_type(extent[0]) == layout.rows()) &&
+        (size_type(extent[1]) == layout.cols()),
+        "The block-cyclic layout does not match the dimensions of the array.");
+    const size_type r0 = lobound[0], c0 = lobound[1];
+
+    DistArray<Tensor<T>, DensePolicy> array(world, trange, pmap);
+    const size_type nproc = world.size();
+    const size_type volume = trange.tiles_range().volume();
+
+    // Pack the local elements in the order of the tiles of each owner
+    std::vector<std::vector<T> > send(nproc), recv(nproc);
+    if(matrix.in_grid()) {
+      for(size_type i = 0ul; i < volume; ++i) {
+        std::vector<T>& buffer = send[array.owner(i)];
+        const Range range = trange.make_tile_range(i);
+        for(size_type row = range.lobound(0) - r0; row < range.upbound(0) - r0; ++row) {
+          if(layout.grid_row(row) != matrix.grid_row())
+            continue;
+          const size_type li = layout.local_row(row);
+          BlockCyclicLayout::segments(range.lobound(1) - c0, range.upbound(1) - c0,
+              layout.nb(), layout.npcol(), [&] (size_type q, size_type first, size_type last)
+              {
+                if(q != matrix.grid_col())
+                  return;
+                for(size_type col = first; col < last; ++col)
+                  buffer.push_back(matrix.local(li, layout.local_col(col)));
+              });
+        }
+      }
+    }
+
+    // The local tiles in ascending order
+    std::vector<size_type> indices(array.pmap()->begin(), array.pmap()->end());
+    std::sort(indices.begin(), indices.end());
+
+    // Size the receive buffers
+    {
+      std::vector<size_type> recv_counts(nproc, 0ul);
+      for(const size_type i : indices) {
+        const Range range = trange.make_tile_range(i);
+        BlockCyclicLayout::segments(range.lobound(0) - r0, range.upbound(0) - r0,
+            layout.mb(), layout.nprow(), [&] (size_type p, size_type first, size_type last)
+            {
+              BlockCyclicLayout::segments(range.lobound(1) - c0, range.upbound(1) - c0,
+                  layout.nb(), layout.npcol(), [&] (size_type q, size_type col_first,
+                  size_type col_last)
+                  { recv_counts[layout.rank(p, q)] += (last - first) * (col_last - col_first); });
+            });
+      }
+      for(size_type p = 0ul; p < nproc; ++p)
+        recv[p].resize(recv_counts[p]);
+    }
+
+    detail::exchange_buffers(world, send, recv);
+    send.clear();
+
+    // Assemble the local tiles, row segment by row segment
+    std::vector<size_type> positions(nproc, 0ul);
+    for(const size_type i : indices) {
+      Tensor<T> tile(trange.make_tile_range(i));
+      const Range& range = tile.range();
+      const size_type ncols = range.extent(1);
+      for(size_type row = range.lobound(0); row < size_type(range.upbound(0)); ++row) {
+        const size_type p = layout.grid_row(row - r0);
+        T* const tile_row = tile.data() + (row - range.lobound(0)) * ncols;
+        BlockCyclicLayout::segments(range.lobound(1) - c0, range.upbound(1) - c0,
+            layout.nb(), layout.npcol(), [&] (size_type q, size_type first, size_type last)
+            {
+              const ProcessID source = layout.rank(p, q);
+              const T* const data = recv[source].data() + positions[source];
+              std::copy(data, data + (last - first),
+                  tile_row + (first + c0 - range.lobound(1)));
+              positions[source] += last - first;
+            });
+      }
+      array.set(i, std::move(tile));
+    }
+
+    return array;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_BLOCK_CYCLIC_H__INCLUDED
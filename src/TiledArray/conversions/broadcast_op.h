@@ -0,0 +1,326 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  broadcast_op.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_BROADCAST_OP_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_BROADCAST_OP_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/tensor.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+
+  /// A replicated vector operand of \c broadcast_op()
+
+  /// The elements of the vector are held by every process, and they are
+  /// matched with the elements of a higher rank array by the variable of
+  /// the vector, e.g. the orbital energies of the occupied orbitals with the
+  /// variables \c i and \c j of <tt>T("i,j,a,b")</tt> .
+  /// \tparam T The element type
+  template <typename T>
+  class BroadcastVector {
+    std::vector<T> data_; ///< The scaled elements of the vector
+    std::string var_; ///< The variable of the vector
+
+  public:
+
+    /// Replicate a rank-1 array
+
+    /// All processes fetch all non-zero tiles of \c array , so this
+    /// constructor waits for them; the elements of zero tiles are zero.
+    /// \tparam A The allocator type of the tiles
+    /// \tparam Policy The array policy
+    /// \param array A rank-1 array
+    /// \param var The variable of \c array
+    /// \param factor The factor applied to the elements [default = 1]
+    /// \throw TiledArray::Exception When \c array is not rank-1.
+    template <typename A, typename Policy>
+    BroadcastVector(const DistArray<Tensor<T, A>, Policy>& array,
+        const std::string& var, const T factor = T(1)) :
+      data_(), var_(var)
+    {
+      TA_USER_ASSERT(array.trange().rank() == 1u,
+          "BroadcastVector: the array must be rank-1.");
+      const std::size_t lobound = array.trange().elements_range().lobound_data()[0];
+      data_.assign(array.trange().elements_range().volume(), T(0));
+
+      std::vector<Future<Tensor<T, A> > > tiles;
+      for(std::size_t i = 0ul; i < array.size(); ++i)
+        if(! array.is_zero(i))
+          tiles.push_back(array.find(i));
+      for(auto& future : tiles) {
+        const Tensor<T, A>& tile = future.get();
+        T* MADNESS_RESTRICT const data =
+            data_.data() + (tile.range().lobound_data()[0] - lobound);
+        for(std::size_t x = 0ul; x < tile.size(); ++x)
+          data[x] = factor * tile[x];
+      }
+    }
+
+    /// Construct a vector operand from its elements
+
+    /// \param data The elements of the vector, which are matched with the
+    /// elements of a dimension starting at its lower bound
+    /// \param var The variable of the vector
+    /// \param factor The factor applied to the elements [default = 1]
+    BroadcastVector(const std::vector<T>& data, const std::string& var,
+        const T factor = T(1)) :
+      data_(data), var_(var)
+    {
+      for(T& value : data_)
+        value *= factor;
+    }
+
+    /// \return The scaled elements of the vector
+    const std::vector<T>& data() const { return data_; }
+
+    /// \return The variable of the vector
+    const std::string& var() const { return var_; }
+
+  }; // class BroadcastVector
+
+  namespace detail {
+
+    /// Sum the vector operands of each dimension
+
+    /// \tparam T The element type
+    /// \param trange The tiled range of the array
+    /// \param vars The variables of the array
+    /// \param operands The vector operands
+    /// \param shift The constant that is added to the sum
+    /// \return The sums of the operands of each dimension, by element offset;
+    /// \c shift is added to the first dimension
+    /// \throw TiledArray::Exception When a variable of an operand is not a
+    /// variable of the array, or the size of an operand does not match its
+    /// dimension.
+    template <typename T>
+    inline std::shared_ptr<const std::vector<std::vector<T> > >
+    make_broadcast_sums(const TiledRange& trange, const std::string& vars,
+        const std::vector<BroadcastVector<T> >& operands, const T shift)
+    {
+      const expressions::VariableList var_list(vars);
+      const unsigned int rank = trange.rank();
+      TA_USER_ASSERT(var_list.dim() == rank,
+          "broadcast_op: the number of variables must match the array rank.");
+
+      auto sums = std::make_shared<std::vector<std::vector<T> > >(rank);
+      for(unsigned int d = 0u; d < rank; ++d)
+        (*sums)[d].assign(trange.elements_range().extent_data()[d], T(0));
+      for(T& value : sums->front())
+        value += shift;
+
+      for(const BroadcastVector<T>& operand : operands) {
+        unsigned int d = 0u;
+        while((d < rank) && (var_list[d] != operand.var()))
+          ++d;
+        TA_USER_ASSERT(d < rank,
+            "broadcast_op: an operand variable is not a variable of the array.");
+        std::vector<T>& sum = (*sums)[d];
+        TA_USER_ASSERT(operand.data().size() == sum.size(),
+            "broadcast_op: the size of an operand does not match its dimension.");
+        for(std::size_t x = 0ul; x < sum.size(); ++x)
+          sum[x] += operand.data()[x];
+      }
+
+      return sums;
+    }
+
+    /// Apply a broadcast operation to a tile
+
+    /// \tparam T The element type
+    /// \tparam A The allocator type
+    /// \tparam Op The element operation type
+    /// \param tile The argument tile
+    /// \param sums The sums of the operands of each dimension
+    /// \param lobound The lower bound of the elements of the array
+    /// \param op The element operation
+    /// \return The result tile
+    template <typename T, typename A, typename Op>
+    inline Tensor<T, A> broadcast_op_tile(const Tensor<T, A>& tile,
+        const std::vector<std::vector<T> >& sums,
+        const std::vector<std::size_t>& lobound, const Op& op)
+    {
+      const auto& range = tile.range();
+      const unsigned int rank = range.rank();
+      Tensor<T, A> result(range);
+      if(range.volume() == 0ul)
+        return result;
+
+      // The elements of the last dimension are contiguous, so its sums are
+      // added in the inner loop, and the sums of the other dimensions once
+      // per row
+      const std::size_t* MADNESS_RESTRICT const tile_lobound = range.lobound_data();
+      const std::size_t* MADNESS_RESTRICT const extent = range.extent_data();
+      const std::size_t inner = extent[rank - 1u];
+      const std::size_t outer = range.volume() / inner;
+      const T* MADNESS_RESTRICT const inner_sum = sums[rank - 1u].data() +
+          (tile_lobound[rank - 1u] - lobound[rank - 1u]);
+
+      std::vector<std::size_t> index(rank, 0ul);
+      for(std::size_t o = 0ul; o < outer; ++o) {
+        T outer_sum = T(0);
+        for(unsigned int d = 0u; d + 1u < rank; ++d)
+          outer_sum += sums[d][tile_lobound[d] - lobound[d] + index[d]];
+
+        const T* MADNESS_RESTRICT const arg = tile.data() + o * inner;
+        T* MADNESS_RESTRICT const res = result.data() + o * inner;
+        for(std::size_t x = 0ul; x < inner; ++x)
+          res[x] = op(arg[x], outer_sum + inner_sum[x]);
+
+        // Advance the index of the outer dimensions
+        for(unsigned int d = rank - 1u; d-- > 0u;) {
+          if(++index[d] < extent[d])
+            break;
+          index[d] = 0ul;
+        }
+      }
+
+      return result;
+    }
+
+  }  // namespace detail
+
+  /// Combine an array with vectors that are broadcast by index matching
+
+  /// The result is
+  /// \f[
+  ///   R_{i_1 \dots i_n} = op(A_{i_1 \dots i_n}, s + \sum_m v^m_{i_{d_m}})
+  /// \f]
+  /// where each vector operand \f$v^m\f$ is matched with the dimension
+  /// \f$d_m\f$ of \c arg that has its variable. The vectors are replicated
+  /// once, and the sums and \c op are fused into one pass over each tile, so
+  /// the higher rank operand, e.g. an orbital energy denominator, is never
+  /// formed, e.g.
+  /// \code
+  /// // T("i,j,a,b") / (e_i + e_j - e_a - e_b)
+  /// TArrayD r = broadcast_op(t, "i,j,a,b",
+  ///     { BroadcastVector<double>(e_occ, "i"), BroadcastVector<double>(e_occ, "j"),
+  ///       BroadcastVector<double>(e_vir, "a", -1.0),
+  ///       BroadcastVector<double>(e_vir, "b", -1.0) },
+  ///     [] (const double t, const double d) { return t / d; });
+  /// \endcode
+  /// Only rank-1 operands are broadcast; several operands may have the same
+  /// variable. The result has the distribution of \c arg , and this function
+  /// does not wait for the tiles of \c arg .
+  /// \tparam T The element type
+  /// \tparam A The allocator type
+  /// \tparam Op The element operation type
+  /// \param arg The argument array
+  /// \param vars The variables of \c arg
+  /// \param operands The vector operands
+  /// \param op The element operation, <tt>T op(T element, T sum)</tt>
+  /// \param shift The constant \c s that is added to the sums [default = 0]
+  /// \return The result array
+  /// \throw TiledArray::Exception When the variables of the operands do not
+  /// match the variables and dimensions of \c arg .
+  template <typename T, typename A, typename Op>
+  inline DistArray<Tensor<T, A>, DensePolicy>
+  broadcast_op(const DistArray<Tensor<T, A>, DensePolicy>& arg,
+      const std::string& vars, const std::vector<BroadcastVector<T> >& operands,
+      const Op& op, const T shift = T(0))
+  {
+    typedef DistArray<Tensor<T, A>, DensePolicy> array_type;
+    World& world = arg.world();
+    const std::shared_ptr<const std::vector<std::vector<T> > > sums =
+        detail::make_broadcast_sums(arg.trange(), vars, operands, shift);
+    const std::vector<std::size_t> lobound(
+        arg.trange().elements_range().lobound_data(),
+        arg.trange().elements_range().lobound_data() + arg.trange().rank());
+
+    array_type result(world, arg.trange(), arg.shape(), arg.pmap());
+    for(const auto i : *result.pmap())
+      result.set(i, world.taskq.add([sums, lobound, op] (const Tensor<T, A>& tile) {
+        return detail::broadcast_op_tile(tile, *sums, lobound, op);
+      }, arg.find(i)));
+
+    return result;
+  }
+
+  /// Combine a sparse array with vectors that are broadcast by index matching
+
+  /// Zero tiles of \c arg are zero in the result, so \c op must map zero
+  /// elements to zero, e.g. a division by a denominator. The shape of the
+  /// result is computed from the norms of the result tiles, so this function
+  /// is collective, and it waits for the local tiles of \c arg .
+  /// \tparam T The element type
+  /// \tparam A The allocator type
+  /// \tparam Op The element operation type
+  /// \param arg The argument array
+  /// \param vars The variables of \c arg
+  /// \param operands The vector operands
+  /// \param op The element operation, <tt>T op(T element, T sum)</tt>
+  /// \param shift The constant that is added to the sums [default = 0]
+  /// \return The result array
+  /// \throw TiledArray::Exception When the variables of the operands do not
+  /// match the variables and dimensions of \c arg .
+  /// \sa broadcast_op(const DistArray<Tensor<T, A>, DensePolicy>&, const std::string&, const std::vector<BroadcastVector<T> >&, const Op&, const T)
+  template <typename T, typename A, typename Op>
+  inline DistArray<Tensor<T, A>, SparsePolicy>
+  broadcast_op(const DistArray<Tensor<T, A>, SparsePolicy>& arg,
+      const std::string& vars, const std::vector<BroadcastVector<T> >& operands,
+      const Op& op, const T shift = T(0))
+  {
+    typedef DistArray<Tensor<T, A>, SparsePolicy> array_type;
+    typedef typename array_type::shape_type shape_type;
+    typedef typename shape_type::value_type norm_type;
+    typedef std::pair<Tensor<T, A>, norm_type> result_type;
+    World& world = arg.world();
+    const std::shared_ptr<const std::vector<std::vector<T> > > sums =
+        detail::make_broadcast_sums(arg.trange(), vars, operands, shift);
+    const std::vector<std::size_t> lobound(
+        arg.trange().elements_range().lobound_data(),
+        arg.trange().elements_range().lobound_data() + arg.trange().rank());
+
+    // Compute the local result tiles and their norms
+    std::vector<std::pair<std::size_t, Future<result_type> > > tiles;
+    for(const auto i : *arg.pmap())
+      if(! arg.is_zero(i))
+        tiles.emplace_back(i, world.taskq.add(
+            [sums, lobound, op] (const Tensor<T, A>& tile) {
+              Tensor<T, A> result =
+                  detail::broadcast_op_tile(tile, *sums, lobound, op);
+              const norm_type result_norm = result.norm();
+              return result_type(std::move(result), result_norm);
+            }, arg.find(i)));
+
+    Tensor<norm_type> norms(arg.trange().tiles_range(), norm_type(0));
+    for(auto& tile : tiles)
+      norms[tile.first] = tile.second.get().second;
+
+    array_type result(world, arg.trange(),
+        shape_type(world, norms, arg.trange()), arg.pmap());
+    for(auto& tile : tiles)
+      if(! result.is_zero(tile.first))
+        result.set(tile.first, tile.second.get().first);
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_BROADCAST_OP_H__INCLUDED
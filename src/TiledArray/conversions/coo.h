@@ -0,0 +1,275 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  coo.h
+ *  May 18, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_COO_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_COO_H__INCLUDED
+
+#include <TiledArray/conversions/block_cyclic.h>
+#include <TiledArray/dense_shape.h>
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/sparse_shape.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/type_traits.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    inline DenseShape local_tiles_shape(World&, const Tensor<float>&,
+        const TiledRange&, const DenseShape*)
+    { return DenseShape(); }
+
+    /// The shape of an array that is made of the local tiles of each process
+
+    /// \param world The world of the array
+    /// \param norms The norms of the local tiles, which are summed over
+    /// \c world
+    /// \param trange The tiled range of the array
+    /// \return The shape of the array
+    template <typename T>
+    SparseShape<T> local_tiles_shape(World& world, const Tensor<float>& norms,
+        const TiledRange& trange, const SparseShape<T>*)
+    {
+      Tensor<T> tile_norms(norms.range());
+      for(std::size_t i = 0ul; i < norms.size(); ++i)
+        tile_norms[i] = T(norms[i]);
+      return SparseShape<T>(world, tile_norms, trange);
+    }
+
+    /// Construct an array from its local tiles
+
+    /// The norms of the local tiles are summed to make the shape, so the
+    /// tiles that are missing or hold only zeros are zero tiles of sparse
+    /// arrays, and zero-filled tiles of dense arrays. The tiles are inserted
+    /// with \c DistArray::set_bulk() . This function is collective.
+    /// \tparam Tile The array tile type
+    /// \tparam Policy The array policy type
+    /// \param world The world of the array
+    /// \param trange The tiled range of the array
+    /// \param pmap The process map of the array
+    /// \param tiles The local tiles, which are moved to the array
+    /// \return The array
+    template <typename Tile, typename Policy>
+    DistArray<Tile, Policy>
+    array_from_local_tiles(World& world, const TiledRange& trange,
+        const std::shared_ptr<typename DistArray<Tile, Policy>::pmap_interface>& pmap,
+        std::unordered_map<std::size_t, Tile>& tiles)
+    {
+      typedef DistArray<Tile, Policy> array_type;
+      typedef typename array_type::shape_type shape_type;
+
+      Tensor<float> norms(trange.tiles_range(), 0.0f);
+      for(const auto& tile : tiles)
+        norms[tile.first] = float(tile.second.norm());
+      const shape_type shape = local_tiles_shape(world, norms, trange,
+          static_cast<const shape_type*>(nullptr));
+
+      array_type result(world, trange, shape, pmap);
+      std::vector<std::size_t> indices;
+      std::vector<Future<Tile> > futures;
+      for(const std::size_t i : *result.pmap()) {
+        if(result.is_zero(i))
+          continue;
+        auto it = tiles.find(i);
+        indices.push_back(i);
+        futures.emplace_back(it != tiles.end() ? std::move(it->second) :
+            Tile(trange.make_tile_range(i), typename Tile::value_type(0)));
+      }
+      tiles.clear();
+      result.set_bulk(indices, futures);
+
+      return result;
+    }
+
+    /// Coordinate-list elements, bucketed by the owner of their tile
+
+    /// Each element is stored as a record of one 64-bit unsigned integer
+    /// per dimension, for its index, followed by its value, without padding,
+    /// in the bucket of the process that owns its tile.
+    /// \tparam T The element type
+    template <typename T>
+    class CooBuckets {
+      const TiledRange& trange_; ///< The tiled range of the array
+      std::shared_ptr<Pmap> pmap_; ///< The process map of the array
+      std::size_t rank_; ///< The rank of the array
+      std::vector<std::vector<unsigned char> > buckets_; ///< The records sent to each process
+      std::vector<std::uint64_t> index_; ///< Index buffer
+
+      /// The ordinal of the tile that holds \c index_
+      std::size_t tile() const {
+        return trange_.tiles_range().ordinal(trange_.element_to_tile(index_));
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param world The world of the array
+      /// \param trange The tiled range of the array
+      /// \param pmap The process map of the array
+      CooBuckets(World& world, const TiledRange& trange,
+          const std::shared_ptr<Pmap>& pmap) :
+        trange_(trange), pmap_(pmap), rank_(trange.rank()),
+        buckets_(world.size()), index_(rank_)
+      { }
+
+      /// \return The size of a record in bytes
+      std::size_t record_size() const {
+        return rank_ * sizeof(std::uint64_t) + sizeof(T);
+      }
+
+      /// Add an element
+
+      /// \tparam Index The element index type
+      /// \param index The element index
+      /// \param value The element value
+      /// \throw TiledArray::Exception When \c index is not in the tiled range
+      template <typename Index>
+      void add(const Index& index, const T& value) {
+        TA_USER_ASSERT(std::size_t(index.size()) == rank_,
+            "The rank of an element index does not match the tiled range.");
+        std::copy(index.begin(), index.end(), index_.begin());
+        if(! trange_.elements_range().includes(index_))
+          TA_EXCEPTION("An element is not in the tiled range.");
+        std::vector<unsigned char>& bucket = buckets_[pmap_->owner(tile())];
+        const std::size_t size = bucket.size();
+        bucket.resize(size + record_size());
+        std::memcpy(bucket.data() + size, index_.data(), rank_ * sizeof(std::uint64_t));
+        std::memcpy(bucket.data() + size + rank_ * sizeof(std::uint64_t),
+            & value, sizeof(T));
+      }
+
+      /// Add an element that is stored as a record
+
+      /// \param record A pointer to the record
+      /// \throw TiledArray::Exception When the element is not in the tiled
+      /// range
+      void add_record(const unsigned char* record) {
+        std::memcpy(index_.data(), record, rank_ * sizeof(std::uint64_t));
+        if(! trange_.elements_range().includes(index_))
+          TA_EXCEPTION("An element is not in the tiled range.");
+        std::vector<unsigned char>& bucket = buckets_[pmap_->owner(tile())];
+        bucket.insert(bucket.end(), record, record + record_size());
+      }
+
+      /// Construct the array of the elements of all processes
+
+      /// The buckets are sent to their processes with one all-to-all
+      /// exchange, after the bucket sizes. The elements of each tile are
+      /// then added to a zero tile, so the values of repeated elements are
+      /// summed. This function is collective.
+      /// \tparam Tile The array tile type
+      /// \tparam Policy The array policy type
+      /// \param world The world of the array
+      /// \return The array
+      template <typename Tile, typename Policy>
+      DistArray<Tile, Policy> make_array(World& world) {
+        const std::size_t nproc = world.size();
+        std::vector<std::vector<unsigned char> > recv(nproc);
+        {
+          std::vector<std::vector<std::uint64_t> > send_sizes(nproc),
+              recv_sizes(nproc, std::vector<std::uint64_t>(1ul));
+          for(std::size_t p = 0ul; p < nproc; ++p)
+            send_sizes[p].push_back(buckets_[p].size());
+          exchange_buffers(world, send_sizes, recv_sizes);
+          for(std::size_t p = 0ul; p < nproc; ++p)
+            recv[p].resize(recv_sizes[p].front());
+        }
+        exchange_buffers(world, buckets_, recv);
+        std::vector<std::vector<unsigned char> >(nproc).swap(buckets_);
+
+        std::unordered_map<std::size_t, Tile> tiles;
+        const std::size_t record = record_size();
+        T value;
+        for(const std::vector<unsigned char>& message : recv) {
+          for(std::size_t r = 0ul; r < message.size(); r += record) {
+            std::memcpy(index_.data(), message.data() + r, rank_ * sizeof(std::uint64_t));
+            std::memcpy(& value, message.data() + r + rank_ * sizeof(std::uint64_t),
+                sizeof(T));
+            const std::size_t i = tile();
+            auto it = tiles.find(i);
+            if(it == tiles.end())
+              it = tiles.emplace(i, Tile(trange_.make_tile_range(i), T(0))).first;
+            it->second[index_] += value;
+          }
+        }
+
+        return array_from_local_tiles<Tile, Policy>(world, trange_, pmap_, tiles);
+      }
+
+    }; // class CooBuckets
+
+  } // namespace detail
+
+  /// Construct an array from a distributed coordinate list
+
+  /// Each process holds any part of the non-zero elements, as a sequence of
+  /// <tt>std::pair<Index, T></tt> , where \c Index is a random-access
+  /// sequence of integers, e.g. <tt>std::array<std::size_t, 2></tt> . The
+  /// elements are bucketed by the owner of their tile, and the buckets are
+  /// shipped with one all-to-all exchange, so no tile is staged densely
+  /// before it reaches its owner. The shape of sparse arrays is made from
+  /// the norms of the received tiles, so only tiles that hold elements are
+  /// non-zero tiles, and only they are stored. The values of repeated
+  /// elements are summed. This function is collective, e.g.
+  /// \code
+  /// std::vector<std::pair<std::array<std::size_t, 2>, double> > elements =
+  ///     { { {{ 0, 1 }}, 1.0 }, { {{ 5, 3 }}, -2.0 } };
+  /// TSpArrayD a = coo_to_array<TSpArrayD>(world, trange, elements);
+  /// \endcode
+  /// \tparam Array The \c DistArray type, whose tiles are \c Tensor objects
+  /// \tparam Elements The element sequence type
+  /// \param world The world of the array
+  /// \param trange The tiled range of the array
+  /// \param elements The elements of this process
+  /// \param pmap The process map of the array; the default process map is
+  /// used when it is null
+  /// \return The array
+  /// \throw TiledArray::Exception When an element is not in \c trange .
+  template <typename Array, typename Elements>
+  Array coo_to_array(World& world, const TiledRange& trange,
+      const Elements& elements,
+      std::shared_ptr<typename Array::pmap_interface> pmap =
+          std::shared_ptr<typename Array::pmap_interface>())
+  {
+    typedef typename Array::value_type tile_type;
+    typedef typename Array::element_type element_type;
+    typedef detail::policy_t<Array> policy_type;
+
+    if(! pmap)
+      pmap = policy_type::default_pmap(world, trange.tiles_range().volume());
+
+    detail::CooBuckets<element_type> buckets(world, trange, pmap);
+    for(const auto& element : elements)
+      buckets.add(element.first, element_type(element.second));
+
+    return buckets.template make_array<tile_type, policy_type>(world);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_COO_H__INCLUDED
@@ -0,0 +1,207 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  delta.h
+ *  Mar 24, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_DELTA_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_DELTA_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/tile_op/tile_interface.h>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Difference of two versions of a sparse array
+
+  /// The result holds the tiles of <tt>current - previous</tt> whose norm
+  /// is larger than \c tolerance , i.e. the dirty tiles of \c current ; all
+  /// other tiles are zero. Since the cost of an expression with sparse
+  /// arrays scales with the non-zero tile pairs given by the shapes, e.g.
+  /// \c SparseShape::gemm() for contractions, an expression of the delta
+  /// recomputes only the result tiles that depend on dirty tiles. Linear
+  /// and bilinear results can then be updated incrementally with
+  /// \c apply_delta() , e.g. for <tt>W = V T</tt> where \c V changes in a
+  /// few tiles between iterations:
+  /// \code
+  /// TSpArrayD dv = array_delta(v_new, v_old);
+  /// dw("i,j") = dv("i,k") * t("k,j");
+  /// w = apply_delta(w, dw);
+  /// \endcode
+  /// and when \c T changes too, <tt>dw = dv T_new + V_old dt</tt>. This
+  /// function is collective, and it waits for the local tiles of both
+  /// arrays.
+  /// \tparam Tile The tile type
+  /// \param current The current array
+  /// \param previous The previous array, with the same tiled range
+  /// \param tolerance The norm of the tile differences that are dropped
+  /// [default = 0]
+  /// \return The dirty tiles of \c current , as differences, with the
+  /// distribution of \c current
+  /// \throw TiledArray::Exception When the tiled ranges do not match.
+  template <typename Tile>
+  inline DistArray<Tile, SparsePolicy>
+  array_delta(const DistArray<Tile, SparsePolicy>& current,
+      const DistArray<Tile, SparsePolicy>& previous, const float tolerance = 0.0f)
+  {
+    typedef DistArray<Tile, SparsePolicy> array_type;
+    typedef typename array_type::shape_type shape_type;
+    typedef typename shape_type::value_type norm_type;
+    typedef typename array_type::element_type numeric_type;
+    typedef std::pair<Tile, norm_type> result_type;
+    TA_USER_ASSERT(current.trange() == previous.trange(),
+        "array_delta: the arrays must have the same tiled range.");
+    World& world = current.world();
+
+    // Compute the local tile differences and their norms
+    std::vector<std::pair<std::size_t, Future<result_type> > > deltas;
+    for(const auto i : *current.pmap()) {
+      const bool current_zero = current.is_zero(i);
+      const bool previous_zero = previous.is_zero(i);
+      if(current_zero && previous_zero)
+        continue;
+      if(previous_zero)
+        deltas.emplace_back(i, world.taskq.add([] (const Tile& tile) {
+          Tile result = clone(tile);
+          return result_type(result, norm(result));
+        }, current.find(i)));
+      else if(current_zero)
+        deltas.emplace_back(i, world.taskq.add([] (const Tile& tile) {
+          Tile result = scale(tile, numeric_type(-1));
+          return result_type(result, norm(result));
+        }, previous.find(i)));
+      else
+        deltas.emplace_back(i, world.taskq.add([] (const Tile& left, const Tile& right) {
+          Tile result = subt(left, right);
+          return result_type(result, norm(result));
+        }, current.find(i), previous.find(i)));
+    }
+
+    Tensor<norm_type> norms(current.trange().tiles_range(), norm_type(0));
+    for(auto& delta : deltas) {
+      const norm_type delta_norm = delta.second.get().second;
+      if(delta_norm > tolerance)
+        norms[delta.first] = delta_norm;
+    }
+
+    array_type result(world, current.trange(),
+        shape_type(world, norms, current.trange()), current.pmap());
+    for(auto& delta : deltas)
+      if(! result.is_zero(delta.first))
+        result.set(delta.first, delta.second.get().first);
+
+    return result;
+  }
+
+  /// Update an array with a difference
+
+  /// The result is <tt>previous + delta</tt> , where the tiles that are zero
+  /// in \c delta are shared with \c previous instead of being copied or
+  /// recomputed, so the cost of the update scales with the non-zero tiles of
+  /// \c delta . The shape of the result is the sum of the shapes of the
+  /// arguments, see \c SparseShape::add() . This function does not wait for
+  /// the tiles of its arguments.
+  /// \tparam Tile The tile type
+  /// \param previous The array to be updated
+  /// \param delta The difference, with the same tiled range, e.g. computed
+  /// from the result of \c array_delta()
+  /// \return The updated array, with the distribution of \c previous
+  /// \throw TiledArray::Exception When the tiled ranges do not match.
+  template <typename Tile>
+  inline DistArray<Tile, SparsePolicy>
+  apply_delta(const DistArray<Tile, SparsePolicy>& previous,
+      const DistArray<Tile, SparsePolicy>& delta)
+  {
+    typedef DistArray<Tile, SparsePolicy> array_type;
+    TA_USER_ASSERT(previous.trange() == delta.trange(),
+        "apply_delta: the arrays must have the same tiled range.");
+    World& world = previous.world();
+
+    array_type result(world, previous.trange(),
+        previous.shape().add(delta.shape()), previous.pmap());
+    for(const auto i : *result.pmap()) {
+      if(result.is_zero(i))
+        continue;
+      if(delta.is_zero(i))
+        result.set(i, previous.find(i));
+      else if(previous.is_zero(i))
+        result.set(i, delta.find(i));
+      else
+        result.set(i, world.taskq.add([] (const Tile& left, const Tile& right) {
+          return add(left, right);
+        }, previous.find(i), delta.find(i)));
+    }
+
+    return result;
+  }
+
+  /// Dirty tile tracker of an array across iterations
+
+  /// The tracker keeps the last version of an array, and returns the
+  /// difference of each new version with the last one, see
+  /// \c array_delta() . The dirty tiles of the new version are the non-zero
+  /// tiles of the difference.
+  /// \tparam Tile The tile type
+  template <typename Tile>
+  class DeltaTracker {
+  public:
+    typedef DistArray<Tile, SparsePolicy> array_type; ///< The array type
+
+  private:
+    array_type previous_; ///< The last version of the array
+    float tolerance_; ///< The norm of the tile differences that are dropped
+
+  public:
+
+    /// Constructor
+
+    /// \param tolerance The norm of the tile differences that are dropped
+    /// [default = 0]
+    explicit DeltaTracker(const float tolerance = 0.0f) :
+      previous_(), tolerance_(tolerance)
+    { }
+
+    /// Record a new version of the array
+
+    /// This function is collective.
+    /// \param current The new version of the array
+    /// \return The difference of \c current with the last version, or
+    /// \c current itself for the first version, when all tiles are dirty
+    array_type update(const array_type& current) {
+      array_type result = (previous_.is_initialized() ?
+          array_delta(current, previous_, tolerance_) : current);
+      previous_ = current;
+      return result;
+    }
+
+    /// \return The last version of the array
+    const array_type& previous() const { return previous_; }
+
+    /// Forget the last version, so that all tiles of the next one are dirty
+    void reset() { previous_ = array_type(); }
+
+  }; // class DeltaTracker
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_DELTA_H__INCLUDED
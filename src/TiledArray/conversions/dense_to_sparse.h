@@ -3,6 +3,7 @@
 #define TILEDARRAY_DENSETOSPARSE_H__INCLUDED
 
 #include "../dist_array.h"
+#include "../tile_interface/clone.h"
 
 namespace TiledArray {
 
@@ -36,17 +37,78 @@ namespace TiledArray {
 
       // Loop over the local dense tiles and if that tile is in the
       // sparse_array set the sparse array tile with a clone so as not to hold
-      // a pointer to the original tile.
+      // a pointer to the original tile; copy-on-write tiles are shared.
       for (auto it = begin; it != end; ++it) {
           const auto ord = it.ordinal();
           if (!sparse_array.is_zero(ord)) {
-              sparse_array.set(ord, it->get().clone());
+              sparse_array.set(ord, share_or_clone(it->get()));
+              sparse_array.tile_norm(ord, tile_norms[ord]);
           }
       }
 
       return sparse_array;
   }
 
+  /// Function to convert a dense array into a block sparse array, reusing its tiles
+
+  /// The norms of the local tiles are computed in tasks, in a single pass
+  /// over the tile data, and the significant tiles are moved into the sparse
+  /// array instead of being cloned, so the conversion does not hold a second
+  /// copy of the data. \c dense_array is reset; the tiles that are not
+  /// significant are released with it. Other copies of \c dense_array , if
+  /// any, share their tiles with the result.
+  template <typename Tile>
+  DistArray<Tile, SparsePolicy>
+  to_sparse(DistArray<Tile, DensePolicy>&& dense_array) {
+      typedef DistArray<Tile, SparsePolicy> ArrayType;  // return type
+      typedef typename ArrayType::size_type size_type;
+      typedef std::pair<size_type, Future<Tile> > datum_type;
+
+      World& world = dense_array.world();
+
+      // Constructing a tensor to hold the norm of each tile in the Dense Array
+      TiledArray::Tensor<float> tile_norms(dense_array.trange().tiles_range(), 0.0);
+
+      // Compute the norms of the local tiles as they become ready
+      std::vector<datum_type> tiles;
+      tiles.reserve(dense_array.pmap()->local_size());
+      madness::AtomicInt counter; counter = 0;
+      int task_count = 0;
+      auto task = [&counter,&tile_norms] (const size_type index,
+          const Tile& tile) -> bool
+      {
+          tile_norms[index] = tile.norm();
+          ++counter;
+          return true;
+      };
+      for(const size_type index : *(dense_array.pmap())) {
+          tiles.push_back(datum_type(index, dense_array.find(index)));
+          world.taskq.add(task, index, tiles.back().second);
+          ++task_count;
+      }
+
+      // Wait for tile norm data to be collected.
+      if(task_count > 0)
+          world.await([&counter,task_count] () -> bool { return counter == task_count; });
+
+      TiledArray::SparseShape<float> shape(world, tile_norms,
+                                           dense_array.trange());
+      ArrayType sparse_array(world, dense_array.trange(), shape,
+          dense_array.pmap());
+
+      // Move the significant tiles into the sparse array
+      for(const datum_type& datum : tiles) {
+          if (!sparse_array.is_zero(datum.first)) {
+              sparse_array.set(datum.first, datum.second);
+              sparse_array.tile_norm(datum.first, tile_norms[datum.first]);
+          }
+      }
+      tiles.clear();
+      dense_array = DistArray<Tile, DensePolicy>();
+
+      return sparse_array;
+  }
+
   /// If the array is already sparse return a copy of the array.
   template <typename Tile>
   DistArray<Tile, SparsePolicy>
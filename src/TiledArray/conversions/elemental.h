@@ -29,6 +29,7 @@
 #if TILEDARRAY_HAS_ELEMENTAL
 #if HAVE_EL_H
 
+#include <TiledArray/conversions/block_cyclic.h>
 #include <TiledArray/dist_array.h>
 #include <TiledArray/error.h>
 #include <TiledArray/tiled_range.h>
@@ -67,46 +68,49 @@ inline bool uniformly_blocked(TiledRange const &trange){
     return true;
 }
 
+/// The block-cyclic layout of an element-cyclic Elemental matrix
+
+/// \param g The Elemental grid
+/// \param nrows The number of matrix rows
+/// \param ncols The number of matrix columns
+/// \return The layout of an <tt>El::DistMatrix<T></tt> , i.e. [MC,MR] , with
+/// zero alignments on \c g
+inline BlockCyclicLayout el_layout(El::Grid const &g, std::size_t nrows,
+        std::size_t ncols){
+    return BlockCyclicLayout(nrows, ncols, 1ul, 1ul, g.Height(), g.Width(),
+            g.Order() == El::ROW_MAJOR);
+}
+
 template <typename Array>
 El::DistMatrix<typename Array::element_type> matrix_to_el(
         Array const& A, El::Grid const &g){
-    
-    // Check for matrix and uniform blocking
+    typedef typename Array::element_type T;
+
+    // Check for matrix
     TiledRange const &trange = A.trange();
     TA_ASSERT(trange.rank() == 2);
+    TA_USER_ASSERT(g.Size() == A.world().size(),
+            "The Elemental grid must span the world of the array.");
 
     // Determine matrix total size
     auto elem_extent = trange.elements_range().extent_data();
     const auto nrows = elem_extent[0];
     const auto ncols = elem_extent[1];
 
-    // Construct elem array, zero it to avoid having to write zero tiles
-    auto el_A = El::DistMatrix<typename Array::element_type>(nrows, ncols, g);
-    El::Zero(el_A);
-
-    // Loop over all tiles
-    const auto vol = trange.tiles_range().volume();
-    for(auto i = 0ul; i < vol; ++i){
-
-        // Write local tiles into a queue and allow elemental to do all 
-        // communication of elements to the remote nodes.
-        if(!A.is_zero(i) && A.is_local(i)){
-            auto tile = A.find(i).get();
-            
-            auto lo = tile.range().lobound_data();
-            auto up = tile.range().upbound_data();
-
-            for(auto m = lo[0]; m < up[0]; ++m){
-                for(auto n = lo[1]; n < up[1]; ++n){
-                    el_A.QueueUpdate(m,n,tile(m,n));
-                }
-            }
+    // Redistribute the tiles directly into the element-cyclic layout of
+    // Elemental, which works for any tiling since no block size is assumed.
+    const BlockCyclicMatrix<T> local =
+            array_to_block_cyclic(A, el_layout(g, nrows, ncols));
+
+    auto el_A = El::DistMatrix<T>(nrows, ncols, g);
+    TA_ASSERT(std::size_t(el_A.LocalHeight()) == local.local_rows());
+    TA_ASSERT(std::size_t(el_A.LocalWidth()) == local.local_cols());
+    for(auto lj = 0ul; lj < local.local_cols(); ++lj){
+        for(auto li = 0ul; li < local.local_rows(); ++li){
+            el_A.SetLocal(li, lj, local.local(li, lj));
         }
     }
 
-    // Initialize the communication process
-    el_A.ProcessQueues();
-
     return el_A;
 }
 
@@ -116,51 +120,27 @@ DistArray<Tensor<T>, DensePolicy> el_to_matrix(
         El::AbstractDistMatrix<T> const &M, World& world, 
         TiledRange const &trange){
     TA_ASSERT(trange.rank() == 2);
-    TA_USER_ASSERT(uniformly_blocked(trange), "The output TiledRange must be uniformly blocked.");
-
-    // Determine block size
-    auto const& tr1_row = trange.data()[0];
-    auto const& tr1_col = trange.data()[1];
-    auto row_bs = tr1_row.begin()->second - tr1_row.begin()->first;
-    auto col_bs = tr1_col.begin()->second - tr1_col.begin()->first;
-
-    // Copy the unknown matrix distribution into a block based distribution 
-    El::DistMatrix<T, El::MC, El::MR, El::BLOCK> Mb(M.Height(), M.Width(), M.Grid(), row_bs, col_bs);
-    Mb = M;
-
-    DistArray<Tensor<T>, DensePolicy> A(world, trange);
-
-    // Loop over the tiles in the trange
-    const auto vol = trange.tiles_range().volume();
-    for(auto i = 0ul; i < vol; ++i){
-        // Make the tiled range for tile i
-        auto range = trange.make_tile_range(i);
-        auto lo = range.lobound_data();
-
-        auto task = [&](Range rng){
-            auto lo = rng.lobound_data();
-            auto up = rng.upbound_data();
-            auto tile = Tensor<T>(rng, 0.0);
-            
-            // Copy by element 
-            for(auto m = lo[0]; m != up[0]; ++m){
-                for(auto n = lo[1]; n != up[1]; ++n){
-                    tile(m,n) = Mb.GetLocal(Mb.LocalRow(m),Mb.LocalCol(n));
-                }
-            }
-            
-            return tile;
-        };
-         
-        // Send local writes to task
-        if(Mb.IsLocal(lo[0], lo[1])){
-            auto tile_future = A.world().taskq.add(task, range);
-            A.set(i, tile_future);
+    TA_USER_ASSERT(M.Grid().Size() == world.size(),
+            "The Elemental grid must span the world of the array.");
+
+    // Copy the unknown matrix distribution into the element-cyclic
+    // distribution, which El redistributes with its own collectives.
+    El::DistMatrix<T> Mc(M.Height(), M.Width(), M.Grid());
+    Mc = M;
+    TA_USER_ASSERT(Mc.ColAlign() == 0 && Mc.RowAlign() == 0,
+            "The Elemental matrix must not be aligned to a nonzero grid position.");
+
+    BlockCyclicMatrix<T> local(world, el_layout(M.Grid(), M.Height(), M.Width()));
+    TA_ASSERT(std::size_t(Mc.LocalHeight()) == local.local_rows());
+    TA_ASSERT(std::size_t(Mc.LocalWidth()) == local.local_cols());
+    for(auto lj = 0ul; lj < local.local_cols(); ++lj){
+        for(auto li = 0ul; li < local.local_rows(); ++li){
+            local.local(li, lj) = Mc.GetLocal(li, lj);
         }
     }
-    A.world().gop.fence();
 
-    return A;
+    // Assemble the tiles of any tiling from the element-cyclic layout
+    return block_cyclic_to_array(world, local, trange);
 }
 
 } // namespace detail
@@ -217,7 +197,7 @@ El::DistMatrix<typename Array::element_type> array_to_el(
 
 /// @param M An Elemental DistMatrix 
 /// @param world A madness world
-/// @param trange A TiledRange that must be uniformly blocked in each dimension
+/// @param trange A TiledRange of any blocking
 /// @param tf A tensor flattening that dictates which dimensions to unfold. 
 template<typename T>
 DistArray<Tensor<T>, DensePolicy> el_to_array(
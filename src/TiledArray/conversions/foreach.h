@@ -27,11 +27,9 @@
 #define TILEDARRAY_CONVERSIONS_FOREACH_H__INCLUDED
 
 #include <TiledArray/type_traits.h>
-
-/// Forward declarations
-namespace Eigen {
-  template <typename> class aligned_allocator;
-} // namespace Eigen
+#include <TiledArray/tile_batch_task.h>
+#include <TiledArray/tensor/kernels.h>
+#include <TiledArray/tensor/type_traits.h>
 
 namespace TiledArray {
 
@@ -114,6 +112,21 @@ namespace TiledArray {
             [](const bool val) -> bool {return val;});
       }
 
+      /// Remove the cached norm of a tile that is modified in place
+
+      /// \param array The array that holds the tile
+      /// \param index The ordinal index of the local tile
+      template <typename Tile, typename Policy>
+      inline void clear_tile_norm(DistArray<Tile, Policy>& array,
+          const typename DistArray<Tile, Policy>::size_type index)
+      { array.tile_norm(index, -1.0f); }
+
+      /// The tiles of a const array are not modified
+      template <typename Tile, typename Policy>
+      inline void clear_tile_norm(const DistArray<Tile, Policy>&,
+          const typename DistArray<Tile, Policy>::size_type)
+      { }
+
       template <typename I, typename A>
       Future<typename A::value_type> get_sparse_tile(const I& index, const A& array) {
         return (!array.is_zero(index)? array.find(index)
@@ -141,27 +154,34 @@ namespace TiledArray {
       typedef DistArray<ArgTile, DensePolicy> arg_array_type;
       typedef DistArray<ResultTile, DensePolicy> result_array_type;
 
+      typedef typename arg_array_type::value_type arg_value_type;
+      typedef typename result_array_type::value_type result_value_type;
+      typedef typename arg_array_type::size_type size_type;
+
       World& world = arg.world();
 
       // Make an empty result array
       result_array_type result(world, arg.trange(), arg.pmap());
 
-      // Construct the task function for making result tiles.
-      auto task = [&op](const_if_t<not inplace, typename arg_array_type::value_type>& arg_tile,
-          const ArgTiles&... arg_tiles) {
-        void_op_helper<inplace, typename result_array_type::value_type> op_caller;
-        return op_caller(std::forward<Op>(op), arg_tile, arg_tiles...);
+      // Construct the tile function, which shares one copy of op among all
+      // tasks, since the tasks may run after this function returns.
+      auto op_ptr = std::make_shared<std::decay_t<Op> >(std::forward<Op>(op));
+      auto fn = [op_ptr] (const size_type, arg_value_type& arg_tile,
+          ArgTiles&... arg_tiles) -> result_value_type {
+        void_op_helper<inplace, result_value_type> op_caller;
+        return op_caller(*op_ptr,
+            static_cast<const_if_t<not inplace, arg_value_type>&>(arg_tile),
+            static_cast<const ArgTiles&>(arg_tiles)...);
       };
+      auto batcher = make_tile_batcher<result_value_type, arg_value_type,
+          ArgTiles...>(world, fn);
 
-      // Iterate over local tiles of arg
-      for (auto index: *(arg.pmap())) {
-        // Spawn a task to evaluate the tile
-        Future<typename result_array_type::value_type> tile =
-            world.taskq.add(task, arg.find(index), args.find(index)...);
-
-        // Store result tile
-        result.set(index, tile);
-      }
+      // Iterate over local tiles of arg, and compute small tiles in batches
+      for (auto index: *(arg.pmap()))
+        result.set(index, batcher->add(index,
+            arg.trange().make_tile_range(index).volume(), arg.find(index),
+            args.find(index)...));
+      batcher->flush();
 
       return result;
     }
@@ -192,23 +212,26 @@ namespace TiledArray {
 
       // Construct a tensor to hold updated tile norms for the result shape.
       TiledArray::Tensor<typename shape_type::value_type,
-          Eigen::aligned_allocator<typename shape_type::value_type> >
+          typename detail::default_tensor_allocator<
+              typename shape_type::value_type>::type>
       tile_norms(arg.trange().tiles_range(), 0);
 
-      // Construct the task function used to construct the result tiles.
+      // Construct the tile function used to construct the result tiles.
       madness::AtomicInt counter; counter = 0;
       int task_count = 0;
-      auto task = [&op,&counter,&tile_norms](const size_type index,
-          const_if_t<not inplace, arg_value_type>& arg_tile,
-          const ArgTiles&... arg_tiles) -> result_value_type {
+      auto fn = [&op,&counter,&tile_norms](const size_type index,
+          arg_value_type& arg_tile, ArgTiles&... arg_tiles) -> result_value_type {
         nonvoid_op_helper<inplace, result_value_type> op_caller;
-        auto result_tile = op_caller(std::forward<Op>(op), tile_norms[index],
-            arg_tile, arg_tiles...);
+        auto result_tile = op_caller(op, tile_norms[index],
+            static_cast<const_if_t<not inplace, arg_value_type>&>(arg_tile),
+            static_cast<const ArgTiles&>(arg_tiles)...);
         ++counter;
         return std::move(result_tile);
       };
 
       World& world = arg.world();
+      auto batcher = make_tile_batcher<result_value_type, arg_value_type,
+          ArgTiles...>(world, fn);
 
       switch (shape_reduction) {
       case ShapeReductionMethod::Intersect:
@@ -216,8 +239,11 @@ namespace TiledArray {
         for(auto index: *(arg.pmap())) {
           if(is_zero_intersection({arg.is_zero(index), args.is_zero(index)...}))
             continue;
-          auto result_tile = world.taskq.add(task, index, arg.find(index),
+          auto result_tile = batcher->add(index,
+              arg.trange().make_tile_range(index).volume(), arg.find(index),
               args.find(index)...);
+          if(inplace)
+            clear_tile_norm(arg, index);
           ++task_count;
           tiles.push_back(datum_type(index, result_tile));
         }
@@ -227,8 +253,12 @@ namespace TiledArray {
         for(auto index: *(arg.pmap())) {
           if(is_zero_union({arg.is_zero(index), args.is_zero(index)...}))
             continue;
-          auto result_tile = world.taskq.add(task, index, detail::get_sparse_tile(index, arg),
+          auto result_tile = batcher->add(index,
+              arg.trange().make_tile_range(index).volume(),
+              detail::get_sparse_tile(index, arg),
               detail::get_sparse_tile(index, args)...);
+          if(inplace && ! arg.is_zero(index))
+            clear_tile_norm(arg, index);
           ++task_count;
           tiles.push_back(datum_type(index, result_tile));
         }
@@ -237,6 +267,7 @@ namespace TiledArray {
         TA_ASSERT(false);
         break;
       }
+      batcher->flush();
 
       // Wait for tile norm data to be collected.
       if(task_count > 0)
@@ -247,13 +278,136 @@ namespace TiledArray {
           shape_type(world, tile_norms, arg.trange()), arg.pmap());
       for(typename std::vector<datum_type>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
         const size_type index = it->first;
-        if(! result.is_zero(index))
+        if(! result.is_zero(index)) {
           result.set(it->first, it->second);
+          result.tile_norm(index, tile_norms[index]);
+        }
       }
 
       return result;
     }
 
+    /// The Frobenius norm of a tile, as given by the shape of its array
+
+    /// \param array The array that holds the tile
+    /// \param index The ordinal index of the tile
+    /// \return The norm of tile \c index , which is zero for zero tiles
+    template <typename Tile>
+    inline float shape_tile_norm(const DistArray<Tile, SparsePolicy>& array,
+        const typename DistArray<Tile, SparsePolicy>::size_type index)
+    {
+      return float(array.shape()[index])
+          * float(array.trange().make_tile_range(index).volume());
+    }
+
+    /// base implementation of TiledArray::foreach_estimated
+
+    /// The result shape is made from the norms returned by \c estimator ,
+    /// before any result tile is computed, so only the tiles that are
+    /// non-zero in the estimated shape are computed and stored.
+    template <typename Op, typename Estimator, typename ResultTile,
+        typename ArgTile, typename... ArgTiles>
+    inline DistArray<ResultTile, SparsePolicy>
+    foreach_estimated(Op&& op, Estimator&& estimator,
+        const ShapeReductionMethod shape_reduction,
+        const DistArray<ArgTile, SparsePolicy>& arg,
+        const DistArray<ArgTiles, SparsePolicy>&... args)
+    {
+      TA_USER_ASSERT(detail::compare_trange(arg, args...), "Tiled ranges of args must match");
+
+      typedef DistArray<ArgTile, SparsePolicy> arg_array_type;
+      typedef DistArray<ResultTile, SparsePolicy> result_array_type;
+
+      typedef typename arg_array_type::value_type arg_value_type;
+      typedef typename result_array_type::value_type result_value_type;
+      typedef typename arg_array_type::size_type size_type;
+      typedef typename result_array_type::shape_type shape_type;
+
+      World& world = arg.world();
+      const TiledRange& trange = arg.trange();
+
+      // Estimate the norms of the local result tiles
+      TiledArray::Tensor<typename shape_type::value_type,
+          typename detail::default_tensor_allocator<
+              typename shape_type::value_type>::type>
+      tile_norms(trange.tiles_range(), 0);
+      for(auto index: *(arg.pmap())) {
+        const bool is_zero = (shape_reduction == ShapeReductionMethod::Intersect ?
+            is_zero_intersection({arg.is_zero(index), args.is_zero(index)...}) :
+            is_zero_union({arg.is_zero(index), args.is_zero(index)...}));
+        if(is_zero)
+          continue;
+        tile_norms[index] = estimator(shape_tile_norm(arg, index),
+            shape_tile_norm(args, index)...);
+      }
+
+      // Construct the result array with the estimated shape
+      result_array_type result(world, trange,
+          shape_type(world, tile_norms, trange), arg.pmap());
+
+      // Construct the tile function, which shares one copy of op among all
+      // tasks, since the tasks may run after this function returns.
+      auto op_ptr = std::make_shared<std::decay_t<Op> >(std::forward<Op>(op));
+      auto fn = [op_ptr] (const size_type, arg_value_type& arg_tile,
+          ArgTiles&... arg_tiles) -> result_value_type {
+        result_value_type result_tile;
+        (*op_ptr)(result_tile, static_cast<const arg_value_type&>(arg_tile),
+            static_cast<const ArgTiles&>(arg_tiles)...);
+        return result_tile;
+      };
+      auto batcher = make_tile_batcher<result_value_type, arg_value_type,
+          ArgTiles...>(world, fn);
+
+      // Compute only the tiles that are non-zero in the estimated shape
+      for(auto index: *(arg.pmap())) {
+        if(result.is_zero(index))
+          continue;
+        result.set(index, batcher->add(index,
+            trange.make_tile_range(index).volume(),
+            detail::get_sparse_tile(index, arg),
+            detail::get_sparse_tile(index, args)...));
+      }
+      batcher->flush();
+
+      return result;
+    }
+
+    /// The element type of the result of an element-wise function
+
+    /// \tparam Op The element operation type
+    /// \tparam Tiles The argument tile types
+    template <typename Op, typename... Tiles>
+    using elementwise_result_t = std::decay_t<decltype(std::declval<Op>()(
+        std::declval<const typename Tiles::value_type&>()...))>;
+
+    /// The range of the first non-empty tile
+
+    /// \return The range of \c tile or, if \c tile is empty, of the first
+    /// non-empty tile of \c tiles
+    template <typename Tile>
+    inline const typename Tile::range_type& nonempty_range(const Tile& tile) {
+      TA_ASSERT(! tile.empty());
+      return tile.range();
+    }
+
+    template <typename Tile, typename Next, typename... Tiles>
+    inline const typename Tile::range_type&
+    nonempty_range(const Tile& tile, const Next& next, const Tiles&... tiles) {
+      return (tile.empty() ? nonempty_range(next, tiles...) : tile.range());
+    }
+
+    /// Substitute a zero tile for an empty tile
+
+    /// \param tile The tile
+    /// \param range The range of the zero tile
+    /// \return \c tile or, if \c tile is empty, a zero tile with \c range
+    template <typename Tile>
+    inline Tile nonempty_tile(const Tile& tile,
+        const typename Tile::range_type& range)
+    {
+      return (tile.empty() ? Tile(range, typename Tile::value_type(0)) : tile);
+    }
+
   } // namespace TiledArray::detail
 
   /// Apply a function to each tile of a dense Array
@@ -523,6 +677,195 @@ namespace TiledArray {
         shape_reduction, left, right);
   }
 
+  /// Apply a function to each tile of a sparse Array with an estimated shape
+
+  /// This function is like \c foreach() , but the shape of the result is
+  /// predicted before any result tile is computed, from the norms returned
+  /// by \c estimator , so the tiles that are predicted to be zero are
+  /// never computed or stored. The estimator takes the Frobenius norm of the
+  /// argument tile, as given by the shape of \c arg , and returns an
+  /// estimate of the Frobenius norm of the result tile, e.g. an upper bound
+  /// for the square root of each element:
+  /// \code
+  /// TiledArray::TSpArrayD out_array =
+  ///     foreach_estimated(in_array,
+  ///       [] (TiledArray::TensorD& out_tile, const TiledArray::TensorD& in_tile) {
+  ///         out_tile = in_tile.unary([] (const double value) { return std::sqrt(value); });
+  ///       },
+  ///       [] (const float norm) { return std::sqrt(norm); });
+  /// \endcode
+  /// The expected signatures of the tile operation and of the estimator are:
+  /// \code
+  /// void op(typename TiledArray::DistArray<ResultTile,SparsePolicy>::value_type& result_tile,
+  ///     const typename TiledArray::DistArray<ArgTile,SparsePolicy>::value_type& arg_tile);
+  /// float estimator(const float arg_norm);
+  /// \endcode
+  /// \note The estimated norms are the norms of the result shape, so the
+  /// result tiles that are smaller than the estimate are not truncated until
+  /// \c truncate() is called, and result tiles that are estimated to be
+  /// zero are zero even when \c op would not make them zero.
+  /// \tparam ResultTile The tile type of the result array
+  /// \tparam ArgTile The tile type of \c arg
+  /// \tparam Op Tile operation
+  /// \tparam Estimator Tile norm estimator
+  /// \param arg The argument array
+  /// \param op The tile function
+  /// \param estimator The tile norm estimator
+  /// \return An array that holds the result of \c op
+  template <typename ResultTile, typename ArgTile, typename Op, typename Estimator,
+            typename = typename std::enable_if<!std::is_same<ResultTile,ArgTile>::value>::type>
+  inline DistArray<ResultTile, SparsePolicy>
+  foreach_estimated(const DistArray<ArgTile, SparsePolicy>& arg, Op&& op,
+      Estimator&& estimator)
+  {
+    return detail::foreach_estimated<Op, Estimator, ResultTile, ArgTile>(
+        std::forward<Op>(op), std::forward<Estimator>(estimator),
+        ShapeReductionMethod::Intersect, arg);
+  }
+
+  /// Apply a function to each tile of a sparse Array with an estimated shape
+
+  /// Specialization of foreach_estimated<ResultTile,ArgTile,Op,Estimator>
+  /// for the case \c ResultTile == \c ArgTile
+  template <typename Tile, typename Op, typename Estimator>
+  inline DistArray<Tile, SparsePolicy>
+  foreach_estimated(const DistArray<Tile, SparsePolicy>& arg, Op&& op,
+      Estimator&& estimator)
+  {
+    return detail::foreach_estimated<Op, Estimator, Tile, Tile>(
+        std::forward<Op>(op), std::forward<Estimator>(estimator),
+        ShapeReductionMethod::Intersect, arg);
+  }
+
+  /// Apply a function to each tile of sparse Arrays with an estimated shape
+
+  /// The binary form of \c foreach_estimated() , where the estimator takes
+  /// the Frobenius norms of the left and right argument tiles:
+  /// \code
+  /// float estimator(const float left_norm, const float right_norm);
+  /// \endcode
+  /// The norm of a zero argument tile is zero, and with
+  /// \c ShapeReductionMethod::Intersect the estimator is not called when
+  /// either argument tile is zero.
+  template <typename ResultTile, typename LeftTile, typename RightTile,
+            typename Op, typename Estimator,
+            typename = typename std::enable_if<!std::is_same<ResultTile, LeftTile>::value>::type>
+  inline DistArray<ResultTile, SparsePolicy>
+  foreach_estimated(const DistArray<LeftTile, SparsePolicy>& left,
+      const DistArray<RightTile, SparsePolicy>& right, Op&& op,
+      Estimator&& estimator,
+      const ShapeReductionMethod shape_reduction = ShapeReductionMethod::Intersect)
+  {
+    return detail::foreach_estimated<Op, Estimator, ResultTile, LeftTile,
+        RightTile>(std::forward<Op>(op), std::forward<Estimator>(estimator),
+        shape_reduction, left, right);
+  }
+
+  /// Specialization of foreach_estimated<ResultTile,LeftTile,RightTile,Op,Estimator>
+  /// for the case \c ResultTile == \c LeftTile
+  template <typename LeftTile, typename RightTile, typename Op, typename Estimator>
+  inline DistArray<LeftTile, SparsePolicy>
+  foreach_estimated(const DistArray<LeftTile, SparsePolicy>& left,
+      const DistArray<RightTile, SparsePolicy>& right, Op&& op,
+      Estimator&& estimator,
+      const ShapeReductionMethod shape_reduction = ShapeReductionMethod::Intersect)
+  {
+    return detail::foreach_estimated<Op, Estimator, LeftTile, LeftTile,
+        RightTile>(std::forward<Op>(op), std::forward<Estimator>(estimator),
+        shape_reduction, left, right);
+  }
+
+  /// Apply an element-wise function to dense Arrays
+
+  /// Each element of the result is computed from the corresponding elements
+  /// of all arguments in a single pass over the tiles, with one read of each
+  /// argument tile and one write of the result tile, and one task per
+  /// result tile. This is equivalent to an expression of element-wise
+  /// operations, where each operation is evaluated separately, e.g. the
+  /// result of
+  /// \code
+  /// c("i,j") = 2.0 * (a("i,j") + b("i,j")) - d("i,j");
+  /// \endcode
+  /// is given by
+  /// \code
+  /// c = elementwise([] (const double a, const double b, const double d) {
+  ///       return 2.0 * (a + b) - d; }, a, b, d);
+  /// \endcode
+  /// \tparam Op The element operation type, which takes an element of each
+  /// argument
+  /// \tparam Tile The tile type of \c arg
+  /// \tparam Tiles The tile types of \c args
+  /// \param op The element operation
+  /// \param arg The first argument array
+  /// \param args The other argument arrays, which have the same tiled range
+  /// as \c arg
+  /// \return An array of tensors that holds the result of \c op
+  template <typename Op, typename Tile, typename... Tiles>
+  inline DistArray<Tensor<detail::elementwise_result_t<Op, Tile, Tiles...>,
+      typename detail::default_tensor_allocator<detail::elementwise_result_t<Op,
+          Tile, Tiles...> >::type>, DensePolicy>
+  elementwise(Op&& op, const DistArray<Tile, DensePolicy>& arg,
+      const DistArray<Tiles, DensePolicy>&... args)
+  {
+    typedef detail::elementwise_result_t<Op, Tile, Tiles...> value_type;
+    typedef Tensor<value_type, typename detail::default_tensor_allocator<
+        value_type>::type> result_tile_type;
+
+    auto tile_op = [op] (result_tile_type& result, const Tile& tile,
+        const Tiles&... tiles)
+    {
+      result = result_tile_type(tile.range());
+      detail::tensor_init(op, result, tile, tiles...);
+    };
+
+    return detail::foreach<false, decltype(tile_op), result_tile_type, Tile,
+        Tiles...>(std::move(tile_op), arg, args...);
+  }
+
+  /// Apply an element-wise function to sparse Arrays
+
+  /// Each element of the result is computed from the corresponding elements
+  /// of all arguments in a single pass over the tiles, with one read of each
+  /// argument tile and one write of the result tile, and one task per
+  /// result tile. The result tiles are zero where the tiles of all arguments
+  /// are zero, so \c op must return zero when all of its arguments are zero.
+  /// A zero tile is used in place of the zero tiles of the other arguments.
+  /// \tparam Op The element operation type, which takes an element of each
+  /// argument
+  /// \tparam Tile The tile type of \c arg
+  /// \tparam Tiles The tile types of \c args
+  /// \param op The element operation
+  /// \param arg The first argument array
+  /// \param args The other argument arrays, which have the same tiled range
+  /// as \c arg
+  /// \return An array of tensors that holds the result of \c op
+  template <typename Op, typename Tile, typename... Tiles>
+  inline DistArray<Tensor<detail::elementwise_result_t<Op, Tile, Tiles...>,
+      typename detail::default_tensor_allocator<detail::elementwise_result_t<Op,
+          Tile, Tiles...> >::type>, SparsePolicy>
+  elementwise(Op&& op, const DistArray<Tile, SparsePolicy>& arg,
+      const DistArray<Tiles, SparsePolicy>&... args)
+  {
+    typedef detail::elementwise_result_t<Op, Tile, Tiles...> value_type;
+    typedef Tensor<value_type, typename detail::default_tensor_allocator<
+        value_type>::type> result_tile_type;
+    typedef typename DistArray<Tile, SparsePolicy>::shape_type::value_type
+        norm_type;
+
+    auto tile_op = [op] (result_tile_type& result, const Tile& tile,
+        const Tiles&... tiles) -> norm_type
+    {
+      const auto& range = detail::nonempty_range(tile, tiles...);
+      result = result_tile_type(range);
+      detail::tensor_init(op, result, detail::nonempty_tile(tile, range),
+          detail::nonempty_tile(tiles, range)...);
+      return result.norm();
+    };
+
+    return detail::foreach<false, decltype(tile_op), result_tile_type, Tile,
+        Tiles...>(std::move(tile_op), ShapeReductionMethod::Union, arg, args...);
+  }
+
 } // namespace TiledArray
 
 #endif // TILEDARRAY_CONVERSIONS_TRUNCATE_H__INCLUDED
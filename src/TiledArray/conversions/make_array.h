@@ -27,12 +27,9 @@
 #define TILEDARRAY_CONVERSIONS_MAKE_ARRAY_H__INCLUDED
 
 #include <TiledArray/madness.h>
+#include <TiledArray/tile_batch_task.h>
 #include <TiledArray/type_traits.h>
-
-/// Forward declarations
-namespace Eigen {
-  template <typename> class aligned_allocator;
-} // namespace Eigen
+#include <TiledArray/tensor/type_traits.h>
 
 namespace TiledArray {
 
@@ -72,25 +69,27 @@ namespace TiledArray {
       const std::shared_ptr<detail::pmap_t<Array> >& pmap, Op&& op)
   {
     typedef typename Array::value_type value_type;
-    typedef typename value_type::range_type range_type;
+    typedef typename Array::size_type size_type;
 
     // Make an empty result array
     Array result(world, trange);
 
-    // Iterate over local tiles of arg
-    for(const auto index : * result.pmap()) {
-
-      // Spawn a task to evaluate the tile
-      auto tile =
-          world.taskq.add([=] (const range_type& range) -> value_type {
-            value_type tile;
-            op(tile, range);
-            return tile;
-          }, trange.make_tile_range(index));
+    // Construct the tile function, which shares one copy of op among all
+    // tasks, since the tasks may run after this function returns.
+    auto op_ptr = std::make_shared<std::decay_t<Op> >(std::forward<Op>(op));
+    const detail::trange_t<Array> tile_trange = trange;
+    auto fn = [op_ptr,tile_trange] (const size_type index) -> value_type {
+      value_type tile;
+      (*op_ptr)(tile, tile_trange.make_tile_range(index));
+      return tile;
+    };
+    auto batcher = detail::make_tile_batcher<value_type>(world, fn);
 
-      // Store result tile
-      result.set(index, tile);
-    }
+    // Iterate over local tiles, and compute small tiles in batches
+    for(const auto index : * result.pmap())
+      result.set(index, batcher->add(index,
+          trange.make_tile_range(index).volume()));
+    batcher->flush();
 
     return result;
   }
@@ -145,24 +144,28 @@ namespace TiledArray {
 
     // Construct a tensor to hold updated tile norms for the result shape.
     TiledArray::Tensor<typename detail::shape_t<Array>::value_type,
-        Eigen::aligned_allocator<typename detail::shape_t<Array>::value_type> >
+        typename detail::default_tensor_allocator<
+            typename detail::shape_t<Array>::value_type>::type>
     tile_norms(trange.tiles_range(), 0);
 
-    // Construct the task function used to construct the result tiles.
+    // Construct the tile function used to construct the result tiles.
     madness::AtomicInt counter; counter = 0;
     int task_count = 0;
-    auto task = [&](const size_type index) -> value_type {
+    auto fn = [&](const size_type index) -> value_type {
       value_type tile;
       tile_norms[index] = op(tile, trange.make_tile_range(index));
       ++counter;
       return tile;
     };
+    auto batcher = detail::make_tile_batcher<value_type>(world, fn);
 
     for(const auto index : *pmap) {
-      auto result_tile = world.taskq.add(task, index);
+      auto result_tile = batcher->add(index,
+          trange.make_tile_range(index).volume());
       ++task_count;
       tiles.push_back(datum_type(index, result_tile));
     }
+    batcher->flush();
 
     // Wait for tile norm data to be collected.
     if(task_count > 0)
@@ -173,8 +176,10 @@ namespace TiledArray {
         typename Array::shape_type(world, tile_norms, trange), pmap);
     for(auto& it : tiles) {
       const size_type index = it.first;
-      if(! result.is_zero(index))
+      if(! result.is_zero(index)) {
         result.set(it.first, it.second);
+        result.tile_norm(index, tile_norms[index]);
+      }
     }
 
     return result;
@@ -222,6 +227,166 @@ namespace TiledArray {
         trange.tiles_range().volume()), op);
   }
 
+  /// Construct a sparse Array with a known shape
+
+  /// This function is used to construct a `DistArray` object whose shape is
+  /// known before its tiles are generated, e.g. a shape of a priori bounds
+  /// made with `SparseShape::from_bounds()`. Only the tiles that are not
+  /// zero in `shape` are generated, and their norms are not computed, so
+  /// the tiles are generated in one pass. For example:
+  /// \code
+  /// TiledArray::TSpArray<double> array =
+  ///     make_array<TiledArray::TSpArray<double> >(world, trange,
+  ///           TiledArray::SparseShape<float>::from_bounds(bounds, trange), pmap,
+  ///           [=] (TiledArray::Tensor<double>& tile, const TiledArray::Range& range) {
+  ///             tile = TiledArray::Tensor<double>(range, 1.0);
+  ///           });
+  /// \endcode
+  /// The expected signature of the tile operation is:
+  /// \code
+  /// void op(tile_t& tile, const range_t& range);
+  /// \endcode
+  /// where `tile_t` and `range_t` are your tile type and tile range type,
+  /// respectively.
+  /// \tparam Array The `DistArray` type
+  /// \tparam Op Tile operation
+  /// \param world The world where the array will live
+  /// \param trange The tiled range of the array
+  /// \param shape The shape of the array
+  /// \param pmap A shared pointer to the array process map
+  /// \param op The tile function/functor
+  /// \return An array object of type `Array`
+  template <typename Array, typename Op,
+      typename std::enable_if<! is_dense<Array>::value>::type* = nullptr>
+  inline Array
+  make_array(World& world, const detail::trange_t<Array>& trange,
+      const detail::shape_t<Array>& shape,
+      const std::shared_ptr<detail::pmap_t<Array> >& pmap, Op&& op)
+  {
+    typedef typename Array::value_type value_type;
+    typedef typename Array::size_type size_type;
+
+    Array result(world, trange, shape, pmap);
+
+    // Construct the tile function, which shares one copy of op among all
+    // tasks, since the tasks may run after this function returns.
+    auto op_ptr = std::make_shared<std::decay_t<Op> >(std::forward<Op>(op));
+    const detail::trange_t<Array> tile_trange = trange;
+    auto fn = [op_ptr,tile_trange] (const size_type index) -> value_type {
+      value_type tile;
+      (*op_ptr)(tile, tile_trange.make_tile_range(index));
+      return tile;
+    };
+    auto batcher = detail::make_tile_batcher<value_type>(world, fn);
+
+    // Iterate over local, non-zero tiles, and compute small tiles in batches
+    for(const auto index : * result.pmap()) {
+      if(result.is_zero(index))
+        continue;
+      result.set(index, batcher->add(index,
+          trange.make_tile_range(index).volume()));
+    }
+    batcher->flush();
+
+    return result;
+  }
+
+  /// Construct a sparse Array with a known shape and the default process map
+
+  /// \tparam Array The `DistArray` type
+  /// \tparam Op Tile operation
+  /// \param world The world where the array will live
+  /// \param trange The tiled range of the array
+  /// \param shape The shape of the array
+  /// \param op The tile function/functor
+  /// \return An array object of type `Array`
+  template <typename Array, typename Op,
+      typename std::enable_if<! is_dense<Array>::value>::type* = nullptr>
+  inline Array
+  make_array(World& world, const detail::trange_t<Array>& trange,
+      const detail::shape_t<Array>& shape, Op&& op)
+  {
+    return make_array<Array>(world, trange, shape,
+        detail::policy_t<Array>::default_pmap(world,
+        trange.tiles_range().volume()), std::forward<Op>(op));
+  }
+
+  /// Construct a lazy Array
+
+  /// This function is used to construct a `DistArray` object whose tiles are
+  /// generated on demand, rather than up front as with `make_array`. A
+  /// non-zero tile is generated, in a task, when it is first requested, e.g.
+  /// by an expression that consumes the array; tiles that `shape` marks as
+  /// zero are never generated. Since the tiles are not generated up front,
+  /// the shape of the array must be provided. For example:
+  /// \code
+  /// TiledArray::TSpArray<double> array =
+  ///     make_lazy_array<TiledArray::TSpArray<double> >(world, trange, shape, pmap,
+  ///           [=] (TiledArray::Tensor<double>& tile, const TiledArray::Range& range) {
+  ///             tile = TiledArray::Tensor<double>(range, 1.0);
+  ///           });
+  /// \endcode
+  /// The expected signature of the tile operation is:
+  /// \code
+  /// void op(tile_t& tile, const range_t& range);
+  /// \endcode
+  /// where `tile_t` and `range_t` are your tile type and tile range type,
+  /// respectively. The operation must be thread safe, and it must remain
+  /// valid for the lifetime of the array. This function is collective, and
+  /// it fences the world (see `DistArray::init_lazy_tiles()`).
+  /// \tparam Array The `DistArray` type
+  /// \tparam Op Tile operation
+  /// \param world The world where the array will live
+  /// \param trange The tiled range of the array
+  /// \param shape The shape of the array
+  /// \param pmap A shared pointer to the array process map
+  /// \param op The tile function/functor
+  /// \param cache If `true`, generated tiles are stored by the array;
+  /// otherwise, they are generated again for each request
+  /// \return An array object of type `Array`
+  /// \sa DistArray::init_lazy_tiles()
+  template <typename Array, typename Op>
+  inline Array
+  make_lazy_array(World& world, const detail::trange_t<Array>& trange,
+      const detail::shape_t<Array>& shape,
+      const std::shared_ptr<detail::pmap_t<Array> >& pmap, Op&& op,
+      const bool cache = true)
+  {
+    typedef typename Array::value_type value_type;
+    typedef typename value_type::range_type range_type;
+
+    Array result(world, trange, shape, pmap);
+    result.init_lazy_tiles([=] (const range_type& range) -> value_type {
+      value_type tile;
+      op(tile, range);
+      return tile;
+    }, cache);
+
+    return result;
+  }
+
+  /// Construct a lazy Array with the default process map
+
+  /// \tparam Array The `DistArray` type
+  /// \tparam Op Tile operation
+  /// \param world The world where the array will live
+  /// \param trange The tiled range of the array
+  /// \param shape The shape of the array
+  /// \param op The tile function/functor
+  /// \param cache If `true`, generated tiles are stored by the array;
+  /// otherwise, they are generated again for each request
+  /// \return An array object of type `Array`
+  /// \sa make_lazy_array(World&, const detail::trange_t<Array>&, const detail::shape_t<Array>&, const std::shared_ptr<detail::pmap_t<Array> >&, Op&&, const bool)
+  template <typename Array, typename Op>
+  inline Array
+  make_lazy_array(World& world, const detail::trange_t<Array>& trange,
+      const detail::shape_t<Array>& shape, Op&& op, const bool cache = true)
+  {
+    return make_lazy_array<Array>(world, trange, shape,
+        detail::policy_t<Array>::default_pmap(world,
+        trange.tiles_range().volume()), op, cache);
+  }
+
 } // namespace TiledArray
 
 #endif // TILEDARRAY_CONVERSIONS_MAKE_ARRAY_H__INCLUDED
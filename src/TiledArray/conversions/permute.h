@@ -0,0 +1,188 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  permute.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_PERMUTE_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_PERMUTE_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/madness.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+namespace TiledArray {
+
+  namespace detail {
+
+    /// The default size of the messages of \c permute_array
+
+    /// The size is read from the \c TA_PERMUTE_BATCH_BYTES environment
+    /// variable; the default is 4 MiB.
+    /// \return The largest size of a batch of tiles in bytes
+    inline std::size_t permute_batch_bytes() {
+      static const std::size_t bytes = [] () -> std::size_t {
+        const char* batch_bytes = getenv("TA_PERMUTE_BATCH_BYTES");
+        if(batch_bytes)
+          return std::strtoul(batch_bytes, nullptr, 10);
+        return 4ul << 20;
+      }();
+      return bytes;
+    }
+
+    /// The batches of tiles that one process sends to another
+
+    /// The tiles that process \c source sends to process \c target are
+    /// split into batches in the order of their source indices, and a batch
+    /// is closed when it holds at least \c batch_bytes bytes. The batches only
+    /// depend on the tiled range, the shape, and the process maps, so the
+    /// sender and the receiver compute the same batches.
+    /// \param array The source array
+    /// \param owners The owner of each result tile, by source index
+    /// \param source The sending process
+    /// \param target The receiving process
+    /// \param batch_bytes The largest size of a batch, or zero to send
+    /// one message per tile
+    /// \return The source indices of the tiles of each batch
+    template <typename Tile, typename Policy>
+    std::vector<std::vector<std::size_t> >
+    permute_batches(const DistArray<Tile, Policy>& array,
+        const std::vector<ProcessID>& owners, const ProcessID source,
+        const ProcessID target, const std::size_t batch_bytes)
+    {
+      typedef typename DistArray<Tile, Policy>::element_type element_type;
+
+      std::vector<std::vector<std::size_t> > batches;
+      std::size_t bytes = batch_bytes;
+      for(std::size_t i = 0ul; i < owners.size(); ++i) {
+        if((owners[i] != target) || array.is_zero(i) || (array.owner(i) != source))
+          continue;
+        if(bytes >= batch_bytes) {
+          batches.emplace_back();
+          bytes = 0ul;
+        }
+        batches.back().push_back(i);
+        bytes += array.trange().make_tile_range(i).volume() * sizeof(element_type);
+      }
+      return batches;
+    }
+
+  } // namespace detail
+
+  /// Permute an array and redistribute its tiles
+
+  /// This is the whole-array equivalent of <tt>b("j,i") = a("i,j")</tt> .
+  /// The owner of every permuted tile is known to all processes, so each
+  /// process sends its tiles to their owners in the result in a few large
+  /// messages, one per batch of at most \p batch_bytes bytes, instead of
+  /// the result tiles fetching one tile per message. The tiles are
+  /// permuted by the receiver, in one task per tile as its batch arrives, so
+  /// the permutation of early batches overlaps the transfer of later ones.
+  /// The result has the default process map. This function is collective.
+  /// \tparam Tile The array tile type
+  /// \tparam Policy The array policy type
+  /// \param array The array to be permuted
+  /// \param perm The permutation, so the result tiled range is
+  /// <tt>perm * array.trange()</tt>
+  /// \param batch_bytes The largest size of a message, or zero to send one
+  /// message per tile
+  /// \return The permuted array
+  template <typename Tile, typename Policy>
+  DistArray<Tile, Policy>
+  permute_array(const DistArray<Tile, Policy>& array, const Permutation& perm,
+      const std::size_t batch_bytes = detail::permute_batch_bytes())
+  {
+    typedef DistArray<Tile, Policy> array_type;
+    typedef typename array_type::value_type value_type;
+    typedef typename array_type::size_type size_type;
+
+    TA_USER_ASSERT(array.is_initialized(), "The array is not initialized.");
+    if(! perm)
+      return array;
+    TA_USER_ASSERT(perm.dim() == array.trange().tiles_range().rank(),
+        "The permutation does not match the rank of the array.");
+
+    World& world = array.world();
+    array_type result(world, perm * array.trange(), array.shape().perm(perm));
+
+    // The result index and owner of each source tile
+    const size_type volume = array.size();
+    std::vector<size_type> targets(volume);
+    std::vector<ProcessID> owners(volume);
+    for(size_type i = 0ul; i < volume; ++i) {
+      targets[i] = result.trange().tiles_range().ordinal(
+          perm * array.trange().tiles_range().idx(i));
+      owners[i] = result.owner(targets[i]);
+    }
+
+    auto permute_tile = [perm] (const value_type& tile) {
+      return permute(tile, perm);
+    };
+
+    const madness::uniqueidT id = world.unique_obj_id();
+    const ProcessID me = world.rank();
+    for(ProcessID proc = 0; proc < world.size(); ++proc) {
+      if(proc == me) {
+        // Permute the tiles that stay on this process
+        for(const size_type i : *array.pmap())
+          if((owners[i] == me) && ! array.is_zero(i))
+            result.set(targets[i], world.taskq.add(permute_tile, array.find(i)));
+        continue;
+      }
+
+      // Send the local tiles of proc in batches
+      for(const std::vector<size_type>& batch :
+          detail::permute_batches(array, owners, me, proc, batch_bytes))
+      {
+        std::vector<Future<value_type> > tiles;
+        tiles.reserve(batch.size());
+        for(const size_type i : batch)
+          tiles.push_back(array.find(i));
+        world.gop.send(proc, madness::DistributedID(id, batch.front()),
+            world.taskq.add([] (const std::vector<value_type>& tiles) {
+              return tiles;
+            }, tiles));
+      }
+
+      // Receive the tiles that proc sends to this process, and permute them
+      for(const std::vector<size_type>& batch :
+          detail::permute_batches(array, owners, proc, me, batch_bytes))
+      {
+        const Future<std::vector<value_type> > tiles =
+            world.gop.template recv<std::vector<value_type> >(proc,
+            madness::DistributedID(id, batch.front()));
+        for(size_type n = 0ul; n < batch.size(); ++n)
+          result.set(targets[batch[n]], world.taskq.add([perm, n]
+              (const std::vector<value_type>& tiles) {
+                return permute(tiles[n], perm);
+              }, tiles));
+      }
+    }
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_PERMUTE_H__INCLUDED
@@ -0,0 +1,319 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  reshape.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_RESHAPE_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_RESHAPE_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/tiled_range.h>
+#include <vector>
+
+namespace TiledArray {
+
+  namespace detail {
+
+    /// Tile boundaries of a group of dimensions
+
+    /// The elements of a group of dimensions <tt>[first,last)</tt> are
+    /// numbered in row-major order. The tiles of the group hold contiguous
+    /// elements if only the leading dimension, i.e. the first dimension with
+    /// more than one element, has more than one tile; the group is then
+    /// tiled like one dimension.
+    /// \param trange The tiled range
+    /// \param first The first dimension of the group
+    /// \param last One past the last dimension of the group
+    /// \param[out] bounds The tile boundaries of the group, starting at zero
+    /// \return \c true if the tiles of the group hold contiguous elements
+    inline bool reshape_group_bounds(const TiledRange& trange,
+        const unsigned int first, const unsigned int last,
+        std::vector<std::size_t>& bounds)
+    {
+      bounds.clear();
+      if(first == last) {
+        bounds.push_back(0ul);
+        bounds.push_back(1ul);
+        return true;
+      }
+
+      unsigned int lead = first;
+      while((lead + 1u < last) && (trange.data()[lead].extent() == 1ul))
+        ++lead;
+
+      std::size_t inner = 1ul;
+      for(unsigned int d = lead + 1u; d < last; ++d) {
+        if(trange.data()[d].tile_extent() != 1ul)
+          return false;
+        inner *= trange.data()[d].extent();
+      }
+
+      const TiledRange1& range = trange.data()[lead];
+      const std::size_t lower = range.elements_range().first;
+      for(const auto& tile : range)
+        bounds.push_back((tile.first - lower) * inner);
+      bounds.push_back((range.elements_range().second - lower) * inner);
+      return true;
+    }
+
+    /// Check that two tilings hold the same elements in the same tiles
+
+    /// The dimensions of \c source and \c target are matched in groups with
+    /// the same number of elements, e.g. dimensions <tt>(i,j)</tt> of one
+    /// tiling with dimension <tt>ij</tt> of the other. The tilings are
+    /// aligned if the tiles of each group hold contiguous elements, with the
+    /// same tile boundaries in both tilings (see \c reshape_group_bounds() ).
+    /// Tile \c t of an aligned tiling then holds the same elements, in
+    /// row-major order, as tile \c t of the other.
+    /// \param source The source tiling
+    /// \param target The target tiling
+    /// \return \c true if \c source and \c target are aligned
+    inline bool is_reshape_aligned(const TiledRange& source,
+        const TiledRange& target)
+    {
+      const unsigned int source_rank = source.rank();
+      const unsigned int target_rank = target.rank();
+      const std::size_t volume = source.elements_range().volume();
+      if((volume == 0ul) || (volume != target.elements_range().volume()))
+        return false;
+
+      auto extent = [] (const TiledRange& trange, const unsigned int d) {
+        return trange.data()[d].extent();
+      };
+
+      std::vector<std::size_t> source_bounds, target_bounds;
+      unsigned int s = 0u, t = 0u;
+      while((s < source_rank) || (t < target_rank)) {
+        // Add dimensions to the smaller group until the groups hold the same
+        // number of elements
+        unsigned int s_last = s, t_last = t;
+        std::size_t s_volume = 1ul, t_volume = 1ul;
+        if(s_last < source_rank)
+          s_volume *= extent(source, s_last++);
+        if(t_last < target_rank)
+          t_volume *= extent(target, t_last++);
+        while(s_volume != t_volume) {
+          if(s_volume < t_volume) {
+            if(s_last == source_rank)
+              return false;
+            s_volume *= extent(source, s_last++);
+          } else {
+            if(t_last == target_rank)
+              return false;
+            t_volume *= extent(target, t_last++);
+          }
+        }
+
+        // Dimensions with one element are appended to the group
+        while((s_last < source_rank) && (extent(source, s_last) == 1ul))
+          ++s_last;
+        while((t_last < target_rank) && (extent(target, t_last) == 1ul))
+          ++t_last;
+
+        if(! reshape_group_bounds(source, s, s_last, source_bounds) ||
+            ! reshape_group_bounds(target, t, t_last, target_bounds) ||
+            (source_bounds != target_bounds))
+          return false;
+
+        s = s_last;
+        t = t_last;
+      }
+
+      return true;
+    }
+
+    /// Shape of a reshaped dense array
+
+    /// \return A dense shape
+    template <typename T, typename A>
+    inline DenseShape reshape_shape(const DistArray<Tensor<T, A>, DensePolicy>&,
+        const TiledRange&)
+    { return DenseShape(); }
+
+    /// Shape of a reshaped sparse array
+
+    /// Tile \c t of the result holds the elements of tile \c t of \c array ,
+    /// so it has the same norm.
+    /// \param array The source array
+    /// \param trange The aligned tiling of the result
+    /// \return The shape of the reshaped array
+    template <typename T, typename A>
+    inline SparseShape<float>
+    reshape_shape(const DistArray<Tensor<T, A>, SparsePolicy>& array,
+        const TiledRange& trange)
+    {
+      const SparseShape<float>& shape = array.shape();
+      const Tensor<float>& source_norms = shape.data();
+      Tensor<float> norms(trange.tiles_range(), 0.0f);
+      for(std::size_t t = 0ul; t < norms.size(); ++t) {
+        // The stored norms are per element
+        if(! shape.is_zero(t))
+          norms[t] = source_norms[t] * float(trange.make_tile_range(t).volume());
+      }
+      return SparseShape<float>(norms, trange, shape.zero_threshold());
+    }
+
+  } // namespace detail
+
+  /// Fuse adjacent dimensions of a tiling
+
+  /// Dimensions <tt>[first,last)</tt> of \c trange are replaced by one
+  /// dimension, whose elements are those of the fused dimensions in
+  /// row-major order, starting at zero. Only the leading fused dimension,
+  /// i.e. the first with more than one element, may have more than one
+  /// tile, so that each fused tile holds contiguous elements.
+  /// \param trange The tiling
+  /// \param first The first fused dimension
+  /// \param last One past the last fused dimension
+  /// \return The tiling with fused dimensions, which is aligned with
+  /// \c trange (see \c reshape() )
+  /// \throw TiledArray::Exception When the fused tiles are not contiguous
+  inline TiledRange fuse_tiled_range(const TiledRange& trange,
+      const unsigned int first, const unsigned int last)
+  {
+    TA_USER_ASSERT((first < last) && (last <= trange.rank()),
+        "The fused dimensions are out of range.");
+    std::vector<std::size_t> bounds;
+    TA_USER_ASSERT(detail::reshape_group_bounds(trange, first, last, bounds),
+        "Only the leading fused dimension may have more than one tile.");
+
+    std::vector<TiledRange1> ranges(trange.data().begin(),
+        trange.data().begin() + first);
+    ranges.emplace_back(bounds.begin(), bounds.end());
+    ranges.insert(ranges.end(), trange.data().begin() + last,
+        trange.data().end());
+    return TiledRange(ranges.begin(), ranges.end());
+  }
+
+  /// Split a dimension of a tiling
+
+  /// Dimension \c dim of \c trange is replaced by dimensions with the given
+  /// extents, whose elements, in row-major order, are those of \c dim , and
+  /// which start at zero. The tiles of \c dim are split along the leading
+  /// new dimension, i.e. the first with more than one element, so the
+  /// boundaries of the tiles, relative to the first element of \c dim , must
+  /// be multiples of the product of the extents that follow it.
+  /// \param trange The tiling
+  /// \param dim The split dimension
+  /// \param extents The extents of the new dimensions, whose product is the
+  /// extent of \c dim
+  /// \return The tiling with the split dimension, which is aligned with
+  /// \c trange (see \c reshape() )
+  /// \throw TiledArray::Exception When the tile boundaries of \c dim are
+  /// not aligned with the new dimensions
+  inline TiledRange split_tiled_range(const TiledRange& trange,
+      const unsigned int dim, const std::vector<std::size_t>& extents)
+  {
+    TA_USER_ASSERT(dim < trange.rank(), "The split dimension is out of range.");
+    TA_USER_ASSERT(! extents.empty(), "The split dimension has no extents.");
+    const TiledRange1& range = trange.data()[dim];
+
+    std::size_t volume = 1ul;
+    for(const std::size_t extent : extents)
+      volume *= extent;
+    TA_USER_ASSERT(volume == range.extent(),
+        "The split extents do not match the extent of the dimension.");
+
+    std::size_t lead = 0ul;
+    while((lead + 1ul < extents.size()) && (extents[lead] == 1ul))
+      ++lead;
+    std::size_t inner = 1ul;
+    for(std::size_t d = lead + 1ul; d < extents.size(); ++d)
+      inner *= extents[d];
+
+    const std::size_t lower = range.elements_range().first;
+    std::vector<std::size_t> bounds;
+    for(const auto& tile : range) {
+      TA_USER_ASSERT((tile.first - lower) % inner == 0ul,
+          "The tile boundaries are not aligned with the split dimensions.");
+      bounds.push_back((tile.first - lower) / inner);
+    }
+    bounds.push_back(extents[lead]);
+
+    std::vector<TiledRange1> ranges(trange.data().begin(),
+        trange.data().begin() + dim);
+    for(std::size_t d = 0ul; d < extents.size(); ++d) {
+      if(d == lead)
+        ranges.emplace_back(bounds.begin(), bounds.end());
+      else
+        ranges.emplace_back(0ul, extents[d]);
+    }
+    ranges.insert(ranges.end(), trange.data().begin() + dim + 1ul,
+        trange.data().end());
+    return TiledRange(ranges.begin(), ranges.end());
+  }
+
+  /// Reshape an array without moving its data
+
+  /// The result holds the elements of \c array , in row-major order, with
+  /// tiling \c trange , e.g. a tensor <tt>A(i,j,Q)</tt> as a matrix
+  /// <tt>A(ij,Q)</tt> (see \c fuse_tiled_range() and
+  /// \c split_tiled_range() ). The tilings must be aligned, i.e. each
+  /// tile of the result holds the elements of the tile of \c array with the
+  /// same ordinal, so tiles keep their owners, and their data is not copied
+  /// or communicated: each tile of the result shares the data of the
+  /// \c array tile and only has a different range (see
+  /// \c Tensor::reshape() ). Tiles of the result should therefore not be
+  /// modified in place while \c array is used. Tilings that are not aligned
+  /// may be aligned with \c retile() first. This function is collective,
+  /// but it does not fence.
+  /// \tparam T The element type
+  /// \tparam A The tile allocator type
+  /// \tparam Policy The array policy type
+  /// \param array The source array
+  /// \param trange The tiling of the result, which is aligned with the
+  /// tiling of \c array
+  /// \return \c array with tiling \c trange
+  /// \throw TiledArray::Exception When the tilings are not aligned
+  template <typename T, typename A, typename Policy>
+  inline DistArray<Tensor<T, A>, Policy>
+  reshape(const DistArray<Tensor<T, A>, Policy>& array, const TiledRange& trange)
+  {
+    typedef Tensor<T, A> tile_type;
+    typedef DistArray<tile_type, Policy> array_type;
+
+    TA_USER_ASSERT(detail::is_reshape_aligned(array.trange(), trange),
+        "The tiling is not aligned with the tiling of the array.");
+
+    World& world = array.world();
+    array_type result(world, trange, detail::reshape_shape(array, trange),
+        array.pmap());
+
+    for(const std::size_t tile : *array.pmap()) {
+      if(result.is_zero(tile))
+        continue;
+      const Range range = trange.make_tile_range(tile);
+      const Future<tile_type> source = array.find(tile);
+      if(source.probe())
+        result.set(tile, source.get().reshape(range));
+      else
+        result.set(tile, world.taskq.add([range] (const tile_type& source) {
+            return source.reshape(range);
+          }, source));
+    }
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_RESHAPE_H__INCLUDED
@@ -0,0 +1,339 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  retile.h
+ *  Mar 6, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_RETILE_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_RETILE_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/tiled_range.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace TiledArray {
+
+  namespace detail {
+
+    /// The overlap of two tilings of the same elements
+
+    /// The pieces of the overlap are the intersections of the tiles of the
+    /// source and target tilings, so each piece lies in exactly one source
+    /// tile and one target tile.
+    class RetileMap {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+      TiledRange pieces_; ///< The tiling of the pieces
+      std::vector<std::vector<size_type> > source_; ///< The source tile of the pieces of each dimension
+      std::vector<std::vector<size_type> > target_; ///< The target tile of the pieces of each dimension
+      Range source_tiles_; ///< The tiles range of the source
+      Range target_tiles_; ///< The tiles range of the target
+
+      static TiledRange make_pieces(const TiledRange& source,
+          const TiledRange& target)
+      {
+        std::vector<TiledRange1> ranges;
+        ranges.reserve(source.rank());
+        for(unsigned int d = 0u; d < source.rank(); ++d) {
+          std::vector<size_type> bounds;
+          for(const auto& tile : source.data()[d])
+            bounds.push_back(tile.first);
+          for(const auto& tile : target.data()[d])
+            bounds.push_back(tile.first);
+          bounds.push_back(source.data()[d].elements_range().second);
+          std::sort(bounds.begin(), bounds.end());
+          bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+          ranges.emplace_back(bounds.begin(), bounds.end());
+        }
+        return TiledRange(ranges.begin(), ranges.end());
+      }
+
+      size_type map(const std::vector<std::vector<size_type> >& tiles,
+          const Range& range, const size_type piece) const
+      {
+        const Range& pieces_range = pieces_.tiles_range();
+        const auto index = pieces_range.idx(piece);
+        std::vector<size_type> result(tiles.size());
+        for(size_type d = 0ul; d < tiles.size(); ++d)
+          result[d] = tiles[d][index[d] - pieces_range.lobound(d)];
+        return range.ordinal(result);
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param source The source tiling
+      /// \param target The target tiling, which has the same elements range
+      /// as \c source
+      RetileMap(const TiledRange& source, const TiledRange& target) :
+        pieces_(make_pieces(source, target)), source_(source.rank()),
+        target_(source.rank()), source_tiles_(source.tiles_range()),
+        target_tiles_(target.tiles_range())
+      {
+        for(unsigned int d = 0u; d < source.rank(); ++d) {
+          for(const auto& piece : pieces_.data()[d]) {
+            source_[d].push_back(source.data()[d].element_to_tile(piece.first));
+            target_[d].push_back(target.data()[d].element_to_tile(piece.first));
+          }
+        }
+      }
+
+      /// \return The tiling of the pieces
+      const TiledRange& pieces() const { return pieces_; }
+
+      /// \param piece The ordinal of a piece
+      /// \return The ordinal of the source tile that holds \c piece
+      size_type source(const size_type piece) const {
+        return map(source_, source_tiles_, piece);
+      }
+
+      /// \param piece The ordinal of a piece
+      /// \return The ordinal of the target tile that holds \c piece
+      size_type target(const size_type piece) const {
+        return map(target_, target_tiles_, piece);
+      }
+
+      /// Visit the pieces of a tile
+
+      /// \tparam Op The visitor type
+      /// \param of_source \c true if \c tile is a source tile, or \c false
+      /// if it is a target tile
+      /// \param tile The ordinal of the tile
+      /// \param op The visitor, which is called with the ordinal of each
+      /// piece of \c tile
+      template <typename Op>
+      void for_each_piece(const bool of_source, const size_type tile, Op&& op) const {
+        const std::vector<std::vector<size_type> >& tiles =
+            (of_source ? source_ : target_);
+        const Range& tiles_range = (of_source ? source_tiles_ : target_tiles_);
+        const auto index = tiles_range.idx(tile);
+        const unsigned int rank = tiles.size();
+
+        // The range of pieces in each dimension
+        std::vector<size_type> lower(rank), upper(rank);
+        for(unsigned int d = 0u; d < rank; ++d) {
+          const std::vector<size_type>& dim = tiles[d];
+          const size_type t = index[d];
+          lower[d] = std::lower_bound(dim.begin(), dim.end(), t) - dim.begin()
+              + pieces_.tiles_range().lobound(d);
+          upper[d] = std::upper_bound(dim.begin(), dim.end(), t) - dim.begin()
+              + pieces_.tiles_range().lobound(d);
+        }
+
+        for(auto piece : Range(lower, upper))
+          op(pieces_.tiles_range().ordinal(piece));
+      }
+
+    }; // class RetileMap
+
+    /// Process map of the pieces of a retiled array
+
+    /// Each piece is owned by the owner of the target tile that holds it, so
+    /// the source tile owners send the pieces directly to the processes
+    /// that assemble the target tiles.
+    class RetilePmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+      std::shared_ptr<const RetileMap> map_; ///< The overlap of the tilings
+      std::shared_ptr<Pmap> target_; ///< The process map of the target
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// Constructor
+
+      /// \param world A reference to the world
+      /// \param map The overlap of the tilings
+      /// \param target The process map of the target
+      RetilePmap(World& world, const std::shared_ptr<const RetileMap>& map,
+          const std::shared_ptr<Pmap>& target) :
+        Pmap(world, map->pieces().tiles_range().volume()), map_(map),
+        target_(target)
+      {
+        for(const size_type tile : *target_)
+          map_->for_each_piece(false, tile,
+              [this] (const size_type piece) { local_.push_back(piece); });
+      }
+
+      virtual ~RetilePmap() { }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return target_->owner(map_->target(tile));
+      }
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return owner(tile) == rank_;
+      }
+
+    }; // class RetilePmap
+
+    /// Shape of a retiled dense array
+
+    /// \return A dense shape
+    template <typename T, typename A>
+    inline DenseShape retile_shape(const DistArray<Tensor<T, A>, DensePolicy>&,
+        const RetileMap&, const TiledRange&)
+    { return DenseShape(); }
+
+    /// Shape of a retiled sparse array
+
+    /// The norm of each piece is estimated from the norm of its source tile,
+    /// assuming that the norm is spread evenly over the elements of the
+    /// source tile, so target tiles that only overlap zero source tiles are
+    /// zero.
+    /// \param array The source array
+    /// \param map The overlap of the tilings
+    /// \param trange The target tiling
+    /// \return The shape of the retiled array
+    template <typename T, typename A>
+    inline SparseShape<float>
+    retile_shape(const DistArray<Tensor<T, A>, SparsePolicy>& array,
+        const RetileMap& map, const TiledRange& trange)
+    {
+      const TiledRange& pieces = map.pieces();
+      const Tensor<float>& source_norms = array.shape().data();
+      Tensor<float> norms(trange.tiles_range(), 0.0f);
+      for(std::size_t piece = 0ul; piece < pieces.tiles_range().volume(); ++piece) {
+        // The stored norms are the Frobenius norms divided by the volume of
+        // the source tile, so the squared norm of a piece is
+        // (norm * source_volume)^2 * piece_volume / source_volume
+        const std::size_t source = map.source(piece);
+        const float norm = source_norms[source];
+        const float source_volume =
+            array.trange().make_tile_range(source).volume();
+        const float volume = pieces.make_tile_range(piece).volume();
+        norms[map.target(piece)] += norm * norm * source_volume * volume;
+      }
+      for(float& norm : norms)
+        norm = std::sqrt(norm);
+      return SparseShape<float>(norms, trange);
+    }
+
+  } // namespace detail
+
+  /// Change the tiling of an array
+
+  /// The source and target tilings are intersected into pieces, which lie
+  /// in exactly one source tile and one target tile. The owners of the
+  /// source tiles cut their tiles into pieces and send each piece directly
+  /// to the owner of its target tile, which assembles the target tile in a
+  /// task once all of its pieces have arrived. Only the sub-blocks that are
+  /// needed are moved, and pieces of zero source tiles are not sent. For
+  /// sparse arrays, target tiles that overlap only zero source tiles are
+  /// zero. This function is collective, but it does not fence.
+  /// \tparam T The element type
+  /// \tparam A The tile allocator type
+  /// \tparam Policy The array policy type
+  /// \param array The source array
+  /// \param trange The target tiling, which has the same elements range as
+  /// the tiling of \c array
+  /// \param pmap The process map of the result [ default = the default
+  /// process map ]
+  /// \return A copy of \c array with tiling \c trange
+  template <typename T, typename A, typename Policy>
+  inline DistArray<Tensor<T, A>, Policy>
+  retile(const DistArray<Tensor<T, A>, Policy>& array, const TiledRange& trange,
+      std::shared_ptr<typename Policy::pmap_interface> pmap = nullptr)
+  {
+    typedef Tensor<T, A> tile_type;
+    typedef DistArray<tile_type, Policy> array_type;
+    typedef DistArray<tile_type, DensePolicy> pieces_type;
+
+    TA_USER_ASSERT(array.trange().elements_range() == trange.elements_range(),
+        "The target tiling must have the same elements range as the array.");
+
+    World& world = array.world();
+    if(! pmap)
+      pmap = Policy::default_pmap(world, trange.tiles_range().volume());
+
+    std::shared_ptr<const detail::RetileMap> map =
+        std::make_shared<detail::RetileMap>(array.trange(), trange);
+    const TiledRange& pieces_trange = map->pieces();
+
+    array_type result(world, trange,
+        detail::retile_shape(array, *map, trange), pmap);
+    pieces_type pieces(world, pieces_trange,
+        std::make_shared<detail::RetilePmap>(world, map, pmap));
+
+    // Cut the local source tiles into pieces and send them to the owners of
+    // their target tiles
+    for(const std::size_t tile : *array.pmap()) {
+      if(array.is_zero(tile))
+        continue;
+      world.taskq.add([=] (const tile_type& source) mutable {
+        map->for_each_piece(true, tile, [&] (const std::size_t piece) {
+          if(result.is_zero(map->target(piece)))
+            return;
+          const Range range = pieces_trange.make_tile_range(piece);
+          pieces.set(piece, tile_type(source.block(range.lobound(),
+              range.upbound())));
+        });
+      }, array.find(tile));
+    }
+
+    // Assemble the local target tiles from their pieces
+    for(const std::size_t tile : *result.pmap()) {
+      if(result.is_zero(tile))
+        continue;
+      std::vector<Future<tile_type> > tile_pieces;
+      map->for_each_piece(false, tile, [&] (const std::size_t piece) {
+        if(! array.is_zero(map->source(piece)))
+          tile_pieces.push_back(pieces.find(piece));
+      });
+      const Range range = trange.make_tile_range(tile);
+      result.set(tile, world.taskq.add([range]
+          (const std::vector<tile_type>& tile_pieces) {
+            tile_type target(range, T(0));
+            for(const tile_type& piece : tile_pieces)
+              target.block(piece.range().lobound(), piece.range().upbound()) =
+                  piece;
+            return target;
+          }, tile_pieces));
+    }
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_RETILE_H__INCLUDED
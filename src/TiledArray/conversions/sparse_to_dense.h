@@ -27,6 +27,7 @@
 #define TILEDARRAY_CONVERSIONS_SPARSE_TO_DENSE_H__INCLUDED
 
 #include "../dist_array.h"
+#include "../tile_interface/clone.h"
 
 namespace TiledArray {
 
@@ -46,8 +47,9 @@ namespace TiledArray {
            ++it) {
           const std::size_t ord = *it;
           if (!sparse_array.is_zero(ord)) {
-              // clone because tiles are shallow copied
-              Tile tile(sparse_array.find(ord).get().clone());
+              // clone because tiles are shallow copied, unless they are
+              // copy-on-write
+              Tile tile(share_or_clone(sparse_array.find(ord).get()));
               dense_array.set(ord, tile);
           } else {
               // see DistArray::set(ordinal, element_type)
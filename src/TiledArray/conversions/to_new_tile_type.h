@@ -27,6 +27,7 @@
 #define TILEDARRAY_CONVERSIONS_TO_NEW_TILE_TYPE_H__INCLUDED
 
 #include "../dist_array.h"
+#include "../tile_interface/cast.h"
 
 namespace TiledArray {
 
@@ -67,5 +68,22 @@ namespace TiledArray {
     return new_array;
   }
 
+  /// Function to convert an array to a new array with a different tile type.
+
+  /// The tiles are converted with \c TiledArray::Cast , e.g. a double
+  /// precision array may be converted to a single precision array with
+  /// \code
+  /// TArrayF b = to_new_tile_type<TensorF>(a);
+  /// \endcode
+  /// \tparam OutTile The tile type of the new array
+  /// \tparam Tile The array tile type
+  /// \tparam Policy The array policy type
+  /// \param old_array The array to be converted
+  template <typename OutTile, typename Tile, typename Policy>
+  inline DistArray<OutTile, Policy>
+  to_new_tile_type(DistArray<Tile, Policy> const &old_array) {
+    return to_new_tile_type(old_array, TiledArray::Cast<OutTile, Tile>());
+  }
+
 } // namespace TiledArray
 #endif // TILEDARRAY_CONVERSIONS_TO_NEW_TILE_TYPE_H__INCLUDED
@@ -45,17 +45,64 @@ namespace TiledArray {
 
   /// Truncate a sparse Array
 
+  /// The norms of the local non-zero tiles are reduced into a new shape with
+  /// one collective operation. Cached tile norms are used where available,
+  /// see \c DistArray::tile_norm() ; the other norms are computed in tasks
+  /// and cached. The shape of \c array
+  /// is then replaced in place: local tiles that fall below the zero
+  /// threshold are released, and the remaining tiles are not copied, so the
+  /// id of \c array does not change. The caches that identify arrays by
+  /// their id are cleared (see \c DistArray::update_shape() ). Arrays whose
+  /// shape holds upper bounds
+  /// of the norms (see \c SparseShape::is_bound() ) are valid without
+  /// truncation, so truncating them is optional; it replaces the bounds
+  /// with the norms of the tiles, which may screen more tiles.
   /// \tparam Tile The tile type of the array
   /// \param[in,out] array The array object to be truncated
   template <typename Tile>
   inline void truncate(DistArray<Tile, SparsePolicy>& array) {
-    typedef typename DistArray<Tile, SparsePolicy>::value_type value_type;
-    array =
-        foreach(array, [] (value_type& result_tile, const value_type& arg_tile) {
-          typename detail::scalar_type<value_type>::type norm = arg_tile.norm();
-          result_tile = arg_tile; // Assume this is shallow copy
-          return norm;
-        });
+    typedef DistArray<Tile, SparsePolicy> array_type;
+    typedef typename array_type::value_type value_type;
+    typedef typename array_type::size_type size_type;
+    typedef typename array_type::shape_type shape_type;
+    typedef typename shape_type::value_type norm_type;
+
+    // Construct a tensor to hold the tile norms of the new shape.
+    TiledArray::Tensor<norm_type,
+        typename detail::default_tensor_allocator<norm_type>::type>
+    tile_norms(array.trange().tiles_range(), 0);
+
+    // Compute the norms of the local, non-zero tiles
+    madness::AtomicInt counter; counter = 0;
+    int task_count = 0;
+    auto task = [&counter,&tile_norms,&array] (const size_type index,
+        const value_type& tile) -> bool
+    {
+      tile_norms[index] = tile.norm();
+      array.tile_norm(index, tile_norms[index]);
+      ++counter;
+      return true;
+    };
+
+    World& world = array.world();
+    for(const size_type index : *(array.pmap())) {
+      if(array.is_zero(index))
+        continue;
+      const float norm = array.tile_norm(index);
+      if(norm >= 0.0f) {
+        tile_norms[index] = norm;
+        continue;
+      }
+      world.taskq.add(task, index, array.find(index));
+      ++task_count;
+    }
+
+    // Wait for tile norm data to be collected.
+    if(task_count > 0)
+      world.await([&counter,task_count] () -> bool { return counter == task_count; });
+
+    array.update_shape(shape_type(world, tile_norms, array.trange(),
+        array.shape().zero_threshold()));
   }
 
 } // namespace TiledArray
@@ -0,0 +1,285 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  cuda_gemm.h
+ *  Mar 8, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CUDA_GEMM_H__INCLUDED
+#define TILEDARRAY_CUDA_GEMM_H__INCLUDED
+
+#include <TiledArray/cuda_tensor.h>
+
+#ifdef TILEDARRAY_HAS_CUDA
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The device memory budget of streamed contractions
+
+    /// Contractions of host tensors are streamed through the device when
+    /// the \c TA_CUDA_GEMM_MAX_MEMORY environment variable is set to a
+    /// positive size. The size is given in bytes or with a unit, as for
+    /// \c TA_SUMMA_MAX_MEMORY , e.g. "2 GiB".
+    /// \return The largest number of bytes of device memory that is used by
+    /// the streamed contractions of a thread, or zero when contractions are
+    /// evaluated on the host
+    inline std::size_t cuda_gemm_max_memory() {
+      static const std::size_t max_memory = [] () -> std::size_t {
+        const char* max_memory = getenv("TA_CUDA_GEMM_MAX_MEMORY");
+        if(! max_memory)
+          return 0ul;
+        std::stringstream ss(max_memory);
+        double memory = 0.0;
+        std::string unit;
+        if(! (ss >> memory) || memory <= 0.0)
+          return 0ul;
+        if(ss >> unit) {
+          if(unit == "KB" || unit == "kB")
+            memory *= 1000.0;
+          else if(unit == "KiB" || unit == "kiB")
+            memory *= 1024.0;
+          else if(unit == "MB")
+            memory *= 1000000.0;
+          else if(unit == "MiB")
+            memory *= 1048576.0;
+          else if(unit == "GB")
+            memory *= 1000000000.0;
+          else if(unit == "GiB")
+            memory *= 1073741824.0;
+        }
+        return memory;
+      }();
+      return max_memory;
+    }
+
+    /// The number of streams of a streamed contraction
+
+    /// The number is read from the \c TA_CUDA_GEMM_STREAMS environment
+    /// variable; the default is 2. The copies of the arguments of a pair are
+    /// overlapped with the contractions of the previous pairs on the other
+    /// streams.
+    /// \return The number of streams that are used by each thread
+    inline std::size_t cuda_gemm_streams() {
+      static const std::size_t streams = [] () -> std::size_t {
+        const char* streams = getenv("TA_CUDA_GEMM_STREAMS");
+        if(streams)
+          return std::max(std::strtoul(streams, nullptr, 10), 1ul);
+        return 2ul;
+      }();
+      return streams;
+    }
+
+    /// \return \c true if contractions of host tensors are streamed through
+    /// the device
+    inline bool cuda_gemm_enabled() { return cuda_gemm_max_memory() > 0ul; }
+
+    /// The streams and the device workspace of the streamed contractions of
+    /// a thread
+
+    /// The workspace grows to the largest size that was requested and is
+    /// kept for the next contractions of the thread.
+    class CudaGemmStreams {
+      std::vector<cudaStream_t> streams_; ///< The streams
+      void* workspace_ = nullptr; ///< The device workspace
+      std::size_t bytes_ = 0ul; ///< The size of the workspace
+
+    public:
+      CudaGemmStreams() : streams_(cuda_gemm_streams()) {
+        for(cudaStream_t& stream : streams_)
+          if(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) != cudaSuccess)
+            TA_EXCEPTION("CudaGemmStreams: unable to create a CUDA stream.");
+      }
+
+      CudaGemmStreams(const CudaGemmStreams&) = delete;
+      CudaGemmStreams& operator=(const CudaGemmStreams&) = delete;
+
+      ~CudaGemmStreams() {
+        cudaFree(workspace_);
+        for(cudaStream_t stream : streams_)
+          cudaStreamDestroy(stream);
+      }
+
+      /// \return The streams
+      const std::vector<cudaStream_t>& streams() const { return streams_; }
+
+      /// \param bytes The size of the workspace
+      /// \return A device workspace of at least \c bytes bytes
+      void* workspace(const std::size_t bytes) {
+        if(bytes > bytes_) {
+          cudaFree(workspace_);
+          workspace_ = nullptr;
+          bytes_ = 0ul;
+          if(cudaMalloc(&workspace_, bytes) != cudaSuccess)
+            TA_EXCEPTION("CudaGemmStreams: unable to allocate device memory.");
+          bytes_ = bytes;
+        }
+        return workspace_;
+      }
+
+      /// Wait for all streams
+      void synchronize() const {
+        for(cudaStream_t stream : streams_)
+          if(cudaStreamSynchronize(stream) != cudaSuccess)
+            TA_EXCEPTION("CudaGemmStreams: a CUDA operation failed.");
+      }
+
+      /// \return The streams and workspace of the calling thread
+      static CudaGemmStreams& get() {
+        static thread_local CudaGemmStreams streams;
+        return streams;
+      }
+    }; // class CudaGemmStreams
+
+    /// Stream a batch of tile contractions through the device
+
+    /// This is the fallback for tile types that are not streamed.
+    /// \return \c false
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    inline bool cuda_batch_gemm(Result&, const std::vector<const Left*>&,
+        const std::vector<const Right*>&, const Scalar, const math::GemmHelper&)
+    { return false; }
+
+    /// Stream a batch of tensor contractions through the device
+
+    /// The pairs are distributed over the streams of the thread, and each
+    /// stream holds the arguments of one pair and a partial sum of the
+    /// products of its pairs. The copies of the arguments of a pair to the
+    /// device are queued behind the contraction of the previous pair of its
+    /// stream, so they overlap with the contractions of the other streams.
+    /// The number of streams is reduced until the buffers fit in
+    /// \c cuda_gemm_max_memory() . The partial sums are added on the device,
+    /// and the sum is copied to \c result once all pairs are contracted.
+    /// \tparam T The element type, \c float or \c double
+    /// \tparam A The result allocator type
+    /// \tparam AL The left-hand allocator type
+    /// \tparam AR The right-hand allocator type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tensor
+    /// \param[in] left The left-hand tensors to be contracted
+    /// \param[in] right The right-hand tensors to be contracted
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    /// \return \c true if the contractions were evaluated on the device, or
+    /// \c false if streaming is disabled or the buffers of a single pair do
+    /// not fit in the device memory budget
+    template <typename T, typename A, typename AL, typename AR, typename Scalar,
+        typename std::enable_if<std::is_same<T, float>::value ||
+            std::is_same<T, double>::value>::type* = nullptr>
+    inline bool cuda_batch_gemm(Tensor<T, A>& result,
+        const std::vector<const Tensor<T, AL>*>& left,
+        const std::vector<const Tensor<T, AR>*>& right, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      TA_ASSERT(left.size() == right.size());
+      if(! cuda_gemm_enabled() || left.empty())
+        return false;
+
+      // The result size and the largest argument sizes of the batch
+      integer m = 1, n = 1, k = 1, max_k = 1;
+      for(std::size_t p = 0ul; p < left.size(); ++p) {
+        gemm_helper.compute_matrix_sizes(m, n, k, left[p]->range(),
+            right[p]->range());
+        max_k = std::max(max_k, k);
+      }
+      const std::size_t result_size = std::size_t(m) * std::size_t(n);
+      const std::size_t pair_size = std::size_t(max_k) * std::size_t(m + n) +
+          result_size;
+
+      // The number of streams that fit in the device memory budget
+      CudaGemmStreams& streams = CudaGemmStreams::get();
+      const std::size_t max_slots = cuda_gemm_max_memory() / (pair_size * sizeof(T));
+      const std::size_t slots = std::min({ streams.streams().size(),
+          left.size(), max_slots });
+      if(slots == 0ul)
+        return false;
+
+      // Partition the workspace into the buffers of each stream
+      T* const workspace = static_cast<T*>(streams.workspace(slots * pair_size * sizeof(T)));
+      auto left_buffer = [&] (const std::size_t s) { return workspace + s * pair_size; };
+      auto right_buffer = [&] (const std::size_t s) {
+        return left_buffer(s) + std::size_t(max_k) * std::size_t(m);
+      };
+      auto result_buffer = [&] (const std::size_t s) {
+        return right_buffer(s) + std::size_t(max_k) * std::size_t(n);
+      };
+
+      const CudaContext& context = CudaContext::get();
+      const T alpha(factor), one(1), zero(0);
+
+      // Start the partial sum of the first stream with the result
+      const bool accumulate = ! result.empty();
+      if(accumulate &&
+          cudaMemcpyAsync(result_buffer(0ul), result.data(), result_size * sizeof(T),
+              cudaMemcpyHostToDevice, streams.streams()[0]) != cudaSuccess)
+        TA_EXCEPTION("cuda_batch_gemm: unable to copy a tensor to the device.");
+
+      for(std::size_t p = 0ul; p < left.size(); ++p) {
+        const std::size_t s = p % slots;
+        cudaStream_t stream = streams.streams()[s];
+        gemm_helper.compute_matrix_sizes(m, n, k, left[p]->range(),
+            right[p]->range());
+        if(cudaMemcpyAsync(left_buffer(s), left[p]->data(),
+                left[p]->size() * sizeof(T), cudaMemcpyHostToDevice, stream) != cudaSuccess ||
+            cudaMemcpyAsync(right_buffer(s), right[p]->data(),
+                right[p]->size() * sizeof(T), cudaMemcpyHostToDevice, stream) != cudaSuccess)
+          TA_EXCEPTION("cuda_batch_gemm: unable to copy a tensor to the device.");
+
+        // The tensors are row-major, so C^T = B^T A^T is evaluated
+        const integer lda = (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
+        const integer ldb = (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
+        const T beta = ((p >= slots) || (accumulate && s == 0ul) ? one : zero);
+        cublas_check(cublasSetStream(context.handle(), stream));
+        cublas_check(cublas_gemm(context.handle(), cublas_op(gemm_helper.right_op()),
+            cublas_op(gemm_helper.left_op()), int(n), int(m), int(k), &alpha,
+            right_buffer(s), int(ldb), left_buffer(s), int(lda), &beta,
+            result_buffer(s), int(n)));
+      }
+
+      // Sum the partial sums into the first stream buffer
+      streams.synchronize();
+      cublas_check(cublasSetStream(context.handle(), streams.streams()[0]));
+      for(std::size_t s = 1ul; s < slots; ++s)
+        cublas_check(cublas_axpy(context.handle(), int(result_size), &one,
+            result_buffer(s), result_buffer(0ul)));
+
+      // Copy the sum back to the host
+      if(! accumulate)
+        result = Tensor<T, A>(gemm_helper.make_result_range<
+            typename Tensor<T, A>::range_type>(left.front()->range(),
+            right.front()->range()));
+      if(cudaMemcpyAsync(result.data(), result_buffer(0ul), result_size * sizeof(T),
+          cudaMemcpyDeviceToHost, streams.streams()[0]) != cudaSuccess)
+        TA_EXCEPTION("cuda_batch_gemm: unable to copy a tensor to the host.");
+      streams.synchronize();
+      cublas_check(cublasSetStream(context.handle(), context.stream()));
+      return true;
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_HAS_CUDA
+
+#endif // TILEDARRAY_CUDA_GEMM_H__INCLUDED
@@ -0,0 +1,606 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  cuda_tensor.h
+ *  Mar 7, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_CUDA_TENSOR_H__INCLUDED
+#define TILEDARRAY_CUDA_TENSOR_H__INCLUDED
+
+#include <TiledArray/config.h>
+
+#ifdef TILEDARRAY_HAS_CUDA
+
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/tensor.h>
+
+#include <cuda_runtime.h>
+#include <cublas_v2.h>
+
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The cuBLAS handle and the stream of a thread
+
+    /// Every thread enqueues its work on its own stream, so tasks that run on
+    /// different threads use the device concurrently. Operations wait for
+    /// their stream before they return, so the result of an operation may be
+    /// used by any task.
+    class CudaContext {
+      cublasHandle_t handle_; ///< The cuBLAS handle
+      cudaStream_t stream_; ///< The stream of \c handle_
+
+    public:
+      CudaContext() {
+        if(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking) != cudaSuccess)
+          TA_EXCEPTION("CudaContext: unable to create a CUDA stream.");
+        if(cublasCreate(&handle_) != CUBLAS_STATUS_SUCCESS) {
+          cudaStreamDestroy(stream_);
+          TA_EXCEPTION("CudaContext: unable to create a cuBLAS handle.");
+        }
+        cublasSetStream(handle_, stream_);
+      }
+
+      CudaContext(const CudaContext&) = delete;
+      CudaContext& operator=(const CudaContext&) = delete;
+
+      ~CudaContext() {
+        cublasDestroy(handle_);
+        cudaStreamDestroy(stream_);
+      }
+
+      /// \return The cuBLAS handle of this thread
+      cublasHandle_t handle() const { return handle_; }
+
+      /// \return The stream of this thread
+      cudaStream_t stream() const { return stream_; }
+
+      /// Wait for the work that was enqueued by this thread
+      void synchronize() const {
+        if(cudaStreamSynchronize(stream_) != cudaSuccess)
+          TA_EXCEPTION("CudaContext: a CUDA operation failed.");
+      }
+
+      /// \return The context of the calling thread
+      static const CudaContext& get() {
+        static thread_local CudaContext context;
+        return context;
+      }
+    }; // class CudaContext
+
+    /// Throw when a cuBLAS call failed
+
+    /// \param status The status of a cuBLAS call
+    inline void cublas_check(const cublasStatus_t status) {
+      if(status != CUBLAS_STATUS_SUCCESS)
+        TA_EXCEPTION("cuBLAS call failed.");
+    }
+
+    /// \return The cuBLAS operation of \c op
+    inline cublasOperation_t cublas_op(const madness::cblas::CBLAS_TRANSPOSE op) {
+      return (op == madness::cblas::NoTrans ? CUBLAS_OP_N :
+          (op == madness::cblas::Trans ? CUBLAS_OP_T : CUBLAS_OP_C));
+    }
+
+    // cuBLAS overloads for single and double precision
+
+    inline cublasStatus_t cublas_gemm(cublasHandle_t h, cublasOperation_t opa,
+        cublasOperation_t opb, int m, int n, int k, const float* alpha,
+        const float* a, int lda, const float* b, int ldb, const float* beta,
+        float* c, int ldc)
+    { return cublasSgemm(h, opa, opb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc); }
+    inline cublasStatus_t cublas_gemm(cublasHandle_t h, cublasOperation_t opa,
+        cublasOperation_t opb, int m, int n, int k, const double* alpha,
+        const double* a, int lda, const double* b, int ldb, const double* beta,
+        double* c, int ldc)
+    { return cublasDgemm(h, opa, opb, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc); }
+
+    inline cublasStatus_t cublas_geam(cublasHandle_t h, cublasOperation_t opa,
+        cublasOperation_t opb, int m, int n, const float* alpha, const float* a,
+        int lda, const float* beta, const float* b, int ldb, float* c, int ldc)
+    { return cublasSgeam(h, opa, opb, m, n, alpha, a, lda, beta, b, ldb, c, ldc); }
+    inline cublasStatus_t cublas_geam(cublasHandle_t h, cublasOperation_t opa,
+        cublasOperation_t opb, int m, int n, const double* alpha, const double* a,
+        int lda, const double* beta, const double* b, int ldb, double* c, int ldc)
+    { return cublasDgeam(h, opa, opb, m, n, alpha, a, lda, beta, b, ldb, c, ldc); }
+
+    inline cublasStatus_t cublas_axpy(cublasHandle_t h, int n, const float* alpha,
+        const float* x, float* y)
+    { return cublasSaxpy(h, n, alpha, x, 1, y, 1); }
+    inline cublasStatus_t cublas_axpy(cublasHandle_t h, int n, const double* alpha,
+        const double* x, double* y)
+    { return cublasDaxpy(h, n, alpha, x, 1, y, 1); }
+
+    inline cublasStatus_t cublas_scal(cublasHandle_t h, int n, const float* alpha, float* x)
+    { return cublasSscal(h, n, alpha, x, 1); }
+    inline cublasStatus_t cublas_scal(cublasHandle_t h, int n, const double* alpha, double* x)
+    { return cublasDscal(h, n, alpha, x, 1); }
+
+    inline cublasStatus_t cublas_dgmm(cublasHandle_t h, int n, const float* a,
+        const float* x, float* c)
+    { return cublasSdgmm(h, CUBLAS_SIDE_LEFT, n, 1, a, n, x, 1, c, n); }
+    inline cublasStatus_t cublas_dgmm(cublasHandle_t h, int n, const double* a,
+        const double* x, double* c)
+    { return cublasDdgmm(h, CUBLAS_SIDE_LEFT, n, 1, a, n, x, 1, c, n); }
+
+    inline cublasStatus_t cublas_dot(cublasHandle_t h, int n, const float* x,
+        const float* y, float* result)
+    { return cublasSdot(h, n, x, 1, y, 1, result); }
+    inline cublasStatus_t cublas_dot(cublasHandle_t h, int n, const double* x,
+        const double* y, double* result)
+    { return cublasDdot(h, n, x, 1, y, 1, result); }
+
+  }  // namespace detail
+
+  /// A tensor that is resident in device memory
+
+  /// The elements are stored in row-major order in device memory, so tiles
+  /// stay on the device between the operations of an expression and across
+  /// expressions; they are copied to the host only to be communicated or
+  /// when they are converted to a \c Tensor . Contractions are evaluated
+  /// with cuBLAS gemm and element-wise operations with cuBLAS level-1 and
+  /// extension routines. Permutations of rank-2 tiles are evaluated on the
+  /// device; other permutations are evaluated on the host. \c CudaTensor
+  /// implements the tile interface, so it may be used as the tile type of a
+  /// \c DistArray . Copies are shallow; see \c clone() for deep copies.
+  /// \tparam T The element type, \c float or \c double
+  template <typename T>
+  class CudaTensor {
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value,
+        "CudaTensor<T>: T must be float or double.");
+  public:
+    typedef CudaTensor<T> CudaTensor_; ///< This object type
+    typedef Range range_type; ///< Tensor range type
+    typedef T value_type; ///< Element type
+    typedef T numeric_type; ///< The scalar type that is compatible with value_type
+    typedef T scalar_type; ///< The scalar type of the norms
+    typedef std::size_t size_type; ///< Size type
+
+  private:
+
+    range_type range_; ///< The tensor range
+    std::shared_ptr<T> data_; ///< The device buffer
+
+    /// Allocate a device buffer
+
+    /// \param n The number of elements
+    /// \return A buffer that is freed when its last copy is destroyed
+    static std::shared_ptr<T> allocate(const size_type n) {
+      T* data = nullptr;
+      if(cudaMalloc(reinterpret_cast<void**>(&data), n * sizeof(T)) != cudaSuccess)
+        TA_EXCEPTION("CudaTensor: unable to allocate device memory.");
+      return std::shared_ptr<T>(data, [] (T* const p) { cudaFree(p); });
+    }
+
+    /// The number of elements as a cuBLAS integer
+    int isize() const { return int(range_.volume()); }
+
+    /// Permute the result of an operation
+
+    /// \param perm The permutation of the result
+    /// \return This tensor permuted by \c perm
+    CudaTensor_ permute_result(const Permutation& perm) const {
+      return (perm ? permute(perm) : *this);
+    }
+
+  public:
+
+    /// Construct an empty tensor
+    CudaTensor() = default;
+
+    /// Construct a tensor with uninitialized elements
+
+    /// \param range The range of the tensor
+    explicit CudaTensor(const range_type& range) :
+      range_(range), data_(allocate(range.volume()))
+    { }
+
+    /// Construct a tensor with all elements equal to \c value
+
+    /// \param range The range of the tensor
+    /// \param value The value of the elements
+    CudaTensor(const range_type& range, const numeric_type value) :
+      CudaTensor(Tensor<T>(range, value))
+    { }
+
+    /// Copy a host tensor to the device
+
+    /// \param tensor The host tensor
+    explicit CudaTensor(const Tensor<T>& tensor) : range_(), data_() {
+      if(tensor.empty())
+        return;
+      *this = CudaTensor_(tensor.range());
+      const auto& context = detail::CudaContext::get();
+      if(cudaMemcpyAsync(data_.get(), tensor.data(), tensor.size() * sizeof(T),
+          cudaMemcpyHostToDevice, context.stream()) != cudaSuccess)
+        TA_EXCEPTION("CudaTensor: unable to copy a tensor to the device.");
+      context.synchronize();
+    }
+
+    CudaTensor(const CudaTensor_&) = default;
+    CudaTensor(CudaTensor_&&) = default;
+    CudaTensor_& operator=(const CudaTensor_&) = default;
+    CudaTensor_& operator=(CudaTensor_&&) = default;
+
+    /// Copy this tensor to the host
+
+    /// \return A host tensor with the elements of this tensor
+    explicit operator Tensor<T>() const {
+      if(empty())
+        return Tensor<T>();
+      Tensor<T> result(range_);
+      const auto& context = detail::CudaContext::get();
+      if(cudaMemcpyAsync(result.data(), data_.get(), result.size() * sizeof(T),
+          cudaMemcpyDeviceToHost, context.stream()) != cudaSuccess)
+        TA_EXCEPTION("CudaTensor: unable to copy a tensor to the host.");
+      context.synchronize();
+      return result;
+    }
+
+    /// Deep copy
+
+    /// \return A copy of this tensor that does not share data with this tensor
+    CudaTensor_ clone() const {
+      if(empty())
+        return CudaTensor_();
+      CudaTensor_ result(range_);
+      const auto& context = detail::CudaContext::get();
+      if(cudaMemcpyAsync(result.data(), data_.get(), range_.volume() * sizeof(T),
+          cudaMemcpyDeviceToDevice, context.stream()) != cudaSuccess)
+        TA_EXCEPTION("CudaTensor: unable to copy a tensor on the device.");
+      context.synchronize();
+      return result;
+    }
+
+    /// \return \c true if this tensor is not initialized
+    bool empty() const { return ! data_; }
+
+    /// \return The range of this tensor
+    const range_type& range() const { return range_; }
+
+    /// \return The number of elements of this tensor
+    size_type size() const { return range_.volume(); }
+
+    /// \return The device pointer to the elements of this tensor
+    T* data() { return data_.get(); }
+
+    /// \return The device pointer to the elements of this tensor
+    const T* data() const { return data_.get(); }
+
+    /// Serialize the tensor
+
+    /// The elements are copied to the host and serialized as a \c Tensor .
+    /// \tparam Archive The output archive type
+    /// \param ar The output archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      Tensor<T> host = static_cast<Tensor<T> >(*this);
+      ar & host;
+    }
+
+    /// Deserialize the tensor
+
+    /// \tparam Archive The input archive type
+    /// \param ar The input archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      Tensor<T> host;
+      ar & host;
+      *this = CudaTensor_(host);
+    }
+
+    // Permutation -----------------------------------------------------------
+
+    /// Permute this tensor
+
+    /// Rank-2 tensors are transposed on the device; tensors of other ranks
+    /// are permuted on the host.
+    /// \param perm The permutation
+    /// \return A permuted copy of this tensor
+    CudaTensor_ permute(const Permutation& perm) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(perm.dim() == range_.rank());
+      if(range_.rank() != 2u)
+        return CudaTensor_(static_cast<Tensor<T> >(*this).permute(perm));
+      if(perm[0] == 0u)
+        return clone();
+      CudaTensor_ result(perm * range_);
+      const int m = range_.extent_data()[0];
+      const int n = range_.extent_data()[1];
+      const T one(1), zero(0);
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_geam(context.handle(), CUBLAS_OP_T,
+          CUBLAS_OP_N, m, n, &one, data_.get(), n, &zero, result.data(), m,
+          result.data(), m));
+      context.synchronize();
+      return result;
+    }
+
+    // Scaling ---------------------------------------------------------------
+
+    /// Scale this tensor in place
+
+    /// \param factor The scaling factor
+    /// \return A reference to this tensor
+    CudaTensor_& scale_to(const numeric_type factor) {
+      TA_ASSERT(! empty());
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_scal(context.handle(), isize(),
+          &factor, data_.get()));
+      context.synchronize();
+      return *this;
+    }
+
+    /// \param factor The scaling factor
+    /// \return A copy of this tensor scaled by \c factor
+    CudaTensor_ scale(const numeric_type factor) const {
+      return clone().scale_to(factor);
+    }
+
+    /// \param factor The scaling factor
+    /// \param perm The permutation of the result
+    /// \return A permuted copy of this tensor scaled by \c factor
+    CudaTensor_ scale(const numeric_type factor, const Permutation& perm) const {
+      return scale(factor).permute_result(perm);
+    }
+
+    /// \return A reference to this tensor after it is negated
+    CudaTensor_& neg_to() { return scale_to(numeric_type(-1)); }
+
+    /// \return A negated copy of this tensor
+    CudaTensor_ neg() const { return scale(numeric_type(-1)); }
+
+    /// \param perm The permutation of the result
+    /// \return A permuted and negated copy of this tensor
+    CudaTensor_ neg(const Permutation& perm) const {
+      return scale(numeric_type(-1), perm);
+    }
+
+    // Addition and subtraction ----------------------------------------------
+
+    /// Scaled sum of this tensor and \c right
+
+    /// \param right The right-hand argument
+    /// \param alpha The scaling factor of this tensor
+    /// \param beta The scaling factor of \c right
+    /// \return A tensor that is equal to <tt>alpha * (*this) + beta * right</tt>
+    CudaTensor_ axpby(const CudaTensor_& right, const numeric_type alpha,
+        const numeric_type beta) const
+    {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(range_ == right.range_);
+      CudaTensor_ result(range_);
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_geam(context.handle(), CUBLAS_OP_N,
+          CUBLAS_OP_N, isize(), 1, &alpha, data_.get(), isize(), &beta,
+          right.data(), isize(), result.data(), isize()));
+      context.synchronize();
+      return result;
+    }
+
+    /// Add a scaled tensor to this tensor in place
+
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of \c right
+    /// \return A reference to this tensor after <tt>(*this) += factor * right</tt>
+    CudaTensor_& axpy_to(const CudaTensor_& right, const numeric_type factor) {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(range_ == right.range_);
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_axpy(context.handle(), isize(),
+          &factor, right.data(), data_.get()));
+      context.synchronize();
+      return *this;
+    }
+
+    CudaTensor_ add(const CudaTensor_& right) const {
+      return axpby(right, numeric_type(1), numeric_type(1));
+    }
+    CudaTensor_ add(const CudaTensor_& right, const Permutation& perm) const {
+      return add(right).permute_result(perm);
+    }
+    CudaTensor_ add(const CudaTensor_& right, const numeric_type factor) const {
+      return axpby(right, factor, factor);
+    }
+    CudaTensor_ add(const CudaTensor_& right, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return add(right, factor).permute_result(perm);
+    }
+    CudaTensor_& add_to(const CudaTensor_& right) {
+      return axpy_to(right, numeric_type(1));
+    }
+    CudaTensor_& add_to(const CudaTensor_& right, const numeric_type factor) {
+      return axpy_to(right, numeric_type(1)).scale_to(factor);
+    }
+
+    CudaTensor_ subt(const CudaTensor_& right) const {
+      return axpby(right, numeric_type(1), numeric_type(-1));
+    }
+    CudaTensor_ subt(const CudaTensor_& right, const Permutation& perm) const {
+      return subt(right).permute_result(perm);
+    }
+    CudaTensor_ subt(const CudaTensor_& right, const numeric_type factor) const {
+      return axpby(right, factor, -factor);
+    }
+    CudaTensor_ subt(const CudaTensor_& right, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return subt(right, factor).permute_result(perm);
+    }
+    CudaTensor_& subt_to(const CudaTensor_& right) {
+      return axpy_to(right, numeric_type(-1));
+    }
+    CudaTensor_& subt_to(const CudaTensor_& right, const numeric_type factor) {
+      return axpy_to(right, numeric_type(-1)).scale_to(factor);
+    }
+
+    // Element-wise multiplication -------------------------------------------
+
+    /// Multiply this tensor by \c right element-wise in place
+
+    /// \param right The right-hand argument
+    /// \return A reference to this tensor
+    CudaTensor_& mult_to(const CudaTensor_& right) {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(range_ == right.range_);
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_dgmm(context.handle(), isize(),
+          data_.get(), right.data(), data_.get()));
+      context.synchronize();
+      return *this;
+    }
+
+    CudaTensor_& mult_to(const CudaTensor_& right, const numeric_type factor) {
+      return mult_to(right).scale_to(factor);
+    }
+    CudaTensor_ mult(const CudaTensor_& right) const {
+      return clone().mult_to(right);
+    }
+    CudaTensor_ mult(const CudaTensor_& right, const Permutation& perm) const {
+      return mult(right).permute_result(perm);
+    }
+    CudaTensor_ mult(const CudaTensor_& right, const numeric_type factor) const {
+      return clone().mult_to(right, factor);
+    }
+    CudaTensor_ mult(const CudaTensor_& right, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return mult(right, factor).permute_result(perm);
+    }
+
+    // Contraction -----------------------------------------------------------
+
+    /// Contract this tensor with \c other
+
+    /// \param other The right-hand argument
+    /// \param factor The scaling factor
+    /// \param gemm_helper The contraction dimensions
+    /// \return A tensor that is equal to <tt>factor * (*this) * other</tt>
+    CudaTensor_ gemm(const CudaTensor_& other, const numeric_type factor,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! other.empty());
+      TA_ASSERT(range_.rank() == gemm_helper.left_rank());
+      TA_ASSERT(other.range_.rank() == gemm_helper.right_rank());
+      CudaTensor_ result(gemm_helper.make_result_range<range_type>(range_, other.range_));
+      result.gemm_impl(*this, other, factor, numeric_type(0), gemm_helper);
+      return result;
+    }
+
+    /// Contract \c left with \c right and add the product to this tensor
+
+    /// \param left The left-hand argument
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor
+    /// \param gemm_helper The contraction dimensions
+    /// \return A reference to this tensor after
+    /// <tt>(*this) += factor * left * right</tt>
+    CudaTensor_& gemm(const CudaTensor_& left, const CudaTensor_& right,
+        const numeric_type factor, const math::GemmHelper& gemm_helper)
+    {
+      if(empty())
+        return *this = left.gemm(right, factor, gemm_helper);
+      TA_ASSERT(range_.rank() == gemm_helper.result_rank());
+      gemm_impl(left, right, factor, numeric_type(1), gemm_helper);
+      return *this;
+    }
+
+  private:
+
+    /// Evaluate <tt>(*this) = factor * left * right + beta * (*this)</tt>
+
+    /// The tensors are row-major, so the column-major product
+    /// \f$ C^T = B^T A^T \f$ is evaluated.
+    void gemm_impl(const CudaTensor_& left, const CudaTensor_& right,
+        const numeric_type factor, const numeric_type beta,
+        const math::GemmHelper& gemm_helper)
+    {
+      integer m = 1, n = 1, k = 1;
+      gemm_helper.compute_matrix_sizes(m, n, k, left.range_, right.range_);
+      const integer lda = (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
+      const integer ldb = (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_gemm(context.handle(),
+          detail::cublas_op(gemm_helper.right_op()),
+          detail::cublas_op(gemm_helper.left_op()), int(n), int(m), int(k),
+          &factor, right.data(), int(ldb), left.data(), int(lda), &beta,
+          data_.get(), int(n)));
+      context.synchronize();
+    }
+
+  public:
+
+    // Reduction operations --------------------------------------------------
+
+    /// \param other The right-hand argument
+    /// \return The dot product of this tensor and \c other
+    numeric_type dot(const CudaTensor_& other) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(range_ == other.range_);
+      numeric_type result(0);
+      const auto& context = detail::CudaContext::get();
+      detail::cublas_check(detail::cublas_dot(context.handle(), isize(),
+          data_.get(), other.data(), &result));
+      context.synchronize();
+      return result;
+    }
+
+    /// \return The squared Frobenius norm of this tensor
+    scalar_type squared_norm() const { return dot(*this); }
+
+    /// \return The Frobenius norm of this tensor
+    scalar_type norm() const { return std::sqrt(squared_norm()); }
+
+    /// The sum is evaluated on the host.
+    /// \return The sum of the elements of this tensor
+    numeric_type sum() const {
+      TA_ASSERT(! empty());
+      return static_cast<Tensor<T> >(*this).sum();
+    }
+
+  }; // class CudaTensor
+
+  /// Print a device tensor
+
+  /// \param os The output stream
+  /// \param tensor The tensor
+  /// \return \c os
+  template <typename T>
+  inline std::ostream& operator<<(std::ostream& os, const CudaTensor<T>& tensor) {
+    os << static_cast<Tensor<T> >(tensor);
+    return os;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_HAS_CUDA
+
+#endif // TILEDARRAY_CUDA_TENSOR_H__INCLUDED
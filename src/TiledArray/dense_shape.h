@@ -26,7 +26,9 @@
 #ifndef TILEDARRAY_DENSE_SHAPE_H__INCLUDED
 #define TILEDARRAY_DENSE_SHAPE_H__INCLUDED
 
+#include <TiledArray/bitset.h>
 #include <TiledArray/type_traits.h>
+#include <vector>
 
 namespace madness {
   class World;
@@ -95,6 +97,22 @@ namespace TiledArray {
       return DenseShape{};
     };
 
+    /// Tile mask
+
+    /// Dense shapes have no zero tiles, so tile masks are ignored.
+    /// \return A dense shape
+    template <typename Block>
+    DenseShape mask(const detail::Bitset<Block>&) const {
+      return DenseShape{};
+    };
+
+    /// Zero threshold
+
+    /// Dense shapes have no zero tiles, so thresholds are ignored.
+    /// \return A dense shape
+    template <typename Scalar>
+    static DenseShape with_threshold(const Scalar) { return DenseShape(); }
+
     template <typename Index>
     static DenseShape update_block(const Index&, const Index&, const DenseShape&)
     { return DenseShape(); }
@@ -173,8 +191,29 @@ namespace TiledArray {
     static DenseShape gemm(const DenseShape&, const Scalar, const math::GemmHelper&, const Permutation&)
     { return DenseShape(); }
 
+    template <typename Scalar, typename Block>
+    static DenseShape gemm(const DenseShape&, const Scalar, const math::GemmHelper&,
+        const detail::Bitset<Block>&)
+    { return DenseShape(); }
+
+    template <typename Scalar, typename Block>
+    static DenseShape gemm(const DenseShape&, const Scalar, const math::GemmHelper&,
+        const Permutation&, const detail::Bitset<Block>&)
+    { return DenseShape(); }
+
+    static DenseShape sum_over(const std::vector<unsigned int>&) { return DenseShape(); }
+
   }; // class DenseShape
 
+  namespace detail {
+
+    /// Dense shapes are always equal
+
+    /// \return \c true
+    inline bool is_same_shape(const DenseShape&, const DenseShape&) { return true; }
+
+  } // namespace detail
+
 } // namespace TiledArray
 
 #endif // TILEDARRAY_DENSE_SHAPE_H__INCLUDED
@@ -0,0 +1,159 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  df_exchange.h
+ *  Apr 4, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DF_EXCHANGE_H__INCLUDED
+#define TILEDARRAY_DF_EXCHANGE_H__INCLUDED
+
+#include <TiledArray/conversions/truncate.h>
+#include <TiledArray/dist_array.h>
+#include <TiledArray/expressions/cont_slice.h>
+#include <TiledArray/expressions/expr_handle.h>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Partition the density-fitting tiles of \c df_exchange() into batches
+
+    /// The half-transformed tensor of a batch, which is a block of
+    /// <tt>W(X,mu,i)</tt> , is bounded by half of \c budget , since the
+    /// next batch is computed while the current one is contracted.
+    /// \param df The tiling of the density-fitting index
+    /// \param ao_size The number of basis functions
+    /// \param occ_size The number of occupied orbitals
+    /// \param element_size The size of an element, in bytes
+    /// \param procs The number of processes
+    /// \param budget The memory budget, in bytes per process, or zero for
+    /// one batch
+    /// \return The bounds of the batches, in tiles relative to the first
+    /// tile of \c df
+    inline std::vector<std::size_t>
+    df_exchange_batches(const TiledRange1& df, const std::size_t ao_size,
+        const std::size_t occ_size, const std::size_t element_size,
+        const std::size_t procs, const std::size_t budget)
+    {
+      const std::size_t tiles = df.tiles_range().second - df.tiles_range().first;
+      std::vector<std::size_t> bounds(1, 0ul);
+      if(budget) {
+        const std::size_t row = ao_size * occ_size * element_size;
+        std::size_t batch_memory = 0ul;
+        for(std::size_t t = 0ul; t < tiles; ++t) {
+          const auto& tile = df.tile(df.tiles_range().first + t);
+          const std::size_t memory = (tile.second - tile.first) * row;
+          if((t > bounds.back()) && (((batch_memory + memory) / procs) > (budget / 2ul))) {
+            bounds.push_back(t);
+            batch_memory = 0ul;
+          }
+          batch_memory += memory;
+        }
+      }
+      bounds.push_back(tiles);
+      return bounds;
+    }
+
+  }  // namespace detail
+
+  /// Density-fitted exchange matrix
+
+  /// Computes
+  /// \f[
+  ///   K_{\mu\nu} = \sum_{X i} W_{X \mu i} W_{X \nu i}, \quad
+  ///   W_{X \mu i} = \sum_{\sigma} B_{X \mu \sigma} C_{\sigma i}
+  /// \f]
+  /// where \c B is the fitted three-index tensor, i.e. the three-index
+  /// integrals contracted with the inverse square root of the metric, and
+  /// \c C are the occupied orbital coefficients. The full half-transformed
+  /// tensor \c W is never stored: the density-fitting index \c X is
+  /// streamed in batches of tiles whose \c W fits in
+  /// \c contraction_max_memory() (one batch when it is zero). The
+  /// half-transformation of a batch, a block of \c B times \c C , is
+  /// evaluated while the previous batch is contracted into \c K , and the
+  /// batch is released as soon as it has been contracted. For sparse
+  /// arrays the shape of \c W is estimated from the norms of the
+  /// <tt>(X,mu)</tt> rows of \c B , so screened rows are never computed,
+  /// and \c W is truncated before it is contracted, so the contraction
+  /// skips the <tt>(X,mu)</tt> blocks that are negligible in fact. This
+  /// function is collective.
+  /// \tparam Tile The tile type
+  /// \tparam Policy The array policy type
+  /// \param B The fitted three-index tensor, with indices <tt>(X,mu,nu)</tt>
+  /// \param C The orbital coefficients, with indices <tt>(mu,i)</tt>
+  /// \return The exchange matrix, with indices <tt>(mu,nu)</tt>
+  /// \throw TiledArray::Exception When the ranks or the tiling of the
+  /// arguments do not match
+  template <typename Tile, typename Policy>
+  inline DistArray<Tile, Policy>
+  df_exchange(const DistArray<Tile, Policy>& B, const DistArray<Tile, Policy>& C) {
+    typedef DistArray<Tile, Policy> array_type;
+    typedef typename array_type::element_type element_type;
+
+    TA_USER_ASSERT(B.trange().tiles_range().rank() == 3u,
+        "df_exchange(): the three-index tensor must have rank 3.");
+    TA_USER_ASSERT(C.trange().tiles_range().rank() == 2u,
+        "df_exchange(): the coefficients must have rank 2.");
+    TA_USER_ASSERT(B.trange().data()[2] == C.trange().data()[0],
+        "df_exchange(): the tiling of the basis functions of the arguments differs.");
+
+    World& world = B.world();
+    const auto& tiles = B.trange().tiles_range();
+    const std::vector<std::size_t> bounds = detail::df_exchange_batches(
+        B.trange().data()[0], B.trange().elements_range().extent_data()[1],
+        C.trange().elements_range().extent_data()[1], sizeof(element_type),
+        world.size(), contraction_max_memory());
+
+    // Start the half-transformation of a batch
+    const auto half_transform = [&] (array_type& W, const std::size_t b) {
+      std::vector<std::size_t> lower(tiles.lobound_data(),
+          tiles.lobound_data() + 3);
+      std::vector<std::size_t> upper(tiles.upbound_data(),
+          tiles.upbound_data() + 3);
+      upper[0] = lower[0] + bounds[b + 1ul];
+      lower[0] += bounds[b];
+      return W("X,mu,i").assign_async(
+          B("X,mu,nu").block(lower, upper) * C("nu,i"));
+    };
+
+    array_type K, W, W_next;
+    auto handle = half_transform(W, 0ul);
+    for(std::size_t b = 0ul; (b + 1ul) < bounds.size(); ++b) {
+      handle.wait();
+      truncate(W);
+
+      // Overlap the next half-transformation with this contraction
+      if((b + 2ul) < bounds.size())
+        handle = half_transform(W_next, b + 1ul);
+
+      if(b == 0ul)
+        K("mu,nu") = W("X,mu,i") * W("X,nu,i");
+      else
+        K("mu,nu") += W("X,mu,i") * W("X,nu,i");
+
+      W = W_next;
+      W_next = array_type();
+    }
+
+    return K;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DF_EXCHANGE_H__INCLUDED
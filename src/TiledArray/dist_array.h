@@ -22,9 +22,12 @@
 
 #include <TiledArray/replicator.h>
 #include <TiledArray/pmap/replicated_pmap.h>
+#include <TiledArray/pmap/view_pmap.h>
 //#include <TiledArray/tensor.h>
 #include <TiledArray/policies/dense_policy.h>
 #include <TiledArray/array_impl.h>
+#include <TiledArray/expressions/index_list.h>
+#include <TiledArray/math/random.h>
 #include <TiledArray/conversions/truncate.h>
 #include <TiledArray/conversions/clone.h>
 
@@ -44,7 +47,7 @@ namespace TiledArray {
   /// used to construct distributed tensor algebraic operations.
   /// \tparam T The element type of for array tiles
   /// \tparam Tile The tile type [ Default = \c Tensor<T> ]
-  template <typename Tile = Tensor<double, Eigen::aligned_allocator<double> >,
+  template <typename Tile = Tensor<double, PoolAllocator<double> >,
       typename Policy = DensePolicy>
   class DistArray {
   public:
@@ -75,18 +78,33 @@ namespace TiledArray {
     /// Array deleter function
 
     /// This function schedules a task for lazy cleanup. Array objects are
-    /// deleted only after the object has been deleted in all processes.
+    /// deleted only after the object has been deleted in all processes,
+    /// which is detected by \c lazy_sync without a fence. Remote tiles
+    /// cached by this process are not needed by other processes, so they are
+    /// released immediately, and an array that exists on only one process
+    /// is deleted immediately. The arrays that wait for cleanup are counted
+    /// by \c TiledArray::lazy_cleanup_stats() .
     /// \param pimpl The implementation pointer to be deleted.
     static void lazy_deleter(const impl_type* const pimpl) {
       if(pimpl) {
         if(madness::initialized()) {
           World& world = pimpl->world();
           const madness::uniqueidT id = pimpl->id();
+          const_cast<impl_type*>(pimpl)->clear_prefetch();
+          if(world.size() == 1) {
+            delete pimpl;
+            return;
+          }
+
+          detail::WorldMemoryTracker& tracker = detail::world_memory_tracker(world);
+          const std::size_t bytes = pimpl->memory_usage().total_bytes();
+          tracker.cleanup_add(bytes);
           cleanup_counter_++;
 
           try {
-            world.gop.lazy_sync(id, [pimpl]() {
+            world.gop.lazy_sync(id, [pimpl,&tracker,bytes]() {
               delete pimpl;
+              tracker.cleanup_sub(bytes);
               DistArray_::cleanup_counter_--;
             });
           }
@@ -96,6 +114,7 @@ namespace TiledArray {
                             "!! ERROR TiledArray: The exception has been absorbed.\n"
                             "!! ERROR TiledArray: rank=%i\n", e.what(), world.rank());
 
+            tracker.cleanup_sub(bytes);
             cleanup_counter_--;
             delete pimpl;
           }
@@ -105,6 +124,7 @@ namespace TiledArray {
                             "!! ERROR TiledArray: The exception has been absorbed.\n"
                             "!! ERROR TiledArray: rank=%i\n", e.what(), world.rank());
 
+            tracker.cleanup_sub(bytes);
             cleanup_counter_--;
             delete pimpl;
           }
@@ -113,6 +133,7 @@ namespace TiledArray {
                             "!! ERROR TiledArray: The exception has been absorbed.\n"
                             "!! ERROR TiledArray: rank=%i\n", world.rank());
 
+            tracker.cleanup_sub(bytes);
             cleanup_counter_--;
             delete pimpl;
           }
@@ -156,6 +177,11 @@ namespace TiledArray {
       return std::shared_ptr<impl_type>(new impl_type(world, trange, shape, pmap), lazy_deleter);
     }
 
+    /// Implementation constructor
+
+    /// \param pimpl The implementation of the array
+    explicit DistArray(const std::shared_ptr<impl_type>& pimpl) : pimpl_(pimpl) { }
+
   public:
     /// Default constructor
 
@@ -266,6 +292,16 @@ namespace TiledArray {
     /// should not rely on this function.
     madness::uniqueidT id() const { return pimpl_->id(); }
 
+    /// Modification counter
+
+    /// \return The number of times tiles of this array were set, or its shape
+    /// was updated, through this process
+    /// \sa detail::ArrayImpl::version()
+    unsigned long version() const {
+      check_pimpl();
+      return pimpl_->version();
+    }
+
     /// Begin iterator factory function
 
     /// \return An iterator to the first local tile.
@@ -321,6 +357,305 @@ namespace TiledArray {
       return find<std::initializer_list<Integer>>(i);
     }
 
+    /// Prefetch remote tiles
+
+    /// Request copies of the remote tiles in the sequence
+    /// <tt>[first,last)</tt> , which are overlapped with each other and with
+    /// local work. The tiles are held in a bounded local cache until they are
+    /// requested with \c find() , so a loop that calls \c find() for each
+    /// tile does not wait for a serialized round trip per tile. Local tiles
+    /// that were spilled to disk are read back, and other local tiles and
+    /// zero tiles are ignored. If more tiles are prefetched than fit in the
+    /// cache, the oldest prefetched tiles are dropped and fetched again when
+    /// they are requested.
+    /// \tparam InIter An input iterator type, which dereferences to a tile
+    /// index or ordinal
+    /// \param first An iterator to the first tile index to prefetch
+    /// \param last An iterator to one past the last tile index to prefetch
+    /// \throw TiledArray::Exception When a tile index is out of range
+    template <typename InIter,
+        typename std::enable_if<detail::is_input_iterator<InIter>::value>::type* = nullptr>
+    void prefetch(InIter first, InIter last) const {
+      for(; first != last; ++first) {
+        check_index(*first);
+        pimpl_->prefetch(*first);
+      }
+    }
+
+    /// Prefetch remote tiles
+
+    /// \tparam Indices A container type of tile indices or ordinals, e.g.
+    /// \c std::vector or the \c Range of a block of tiles
+    /// \param indices The indices of the tiles to prefetch
+    /// \throw TiledArray::Exception When a tile index is out of range
+    /// \sa prefetch(InIter, InIter)
+    template <typename Indices>
+    void prefetch(const Indices& indices) const {
+      using std::begin;
+      using std::end;
+      prefetch(begin(indices), end(indices));
+    }
+
+    /// Prefetch remote tiles
+
+    /// \tparam Index A tile index or ordinal type
+    /// \param indices The indices of the tiles to prefetch
+    /// \throw TiledArray::Exception When a tile index is out of range
+    template <typename Index>
+    void prefetch(const std::initializer_list<Index>& indices) const {
+      prefetch(indices.begin(), indices.end());
+    }
+
+    /// Prefetch cache capacity accessor
+
+    /// The default capacity is set with the \c TA_PREFETCH_CACHE_SIZE
+    /// environment variable.
+    /// \return The largest number of remote tiles held by the prefetch cache
+    /// of this array
+    size_type prefetch_capacity() const {
+      check_pimpl();
+      return pimpl_->prefetch_capacity();
+    }
+
+    /// Set the prefetch cache capacity
+
+    /// \param capacity The largest number of remote tiles held by the
+    /// prefetch cache of this array on this process; zero disables
+    /// prefetching
+    void prefetch_capacity(const size_type capacity) {
+      check_pimpl();
+      pimpl_->prefetch_capacity(capacity);
+    }
+
+    /// Permutation cache capacity accessor
+
+    /// \return The largest number of bytes held by the permutation cache of
+    /// this array on this process, or zero if it is disabled
+    std::size_t permutation_cache_capacity() const {
+      check_pimpl();
+      return pimpl_->permutation_cache_capacity();
+    }
+
+    /// Cache the permuted local tiles of this array
+
+    /// Expressions that use this array with its indices in another order,
+    /// e.g. <tt>a("j,i")</tt> where \c a is stored as <tt>a("i,j")</tt> ,
+    /// permute each local tile when it is used. With a permutation cache,
+    /// each permuted tile is kept on this process for each permutation, and
+    /// later expressions with the same permutation use a copy of the cached
+    /// tile instead of permuting it again. The least recently used tiles are
+    /// removed when the cache holds more than \c capacity bytes, and all
+    /// cached tiles are removed when tiles of this array are set, or its
+    /// shape is updated, through this process. This trades memory for the
+    /// permutations of arrays that are used in several index orders many
+    /// times, e.g. the integrals of an iterative solver, and should only be
+    /// used for arrays that are not modified in place on other processes.
+    /// It is independent of the lazy tile cache, see
+    /// \c lazy_tile_cache_capacity() .
+    /// \param capacity The largest number of bytes held by the permutation
+    /// cache of this array on this process; zero disables the cache
+    void permutation_cache_capacity(const std::size_t capacity) {
+      check_pimpl();
+      pimpl_->permutation_cache_capacity(capacity);
+    }
+
+    /// Permutation cache size accessor
+
+    /// \return The number of bytes held by the permutation cache of this
+    /// array on this process
+    std::size_t permutation_cache_size() const {
+      check_pimpl();
+      const std::shared_ptr<detail::TileCache>& cache = pimpl_->permutation_cache();
+      return (cache ? cache->size() : 0ul);
+    }
+
+    /// Permutation cache accessor
+
+    /// \return The permutation cache of this array, or null if it is
+    /// disabled
+    const std::shared_ptr<detail::TileCache>& permutation_cache() const {
+      check_pimpl();
+      return pimpl_->permutation_cache();
+    }
+
+    /// Memory footprint of this array on this process
+
+    /// The footprint has three parts: the local bytes are the size of the
+    /// local tiles that have been set, the pending bytes are the expected size
+    /// of the local tiles that have not been set, and the cache bytes are the
+    /// size of the prefetched remote tiles. Tiles that share data with other
+    /// arrays, e.g. shallow copies, are counted by each array. The footprint
+    /// of all arrays in a world is returned by
+    /// \c TiledArray::memory_usage(world) .
+    /// \return The current footprint of this array on this process
+    MemoryUsage memory_usage() const {
+      check_pimpl();
+      return pimpl_->memory_usage();
+    }
+
+    /// Spill the local tiles of this array to disk
+
+    /// The local tiles of this array are kept in memory until their total
+    /// size exceeds \c max_bytes ; the least recently used tiles are then
+    /// written to files in \c directory and they are read back, in a task,
+    /// when they are accessed again. Only the local tiles of this process
+    /// are affected; the directory should be on node-local storage, such as
+    /// an NVMe drive. This must be called before any tile is set. By default,
+    /// tiles are spilled to the \c TA_SPILL_DIR directory, when that
+    /// environment variable is set, with a limit of \c TA_SPILL_MAX_BYTES
+    /// (default 1 GB).
+    /// \param directory The directory of the spill files
+    /// \param max_bytes The largest size, in bytes, of the local tiles held in
+    /// memory by this process
+    void spill(const std::string& directory, const std::size_t max_bytes) {
+      check_pimpl();
+      pimpl_->spill(directory, max_bytes);
+    }
+
+    /// Number of spilled tiles
+
+    /// \return The number of local tiles of this array that are held on disk
+    size_type spilled_size() const {
+      check_pimpl();
+      return pimpl_->spilled_size();
+    }
+
+    /// Hold the local tiles of this array in a flat array
+
+    /// The local tiles are held in an array indexed by their position among
+    /// the local tiles of the process map, instead of a concurrent hash map,
+    /// so tiles are read without locks, which avoids contention when many
+    /// threads read the same tiles, e.g. in contractions. Tiles of indexed
+    /// storage are not spilled to disk. By default, indexed storage is used
+    /// when the \c TA_INDEXED_STORAGE environment variable is set to a
+    /// non-zero value.
+    /// \note This function is collective; it must be called on all processes
+    /// before any tile is set or read, and it must not be called from a task.
+    /// It fences after switching the storage, so no process can set a tile of
+    /// another process before that process has switched.
+    void indexed_storage() {
+      check_pimpl();
+      pimpl_->indexed_storage();
+      pimpl_->world().gop.fence();
+    }
+
+    /// Indexed storage query
+
+    /// \return \c true if the local tiles of this array are held in indexed
+    /// storage
+    bool is_indexed_storage() const {
+      check_pimpl();
+      return pimpl_->is_indexed_storage();
+    }
+
+    /// Make this array read-only
+
+    /// After this call, tiles of this array may not be set or accumulated.
+    /// Each process then caches the remote tiles that it reads, or
+    /// prefetches, when they are first requested, so later expressions that
+    /// read the same tiles use the cached copies instead of fetching them
+    /// again, and local tiles of the hash map are read without locks. The
+    /// cached tiles are counted as cache bytes by \c memory_usage() , and
+    /// they are released when this array is destroyed. Freezing a view
+    /// freezes the viewed array. This is a collective operation, which
+    /// fences the world of this array so that all tiles are set before they
+    /// are frozen.
+    void freeze() {
+      check_pimpl();
+      world().gop.fence();
+      pimpl_->freeze();
+    }
+
+    /// Frozen array query
+
+    /// \return \c true if the tiles of this array are read-only
+    bool is_frozen() const {
+      check_pimpl();
+      return pimpl_->is_frozen();
+    }
+
+    /// Aggregate small remote tile sets and gets
+
+    /// Tiles smaller than \c bytes that are set on another process, and
+    /// requests for tiles of another process, are buffered per destination
+    /// and sent in one active message when the buffer holds \c bytes bytes,
+    /// or when the task queued for the buffer runs, so buffers are always
+    /// sent before a fence. This reduces the per-message overhead of arrays
+    /// with many small tiles. By default, the size is read from the
+    /// \c TA_AGGREGATE_BYTES environment variable, and zero disables
+    /// aggregation.
+    /// \note This function is collective; it must be called on all processes
+    /// with the same size, before any tile is set or read, and it must not
+    /// be called from a task. It fences after changing the size, so all
+    /// processes use the same size when tiles are accessed.
+    /// \param bytes The size of aggregated messages, or zero to send one
+    /// message per tile
+    void aggregate_bytes(const std::size_t bytes) {
+      check_pimpl();
+      pimpl_->aggregate_bytes(bytes);
+      pimpl_->world().gop.fence();
+    }
+
+    /// Number of tile set and get messages sent by this process
+
+    /// \return The number of active messages that set, request, or return
+    /// tiles of this array, which were sent by this process
+    size_type messages_sent() const {
+      check_pimpl();
+      return pimpl_->messages_sent();
+    }
+
+    /// Number of tiles moved by the messages of this process
+
+    /// \return The number of tiles set, requested, or returned by the
+    /// messages counted by \c messages_sent()
+    size_type tiles_sent() const {
+      check_pimpl();
+      return pimpl_->tiles_sent();
+    }
+
+    /// Expose the tiles of this array for one-sided access
+
+    /// The local tiles of each process are copied into an MPI-3 window, and
+    /// remote tiles are then read with \c MPI_Get , so the owner of a tile
+    /// takes no part in the transfer and a busy task queue does not delay
+    /// it. The array is read-only until \c rma_release() is called. Arrays
+    /// whose tiles do not hold their elements in one contiguous buffer are
+    /// still read with active messages. This function is collective, and all
+    /// tiles must have been set, e.g.
+    /// \code
+    /// world.gop.fence();
+    /// a.rma_expose();
+    /// c("i,j") = a("i,k") * b("k,j");
+    /// a.rma_release();
+    /// \endcode
+    /// \note Releasing the window is collective, so it is not released when
+    /// the array is destroyed: \c rma_release() must be called on all
+    /// processes before the last copy of the array is destroyed.
+    /// \sa detail::RmaWindow
+    void rma_expose() {
+      check_pimpl();
+      pimpl_->rma_expose();
+    }
+
+    /// Release the one-sided window of this array
+
+    /// The world is fenced before the window is released, and tiles may be
+    /// set again afterward. This function is collective.
+    void rma_release() {
+      check_pimpl();
+      pimpl_->rma_release();
+    }
+
+    /// One-sided access query
+
+    /// \return \c true if the tiles of this array are exposed for one-sided
+    /// access
+    bool is_rma_exposed() const {
+      check_pimpl();
+      return pimpl_->is_rma_exposed();
+    }
+
     /// Set a tile and fill it using a sequence
 
     /// \tparam Index An index or integral type
@@ -413,6 +748,66 @@ namespace TiledArray {
       set<std::initializer_list<Integer>>(i, v);
     }
 
+    /// Add a contribution to a tile
+
+    /// This is for builds where many processes contribute to the same tiles,
+    /// e.g. Fock matrix builds, which would otherwise sum private arrays.
+    /// The contribution is sent to the owner of the tile, where it is added
+    /// to the tile; contributions to the same remote tile are first combined
+    /// locally, and the combined contributions are sent with one message per
+    /// owner. All contributions have been added after the next fence, e.g.
+    /// \code
+    /// TArrayD f(world, trange);
+    /// for(auto&& shell_quartet : my_shell_quartets)
+    ///   f.accumulate(tile_index(shell_quartet), contribution(shell_quartet));
+    /// world.gop.fence();
+    /// \endcode
+    /// The first contribution sets the tile, so a tile that is accumulated
+    /// must not be set, and it holds a partial sum before the fence.
+    /// \tparam Index An index or integral type
+    /// \param i The index or the ordinal of the tile, which must not be a
+    /// zero tile
+    /// \param value The contribution to tile \c i
+    /// \sa detail::DistributedStorage::accumulate()
+    template <typename Index>
+    void accumulate(const Index& i, const value_type& value) {
+      check_index(i);
+      pimpl_->accumulate(i, value);
+    }
+
+    /// Add a contribution to a tile
+
+    /// \tparam Integer An integral type
+    /// \param i The tile index, as an \c std::initializer_list<Integer>
+    /// \param value The contribution to tile \c i
+    template <typename Integer>
+    void accumulate(const std::initializer_list<Integer>& i, const value_type& value) {
+      accumulate<std::initializer_list<Integer>>(i, value);
+    }
+
+    /// Set many tiles with futures
+
+    /// This is equivalent to calling \c set() for each tile, but the tiles
+    /// are inserted together, and the remote tiles are sent with one message
+    /// per owner; see \c detail::DistributedStorage::set_bulk() .
+    /// \param indices The ordinal indices of the tiles to be set, which must
+    /// not be zero tiles
+    /// \param tiles The futures of the tiles in \c indices
+    void set_bulk(const std::vector<size_type>& indices,
+        const std::vector<Future<value_type> >& tiles)
+    {
+      check_pimpl();
+      TA_USER_ASSERT(indices.size() == tiles.size(),
+          "The number of indices and tiles must be equal.");
+#ifndef NDEBUG
+      for(const size_type i : indices) {
+        TA_ASSERT(i < size());
+        TA_ASSERT(! is_zero(i));
+      }
+#endif // NDEBUG
+      pimpl_->set_bulk(indices, tiles);
+    }
+
     /// Fill all local tiles
 
     /// \param value The fill value
@@ -430,6 +825,66 @@ namespace TiledArray {
       fill_local(value, skip_set);
     }
 
+    /// Fill all local tiles with uniform random values
+
+    /// Each tile is filled with the Philox counter-based generator (see
+    /// \c math::uniform_fill() ), using the tile ordinal as the stream, so
+    /// the values depend only on \c seed and the tiling: they do not depend
+    /// on the number of processes or threads, or on the process map, and no
+    /// communication is needed. Zero tiles are not set.
+    /// \param lo The lower bound of the values
+    /// \param hi The upper bound of the values
+    /// \param seed The seed of the random values
+    /// \param skip_set If false, will throw if any tiles are already set
+    template <typename T = element_type>
+    void fill_random(const T lo = T(-1), const T hi = T(1),
+        const std::uint64_t seed = 0ul, bool skip_set = false)
+    {
+      static_assert(std::is_same<T, element_type>::value &&
+          std::is_floating_point<T>::value,
+          "fill_random requires floating point tile elements");
+      init_indexed_tiles(local_init_indices(skip_set),
+          [=] (const size_type index, const range_type& range) {
+            value_type tile(range);
+            math::uniform_fill(range.volume(), tile.begin(), index, seed, lo, hi);
+            return tile;
+          });
+    }
+
+    /// Fill all local tiles with the identity
+
+    /// Elements whose indices are all equal are set to one, and all other
+    /// elements are set to zero, so a matrix is filled with the identity
+    /// matrix. Zero tiles are not set.
+    /// \param skip_set If false, will throw if any tiles are already set
+    void fill_identity(bool skip_set = false) {
+      init_tiles([] (const range_type& range) {
+            value_type tile(range, element_type(0));
+
+            // Only the diagonal of the tile is set
+            const unsigned int rank = range.rank();
+            const auto* const lower = range.lobound_data();
+            const auto* const upper = range.upbound_data();
+            const auto* const stride = range.stride_data();
+            std::size_t first = 0ul, last = std::numeric_limits<std::size_t>::max();
+            std::size_t diagonal_stride = 0ul;
+            for(unsigned int d = 0u; d < rank; ++d) {
+              first = std::max<std::size_t>(first, lower[d]);
+              last = std::min<std::size_t>(last, upper[d]);
+              diagonal_stride += stride[d];
+            }
+            if(first < last) {
+              std::size_t offset = 0ul;
+              for(unsigned int d = 0u; d < rank; ++d)
+                offset += (first - lower[d]) * stride[d];
+              for(std::size_t i = first; i < last; ++i, offset += diagonal_stride)
+                tile[offset] = element_type(1);
+            }
+
+            return tile;
+          }, skip_set);
+    }
+
     /// Initialize tiles with a user provided functor
 
     /// This function is used to initialize tiles of the array via a function
@@ -462,25 +917,66 @@ namespace TiledArray {
     /// \param skip_set If false, will throw if any tiles are already set
     template <typename Op>
     void init_tiles(Op&& op, bool skip_set = false) {
+      init_tiles(local_init_indices(skip_set), std::forward<Op>(op));
+    }
+
+    /// Initialize some local tiles with a user provided functor
+
+    /// The futures of all tiles in \c indices are inserted with a single
+    /// \c set_bulk() call, and the tiles are generated by a few tasks per
+    /// thread, each of which generates a contiguous block of \c indices , so
+    /// the cost of a task, an index check, and a storage insertion is not
+    /// paid for each tile. This is much faster than \c set() for arrays with
+    /// many small tiles. The signature of the functor is the same as for
+    /// \c init_tiles() , and it must be thread safe.
+    /// \tparam Op Tile operation type
+    /// \param indices The ordinals of the tiles to be set, which must be
+    /// local, non-zero tiles that are not set yet
+    /// \param op The operation used to generate tiles
+    template <typename Op>
+    void init_tiles(const std::vector<size_type>& indices, Op&& op) {
+      typedef typename std::decay<Op>::type op_type;
+      init_indexed_tiles(indices, [op = op_type(std::forward<Op>(op))]
+          (const size_type, const range_type& range) mutable
+          { return op(range); });
+    }
+
+    /// Initialize tiles on demand
+
+    /// This function makes this a lazy array: tiles are not set; instead,
+    /// a non-zero tile is generated by a task that evaluates \c op with the
+    /// range of the tile when the tile is first requested, e.g. by \c find()
+    /// or by an expression that consumes this array, so tiles that are never
+    /// used, and tiles that the shape marks as zero, are never generated.
+    /// The signature of the functor is the same as for \c init_tiles() :
+    /// \code
+    /// value_type op(const range_type&)
+    /// \endcode
+    /// When \c cache is \c true , a generated tile is stored and reused by
+    /// later requests, like a tile that has been set. Otherwise, the tile is
+    /// generated again for each request and this array does not hold it,
+    /// which trades computation for memory. Tiles of a lazy array cannot be
+    /// set. This function is collective: the world is fenced after the
+    /// operation is installed, so no process requests a tile before its
+    /// owner can generate it. It must therefore be called before the array
+    /// is used on any process, and not from a task.
+    /// \tparam Op Tile operation type
+    /// \param op The thread-safe operation used to generate tiles
+    /// \param cache If \c true , generated tiles are stored
+    template <typename Op>
+    void init_lazy_tiles(Op&& op, const bool cache = true) {
       check_pimpl();
+      pimpl_->generator(std::forward<Op>(op), cache);
+      pimpl_->world().gop.fence();
+    }
 
-      auto it = pimpl_->pmap()->begin();
-      const auto end = pimpl_->pmap()->end();
-      for(; it != end; ++it) {
-        const auto index = *it;
-        if(! pimpl_->is_zero(index)) {
-          if (skip_set) {
-            auto fut = find(index);
-            if (fut.probe())
-              continue;
-          }
-          Future<value_type> tile = pimpl_->world().taskq.add(
-              [] (DistArray_* array, const size_type index, const Op& op) -> value_type
-              { return op(array->trange().make_tile_range(index)); },
-              this, index, op);
-          set(index, tile);
-        }
-      }
+    /// Lazy array query
+
+    /// \return \c true if the tiles of this array are generated on demand
+    /// \sa init_lazy_tiles()
+    bool is_lazy() const {
+      check_pimpl();
+      return pimpl_->is_lazy();
     }
 
     /// Tiled range accessor
@@ -524,18 +1020,8 @@ namespace TiledArray {
     TiledArray::expressions::TsrExpr<const DistArray_, true>
     operator ()(const std::string& vars) const {
 #ifndef NDEBUG
-      const unsigned int n = 1u + std::count_if(vars.begin(), vars.end(),
-          [](const char c) { return c == ','; });
-      if(bool(pimpl_) && n != pimpl_->trange().tiles_range().rank()) {
-        if(TiledArray::get_default_world().rank() == 0) {
-          TA_USER_ERROR_MESSAGE( \
-              "The number of array annotation variables is not equal to the array dimension:" \
-              << "\n    number of variables  = " << n \
-              << "\n    array dimension      = " << pimpl_->trange().tiles_range().rank() );
-        }
-
-        TA_EXCEPTION("The number of array annotation variables is not equal to the array dimension.");
-      }
+      check_index_count(1u + std::count_if(vars.begin(), vars.end(),
+          [](const char c) { return c == ','; }));
 #endif // NDEBUG
       return TiledArray::expressions::TsrExpr<const DistArray_, true>(*this, vars);
     }
@@ -547,22 +1033,67 @@ namespace TiledArray {
     TiledArray::expressions::TsrExpr<DistArray_, true>
     operator ()(const std::string& vars) {
 #ifndef NDEBUG
-      const unsigned int n = 1u + std::count_if(vars.begin(), vars.end(),
-          [](const char c) { return c == ','; });
-      if(bool(pimpl_) && n != pimpl_->trange().tiles_range().rank()) {
-        if(TiledArray::get_default_world().rank() == 0) {
-          TA_USER_ERROR_MESSAGE( \
-              "The number of array annotation variables is not equal to the array dimension:" \
-              << "\n    number of variables  = " << n \
-              << "\n    array dimension      = " << pimpl_->trange().tiles_range().rank() );
-        }
-
-        TA_EXCEPTION("The number of array annotation variables is not equal to the array dimension.");
-      }
+      check_index_count(1u + std::count_if(vars.begin(), vars.end(),
+          [](const char c) { return c == ','; }));
 #endif // NDEBUG
       return TiledArray::expressions::TsrExpr<DistArray_, true>(*this, vars);
     }
 
+    /// Create a tensor expression with compile-time indices
+
+    /// The indices of \c vars are checked for duplicates at compile time,
+    /// e.g. <tt>a(i, j)</tt> with the indices of \c TiledArray::indices is
+    /// equivalent to <tt>a("i,j")</tt>. The expression is constructed from
+    /// the annotation string of \c vars , so it is evaluated, and its
+    /// variable list parsed, exactly like a string annotation.
+    /// \tparam Is The indices
+    /// \param vars The index list
+    /// \return A const tensor expression object
+    template <typename... Is>
+    TiledArray::expressions::TsrExpr<const DistArray_, true>
+    operator ()(const TiledArray::expressions::IndexList<Is...>& vars) const {
+      check_index_count(vars.size());
+      return TiledArray::expressions::TsrExpr<const DistArray_, true>(*this,
+          vars.string());
+    }
+
+    /// Create a tensor expression with compile-time indices
+
+    /// \tparam Is The indices
+    /// \param vars The index list
+    /// \return A non-const tensor expression object
+    template <typename... Is>
+    TiledArray::expressions::TsrExpr<DistArray_, true>
+    operator ()(const TiledArray::expressions::IndexList<Is...>& vars) {
+      check_index_count(vars.size());
+      return TiledArray::expressions::TsrExpr<DistArray_, true>(*this,
+          vars.string());
+    }
+
+    /// Create a tensor expression with compile-time indices
+
+    /// \tparam Cs The characters of the first index
+    /// \tparam Is The other indices
+    /// \return A const tensor expression object
+    template <char... Cs, typename... Is>
+    TiledArray::expressions::TsrExpr<const DistArray_, true>
+    operator ()(const TiledArray::expressions::Index<Cs...>&, const Is&...) const {
+      return operator()(TiledArray::expressions::IndexList<
+          TiledArray::expressions::Index<Cs...>, Is...>());
+    }
+
+    /// Create a tensor expression with compile-time indices
+
+    /// \tparam Cs The characters of the first index
+    /// \tparam Is The other indices
+    /// \return A non-const tensor expression object
+    template <char... Cs, typename... Is>
+    TiledArray::expressions::TsrExpr<DistArray_, true>
+    operator ()(const TiledArray::expressions::Index<Cs...>&, const Is&...) {
+      return operator()(TiledArray::expressions::IndexList<
+          TiledArray::expressions::Index<Cs...>, Is...>());
+    }
+
     /// \deprecated use DistArray::world()
     DEPRECATED World& get_world() const {
       check_pimpl();
@@ -703,11 +1234,218 @@ namespace TiledArray {
       }
     }
 
+    /// Move the tiles of this array to a new process map
+
+    /// Only the tiles whose owner changes are communicated; tiles that stay
+    /// on the same process are shared with the new array. The tiles sent
+    /// from one process to another are grouped in a single message, and
+    /// they are sent as soon as they are assigned, so this function does not
+    /// wait for pending tiles or for the transfer to complete. Copies of this
+    /// array are not modified. This function is collective.
+    /// \param pmap The new process map
+    /// \throw TiledArray::Exception When this array is lazy, or \c pmap has a
+    /// different size than this array.
+    /// \sa balanced_pmap()
+    void redistribute(const std::shared_ptr<pmap_interface>& pmap) {
+      check_pimpl();
+      TA_USER_ASSERT(pmap && (pmap->size() == size()),
+          "The process map must have the same size as the array.");
+      TA_USER_ASSERT(! is_lazy(), "Lazy arrays cannot be redistributed.");
+      if(pmap == pimpl_->pmap())
+        return;
+
+      DistArray_ result = DistArray_(world(), trange(), shape(), pmap);
+
+      // Move the local, non-zero tiles
+      std::vector<size_type> indices;
+      std::vector<Future<value_type> > tiles;
+      for(const size_type i : *pimpl_->pmap()) {
+        if(pimpl_->is_zero(i))
+          continue;
+        indices.push_back(i);
+        tiles.push_back(pimpl_->get(i));
+      }
+      result.pimpl_->set_bulk(indices, tiles);
+
+      DistArray_::operator=(result);
+    }
+
+    /// Create a view of a block of tiles
+
+    /// The view is an array whose tiles are the tiles of the block
+    /// <tt>[lower_bound, upper_bound)</tt> of this array; its tiled range is
+    /// the tiling of the block shifted to the origin, like the result of a
+    /// block expression. Unlike a block expression, no tile is copied: a
+    /// tile of the view is the tile of this array with a shifted range,
+    /// which shares the data of tiles that support it (see
+    /// \c Tensor::shift() ), and it is held by the owner of the tile of this
+    /// array. Setting a tile of the view, or assigning an expression to it,
+    /// sets the tiles of the block of this array. The view may be used as an
+    /// expression argument, e.g.
+    /// \code
+    /// auto v = a.view({ 2, 0 }, { 4, 3 });
+    /// c("i,j") = v("i,k") * b("k,j");
+    /// v("i,j") = 2 * v("i,j");  // scales the block of a in place
+    /// \endcode
+    /// The shape of the view is the block of the shape of this array when
+    /// the view is created or assigned; it is not updated when the tiles of
+    /// this array are replaced otherwise. This function is collective.
+    /// \tparam Index A coordinate index type
+    /// \param lower_bound The lower bound of the tile block
+    /// \param upper_bound The upper bound of the tile block
+    /// \return A view of the block of this array
+    template <typename Index>
+    DistArray_ view(const Index& lower_bound, const Index& upper_bound) const {
+      check_pimpl();
+      const BlockRange block(pimpl_->trange().tiles_range(), lower_bound,
+          upper_bound);
+
+      // Shift the tiling of the block to the origin
+      const unsigned int rank = block.rank();
+      std::vector<TiledRange1> trange_data;
+      trange_data.reserve(rank);
+      std::vector<std::size_t> trange1_data;
+      for(unsigned int d = 0u; d < rank; ++d) {
+        const TiledRange1& trange1 = pimpl_->trange().data()[d];
+        const auto base_d = trange1.tile(block.lobound(d)).first;
+        trange1_data.emplace_back(0ul);
+        for(auto i = block.lobound(d); i < block.upbound(d); ++i)
+          trange1_data.emplace_back(trange1.tile(i).second - base_d);
+        trange_data.emplace_back(trange1_data.begin(), trange1_data.end());
+        trange1_data.resize(0ul);
+      }
+
+      std::shared_ptr<pmap_interface> pmap =
+          std::make_shared<detail::ViewPmap>(world(), pimpl_->pmap(), block);
+      return DistArray_(std::shared_ptr<impl_type>(new impl_type(pimpl_, block,
+          trange_type(trange_data.begin(), trange_data.end()), pmap),
+          lazy_deleter));
+    }
+
+    /// Create a view of a block of tiles
+
+    /// \tparam Index1 An integral type
+    /// \param lower_bound The lower bound of the tile block
+    /// \param upper_bound The upper bound of the tile block
+    /// \return A view of the block of this array
+    /// \sa view()
+    template <typename Index1>
+    DistArray_ view(const std::initializer_list<Index1>& lower_bound,
+        const std::initializer_list<Index1>& upper_bound) const
+    {
+      return view<std::initializer_list<Index1>>(lower_bound, upper_bound);
+    }
+
+    /// View query
+
+    /// \return \c true if this array is a view of a block of another array
+    /// \sa view()
+    bool is_view() const {
+      check_pimpl();
+      return pimpl_->is_view();
+    }
+
+    /// Viewed array accessor
+
+    /// \return The array that holds the tiles of this view
+    /// \throw TiledArray::Exception When this array is not a view
+    DistArray_ view_parent() const {
+      TA_USER_ASSERT(is_view(), "The array is not a view.");
+      return DistArray_(pimpl_->view_parent());
+    }
+
+    /// Viewed block accessor
+
+    /// \return The block of tiles of \c view_parent() that is held by this
+    /// view
+    /// \throw TiledArray::Exception When this array is not a view
+    const BlockRange& view_block() const {
+      TA_USER_ASSERT(is_view(), "The array is not a view.");
+      return pimpl_->view_block();
+    }
+
+    /// Update the shape of a view
+
+    /// The shape of this view is replaced by the block of the current shape
+    /// of \c view_parent() . This is done by expression assignments to the
+    /// view.
+    /// \throw TiledArray::Exception When this array is not a view
+    void update_view() {
+      TA_USER_ASSERT(is_view(), "The array is not a view.");
+      pimpl_->update_view();
+    }
+
     /// Update shape data and remove tiles that are below the zero threshold
 
     /// \note This function is a no-op for dense arrays.
     void truncate() { TiledArray::truncate(*this); }
 
+    /// Cache the norm of a local tile
+
+    /// Functions that compute the Frobenius norm of a tile when they produce
+    /// it, e.g. \c foreach() and \c make_array() , store the norm with the
+    /// tile so that \c truncate() does not read the tile again. A tile whose
+    /// data is modified after it was set must have its cached norm removed.
+    /// Norms are only cached by sparse arrays.
+    /// \param i The ordinal index of a local tile
+    /// \param norm The Frobenius norm of tile \c i , or a negative value to
+    /// remove the cached norm
+    void tile_norm(const size_type i, const float norm) {
+      check_pimpl();
+      pimpl_->tile_norm(i, norm);
+    }
+
+    /// Cached norm accessor
+
+    /// \param i The ordinal index of a local tile
+    /// \return The cached Frobenius norm of tile \c i , or a negative value
+    /// when it is not cached
+    float tile_norm(const size_type i) const {
+      check_pimpl();
+      return pimpl_->tile_norm(i);
+    }
+
+    /// Replace the shape of this array in place
+
+    /// The local tiles that are non-zero in the current shape and zero in
+    /// \c shape are released. The id, tiled range, and process map of this
+    /// array do not change, and shallow copies of this array share the new
+    /// shape. The expression, lazy tile, and SUMMA broadcast caches, which
+    /// identify arrays by their id, are cleared (see
+    /// \c clear_expression_cache() ), so this function is collective.
+    /// \c shape must be identical on all processes, and it must be
+    /// zero wherever the current shape is zero. The local tiles that are
+    /// released must have been set, and no task may use this array while the
+    /// shape is replaced.
+    /// \param shape The new shape of this array
+    /// \throw TiledArray::Exception When this array is lazy.
+    /// \sa truncate()
+    void update_shape(const shape_type& shape) {
+      check_pimpl();
+      pimpl_->update_shape(shape);
+    }
+
+    /// Replace the shape and release the local tiles of a block
+
+    /// The local tiles of \c block that are non-zero in the current shape
+    /// are released, so the tiles of the block can be set again without
+    /// touching the rest of this array. The id of this array does not
+    /// change, so the expression, lazy tile, and SUMMA broadcast caches,
+    /// which identify arrays by their id, are cleared (see
+    /// \c clear_expression_cache() ), and shallow copies of this array see
+    /// the new block, as they see tiles that are set. This function is
+    /// collective. \c shape must be identical on all processes and identical
+    /// to the current shape outside \c block . Remote tiles of the block must
+    /// not be set before all processes have released their tiles.
+    /// \param block The tile block that is replaced
+    /// \param shape The new shape of this array
+    /// \throw TiledArray::Exception When this array is lazy.
+    /// \sa update_shape()
+    void update_block(const BlockRange& block, const shape_type& shape) {
+      check_pimpl();
+      pimpl_->update_block(block, shape);
+    }
+
     /// Check if the array is initialized
 
     /// \return \c false if the array has been default initialized, otherwise
@@ -739,6 +1477,97 @@ namespace TiledArray {
       check_index<std::initializer_list<Index1>>(i);
     }
 
+    /// Local, non-zero tiles to be initialized
+
+    /// \param skip_set If true, tiles that are already set are skipped
+    /// \return The ordinals of the tiles
+    std::vector<size_type> local_init_indices(const bool skip_set) const {
+      check_pimpl();
+
+      std::vector<size_type> indices;
+      auto it = pimpl_->pmap()->begin();
+      const auto end = pimpl_->pmap()->end();
+      for(; it != end; ++it) {
+        const auto index = *it;
+        if(! pimpl_->is_zero(index)) {
+          if (skip_set) {
+            auto fut = find(index);
+            if (fut.probe())
+              continue;
+          }
+          indices.push_back(index);
+        }
+      }
+
+      return indices;
+    }
+
+    /// Initialize some local tiles with a functor of the tile ordinal
+
+    /// This implements \c init_tiles() ; the signature of the functor is:
+    /// \code
+    /// value_type op(const size_type, const range_type&)
+    /// \endcode
+    /// \tparam Op Tile operation type
+    /// \param indices The ordinals of the tiles to be set, which must be
+    /// local, non-zero tiles that are not set yet
+    /// \param op The operation used to generate tiles
+    template <typename Op>
+    void init_indexed_tiles(const std::vector<size_type>& indices, Op&& op) {
+      check_pimpl();
+#ifndef NDEBUG
+      for(const size_type i : indices) {
+        TA_ASSERT(i < size());
+        TA_ASSERT(is_local(i));
+        TA_ASSERT(! is_zero(i));
+      }
+#endif // NDEBUG
+      if(indices.empty())
+        return;
+
+      auto tiles = std::make_shared<std::vector<Future<value_type> > >(indices.size());
+      pimpl_->set_bulk(indices, *tiles);
+
+      // Generate the tiles in contiguous blocks of indices
+      typedef typename std::decay<Op>::type op_type;
+      auto shared_indices = std::make_shared<std::vector<size_type> >(indices);
+      auto shared_op = std::make_shared<op_type>(std::forward<Op>(op));
+      std::shared_ptr<impl_type> pimpl = pimpl_;
+      const size_type n = indices.size();
+      const size_type tasks = std::min<size_type>(n,
+          4ul * (madness::ThreadPool::size() + 1ul));
+      for(size_type t = 0ul; t < tasks; ++t) {
+        const size_type first = (n * t) / tasks;
+        const size_type last = (n * (t + 1ul)) / tasks;
+        pimpl_->world().taskq.add([pimpl, tiles, shared_indices, shared_op,
+            first, last] () {
+          for(size_type k = first; k < last; ++k) {
+            const size_type index = (*shared_indices)[k];
+            (*tiles)[k].set((*shared_op)(index,
+                pimpl->trange().make_tile_range(index)));
+          }
+        });
+      }
+    }
+
+    /// Check the number of annotation variables of an expression
+
+    /// \param n The number of variables
+    /// \throw TiledArray::Exception When \c n is not equal to the array
+    /// dimension
+    void check_index_count(const unsigned int n) const {
+      if(bool(pimpl_) && n != pimpl_->trange().tiles_range().rank()) {
+        if(TiledArray::get_default_world().rank() == 0) {
+          TA_USER_ERROR_MESSAGE( \
+              "The number of array annotation variables is not equal to the array dimension:" \
+              << "\n    number of variables  = " << n \
+              << "\n    array dimension      = " << pimpl_->trange().tiles_range().rank() );
+        }
+
+        TA_EXCEPTION("The number of array annotation variables is not equal to the array dimension.");
+      }
+    }
+
     /// Makes sure pimpl has been initialized
     void check_pimpl() const {
       TA_USER_ASSERT(pimpl_,
@@ -754,7 +1583,7 @@ namespace TiledArray {
 #ifndef TILEDARRAY_HEADER_ONLY
 
   extern template
-  class DistArray<Tensor<double, Eigen::aligned_allocator<double> >, DensePolicy>;
+  class DistArray<Tensor<double, PoolAllocator<double> >, DensePolicy>;
   extern template
   class DistArray<Tensor<float, Eigen::aligned_allocator<float> >, DensePolicy>;
   extern template
@@ -767,7 +1596,7 @@ namespace TiledArray {
 //  class DistArray<Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >, DensePolicy>
 
   extern template
-  class DistArray<Tensor<double, Eigen::aligned_allocator<double> >, SparsePolicy>;
+  class DistArray<Tensor<double, PoolAllocator<double> >, SparsePolicy>;
   extern template
   class DistArray<Tensor<float, Eigen::aligned_allocator<float> >, SparsePolicy>;
   extern template
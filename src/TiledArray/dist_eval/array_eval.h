@@ -27,7 +27,11 @@
 #define TILEDARRAY_DIST_EVAL_ARRAY_EVAL_H__INCLUDED
 
 #include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/dist_eval/lazy_tile_cache.h>
 #include <TiledArray/block_range.h>
+#include <TiledArray/memory_usage.h>
+#include <TiledArray/tile_interface/clone.h>
+#include <string>
 
 namespace TiledArray {
   namespace detail {
@@ -35,7 +39,10 @@ namespace TiledArray {
     /// Lazy tile for on-the-fly evaluation of array tiles.
 
     /// This tile object is used to hold input array tiles and do on-the-fly
-    /// evaluation, type conversion, and/or permutations.
+    /// evaluation, type conversion, and/or permutations. When the tile has a
+    /// cache key, the converted tile is kept in the lazy tile cache (see
+    /// \c lazy_tile_cache_capacity() ), so that the same conversion of the
+    /// same array tile is done once on this process.
     /// \tparam Tile Array tile type
     /// \tparam Op The operation type
     template <typename Tile, typename Op>
@@ -50,19 +57,25 @@ namespace TiledArray {
       mutable tile_type tile_; ///< The input tile
       std::shared_ptr<op_type> op_; ///< The operation that will be applied to argument tiles
       bool consume_; ///< If true, \c tile_ is consumable
+      std::shared_ptr<const std::string> cache_key_; ///< The cache key of the array and operation, if cached
+      std::size_t index_; ///< The array tile index, used in the cache key
+      std::shared_ptr<TileCache> cache_; ///< The cache of the tile, or null for the lazy tile cache
 
       template <typename T>
       using eval_t = typename eval_trait<typename std::decay<T>::type>::type;
 
     public:
       /// Default constructor
-      LazyArrayTile() : tile_(), op_(), consume_(false) { }
+      LazyArrayTile() :
+        tile_(), op_(), consume_(false), cache_key_(), index_(0ul), cache_()
+      { }
 
       /// Copy constructor
 
       /// \param other The LazyArrayTile object to be copied
       LazyArrayTile(const LazyArrayTile_& other) :
-        tile_(other.tile_), op_(other.op_), consume_(other.consume_)
+        tile_(other.tile_), op_(other.op_), consume_(other.consume_),
+        cache_key_(other.cache_key_), index_(other.index_), cache_(other.cache_)
       { }
 
       /// Construct from tile and operation
@@ -71,7 +84,25 @@ namespace TiledArray {
       /// \param op The operation to be applied to the input tile
       /// \param consume If true, the input tile may be consumed by \c op
       LazyArrayTile(const tile_type& tile, const std::shared_ptr<op_type>& op, const bool consume) :
-        tile_(tile), op_(op), consume_(consume)
+        tile_(tile), op_(op), consume_(consume), cache_key_(), index_(0ul),
+        cache_()
+      { }
+
+      /// Construct from tile and operation, with a cached conversion
+
+      /// \param tile The input tile that will be modified
+      /// \param op The operation to be applied to the input tile
+      /// \param consume If true, the input tile may be consumed by \c op
+      /// \param cache_key The cache key of the array and the operation
+      /// \param index The array tile index
+      /// \param cache The cache of the converted tile, or null for the lazy
+      /// tile cache
+      LazyArrayTile(const tile_type& tile, const std::shared_ptr<op_type>& op,
+          const bool consume, const std::shared_ptr<const std::string>& cache_key,
+          const std::size_t index,
+          const std::shared_ptr<TileCache>& cache = nullptr) :
+        tile_(tile), op_(op), consume_(consume), cache_key_(cache_key),
+        index_(index), cache_(cache)
       { }
 
       /// Assignment operator
@@ -81,6 +112,9 @@ namespace TiledArray {
         tile_ = other.tile_;
         op_ = other.op_;
         consume_ = other.consume_;
+        cache_key_ = other.cache_key_;
+        index_ = other.index_;
+        cache_ = other.cache_;
 
         return *this;
       }
@@ -90,6 +124,40 @@ namespace TiledArray {
       /// \return \c true if this tile is consumable, otherwise \c false .
       bool is_consumable() const { return consume_ || op_->permutation(); }
 
+    private:
+
+      /// Convert tile to evaluation type using the op object
+
+      /// Local tiles with a cache key are converted once and cached, in the
+      /// permutation cache of the array or in the lazy tile cache, and each
+      /// conversion returns a copy of the cached tile (see
+      /// \c share_or_clone() ), so the result remains consumable and the
+      /// cached tile is never modified.
+      /// \return The converted tile
+      auto convert() const {
+        typedef typename std::decay<decltype((*op_)(tile_))>::type result_type;
+        if(cache_key_ && ! (consume_ || Op::is_consumable)) {
+          const std::string key = *cache_key_ + " " + std::to_string(index_);
+          std::shared_ptr<void> cached =
+              (cache_ ? cache_->find(key) : lazy_tile_cache_find(key));
+          if(! cached) {
+            std::shared_ptr<result_type> result =
+                std::make_shared<result_type>((*op_)(tile_));
+            const std::size_t bytes = tile_bytes(*result);
+            if(! (cache_ ? cache_->insert(key, result, bytes) :
+                lazy_tile_cache_insert(key, result, bytes)))
+              return result_type(std::move(*result));
+            cached = result;
+          }
+          return result_type(
+              share_or_clone(*std::static_pointer_cast<result_type>(cached)));
+        }
+        return result_type((!Op::is_consumable) && consume_ ?
+            op_->consume(tile_) : (*op_)(tile_));
+      }
+
+    public:
+
       /// Convert tile to evaluation type using the op object
 #ifdef __clang__  // clang's operator auto behavior is severely broken
                   // (e.g. explicit operator auto() is not considered in conversions,
@@ -98,20 +166,17 @@ namespace TiledArray {
       using conversion_result_type =
           decltype(((!Op::is_consumable) && consume_ ? op_->consume(tile_)
                                                      : (*op_)(tile_)));
-      explicit operator conversion_result_type() const {
-        return ((!Op::is_consumable) && consume_ ? op_->consume(tile_)
-                                                 : (*op_)(tile_));
-      }
+      explicit operator conversion_result_type() const { return convert(); }
 #else
-      explicit operator auto() const {
-        return ((!Op::is_consumable) && consume_ ? op_->consume(tile_)
-                                                 : (*op_)(tile_));
-      }
+      explicit operator auto() const { return convert(); }
 #endif
 
       /// return ref to input tile
       const tile_type& tile() const { return tile_; }
 
+      /// return ref to the tile operation
+      const op_type& op() const { return *op_; }
+
       /// Serialization (not implemented)
 
       /// \tparam Archive The archive type
@@ -158,6 +223,8 @@ namespace TiledArray {
       array_type array_; ///< The array that will be evaluated
       std::shared_ptr<op_type> op_; ///< The tile operation
       BlockRange block_range_; ///< Sub-block range
+      std::shared_ptr<const std::string> cache_key_; ///< The lazy tile cache key, if cached
+      std::shared_ptr<TileCache> cache_; ///< The permutation cache of the array, if used
 
     public:
 
@@ -174,7 +241,8 @@ namespace TiledArray {
           const shape_type& shape, const std::shared_ptr<pmap_interface>& pmap,
           const Permutation& perm, const op_type& op) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
-        array_(array), op_(std::make_shared<op_type>(op)), block_range_()
+        array_(array), op_(std::make_shared<op_type>(op)), block_range_(),
+        cache_key_(), cache_(op.permutation() ? array.permutation_cache() : nullptr)
       { }
 
       /// Constructor with sub-block range
@@ -195,39 +263,47 @@ namespace TiledArray {
           const std::vector<std::size_t>& upper_bound) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
         array_(array), op_(std::make_shared<op_type>(op)),
-        block_range_(array.trange().tiles_range(), lower_bound, upper_bound)
+        block_range_(array.trange().tiles_range(), lower_bound, upper_bound),
+        cache_key_(), cache_(op.permutation() ? array.permutation_cache() : nullptr)
       { }
 
       /// Virtual destructor
       virtual ~ArrayEvalImpl() { }
 
-      virtual Future<value_type> get_tile(size_type i) const {
+      /// Cache the converted tiles
 
-        // Get the array index that corresponds to the target index
-        size_type array_index = DistEvalImpl_::perm_index_to_source(i);
+      /// The converted local tiles are held with \c key , which must identify
+      /// the array and the tile operation, by the permutation cache of the
+      /// array, when the operation permutes tiles and the array has one, or
+      /// otherwise by the lazy tile cache.
+      /// \param key The lazy tile cache key
+      void cache_key(const std::string& key) {
+        cache_key_ = std::make_shared<const std::string>(key);
+      }
 
-        // If this object only uses a sub-block of the array, shift the tile
-        // index to the correct location.
-        if(block_range_.rank())
-          array_index = block_range_.ordinal(array_index);
+      virtual Future<value_type> get_tile(size_type i) const {
+        const size_type array_index = source_index(i);
 
         // Get the tile from array_, which may be located on a remote node.
         Future<typename array_type::value_type> tile =
             array_.find(array_index);
 
-        const bool consumable_tile = ! array_.is_local(array_index);
+        // Remote tiles of a frozen array are cached and shared, so they
+        // cannot be consumed.
+        const bool consumable_tile =
+            ! array_.is_local(array_index) && ! array_.is_frozen();
         // Insert the tile into this evaluator for subsequent processing
         if(tile.probe()) {
           // Skip the task since the tile is ready
           Future<value_type> result;
-          result.set(make_tile(tile, consumable_tile));
+          result.set(make_tile(tile, consumable_tile, array_index));
           const_cast<ArrayEvalImpl_*>(this)->notify();
           return result;
         } else {
           // Spawn a task to set the tile when the input tile is ready.
           Future<value_type> result =
               TensorImpl_::world().taskq.add(shared_from_this(),
-              & ArrayEvalImpl_::make_tile, tile, consumable_tile,
+              & ArrayEvalImpl_::make_tile, tile, consumable_tile, array_index,
               madness::TaskAttributes::hipri());
 
           result.register_callback(const_cast<ArrayEvalImpl_*>(this));
@@ -243,10 +319,38 @@ namespace TiledArray {
         const_cast<ArrayEvalImpl_*>(this)->notify();
       }
 
+      /// Prefetch a tile of the array
+
+      /// Remote tiles are copied into the prefetch cache of the array, and
+      /// local tiles that were spilled to disk are read back.
+      /// \param i The index of the tile
+      virtual void prefetch_tile(size_type i) const {
+        const size_type array_index = source_index(i);
+        array_.prefetch(& array_index, & array_index + 1);
+      }
+
     private:
 
-      value_type make_tile(const typename array_type::value_type& tile, const bool consume) const {
-        return value_type(tile, op_, consume);
+      /// The array ordinal of a tile of this evaluator
+
+      /// \param i The index of the tile
+      /// \return The ordinal of tile \c i in \c array_
+      size_type source_index(const size_type i) const {
+        // Get the array index that corresponds to the target index
+        size_type array_index = DistEvalImpl_::perm_index_to_source(i);
+
+        // If this object only uses a sub-block of the array, shift the tile
+        // index to the correct location.
+        if(block_range_.rank())
+          array_index = block_range_.ordinal(array_index);
+
+        return array_index;
+      }
+
+      value_type make_tile(const typename array_type::value_type& tile,
+          const bool consume, const size_type index) const
+      {
+        return value_type(tile, op_, consume, cache_key_, index, cache_);
       }
 
       /// Make an array tile and insert it into the distributed storage container
@@ -121,7 +121,31 @@ namespace TiledArray {
       /// \param right The right-hand tile
       template <typename L, typename R>
       void eval_tile(const size_type i, L left, R right) {
-        DistEvalImpl_::set_tile(i, op_(left, right));
+        TaskTraceScope trace("binary_eval", i);
+        if(DistEvalImpl_::profile()) {
+          const void* const left_data = tile_data(left);
+          const void* const right_data = tile_data(right);
+          const value_type result = op_(left, right);
+          DistEvalImpl_::profile_in_place(tile_data(result),
+              { left_data, right_data });
+          DistEvalImpl_::set_tile(i, result);
+        } else {
+          DistEvalImpl_::set_tile(i, op_(left, right));
+        }
+      }
+
+      /// Task function for evaluating a batch of small tiles
+
+      /// \param indices The tile indices
+      /// \param left The left-hand tiles
+      /// \param right The right-hand tiles
+      template <typename L, typename R>
+      void eval_tiles(const std::vector<size_type>& indices,
+          std::vector<Future<typename left_type::value_type> > left,
+          std::vector<Future<typename right_type::value_type> > right)
+      {
+        for(std::size_t i = 0ul; i < indices.size(); ++i)
+          eval_tile<L, R>(indices[i], left[i].get(), right[i].get());
       }
 
       /// Evaluate the tiles of this tensor
@@ -152,6 +176,42 @@ namespace TiledArray {
         // Construct local iterator
         TA_ASSERT(left_.pmap() == right_.pmap());
         std::shared_ptr<BinaryEvalImpl_> self = shared_from_this();
+
+        // The batch of small tiles that are evaluated by one task
+        const std::size_t max_batch_volume = tile_batch_volume();
+        std::vector<size_type> batch_indices;
+        std::vector<Future<typename left_type::value_type> > batch_left;
+        std::vector<Future<typename right_type::value_type> > batch_right;
+        std::size_t batch_volume = 0ul;
+        auto submit_batch = [&] () {
+          TensorImpl_::world().taskq.add(self,
+              & BinaryEvalImpl_::template eval_tiles<left_argument_type, right_argument_type>,
+              batch_indices, batch_left, batch_right);
+          batch_indices.clear();
+          batch_left.clear();
+          batch_right.clear();
+          batch_volume = 0ul;
+        };
+
+        // Evaluate a tile where both arguments are non-zero
+        auto eval_nonzero_tile = [&] (const size_type target_index, const size_type source_index) {
+          const std::size_t volume = (max_batch_volume ?
+              TensorImpl_::trange().make_tile_range(target_index).volume() : 0ul);
+          if(volume && (volume < max_batch_volume)) {
+            // Add a small tile to the batch
+            batch_indices.push_back(target_index);
+            batch_left.push_back(left_.get(source_index));
+            batch_right.push_back(right_.get(source_index));
+            batch_volume += volume;
+            if(batch_volume >= max_batch_volume)
+              submit_batch();
+          } else {
+            // Schedule tile evaluation task
+            TensorImpl_::world().taskq.add(self,
+                & BinaryEvalImpl_::template eval_tile<left_argument_type, right_argument_type>,
+                target_index, left_.get(source_index), right_.get(source_index));
+          }
+        };
         typename pmap_interface::const_iterator it = left_.pmap()->begin();
         const typename pmap_interface::const_iterator end = left_.pmap()->end();
 
@@ -162,10 +222,7 @@ namespace TiledArray {
             const size_type source_index = *it;
             const size_type target_index = DistEvalImpl_::perm_index_to_target(source_index);
 
-            // Schedule tile evaluation task
-            TensorImpl_::world().taskq.add(self,
-                & BinaryEvalImpl_::template eval_tile<left_argument_type, right_argument_type>,
-                target_index, left_.get(source_index), right_.get(source_index));
+            eval_nonzero_tile(target_index, source_index);
 
             ++task_count;
           }
@@ -187,9 +244,7 @@ namespace TiledArray {
                   & BinaryEvalImpl_::template eval_tile<left_argument_type, const ZeroTensor>,
                   target_index, left_.get(index), ZeroTensor());
               } else {
-                TensorImpl_::world().taskq.add(self,
-                  & BinaryEvalImpl_::template eval_tile<left_argument_type, right_argument_type>,
-                  target_index, left_.get(index), right_.get(index));
+                eval_nonzero_tile(target_index, index);
               }
 
               ++task_count;
@@ -203,6 +258,9 @@ namespace TiledArray {
           }
         }
 
+        if(! batch_indices.empty())
+          submit_batch();
+
         // Wait for child tensors to be evaluated, and process tasks while waiting.
         left_.wait();
         right_.wait();
@@ -21,12 +21,28 @@
 #define TILEDARRAY_DIST_EVAL_CONTRACTION_EVAL_H__INCLUDED
 
 #include <vector>
-
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <numeric>
+#include <sstream>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <TiledArray/comm_stats.h>
 #include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/dist_eval/summa_bcast_cache.h>
+#include <TiledArray/dist_eval/summa_schedule.h>
+#include <TiledArray/dist_eval/summa_trace.h>
+#include <TiledArray/memory_governor.h>
 #include <TiledArray/proc_grid.h>
 #include <TiledArray/reduce_task.h>
 #include <TiledArray/type_traits.h>
 #include <TiledArray/shape.h>
+#include <TiledArray/tile_interface/add.h>
+#include <TiledArray/tile_compression.h>
+#include <TiledArray/utility.h>
+#include <TiledArray/zero_copy.h>
 
 //#define TILEDARRAY_ENABLE_SUMMA_TRACE_EVAL 1
 //#define TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE 1
@@ -37,6 +53,64 @@
 namespace TiledArray {
   namespace detail {
 
+    /// Bound on the number of concurrent SUMMA iterations
+
+    /// The bound is read from the \c TA_SUMMA_MAX_DEPTH environment variable
+    /// and may be changed at runtime, e.g. to the depth recommended by
+    /// \c recommend_tiling() ; zero means that the depth is not bounded.
+    /// \return A reference to the bound
+    inline std::atomic<std::size_t>& summa_max_depth() {
+      static std::atomic<std::size_t> max_depth([] () -> std::size_t {
+        const char* max_depth = getenv("TA_SUMMA_MAX_DEPTH");
+        if(max_depth)
+          return std::stoul(max_depth);
+        return 0ul;
+      }());
+      return max_depth;
+    }
+
+    /// Number of SUMMA iterations whose argument tiles are prefetched
+
+    /// When the tiles of an iteration are collected, the argument tiles of
+    /// this many later iterations are prefetched from the storage of the
+    /// arguments, e.g. remote tiles, or local tiles that were spilled to
+    /// disk, so that reading them overlaps with the contractions of the
+    /// current iterations. The depth is read from the
+    /// \c TA_SUMMA_PREFETCH_DEPTH environment variable; zero disables
+    /// prefetching. The default is 2.
+    /// \return The prefetch depth
+    inline std::size_t summa_prefetch_depth() {
+      static const std::size_t depth = [] () -> std::size_t {
+        const char* depth = getenv("TA_SUMMA_PREFETCH_DEPTH");
+        if(depth)
+          return std::strtoul(depth, nullptr, 10);
+        return 2ul;
+      }();
+      return depth;
+    }
+
+    /// Pair screening flag of sparse SUMMA
+
+    /// The flag is read from the \c TA_SUMMA_SCREEN environment variable,
+    /// where a nonzero value enables screening, and may be changed at
+    /// runtime; it must have the same value on all processes when a
+    /// contraction is evaluated.
+    /// \return A reference to the flag
+    inline std::atomic<bool>& summa_screen() {
+      static std::atomic<bool> screen([] () -> bool {
+        const char* screen = getenv("TA_SUMMA_SCREEN");
+        return screen && (std::string(screen) != "0");
+      }());
+      return screen;
+    }
+
+    /// The order of the inner iterations of sparse SUMMA
+    enum class SummaOrder {
+      index, ///< Increasing inner tile index
+      norm,  ///< Decreasing bound on the norm of the contribution
+      count  ///< Decreasing number of non-zero tile pairs
+    }; // enum class SummaOrder
+
     /// \brief Distributed contraction evaluator implementation
 
     /// \tparam Left The left-hand argument evaluator type
@@ -47,7 +121,29 @@ namespace TiledArray {
     /// dimensional cyclic distribution, and that the row phase of the left-hand
     /// argument and the column phase of the right-hand argument are equal to
     /// the number of rows and columns, respectively, in the \c ProcGrid object
-    /// passed to the constructor.
+    /// passed to the constructor. When the process grid has more than one
+    /// layer, the arguments must have the layered distribution of
+    /// \c ProcGrid::make_row_phase_pmap() and
+    /// \c ProcGrid::make_col_phase_pmap() ; each layer evaluates SUMMA over
+    /// its block of the inner dimension, and the partial result tiles are
+    /// summed by the first layer. Layered evaluation requires dense shapes.
+    ///
+    /// When \c TA_SUMMA_STEAL is set to a nonzero value, tile pairs are queued
+    /// before they are added to the reduce tasks, and each process steals
+    /// queued pairs from the next process in its process row once all of its
+    /// own pairs have been added. The victim sends the tiles of pairs whose
+    /// operands it already holds; the thief contracts them and sends the
+    /// partial result tiles back, which the victim adds to its result tiles.
+    /// Work stealing requires a single layer and more than one process column.
+    ///
+    /// When pair screening is enabled (see \c summa_screen() ) and all
+    /// shapes are sparse, tile pairs whose contribution to the result is negligible are
+    /// screened out. The contribution of pair \f$(ik, kj)\f$ is estimated from
+    /// the tile norms as in \c SparseShape::gemm() , and a pair is screened
+    /// when it is less than half of the zero threshold divided by the number
+    /// of tiles in the inner dimension, so every non-zero result tile keeps at
+    /// least one pair. Argument tiles that have no significant pair with any
+    /// tile of the other argument are neither broadcast nor contracted.
     template <typename Left, typename Right, typename Op, typename Policy>
     class Summa :
         public DistEvalImpl<typename Op::result_type, Policy>,
@@ -70,7 +166,13 @@ namespace TiledArray {
 
     private:
       static size_type max_memory_; ///< Maximum memory used per node
-      static size_type max_depth_; ///< Maximum number of concurrent SUMMA iterations
+      static bool auto_memory_; ///< Bound memory by the available node memory
+      static constexpr size_type auto_memory_fallback = 1ul << 30;
+          ///< The memory bound when the available node memory is not known
+      static bool steal_; ///< Steal tile pairs from the processes in the same row
+      static SummaOrder order_; ///< The order of the inner iterations of sparse SUMMA
+      static bool uniform_priority_; ///< Reduce tile contractions with a high priority
+      static bool early_release_; ///< Set sparse result tiles after their last step
 
       // Arguments and operation
       left_type left_; ///< The left-hand argument
@@ -84,6 +186,8 @@ namespace TiledArray {
       // Dimension information
       const size_type k_; ///< Number of tiles in the inner dimension
       const ProcGrid proc_grid_; ///< Process grid for this contraction
+      const size_type k_begin_; ///< First inner tile index of this process's layer
+      const size_type k_end_; ///< End of the inner tile range of this process's layer
 
       // Contraction results
       ReducePairTask<op_type>* reduce_tasks_; ///< A pointer to the reduction tasks
@@ -101,6 +205,88 @@ namespace TiledArray {
       typedef Future<typename left_type::eval_type> left_future; ///< Future to a left-hand argument tile
       typedef std::pair<size_type, right_future> row_datum; ///< Datum element type for a right-hand argument row
       typedef std::pair<size_type, left_future> col_datum; ///< Datum element type for a left-hand argument column
+      typedef SummaIterationTracer<col_datum, row_datum> tracer_type; ///< SUMMA iteration tracer type
+
+      /// A tile pair that has not been added to its reduce task
+      struct PendingPair {
+        size_type index; ///< The reduce task index
+        left_future left; ///< The left-hand tile
+        right_future right; ///< The right-hand tile
+        madness::CallbackInterface* callback; ///< The contraction callback
+      }; // struct PendingPair
+
+      /// The tiles of the pairs that are sent to a stealing process
+      struct StolenPairs {
+        std::vector<typename left_type::eval_type> left; ///< The left-hand tiles
+        std::vector<typename right_type::eval_type> right; ///< The right-hand tiles
+
+        template <typename Archive>
+        void serialize(Archive& ar) { ar & left & right; }
+      }; // struct StolenPairs
+
+      /// The pairs that are contracted by a stealing process
+      struct StealBatch {
+        size_type round; ///< The stealing round
+        StolenPairs pairs; ///< The stolen tile pairs
+        std::vector<value_type> results; ///< The partial result tiles
+        std::atomic<size_type> remaining; ///< The number of pairs left to contract
+
+        StealBatch(const size_type r, const StolenPairs& p) :
+          round(r), pairs(p), results(p.left.size()), remaining(p.left.size())
+        { }
+      }; // struct StealBatch
+
+      // Work stealing (empty unless stealing is enabled)
+      const bool stealing_; ///< Stealing is enabled for this contraction
+      madness::Spinlock steal_lock_; ///< Protects the pending and stolen pairs
+      std::deque<PendingPair> pending_; ///< Pairs that wait for a thread
+      std::vector<bool> started_; ///< Reduce tasks that hold at least one pair
+      std::vector<PendingPair> stolen_; ///< Pairs that are evaluated by the thief
+      std::unordered_map<size_type, std::vector<value_type> > stolen_tiles_;
+          ///< Partial result tiles returned by the thief, by reduce task
+      std::atomic<size_type> pending_count_; ///< The number of pairs that have
+          ///< not been reduced or returned, plus one until finalization
+
+      // Pair screening (empty unless screening is enabled)
+      std::vector<bool> left_screen_; ///< Non-zero left tiles without significant pairs or non-zero result tiles
+      std::vector<bool> right_screen_; ///< Non-zero right tiles without significant pairs or non-zero result tiles
+      std::vector<double> pair_threshold_; ///< The smallest significant norm
+          ///< product of the tiles of each inner index
+
+      // Early release of result tiles (empty unless enabled)
+      std::unique_ptr<std::atomic<std::uint32_t>[]> visits_; ///< The number
+          ///< of steps that have not added pairs to each local result tile
+      std::vector<bool> released_; ///< The local result tiles that are set by
+          ///< the last step that adds pairs to them
+
+      // Structured sparsity (empty unless the shapes are structured)
+      std::vector<bool> k_nonzero_; ///< The inner indices where the column of
+          ///< left and the row of right both have non-zero tiles on this process
+
+      // Broadcast cache (empty unless the left-hand argument is cached)
+      typedef std::vector<Future<std::vector<col_datum> > >
+          col_cache_type; ///< The columns of the left-hand argument, by inner index
+      std::shared_ptr<col_cache_type> col_cache_; ///< The cached columns of
+          ///< the inner indices of this process's layer
+      bool col_cache_hit_; ///< The columns were broadcast by a previous contraction
+      std::vector<size_type> k_order_; ///< The inner tile index of each sparse iteration, or empty for increasing order
+
+      // Sparse broadcast groups, by their members
+      static constexpr size_type max_group_key_bits = 62ul; ///< The largest
+          ///< process row or column whose groups are reused
+      mutable madness::Spinlock group_lock_; ///< Protects the broadcast groups
+      mutable std::unordered_map<size_type, madness::Group> groups_; ///< The
+          ///< sparse broadcast groups of this process, by their members
+
+      // Recorded schedule (null unless the engine records it)
+      std::shared_ptr<SummaSchedule> schedule_; ///< The schedule that is
+          ///< replayed and recorded by this contraction
+
+      // Argument prefetch
+      const size_type prefetch_depth_; ///< The number of iterations whose
+          ///< argument tiles are prefetched ahead of their step
+      mutable std::atomic<size_type> prefetched_; ///< The end of the
+          ///< prefetched iterations
 
     protected:
 
@@ -115,7 +301,7 @@ namespace TiledArray {
       /// Initialize max_memory_ limit for SUMMA
       static size_type init_max_memory() {
         const char* max_memory = getenv("TA_SUMMA_MAX_MEMORY");
-        if(max_memory) {
+        if(max_memory && ! init_auto_memory()) {
             // Convert the string into bytes
             std::stringstream ss(max_memory);
             double memory = 0.0;
@@ -148,11 +334,327 @@ namespace TiledArray {
       }
 
 
-      static size_type init_max_depth() {
-        const char* max_depth = getenv("TA_SUMMA_MAX_DEPTH");
-        if(max_depth)
-          return std::stoul(max_depth);
-        return 0ul;
+      /// Initialize auto_memory_ flag for SUMMA
+
+      /// \return \c true when \c TA_SUMMA_MAX_MEMORY is set to \c auto
+      static bool init_auto_memory() {
+        const char* max_memory = getenv("TA_SUMMA_MAX_MEMORY");
+        return max_memory && (std::string(max_memory) == "auto");
+      }
+
+
+      /// Initialize steal_ flag for SUMMA
+
+      /// \return \c true when \c TA_SUMMA_STEAL is set to a nonzero value
+      static bool init_steal() {
+        const char* steal = getenv("TA_SUMMA_STEAL");
+        return steal && (std::string(steal) != "0");
+      }
+
+
+      /// Initialize order_ for SUMMA
+
+      /// \return \c SummaOrder::norm or \c SummaOrder::count when
+      /// \c TA_SUMMA_ORDER is set to \c norm or \c count , respectively,
+      /// otherwise \c SummaOrder::index
+      static SummaOrder init_order() {
+        const char* order = getenv("TA_SUMMA_ORDER");
+        const std::string name = (order ? order : "index");
+        if(name == "norm")
+          return SummaOrder::norm;
+        if(name == "count")
+          return SummaOrder::count;
+        return SummaOrder::index;
+      }
+
+
+      /// Initialize uniform_priority_ flag for SUMMA
+
+      /// By default, the broadcast, step, and finalize tasks have a high
+      /// priority, since the other processes wait on them, and the tasks
+      /// that reduce the tile contractions have the default priority. The
+      /// default priority tasks are run in the order they are submitted, so
+      /// the contractions of the earliest \c k iterations are reduced first,
+      /// while the high priority tasks are run before them. When
+      /// \c TA_SUMMA_PRIORITY is set to \c uniform , all tasks have a high
+      /// priority.
+      /// \return \c true when \c TA_SUMMA_PRIORITY is set to \c uniform
+      static bool init_uniform_priority() {
+        const char* priority = getenv("TA_SUMMA_PRIORITY");
+        return priority && (std::string(priority) == "uniform");
+      }
+
+      /// Initialize early_release_ flag for SUMMA
+
+      /// \return \c false when \c TA_SUMMA_EARLY_RELEASE is set to 0,
+      /// otherwise \c true
+      static bool init_early_release() {
+        const char* release = getenv("TA_SUMMA_EARLY_RELEASE");
+        return ! (release && (std::string(release) == "0"));
+      }
+
+      /// \return The attributes of the tasks that reduce tile contractions
+      static madness::TaskAttributes reduce_attributes() {
+        return (uniform_priority_ ? madness::TaskAttributes::hipri() :
+            madness::TaskAttributes());
+      }
+
+
+      // Pair screening --------------------------------------------------------
+
+      /// Find the inner indices with local non-zero tiles of structured shapes
+
+      /// This is a no-op unless all shapes are structured.
+      template <typename ResultShape, typename LeftShape, typename RightShape>
+      void make_structure(const ResultShape&, const LeftShape&, const RightShape&) { }
+
+      /// Find the inner indices with local non-zero tiles of band shapes
+
+      /// The non-zero tiles of each row of a band shape are a range of
+      /// columns, so the columns of left that have non-zero tiles in the
+      /// rows of this process are marked with a difference array, and the
+      /// rows of right that have non-zero tiles in the columns of this
+      /// process are found in constant time each. This takes
+      /// O(rows + inner) time, instead of the O(rows * inner) checks of
+      /// \c iterate_col() and \c iterate_row() , which are skipped by
+      /// \c search_sparse() .
+      /// \param left The shape of the left-hand argument
+      /// \param right The shape of the right-hand argument
+      void make_structure(const BandShape&, const BandShape& left,
+          const BandShape& right)
+      {
+        const size_type M = proc_grid_.rows();
+        const size_type N = proc_grid_.cols();
+        if((left.range().rank() != 2u) || (right.range().rank() != 2u) ||
+            (M * k_ != left.range().volume()) || (k_ * N != right.range().volume()))
+          return;
+
+        // Count the local rows of left where each column starts and ends
+        std::vector<long> left_count(k_ + 1ul, 0l);
+        for(size_type i = proc_grid_.rank_row(); i < M; i += proc_grid_.proc_rows()) {
+          if(left.first(i) < left.last(i)) {
+            ++left_count[left.first(i)];
+            --left_count[left.last(i)];
+          }
+        }
+
+        const size_type proc_cols = proc_grid_.proc_cols();
+        const size_type rank_col = proc_grid_.rank_col();
+        k_nonzero_.assign(k_, false);
+        long count = 0l;
+        for(size_type k = 0ul; k < k_; ++k) {
+          count += left_count[k];
+          const size_type first = right.first(k);
+          const size_type j = first + (rank_col + proc_cols - first % proc_cols) % proc_cols;
+          k_nonzero_[k] = (count > 0l) && (j < right.last(k));
+        }
+      }
+
+      /// Compute the screened tiles of the arguments
+
+      /// This is a no-op unless all shapes are sparse.
+      template <typename ResultShape, typename LeftShape, typename RightShape>
+      void make_screen(const ResultShape&, const LeftShape&, const RightShape&) { }
+
+      /// Compute the screened tiles of sparse arguments
+
+      /// The norm of the contribution of pair \f$(ik, kj)\f$ to result tile
+      /// \f$ij\f$ is \f$|\alpha| \, a_{ik} b_{kj} s_k^2\f$, where \f$a\f$ and
+      /// \f$b\f$ are the scaled tile norms and \f$s_k\f$ is the volume of the
+      /// inner dimensions of tile \f$k\f$, as in \c SparseShape::gemm() .
+      /// \tparam T The shape value type
+      /// \param left The shape of the left-hand argument
+      /// \param right The shape of the right-hand argument
+      template <typename T>
+      void make_screen(const SparseShape<T>& shape, const SparseShape<T>& left,
+          const SparseShape<T>& right)
+      {
+        if(! summa_screen())
+          return;
+
+        const size_type M = proc_grid_.rows();
+        const size_type N = proc_grid_.cols();
+        const math::GemmHelper& gemm_helper = op_.gemm_helper();
+        const double threshold = 0.5 * double(shape.zero_threshold()) / double(k_);
+        const double factor = std::abs(op_.factor());
+
+        // Compute the significant norm product of each k
+        pair_threshold_.assign(k_, 0.0);
+        for(size_type k = 0ul; k < k_; ++k) {
+          const auto range = left_.trange().make_tile_range(k);
+          double size = 1.0;
+          for(unsigned int d = gemm_helper.left_inner_begin(); d < gemm_helper.left_inner_end(); ++d)
+            size *= double(range.extent_data()[d]);
+          const double weight = factor * size * size;
+          pair_threshold_[k] = (weight > 0.0 ? threshold / weight : 0.0);
+        }
+
+        // The largest norm of each column of left and each row of right
+        std::vector<double> left_max(k_, 0.0), right_max(k_, 0.0);
+        for(size_type i = 0ul, ik = 0ul; i < M; ++i)
+          for(size_type k = 0ul; k < k_; ++k, ++ik)
+            left_max[k] = std::max<double>(left_max[k], left[ik]);
+        for(size_type k = 0ul, kj = 0ul; k < k_; ++k)
+          for(size_type j = 0ul; j < N; ++j, ++kj)
+            right_max[k] = std::max<double>(right_max[k], right[kj]);
+
+        left_screen_.assign(M * k_, false);
+        for(size_type i = 0ul, ik = 0ul; i < M; ++i)
+          for(size_type k = 0ul; k < k_; ++k, ++ik)
+            left_screen_[ik] = (! left.is_zero(ik)) &&
+                (double(left[ik]) * right_max[k] < pair_threshold_[k]);
+        right_screen_.assign(k_ * N, false);
+        for(size_type k = 0ul, kj = 0ul; k < k_; ++k)
+          for(size_type j = 0ul; j < N; ++j, ++kj)
+            right_screen_[kj] = (! right.is_zero(kj)) &&
+                (left_max[k] * double(right[kj]) < pair_threshold_[k]);
+      }
+
+      /// Screen argument tiles that only contribute to zero result tiles
+
+      /// This is a no-op unless the result shape is sparse.
+      template <typename ResultShape>
+      void make_result_screen(const ResultShape&) { }
+
+      /// Screen argument tiles that only contribute to zero result tiles
+
+      /// The non-zero tiles of the left-hand argument in rows of the result
+      /// that have no non-zero tiles, and those of the right-hand argument
+      /// in columns of the result that have no non-zero tiles, are screened,
+      /// so they are neither broadcast nor contracted. Such rows and columns
+      /// are found in results that are masked with \c Expr::set_shape() or
+      /// \c Expr::set_tile_mask() . Unlike the pair screening, this does not
+      /// change the result.
+      /// \tparam T The shape value type
+      /// \param shape The result shape
+      template <typename T>
+      void make_result_screen(const SparseShape<T>& shape) {
+        const size_type M = proc_grid_.rows();
+        const size_type N = proc_grid_.cols();
+
+        std::vector<bool> zero_row(M, true), zero_col(N, true);
+        for(size_type i = 0ul, ij = 0ul; i < M; ++i)
+          for(size_type j = 0ul; j < N; ++j, ++ij)
+            if(! shape.is_zero(DistEvalImpl_::perm_index_to_target(ij))) {
+              zero_row[i] = false;
+              zero_col[j] = false;
+            }
+
+        if(std::find(zero_row.begin(), zero_row.end(), true) != zero_row.end()) {
+          if(left_screen_.empty())
+            left_screen_.assign(M * k_, false);
+          for(size_type i = 0ul; i < M; ++i)
+            if(zero_row[i])
+              for(size_type ik = i * k_; ik < (i + 1ul) * k_; ++ik)
+                if(! left_.shape().is_zero(ik))
+                  left_screen_[ik] = true;
+        }
+        if(std::find(zero_col.begin(), zero_col.end(), true) != zero_col.end()) {
+          if(right_screen_.empty())
+            right_screen_.assign(k_ * N, false);
+          for(size_type j = 0ul; j < N; ++j)
+            if(zero_col[j])
+              for(size_type kj = j; kj < k_ * N; kj += N)
+                if(! right_.shape().is_zero(kj))
+                  right_screen_[kj] = true;
+        }
+      }
+
+      /// Order the inner iterations of sparse SUMMA
+
+      /// This is a no-op unless all shapes are sparse.
+      template <typename ResultShape, typename LeftShape, typename RightShape>
+      void make_order(const ResultShape&, const LeftShape&, const RightShape&) { }
+
+      /// Order the inner iterations of sparse SUMMA
+
+      /// With \c SummaOrder::norm , the iterations are ordered by decreasing
+      /// \f$ s_k^2 \sum_i a_{ik} \sum_j b_{kj} \f$ , which bounds the norm of
+      /// the contribution of iteration \f$k\f$ to the result; with
+      /// \c SummaOrder::count , they are ordered by decreasing number of
+      /// non-zero tile pairs. Screened tiles are not counted. The largest
+      /// contributions are then broadcast and contracted first, which
+      /// balances the load of the processes, and the result tiles are
+      /// complete, up to small contributions, early. The order is computed
+      /// from the shapes, which are equal on all processes, so all processes
+      /// iterate in the same order.
+      /// \tparam T The shape value type
+      /// \param left The shape of the left-hand argument
+      /// \param right The shape of the right-hand argument
+      template <typename T>
+      void make_order(const SparseShape<T>&, const SparseShape<T>& left,
+          const SparseShape<T>& right)
+      {
+        if(order_ == SummaOrder::index)
+          return;
+
+        const size_type M = proc_grid_.rows();
+        const size_type N = proc_grid_.cols();
+        const math::GemmHelper& gemm_helper = op_.gemm_helper();
+
+        std::vector<double> weight(k_, 0.0);
+        for(size_type k = 0ul; k < k_; ++k) {
+          double left_sum = 0.0, right_sum = 0.0;
+          for(size_type ik = k; ik < M * k_; ik += k_)
+            if(! is_zero_left(ik))
+              left_sum += (order_ == SummaOrder::norm ? double(left[ik]) : 1.0);
+          for(size_type kj = k * N; kj < (k + 1ul) * N; ++kj)
+            if(! is_zero_right(kj))
+              right_sum += (order_ == SummaOrder::norm ? double(right[kj]) : 1.0);
+          weight[k] = left_sum * right_sum;
+
+          if(order_ == SummaOrder::norm) {
+            const auto range = left_.trange().make_tile_range(k);
+            double size = 1.0;
+            for(unsigned int d = gemm_helper.left_inner_begin(); d < gemm_helper.left_inner_end(); ++d)
+              size *= double(range.extent_data()[d]);
+            weight[k] *= size * size;
+          }
+        }
+
+        k_order_.resize(k_);
+        for(size_type k = 0ul; k < k_; ++k)
+          k_order_[k] = k;
+        std::stable_sort(k_order_.begin(), k_order_.end(),
+            [&weight] (const size_type l, const size_type r) {
+              return weight[l] > weight[r];
+            });
+      }
+
+      /// The inner tile index of an iteration
+
+      /// \param p The position of the iteration
+      /// \return The inner tile index of iteration \c p
+      size_type k_at(const size_type p) const {
+        return (k_order_.empty() ? p : k_order_[p]);
+      }
+
+      /// Check for a zero or screened tile of \c left_
+
+      /// \param index The index of the tile in \c left_
+      /// \return \c true if the tile is zero or has no significant pair
+      bool is_zero_left(const size_type index) const {
+        return left_.shape().is_zero(index) ||
+            ((! left_screen_.empty()) && left_screen_[index]);
+      }
+
+      /// Check for a zero or screened tile of \c right_
+
+      /// \param index The index of the tile in \c right_
+      /// \return \c true if the tile is zero or has no significant pair
+      bool is_zero_right(const size_type index) const {
+        return right_.shape().is_zero(index) ||
+            ((! right_screen_.empty()) && right_screen_[index]);
+      }
+
+      /// Discard the local argument tiles that are screened out
+      void discard_screened() const {
+        for(size_type index = 0ul; index < left_screen_.size(); ++index)
+          if(left_screen_[index] && left_.is_local(index))
+            left_.discard(index);
+        for(size_type index = 0ul; index < right_screen_.size(); ++index)
+          if(right_screen_[index] && right_.is_local(index))
+            right_.discard(index);
       }
 
 
@@ -160,11 +662,14 @@ namespace TiledArray {
 
       /// Process group factory function
 
-      /// This function generates a sparse process group.
-      /// \tparam Shape The shape type
+      /// This function generates a sparse process group. Groups are reused
+      /// for all k with the same members, so each group is constructed and
+      /// registered once per contraction; the distributed id of a group is
+      /// made from its members, so it is equal on all of them.
+      /// \tparam IsZero The zero tile predicate type
       /// \tparam ProcMap The process map operation type
-      /// \param shape The shape that will be used to select processes that are
-      /// included in the process group
+      /// \param is_zero The zero tile predicate that will be used to select
+      /// processes that are included in the process group
       /// \param process_mask the process mask, if
       ///        \code process_mask[p] == true \endcode,
       ///        process \c p will not be included in the result (p is row/col index
@@ -181,8 +686,8 @@ namespace TiledArray {
       /// index into the absolute process index (ProcessID)
       /// \return A sparse process group that includes process in the row or
       /// column of this process as defined by \c proc_grid_.
-      template <typename Shape, typename ProcMap>
-      madness::Group make_group(const Shape& shape, const std::vector<bool>& process_mask, size_type index,
+      template <typename IsZero, typename ProcMap>
+      madness::Group make_group(const IsZero& is_zero, const std::vector<bool>& process_mask, size_type index,
           const size_type end, const size_type stride, const size_type max_group_size,
           const size_type k, const size_type key_offset, const ProcMap& proc_map) const
       {
@@ -199,23 +704,49 @@ namespace TiledArray {
         for(p = 0ul; (index < end) && (count < max_group_size); index += stride,
             p = (p + 1u) % max_group_size)
         {
-          if((proc_list[p] != -1) || (shape.is_zero(index)) || !process_mask.at(p)) continue;
+          if((proc_list[p] != -1) || (is_zero(index)) || !process_mask.at(p)) continue;
 
           proc_list[p] = proc_map(p);
           ++count;
         }
 
-        // Remove processes from the list that will not be in the group
+        // Groups of grids that are too large for the membership key are not
+        // reused
+        if(max_group_size > max_group_key_bits) {
+          compact_group(proc_list, count);
+          return madness::Group(TensorImpl_::world(), proc_list,
+              madness::DistributedID(DistEvalImpl_::id(), k + key_offset));
+        }
+
+        // The key is the set of members, so it is equal on all members of the
+        // group, for every k with the same members
+        size_type members = 0ul;
+        for(p = 0ul; p < max_group_size; ++p)
+          if(proc_list[p] != -1)
+            members |= size_type(1) << p;
+        const size_type key = 2ul * k_ + ((members << 1) | (key_offset != 0ul ? 1ul : 0ul));
+
+        madness::ScopedMutex<madness::Spinlock> locker(& group_lock_);
+        auto it = groups_.find(key);
+        if(it == groups_.end()) {
+          compact_group(proc_list, count);
+          it = groups_.emplace(key, madness::Group(TensorImpl_::world(),
+              proc_list, madness::DistributedID(DistEvalImpl_::id(), key))).first;
+        }
+        return it->second;
+      }
+
+      /// Remove the processes that are not in a group from its process list
+
+      /// \param proc_list The process list, where processes that are not in
+      /// the group are -1
+      /// \param count The number of processes in the group
+      static void compact_group(std::vector<ProcessID>& proc_list, const size_type count) {
         for(size_type x = 0ul, p = 0ul; x < count; ++p) {
           if(proc_list[p] == -1) continue;
           proc_list[x++] = proc_list[p];
         }
-
-        // Truncate invalid process id's
         proc_list.resize(count);
-
-        return madness::Group(TensorImpl_::world(), proc_list,
-            madness::DistributedID(DistEvalImpl_::id(), k + key_offset));
       }
 
       /// Row process group factory function
@@ -228,11 +759,14 @@ namespace TiledArray {
         const size_type right_end_k = right_begin_k + proc_grid_.cols();
         // make the row mask; using the same mask for all tiles avoids having to compute mask
         // for every tile and use of masked broadcasts
-        auto result_row_mask_k = make_row_mask(k);
+        auto result_row_mask_k = (schedule_ ?
+            schedule_->row_mask(k, [=] () { return make_row_mask(k); }) :
+            make_row_mask(k));
 
         // return empty group if I am not in this group, otherwise make a group
         if (result_row_mask_k[proc_grid_.rank_col()])
-          return make_group(right_.shape(), result_row_mask_k, right_begin_k, right_end_k,
+          return make_group([this] (const size_type i) { return is_zero_right(i); },
+                            result_row_mask_k, right_begin_k, right_end_k,
                             right_stride_, proc_grid_.proc_cols(), k, k_,
                             [&](const ProcGrid::size_type col) { return proc_grid_.map_col(col); });
         else
@@ -248,11 +782,14 @@ namespace TiledArray {
 
         // make the column mask; using the same mask for all tiles avoids having to compute mask
         // for every tile and use of masked broadcasts
-        auto result_col_mask_k = make_col_mask(k);
+        auto result_col_mask_k = (schedule_ ?
+            schedule_->col_mask(k, [=] () { return make_col_mask(k); }) :
+            make_col_mask(k));
 
         // return empty group if I am not in this group, otherwise make a group
         if (result_col_mask_k[proc_grid_.rank_row()])
-          return make_group(left_.shape(), result_col_mask_k, k, left_end_, left_stride_,
+          return make_group([this] (const size_type i) { return is_zero_left(i); },
+                            result_col_mask_k, k, left_end_, left_stride_,
                             proc_grid_.proc_rows(), k, 0ul,
                             [&](const ProcGrid::size_type row) { return proc_grid_.map_row(row); });
         else
@@ -296,7 +833,7 @@ namespace TiledArray {
         for (size_type i = i_start, ik = i_start * nk + k; i < i_fence;
              i += i_stride, ik += ik_stride) {
           // ... such that A[i][k] exists ...
-          if (!left_.shape().is_zero(ik)) {
+          if (!is_zero_left(ik)) {
             // ... the owner of А[i][k] is always in the group ...
             const auto k_proc_col = k % nproc_cols;
             mask[k_proc_col] = true;
@@ -362,7 +899,7 @@ namespace TiledArray {
         for (size_type j = j_start, kj = k * nj + j_start; j < j_fence;
              j += j_stride, kj += kj_stride) {
           // ... such that B[k][j] exists ...
-          if (!right_.shape().is_zero(kj)) {
+          if (!is_zero_right(kj)) {
             // ... the owner of B[k][j] is always in the group ...
             auto k_proc_row = k % nproc_rows;
             mask[k_proc_row] = true;
@@ -471,27 +1008,29 @@ namespace TiledArray {
       /// Collect non-zero tiles from \c arg
 
       /// \tparam Arg The argument type
+      /// \tparam IsZero The zero tile predicate type
       /// \tparam Datum The vector datum type
       /// \param[in] arg The owner of the input tiles
+      /// \param[in] is_zero The zero tile predicate of \c arg
       /// \param[in] index The index of the first tile to be broadcast
       /// \param[in] end The end of the range of tiles to be broadcast
       /// \param[in] stride The stride between tile indices to be broadcast
       /// \param[out] vec The vector that will hold broadcast tiles
-      template <typename Arg, typename Datum>
-      void get_vector(Arg& arg, size_type index, const size_type end,
-          const size_type stride, std::vector<Datum>& vec) const
+      template <typename Arg, typename IsZero, typename Datum>
+      void get_vector(Arg& arg, const IsZero& is_zero, size_type index,
+          const size_type end, const size_type stride, std::vector<Datum>& vec) const
       {
         TA_ASSERT(vec.size() == 0ul);
 
         // Iterate over vector of tiles
         if(arg.is_local(index)) {
           for(size_type i = 0ul; index < end; ++i, index += stride) {
-            if(arg.shape().is_zero(index)) continue;
+            if(is_zero(index)) continue;
             vec.emplace_back(i, get_tile(arg, index));
           }
         } else {
           for(size_type i = 0ul; index < end; ++i, index += stride) {
-            if(arg.shape().is_zero(index)) continue;
+            if(is_zero(index)) continue;
             vec.emplace_back(i, Future<typename Arg::eval_type>());
           }
         }
@@ -499,13 +1038,85 @@ namespace TiledArray {
         TA_ASSERT(vec.size() > 0ul);
       }
 
+      /// Prefetch a vector of tiles of an argument
+
+      /// \tparam Arg The argument type
+      /// \tparam IsZero The zero tile predicate type
+      /// \param arg The owner of the tiles
+      /// \param is_zero The zero tile predicate of \c arg
+      /// \param index The index of the first tile
+      /// \param end The end of the range of tiles
+      /// \param stride The stride between tile indices
+      template <typename Arg, typename IsZero>
+      static void prefetch_vector(const Arg& arg, const IsZero& is_zero,
+          size_type index, const size_type end, const size_type stride)
+      {
+        if(arg.is_local(index))
+          for(; index < end; index += stride)
+            if(! is_zero(index))
+              arg.prefetch(index);
+      }
+
+      /// Prefetch the argument tiles of the iterations after iteration \c p
+
+      /// The local tiles of the columns of \c left_ and the rows of
+      /// \c right_ of the next \c prefetch_depth_ iterations, in the order of
+      /// \c k_at() , are prefetched from the storage of the arguments, so
+      /// they are in memory when the step tasks of these iterations collect
+      /// them. Iterations that were prefetched before are skipped. Sparse
+      /// iterations that the search skips are prefetched too, but only their
+      /// non-zero tiles are read.
+      /// \param p The position of the iteration whose tiles are collected
+      void prefetch(const size_type p) const {
+        if(prefetch_depth_ == 0ul)
+          return;
+
+        // Claim the iterations that were not prefetched yet
+        const size_type last = std::min(p + 1ul + prefetch_depth_, k_end_);
+        size_type first = prefetched_.load();
+        do {
+          if(first >= last)
+            return;
+        } while(! prefetched_.compare_exchange_weak(first, last));
+        first = std::max(first, p + 1ul);
+
+        for(; first < last; ++first) {
+          const size_type k = k_at(first);
+          if(! col_cache_hit_)
+            prefetch_vector(left_, [this] (const size_type i) { return is_zero_left(i); },
+                left_start_local_ + k, left_end_, left_stride_local_);
+          const size_type begin = k * proc_grid_.cols();
+          prefetch_vector(right_, [this] (const size_type i) { return is_zero_right(i); },
+              begin + proc_grid_.rank_col(), begin + proc_grid_.cols(),
+              right_stride_local_);
+        }
+      }
+
       /// Collect non-zero tiles from column \c k of \c left_
 
       /// \param[in] k The column to be retrieved
       /// \param[out] col The column vector that will hold the tiles
       void get_col(const size_type k, std::vector<col_datum>& col) const {
         col.reserve(proc_grid_.local_rows());
-        get_vector(left_, left_start_local_ + k, left_end_, left_stride_local_, col);
+        get_vector(left_, [this] (const size_type i) { return is_zero_left(i); },
+            left_start_local_ + k, left_end_, left_stride_local_, col);
+
+        // Hold the column, which is completed by its broadcast, for later
+        // contractions
+        if(col_cache_)
+          (*col_cache_)[k - k_begin_].set(col);
+      }
+
+      /// Discard the local tiles of column \c k of \c left_
+
+      /// The tiles are not needed when the column is held by the broadcast
+      /// cache.
+      /// \param[in] k The column to be discarded
+      void discard_col(const size_type k) const {
+        size_type index = left_start_local_ + k;
+        if(left_.is_local(index))
+          for(; index < left_end_; index += left_stride_local_)
+            left_.discard(index);
       }
 
       /// Collect non-zero tiles from row \c k of \c right_
@@ -520,19 +1131,60 @@ namespace TiledArray {
         const size_type end = begin + proc_grid_.cols();
         begin += proc_grid_.rank_col();
 
-        get_vector(right_, begin, end, right_stride_local_, row);
+        get_vector(right_, [this] (const size_type i) { return is_zero_right(i); },
+            begin, end, right_stride_local_, row);
+      }
+
+      /// Broadcast tile \c index of \c arg
+
+      /// Tensor tiles are compressed when a tile codec is selected; otherwise
+      /// large tensor tiles are broadcast with the zero-copy protocol, along
+      /// a tree or a pipelined chain (see \c detail::bcast_algorithm() ). The
+      /// tile volume is computed from the tiled range of \c arg , so that all
+      /// processes in \c group select the same protocol.
+      /// \tparam Arg The argument type
+      /// \param[in] arg The owner of the input tile
+      /// \param[in] index The index of the tile to be broadcast
+      /// \param[in] key The broadcast key
+      /// \param[in,out] tile The tile that will be broadcast
+      /// \param[in] group The process group where the tile will be broadcast
+      /// \param[in] group_root The root process of the broadcast
+      template <typename Arg>
+      void bcast_tile(const Arg& arg, const size_type index,
+          const madness::DistributedID& key, Future<typename Arg::eval_type>& tile,
+          const madness::Group& group, const ProcessID group_root) const
+      {
+        TaskTraceScope trace("summa_bcast", index);
+        const std::size_t volume = arg.trange().make_tile_range(index).volume();
+        const std::size_t bytes =
+            volume * sizeof(typename Arg::eval_type::value_type);
+        if(group.rank() == group_root) {
+          if(DistEvalImpl_::profile())
+            DistEvalImpl_::profile()->add_bytes(bytes * (group.size() - 1));
+          if(comm_stats_enabled())
+            comm_stats_record(CommCategory::summa_bcast, group.size() - 1,
+                bytes * (group.size() - 1));
+        } else {
+          comm_stats_track(CommCategory::summa_bcast, tile,
+              [bytes] (const typename Arg::eval_type&) { return bytes; });
+        }
+        if(! compressed_bcast(TensorImpl_::world(), key, tile, group_root, group, volume))
+          zero_copy_bcast(TensorImpl_::world(), key, tile, group_root, group, volume);
       }
 
       /// Broadcast tiles from \c arg
 
+      /// \tparam Arg The argument type
+      /// \tparam Datum The vector datum type
+      /// \param[in] arg The owner of the input tiles
       /// \param[in] start The index of the first tile to be broadcast
       /// \param[in] stride The stride between tile indices to be broadcast
       /// \param[in] group The process group where the tiles will be broadcast
       /// \param[in] group_root The root process of the broadcast
       /// \param[in] key_offset The broadcast key offset value
       /// \param[out] vec The vector that will hold broadcast tiles
-      template <typename Datum>
-      void bcast(const size_type start, const size_type stride,
+      template <typename Arg, typename Datum>
+      void bcast(const Arg& arg, const size_type start, const size_type stride,
           const madness::Group& group, const ProcessID group_root,
           const size_type key_offset, std::vector<Datum>& vec) const
       {
@@ -557,7 +1209,7 @@ namespace TiledArray {
 
           // Broadcast the tile
           const madness::DistributedID key(DistEvalImpl_::id(), index + key_offset);
-          TensorImpl_::world().gop.bcast(key, it->second, group_root, group);
+          bcast_tile(arg, index, key, it->second, group, group_root);
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_BCAST
           ss  << index << " ";
@@ -578,7 +1230,7 @@ namespace TiledArray {
       ProcessID get_row_group_root(const size_type k, const madness::Group& row_group) const {
         ProcessID group_root = k % proc_grid_.proc_cols();
         if(! right_.shape().is_dense() && row_group.size() < static_cast<ProcessID>(proc_grid_.proc_cols())) {
-          const ProcessID world_root = proc_grid_.rank_row() * proc_grid_.proc_cols() + group_root;
+          const ProcessID world_root = proc_grid_.map_col(group_root);
           group_root = row_group.rank(world_root);
         }
         return group_root;
@@ -587,7 +1239,7 @@ namespace TiledArray {
       ProcessID get_col_group_root(const size_type k, const madness::Group& col_group) const {
         ProcessID group_root = k % proc_grid_.proc_rows();
         if(! left_.shape().is_dense() && col_group.size() < static_cast<ProcessID>(proc_grid_.proc_rows())) {
-          const ProcessID world_root = group_root * proc_grid_.proc_cols() + proc_grid_.rank_col();
+          const ProcessID world_root = proc_grid_.map_row(group_root);
           group_root = col_group.rank(world_root);
         }
         return group_root;
@@ -598,11 +1250,13 @@ namespace TiledArray {
       /// \param[in] k The column of \c left_ to be broadcast
       /// \param[out] col The vector that will hold the results of the broadcast
       void bcast_col(const size_type k, std::vector<col_datum>& col, const madness::Group& row_group) const {
-        // broadcast if I'm part of the broadcast group
-        if (!row_group.empty()) {
+        // broadcast if I'm part of the broadcast group, and the column was not
+        // broadcast by a previous contraction
+        if (!row_group.empty() && !col_cache_hit_) {
           // Broadcast column k of left_.
           ProcessID group_root = get_row_group_root(k, row_group);
-          bcast(left_start_local_ + k, left_stride_local_, row_group, group_root, 0ul, col);
+          bcast(left_, left_start_local_ + k, left_stride_local_, row_group,
+              group_root, 0ul, col);
         }
       }
 
@@ -617,17 +1271,19 @@ namespace TiledArray {
           ProcessID group_root = get_col_group_root(k, col_group);
 
           // Broadcast row k of right_.
-          bcast(k * proc_grid_.cols() + proc_grid_.rank_col(),
+          bcast(right_, k * proc_grid_.cols() + proc_grid_.rank_col(),
                 right_stride_local_, col_group, group_root, left_.size(), row);
         }
       }
 
-      void bcast_col_range_task(size_type k, const size_type end) const {
-        // Compute the first local row of right
+      void bcast_col_range_task(size_type p, const size_type end) const {
         const size_type Pcols = proc_grid_.proc_cols();
-        k += (Pcols - ((k + Pcols - proc_grid_.rank_col()) % Pcols)) % Pcols;
 
-        for(; k < end; k += Pcols) {
+        for(; p < end; ++p) {
+          // Skip the columns of left that are not local
+          const size_type k = k_at(p);
+          if((k % Pcols) != proc_grid_.rank_col())
+            continue;
 
           // Compute local iteration limits for column k of left_.
           size_type index = left_start_local_ + k;
@@ -640,7 +1296,7 @@ namespace TiledArray {
 
           // Search column k of left for non-zero tiles
           for(; index < left_end_; index += left_stride_local_) {
-            if(left_.shape().is_zero(index)) continue;
+            if(is_zero_left(index)) continue;
 
             // Construct broadcast group, if needed
             if (!have_group) {
@@ -656,7 +1312,7 @@ namespace TiledArray {
               // Broadcast the tile
               const madness::DistributedID key(DistEvalImpl_::id(), index);
               auto tile = get_tile(left_, index);
-              TensorImpl_::world().gop.bcast(key, tile, group_root, row_group);
+              bcast_tile(left_, index, key, tile, row_group, group_root);
             } else {
               // Discard the tile
               left_.discard(index);
@@ -665,12 +1321,14 @@ namespace TiledArray {
         }
       }
 
-      void bcast_row_range_task(size_type k, const size_type end) const {
-        // Compute the first local row of right
+      void bcast_row_range_task(size_type p, const size_type end) const {
         const size_type Prows = proc_grid_.proc_rows();
-        k += (Prows - ((k + Prows - proc_grid_.rank_row()) % Prows)) % Prows;
 
-        for(; k < end; k += Prows) {
+        for(; p < end; ++p) {
+          // Skip the rows of right that are not local
+          const size_type k = k_at(p);
+          if((k % Prows) != proc_grid_.rank_row())
+            continue;
 
           // Compute local iteration limits for row k of right_.
           size_type index = k * proc_grid_.cols();
@@ -685,7 +1343,7 @@ namespace TiledArray {
 
           // Search for and broadcast non-zero row
           for(; index < row_end; index += right_stride_local_) {
-            if(right_.shape().is_zero(index)) continue;
+            if(is_zero_right(index)) continue;
 
             // Construct broadcast group
             if (!have_group) {
@@ -701,7 +1359,7 @@ namespace TiledArray {
               // Broadcast the tile
               const madness::DistributedID key(DistEvalImpl_::id(), index + left_.size());
               auto tile = get_tile(right_, index);
-              TensorImpl_::world().gop.bcast(key, tile, group_root, col_group);
+              bcast_tile(right_, index, key, tile, col_group, group_root);
             } else {
               // Discard the tile
               right_.discard(index);
@@ -715,46 +1373,48 @@ namespace TiledArray {
 
       /// Find next non-zero row of \c right_ for a sparse shape
 
-      /// Starting at the k-th row of the right-hand argument, find the next row
-      /// that contains at least one non-zero tile. This search only checks for
-      /// non-zero tiles in this processes column.
-      /// \param k The first row to search
-      /// \return The first row, greater than or equal to \c k with non-zero
-      /// tiles, or \c k_ if none is found.
-      size_type iterate_row(size_type k) const {
+      /// Starting at the row of the right-hand argument of iteration \c p ,
+      /// find the next iteration whose row contains at least one non-zero
+      /// tile; see \c k_at() . This search only checks for non-zero tiles in
+      /// this processes column.
+      /// \param p The first iteration to search
+      /// \return The first iteration, greater than or equal to \c p with
+      /// non-zero tiles, or \c k_end_ if none is found.
+      size_type iterate_row(size_type p) const {
         // Iterate over k's until a non-zero tile is found or the end of the
         // matrix is reached.
-        size_type end = k * proc_grid_.cols();
-        for(; k < k_; ++k) {
+        for(; p < k_end_; ++p) {
           // Search for non-zero tiles in row k of right
-          size_type i = end + proc_grid_.rank_col();
-          end += proc_grid_.cols();
-          for(; i < end; i += right_stride_local_)
-            if(! right_.shape().is_zero(i))
-              return k;
+          const size_type begin = k_at(p) * proc_grid_.cols();
+          const size_type end = begin + proc_grid_.cols();
+          for(size_type i = begin + proc_grid_.rank_col(); i < end; i += right_stride_local_)
+            if(! is_zero_right(i))
+              return p;
         }
 
-        return k;
+        return p;
       }
 
       /// Find the next non-zero column of \c left_ for an arbitrary shape type
 
-      /// Starting at the k-th column of the left-hand argument, find the next
-      /// column that contains at least one non-zero tile. This search only
-      /// checks for non-zero tiles in this process's row.
-      /// \param k The first column to test for non-zero tiles
-      /// \return The first column, greater than or equal to \c k, that contains
-      /// a non-zero tile. If no non-zero tile is not found, return \c k_.
-      size_type iterate_col(size_type k) const {
+      /// Starting at the column of the left-hand argument of iteration \c p ,
+      /// find the next iteration whose column contains at least one non-zero
+      /// tile; see \c k_at() . This search only checks for non-zero tiles in
+      /// this process's row.
+      /// \param p The first iteration to test for non-zero tiles
+      /// \return The first iteration, greater than or equal to \c p, that
+      /// contains a non-zero tile. If no non-zero tile is not found, return
+      /// \c k_end_.
+      size_type iterate_col(size_type p) const {
         // Iterate over k's until a non-zero tile is found or the end of the
         // matrix is reached.
-        for(; k < k_; ++k)
-          // Search row k for non-zero tiles
-          for(size_type i = left_start_local_ + k; i < left_end_; i += left_stride_local_)
-            if(! left_.shape().is_zero(i))
-              return k;
+        for(; p < k_end_; ++p)
+          // Search column k for non-zero tiles
+          for(size_type i = left_start_local_ + k_at(p); i < left_end_; i += left_stride_local_)
+            if(! is_zero_left(i))
+              return p;
 
-        return k;
+        return p;
       }
 
 
@@ -764,11 +1424,46 @@ namespace TiledArray {
       /// arguments, respectively, that both contain non-zero tiles. This search
       /// only checks for non-zero tiles in this process's row or column. If a
       /// non-zero, local tile is found that does not contribute to local
-      /// contractions, the tiles will be immediately broadcast.
-      /// \param k The first row/column to check
-      /// \return The next k-th column and row of the left- and right-hand
-      /// arguments, respectively, that both have non-zero tiles
+      /// contractions, the tiles will be immediately broadcast. Iterations
+      /// are counted in the order of \c k_at() . The search is replayed from
+      /// the recorded schedule, if it holds the result.
+      /// \param k The first iteration to check
+      /// \return The next iteration where the column and row of the left- and
+      /// right-hand arguments, respectively, both have non-zero tiles
       size_type iterate_sparse(const size_type k) const {
+        const size_type k_row = (schedule_ ?
+            schedule_->step(k, [=] () { return search_sparse(k); }) :
+            search_sparse(k));
+
+        if(k < k_row) {
+          // Spawn a task to broadcast any local columns of left that were skipped
+          TensorImpl_::world().taskq.add(shared_from_this(),
+              & Summa_::bcast_col_range_task, k, k_row,
+              madness::TaskAttributes::hipri());
+
+          // Spawn a task to broadcast any local rows of right that were skipped
+          TensorImpl_::world().taskq.add(shared_from_this(),
+              & Summa_::bcast_row_range_task, k, k_row,
+              madness::TaskAttributes::hipri());
+        }
+
+        return k_row;
+      }
+
+      /// Search for the next k where the left- and right-hand argument have non-zero tiles
+
+      /// \param k The first iteration to check
+      /// 
+eturn The next iteration where the column and row of the left- and
+      /// right-hand arguments, respectively, both have non-zero tiles
+      size_type search_sparse(const size_type k) const {
+        if(! k_nonzero_.empty()) {
+          size_type p = k;
+          while((p < k_end_) && ! k_nonzero_[k_at(p)])
+            ++p;
+          return p;
+        }
+
         // Initial step for k_col and k_row.
         size_type k_col = iterate_col(k);
         size_type k_row = iterate_row(k_col);
@@ -782,18 +1477,6 @@ namespace TiledArray {
           }
         }
 
-        if(k < k_row) {
-          // Spawn a task to broadcast any local columns of left that were skipped
-          TensorImpl_::world().taskq.add(shared_from_this(),
-              & Summa_::bcast_col_range_task, k, k_row,
-              madness::TaskAttributes::hipri());
-
-          // Spawn a task to broadcast any local rows of right that were skipped
-          TensorImpl_::world().taskq.add(shared_from_this(),
-              & Summa_::bcast_row_range_task, k, k_col,
-              madness::TaskAttributes::hipri());
-        }
-
         return k_col;
       }
 
@@ -841,13 +1524,22 @@ namespace TiledArray {
         std::allocator<ReducePairTask<op_type> > alloc;
         reduce_tasks_ = alloc.allocate(proc_grid_.local_size());
 
+        // Initialize iteration variables
+        size_type row_start = proc_grid_.rank_row() * proc_grid_.cols();
+        size_type row_end = row_start + proc_grid_.cols();
+        row_start += proc_grid_.rank_col();
+        const size_type col_stride = // The stride to iterate down a column
+            proc_grid_.proc_rows() * proc_grid_.cols();
+        const size_type row_stride = // The stride to iterate across a row
+            proc_grid_.proc_cols();
+        const size_type end = TensorImpl_::size();
+
         // Iterate over all local tiles
-        const size_type n = proc_grid_.local_size();
-        for(size_type t = 0ul; t < n; ++t) {
-          // Initialize the reduction task
-          ReducePairTask<op_type>* MADNESS_RESTRICT const reduce_task = reduce_tasks_ + t;
-          new(reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_);
-        }
+        ReducePairTask<op_type>* MADNESS_RESTRICT reduce_task = reduce_tasks_;
+        for(; row_start < end; row_start += col_stride, row_end += col_stride)
+          for(size_type index = row_start; index < row_end; index += row_stride, ++reduce_task)
+            // Initialize the reduction task
+            make_reduce_task(reduce_task, index);
 
         return proc_grid_.local_size();
       }
@@ -892,7 +1584,7 @@ namespace TiledArray {
               ss << index << " ";
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
-              new(reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_);
+              make_reduce_task(reduce_task, index);
               ++tile_count;
             } else {
               // Construct an empty task to represent zero tiles.
@@ -906,9 +1598,85 @@ namespace TiledArray {
         printf(ss.str().c_str());
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
+        // Screened tiles are never broadcast, so release them
+        discard_screened();
+
+        make_visits();
+
         return tile_count;
       }
 
+      /// Count the steps that add pairs to each local result tile
+
+      /// A step adds pairs to the result tiles of the rows of its column of
+      /// \c left_ and of the columns of its row of \c right_ that have
+      /// non-zero tiles on this process, see \c get_col() and \c get_row() .
+      /// The count of each non-zero result tile is decremented by
+      /// \c release_visit() when a step has added its pairs, and the tile is
+      /// set when the count reaches zero, instead of by \c finalize() after
+      /// the last step. The tiles are then available to the evaluator that
+      /// uses this contraction, e.g. the SUMMA of an outer contraction
+      /// <tt>(a * b) * c</tt> , which broadcasts them and releases them
+      /// as soon as they are set. Tiles without pairs are set by
+      /// \c finalize() . Counting takes time proportional to the number of
+      /// tile pairs of this process. Early release is not used with work
+      /// stealing, since stolen pairs are added to the result after the last
+      /// step, and it is disabled by setting \c TA_SUMMA_EARLY_RELEASE to 0.
+      void make_visits() {
+        if(! early_release_ || stealing_ || (proc_grid_.proc_layers() != 1ul))
+          return;
+
+        const size_type local_rows = proc_grid_.local_rows();
+        const size_type local_cols = proc_grid_.local_cols();
+        const size_type N = proc_grid_.cols();
+        const size_type right_start = proc_grid_.rank_col();
+        std::vector<std::uint32_t> visits(local_rows * local_cols, 0u);
+        std::vector<size_type> rows, cols;
+        rows.reserve(local_rows);
+        cols.reserve(local_cols);
+        for(size_type k = 0ul; k < k_; ++k) {
+          rows.clear();
+          for(size_type t = 0ul; t < local_rows; ++t)
+            if(! is_zero_left(left_start_local_ + k + t * left_stride_local_))
+              rows.push_back(t);
+          if(rows.empty())
+            continue;
+          cols.clear();
+          for(size_type t = 0ul; t < local_cols; ++t)
+            if(! is_zero_right(k * N + right_start + t * right_stride_local_))
+              cols.push_back(t);
+          for(const size_type row : rows)
+            for(const size_type col : cols)
+              ++visits[row * local_cols + col];
+        }
+
+        visits_.reset(new std::atomic<std::uint32_t>[visits.size()]);
+        released_.assign(visits.size(), false);
+        for(size_type r = 0ul; r < visits.size(); ++r) {
+          visits_[r] = visits[r];
+          released_[r] = (visits[r] > 0u) && bool(reduce_tasks_[r]);
+        }
+      }
+
+      /// Record that a step has added its pairs to a result tile
+
+      /// The result tile is set after the last step that adds pairs to it;
+      /// see \c make_visits() .
+      /// \param index The reduce task index of the result tile
+      void release_visit(const size_type index) {
+        if(! released_.empty() && released_[index] &&
+            (visits_[index].fetch_sub(1u) == 1u))
+        {
+          const size_type local_cols = proc_grid_.local_cols();
+          const size_type row = proc_grid_.rank_row() +
+              (index / local_cols) * proc_grid_.proc_rows();
+          const size_type col = proc_grid_.rank_col() +
+              (index % local_cols) * proc_grid_.proc_cols();
+          set_result_tile(DistEvalImpl_::perm_index_to_target(
+              row * proc_grid_.cols() + col), submit(reduce_tasks_ + index));
+        }
+      }
+
       size_type initialize() {
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
         printf("init: start rank=%i\n", TensorImpl_::world().rank());
@@ -926,6 +1694,112 @@ namespace TiledArray {
 
       // Finalize functions ----------------------------------------------------
 
+      /// Add two partial result tiles
+
+      /// \param left The left-hand partial result tile
+      /// \param right The right-hand partial result tile
+      /// \return The sum of \c left and \c right
+      static value_type add_partial(const value_type& left, const value_type& right) {
+        using TiledArray::add;
+        return add(left, right);
+      }
+
+      /// Permute the initial value of a result tile
+
+      /// \param tile The initial value of the result tile
+      /// \param perm The permutation that is applied to \c tile
+      /// \return The permuted tile
+      static value_type permute_seed(const value_type& tile, const Permutation& perm) {
+        using TiledArray::permute;
+        return permute(tile, perm);
+      }
+
+      /// Construct the reduction task of a result tile
+
+      /// If the tile operation has a seed for the result tile, the reduction
+      /// accumulates the contraction into the seed, instead of a new tile.
+      /// Only the first layer of the process grid is seeded, since the
+      /// partial results of the other layers are added to it.
+      /// \param reduce_task The memory of the reduction task
+      /// \param index The (unpermuted) index of the result tile
+      void make_reduce_task(ReducePairTask<op_type>* const reduce_task,
+          const size_type index)
+      {
+        Future<value_type> seed;
+        if(op_.seed() && (proc_grid_.rank_layer() == 0ul) &&
+            op_.seed()(DistEvalImpl_::perm_index_to_target(index), seed))
+        {
+          // The seed is given in the layout of the final result
+          if(op_.perm())
+            seed = TensorImpl_::world().taskq.add(& Summa_::permute_seed, seed,
+                op_.perm().inv(), madness::TaskAttributes::hipri());
+          new(reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_,
+              seed, nullptr, reduce_attributes());
+        } else {
+          new(reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_,
+              nullptr, reduce_attributes());
+        }
+      }
+
+      /// Apply the epilogue of the tile operation to a result tile
+
+      /// \param op The tile operation
+      /// \param tile The result tile
+      /// \return \c tile , after the epilogue was applied in place
+      static value_type apply_epilogue(const op_type& op, const value_type& tile) {
+        value_type result = tile;
+        op.epilogue()(result);
+        return result;
+      }
+
+      /// Set a result tile
+
+      /// If the tile operation has an epilogue, it is applied to the tile in
+      /// a high priority task as soon as the tile has been computed, while
+      /// the tile is in cache, and before the tile is set.
+      /// \param index The (permuted) index of the result tile
+      /// \param tile The result tile
+      void set_result_tile(const size_type index, Future<value_type> tile) {
+        if(op_.epilogue())
+          tile = TensorImpl_::world().taskq.add(& Summa_::apply_epilogue, op_,
+              tile, madness::TaskAttributes::hipri());
+        DistEvalImpl_::set_tile(index, tile);
+      }
+
+      /// Sum the partial result tiles of a layered contraction
+
+      /// The partial result tiles of all layers are sent to the process with
+      /// the same row and column in the first layer, which sums them and sets
+      /// the result tile.
+      /// \param index The (permuted) index of the result tile
+      /// \param partial The partial result tile of this process's layer
+      void reduce_layers(const size_type index, Future<value_type> partial) {
+        // The partial tile keys follow the keys used by the argument broadcasts.
+        const size_type key_offset = left_.size() + right_.size();
+        const size_type layer = proc_grid_.rank_layer();
+
+        if(layer != 0ul) {
+          // Send the partial tile to the first layer
+          const madness::DistributedID key(DistEvalImpl_::id(),
+              key_offset + (layer - 1ul) * TensorImpl_::size() + index);
+          TensorImpl_::world().gop.send(proc_grid_.map_layer(0ul), key, partial);
+        } else {
+          // Sum the partial tiles of the other layers
+          const size_type layers = proc_grid_.proc_layers();
+          for(size_type l = 1ul; l < layers; ++l) {
+            const madness::DistributedID key(DistEvalImpl_::id(),
+                key_offset + (l - 1ul) * TensorImpl_::size() + index);
+            Future<value_type> remote = TensorImpl_::world().gop.template
+                recv<value_type>(proc_grid_.map_layer(l), key);
+            partial = TensorImpl_::world().taskq.add(& Summa_::add_partial,
+                partial, remote, madness::TaskAttributes::hipri());
+          }
+
+          // Set the result tile
+          set_result_tile(index, partial);
+        }
+      }
+
       /// Set the result tiles, destroy reduce tasks, and destroy broadcast groups
       void finalize(const DenseShape&) {
         // Initialize iteration variables
@@ -942,11 +1816,15 @@ namespace TiledArray {
         for(ReducePairTask<op_type>* reduce_task = reduce_tasks_;
             row_start < end; row_start += col_stride, row_end += col_stride) {
           for(size_type index = row_start; index < row_end; index += row_stride, ++reduce_task) {
+            const size_type perm_index = DistEvalImpl_::perm_index_to_target(index);
 
-
-            // Set the result tile
-            DistEvalImpl_::set_tile(DistEvalImpl_::perm_index_to_target(index),
-                reduce_task->submit());
+            if(proc_grid_.proc_layers() == 1ul) {
+              // Set the result tile
+              set_result_tile(perm_index, submit(reduce_task));
+            } else {
+              // Sum the partial result tiles of the layers
+              reduce_layers(perm_index, reduce_task->submit());
+            }
 
             // Destroy the reduce task
             reduce_task->~ReducePairTask<op_type>();
@@ -984,15 +1862,16 @@ namespace TiledArray {
             // Compute the permuted index
             const size_type perm_index = DistEvalImpl_::perm_index_to_target(index);
 
-            // Skip zero tiles
-            if(! shape.is_zero(perm_index)) {
+            // Skip zero tiles, and tiles that were set by their last step
+            if(! shape.is_zero(perm_index) && (released_.empty() ||
+                ! released_[reduce_task - reduce_tasks_])) {
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
               ss << index << " ";
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
 
               // Set the result tile
-              DistEvalImpl_::set_tile(perm_index, reduce_task->submit());
+              set_result_tile(perm_index, submit(reduce_task));
             }
 
             // Destroy the reduce task
@@ -1010,7 +1889,27 @@ namespace TiledArray {
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
       }
 
-      void finalize() {
+      /// Submit a reduce task
+
+      /// The partial result tiles that were contracted by a stealing process
+      /// are added to the result of the reduce task.
+      /// \param reduce_task The reduce task of a result tile
+      /// \return The result tile
+      Future<value_type> submit(ReducePairTask<op_type>* const reduce_task) {
+        Future<value_type> result = reduce_task->submit();
+        if(stealing_) {
+          const auto it = stolen_tiles_.find(reduce_task - reduce_tasks_);
+          if(it != stolen_tiles_.end()) {
+            for(const value_type& partial : it->second)
+              result = TensorImpl_::world().taskq.add(& Summa_::add_partial,
+                  result, partial, madness::TaskAttributes::hipri());
+            stolen_tiles_.erase(it);
+          }
+        }
+        return result;
+      }
+
+      void finalize_tiles() {
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
         printf("finalize: start rank=%i\n", TensorImpl_::world().rank());
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
@@ -1022,6 +1921,18 @@ namespace TiledArray {
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
       }
 
+      /// Set the result tiles once all tile pairs have been added
+
+      /// When work stealing is enabled, the result tiles are set after the
+      /// pending pairs have been added to their reduce tasks and the stolen
+      /// pairs have been returned.
+      void finalize() {
+        if(stealing_)
+          release_pending();
+        else
+          finalize_tiles();
+      }
+
       /// SUMMA finalization task
 
       /// This task will set the tiles and do cleanup.
@@ -1044,17 +1955,221 @@ namespace TiledArray {
 
       // Contraction functions -------------------------------------------------
 
+      /// Add a tile pair to a reduce task
+
+      /// When work stealing is enabled, the pair is queued and it is added to
+      /// the reduce task by a separate task, so that it may be stolen while it
+      /// waits for a thread.
+      /// \param index The reduce task index
+      /// \param left The left-hand tile
+      /// \param right The right-hand tile
+      /// \param callback The callback that is invoked when the pair has been
+      /// contracted
+      void add_pair(const size_type index, const left_future& left,
+          const right_future& right, madness::CallbackInterface* const callback)
+      {
+        if(stealing_) {
+          pending_count_.fetch_add(1ul);
+          {
+            madness::ScopedMutex<madness::Spinlock> locker(& steal_lock_);
+            pending_.push_back(PendingPair{ index, left, right, callback });
+          }
+          TensorImpl_::world().taskq.add(shared_from_this(),
+              & Summa_::add_pending_pair);
+        } else {
+          reduce_tasks_[index].add(left, right, callback);
+        }
+      }
+
+      /// Add the oldest pending pair to its reduce task
+      void add_pending_pair() {
+        PendingPair pair;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& steal_lock_);
+          // The pair of this task may have been stolen
+          if(pending_.empty())
+            return;
+          pair = pending_.front();
+          pending_.pop_front();
+          started_[pair.index] = true;
+        }
+        reduce_tasks_[pair.index].add(pair.left, pair.right, pair.callback);
+        release_pending();
+      }
+
+      /// Release a pending pair, and set the result tiles after the last one
+
+      /// Once all pairs have been added, this process starts to steal pairs
+      /// from the next process in its row.
+      void release_pending() {
+        if(pending_count_.fetch_sub(1ul) == 1ul) {
+          finalize_tiles();
+          steal(0ul);
+        }
+      }
+
+
+      // Work stealing functions -----------------------------------------------
+
+      /// \return The process that this process steals pairs from
+      ProcessID steal_victim() const {
+        return proc_grid_.map_col((proc_grid_.rank_col() + 1ul) % proc_grid_.proc_cols());
+      }
+
+      /// \return The process that steals pairs from this process
+      ProcessID steal_thief() const {
+        return proc_grid_.map_col((proc_grid_.rank_col() + proc_grid_.proc_cols() - 1ul)
+            % proc_grid_.proc_cols());
+      }
+
+      /// Work stealing message key
+
+      /// The keys follow the keys used by the argument broadcasts.
+      /// \param round The stealing round
+      /// \param message The message of the round: the request (0), the stolen
+      /// pairs (1), or the partial result tiles (2)
+      /// \return The key of \c message in \c round
+      madness::DistributedID steal_key(const size_type round, const size_type message) const {
+        return madness::DistributedID(DistEvalImpl_::id(),
+            left_.size() + right_.size() + 3ul * round + message);
+      }
+
+      /// Wait for a stealing request from the thief
+      /// \param round The stealing round
+      void steal_listen(const size_type round) {
+        Future<bool> request = TensorImpl_::world().gop.template
+            recv<bool>(steal_thief(), steal_key(round, 0ul));
+        TensorImpl_::world().taskq.add(shared_from_this(), & Summa_::steal_reply,
+            round, request, madness::TaskAttributes::hipri());
+      }
+
+      /// Send pending pairs to the thief
+
+      /// Up to half of the pending pairs are stolen, newest first; only pairs
+      /// whose tiles are held by this process, and whose reduce task already
+      /// holds another pair, are sent. The stealing ends when no pairs are sent.
+      /// \param round The stealing round
+      void steal_reply(const size_type round, const bool) {
+        StolenPairs pairs;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& steal_lock_);
+          const size_type max_pairs = (pending_.size() + 1ul) / 2ul;
+          for(auto it = pending_.end(); (it != pending_.begin()) &&
+              (stolen_.size() < max_pairs);)
+          {
+            --it;
+            if(started_[it->index] && it->left.probe() && it->right.probe()) {
+              pairs.left.push_back(it->left.get());
+              pairs.right.push_back(it->right.get());
+              stolen_.push_back(*it);
+              it = pending_.erase(it);
+            }
+          }
+        }
+
+        TensorImpl_::world().gop.send(steal_thief(), steal_key(round, 1ul), pairs);
+
+        if(! pairs.left.empty()) {
+          Future<std::vector<value_type> > results = TensorImpl_::world().gop.template
+              recv<std::vector<value_type> >(steal_thief(), steal_key(round, 2ul));
+          TensorImpl_::world().taskq.add(shared_from_this(), & Summa_::steal_receive,
+              round, results, madness::TaskAttributes::hipri());
+        }
+      }
+
+      /// Store the partial result tiles of the stolen pairs
+
+      /// \param round The stealing round
+      /// \param results The partial result tiles of the pairs sent in \c round
+      void steal_receive(const size_type round, const std::vector<value_type>& results) {
+        std::vector<PendingPair> stolen;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& steal_lock_);
+          stolen.swap(stolen_);
+          TA_ASSERT(stolen.size() == results.size());
+          for(size_type n = 0ul; n < stolen.size(); ++n)
+            stolen_tiles_[stolen[n].index].push_back(results[n]);
+        }
+
+        steal_listen(round + 1ul);
+        for(const PendingPair& pair : stolen) {
+          if(pair.callback)
+            pair.callback->notify();
+          release_pending();
+        }
+      }
+
+      /// Request pairs from the victim
+      /// \param round The stealing round
+      void steal(const size_type round) {
+        TensorImpl_::world().gop.send(steal_victim(), steal_key(round, 0ul), true);
+        Future<StolenPairs> pairs = TensorImpl_::world().gop.template
+            recv<StolenPairs>(steal_victim(), steal_key(round, 1ul));
+        TensorImpl_::world().taskq.add(shared_from_this(), & Summa_::steal_run,
+            round, pairs, madness::TaskAttributes::hipri());
+      }
+
+      /// Contract the stolen pairs
+      /// \param round The stealing round
+      /// \param pairs The pairs sent by the victim
+      void steal_run(const size_type round, const StolenPairs& pairs) {
+        if(pairs.left.empty())
+          return; // The victim has no pending pairs
+
+        std::shared_ptr<StealBatch> batch = std::make_shared<StealBatch>(round, pairs);
+        for(size_type n = 0ul; n < pairs.left.size(); ++n)
+          TensorImpl_::world().taskq.add(shared_from_this(),
+              & Summa_::steal_contract, batch, n);
+      }
+
+      /// Contract a stolen pair
+
+      /// The partial result tiles are sent to the victim once all pairs of
+      /// \c batch are contracted, and then more pairs are requested.
+      /// \param batch The stolen pairs
+      /// \param n The pair to be contracted
+      void steal_contract(const std::shared_ptr<StealBatch>& batch, const size_type n) {
+        value_type result = op_();
+        op_(result, batch->pairs.left[n], batch->pairs.right[n]);
+        batch->results[n] = op_(result);
+
+        if(batch->remaining.fetch_sub(1ul) == 1ul) {
+          TensorImpl_::world().gop.send(steal_victim(),
+              steal_key(batch->round, 2ul), batch->results);
+          steal(batch->round + 1ul);
+        }
+      }
+
+      /// Count the flops of a scheduled tile contraction
+
+      /// \param k The k step of the contraction
+      /// \param i The local index of the left tile in its column
+      /// \param j The local index of the right tile in its row
+      void profile_pair(const size_type k, const size_type i,
+          const size_type j) const
+      {
+        integer m = 0, n = 0, kk = 0;
+        op_.gemm_helper().compute_matrix_sizes(m, n, kk,
+            left_.trange().make_tile_range(left_start_local_ + k +
+                (i * left_stride_local_)),
+            right_.trange().make_tile_range(k * proc_grid_.cols() +
+                proc_grid_.rank_col() + (j * right_stride_local_)));
+        DistEvalImpl_::profile()->add_flops(2ull * m * n * kk);
+      }
+
       /// Schedule local contraction tasks for \c col and \c row tile pairs
 
       /// Schedule tile contractions for each tile pair of \c row and \c col. A
       /// callback to \c task will be registered with each tile contraction
       /// task.
+      /// \param k The k step for this contraction set
       /// \param col A column of tiles from the left-hand argument
       /// \param row A row of tiles from the right-hand argument
       /// \param task The task that depends on tile contraction tasks
-      void contract(const DenseShape&, const size_type,
+      /// \param tracer The iteration tracer, or \c nullptr if tracing is disabled
+      void contract(const DenseShape&, const size_type k,
           const std::vector<col_datum>& col, const std::vector<row_datum>& row,
-          madness::TaskInterface* const task)
+          madness::TaskInterface* const task, tracer_type* const tracer)
       {
         // Iterate over the row
         for(size_type i = 0ul; i < col.size(); ++i) {
@@ -1070,7 +2185,10 @@ namespace TiledArray {
               task->inc();
             const left_future left = col[i].second;
             const right_future right = row[j].second;
-            reduce_tasks_[reduce_task_index].add(left, right, task);
+            add_pair(reduce_task_index, left, right,
+                (tracer ? tracer->contraction() : task));
+            if(DistEvalImpl_::profile())
+              profile_pair(k, col[i].first, row[j].first);
           }
         }
       }
@@ -1080,13 +2198,15 @@ namespace TiledArray {
       /// Schedule tile contractions for each tile pair of \c row and \c col. A
       /// callback to \c task will be registered with each tile contraction
       /// task.
+      /// \param k The k step for this contraction set
       /// \param col A column of tiles from the left-hand argument
       /// \param row A row of tiles from the right-hand argument
       /// \param task The task that depends on tile contraction tasks
+      /// \param tracer The iteration tracer, or \c nullptr if tracing is disabled
       template <typename Shape>
-      void contract(const Shape&, const size_type,
+      void contract(const Shape&, const size_type k,
           const std::vector<col_datum>& col, const std::vector<row_datum>& row,
-          madness::TaskInterface* const task)
+          madness::TaskInterface* const task, tracer_type* const tracer)
       {
         // Iterate over the row
         for(size_type i = 0ul; i < col.size(); ++i) {
@@ -1098,79 +2218,110 @@ namespace TiledArray {
             const size_type reduce_task_index = reduce_task_offset + row[j].first;
 
             // Skip zero tiles
-            if(! reduce_tasks_[reduce_task_index])
+            if(! reduce_tasks_[reduce_task_index]) {
+              if(tracer)
+                tracer->skip();
               continue;
+            }
 
             // Schedule task for contraction pairs
             if(task)
               task->inc();
             const left_future left = col[i].second;
             const right_future right = row[j].second;
-            reduce_tasks_[reduce_task_index].add(left, right, task);
+            add_pair(reduce_task_index, left, right,
+                (tracer ? tracer->contraction() : task));
+            if(DistEvalImpl_::profile())
+              profile_pair(k, col[i].first, row[j].first);
+            release_visit(reduce_task_index);
           }
         }
       }
 
-#define TILEDARRAY_DISABLE_TILE_CONTRACTION_FILTER
-#ifndef TILEDARRAY_DISABLE_TILE_CONTRACTION_FILTER
       /// Schedule local contraction tasks for \c col and \c row tile pairs
 
       /// Schedule tile contractions for each tile pair of \c row and \c col. A
       /// callback to \c task will be registered with each tile contraction
       /// task. This version of contract is used when shape_type is
-      /// \c SparseShape. It skips tile contractions that have a negligible
-      /// contribution to the result tile.
+      /// \c SparseShape. When pair screening is enabled, it skips tile
+      /// contractions that have a negligible contribution to the result tile;
+      /// see \c make_screen() .
       /// \tparam T The shape value type
       /// \param k The k step for this contraction set
       /// \param col A column of tiles from the left-hand argument
       /// \param row A row of tiles from the right-hand argument
       /// \param task The task that depends on the tile contraction tasks
+      /// \param tracer The iteration tracer, or \c nullptr if tracing is disabled
       template <typename T>
       typename std::enable_if<std::is_floating_point<T>::value>::type
-      contract(const SparseShape<T>&, const size_type k,
+      contract(const SparseShape<T>& shape, const size_type k,
           const std::vector<col_datum>& col, const std::vector<row_datum>& row,
-          madness::TaskInterface* const task)
+          madness::TaskInterface* const task, tracer_type* const tracer)
       {
+        if(pair_threshold_.empty()) {
+          contract<SparseShape<T> >(shape, k, col, row, task, tracer);
+          return;
+        }
+
         // Cache row shape data.
-        std::vector<typename SparseShape<T>::value_type> row_shape_values;
+        std::vector<double> row_shape_values;
         row_shape_values.reserve(row.size());
         const size_type row_start = k * proc_grid_.cols() + proc_grid_.rank_col();
         for(size_type j = 0ul; j < row.size(); ++j)
           row_shape_values.push_back(right_.shape()[row_start + (row[j].first * right_stride_local_)]);
 
         const size_type col_start = left_start_local_ + k;
-        const float threshold_k = TensorImpl_::shape().threshold() / typename SparseShape<T>::value_type(k_);
+        const double threshold_k = pair_threshold_[k];
         // Iterate over the row
         for(size_type i = 0ul; i != col.size(); ++i) {
           // Compute the local, result-tile offset
           const size_type offset = col[i].first * proc_grid_.local_cols();
 
           // Get the shape data for col_it tile
-          const typename SparseShape<T>::value_type col_shape_value =
+          const double col_shape_value =
               left_.shape()[col_start + (col[i].first * left_stride_local_)];
 
           // Iterate over columns
           for(size_type j = 0ul; j < row.size(); ++j) {
-            if((col_shape_value * row_shape_values[j]) < threshold_k)
-              continue;
-
             const size_type reduce_task_index = offset + row[j].first;
 
+            if((col_shape_value * row_shape_values[j]) < threshold_k) {
+              if(tracer)
+                tracer->skip();
+              release_visit(reduce_task_index);
+              continue;
+            }
+
             // Skip zero tiles
-            if(! reduce_tasks_[reduce_task_index])
+            if(! reduce_tasks_[reduce_task_index]) {
+              if(tracer)
+                tracer->skip();
               continue;
+            }
 
             if(task)
               task->inc();
-            reduce_tasks_[reduce_task_index].add(col[i].second, row[j].second, task);
+            add_pair(reduce_task_index, col[i].second, row[j].second,
+                (tracer ? tracer->contraction() : task));
+            if(DistEvalImpl_::profile())
+              profile_pair(k, col[i].first, row[j].first);
+            release_visit(reduce_task_index);
           }
         }
       }
-#endif // TILEDARRAY_DISABLE_TILE_CONTRACTION_FILTER
 
       void contract(const size_type k, const std::vector<col_datum>& col,
           const std::vector<row_datum>& row, madness::TaskInterface* const task)
-      { contract(TensorImpl_::shape(), k, col, row, task); }
+      {
+        if(SummaTrace::instance().enabled()) {
+          tracer_type* const tracer = new tracer_type(DistEvalImpl_::id(), k,
+              col, row, proc_grid_.local_rows() + proc_grid_.local_cols(), task);
+          contract(TensorImpl_::shape(), k, col, row, task, tracer);
+          tracer->release();
+        } else {
+          contract(TensorImpl_::shape(), k, col, row, task, nullptr);
+        }
+      }
 
 
       // SUMMA step task -------------------------------------------------------
@@ -1201,6 +2352,12 @@ namespace TiledArray {
           this->notify();
         }
 
+        void set_col(const size_type k, const std::vector<col_datum>& col) {
+          owner_->discard_col(k);
+          col_ = col;
+          this->notify();
+        }
+
       public:
 
         StepTask(const std::shared_ptr<Summa_>& owner, int finalize_ndep) :
@@ -1228,9 +2385,15 @@ namespace TiledArray {
         virtual ~StepTask() { }
 
         void spawn_get_row_col_tasks(const size_type k) {
-          // Submit the task to collect column tiles of left for iteration k
+          // Submit the task to collect column tiles of left for iteration k,
+          // or to use the column held by the broadcast cache
           madness::DependencyInterface::inc();
-          world_.taskq.add(this, & StepTask::get_col, k, madness::TaskAttributes::hipri());
+          if(owner_->col_cache_hit_)
+            world_.taskq.add(this, & StepTask::set_col, k,
+                (*owner_->col_cache_)[k - owner_->k_begin_],
+                madness::TaskAttributes::hipri());
+          else
+            world_.taskq.add(this, & StepTask::get_col, k, madness::TaskAttributes::hipri());
 
           // Submit the task to collect row tiles of right for iteration k
           madness::DependencyInterface::inc();
@@ -1241,8 +2404,9 @@ namespace TiledArray {
         void make_next_step_tasks(Derived* task, size_type depth) {
           TA_ASSERT(depth > 0);
           // Set the depth to be no greater than the maximum number steps
-          if(depth > owner_->k_)
-            depth = owner_->k_;
+          const size_type steps = owner_->k_end_ - owner_->k_begin_;
+          if(depth > steps)
+            depth = steps;
 
           // Spawn the first (depth - 1) step tasks
           for(; depth > 0ul; --depth) {
@@ -1257,11 +2421,12 @@ namespace TiledArray {
 
         template <typename Derived, typename GroupType>
         void run(const size_type k, const GroupType& row_group, const GroupType& col_group) {
+          TaskTraceScope trace("summa_step", k);
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_STEP
           printf("step:  start rank=%i k=%lu\n", owner_->world().rank(), k);
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_STEP
 
-          if(k < owner_->k_) {
+          if(k < owner_->k_end_) {
             // Initialize next tail task and submit next task
             TA_ASSERT(next_step_task_);
             next_step_task_->tail_step_task_ =
@@ -1315,18 +2480,22 @@ namespace TiledArray {
 
       public:
         DenseStepTask(const std::shared_ptr<Summa_>& owner, const size_type depth) :
-          StepTask(owner, owner->k_ + 1ul), k_(0)
+          StepTask(owner, owner->k_end_ - owner->k_begin_ + 1ul),
+          k_(owner->k_begin_)
         {
           StepTask::make_next_step_tasks(this, depth);
           StepTask::spawn_get_row_col_tasks(k_);
+          owner_->prefetch(k_);
         }
 
         DenseStepTask(DenseStepTask* const parent, const int ndep) :
           StepTask(parent, ndep), k_(parent->k_ + 1ul)
         {
           // Spawn tasks to get k-th row and column tiles
-          if(k_ < owner_->k_)
+          if(k_ < owner_->k_end_) {
             StepTask::spawn_get_row_col_tasks(k_);
+            owner_->prefetch(k_);
+          }
         }
 
         virtual ~DenseStepTask() { }
@@ -1338,7 +2507,8 @@ namespace TiledArray {
 
       class SparseStepTask : public StepTask {
       protected:
-        Future<size_type> k_{};
+        Future<size_type> p_{}; ///< The position of this iteration in the k order
+        Future<size_type> k_{}; ///< The inner tile index of this iteration
         Future<madness::Group> row_group_{};
         Future<madness::Group> col_group_{};
         using StepTask::owner_;
@@ -1349,17 +2519,21 @@ namespace TiledArray {
       private:
 
         /// Spawn task to construct process groups and get tiles.
-        void iterate_task(size_type k, const size_type offset) {
+        void iterate_task(const size_type p, const size_type offset) {
           // Search for the next non-zero row and column
-          k = owner_->iterate_sparse(k + offset);
+          const size_type next = owner_->iterate_sparse(p + offset);
+          const size_type k = (next < owner_->k_end_ ? owner_->k_at(next) : next);
+          p_.set(next);
           k_.set(k);
 
-          if(k < owner_->k_) {
+          if(k < owner_->k_end_) {
             // NOTE: The order of task submissions is dependent on the order in
             // which we want the tasks to complete.
 
-            // Spawn tasks to get k-th row and column tiles
+            // Spawn tasks to get k-th row and column tiles, and prefetch the
+            // tiles of the next iterations
             StepTask::spawn_get_row_col_tasks(k);
+            owner_->prefetch(next);
 
             // Spawn tasks to construct the row and column broadcast group
             row_group_ = world_.taskq.add(owner_, & Summa_::make_row_group, k,
@@ -1386,20 +2560,21 @@ namespace TiledArray {
           // Spawn a task to find the next non-zero iteration
           madness::DependencyInterface::inc();
           world_.taskq.add(this, & SparseStepTask::iterate_task,
-              0ul, 0ul, madness::TaskAttributes::hipri());
+              owner_->k_begin_, 0ul, madness::TaskAttributes::hipri());
         }
 
         SparseStepTask(SparseStepTask* const parent, const int ndep) :
           StepTask(parent, ndep)
         {
-          if(parent->k_.probe() && (parent->k_.get() >= owner_->k_)) {
+          if(parent->p_.probe() && (parent->p_.get() >= owner_->k_end_)) {
             // Avoid running extra tasks if not needed.
-            k_.set(parent->k_.get());
+            p_.set(parent->p_.get());
+            k_.set(parent->p_.get());
           } else {
             // Spawn a task to find the next non-zero iteration
             madness::DependencyInterface::inc();
             world_.taskq.add(this, & SparseStepTask::iterate_task,
-                parent->k_, 1ul, madness::TaskAttributes::hipri());
+                parent->p_, 1ul, madness::TaskAttributes::hipri());
           }
         }
 
@@ -1425,28 +2600,94 @@ namespace TiledArray {
       /// \param k The number of tiles in the inner dimension
       /// \param proc_grid The process grid that defines the layout of the tiles
       ///                  during the contraction evaluation
+      /// \param schedule The schedule of previous evaluations of the same
+      ///                 contraction, which is replayed and completed by this
+      ///                 evaluation, or null
       /// \note The trange, shape, and pmap refer to the final,
       ///       permuted, state for the result, NOT to the result during
       ///       the SUMMA evaluation.
       Summa(const left_type& left, const right_type& right,
           World& world, const trange_type trange, const shape_type& shape,
           const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
-          const op_type& op, const size_type k, const ProcGrid& proc_grid) :
+          const op_type& op, const size_type k, const ProcGrid& proc_grid,
+          const std::shared_ptr<SummaSchedule>& schedule =
+              std::shared_ptr<SummaSchedule>()) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
         left_(left), right_(right), op_(op),
         row_group_(), col_group_(),
         k_(k), proc_grid_(proc_grid),
+        k_begin_(proc_grid_.layer_inner_begin(k)),
+        k_end_(proc_grid_.layer_inner_end(k)),
         reduce_tasks_(NULL),
         left_start_local_(proc_grid_.rank_row() * k),
         left_end_(left.size()),
         left_stride_(k),
         left_stride_local_(proc_grid.proc_rows() * k),
         right_stride_(1ul),
-        right_stride_local_(proc_grid.proc_cols())
-      { }
+        right_stride_local_(proc_grid.proc_cols()),
+        stealing_(steal_ && (proc_grid_.proc_layers() == 1ul) &&
+            (proc_grid_.proc_cols() > 1ul) && (proc_grid_.local_size() > 0ul)),
+        steal_lock_(), pending_(), started_(), stolen_(), stolen_tiles_(),
+        pending_count_(1ul), left_screen_(), right_screen_(), pair_threshold_(),
+        visits_(), released_(), k_nonzero_(), col_cache_(), col_cache_hit_(false), k_order_(), group_lock_(),
+        groups_(), schedule_(schedule),
+        prefetch_depth_(summa_prefetch_depth()), prefetched_(0ul)
+      {
+        TA_ASSERT((proc_grid_.proc_layers() == 1ul) || shape.is_dense());
+        make_structure(shape, left_.shape(), right_.shape());
+        if(schedule_ && schedule_->replay_screen(left_screen_, right_screen_,
+            pair_threshold_, k_order_))
+          return;
+
+        make_screen(shape, left_.shape(), right_.shape());
+        make_result_screen(shape);
+        make_order(shape, left_.shape(), right_.shape());
+        if(schedule_)
+          schedule_->record_screen(left_screen_, right_screen_,
+              pair_threshold_, k_order_);
+      }
 
       virtual ~Summa() { }
 
+      /// Reuse the broadcasts of the left-hand argument
+
+      /// The columns of the left-hand argument that this process holds after
+      /// their broadcasts are added to the SUMMA broadcast cache (see
+      /// \c summa_bcast_cache_capacity() ), with a key that identifies the
+      /// argument and the process grid. If the cache already holds them, from
+      /// a previous contraction, the columns are neither collected nor
+      /// broadcast. Only dense contractions are cached. This function must be
+      /// called by all processes before this object is evaluated.
+      /// \param key The key that identifies the left-hand argument and the
+      /// operation that converts its tiles
+      void bcast_cache_key(const std::string& key) {
+        if(! (left_.shape().is_dense() && right_.shape().is_dense() &&
+            TensorImpl_::shape().is_dense()))
+          return;
+
+        std::ostringstream ss;
+        ss << key << " " << typeid(typename left_type::eval_type).name()
+            << " grid=" << proc_grid_.rows() << "x" << proc_grid_.cols() << ":"
+            << proc_grid_.proc_rows() << "x" << proc_grid_.proc_cols() << "x"
+            << proc_grid_.proc_layers() << " k=" << k_;
+
+        std::shared_ptr<void> cached = summa_bcast_cache_find(ss.str());
+        if(cached) {
+          col_cache_ = std::static_pointer_cast<col_cache_type>(cached);
+          col_cache_hit_ = true;
+        } else {
+          // The size is estimated from the tiled range, so that it is equal on
+          // all processes
+          typedef typename numeric_type<typename left_type::eval_type>::type
+              left_numeric_type;
+          col_cache_ = std::make_shared<col_cache_type>(k_end_ - k_begin_);
+          if(! summa_bcast_cache_insert(ss.str(), col_cache_,
+              left_.trange().elements_range().volume() * sizeof(left_numeric_type) /
+              proc_grid_.proc_rows()))
+            col_cache_.reset();
+        }
+      }
+
       /// Get tile at index \c i
 
       /// \param i The index of the tile
@@ -1482,34 +2723,122 @@ namespace TiledArray {
 
     private:
 
+      /// Memory required by each SUMMA iteration on this process
+
+      /// The memory of an iteration is the size of the non-zero tiles of the
+      /// left-hand column and the right-hand row that are used by this
+      /// process, computed from the actual tile ranges.
+      /// \return A vector with the memory, in bytes, required by each of the
+      /// iterations of this process's layer
+      std::vector<size_type> iteration_memory() const {
+        typedef typename numeric_type<typename left_type::eval_type>::type left_numeric_type;
+        typedef typename numeric_type<typename right_type::eval_type>::type right_numeric_type;
+
+        std::vector<size_type> memory(k_end_ - k_begin_, 0ul);
+        for(size_type k = k_begin_; k < k_end_; ++k) {
+          size_type& memory_k = memory[k - k_begin_];
+          // Column k of left_
+          for(size_type index = left_start_local_ + k; index < left_end_;
+              index += left_stride_local_)
+          {
+            if(is_zero_left(index)) continue;
+            memory_k += left_.trange().make_tile_range(index).volume() *
+                sizeof(left_numeric_type);
+          }
+
+          // Row k of right_
+          const size_type row_end = (k + 1ul) * proc_grid_.cols();
+          for(size_type index = k * proc_grid_.cols() + proc_grid_.rank_col();
+              index < row_end; index += right_stride_local_)
+          {
+            if(is_zero_right(index)) continue;
+            memory_k += right_.trange().make_tile_range(index).volume() *
+                sizeof(right_numeric_type);
+          }
+        }
+
+        return memory;
+      }
+
+      /// Memory available to SUMMA iterations on this process
+
+      /// When \c TA_SUMMA_MAX_MEMORY is set to \c auto , the available memory
+      /// is half of the physical memory that is currently free on this node,
+      /// divided evenly between the processes on the node; the other half is
+      /// reserved for result tiles and other data. If the free memory of the
+      /// node cannot be determined, \c auto_memory_fallback bytes are
+      /// available, so the depth stays bounded.
+      /// \return The memory, in bytes, available for the column and row tiles
+      /// of concurrent SUMMA iterations, or 0 if memory is unbounded.
+      static size_type available_memory() {
+        if(auto_memory_) {
+          const size_type node_memory = node_available_memory();
+          if(node_memory == 0ul)
+            return auto_memory_fallback;
+          return std::max<size_type>(node_memory / (2ul * node_local_procs()), 1ul);
+        }
+        return max_memory_;
+      }
+
       /// Adjust iteration depth based on memory constraints
 
+      /// The depth is the largest number of consecutive, non-zero iterations
+      /// whose column and row tiles fit in the available memory. Zero
+      /// iterations are skipped by the sparse SUMMA step tasks, so they do not
+      /// contribute memory. When a memory budget or a free node memory limit
+      /// is set (see \c memory_budget() ), the memory governor first evicts
+      /// caches to make room for the iterations, and the depth is reduced to
+      /// the memory that is left, down to one iteration.
       /// \param depth The unbounded iteration depth
-      /// \param left_sparsity The fraction of zero tiles in the left-hand matrix
-      /// \param right_sparsity The fraction of zero tiles in the right-hand matrix
       /// \return The memory bounded iteration depth
-      /// \thorw TiledArray::Exception When the memory bounded iteration depth
-      /// is less than 1.
-      size_type mem_bound_depth(size_type depth, const float left_sparsity, const float right_sparsity) {
+      /// \throw TiledArray::Exception When an explicit memory bound is set and
+      /// a single iteration does not fit in the memory bound.
+      size_type mem_bound_depth(size_type depth) {
 
         // Check if a memory bound has been set
-        const size_type available_memory = max_memory_;
-        if(available_memory) {
-
-          // Compute the average memory requirement per iteration of this process
-          const std::size_t local_memory_per_iter_left =
-              (left_.trange().elements_range().volume() / left_.trange().tiles_range().volume()) *
-              sizeof(typename numeric_type<typename left_type::eval_type>::type) *
-              proc_grid_.local_rows() * (1.0f - left_sparsity);
-          const std::size_t local_memory_per_iter_right =
-              (right_.trange().elements_range().volume() / right_.trange().tiles_range().volume()) *
-              sizeof(typename numeric_type<typename right_type::eval_type>::type) *
-              proc_grid_.local_cols() * (1.0f - right_sparsity);
-
-          // Compute the maximum number of iterations based on available memory
-          const size_type mem_bound_depth =
-              ((local_memory_per_iter_left + local_memory_per_iter_right) /
-              available_memory);
+        size_type available_memory = Summa_::available_memory();
+        const bool governed = memory_governor_bounded();
+        if(available_memory || governed) {
+
+          // Collect the memory requirement of non-zero iterations
+          std::vector<size_type> memory = iteration_memory();
+          memory.erase(std::remove(memory.begin(), memory.end(), 0ul), memory.end());
+
+          // The largest memory of d consecutive iterations
+          auto max_window = [&memory] (const size_type d) -> size_type {
+            size_type window = std::accumulate(memory.begin(), memory.begin() + d, size_type(0));
+            size_type max_window = window;
+            for(size_type i = d; i < memory.size(); ++i) {
+              window += memory[i];
+              window -= memory[i - d];
+              max_window = std::max(max_window, window);
+            }
+            return max_window;
+          };
+
+          // Let the memory governor make room for the iterations, and bound
+          // the memory by what is left
+          bool throttled = false;
+          if(governed && ! memory.empty()) {
+            size_type request = max_window(std::min(depth, size_type(memory.size())));
+            if(available_memory)
+              request = std::min(request, available_memory);
+            const size_type headroom = memory_headroom(request);
+            if(headroom < request) {
+              available_memory = headroom;
+              throttled = true;
+            }
+          }
+
+          // Find the largest depth where every window of depth consecutive
+          // iterations fits in the available memory
+          size_type mem_bound_depth = 0ul;
+          for(size_type d = 1ul; d <= std::min(depth, size_type(memory.size())); ++d) {
+            if(max_window(d) > available_memory) break;
+            mem_bound_depth = d;
+          }
+          if(memory.empty() || ! (available_memory || throttled))
+            mem_bound_depth = depth;
 
           // Check if the memory bounded depth is less than the optimal depth
           if(depth > mem_bound_depth) {
@@ -1517,13 +2846,16 @@ namespace TiledArray {
             // Adjust the depth based on the available memory
             switch(mem_bound_depth) {
               case 0:
-                // When memory bound depth is
-                TA_EXCEPTION("Insufficient memory available for SUMMA");
-                break;
+                // A single iteration does not fit in memory
+                if(! (auto_memory_ || throttled))
+                  TA_EXCEPTION("Insufficient memory available for SUMMA");
+                mem_bound_depth = 1ul;
+                // fall through
               case 1:
                 if(TensorImpl_::world().rank() == 0)
                   printf("!! WARNING TiledArray: Memory constraints limit the SUMMA depth depth to 1.\n"
                          "!! WARNING TiledArray: Performance may be slow.\n");
+                // fall through
               default:
                 depth = mem_bound_depth;
             }
@@ -1557,6 +2889,17 @@ namespace TiledArray {
         if(proc_grid_.local_size() > 0ul) {
           tile_count = initialize();
 
+          // Wait for the first request of the stealing process
+          if(stealing_) {
+            started_.assign(proc_grid_.local_size(), false);
+            steal_listen(0ul);
+          }
+
+          // Result tiles are only set by the first layer; the other layers
+          // send their partial result tiles to the first layer.
+          if(proc_grid_.rank_layer() != 0ul)
+            tile_count = 0ul;
+
           // depth controls the number of simultaneous SUMMA iterations
           // that are scheduled.
 
@@ -1567,16 +2910,21 @@ namespace TiledArray {
 
           // Construct the first SUMMA iteration task
           if(TensorImpl_::shape().is_dense()) {
+            // When the memory bound is derived from the available node
+            // memory, let the memory bound select the depth.
+            if(auto_memory_) depth = k_end_ - k_begin_;
+
             // We cannot have more iterations than there are blocks in the k
-            // dimension
-            if(depth > k_) depth = k_;
+            // dimension of this layer
+            if(depth > (k_end_ - k_begin_)) depth = k_end_ - k_begin_;
 
             // Modify the number of concurrent iterations based on the available
             // memory.
-            depth = mem_bound_depth(depth, 0.0f, 0.0f);
+            depth = mem_bound_depth(depth);
 
             // Enforce user defined depth bound
-            if(max_depth_) std::min(depth, max_depth_);
+            const size_type max_depth = summa_max_depth();
+            if(max_depth) depth = std::min(depth, max_depth);
 
             TensorImpl_::world().taskq.add(new DenseStepTask(shared_from_this(),
                                                              depth));
@@ -1594,16 +2942,21 @@ namespace TiledArray {
             // Compute the new depth based on sparsity of the arguments
             depth = float(depth) * (1.0f - 1.35638f * std::log2(frac_non_zero)) + 0.5f;
 
+            // When the memory bound is derived from the available node
+            // memory, let the memory bound select the depth.
+            if(auto_memory_) depth = k_end_ - k_begin_;
+
             // We cannot have more iterations than there are blocks in the k
-            // dimension
-            if(depth > k_) depth = k_;
+            // dimension of this layer
+            if(depth > (k_end_ - k_begin_)) depth = k_end_ - k_begin_;
 
             // Modify the number of concurrent iterations based on the available
             // memory and sparsity of the argument tensors.
-            depth = mem_bound_depth(depth, left_sparsity, right_sparsity);
+            depth = mem_bound_depth(depth);
 
             // Enforce user defined depth bound
-            if(max_depth_) std::min(depth, max_depth_);
+            const size_type max_depth = summa_max_depth();
+            if(max_depth) depth = std::min(depth, max_depth);
 
             TensorImpl_::world().taskq.add(new SparseStepTask(shared_from_this(),
                                                               depth));
@@ -1630,15 +2983,30 @@ namespace TiledArray {
 
     // Initialize static member variables for Summa
 
-    template <typename Left, typename Right, typename Op, typename Policy>
-    typename Summa<Left, Right, Op, Policy>::size_type
-    Summa<Left, Right, Op, Policy>::max_depth_ =
-        Summa<Left, Right, Op, Policy>::init_max_depth();
-
     template <typename Left, typename Right, typename Op, typename Policy>
     typename Summa<Left, Right, Op, Policy>::size_type
     Summa<Left, Right, Op, Policy>::max_memory_ =
         Summa<Left, Right, Op, Policy>::init_max_memory();
+
+    template <typename Left, typename Right, typename Op, typename Policy>
+    bool Summa<Left, Right, Op, Policy>::auto_memory_ =
+        Summa<Left, Right, Op, Policy>::init_auto_memory();
+
+    template <typename Left, typename Right, typename Op, typename Policy>
+    bool Summa<Left, Right, Op, Policy>::steal_ =
+        Summa<Left, Right, Op, Policy>::init_steal();
+
+    template <typename Left, typename Right, typename Op, typename Policy>
+    SummaOrder Summa<Left, Right, Op, Policy>::order_ =
+        Summa<Left, Right, Op, Policy>::init_order();
+
+    template <typename Left, typename Right, typename Op, typename Policy>
+    bool Summa<Left, Right, Op, Policy>::uniform_priority_ =
+        Summa<Left, Right, Op, Policy>::init_uniform_priority();
+
+    template <typename Left, typename Right, typename Op, typename Policy>
+    bool Summa<Left, Right, Op, Policy>::early_release_ =
+        Summa<Left, Right, Op, Policy>::init_early_release();
   } // namespace detail
 }  // namespace TiledArray
 
@@ -24,10 +24,68 @@
 #include <TiledArray/permutation.h>
 #include <TiledArray/perm_index.h>
 #include <TiledArray/type_traits.h>
+#include <TiledArray/expressions/expr_profile.h>
+#include <TiledArray/task_trace.h>
+#include <algorithm>
+#include <cstdlib>
+#include <initializer_list>
 
 namespace TiledArray {
   namespace detail {
 
+    /// The work size of a batch of small tile evaluations
+
+    /// Local tiles with fewer elements than the batch volume are evaluated
+    /// in batches, with one task per batch instead of one task per tile,
+    /// since the cost of a task exceeds the work of a small tile. A batch
+    /// is submitted once its tiles hold at least the batch volume. The
+    /// volume is read from the \c TA_TILE_BATCH_VOLUME environment
+    /// variable; a value of zero disables batching. The default is 512
+    /// elements.
+    /// \return The batch volume
+    inline std::size_t tile_batch_volume() {
+      static const std::size_t volume = [] () -> std::size_t {
+        const char* volume = getenv("TA_TILE_BATCH_VOLUME");
+        if(volume)
+          return std::strtoul(volume, nullptr, 10);
+        return 512ul;
+      }();
+      return volume;
+    }
+
+    template <typename T>
+    inline const void* tile_data(const T& tile);
+
+    template <typename T>
+    inline auto tile_data(const T& tile, int)
+        -> decltype(static_cast<const void*>(tile.data()))
+    { return tile.data(); }
+
+    template <typename T>
+    inline auto tile_data(const T& tile, long)
+        -> decltype(tile.empty(), tile.tensor(), static_cast<const void*>(nullptr))
+    { return (tile.empty() ? nullptr : tile_data(tile.tensor())); }
+
+    template <typename T>
+    inline auto tile_data(const T& tile, long)
+        -> decltype(tile.tile(), static_cast<const void*>(nullptr))
+    { return tile_data(tile.tile()); }
+
+    template <typename T>
+    inline const void* tile_data(const T&, ...) { return nullptr; }
+
+    /// The address of the data of a tile
+
+    /// This is used to detect the tile operations that reuse the data of a
+    /// consumed argument tile.
+    /// \tparam T The tile type
+    /// \param tile The tile
+    /// \return The address of the data of the tile, of the tensor of a
+    /// \c Tile , or of the tile of a lazy array tile, or \c nullptr when it
+    /// is not known
+    template <typename T>
+    inline const void* tile_data(const T& tile) { return tile_data(tile, 0); }
+
     /// Distributed evaluator implementation object
 
     /// This class is used as the base class for other distributed evaluation
@@ -64,6 +122,7 @@ namespace TiledArray {
 
       volatile int task_count_; ///< Total number of local tasks
       madness::AtomicInt set_counter_; ///< The number of tiles set by this node
+      std::shared_ptr<expressions::ExprProfile> profile_; ///< Cost counters, if profiled
 
     protected:
 
@@ -104,7 +163,8 @@ namespace TiledArray {
         source_to_target_(),
         target_to_source_(),
         task_count_(-1),
-        set_counter_()
+        set_counter_(),
+        profile_()
       {
         set_counter_ = 0;
 
@@ -124,6 +184,23 @@ namespace TiledArray {
       /// \return This object's unique identifier
       const madness::uniqueidT& id() const { return id_; }
 
+      /// Profile accessor
+
+      /// \return The cost counters of this evaluator, or \c nullptr if it is
+      /// not profiled
+      const std::shared_ptr<expressions::ExprProfile>& profile() const {
+        return profile_;
+      }
+
+      /// Set the profile
+
+      /// \note This must be called before \c eval() .
+      /// \param profile The cost counters of this evaluator
+      void profile(const std::shared_ptr<expressions::ExprProfile>& profile) {
+        TA_ASSERT(task_count_ == -1);
+        profile_ = profile;
+      }
+
       /// Get tile at index \c i
 
       /// \param i The index of the tile
@@ -137,6 +214,14 @@ namespace TiledArray {
       /// \param i The index of the tile
       virtual void discard_tile(size_type i) const = 0;
 
+      /// Prefetch a tile that will be requested soon
+
+      /// Evaluators of stored tiles start reading tile \c i , e.g. from a
+      /// remote process or from disk, so that a later call to \c get_tile()
+      /// does not wait for it. By default this does nothing.
+      /// \param i The index of the tile
+      virtual void prefetch_tile(size_type i) const { }
+
       /// Set tensor value
 
       /// This will store \c value at ordinal index \c i . Typically, this
@@ -167,8 +252,36 @@ namespace TiledArray {
         f.register_callback(this);
       }
 
+      /// Count a tile that was produced in the data of an argument tile
+
+      /// \param result The data of the result tile
+      /// \param args The data of the argument tiles
+      void profile_in_place(const void* result,
+          std::initializer_list<const void*> args) const
+      {
+        TA_ASSERT(profile_);
+        if(result && (std::find(args.begin(), args.end(), result) != args.end()))
+          profile_->add_in_place();
+      }
+
       /// Tile set notification
-      virtual void notify() { set_counter_++; }
+      virtual void notify() {
+        const int count = ++set_counter_;
+        if(profile_) {
+          profile_->add_tile();
+          if(count == task_count_)
+            profile_->finish();
+        }
+      }
+
+      /// Check that all tiles have been assigned
+
+      /// \return \c true when the tiles of all local tasks have been set,
+      /// otherwise \c false
+      bool done() const {
+        const int task_count = task_count_;
+        return (task_count <= 0) || (set_counter_ == task_count);
+      }
 
       /// Wait for all tiles to be assigned
       void wait() const {
@@ -209,8 +322,14 @@ namespace TiledArray {
       /// this object).
       void eval() {
         TA_ASSERT(task_count_ == -1);
+        if(profile_)
+          profile_->start();
         task_count_ = this->internal_eval();
         TA_ASSERT(task_count_ >= 0);
+
+        // All local tiles may have been set before the task count was known
+        if(profile_ && (set_counter_ == task_count_))
+          profile_->finish();
       }
 
     }; // class DistEvalImpl
@@ -336,6 +455,11 @@ namespace TiledArray {
       /// \param i The index of the tile
       virtual void discard(size_type i) const { pimpl_->discard_tile(i); }
 
+      /// Prefetch a tile that will be requested soon
+
+      /// \param i The index of the tile
+      void prefetch(size_type i) const { pimpl_->prefetch_tile(i); }
+
       /// World object accessor
 
       /// \return A reference to the world object
@@ -349,6 +473,27 @@ namespace TiledArray {
       /// Wait for all local tiles to be evaluated
       void wait() const { pimpl_->wait(); }
 
+      /// Check that all local tiles have been evaluated
+
+      /// \return \c true when all local tiles have been evaluated, otherwise
+      /// \c false
+      bool done() const { return pimpl_->done(); }
+
+      /// Profile accessor
+
+      /// \return The cost counters of this evaluator, or \c nullptr if it is
+      /// not profiled
+      const std::shared_ptr<expressions::ExprProfile>& profile() const {
+        return pimpl_->profile();
+      }
+
+      /// Set the profile
+
+      /// \param profile The cost counters of this evaluator
+      void profile(const std::shared_ptr<expressions::ExprProfile>& profile) {
+        pimpl_->profile(profile);
+      }
+
     }; // class DistEval
 
   }  // namespace detail
@@ -0,0 +1,155 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  lazy_tile_cache.cpp
+ *  Apr 5, 2017
+ *
+ */
+
+#include <TiledArray/dist_eval/lazy_tile_cache.h>
+#include <cstdlib>
+#include <iterator>
+
+namespace TiledArray {
+  namespace detail {
+
+    void TileCache::trim(std::list<entry_type>& removed) {
+      while(size_ > capacity_) {
+        size_ -= std::get<2>(entries_.back());
+        index_.erase(std::get<0>(entries_.back()));
+        removed.splice(removed.begin(), entries_, std::prev(entries_.end()));
+      }
+    }
+
+    TileCache::TileCache(const std::size_t capacity,
+        const CachePriority priority) :
+      lock_(), entries_(), index_(), capacity_(capacity), size_(0ul),
+      governor_id_(register_memory_cache(priority,
+          [this] () { return size(); },
+          [this] (const std::size_t bytes) { return evict(bytes); }))
+    { }
+
+    TileCache::~TileCache() { unregister_memory_cache(governor_id_); }
+
+    std::size_t TileCache::capacity() {
+      std::lock_guard<std::mutex> locker(lock_);
+      return capacity_;
+    }
+
+    void TileCache::capacity(const std::size_t capacity) {
+      std::list<entry_type> removed;
+      std::lock_guard<std::mutex> locker(lock_);
+      capacity_ = capacity;
+      trim(removed);
+    }
+
+    std::size_t TileCache::size() {
+      std::lock_guard<std::mutex> locker(lock_);
+      return size_;
+    }
+
+    void TileCache::clear() {
+      std::list<entry_type> removed;
+      std::lock_guard<std::mutex> locker(lock_);
+      index_.clear();
+      removed.swap(entries_);
+      size_ = 0ul;
+    }
+
+    std::size_t TileCache::evict(const std::size_t bytes) {
+      std::list<entry_type> removed;
+      std::lock_guard<std::mutex> locker(lock_);
+      std::size_t freed = 0ul;
+      while((freed < bytes) && ! entries_.empty()) {
+        freed += std::get<2>(entries_.back());
+        size_ -= std::get<2>(entries_.back());
+        index_.erase(std::get<0>(entries_.back()));
+        removed.splice(removed.begin(), entries_, std::prev(entries_.end()));
+      }
+      return freed;
+    }
+
+    std::shared_ptr<void> TileCache::find(const std::string& key) {
+      std::lock_guard<std::mutex> locker(lock_);
+      auto it = index_.find(key);
+      if(it == index_.end())
+        return std::shared_ptr<void>();
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return std::get<1>(*it->second);
+    }
+
+    bool TileCache::insert(const std::string& key,
+        const std::shared_ptr<void>& tile, const std::size_t bytes)
+    {
+      {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        if(bytes > capacity_)
+          return false;
+        auto it = index_.find(key);
+        if(it != index_.end()) {
+          size_ -= std::get<2>(*it->second);
+          removed.splice(removed.begin(), entries_, it->second);
+        }
+        entries_.emplace_front(key, tile, bytes);
+        index_[key] = entries_.begin();
+        size_ += bytes;
+        trim(removed);
+      }
+      memory_governor_poll();
+      return true;
+    }
+
+  }  // namespace detail
+
+  namespace {
+
+    /// Cached lazy tiles
+    detail::TileCache& lazy_tile_cache() {
+      static detail::TileCache cache([] () -> std::size_t {
+        const char* capacity = getenv("TA_LAZY_TILE_CACHE_CAPACITY");
+        return (capacity ? std::strtoul(capacity, nullptr, 10) : 0ul);
+      }(), CachePriority::lazy_tiles);
+      return cache;
+    }
+
+  }  // namespace
+
+  std::size_t lazy_tile_cache_capacity() { return lazy_tile_cache().capacity(); }
+
+  void lazy_tile_cache_capacity(const std::size_t capacity) {
+    lazy_tile_cache().capacity(capacity);
+  }
+
+  std::size_t lazy_tile_cache_size() { return lazy_tile_cache().size(); }
+
+  void clear_lazy_tile_cache() { lazy_tile_cache().clear(); }
+
+  namespace detail {
+
+    std::shared_ptr<void> lazy_tile_cache_find(const std::string& key) {
+      return lazy_tile_cache().find(key);
+    }
+
+    bool lazy_tile_cache_insert(const std::string& key,
+        const std::shared_ptr<void>& tile, const std::size_t bytes)
+    {
+      return lazy_tile_cache().insert(key, tile, bytes);
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
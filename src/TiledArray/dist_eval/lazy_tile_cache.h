@@ -0,0 +1,165 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  lazy_tile_cache.h
+ *  Apr 5, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_LAZY_TILE_CACHE_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_LAZY_TILE_CACHE_H__INCLUDED
+
+#include <TiledArray/memory_governor.h>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace TiledArray {
+
+  /// Lazy tile cache capacity accessor
+
+  /// The lazy tile cache holds the array tiles of expressions after they
+  /// are converted to the evaluation tile type, i.e. permuted, scaled,
+  /// shifted, or decompressed, so that an array that is used by several
+  /// expressions with the same conversion is converted once per tile on
+  /// each process. The capacity is initialized with the
+  /// \c TA_LAZY_TILE_CACHE_CAPACITY environment variable, in bytes; the
+  /// default capacity is zero, which disables the cache.
+  /// \return The largest number of bytes held by the lazy tile cache
+  std::size_t lazy_tile_cache_capacity();
+
+  /// Set the lazy tile cache capacity
+
+  /// The least recently used tiles are removed when the cache holds more
+  /// than \c capacity bytes. This may differ between processes.
+  /// \param capacity The largest number of bytes held by the lazy tile
+  /// cache; zero disables caching
+  void lazy_tile_cache_capacity(const std::size_t capacity);
+
+  /// Size of the cached lazy tiles
+
+  /// \return The number of bytes held by the lazy tile cache
+  std::size_t lazy_tile_cache_size();
+
+  /// Remove all tiles from the lazy tile cache
+
+  /// The cached tiles are identified by the array and the tile index, so
+  /// the cache should be cleared when the tiles of an input array are
+  /// modified in place, like the expression cache (see
+  /// \c clear_expression_cache() ). \c TiledArray::finalize() clears the
+  /// cache.
+  void clear_lazy_tile_cache();
+
+  namespace detail {
+
+    /// Converted tiles, removed in least recently used order
+
+    /// This holds the tiles of the lazy tile cache, and of the permutation
+    /// caches of arrays (see \c DistArray::permutation_cache_capacity() ).
+    /// The tiles are held as pointers to copies of the converted tiles, and
+    /// identified by a key that identifies the array, the conversion, and
+    /// the tile. The cache is registered with the memory governor, which
+    /// removes its least recently used tiles when memory is needed (see
+    /// \c memory_budget() ). All functions are thread-safe.
+    class TileCache {
+      typedef std::tuple<std::string, std::shared_ptr<void>, std::size_t>
+          entry_type; ///< Key, tile, and bytes
+
+      std::mutex lock_; ///< Protects the cache
+      std::list<entry_type> entries_; ///< The tiles, most recently used first
+      std::unordered_map<std::string, std::list<entry_type>::iterator> index_;
+          ///< The position of each tile in \c entries_
+      std::size_t capacity_; ///< The largest number of bytes
+      std::size_t size_; ///< The number of bytes held
+      std::size_t governor_id_; ///< The id of the cache in the memory governor
+
+      TileCache(const TileCache&);
+      TileCache& operator=(const TileCache&);
+
+      /// Remove the least recently used tiles that exceed the capacity
+
+      /// \param[out] removed The removed tiles, which are released after the
+      /// lock
+      void trim(std::list<entry_type>& removed);
+
+    public:
+
+      /// \param capacity The largest number of bytes held by the cache
+      /// \param priority The eviction priority of the cache
+      TileCache(const std::size_t capacity, const CachePriority priority);
+
+      ~TileCache();
+
+      /// \return The largest number of bytes held by the cache
+      std::size_t capacity();
+
+      /// \param capacity The largest number of bytes held by the cache
+      void capacity(const std::size_t capacity);
+
+      /// \return The number of bytes held by the cache
+      std::size_t size();
+
+      /// Remove all tiles
+      void clear();
+
+      /// Remove the least recently used tiles
+
+      /// \param bytes The number of bytes to be freed
+      /// \return The number of bytes removed, which is less than \c bytes
+      /// only when the cache is empty
+      std::size_t evict(const std::size_t bytes);
+
+      /// \param key The tile key
+      /// \return A pointer to the cached tile, or null if there is no tile
+      /// for \c key
+      std::shared_ptr<void> find(const std::string& key);
+
+      /// \param key The tile key
+      /// \param tile A pointer to a copy of the converted tile
+      /// \param bytes The size of the tile
+      /// \return \c true if the tile was added, or \c false if it is larger
+      /// than the capacity
+      bool insert(const std::string& key, const std::shared_ptr<void>& tile,
+          const std::size_t bytes);
+
+    }; // class TileCache
+
+    /// Find a cached lazy tile
+
+    /// \param key The lazy tile cache key
+    /// \return A pointer to the cached tile, or null if there is no tile for
+    /// \c key
+    std::shared_ptr<void> lazy_tile_cache_find(const std::string& key);
+
+    /// Add a converted tile to the lazy tile cache
+
+    /// \param key The lazy tile cache key
+    /// \param tile A pointer to a copy of the converted tile
+    /// \param bytes The size of the tile
+    /// \return \c true if the tile was added, or \c false if it is larger
+    /// than the capacity
+    bool lazy_tile_cache_insert(const std::string& key,
+        const std::shared_ptr<void>& tile, const std::size_t bytes);
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_LAZY_TILE_CACHE_H__INCLUDED
@@ -0,0 +1,363 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  outer_eval.h
+ *  May 4, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_OUTER_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_OUTER_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/tile_interface/clone.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Distributed outer product evaluator
+
+    /// This object evaluates the tiles of a contraction without contracted
+    /// indices, <tt>C(i,j) = A(i) * B(j)</tt> , where \c i and \c j are the
+    /// fused tile indices of the arguments. Each result tile is computed by
+    /// its owner: the owner of an argument tile sends it, once, to each
+    /// process that owns a non-zero result tile that uses it, so there are
+    /// no SUMMA steps or broadcast groups. When the result is distributed
+    /// like the larger argument (see \c ContEngine ), only the tiles of the
+    /// smaller argument are moved.
+    /// \tparam Left The left argument type
+    /// \tparam Right The right argument type
+    /// \tparam Op The tile contraction operator type
+    /// \tparam Policy The tensor policy class
+    template <typename Left, typename Right, typename Op, typename Policy>
+    class OuterEvalImpl :
+      public DistEvalImpl<typename Op::result_type, Policy>,
+      public std::enable_shared_from_this<OuterEvalImpl<Left, Right, Op, Policy> >
+    {
+    public:
+      typedef OuterEvalImpl<Left, Right, Op, Policy> OuterEvalImpl_; ///< This object type
+      typedef DistEvalImpl<typename Op::result_type, Policy> DistEvalImpl_; ///< The base class type
+      typedef typename DistEvalImpl_::TensorImpl_ TensorImpl_; ///< The base, base class type
+      typedef Left left_type; ///< The left-hand argument type
+      typedef Right right_type; ///< The right-hand argument type
+      typedef typename DistEvalImpl_::size_type size_type; ///< Size type
+      typedef typename DistEvalImpl_::range_type range_type; ///< Range type
+      typedef typename DistEvalImpl_::shape_type shape_type; ///< Shape type
+      typedef typename DistEvalImpl_::pmap_interface pmap_interface; ///< Process map interface type
+      typedef typename DistEvalImpl_::trange_type trange_type; ///< Tiled range type
+      typedef typename DistEvalImpl_::value_type value_type; ///< Tile type
+      typedef typename DistEvalImpl_::eval_type eval_type; ///< Tile evaluation type
+      typedef Op op_type; ///< Tile evaluation operator type
+
+      using std::enable_shared_from_this<OuterEvalImpl_>::shared_from_this;
+
+    private:
+
+      typedef typename left_type::eval_type left_eval_type; ///< Left-hand tile type
+      typedef typename right_type::eval_type right_eval_type; ///< Right-hand tile type
+
+      left_type left_; ///< Left argument
+      right_type right_; ///< Right argument
+      op_type op_; ///< Tile contraction operator
+
+    public:
+
+      /// Construct an outer product evaluator
+
+      /// \param left The left-hand argument
+      /// \param right The right-hand argument
+      /// \param world The world where the tensor lives
+      /// \param trange The tiled range object
+      /// \param shape The tensor shape object
+      /// \param pmap The tile-process map
+      /// \param perm The permutation that is applied to tile indices
+      /// \param op The tile contraction operation
+      OuterEvalImpl(const left_type& left, const right_type& right,
+          World& world, const trange_type& trange, const shape_type& shape,
+          const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
+          const op_type& op) :
+        DistEvalImpl_(world, trange, shape, pmap, perm),
+        left_(left), right_(right), op_(op)
+      {
+        TA_ASSERT(left.size() * right.size() == TensorImpl_::size());
+      }
+
+      virtual ~OuterEvalImpl() { }
+
+      /// Get tile at index \c i
+
+      /// \param i The index of the tile
+      /// \return A \c Future to the tile at index i
+      /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+      /// \throw TiledArray::Exception When tile \c i a zero tile.
+      virtual Future<value_type> get_tile(size_type i) const {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+
+        // Result tiles are computed by their owner
+        const madness::DistributedID key(DistEvalImpl_::id(), i);
+        return TensorImpl_::world().gop.template recv<value_type>(
+            TensorImpl_::world().rank(), key);
+      }
+
+      /// Discard a tile that is not needed
+
+      /// This function handles the cleanup for tiles that are not needed in
+      /// subsequent computation.
+      /// \param i The index of the tile
+      virtual void discard_tile(size_type i) const { get_tile(i); }
+
+    private:
+
+      /// Tile conversion task function
+
+      /// \tparam Tile The input tile type
+      /// \param tile The input tile
+      /// \return The evaluated version of the lazy tile
+      template <typename Tile>
+      static auto convert_tile(const Tile& tile) {
+        TiledArray::Cast<typename eval_trait<Tile>::type, Tile> cast;
+        return cast(tile);
+      }
+
+      /// Conversion function
+
+      /// This function does nothing since tile is not a lazy tile.
+      /// \tparam Arg The type of the argument that holds the input tiles
+      /// \param arg The argument that holds the tiles
+      /// \param index The tile index of arg
+      /// \return \c tile
+      template <typename Arg>
+      static typename std::enable_if<
+          ! is_lazy_tile<typename Arg::value_type>::value,
+          Future<typename Arg::eval_type> >::type
+      get_arg_tile(const Arg& arg, const size_type index) { return arg.get(index); }
+
+      /// Conversion function
+
+      /// This function spawns a task that will convert a lazy tile from the
+      /// tile type to the evaluated tile type, so that evaluated tiles are
+      /// sent to the processes that use them.
+      /// \tparam Arg The type of the argument that holds the input tiles
+      /// \param arg The argument that holds the tiles
+      /// \param index The tile index of arg
+      /// \return A future to the evaluated tile
+      template <typename Arg>
+      static typename std::enable_if<
+          is_lazy_tile<typename Arg::value_type>::value,
+          Future<typename Arg::eval_type> >::type
+      get_arg_tile(const Arg& arg, const size_type index) {
+        auto convert_tile_fn =
+            &OuterEvalImpl_::template convert_tile<typename Arg::value_type>;
+        return arg.world().taskq.add(convert_tile_fn, arg.get(index),
+                                     madness::TaskAttributes::hipri());
+      }
+
+      /// Send the local tiles of an argument to the processes that use them
+
+      /// \tparam Arg The argument type
+      /// \tparam OtherIsZero The zero tile predicate type
+      /// \tparam Index The function that gives the (unpermuted) result tile
+      /// index of an argument tile and a tile of the other argument
+      /// \param arg The argument
+      /// \param other The number of tiles of the other argument
+      /// \param other_is_zero The zero tile predicate of the other argument
+      /// \param index The result tile index function
+      /// \param key_offset The offset of the keys of the argument tiles
+      /// \param[out] tiles The argument tiles that are used by this process
+      template <typename Arg, typename OtherIsZero, typename Index>
+      void send_arg(const Arg& arg, const size_type other,
+          const OtherIsZero& other_is_zero, const Index& index,
+          const size_type key_offset,
+          std::unordered_map<size_type, Future<typename Arg::eval_type> >& tiles) const
+      {
+        World& world = TensorImpl_::world();
+        const ProcessID rank = world.rank();
+        std::vector<ProcessID> procs;
+
+        typename pmap_interface::const_iterator it = arg.pmap()->begin();
+        const typename pmap_interface::const_iterator end = arg.pmap()->end();
+        for(; it != end; ++it) {
+          const size_type i = *it;
+          if(arg.is_zero(i))
+            continue;
+
+          // Find the owners of the non-zero result tiles that use tile i
+          procs.clear();
+          for(size_type j = 0ul; j < other; ++j) {
+            const size_type target = DistEvalImpl_::perm_index_to_target(index(i, j));
+            if(! (TensorImpl_::is_zero(target) || other_is_zero(j)))
+              procs.push_back(TensorImpl_::owner(target));
+          }
+          std::sort(procs.begin(), procs.end());
+          procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+
+          if(procs.empty()) {
+            arg.discard(i);
+            continue;
+          }
+
+          const Future<typename Arg::eval_type> tile = get_arg_tile(arg, i);
+          for(const ProcessID proc : procs) {
+            if(proc == rank)
+              tiles.emplace(i, tile);
+            else
+              world.gop.send(proc, madness::DistributedID(DistEvalImpl_::id(),
+                  key_offset + i), tile);
+          }
+        }
+      }
+
+      /// Get an argument tile that is used by this process
+
+      /// \tparam Arg The argument type
+      /// \param arg The argument
+      /// \param i The index of the argument tile
+      /// \param key_offset The offset of the keys of the argument tiles
+      /// \param[in,out] tiles The argument tiles that are used by this process
+      /// \return A future to argument tile \c i
+      template <typename Arg>
+      Future<typename Arg::eval_type> recv_arg(const Arg& arg,
+          const size_type i, const size_type key_offset,
+          std::unordered_map<size_type, Future<typename Arg::eval_type> >& tiles) const
+      {
+        auto it = tiles.find(i);
+        if(it == tiles.end())
+          it = tiles.emplace(i, TensorImpl_::world().gop.template
+              recv<typename Arg::eval_type>(arg.owner(i),
+              madness::DistributedID(DistEvalImpl_::id(), key_offset + i))).first;
+        return it->second;
+      }
+
+      /// Task function for evaluating a result tile
+
+      /// \param index The (permuted) index of the result tile
+      /// \param left The left-hand tile
+      /// \param right The right-hand tile
+      /// \param seed The initial value of the result tile, in the layout of
+      /// the result, or an empty tile
+      void eval_tile(const size_type index, const left_eval_type& left,
+          const right_eval_type& right, value_type seed)
+      {
+        TaskTraceScope trace("outer_eval", index);
+        using TiledArray::empty;
+        // The seed is accumulated in place, so it must not share its data
+        // with the tile it was taken from
+        if(! empty(seed)) {
+          using TiledArray::clone;
+          using TiledArray::permute;
+          seed = (op_.perm() ? permute(seed, op_.perm().inv()) : clone(seed));
+        }
+        op_(seed, left, right);
+        value_type result = op_(seed);
+        if(op_.epilogue())
+          op_.epilogue()(result);
+        DistEvalImpl_::set_tile(index, result);
+      }
+
+      /// Task function for a result tile with a zero argument tile
+
+      /// \param index The (permuted) index of the result tile
+      /// \param seed The initial value of the result tile
+      void eval_seed_tile(const size_type index, value_type seed) {
+        if(op_.epilogue()) {
+          // The epilogue modifies the tile in place
+          using TiledArray::clone;
+          seed = clone(seed);
+          op_.epilogue()(seed);
+        }
+        DistEvalImpl_::set_tile(index, seed);
+      }
+
+      /// Evaluate the tiles of this tensor
+
+      /// This function will evaluate the children of this distributed evaluator
+      /// and evaluate the tiles for this distributed evaluator. It will block
+      /// until the tasks for the children are evaluated (not for the tasks of
+      /// this object).
+      /// \return The number of tiles that will be set by this process
+      virtual int internal_eval() {
+
+        // Evaluate child tensors
+        left_.eval();
+        right_.eval();
+
+        const size_type cols = right_.size();
+        const size_type left_offset = TensorImpl_::size();
+        const size_type right_offset = left_offset + left_.size();
+
+        // Send the argument tiles to the owners of the result tiles, with
+        // keys that follow the result tile keys
+        std::unordered_map<size_type, Future<left_eval_type> > left_tiles;
+        std::unordered_map<size_type, Future<right_eval_type> > right_tiles;
+        send_arg(left_, cols,
+            [this] (const size_type j) { return right_.is_zero(j); },
+            [cols] (const size_type i, const size_type j) { return i * cols + j; },
+            left_offset, left_tiles);
+        send_arg(right_, left_.size(),
+            [this] (const size_type i) { return left_.is_zero(i); },
+            [cols] (const size_type j, const size_type i) { return i * cols + j; },
+            right_offset, right_tiles);
+
+        // Compute the local result tiles
+        size_type task_count = 0ul;
+        std::shared_ptr<OuterEvalImpl_> self = shared_from_this();
+        typename pmap_interface::const_iterator it = TensorImpl_::pmap()->begin();
+        const typename pmap_interface::const_iterator end = TensorImpl_::pmap()->end();
+        for(; it != end; ++it) {
+          const size_type target = *it;
+          if(TensorImpl_::is_zero(target))
+            continue;
+
+          const size_type source = DistEvalImpl_::perm_index_to_source(target);
+          const size_type i = source / cols;
+          const size_type j = source - i * cols;
+
+          Future<value_type> seed;
+          const bool seeded = op_.seed() && op_.seed()(target, seed);
+
+          if(left_.is_zero(i) || right_.is_zero(j)) {
+            // The result tile is non-zero because of its initial value
+            TA_ASSERT(seeded);
+            TensorImpl_::world().taskq.add(self, & OuterEvalImpl_::eval_seed_tile,
+                target, seed);
+          } else {
+            TensorImpl_::world().taskq.add(self, & OuterEvalImpl_::eval_tile,
+                target, recv_arg(left_, i, left_offset, left_tiles),
+                recv_arg(right_, j, right_offset, right_tiles),
+                (seeded ? seed : Future<value_type>(value_type())));
+          }
+
+          ++task_count;
+        }
+
+        // Wait for child tensors to be evaluated, and process tasks while waiting.
+        left_.wait();
+        right_.wait();
+
+        return task_count;
+      }
+
+    }; // class OuterEvalImpl
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_OUTER_EVAL_H__INCLUDED
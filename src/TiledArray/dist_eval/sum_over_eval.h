@@ -0,0 +1,384 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sum_over_eval.h
+ *  May 10, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_SUM_OVER_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_SUM_OVER_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/tile_interface/add.h>
+#include <TiledArray/tile_interface/cast.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Distributed partial sum evaluator
+
+    /// This object evaluates the sum of a tensor over some of its indices,
+    /// e.g. <tt>v(i) = A(i,j).sum_over("j")</tt> . Each process sums the
+    /// local tiles of the argument that contribute to a result tile, so it
+    /// sends at most one partial sum of each result tile to the owner of
+    /// the tile, which adds the partial sums of all processes. The tiles of
+    /// a sum are added pair-wise, in a binary tree of tasks. The result is
+    /// not computed by contracting the argument with a vector of ones, so
+    /// there are no SUMMA steps or broadcasts of argument tiles.
+    /// \tparam Arg The argument distributed evaluator type
+    /// \tparam Op The tile partial sum operation type (see \c SumOver ), which
+    /// also holds the permutation of the result tiles
+    /// \tparam Policy The tensor policy class
+    template <typename Arg, typename Op, typename Policy>
+    class SumOverEvalImpl :
+      public DistEvalImpl<typename Op::result_type, Policy>,
+      public std::enable_shared_from_this<SumOverEvalImpl<Arg, Op, Policy> >
+    {
+    public:
+      typedef SumOverEvalImpl<Arg, Op, Policy> SumOverEvalImpl_; ///< This object type
+      typedef DistEvalImpl<typename Op::result_type, Policy> DistEvalImpl_; ///< The base class type
+      typedef typename DistEvalImpl_::TensorImpl_ TensorImpl_; ///< The base, base class type
+      typedef Arg arg_type; ///< The argument tensor type
+      typedef typename DistEvalImpl_::size_type size_type; ///< Size type
+      typedef typename DistEvalImpl_::range_type range_type; ///< Range type
+      typedef typename DistEvalImpl_::shape_type shape_type; ///< Shape type
+      typedef typename DistEvalImpl_::pmap_interface pmap_interface; ///< Process map interface type
+      typedef typename DistEvalImpl_::trange_type trange_type; ///< Tiled range type
+      typedef typename DistEvalImpl_::value_type value_type; ///< Tile type
+      typedef typename DistEvalImpl_::eval_type eval_type; ///< Tile evaluation type
+      typedef Op op_type; ///< Tile evaluation operator type
+
+      using std::enable_shared_from_this<SumOverEvalImpl_>::shared_from_this;
+
+    private:
+
+      arg_type arg_; ///< Argument
+      op_type op_; ///< The tile partial sum operation
+      std::vector<size_type> arg_extent_; ///< The tile extents of the argument
+      std::vector<size_type> weight_; ///< The (unpermuted) result weight of each argument dimension, or zero for summed dimensions
+
+    public:
+
+      /// Constructor
+
+      /// \param arg The argument
+      /// \param world The world where the tensor lives
+      /// \param trange The tiled range object
+      /// \param shape The tensor shape object
+      /// \param pmap The tile-process map
+      /// \param perm The permutation that is applied to tile indices
+      /// \param op The tile partial sum operation
+      SumOverEvalImpl(const arg_type& arg, World& world, const trange_type& trange,
+          const shape_type& shape, const std::shared_ptr<pmap_interface>& pmap,
+          const Permutation& perm, const op_type& op) :
+        DistEvalImpl_(world, trange, shape, pmap, perm),
+        arg_(arg), op_(op), arg_extent_(), weight_()
+      {
+        const range_type& arg_range = arg_.trange().tiles_range();
+        const unsigned int rank = arg_range.rank();
+        arg_extent_.assign(arg_range.extent_data(), arg_range.extent_data() + rank);
+        weight_.assign(rank, 0ul);
+        size_type weight = 1ul;
+        for(unsigned int d = rank; d > 0u; ) {
+          --d;
+          if(! std::binary_search(op_.dims().begin(), op_.dims().end(), d)) {
+            weight_[d] = weight;
+            weight *= arg_extent_[d];
+          }
+        }
+        TA_ASSERT(weight == TensorImpl_::size());
+      }
+
+      virtual ~SumOverEvalImpl() { }
+
+      /// Get tile at index \c i
+
+      /// \param i The index of the tile
+      /// \return A \c Future to the tile at index i
+      /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+      /// \throw TiledArray::Exception When tile \c i a zero tile.
+      virtual Future<value_type> get_tile(size_type i) const {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+
+        // Result tiles are computed by their owner
+        const madness::DistributedID key(DistEvalImpl_::id(), i);
+        return TensorImpl_::world().gop.template recv<value_type>(
+            TensorImpl_::world().rank(), key);
+      }
+
+      /// Discard a tile that is not needed
+
+      /// This function handles the cleanup for tiles that are not needed in
+      /// subsequent computation.
+      /// \param i The index of the tile
+      virtual void discard_tile(size_type i) const { get_tile(i); }
+
+    private:
+
+      /// Map an argument tile to a result tile
+
+      /// \param i The ordinal index of an argument tile
+      /// \return The (unpermuted) ordinal index of the result tile to which
+      /// tile \c i is added
+      size_type source_index(size_type i) const {
+        size_type result = 0ul;
+        for(unsigned int d = arg_extent_.size(); d > 0u; ) {
+          --d;
+          result += weight_[d] * (i % arg_extent_[d]);
+          i /= arg_extent_[d];
+        }
+        return result;
+      }
+
+      /// Visit the argument tiles of a result tile
+
+      /// \tparam F The visitor type
+      /// \param source The (unpermuted) ordinal index of a result tile
+      /// \param f The visitor, which is called with the ordinal index of each
+      /// argument tile that is added to result tile \c source
+      template <typename F>
+      void for_each_arg_tile(size_type source, F&& f) const {
+        const unsigned int rank = arg_extent_.size();
+        const std::vector<unsigned int>& dims = op_.dims();
+
+        // Compute the argument strides and the offset of the first tile
+        std::vector<size_type> stride(rank);
+        size_type offset = 0ul;
+        size_type s = 1ul;
+        for(unsigned int d = rank; d > 0u; ) {
+          --d;
+          stride[d] = s;
+          s *= arg_extent_[d];
+          if(weight_[d]) {
+            offset += stride[d] * (source % arg_extent_[d]);
+            source /= arg_extent_[d];
+          }
+        }
+
+        // Iterate over the tiles of the summed dimensions
+        std::vector<size_type> index(dims.size(), 0ul);
+        bool done = false;
+        while(! done) {
+          f(offset);
+
+          done = true;
+          for(unsigned int x = dims.size(); x > 0u; ) {
+            --x;
+            const unsigned int d = dims[x];
+            offset += stride[d];
+            if(++index[x] < arg_extent_[d]) {
+              done = false;
+              break;
+            }
+            offset -= stride[d] * index[x];
+            index[x] = 0ul;
+          }
+        }
+      }
+
+      /// Task function for summing an argument tile
+
+      /// \param index The index of the argument tile
+      /// \param tile The argument tile
+      /// \return The partial sum of \c tile
+      template <typename Tile>
+      value_type sum_tile(const size_type index, const Tile& tile) {
+        TaskTraceScope trace("sum_over_eval", index);
+        return sum_arg(tile);
+      }
+
+      template <typename Tile>
+      typename std::enable_if<! is_lazy_tile<Tile>::value, value_type>::type
+      sum_arg(const Tile& tile) const { return op_(tile); }
+
+      template <typename Tile>
+      typename std::enable_if<is_lazy_tile<Tile>::value, value_type>::type
+      sum_arg(const Tile& tile) const {
+        TiledArray::Cast<typename eval_trait<Tile>::type, Tile> cast;
+        return op_(cast(tile));
+      }
+
+      /// Add two partial sums
+
+      /// \param left The left-hand partial sum
+      /// \param right The right-hand partial sum
+      /// \return The sum of \c left and \c right
+      static value_type add_tiles(const value_type& left, const value_type& right) {
+        using TiledArray::add;
+        return add(left, right);
+      }
+
+      /// Add partial sums in a binary tree of tasks
+
+      /// \param[in,out] tiles The partial sums, which are replaced with
+      /// intermediate sums
+      /// \return The sum of \c tiles
+      Future<value_type> sum_tiles(std::vector<Future<value_type> >& tiles) const {
+        TA_ASSERT(! tiles.empty());
+        World& world = TensorImpl_::world();
+        while(tiles.size() > 1ul) {
+          std::size_t n = 0ul;
+          for(std::size_t j = 0ul; (j + 1ul) < tiles.size(); j += 2ul)
+            tiles[n++] = world.taskq.add(& SumOverEvalImpl_::add_tiles,
+                tiles[j], tiles[j + 1ul], madness::TaskAttributes::hipri());
+          if(tiles.size() & 1ul)
+            tiles[n++] = tiles.back();
+          tiles.resize(n);
+        }
+        return tiles.front();
+      }
+
+      /// Task function that sets a result tile
+
+      /// \param index The (permuted) index of the result tile
+      /// \param tile The (unpermuted) sum of the result tile
+      void set_sum_tile(const size_type index, const value_type& tile) {
+        if(op_.perm()) {
+          using TiledArray::permute;
+          DistEvalImpl_::set_tile(index, permute(tile, op_.perm()));
+        } else {
+          DistEvalImpl_::set_tile(index, tile);
+        }
+      }
+
+      /// Evaluate the tiles of this tensor
+
+      /// This function will evaluate the children of this distributed evaluator
+      /// and evaluate the tiles for this distributed evaluator. It will block
+      /// until the tasks for the children are evaluated (not for the tasks of
+      /// this object).
+      /// \return The number of tiles that will be set by this process
+      virtual int internal_eval() {
+        typedef typename arg_type::value_type arg_value_type;
+
+        // Evaluate child tensors
+        arg_.eval();
+
+        World& world = TensorImpl_::world();
+        const ProcessID rank = world.rank();
+        std::shared_ptr<SumOverEvalImpl_> self = shared_from_this();
+
+        // The partial sums of the processes have keys that follow the result
+        // tile keys, and are identified by the first argument tile of the sum
+        const size_type key_offset = TensorImpl_::size();
+
+        // Group the local argument tiles by result tile
+        std::map<size_type, std::vector<size_type> > groups;
+        {
+          typename pmap_interface::const_iterator it = arg_.pmap()->begin();
+          const typename pmap_interface::const_iterator end = arg_.pmap()->end();
+          for(; it != end; ++it) {
+            const size_type i = *it;
+            if(arg_.is_zero(i))
+              continue;
+            const size_type target =
+                DistEvalImpl_::perm_index_to_target(source_index(i));
+            if(TensorImpl_::is_zero(target)) {
+              arg_.discard(i);
+              continue;
+            }
+            groups[target].push_back(i);
+          }
+        }
+
+        // Sum the local argument tiles of each result tile, and send the
+        // partial sums to the owners of the result tiles
+        std::unordered_map<size_type, Future<value_type> > local_sums;
+        std::vector<Future<value_type> > tiles;
+        for(auto& group : groups) {
+          tiles.clear();
+          for(const size_type i : group.second)
+            tiles.push_back(world.taskq.add(self,
+                & SumOverEvalImpl_::template sum_tile<arg_value_type>,
+                i, arg_.get(i), madness::TaskAttributes::hipri()));
+          const Future<value_type> partial = sum_tiles(tiles);
+
+          const ProcessID owner = TensorImpl_::owner(group.first);
+          if(owner == rank) {
+            local_sums.emplace(group.first, partial);
+          } else {
+            const size_type first =
+                *std::min_element(group.second.begin(), group.second.end());
+            world.gop.send(owner, madness::DistributedID(DistEvalImpl_::id(),
+                key_offset + first), partial);
+          }
+        }
+
+        // Add the partial sums of the local result tiles
+        size_type task_count = 0ul;
+        std::map<ProcessID, size_type> firsts;
+        typename pmap_interface::const_iterator it = TensorImpl_::pmap()->begin();
+        const typename pmap_interface::const_iterator end = TensorImpl_::pmap()->end();
+        for(; it != end; ++it) {
+          const size_type target = *it;
+          if(TensorImpl_::is_zero(target))
+            continue;
+
+          // Find the first argument tile of each process that sums this tile
+          firsts.clear();
+          for_each_arg_tile(DistEvalImpl_::perm_index_to_source(target),
+              [&] (const size_type i) {
+                if(arg_.is_zero(i))
+                  return;
+                const auto result = firsts.emplace(arg_.owner(i), i);
+                if(! result.second)
+                  result.first->second = std::min(result.first->second, i);
+              });
+
+          tiles.clear();
+          for(const auto& first : firsts) {
+            if(first.first == rank) {
+              TA_ASSERT(local_sums.find(target) != local_sums.end());
+              tiles.push_back(local_sums[target]);
+            } else {
+              tiles.push_back(world.gop.template recv<value_type>(first.first,
+                  madness::DistributedID(DistEvalImpl_::id(),
+                  key_offset + first.second)));
+            }
+          }
+
+          if(tiles.empty()) {
+            // All argument tiles of this tile are zero
+            DistEvalImpl_::set_tile(target, value_type(
+                TensorImpl_::trange().make_tile_range(target), 0));
+          } else {
+            world.taskq.add(self, & SumOverEvalImpl_::set_sum_tile, target,
+                sum_tiles(tiles));
+          }
+
+          ++task_count;
+        }
+
+        // Wait for child tensors to be evaluated, and process tasks while waiting.
+        arg_.wait();
+
+        return task_count;
+      }
+
+    }; // class SumOverEvalImpl
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_SUM_OVER_EVAL_H__INCLUDED
@@ -0,0 +1,196 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  summa_bcast_cache.cpp
+ *  Apr 12, 2017
+ *
+ */
+
+#include <TiledArray/dist_eval/summa_bcast_cache.h>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace TiledArray {
+  namespace {
+
+    /// Cached SUMMA broadcasts, in least recently used order
+    class SummaBcastCache {
+      typedef std::tuple<std::string, std::shared_ptr<void>, std::size_t>
+          entry_type; ///< Key, broadcasts, and bytes
+
+      std::mutex lock_; ///< Protects the cache
+      std::list<entry_type> entries_; ///< The broadcasts, most recently used first
+      std::unordered_map<std::string, std::list<entry_type>::iterator> index_;
+          ///< The position of each argument in \c entries_
+      std::size_t capacity_; ///< The largest number of bytes
+      std::size_t size_; ///< The number of bytes held
+
+      /// Remove the least recently used broadcasts that exceed the capacity
+
+      /// \param[out] removed The removed broadcasts, which are released after the
+      /// lock
+      void trim(std::list<entry_type>& removed) {
+        while(size_ > capacity_) {
+          size_ -= std::get<2>(entries_.back());
+          index_.erase(std::get<0>(entries_.back()));
+          removed.splice(removed.begin(), entries_, std::prev(entries_.end()));
+        }
+      }
+
+    public:
+
+      SummaBcastCache() : lock_(), entries_(), index_(),
+        capacity_([] () -> std::size_t {
+          const char* capacity = getenv("TA_SUMMA_BCAST_CACHE_CAPACITY");
+          return (capacity ? std::strtoul(capacity, nullptr, 10) : 0ul);
+        }()),
+        size_(0ul)
+      { }
+
+      std::size_t capacity() {
+        std::lock_guard<std::mutex> locker(lock_);
+        return capacity_;
+      }
+
+      void capacity(const std::size_t capacity) {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        capacity_ = capacity;
+        trim(removed);
+      }
+
+      std::size_t size() {
+        std::lock_guard<std::mutex> locker(lock_);
+        return size_;
+      }
+
+      void clear() {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        index_.clear();
+        removed.swap(entries_);
+        size_ = 0ul;
+      }
+
+      std::shared_ptr<void> find(const std::string& key) {
+        std::lock_guard<std::mutex> locker(lock_);
+        auto it = index_.find(key);
+        if(it == index_.end())
+          return std::shared_ptr<void>();
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return std::get<1>(*it->second);
+      }
+
+      bool insert(const std::string& key, const std::shared_ptr<void>& bcasts,
+          const std::size_t bytes)
+      {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        if(bytes > capacity_)
+          return false;
+        auto it = index_.find(key);
+        if(it != index_.end()) {
+          size_ -= std::get<2>(*it->second);
+          removed.splice(removed.begin(), entries_, it->second);
+        }
+        entries_.emplace_front(key, bcasts, bytes);
+        index_[key] = entries_.begin();
+        size_ += bytes;
+        trim(removed);
+        return true;
+      }
+
+    }; // class SummaBcastCache
+
+    SummaBcastCache& summa_bcast_cache() {
+      static SummaBcastCache cache;
+      return cache;
+    }
+
+    /// The broadcasts that are held for \c SummaBcastScope objects
+    struct BcastScope {
+      std::mutex lock; ///< Protects the scope
+      std::size_t depth = 0ul; ///< The number of \c SummaBcastScope objects
+      std::unordered_map<std::string, std::shared_ptr<void> > bcasts;
+          ///< The broadcasts, by key
+    }; // struct BcastScope
+
+    BcastScope& bcast_scope() {
+      static BcastScope scope;
+      return scope;
+    }
+
+  }  // namespace
+
+  std::size_t summa_bcast_cache_capacity() { return summa_bcast_cache().capacity(); }
+
+  void summa_bcast_cache_capacity(const std::size_t capacity) {
+    summa_bcast_cache().capacity(capacity);
+  }
+
+  std::size_t summa_bcast_cache_size() { return summa_bcast_cache().size(); }
+
+  void clear_summa_bcast_cache() { summa_bcast_cache().clear(); }
+
+  SummaBcastScope::SummaBcastScope() {
+    std::lock_guard<std::mutex> locker(bcast_scope().lock);
+    ++bcast_scope().depth;
+  }
+
+  SummaBcastScope::~SummaBcastScope() {
+    // The broadcasts are released after the lock
+    std::unordered_map<std::string, std::shared_ptr<void> > removed;
+    std::lock_guard<std::mutex> locker(bcast_scope().lock);
+    if(--bcast_scope().depth == 0ul)
+      removed.swap(bcast_scope().bcasts);
+  }
+
+  namespace detail {
+
+    bool summa_bcast_scope_active() {
+      std::lock_guard<std::mutex> locker(bcast_scope().lock);
+      return bcast_scope().depth > 0ul;
+    }
+
+    std::shared_ptr<void> summa_bcast_cache_find(const std::string& key) {
+      {
+        std::lock_guard<std::mutex> locker(bcast_scope().lock);
+        auto it = bcast_scope().bcasts.find(key);
+        if(it != bcast_scope().bcasts.end())
+          return it->second;
+      }
+      return summa_bcast_cache().find(key);
+    }
+
+    bool summa_bcast_cache_insert(const std::string& key,
+        const std::shared_ptr<void>& bcasts, const std::size_t bytes)
+    {
+      {
+        std::lock_guard<std::mutex> locker(bcast_scope().lock);
+        if(bcast_scope().depth) {
+          bcast_scope().bcasts[key] = bcasts;
+          return true;
+        }
+      }
+      return summa_bcast_cache().insert(key, bcasts, bytes);
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
@@ -0,0 +1,130 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  summa_bcast_cache.h
+ *  Apr 12, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_SUMMA_BCAST_CACHE_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_SUMMA_BCAST_CACHE_H__INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace TiledArray {
+
+  /// SUMMA broadcast cache capacity accessor
+
+  /// The SUMMA broadcast cache holds the columns of the left-hand argument
+  /// of dense contractions that each process received from the broadcasts
+  /// of its process row, so that a later contraction of the same array on
+  /// the same process grid, e.g. with another right-hand argument, reuses
+  /// them instead of broadcasting them again. The capacity is initialized
+  /// with the \c TA_SUMMA_BCAST_CACHE_CAPACITY environment variable, in
+  /// bytes per process; the default capacity is zero, which disables the
+  /// cache. The size of an argument is estimated from its tiled range, so
+  /// that all processes hold the same arguments; the capacity must be equal
+  /// on all processes.
+  /// \return The largest number of bytes held by the SUMMA broadcast cache
+  std::size_t summa_bcast_cache_capacity();
+
+  /// Set the SUMMA broadcast cache capacity
+
+  /// The least recently used arguments are removed when the cache holds more
+  /// than \c capacity bytes. This function must be called by all processes,
+  /// in the same order relative to the evaluation of contractions.
+  /// \param capacity The largest number of bytes held by the SUMMA broadcast
+  /// cache; zero disables caching
+  void summa_bcast_cache_capacity(const std::size_t capacity);
+
+  /// Size of the cached SUMMA broadcasts
+
+  /// \return The estimated number of bytes held by the SUMMA broadcast cache
+  std::size_t summa_bcast_cache_size();
+
+  /// Remove all arguments from the SUMMA broadcast cache
+
+  /// The cached arguments are identified by the array, so the cache must be
+  /// cleared when the tiles of a cached array are modified. This function
+  /// must be called by all processes, in the same order relative to the
+  /// evaluation of contractions. \c TiledArray::finalize() clears the cache.
+  void clear_summa_bcast_cache();
+
+  /// Share the SUMMA broadcasts of array arguments
+
+  /// While an object of this class exists, a dense contraction whose
+  /// left-hand argument is an array reuses the column broadcasts of a
+  /// previous contraction of the same array on the same process grid, as
+  /// with the SUMMA broadcast cache, but regardless of its capacity. The
+  /// broadcasts are held until the last object is destroyed. Contractions
+  /// that are evaluated asynchronously in the scope of the object share the
+  /// broadcasts while they run, e.g.
+  /// \code
+  /// {
+  ///   SummaBcastScope scope;
+  ///   auto h1 = c1("i,j").assign_async(a("i,k") * b1("k,j"));
+  ///   auto h2 = c2("i,j").assign_async(a("i,k") * b2("k,j"));
+  ///   h1.wait();
+  ///   h2.wait();
+  /// }
+  /// \endcode
+  /// broadcasts the columns of \c a once. Objects must be constructed and
+  /// destroyed by all processes, in the same order relative to the
+  /// evaluation of contractions.
+  class SummaBcastScope {
+  public:
+    SummaBcastScope();
+    ~SummaBcastScope();
+
+    SummaBcastScope(const SummaBcastScope&) = delete;
+    SummaBcastScope& operator=(const SummaBcastScope&) = delete;
+  }; // class SummaBcastScope
+
+  namespace detail {
+
+    /// Check for a \c SummaBcastScope object
+
+    /// \return \c true if a \c SummaBcastScope object exists
+    bool summa_bcast_scope_active();
+
+    /// Find the cached broadcasts of a SUMMA argument
+
+    /// The broadcasts held for a \c SummaBcastScope object are searched
+    /// first.
+    /// \param key The SUMMA broadcast cache key
+    /// \return A pointer to the cached broadcasts, or null if there are no
+    /// broadcasts for \c key
+    std::shared_ptr<void> summa_bcast_cache_find(const std::string& key);
+
+    /// Add the broadcasts of a SUMMA argument to the cache
+
+    /// \param key The SUMMA broadcast cache key
+    /// \param bcasts A pointer to the broadcasts
+    /// \param bytes The estimated size of the broadcasts, which must be
+    /// equal on all processes
+    /// \return \c true if the broadcasts were added, or \c false if they are
+    /// larger than the capacity. They are always added, and held until the
+    /// end of the scope, when a \c SummaBcastScope object exists.
+    bool summa_bcast_cache_insert(const std::string& key,
+        const std::shared_ptr<void>& bcasts, const std::size_t bytes);
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_SUMMA_BCAST_CACHE_H__INCLUDED
@@ -0,0 +1,182 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  summa_schedule.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_SUMMA_SCHEDULE_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_SUMMA_SCHEDULE_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The recorded schedule of a SUMMA contraction
+
+    /// The schedule of \c Summa on one process, i.e. the screened argument
+    /// tiles, the order of the inner iterations, the non-zero iterations
+    /// that are found by the sparse search, and the process masks of the
+    /// broadcast groups, only depends on the shapes and the process grid of
+    /// the contraction. A contraction engine records the schedule while it
+    /// is evaluated, and later evaluations of the same engine, e.g. by
+    /// \c ExprPlan , replay it instead of searching the shapes again. The
+    /// engine starts a new schedule when its shapes are recomputed. The
+    /// iterations and masks are recorded as they are computed, so an
+    /// evaluation replays what the previous evaluations recorded and records
+    /// the rest. The screens are recorded with the screening parameters of
+    /// the first evaluation, e.g. \c SparseShape::error_budget() .
+    class SummaSchedule {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+      mutable madness::Spinlock lock_; ///< Protects the recorded steps and masks
+      std::unordered_map<size_type, size_type> steps_; ///< The next non-zero
+          ///< iteration, by the first iteration of the search
+      std::unordered_map<size_type, std::vector<bool> > row_masks_; ///< The
+          ///< row broadcast group masks, by inner tile index
+      std::unordered_map<size_type, std::vector<bool> > col_masks_; ///< The
+          ///< column broadcast group masks, by inner tile index
+      bool screened_; ///< The screens and order are recorded
+      std::vector<bool> left_screen_; ///< The screened left-hand tiles
+      std::vector<bool> right_screen_; ///< The screened right-hand tiles
+      std::vector<double> pair_threshold_; ///< The pair screening thresholds
+      std::vector<size_type> k_order_; ///< The order of the inner iterations
+
+      /// Find a recorded value, or compute and record it
+
+      /// \tparam T The value type
+      /// \tparam Op The operation type
+      /// \param map The recorded values
+      /// \param key The key of the value
+      /// \param op The operation that computes the value
+      /// \return The value of \c key
+      template <typename T, typename Op>
+      T find_or_record(std::unordered_map<size_type, T>& map,
+          const size_type key, const Op& op)
+      {
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& lock_);
+          auto it = map.find(key);
+          if(it != map.end())
+            return it->second;
+        }
+
+        // Compute the value outside of the lock, since it searches the shapes
+        T value = op();
+        madness::ScopedMutex<madness::Spinlock> locker(& lock_);
+        map.emplace(key, value);
+        return value;
+      }
+
+    public:
+
+      SummaSchedule() :
+        lock_(), steps_(), row_masks_(), col_masks_(), screened_(false),
+        left_screen_(), right_screen_(), pair_threshold_(), k_order_()
+      { }
+
+      SummaSchedule(const SummaSchedule&) = delete;
+      SummaSchedule& operator=(const SummaSchedule&) = delete;
+
+      /// The next non-zero iteration
+
+      /// \tparam Op The search operation type
+      /// \param p The first iteration of the search
+      /// \param op The search operation, which returns the next non-zero
+      /// iteration
+      /// \return The first non-zero iteration that is greater than or equal
+      /// to \c p
+      template <typename Op>
+      size_type step(const size_type p, const Op& op) {
+        return find_or_record(steps_, p, op);
+      }
+
+      /// The process mask of a row broadcast group
+
+      /// \tparam Op The mask operation type
+      /// \param k The inner tile index
+      /// \param op The operation that computes the mask
+      /// \return The mask of the processes in this process row
+      template <typename Op>
+      std::vector<bool> row_mask(const size_type k, const Op& op) {
+        return find_or_record(row_masks_, k, op);
+      }
+
+      /// The process mask of a column broadcast group
+
+      /// \tparam Op The mask operation type
+      /// \param k The inner tile index
+      /// \param op The operation that computes the mask
+      /// \return The mask of the processes in this process column
+      template <typename Op>
+      std::vector<bool> col_mask(const size_type k, const Op& op) {
+        return find_or_record(col_masks_, k, op);
+      }
+
+      /// Record the screens and the iteration order
+
+      /// This function is called by the constructor of \c Summa , so it is
+      /// not concurrent with other evaluations of the engine.
+      /// \param left_screen The screened left-hand tiles
+      /// \param right_screen The screened right-hand tiles
+      /// \param pair_threshold The pair screening thresholds
+      /// \param k_order The order of the inner iterations
+      void record_screen(const std::vector<bool>& left_screen,
+          const std::vector<bool>& right_screen,
+          const std::vector<double>& pair_threshold,
+          const std::vector<size_type>& k_order)
+      {
+        left_screen_ = left_screen;
+        right_screen_ = right_screen;
+        pair_threshold_ = pair_threshold;
+        k_order_ = k_order;
+        screened_ = true;
+      }
+
+      /// Replay the screens and the iteration order
+
+      /// \param[out] left_screen The screened left-hand tiles
+      /// \param[out] right_screen The screened right-hand tiles
+      /// \param[out] pair_threshold The pair screening thresholds
+      /// \param[out] k_order The order of the inner iterations
+      /// \return \c true if the screens were recorded
+      bool replay_screen(std::vector<bool>& left_screen,
+          std::vector<bool>& right_screen, std::vector<double>& pair_threshold,
+          std::vector<size_type>& k_order) const
+      {
+        if(! screened_)
+          return false;
+        left_screen = left_screen_;
+        right_screen = right_screen_;
+        pair_threshold = pair_threshold_;
+        k_order = k_order_;
+        return true;
+      }
+
+    }; // class SummaSchedule
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_SUMMA_SCHEDULE_H__INCLUDED
@@ -0,0 +1,287 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  summa_trace.h
+ *  Jan 9, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_SUMMA_TRACE_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_SUMMA_TRACE_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/type_traits.h>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Trace data for a single SUMMA iteration on this process
+
+    /// Times are measured with \c madness::wall_time() . The wait time is the
+    /// time between the start of the SUMMA step and the arrival of the last
+    /// column/row tile used by this process in the step; the contraction time
+    /// is the time between the arrival of the last tile and the completion of
+    /// the last tile contraction of the step.
+    struct SummaIterationTrace {
+      madness::uniqueidT id; ///< The id of the SUMMA evaluator
+      std::size_t k; ///< The SUMMA iteration (i.e. contraction tile) index
+      std::size_t tiles; ///< Number of column and row tiles used in this iteration
+      std::size_t bytes; ///< Size of the column and row tiles in bytes
+      std::size_t contractions; ///< Number of tile contractions scheduled
+      std::size_t skipped_tiles; ///< Number of zero column and row tiles
+      std::size_t skipped_contractions; ///< Number of tile contractions skipped for zero result tiles
+      double start_time; ///< The wall time at the start of the step
+      double wait_time; ///< Time spent waiting for broadcast tiles
+      double contract_time; ///< Time spent in tile contractions
+    }; // struct SummaIterationTrace
+
+    /// Per-process collection of SUMMA iteration traces
+
+    /// Tracing is disabled by default. It is enabled when the \c TA_SUMMA_TRACE
+    /// environment variable is set to a non-zero value, or by calling
+    /// \c enable(). Traces are accumulated for all SUMMA evaluations on this
+    /// process until \c clear() is called, and may be printed after the
+    /// contraction has been evaluated, e.g.
+    /// \code
+    /// TiledArray::detail::SummaTrace::instance().enable();
+    /// c("i,j") = a("i,k") * b("k,j");
+    /// world.gop.fence();
+    /// TiledArray::detail::SummaTrace::instance().print(std::cout, world.rank());
+    /// \endcode
+    class SummaTrace {
+    private:
+      volatile bool enabled_; ///< Tracing flag
+      mutable madness::Mutex mutex_; ///< Protects \c traces_
+      std::vector<SummaIterationTrace> traces_; ///< Iteration traces
+
+      SummaTrace() : enabled_(init_enabled()), mutex_(), traces_() { }
+
+      static bool init_enabled() {
+        const char* trace = getenv("TA_SUMMA_TRACE");
+        return trace && (std::atoi(trace) != 0);
+      }
+
+    public:
+
+      SummaTrace(const SummaTrace&) = delete;
+      SummaTrace& operator=(const SummaTrace&) = delete;
+
+      /// Trace object accessor
+
+      /// \return A reference to the trace object of this process
+      static SummaTrace& instance() {
+        static SummaTrace trace;
+        return trace;
+      }
+
+      /// Tracing flag accessor
+
+      /// \return \c true if SUMMA iterations are traced
+      bool enabled() const { return enabled_; }
+
+      /// Enable or disable tracing
+
+      /// \note Only SUMMA evaluations started after this call are affected.
+      /// \param flag The new tracing flag
+      void enable(const bool flag = true) { enabled_ = flag; }
+
+      /// Record an iteration trace
+
+      /// \param trace The trace to be recorded
+      void record(const SummaIterationTrace& trace) {
+        madness::ScopedMutex<madness::Mutex> lock(mutex_);
+        traces_.push_back(trace);
+      }
+
+      /// Iteration trace accessor
+
+      /// \return A copy of the iteration traces recorded on this process
+      std::vector<SummaIterationTrace> traces() const {
+        madness::ScopedMutex<madness::Mutex> lock(mutex_);
+        return traces_;
+      }
+
+      /// Remove all recorded traces
+      void clear() {
+        madness::ScopedMutex<madness::Mutex> lock(mutex_);
+        traces_.clear();
+      }
+
+      /// Print the recorded traces
+
+      /// One line is printed per iteration, in the order the iterations
+      /// completed.
+      /// \param os The output stream
+      /// \param rank The rank of this process, used to label the output
+      void print(std::ostream& os, const ProcessID rank) const {
+        std::stringstream ss;
+        ss << "summa trace: rank=" << rank << "\n"
+           << "  id k tiles bytes contractions skipped_tiles skipped_contractions"
+              " start_time wait_time contract_time\n";
+        ss << std::scientific << std::setprecision(6);
+        for(const SummaIterationTrace& t : traces()) {
+          ss << "  " << t.id << " " << t.k << " " << t.tiles << " " << t.bytes
+             << " " << t.contractions << " " << t.skipped_tiles << " "
+             << t.skipped_contractions << " " << t.start_time << " "
+             << t.wait_time << " " << t.contract_time << "\n";
+        }
+        os << ss.str();
+      }
+
+    }; // class SummaTrace
+
+
+    /// SUMMA iteration tracer
+
+    /// This object records the wait and contraction times of a single SUMMA
+    /// iteration. It is a callback for the tile contractions of the
+    /// iteration, which forwards the notification to the step task that
+    /// depends on the contractions. The object records the iteration trace
+    /// and deletes itself once the column and row tiles have arrived, all tile
+    /// contractions have completed, and \c release() has been called.
+    /// \tparam Col The column datum type, a pair of a local index and a tile future
+    /// \tparam Row The row datum type, a pair of a local index and a tile future
+    template <typename Col, typename Row>
+    class SummaIterationTracer : public madness::CallbackInterface {
+    private:
+
+      /// Arrival callback for column and row tiles
+      class ArrivalCallback : public madness::CallbackInterface {
+        SummaIterationTracer* owner_;
+      public:
+        ArrivalCallback(SummaIterationTracer* owner) : owner_(owner) { }
+        virtual ~ArrivalCallback() { }
+        virtual void notify() { owner_->arrived(); }
+      }; // class ArrivalCallback
+
+      SummaIterationTrace trace_; ///< The trace data
+      std::vector<Col> col_; ///< The column tiles
+      std::vector<Row> row_; ///< The row tiles
+      madness::CallbackInterface* callback_; ///< The contraction dependent
+      ArrivalCallback arrival_callback_; ///< Column and row tile callback
+      madness::AtomicInt arrivals_; ///< Pending column and row tiles
+      madness::AtomicInt pending_; ///< Pending completion events
+      double ready_time_; ///< The time at which the last tile arrived
+
+      template <typename Tile>
+      static std::size_t tile_bytes(const Tile& tile) {
+        return tile.size() * sizeof(typename numeric_type<Tile>::type);
+      }
+
+      template <typename Datum>
+      void register_arrival(std::vector<Datum>& vec) {
+        for(Datum& datum : vec) {
+          if(! datum.second.probe()) {
+            arrivals_++;
+            datum.second.register_callback(& arrival_callback_);
+          }
+        }
+      }
+
+      /// Complete a pending event and record the trace after the last one
+      void complete() {
+        if((--pending_) == 0) {
+          const double finish_time = madness::wall_time();
+          trace_.wait_time = ready_time_ - trace_.start_time;
+          trace_.contract_time = finish_time - ready_time_;
+          SummaTrace::instance().record(trace_);
+          delete this;
+        }
+      }
+
+      /// Column and row tile arrival callback
+      void arrived() {
+        if((--arrivals_) == 0) {
+          ready_time_ = madness::wall_time();
+
+          // Tile sizes are only available after the tiles have arrived.
+          std::size_t bytes = 0ul;
+          for(Col& datum : col_)
+            bytes += tile_bytes(datum.second.get());
+          for(Row& datum : row_)
+            bytes += tile_bytes(datum.second.get());
+          trace_.bytes = bytes;
+
+          complete();
+        }
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param id The id of the SUMMA evaluator
+      /// \param k The SUMMA iteration index
+      /// \param col The column tiles used in iteration \c k
+      /// \param row The row tiles used in iteration \c k
+      /// \param max_tiles The total number of column and row tiles, including
+      /// zero tiles, in iteration \c k on this process
+      /// \param callback The task that depends on the tile contractions
+      SummaIterationTracer(const madness::uniqueidT& id, const std::size_t k,
+          const std::vector<Col>& col, const std::vector<Row>& row,
+          const std::size_t max_tiles, madness::CallbackInterface* callback) :
+        trace_(), col_(col), row_(row), callback_(callback),
+        arrival_callback_(this), arrivals_(), pending_(), ready_time_(0.0)
+      {
+        trace_.id = id;
+        trace_.k = k;
+        trace_.tiles = col_.size() + row_.size();
+        trace_.skipped_tiles = max_tiles - trace_.tiles;
+        trace_.start_time = madness::wall_time();
+
+        // The pending events are the arrival of the tiles and release().
+        pending_ = 2;
+        arrivals_ = 1;
+        register_arrival(col_);
+        register_arrival(row_);
+        arrived();
+      }
+
+      virtual ~SummaIterationTracer() { }
+
+      /// Count a tile contraction of this iteration
+
+      /// \return A pointer to the callback to be notified when the tile
+      /// contraction is complete
+      madness::CallbackInterface* contraction() {
+        ++trace_.contractions;
+        pending_++;
+        return this;
+      }
+
+      /// Count a tile contraction skipped because the result tile is zero
+      void skip() { ++trace_.skipped_contractions; }
+
+      /// Tile contraction completion callback
+      virtual void notify() {
+        if(callback_)
+          callback_->notify();
+        complete();
+      }
+
+      /// Signal that all tile contractions have been scheduled
+      void release() { complete(); }
+
+    }; // class SummaIterationTracer
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_SUMMA_TRACE_H__INCLUDED
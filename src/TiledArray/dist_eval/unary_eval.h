@@ -108,7 +108,26 @@ namespace TiledArray {
       /// \param i The tile index
       /// \param tile The tile to be evaluated
       void eval_tile(const size_type i, tile_argument_type tile) {
-        DistEvalImpl_::set_tile(i, op_(tile));
+        TaskTraceScope trace("unary_eval", i);
+        if(DistEvalImpl_::profile()) {
+          const void* const arg_data = tile_data(tile);
+          const value_type result = op_(tile);
+          DistEvalImpl_::profile_in_place(tile_data(result), { arg_data });
+          DistEvalImpl_::set_tile(i, result);
+        } else {
+          DistEvalImpl_::set_tile(i, op_(tile));
+        }
+      }
+
+      /// Task function for evaluating a batch of small tiles
+
+      /// \param indices The tile indices
+      /// \param tiles The tiles to be evaluated
+      void eval_tiles(const std::vector<size_type>& indices,
+          std::vector<Future<typename arg_type::value_type> > tiles)
+      {
+        for(std::size_t i = 0ul; i < indices.size(); ++i)
+          eval_tile(indices[i], tiles[i].get());
       }
 
       /// Evaluate the tiles of this tensor
@@ -126,9 +145,22 @@ namespace TiledArray {
         // Evaluate argument
         arg_.eval();
 
-        // Counter for the number of tasks submitted by this object
+        // Counter for the number of tiles evaluated by this object
         size_type task_count = 0ul;
 
+        // The batch of small tiles that are evaluated by one task
+        const std::size_t max_batch_volume = tile_batch_volume();
+        std::vector<size_type> batch_indices;
+        std::vector<Future<typename arg_type::value_type> > batch_tiles;
+        std::size_t batch_volume = 0ul;
+        auto submit_batch = [&] () {
+          TensorImpl_::world().taskq.add(self, & UnaryEvalImpl_::eval_tiles,
+              batch_indices, batch_tiles);
+          batch_indices.clear();
+          batch_tiles.clear();
+          batch_volume = 0ul;
+        };
+
         // Make sure all local tiles are present.
         const typename pmap_interface::const_iterator end = arg_.pmap()->end();
         typename pmap_interface::const_iterator it = arg_.pmap()->begin();
@@ -140,13 +172,26 @@ namespace TiledArray {
             // Get target tile index
             const size_type target_index = DistEvalImpl_::perm_index_to_target(index);
 
-            // Schedule tile evaluation task
-            TensorImpl_::world().taskq.add(self, & UnaryEvalImpl_::eval_tile,
-                target_index, arg_.get(index));
+            const std::size_t volume = (max_batch_volume ?
+                TensorImpl_::trange().make_tile_range(target_index).volume() : 0ul);
+            if(volume && (volume < max_batch_volume)) {
+              // Add a small tile to the batch
+              batch_indices.push_back(target_index);
+              batch_tiles.push_back(arg_.get(index));
+              batch_volume += volume;
+              if(batch_volume >= max_batch_volume)
+                submit_batch();
+            } else {
+              // Schedule tile evaluation task
+              TensorImpl_::world().taskq.add(self, & UnaryEvalImpl_::eval_tile,
+                  target_index, arg_.get(index));
+            }
 
             ++task_count;
           }
         }
+        if(! batch_indices.empty())
+          submit_batch();
 
         // Wait for local tiles of argument to be evaluated
         arg_.wait();
@@ -20,7 +20,21 @@
 #ifndef TILEDARRAY_DISTRIBUTED_STORAGE_H__INCLUDED
 #define TILEDARRAY_DISTRIBUTED_STORAGE_H__INCLUDED
 
+#include <TiledArray/comm_stats.h>
 #include <TiledArray/pmap/pmap.h>
+#include <TiledArray/tile_interface/add.h>
+#include <TiledArray/tile_interface/clone.h>
+#include <TiledArray/zero_copy.h>
+#include <TiledArray/memory_usage.h>
+#include <TiledArray/tile_spill.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
@@ -35,6 +49,37 @@ namespace TiledArray {
     /// is first accessed, though you may manually initialize an element with
     /// the \c insert() function. All elements are stored in \c Future ,
     /// which may be set only once.
+    ///
+    /// Copies of remote elements may be requested ahead of time with
+    /// \c prefetch() ; they are held in a bounded local cache until they are
+    /// requested with \c get() , which removes them from the cache.
+    ///
+    /// The memory footprint of the local elements and of the prefetch cache
+    /// is tracked as elements are set, and it is added to the footprint of
+    /// the world; see \c memory_usage() .
+    ///
+    /// Small elements that are set on, or requested from, other processes may
+    /// be aggregated into one active message per destination, see
+    /// \c aggregate_bytes() . When the process map knows the node layout,
+    /// e.g. \c HierarchicalPmap , only messages to other nodes are aggregated,
+    /// since messages within a node are cheap and are not delayed.
+    ///
+    /// Contributions from many processes may be summed into one element with
+    /// \c accumulate() ; contributions to remote elements are combined
+    /// locally and sent to the owner with one message per process.
+    ///
+    /// Local elements may be spilled to disk with \c spill() , which limits
+    /// the size of the local elements held in memory. The least recently used
+    /// elements are written to disk when the limit is exceeded, and they are
+    /// read back when they are accessed again.
+    ///
+    /// Alternatively, local elements may be held in a flat array that is
+    /// indexed by their local ordinal, see \c indexed_storage() , where
+    /// elements are accessed without locks.
+    ///
+    /// A container whose elements will not change may be frozen with
+    /// \c freeze() ; its local elements are then read without locks, and the
+    /// remote elements that it requests are cached until it is destroyed.
     /// \note This object is derived from \c WorldObject , which means
     /// the order of construction of object must be the same on all nodes. This
     /// can easily be achieved by only constructing world objects in the main
@@ -60,6 +105,167 @@ namespace TiledArray {
       const size_type max_size_; ///< The maximum number of elements that can be stored by this container
       std::shared_ptr<pmap_interface> pmap_; ///< The process map that defines the element distribution
       mutable container_type data_; ///< The local data container
+      std::shared_ptr<MemoryCounter> memory_; ///< The memory footprint of this container
+      std::function<std::size_t(size_type)> expected_bytes_;
+          ///< The expected footprint of an element that has not been set
+      std::shared_ptr<TileSpill> spill_; ///< The working set of spilled local elements
+      std::function<value_type(size_type)> generator_;
+          ///< Generates local elements on demand, if set
+      bool cache_generated_; ///< \c true if generated elements are stored
+      std::function<future(size_type)> remote_reader_;
+          ///< Reads remote elements without their owner, if set
+
+      /// A local element of indexed storage
+      struct IndexedSlot {
+        future value; ///< The element
+        std::atomic<bool> claimed; ///< \c true once the element was initialized
+
+        IndexedSlot() : value(), claimed(false) { }
+      }; // struct IndexedSlot
+
+      std::vector<size_type> local_indices_; ///< The sorted indices of the local elements of indexed storage
+      std::unique_ptr<IndexedSlot[]> slots_; ///< The local elements of indexed storage
+      mutable std::atomic<size_type> indexed_size_; ///< The number of initialized slots
+
+      /// The footprint of a prefetched element
+
+      /// The footprint is added to the cache when the element arrives, and it
+      /// is removed when the element leaves the cache, whichever comes first.
+      class PrefetchCharge {
+        std::shared_ptr<MemoryCounter> memory_; ///< The container footprint
+        madness::Spinlock lock_; ///< Protects the charge
+        std::size_t bytes_; ///< The footprint of the element
+        bool cached_; ///< \c true while the element is in the cache
+
+      public:
+
+        explicit PrefetchCharge(const std::shared_ptr<MemoryCounter>& memory) :
+          memory_(memory), lock_(), bytes_(0ul), cached_(true)
+        { }
+
+        void arrive(const std::size_t bytes) {
+          madness::ScopedMutex<madness::Spinlock> locker(lock_);
+          if(cached_) {
+            bytes_ = bytes;
+            memory_->add(MemoryCategory::cache, bytes);
+          }
+        }
+
+        void release() {
+          madness::ScopedMutex<madness::Spinlock> locker(lock_);
+          if(cached_) {
+            cached_ = false;
+            memory_->sub(MemoryCategory::cache, bytes_);
+          }
+        }
+      }; // class PrefetchCharge
+
+      /// A prefetched remote element
+      struct PrefetchEntry {
+        future value; ///< The remote element
+        std::size_t id; ///< The prefetch request id
+        std::shared_ptr<PrefetchCharge> charge; ///< The footprint of the element
+      };
+
+      /// Callback that records the footprint of an element when it is set
+      struct TrackElement : public madness::CallbackInterface {
+      private:
+        std::shared_ptr<MemoryCounter> memory_; ///< The container footprint
+        std::shared_ptr<PrefetchCharge> charge_; ///< The prefetch charge, if cached
+        std::shared_ptr<TileSpill> spill_; ///< The working set of local elements
+        future future_; ///< The tracked element
+        size_type index_; ///< The index of the tracked element
+        std::size_t pending_; ///< The expected footprint of the element
+
+      public:
+
+        TrackElement(const std::shared_ptr<MemoryCounter>& memory,
+            const std::shared_ptr<TileSpill>& spill, const future& f,
+            const size_type i, const std::size_t pending) :
+          memory_(memory), charge_(), spill_(spill), future_(f), index_(i),
+          pending_(pending)
+        { }
+
+        TrackElement(const std::shared_ptr<PrefetchCharge>& charge,
+            const future& f) :
+          memory_(), charge_(charge), spill_(), future_(f), index_(0ul),
+          pending_(0ul)
+        { }
+
+        virtual ~TrackElement() { }
+
+        virtual void notify() {
+          const std::size_t bytes = tile_bytes(future_.get());
+          if(charge_) {
+            charge_->arrive(bytes);
+          } else {
+            memory_->sub(MemoryCategory::pending, pending_);
+            memory_->add(MemoryCategory::local, bytes);
+            if(spill_)
+              spill_->insert(index_, bytes);
+          }
+          delete this;
+        }
+      }; // struct TrackElement
+
+      /// Small remote sets and gets that wait to be sent to one process
+      struct AggregateBuffer {
+        madness::Spinlock lock; ///< Protects the buffer
+        std::vector<size_type> set_indices; ///< The indices of the elements to be set
+        std::vector<value_type> set_values; ///< The values of the elements to be set
+        std::vector<size_type> get_indices; ///< The indices of the requested elements
+        std::vector<typename future::remote_refT> get_refs; ///< The futures of the requested elements
+        std::size_t bytes; ///< The size of the buffered elements and requests
+        bool scheduled; ///< \c true while a flush task is queued
+
+        AggregateBuffer() :
+          lock(), set_indices(), set_values(), get_indices(), get_refs(),
+          bytes(0ul), scheduled(false)
+        { }
+      }; // struct AggregateBuffer
+
+      std::size_t aggregate_bytes_; ///< The size of aggregated messages, or zero
+      std::unique_ptr<AggregateBuffer[]> aggregate_; ///< The buffer of each process
+      madness::Spinlock accumulate_lock_; ///< Protects the accumulated elements
+      std::unordered_map<size_type, value_type> accumulate_pending_;
+          ///< The combined contributions to remote elements that wait to be sent
+      bool accumulate_scheduled_; ///< \c true while a flush task is queued
+
+      /// The target of queued flush tasks
+
+      /// Flush tasks hold the guard instead of the storage object, which may
+      /// be destroyed before they run.
+      struct FlushGuard {
+        madness::Spinlock lock; ///< Held while a flush task runs
+        DistributedStorage_* storage; ///< The storage, or null once it is destroyed
+
+        explicit FlushGuard(DistributedStorage_* const s) : lock(), storage(s) { }
+      }; // struct FlushGuard
+
+      std::shared_ptr<FlushGuard> flush_guard_; ///< The target of flush tasks
+      mutable std::atomic<size_type> messages_sent_; ///< The number of set and get messages sent
+      mutable std::atomic<size_type> elements_sent_; ///< The number of elements set or requested by them
+
+      mutable madness::Spinlock prefetch_lock_; ///< Protects the prefetch cache
+      mutable std::unordered_map<key_type, PrefetchEntry> prefetch_cache_;
+          ///< Remote elements that were prefetched but not yet requested
+      mutable std::deque<std::pair<key_type, std::size_t> > prefetch_queue_;
+          ///< The prefetch requests, oldest first
+      mutable std::size_t prefetch_count_; ///< The number of prefetch requests
+      size_type prefetch_capacity_; ///< The maximum number of prefetched elements
+
+      /// A remote element cached by a frozen container
+      struct FrozenSlot {
+        future value; ///< The element
+        std::shared_ptr<PrefetchCharge> charge; ///< The footprint of the element
+      }; // struct FrozenSlot
+
+      bool frozen_; ///< \c true once the elements are read-only
+      std::vector<std::pair<key_type, future> > frozen_local_;
+          ///< The local elements of a frozen hash map, sorted by index
+      std::unique_ptr<std::atomic<FrozenSlot*>[]> frozen_remote_;
+          ///< The remote elements cached by a frozen container, by index; a
+          ///< slot is allocated when the element is first requested
 
       // not allowed
       DistributedStorage(const DistributedStorage_&);
@@ -68,12 +274,233 @@ namespace TiledArray {
       future get_local(const size_type i) const {
         TA_ASSERT(pmap_->is_local(i));
 
+        // Elements that are not cached are generated for each request.
+        if(generator_ && ! cache_generated_)
+          return generate(i);
+
+        // The elements of a frozen hash map are read without a lock.
+        if(! frozen_local_.empty()) {
+          const auto it = std::lower_bound(frozen_local_.begin(),
+              frozen_local_.end(), i,
+              [] (const std::pair<key_type, future>& element,
+                  const size_type index)
+              { return element.first < index; });
+          if((it != frozen_local_.end()) && (it->first == i))
+            return it->second;
+        }
+
+        if(slots_)
+          return get_indexed(i);
+
+        if(spill_)
+          return get_spilled(i);
+
         // Return the local element.
         const_accessor acc;
-        data_.insert(acc, i);
+        if(data_.insert(acc, i))
+          init_local(i, acc->second);
+        return acc->second;
+      }
+
+      /// The slot of local element \c i in indexed storage
+
+      /// \param i The element index
+      /// \return The slot of element \c i
+      IndexedSlot& indexed_slot(const size_type i) const {
+        const auto it = std::lower_bound(local_indices_.begin(),
+            local_indices_.end(), i);
+        TA_ASSERT((it != local_indices_.end()) && (*it == i));
+        return slots_[it - local_indices_.begin()];
+      }
+
+      /// Claim a slot of indexed storage
+
+      /// \param slot The slot of a local element
+      /// \return \c true if the caller is the first to claim \c slot , and
+      /// must initialize it
+      bool claim(IndexedSlot& slot) const {
+        if(slot.claimed.load(std::memory_order_acquire) || slot.claimed.exchange(true))
+          return false;
+        ++indexed_size_;
+        return true;
+      }
+
+      /// Get a local element from indexed storage
+
+      /// The slot is initialized by the first access; other accesses only
+      /// read it.
+      /// \param i The element index
+      /// \return A future to element \c i
+      future get_indexed(const size_type i) const {
+        IndexedSlot& slot = indexed_slot(i);
+        if(claim(slot))
+          init_local(i, slot.value);
+        return slot.value;
+      }
+
+      /// Generate local element \c i
+
+      /// \param i The element index
+      /// \return A future to element \c i , which is set by a task
+      future generate(const size_type i) const {
+        return get_world().taskq.add(generator_, i);
+      }
+
+      /// Initialize local element \c i , which was just inserted
+
+      /// The element is generated when this container has a generator, and
+      /// its footprint is tracked.
+      /// \param i The element index
+      /// \param f The future of element \c i
+      void init_local(const size_type i, const future& f) const {
+        track_local(i, f);
+        if(generator_)
+          const_cast<future&>(f).set(generate(i));
+      }
+
+      /// Get a local element that may have been spilled to disk
+
+      /// If element \c i was spilled, it is replaced with a future that is
+      /// set once the element has been read back.
+      /// \param i The element index
+      /// \return A future to element \c i
+      future get_spilled(const size_type i) const {
+        accessor acc;
+        if(data_.insert(acc, i)) {
+          init_local(i, acc->second);
+        } else {
+          Future<bool> written;
+          if(spill_->restore(i, written)) {
+            acc->second = get_world().taskq.add(& unspill_tile<value_type>,
+                spill_, i, written, madness::TaskAttributes::hipri());
+            track_local(i, acc->second);
+          } else {
+            spill_->touch(i);
+          }
+        }
         return acc->second;
       }
 
+      /// Take a remote element from the prefetch cache
+
+      /// \param i The element index
+      /// \param[out] result The prefetched element
+      /// \return \c true if element \c i was prefetched
+      bool take_prefetched(const size_type i, future& result) const {
+        madness::ScopedMutex<madness::Spinlock> locker(prefetch_lock_);
+        auto it = prefetch_cache_.find(i);
+        if(it == prefetch_cache_.end())
+          return false;
+        result = it->second.value;
+        it->second.charge->release();
+        prefetch_cache_.erase(it);
+        return true;
+      }
+
+      /// Get a remote element of a frozen container
+
+      /// The first request of element \c i allocates its slot and fetches
+      /// it, from the prefetch cache or from its owner, and later requests
+      /// share the cached copy without a lock.
+      /// \param i The element index
+      /// \return A future to element \c i
+      future get_frozen_remote(const size_type i) const {
+        std::atomic<FrozenSlot*>& ptr = frozen_remote_[i];
+        FrozenSlot* slot = ptr.load(std::memory_order_acquire);
+        if(! slot) {
+          // Only the thread that installs the slot fetches the element.
+          FrozenSlot* const claimed = new FrozenSlot();
+          if(ptr.compare_exchange_strong(slot, claimed,
+              std::memory_order_acq_rel, std::memory_order_acquire))
+          {
+            slot = claimed;
+            future result;
+            if(! take_prefetched(i, result))
+              result = get_remote(i);
+            slot->charge = std::make_shared<PrefetchCharge>(memory_);
+            result.register_callback(new TrackElement(slot->charge, result));
+            slot->value.set(result);
+          } else {
+            delete claimed;
+          }
+        }
+        return slot->value;
+      }
+
+      /// Write the least recently used local elements to disk
+
+      /// Elements are spilled until the local elements in memory fit in the
+      /// working-set limit. The memory of a spilled element is released once
+      /// all other copies of its future have been released.
+      void spill_cold() const {
+        if(! spill_)
+          return;
+
+        size_type i = 0ul;
+        std::size_t bytes = 0ul;
+        while(spill_->victim(i, bytes)) {
+          accessor acc;
+          if(! data_.find(acc, i))
+            continue;
+
+          const future f = acc->second;
+          acc->second = future();
+          spill_->spilled(i, get_world().taskq.add(& spill_tile<value_type>,
+              spill_, i, f, madness::TaskAttributes::hipri()));
+          memory_->sub(MemoryCategory::local, bytes);
+        }
+      }
+
+      /// Track the footprint of local element \c i
+
+      /// The expected footprint of the element is pending until it is set.
+      /// \param i The element index
+      /// \param f The future of element \c i , which was just inserted
+      void track_local(const size_type i, const future& f) const {
+        const std::size_t pending =
+            ((f.probe() || ! expected_bytes_) ? 0ul : expected_bytes_(i));
+        memory_->add(MemoryCategory::pending, pending);
+        const_cast<future&>(f).register_callback(
+            new TrackElement(memory_, spill_, f, i, pending));
+      }
+
+      /// Set local element \c i with a \c Future \c f
+
+      /// \param i The local element to be set
+      /// \param f The future for element \c i
+      void set_local(const size_type i, const future& f) {
+        if(slots_) {
+          IndexedSlot& slot = indexed_slot(i);
+          if(claim(slot))
+            track_local(i, slot.value);
+
+          // Check that the future has not been set already.
+#ifndef NDEBUG
+          if(slot.value.probe())
+            TA_EXCEPTION("Tile has already been assigned.");
+#endif // NDEBUG
+          slot.value.set(f);
+          return;
+        }
+
+        const_accessor acc;
+        if(data_.insert(acc, typename container_type::datumT(i, f))) {
+          track_local(i, acc->second);
+        } else {
+          // The element was already in the container, so set it with f.
+          future existing_f = acc->second;
+          acc.release();
+
+          // Check that the future has not been set already.
+#ifndef NDEBUG
+          if(existing_f.probe())
+            TA_EXCEPTION("Tile has already been assigned.");
+#endif // NDEBUG
+          // Set the future
+          existing_f.set(f);
+        }
+      }
+
       void set_handler(const size_type i, const value_type& value) {
         future f = get_local(i);
 
@@ -84,19 +511,444 @@ namespace TiledArray {
 #endif // NDEBUG
 
         f.set(value);
+        spill_cold();
+      }
+
+      void set_bulk_handler(const std::vector<size_type>& indices,
+          const std::vector<value_type>& values)
+      {
+        TA_ASSERT(indices.size() == values.size());
+        for(size_type n = 0ul; n < indices.size(); ++n)
+          set_handler(indices[n], values[n]);
+      }
+
+      /// Add a contribution to local element \c i
+
+      /// The first contribution sets the element, and the other contributions
+      /// are added to it in place.
+      /// \param i The local element
+      /// \param value The contribution
+      /// \param copy Copy \c value when it sets the element, since the
+      /// caller may still hold it
+      void accumulate_local(const size_type i, const value_type& value,
+          const bool copy)
+      {
+        future f = get_local(i);
+        madness::ScopedMutex<madness::Spinlock> locker(& accumulate_lock_);
+        if(f.probe()) {
+          add_to(f.get(), value);
+        } else {
+          using TiledArray::clone;
+          f.set(copy ? clone(value) : value);
+        }
+      }
+
+      /// Add contributions that were sent by another process
+
+      /// \param indices The local elements
+      /// \param values The contributions to the elements in \c indices
+      void accumulate_handler(const std::vector<size_type>& indices,
+          const std::vector<value_type>& values)
+      {
+        TA_ASSERT(indices.size() == values.size());
+        for(size_type n = 0ul; n < indices.size(); ++n)
+          accumulate_local(indices[n], values[n], false);
+      }
+
+      /// Send the combined contributions to remote elements to their owners
+
+      /// The contributions are sent with one message per owner.
+      void flush_accumulate() {
+        std::unordered_map<size_type, value_type> pending;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& accumulate_lock_);
+          pending.swap(accumulate_pending_);
+          accumulate_scheduled_ = false;
+        }
+
+        std::unordered_map<ProcessID, std::pair<std::vector<size_type>,
+            std::vector<value_type> > > messages;
+        for(auto& contribution : pending) {
+          auto& message = messages[owner(contribution.first)];
+          message.first.push_back(contribution.first);
+          message.second.push_back(contribution.second);
+        }
+        for(auto& message : messages) {
+          count_message(message.second.first.size());
+          WorldObject_::task(message.first, & DistributedStorage_::accumulate_handler,
+              message.second.first, message.second.second,
+              madness::TaskAttributes::hipri());
+        }
+      }
+
+      void set_zero_copy_handler(const size_type i, const ProcessID source,
+          const ZeroCopyHeader& header)
+      {
+        future f = get_local(i);
+
+#ifndef NDEBUG
+          // Check that the future has not been set already.
+          if(f.probe())
+            TA_EXCEPTION("Tile has already been assigned.");
+#endif // NDEBUG
+
+        f.set(get_world().taskq.add(& zero_copy_recv<value_type>, & get_world(),
+            source, header, madness::TaskAttributes::hipri()));
       }
 
       void get_handler(const size_type i, const typename future::remote_refT& ref) {
         future f = get_local(i);
+        send_element(f, ref, is_zero_copy_tile<value_type>());
+      }
+
+      /// Answer aggregated requests from process \c requester
+
+      /// The elements that are already set, and are too small for the
+      /// zero-copy protocol, are returned in one message; the other elements
+      /// are returned individually once they are set.
+      /// \param indices The indices of the requested elements
+      /// \param refs The remote references of the requesting futures
+      /// \param requester The process that requested the elements
+      void get_bulk_handler(const std::vector<size_type>& indices,
+          const std::vector<typename future::remote_refT>& refs,
+          const ProcessID requester)
+      {
+        TA_ASSERT(indices.size() == refs.size());
+        std::vector<typename future::remote_refT> ready_refs;
+        std::vector<value_type> values;
+        for(size_type n = 0ul; n < indices.size(); ++n) {
+          future f = get_local(indices[n]);
+          if(f.probe() && ! is_zero_copy_element(f.get(), is_zero_copy_tile<value_type>())) {
+            ready_refs.push_back(refs[n]);
+            values.push_back(f.get());
+          } else {
+            send_element(f, refs[n], is_zero_copy_tile<value_type>());
+          }
+        }
+        if(! values.empty()) {
+          count_message(values.size());
+          WorldObject_::task(requester, & DistributedStorage_::set_refs_handler,
+              ready_refs, values, madness::TaskAttributes::hipri());
+        }
+      }
+
+      /// Set the requesting futures of aggregated requests
+
+      /// \param refs The remote references of the requesting futures
+      /// \param values The requested elements
+      void set_refs_handler(const std::vector<typename future::remote_refT>& refs,
+          const std::vector<value_type>& values)
+      {
+        TA_ASSERT(refs.size() == values.size());
+        for(size_type n = 0ul; n < refs.size(); ++n) {
+          future f(refs[n]);
+          f.set(values[n]);
+        }
+      }
+
+      /// Check that an element is sent with the zero-copy protocol
+      bool is_zero_copy_element(const value_type& value, std::true_type) const {
+        return is_zero_copy<value_type>(value.size());
+      }
+
+      bool is_zero_copy_element(const value_type&, std::false_type) const {
+        return false;
+      }
+
+      /// \return The footprint of \c values in bytes
+      static std::size_t elements_bytes(const std::vector<value_type>& values) {
+        std::size_t bytes = 0ul;
+        for(const value_type& value : values)
+          bytes += tile_bytes(value);
+        return bytes;
+      }
+
+      /// Count a set or get message that holds \c n elements
+      void count_message(const size_type n) const {
+        ++messages_sent_;
+        elements_sent_ += n;
+      }
+
+      /// Add an aggregated set or get to the buffer of process \c dest
+
+      /// The buffer is sent when it holds \c aggregate_bytes_ bytes;
+      /// otherwise a task that sends it is queued, so that the buffer is sent
+      /// before the world is fenced (see \c queue_flush() ).
+      /// \param dest The destination process
+      /// \param bytes The size of the element or request
+      /// \param op The function that adds the element or request to the
+      /// buffer, which is called with the buffer locked
+      template <typename Op>
+      void aggregate(const ProcessID dest, const std::size_t bytes, const Op& op) const {
+        AggregateBuffer& buffer = aggregate_[dest];
+        bool flush = false, schedule = false;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(buffer.lock);
+          op(buffer);
+          buffer.bytes += bytes;
+          flush = (buffer.bytes >= aggregate_bytes_);
+          if(! flush && ! buffer.scheduled)
+            buffer.scheduled = schedule = true;
+        }
+        if(flush)
+          flush_aggregate(dest);
+        else if(schedule)
+          queue_flush([dest] (DistributedStorage_& storage) {
+            storage.flush_aggregate(dest);
+          });
+      }
+
+      /// Queue a task that flushes buffered messages
+
+      /// The task holds a shared guard rather than this object, since an
+      /// array may be destroyed, by \c DistArray::lazy_deleter() , before
+      /// its queued tasks run; the buffered messages of a destroyed object
+      /// are not needed and are dropped.
+      /// \param op The flush operation, which is called with this object
+      template <typename Op>
+      void queue_flush(const Op& op) const {
+        const std::shared_ptr<FlushGuard> guard = flush_guard_;
+        get_world().taskq.add([guard, op] () {
+          madness::ScopedMutex<madness::Spinlock> locker(guard->lock);
+          if(guard->storage)
+            op(*guard->storage);
+        });
+      }
+
+      /// Send the aggregated sets and gets of process \c dest
+
+      /// \param dest The destination process
+      void flush_aggregate(const ProcessID dest) const {
+        std::vector<size_type> set_indices, get_indices;
+        std::vector<value_type> set_values;
+        std::vector<typename future::remote_refT> get_refs;
+        {
+          AggregateBuffer& buffer = aggregate_[dest];
+          madness::ScopedMutex<madness::Spinlock> locker(buffer.lock);
+          set_indices.swap(buffer.set_indices);
+          set_values.swap(buffer.set_values);
+          get_indices.swap(buffer.get_indices);
+          get_refs.swap(buffer.get_refs);
+          buffer.bytes = 0ul;
+          buffer.scheduled = false;
+        }
+        if(! set_indices.empty()) {
+          count_message(set_indices.size());
+          if(comm_stats_enabled())
+            comm_stats_record(CommCategory::storage_set, 1ul,
+                elements_bytes(set_values));
+          WorldObject_::task(dest, & DistributedStorage_::set_bulk_handler,
+              set_indices, set_values, madness::TaskAttributes::hipri());
+        }
+        if(! get_indices.empty()) {
+          count_message(get_indices.size());
+          if(comm_stats_enabled())
+            comm_stats_record(CommCategory::storage_get, 1ul, 0ul);
+          WorldObject_::task(dest, & DistributedStorage_::get_bulk_handler,
+              get_indices, get_refs, get_world().rank(),
+              madness::TaskAttributes::hipri());
+        }
+      }
+
+      void send_element(const future& f, const typename future::remote_refT& ref,
+          std::false_type)
+      {
         future remote_f(ref);
         remote_f.set(f);
       }
 
+      void send_element(const future& f, const typename future::remote_refT& ref,
+          std::true_type)
+      {
+        if(f.probe()) {
+          send_handler(f, ref);
+        } else {
+          WorldObject_::task(get_world().rank(), & DistributedStorage_::send_handler,
+              f, ref, madness::TaskAttributes::hipri());
+        }
+      }
+
+      /// Send a local element to the remote future \c ref
+
+      /// Elements that satisfy \c is_zero_copy() are sent with the zero-copy
+      /// protocol, all other elements are serialized.
+      /// \param value The element to be sent
+      /// \param ref The remote reference of the requesting future
+      void send_handler(const value_type& value,
+          const typename future::remote_refT& ref)
+      {
+        if(is_zero_copy<value_type>(value.size())) {
+          const ProcessID dest = ref.owner();
+          const ZeroCopyHeader header = zero_copy_send(get_world(), dest, value);
+          WorldObject_::task(dest, & DistributedStorage_::get_zero_copy_handler,
+              ref, get_world().rank(), header, madness::TaskAttributes::hipri());
+        } else {
+          future remote_f(ref);
+          remote_f.set(value);
+        }
+      }
+
+      void get_zero_copy_handler(const typename future::remote_refT& ref,
+          const ProcessID source, const ZeroCopyHeader& header)
+      {
+        future f(ref);
+        f.set(get_world().taskq.add(& zero_copy_recv<value_type>, & get_world(),
+            source, header, madness::TaskAttributes::hipri()));
+      }
+
+      future get_remote(const size_type i) const {
+        TA_ASSERT(! pmap_->is_local(i));
+
+        // Read the element without the owner, when possible.
+        if(remote_reader_)
+          return remote_reader_(i);
+
+        // Send a request to the owner of i for the element.
+        future result;
+        comm_stats_track(CommCategory::storage_get, result,
+            [] (const value_type& value) { return tile_bytes(value); });
+        if(aggregate_bytes_ && ! pmap_->is_node_local(i)) {
+          const typename future::remote_refT ref = result.remote_ref(get_world());
+          aggregate(owner(i), sizeof(size_type) + sizeof(ref),
+              [i,&ref] (AggregateBuffer& buffer) {
+                buffer.get_indices.push_back(i);
+                buffer.get_refs.push_back(ref);
+              });
+          return result;
+        }
+        count_message(1ul);
+        if(comm_stats_enabled())
+          comm_stats_record(CommCategory::storage_get, 1ul, 0ul);
+        WorldObject_::task(owner(i), & DistributedStorage_::get_handler, i,
+            result.remote_ref(get_world()), madness::TaskAttributes::hipri());
+
+        return result;
+      }
+
+      /// The default local element storage
+
+      /// Local elements are held in indexed storage by default when the
+      /// \c TA_INDEXED_STORAGE environment variable is set to a non-zero
+      /// value; otherwise they are held in a hash map.
+      /// \return \c true if local elements are held in indexed storage by
+      /// default
+      static bool indexed_storage_default() {
+        static const bool indexed = [] () -> bool {
+          const char* indexed_storage = getenv("TA_INDEXED_STORAGE");
+          if(indexed_storage)
+            return std::strtol(indexed_storage, nullptr, 10) != 0l;
+          return false;
+        }();
+        return indexed;
+      }
+
+      /// The default size of aggregated messages
+
+      /// The size is read from the \c TA_AGGREGATE_BYTES environment
+      /// variable; the default is zero, which disables aggregation.
+      /// \return The default size of aggregated messages in bytes
+      static std::size_t init_aggregate_bytes() {
+        static const std::size_t bytes = [] () -> std::size_t {
+          const char* aggregate_bytes = getenv("TA_AGGREGATE_BYTES");
+          if(aggregate_bytes)
+            return std::strtoul(aggregate_bytes, nullptr, 10);
+          return 0ul;
+        }();
+        return bytes;
+      }
+
+      /// Initialize the prefetch cache capacity
+
+      /// The capacity is the largest number of remote elements that are held
+      /// by the prefetch cache. It is read from the
+      /// \c TA_PREFETCH_CACHE_SIZE environment variable; the default capacity
+      /// is 256 elements.
+      /// \return The prefetch cache capacity
+      static size_type init_prefetch_capacity() {
+        static const size_type capacity = [] () -> size_type {
+          const char* cache_size = getenv("TA_PREFETCH_CACHE_SIZE");
+          if(cache_size)
+            return std::strtoul(cache_size, nullptr, 10);
+          return 256ul;
+        }();
+        return capacity;
+      }
+
+      /// Drop the oldest prefetched elements until the cache fits its capacity
+
+      /// \note The prefetch lock must be held by the caller.
+      void evict_prefetched() const {
+        while(prefetch_queue_.size() > prefetch_capacity_) {
+          const std::pair<key_type, std::size_t> request = prefetch_queue_.front();
+          prefetch_queue_.pop_front();
+
+          // Skip requests that were retrieved or prefetched again
+          auto it = prefetch_cache_.find(request.first);
+          if((it != prefetch_cache_.end()) && (it->second.id == request.second)) {
+            it->second.charge->release();
+            prefetch_cache_.erase(it);
+          }
+        }
+      }
+
       void set_remote(const size_type i, const value_type& value) {
+        set_remote(i, value, is_zero_copy_tile<value_type>());
+      }
+
+      void set_remote(const size_type i, const value_type& value, std::false_type) {
+        const std::size_t bytes = sizeof(size_type) + tile_bytes(value);
+        if(aggregate_bytes_ && (bytes < aggregate_bytes_) &&
+            ! pmap_->is_node_local(i))
+        {
+          aggregate(owner(i), bytes, [i,&value] (AggregateBuffer& buffer) {
+            buffer.set_indices.push_back(i);
+            buffer.set_values.push_back(value);
+          });
+          return;
+        }
+        count_message(1ul);
+        if(comm_stats_enabled())
+          comm_stats_record(CommCategory::storage_set, 1ul, bytes);
         WorldObject_::task(owner(i), & DistributedStorage_::set_handler,
             i, value, madness::TaskAttributes::hipri());
       }
 
+      /// Send element \c i to its owner
+
+      /// Large elements are sent with the zero-copy protocol, where only the
+      /// transfer header is serialized.
+      /// \param i The element to be set
+      /// \param value The value of element \c i
+      void set_remote(const size_type i, const value_type& value, std::true_type) {
+        if(! set_remote_zero_copy(i, value, std::true_type()))
+          set_remote(i, value, std::false_type());
+      }
+
+      /// Send a large element \c i to its owner with the zero-copy protocol
+
+      /// \param i The element to be set
+      /// \param value The value of element \c i
+      /// \return \c true if \c value was sent, or \c false if it is too
+      /// small for the zero-copy protocol
+      bool set_remote_zero_copy(const size_type i, const value_type& value,
+          std::true_type)
+      {
+        if(! is_zero_copy<value_type>(value.size()))
+          return false;
+        const ProcessID dest = owner(i);
+        const ZeroCopyHeader header = zero_copy_send(get_world(), dest, value);
+        count_message(1ul);
+        if(comm_stats_enabled())
+          comm_stats_record(CommCategory::storage_set, 1ul, tile_bytes(value));
+        WorldObject_::task(dest, & DistributedStorage_::set_zero_copy_handler,
+            i, get_world().rank(), header, madness::TaskAttributes::hipri());
+        return true;
+      }
+
+      bool set_remote_zero_copy(const size_type, const value_type&,
+          std::false_type)
+      { return false; }
+
       struct DelayedSet : public madness::CallbackInterface {
       private:
         DistributedStorage_& ds_; ///< A reference to the owning object
@@ -117,6 +969,73 @@ namespace TiledArray {
         }
       }; // struct DelayedSet
 
+      /// Send elements that are owned by one process in a single message
+
+      /// This object waits for all of its elements to be assigned, then
+      /// sends the elements that are too small for the zero-copy protocol
+      /// in one active message; the remaining elements are sent individually
+      /// with the zero-copy protocol.
+      struct BulkSet : public madness::CallbackInterface {
+      private:
+        DistributedStorage_& ds_; ///< A reference to the owning object
+        ProcessID dest_; ///< The owner of the elements
+        std::vector<size_type> indices_; ///< The indices of the elements
+        std::vector<future> futures_; ///< The elements
+        std::atomic<size_type> count_; ///< The number of unassigned elements
+
+      public:
+
+        BulkSet(DistributedStorage_& ds, const ProcessID dest) :
+            ds_(ds), dest_(dest), indices_(), futures_(), count_(0ul)
+        { }
+
+        virtual ~BulkSet() { }
+
+        /// Add element \c i to the message
+        void add(const size_type i, const future& f) {
+          indices_.push_back(i);
+          futures_.push_back(f);
+        }
+
+        /// Send the message once all elements have been assigned
+
+        /// This object is deleted after the message is sent.
+        void start() {
+          count_.store(futures_.size() + 1ul);
+          for(future& f : futures_)
+            f.register_callback(this);
+          notify();
+        }
+
+        virtual void notify() {
+          if(count_.fetch_sub(1ul) != 1ul)
+            return;
+
+          std::vector<size_type> indices;
+          std::vector<value_type> values;
+          indices.reserve(indices_.size());
+          values.reserve(indices_.size());
+          for(size_type n = 0ul; n < indices_.size(); ++n) {
+            const value_type& value = futures_[n].get();
+            if(! ds_.set_remote_zero_copy(indices_[n], value,
+                is_zero_copy_tile<value_type>()))
+            {
+              indices.push_back(indices_[n]);
+              values.push_back(value);
+            }
+          }
+          if(! indices.empty()) {
+            ds_.count_message(indices.size());
+            if(comm_stats_enabled())
+              comm_stats_record(CommCategory::storage_set, 1ul,
+                  elements_bytes(values));
+            ds_.WorldObject_::task(dest_, & DistributedStorage_::set_bulk_handler,
+                indices, values, madness::TaskAttributes::hipri());
+          }
+          delete this;
+        }
+      }; // struct BulkSet
+
     public:
 
       /// Makes an initialized, empty container with default data distribution (no communication)
@@ -132,17 +1051,38 @@ namespace TiledArray {
           const std::shared_ptr<pmap_interface>& pmap) :
         WorldObject_(world), max_size_(max_size),
         pmap_(pmap),
-        data_((max_size / world.size()) + 11)
+        data_((max_size / world.size()) + 11),
+        memory_(std::make_shared<MemoryCounter>(world)), expected_bytes_(),
+        spill_(), generator_(), cache_generated_(true), remote_reader_(),
+        local_indices_(),
+        slots_(), indexed_size_(0ul), aggregate_bytes_(0ul), aggregate_(),
+        accumulate_lock_(), accumulate_pending_(), accumulate_scheduled_(false),
+        flush_guard_(std::make_shared<FlushGuard>(this)),
+        messages_sent_(0ul), elements_sent_(0ul), prefetch_lock_(), prefetch_cache_(), prefetch_queue_(),
+        prefetch_count_(0ul), prefetch_capacity_(init_prefetch_capacity()),
+        frozen_(false), frozen_local_(), frozen_remote_()
       {
         // Check that the process map is appropriate for this storage object
         TA_ASSERT(pmap_);
         TA_ASSERT(pmap_->size() == max_size);
         TA_ASSERT(pmap_->rank() == pmap_interface::size_type(world.rank()));
         TA_ASSERT(pmap_->procs() == pmap_interface::size_type(world.size()));
+        if(! spill_directory().empty())
+          spill(spill_directory(), spill_max_bytes());
+        else if(indexed_storage_default())
+          indexed_storage();
+        aggregate_bytes(init_aggregate_bytes());
         WorldObject_::process_pending();
       }
 
-      virtual ~DistributedStorage() { }
+      virtual ~DistributedStorage() {
+        // Detach the flush tasks that are still queued
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(flush_guard_->lock);
+          flush_guard_->storage = nullptr;
+        }
+        clear_prefetch();
+      }
 
       using WorldObject_::get_world;
 
@@ -178,7 +1118,9 @@ namespace TiledArray {
       /// No communication.
       /// \return The number of local elements stored by the container.
       /// \throw nothing
-      size_type size() const { return data_.size(); }
+      size_type size() const {
+        return (slots_ ? indexed_size_.load() : data_.size());
+      }
 
       /// Max size accessor
 
@@ -190,20 +1132,373 @@ namespace TiledArray {
 
       /// Get local or remote element
 
+      /// If remote element \c i was prefetched, the prefetched copy is
+      /// removed from the prefetch cache and returned.
       /// \param i The element to get
       /// \return A future to element \c i
       /// \throw TiledArray::Exception If \c i is greater than or equal to \c max_size() .
       future get(size_type i) const {
         TA_ASSERT(i < max_size_);
         if(is_local(i)) {
-          return get_local(i);
+          const future result = get_local(i);
+          spill_cold();
+          return result;
         } else {
-          // Send a request to the owner of i for the element.
+          if(frozen_remote_)
+            return get_frozen_remote(i);
+
+          // Check for a prefetched copy of element i.
           future result;
-          WorldObject_::task(owner(i), & DistributedStorage_::get_handler, i,
-              result.remote_ref(get_world()), madness::TaskAttributes::hipri());
+          if(take_prefetched(i, result))
+            return result;
 
-          return result;
+          return get_remote(i);
+        }
+      }
+
+      /// Prefetch a remote element
+
+      /// Request a copy of remote element \c i , which is held in the
+      /// prefetch cache until it is requested with \c get() . The request is
+      /// sent immediately, so the communication latency of several requests
+      /// overlaps. If the cache is full, the oldest prefetched element is
+      /// dropped. This function does nothing if \c i is already in the cache
+      /// or the cache capacity is zero. If \c i is a local element that was
+      /// spilled to disk, it is read back by a task instead.
+      /// \param i The element to prefetch
+      /// \throw TiledArray::Exception If \c i is greater than or equal to \c max_size() .
+      void prefetch(size_type i) const {
+        TA_ASSERT(i < max_size_);
+        if(is_local(i)) {
+          if(spill_ && (cache_generated_ || ! generator_))
+            get_spilled(i);
+          return;
+        }
+        if(frozen_remote_) {
+          get_frozen_remote(i);
+          return;
+        }
+        if(prefetch_capacity_ == 0ul)
+          return;
+
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(prefetch_lock_);
+          if(prefetch_cache_.count(i))
+            return;
+        }
+
+        const future result = get_remote(i);
+        std::shared_ptr<PrefetchCharge> charge =
+            std::make_shared<PrefetchCharge>(memory_);
+        const_cast<future&>(result).register_callback(
+            new TrackElement(charge, result));
+
+        madness::ScopedMutex<madness::Spinlock> locker(prefetch_lock_);
+        const std::size_t id = prefetch_count_++;
+        prefetch_cache_[i] = PrefetchEntry{ result, id, charge };
+        prefetch_queue_.emplace_back(i, id);
+        evict_prefetched();
+      }
+
+      /// Prefetch cache capacity accessor
+
+      /// \return The largest number of remote elements held by the prefetch
+      /// cache
+      size_type prefetch_capacity() const { return prefetch_capacity_; }
+
+      /// Set the prefetch cache capacity
+
+      /// \param capacity The largest number of remote elements held by the
+      /// prefetch cache; zero disables prefetching
+      void prefetch_capacity(const size_type capacity) {
+        madness::ScopedMutex<madness::Spinlock> locker(prefetch_lock_);
+        prefetch_capacity_ = capacity;
+        evict_prefetched();
+      }
+
+      /// Number of prefetched elements
+
+      /// \return The number of remote elements in the prefetch cache
+      size_type prefetch_size() const {
+        madness::ScopedMutex<madness::Spinlock> locker(prefetch_lock_);
+        return prefetch_cache_.size();
+      }
+
+      /// Remove all prefetched elements from the cache
+
+      /// The remote elements cached by a frozen container are released too.
+      /// \note This function must not be called while other threads access
+      /// elements of this container, since the cached remote elements of a
+      /// frozen container are read without a lock.
+      void clear_prefetch() {
+        madness::ScopedMutex<madness::Spinlock> locker(prefetch_lock_);
+        for(auto& entry : prefetch_cache_)
+          entry.second.charge->release();
+        prefetch_cache_.clear();
+        prefetch_queue_.clear();
+
+        // Release the remote elements cached by a frozen container
+        if(frozen_remote_) {
+          for(size_type i = 0ul; i < max_size_; ++i) {
+            FrozenSlot* const slot =
+                frozen_remote_[i].exchange(nullptr, std::memory_order_acq_rel);
+            if(slot) {
+              slot->charge->release();
+              delete slot;
+            }
+          }
+        }
+      }
+
+      /// Make the elements of this container read-only
+
+      /// Elements may not be set, accumulated, or erased after this call.
+      /// Remote elements are then cached by this process when they are first
+      /// requested, or prefetched, so later requests, e.g. by other
+      /// expressions, share the cached copy instead of fetching the element
+      /// again. The cached elements are counted as cache bytes by
+      /// \c memory_usage() until they are released by \c clear_prefetch() .
+      /// Local elements of the hash map are copied into a sorted table that
+      /// is read without locks; elements of indexed storage are already read
+      /// without locks, and elements that are spilled to disk or generated
+      /// for each request are accessed as before. All local elements should
+      /// be set, and no other thread may access this container, when it is
+      /// frozen.
+      void freeze() {
+        if(frozen_)
+          return;
+        frozen_ = true;
+
+        if(! slots_ && ! spill_ && (! generator_ || cache_generated_)) {
+          std::vector<std::pair<key_type, future> > elements;
+          elements.reserve(pmap_->local_size());
+          for(const size_type i : *pmap_) {
+            const_accessor acc;
+            if(data_.find(acc, i))
+              elements.emplace_back(i, acc->second);
+          }
+          std::sort(elements.begin(), elements.end(),
+              [] (const std::pair<key_type, future>& left,
+                  const std::pair<key_type, future>& right)
+              { return left.first < right.first; });
+          frozen_local_.swap(elements);
+        }
+
+        frozen_remote_.reset(new std::atomic<FrozenSlot*>[max_size_]);
+        for(size_type i = 0ul; i < max_size_; ++i)
+          frozen_remote_[i].store(nullptr, std::memory_order_relaxed);
+      }
+
+      /// Frozen container query
+
+      /// \return \c true if the elements of this container are read-only
+      bool is_frozen() const { return frozen_; }
+
+      /// Aggregate small remote sets and gets
+
+      /// Elements that are smaller than \c bytes and are set on another
+      /// process, and requests for elements of another process, are buffered
+      /// per destination and sent in one active message, instead of one
+      /// message per element. A buffer is sent when it holds \c bytes bytes,
+      /// or when the task that is queued for it runs, whichever comes first,
+      /// so buffers are always sent before the world is fenced. Requests are
+      /// answered with one message for the elements that are set when the
+      /// requests arrive. By default, the size is read from the
+      /// \c TA_AGGREGATE_BYTES environment variable.
+      /// \note This must be called on all processes with the same size, and
+      /// not while other threads access elements of this container; the
+      /// processes should be synchronized (e.g. with a fence) before
+      /// elements are accessed.
+      /// \param bytes The size of aggregated messages, or zero to send one
+      /// message per element
+      void aggregate_bytes(const std::size_t bytes) {
+        aggregate_bytes_ = bytes;
+        if(bytes && ! aggregate_)
+          aggregate_.reset(new AggregateBuffer[get_world().size()]);
+      }
+
+      /// Aggregated message size accessor
+
+      /// \return The size of aggregated messages, or zero if messages are
+      /// not aggregated
+      std::size_t aggregate_bytes() const { return aggregate_bytes_; }
+
+      /// Number of set and get messages sent by this process
+
+      /// Each active message that sets or requests elements of another
+      /// process, or answers aggregated requests, is counted once.
+      /// \return The number of messages sent
+      size_type messages_sent() const { return messages_sent_.load(); }
+
+      /// Number of elements set or requested by the messages of this process
+
+      /// \return The number of elements in the messages counted by
+      /// \c messages_sent()
+      size_type elements_sent() const { return elements_sent_.load(); }
+
+      /// Memory footprint of this container on this process
+
+      /// The local bytes are the footprint of the local elements that have
+      /// been set, the pending bytes are the expected footprint of the local
+      /// elements that have not been set, and the cache bytes are the
+      /// footprint of the prefetched elements that have arrived. Elements
+      /// that share data with other containers are counted by each container.
+      /// \return The current footprint of this container
+      MemoryUsage memory_usage() const { return memory_->usage(); }
+
+      /// Set the expected footprint of elements
+
+      /// The expected footprint of a local element is counted as pending
+      /// from the time the element is inserted until it is set. It should be
+      /// set before any element is accessed; by default, it is zero.
+      /// \param op A function that returns the expected footprint, in bytes,
+      /// of an element given its index
+      void expected_bytes(const std::function<std::size_t(size_type)>& op) {
+        expected_bytes_ = op;
+      }
+
+      /// Spill local elements to disk
+
+      /// Local elements that have been set are kept in memory until their
+      /// total size exceeds \c max_bytes ; the least recently used elements
+      /// are then serialized to files in \c directory and read back, in a
+      /// task, when they are accessed again. This should be called before
+      /// any element is set. By default, elements are spilled to the
+      /// \c TA_SPILL_DIR directory, when that environment variable is set,
+      /// with the \c TA_SPILL_MAX_BYTES limit (default 1 GB).
+      /// \param directory The directory of the spill files, which should be
+      /// on node-local storage
+      /// \param max_bytes The working-set limit of the local elements
+      void spill(const std::string& directory, const std::size_t max_bytes) {
+        TA_ASSERT(! directory.empty());
+        TA_USER_ASSERT(! slots_, "Elements of indexed storage cannot be spilled.");
+        spill_ = std::make_shared<TileSpill>(directory + "/ta_spill_" +
+            std::to_string(get_world().rank()) + "_" +
+            std::to_string(WorldObject_::id().get_obj_id()) + "_", max_bytes);
+      }
+
+      /// Generate local elements on demand
+
+      /// Local elements are not set; instead, element \c i is generated by a
+      /// task that evaluates \c op(i) when it is first requested. When
+      /// \c cache is \c true , generated elements are stored like elements
+      /// that have been set; otherwise, they are generated again for each
+      /// request and this container does not hold them. This must be called
+      /// before any element is accessed, and elements of this container
+      /// must not be set afterward. The generator is not synchronized with
+      /// requests from other processes, so the caller must fence the world
+      /// before remote elements are requested (see
+      /// \c DistArray::init_lazy_tiles() ).
+      /// \param op A thread-safe function that returns element \c i given its
+      /// index
+      /// \param cache If \c true , generated elements are stored
+      void generator(const std::function<value_type(size_type)>& op,
+          const bool cache)
+      {
+        TA_ASSERT(op);
+        generator_ = op;
+        cache_generated_ = cache;
+      }
+
+      /// Read remote elements without active messages
+
+      /// Remote element \c i is read with \c op(i) instead of a request to
+      /// its owner, e.g. with one-sided communication, so the owner takes no
+      /// part in the transfer. This is only valid while no element is set.
+      /// \param op A thread-safe function that returns a future to remote
+      /// element \c i given its index, or an empty function to request
+      /// remote elements from their owners
+      void remote_reader(const std::function<future(size_type)>& op) {
+        remote_reader_ = op;
+      }
+
+      /// Generated element query
+
+      /// \return \c true if local elements of this container are generated
+      /// on demand
+      bool is_generated() const { return static_cast<bool>(generator_); }
+
+      /// Hold local elements in a flat array
+
+      /// Local elements are held in an array that is indexed by their local
+      /// ordinal, i.e. their position among the sorted local indices of the
+      /// process map, instead of a concurrent hash map. Slots are allocated
+      /// for all local elements at once, and an element is found with a
+      /// binary search of the local indices, so accessing an element takes no
+      /// lock; this avoids contention when many threads read the same tiles.
+      /// Elements of indexed storage are not spilled, so this replaces
+      /// spilling enabled by \c TA_SPILL_DIR , and elements may not be erased
+      /// while other threads access them. By default, indexed storage is used
+      /// when the \c TA_INDEXED_STORAGE environment variable is set to a
+      /// non-zero value, unless \c TA_SPILL_DIR is set.
+      /// \note This must be called on all processes before any element is
+      /// accessed, and the processes must be synchronized (e.g. with a fence)
+      /// before any remote element is accessed; otherwise a remote set may
+      /// arrive before the owner has switched its storage.
+      /// \throw TiledArray::Exception When an element has already been set.
+      void indexed_storage() {
+        TA_USER_ASSERT(data_.size() == 0ul,
+            "Indexed storage must be selected before any element is set.");
+        spill_.reset();
+        std::vector<size_type> local_indices;
+        local_indices.reserve(pmap_->local_size());
+        for(const size_type i : *pmap_)
+          local_indices.push_back(i);
+        std::sort(local_indices.begin(), local_indices.end());
+        local_indices_.swap(local_indices);
+        slots_.reset(new IndexedSlot[local_indices_.size()]);
+        indexed_size_ = 0ul;
+      }
+
+      /// Indexed storage query
+
+      /// \return \c true if local elements are held in indexed storage
+      bool is_indexed() const { return static_cast<bool>(slots_); }
+
+      /// Number of spilled elements
+
+      /// \return The number of local elements that are held on disk
+      size_type spilled_size() const {
+        return (spill_ ? spill_->spilled_size() : 0ul);
+      }
+
+      /// Remove local element \c i
+
+      /// The element is removed from this container and its footprint is
+      /// released; other copies of its future are not affected. An element
+      /// that is accessed after it was removed is inserted again, like an
+      /// element that was never accessed.
+      /// \param i The element to be removed, which must be local and, unless
+      /// it was spilled, set
+      /// \throw TiledArray::Exception If \c i is not local.
+      void erase(const size_type i) {
+        TA_ASSERT(is_local(i));
+        TA_USER_ASSERT(! frozen_, "Elements of a frozen container cannot be erased.");
+        TA_ASSERT(! generator_ || cache_generated_);
+        if(slots_) {
+          IndexedSlot& slot = indexed_slot(i);
+          if(! slot.claimed.load(std::memory_order_acquire))
+            return;
+          const future f = slot.value;
+          slot.value = future();
+          slot.claimed.store(false, std::memory_order_release);
+          --indexed_size_;
+          TA_ASSERT(f.probe());
+          memory_->sub(MemoryCategory::local, tile_bytes(f.get()));
+          return;
+        }
+
+        accessor acc;
+        if(! data_.find(acc, i))
+          return;
+        const future f = acc->second;
+        data_.erase(acc);
+
+        if(spill_) {
+          memory_->sub(MemoryCategory::local, spill_->erase(i));
+        } else {
+          TA_ASSERT(f.probe());
+          memory_->sub(MemoryCategory::local, tile_bytes(f.get()));
         }
       }
 
@@ -215,6 +1510,8 @@ namespace TiledArray {
       /// \throw madness::MadnessException If \c i has already been set.
       void set(size_type i, const value_type& value) {
         TA_ASSERT(i < max_size_);
+        TA_ASSERT(! generator_);
+        TA_USER_ASSERT(! frozen_, "Elements of a frozen container cannot be set.");
         if(is_local(i))
           set_handler(i, value);
         else
@@ -232,21 +1529,11 @@ namespace TiledArray {
       /// \throw TiledArray::Exception If \c i is greater than or equal to \c max_size() .
       void set(size_type i, const future& f) {
         TA_ASSERT(i < max_size_);
+        TA_ASSERT(! generator_);
+        TA_USER_ASSERT(! frozen_, "Elements of a frozen container cannot be set.");
         if(is_local(i)) {
-          const_accessor acc;
-          if(! data_.insert(acc, typename container_type::datumT(i, f))) {
-            // The element was already in the container, so set it with f.
-            future existing_f = acc->second;
-            acc.release();
-
-            // Check that the future has not been set already.
-#ifndef NDEBUG
-            if(existing_f.probe())
-              TA_EXCEPTION("Tile has already been assigned.");
-#endif // NDEBUG
-            // Set the future
-            existing_f.set(f);
-          }
+          set_local(i, f);
+          spill_cold();
         } else {
           if(f.probe()) {
             set_remote(i, f);
@@ -257,6 +1544,99 @@ namespace TiledArray {
         }
       }
 
+      /// Set many elements with one message per owner
+
+      /// Local elements are inserted as with \c set() , but the elements
+      /// are not spilled until all of them have been inserted. Remote
+      /// elements are grouped by their owner, and each group is sent in a
+      /// single message once all of its elements have been assigned, which
+      /// avoids one active message per element when many small elements are
+      /// moved.
+      /// \param indices The elements to be set
+      /// \param futures The futures of the elements in \c indices
+      /// \throw TiledArray::Exception If an index is greater than or equal to
+      /// \c max_size() .
+      /// \throw madness::MadnessException If an element has already been set.
+      void set_bulk(const std::vector<size_type>& indices,
+          const std::vector<future>& futures)
+      {
+        TA_ASSERT(indices.size() == futures.size());
+        TA_ASSERT(! generator_);
+        TA_USER_ASSERT(! frozen_, "Elements of a frozen container cannot be set.");
+        std::vector<size_type> remote;
+        for(size_type n = 0ul; n < indices.size(); ++n) {
+          const size_type i = indices[n];
+          TA_ASSERT(i < max_size_);
+          if(is_local(i))
+            set_local(i, futures[n]);
+          else
+            remote.push_back(n);
+        }
+        spill_cold();
+        if(remote.empty())
+          return;
+
+        std::vector<size_type> remote_indices(remote.size());
+        for(size_type r = 0ul; r < remote.size(); ++r)
+          remote_indices[r] = indices[remote[r]];
+        const std::vector<size_type> owners = pmap_->owners(remote_indices);
+        std::unordered_map<ProcessID, BulkSet*> messages;
+        for(size_type r = 0ul; r < remote.size(); ++r) {
+          BulkSet*& message = messages[owners[r]];
+          if(! message)
+            message = new BulkSet(*this, owners[r]);
+          message->add(remote_indices[r], futures[remote[r]]);
+        }
+        for(auto& message : messages)
+          message.second->start();
+      }
+
+      /// Add a contribution to element \c i
+
+      /// Contributions to local elements are added to the element as they
+      /// are made. Contributions to remote elements are combined with the
+      /// other local contributions to the same element, and the combined
+      /// contributions are sent by a task, with one message per owner, so
+      /// all contributions have been added once the world is fenced. The
+      /// first contribution sets the element, so an element that is
+      /// accumulated must not be set, and it holds a partial sum until the
+      /// fence. Elements are updated in place, so this is not supported with
+      /// \c spill() .
+      /// \param i The element
+      /// \param value The contribution to element \c i
+      /// \throw TiledArray::Exception If \c i is greater than or equal to
+      /// \c max_size() .
+      void accumulate(const size_type i, const value_type& value) {
+        TA_ASSERT(i < max_size_);
+        TA_ASSERT(! generator_);
+        TA_USER_ASSERT(! spill_, "Elements that are spilled to disk cannot be accumulated.");
+        TA_USER_ASSERT(! frozen_, "Elements of a frozen container cannot be accumulated.");
+        if(is_local(i)) {
+          accumulate_local(i, value, true);
+          return;
+        }
+
+        bool schedule = false;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& accumulate_lock_);
+          auto it = accumulate_pending_.find(i);
+          if(it != accumulate_pending_.end()) {
+            it->second = add(it->second, value);
+          } else {
+            // The caller may modify its element before it is sent, as for
+            // local elements (see accumulate_local() )
+            using TiledArray::clone;
+            accumulate_pending_.emplace(i, clone(value));
+          }
+          if(! accumulate_scheduled_)
+            accumulate_scheduled_ = schedule = true;
+        }
+        if(schedule)
+          queue_flush([] (DistributedStorage_& storage) {
+            storage.flush_accumulate();
+          });
+      }
+
     }; // class DistributedStorage
 
   }  // namespace detail
@@ -312,6 +312,14 @@ namespace TiledArray {
         return ss.str();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        BinaryEngine_::cache_key(os);
+        os << " [" << factor_ << "]";
+      }
+
     }; // class ScalAddEngine
 
   }  // namespace expressions
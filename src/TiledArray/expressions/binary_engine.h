@@ -178,11 +178,49 @@ namespace TiledArray {
       void init_distribution(World* world,
           const std::shared_ptr<pmap_interface>& pmap)
       {
-        left_.init_distribution(world, pmap);
+        left_.init_distribution(world, (pmap ? pmap : BinaryEngine_::native_pmap(*world)));
         right_.init_distribution(world, left_.pmap());
         ExprEngine_::init_distribution(world, left_.pmap());
       }
 
+      /// Native process map accessor
+
+      /// When the arguments are distributed differently, the result is
+      /// distributed like the argument that moves fewer elements of the
+      /// other (and of its own nested arguments), based on the tile volumes
+      /// and the shapes of the arguments. The left-hand process map is
+      /// preferred when the costs are equal, and the choice is left to the
+      /// left-hand argument when it does not prefer a distribution.
+      /// \param world The world where the expression is evaluated
+      /// \return The native process map of this expression
+      std::shared_ptr<pmap_interface> native_pmap(World& world) const {
+        const std::shared_ptr<pmap_interface> left = left_.native_pmap(world);
+        if(! left)
+          return left;
+        const std::shared_ptr<pmap_interface> right = right_.native_pmap(world);
+        if(! right || (right == left))
+          return left;
+        return (BinaryEngine_::redistribution_cost(world, *right) <
+            BinaryEngine_::redistribution_cost(world, *left) ? right : left);
+      }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param world The world where the expression is evaluated
+      /// \param pmap The process map of the result tensor
+      /// \return The sum of the redistribution costs of the arguments
+      std::size_t redistribution_cost(World& world, const pmap_interface& pmap) const {
+        return left_.redistribution_cost(world, pmap) +
+            right_.redistribution_cost(world, pmap);
+      }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// \return The sum of the permutation costs of the arguments
+      std::size_t permute_cost() const {
+        return left_.permute_cost() + right_.permute_cost();
+      }
+
       /// Non-permuting tiled range factory function
 
       /// \return The result tiled range
@@ -212,9 +250,40 @@ namespace TiledArray {
             new impl_type(left, right, *world_, trange_, shape_, pmap_,
             perm_, ExprEngine_::make_op()));
 
+        if(std::shared_ptr<ExprProfile> profile = ExprEngine_::make_profile()) {
+          profile->add_child(left.profile());
+          profile->add_child(right.profile());
+          pimpl->profile(profile);
+        }
+
         return dist_eval_type(pimpl);
       }
 
+      /// Rebind the leaves of this engine to the arrays of another expression
+
+      /// \tparam D The expression type
+      /// \param expr An expression with the same structure as the expression
+      /// of this engine
+      /// \param[in,out] same_shape Set to false when a shape of an array
+      /// changed
+      /// \return \c true if the arrays were replaced, or \c false if a tiled
+      /// range differs
+      template <typename D>
+      bool rebind(const BinaryExpr<D>& expr, bool& same_shape) {
+        return left_.rebind(expr.left(), same_shape) &&
+            right_.rebind(expr.right(), same_shape);
+      }
+
+      /// Construct the cost estimate of this expression
+
+      /// \return The cost estimate of this expression and its arguments
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        std::shared_ptr<ExprEstimate> estimate = ExprEngine_::make_estimate();
+        estimate->add_child(left_.make_estimate());
+        estimate->add_child(right_.make_estimate());
+        return estimate;
+      }
+
       /// Expression print
 
       /// \param os The output stream
@@ -226,6 +295,19 @@ namespace TiledArray {
         right_.print(os, vars_);
         os.dec();
       }
+
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        ExprEngine_::cache_key(os);
+        os << " (";
+        left_.cache_key(os);
+        os << ", ";
+        right_.cache_key(os);
+        os << ")";
+      }
+
     }; // class BinaryEngine
 
   }  // namespace expressions
@@ -37,6 +37,7 @@ namespace TiledArray {
   namespace expressions {
 
     // Forward declaration
+    template <typename> class BlkTsrExprBase;
     template <typename, bool> class BlkTsrExpr;
     template <typename, typename> class ScalBlkTsrExpr;
     template <typename, typename, bool> class BlkTsrEngine;
@@ -72,7 +73,10 @@ namespace TiledArray {
       typedef typename policy::pmap_interface
           pmap_interface; ///< Process map interface type
 
-      static constexpr bool consumable = true;
+      // Note: Shifted tiles share data with the array tiles, so the result is
+      // only consumable when the array tiles are.
+      static constexpr bool consumable = (! Alias) ||
+          eval_trait<typename array_type::value_type>::is_consumable;
       static constexpr unsigned int leaves = 1;
     };
 
@@ -176,6 +180,23 @@ namespace TiledArray {
         lower_bound_(expr.lower_bound()), upper_bound_(expr.upper_bound())
       { }
 
+      /// Rebind this engine to the array of another block expression
+
+      /// \tparam D The block expression type
+      /// \param expr A block expression with the same block as the expression
+      /// of this engine
+      /// \param[in,out] same_shape Set to false when the shape of the array
+      /// of \c expr differs from the shape of the current array
+      /// \return \c true if the array was replaced, or \c false if the
+      /// block or the tiled range differs
+      template <typename D>
+      bool rebind(const BlkTsrExprBase<D>& expr, bool& same_shape) {
+        if((expr.lower_bound() != lower_bound_) ||
+            (expr.upper_bound() != upper_bound_))
+          return false;
+        return LeafEngine_::rebind(expr, same_shape);
+      }
+
 
       /// Non-permuting tiled range factory function
 
@@ -260,6 +281,32 @@ namespace TiledArray {
             (pmap ? pmap : policy::default_pmap(*world, trange_.tiles_range().volume())));
       }
 
+      /// Native process map accessor
+
+      /// The tiles of a block are not indexed like the tiles of the array.
+      /// \return NULL
+      std::shared_ptr<pmap_interface> native_pmap(World&) const { return nullptr; }
+
+      /// Estimate the cost of a result distribution
+
+      /// \return Zero
+      std::size_t redistribution_cost(World&, const pmap_interface&) const { return 0ul; }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// \return The number of elements in the block
+      std::size_t permute_cost() const {
+        std::size_t cost = 1ul;
+        for(unsigned int d = 0u; d < lower_bound_.size(); ++d) {
+          if(lower_bound_[d] >= upper_bound_[d])
+            return 0ul;
+          const auto& trange1 = array_.trange().data()[d];
+          cost *= trange1.tile(upper_bound_[d] - 1ul).second -
+              trange1.tile(lower_bound_[d]).first;
+        }
+        return cost;
+      }
+
       /// Construct the distributed evaluator for array
       dist_eval_type make_dist_eval() const {
         // Define the distributed evaluator implementation type
@@ -269,6 +316,9 @@ namespace TiledArray {
         std::shared_ptr<impl_type> pimpl(
             new impl_type(array_, *world_, trange_, shape_, pmap_, perm_,
             ExprEngine_::make_op(), lower_bound_, upper_bound_));
+        pimpl->profile(ExprEngine_::make_profile());
+        if(lazy_tile_cache_capacity() || array_.permutation_cache())
+          pimpl->cache_key(LeafEngine_::make_lazy_tile_cache_key());
 
         return dist_eval_type(pimpl);
       }
@@ -286,6 +336,14 @@ namespace TiledArray {
         return ss.str();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        LeafEngine_::cache_key(os);
+        os << " " << make_tag();
+      }
+
     }; // class BlkTsrEngineBase
 
 
@@ -569,6 +627,14 @@ namespace TiledArray {
         return BlkTsrEngineBase_::make_tag() + ss.str();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        BlkTsrEngineBase_::cache_key(os);
+        os << " [" << factor_ << "]";
+      }
+
     }; // class ScalBlkTsrEngine
 
 
@@ -28,6 +28,7 @@
 
 #include <TiledArray/expressions/binary_engine.h>
 #include <TiledArray/dist_eval/contraction_eval.h>
+#include <TiledArray/dist_eval/outer_eval.h>
 #include <TiledArray/tile_op/contract_reduce.h>
 #include <TiledArray/proc_grid.h>
 
@@ -35,6 +36,7 @@ namespace TiledArray {
   namespace expressions {
 
     // Forward declarations
+    template <typename> class LeafEngine;
     template <typename, typename> class MultExpr;
     template <typename, typename, typename> class ScalMultExpr;
 
@@ -99,8 +101,18 @@ namespace TiledArray {
         no_trans = 1,
         trans = 2,
         permute_to_no_trans = 3,
+        permute_in_gemm = 4, ///< Tiles are permuted while they are contracted
       } TensorOp;
 
+      /// Indicates that the argument tiles may be permuted while they are
+      /// contracted, instead of being stored in a permuted copy
+      static constexpr bool left_permute_in_gemm =
+          TiledArray::detail::is_tensor<typename
+          eval_trait<typename left_type::value_type>::type>::value;
+      static constexpr bool right_permute_in_gemm =
+          TiledArray::detail::is_tensor<typename
+          eval_trait<typename right_type::value_type>::type>::value;
+
     protected:
 
       scalar_type factor_; ///< Contraction scaling factor
@@ -114,6 +126,8 @@ namespace TiledArray {
       op_type op_; ///< Tile operation
       TiledArray::detail::ProcGrid proc_grid_; ///< Process grid for the contraction
       size_type K_; ///< Inner dimension size
+      std::shared_ptr<TiledArray::detail::SummaSchedule> schedule_; ///< The
+          ///< SUMMA schedule of the evaluations of this engine
 
 
       static unsigned int
@@ -137,7 +151,7 @@ namespace TiledArray {
       ContEngine(const MultExpr<L, R>& expr) :
         BinaryEngine_(expr), factor_(1), left_vars_(), right_vars_(),
         left_op_(permute_to_no_trans), right_op_(permute_to_no_trans), op_(),
-        proc_grid_(), K_(1u)
+        proc_grid_(), K_(1u), schedule_()
       { }
 
       /// Constructor
@@ -150,7 +164,7 @@ namespace TiledArray {
       ContEngine(const ScalMultExpr<L, R, S>& expr) :
         BinaryEngine_(expr), factor_(expr.factor()), left_vars_(), right_vars_(),
         left_op_(permute_to_no_trans), right_op_(permute_to_no_trans), op_(),
-        proc_grid_(), K_(1u)
+        proc_grid_(), K_(1u), schedule_()
       { }
 
       // Pull base class functions into this class.
@@ -166,7 +180,9 @@ namespace TiledArray {
       /// \param target_vars The target variable list for this expression
       void perm_vars(const VariableList& target_vars) {
         // Only permute if the arguments can be permuted
-        if((left_op_ == permute_to_no_trans) || (right_op_ == permute_to_no_trans)) {
+        if((left_op_ == permute_to_no_trans) || (right_op_ == permute_to_no_trans)
+            || (left_op_ == permute_in_gemm) || (right_op_ == permute_in_gemm))
+        {
 
           // Compute ranks
           const unsigned int result_rank = target_vars.dim();
@@ -185,7 +201,7 @@ namespace TiledArray {
           // to fit the target.
           if(target_partitioned) {
 
-            if(left_op_ == permute_to_no_trans) {
+            if((left_op_ == permute_to_no_trans) || (left_op_ == permute_in_gemm)) {
               // Copy left-hand target variables to left and result variable lists.
               for(unsigned int i = 0u; i < left_outer_rank; ++i) {
                 const std::string& var = target_vars[i];
@@ -193,15 +209,18 @@ namespace TiledArray {
                 const_cast<std::string&>(vars_[i]) = var;
               }
 
-              // Permute the left argument with the new variable list.
-              left_.perm_vars(left_vars_);
+              // Permute the left argument with the new variable list. Tiles
+              // that are permuted in the contraction only need the new
+              // variable list.
+              if(left_op_ == permute_to_no_trans)
+                left_.perm_vars(left_vars_);
             } else {
               // Copy left-hand outer variables to that of result.
               for(unsigned int i = 0u; i < left_outer_rank; ++i)
                 const_cast<std::string&>(vars_[i]) = left_vars_[i];
             }
 
-            if(right_op_ == permute_to_no_trans) {
+            if((right_op_ == permute_to_no_trans) || (right_op_ == permute_in_gemm)) {
               // Copy right-hand target variables to right and result variable lists.
               for(unsigned int i = left_outer_rank, j = inner_rank; i < result_rank; ++i, ++j) {
                 const std::string& var = target_vars[i];
@@ -210,7 +229,8 @@ namespace TiledArray {
               }
 
               // Permute the left argument with the new variable list.
-              right_.perm_vars(right_vars_);
+              if(right_op_ == permute_to_no_trans)
+                right_.perm_vars(right_vars_);
             } else {
               // Copy right-hand outer variables to that of result.
               for(unsigned int i = left_outer_rank, j = inner_rank; i < result_rank; ++i, ++j)
@@ -283,11 +303,18 @@ namespace TiledArray {
         // If the inner variable lists of the arguments are not in the same
         // order, one of them will need to be permuted. Here, we determine which
         // argument, left or right, will be permuted if a permutation is
-        // required. The argument with the lowest rank is preferred since it is
-        // likely to have the smaller memory footprint, or the fewest leaves to
-        // minimize the number of permutations in the expression.
-        const bool perm_left = (left_rank < right_rank) || ((left_rank == right_rank)
-            && (left_type::leaves <= right_type::leaves));
+        // required. The argument that copies fewer elements when it is
+        // permuted is preferred, see permute_cost(). When the costs are
+        // equal, e.g. both arguments are contractions, the argument with the
+        // lowest rank is preferred since it is likely to have the smaller
+        // memory footprint, or the fewest leaves to minimize the number of
+        // permutations in the expression.
+        const std::size_t left_cost = left_.permute_cost();
+        const std::size_t right_cost = right_.permute_cost();
+        const bool perm_left = (left_cost != right_cost ?
+            left_cost < right_cost :
+            (left_rank < right_rank) || ((left_rank == right_rank)
+                && (left_type::leaves <= right_type::leaves)));
 
         // Extract variables from the right-hand argument, collect information
         // about the layout of the variable lists, and ensure the inner variable
@@ -330,13 +357,18 @@ namespace TiledArray {
 
         // Here we set the type of permutation that will be applied to the
         // argument tensors. If an argument is in matrix form, permutation of
-        // the tiles is disabled.
+        // the tiles is disabled. Otherwise, the tiles of the larger argument
+        // are permuted while they are contracted, if the tile type supports
+        // it, which avoids storing a permuted copy of the larger argument.
         if(left_is_no_trans) {
           left_op_ = no_trans;
           left_.permute_tiles(false);
         } else if(left_is_trans) {
           left_op_ = trans;
           left_.permute_tiles(false);
+        } else if(left_permute_in_gemm && (! perm_left)) {
+          left_op_ = permute_in_gemm;
+          left_.permute_tiles(false);
         } else {
           left_.perm_vars(left_vars_);
         }
@@ -346,6 +378,9 @@ namespace TiledArray {
         } else if(right_is_trans) {
           right_op_ = trans;
           right_.permute_tiles(false);
+        } else if(right_permute_in_gemm && perm_left) {
+          right_op_ = permute_in_gemm;
+          right_.permute_tiles(false);
         } else {
           right_.perm_vars(right_vars_);
         }
@@ -362,6 +397,15 @@ namespace TiledArray {
         left_.init_struct(left_vars_);
         right_.init_struct(right_vars_);
 
+        // Compute the number of tiles in the contracted dimensions
+        const unsigned int left_rank = left_vars_.dim();
+        const unsigned int inner_rank = (left_rank + right_vars_.dim() - vars_.dim()) >> 1;
+        const size_type* MADNESS_RESTRICT const left_tiles_size =
+            left_.trange().tiles_range().extent_data();
+        K_ = 1ul;
+        for(unsigned int i = left_rank - inner_rank; i < left_rank; ++i)
+          K_ *= left_tiles_size[i];
+
         // Initialize the tile operation in this function because it is used to
         // evaluate the tiled range and shape.
 
@@ -370,34 +414,260 @@ namespace TiledArray {
         const madness::cblas::CBLAS_TRANSPOSE right_op =
             (right_op_ == trans ? madness::cblas::Trans : madness::cblas::NoTrans);
 
+        // Get the permutations that are applied to argument tiles while they
+        // are contracted
+        const Permutation left_perm =
+            (left_op_ == permute_in_gemm ? left_.perm() : Permutation());
+        const Permutation right_perm =
+            (right_op_ == permute_in_gemm ? right_.perm() : Permutation());
 
         if(target_vars != vars_) {
           // Initialize permuted structure
           perm_ = ExprEngine_::make_perm(target_vars);
           op_ = op_type(left_op, right_op, factor_, vars_.dim(), left_vars_.dim(),
-              right_vars_.dim(), (permute_tiles_ ? perm_ : Permutation()));
+              right_vars_.dim(), (permute_tiles_ ? perm_ : Permutation()),
+              left_perm, right_perm);
           trange_ = ContEngine_::make_trange(perm_);
-          shape_ = ContEngine_::make_shape(perm_);
+          const std::shared_ptr<const TiledArray::detail::Bitset<> > mask =
+              make_result_mask();
+          shape_ = (mask ? ContEngine_::make_shape(perm_, *mask) :
+              ContEngine_::make_shape(perm_));
         } else {
           // Initialize non-permuted structure
           op_ = op_type(left_op, right_op, factor_, vars_.dim(), left_vars_.dim(),
-              right_vars_.dim());
+              right_vars_.dim(), Permutation(), left_perm, right_perm);
           trange_ = ContEngine_::make_trange();
-          shape_ = ContEngine_::make_shape();
+          const std::shared_ptr<const TiledArray::detail::Bitset<> > mask =
+              make_result_mask();
+          shape_ = (mask ? ContEngine_::make_shape(*mask) :
+              ContEngine_::make_shape());
         }
 
-        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->shape){
-            shape_ = shape_.mask(*ExprEngine_::override_ptr_->shape);
-        } 
+        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->mixed_precision)
+          op_.mixed_precision(true);
+
+        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->epilogue)
+          op_.epilogue(ExprEngine_::override_ptr_->epilogue);
+
+        // The result includes the non-zero tiles of the initial value
+        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->seed) {
+          TA_ASSERT(ExprEngine_::override_ptr_->seed_shape);
+          shape_ = shape_.add(*ExprEngine_::override_ptr_->seed_shape);
+          op_.seed(ExprEngine_::override_ptr_->seed);
+        }
+
+        // The SUMMA schedule depends on the shapes, so it is recorded again
+        schedule_ = std::make_shared<TiledArray::detail::SummaSchedule>();
       }
 
-      /// Initialize result tensor distribution
+      /// Number of process grid layers for the contraction
+
+      /// The number of layers is set with \c Expr::set_summa_layers() , or
+      /// selected by \c ProcGrid::optimal_proc_layers() such that the copies
+      /// of the result held by the layers use no more than half of the free
+      /// memory of each node. Layers are only used for dense results. The
+      /// automatic selection is collective, since the free memory of the
+      /// processes is reduced to its minimum, so that all processes construct
+      /// the same process grid.
+      /// \param world The world where the result will be distributed
+      /// \param M The number of result tile rows
+      /// \param N The number of result tile columns
+      /// \param m The number of result element rows
+      /// \param n The number of result element columns
+      /// \param k The number of elements in the contracted dimension
+      /// \return The number of process grid layers
+      size_type proc_layers(World& world, const size_type M, const size_type N,
+          const size_type m, const size_type n, const size_type k) const
+      {
+        if(! shape_.is_dense())
+          return 1ul;
+
+        const size_type nprocs = world.size();
+        const size_type max_layers = std::min<size_type>(nprocs, K_);
+
+        // Use the number of layers selected for this expression
+        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->layers)
+          return std::min<size_type>(ExprEngine_::override_ptr_->layers, max_layers);
+
+        // Bound the number of layers by the memory required by the copies of
+        // the result
+        typedef typename TiledArray::detail::numeric_type<value_type>::type
+            numeric_type;
+        // The free memory differs between nodes, so all processes use the
+        // smallest value, and select the same number of layers.
+        const std::size_t result_memory = m * n * sizeof(numeric_type);
+        unsigned long node_memory =
+            TiledArray::detail::node_available_memory() /
+            (2ul * TiledArray::detail::node_local_procs());
+        world.gop.min(& node_memory, 1);
+        const std::size_t memory_layers = node_memory * nprocs / result_memory;
+        if(memory_layers <= 1ul)
+          return 1ul;
+
+        return TiledArray::detail::ProcGrid::optimal_proc_layers(nprocs, M, N,
+            K_, m, n, k, std::min<std::size_t>(memory_layers, max_layers));
+      }
 
-      /// This function will initialize the world and process map for the result
-      /// tensor.
-      /// \param world The world were the result will be distributed
-      /// \param pmap The process map for the result tensor tiles
-      void init_distribution(World* world, std::shared_ptr<pmap_interface> pmap) {
+      /// Check that an argument is distributed like a SUMMA argument
+
+      /// \param pmap The process map of the argument (may be NULL)
+      /// \param world The world where the result will be distributed
+      /// \param rows The number of tile rows of the argument
+      /// \param cols The number of tile columns of the argument
+      /// \param M The number of tile rows of the result
+      /// \param N The number of tile columns of the result
+      /// \return \c true if \c pmap is a cyclic process map of the argument
+      /// tiles whose process grid is valid for the result
+      static bool is_summa_layout(const pmap_interface* pmap, World& world,
+          const size_type rows, const size_type cols, const size_type M,
+          const size_type N)
+      {
+        const TiledArray::detail::CyclicPmap* layout =
+            dynamic_cast<const TiledArray::detail::CyclicPmap*>(pmap);
+        return layout && (layout->procs() == size_type(world.size())) &&
+            (layout->nrows() == rows) && (layout->ncols() == cols) &&
+            (layout->nrows_proc() <= M) && (layout->ncols_proc() <= N);
+      }
+
+      /// Check for an outer product
+
+      /// \return \c true if no indices are contracted
+      bool is_outer_product() const {
+        return op_.gemm_helper().num_contract_ranks() == 0u;
+      }
+
+      /// Construct the process map of the arguments of an outer product
+
+      /// An outer product is computed by the owners of its result tiles, so
+      /// the larger argument is distributed cyclically over all processes,
+      /// and the result is distributed like it, i.e. the result tiles that
+      /// use an argument tile are owned by the owner of the argument tile.
+      /// Only the smaller argument is sent to (replicated on) the processes
+      /// that use it, and it keeps its native distribution, if it has one.
+      /// \param world The world where the result will be distributed
+      /// \param left \c true for the left-hand argument
+      /// \return The process map of the argument
+      std::shared_ptr<pmap_interface>
+      make_outer_arg_pmap(World& world, const bool left) const {
+        const size_type M = left_.trange().tiles_range().volume();
+        const size_type N = right_.trange().tiles_range().volume();
+        const size_type P = world.size();
+        if(left != outer_left_is_larger()) {
+          std::shared_ptr<pmap_interface> pmap =
+              (left ? left_.native_pmap(world) : right_.native_pmap(world));
+          if(pmap)
+            return pmap;
+        }
+        if(left)
+          return std::make_shared<TiledArray::detail::CyclicPmap>(world, M, 1ul,
+              std::min(M, P), 1ul);
+        return std::make_shared<TiledArray::detail::CyclicPmap>(world, 1ul, N,
+            1ul, std::min(N, P));
+      }
+
+      /// Check that the left-hand argument of an outer product is larger
+
+      /// \return \c true if the left-hand argument has at least as many
+      /// elements as the right-hand argument
+      bool outer_left_is_larger() const {
+        return left_.trange().elements_range().volume() >=
+            right_.trange().elements_range().volume();
+      }
+
+      /// Construct the native process map of an outer product
+
+      /// The result tiles are owned by the owner of the tile of the larger
+      /// argument that they use (see \c make_outer_arg_pmap() ).
+      /// \param world The world where the result will be distributed
+      /// \return The process map of the result
+      std::shared_ptr<pmap_interface> make_outer_pmap(World& world) const {
+        const size_type M = left_.trange().tiles_range().volume();
+        const size_type N = right_.trange().tiles_range().volume();
+        const size_type P = world.size();
+        if(outer_left_is_larger())
+          return std::make_shared<TiledArray::detail::CyclicPmap>(world, M, N,
+              std::min(M, P), 1ul);
+        return std::make_shared<TiledArray::detail::CyclicPmap>(world, M, N,
+            1ul, std::min(N, P));
+      }
+
+      /// Construct the process grid for a sparse contraction
+
+      /// The element rows and columns of the grid are weighted by the
+      /// fraction of the elements of the left- and right-hand arguments that
+      /// are in non-zero tiles, and the work is the number of flops of the
+      /// non-zero tile pairs, which is an upper bound when pairs are screened
+      /// or the result is sparser than the product of the shapes. These are
+      /// computed from the shapes, which are equal on all processes, in
+      /// O(MK + KN) time.
+      /// \param world The world where the result will be distributed
+      /// \param M The number of result tile rows
+      /// \param N The number of result tile columns
+      /// \return The process grid of the sparse contraction
+      TiledArray::detail::ProcGrid
+      make_sparse_proc_grid(World& world, const size_type M, const size_type N) const {
+        const math::GemmHelper& gemm_helper = op_.gemm_helper();
+        const unsigned int inner_rank = gemm_helper.num_contract_ranks();
+        const unsigned int left_outer_rank = gemm_helper.left_rank() - inner_rank;
+        const unsigned int right_rank = gemm_helper.right_rank();
+
+        // The element extents of the tile rows, columns, and inner tiles
+        std::vector<double> m(M, 1.0), n(N, 1.0), k(K_, 1.0);
+        for(size_type i = 0ul; i < M; ++i) {
+          const auto range = left_.trange().make_tile_range(i * K_);
+          for(unsigned int d = 0u; d < left_outer_rank; ++d)
+            m[i] *= range.extent_data()[d];
+        }
+        for(size_type x = 0ul; x < K_; ++x) {
+          const auto range = left_.trange().make_tile_range(x);
+          for(unsigned int d = left_outer_rank; d < gemm_helper.left_rank(); ++d)
+            k[x] *= range.extent_data()[d];
+        }
+        for(size_type j = 0ul; j < N; ++j) {
+          const auto range = right_.trange().make_tile_range(j);
+          for(unsigned int d = inner_rank; d < right_rank; ++d)
+            n[j] *= range.extent_data()[d];
+        }
+
+        // The non-zero element rows of each column of left and the non-zero
+        // element columns of each row of right
+        const auto& left_shape = left_.shape();
+        const auto& right_shape = right_.shape();
+        std::vector<double> left_rows(K_, 0.0), right_cols(K_, 0.0);
+        for(size_type i = 0ul; i < M; ++i)
+          for(size_type x = 0ul; x < K_; ++x)
+            if(! left_shape.is_zero(i * K_ + x))
+              left_rows[x] += m[i];
+        for(size_type x = 0ul; x < K_; ++x)
+          for(size_type j = 0ul; j < N; ++j)
+            if(! right_shape.is_zero(x * N + j))
+              right_cols[x] += n[j];
+
+        const double row_size = std::accumulate(m.begin(), m.end(), 0.0);
+        const double col_size = std::accumulate(n.begin(), n.end(), 0.0);
+        const double inner_size = std::accumulate(k.begin(), k.end(), 0.0);
+        double left_size = 0.0, right_size = 0.0, flops = 0.0, inner_count = 0.0;
+        for(size_type x = 0ul; x < K_; ++x) {
+          left_size += left_rows[x] * k[x];
+          right_size += right_cols[x] * k[x];
+          flops += 2.0 * left_rows[x] * k[x] * right_cols[x];
+          if((left_rows[x] > 0.0) && (right_cols[x] > 0.0))
+            inner_count += 1.0;
+        }
+
+        return TiledArray::detail::ProcGrid(world, M, N, left_size / inner_size,
+            right_size / inner_size, inner_size, inner_count, flops);
+      }
+
+      /// Construct the process grid for the contraction
+
+      /// The process grid of an argument that is stored in a SUMMA
+      /// distribution is reused, otherwise the grid dimensions and the number
+      /// of layers are selected for the contraction. The grids of sparse
+      /// arguments are selected with \c make_sparse_proc_grid() .
+      /// \param world The world where the result will be distributed
+      /// \return The process grid that evaluates this contraction
+      TiledArray::detail::ProcGrid make_proc_grid(World& world) const {
         const unsigned int inner_rank = op_.gemm_helper().num_contract_ranks();
         const unsigned int left_rank = op_.gemm_helper().left_rank();
         const unsigned int right_rank = op_.gemm_helper().right_rank();
@@ -414,21 +684,60 @@ namespace TiledArray {
             right_.trange().elements_range().extent_data();
 
         // Compute the fused sizes of the contraction
-        size_type M = 1ul, m = 1ul, N = 1ul, n = 1ul;
+        size_type M = 1ul, m = 1ul, N = 1ul, n = 1ul, k = 1ul;
         unsigned int i = 0u;
         for(; i < left_outer_rank; ++i) {
           M *= left_tiles_size[i];
           m *= left_element_size[i];
         }
         for(; i < left_rank; ++i)
-          K_ *= left_tiles_size[i];
+          k *= left_element_size[i];
         for(i = inner_rank; i < right_rank; ++i) {
           N *= right_tiles_size[i];
           n *= right_element_size[i];
         }
 
+        // Use the process grid of an argument that is stored in a SUMMA
+        // distribution (see summa_pmap()), so it is not redistributed,
+        // unless the number of layers is selected for this expression
+        if(! (ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->layers)) {
+          const std::shared_ptr<pmap_interface> left_pmap = left_.native_pmap(world);
+          if(is_summa_layout(left_pmap.get(), world, M, K_, M, N))
+            return TiledArray::detail::ProcGrid(world, M, N,
+                static_cast<const TiledArray::detail::CyclicPmap&>(*left_pmap));
+          const std::shared_ptr<pmap_interface> right_pmap = right_.native_pmap(world);
+          if(is_summa_layout(right_pmap.get(), world, K_, N, M, N))
+            return TiledArray::detail::ProcGrid(world, M, N,
+                static_cast<const TiledArray::detail::CyclicPmap&>(*right_pmap));
+        }
+
         // Construct the process grid.
-        proc_grid_ = TiledArray::detail::ProcGrid(*world, M, N, m, n);
+        const size_type layers = proc_layers(world, M, N, m, n, k);
+        if(layers > 1ul)
+          return TiledArray::detail::ProcGrid(world, M, N, m, n, layers);
+        else if(! (left_.shape().is_dense() && right_.shape().is_dense()))
+          return make_sparse_proc_grid(world, M, N);
+        else
+          return TiledArray::detail::ProcGrid(world, M, N, m, n);
+      }
+
+      /// Initialize result tensor distribution
+
+      /// This function will initialize the world and process map for the result
+      /// tensor.
+      /// \param world The world were the result will be distributed
+      /// \param pmap The process map for the result tensor tiles
+      void init_distribution(World* world, std::shared_ptr<pmap_interface> pmap) {
+        if(is_outer_product()) {
+          left_.init_distribution(world, make_outer_arg_pmap(*world, true));
+          right_.init_distribution(world, make_outer_arg_pmap(*world, false));
+          if(! pmap)
+            pmap = make_outer_pmap(*world);
+          ExprEngine_::init_distribution(world, pmap);
+          return;
+        }
+
+        proc_grid_ = make_proc_grid(*world);
 
         // Initialize children
         left_.init_distribution(world, proc_grid_.make_row_phase_pmap(K_));
@@ -440,6 +749,37 @@ namespace TiledArray {
         ExprEngine_::init_distribution(world, pmap);
       }
 
+      /// Native process map accessor
+
+      /// The arguments of a contraction are redistributed over the process
+      /// grid for any result distribution, and the result tiles are computed
+      /// by the processes of the grid. Outer products are distributed like
+      /// their larger argument.
+      /// \param world The world where the expression is evaluated
+      /// \return The process map of the process grid
+      std::shared_ptr<pmap_interface> native_pmap(World& world) const {
+        if(is_outer_product())
+          return make_outer_pmap(world);
+        return make_proc_grid(world).make_pmap();
+      }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param world The world where the expression is evaluated
+      /// \param pmap The process map of the result tensor
+      /// \return The number of elements, in non-zero result tiles, that are
+      /// moved from the process grid to \c pmap
+      std::size_t redistribution_cost(World& world, const pmap_interface& pmap) const {
+        return ExprEngine_::move_cost(*native_pmap(world), pmap);
+      }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// The result tiles are permuted when they are reduced, or the
+      /// permutation is moved to the arguments by \c perm_vars() .
+      /// \return Zero
+      std::size_t permute_cost() const { return 0ul; }
+
       /// Tiled range factory function
 
       /// \param perm The permutation to be applied to the array
@@ -500,6 +840,32 @@ namespace TiledArray {
         return trange_type(ranges.begin(), ranges.end());
       }
 
+      /// The mask of the result tiles that may be non-zero
+
+      /// The mask combines the non-zero tiles of the shape that is set with
+      /// \c Expr::set_shape() and the tile mask that is set with
+      /// \c Expr::set_tile_mask() . The shape of the result is only computed
+      /// for these tiles, and \c Summa neither broadcasts nor contracts
+      /// argument tiles that only contribute to tiles outside the mask.
+      /// \return The result tile mask in the ordinal order of the tiles of
+      /// \c trange_ , or a null pointer when all tiles may be non-zero
+      std::shared_ptr<const TiledArray::detail::Bitset<> > make_result_mask() const {
+        const auto& override_ptr = ExprEngine_::override_ptr_;
+        if(! (override_ptr && (override_ptr->shape || override_ptr->tile_mask)))
+          return nullptr;
+        if(! override_ptr->shape)
+          return override_ptr->tile_mask;
+
+        const std::size_t volume = trange_.tiles_range().volume();
+        std::shared_ptr<TiledArray::detail::Bitset<> > mask =
+            std::make_shared<TiledArray::detail::Bitset<> >(volume);
+        for(std::size_t i = 0ul; i < volume; ++i)
+          if(! override_ptr->shape->is_zero(i) &&
+              (! override_ptr->tile_mask || (*override_ptr->tile_mask)[i]))
+            mask->set(i);
+        return mask;
+      }
+
       /// Non-permuting shape factory function
 
       /// \return The result shape
@@ -524,7 +890,40 @@ namespace TiledArray {
                                   perm);
       }
 
+      /// Non-permuting shape factory function for masked results
+
+      /// \param mask The result tile mask
+      /// \return The result shape, which is zero outside \c mask
+      shape_type make_shape(const TiledArray::detail::Bitset<>& mask) const {
+        const TiledArray::math::GemmHelper
+        shape_gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+            op_.gemm_helper().result_rank(), op_.gemm_helper().left_rank(),
+            op_.gemm_helper().right_rank());
+        return left_.shape().gemm(right_.shape(), factor_, shape_gemm_helper,
+            mask);
+      }
+
+      /// Permuting shape factory function for masked results
+
+      /// \param perm The permutation to be applied to the array
+      /// \param mask The result tile mask, in the order of the permuted
+      /// result
+      /// \return The result shape, which is zero outside \c mask
+      shape_type make_shape(const Permutation& perm,
+          const TiledArray::detail::Bitset<>& mask) const
+      {
+        const TiledArray::math::GemmHelper
+        shape_gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+            op_.gemm_helper().result_rank(), op_.gemm_helper().left_rank(),
+            op_.gemm_helper().right_rank());
+        return left_.shape().gemm(right_.shape(), factor_, shape_gemm_helper,
+            perm, mask);
+      }
+
       dist_eval_type make_dist_eval() const {
+        if(is_outer_product())
+          return make_outer_dist_eval();
+
         // Define the impl type
         typedef TiledArray::detail::Summa<typename left_type::dist_eval_type,
             typename right_type::dist_eval_type, op_type, typename Derived::policy> impl_type;
@@ -534,11 +933,60 @@ namespace TiledArray {
 
         std::shared_ptr<impl_type> pimpl(
             new impl_type(left, right, *world_, trange_, shape_, pmap_, perm_,
-            op_, K_, proc_grid_));
+            op_, K_, proc_grid_, schedule_));
+
+        if(std::shared_ptr<ExprProfile> profile = BinaryEngine_::make_profile()) {
+          profile->add_child(left.profile());
+          profile->add_child(right.profile());
+          pimpl->profile(profile);
+        }
+
+        // Reuse the broadcasts of an array argument
+        if(summa_bcast_cache_capacity() ||
+            TiledArray::detail::summa_bcast_scope_active())
+          bcast_cache_key(*pimpl, std::is_base_of<LeafEngine<left_type>, left_type>());
+
+        return dist_eval_type(pimpl);
+      }
+
+      /// Construct the distributed evaluator of an outer product
+
+      /// \return The owner-computes outer product evaluator
+      dist_eval_type make_outer_dist_eval() const {
+        typedef TiledArray::detail::OuterEvalImpl<typename left_type::dist_eval_type,
+            typename right_type::dist_eval_type, op_type, typename Derived::policy> impl_type;
+
+        typename left_type::dist_eval_type left = left_.make_dist_eval();
+        typename right_type::dist_eval_type right = right_.make_dist_eval();
+
+        std::shared_ptr<impl_type> pimpl =
+            std::make_shared<impl_type>(left, right, *world_, trange_, shape_,
+            pmap_, perm_, op_);
+
+        if(std::shared_ptr<ExprProfile> profile = BinaryEngine_::make_profile()) {
+          profile->add_child(left.profile());
+          profile->add_child(right.profile());
+          pimpl->profile(profile);
+        }
 
         return dist_eval_type(pimpl);
       }
 
+      /// Set the SUMMA broadcast cache key of the left-hand argument
+
+      /// This function does nothing since the left-hand argument is not an
+      /// array.
+      template <typename Impl>
+      void bcast_cache_key(Impl&, std::false_type) const { }
+
+      /// Set the SUMMA broadcast cache key of the left-hand argument
+
+      /// \param impl The SUMMA evaluator
+      template <typename Impl>
+      void bcast_cache_key(Impl& impl, std::true_type) const {
+        impl.bcast_cache_key(left_.make_lazy_tile_cache_key());
+      }
+
       /// Expression identification tag
 
       /// \return An expression tag used to identify this expression
@@ -551,6 +999,90 @@ namespace TiledArray {
       }
 
 
+      /// Construct the cost estimate of this expression
+
+      /// The flops are counted for each pair of non-zero argument tiles that
+      /// contributes to a non-zero result tile. Each non-zero argument tile
+      /// is counted as broadcast to the other processes of its process grid
+      /// row or column, which is an upper bound when the broadcast groups are
+      /// pruned by the result shape. Outer products do not broadcast.
+      /// \return The cost estimate of this expression and its arguments
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        std::shared_ptr<ExprEstimate> estimate = BinaryEngine_::make_estimate();
+
+        const math::GemmHelper& gemm_helper = op_.gemm_helper();
+        const unsigned int inner_rank = gemm_helper.num_contract_ranks();
+        const unsigned int left_outer_rank = gemm_helper.left_rank() - inner_rank;
+        const unsigned int right_rank = gemm_helper.right_rank();
+
+        // The element extents of the tile rows, columns, and inner tiles
+        const size_type M = left_.trange().tiles_range().volume() / K_;
+        const size_type N = right_.trange().tiles_range().volume() / K_;
+        std::vector<unsigned long long> m(M), n(N), k(K_);
+        for(size_type i = 0ul; i < M; ++i) {
+          const auto range = left_.trange().make_tile_range(i * K_);
+          m[i] = 1ull;
+          for(unsigned int d = 0u; d < left_outer_rank; ++d)
+            m[i] *= range.extent_data()[d];
+        }
+        for(size_type x = 0ul; x < K_; ++x) {
+          const auto range = left_.trange().make_tile_range(x);
+          k[x] = 1ull;
+          for(unsigned int d = left_outer_rank; d < gemm_helper.left_rank(); ++d)
+            k[x] *= range.extent_data()[d];
+        }
+        for(size_type j = 0ul; j < N; ++j) {
+          const auto range = right_.trange().make_tile_range(j);
+          n[j] = 1ull;
+          for(unsigned int d = inner_rank; d < right_rank; ++d)
+            n[j] *= range.extent_data()[d];
+        }
+
+        // The non-zero result tiles in the order of the contraction
+        std::vector<bool> result(M * N, false);
+        const Permutation inv_perm = perm_.inv();
+        const auto gemm_range = (perm_ ? inv_perm * trange_.tiles_range() :
+            trange_.tiles_range());
+        for(size_type t = 0ul; t < M * N; ++t)
+          if(! shape_.is_zero(t))
+            result[perm_ ? gemm_range.ordinal(inv_perm *
+                trange_.tiles_range().idx(t)) : t] = true;
+
+        const auto& left_shape = left_.shape();
+        const auto& right_shape = right_.shape();
+        unsigned long long flops = 0ull;
+        for(size_type i = 0ul; i < M; ++i)
+          for(size_type x = 0ul; x < K_; ++x) {
+            if(left_shape.is_zero(i * K_ + x))
+              continue;
+            unsigned long long columns = 0ull;
+            for(size_type j = 0ul; j < N; ++j)
+              if(result[i * N + j] && ! right_shape.is_zero(x * N + j))
+                columns += n[j];
+            flops += 2ull * m[i] * k[x] * columns;
+          }
+        estimate->add_flops(flops);
+
+        if(is_outer_product() || (world_->size() == 1))
+          return estimate;
+
+        // SUMMA broadcasts
+        const unsigned long long element_bytes =
+            sizeof(TiledArray::detail::numeric_t<value_type>);
+        const unsigned long long row_procs = proc_grid_.proc_cols() - 1ul;
+        const unsigned long long col_procs = proc_grid_.proc_rows() - 1ul;
+        for(size_type i = 0ul; i < M; ++i)
+          for(size_type x = 0ul; x < K_; ++x)
+            if(! left_shape.is_zero(i * K_ + x))
+              estimate->add_comm_bytes(m[i] * k[x] * element_bytes * row_procs);
+        for(size_type x = 0ul; x < K_; ++x)
+          for(size_type j = 0ul; j < N; ++j)
+            if(! right_shape.is_zero(x * N + j))
+              estimate->add_comm_bytes(k[x] * n[j] * element_bytes * col_procs);
+
+        return estimate;
+      }
+
       /// Expression print
 
       /// \param os The output stream
@@ -563,6 +1095,14 @@ namespace TiledArray {
         os.dec();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        BinaryEngine_::cache_key(os);
+        os << " [" << factor_ << "]";
+      }
+
     }; // class ContEngine
 
   }  // namespace expressions
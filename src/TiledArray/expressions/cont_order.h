@@ -0,0 +1,251 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  cont_order.h
+ *  Feb 22, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_CONT_ORDER_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_CONT_ORDER_H__INCLUDED
+
+#include <TiledArray/expressions/expr_handle.h>
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/tiled_range.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace TiledArray {
+  namespace expressions {
+
+    // Forward declarations
+    template <typename> class Expr;
+    template <typename, bool> class TsrExpr;
+    template <typename, typename> class MultExpr;
+
+    /// Contraction ordering flag
+
+    /// Contraction chains are reordered unless the \c TA_CONTRACTION_ORDER
+    /// environment variable is set to \c 0 .
+    /// \return \c true if contraction chains are reordered
+    inline bool contraction_ordering() {
+      static const bool enabled = [] () -> bool {
+        const char* enabled = getenv("TA_CONTRACTION_ORDER");
+        return ! (enabled && (std::strcmp(enabled, "0") == 0));
+      }();
+      return enabled;
+    }
+
+    /// The evaluation orders of a chain of three contraction operands
+    enum class ContOrder {
+      left,  ///< <tt>(a * b) * c</tt>
+      right, ///< <tt>a * (b * c)</tt>
+      outer  ///< <tt>(a * c) * b</tt>
+    }; // enum class ContOrder
+
+    /// Contraction operand summary used by the contraction cost model
+    struct ContOperand {
+      std::vector<std::string> vars; ///< The operand indices
+      std::vector<double> extents; ///< The number of elements of each index
+      std::vector<double> tiles; ///< The number of tiles of each index
+      double density; ///< The fraction of non-zero tiles
+
+      ContOperand() : vars(), extents(), tiles(), density(1.0) { }
+
+      /// Constructor
+
+      /// \param v The variable list of the operand
+      /// \param trange The tiled range of the operand
+      /// \param sparsity The fraction of zero tiles of the operand
+      ContOperand(const VariableList& v, const TiledRange& trange,
+          const float sparsity) :
+        vars(v.begin(), v.end()), extents(), tiles(),
+        density(1.0 - double(sparsity))
+      {
+        TA_ASSERT(v.dim() == trange.tiles_range().rank());
+        for(unsigned int i = 0u; i < v.dim(); ++i) {
+          extents.push_back(trange.elements_range().extent_data()[i]);
+          tiles.push_back(trange.tiles_range().extent_data()[i]);
+        }
+      }
+
+      /// Index query
+
+      /// \param var The index
+      /// \return \c true if \c var is an index of this operand
+      bool has(const std::string& var) const {
+        return std::find(vars.begin(), vars.end(), var) != vars.end();
+      }
+
+    }; // struct ContOperand
+
+    /// Estimate the cost of contracting two operands
+
+    /// The cost is the number of floating point operations plus the number
+    /// of elements of the result, which is written once and read once by the
+    /// next contraction. Both are scaled by the densities of the operands;
+    /// the tiles of the result are assumed to be non-zero if any product of
+    /// non-zero tiles contributes to them.
+    /// \param left The left-hand operand
+    /// \param right The right-hand operand
+    /// \param keep The indices that are not summed by this contraction, i.e.
+    /// the indices of the other operands and of the target
+    /// \param[in,out] cost The accumulated cost; the cost of this contraction
+    /// is added to it
+    /// \return The summary of the result
+    inline ContOperand cont_product(const ContOperand& left,
+        const ContOperand& right, const std::vector<std::string>& keep,
+        double& cost)
+    {
+      ContOperand result;
+      double volume = 1.0, result_volume = 1.0, summed_tiles = 1.0;
+      const double density = left.density * right.density;
+      auto add_var = [&] (const ContOperand& arg, const unsigned int i) {
+        volume *= arg.extents[i];
+        if(std::find(keep.begin(), keep.end(), arg.vars[i]) != keep.end()) {
+          result.vars.push_back(arg.vars[i]);
+          result.extents.push_back(arg.extents[i]);
+          result.tiles.push_back(arg.tiles[i]);
+          result_volume *= arg.extents[i];
+        } else {
+          summed_tiles *= arg.tiles[i];
+        }
+      };
+      for(unsigned int i = 0u; i < left.vars.size(); ++i)
+        add_var(left, i);
+      for(unsigned int i = 0u; i < right.vars.size(); ++i)
+        if(! left.has(right.vars[i]))
+          add_var(right, i);
+
+      result.density = 1.0 - std::pow(1.0 - density, summed_tiles);
+      cost += 2.0 * volume * density + 2.0 * result_volume * result.density;
+      return result;
+    }
+
+    /// Select the evaluation order of a chain of three contraction operands
+
+    /// The order is only changed for chains of pure contractions, i.e. where
+    /// each index occurs in exactly two of the operands and the target, and
+    /// when another order is estimated to be at least 10% cheaper.
+    /// \param a The first operand
+    /// \param b The second operand
+    /// \param c The third operand
+    /// \param target The target indices
+    /// \param current The order of the chain as it was written
+    /// \return The selected order
+    inline ContOrder cont_chain_order(const ContOperand& a, const ContOperand& b,
+        const ContOperand& c, const VariableList& target, const ContOrder current)
+    {
+      ContOperand t;
+      t.vars.assign(target.begin(), target.end());
+
+      // Check that each index occurs exactly twice
+      const ContOperand* const args[4] = { &a, &b, &c, &t };
+      for(const ContOperand* arg : args) {
+        for(const std::string& var : arg->vars) {
+          const long count = std::count(arg->vars.begin(), arg->vars.end(), var);
+          if((count != 1l) || ((a.has(var) + b.has(var) + c.has(var) + t.has(var)) != 2))
+            return current;
+        }
+      }
+
+      // The indices that are not summed by the first contraction
+      auto keep = [&t] (const ContOperand& other) {
+        std::vector<std::string> result = other.vars;
+        result.insert(result.end(), t.vars.begin(), t.vars.end());
+        return result;
+      };
+
+      double costs[3] = { 0.0, 0.0, 0.0 };
+      cont_product(cont_product(a, b, keep(c), costs[0]), c, t.vars, costs[0]);
+      cont_product(a, cont_product(b, c, keep(a), costs[1]), t.vars, costs[1]);
+      cont_product(cont_product(a, c, keep(b), costs[2]), b, t.vars, costs[2]);
+
+      unsigned int best = static_cast<unsigned int>(current);
+      for(unsigned int i = 0u; i < 3u; ++i)
+        if(costs[i] < 0.9 * costs[best])
+          best = i;
+      return static_cast<ContOrder>(best);
+    }
+
+    /// Construct the summary of a contraction operand
+
+    /// \tparam E The operand expression type
+    /// \param expr The operand expression
+    /// \return The summary of \c expr
+    template <typename E>
+    inline ContOperand make_cont_operand(const Expr<E>& expr) {
+      typename Expr<E>::engine_type engine(expr.derived());
+      engine.init_vars();
+      engine.init_struct(engine.vars());
+      return ContOperand(engine.vars(), engine.trange(), engine.shape().sparsity());
+    }
+
+    /// Evaluate a chain of three contraction operands in the cheapest order
+
+    /// \tparam A The array type
+    /// \tparam Alias Tile alias flag
+    /// \tparam X The first operand expression type
+    /// \tparam Y The second operand expression type
+    /// \tparam Z The third operand expression type
+    /// \param tsr The tensor to be assigned
+    /// \param x The first operand
+    /// \param y The second operand
+    /// \param z The third operand
+    /// \param current The order of the chain as it was written
+    /// \return The handle of the evaluation, see \c Expr::eval_async()
+    template <typename A, bool Alias, typename X, typename Y, typename Z>
+    inline ExprHandle<A> eval_cont_chain(TsrExpr<A, Alias>& tsr, const X& x, const Y& y,
+        const Z& z, const ContOrder current)
+    {
+      const ContOrder order = cont_chain_order(make_cont_operand(x),
+          make_cont_operand(y), make_cont_operand(z), VariableList(tsr.vars()),
+          current);
+
+      // The reordered expressions are evaluated with the base class
+      // evaluation function, so they are not reordered again.
+      switch(order) {
+        case ContOrder::left:
+          {
+            typedef MultExpr<MultExpr<X, Y>, Z> expr_type;
+            const expr_type expr(MultExpr<X, Y>(x, y), z);
+            return static_cast<const Expr<expr_type>&>(expr).eval_async(tsr);
+          }
+        case ContOrder::right:
+          {
+            typedef MultExpr<X, MultExpr<Y, Z> > expr_type;
+            const expr_type expr(x, MultExpr<Y, Z>(y, z));
+            return static_cast<const Expr<expr_type>&>(expr).eval_async(tsr);
+          }
+        case ContOrder::outer:
+          {
+            typedef MultExpr<MultExpr<X, Z>, Y> expr_type;
+            const expr_type expr(MultExpr<X, Z>(x, z), y);
+            return static_cast<const Expr<expr_type>&>(expr).eval_async(tsr);
+          }
+      }
+
+      // Not reached
+      return ExprHandle<A>(tsr.array());
+    }
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_CONT_ORDER_H__INCLUDED
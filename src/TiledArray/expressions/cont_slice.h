@@ -0,0 +1,227 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  cont_slice.h
+ *  Mar 29, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_CONT_SLICE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_CONT_SLICE_H__INCLUDED
+
+#include <TiledArray/expressions/expr_handle.h>
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/tile_interface/shift.h>
+#include <TiledArray/madness.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The memory budget of the result of a contraction
+
+    /// The initial budget is read from the \c TA_CONTRACTION_MAX_MEMORY
+    /// environment variable, in bytes per process.
+    /// \return A reference to the budget
+    inline std::atomic<std::size_t>& contraction_max_memory_value() {
+      static std::atomic<std::size_t> max_memory([] () -> std::size_t {
+        const char* max_memory = getenv("TA_CONTRACTION_MAX_MEMORY");
+        if(max_memory)
+          return std::strtoul(max_memory, nullptr, 10);
+        return 0ul;
+      }());
+      return max_memory;
+    }
+
+  }  // namespace detail
+
+  /// The memory budget of the result of a contraction
+
+  /// When it is zero, the default, contractions are not sliced; see
+  /// \c expressions::eval_cont_sliced() .
+  /// \return The memory budget of a contraction result, in bytes per process
+  inline std::size_t contraction_max_memory() {
+    return detail::contraction_max_memory_value();
+  }
+
+  /// Set the memory budget of the result of a contraction
+
+  /// The budget must be the same on all processes.
+  /// \param bytes The memory budget of a contraction result, in bytes per
+  /// process, or zero to disable slicing
+  inline void contraction_max_memory(const std::size_t bytes) {
+    detail::contraction_max_memory_value() = bytes;
+  }
+
+  namespace expressions {
+
+    // Forward declaration
+    template <typename, bool> class TsrExpr;
+
+    /// Evaluate a contraction of two arrays in memory-bounded slices
+
+    /// When the estimated memory of the result of <tt>left * right</tt>
+    /// exceeds \c contraction_max_memory() , the result is
+    /// partitioned along an outer index, i.e. the first target index that
+    /// belongs to only one operand, into slices of tiles whose memory is
+    /// within the budget. Each slice is contracted separately with a block
+    /// of that operand, see \c TsrExpr::block() , and its tiles are moved
+    /// into the result before the next slice is started, so the working
+    /// memory of the contraction, e.g. the partial results and the
+    /// broadcast tiles of SUMMA, is that of one slice. The memory of a slice
+    /// is estimated from the volume of its non-zero tiles in the result
+    /// shape.
+    /// \tparam A The result array type
+    /// \tparam Alias Tile alias flag of the result
+    /// \tparam E The contraction expression type
+    /// \tparam L The left-hand array type
+    /// \tparam R The right-hand array type
+    /// \param tsr The tensor to be assigned
+    /// \param expr The contraction expression, <tt>left * right</tt>
+    /// \param left The left-hand argument of \c expr
+    /// \param right The right-hand argument of \c expr
+    /// \return \c true when \c tsr has been assigned, or \c false when the
+    /// contraction does not need to, or cannot, be sliced
+    template <typename A, bool Alias, typename E, typename L, bool AliasL,
+        typename R, bool AliasR>
+    inline bool eval_cont_sliced(TsrExpr<A, Alias>& tsr, const E& expr,
+        const TsrExpr<L, AliasL>& left, const TsrExpr<R, AliasR>& right)
+    {
+      typedef typename A::value_type value_type;
+      typedef typename A::element_type element_type;
+      typedef typename A::size_type size_type;
+
+      const std::size_t budget = contraction_max_memory();
+      if(! budget || (tsr.array().is_initialized() && tsr.array().is_view()))
+        return false;
+
+      World& world = (tsr.array().is_initialized() ? tsr.array().world() :
+          TiledArray::get_default_world());
+      std::shared_ptr<typename A::pmap_interface> pmap;
+      if(tsr.array().is_initialized())
+        pmap = tsr.array().pmap();
+      const VariableList target_vars(tsr.vars());
+
+      typename E::engine_type engine(expr);
+      engine.init(world, pmap, target_vars);
+      if(! engine.is_contraction())
+        return false;
+
+      // Find the outer index that is sliced
+      const VariableList left_vars(left.vars());
+      const VariableList right_vars(right.vars());
+      unsigned int dim = target_vars.dim();
+      bool sliced_left = false;
+      unsigned int operand_dim = 0u;
+      for(unsigned int d = 0u; d < target_vars.dim(); ++d) {
+        const auto l = std::find(left_vars.begin(), left_vars.end(), target_vars[d]);
+        const auto r = std::find(right_vars.begin(), right_vars.end(), target_vars[d]);
+        if((l != left_vars.end()) != (r != right_vars.end())) {
+          dim = d;
+          sliced_left = (l != left_vars.end());
+          operand_dim = (sliced_left ? l - left_vars.begin() : r - right_vars.begin());
+          break;
+        }
+      }
+      if(dim == target_vars.dim())
+        return false;
+
+      // Estimate the memory of each slab of result tiles
+      const auto& trange = engine.trange();
+      const auto& shape = engine.shape();
+      const auto& tiles = trange.tiles_range();
+      const size_type first = tiles.lobound(dim);
+      const size_type slabs = tiles.extent_data()[dim];
+      std::vector<std::size_t> slab_memory(slabs, 0ul);
+      std::size_t memory = 0ul;
+      for(size_type ord = 0ul; ord < tiles.volume(); ++ord) {
+        if(shape.is_zero(ord))
+          continue;
+        const std::size_t bytes =
+            trange.make_tile_range(ord).volume() * sizeof(element_type);
+        slab_memory[tiles.idx(ord)[dim] - first] += bytes;
+        memory += bytes;
+      }
+      const std::size_t procs = world.size();
+      if((memory / procs) <= budget || slabs < 2ul)
+        return false;
+
+      // Partition the slabs into slices that fit in the budget
+      std::vector<size_type> bounds(1, 0ul);
+      std::size_t slice_memory = 0ul;
+      for(size_type s = 0ul; s < slabs; ++s) {
+        if((s > bounds.back()) && (((slice_memory + slab_memory[s]) / procs) > budget)) {
+          bounds.push_back(s);
+          slice_memory = 0ul;
+        }
+        slice_memory += slab_memory[s];
+      }
+      bounds.push_back(slabs);
+
+      A result(world, trange, shape, engine.pmap());
+      const auto& operand_tiles = (sliced_left ? left.array().trange().tiles_range() :
+          right.array().trange().tiles_range());
+      for(std::size_t b = 0ul; (b + 1ul) < bounds.size(); ++b) {
+        // Contract the slice
+        std::vector<std::size_t> lower(operand_tiles.lobound_data(),
+            operand_tiles.lobound_data() + operand_tiles.rank());
+        std::vector<std::size_t> upper(operand_tiles.upbound_data(),
+            operand_tiles.upbound_data() + operand_tiles.rank());
+        lower[operand_dim] += bounds[b];
+        upper[operand_dim] = lower[operand_dim] + (bounds[b + 1ul] - bounds[b]);
+        A slice;
+        TsrExpr<A, true> slice_expr(slice, tsr.vars());
+        ExprHandle<A> handle = (sliced_left ?
+            slice_expr.assign_async(left.block(lower, upper) * right) :
+            slice_expr.assign_async(left * right.block(lower, upper)));
+
+        // Move the tiles of the slice into the result
+        const auto& slice_tiles = slice.trange().tiles_range();
+        for(const auto i : *slice.pmap()) {
+          std::vector<size_type> index = slice_tiles.idx(i);
+          for(unsigned int d = 0u; d < index.size(); ++d)
+            index[d] += tiles.lobound(d) - slice_tiles.lobound(d);
+          index[dim] += bounds[b];
+          const size_type j = tiles.ordinal(index);
+          if(result.is_zero(j))
+            continue;
+          const auto range = trange.make_tile_range(j);
+          if(slice.is_zero(i)) {
+            result.set(j, value_type(range, element_type(0)));
+          } else {
+            result.set(j, world.taskq.add([range] (const value_type& tile) {
+              std::vector<long> bound_shift(range.rank());
+              for(unsigned int d = 0u; d < range.rank(); ++d)
+                bound_shift[d] = long(range.lobound(d)) - long(tile.range().lobound(d));
+              return shift(tile, bound_shift);
+            }, slice.find(i)));
+          }
+        }
+        handle.wait();
+      }
+
+      tsr.array() = result;
+      return true;
+    }
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_CONT_SLICE_H__INCLUDED
@@ -27,6 +27,8 @@
 #define TILEDARRAY_EXPRESSIONS_EXPR_H__INCLUDED
 
 #include "expr_engine.h"
+#include "expr_cache.h"
+#include "expr_handle.h"
 #include "../reduce_task.h"
 #include "../tile_interface/cast.h"
 #include "../tile_interface/scale.h"
@@ -35,6 +37,12 @@
 #include "../tile_op/unary_reduction.h"
 #include "../tile_op/binary_reduction.h"
 #include "../tile_op/reduce_wrapper.h"
+#include "../tile_op/tuple_reduction.h"
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
 
 namespace TiledArray {
   namespace expressions {
@@ -43,12 +51,18 @@ namespace TiledArray {
     template <typename> struct ExprTrait;
     template <typename, bool> class TsrExpr;
     template <typename, bool> class BlkTsrExpr;
+    template <typename> class SumOverExpr;
     template <typename> struct is_aliased;
+    template <typename> class LeafEngine;
 
     template <typename Engine>
     struct EngineParamOverride {
 
-      EngineParamOverride() : world(nullptr), pmap(), shape(nullptr) {}
+      EngineParamOverride() :
+        world(nullptr), pmap(), pmap_hint(), shape(nullptr), tile_mask(), layers(0u),
+        mixed_precision(false), cache(false), epilogue(), seed(),
+        seed_shape(nullptr), threshold(0.0)
+      { }
 
       typedef typename EngineTrait<Engine>::policy policy; ///< The result policy type
       typedef typename EngineTrait<Engine>::shape_type shape_type; ///< Tensor shape type
@@ -56,7 +70,20 @@ namespace TiledArray {
 
        World* world;
        std::shared_ptr<pmap_interface> pmap;
+       std::shared_ptr<pmap_interface> pmap_hint; ///< Where the result will be used
        const shape_type* shape;
+       std::shared_ptr<const TiledArray::detail::Bitset<> >
+           tile_mask; ///< Tiles of the result that may be non-zero
+       unsigned int layers; ///< Number of SUMMA process grid layers (0 = automatic)
+       bool mixed_precision; ///< Accumulate single precision contractions in double precision
+       bool cache; ///< Reuse the cached result of an identical expression
+       std::function<void(typename EngineTrait<Engine>::value_type&)>
+           epilogue; ///< Operation applied to each contraction result tile
+       std::function<bool(std::size_t,
+           Future<typename EngineTrait<Engine>::value_type>&)>
+           seed; ///< Initial values of the contraction result tiles
+       const shape_type* seed_shape; ///< The shape of the initial values
+       double threshold; ///< The zero threshold of the result shape (0 = inherited)
     };
 
     /// \brief type trait checks if T has array() member
@@ -113,6 +140,39 @@ namespace TiledArray {
        }
        return derived();
       }
+      /// \param threshold The zero threshold of the shape of the result of
+      /// this expression, which replaces the threshold that the result
+      /// inherits from its arguments (see \c SparseShape::zero_threshold() ).
+      /// It is carried by the result array, and by the results of later
+      /// expressions of that array, so intermediates may be screened with a
+      /// larger threshold than the arrays that need accuracy, e.g.
+      /// <tt>t("i,j") = (a("i,k") * b("k,j")).set_threshold(1e-8)</tt> .
+      /// Norms that are zero with the inherited threshold are not restored by
+      /// a smaller one. Thresholds are ignored by dense arrays, and expressions with a
+      /// threshold are not cached.
+      Expr<Derived>& set_threshold(const double threshold) {
+        if (! override_ptr_)
+          override_ptr_ = std::make_shared<override_type>();
+        override_ptr_->threshold = threshold;
+        return derived();
+      }
+      /// \param tile_mask A bit-packed mask of the result tiles, with one
+      /// bit per tile in the ordinal order of the tiles of the result; the
+      /// tiles whose bits are cleared are zero tiles of the result, so they
+      /// are never evaluated. A mask may be constructed directly from an
+      /// index or boolean array, e.g. <tt>Bitset<>(t.begin(), t.end())</tt> ,
+      /// without a shape of norms. The mask of a contraction is applied while
+      /// the shape of the result is computed, and argument tiles that only
+      /// contribute to masked tiles are neither broadcast nor contracted.
+      /// Tile masks are ignored by dense arrays, and expressions with a tile
+      /// mask are not cached.
+      Expr<Derived>& set_tile_mask(const TiledArray::detail::Bitset<>& tile_mask) {
+        if (! override_ptr_)
+          override_ptr_ = std::make_shared<override_type>();
+        override_ptr_->tile_mask =
+            std::make_shared<const TiledArray::detail::Bitset<> >(tile_mask);
+        return derived();
+      }
       /// \param world the World object to use for the result
       Expr<Derived> &set_world(World& world) {
           if(override_ptr_ != nullptr){
@@ -135,9 +195,155 @@ namespace TiledArray {
         }
         return derived();
       }
+      /// \param pmap the Pmap object of the arrays the result will be used
+      /// with, e.g. the array it is added to later; the result is distributed
+      /// to minimize the elements moved to evaluate the expression plus the
+      /// elements of the result moved to \c pmap . This is a hint, and it is
+      /// ignored when the Pmap is set with \c set_pmap() .
+      Expr<Derived>& set_pmap_hint(
+          const std::shared_ptr<typename override_type::pmap_interface>
+              pmap) {
+        if (! override_ptr_)
+          override_ptr_ = std::make_shared<override_type>();
+        override_ptr_->pmap_hint = pmap;
+        return derived();
+      }
+      /// \param layers the number of process grid layers used to evaluate the
+      /// contraction of this expression with the layered (2.5D) SUMMA
+      /// algorithm; 1 selects the 2D SUMMA algorithm, and 0 (the default) lets
+      /// the process grid select the number of layers. Layers are only used
+      /// for contractions of dense arrays, and are ignored by other expressions.
+      Expr<Derived>& set_summa_layers(const unsigned int layers) {
+        if (override_ptr_) {
+          override_ptr_->layers = layers;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->layers = layers;
+        }
+        return derived();
+      }
+      /// \param mixed_precision if \c true , the contraction of this
+      /// expression accumulates single precision tiles in double precision, so
+      /// that arrays may be stored and broadcast in single precision without
+      /// losing the precision of the dot products within a tile. The result
+      /// tile is rounded to single precision after each pair of tiles is
+      /// contracted into it, so the sum over tiles is accumulated in single
+      /// precision. Mixed precision is only
+      /// used by contractions of \c Tensor tiles with \c float or
+      /// <tt>std::complex<float></tt> elements, and is ignored by other
+      /// expressions.
+      Expr<Derived>& set_mixed_precision(const bool mixed_precision = true) {
+        if (override_ptr_) {
+          override_ptr_->mixed_precision = mixed_precision;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->mixed_precision = mixed_precision;
+        }
+        return derived();
+      }
+
+      /// \param cache if \c true , the result of this expression is stored
+      /// in the expression cache when it is assigned to an array, and a later
+      /// assignment of an identical expression, i.e. one with the same
+      /// structure, annotations, scaling factors, and input arrays, reuses
+      /// the cached result instead of evaluating the expression again. Input
+      /// arrays are identified by their id, which changes whenever an array
+      /// is assigned, so the cache should be cleared with
+      /// \c TiledArray::clear_expression_cache() if the tiles of an input
+      /// array are modified in place. Expressions with a shape set by
+      /// \c set_shape(), and assignments to array blocks, are not cached.
+      Expr<Derived>& set_cache(const bool cache = true) {
+        if (override_ptr_) {
+          override_ptr_->cache = cache;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->cache = cache;
+        }
+        return derived();
+      }
+
+      /// \param epilogue An operation that is applied in place to each
+      /// result tile of the contraction of this expression, as soon as the
+      /// tile has been computed and while it is in cache, e.g. to divide by
+      /// energy denominators or to add another tile, which saves a separate
+      /// pass over the result. The epilogue takes a reference to the result
+      /// tile, whose range gives the element indices of the tile. It is only
+      /// applied to non-zero tiles, and the shape of the result is not
+      /// updated, so it should not change the norm of a tile by more than the
+      /// precision of the shape. Epilogues are only used by contractions, and
+      /// are ignored by other expressions; expressions with an epilogue are
+      /// not cached.
+      Expr<Derived>& set_epilogue(const std::function<void(
+          typename EngineTrait<engine_type>::value_type&)>& epilogue)
+      {
+        if (override_ptr_) {
+          override_ptr_->epilogue = epilogue;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->epilogue = epilogue;
+        }
+        return derived();
+      }
+
+      /// \param array The initial value of the result of the contraction of
+      /// this expression: the contraction is accumulated into copies of the
+      /// tiles of \c array , instead of zero tiles, so the result is not
+      /// added to \c array in a separate pass. It is used by the
+      /// non-aliasing plus-assignment operator, e.g.
+      /// <tt>c("i,j").no_alias() += a("i,k") * b("k,j")</tt> . \c array
+      /// must have the tiled range of the result, in the layout of the final
+      /// result; the result is the sum of \c array and the contraction. The
+      /// tiles of \c array are not modified, so objects that share them,
+      /// e.g. shallow copies of \c array , keep their values. The initial
+      /// value is only used by contractions. The
+      /// engine parameters of this expression are copied, since they may be
+      /// shared with other expressions.
+      template <typename A>
+      Expr<Derived>& set_seed(const A& array) {
+        typedef typename EngineTrait<engine_type>::value_type value_type;
+        static_assert(std::is_same<typename A::value_type, value_type>::value,
+            "The tile type of the initial value must be the result tile type.");
+        override_ptr_ = (override_ptr_ ?
+            std::make_shared<override_type>(*override_ptr_) :
+            std::make_shared<override_type>());
+        override_ptr_->seed =
+            [array] (const std::size_t index, Future<value_type>& tile) {
+              if(array.is_zero(index))
+                return false;
+              tile = array.find(index);
+              return true;
+            };
+        override_ptr_->seed_shape = & array.shape();
+        return derived();
+      }
+
+      /// Engine parameter query
+
+      /// \return \c true if any engine parameter of this expression was set,
+      /// e.g. with \c set_world() or \c set_cache()
+      bool has_overrides() const { return static_cast<bool>(override_ptr_); }
 
     private:
 
+      /// Expression cache key factory function
+
+      /// \tparam A The result array type
+      /// \param engine The initialized expression engine
+      /// \param world The world of the result
+      /// \param target_vars The target variable list
+      /// \return The key that identifies the result of this expression
+      template <typename A>
+      static std::string make_cache_key(const engine_type& engine,
+          const World& world, const VariableList& target_vars)
+      {
+        std::ostringstream ss;
+        ss.precision(std::numeric_limits<long double>::max_digits10);
+        ss << typeid(A).name() << " " << world.id() << " " << target_vars
+            << " = ";
+        engine.cache_key(ss);
+        return ss.str();
+      }
+
       /// Task function used to evaluate a lazy tile and apply an op
 
       /// \tparam R The result type
@@ -167,41 +373,39 @@ namespace TiledArray {
       }
 
 
-      /// Set an array tile with a lazy tile
+      /// Convert a lazy tile, or a tile of another type, to an array tile
 
-      /// Spawn a task to evaluate a lazy tile and set the \a array tile at
-      /// \c index with the result.
+      /// Spawn a task to evaluate a lazy tile, or to convert a tile of
+      /// another type, e.g. a \c Tensor<double> result of a mixed-precision
+      /// expression that is assigned to an array of \c Tensor<float> .
       /// \tparam A The array type
-      /// \tparam I The index type
       /// \tparam T The lazy tile type
       /// \param array The result array
-      /// \param index The tile index
       /// \param tile The lazy tile
-      template <typename A, typename I, typename T,
+      /// \return The future of the evaluated tile
+      template <typename A, typename T,
           typename std::enable_if<
-              ! std::is_same<typename A::value_type, T>::value &&
-              is_lazy_tile<T>::value
+              ! std::is_same<typename A::value_type, T>::value
           >::type* = nullptr>
-      void set_tile(A& array, const I& index, const Future<T>& tile) const {
-        array.set(index, array.world().taskq.add(
-            TiledArray::Cast<typename A::value_type, T>(), tile));
+      Future<typename A::value_type>
+      make_tile(A& array, const Future<T>& tile) const {
+        return array.world().taskq.add(
+            TiledArray::Cast<typename A::value_type, T>(), tile);
       }
 
 
-      /// Set the \c array tile at \c index with \c tile
+      /// Convert a tile to an array tile
 
       /// \tparam A The array type
-      /// \tparam I The index type
-      /// \tparam T The lazy tile type
-      /// \param array The result array
-      /// \param index The tile index
+      /// \tparam T The tile type
       /// \param tile The tile
-      template <typename A, typename I, typename T,
+      /// \return \c tile
+      template <typename A, typename T,
           typename std::enable_if<
               std::is_same<typename A::value_type, T>::value
           >::type* = nullptr>
-      void set_tile(A& array, const I& index, const Future<T>& tile) const {
-        array.set(index, tile);
+      const Future<T>& make_tile(A&, const Future<T>& tile) const {
+        return tile;
       }
 
 
@@ -285,9 +489,38 @@ namespace TiledArray {
       /// \param tsr The tensor to be assigned
       template <typename A, bool Alias>
       void eval_to(TsrExpr<A, Alias>& tsr) const {
+        eval_async(tsr).wait();
+      }
+
+      /// Evaluate this object asynchronously and assign it to \c tsr
+
+      /// The tasks of this expression are submitted, and \c tsr is assigned
+      /// an array whose tiles are the futures of the results, but this
+      /// function does not wait for the tasks; see \c ExprHandle .
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \param tsr The tensor to be assigned
+      /// \return The handle of the evaluation
+      template <typename A, bool Alias>
+      ExprHandle<A> eval_async(TsrExpr<A, Alias>& tsr) const {
         static_assert(! is_lazy_tile<typename A::value_type>::value,
             "Assignment to an array of lazy tiles is not supported.");
 
+        // A view is assigned in place, as the block of the viewed array
+        if(tsr.array().is_initialized() && tsr.array().is_view()) {
+          A parent = tsr.array().view_parent();
+          const BlockRange& block = tsr.array().view_block();
+          const std::vector<std::size_t> lower_bound(block.lobound_data(),
+              block.lobound_data() + block.rank());
+          const std::vector<std::size_t> upper_bound(block.upbound_data(),
+              block.upbound_data() + block.rank());
+          BlkTsrExpr<A, Alias> parent_block(parent, tsr.vars(), lower_bound,
+              upper_bound);
+          eval_to(parent_block);
+          tsr.array().update_view();
+          return ExprHandle<A>(tsr.array());
+        }
+
         // Get the target world
         // 1. result's world is assigned, use it
         // 2. if this expression's world was assigned by set_world(), use it
@@ -299,7 +532,8 @@ namespace TiledArray {
 
         // Get the output process map.
         // If result's pmap is assigned use it as the initial guess
-        // it will be assigned in engine.init
+        // it will be assigned in engine.init, unless the arguments are
+        // distributed differently and moving them costs more
         std::shared_ptr<typename TsrExpr<A, Alias>::array_type::pmap_interface> pmap;
         if(tsr.array().is_initialized())
           pmap = tsr.array().pmap();
@@ -309,36 +543,95 @@ namespace TiledArray {
 
         // Construct the expression engine
         engine_type engine(derived());
-        engine.init(world, pmap, target_vars);
+        engine.init(world, pmap, target_vars, true);
+
+        // Reuse the result of an identical expression, if it is cached
+        std::string cache_key;
+        if(override_ptr_ && override_ptr_->cache && ! override_ptr_->shape &&
+            ! override_ptr_->tile_mask && ! override_ptr_->epilogue &&
+            ! override_ptr_->seed && ! (override_ptr_->threshold > 0.0)) {
+          cache_key = make_cache_key<A>(engine, world, target_vars);
+          const std::shared_ptr<void> cached =
+              TiledArray::detail::expression_cache_find(cache_key);
+          if(cached) {
+            tsr.array() = *std::static_pointer_cast<A>(cached);
+            return ExprHandle<A>(tsr.array());
+          }
+        }
+
+        return eval_engine(engine, tsr.array(), target_vars, cache_key);
+      }
 
+    private:
+
+      template <typename>
+      friend class ExprPlan;
+
+      /// Evaluate an initialized engine and assign the result to \c array
+
+      /// \tparam A The array type
+      /// \param engine The initialized engine of this expression
+      /// \param array The array to be assigned
+      /// \param target_vars The target variable list of \c engine
+      /// \param cache_key The expression cache key of the result, or an empty
+      /// string if the result is not cached
+      /// \return The handle of the evaluation
+      template <typename A>
+      ExprHandle<A> eval_engine(const engine_type& engine, A& array,
+          const VariableList& target_vars, const std::string& cache_key) const
+      {
         // Create the distributed evaluator from this expression
         typename engine_type::dist_eval_type dist_eval = engine.make_dist_eval();
+        if(dist_eval.profile()) {
+          std::stringstream ss;
+          ss << target_vars;
+          ExprProfiler::instance().record(ss.str(), dist_eval.profile());
+        }
         dist_eval.eval();
 
         // Create the result array
         A result(dist_eval.world(), dist_eval.trange(),
             dist_eval.shape(), dist_eval.pmap());
 
-        // Move the data from dist_eval into the result array. There is no
-        // communication in this step.
+        // Move the data from dist_eval into the result array. The tiles are
+        // inserted together, and there is no communication in this step.
+        std::vector<typename A::size_type> indices;
+        std::vector<Future<typename A::value_type> > tiles;
+        indices.reserve(dist_eval.pmap()->local_size());
+        tiles.reserve(dist_eval.pmap()->local_size());
         for(const auto index : *dist_eval.pmap()) {
-          if(! dist_eval.is_zero(index))
-            set_tile(result, index, dist_eval.get(index));
+          if(! dist_eval.is_zero(index)) {
+            indices.push_back(index);
+            tiles.push_back(make_tile(result, dist_eval.get(index)));
+          }
         }
+        result.set_bulk(indices, tiles);
 
-        // Wait for child expressions of dist_eval
-        dist_eval.wait();
+        if(! cache_key.empty())
+          TiledArray::detail::expression_cache_insert(cache_key,
+              std::make_shared<A>(result));
 
         // Swap the new array with the result array object.
-        result.swap(tsr.array());
+        result.swap(array);
+
+        // The handle waits for child expressions of dist_eval
+        return ExprHandle<A>(array, dist_eval);
       }
 
+    public:
+
 
       /// Evaluate this object and assign it to \c tsr
 
       /// This expression is evaluated in parallel in distributed environments,
-      /// where the content of \c tsr will be replaced by the results of the
-      /// evaluated tensor expression.
+      /// where the content of the sub-block of \c tsr will be replaced by the
+      /// results of the evaluated tensor expression. The sub-block is assigned
+      /// in place: only the tiles of the sub-block are replaced, and the
+      /// array keeps its id. Tiles of the sub-block that were obtained from
+      /// the array before the assignment keep their previous value, while
+      /// shallow copies of the array see the assignment. The caches that
+      /// identify arrays by their id are cleared (see
+      /// \c DistArray::update_block() ).
       /// \tparam A The array type
       /// \tparam Alias Tile alias flag
       /// \param tsr The tensor to be assigned
@@ -381,51 +674,79 @@ namespace TiledArray {
 
         // Create the distributed evaluator from this expression
         typename engine_type::dist_eval_type dist_eval = engine.make_dist_eval();
+        if(dist_eval.profile()) {
+          std::stringstream ss;
+          ss << target_vars;
+          ExprProfiler::instance().record(ss.str(), dist_eval.profile());
+        }
         dist_eval.eval();
 
-        // Create the result array
-        A result(world, tsr.array().trange(),
-            tsr.array().shape().update_block(tsr.lower_bound(), tsr.upper_bound(),
-            dist_eval.shape()), tsr.array().pmap());
+        // Get the local result tiles before the target array is modified,
+        // since the expression may read tiles of the target array.
+        typedef typename engine_type::dist_eval_type::future future_type;
+        std::vector<std::pair<typename engine_type::size_type, future_type> > tiles;
+        for(const auto index : *dist_eval.pmap()) {
+          if(! dist_eval.is_zero(index))
+            tiles.emplace_back(index, dist_eval.get(index));
+        }
 
-        // NOTE: The tiles from the original array and the sub-block are copied
-        // in two separate steps because the two tensors have different data
-        // distribution.
+        // Wait for child expressions of dist_eval and for the input tiles of
+        // the local result tiles. After the barrier no process reads tiles of
+        // the target array.
+        dist_eval.wait();
+        for(const auto& tile : tiles)
+          tile.second.get();
+        world.gop.barrier();
 
-        // Copy tiles from the original array to the result array that are not
-        // included in the sub-block assignment. There is no communication in
-        // this step.
+        // Release the tiles of the sub-block and patch the shape of the target
+        // array in place. The tiles outside the sub-block are not touched.
         const BlockRange blk_range(tsr.array().trange().tiles_range(),
             tsr.lower_bound(), tsr.upper_bound());
-        for(const auto index : *tsr.array().pmap()) {
-          if(! tsr.array().is_zero(index)) {
-            if(! blk_range.includes(tsr.array().trange().tiles_range().idx(index)))
-              result.set(index, tsr.array().find(index));
-          }
-        }
+        tsr.array().update_block(blk_range,
+            tsr.array().shape().update_block(tsr.lower_bound(),
+            tsr.upper_bound(), dist_eval.shape()));
 
-        // Move the data from dist_eval into the sub-block of result array.
-        // This step may involve communication when the tiles are moved from the
-        // sub-block distribution to the array distribution.
-        {
-          const std::vector<long> shift =
-              tsr.array().trange().make_tile_range(tsr.lower_bound()).lobound();
+        // A tile may only be set after its owner released the previous tile.
+        world.gop.barrier();
 
-          std::shared_ptr<op_type> shift_op =
-              std::make_shared<op_type>(shift_op_type(shift));
+        // Move the data from dist_eval into the sub-block of the target array.
+        // This step may involve communication when the tiles are moved from
+        // the sub-block distribution to the array distribution.
+        const std::vector<long> shift =
+            tsr.array().trange().make_tile_range(tsr.lower_bound()).lobound();
 
-          for(const auto index : *dist_eval.pmap()) {
-            if(! dist_eval.is_zero(index))
-              set_tile(result, blk_range.ordinal(index), dist_eval.get(index),
-                  shift_op);
-          }
-        }
+        std::shared_ptr<op_type> shift_op =
+            std::make_shared<op_type>(shift_op_type(shift));
 
-        // Wait for child expressions of dist_eval
-        dist_eval.wait();
+        for(const auto& tile : tiles)
+          set_tile(tsr.array(), blk_range.ordinal(tile.first), tile.second,
+              shift_op);
+      }
 
-        // Swap the new array with the result array object.
-        result.swap(tsr.array());
+      /// Estimate the cost of this expression without evaluating it
+
+      /// The expression graph is initialized as for an assignment to an
+      /// array with the variable list \c target_vars , i.e. the variable
+      /// lists, tiled ranges, and shapes of all nodes, including the shapes
+      /// of contractions, and the process grids and maps are computed, but no
+      /// tile is evaluated and nothing is communicated. The estimate is equal
+      /// on all processes, e.g.
+      /// \code
+      /// auto estimate = (g("a,b,c,d") * t("c,d,i,j")).estimate("a,b,i,j");
+      /// if(estimate->peak_process_bytes() < budget)
+      ///   r("a,b,i,j") = g("a,b,c,d") * t("c,d,i,j");
+      /// \endcode
+      /// \param target_vars The target variable list of the result
+      /// \param world The world where the expression would be evaluated
+      /// \return The cost estimate tree of this expression
+      /// \sa ExprEstimate
+      std::shared_ptr<ExprEstimate> estimate(const std::string& target_vars,
+          World& world = TiledArray::get_default_world()) const
+      {
+        engine_type engine(derived());
+        engine.init(world, std::shared_ptr<typename engine_type::pmap_interface>(),
+            VariableList(target_vars));
+        return engine.make_estimate();
       }
 
       /// Expression print
@@ -460,6 +781,25 @@ namespace TiledArray {
         return default_world_helper<Derived>(this->derived()).get();
       }
 
+      /// Binary reduction operation factory function
+
+      /// \param op The reduction operation
+      /// \return \c op
+      template <typename Op>
+      static const Op& make_reduction_op(const Op& op, const Permutation&,
+          std::false_type)
+      { return op; }
+
+      /// Binary reduction operation factory function
+
+      /// \param perm The permutation of the right-hand tiles
+      /// \return A reduction operation that applies \c perm to the
+      /// right-hand tiles
+      template <typename Op>
+      static Op make_reduction_op(const Op&, const Permutation& perm,
+          std::true_type)
+      { return Op(perm); }
+
     public:
 
       template <typename Op>
@@ -528,8 +868,17 @@ namespace TiledArray {
             left_engine.make_dist_eval();
         left_dist_eval.eval();
 
-        // Evaluate the right-hand expression
+        // Evaluate the right-hand expression. If the reduction can permute
+        // the right-hand tiles, the tiles of array arguments are reduced in
+        // their own layout instead of a permuted copy, so no tiles are
+        // constructed for the reduction.
+        typedef std::integral_constant<bool,
+            TiledArray::detail::is_permuting_reduction<Op>::value &&
+            std::is_base_of<LeafEngine<typename D::engine_type>,
+                typename D::engine_type>::value> permute_in_reduction;
         typename D::engine_type right_engine(right_expr.derived());
+        if(permute_in_reduction::value)
+          right_engine.permute_tiles(false);
         right_engine.init(world, left_engine.pmap(), left_engine.vars());
 
         // Create the distributed evaluator for the right-hand expression
@@ -551,7 +900,8 @@ namespace TiledArray {
 #endif // NDEBUG
 
         // Create a local reduction task
-        reduction_op_type wrapped_op(op);
+        reduction_op_type wrapped_op(make_reduction_op(op, right_engine.perm(),
+            permute_in_reduction()));
         TiledArray::detail::ReducePairTask<reduction_op_type>
             local_reduce_task(world, wrapped_op);
 
@@ -612,6 +962,26 @@ namespace TiledArray {
         return sum(default_world());
       }
 
+      /// Sum this expression over some of its variables
+
+      /// The result is an expression of the other variables, e.g.
+      /// \code
+      /// v("i") = A("i,j").sum_over("j");
+      /// \endcode
+      /// The tiles of the argument are summed locally, and each process
+      /// sends one partial sum of each result tile to its owner (see
+      /// \c SumOverEngine ).
+      /// \tparam D The derived expression type
+      /// \param vars The summed variables
+      /// \return The partial sum expression
+      template <typename D = Derived>
+      SumOverExpr<D> sum_over(const std::string& vars) const {
+        static_assert(TiledArray::expressions::is_aliased<D>::value,
+            "no_alias() expressions are not allowed on the right-hand side of "
+            "the assignment operator.");
+        return SumOverExpr<D>(derived(), VariableList(vars));
+      }
+
       Future<typename TiledArray::ProductReduction<
           typename EngineTrait<engine_type>::eval_type>::result_type>
       product(World& world) const {
@@ -736,6 +1106,107 @@ namespace TiledArray {
         return abs_max(default_world());
       }
 
+      /// Compute several reductions of this expression
+
+      /// The expression is evaluated once, and the results of all reductions
+      /// are combined with a single collective operation, e.g.
+      /// \code
+      /// auto r = a("i,j").reduce_all(world,
+      ///     TiledArray::MinReduction<value_type>(),
+      ///     TiledArray::MaxReduction<value_type>()).get();
+      /// std::get<0>(r); // the minimum
+      /// std::get<1>(r); // the maximum
+      /// \endcode
+      /// \tparam Op The first reduction operation type
+      /// \tparam Ops The other reduction operation types
+      /// \param world The world where the reductions are computed
+      /// \param op The first reduction operation
+      /// \param ops The other reduction operations
+      /// \return A future to the tuple of the reduction results
+      template <typename Op, typename... Ops>
+      Future<TiledArray::detail::ReductionTuple<typename Op::result_type,
+          typename Ops::result_type...> >
+      reduce_all(World& world, const Op& op, const Ops&... ops) const {
+        return reduce(TiledArray::make_tuple_reduction(op, ops...), world);
+      }
+
+      template <typename Op, typename... Ops>
+      Future<TiledArray::detail::ReductionTuple<typename Op::result_type,
+          typename Ops::result_type...> >
+      reduce_all(const Op& op, const Ops&... ops) const {
+        return reduce_all(default_world(), op, ops...);
+      }
+
+      /// Evaluate this expression and pass each result tile to a callback
+
+      /// \c op is called with the ordinal and the value of each non-zero
+      /// result tile of this process, in a task that runs as soon as the tile
+      /// is evaluated, e.g. when the last contribution of a contraction is
+      /// reduced into it, and the tile is released when \c op returns. The
+      /// result array is never stored as a whole, e.g. when its tiles are
+      /// written to disk or only contribute to a reduction with side effects:
+      /// \code
+      /// std::mutex lock;
+      /// double energy = 0.0;
+      /// (t("i,j,a,b") * g("a,b,k,l")).eval_to_callback(world,
+      ///     [&] (const std::size_t index, const TensorD& tile) {
+      ///       const double e = tile.sum();
+      ///       std::lock_guard<std::mutex> guard(lock);
+      ///       energy += e;
+      ///     });
+      /// \endcode
+      /// As for \c reduce() , the tiles are in the order of the variables of
+      /// the expression, and their ordinals are in its tiles range. \c op may
+      /// be called concurrently by several threads. This function is
+      /// collective, and returns when \c op has been called for all local
+      /// tiles.
+      /// \tparam Op The callback type, with the signature
+      /// <tt>void(std::size_t, const eval_type&)</tt>
+      /// \param world The world where the expression is evaluated
+      /// \param op The callback
+      template <typename Op>
+      void eval_to_callback(World& world, const Op& op) const {
+        typedef typename engine_type::value_type value_type;
+        typedef typename EngineTrait<engine_type>::eval_type eval_type;
+
+        // Construct the expression engine
+        engine_type engine(derived());
+        engine.init(world, std::shared_ptr<typename engine_type::pmap_interface>(),
+            VariableList());
+
+        // Create the distributed evaluator from this expression
+        typename engine_type::dist_eval_type dist_eval = engine.make_dist_eval();
+        dist_eval.eval();
+
+        // Pass each local tile to op when it is evaluated. The tiles are
+        // moved out of dist_eval, so each is held only by its task.
+        std::vector<Future<bool> > done;
+        done.reserve(dist_eval.pmap()->local_size());
+        typename engine_type::dist_eval_type::pmap_interface::const_iterator it =
+            dist_eval.pmap()->begin();
+        const typename engine_type::dist_eval_type::pmap_interface::const_iterator end =
+            dist_eval.pmap()->end();
+        for(; it != end; ++it) {
+          if(dist_eval.is_zero(*it))
+            continue;
+          const std::size_t index = *it;
+          done.push_back(world.taskq.add([&op, index] (const value_type& tile) {
+              const eval_type eval_tile(tile);
+              op(index, eval_tile);
+              return true;
+            }, dist_eval.get(index)));
+        }
+
+        dist_eval.wait();
+        for(Future<bool>& f : done)
+          f.get();
+      }
+
+      template <typename Op>
+      void eval_to_callback(const Op& op) const {
+        eval_to_callback(default_world(), op);
+      }
+
       template <typename D>
       Future<typename TiledArray::DotReduction<
           typename EngineTrait<engine_type>::eval_type,
@@ -0,0 +1,340 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_batch.h
+ *  Mar 28, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_BATCH_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_BATCH_H__INCLUDED
+
+#include <TiledArray/expressions/tsr_expr.h>
+#include <TiledArray/expressions/expr_handle.h>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The number of batched expressions that are evaluated at the same time
+
+    /// The window is read from the \c TA_EXPR_BATCH_WINDOW environment
+    /// variable. When it is zero, all expressions of a batch are submitted
+    /// before any of them is waited for.
+    /// \return The number of expressions in flight [default = 4]
+    inline std::size_t expr_batch_window() {
+      static const std::size_t window = [] () -> std::size_t {
+        const char* window = getenv("TA_EXPR_BATCH_WINDOW");
+        if(window)
+          return std::strtoul(window, nullptr, 10);
+        return 4ul;
+      }();
+      return window;
+    }
+
+  }  // namespace detail
+
+  namespace expressions {
+
+    /// Collect the arrays that are read by an expression
+
+    /// \param expr The expression
+    /// \param[out] reads The addresses of the array objects read by \c expr
+    template <typename A, bool Alias>
+    inline void expr_reads(const TsrExpr<A, Alias>& expr, std::vector<const void*>& reads) {
+      reads.push_back(& expr.array());
+    }
+
+    template <typename A, typename Scalar>
+    inline void expr_reads(const ScalTsrExpr<A, Scalar>& expr, std::vector<const void*>& reads) {
+      reads.push_back(& expr.array());
+    }
+
+    template <typename D>
+    inline void expr_reads(const BlkTsrExprBase<D>& expr, std::vector<const void*>& reads) {
+      reads.push_back(& expr.array());
+    }
+
+    template <typename D>
+    inline void expr_reads(const UnaryExpr<D>& expr, std::vector<const void*>& reads) {
+      expr_reads(expr.arg(), reads);
+    }
+
+    template <typename D>
+    inline void expr_reads(const BinaryExpr<D>& expr, std::vector<const void*>& reads) {
+      expr_reads(expr.left(), reads);
+      expr_reads(expr.right(), reads);
+    }
+
+    /// A batch of array assignments that are scheduled together
+
+    /// The assignments of a batch, e.g. the terms of a residual equation
+    /// and the intermediates they share, are recorded by \c assign() and
+    /// \c accumulate() , and evaluated by \c run() . The arrays are
+    /// identified by their address, and an assignment depends on the
+    /// earlier assignments that write an array it reads or writes, or that
+    /// read an array it writes. \c run() submits the assignments in an order
+    /// that respects these dependencies with \c Expr::eval_async() , so the
+    /// tasks and communication of independent assignments overlap, while at
+    /// most \c window assignments are in flight. Among the assignments that
+    /// are ready, the one that releases the most temporaries (see
+    /// \c temporary() ) is submitted first, which keeps the number of live
+    /// intermediates low, e.g.
+    /// \code
+    /// TiledArray::expressions::ExprBatch batch;
+    /// batch.temporary(t)
+    ///      .assign(t("i,j"), a("i,k") * b("k,j"))
+    ///      .assign(r1("i,j"), t("i,k") * c("k,j"))
+    ///      .accumulate(r2("i,j"), 2 * t("i,j"))
+    ///      .run();
+    /// \endcode
+    /// The batch must be constructed and run in the same order on all
+    /// processes, and the arrays must outlive \c run() .
+    class ExprBatch {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+
+      /// A recorded assignment
+      struct Term {
+        const void* write; ///< The array written by this term
+        std::vector<const void*> reads; ///< The arrays read by this term
+        std::function<std::function<void()>()> submit; ///< Submits this term and returns its wait function
+      }; // struct Term
+
+      /// A temporary array
+      struct Temporary {
+        const void* array; ///< The address of the array
+        std::function<void()> release; ///< Releases the array
+      }; // struct Temporary
+
+      std::vector<Term> terms_; ///< The recorded assignments
+      std::vector<Temporary> temporaries_; ///< The temporary arrays
+      size_type window_; ///< The number of terms in flight
+
+      /// Check that a term references an array
+
+      /// \param term The term
+      /// \param array The address of the array
+      /// \return \c true when \c term reads or writes \c array
+      static bool references(const Term& term, const void* array) {
+        return (term.write == array) || (std::find(term.reads.begin(),
+            term.reads.end(), array) != term.reads.end());
+      }
+
+      /// Check that two terms must be evaluated in order
+
+      /// \param first The earlier term
+      /// \param second The later term
+      /// \return \c true when one term writes an array that the other term
+      /// reads or writes
+      static bool conflicts(const Term& first, const Term& second) {
+        return references(second, first.write) || references(first, second.write);
+      }
+
+      /// Add a term
+
+      /// \param term The term
+      /// \return A reference to this object
+      ExprBatch& add_term(Term term) {
+        // Remove repeated reads
+        std::sort(term.reads.begin(), term.reads.end());
+        term.reads.erase(std::unique(term.reads.begin(), term.reads.end()),
+            term.reads.end());
+        terms_.push_back(std::move(term));
+        return *this;
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param window The number of assignments that are evaluated at the
+      /// same time, or zero for no limit [default = the value of the
+      /// \c TA_EXPR_BATCH_WINDOW environment variable, or 4]
+      explicit ExprBatch(const size_type window = detail::expr_batch_window()) :
+        terms_(), temporaries_(), window_(window)
+      { }
+
+      ExprBatch(const ExprBatch&) = delete;
+      ExprBatch& operator=(const ExprBatch&) = delete;
+
+      /// Record an assignment
+
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \tparam D The expression type
+      /// \param result The array expression to be assigned
+      /// \param expr The expression that will be assigned to \c result
+      /// \return A reference to this object
+      template <typename A, bool Alias, typename D>
+      ExprBatch& assign(TsrExpr<A, Alias> result, const Expr<D>& expr) {
+        static_assert(TiledArray::expressions::is_aliased<D>::value,
+            "no_alias() expressions are not allowed on the right-hand side of "
+            "the assignment operator.");
+        Term term;
+        term.write = & result.array();
+        expr_reads(expr.derived(), term.reads);
+        const D arg(expr.derived());
+        term.submit = [result,arg] () mutable -> std::function<void()> {
+          std::shared_ptr<ExprHandle<A> > handle =
+              std::make_shared<ExprHandle<A> >(result.assign_async(arg));
+          return [handle] () { handle->wait(); };
+        };
+        return add_term(std::move(term));
+      }
+
+      /// Record an accumulation
+
+      /// \c expr is added to \c result , which must be initialized when the
+      /// accumulation is evaluated.
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \tparam D The expression type
+      /// \param result The array expression to be updated
+      /// \param expr The expression that will be added to \c result
+      /// \return A reference to this object
+      template <typename A, bool Alias, typename D>
+      ExprBatch& accumulate(TsrExpr<A, Alias> result, const Expr<D>& expr) {
+        return assign(result, AddExpr<TsrExpr<A, Alias>, D>(result, expr.derived()));
+      }
+
+      /// Mark an array as a temporary of the batch
+
+      /// The array is released, i.e. reset to an uninitialized array, as
+      /// soon as all the assignments that reference it have been submitted,
+      /// so its tiles are freed when those assignments finish.
+      /// \tparam A The array type
+      /// \param array The temporary array
+      /// \return A reference to this object
+      template <typename A>
+      ExprBatch& temporary(A& array) {
+        temporaries_.push_back(Temporary{& array, [&array] () { array = A(); }});
+        return *this;
+      }
+
+      /// \return The number of recorded assignments
+      size_type size() const { return terms_.size(); }
+
+      /// Compute the order in which the assignments are submitted
+
+      /// \return The indices of the recorded assignments, in the order of
+      /// submission
+      std::vector<size_type> schedule() const {
+        const size_type n = terms_.size();
+
+        // Count the predecessors of each term
+        std::vector<std::vector<size_type> > successors(n);
+        std::vector<size_type> predecessors(n, 0ul);
+        for(size_type j = 0ul; j < n; ++j)
+          for(size_type i = 0ul; i < j; ++i)
+            if(conflicts(terms_[i], terms_[j])) {
+              successors[i].push_back(j);
+              ++predecessors[j];
+            }
+
+        // Count the references of each temporary
+        std::vector<size_type> remaining(temporaries_.size(), 0ul);
+        for(size_type t = 0ul; t < temporaries_.size(); ++t)
+          for(const Term& term : terms_)
+            if(references(term, temporaries_[t].array))
+              ++remaining[t];
+
+        std::vector<size_type> order;
+        order.reserve(n);
+        std::vector<char> done(n, 0);
+        while(order.size() < n) {
+          // Pick the ready term that releases the most temporaries and
+          // creates the fewest; ties are broken by the order of the terms.
+          size_type best = n;
+          long best_score = 0l;
+          for(size_type j = 0ul; j < n; ++j) {
+            if(done[j] || predecessors[j])
+              continue;
+            long score = 0l;
+            for(size_type t = 0ul; t < temporaries_.size(); ++t) {
+              if(! references(terms_[j], temporaries_[t].array))
+                continue;
+              if(remaining[t] == 1ul)
+                ++score;
+              else if(terms_[j].write == temporaries_[t].array)
+                --score;
+            }
+            if((best == n) || (score > best_score)) {
+              best = j;
+              best_score = score;
+            }
+          }
+          TA_ASSERT(best < n);
+
+          done[best] = 1;
+          order.push_back(best);
+          for(const size_type j : successors[best])
+            --predecessors[j];
+          for(size_type t = 0ul; t < temporaries_.size(); ++t)
+            if(references(terms_[best], temporaries_[t].array))
+              --remaining[t];
+        }
+
+        return order;
+      }
+
+      /// Evaluate the recorded assignments
+
+      /// The assignments are submitted in the order given by \c schedule() ,
+      /// and this function returns when all of them have been evaluated.
+      /// The recorded assignments are cleared. This function is collective.
+      void run() {
+        const std::vector<size_type> order = schedule();
+
+        std::vector<size_type> remaining(temporaries_.size(), 0ul);
+        for(size_type t = 0ul; t < temporaries_.size(); ++t)
+          for(const Term& term : terms_)
+            if(references(term, temporaries_[t].array))
+              ++remaining[t];
+
+        std::deque<std::function<void()> > in_flight;
+        for(const size_type j : order) {
+          if(window_ && (in_flight.size() >= window_)) {
+            in_flight.front()();
+            in_flight.pop_front();
+          }
+          in_flight.push_back(terms_[j].submit());
+
+          for(size_type t = 0ul; t < temporaries_.size(); ++t)
+            if(references(terms_[j], temporaries_[t].array) && (--remaining[t] == 0ul))
+              temporaries_[t].release();
+        }
+        for(auto& wait : in_flight)
+          wait();
+
+        terms_.clear();
+        temporaries_.clear();
+      }
+
+    }; // class ExprBatch
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_BATCH_H__INCLUDED
@@ -0,0 +1,142 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_cache.cpp
+ *  Feb 20, 2017
+ *
+ */
+
+#include <TiledArray/expressions/expr_cache.h>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace TiledArray {
+  namespace {
+
+    /// Cached expression results, in least recently used order
+    class ExprCache {
+      typedef std::pair<std::string, std::shared_ptr<void> > entry_type;
+
+      std::mutex lock_; ///< Protects the cache
+      std::list<entry_type> entries_; ///< The results, most recently used first
+      std::unordered_map<std::string, std::list<entry_type>::iterator> index_;
+          ///< The position of each result in \c entries_
+      std::size_t capacity_; ///< The largest number of results
+
+      /// Remove the least recently used results that exceed the capacity
+
+      /// \param[out] removed The removed results, which are released after
+      /// the lock, since releasing an array may spawn tasks
+      void trim(std::list<entry_type>& removed) {
+        while(entries_.size() > capacity_) {
+          index_.erase(entries_.back().first);
+          removed.splice(removed.begin(), entries_, std::prev(entries_.end()));
+        }
+      }
+
+    public:
+
+      ExprCache() : lock_(), entries_(), index_(),
+        capacity_([] () -> std::size_t {
+          const char* capacity = getenv("TA_EXPR_CACHE_CAPACITY");
+          return (capacity ? std::strtoul(capacity, nullptr, 10) : 32ul);
+        }())
+      { }
+
+      std::size_t capacity() {
+        std::lock_guard<std::mutex> locker(lock_);
+        return capacity_;
+      }
+
+      void capacity(const std::size_t capacity) {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        capacity_ = capacity;
+        trim(removed);
+      }
+
+      std::size_t size() {
+        std::lock_guard<std::mutex> locker(lock_);
+        return entries_.size();
+      }
+
+      void clear() {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        index_.clear();
+        removed.swap(entries_);
+      }
+
+      std::shared_ptr<void> find(const std::string& key) {
+        std::lock_guard<std::mutex> locker(lock_);
+        auto it = index_.find(key);
+        if(it == index_.end())
+          return std::shared_ptr<void>();
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->second;
+      }
+
+      void insert(const std::string& key, const std::shared_ptr<void>& result) {
+        std::list<entry_type> removed;
+        std::lock_guard<std::mutex> locker(lock_);
+        auto it = index_.find(key);
+        if(it != index_.end()) {
+          it->second->second = result;
+          entries_.splice(entries_.begin(), entries_, it->second);
+        } else {
+          entries_.emplace_front(key, result);
+          index_[key] = entries_.begin();
+        }
+        trim(removed);
+      }
+
+    }; // class ExprCache
+
+    ExprCache& expr_cache() {
+      static ExprCache cache;
+      return cache;
+    }
+
+  }  // namespace
+
+  std::size_t expression_cache_capacity() { return expr_cache().capacity(); }
+
+  void expression_cache_capacity(const std::size_t capacity) {
+    expr_cache().capacity(capacity);
+  }
+
+  std::size_t expression_cache_size() { return expr_cache().size(); }
+
+  void clear_expression_cache() { expr_cache().clear(); }
+
+  namespace detail {
+
+    std::shared_ptr<void> expression_cache_find(const std::string& key) {
+      return expr_cache().find(key);
+    }
+
+    void expression_cache_insert(const std::string& key,
+        const std::shared_ptr<void>& result)
+    {
+      expr_cache().insert(key, result);
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
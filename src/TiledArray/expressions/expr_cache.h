@@ -0,0 +1,80 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_cache.h
+ *  Feb 20, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_CACHE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_CACHE_H__INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace TiledArray {
+
+  /// Expression cache capacity accessor
+
+  /// The capacity is initialized with the \c TA_EXPR_CACHE_CAPACITY
+  /// environment variable; the default capacity is 32.
+  /// \return The largest number of results held by the expression cache
+  std::size_t expression_cache_capacity();
+
+  /// Set the expression cache capacity
+
+  /// The least recently used results are removed when the cache holds more
+  /// than \c capacity results. This must be called on all processes with the
+  /// same value.
+  /// \param capacity The largest number of results held by the expression
+  /// cache; zero disables caching
+  void expression_cache_capacity(const std::size_t capacity);
+
+  /// Number of cached expression results
+
+  /// \return The number of results held by the expression cache
+  std::size_t expression_cache_size();
+
+  /// Remove all results from the expression cache
+
+  /// The cache holds shallow copies of the result arrays, so it should be
+  /// cleared when the input arrays are modified in place, and before the
+  /// worlds of the results are destroyed. This must be called on all
+  /// processes; \c TiledArray::finalize() clears the cache.
+  void clear_expression_cache();
+
+  namespace detail {
+
+    /// Find a cached expression result
+
+    /// \param key The expression cache key
+    /// \return A pointer to the cached result array, or null if there is no
+    /// result for \c key
+    std::shared_ptr<void> expression_cache_find(const std::string& key);
+
+    /// Add an expression result to the cache
+
+    /// \param key The expression cache key
+    /// \param result A pointer to a copy of the result array
+    void expression_cache_insert(const std::string& key,
+        const std::shared_ptr<void>& result);
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_CACHE_H__INCLUDED
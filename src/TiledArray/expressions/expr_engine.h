@@ -27,7 +27,11 @@
 #define TILEDARRAY_EXPRESSIONS_EXPR_ENGINE_H__INCLUDED
 
 #include <TiledArray/madness.h>
+#include <TiledArray/type_traits.h>
 #include <TiledArray/expressions/expr_trace.h>
+#include <TiledArray/expressions/expr_estimate.h>
+#include <TiledArray/expressions/expr_profile.h>
+#include <typeinfo>
 
 namespace TiledArray {
   namespace expressions {
@@ -89,8 +93,11 @@ namespace TiledArray {
       /// \param world The world where the expression will be evaluated
       /// \param pmap The process map for the result tensor (may be NULL)
       /// \param target_vars The target variable list of the result tensor
+      /// \param pmap_is_guess If \c true , \c pmap is only a preference, and
+      /// it may be replaced by a distribution that moves fewer elements; see
+      /// \c select_pmap()
       void init(World& world, std::shared_ptr<pmap_interface> pmap,
-          const VariableList& target_vars)
+          const VariableList& target_vars, const bool pmap_is_guess = false)
       {
         if(target_vars.dim()) {
           derived().init_vars(target_vars);
@@ -114,6 +121,12 @@ namespace TiledArray {
             pmap_.reset();
         }
 
+        // Select the result distribution that moves the fewest elements,
+        // unless it is set for this expression or required by the caller
+        const bool has_pmap_hint = override_ptr_ && override_ptr_->pmap_hint;
+        if(! override_pmap && (pmap_is_guess || (! pmap_ && has_pmap_hint)))
+          pmap_ = select_pmap(pmap_);
+
         derived().init_distribution(world_, pmap_);
       }
 
@@ -139,6 +152,10 @@ namespace TiledArray {
 
         if(override_ptr_ && override_ptr_->shape)
           shape_ = shape_.mask(*override_ptr_->shape);
+        if(override_ptr_ && override_ptr_->tile_mask)
+          shape_ = shape_.mask(*override_ptr_->tile_mask);
+        if(override_ptr_ && (override_ptr_->threshold > 0.0))
+          shape_ = shape_.with_threshold(override_ptr_->threshold);
       }
 
       /// Initialize result tensor distribution
@@ -160,6 +177,97 @@ namespace TiledArray {
         pmap_ = pmap;
       }
 
+      /// Native process map accessor
+
+      /// The native process map is the distribution under which this
+      /// expression is evaluated with the least communication of argument
+      /// tiles, e.g. the process map of an array argument or the process grid
+      /// of a contraction. It is only valid after \c init_struct() , and
+      /// derived classes that store or co-locate data should provide their own
+      /// implementation.
+      /// \param world The world where the expression is evaluated
+      /// \return The native process map, or NULL if this expression does not
+      /// prefer a distribution
+      std::shared_ptr<pmap_interface> native_pmap(World&) const { return nullptr; }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param world The world where the expression is evaluated
+      /// \param pmap The process map of the result tensor
+      /// \return The number of elements, in non-zero argument tiles, that are
+      /// moved to evaluate this expression with the result distributed by
+      /// \c pmap
+      std::size_t redistribution_cost(World&, const pmap_interface&) const { return 0ul; }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// This is used to choose which argument of a contraction is permuted.
+      /// It is valid after \c init_vars() . Expressions that compute new
+      /// result tiles permute them when they are computed, so the
+      /// permutation does not add a pass over the data.
+      /// \return The number of elements, in non-zero tiles, that are copied
+      /// to permute the result of this expression, which is zero
+      std::size_t permute_cost() const { return 0ul; }
+
+      /// Count the elements of the result that move between distributions
+
+      /// \param from The process map where the result tiles are
+      /// \param to The process map where the result tiles are needed
+      /// \return The number of elements in the non-zero result tiles that are
+      /// owned by different processes in \c from and \c to
+      std::size_t move_cost(const pmap_interface& from, const pmap_interface& to) const {
+        if((&from == &to) || (to.procs() == 1ul))
+          return 0ul;
+
+        std::size_t cost = 0ul;
+        const size_type volume = trange_.tiles_range().volume();
+        for(size_type i = 0ul; i < volume; ++i)
+          if((! shape_.is_zero(i)) && (from.owner(i) != to.owner(i)))
+            cost += trange_.make_tile_range(i).volume();
+        return cost;
+      }
+
+      /// Select the distribution of the result
+
+      /// The candidates are \c pmap , the native process map of this
+      /// expression, and the process map set with \c Expr::set_pmap_hint() .
+      /// The cost of a candidate is the number of elements of the arguments
+      /// that are moved to evaluate the expression plus the number of
+      /// elements of the result that are moved to the hinted distribution,
+      /// where it will be used. The first candidate with the least cost is
+      /// selected, so the guess is kept when no other candidate is cheaper.
+      /// \param pmap The initial guess for the result process map (may be
+      /// NULL)
+      /// \return The selected process map (may be NULL)
+      std::shared_ptr<pmap_interface>
+      select_pmap(const std::shared_ptr<pmap_interface>& pmap) const {
+        std::shared_ptr<pmap_interface> hint;
+        if(override_ptr_ && override_ptr_->pmap_hint &&
+            (typename pmap_interface::size_type(world_->size()) ==
+            override_ptr_->pmap_hint->procs()) &&
+            (trange_.tiles_range().volume() == override_ptr_->pmap_hint->size()))
+          hint = override_ptr_->pmap_hint;
+
+        const std::shared_ptr<pmap_interface> candidates[3] =
+            { pmap, derived().native_pmap(*world_), hint };
+
+        std::shared_ptr<pmap_interface> result;
+        std::size_t result_cost = 0ul;
+        for(const auto& candidate : candidates) {
+          if(! candidate || (candidate == result))
+            continue;
+          const std::size_t cost =
+              derived().redistribution_cost(*world_, *candidate) +
+              (hint ? move_cost(*candidate, *hint) : 0ul);
+          if(! result || (cost < result_cost)) {
+            result = candidate;
+            result_cost = cost;
+          }
+        }
+
+        return result;
+      }
+
       /// Permutation factory function
 
       /// This function will generate the permutation that will be applied to
@@ -241,6 +349,70 @@ namespace TiledArray {
       /// \return An expression tag used to identify this expression
       const char* make_tag() const { return ""; }
 
+      /// Construct the profile of this expression
+
+      /// \return The cost counters of this expression, labelled with its tag
+      /// and variable list, or \c nullptr if expressions are not profiled
+      std::shared_ptr<ExprProfile> make_profile() const {
+        if(! ExprProfiler::instance().enabled())
+          return nullptr;
+        std::stringstream ss;
+        ss << derived().make_tag() << vars_;
+        return std::make_shared<ExprProfile>(ss.str());
+      }
+
+      /// Construct the cost estimate of this expression
+
+      /// The estimate holds the non-zero tiles of the result and the bytes
+      /// of the result on all processes and on the process that holds the
+      /// most result data. It is only valid after \c init() . Derived
+      /// classes add their children, flops, and communication.
+      /// \param allocates \c false if the result tiles are not allocated by
+      /// this expression, e.g. the tiles of an array argument
+      /// \return The cost estimate of this expression, labelled with its tag
+      /// and variable list
+      std::shared_ptr<ExprEstimate> make_estimate(const bool allocates = true) const {
+        TA_ASSERT(world_);
+        TA_ASSERT(pmap_);
+        std::stringstream ss;
+        ss << derived().make_tag() << vars_;
+        std::shared_ptr<ExprEstimate> estimate = std::make_shared<ExprEstimate>(ss.str());
+
+        const unsigned long long element_bytes =
+            sizeof(TiledArray::detail::numeric_t<value_type>);
+        std::vector<unsigned long long> process_bytes(world_->size(), 0ull);
+        unsigned long long tiles = 0ull, bytes = 0ull;
+        const size_type volume = trange_.tiles_range().volume();
+        for(size_type i = 0ul; i < volume; ++i) {
+          if(shape_.is_zero(i))
+            continue;
+          ++tiles;
+          if(allocates) {
+            const unsigned long long tile_bytes =
+                trange_.make_tile_range(i).volume() * element_bytes;
+            bytes += tile_bytes;
+            process_bytes[pmap_->owner(i)] += tile_bytes;
+          }
+        }
+        estimate->result(tiles, bytes,
+            *std::max_element(process_bytes.begin(), process_bytes.end()));
+
+        return estimate;
+      }
+
+      /// Expression cache key
+
+      /// Write a key that identifies the structure of this expression graph
+      /// and its arguments, so that expressions with equal keys evaluate to
+      /// the same result. Derived classes append their arguments and
+      /// parameters to the key.
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        os << typeid(Derived).name() << " " << vars_;
+        if(override_ptr_ && override_ptr_->mixed_precision)
+          os << " [mixed precision]";
+      }
+
     }; // class ExprEngine
 
   }  // namespace expressions
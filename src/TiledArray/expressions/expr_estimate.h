@@ -0,0 +1,196 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_estimate.h
+ *  Jun 1, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_ESTIMATE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_ESTIMATE_H__INCLUDED
+
+#include <TiledArray/expressions/expr_trace.h>
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// Estimated cost of one node of an expression
+
+    /// An estimate is computed by \c Expr::estimate() from the tiled ranges,
+    /// shapes, and process maps of the expression, without evaluating tiles.
+    /// The flops of a node are the flops of its tile contractions, counted
+    /// like \c ExprProfile for the non-zero tile pairs of non-zero result
+    /// tiles. The communication of a node is the bytes of the argument tiles
+    /// that are moved to the distribution of the node plus, for
+    /// contractions, the bytes of the tiles broadcast by SUMMA, with each
+    /// tile sent to all other processes of its process grid row or column.
+    /// The memory of a node is the bytes of its non-zero result tiles;
+    /// leaves only allocate memory when they permute their tiles. Since the
+    /// nodes are evaluated concurrently, the peak memory is bounded by the
+    /// sum of the memory of all nodes; it is smaller when argument tiles are
+    /// consumed early. All counters are totals over all processes, except
+    /// the process memory, which is the memory of the process that holds the
+    /// most result data.
+    class ExprEstimate {
+      std::string label_; ///< The expression node label
+      unsigned long long tiles_; ///< Non-zero result tiles
+      unsigned long long bytes_; ///< Bytes of the allocated result tiles
+      unsigned long long process_bytes_; ///< The largest \c bytes_ of one process
+      unsigned long long flops_; ///< Floating point operations
+      unsigned long long comm_bytes_; ///< Bytes sent to other processes
+      std::vector<std::shared_ptr<ExprEstimate> > children_; ///< Child nodes
+
+    public:
+
+      /// Constructor
+
+      /// \param label The expression node label
+      explicit ExprEstimate(const std::string& label) :
+        label_(label), tiles_(0ull), bytes_(0ull), process_bytes_(0ull),
+        flops_(0ull), comm_bytes_(0ull), children_()
+      { }
+
+      ExprEstimate(const ExprEstimate&) = delete;
+      ExprEstimate& operator=(const ExprEstimate&) = delete;
+
+      /// \return The expression node label
+      const std::string& label() const { return label_; }
+
+      /// \param child A child node
+      void add_child(const std::shared_ptr<ExprEstimate>& child) {
+        if(child)
+          children_.push_back(child);
+      }
+
+      /// \return The child nodes
+      const std::vector<std::shared_ptr<ExprEstimate> >& children() const {
+        return children_;
+      }
+
+      /// Set the result of this node
+
+      /// \param tiles The number of non-zero result tiles
+      /// \param bytes The bytes of the result tiles that are allocated
+      /// \param process_bytes The largest number of bytes of the allocated
+      /// result tiles of one process
+      void result(const unsigned long long tiles,
+          const unsigned long long bytes,
+          const unsigned long long process_bytes)
+      {
+        tiles_ = tiles;
+        bytes_ = bytes;
+        process_bytes_ = process_bytes;
+      }
+
+      /// \param flops The floating point operations to be added
+      void add_flops(const unsigned long long flops) { flops_ += flops; }
+
+      /// \param bytes The communicated bytes to be added
+      void add_comm_bytes(const unsigned long long bytes) { comm_bytes_ += bytes; }
+
+      /// \return The non-zero result tiles
+      unsigned long long tiles() const { return tiles_; }
+
+      /// \return The bytes of the allocated result tiles
+      unsigned long long bytes() const { return bytes_; }
+
+      /// \return The bytes of the allocated result tiles of the process that
+      /// holds the most result data
+      unsigned long long process_bytes() const { return process_bytes_; }
+
+      /// \return The floating point operations of this node
+      unsigned long long flops() const { return flops_; }
+
+      /// \return The bytes that this node sends to other processes
+      unsigned long long comm_bytes() const { return comm_bytes_; }
+
+      /// \return The floating point operations of this node and its children
+      unsigned long long total_flops() const {
+        unsigned long long result = flops_;
+        for(const std::shared_ptr<ExprEstimate>& child : children_)
+          result += child->total_flops();
+        return result;
+      }
+
+      /// \return The bytes sent by this node and its children
+      unsigned long long total_comm_bytes() const {
+        unsigned long long result = comm_bytes_;
+        for(const std::shared_ptr<ExprEstimate>& child : children_)
+          result += child->total_comm_bytes();
+        return result;
+      }
+
+      /// \return The upper bound of the memory allocated by this node and its
+      /// children
+      unsigned long long peak_bytes() const {
+        unsigned long long result = bytes_;
+        for(const std::shared_ptr<ExprEstimate>& child : children_)
+          result += child->peak_bytes();
+        return result;
+      }
+
+      /// \return The upper bound of the memory allocated by this node and its
+      /// children on one process
+      unsigned long long peak_process_bytes() const {
+        unsigned long long result = process_bytes_;
+        for(const std::shared_ptr<ExprEstimate>& child : children_)
+          result += child->peak_process_bytes();
+        return result;
+      }
+
+      /// Print this node and its children
+
+      /// \param os The output stream
+      void print(ExprOStream os) const {
+        std::stringstream ss;
+        ss << std::setprecision(4) << label_ << "  tiles=" << tiles_;
+        if(flops_)
+          ss << " flops=" << double(flops_);
+        if(comm_bytes_)
+          ss << " comm=" << double(comm_bytes_);
+        if(bytes_)
+          ss << " bytes=" << double(bytes_) << " process_bytes="
+             << double(process_bytes_);
+        os << ss.str() << "\n";
+        os.inc();
+        for(const std::shared_ptr<ExprEstimate>& child : children_)
+          child->print(os);
+        os.dec();
+      }
+
+      /// Print the totals of this node and its children
+
+      /// \param os The output stream
+      void print_totals(std::ostream& os) const {
+        os << std::setprecision(4) << "flops=" << double(total_flops())
+           << " comm=" << double(total_comm_bytes())
+           << " peak_bytes=" << double(peak_bytes())
+           << " peak_process_bytes=" << double(peak_process_bytes()) << "\n";
+      }
+
+    }; // class ExprEstimate
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_ESTIMATE_H__INCLUDED
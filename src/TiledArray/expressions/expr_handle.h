@@ -0,0 +1,144 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_handle.h
+ *  Mar 27, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_HANDLE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_HANDLE_H__INCLUDED
+
+#include <functional>
+#include <memory>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// Handle of an expression that is evaluated asynchronously
+
+    /// The handle is returned by \c Expr::eval_async() and
+    /// \c TsrExpr::assign_async() before the tasks of the expression have
+    /// been run. The result array is assigned immediately, and its tiles are
+    /// futures that are set by those tasks, so later expressions that read
+    /// the result depend on its tiles, and the tasks of independent
+    /// expressions interleave in the task queue, e.g.
+    /// \code
+    /// auto h1 = r1("i,j").assign_async(a("i,k") * b("k,j"));
+    /// auto h2 = r2("i,j").assign_async(c("i,k") * d("k,j"));
+    /// e("i,j") = r1("i,j") + r2("i,j"); // depends on the tiles of r1 and r2
+    /// h1.wait();
+    /// h2.wait();
+    /// \endcode
+    /// The handle owns the distributed evaluator of the expression, which
+    /// must live until all its local tiles have been evaluated, so the
+    /// destructor waits for them.
+    /// \tparam A The array type of the result
+    template <typename A>
+    class ExprHandle {
+    public:
+      typedef A array_type; ///< The result array type
+
+    private:
+      array_type array_; ///< The result array
+      std::function<bool()> done_; ///< Checks that the evaluation is done
+      std::function<void()> wait_; ///< Waits for the evaluation
+
+    public:
+
+      /// Constructs a handle of a finished evaluation
+
+      /// \param array The result array
+      explicit ExprHandle(const array_type& array) :
+        array_(array), done_(), wait_()
+      { }
+
+      /// Constructs a handle of an evaluation
+
+      /// \tparam DistEval The distributed evaluator type
+      /// \param array The result array
+      /// \param dist_eval The distributed evaluator of the expression
+      template <typename DistEval>
+      ExprHandle(const array_type& array, const DistEval& dist_eval) :
+        array_(array),
+        done_([dist_eval] () { return dist_eval.done(); }),
+        wait_([dist_eval] () { dist_eval.wait(); })
+      { }
+
+      ExprHandle(const ExprHandle&) = delete;
+      ExprHandle& operator=(const ExprHandle&) = delete;
+
+      ExprHandle(ExprHandle&& other) :
+        array_(std::move(other.array_)), done_(std::move(other.done_)),
+        wait_(std::move(other.wait_))
+      {
+        other.done_ = nullptr;
+        other.wait_ = nullptr;
+      }
+
+      ExprHandle& operator=(ExprHandle&& other) {
+        if(this != &other) {
+          wait();
+          array_ = std::move(other.array_);
+          done_ = std::move(other.done_);
+          wait_ = std::move(other.wait_);
+          other.done_ = nullptr;
+          other.wait_ = nullptr;
+        }
+        return *this;
+      }
+
+      /// Waits for the evaluation
+      ~ExprHandle() { wait(); }
+
+      /// Result array accessor
+
+      /// The tiles of the array may not have been evaluated yet.
+      /// \return A const reference to the result array
+      const array_type& array() const { return array_; }
+
+      /// Check that the evaluation is done
+
+      /// \return \c true when all local tiles of the result have been
+      /// evaluated, otherwise \c false
+      bool ready() const { return (! done_) || done_(); }
+
+      /// Wait for the local tiles of the result
+
+      /// Other tasks are run while waiting. This function is not collective.
+      void wait() {
+        if(wait_) {
+          wait_();
+          done_ = nullptr;
+          wait_ = nullptr;
+        }
+      }
+
+      /// Wait for the local tiles of the result
+
+      /// \return A const reference to the result array
+      const array_type& get() {
+        wait();
+        return array_;
+      }
+
+    }; // class ExprHandle
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_HANDLE_H__INCLUDED
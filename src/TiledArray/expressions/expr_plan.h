@@ -0,0 +1,163 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_plan.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_PLAN_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_PLAN_H__INCLUDED
+
+#include <TiledArray/expressions/expr.h>
+#include <memory>
+#include <string>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// A reusable evaluation plan of an expression
+
+    /// Iterative solvers evaluate the same expression many times with arrays
+    /// that have the same tiled ranges, e.g. the amplitude equations of
+    /// coupled cluster. A plan initializes the engine of the expression once,
+    /// i.e. the variable lists and permutations of all nodes, the process
+    /// grids, and the process maps, and reuses it for every evaluation. The
+    /// expression of a plan refers to the array objects of its leaves, so
+    /// the arrays that are assigned to these objects between two evaluations
+    /// are evaluated, e.g.
+    /// \code
+    /// auto plan = make_plan(g("a,b,c,d") * t("c,d,i,j"), "a,b,i,j");
+    /// for(int iter = 0; iter < maxiter; ++iter) {
+    ///   plan.execute(r);
+    ///   t = update(t, r);
+    /// }
+    /// \endcode
+    /// Contractions replay the SUMMA schedule that was recorded by the
+    /// previous evaluations, i.e. the screened tiles, the non-zero iterations,
+    /// and the broadcast groups, see \c SummaSchedule . The shapes of the
+    /// engine are recomputed, and the schedules are recorded again, when the
+    /// shape of an array changed, and the engine is rebuilt when the tiled
+    /// range of an array changed. The expression cache is not used by plans.
+    /// \tparam Derived The expression type
+    template <typename Derived>
+    class ExprPlan {
+    public:
+      typedef typename Expr<Derived>::engine_type engine_type; ///< Engine type
+
+    private:
+      Derived expr_; ///< The expression
+      VariableList target_vars_; ///< The target variable list
+      World* world_; ///< The world where the expression is evaluated
+      std::unique_ptr<engine_type> engine_; ///< The engine of the expression
+      std::size_t builds_; ///< Engine initializations
+      std::size_t shape_updates_; ///< Shape updates of the engine
+      std::size_t reuses_; ///< Evaluations that reused the engine
+
+    public:
+
+      /// Constructor
+
+      /// The engine is initialized by the first evaluation.
+      /// \param expr The expression
+      /// \param target_vars The variable list of the result
+      /// \param world The world where the expression is evaluated
+      ExprPlan(const Expr<Derived>& expr, const std::string& target_vars,
+          World& world = TiledArray::get_default_world()) :
+        expr_(expr.derived()), target_vars_(target_vars), world_(&world),
+        engine_(), builds_(0ul), shape_updates_(0ul), reuses_(0ul)
+      { }
+
+      ExprPlan(const ExprPlan&) = delete;
+      ExprPlan& operator=(const ExprPlan&) = delete;
+      ExprPlan(ExprPlan&&) = default;
+      ExprPlan& operator=(ExprPlan&&) = default;
+
+      /// Evaluate the expression asynchronously and assign it to \c result
+
+      /// \tparam A The array type
+      /// \param result The array to be assigned
+      /// \return The handle of the evaluation
+      /// \sa Expr::eval_async
+      template <typename A>
+      ExprHandle<A> execute_async(A& result) {
+        static_assert(! is_lazy_tile<typename A::value_type>::value,
+            "Assignment to an array of lazy tiles is not supported.");
+        TA_USER_ASSERT(! (result.is_initialized() && result.is_view()),
+            "Planned expressions cannot be assigned to array views.");
+
+        bool same_shape = true;
+        if(engine_ && engine_->rebind(expr_, same_shape)) {
+          if(same_shape) {
+            ++reuses_;
+          } else {
+            engine_->init_struct(target_vars_);
+            ++shape_updates_;
+          }
+        } else {
+          // Construct the engine with the same process map guess as Expr
+          std::shared_ptr<typename A::pmap_interface> pmap;
+          if(result.is_initialized())
+            pmap = result.pmap();
+          engine_.reset(new engine_type(expr_));
+          engine_->init(*world_, pmap, target_vars_, true);
+          ++builds_;
+        }
+
+        const Expr<Derived>& expr = expr_;
+        return expr.eval_engine(*engine_, result, target_vars_, std::string());
+      }
+
+      /// Evaluate the expression and assign it to \c result
+
+      /// \tparam A The array type
+      /// \param result The array to be assigned
+      template <typename A>
+      void execute(A& result) { execute_async(result).wait(); }
+
+      /// \return The target variable list
+      const VariableList& target_vars() const { return target_vars_; }
+
+      /// \return The number of times the engine was initialized
+      std::size_t builds() const { return builds_; }
+
+      /// \return The number of times the shapes of the engine were updated
+      std::size_t shape_updates() const { return shape_updates_; }
+
+      /// \return The number of evaluations that reused the engine unchanged
+      std::size_t reuses() const { return reuses_; }
+
+    }; // class ExprPlan
+
+    /// Construct a reusable evaluation plan of an expression
+
+    /// \tparam D The expression type
+    /// \param expr The expression
+    /// \param target_vars The variable list of the result
+    /// \param world The world where the expression is evaluated
+    /// \return The plan of \c expr
+    template <typename D>
+    inline ExprPlan<D> make_plan(const Expr<D>& expr, const std::string& target_vars,
+        World& world = TiledArray::get_default_world())
+    {
+      return ExprPlan<D>(expr, target_vars, world);
+    }
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_PLAN_H__INCLUDED
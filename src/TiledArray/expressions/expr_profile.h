@@ -0,0 +1,250 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_profile.h
+ *  Mar 13, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_PROFILE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_PROFILE_H__INCLUDED
+
+#include <TiledArray/expressions/expr_trace.h>
+#include <TiledArray/madness.h>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// Cost counters of one node of an evaluated expression
+
+    /// The counters are local to this process until \c reduce() is called.
+    /// The time of a node is the wall time from the start of its evaluation
+    /// to the assignment of its last local tile, so the time of a node
+    /// includes the time of its children.
+    class ExprProfile {
+      std::string label_; ///< The expression node label
+      double start_; ///< Wall time at the start of the evaluation
+      std::atomic<double> end_; ///< Wall time when the last local tile was set
+      std::atomic<unsigned long long> flops_; ///< Floating point operations
+      std::atomic<unsigned long long> bytes_; ///< Bytes sent to other processes
+      std::atomic<unsigned long long> tiles_; ///< Tiles produced
+      std::atomic<unsigned long long> in_place_; ///< Tiles produced in place
+      std::vector<std::shared_ptr<ExprProfile> > children_; ///< Child nodes
+
+    public:
+
+      /// Constructor
+
+      /// \param label The expression node label
+      explicit ExprProfile(const std::string& label) :
+        label_(label), start_(0.0), end_(0.0), flops_(0ull), bytes_(0ull),
+        tiles_(0ull), in_place_(0ull), children_()
+      { }
+
+      ExprProfile(const ExprProfile&) = delete;
+      ExprProfile& operator=(const ExprProfile&) = delete;
+
+      /// \return The expression node label
+      const std::string& label() const { return label_; }
+
+      /// \param child A child node
+      void add_child(const std::shared_ptr<ExprProfile>& child) {
+        if(child)
+          children_.push_back(child);
+      }
+
+      /// \return The child nodes
+      const std::vector<std::shared_ptr<ExprProfile> >& children() const {
+        return children_;
+      }
+
+      /// Record the start of the evaluation
+      void start() { start_ = madness::wall_time(); }
+
+      /// Record the assignment of the last local tile
+      void finish() { end_ = madness::wall_time(); }
+
+      /// \param flops The floating point operations to be added
+      void add_flops(const unsigned long long flops) { flops_ += flops; }
+
+      /// \param bytes The communicated bytes to be added
+      void add_bytes(const unsigned long long bytes) { bytes_ += bytes; }
+
+      /// Count a produced tile
+      void add_tile() { ++tiles_; }
+
+      /// Count a tile that was produced in the data of an argument tile
+      void add_in_place() { ++in_place_; }
+
+      /// \return The evaluation time, in s
+      double time() const { return std::max(end_.load() - start_, 0.0); }
+
+      /// \return The floating point operations
+      unsigned long long flops() const { return flops_; }
+
+      /// \return The communicated bytes
+      unsigned long long bytes() const { return bytes_; }
+
+      /// \return The produced tiles
+      unsigned long long tiles() const { return tiles_; }
+
+      /// \return The tiles that were produced in the data of an argument
+      /// tile, i.e. the result allocations that were avoided
+      unsigned long long in_place() const { return in_place_; }
+
+      /// Sum the counters over all processes
+
+      /// The counters of each node are replaced by their sums over all
+      /// processes, and the time by its maximum. This function is collective
+      /// and must be called with the same expression on all processes.
+      /// \param world The world where the expression was evaluated
+      void reduce(World& world) {
+        unsigned long long counters[4] = { flops_, bytes_, tiles_, in_place_ };
+        world.gop.sum(counters, 4);
+        flops_ = counters[0];
+        bytes_ = counters[1];
+        tiles_ = counters[2];
+        in_place_ = counters[3];
+        double time = this->time();
+        world.gop.max(time);
+        start_ = 0.0;
+        end_ = time;
+        for(const std::shared_ptr<ExprProfile>& child : children_)
+          child->reduce(world);
+      }
+
+      /// Print this node and its children
+
+      /// \param os The output stream
+      void print(ExprOStream os) const {
+        std::stringstream ss;
+        ss << std::setprecision(4) << label_ << "  time=" << time() << " s"
+           << " tiles=" << tiles();
+        if(flops())
+          ss << " flops=" << double(flops()) << " GFLOPS="
+             << (time() > 0.0 ? double(flops()) / time() * 1.0e-9 : 0.0);
+        if(bytes())
+          ss << " bytes=" << double(bytes());
+        if(in_place())
+          ss << " in_place=" << in_place();
+        os << ss.str() << "\n";
+        os.inc();
+        for(const std::shared_ptr<ExprProfile>& child : children_)
+          child->print(os);
+        os.dec();
+      }
+
+    }; // class ExprProfile
+
+    /// Expression profiling switch and result
+
+    /// Profiling is disabled by default. It is enabled when the
+    /// \c TA_EXPR_PROFILE environment variable is set to a non-zero value, or
+    /// by calling \c enable(). When it is enabled, each node of an expression
+    /// records its evaluation time, the flops of its tile contractions, the
+    /// bytes that it broadcasts, the tiles that it produces and how many of
+    /// them reuse the data of a consumed argument tile, and the
+    /// profile of the last assignment can be printed as an annotated
+    /// expression tree, e.g.
+    /// \code
+    /// TiledArray::expressions::ExprProfiler::instance().enable();
+    /// r("a,b,i,j") = g("a,b,c,d") * t("c,d,i,j") + f("a,c") * t("c,b,i,j");
+    /// world.gop.fence();
+    /// TiledArray::expressions::ExprProfiler::instance().print(std::cout, world);
+    /// \endcode
+    class ExprProfiler {
+      volatile bool enabled_; ///< Profiling flag
+      std::shared_ptr<ExprProfile> last_; ///< The profile of the last assignment
+      std::string target_; ///< The target of the last assignment
+
+      ExprProfiler() : enabled_(init_enabled()), last_(), target_() { }
+
+      static bool init_enabled() {
+        const char* profile = getenv("TA_EXPR_PROFILE");
+        return profile && (std::atoi(profile) != 0);
+      }
+
+    public:
+
+      ExprProfiler(const ExprProfiler&) = delete;
+      ExprProfiler& operator=(const ExprProfiler&) = delete;
+
+      /// Profiler object accessor
+
+      /// \return A reference to the profiler object of this process
+      static ExprProfiler& instance() {
+        static ExprProfiler profiler;
+        return profiler;
+      }
+
+      /// Profiling flag accessor
+
+      /// \return \c true if expressions are profiled
+      bool enabled() const { return enabled_; }
+
+      /// Enable or disable profiling
+
+      /// \note Only expressions evaluated after this call are affected.
+      /// \param flag The new profiling flag
+      void enable(const bool flag = true) { enabled_ = flag; }
+
+      /// Record the profile of an assignment
+
+      /// \param target The target variable list of the assignment
+      /// \param profile The profile of the assigned expression
+      void record(const std::string& target,
+          const std::shared_ptr<ExprProfile>& profile)
+      {
+        target_ = target;
+        last_ = profile;
+      }
+
+      /// \return The profile of the last assignment, or \c nullptr
+      const std::shared_ptr<ExprProfile>& last() const { return last_; }
+
+      /// Print the profile of the last assignment
+
+      /// The counters are summed over all processes and the tree is printed
+      /// by process 0, so the profile can be printed once. This function is
+      /// collective, and the last assignment must be complete, e.g. after a
+      /// fence.
+      /// \param os The output stream
+      /// \param world The world where the expression was evaluated
+      void print(std::ostream& os, World& world) const {
+        if(! last_)
+          return;
+        last_->reduce(world);
+        if(world.rank() == 0) {
+          os << target_ << " =\n";
+          ExprOStream expr_stream(os);
+          expr_stream.inc();
+          last_->print(expr_stream);
+        }
+      }
+
+    }; // class ExprProfiler
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_PROFILE_H__INCLUDED
@@ -0,0 +1,485 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  index_list.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_INDEX_LIST_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_INDEX_LIST_H__INCLUDED
+
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/tensor/tensor.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// Compile-time index
+
+    /// An index is identified by its name, e.g. \c Index<'i'> or
+    /// \c Index<'a','1'> . Predefined single letter indices are in
+    /// \c TiledArray::indices .
+    /// \tparam Cs The characters of the index name
+    template <char... Cs>
+    struct Index {
+      static_assert(sizeof...(Cs) > 0ul, "An index name may not be empty.");
+
+      /// \return The index name
+      static std::string name() { return std::string{ Cs... }; }
+    }; // struct Index
+
+    template <typename...> struct IndexList;
+
+    namespace detail {
+
+      /// Check for an \c Index type
+      template <typename>
+      struct is_index : public std::false_type { };
+
+      template <char... Cs>
+      struct is_index<Index<Cs...> > : public std::true_type { };
+
+      /// Check that all types are \c Index types
+      template <typename... Is>
+      struct are_indices : public std::true_type { };
+
+      template <typename I, typename... Is>
+      struct are_indices<I, Is...> : public std::integral_constant<bool,
+          is_index<I>::value && are_indices<Is...>::value>
+      { };
+
+      /// Position of an index in a list of indices
+
+      /// \tparam I The index
+      /// \tparam Is The list of indices
+      /// \c value is the position of \c I in \c Is , or the size of \c Is if
+      /// \c I is not in \c Is
+      template <typename I, typename... Is>
+      struct index_position : public std::integral_constant<unsigned int, 0u> { };
+
+      template <typename I, typename J, typename... Is>
+      struct index_position<I, J, Is...> : public std::integral_constant<unsigned int,
+          (std::is_same<I, J>::value ? 0u : 1u + index_position<I, Is...>::value)>
+      { };
+
+      /// Check that a list of indices has no duplicates
+      template <typename... Is>
+      struct unique_indices : public std::true_type { };
+
+      template <typename I, typename... Is>
+      struct unique_indices<I, Is...> : public std::integral_constant<bool,
+          (index_position<I, Is...>::value == sizeof...(Is)) &&
+          unique_indices<Is...>::value>
+      { };
+
+      /// Check that an index list contains a list of indices
+      template <typename, typename... Js>
+      struct contains_indices : public std::true_type { };
+
+      template <typename... Is, typename J, typename... Js>
+      struct contains_indices<IndexList<Is...>, J, Js...> :
+          public std::integral_constant<bool,
+              (index_position<J, Is...>::value < sizeof...(Is)) &&
+              contains_indices<IndexList<Is...>, Js...>::value>
+      { };
+
+      /// A fixed size array of index positions that is usable in constant
+      /// expressions
+      template <unsigned int N>
+      struct IndexArray {
+        unsigned int data[N ? N : 1u]; ///< The positions
+
+        constexpr unsigned int operator[](const unsigned int i) const {
+          return data[i];
+        }
+
+        /// \return \c true if each position is equal to its index
+        constexpr bool is_identity() const {
+          for(unsigned int i = 0u; i < N; ++i)
+            if(data[i] != i)
+              return false;
+          return true;
+        }
+
+        /// \return The positions as a permutation, or an empty permutation
+        /// when they are the identity
+        Permutation permutation() const {
+          if(is_identity())
+            return Permutation();
+          return Permutation(std::vector<unsigned int>(data, data + N));
+        }
+      }; // struct IndexArray
+
+    }  // namespace detail
+
+    /// Compile-time index list
+
+    /// An index list annotates an array in an expression like a variable
+    /// list string, e.g. <tt>a(IndexList<Index<'i'>, Index<'j'> >())</tt> or,
+    /// with the predefined indices, <tt>a(i, j)</tt> is equivalent to
+    /// <tt>a("i,j")</tt>. The indices are checked for duplicates at compile
+    /// time. An array annotated with an index list is evaluated exactly like
+    /// one annotated with the equivalent string, i.e. the expression engines
+    /// still parse the variable list of each expression. The compile-time
+    /// permutations between index lists, and the layout of contractions (see
+    /// \c IndexContraction ), are for tile-level operations with a fixed
+    /// annotation.
+    /// \tparam Is The indices
+    template <typename... Is>
+    struct IndexList {
+      static_assert(detail::are_indices<Is...>::value,
+          "The elements of an IndexList must be Index types.");
+      static_assert(detail::unique_indices<Is...>::value,
+          "The indices of an IndexList must be unique.");
+
+      constexpr IndexList() { }
+
+      /// \param indices The indices, which are only used for their types
+      constexpr IndexList(const Is&...) { }
+
+      /// \return The number of indices
+      static constexpr unsigned int size() { return sizeof...(Is); }
+
+      /// Position of an index
+
+      /// \tparam I The index
+      /// \return The position of \c I in this list, or \c size() if \c I is
+      /// not in this list
+      template <typename I>
+      static constexpr unsigned int position() {
+        return detail::index_position<I, Is...>::value;
+      }
+
+      /// Variable string accessor
+
+      /// \return A comma-separated list of the index names, e.g. "i,j"
+      static const std::string& string() {
+        static const std::string result = [] () {
+          std::string result;
+          for(const std::string& name :
+              std::initializer_list<std::string>{ Is::name()... })
+            result += (result.empty() ? "" : ",") + name;
+          return result;
+        }();
+        return result;
+      }
+
+      /// Variable list accessor
+
+      /// \return The variable list of this index list, which is constructed
+      /// once
+      static const VariableList& variable_list() {
+        static const VariableList result(string());
+        return result;
+      }
+
+      /// Positions of the indices of another list in this list
+
+      /// The result is equal to <tt>variable_list().permutation(other)</tt>,
+      /// i.e. the permutation that maps a tensor annotated with \c other to
+      /// one annotated with this list, and is computed at compile time.
+      /// \tparam Js The indices of the other list, which must be a
+      /// permutation of this list
+      /// \return The positions of the indices \c Js in this list
+      template <typename... Js>
+      static constexpr detail::IndexArray<sizeof...(Js)>
+      positions(const IndexList<Js...>&) {
+        static_assert(sizeof...(Js) == sizeof...(Is),
+            "The index lists must have the same number of indices.");
+        static_assert(detail::contains_indices<IndexList<Is...>, Js...>::value,
+            "The index lists must have the same indices.");
+        return detail::IndexArray<sizeof...(Js)>{
+            { detail::index_position<Js, Is...>::value... } };
+      }
+
+      /// Permutation from another index list
+
+      /// \tparam Js The indices of the other list, which must be a
+      /// permutation of this list
+      /// \param other The other index list
+      /// \return The permutation that maps a tensor annotated with \c other
+      /// to one annotated with this list, or an empty permutation when the
+      /// lists are equal
+      template <typename... Js>
+      static Permutation permutation(const IndexList<Js...>& other) {
+        return positions(other).permutation();
+      }
+
+    }; // struct IndexList
+
+    /// Make an index list
+
+    /// \tparam Is The indices
+    /// \return An index list of \c Is
+    template <typename... Is>
+    constexpr IndexList<Is...> make_index_list(const Is&...) {
+      return IndexList<Is...>();
+    }
+
+    template <typename, typename, typename>
+    struct IndexContraction;
+
+    /// Compile-time layout of a contraction
+
+    /// The contraction <tt>result(C...) = left(L...) * right(R...)</tt> is
+    /// evaluated as a matrix multiplication of the left-hand argument,
+    /// permuted to <tt>[outer..., inner...]</tt>, with the right-hand
+    /// argument, permuted to <tt>[inner..., outer...]</tt>, where the
+    /// contracted inner indices are in the order of the left-hand argument.
+    /// The result of the multiplication, <tt>[left outer..., right
+    /// outer...]</tt>, is permuted to \c C . This class computes the ranks
+    /// and the permutations at compile time, so that tile contractions with a
+    /// fixed annotation, e.g. in tile operations of small-tile workloads, do
+    /// not derive them from variable lists for each tile.
+    /// \tparam Ls The indices of the left-hand argument
+    /// \tparam Rs The indices of the right-hand argument
+    /// \tparam Cs The indices of the result
+    template <typename... Ls, typename... Rs, typename... Cs>
+    struct IndexContraction<IndexList<Ls...>, IndexList<Rs...>, IndexList<Cs...> > {
+    private:
+      static constexpr unsigned int nl = sizeof...(Ls);
+      static constexpr unsigned int nr = sizeof...(Rs);
+      static constexpr unsigned int nc = sizeof...(Cs);
+
+      /// \return The positions of the left-hand indices in the right-hand list
+      static constexpr detail::IndexArray<nl> left_in_right() {
+        return detail::IndexArray<nl>{ { detail::index_position<Ls, Rs...>::value... } };
+      }
+
+      /// \return The positions of the right-hand indices in the left-hand list
+      static constexpr detail::IndexArray<nr> right_in_left() {
+        return detail::IndexArray<nr>{ { detail::index_position<Rs, Ls...>::value... } };
+      }
+
+      /// \return The positions of the left-hand indices in the result
+      static constexpr detail::IndexArray<nl> left_in_result() {
+        return detail::IndexArray<nl>{ { detail::index_position<Ls, Cs...>::value... } };
+      }
+
+      /// \return The positions of the right-hand indices in the result
+      static constexpr detail::IndexArray<nr> right_in_result() {
+        return detail::IndexArray<nr>{ { detail::index_position<Rs, Cs...>::value... } };
+      }
+
+      /// \return The number of contracted indices
+      static constexpr unsigned int count_contracted() {
+        unsigned int n = 0u;
+        for(unsigned int i = 0u; i < nl; ++i)
+          n += (left_in_right()[i] < nr ? 1u : 0u);
+        return n;
+      }
+
+      /// \return \c true if each outer index is in the result
+      static constexpr bool outer_in_result() {
+        for(unsigned int i = 0u; i < nl; ++i)
+          if((left_in_right()[i] == nr) && (left_in_result()[i] == nc))
+            return false;
+        for(unsigned int i = 0u; i < nr; ++i)
+          if((right_in_left()[i] == nl) && (right_in_result()[i] == nc))
+            return false;
+        return true;
+      }
+
+      /// \return The positions of the left-hand indices in the GEMM order
+      static constexpr detail::IndexArray<nl> left_positions() {
+        detail::IndexArray<nl> result{ { } };
+        unsigned int outer = 0u, inner = nl - count_contracted();
+        for(unsigned int i = 0u; i < nl; ++i)
+          result.data[i] = (left_in_right()[i] < nr ? inner++ : outer++);
+        return result;
+      }
+
+      /// \return The positions of the right-hand indices in the GEMM order
+      static constexpr detail::IndexArray<nr> right_positions() {
+        detail::IndexArray<nr> result{ { } };
+        unsigned int outer = count_contracted();
+        for(unsigned int i = 0u; i < nr; ++i) {
+          if(right_in_left()[i] < nl) {
+            // The rank of the index among the inner indices of the left-hand
+            // argument
+            unsigned int inner = 0u;
+            for(unsigned int j = 0u; j < right_in_left()[i]; ++j)
+              inner += (left_in_right()[j] < nr ? 1u : 0u);
+            result.data[i] = inner;
+          } else {
+            result.data[i] = outer++;
+          }
+        }
+        return result;
+      }
+
+      /// \return The positions of the GEMM result indices in the result
+      static constexpr detail::IndexArray<nc> result_positions() {
+        detail::IndexArray<nc> result{ { } };
+        unsigned int g = 0u;
+        for(unsigned int i = 0u; i < nl; ++i)
+          if(left_in_right()[i] == nr)
+            result.data[g++] = left_in_result()[i];
+        for(unsigned int i = 0u; i < nr; ++i)
+          if(right_in_left()[i] == nl)
+            result.data[g++] = right_in_result()[i];
+        return result;
+      }
+
+      /// \return \c true if the result indices are the outer indices of the
+      /// arguments
+      static constexpr bool valid() {
+        return (nl + nr == nc + 2u * count_contracted()) && outer_in_result();
+      }
+
+    public:
+
+      constexpr IndexContraction() {
+        static_assert(valid(),
+            "The result indices of a contraction must be the outer indices of its arguments.");
+      }
+
+      /// \return The rank of the left-hand argument
+      static constexpr unsigned int left_rank() { return nl; }
+
+      /// \return The rank of the right-hand argument
+      static constexpr unsigned int right_rank() { return nr; }
+
+      /// \return The rank of the result
+      static constexpr unsigned int result_rank() { return nc; }
+
+      /// \return The number of contracted indices
+      static constexpr unsigned int contracted_rank() { return count_contracted(); }
+
+      /// \return \c true if the left-hand argument is permuted
+      static constexpr bool permute_left() { return ! left_positions().is_identity(); }
+
+      /// \return \c true if the right-hand argument is permuted
+      static constexpr bool permute_right() { return ! right_positions().is_identity(); }
+
+      /// \return \c true if the result of the multiplication is permuted
+      static constexpr bool permute_result() { return ! result_positions().is_identity(); }
+
+      /// \return The permutation of the left-hand argument to the GEMM order,
+      /// or an empty permutation when it is not permuted
+      static const Permutation& left_permutation() {
+        static const Permutation result = left_positions().permutation();
+        return result;
+      }
+
+      /// \return The permutation of the right-hand argument to the GEMM
+      /// order, or an empty permutation when it is not permuted
+      static const Permutation& right_permutation() {
+        static const Permutation result = right_positions().permutation();
+        return result;
+      }
+
+      /// \return The permutation of the result of the multiplication to the
+      /// result indices, or an empty permutation when it is not permuted
+      static const Permutation& result_permutation() {
+        static const Permutation result = result_positions().permutation();
+        return result;
+      }
+
+      /// \return The GEMM helper of the permuted arguments
+      static math::GemmHelper gemm_helper() {
+        static_assert(valid(),
+            "The result indices of a contraction must be the outer indices of its arguments.");
+        return math::GemmHelper(madness::cblas::NoTrans,
+            madness::cblas::NoTrans, nc, nl, nr);
+      }
+
+      /// Contract two tiles
+
+      /// The permutations that are not needed are removed at compile time.
+      /// \tparam T The left-hand tensor element type
+      /// \tparam A The left-hand tensor allocator type
+      /// \tparam U The right-hand tensor element type
+      /// \tparam AU The right-hand tensor allocator type
+      /// \tparam W The type of the scaling factor
+      /// \param left The left-hand tile, annotated with \c Ls
+      /// \param right The right-hand tile, annotated with \c Rs
+      /// \param factor The scaling factor
+      /// \return <tt>factor * left(Ls...) * right(Rs...)</tt> , annotated
+      /// with \c Cs
+      template <typename T, typename A, typename U, typename AU, typename W>
+      static Tensor<T, A> contract(const Tensor<T, A>& left,
+          const Tensor<U, AU>& right, const W factor)
+      {
+        const Tensor<T, A> gemm_left =
+            (permute_left() ? left.permute(left_permutation()) : left);
+        const Tensor<U, AU> gemm_right =
+            (permute_right() ? right.permute(right_permutation()) : right);
+        Tensor<T, A> result = gemm_left.gemm(gemm_right, factor, gemm_helper());
+        if(permute_result())
+          result = result.permute(result_permutation());
+        return result;
+      }
+
+    }; // struct IndexContraction
+
+    /// Make a compile-time contraction layout
+
+    /// \return The contraction layout of
+    /// <tt>result(Cs...) = left(Ls...) * right(Rs...)</tt>
+    template <typename... Ls, typename... Rs, typename... Cs>
+    constexpr IndexContraction<IndexList<Ls...>, IndexList<Rs...>, IndexList<Cs...> >
+    make_index_contraction(const IndexList<Ls...>&, const IndexList<Rs...>&,
+        const IndexList<Cs...>&)
+    {
+      return IndexContraction<IndexList<Ls...>, IndexList<Rs...>, IndexList<Cs...> >();
+    }
+
+  }  // namespace expressions
+
+  /// Predefined single letter indices
+
+  /// With <tt>using namespace TiledArray::indices;</tt> arrays are annotated
+  /// as <tt>c(i, j) = a(i, k) * b(k, j);</tt>
+  namespace indices {
+    constexpr expressions::Index<'a'> a{};
+    constexpr expressions::Index<'b'> b{};
+    constexpr expressions::Index<'c'> c{};
+    constexpr expressions::Index<'d'> d{};
+    constexpr expressions::Index<'e'> e{};
+    constexpr expressions::Index<'f'> f{};
+    constexpr expressions::Index<'g'> g{};
+    constexpr expressions::Index<'h'> h{};
+    constexpr expressions::Index<'i'> i{};
+    constexpr expressions::Index<'j'> j{};
+    constexpr expressions::Index<'k'> k{};
+    constexpr expressions::Index<'l'> l{};
+    constexpr expressions::Index<'m'> m{};
+    constexpr expressions::Index<'n'> n{};
+    constexpr expressions::Index<'o'> o{};
+    constexpr expressions::Index<'p'> p{};
+    constexpr expressions::Index<'q'> q{};
+    constexpr expressions::Index<'r'> r{};
+    constexpr expressions::Index<'s'> s{};
+    constexpr expressions::Index<'t'> t{};
+    constexpr expressions::Index<'u'> u{};
+    constexpr expressions::Index<'v'> v{};
+    constexpr expressions::Index<'w'> w{};
+    constexpr expressions::Index<'x'> x{};
+    constexpr expressions::Index<'y'> y{};
+    constexpr expressions::Index<'z'> z{};
+  }  // namespace indices
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_INDEX_LIST_H__INCLUDED
@@ -28,6 +28,9 @@
 
 #include <TiledArray/expressions/expr_engine.h>
 #include <TiledArray/dist_eval/array_eval.h>
+#include <limits>
+#include <sstream>
+#include <typeinfo>
 
 namespace TiledArray {
   namespace expressions {
@@ -125,6 +128,49 @@ namespace TiledArray {
         ExprEngine_::init_distribution(world, (pmap ? pmap : array_.pmap()));
       }
 
+      /// Native process map accessor
+
+      /// \return The process map of the array, or NULL if the tiles of the
+      /// array are permuted
+      std::shared_ptr<pmap_interface> native_pmap(World&) const {
+        if(perm_ || (array_.pmap()->size() != trange_.tiles_range().volume()))
+          return nullptr;
+        return array_.pmap();
+      }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param world The world where the expression is evaluated
+      /// \param pmap The process map of the result tensor
+      /// \return The number of elements, in non-zero tiles, that are not owned
+      /// by the same process in the array and in \c pmap
+      std::size_t redistribution_cost(World& world, const pmap_interface& pmap) const {
+        const std::shared_ptr<pmap_interface> native = native_pmap(world);
+        return (native ? ExprEngine_::move_cost(*native, pmap) : 0ul);
+      }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// Every non-zero tile of the array is copied when it is permuted.
+      /// Tiles of lazy arrays are permuted after they are generated, which
+      /// also adds a copy of each tile. The permutation cache of the array
+      /// (see \c DistArray::permutation_cache_capacity() ) is not taken into
+      /// account: it is set on each process separately, and the cost must be
+      /// the same on all processes, so that they select the same evaluation
+      /// plan.
+      /// \return The number of elements in the non-zero tiles of the array
+      std::size_t permute_cost() const {
+        if(shape_type::is_dense())
+          return array_.trange().elements_range().volume();
+
+        std::size_t cost = 0ul;
+        const size_type volume = array_.trange().tiles_range().volume();
+        for(size_type i = 0ul; i < volume; ++i)
+          if(! array_.is_zero(i))
+            cost += array_.trange().make_tile_range(i).volume();
+        return cost;
+      }
+
 
       /// Non-permuting tiled range factory function
 
@@ -152,6 +198,56 @@ namespace TiledArray {
       make_shape(const Permutation& perm) { return array_.shape().perm(perm); }
 
 
+      /// Rebind this engine to the array of another expression
+
+      /// The engine may evaluate the array of \c expr when it has the same
+      /// tiled range as the array of this engine; the array is replaced and
+      /// the structure of this engine is kept.
+      /// \tparam D The expression type
+      /// \param expr An expression with the same structure as the expression
+      /// of this engine
+      /// \param[in,out] same_shape Set to false when the shape of the array
+      /// of \c expr differs from the shape of the current array
+      /// \return \c true if the array was replaced, or \c false if the
+      /// tiled ranges differ
+      template <typename D>
+      bool rebind(const Expr<D>& expr, bool& same_shape) {
+        const array_type& array = expr.derived().array();
+        if(array.trange() != array_.trange())
+          return false;
+        if(! TiledArray::detail::is_same_shape(array.shape(), array_.shape()))
+          same_shape = false;
+        array_ = array;
+        return true;
+      }
+
+      /// Construct the cost estimate of this expression
+
+      /// The tiles of the array are only allocated when they are permuted,
+      /// and the non-zero tiles that are owned by different processes in the
+      /// array and in the distribution of this expression are communicated.
+      /// \return The cost estimate of this expression
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        std::shared_ptr<ExprEstimate> estimate =
+            ExprEngine_::make_estimate(perm_ && permute_tiles_);
+
+        const size_type volume = array_.trange().tiles_range().volume();
+        if((world_->size() == 1) || (volume != trange_.tiles_range().volume()))
+          return estimate;
+        const unsigned long long element_bytes =
+            sizeof(TiledArray::detail::numeric_t<value_type>);
+        for(size_type i = 0ul; i < volume; ++i) {
+          if(array_.is_zero(i))
+            continue;
+          const size_type target = (perm_ ? trange_.tiles_range().ordinal(
+              perm_ * array_.trange().tiles_range().idx(i)) : i);
+          if(array_.pmap()->owner(i) != pmap_->owner(target))
+            estimate->add_comm_bytes(
+                array_.trange().make_tile_range(i).volume() * element_bytes);
+        }
+        return estimate;
+      }
+
       /// Construct the distributed evaluator for array
       dist_eval_type make_dist_eval() const {
         // Define the distributed evaluator implementation type
@@ -161,10 +257,35 @@ namespace TiledArray {
         std::shared_ptr<impl_type> pimpl(
             new impl_type(array_, *world_, trange_, shape_, pmap_, perm_,
             ExprEngine_::make_op()));
+        pimpl->profile(ExprEngine_::make_profile());
+        if(lazy_tile_cache_capacity() || array_.permutation_cache())
+          pimpl->cache_key(make_lazy_tile_cache_key());
 
         return dist_eval_type(pimpl);
       }
 
+      /// Lazy tile cache key factory function
+
+      /// \return The key that identifies the array and the operation that
+      /// converts its tiles
+      std::string make_lazy_tile_cache_key() const {
+        std::ostringstream ss;
+        ss.precision(std::numeric_limits<long double>::max_digits10);
+        ExprEngine_::derived().cache_key(ss);
+        ss << " " << typeid(op_type).name() << " " << perm_ << " "
+            << permute_tiles_;
+        return ss.str();
+      }
+
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        ExprEngine_::cache_key(os);
+        os << " {" << array_.id().get_world_id() << ":"
+            << array_.id().get_obj_id() << "}";
+      }
+
     }; // class LeafEngine
 
   }  // namespace expressions
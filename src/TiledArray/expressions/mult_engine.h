@@ -182,6 +182,14 @@ namespace TiledArray {
         ContEngine_(expr), contract_(false)
       { }
 
+      /// Contraction check
+
+      /// \return \c true if this expression is a contraction, or \c false if
+      /// it is a Hadamard product
+      /// \note The expression type is set when the variable list of this
+      /// expression is initialized.
+      bool is_contraction() const { return contract_; }
+
 
       /// Set the variable list for this expression
 
@@ -267,6 +275,40 @@ namespace TiledArray {
           BinaryEngine_::init_distribution(world, pmap);
       }
 
+      /// Native process map accessor
+
+      /// \return The native process map of a Hadamard product, or NULL for a
+      /// contraction
+      std::shared_ptr<pmap_interface> native_pmap(World& world) const {
+        if(contract_)
+          return ContEngine_::native_pmap(world);
+        else
+          return BinaryEngine_::native_pmap(world);
+      }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param pmap The process map of the result tensor
+      /// \return The redistribution cost of a Hadamard product, or zero for a
+      /// contraction
+      std::size_t redistribution_cost(World& world, const pmap_interface& pmap) const {
+        if(contract_)
+          return ContEngine_::redistribution_cost(world, pmap);
+        else
+          return BinaryEngine_::redistribution_cost(world, pmap);
+      }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// \return The permutation cost of a Hadamard product, or zero for a
+      /// contraction
+      std::size_t permute_cost() const {
+        if(contract_)
+          return ContEngine_::permute_cost();
+        else
+          return BinaryEngine_::permute_cost();
+      }
+
       /// Non-permuting tiled range factory function
 
       /// \return The result tiled range object
@@ -340,6 +382,16 @@ namespace TiledArray {
           return BinaryEngine_::print(os, target_vars);
       }
 
+      /// Construct the cost estimate of this expression
+
+      /// \return The cost estimate of this expression and its arguments
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        if(contract_)
+          return ContEngine_::make_estimate();
+        else
+          return BinaryEngine_::make_estimate();
+      }
+
     }; // class MultEngine
 
 
@@ -410,6 +462,14 @@ namespace TiledArray {
       template <typename L, typename R, typename S>
       ScalMultEngine(const ScalMultExpr<L, R, S>& expr) : ContEngine_(expr), contract_(false) { }
 
+      /// Contraction check
+
+      /// \return \c true if this expression is a contraction, or \c false if
+      /// it is a Hadamard product
+      /// \note The expression type is set when the variable list of this
+      /// expression is initialized.
+      bool is_contraction() const { return contract_; }
+
       /// Set the variable list for this expression
 
       /// This function will set the variable list for this expression and its
@@ -494,6 +554,40 @@ namespace TiledArray {
           BinaryEngine_::init_distribution(world, pmap);
       }
 
+      /// Native process map accessor
+
+      /// \return The native process map of a Hadamard product, or NULL for a
+      /// contraction
+      std::shared_ptr<pmap_interface> native_pmap(World& world) const {
+        if(contract_)
+          return ContEngine_::native_pmap(world);
+        else
+          return BinaryEngine_::native_pmap(world);
+      }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param pmap The process map of the result tensor
+      /// \return The redistribution cost of a Hadamard product, or zero for a
+      /// contraction
+      std::size_t redistribution_cost(World& world, const pmap_interface& pmap) const {
+        if(contract_)
+          return ContEngine_::redistribution_cost(world, pmap);
+        else
+          return BinaryEngine_::redistribution_cost(world, pmap);
+      }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// \return The permutation cost of a Hadamard product, or zero for a
+      /// contraction
+      std::size_t permute_cost() const {
+        if(contract_)
+          return ContEngine_::permute_cost();
+        else
+          return BinaryEngine_::permute_cost();
+      }
+
       /// Construct the distributed evaluator for this expression
 
       /// \return The distributed evaluator that will evaluate this expression
@@ -577,6 +671,16 @@ namespace TiledArray {
           return BinaryEngine_::print(os, target_vars);
       }
 
+      /// Construct the cost estimate of this expression
+
+      /// \return The cost estimate of this expression and its arguments
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        if(contract_)
+          return ContEngine_::make_estimate();
+        else
+          return BinaryEngine_::make_estimate();
+      }
+
     }; // class ScalMultEngine
 
   }  // namespace expressions
@@ -28,6 +28,8 @@
 
 #include <TiledArray/expressions/binary_expr.h>
 #include <TiledArray/expressions/mult_engine.h>
+#include <TiledArray/expressions/cont_order.h>
+#include <TiledArray/expressions/cont_slice.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -110,6 +112,11 @@ namespace TiledArray {
 
       /// Dot product
 
+      /// A product over all indices, e.g.
+      /// <tt>double e = t("i,j,a,b") * v("i,j,a,b")</tt> , is evaluated as a
+      /// dot product: the local tile pairs are reduced where they are stored,
+      /// followed by a single global sum, so the product is neither
+      /// distributed by SUMMA nor stored.
       /// \tparam Numeric A numeric type
       /// \return The dot product of this expression.
       template <typename Numeric,
@@ -133,6 +140,89 @@ namespace TiledArray {
         return BinaryExpr_::left().dot(BinaryExpr_::right());
       }
 
+      using BinaryExpr_::eval_to;
+      using BinaryExpr_::eval_async;
+
+      /// Evaluate this object and assign it to \c tsr
+
+      /// When this expression is a chain of three contraction operands, i.e.
+      /// <tt>(a * b) * c</tt> or <tt>a * (b * c)</tt>, the operands are
+      /// contracted in the order with the smallest estimated cost, which is
+      /// computed from the extents of the operand indices and the sparsity
+      /// of the operand shapes (see \c cont_chain_order() ). Chains are not
+      /// reordered if the engine parameters of this expression or of the
+      /// nested multiplication were set, or if the \c TA_CONTRACTION_ORDER
+      /// environment variable is \c 0 . A contraction of two arrays whose
+      /// result exceeds \c contraction_max_memory() is evaluated in slices,
+      /// see \c eval_cont_sliced() .
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \param tsr The tensor to be assigned
+      template <typename A, bool Alias>
+      void eval_to(TsrExpr<A, Alias>& tsr) const {
+        eval_async(tsr).wait();
+      }
+
+      /// Evaluate this object asynchronously and assign it to \c tsr
+
+      /// Chains of contractions are reordered as in \c eval_to() .
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \param tsr The tensor to be assigned
+      /// \return The handle of the evaluation
+      template <typename A, bool Alias>
+      ExprHandle<A> eval_async(TsrExpr<A, Alias>& tsr) const {
+        return eval_chain_async(tsr, BinaryExpr_::left(), BinaryExpr_::right());
+      }
+
+    private:
+
+      template <typename A, bool Alias, typename L, typename R>
+      ExprHandle<A> eval_chain_async(TsrExpr<A, Alias>& tsr, const L&, const R&) const {
+        return BinaryExpr_::eval_async(tsr);
+      }
+
+      template <typename A, bool Alias, typename L, bool AliasL, typename R,
+          bool AliasR>
+      ExprHandle<A> eval_chain_async(TsrExpr<A, Alias>& tsr,
+          const TsrExpr<L, AliasL>& left, const TsrExpr<R, AliasR>& right) const
+      {
+        if(! BinaryExpr_::has_overrides() && eval_cont_sliced(tsr, *this, left, right))
+          return ExprHandle<A>(tsr.array());
+        return BinaryExpr_::eval_async(tsr);
+      }
+
+      template <typename A, bool Alias, typename L1, typename L2, typename R>
+      ExprHandle<A> eval_chain_async(TsrExpr<A, Alias>& tsr,
+          const MultExpr<L1, L2>& left, const R& right) const
+      {
+        if(contraction_ordering() && ! BinaryExpr_::has_overrides() &&
+            ! left.has_overrides())
+          return eval_cont_chain(tsr, left.left(), left.right(), right, ContOrder::left);
+        return BinaryExpr_::eval_async(tsr);
+      }
+
+      template <typename A, bool Alias, typename L, typename R1, typename R2>
+      ExprHandle<A> eval_chain_async(TsrExpr<A, Alias>& tsr, const L& left,
+          const MultExpr<R1, R2>& right) const
+      {
+        if(contraction_ordering() && ! BinaryExpr_::has_overrides() &&
+            ! right.has_overrides())
+          return eval_cont_chain(tsr, left, right.left(), right.right(), ContOrder::right);
+        return BinaryExpr_::eval_async(tsr);
+      }
+
+      template <typename A, bool Alias, typename L1, typename L2, typename R1,
+          typename R2>
+      ExprHandle<A> eval_chain_async(TsrExpr<A, Alias>& tsr,
+          const MultExpr<L1, L2>& left, const MultExpr<R1, R2>& right) const
+      {
+        if(contraction_ordering() && ! BinaryExpr_::has_overrides() &&
+            ! left.has_overrides())
+          return eval_cont_chain(tsr, left.left(), left.right(), right, ContOrder::left);
+        return BinaryExpr_::eval_async(tsr);
+      }
+
     }; // class MultExpr
 
 
@@ -177,6 +267,21 @@ namespace TiledArray {
       /// \return The scaling factor
       scalar_type factor() const { return factor_; }
 
+      /// Scaled dot product
+
+      /// A product over all indices is evaluated as a dot product of the
+      /// arguments, which is scaled by the factor of this expression.
+      /// \tparam Numeric A numeric type
+      /// \return The scaled dot product of this expression.
+      template <typename Numeric,
+          typename std::enable_if<
+              TiledArray::detail::is_numeric<Numeric>::value
+          >::type* = nullptr>
+      operator Numeric() const {
+        auto result = BinaryExpr_::left().dot(BinaryExpr_::right());
+        return factor_ * result.get();
+      }
+
     }; // class ScalMultExpr
 
 
@@ -512,6 +617,45 @@ namespace TiledArray {
       return result;
     }
 
+    /// Scaled dot product add-to operator
+
+    /// \tparam Numeric The numeric result type
+    /// \tparam Left The left-hand expression type
+    /// \tparam Right The right-hand expression type
+    /// \tparam Scalar The scaling factor type
+    /// \param result The result that the scaled dot product will be added to.
+    /// \param expr The scaled multiply expression object
+    /// \return A reference to result
+    template <typename Numeric, typename Left, typename Right, typename Scalar,
+        typename std::enable_if<
+            TiledArray::detail::is_numeric<Numeric>::value
+        >::type* = nullptr>
+    inline Numeric&
+    operator +=(Numeric& result, const ScalMultExpr<Left, Right, Scalar>& expr) {
+      result += expr.factor() * expr.left().dot(expr.right()).get();
+      return result;
+    }
+
+    /// Scaled dot product subtract-to operator
+
+    /// \tparam Numeric The numeric result type
+    /// \tparam Left The left-hand expression type
+    /// \tparam Right The right-hand expression type
+    /// \tparam Scalar The scaling factor type
+    /// \param result The result that the scaled dot product will be
+    /// subtracted from.
+    /// \param expr The scaled multiply expression object
+    /// \return A reference to result
+    template <typename Numeric, typename Left, typename Right, typename Scalar,
+        typename std::enable_if<
+            TiledArray::detail::is_numeric<Numeric>::value
+        >::type* = nullptr>
+    inline Numeric&
+    operator -=(Numeric& result, const ScalMultExpr<Left, Right, Scalar>& expr) {
+      result -= expr.factor() * expr.left().dot(expr.right()).get();
+      return result;
+    }
+
 
   }  // namespace expressions
 } // namespace TiledArray
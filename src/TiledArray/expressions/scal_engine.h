@@ -148,6 +148,14 @@ namespace TiledArray {
         return ss.str();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        UnaryEngine_::cache_key(os);
+        os << " [" << factor_ << "]";
+      }
+
     }; // class ScalEngine
 
 
@@ -146,6 +146,14 @@ namespace TiledArray {
         return ss.str();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        LeafEngine_::cache_key(os);
+        os << " [" << factor_ << "]";
+      }
+
     }; // class ScalTsrEngine
 
   }  // namespace expressions
@@ -307,6 +307,14 @@ namespace TiledArray {
         return ss.str();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        BinaryEngine_::cache_key(os);
+        os << " [" << factor_ << "]";
+      }
+
     }; // class ScalSubtEngine
 
   }  // namespace expressions
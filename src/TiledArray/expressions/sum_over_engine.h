@@ -0,0 +1,347 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sum_over_engine.h
+ *  May 10, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_SUM_OVER_ENGINE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_SUM_OVER_ENGINE_H__INCLUDED
+
+#include <TiledArray/expressions/expr_engine.h>
+#include <TiledArray/dist_eval/sum_over_eval.h>
+#include <TiledArray/tile_op/sum_over.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    // Forward declarations
+    template <typename> class SumOverExpr;
+    template <typename> class SumOverEngine;
+
+
+    template <typename Arg>
+    struct EngineTrait<SumOverEngine<Arg> > {
+      // Argument typedefs
+      typedef Arg argument_type; ///< The argument expression engine type
+
+      // Operational typedefs
+      typedef typename EngineTrait<Arg>::eval_type
+          value_type; ///< The result tile type
+      typedef TiledArray::detail::SumOver<value_type,
+          typename EngineTrait<Arg>::eval_type> op_type; ///< The tile operation type
+      typedef typename eval_trait<value_type>::type
+          eval_type; ///< Evaluation tile type
+      typedef typename argument_type::policy
+          policy; ///< The result policy type
+      typedef TiledArray::detail::DistEval<value_type, policy>
+          dist_eval_type; ///< The distributed evaluator type
+
+      // Meta data typedefs
+      typedef typename policy::size_type size_type; ///< Size type
+      typedef typename policy::trange_type trange_type; ///< Tiled range type
+      typedef typename policy::shape_type shape_type; ///< Shape type
+      typedef typename policy::pmap_interface
+          pmap_interface; ///< Process map interface type
+
+      static constexpr bool consumable = true;
+      static constexpr unsigned int leaves = EngineTrait<Arg>::leaves;
+    };
+
+
+    /// Partial sum expression engine
+
+    /// This engine evaluates the sum of its argument over some of its
+    /// variables, e.g. <tt>v("i") = A("i,j").sum_over("j")</tt> , with
+    /// \c SumOverEvalImpl . The other variables of the argument are the
+    /// variables of the result, in the order of the argument. The argument
+    /// is not permuted to the target variables of the result; the result
+    /// tiles, which are smaller, are permuted instead.
+    /// \tparam Arg The argument expression engine type
+    template <typename Arg>
+    class SumOverEngine : public ExprEngine<SumOverEngine<Arg> > {
+    public:
+      // Class hierarchy typedefs
+      typedef SumOverEngine<Arg> SumOverEngine_; ///< This class type
+      typedef ExprEngine<SumOverEngine_> ExprEngine_; ///< Expression engine base type
+
+      // Argument typedefs
+      typedef typename EngineTrait<SumOverEngine_>::argument_type argument_type; ///< The argument expression engine type
+
+      // Operational typedefs
+      typedef typename EngineTrait<SumOverEngine_>::value_type value_type; ///< The result tile type
+      typedef typename EngineTrait<SumOverEngine_>::op_type op_type; ///< The tile operation type
+      typedef typename EngineTrait<SumOverEngine_>::policy policy; ///< The result policy type
+      typedef typename EngineTrait<SumOverEngine_>::dist_eval_type dist_eval_type; ///< The distributed evaluator type
+
+      // Meta data typedefs
+      typedef typename EngineTrait<SumOverEngine_>::size_type size_type; ///< Size type
+      typedef typename EngineTrait<SumOverEngine_>::trange_type trange_type; ///< Tiled range type
+      typedef typename EngineTrait<SumOverEngine_>::shape_type shape_type; ///< Shape type
+      typedef typename EngineTrait<SumOverEngine_>::pmap_interface pmap_interface; ///< Process map interface type
+
+      static constexpr bool consumable = true;
+      static constexpr unsigned int leaves = argument_type::leaves;
+
+    protected:
+
+      // Import base class variables to this scope
+      using ExprEngine_::world_;
+      using ExprEngine_::vars_;
+      using ExprEngine_::perm_;
+      using ExprEngine_::trange_;
+      using ExprEngine_::shape_;
+      using ExprEngine_::pmap_;
+      using ExprEngine_::permute_tiles_;
+
+    private:
+
+      argument_type arg_; ///< The argument
+      VariableList sum_vars_; ///< The summed variables
+      std::vector<unsigned int> dims_; ///< The summed dimensions of the argument
+
+      // Not allowed
+      SumOverEngine(const SumOverEngine_&);
+      SumOverEngine_& operator=(const SumOverEngine_&);
+
+    public:
+
+      /// Constructor
+
+      /// \tparam A The argument expression type
+      /// \param expr The parent expression
+      template <typename A>
+      SumOverEngine(const SumOverExpr<A>& expr) :
+        ExprEngine_(expr), arg_(expr.arg()), sum_vars_(expr.sum_vars()), dims_()
+      { }
+
+      // Pull base class functions into this class.
+      using ExprEngine_::derived;
+      using ExprEngine_::vars;
+
+      /// Set the variable list for this expression
+
+      /// The argument is not permuted, so the result keeps the variable list
+      /// of the argument, and the result tiles are permuted to
+      /// \c target_vars by \c init_struct() .
+      void perm_vars(const VariableList&) { TA_ASSERT(permute_tiles_); }
+
+      /// Initialize the variable list of this expression
+
+      /// \param target_vars The target variable list for this expression
+      void init_vars(const VariableList&) { init_vars(); }
+
+      /// Initialize the variable list of this expression
+
+      /// \throw TiledArray::Exception When a summed variable is not a
+      /// variable of the argument, or when all variables of the argument are
+      /// summed.
+      void init_vars() {
+        arg_.init_vars();
+
+        const VariableList& arg_vars = arg_.vars();
+        for(const std::string& var : sum_vars_) {
+          if(std::find(arg_vars.begin(), arg_vars.end(), var) == arg_vars.end()) {
+            if(TiledArray::get_default_world().rank() == 0) {
+              TA_USER_ERROR_MESSAGE( \
+                  "The summed variable " << var << " is not a variable of the " \
+                  "argument:" \
+                  << "\n    argument = " << arg_vars \
+                  << "\n    summed   = " << sum_vars_ );
+            }
+
+            TA_EXCEPTION("A summed variable is not a variable of the argument.");
+          }
+        }
+
+        // Split the variables of the argument
+        std::vector<std::string>& result_vars =
+            const_cast<std::vector<std::string>&>(vars_.data());
+        result_vars.clear();
+        dims_.clear();
+        for(unsigned int d = 0u; d < arg_vars.dim(); ++d) {
+          if(std::find(sum_vars_.begin(), sum_vars_.end(), arg_vars[d]) == sum_vars_.end())
+            result_vars.push_back(arg_vars[d]);
+          else
+            dims_.push_back(d);
+        }
+
+        if(result_vars.empty())
+          TA_EXCEPTION("All variables of the argument are summed; use sum() "
+              "to compute the sum of all elements.");
+      }
+
+      /// Initialize result tensor structure
+
+      /// This function will initialize the permutation, tiled range, and shape
+      /// for the argument and result tensor.
+      /// \param target_vars The target variable list for the result tensor
+      void init_struct(const VariableList& target_vars) {
+        arg_.init_struct(arg_.vars());
+        ExprEngine_::init_struct(target_vars);
+      }
+
+      /// Initialize result tensor distribution
+
+      /// The argument keeps its own distribution, and the result tiles are
+      /// distributed by \c pmap or by the default process map of the policy.
+      /// \param world The world were the result will be distributed
+      /// \param pmap The process map for the result tensor tiles
+      void init_distribution(World* world,
+          const std::shared_ptr<pmap_interface>& pmap)
+      {
+        std::shared_ptr<pmap_interface> arg_pmap = arg_.native_pmap(*world);
+        if(! arg_pmap)
+          arg_pmap = policy::default_pmap(*world,
+              arg_.trange().tiles_range().volume());
+        arg_.init_distribution(world, arg_pmap);
+
+        ExprEngine_::init_distribution(world, (pmap ? pmap :
+            policy::default_pmap(*world, trange_.tiles_range().volume())));
+      }
+
+      /// Non-permuting tiled range factory function
+
+      /// \return The result tiled range
+      trange_type make_trange() const {
+        const trange_type& arg_trange = arg_.trange();
+        std::vector<TiledRange1> ranges;
+        ranges.reserve(arg_trange.rank() - dims_.size());
+        for(unsigned int d = 0u; d < arg_trange.rank(); ++d)
+          if(! std::binary_search(dims_.begin(), dims_.end(), d))
+            ranges.push_back(arg_trange.data()[d]);
+        return trange_type(ranges.begin(), ranges.end());
+      }
+
+      /// Permuting tiled range factory function
+
+      /// \param perm The permutation to be applied to the tiled range
+      /// \return The result tiled range
+      trange_type make_trange(const Permutation& perm) const {
+        return perm * make_trange();
+      }
+
+      /// Non-permuting shape factory function
+
+      /// \return The result shape
+      shape_type make_shape() const { return arg_.shape().sum_over(dims_); }
+
+      /// Permuting shape factory function
+
+      /// \param perm The permutation to be applied to the shape
+      /// \return The result shape
+      shape_type make_shape(const Permutation& perm) const {
+        return arg_.shape().sum_over(dims_).perm(perm);
+      }
+
+      /// Non-permuting tile operation factory function
+
+      /// \return The tile operation
+      op_type make_tile_op() const { return op_type(dims_); }
+
+      /// Permuting tile operation factory function
+
+      /// \param perm The permutation to be applied to tiles
+      /// \return The tile operation
+      op_type make_tile_op(const Permutation& perm) const { return op_type(dims_, perm); }
+
+      /// Construct the distributed evaluator for this expression
+
+      /// \return The distributed evaluator that will evaluate this expression
+      dist_eval_type make_dist_eval() const {
+        typedef TiledArray::detail::SumOverEvalImpl<typename argument_type::dist_eval_type,
+            op_type, typename dist_eval_type::policy> impl_type;
+
+        // Construct the argument distributed evaluator
+        const typename argument_type::dist_eval_type arg = arg_.make_dist_eval();
+
+        // Construct the distributed evaluator type
+        std::shared_ptr<impl_type> pimpl(
+            new impl_type(arg, *world_, trange_, shape_, pmap_, perm_,
+            ExprEngine_::make_op()));
+
+        if(std::shared_ptr<ExprProfile> profile = ExprEngine_::make_profile()) {
+          profile->add_child(arg.profile());
+          pimpl->profile(profile);
+        }
+
+        return dist_eval_type(pimpl);
+      }
+
+      /// Expression identification tag
+
+      /// \return An expression tag used to identify this expression
+      std::string make_tag() const {
+        std::stringstream ss;
+        ss << "[sum_over " << sum_vars_ << "] ";
+        return ss.str();
+      }
+
+      /// Rebind the leaves of this engine to the arrays of another expression
+
+      /// \tparam A The argument expression type
+      /// \param expr An expression with the same structure as the expression
+      /// of this engine
+      /// \param[in,out] same_shape Set to false when a shape of an array
+      /// changed
+      /// \return \c true if the arrays were replaced, or \c false if a tiled
+      /// range differs
+      template <typename A>
+      bool rebind(const SumOverExpr<A>& expr, bool& same_shape) {
+        return arg_.rebind(expr.arg(), same_shape);
+      }
+
+      /// Construct the cost estimate of this expression
+
+      /// \return The cost estimate of this expression and its argument
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        std::shared_ptr<ExprEstimate> estimate = ExprEngine_::make_estimate();
+        estimate->add_child(arg_.make_estimate());
+        return estimate;
+      }
+
+      /// Expression print
+
+      /// \param os The output stream
+      /// \param target_vars The target variable list for this expression
+      void print(ExprOStream os, const VariableList& target_vars) const {
+        ExprEngine_::print(os, target_vars);
+        os.inc();
+        arg_.print(os, arg_.vars());
+        os.dec();
+      }
+
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        ExprEngine_::cache_key(os);
+        os << " [sum_over " << sum_vars_ << "] (";
+        arg_.cache_key(os);
+        os << ")";
+      }
+
+    }; // class SumOverEngine
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_SUM_OVER_ENGINE_H__INCLUDED
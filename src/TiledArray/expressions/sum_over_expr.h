@@ -0,0 +1,90 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sum_over_expr.h
+ *  May 10, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_SUM_OVER_EXPR_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_SUM_OVER_EXPR_H__INCLUDED
+
+#include <TiledArray/expressions/unary_expr.h>
+#include <TiledArray/expressions/sum_over_engine.h>
+
+namespace TiledArray {
+  namespace expressions {
+
+    template <typename Arg>
+    struct ExprTrait<SumOverExpr<Arg> > {
+      typedef Arg argument_type; ///< The argument expression type
+      typedef SumOverEngine<typename ExprTrait<Arg>::engine_type>
+          engine_type; ///< Expression engine type
+      typedef typename ExprTrait<Arg>::numeric_type
+          numeric_type; ///< Result numeric type
+      typedef typename ExprTrait<Arg>::scalar_type
+          scalar_type; ///< Result scalar type
+    };
+
+    /// Partial sum expression
+
+    /// The sum of an expression over some of its variables, e.g.
+    /// \code
+    /// v("i") = A("i,j").sum_over("j");
+    /// \endcode
+    /// which is constructed with \c Expr::sum_over() .
+    /// \tparam Arg The argument expression type
+    template <typename Arg>
+    class SumOverExpr : public UnaryExpr<SumOverExpr<Arg> > {
+    public:
+      typedef SumOverExpr<Arg> SumOverExpr_; ///< This class type
+      typedef UnaryExpr<SumOverExpr_> UnaryExpr_; ///< Unary base class type
+      typedef typename ExprTrait<SumOverExpr_>::argument_type argument_type; ///< The argument expression type
+      typedef typename ExprTrait<SumOverExpr_>::engine_type engine_type; ///< Expression engine type
+
+    private:
+
+      VariableList sum_vars_; ///< The summed variables
+
+    public:
+
+      // Compiler generated functions
+      SumOverExpr(const SumOverExpr_&) = default;
+      SumOverExpr(SumOverExpr_&&) = default;
+      ~SumOverExpr() = default;
+      SumOverExpr_& operator=(const SumOverExpr_&) = delete;
+      SumOverExpr_& operator=(SumOverExpr_&&) = delete;
+
+      /// Partial sum expression constructor
+
+      /// \param arg The argument expression
+      /// \param sum_vars The summed variables of \c arg
+      SumOverExpr(const argument_type& arg, const VariableList& sum_vars) :
+        UnaryExpr_(arg), sum_vars_(sum_vars)
+      { }
+
+      /// Summed variables accessor
+
+      /// \return The summed variables
+      const VariableList& sum_vars() const { return sum_vars_; }
+
+    }; // class SumOverExpr
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_SUM_OVER_EXPR_H__INCLUDED
@@ -94,6 +94,47 @@ namespace TiledArray {
       array_type& array_; ///< The array that this expression
       std::string vars_; ///< The tensor variable list
 
+      /// Check that a product may be accumulated in place into this array
+
+      /// \tparam D The product expression type
+      template <typename D>
+      struct is_accumulable : public std::integral_constant<bool, (! Alias) &&
+          std::is_same<typename array_type::value_type,
+              typename EngineTrait<typename ExprTrait<D>::engine_type>::value_type>::value &&
+          std::is_same<typename array_type::shape_type,
+              typename EngineTrait<typename ExprTrait<D>::engine_type>::shape_type>::value>
+      { };
+
+      /// Add an expression to this array
+
+      /// \tparam D The expression type
+      /// \param other The expression that will be added to this array
+      template <typename D>
+      array_type& plus_assign(const D& other, std::false_type) {
+        return operator=(AddExpr<TsrExpr_, D>(*this, other));
+      }
+
+      /// Add a product to this array
+
+      /// Contractions are accumulated into copies of the tiles of this array,
+      /// instead of a temporary result that is added to this array in a
+      /// separate pass; Hadamard products are added to this array.
+      /// \tparam D The product expression type
+      /// \param other The product that will be added to this array
+      template <typename D>
+      array_type& plus_assign(const D& other, std::true_type) {
+        if(array_.is_initialized() && ! array_.is_view()) {
+          typename ExprTrait<D>::engine_type engine(other);
+          engine.init_vars();
+          if(engine.is_contraction()) {
+            D expr(other);
+            expr.set_seed(array_);
+            return operator=(expr);
+          }
+        }
+        return plus_assign(other, std::false_type());
+      }
+
     public:
 
       // Compiler generated functions
@@ -131,6 +172,21 @@ namespace TiledArray {
         return array_;
       }
 
+      /// Asynchronous expression assignment
+
+      /// The array is assigned before the tasks of \c other have been run;
+      /// see \c ExprHandle .
+      /// \tparam D The derived expression type
+      /// \param other The expression that will be assigned to this array
+      /// \return The handle of the evaluation
+      template <typename D>
+      ExprHandle<array_type> assign_async(const Expr<D>& other) {
+        static_assert(TiledArray::expressions::is_aliased<D>::value,
+            "no_alias() expressions are not allowed on the right-hand side of "
+            "the assignment operator.");
+        return other.derived().eval_async(*this);
+      }
+
       /// Expression plus-assignment operator
 
       /// \tparam D The derived expression type
@@ -140,7 +196,45 @@ namespace TiledArray {
         static_assert(TiledArray::expressions::is_aliased<D>::value,
             "no_alias() expressions are not allowed on the right-hand side of "
             "the assignment operator.");
-        return operator=(AddExpr<TsrExpr_, D>(*this, other.derived()));
+        return plus_assign(other.derived(), std::false_type());
+      }
+
+      /// Product plus-assignment operator
+
+      /// If this is a non-aliasing expression, e.g.
+      /// <tt>c("i,j").no_alias() += a("i,k") * b("k,j")</tt> , contractions
+      /// are accumulated into copies of the tiles of this array, instead of
+      /// a temporary result that is added to this array in a separate pass.
+      /// The tiles of this array are not modified in place, so shallow
+      /// copies of the array and other objects that share its tiles keep
+      /// their values.
+      /// \tparam L The left-hand argument expression type
+      /// \tparam R The right-hand argument expression type
+      /// \param other The product that will be added to this array
+      template <typename L, typename R>
+      array_type& operator+=(const MultExpr<L, R>& other) {
+        static_assert(TiledArray::expressions::is_aliased<MultExpr<L, R> >::value,
+            "no_alias() expressions are not allowed on the right-hand side of "
+            "the assignment operator.");
+        return plus_assign(other,
+            is_accumulable<MultExpr<L, R> >());
+      }
+
+      /// Scaled product plus-assignment operator
+
+      /// Non-aliasing contractions are accumulated into copies of the tiles
+      /// of this array; see the product plus-assignment operator.
+      /// \tparam L The left-hand argument expression type
+      /// \tparam R The right-hand argument expression type
+      /// \tparam S The scaling factor type
+      /// \param other The scaled product that will be added to this array
+      template <typename L, typename R, typename S>
+      array_type& operator+=(const ScalMultExpr<L, R, S>& other) {
+        static_assert(TiledArray::expressions::is_aliased<ScalMultExpr<L, R, S> >::value,
+            "no_alias() expressions are not allowed on the right-hand side of "
+            "the assignment operator.");
+        return plus_assign(other,
+            is_accumulable<ScalMultExpr<L, R, S> >());
       }
 
       /// Expression minus-assignment operator
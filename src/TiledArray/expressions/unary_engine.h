@@ -144,6 +144,26 @@ namespace TiledArray {
         ExprEngine_::init_distribution(world, arg_.pmap());
       }
 
+      /// Native process map accessor
+
+      /// \return The native process map of the argument
+      std::shared_ptr<pmap_interface> native_pmap(World& world) const {
+        return arg_.native_pmap(world);
+      }
+
+      /// Estimate the cost of a result distribution
+
+      /// \param pmap The process map of the result tensor
+      /// \return The redistribution cost of the argument
+      std::size_t redistribution_cost(World& world, const pmap_interface& pmap) const {
+        return arg_.redistribution_cost(world, pmap);
+      }
+
+      /// Estimate the cost of a permutation of the result
+
+      /// \return The permutation cost of the argument
+      std::size_t permute_cost() const { return arg_.permute_cost(); }
+
       /// Non-permuting tiled range factory function
 
       /// \return The result tiled range
@@ -172,9 +192,37 @@ namespace TiledArray {
             new impl_type(arg, *world_, trange_, shape_, pmap_, perm_,
             ExprEngine_::make_op()));
 
+        if(std::shared_ptr<ExprProfile> profile = ExprEngine_::make_profile()) {
+          profile->add_child(arg.profile());
+          pimpl->profile(profile);
+        }
+
         return dist_eval_type(pimpl);
       }
 
+      /// Rebind the leaves of this engine to the arrays of another expression
+
+      /// \tparam D The expression type
+      /// \param expr An expression with the same structure as the expression
+      /// of this engine
+      /// \param[in,out] same_shape Set to false when a shape of an array
+      /// changed
+      /// \return \c true if the arrays were replaced, or \c false if a tiled
+      /// range differs
+      template <typename D>
+      bool rebind(const UnaryExpr<D>& expr, bool& same_shape) {
+        return arg_.rebind(expr.arg(), same_shape);
+      }
+
+      /// Construct the cost estimate of this expression
+
+      /// \return The cost estimate of this expression and its argument
+      std::shared_ptr<ExprEstimate> make_estimate() const {
+        std::shared_ptr<ExprEstimate> estimate = ExprEngine_::make_estimate();
+        estimate->add_child(arg_.make_estimate());
+        return estimate;
+      }
+
       /// Expression print
 
       /// \param os The output stream
@@ -186,6 +234,16 @@ namespace TiledArray {
         os.dec();
       }
 
+      /// Expression cache key
+
+      /// \param os The output stream for the key
+      void cache_key(std::ostream& os) const {
+        ExprEngine_::cache_key(os);
+        os << " (";
+        arg_.cache_key(os);
+        os << ")";
+      }
+
     }; // class UnaryEngine
 
   }  // namespace expressions
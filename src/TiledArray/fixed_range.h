@@ -0,0 +1,178 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fixed_range.h
+ *  Mar 9, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_FIXED_RANGE_H__INCLUDED
+#define TILEDARRAY_FIXED_RANGE_H__INCLUDED
+
+#include <TiledArray/range.h>
+#include <array>
+#include <utility>
+
+namespace TiledArray {
+
+  /// A range with a rank that is fixed at compile time
+
+  /// \c FixedRange holds the dimension data of a \c Range of rank \c Rank in
+  /// fixed size arrays, so the coordinate index computations are unrolled at
+  /// compile time and the strides are kept in registers in the loops over the
+  /// elements of a tile. It is intended for element access to tiles of a known
+  /// rank, typically matrices and 4-index tensors, e.g.
+  /// \code
+  /// FixedRange<4> range(tile.range());
+  /// for(...)
+  ///   tile[range.ordinal(i, j, k, l)] = ...;
+  /// \endcode
+  /// \tparam Rank The rank of the range
+  template <unsigned int Rank>
+  class FixedRange {
+    static_assert(Rank > 0u, "FixedRange: the rank must be positive");
+
+  public:
+    typedef Range::size_type size_type; ///< Size type
+    typedef Range::ordinal_type ordinal_type; ///< Ordinal type
+    typedef std::array<size_type, Rank> index; ///< Coordinate index type
+
+  private:
+
+    index lobound_; ///< The lower bound of each dimension
+    index upbound_; ///< The upper bound of each dimension
+    index extent_; ///< The extent of each dimension
+    index stride_; ///< The stride of each dimension
+    size_type offset_; ///< Ordinal index offset correction
+    size_type volume_; ///< Total number of elements
+
+    template <typename Index, std::size_t... Is>
+    ordinal_type ordinal_(const Index& i, std::index_sequence<Is...>) const {
+      size_type result = 0ul;
+      const int expand[] = { 0, (result += size_type(i[Is]) * stride_[Is], 0)... };
+      (void) expand;
+      return result - offset_;
+    }
+
+    template <typename Index, std::size_t... Is>
+    bool includes_(const Index& i, std::index_sequence<Is...>) const {
+      bool result = true;
+      const int expand[] = { 0, (result = result && (size_type(i[Is]) >= lobound_[Is]) &&
+          (size_type(i[Is]) < upbound_[Is]), 0)... };
+      (void) expand;
+      return result;
+    }
+
+  public:
+
+    /// Construct a fixed-rank copy of a range
+
+    /// \param range The range, with rank \c Rank
+    explicit FixedRange(const Range& range) :
+      offset_(range.offset()), volume_(range.volume())
+    {
+      TA_ASSERT(range.rank() == Rank);
+      for(unsigned int i = 0u; i < Rank; ++i) {
+        lobound_[i] = range.lobound_data()[i];
+        upbound_[i] = range.upbound_data()[i];
+        extent_[i] = range.extent_data()[i];
+        stride_[i] = range.stride_data()[i];
+      }
+    }
+
+    /// \return The rank of the range
+    static constexpr unsigned int rank() { return Rank; }
+
+    /// \return The lower bound of the range
+    const index& lobound() const { return lobound_; }
+
+    /// \return The upper bound of the range
+    const index& upbound() const { return upbound_; }
+
+    /// \return The extent of the range
+    const index& extent() const { return extent_; }
+
+    /// \return The stride of the range
+    const index& stride() const { return stride_; }
+
+    /// \return The number of elements in the range
+    ordinal_type volume() const { return volume_; }
+
+    /// Check the coordinate to make sure it is within the range.
+
+    /// \tparam Index The index types
+    /// \param i The coordinate index, one element per dimension
+    /// \return \c true when \c i is included in the range
+    template <typename... Index,
+        typename std::enable_if<sizeof...(Index) == Rank>::type* = nullptr>
+    bool includes(const Index&... i) const {
+      return detail::unrolled_includes<size_type>(lobound_.data(),
+          upbound_.data(), i...);
+    }
+
+    /// Check the coordinate to make sure it is within the range.
+
+    /// \tparam Integer The index element type
+    /// \param i The coordinate index
+    /// \return \c true when \c i is included in the range
+    template <typename Integer>
+    bool includes(const std::array<Integer, Rank>& i) const {
+      return includes_(i, std::make_index_sequence<Rank>());
+    }
+
+    /// Convert a coordinate index to an ordinal index
+
+    /// \tparam Index The index types
+    /// \param i The coordinate index, one element per dimension
+    /// \return The ordinal index of \c i
+    template <typename... Index,
+        typename std::enable_if<sizeof...(Index) == Rank>::type* = nullptr>
+    ordinal_type ordinal(const Index&... i) const {
+      TA_ASSERT(includes(i...));
+      return detail::unrolled_ordinal<size_type>(stride_.data(), i...) - offset_;
+    }
+
+    /// Convert a coordinate index to an ordinal index
+
+    /// \tparam Integer The index element type
+    /// \param i The coordinate index
+    /// \return The ordinal index of \c i
+    template <typename Integer>
+    ordinal_type ordinal(const std::array<Integer, Rank>& i) const {
+      TA_ASSERT(includes(i));
+      return ordinal_(i, std::make_index_sequence<Rank>());
+    }
+
+    /// Convert an ordinal index to a coordinate index
+
+    /// \param i The ordinal index
+    /// \return The coordinate index of \c i
+    index idx(ordinal_type i) const {
+      TA_ASSERT(i < volume_);
+      index result;
+      for(unsigned int d = Rank; d > 0u; --d) {
+        result[d - 1u] = (i % extent_[d - 1u]) + lobound_[d - 1u];
+        i /= extent_[d - 1u];
+      }
+      return result;
+    }
+
+  }; // class FixedRange
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_FIXED_RANGE_H__INCLUDED
@@ -0,0 +1,78 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fused_contract.h
+ *  May 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_FUSED_CONTRACT_H__INCLUDED
+#define TILEDARRAY_FUSED_CONTRACT_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/dist_eval/summa_bcast_cache.h>
+#include <TiledArray/expressions/expr_handle.h>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Contract one array with several arrays
+
+  /// Computes <tt>results[i](result_vars) = left(left_vars) *
+  /// rights[i](right_vars)</tt> for each of \c rights . The contractions are
+  /// evaluated concurrently, in the scope of a \c SummaBcastScope , so for
+  /// dense arrays the tiles of \c left are broadcast once, by the first
+  /// contraction, and reused by the others, and the function waits for all
+  /// of the results at once. This function is collective.
+  /// \tparam Tile The tile type
+  /// \tparam Policy The array policy type
+  /// \param left The left-hand argument of the contractions
+  /// \param left_vars The variable list of \c left
+  /// \param rights The right-hand arguments of the contractions
+  /// \param right_vars The variable list of \c rights
+  /// \param result_vars The variable list of the results
+  /// \return The results, in the order of \c rights
+  template <typename Tile, typename Policy>
+  inline std::vector<DistArray<Tile, Policy> >
+  fused_contract(const DistArray<Tile, Policy>& left,
+      const std::string& left_vars,
+      const std::vector<DistArray<Tile, Policy> >& rights,
+      const std::string& right_vars, const std::string& result_vars)
+  {
+    typedef DistArray<Tile, Policy> array_type;
+
+    std::vector<array_type> results(rights.size());
+    {
+      SummaBcastScope scope;
+
+      std::vector<expressions::ExprHandle<array_type> > handles;
+      handles.reserve(rights.size());
+      for(std::size_t i = 0ul; i < rights.size(); ++i)
+        handles.push_back(results[i](result_vars).assign_async(
+            left(left_vars) * rights[i](right_vars)));
+
+      for(auto& handle : handles)
+        handle.wait();
+    }
+
+    return results;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_FUSED_CONTRACT_H__INCLUDED
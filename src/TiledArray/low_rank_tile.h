@@ -0,0 +1,650 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  low_rank_tile.h
+ *  Feb 28, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_LOW_RANK_TILE_H__INCLUDED
+#define TILEDARRAY_LOW_RANK_TILE_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/math/eigen.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/memory_usage.h>
+#include <TiledArray/tensor.h>
+
+#pragma GCC diagnostic push
+#pragma GCC system_header
+#include <Eigen/SVD>
+#pragma GCC diagnostic pop
+
+#include <cstdlib>
+#include <memory>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The default truncation tolerance of low-rank tiles
+
+    /// The tolerance is read from the \c TA_LOW_RANK_TOLERANCE environment
+    /// variable; the default tolerance is 1e-8.
+    /// \return The default truncation tolerance
+    inline double low_rank_tolerance() {
+      static const double tolerance = [] () -> double {
+        const char* tolerance = getenv("TA_LOW_RANK_TOLERANCE");
+        if(tolerance)
+          return std::strtod(tolerance, nullptr);
+        return 1.0e-8;
+      }();
+      return tolerance;
+    }
+
+    /// The number of singular values that are kept by a truncation
+
+    /// The trailing singular values are dropped as long as the Frobenius
+    /// norm of the dropped values does not exceed \c tolerance .
+    /// \tparam S The singular value vector type
+    /// \param s The singular values, in decreasing order
+    /// \param tolerance The absolute truncation tolerance
+    /// \return The truncated rank
+    template <typename S>
+    inline Eigen::Index low_rank_truncate(const S& s, const double tolerance) {
+      const double tolerance2 = tolerance * tolerance;
+      double dropped = 0.0;
+      Eigen::Index rank = s.size();
+      while(rank > 0) {
+        const double value = s[rank - 1];
+        if(dropped + value * value > tolerance2)
+          break;
+        dropped += value * value;
+        --rank;
+      }
+      return rank;
+    }
+
+    /// Factor a dense matrix
+
+    /// \c a is factored as \f$ U V^T \f$ with a truncated singular value
+    /// decomposition; the singular values are absorbed by \c u .
+    /// \tparam Matrix The Eigen matrix type of the factors
+    /// \tparam A The Eigen expression type of the dense matrix
+    /// \param a The dense matrix
+    /// \param tolerance The absolute truncation tolerance
+    /// \param[out] u The left factor
+    /// \param[out] v The right factor
+    template <typename Matrix, typename A>
+    inline void low_rank_compress(const A& a, const double tolerance,
+        Matrix& u, Matrix& v)
+    {
+      Eigen::JacobiSVD<Matrix> svd(a, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      const Eigen::Index rank = low_rank_truncate(svd.singularValues(), tolerance);
+      u = svd.matrixU().leftCols(rank) * svd.singularValues().head(rank).asDiagonal();
+      v = svd.matrixV().leftCols(rank).conjugate();
+    }
+
+    /// Reduce the rank of a factored matrix
+
+    /// \f$ U V^T \f$ is recompressed in place with the QR decompositions of
+    /// the factors, \f$ U = Q_u R_u \f$ and \f$ V = Q_v R_v \f$ , followed by
+    /// a truncated singular value decomposition of \f$ R_u R_v^T \f$ , so the
+    /// cost is linear in the tile dimensions.
+    /// \tparam Matrix The Eigen matrix type of the factors
+    /// \param[in,out] u The left factor
+    /// \param[in,out] v The right factor
+    /// \param tolerance The absolute truncation tolerance
+    template <typename Matrix>
+    inline void low_rank_recompress(Matrix& u, Matrix& v, const double tolerance) {
+      TA_ASSERT(u.cols() == v.cols());
+      if(u.cols() == 0)
+        return;
+
+      const Eigen::Index ku = std::min(u.rows(), u.cols());
+      const Eigen::Index kv = std::min(v.rows(), v.cols());
+      Eigen::HouseholderQR<Matrix> qr_u(u);
+      Eigen::HouseholderQR<Matrix> qr_v(v);
+      const Matrix r_u = qr_u.matrixQR().topRows(ku).template triangularView<Eigen::Upper>();
+      const Matrix r_v = qr_v.matrixQR().topRows(kv).template triangularView<Eigen::Upper>();
+
+      Eigen::JacobiSVD<Matrix> svd(r_u * r_v.transpose(),
+          Eigen::ComputeThinU | Eigen::ComputeThinV);
+      const Eigen::Index rank = low_rank_truncate(svd.singularValues(), tolerance);
+      const Matrix q_u = qr_u.householderQ() * Matrix::Identity(u.rows(), ku);
+      const Matrix q_v = qr_v.householderQ() * Matrix::Identity(v.rows(), kv);
+      u = q_u * (svd.matrixU().leftCols(rank) *
+          svd.singularValues().head(rank).asDiagonal());
+      v = q_v * svd.matrixV().leftCols(rank).conjugate();
+    }
+
+    /// Squared Frobenius norm of a factored matrix
+
+    /// \tparam Matrix The Eigen matrix type of the factors
+    /// \param u The left factor
+    /// \param v The right factor
+    /// \return The squared Frobenius norm of \f$ U V^T \f$
+    template <typename Matrix>
+    inline double low_rank_squared_norm(const Matrix& u, const Matrix& v) {
+      if(u.cols() == 0)
+        return 0.0;
+      const Matrix g = u.adjoint() * u;
+      const Matrix h = v.adjoint() * v;
+      return std::real(g.cwiseProduct(h).sum());
+    }
+
+  }  // namespace detail
+
+  /// A tile that holds a low-rank matrix in factored form
+
+  /// The tile is a rank-2 tensor \f$ A = U V^T \f$ , where \c U is an
+  /// \f$ m \times r \f$ matrix and \c V is an \f$ n \times r \f$ matrix.
+  /// The rank \f$ r \f$ is adapted to the data: dense matrices, sums, and
+  /// products are truncated so that the Frobenius norm of the error of each
+  /// operation does not exceed the truncation tolerance of the tile. The
+  /// arithmetic of the tile interface keeps the factored form: permutation
+  /// swaps the factors, addition concatenates and recompresses them, and
+  /// contraction multiplies the inner factors only. Only matrix contractions,
+  /// with one contracted and one outer index on each side, are supported.
+  /// Copies are shallow; see \c clone() for deep copies.
+  /// \tparam T The element type
+  template <typename T>
+  class LowRankTile {
+  public:
+    typedef LowRankTile<T> LowRankTile_; ///< This object type
+    typedef Range range_type; ///< Tensor range type
+    typedef T value_type; ///< Element type
+    typedef T numeric_type; ///< The scalar type that is compatible with value_type
+    typedef std::size_t size_type; ///< Size type
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrix_type; ///< Factor type
+
+  private:
+
+    /// The tile data
+    struct Impl {
+      range_type range_; ///< The tile range
+      matrix_type u_; ///< The left factor
+      matrix_type v_; ///< The right factor
+      double tolerance_; ///< The truncation tolerance
+    }; // struct Impl
+
+    std::shared_ptr<Impl> pimpl_; ///< The tile data
+
+    /// The tolerance of a result of this tile and \c other
+    double tolerance(const LowRankTile_& other) const {
+      return std::max(pimpl_->tolerance_, other.pimpl_->tolerance_);
+    }
+
+    /// Construct a tile with the factors of the transpose of this tile
+
+    /// \param perm The permutation of the tile range
+    LowRankTile_ transpose(const Permutation& perm) const {
+      TA_ASSERT(perm.dim() == 2u);
+      if(perm[0] == 0u)
+        return *this;
+      return LowRankTile_(perm * pimpl_->range_, pimpl_->v_, pimpl_->u_,
+          pimpl_->tolerance_);
+    }
+
+    /// Sum of this tile and a scaled tile
+
+    /// \param other The tile to be added
+    /// \param factor The scaling factor of \c other
+    /// \return A tile that is equal to <tt>(*this) + factor * other</tt>
+    LowRankTile_ axpy(const LowRankTile_& other, const numeric_type factor) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! other.empty());
+      TA_ASSERT(pimpl_->range_ == other.pimpl_->range_);
+      const Eigen::Index r1 = rank();
+      const Eigen::Index r2 = other.rank();
+      matrix_type u(pimpl_->u_.rows(), r1 + r2);
+      matrix_type v(pimpl_->v_.rows(), r1 + r2);
+      u << pimpl_->u_, other.pimpl_->u_ * factor;
+      v << pimpl_->v_, other.pimpl_->v_;
+      const double tolerance = this->tolerance(other);
+      detail::low_rank_recompress(u, v, tolerance);
+      return LowRankTile_(pimpl_->range_, std::move(u), std::move(v), tolerance);
+    }
+
+    /// The factors of a contraction argument
+
+    /// \param op The operation that is applied to the argument
+    /// \param[out] u The left factor of the argument after \c op
+    /// \param[out] v The right factor of the argument after \c op
+    void gemm_factors(const madness::cblas::CBLAS_TRANSPOSE op,
+        matrix_type& u, matrix_type& v) const
+    {
+      switch(op) {
+        case madness::cblas::NoTrans:
+          u = pimpl_->u_;
+          v = pimpl_->v_;
+          break;
+        case madness::cblas::Trans:
+          u = pimpl_->v_;
+          v = pimpl_->u_;
+          break;
+        case madness::cblas::ConjTrans:
+          u = pimpl_->v_.conjugate();
+          v = pimpl_->u_.conjugate();
+          break;
+      }
+    }
+
+  public:
+
+    /// Construct an empty tile
+    LowRankTile() = default;
+
+    /// Construct a tile from its factors
+
+    /// \param range The range of the tile
+    /// \param u The \f$ m \times r \f$ left factor
+    /// \param v The \f$ n \times r \f$ right factor
+    /// \param tolerance The truncation tolerance of the tile
+    LowRankTile(const range_type& range, matrix_type u, matrix_type v,
+        const double tolerance = detail::low_rank_tolerance()) :
+      pimpl_(std::make_shared<Impl>(Impl{ range, std::move(u), std::move(v),
+          tolerance }))
+    {
+      TA_ASSERT(range.rank() == 2u);
+      TA_ASSERT(pimpl_->u_.rows() == Eigen::Index(range.extent_data()[0]));
+      TA_ASSERT(pimpl_->v_.rows() == Eigen::Index(range.extent_data()[1]));
+      TA_ASSERT(pimpl_->u_.cols() == pimpl_->v_.cols());
+    }
+
+    /// Construct a zero tile
+
+    /// \param range The range of the tile
+    /// \param tolerance The truncation tolerance of the tile
+    explicit LowRankTile(const range_type& range,
+        const double tolerance = detail::low_rank_tolerance()) :
+      LowRankTile(range, matrix_type(range.extent_data()[0], 0),
+          matrix_type(range.extent_data()[1], 0), tolerance)
+    { }
+
+    /// Compress a dense tile
+
+    /// \tparam A The allocator type of the tensor
+    /// \param tensor The rank-2 tensor to be compressed
+    /// \param tolerance The truncation tolerance of the tile
+    template <typename A>
+    explicit LowRankTile(const Tensor<T, A>& tensor,
+        const double tolerance = detail::low_rank_tolerance()) :
+      pimpl_()
+    {
+      TA_ASSERT(! tensor.empty());
+      TA_ASSERT(tensor.range().rank() == 2u);
+      matrix_type u, v;
+      detail::low_rank_compress(math::eigen_map(tensor.data(),
+          tensor.range().extent_data()[0], tensor.range().extent_data()[1]),
+          tolerance, u, v);
+      pimpl_ = std::make_shared<Impl>(Impl{ tensor.range(), std::move(u),
+          std::move(v), tolerance });
+    }
+
+    LowRankTile(const LowRankTile_&) = default;
+    LowRankTile(LowRankTile_&&) = default;
+    LowRankTile_& operator=(const LowRankTile_&) = default;
+    LowRankTile_& operator=(LowRankTile_&&) = default;
+
+    /// Deep copy
+
+    /// \return A copy of this tile that does not share data with this tile
+    LowRankTile_ clone() const {
+      if(empty())
+        return LowRankTile_();
+      return LowRankTile_(pimpl_->range_, pimpl_->u_, pimpl_->v_,
+          pimpl_->tolerance_);
+    }
+
+    /// Expand this tile to a dense tensor
+
+    /// \return A tensor that holds \f$ U V^T \f$
+    explicit operator Tensor<T>() const {
+      TA_ASSERT(! empty());
+      Tensor<T> result(pimpl_->range_);
+      math::eigen_map(result.data(), pimpl_->u_.rows(), pimpl_->v_.rows()) =
+          pimpl_->u_ * pimpl_->v_.transpose();
+      return result;
+    }
+
+    /// \return \c true if this tile is not initialized
+    bool empty() const { return ! pimpl_; }
+
+    /// \return The range of this tile
+    const range_type& range() const {
+      TA_ASSERT(! empty());
+      return pimpl_->range_;
+    }
+
+    /// \return The number of elements of the dense tile
+    size_type size() const { return range().volume(); }
+
+    /// \return The rank of the factorization
+    size_type rank() const {
+      TA_ASSERT(! empty());
+      return pimpl_->u_.cols();
+    }
+
+    /// \return The left factor
+    const matrix_type& u() const {
+      TA_ASSERT(! empty());
+      return pimpl_->u_;
+    }
+
+    /// \return The right factor
+    const matrix_type& v() const {
+      TA_ASSERT(! empty());
+      return pimpl_->v_;
+    }
+
+    /// \return The truncation tolerance of this tile
+    double tolerance() const {
+      TA_ASSERT(! empty());
+      return pimpl_->tolerance_;
+    }
+
+    /// Serialize the tile
+
+    /// \tparam Archive The output archive type
+    /// \param ar The output archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      const bool have_pimpl = ! empty();
+      ar & have_pimpl;
+      if(have_pimpl) {
+        const std::size_t rank = this->rank();
+        ar & pimpl_->range_ & pimpl_->tolerance_ & rank
+           & madness::archive::wrap(pimpl_->u_.data(), pimpl_->u_.size())
+           & madness::archive::wrap(pimpl_->v_.data(), pimpl_->v_.size());
+      }
+    }
+
+    /// Deserialize the tile
+
+    /// \tparam Archive The input archive type
+    /// \param ar The input archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      bool have_pimpl = false;
+      ar & have_pimpl;
+      if(have_pimpl) {
+        range_type range;
+        double tolerance = 0.0;
+        std::size_t rank = 0ul;
+        ar & range & tolerance & rank;
+        matrix_type u(range.extent_data()[0], rank);
+        matrix_type v(range.extent_data()[1], rank);
+        ar & madness::archive::wrap(u.data(), u.size())
+           & madness::archive::wrap(v.data(), v.size());
+        pimpl_ = std::make_shared<Impl>(Impl{ std::move(range), std::move(u),
+            std::move(v), tolerance });
+      } else {
+        pimpl_.reset();
+      }
+    }
+
+    // Permutation operations ------------------------------------------------
+
+    /// \param perm The permutation
+    /// \return A permuted copy of this tile; the factors are shared
+    LowRankTile_ permute(const Permutation& perm) const {
+      TA_ASSERT(! empty());
+      return transpose(perm);
+    }
+
+    // Addition operations ---------------------------------------------------
+
+    LowRankTile_ add(const LowRankTile_& right) const {
+      return axpy(right, numeric_type(1));
+    }
+
+    LowRankTile_ add(const LowRankTile_& right, const Permutation& perm) const {
+      return add(right).transpose(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_ add(const LowRankTile_& right, const Scalar factor) const {
+      return add(right).scale(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_ add(const LowRankTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return add(right).scale(factor, perm);
+    }
+
+    LowRankTile_& add_to(const LowRankTile_& right) {
+      *pimpl_ = *axpy(right, numeric_type(1)).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_& add_to(const LowRankTile_& right, const Scalar factor) {
+      return add_to(right).scale_to(factor);
+    }
+
+    // Subtraction operations ------------------------------------------------
+
+    LowRankTile_ subt(const LowRankTile_& right) const {
+      return axpy(right, numeric_type(-1));
+    }
+
+    LowRankTile_ subt(const LowRankTile_& right, const Permutation& perm) const {
+      return subt(right).transpose(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_ subt(const LowRankTile_& right, const Scalar factor) const {
+      return subt(right).scale(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_ subt(const LowRankTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return subt(right).scale(factor, perm);
+    }
+
+    LowRankTile_& subt_to(const LowRankTile_& right) {
+      *pimpl_ = *axpy(right, numeric_type(-1)).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_& subt_to(const LowRankTile_& right, const Scalar factor) {
+      return subt_to(right).scale_to(factor);
+    }
+
+    // Scaling operations ----------------------------------------------------
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_ scale(const Scalar factor) const {
+      TA_ASSERT(! empty());
+      return LowRankTile_(pimpl_->range_, pimpl_->u_ * numeric_type(factor),
+          pimpl_->v_, pimpl_->tolerance_);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_ scale(const Scalar factor, const Permutation& perm) const {
+      return scale(factor).transpose(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    LowRankTile_& scale_to(const Scalar factor) {
+      TA_ASSERT(! empty());
+      pimpl_->u_ *= numeric_type(factor);
+      return *this;
+    }
+
+    LowRankTile_ neg() const { return scale(numeric_type(-1)); }
+
+    LowRankTile_ neg(const Permutation& perm) const {
+      return scale(numeric_type(-1), perm);
+    }
+
+    LowRankTile_& neg_to() { return scale_to(numeric_type(-1)); }
+
+    // Contraction operations ------------------------------------------------
+
+    /// Contract this tile with \c right
+
+    /// The product \f$ U_1 (V_1^T U_2) V_2^T \f$ is formed without expanding
+    /// either tile, and the rank of the result is the smaller of the ranks
+    /// of the arguments.
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of the product
+    /// \param gemm_helper The contraction plan
+    /// \return The scaled product of this tile and \c right
+    /// \throw TiledArray::Exception When the contraction is not a matrix
+    /// product
+    LowRankTile_ gemm(const LowRankTile_& right, const numeric_type factor,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_USER_ASSERT((gemm_helper.result_rank() == 2u) &&
+          (gemm_helper.left_rank() == 2u) && (gemm_helper.right_rank() == 2u),
+          "LowRankTile::gemm(): only matrix products are supported.");
+
+      matrix_type u1, v1, u2, v2;
+      gemm_factors(gemm_helper.left_op(), u1, v1);
+      right.gemm_factors(gemm_helper.right_op(), u2, v2);
+      TA_ASSERT(v1.rows() == u2.rows());
+
+      const matrix_type core = v1.transpose() * u2;
+      const range_type range =
+          gemm_helper.make_result_range<range_type>(pimpl_->range_, right.range());
+      if(u1.cols() <= u2.cols())
+        return LowRankTile_(range, u1 * factor, v2 * core.transpose(),
+            tolerance(right));
+      return LowRankTile_(range, (u1 * core) * factor, std::move(v2),
+          tolerance(right));
+    }
+
+    /// Contract \c left and \c right and add the product to this tile
+
+    /// \param left The left-hand argument
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of the product
+    /// \param gemm_helper The contraction plan
+    /// \return A reference to this tile
+    LowRankTile_& gemm(const LowRankTile_& left, const LowRankTile_& right,
+        const numeric_type factor, const math::GemmHelper& gemm_helper)
+    {
+      LowRankTile_ product = left.gemm(right, factor, gemm_helper);
+      if(empty())
+        pimpl_ = product.pimpl_;
+      else
+        add_to(product);
+      return *this;
+    }
+
+    // Reduction operations --------------------------------------------------
+
+    /// \return The sum of the elements of this tile
+    numeric_type sum() const {
+      TA_ASSERT(! empty());
+      if(rank() == 0ul)
+        return numeric_type(0);
+      return (pimpl_->u_.colwise().sum() * pimpl_->v_.colwise().sum().transpose())(0, 0);
+    }
+
+    /// \return The squared Frobenius norm of this tile
+    double squared_norm() const {
+      TA_ASSERT(! empty());
+      return detail::low_rank_squared_norm(pimpl_->u_, pimpl_->v_);
+    }
+
+    /// \return The Frobenius norm of this tile
+    double norm() const { return std::sqrt(squared_norm()); }
+
+  }; // class LowRankTile
+
+  /// Memory footprint of a low-rank tile
+
+  /// This overload is found by argument-dependent lookup, so it does not
+  /// need to be declared before the containers that count tiles.
+  /// \tparam T The element type
+  /// \param tile The tile
+  /// \return The size of the factors of \c tile in bytes
+  template <typename T>
+  inline std::size_t tile_bytes(const LowRankTile<T>& tile) {
+    return (tile.empty() ? 0ul : tile.rank() * (tile.u().rows() +
+        tile.v().rows()) * sizeof(T));
+  }
+
+  /// Storage cost of the local tiles of a low-rank array
+
+  /// The cost of a non-zero local tile is the number of elements of its
+  /// factors, \f$ r (m + n) \f$ , which is also proportional to the flops of
+  /// the additions and contractions of the tile; the other tiles cost
+  /// nothing. The costs may be given to \c balanced_pmap() to balance the
+  /// array by the ranks of its tiles. The local tiles must be set; this
+  /// function waits for them.
+  /// \tparam T The element type of the tiles
+  /// \tparam Policy The array policy type
+  /// \param array The array
+  /// \return The cost of each tile of \c array , indexed by the tile ordinal
+  template <typename T, typename Policy>
+  inline std::vector<double>
+  low_rank_costs(const DistArray<LowRankTile<T>, Policy>& array) {
+    std::vector<double> costs(array.size(), 0.0);
+    for(const std::size_t i : *array.pmap()) {
+      if(array.is_zero(i))
+        continue;
+      const LowRankTile<T> tile = array.find(i).get();
+      costs[i] = tile.rank() * (tile.u().rows() + tile.v().rows());
+    }
+    return costs;
+  }
+
+  /// Ranks of the tiles of a low-rank array
+
+  /// The local ranks are combined across all processes, so every process
+  /// holds the rank of every tile; zero tiles have rank zero. The local
+  /// tiles must be set; this function waits for them. This function is
+  /// collective.
+  /// \tparam T The element type of the tiles
+  /// \tparam Policy The array policy type
+  /// \param array The array
+  /// \return The rank of each tile of \c array , indexed by the tile ordinal
+  template <typename T, typename Policy>
+  inline std::vector<unsigned long>
+  low_rank_ranks(const DistArray<LowRankTile<T>, Policy>& array) {
+    std::vector<unsigned long> ranks(array.size(), 0ul);
+    for(const std::size_t i : *array.pmap())
+      if(! array.is_zero(i))
+        ranks[i] = array.find(i).get().rank();
+    array.world().gop.sum(ranks.data(), ranks.size());
+    return ranks;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_LOW_RANK_TILE_H__INCLUDED
@@ -31,7 +31,13 @@
 #include <madness/world/MADworld.h>
 #include <madness/tensor/cblas.h>
 #pragma GCC diagnostic pop
+#include <TiledArray/comm_progress.h>
+#include <TiledArray/comm_stats.h>
 #include <TiledArray/error.h>
+#include <TiledArray/dist_eval/lazy_tile_cache.h>
+#include <TiledArray/dist_eval/summa_bcast_cache.h>
+#include <TiledArray/expressions/expr_cache.h>
+#include <TiledArray/task_trace.h>
 
 namespace TiledArray {
 // Import some MADNESS classes into TiledArray for convenience.
@@ -125,6 +131,7 @@ namespace TiledArray {
   inline World& initialize(int& argc, char**& argv, const SafeMPI::Intracomm& comm) {
     auto& default_world = madness::initialize(argc, argv, comm);
     TiledArray::set_default_world(default_world);
+    TiledArray::detail::comm_progress_initialize(default_world);
     return default_world;
   }
 
@@ -137,6 +144,11 @@ namespace TiledArray {
   }
 
   inline void finalize() {
+    TiledArray::detail::task_trace_finalize(TiledArray::get_default_world());
+    TiledArray::clear_expression_cache();
+    TiledArray::clear_lazy_tile_cache();
+    TiledArray::clear_summa_bcast_cache();
+    TiledArray::comm_progress_stop();
     madness::finalize();
     TiledArray::reset_default_world();
   }
@@ -0,0 +1,244 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  mapped_array.h
+ *  Feb 17, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MAPPED_ARRAY_H__INCLUDED
+#define TILEDARRAY_MAPPED_ARRAY_H__INCLUDED
+
+#include <TiledArray/checkpoint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Mapped array file magic number, "TAMAPPD" followed by a zero byte
+    inline const char* mapped_array_magic() { return "TAMAPPD"; }
+
+    /// The alignment of tile data in a mapped array file
+    constexpr std::uint64_t mapped_array_alignment = 64ul;
+
+    /// Round \c offset up to the tile data alignment
+    inline std::uint64_t mapped_array_align(const std::uint64_t offset) {
+      return (offset + mapped_array_alignment - 1ul) & ~(mapped_array_alignment - 1ul);
+    }
+
+    /// A private, copy-on-write memory mapping of a file
+
+    /// Pages of the file are read on first access, and they are only copied
+    /// to anonymous memory if they are modified; the file is never modified.
+    class MappedFile {
+      unsigned char* data_; ///< The mapped data
+      std::size_t size_; ///< The size of the mapped data
+
+    public:
+
+      /// Map a file
+
+      /// \param path The path of the file
+      /// \throw TiledArray::Exception When the file cannot be mapped
+      explicit MappedFile(const std::string& path) : data_(nullptr), size_(0ul) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+          TA_EXCEPTION("Unable to open mapped array file.");
+
+        struct stat status;
+        if(::fstat(fd, & status) != 0) {
+          ::close(fd);
+          TA_EXCEPTION("Unable to open mapped array file.");
+        }
+
+        size_ = status.st_size;
+        void* const data = (size_ ? ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE, fd, 0) : MAP_FAILED);
+        ::close(fd);
+        if(data == MAP_FAILED)
+          TA_EXCEPTION("Unable to map mapped array file.");
+        data_ = static_cast<unsigned char*>(data);
+      }
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      ~MappedFile() { ::munmap(data_, size_); }
+
+      /// \return A pointer to the mapped data
+      unsigned char* data() const { return data_; }
+
+      /// \return The size of the mapped data in bytes
+      std::size_t size() const { return size_; }
+
+    }; // class MappedFile
+
+  }  // namespace detail
+
+  /// Write an array to a file that can be memory mapped
+
+  /// The file holds a header with the tiled range, the shape, and a tile
+  /// table, followed by the raw data of the non-zero tiles, aligned to 64
+  /// bytes. The tiles are gathered and written by rank 0, so this is intended
+  /// for preparing input data. This function is collective.
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Policy The array policy type
+  /// \param array The array to be written
+  /// \param path The path of the file
+  /// \throw TiledArray::Exception When the file cannot be written
+  template <typename T, typename A, typename Policy>
+  void save_mapped_array(const DistArray<Tensor<T, A>, Policy>& array,
+      const std::string& path)
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "Mapped arrays must have trivially copyable elements.");
+    World& world = array.world();
+
+    if(world.rank() == 0) {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      if(! file)
+        TA_EXCEPTION("Unable to open mapped array file.");
+
+      file.write(detail::mapped_array_magic(), 8);
+      detail::checkpoint_write(file, detail::checkpoint_version);
+      detail::checkpoint_write(file, Policy::shape_type::is_dense() ? 0ul : 1ul);
+      detail::checkpoint_write(file, sizeof(T));
+      detail::checkpoint_write(file, array.trange());
+      detail::checkpoint_write(file, array.shape(), array.trange());
+
+      // Write the ordinal and data offset of each non-zero tile
+      std::vector<std::uint64_t> tiles;
+      for(std::size_t i = 0ul; i < array.size(); ++i)
+        if(! array.is_zero(i))
+          tiles.push_back(i);
+      detail::checkpoint_write(file, tiles.size());
+      std::uint64_t offset = 0ul;
+      for(const std::uint64_t i : tiles) {
+        detail::checkpoint_write(file, i);
+        detail::checkpoint_write(file, offset);
+        offset = detail::mapped_array_align(offset +
+            array.trange().make_tile_range(i).volume() * sizeof(T));
+      }
+
+      // Write the tile data
+      const std::vector<char> padding(detail::mapped_array_alignment, 0);
+      std::uint64_t position = file.tellp();
+      for(const std::uint64_t i : tiles) {
+        file.write(padding.data(), detail::mapped_array_align(position) - position);
+        const Tensor<T, A> tile = array.find(i).get();
+        TA_ASSERT(tile.range() == array.trange().make_tile_range(i));
+        file.write(reinterpret_cast<const char*>(tile.data()),
+            tile.size() * sizeof(T));
+        position = detail::mapped_array_align(position) + tile.size() * sizeof(T);
+      }
+      file.close();
+      if(! file)
+        TA_EXCEPTION("Unable to write mapped array file.");
+    }
+
+    world.gop.fence();
+  }
+
+  /// Read an array from a memory mapped file
+
+  /// The file, written by \c save_mapped_array() , is mapped by each process
+  /// and the local tiles are views of the mapped data, so the array does not
+  /// allocate memory for its tiles, and pages are read from the file on first
+  /// access. The mapping is private: tiles may be modified in place without
+  /// modifying the file. The file is unmapped once the array and all copies
+  /// of its tiles are destroyed. The file must be visible to all processes,
+  /// and the array may be read with any number of processes and any process
+  /// map.
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Policy The array policy type
+  /// \param[out] array The array that will hold the mapped tiles
+  /// \param world The world of the array
+  /// \param path The path of the file
+  /// \param pmap The process map of the array; the default process map is
+  /// used when it is null
+  /// \throw TiledArray::Exception When the file is not valid, or it was
+  /// written with a different policy or element type.
+  template <typename T, typename A, typename Policy>
+  void load_mapped_array(DistArray<Tensor<T, A>, Policy>& array, World& world,
+      const std::string& path,
+      const std::shared_ptr<typename DistArray<Tensor<T, A>, Policy>::pmap_interface>& pmap =
+          std::shared_ptr<typename DistArray<Tensor<T, A>, Policy>::pmap_interface>())
+  {
+    typedef DistArray<Tensor<T, A>, Policy> array_type;
+    typedef typename array_type::shape_type shape_type;
+
+    // Read the header
+    std::ifstream file(path, std::ios::binary);
+    if(! file)
+      TA_EXCEPTION("Unable to open mapped array file.");
+    char magic[8];
+    file.read(magic, 8);
+    if((! file) || (std::memcmp(magic, detail::mapped_array_magic(), 8) != 0))
+      TA_EXCEPTION("Invalid mapped array file.");
+    if(detail::checkpoint_read(file) != detail::checkpoint_version)
+      TA_EXCEPTION("Unsupported mapped array file version.");
+    if(detail::checkpoint_read(file) != (shape_type::is_dense() ? 0ul : 1ul))
+      TA_EXCEPTION("The mapped array was written with a different array policy.");
+    if(detail::checkpoint_read(file) != sizeof(T))
+      TA_EXCEPTION("The mapped array was written with a different element type.");
+    const TiledRange trange = detail::checkpoint_read_trange(file);
+    const shape_type shape = detail::checkpoint_read_shape(world, file, trange,
+        static_cast<const shape_type*>(nullptr));
+    std::vector<std::uint64_t> tiles(2ul * detail::checkpoint_read(file));
+    for(std::uint64_t& value : tiles)
+      value = detail::checkpoint_read(file);
+    const std::uint64_t base = detail::mapped_array_align(file.tellg());
+    file.close();
+
+    array_type result(world, trange, shape, pmap);
+    std::shared_ptr<detail::MappedFile> mapped =
+        std::make_shared<detail::MappedFile>(path);
+
+    // Construct the local tiles as views of the mapped file
+    std::vector<bool> found(trange.tiles_range().volume(), false);
+    for(std::size_t t = 0ul; t < tiles.size(); t += 2ul) {
+      const std::uint64_t i = tiles[t];
+      if(i >= found.size())
+        TA_EXCEPTION("Invalid mapped array file.");
+      if((! result.is_local(i)) || result.is_zero(i))
+        continue;
+
+      const Range range = trange.make_tile_range(i);
+      const std::uint64_t offset = base + tiles[t + 1ul];
+      if(offset + range.volume() * sizeof(T) > mapped->size())
+        TA_EXCEPTION("Unexpected end of mapped array file.");
+      result.set(i, Tensor<T, A>(range,
+          reinterpret_cast<T*>(mapped->data() + offset), mapped));
+      found[i] = true;
+    }
+
+    // Check that all local tiles were found
+    for(auto it = result.pmap()->begin(); it != result.pmap()->end(); ++it)
+      if((! result.is_zero(*it)) && (! found[*it]))
+        TA_EXCEPTION("The mapped array file does not contain all non-zero tiles.");
+
+    array = result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MAPPED_ARRAY_H__INCLUDED
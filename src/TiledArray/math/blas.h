@@ -29,6 +29,7 @@
 #include <madness/tensor/cblas.h>
 #include <TiledArray/type_traits.h>
 #include <TiledArray/math/eigen.h>
+#include <TiledArray/math/blas_threads.h>
 
 namespace TiledArray {
   namespace math {
@@ -134,6 +135,7 @@ namespace TiledArray {
         const integer k, const float alpha, const float* a, const integer lda,
         const float* b, const integer ldb, const float beta, float* c, const integer ldc)
     {
+      BlasThreadScope threads(m, n, k);
       madness::cblas::gemm(op_b, op_a, n, m, k, alpha, b, ldb, a, lda, beta, c, ldc);
     }
 
@@ -142,6 +144,7 @@ namespace TiledArray {
         const integer k, const double alpha, const double* a, const integer lda,
         const double* b, const integer ldb, const double beta, double* c, const integer ldc)
     {
+      BlasThreadScope threads(m, n, k);
       madness::cblas::gemm(op_b, op_a, n, m, k, alpha, b, ldb, a, lda, beta, c, ldc);
     }
 
@@ -151,6 +154,7 @@ namespace TiledArray {
         const integer lda, const std::complex<float>* b, const integer ldb,
         const std::complex<float> beta, std::complex<float>* c, const integer ldc)
     {
+      BlasThreadScope threads(m, n, k);
       madness::cblas::gemm(op_b, op_a, n, m, k, alpha, b, ldb, a, lda, beta, c, ldc);
     }
 
@@ -160,6 +164,7 @@ namespace TiledArray {
         const integer lda, const std::complex<double>* b, const integer ldb,
         const std::complex<double> beta, std::complex<double>* c, const integer ldc)
     {
+      BlasThreadScope threads(m, n, k);
       madness::cblas::gemm(op_b, op_a, n, m, k, alpha, b, ldb, a, lda, beta, c, ldc);
     }
 
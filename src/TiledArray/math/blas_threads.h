@@ -0,0 +1,188 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  blas_threads.h
+ *  May 8, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_BLAS_THREADS_H__INCLUDED
+#define TILEDARRAY_MATH_BLAS_THREADS_H__INCLUDED
+
+#include <TiledArray/config.h>
+#include <madness/madness_config.h>
+#include <madness/world/thread.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#ifdef HAVE_INTEL_MKL
+#include <mkl_service.h>
+#elif defined(TILEDARRAY_HAS_OPENBLAS_LOCAL_THREADS)
+extern "C" int openblas_set_num_threads_local(int num_threads);
+#endif
+
+namespace TiledArray {
+  namespace math {
+
+    /// Check that the number of BLAS threads can be set for each call
+
+    /// \return \c true if the BLAS is MKL, or OpenBLAS with
+    /// \c openblas_set_num_threads_local()
+    constexpr bool has_blas_local_threads() {
+#if defined(HAVE_INTEL_MKL) || defined(TILEDARRAY_HAS_OPENBLAS_LOCAL_THREADS)
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    /// The largest number of threads of a BLAS call
+
+    /// The number of threads of each *GEMM call is selected at run time, so
+    /// that the many small tile contractions of a node are single-threaded,
+    /// while a large contraction uses the workers that are idle. It is read
+    /// from the \c TA_BLAS_THREADS environment variable; a value of zero
+    /// leaves the BLAS threading as configured by the BLAS library. The
+    /// default is the number of MADNESS threads, including the main thread.
+    /// It is zero when the BLAS library does not support setting the number
+    /// of threads of a call (see \c has_blas_local_threads() ).
+    /// \return The largest number of BLAS threads
+    inline int blas_max_threads() {
+      static const int threads = [] () -> int {
+        if(! has_blas_local_threads())
+          return 0;
+        const char* max_threads = getenv("TA_BLAS_THREADS");
+        if(max_threads)
+          return std::atoi(max_threads);
+        return madness::ThreadPool::size() + 1;
+      }();
+      return threads;
+    }
+
+    /// The work of a BLAS thread
+
+    /// A *GEMM call uses one thread for each multiply-add count,
+    /// \f$ m n k \f$, of this size. It is read from the
+    /// \c TA_BLAS_THREAD_WORK environment variable; the default,
+    /// \f$ 2^{24} \f$, corresponds to 256 element wide matrices.
+    /// \return The number of multiply-adds of a BLAS thread
+    inline std::size_t blas_thread_work() {
+      static const std::size_t work = [] () -> std::size_t {
+        const char* thread_work = getenv("TA_BLAS_THREAD_WORK");
+        if(thread_work)
+          return std::max<std::size_t>(std::strtoul(thread_work, nullptr, 10), 1ul);
+        return 1ul << 24;
+      }();
+      return work;
+    }
+
+    namespace detail {
+
+      /// The number of threads that are used by BLAS calls
+
+      /// \return A reference to the number of threads of the BLAS calls
+      /// that are running
+      inline std::atomic<int>& blas_busy_threads() {
+        static std::atomic<int> threads(0);
+        return threads;
+      }
+
+      /// Set the number of BLAS threads of the calling thread
+
+      /// \param threads The number of threads of BLAS calls, or zero to
+      /// restore the global setting of the BLAS library
+      /// \return The previous number of threads of the calling thread
+      inline int set_blas_local_threads(const int threads) {
+#ifdef HAVE_INTEL_MKL
+        return mkl_set_num_threads_local(threads);
+#elif defined(TILEDARRAY_HAS_OPENBLAS_LOCAL_THREADS)
+        return openblas_set_num_threads_local(threads);
+#else
+        (void)threads;
+        return 0;
+#endif
+      }
+
+    } // namespace detail
+
+    /// Select the number of threads of a BLAS call
+
+    /// The number of threads is proportional to the work of the call, see
+    /// \c blas_thread_work() , and bounded by \c blas_max_threads() and by
+    /// the threads that are not used by other BLAS calls or, without TBB,
+    /// by queued MADNESS tasks. The setting is restored by the destructor.
+    class BlasThreadScope {
+      int threads_; ///< The number of threads of this call
+      int previous_; ///< The previous number of local threads
+
+    public:
+
+      BlasThreadScope(const BlasThreadScope&) = delete;
+      BlasThreadScope& operator=(const BlasThreadScope&) = delete;
+
+      /// Constructor
+
+      /// \param m The number of rows of the result
+      /// \param n The number of columns of the result
+      /// \param k The number of contracted elements
+      BlasThreadScope(const std::size_t m, const std::size_t n,
+          const std::size_t k) :
+        threads_(0), previous_(0)
+      {
+        const int max_threads = blas_max_threads();
+        if(max_threads <= 0)
+          return;
+
+        const std::size_t work = m * n * k / blas_thread_work();
+        int threads = int(std::min<std::size_t>(std::max<std::size_t>(work, 1ul),
+            std::size_t(max_threads)));
+        if(threads > 1) {
+#ifndef HAVE_INTEL_TBB
+          // Queued tasks will occupy the workers
+          if(madness::ThreadPool::queue_size() > 0)
+            threads = 1;
+#endif // HAVE_INTEL_TBB
+          const int busy = detail::blas_busy_threads().load();
+          threads = std::max(1, std::min(threads, max_threads - busy));
+        }
+
+        threads_ = threads;
+        detail::blas_busy_threads() += threads_;
+        previous_ = detail::set_blas_local_threads(threads_);
+      }
+
+      /// Destructor
+      ~BlasThreadScope() {
+        if(threads_) {
+          detail::set_blas_local_threads(previous_);
+          detail::blas_busy_threads() -= threads_;
+        }
+      }
+
+      /// Thread count accessor
+
+      /// \return The number of threads of the BLAS call, or zero if it is
+      /// selected by the BLAS library
+      int threads() const { return threads_; }
+
+    }; // class BlasThreadScope
+
+  }  // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_BLAS_THREADS_H__INCLUDED
@@ -0,0 +1,261 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  parallel_for.h
+ *  May 25, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_PARALLEL_FOR_H__INCLUDED
+#define TILEDARRAY_MATH_PARALLEL_FOR_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#ifdef HAVE_INTEL_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#endif // HAVE_INTEL_TBB
+
+namespace TiledArray {
+  namespace math {
+
+    /// The smallest number of iterations of a loop that is split among tasks
+
+    /// Loops over the tiles of a shape, e.g. of \c SparseShape , are split
+    /// into chunks of at least this many iterations, which are computed by
+    /// TBB workers. It is read from the \c TA_PARALLEL_GRAIN_SIZE
+    /// environment variable; the default is 16384. Loops are serial when TBB
+    /// is not available.
+    /// \return The grain size of parallel loops
+    inline std::size_t parallel_grain_size() {
+      static const std::size_t grain_size = [] () -> std::size_t {
+        const char* grain_size = getenv("TA_PARALLEL_GRAIN_SIZE");
+        if(grain_size)
+          return std::max<std::size_t>(std::strtoul(grain_size, nullptr, 10), 1ul);
+        return 16384ul;
+      }();
+      return grain_size;
+    }
+
+    /// Loop that may be split among tasks
+
+    /// The range <tt>[first, last)</tt> is partitioned into chunks of at
+    /// least \c grain iterations and \c op is called with the bounds of
+    /// each chunk. Chunks may be computed concurrently, so \c op may not
+    /// write to data that is shared between chunks.
+    /// \tparam Op The chunk operation type
+    /// \param first The first iteration
+    /// \param last The end of the iterations
+    /// \param grain The smallest number of iterations of a chunk
+    /// \param op The chunk operation, <tt>op(first, last)</tt>
+    template <typename Op>
+    inline void parallel_for(const std::size_t first, const std::size_t last,
+        const std::size_t grain, Op&& op)
+    {
+#ifdef HAVE_INTEL_TBB
+      if((last - first) >= (grain << 1)) {
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(first, last, grain),
+            [&op] (const tbb::blocked_range<std::size_t>& range) {
+              op(range.begin(), range.end());
+            }, tbb::auto_partitioner());
+        return;
+      }
+#endif // HAVE_INTEL_TBB
+      if(first < last)
+        op(first, last);
+    }
+
+    /// Counting loop that may be split among tasks
+
+    /// Like \c parallel_for() , except that \c op returns a count for each
+    /// chunk, e.g. the number of zero tiles, and the counts of the chunks
+    /// are summed. The counts are reduced without atomic operations.
+    /// \tparam Op The chunk operation type
+    /// \param first The first iteration
+    /// \param last The end of the iterations
+    /// \param grain The smallest number of iterations of a chunk
+    /// \param op The chunk operation, <tt>op(first, last)</tt>, which
+    /// returns the count of the chunk
+    /// \return The sum of the counts of the chunks
+    template <typename Op>
+    inline std::size_t parallel_count(const std::size_t first,
+        const std::size_t last, const std::size_t grain, Op&& op)
+    {
+#ifdef HAVE_INTEL_TBB
+      if((last - first) >= (grain << 1)) {
+        return tbb::parallel_reduce(
+            tbb::blocked_range<std::size_t>(first, last, grain), std::size_t(0),
+            [&op] (const tbb::blocked_range<std::size_t>& range,
+                const std::size_t count) -> std::size_t
+            { return count + op(range.begin(), range.end()); },
+            [] (const std::size_t left, const std::size_t right) -> std::size_t
+            { return left + right; }, tbb::auto_partitioner());
+      }
+#endif // HAVE_INTEL_TBB
+      return (first < last ? std::size_t(op(first, last)) : std::size_t(0));
+    }
+
+    /// The size of an element-wise tensor operation that is split among tasks
+
+    /// Element-wise operations on tiles of at least this many bytes, e.g.
+    /// the scaling or the sum of very large tiles, are split into chunks of
+    /// \c parallel_vector_chunk_bytes() that are computed by the idle
+    /// workers, so that a few large tiles use the memory bandwidth of the
+    /// node instead of one core. It is read from the
+    /// \c TA_PARALLEL_VECTOR_THRESHOLD environment variable; a value of zero
+    /// disables splitting. The default is 16 MiB.
+    /// \return The parallel element-wise operation threshold, in bytes
+    inline std::size_t parallel_vector_threshold() {
+      static const std::size_t threshold = [] () -> std::size_t {
+        const char* threshold = getenv("TA_PARALLEL_VECTOR_THRESHOLD");
+        if(threshold)
+          return std::strtoul(threshold, nullptr, 10);
+        return 16ul << 20;
+      }();
+      return threshold;
+    }
+
+    /// The size of the chunks of a split element-wise tensor operation
+
+    /// It is read from the \c TA_PARALLEL_VECTOR_CHUNK environment variable;
+    /// the default, 256 KiB, keeps the arguments and result of a chunk in
+    /// the L2 cache of a core.
+    /// \return The size of a chunk, in bytes
+    inline std::size_t parallel_vector_chunk_bytes() {
+      static const std::size_t chunk = [] () -> std::size_t {
+        const char* chunk = getenv("TA_PARALLEL_VECTOR_CHUNK");
+        if(chunk)
+          return std::max<std::size_t>(std::strtoul(chunk, nullptr, 10), 4096ul);
+        return 256ul << 10;
+      }();
+      return chunk;
+    }
+
+    namespace detail {
+
+      /// Chunks of a vector loop that are shared by the threads of the pool
+
+      /// Each thread claims chunks until none are left, so threads that
+      /// start late, or not at all, do not delay the loop.
+      class VectorChunks {
+        std::function<void(std::size_t, std::size_t)> op_; ///< The chunk operation
+        const std::size_t n_; ///< The number of iterations
+        const std::size_t chunk_; ///< The number of iterations of a chunk
+        const std::size_t chunks_; ///< The number of chunks
+        std::atomic<std::size_t> next_; ///< The next chunk to be claimed
+        std::atomic<std::size_t> done_; ///< The number of finished chunks
+
+      public:
+
+        template <typename Op>
+        VectorChunks(Op& op, const std::size_t n, const std::size_t chunk) :
+          op_([&op] (const std::size_t first, const std::size_t last)
+              { op(first, last); }),
+          n_(n), chunk_(chunk), chunks_((n + chunk - 1ul) / chunk),
+          next_(0ul), done_(0ul)
+        { }
+
+        /// Compute chunks until all chunks are claimed
+        void work() {
+          for(std::size_t c = next_++; c < chunks_; c = next_++) {
+            const std::size_t first = c * chunk_;
+            op_(first, std::min(first + chunk_, n_));
+            ++done_;
+          }
+        }
+
+        /// \return \c true when all chunks are finished
+        bool finished() const { return done_.load() == chunks_; }
+
+        /// \return The number of chunks
+        std::size_t chunks() const { return chunks_; }
+
+      }; // class VectorChunks
+
+      /// Task that computes chunks of a vector loop
+      class VectorChunkTask : public madness::PoolTaskInterface {
+        std::shared_ptr<VectorChunks> chunks_; ///< The chunks of the loop
+
+      public:
+
+        explicit VectorChunkTask(const std::shared_ptr<VectorChunks>& chunks) :
+          madness::PoolTaskInterface(madness::TaskAttributes::hipri()),
+          chunks_(chunks)
+        { }
+
+        virtual ~VectorChunkTask() { }
+
+        virtual void run(const madness::TaskThreadEnv&) { chunks_->work(); }
+
+      }; // class VectorChunkTask
+
+    }  // namespace detail
+
+    /// Element-wise loop that may be split among the threads of the node
+
+    /// When <tt>n * element_bytes</tt> is at least
+    /// \c parallel_vector_threshold() , the range <tt>[0, n)</tt> is split
+    /// into chunks of \c parallel_vector_chunk_bytes() , which are computed
+    /// by TBB workers, if available, or otherwise by this thread and by
+    /// tasks added to the MADNESS thread pool, which are run by the idle
+    /// workers. This thread runs other tasks while it waits for chunks that
+    /// are computed by other threads. Otherwise \c op is called once with
+    /// the whole range.
+    /// \tparam Op The chunk operation type
+    /// \param n The number of iterations
+    /// \param element_bytes The number of bytes read and written by an
+    /// iteration, which sets the size of the chunks
+    /// \param op The chunk operation, <tt>op(first, last)</tt> , which may
+    /// be called concurrently for disjoint chunks
+    template <typename Op>
+    inline void parallel_vector_for(const std::size_t n,
+        const std::size_t element_bytes, Op&& op)
+    {
+      const std::size_t threshold = parallel_vector_threshold();
+      const std::size_t threads = madness::ThreadPool::size();
+      if(! threshold || ! threads || (n * element_bytes < threshold)) {
+        if(n)
+          op(0ul, n);
+        return;
+      }
+
+      const std::size_t chunk = std::max<std::size_t>(
+          parallel_vector_chunk_bytes() / std::max<std::size_t>(element_bytes, 1ul),
+          64ul) & ~std::size_t(63);
+#ifdef HAVE_INTEL_TBB
+      parallel_for(0ul, n, chunk, op);
+#else
+      std::shared_ptr<detail::VectorChunks> chunks =
+          std::make_shared<detail::VectorChunks>(op, n, chunk);
+      const std::size_t tasks = std::min(threads, chunks->chunks() - 1ul);
+      for(std::size_t t = 0ul; t < tasks; ++t)
+        madness::ThreadPool::add(new detail::VectorChunkTask(chunks));
+      chunks->work();
+      madness::ThreadPool::await([&chunks] () { return chunks->finished(); });
+#endif // HAVE_INTEL_TBB
+    }
+
+  }  // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_PARALLEL_FOR_H__INCLUDED
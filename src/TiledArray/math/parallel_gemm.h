@@ -27,143 +27,96 @@
 #define TILEDARRAY_PARALLEL_GEMM_H__INCLUDED
 
 #include <TiledArray/madness.h>
-#include <TiledArray/vector_op.h>
-#include <TiledArray/blas.h>
-
-#define TILEDARRAY_DYNAMIC_BLOCK_SIZE std::numeric_limits<std::size_t>::max();
+#include <TiledArray/math/blas.h>
+#include <cstdlib>
+#ifdef HAVE_INTEL_TBB
+#include <tbb/blocked_range2d.h>
+#include <tbb/parallel_for.h>
+#endif // HAVE_INTEL_TBB
 
 namespace TiledArray {
   namespace math {
 
-//#ifdef HAVE_INTEL_TBB
-
-
-    template <typename T, integer Size>
-    class MatrixBlockTask : public tbb::task {
-
-      const integer rows_;
-      const integer cols_;
-      T* data_;
-      const integer ld_;
-      std::shared_ptr<T> result_;
-
-      /// Copy a \c Size^2 block from \c data to \c result
-
-      /// \param[out] result A pointer to the first element of the result block
-      /// \param[in] data A pointer to the first element of the block to be copied
-      /// \param[in] ld The leading dimension stride for the \c data block
-      void copy_block(T* result, const T* data, const integer ld) {
-        const T* const block_end = result + (TILEDARRAY_LOOP_UNWIND * Size);
-        for(; result < block_end; result += Size, data += ld)
-          TiledArray::math::copy_block(result, data);
-      }
-
-      /// Copy a rectangular \c m*n block from \c data to \c result
-
-      /// \param[in] m The number of rows to copy
-      /// \param[in] n The number of columns to copy
-      /// \param[out] result A pointer to the first element of the result block
-      /// \param[in] data A pointer to the first element of the block to be copied
-      /// \param[in] ld The leading dimension stride for the \c data block
-      void copy_block(const integer m, const integer n, T* result,
-          const T* data, const integer ld)
-      {
-        const T* const block_end = result + (m * Size);
-        for(; result < block_end; result += Size, data += ld)
-          TiledArray::math::copy_block(n, result, data);
-      }
-
-    public:
-      MatrixBlockTask(const integer rows, const integer cols,
-          const T* const data, const integer ld) :
-        rows_(rows), cols_(cols), data_(data), ld_(ld)
-      { }
-
-      /// Task body
-      virtual tbb::task* execut() {
-
-        // Compute block iteration limit
-        constexpr integer index_mask = ~integer(TILEDARRAY_LOOP_UNWIND - 1ul);
-        const integer mx = rows_ & index_mask; // = rows - rows % TILEDARRAY_LOOP_UNWIND
-        const integer nx = cols_ & index_mask; // = cols - cols % TILEDARRAY_LOOP_UNWIND
-        const integer m_tail = rows_ - mx;
-        const integer n_tail = cols_ - nx;
-
-        // Copy data into block_
-        integer i = 0ul;
-        T* result_i = result_.get();
-        const T* data_i = data_;
-        for(; i < mx; i += TILEDARRAY_LOOP_UNWIND, result_i += Size, data_i += ld_) {
-
-          integer j = 0ul;
-          for(; j < nx; j += TILEDARRAY_LOOP_UNWIND)
-            copy_block(result_i + j, data_i + j);
-
-          if(n_tail)
-            copy_block(TILEDARRAY_LOOP_UNWIND, n_tail, result_i + j, data_i + j);
-        }
-
-        if(m_tail) {
-
-          integer j = 0ul;
-          for(; j < nx; j += TILEDARRAY_LOOP_UNWIND)
-            copy_block(m_tail, TILEDARRAY_LOOP_UNWIND, result_i + j, data_i + j);
-
-          if(n_tail)
-            copy_block(m_tail, n_tail, result_i + j, data_i + j);
-
-        }
-
-        return nullptr;
-      }
-
-      std::shared_ptr<T> result() {
-        constexpr integer size = Size * Size;
-        constexpr integer bytes = size * sizeof(T);
-
-        T* result_ptr = nullptr;
-        if(! posix_memalign(result_ptr, TILEARRAY_ALIGNMENT, bytes))
-          throw std::bad_alloc();
-
-        result_.reset(result_ptr);
-
-        return result_;
-      }
-
-    }; // class MatrixBlockTask
-
-
-    template <integer Size, typename C, typename A = C, typename B = C, typename Alpha = C, typename Beta = C>
-    class GemmTask : public tbb::task {
-      const madness::cblas::CBLAS_TRANSPOSE op_a_, op_b_;
-      const integer m_, n_, k_;
-      const Alpha alpha_;
-      std::shared_ptr<A> a_;
-      constexpr integer lda_ = Size;
-      std::shared_ptr<B> b_;
-      const Beta beta_;
-      std::shared_ptr<C> c_;
-      const integer ldc_;
-
-    public:
-
-
-      GemmTask(madness::cblas::CBLAS_TRANSPOSE op_a,
-          madness::cblas::CBLAS_TRANSPOSE op_b, const integer m, const integer n,
-          const integer k, const Alpha alpha, const std::shared_ptr<A>& a,
-          const std::shared_ptr<B>& b, const Beta beta,
-          const std::shared_ptr<C>& c, const integer ldc) :
-            op_a_(op_a), op_b_(op_b), m_(m), n_(n), k_(k), alpha_(alpha), a_(a),
-            b_(b), beta_(beta), c_(c), ldc_(c)
-      { }
-
-      virtual tbb::task execute() {
-        gemm(op_a_, op_b_, m_, n_, k_, alpha_, a_.get(), Size, b_.get(), Size, c_, ldc_);
+    /// The size of a tile GEMM that is split among tasks
+
+    /// A tile GEMM with at least this many multiply-adds, \f$ m n k \f$, is
+    /// split into blocks of the result that are computed by idle TBB
+    /// workers, since the BLAS is expected to be single-threaded to avoid
+    /// oversubscription with the MADNESS threads. It is read from the
+    /// \c TA_PARALLEL_GEMM_THRESHOLD environment variable; a value of zero
+    /// disables splitting. The default threshold, \f$ 2^{27} \f$,
+    /// corresponds to tiles that are 512 elements wide. Tile GEMMs are not
+    /// split when TBB is not available.
+    /// \return The parallel GEMM threshold
+    inline std::size_t parallel_gemm_threshold() {
+      static const std::size_t threshold = [] () -> std::size_t {
+        const char* parallel_threshold = getenv("TA_PARALLEL_GEMM_THRESHOLD");
+        if(parallel_threshold)
+          return std::strtoul(parallel_threshold, nullptr, 10);
+        return 1ul << 27;
+      }();
+      return threshold;
+    }
+
+    /// The smallest number of result rows or columns of a GEMM block
+    constexpr integer parallel_gemm_grain_size = 128;
+
+    /// Matrix multiplication that may be split among tasks
+
+    /// Computes <tt>c = alpha * op_a(a) * op_b(b) + beta * c</tt> , like
+    /// \c gemm() . When the number of multiply-adds is not less than
+    /// \c parallel_gemm_threshold() , \c c is partitioned into blocks of at
+    /// least \c parallel_gemm_grain_size rows and columns, which are
+    /// computed by separate TBB tasks, so that one large tile contraction
+    /// uses the idle workers of the node.
+    /// \tparam S1 The type of \c alpha
+    /// \tparam T1 The element type of \c a
+    /// \tparam T2 The element type of \c b
+    /// \tparam S2 The type of \c beta
+    /// \tparam T3 The element type of \c c
+    /// \param[in] op_a The operation applied to \c a
+    /// \param[in] op_b The operation applied to \c b
+    /// \param[in] m The number of rows of \c c
+    /// \param[in] n The number of columns of \c c
+    /// \param[in] k The number of contracted elements
+    /// \param[in] alpha The scaling factor of the product
+    /// \param[in] a The left-hand matrix
+    /// \param[in] lda The leading dimension of \c a
+    /// \param[in] b The right-hand matrix
+    /// \param[in] ldb The leading dimension of \c b
+    /// \param[in] beta The scaling factor of \c c
+    /// \param[in,out] c The result matrix
+    /// \param[in] ldc The leading dimension of \c c
+    template <typename S1, typename T1, typename T2, typename S2, typename T3>
+    inline void parallel_gemm(madness::cblas::CBLAS_TRANSPOSE op_a,
+        madness::cblas::CBLAS_TRANSPOSE op_b, const integer m, const integer n,
+        const integer k, const S1 alpha, const T1* a, const integer lda,
+        const T2* b, const integer ldb, const S2 beta, T3* c, const integer ldc)
+    {
+#ifdef HAVE_INTEL_TBB
+      const std::size_t threshold = parallel_gemm_threshold();
+      if(threshold && ((std::size_t(m) * std::size_t(n) * std::size_t(k)) >= threshold)) {
+        tbb::parallel_for(tbb::blocked_range2d<integer>(0, m,
+            parallel_gemm_grain_size, 0, n, parallel_gemm_grain_size),
+            [=] (const tbb::blocked_range2d<integer>& block) {
+              const integer row = block.rows().begin();
+              const integer col = block.cols().begin();
+
+              // The rows of op_a(a) and the columns of op_b(b) of the block
+              const T1* const a_block = (op_a == madness::cblas::NoTrans ?
+                  a + row * lda : a + row);
+              const T2* const b_block = (op_b == madness::cblas::NoTrans ?
+                  b + col : b + col * ldb);
+
+              gemm(op_a, op_b, block.rows().size(), block.cols().size(), k,
+                  alpha, a_block, lda, b_block, ldb, beta,
+                  c + row * ldc + col, ldc);
+            }, tbb::auto_partitioner());
+        return;
       }
-
-    }; // class GemmTask
-
-//#endif // HAVE_INTEL_TBB
+#endif // HAVE_INTEL_TBB
+      gemm(op_a, op_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    }
 
   }  // namespace math
 } // namespace TiledArray
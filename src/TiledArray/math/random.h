@@ -0,0 +1,205 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  random.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_RANDOM_H__INCLUDED
+#define TILEDARRAY_MATH_RANDOM_H__INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace TiledArray {
+  namespace math {
+
+    /// Philox4x32-10 counter-based random number generator
+
+    /// The generator is a keyed bijection of a 128-bit counter (Salmon et al.,
+    /// "Parallel random numbers: as easy as 1, 2, 3", SC11), so any block of
+    /// a random sequence can be generated independently of the others, without
+    /// state. A sequence is selected by a 64-bit stream and a 64-bit seed;
+    /// block \c b of the sequence is the bijection of the counter
+    /// <tt>(b, stream)</tt> with the seed as key.
+    class Philox4x32 {
+    public:
+      typedef std::array<std::uint32_t, 4> block_type; ///< A random block
+
+      static constexpr std::size_t lanes = 8ul;
+        ///< Number of blocks generated together by \c generate()
+
+    private:
+      static constexpr std::uint32_t m0 = 0xD2511F53u; ///< Round multiplier
+      static constexpr std::uint32_t m1 = 0xCD9E8D57u; ///< Round multiplier
+      static constexpr std::uint32_t w0 = 0x9E3779B9u; ///< Key increment
+      static constexpr std::uint32_t w1 = 0xBB67AE85u; ///< Key increment
+
+    public:
+
+      /// Generate consecutive blocks of a sequence
+
+      /// The blocks are generated lane by lane, so that the compiler can
+      /// vectorize the rounds.
+      /// \param first The first block
+      /// \param stream The stream of the sequence
+      /// \param seed The seed of the sequence
+      /// \param[out] result The words of blocks <tt>[first, first + lanes)</tt>,
+      /// where <tt>result[w][l]</tt> is word \c w of block <tt>first + l</tt>
+      static void generate(const std::uint64_t first, const std::uint64_t stream,
+          const std::uint64_t seed, std::uint32_t (&result)[4][lanes])
+      {
+        std::uint32_t* const c0 = result[0];
+        std::uint32_t* const c1 = result[1];
+        std::uint32_t* const c2 = result[2];
+        std::uint32_t* const c3 = result[3];
+        for(std::size_t l = 0ul; l < lanes; ++l) {
+          const std::uint64_t block = first + l;
+          c0[l] = std::uint32_t(block);
+          c1[l] = std::uint32_t(block >> 32);
+          c2[l] = std::uint32_t(stream);
+          c3[l] = std::uint32_t(stream >> 32);
+        }
+
+        std::uint32_t k0 = std::uint32_t(seed);
+        std::uint32_t k1 = std::uint32_t(seed >> 32);
+        for(unsigned int round = 0u; round < 10u; ++round) {
+          for(std::size_t l = 0ul; l < lanes; ++l) {
+            const std::uint64_t p0 = std::uint64_t(m0) * c0[l];
+            const std::uint64_t p1 = std::uint64_t(m1) * c2[l];
+            const std::uint32_t x0 = std::uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+            const std::uint32_t x2 = std::uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+            c0[l] = x0;
+            c1[l] = std::uint32_t(p1);
+            c2[l] = x2;
+            c3[l] = std::uint32_t(p0);
+          }
+          k0 += w0;
+          k1 += w1;
+        }
+      }
+
+      /// Generate one block of a sequence
+
+      /// \param index The index of the block
+      /// \param stream The stream of the sequence
+      /// \param seed The seed of the sequence
+      /// \return Block \c index of the sequence
+      static block_type block(const std::uint64_t index,
+          const std::uint64_t stream, const std::uint64_t seed)
+      {
+        std::uint32_t words[4][lanes];
+        generate(index, stream, seed, words);
+        return block_type{{ words[0][0], words[1][0], words[2][0], words[3][0] }};
+      }
+
+    }; // class Philox4x32
+
+    namespace detail {
+
+      /// Convert random words to uniform values in [0, 1)
+
+      /// \tparam T The floating point type
+      template <typename T, typename Enabler = void>
+      struct UniformWords;
+
+      template <typename T>
+      struct UniformWords<T, typename std::enable_if<
+          (std::numeric_limits<T>::digits <= 24)>::type>
+      {
+        static constexpr std::size_t per_block = 4ul; ///< Values per block
+
+        /// \return Value \c v of a block, in <tt>[0, 1)</tt>
+        static T value(const std::uint32_t (&words)[4][Philox4x32::lanes],
+            const std::size_t v, const std::size_t l)
+        {
+          return T(words[v][l] >> 8) * T(1.0 / 16777216.0);
+        }
+      };
+
+      template <typename T>
+      struct UniformWords<T, typename std::enable_if<
+          (std::numeric_limits<T>::digits > 24)>::type>
+      {
+        static constexpr std::size_t per_block = 2ul; ///< Values per block
+
+        /// \return Value \c v of a block, with 53 random bits, in <tt>[0, 1)</tt>
+        static T value(const std::uint32_t (&words)[4][Philox4x32::lanes],
+            const std::size_t v, const std::size_t l)
+        {
+          const std::uint64_t bits =
+              (std::uint64_t(words[2ul * v][l] >> 5) << 26) |
+              std::uint64_t(words[2ul * v + 1ul][l] >> 6);
+          return T(double(bits) * (1.0 / 9007199254740992.0));
+        }
+      };
+
+    }  // namespace detail
+
+    /// Fill a vector with uniform random values
+
+    /// Element \c i is computed from block <tt>i / per_block</tt> of the
+    /// Philox sequence selected by \c stream and \c seed , where
+    /// \c per_block is 4 for single precision and 2 for double precision, so
+    /// the values depend only on \c stream , \c seed , and \c i ; in
+    /// particular, they do not depend on the thread or process that computes
+    /// them.
+    /// \tparam T The floating point type of the values
+    /// \tparam Result The random access iterator type of the result
+    /// \param n The number of elements
+    /// \param result The result vector
+    /// \param stream The stream of the sequence, e.g. the ordinal of a tile
+    /// \param seed The seed of the sequence
+    /// \param lo The lower bound of the values
+    /// \param hi The upper bound of the values
+    template <typename T, typename Result>
+    void uniform_fill(const std::size_t n, Result result,
+        const std::uint64_t stream, const std::uint64_t seed, const T lo,
+        const T hi)
+    {
+      static_assert(std::is_floating_point<T>::value,
+          "uniform_fill requires a floating point type");
+      typedef detail::UniformWords<T> words_type;
+      constexpr std::size_t lanes = Philox4x32::lanes;
+      constexpr std::size_t chunk = lanes * words_type::per_block;
+      const T scale = hi - lo;
+
+      std::uint32_t words[4][lanes];
+      for(std::size_t first = 0ul; first < n; first += chunk) {
+        Philox4x32::generate(first / words_type::per_block, stream, seed, words);
+
+        // Values of the chunk in element order
+        T values[chunk];
+        for(std::size_t l = 0ul; l < lanes; ++l)
+          for(std::size_t v = 0ul; v < words_type::per_block; ++v)
+            values[l * words_type::per_block + v] =
+                lo + scale * words_type::value(words, v, l);
+
+        const std::size_t last = (n - first < chunk ? n - first : chunk);
+        for(std::size_t i = 0ul; i < last; ++i)
+          result[first + i] = values[i];
+      }
+    }
+
+  }  // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_RANDOM_H__INCLUDED
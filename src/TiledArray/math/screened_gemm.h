@@ -0,0 +1,136 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  screened_gemm.h
+ *  Mar 1, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_SCREENED_GEMM_H__INCLUDED
+#define TILEDARRAY_MATH_SCREENED_GEMM_H__INCLUDED
+
+#include <TiledArray/math/blas.h>
+#include <TiledArray/math/parallel_for.h>
+#include <algorithm>
+#include <vector>
+
+namespace TiledArray {
+  namespace math {
+
+    /// Coarse block maxima of a row-major matrix
+
+    /// The matrix is divided into \c block by \c block blocks, the last
+    /// blocks of each row and column may be smaller, and the largest element
+    /// of each block is stored in \c result .
+    /// \tparam T The element type
+    /// \param m The number of rows of \c a
+    /// \param n The number of columns of \c a
+    /// \param a The row-major \c m by \c n matrix
+    /// \param block The block size
+    /// \return The row-major matrix of the block maxima, with
+    /// <tt>ceil(m / block)</tt> rows and <tt>ceil(n / block)</tt> columns
+    template <typename T>
+    inline std::vector<T> block_max(const integer m, const integer n,
+        const T* const a, const integer block)
+    {
+      TA_ASSERT(block > 0);
+      const integer mb = (m + block - 1) / block;
+      const integer nb = (n + block - 1) / block;
+      std::vector<T> result(mb * nb, T(0));
+      for(integer i = 0; i < m; ++i) {
+        T* const result_i = result.data() + (i / block) * nb;
+        const T* const a_i = a + i * n;
+        for(integer j = 0; j < n; ++j)
+          result_i[j / block] = std::max(result_i[j / block], a_i[j]);
+      }
+      return result;
+    }
+
+    /// Matrix product of nonnegative matrices with coarse block screening
+
+    /// Computes <tt>c = alpha * a * b</tt> where \c a and \c b are row-major
+    /// matrices with nonnegative elements, e.g. the norms of a sparse shape,
+    /// and \c alpha is nonnegative. The product is screened with the block
+    /// maxima of the arguments: a block of \c c is bounded by
+    /// \f$ \alpha \sum_K |K| \max(a_{IK}) \max(b_{KJ}) \f$ , so result blocks
+    /// whose bound is below \c threshold are set to zero without computing
+    /// them, and the products of argument blocks that are zero are skipped.
+    /// The cost is proportional to the number of non-zero block products
+    /// rather than to \c m*n*k , while the elements of the blocks that are
+    /// computed are equal to those of a dense product.
+    /// \tparam T The element type
+    /// \param m The number of rows of \c a and \c c
+    /// \param n The number of columns of \c b and \c c
+    /// \param k The number of columns of \c a and rows of \c b
+    /// \param alpha The scaling factor of the product
+    /// \param a The row-major \c m by \c k matrix
+    /// \param b The row-major \c k by \c n matrix
+    /// \param threshold The elements of \c c below \c threshold may be zero
+    /// \param block The block size
+    /// \param[out] c The row-major \c m by \c n result matrix
+    template <typename T>
+    inline void screened_gemm(const integer m, const integer n, const integer k,
+        const T alpha, const T* const a, const T* const b, const T threshold,
+        const integer block, T* const c)
+    {
+      TA_ASSERT(alpha >= T(0));
+      std::fill_n(c, m * n, T(0));
+      const std::vector<T> a_max = block_max(m, k, a, block);
+      const std::vector<T> b_max = block_max(k, n, b, block);
+      const integer mb = (m + block - 1) / block;
+      const integer nb = (n + block - 1) / block;
+      const integer kb = (k + block - 1) / block;
+
+      // The block rows of the result are computed by concurrent tasks
+      parallel_for(0ul, mb, 1ul, [&] (const std::size_t first, const std::size_t last) {
+        std::vector<integer> blocks;
+        blocks.reserve(kb);
+        for(integer I = first; I < integer(last); ++I) {
+          const integer i = I * block;
+          const integer block_m = std::min(block, m - i);
+          for(integer J = 0; J < nb; ++J) {
+            const integer j = J * block;
+            const integer block_n = std::min(block, n - j);
+
+            // Bound the result block and collect the non-zero block products
+            T bound = T(0);
+            blocks.clear();
+            for(integer K = 0; K < kb; ++K) {
+              const T product = a_max[I * kb + K] * b_max[K * nb + J];
+              if(product > T(0)) {
+                bound += product * T(std::min(block, k - K * block));
+                blocks.push_back(K);
+              }
+            }
+            if(alpha * bound < threshold)
+              continue;
+
+            for(const integer K : blocks) {
+              const integer l = K * block;
+              gemm(madness::cblas::NoTrans, madness::cblas::NoTrans, block_m,
+                  block_n, std::min(block, k - l), alpha, a + i * k + l, k,
+                  b + l * n + j, n, T(1), c + i * n + j, n);
+            }
+          }
+        }
+      });
+    }
+
+  } // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_SCREENED_GEMM_H__INCLUDED
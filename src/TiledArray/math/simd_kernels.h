@@ -0,0 +1,353 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  simd_kernels.h
+ *  Jan 30, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_SIMD_KERNELS_H__INCLUDED
+#define TILEDARRAY_MATH_SIMD_KERNELS_H__INCLUDED
+
+// This header is included by the translation units that are compiled with
+// instruction set specific flags (e.g. -mavx2), so it must not include any
+// header that defines inline functions that may be used elsewhere. For the
+// same reason, every template below depends on the vector type, which each of
+// these translation units defines in an unnamed namespace.
+#include <cstddef>
+
+namespace TiledArray {
+  namespace math {
+
+    /// Instruction sets of the explicitly vectorized vector kernels
+    enum class SimdIsa {
+      scalar = 0, ///< Portable C++ kernels
+      neon = 1,   ///< ARM NEON kernels
+      avx2 = 2,   ///< x86 AVX2 and FMA kernels
+      avx512 = 3  ///< x86 AVX-512F kernels
+    }; // enum class SimdIsa
+
+    /// The element-wise binary operations of the vector kernels
+    enum SimdBinaryKind {
+      simd_add = 0,  ///< <tt>l + r</tt>
+      simd_subt = 1, ///< <tt>l - r</tt>
+      simd_mult = 2  ///< <tt>l * r</tt>
+    }; // enum SimdBinaryKind
+
+    /// Table of element-wise vector kernels for one instruction set
+
+    /// All kernels operate on \c n contiguous elements; the result may not
+    /// overlap the arguments, except for the in-place kernels where the first
+    /// argument is both input and result.
+    /// \tparam T The element type
+    template <typename T>
+    struct SimdKernelTable {
+      /// <tt>result[i] = left[i] op right[i]</tt>
+      typedef void (*binary_type)(const std::size_t, T* const, const T* const,
+          const T* const);
+      /// <tt>result[i] = (left[i] op right[i]) * factor</tt>
+      typedef void (*scal_binary_type)(const std::size_t, T* const,
+          const T* const, const T* const, const T);
+      /// <tt>result[i] = result[i] op arg[i]</tt>
+      typedef void (*inplace_type)(const std::size_t, T* const, const T* const);
+      /// <tt>result[i] = (result[i] op arg[i]) * factor</tt>
+      typedef void (*scal_inplace_type)(const std::size_t, T* const,
+          const T* const, const T);
+      /// <tt>result[i] = arg[i] * factor</tt>
+      typedef void (*scale_type)(const std::size_t, T* const, const T* const,
+          const T);
+      /// <tt>result[i] *= factor</tt>
+      typedef void (*scale_to_type)(const std::size_t, T* const, const T);
+      /// <tt>sum(arg[i])</tt>
+      typedef T (*sum_type)(const std::size_t, const T* const);
+      /// <tt>sum(left[i] * right[i])</tt>
+      typedef T (*dot_type)(const std::size_t, const T* const, const T* const);
+
+      binary_type binary[3]; ///< Binary kernels, indexed by \c SimdBinaryKind
+      scal_binary_type scal_binary[3]; ///< Scaled binary kernels
+      inplace_type inplace[3]; ///< In-place binary kernels
+      scal_inplace_type scal_inplace[3]; ///< Scaled in-place binary kernels
+      scale_type scale; ///< Scale kernel
+      scale_to_type scale_to; ///< In-place scale kernel
+      sum_type sum; ///< Sum reduction kernel
+      dot_type dot; ///< Dot product reduction kernel
+    }; // struct SimdKernelTable
+
+    namespace detail {
+
+      /// Element operation of a binary kernel
+
+      /// \tparam K The operation kind
+      template <SimdBinaryKind K> struct SimdElementOp;
+
+      template <>
+      struct SimdElementOp<simd_add> {
+        template <typename V>
+        static typename V::vector_type
+        vapply(const typename V::vector_type l, const typename V::vector_type r)
+        { return V::add(l, r); }
+
+        template <typename V>
+        static typename V::value_type
+        apply(const typename V::value_type l, const typename V::value_type r)
+        { return l + r; }
+      }; // struct SimdElementOp<simd_add>
+
+      template <>
+      struct SimdElementOp<simd_subt> {
+        template <typename V>
+        static typename V::vector_type
+        vapply(const typename V::vector_type l, const typename V::vector_type r)
+        { return V::sub(l, r); }
+
+        template <typename V>
+        static typename V::value_type
+        apply(const typename V::value_type l, const typename V::value_type r)
+        { return l - r; }
+      }; // struct SimdElementOp<simd_subt>
+
+      template <>
+      struct SimdElementOp<simd_mult> {
+        template <typename V>
+        static typename V::vector_type
+        vapply(const typename V::vector_type l, const typename V::vector_type r)
+        { return V::mul(l, r); }
+
+        template <typename V>
+        static typename V::value_type
+        apply(const typename V::value_type l, const typename V::value_type r)
+        { return l * r; }
+      }; // struct SimdElementOp<simd_mult>
+
+
+      /// Portable "vector" of one element
+
+      /// This is the vector type of the \c SimdIsa::scalar kernels. A vector
+      /// type \c V provides \c value_type , \c vector_type , \c width and the
+      /// static functions \c load , \c store , \c set1 , \c zero , \c add ,
+      /// \c sub , \c mul , \c fmadd (<tt>a * b + c</tt>), and \c hsum (the
+      /// horizontal sum of a vector).
+      /// \tparam T The element type
+      template <typename T>
+      struct ScalarVector {
+        typedef T value_type;
+        typedef T vector_type;
+        static constexpr std::size_t width = 1ul;
+
+        static vector_type load(const T* const p) { return *p; }
+        static void store(T* const p, const vector_type a) { *p = a; }
+        static vector_type set1(const T a) { return a; }
+        static vector_type zero() { return T(0); }
+        static vector_type add(const vector_type a, const vector_type b) { return a + b; }
+        static vector_type sub(const vector_type a, const vector_type b) { return a - b; }
+        static vector_type mul(const vector_type a, const vector_type b) { return a * b; }
+        static vector_type fmadd(const vector_type a, const vector_type b,
+            const vector_type c) { return a * b + c; }
+        static T hsum(const vector_type a) { return a; }
+      }; // struct ScalarVector
+
+
+      /// Element-wise vector kernels for a vector type
+
+      /// The loops are unrolled four times by the vector width; the remainder
+      /// is handled one vector, and then one element, at a time. All loads and
+      /// stores are unaligned.
+      /// \tparam V The vector type
+      template <typename V>
+      struct SimdKernels {
+        typedef typename V::value_type value_type;
+        typedef typename V::vector_type vector_type;
+        static constexpr std::size_t width = V::width;
+        static constexpr std::size_t block = 4ul * V::width;
+
+        template <typename VecOp, typename ElemOp>
+        static void for_each(const std::size_t n, const VecOp& vec_op,
+            const ElemOp& elem_op)
+        {
+          std::size_t i = 0ul;
+          for(; (i + block) <= n; i += block) {
+            vec_op(i);
+            vec_op(i + width);
+            vec_op(i + 2ul * width);
+            vec_op(i + 3ul * width);
+          }
+          for(; (i + width) <= n; i += width)
+            vec_op(i);
+          for(; i < n; ++i)
+            elem_op(i);
+        }
+
+        template <SimdBinaryKind K>
+        static void binary(const std::size_t n, value_type* const result,
+            const value_type* const left, const value_type* const right)
+        {
+          typedef SimdElementOp<K> op_type;
+          for_each(n,
+              [=] (const std::size_t i) { V::store(result + i,
+                  op_type::template vapply<V>(V::load(left + i), V::load(right + i))); },
+              [=] (const std::size_t i)
+                  { result[i] = op_type::template apply<V>(left[i], right[i]); });
+        }
+
+        template <SimdBinaryKind K>
+        static void scal_binary(const std::size_t n, value_type* const result,
+            const value_type* const left, const value_type* const right,
+            const value_type factor)
+        {
+          typedef SimdElementOp<K> op_type;
+          const vector_type f = V::set1(factor);
+          for_each(n,
+              [=] (const std::size_t i) { V::store(result + i, V::mul(
+                  op_type::template vapply<V>(V::load(left + i), V::load(right + i)), f)); },
+              [=] (const std::size_t i)
+                  { result[i] = op_type::template apply<V>(left[i], right[i]) * factor; });
+        }
+
+        template <SimdBinaryKind K>
+        static void inplace(const std::size_t n, value_type* const result,
+            const value_type* const arg)
+        {
+          typedef SimdElementOp<K> op_type;
+          for_each(n,
+              [=] (const std::size_t i) { V::store(result + i,
+                  op_type::template vapply<V>(V::load(result + i), V::load(arg + i))); },
+              [=] (const std::size_t i)
+                  { result[i] = op_type::template apply<V>(result[i], arg[i]); });
+        }
+
+        template <SimdBinaryKind K>
+        static void scal_inplace(const std::size_t n, value_type* const result,
+            const value_type* const arg, const value_type factor)
+        {
+          typedef SimdElementOp<K> op_type;
+          const vector_type f = V::set1(factor);
+          for_each(n,
+              [=] (const std::size_t i) { V::store(result + i, V::mul(
+                  op_type::template vapply<V>(V::load(result + i), V::load(arg + i)), f)); },
+              [=] (const std::size_t i)
+                  { result[i] = op_type::template apply<V>(result[i], arg[i]) * factor; });
+        }
+
+        static void scale(const std::size_t n, value_type* const result,
+            const value_type* const arg, const value_type factor)
+        {
+          const vector_type f = V::set1(factor);
+          for_each(n,
+              [=] (const std::size_t i)
+                  { V::store(result + i, V::mul(V::load(arg + i), f)); },
+              [=] (const std::size_t i) { result[i] = arg[i] * factor; });
+        }
+
+        static void scale_to(const std::size_t n, value_type* const result,
+            const value_type factor)
+        {
+          const vector_type f = V::set1(factor);
+          for_each(n,
+              [=] (const std::size_t i)
+                  { V::store(result + i, V::mul(V::load(result + i), f)); },
+              [=] (const std::size_t i) { result[i] *= factor; });
+        }
+
+        static value_type sum(const std::size_t n, const value_type* const arg) {
+          // Use independent accumulators to hide the latency of the adds
+          vector_type s0 = V::zero(), s1 = V::zero(), s2 = V::zero(),
+              s3 = V::zero();
+          std::size_t i = 0ul;
+          for(; (i + block) <= n; i += block) {
+            s0 = V::add(s0, V::load(arg + i));
+            s1 = V::add(s1, V::load(arg + i + width));
+            s2 = V::add(s2, V::load(arg + i + 2ul * width));
+            s3 = V::add(s3, V::load(arg + i + 3ul * width));
+          }
+          for(; (i + width) <= n; i += width)
+            s0 = V::add(s0, V::load(arg + i));
+          value_type result = V::hsum(V::add(V::add(s0, s1), V::add(s2, s3)));
+          for(; i < n; ++i)
+            result += arg[i];
+          return result;
+        }
+
+        static value_type dot(const std::size_t n, const value_type* const left,
+            const value_type* const right)
+        {
+          vector_type s0 = V::zero(), s1 = V::zero(), s2 = V::zero(),
+              s3 = V::zero();
+          std::size_t i = 0ul;
+          for(; (i + block) <= n; i += block) {
+            s0 = V::fmadd(V::load(left + i), V::load(right + i), s0);
+            s1 = V::fmadd(V::load(left + i + width),
+                V::load(right + i + width), s1);
+            s2 = V::fmadd(V::load(left + i + 2ul * width),
+                V::load(right + i + 2ul * width), s2);
+            s3 = V::fmadd(V::load(left + i + 3ul * width),
+                V::load(right + i + 3ul * width), s3);
+          }
+          for(; (i + width) <= n; i += width)
+            s0 = V::fmadd(V::load(left + i), V::load(right + i), s0);
+          value_type result = V::hsum(V::add(V::add(s0, s1), V::add(s2, s3)));
+          for(; i < n; ++i)
+            result += left[i] * right[i];
+          return result;
+        }
+
+        /// Fill a kernel table with the kernels of this vector type
+
+        /// \param[out] table The kernel table
+        static void make_table(SimdKernelTable<value_type>& table) {
+          table.binary[simd_add] = & binary<simd_add>;
+          table.binary[simd_subt] = & binary<simd_subt>;
+          table.binary[simd_mult] = & binary<simd_mult>;
+          table.scal_binary[simd_add] = & scal_binary<simd_add>;
+          table.scal_binary[simd_subt] = & scal_binary<simd_subt>;
+          table.scal_binary[simd_mult] = & scal_binary<simd_mult>;
+          table.inplace[simd_add] = & inplace<simd_add>;
+          table.inplace[simd_subt] = & inplace<simd_subt>;
+          table.inplace[simd_mult] = & inplace<simd_mult>;
+          table.scal_inplace[simd_add] = & scal_inplace<simd_add>;
+          table.scal_inplace[simd_subt] = & scal_inplace<simd_subt>;
+          table.scal_inplace[simd_mult] = & scal_inplace<simd_mult>;
+          table.scale = & scale;
+          table.scale_to = & scale_to;
+          table.sum = & sum;
+          table.dot = & dot;
+        }
+
+      }; // struct SimdKernels
+
+      /// Initialize the AVX2 kernel tables
+
+      /// Defined in a translation unit compiled with AVX2 and FMA support; it
+      /// may only be called when the processor supports these instructions.
+      /// \param[out] double_table The kernel table for \c double
+      /// \param[out] float_table The kernel table for \c float
+      void init_avx2_kernels(SimdKernelTable<double>& double_table,
+          SimdKernelTable<float>& float_table);
+
+      /// Initialize the AVX-512 kernel tables
+
+      /// Defined in a translation unit compiled with AVX-512F support; it may
+      /// only be called when the processor supports these instructions.
+      /// \param[out] double_table The kernel table for \c double
+      /// \param[out] float_table The kernel table for \c float
+      void init_avx512_kernels(SimdKernelTable<double>& double_table,
+          SimdKernelTable<float>& float_table);
+
+    }  // namespace detail
+  }  // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_SIMD_KERNELS_H__INCLUDED
@@ -0,0 +1,214 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  simd_vector_op.cpp
+ *  Jan 30, 2017
+ *
+ */
+
+#include <TiledArray/math/simd_vector_op.h>
+#include <TiledArray/error.h>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TILEDARRAY_HAS_NEON_KERNELS 1
+#endif
+
+namespace TiledArray {
+  namespace math {
+    namespace detail {
+      namespace {
+
+#ifdef TILEDARRAY_HAS_NEON_KERNELS
+
+        struct NeonFloat {
+          typedef float value_type;
+          typedef float32x4_t vector_type;
+          static constexpr std::size_t width = 4ul;
+
+          static vector_type load(const float* const p) { return vld1q_f32(p); }
+          static void store(float* const p, const vector_type a) { vst1q_f32(p, a); }
+          static vector_type set1(const float a) { return vdupq_n_f32(a); }
+          static vector_type zero() { return vdupq_n_f32(0.0f); }
+          static vector_type add(const vector_type a, const vector_type b) { return vaddq_f32(a, b); }
+          static vector_type sub(const vector_type a, const vector_type b) { return vsubq_f32(a, b); }
+          static vector_type mul(const vector_type a, const vector_type b) { return vmulq_f32(a, b); }
+#ifdef __aarch64__
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return vfmaq_f32(c, a, b); }
+          static float hsum(const vector_type a) { return vaddvq_f32(a); }
+#else
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return vmlaq_f32(c, a, b); }
+          static float hsum(const vector_type a) {
+            const float32x2_t s = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+            return vget_lane_f32(vpadd_f32(s, s), 0);
+          }
+#endif // __aarch64__
+        }; // struct NeonFloat
+
+#ifdef __aarch64__
+        struct NeonDouble {
+          typedef double value_type;
+          typedef float64x2_t vector_type;
+          static constexpr std::size_t width = 2ul;
+
+          static vector_type load(const double* const p) { return vld1q_f64(p); }
+          static void store(double* const p, const vector_type a) { vst1q_f64(p, a); }
+          static vector_type set1(const double a) { return vdupq_n_f64(a); }
+          static vector_type zero() { return vdupq_n_f64(0.0); }
+          static vector_type add(const vector_type a, const vector_type b) { return vaddq_f64(a, b); }
+          static vector_type sub(const vector_type a, const vector_type b) { return vsubq_f64(a, b); }
+          static vector_type mul(const vector_type a, const vector_type b) { return vmulq_f64(a, b); }
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return vfmaq_f64(c, a, b); }
+          static double hsum(const vector_type a) { return vaddvq_f64(a); }
+        }; // struct NeonDouble
+#else
+        // 32-bit ARM has no double precision NEON instructions.
+        typedef ScalarVector<double> NeonDouble;
+#endif // __aarch64__
+
+#endif // TILEDARRAY_HAS_NEON_KERNELS
+
+        constexpr std::size_t num_isa = 4ul;
+
+        /// The vector kernel tables of all instruction sets
+        class SimdKernelRegistry {
+          SimdKernelTable<double> double_tables_[num_isa];
+          SimdKernelTable<float> float_tables_[num_isa];
+          bool supported_[num_isa];
+          std::atomic<int> isa_;
+
+          static std::size_t index(const SimdIsa isa) {
+            return static_cast<std::size_t>(isa);
+          }
+
+          /// Read the instruction set cap from \c TA_SIMD_ISA
+          static SimdIsa max_isa() {
+            const char* name = getenv("TA_SIMD_ISA");
+            if(name) {
+              for(std::size_t i = 0ul; i < num_isa; ++i)
+                if(std::strcmp(name, simd_isa_name(static_cast<SimdIsa>(i))) == 0)
+                  return static_cast<SimdIsa>(i);
+            }
+            return SimdIsa::avx512;
+          }
+
+        public:
+
+          SimdKernelRegistry() : supported_(), isa_(0) {
+            SimdKernels<ScalarVector<double> >::make_table(double_tables_[0]);
+            SimdKernels<ScalarVector<float> >::make_table(float_tables_[0]);
+            supported_[0] = true;
+
+#ifdef TILEDARRAY_HAS_NEON_KERNELS
+            SimdKernels<NeonDouble>::make_table(double_tables_[index(SimdIsa::neon)]);
+            SimdKernels<NeonFloat>::make_table(float_tables_[index(SimdIsa::neon)]);
+            supported_[index(SimdIsa::neon)] = true;
+#endif // TILEDARRAY_HAS_NEON_KERNELS
+
+#ifdef TILEDARRAY_HAS_AVX2_KERNELS
+            if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+              init_avx2_kernels(double_tables_[index(SimdIsa::avx2)],
+                  float_tables_[index(SimdIsa::avx2)]);
+              supported_[index(SimdIsa::avx2)] = true;
+            }
+#endif // TILEDARRAY_HAS_AVX2_KERNELS
+
+#ifdef TILEDARRAY_HAS_AVX512_KERNELS
+            if(__builtin_cpu_supports("avx512f")) {
+              init_avx512_kernels(double_tables_[index(SimdIsa::avx512)],
+                  float_tables_[index(SimdIsa::avx512)]);
+              supported_[index(SimdIsa::avx512)] = true;
+            }
+#endif // TILEDARRAY_HAS_AVX512_KERNELS
+
+            // Select the most capable instruction set below the cap
+            const std::size_t max_index = index(max_isa());
+            for(std::size_t i = 0ul; i <= max_index; ++i)
+              if(supported_[i])
+                isa_ = static_cast<int>(i);
+          }
+
+          static SimdKernelRegistry& instance() {
+            static SimdKernelRegistry registry;
+            return registry;
+          }
+
+          SimdIsa isa() const {
+            return static_cast<SimdIsa>(isa_.load(std::memory_order_relaxed));
+          }
+
+          void isa(const SimdIsa isa) {
+            if(! supported(isa))
+              TA_EXCEPTION("The SIMD instruction set is not supported on this processor.");
+            isa_.store(static_cast<int>(index(isa)), std::memory_order_relaxed);
+          }
+
+          bool supported(const SimdIsa isa) const {
+            return (index(isa) < num_isa) && supported_[index(isa)];
+          }
+
+          const SimdKernelTable<double>& double_kernels() const {
+            return double_tables_[isa_.load(std::memory_order_relaxed)];
+          }
+
+          const SimdKernelTable<float>& float_kernels() const {
+            return float_tables_[isa_.load(std::memory_order_relaxed)];
+          }
+
+        }; // class SimdKernelRegistry
+
+      }  // namespace
+    }  // namespace detail
+
+    SimdIsa simd_isa() { return detail::SimdKernelRegistry::instance().isa(); }
+
+    void simd_isa(const SimdIsa isa) {
+      detail::SimdKernelRegistry::instance().isa(isa);
+    }
+
+    bool simd_isa_supported(const SimdIsa isa) {
+      return detail::SimdKernelRegistry::instance().supported(isa);
+    }
+
+    const char* simd_isa_name(const SimdIsa isa) {
+      switch(isa) {
+        case SimdIsa::scalar: return "scalar";
+        case SimdIsa::neon: return "neon";
+        case SimdIsa::avx2: return "avx2";
+        case SimdIsa::avx512: return "avx512";
+      }
+      return "unknown";
+    }
+
+    template <>
+    const SimdKernelTable<double>& simd_kernels<double>() {
+      return detail::SimdKernelRegistry::instance().double_kernels();
+    }
+
+    template <>
+    const SimdKernelTable<float>& simd_kernels<float>() {
+      return detail::SimdKernelRegistry::instance().float_kernels();
+    }
+
+  }  // namespace math
+} // namespace TiledArray
@@ -0,0 +1,652 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  simd_vector_op.h
+ *  Jan 30, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_SIMD_VECTOR_OP_H__INCLUDED
+#define TILEDARRAY_MATH_SIMD_VECTOR_OP_H__INCLUDED
+
+#include <TiledArray/math/simd_kernels.h>
+#include <TiledArray/madness.h>
+#include <complex>
+#include <type_traits>
+
+namespace TiledArray {
+  namespace math {
+
+    /// Instruction set of the vector kernels in use
+
+    /// The instruction set is selected the first time the kernels are used;
+    /// it is the most capable instruction set supported by both this build
+    /// and the processor, which may be capped with the \c TA_SIMD_ISA
+    /// environment variable (\c scalar , \c neon , \c avx2 , or \c avx512 ).
+    /// \return The instruction set of the vector kernels
+    SimdIsa simd_isa();
+
+    /// Select the instruction set of the vector kernels
+
+    /// \note This is intended for testing and benchmarking; it should not be
+    /// called while vector kernels are running.
+    /// \param isa The instruction set
+    /// \throw TiledArray::Exception When \c isa is not supported by this
+    /// build or by the processor.
+    void simd_isa(const SimdIsa isa);
+
+    /// Instruction set support query
+
+    /// \param isa The instruction set
+    /// \return \c true if \c isa is supported by this build and the processor
+    bool simd_isa_supported(const SimdIsa isa);
+
+    /// Instruction set name
+
+    /// \param isa The instruction set
+    /// \return The name of \c isa , as accepted by \c TA_SIMD_ISA
+    const char* simd_isa_name(const SimdIsa isa);
+
+    /// Vector kernel table accessor
+
+    /// \tparam T The element type, \c double or \c float
+    /// \return The kernel table of the instruction set in use
+    template <typename T>
+    const SimdKernelTable<T>& simd_kernels();
+
+    template <>
+    const SimdKernelTable<double>& simd_kernels<double>();
+
+    template <>
+    const SimdKernelTable<float>& simd_kernels<float>();
+
+    namespace detail {
+
+      /// Test for element types that have vector kernels
+      template <typename T>
+      struct is_simd_numeric : public std::false_type { };
+
+      template <>
+      struct is_simd_numeric<double> : public std::true_type { };
+
+      template <>
+      struct is_simd_numeric<float> : public std::true_type { };
+
+      /// Test for complex element types that use the vector kernels of their
+      /// real and imaginary parts
+
+      /// A complex vector is stored as a real vector of twice its size, with
+      /// interleaved real and imaginary parts, so the operations that are
+      /// applied to each part independently (addition, subtraction, and
+      /// scaling by a real factor) are evaluated with the real kernels.
+      template <typename T>
+      struct is_simd_complex : public std::false_type { };
+
+      template <typename T>
+      struct is_simd_complex<std::complex<T> > : public is_simd_numeric<T> { };
+
+      /// Test for binary operations that have vector kernels
+
+      /// \tparam T The element type
+      /// \tparam K The binary operation
+      template <typename T, SimdBinaryKind K>
+      struct is_simd_binary {
+        static constexpr bool value = is_simd_numeric<T>::value ||
+            (is_simd_complex<T>::value && (K != simd_mult));
+      };
+
+      /// Test that a scaling factor is applied exactly by the vector kernels
+
+      /// The generic element operations compute the scaled result in the type
+      /// of <tt>T * Scalar</tt>, so only factors of type \c T or of integral
+      /// type yield identical results when converted to \c T .
+      template <typename T, typename Scalar>
+      struct is_simd_scalar {
+        static constexpr bool value = is_simd_numeric<T>::value &&
+            (std::is_same<T, Scalar>::value || std::is_integral<Scalar>::value);
+      };
+
+      /// Complex scaling factors are applied exactly only when they are of
+      /// the real type of \c T
+      template <typename T, typename Scalar>
+      struct is_simd_scalar<std::complex<T>, Scalar> {
+        static constexpr bool value = is_simd_numeric<T>::value &&
+            std::is_same<T, Scalar>::value;
+      };
+
+      /// Minimum number of elements processed by one task of the vector kernels
+      constexpr std::size_t simd_grain_size = 8192ul;
+
+      /// Apply a vector kernel to blocks of a vector
+
+      /// When TBB is available, large vectors are partitioned among tasks.
+      /// \tparam Op The block operation type, with signature
+      /// <tt>void(std::size_t first, std::size_t count)</tt>
+      /// \param n The vector size
+      /// \param op The block operation
+      template <typename Op>
+      inline void simd_for(const std::size_t n, const Op& op) {
+#ifdef HAVE_INTEL_TBB
+        if(n > simd_grain_size) {
+          tbb::parallel_for(tbb::blocked_range<std::size_t>(0ul, n, simd_grain_size),
+              [&op] (const tbb::blocked_range<std::size_t>& range)
+              { op(range.begin(), range.size()); }, tbb::auto_partitioner());
+          return;
+        }
+#endif // HAVE_INTEL_TBB
+        op(0ul, n);
+      }
+
+      /// Apply a vector reduction kernel to blocks of a vector
+
+      /// When TBB is available, large vectors are partitioned among tasks.
+      /// \tparam T The reduction type
+      /// \tparam Op The block reduction type, with signature
+      /// <tt>T(std::size_t first, std::size_t count)</tt>
+      /// \param n The vector size
+      /// \param op The block reduction
+      /// \return The sum of the block reductions
+      template <typename T, typename Op>
+      inline T simd_reduce(const std::size_t n, const Op& op) {
+#ifdef HAVE_INTEL_TBB
+        if(n > simd_grain_size) {
+          return tbb::parallel_reduce(
+              tbb::blocked_range<std::size_t>(0ul, n, simd_grain_size), T(0),
+              [&op] (const tbb::blocked_range<std::size_t>& range, T result)
+              { return result + op(range.begin(), range.size()); },
+              [] (const T left, const T right) { return left + right; },
+              tbb::auto_partitioner());
+        }
+#endif // HAVE_INTEL_TBB
+        return op(0ul, n);
+      }
+
+    }  // namespace detail
+
+    /// Binary vector operation
+
+    /// <tt>result[i] = left[i] op right[i]</tt>
+    /// \tparam T The element type
+    /// \param kind The binary operation
+    /// \param n The vector size
+    /// \param[out] result The result vector
+    /// \param[in] left The left-hand argument vector
+    /// \param[in] right The right-hand argument vector
+    template <typename T>
+    inline void simd_binary_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, T* const result, const T* const left,
+        const T* const right)
+    {
+      const auto kernel = simd_kernels<T>().binary[kind];
+      detail::simd_for(n, [=] (const std::size_t first, const std::size_t count)
+          { kernel(count, result + first, left + first, right + first); });
+    }
+
+    /// Scaled binary vector operation
+
+    /// <tt>result[i] = (left[i] op right[i]) * factor</tt>
+    /// \tparam T The element type
+    /// \param kind The binary operation
+    /// \param n The vector size
+    /// \param[out] result The result vector
+    /// \param[in] left The left-hand argument vector
+    /// \param[in] right The right-hand argument vector
+    /// \param factor The scaling factor
+    template <typename T>
+    inline void simd_scal_binary_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, T* const result, const T* const left,
+        const T* const right, const T factor)
+    {
+      const auto kernel = simd_kernels<T>().scal_binary[kind];
+      detail::simd_for(n, [=] (const std::size_t first, const std::size_t count)
+          { kernel(count, result + first, left + first, right + first, factor); });
+    }
+
+    /// In-place binary vector operation
+
+    /// <tt>result[i] = result[i] op arg[i]</tt>
+    /// \tparam T The element type
+    /// \param kind The binary operation
+    /// \param n The vector size
+    /// \param[in,out] result The result vector
+    /// \param[in] arg The argument vector
+    template <typename T>
+    inline void simd_inplace_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, T* const result, const T* const arg)
+    {
+      const auto kernel = simd_kernels<T>().inplace[kind];
+      detail::simd_for(n, [=] (const std::size_t first, const std::size_t count)
+          { kernel(count, result + first, arg + first); });
+    }
+
+    /// Scaled in-place binary vector operation
+
+    /// <tt>result[i] = (result[i] op arg[i]) * factor</tt>
+    /// \tparam T The element type
+    /// \param kind The binary operation
+    /// \param n The vector size
+    /// \param[in,out] result The result vector
+    /// \param[in] arg The argument vector
+    /// \param factor The scaling factor
+    template <typename T>
+    inline void simd_scal_inplace_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, T* const result, const T* const arg, const T factor)
+    {
+      const auto kernel = simd_kernels<T>().scal_inplace[kind];
+      detail::simd_for(n, [=] (const std::size_t first, const std::size_t count)
+          { kernel(count, result + first, arg + first, factor); });
+    }
+
+    /// Scale vector operation
+
+    /// <tt>result[i] = arg[i] * factor</tt>
+    /// \tparam T The element type
+    /// \param n The vector size
+    /// \param[out] result The result vector
+    /// \param[in] arg The argument vector
+    /// \param factor The scaling factor
+    template <typename T>
+    inline void simd_scale_vector(const std::size_t n, T* const result,
+        const T* const arg, const T factor)
+    {
+      const auto kernel = simd_kernels<T>().scale;
+      detail::simd_for(n, [=] (const std::size_t first, const std::size_t count)
+          { kernel(count, result + first, arg + first, factor); });
+    }
+
+    /// In-place scale vector operation
+
+    /// <tt>result[i] *= factor</tt>
+    /// \tparam T The element type
+    /// \param n The vector size
+    /// \param[in,out] result The result vector
+    /// \param factor The scaling factor
+    template <typename T>
+    inline void simd_scale_vector_to(const std::size_t n, T* const result,
+        const T factor)
+    {
+      const auto kernel = simd_kernels<T>().scale_to;
+      detail::simd_for(n, [=] (const std::size_t first, const std::size_t count)
+          { kernel(count, result + first, factor); });
+    }
+
+    /// Vector sum
+
+    /// \tparam T The element type
+    /// \param n The vector size
+    /// \param[in] arg The argument vector
+    /// \return The sum of the elements of \c arg
+    template <typename T>
+    inline T simd_sum_vector(const std::size_t n, const T* const arg) {
+      const auto kernel = simd_kernels<T>().sum;
+      return detail::simd_reduce<T>(n,
+          [=] (const std::size_t first, const std::size_t count)
+          { return kernel(count, arg + first); });
+    }
+
+    /// Vector dot product
+
+    /// \tparam T The element type
+    /// \param n The vector size
+    /// \param[in] left The left-hand argument vector
+    /// \param[in] right The right-hand argument vector
+    /// \return The sum of <tt>left[i] * right[i]</tt>
+    template <typename T>
+    inline T simd_dot_vector(const std::size_t n, const T* const left,
+        const T* const right)
+    {
+      const auto kernel = simd_kernels<T>().dot;
+      return detail::simd_reduce<T>(n,
+          [=] (const std::size_t first, const std::size_t count)
+          { return kernel(count, left + first, right + first); });
+    }
+
+    // Complex vector operations
+
+    // These evaluate the complex operations that are applied to the real and
+    // imaginary parts independently with the real kernels, over the
+    // interleaved parts (see detail::is_simd_complex). The scaling factors
+    // are real.
+
+    /// Complex binary vector operation
+
+    /// \tparam T The real type of the elements
+    /// \param kind The binary operation, \c simd_add or \c simd_subt
+    /// \param n The vector size
+    /// \param[out] result The result vector
+    /// \param[in] left The left-hand argument vector
+    /// \param[in] right The right-hand argument vector
+    template <typename T>
+    inline void simd_binary_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, std::complex<T>* const result,
+        const std::complex<T>* const left, const std::complex<T>* const right)
+    {
+      TA_ASSERT(kind != simd_mult);
+      simd_binary_vector_op(kind, n * 2ul, reinterpret_cast<T*>(result),
+          reinterpret_cast<const T*>(left), reinterpret_cast<const T*>(right));
+    }
+
+    /// Complex scaled binary vector operation
+
+    /// \tparam T The real type of the elements
+    /// \param kind The binary operation, \c simd_add or \c simd_subt
+    /// \param n The vector size
+    /// \param[out] result The result vector
+    /// \param[in] left The left-hand argument vector
+    /// \param[in] right The right-hand argument vector
+    /// \param factor The scaling factor, which has no imaginary part
+    template <typename T>
+    inline void simd_scal_binary_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, std::complex<T>* const result,
+        const std::complex<T>* const left, const std::complex<T>* const right,
+        const std::complex<T> factor)
+    {
+      TA_ASSERT(kind != simd_mult);
+      TA_ASSERT(factor.imag() == T(0));
+      simd_scal_binary_vector_op(kind, n * 2ul, reinterpret_cast<T*>(result),
+          reinterpret_cast<const T*>(left), reinterpret_cast<const T*>(right),
+          factor.real());
+    }
+
+    /// Complex in-place binary vector operation
+
+    /// \tparam T The real type of the elements
+    /// \param kind The binary operation, \c simd_add or \c simd_subt
+    /// \param n The vector size
+    /// \param[in,out] result The result vector
+    /// \param[in] arg The argument vector
+    template <typename T>
+    inline void simd_inplace_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, std::complex<T>* const result,
+        const std::complex<T>* const arg)
+    {
+      TA_ASSERT(kind != simd_mult);
+      simd_inplace_vector_op(kind, n * 2ul, reinterpret_cast<T*>(result),
+          reinterpret_cast<const T*>(arg));
+    }
+
+    /// Complex scaled in-place binary vector operation
+
+    /// \tparam T The real type of the elements
+    /// \param kind The binary operation, \c simd_add or \c simd_subt
+    /// \param n The vector size
+    /// \param[in,out] result The result vector
+    /// \param[in] arg The argument vector
+    /// \param factor The scaling factor, which has no imaginary part
+    template <typename T>
+    inline void simd_scal_inplace_vector_op(const SimdBinaryKind kind,
+        const std::size_t n, std::complex<T>* const result,
+        const std::complex<T>* const arg, const std::complex<T> factor)
+    {
+      TA_ASSERT(kind != simd_mult);
+      TA_ASSERT(factor.imag() == T(0));
+      simd_scal_inplace_vector_op(kind, n * 2ul, reinterpret_cast<T*>(result),
+          reinterpret_cast<const T*>(arg), factor.real());
+    }
+
+    /// Complex scale vector operation
+
+    /// \tparam T The real type of the elements
+    /// \param n The vector size
+    /// \param[out] result The result vector
+    /// \param[in] arg The argument vector
+    /// \param factor The scaling factor, which has no imaginary part
+    template <typename T>
+    inline void simd_scale_vector(const std::size_t n,
+        std::complex<T>* const result, const std::complex<T>* const arg,
+        const std::complex<T> factor)
+    {
+      TA_ASSERT(factor.imag() == T(0));
+      simd_scale_vector(n * 2ul, reinterpret_cast<T*>(result),
+          reinterpret_cast<const T*>(arg), factor.real());
+    }
+
+    /// Complex in-place scale vector operation
+
+    /// \tparam T The real type of the elements
+    /// \param n The vector size
+    /// \param[in,out] result The result vector
+    /// \param factor The scaling factor, which has no imaginary part
+    template <typename T>
+    inline void simd_scale_vector_to(const std::size_t n,
+        std::complex<T>* const result, const std::complex<T> factor)
+    {
+      TA_ASSERT(factor.imag() == T(0));
+      simd_scale_vector_to(n * 2ul, reinterpret_cast<T*>(result), factor.real());
+    }
+
+
+    // Element operations with vector kernels
+
+    // These are the element operations of Tensor arithmetic. They are
+    // callable like the generic element-wise lambdas, so they work with any
+    // tensor argument, but when all arguments are Tensor objects with
+    // elements of type T (see TiledArray::detail::is_simd_tensor_op), the
+    // tensor kernels call the vector, or reduce, member instead.
+
+    /// Base class of the element operations with vector kernels
+
+    /// \tparam T The element type of the vector kernel
+    template <typename T>
+    struct SimdOp {
+      typedef T value_type; ///< The element type of the vector kernel
+    }; // struct SimdOp
+
+    namespace detail {
+
+      template <typename T>
+      std::true_type simd_op_test(const SimdOp<T>*);
+      std::false_type simd_op_test(...);
+
+      template <typename T>
+      T simd_op_value_test(const SimdOp<T>*);
+      void simd_op_value_test(...);
+
+      /// Element operation traits
+
+      /// \tparam Op An element operation type
+      template <typename Op>
+      struct simd_op_traits {
+        /// \c true if \c Op is derived from \c SimdOp
+        static constexpr bool is_op =
+            decltype(simd_op_test(static_cast<const Op*>(nullptr)))::value;
+        /// The element type of the vector kernel, or \c void
+        typedef decltype(simd_op_value_test(static_cast<const Op*>(nullptr)))
+            value_type;
+      }; // struct simd_op_traits
+
+      /// Test for element operations that have a vector kernel
+
+      /// \tparam Op An element operation type
+      template <typename Op, bool = simd_op_traits<Op>::is_op>
+      struct is_simd_op : public std::false_type { };
+
+      template <typename Op>
+      struct is_simd_op<Op, true> : public std::integral_constant<bool, Op::simd>
+      { };
+
+      /// Apply a binary element operation to a pair of elements
+      template <typename L, typename R>
+      inline auto simd_element_op(std::integral_constant<SimdBinaryKind, simd_add>,
+          const L l, const R r) -> decltype(l + r) { return l + r; }
+
+      template <typename L, typename R>
+      inline auto simd_element_op(std::integral_constant<SimdBinaryKind, simd_subt>,
+          const L l, const R r) -> decltype(l - r) { return l - r; }
+
+      template <typename L, typename R>
+      inline auto simd_element_op(std::integral_constant<SimdBinaryKind, simd_mult>,
+          const L l, const R r) -> decltype(l * r) { return l * r; }
+
+    }  // namespace detail
+
+    /// Binary element operation
+
+    /// \tparam T The result element type
+    /// \tparam K The binary operation
+    template <typename T, SimdBinaryKind K>
+    struct SimdBinaryOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_binary<T, K>::value;
+
+      template <typename L, typename R>
+      T operator()(const L l, const R r) const {
+        return detail::simd_element_op(std::integral_constant<SimdBinaryKind, K>(),
+            l, r);
+      }
+
+      void vector(const std::size_t n, T* const result, const T* const left,
+          const T* const right) const
+      { simd_binary_vector_op(K, n, result, left, right); }
+    }; // struct SimdBinaryOp
+
+    /// Scaled binary element operation
+
+    /// \tparam T The result element type
+    /// \tparam K The binary operation
+    /// \tparam Scalar The scaling factor type
+    template <typename T, SimdBinaryKind K, typename Scalar>
+    struct SimdScalBinaryOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_binary<T, K>::value &&
+          detail::is_simd_scalar<T, Scalar>::value;
+
+      Scalar factor; ///< The scaling factor
+
+      explicit SimdScalBinaryOp(const Scalar f) : factor(f) { }
+
+      template <typename L, typename R>
+      T operator()(const L l, const R r) const {
+        return detail::simd_element_op(std::integral_constant<SimdBinaryKind, K>(),
+            l, r) * factor;
+      }
+
+      void vector(const std::size_t n, T* const result, const T* const left,
+          const T* const right) const
+      { simd_scal_binary_vector_op(K, n, result, left, right, T(factor)); }
+    }; // struct SimdScalBinaryOp
+
+    /// In-place binary element operation
+
+    /// \tparam T The result element type
+    /// \tparam K The binary operation
+    template <typename T, SimdBinaryKind K>
+    struct SimdInplaceOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_binary<T, K>::value;
+
+      template <typename R>
+      void operator()(T& l, const R r) const {
+        l = detail::simd_element_op(std::integral_constant<SimdBinaryKind, K>(),
+            l, r);
+      }
+
+      void vector(const std::size_t n, T* const result, const T* const arg) const
+      { simd_inplace_vector_op(K, n, result, arg); }
+    }; // struct SimdInplaceOp
+
+    /// Scaled in-place binary element operation
+
+    /// \tparam T The result element type
+    /// \tparam K The binary operation
+    /// \tparam Scalar The scaling factor type
+    template <typename T, SimdBinaryKind K, typename Scalar>
+    struct SimdScalInplaceOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_binary<T, K>::value &&
+          detail::is_simd_scalar<T, Scalar>::value;
+
+      Scalar factor; ///< The scaling factor
+
+      explicit SimdScalInplaceOp(const Scalar f) : factor(f) { }
+
+      template <typename R>
+      void operator()(T& l, const R r) const {
+        l = detail::simd_element_op(std::integral_constant<SimdBinaryKind, K>(),
+            l, r);
+        l *= factor;
+      }
+
+      void vector(const std::size_t n, T* const result, const T* const arg) const
+      { simd_scal_inplace_vector_op(K, n, result, arg, T(factor)); }
+    }; // struct SimdScalInplaceOp
+
+    /// Scale element operation
+
+    /// \tparam T The result element type
+    /// \tparam Scalar The scaling factor type
+    template <typename T, typename Scalar>
+    struct SimdScaleOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_scalar<T, Scalar>::value;
+
+      Scalar factor; ///< The scaling factor
+
+      explicit SimdScaleOp(const Scalar f) : factor(f) { }
+
+      template <typename A>
+      T operator()(const A a) const { return a * factor; }
+
+      void vector(const std::size_t n, T* const result, const T* const arg) const
+      { simd_scale_vector(n, result, arg, T(factor)); }
+    }; // struct SimdScaleOp
+
+    /// In-place scale element operation
+
+    /// \tparam T The result element type
+    /// \tparam Scalar The scaling factor type
+    template <typename T, typename Scalar>
+    struct SimdScaleToOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_scalar<T, Scalar>::value;
+
+      Scalar factor; ///< The scaling factor
+
+      explicit SimdScaleToOp(const Scalar f) : factor(f) { }
+
+      void operator()(T& a) const { a *= factor; }
+
+      void vector(const std::size_t n, T* const result) const
+      { simd_scale_vector_to(n, result, T(factor)); }
+    }; // struct SimdScaleToOp
+
+    /// Sum reduction element operation
+
+    /// \tparam T The reduction element type
+    template <typename T>
+    struct SimdSumOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_numeric<T>::value;
+
+      template <typename A>
+      void operator()(T& result, const A a) const { result += a; }
+
+      T reduce(const std::size_t n, const T* const arg) const
+      { return simd_sum_vector(n, arg); }
+    }; // struct SimdSumOp
+
+    /// Dot product reduction element operation
+
+    /// \tparam T The reduction element type
+    template <typename T>
+    struct SimdDotOp : public SimdOp<T> {
+      static constexpr bool simd = detail::is_simd_numeric<T>::value;
+
+      template <typename L, typename R>
+      void operator()(T& result, const L l, const R r) const { result += l * r; }
+
+      T reduce(const std::size_t n, const T* const left, const T* const right) const
+      { return simd_dot_vector(n, left, right); }
+    }; // struct SimdDotOp
+
+  }  // namespace math
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_SIMD_VECTOR_OP_H__INCLUDED
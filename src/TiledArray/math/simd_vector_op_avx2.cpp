@@ -0,0 +1,87 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  simd_vector_op_avx2.cpp
+ *  Jan 30, 2017
+ *
+ */
+
+// This file is compiled with -mavx2 -mfma; see simd_kernels.h for the
+// restrictions that apply to the headers included here.
+#include <TiledArray/math/simd_kernels.h>
+#include <immintrin.h>
+
+namespace TiledArray {
+  namespace math {
+    namespace detail {
+      namespace {
+
+        struct Avx2Double {
+          typedef double value_type;
+          typedef __m256d vector_type;
+          static constexpr std::size_t width = 4ul;
+
+          static vector_type load(const double* const p) { return _mm256_loadu_pd(p); }
+          static void store(double* const p, const vector_type a) { _mm256_storeu_pd(p, a); }
+          static vector_type set1(const double a) { return _mm256_set1_pd(a); }
+          static vector_type zero() { return _mm256_setzero_pd(); }
+          static vector_type add(const vector_type a, const vector_type b) { return _mm256_add_pd(a, b); }
+          static vector_type sub(const vector_type a, const vector_type b) { return _mm256_sub_pd(a, b); }
+          static vector_type mul(const vector_type a, const vector_type b) { return _mm256_mul_pd(a, b); }
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return _mm256_fmadd_pd(a, b, c); }
+          static double hsum(const vector_type a) {
+            __m128d lo = _mm256_castpd256_pd128(a);
+            lo = _mm_add_pd(lo, _mm256_extractf128_pd(a, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+          }
+        }; // struct Avx2Double
+
+        struct Avx2Float {
+          typedef float value_type;
+          typedef __m256 vector_type;
+          static constexpr std::size_t width = 8ul;
+
+          static vector_type load(const float* const p) { return _mm256_loadu_ps(p); }
+          static void store(float* const p, const vector_type a) { _mm256_storeu_ps(p, a); }
+          static vector_type set1(const float a) { return _mm256_set1_ps(a); }
+          static vector_type zero() { return _mm256_setzero_ps(); }
+          static vector_type add(const vector_type a, const vector_type b) { return _mm256_add_ps(a, b); }
+          static vector_type sub(const vector_type a, const vector_type b) { return _mm256_sub_ps(a, b); }
+          static vector_type mul(const vector_type a, const vector_type b) { return _mm256_mul_ps(a, b); }
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return _mm256_fmadd_ps(a, b, c); }
+          static float hsum(const vector_type a) {
+            __m128 lo = _mm256_castps256_ps128(a);
+            lo = _mm_add_ps(lo, _mm256_extractf128_ps(a, 1));
+            lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+            return _mm_cvtss_f32(_mm_add_ss(lo, _mm_movehdup_ps(lo)));
+          }
+        }; // struct Avx2Float
+
+      }  // namespace
+
+      void init_avx2_kernels(SimdKernelTable<double>& double_table,
+          SimdKernelTable<float>& float_table)
+      {
+        SimdKernels<Avx2Double>::make_table(double_table);
+        SimdKernels<Avx2Float>::make_table(float_table);
+      }
+
+    }  // namespace detail
+  }  // namespace math
+} // namespace TiledArray
@@ -0,0 +1,78 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  simd_vector_op_avx512.cpp
+ *  Jan 30, 2017
+ *
+ */
+
+// This file is compiled with -mavx512f; see simd_kernels.h for the
+// restrictions that apply to the headers included here.
+#include <TiledArray/math/simd_kernels.h>
+#include <immintrin.h>
+
+namespace TiledArray {
+  namespace math {
+    namespace detail {
+      namespace {
+
+        struct Avx512Double {
+          typedef double value_type;
+          typedef __m512d vector_type;
+          static constexpr std::size_t width = 8ul;
+
+          static vector_type load(const double* const p) { return _mm512_loadu_pd(p); }
+          static void store(double* const p, const vector_type a) { _mm512_storeu_pd(p, a); }
+          static vector_type set1(const double a) { return _mm512_set1_pd(a); }
+          static vector_type zero() { return _mm512_setzero_pd(); }
+          static vector_type add(const vector_type a, const vector_type b) { return _mm512_add_pd(a, b); }
+          static vector_type sub(const vector_type a, const vector_type b) { return _mm512_sub_pd(a, b); }
+          static vector_type mul(const vector_type a, const vector_type b) { return _mm512_mul_pd(a, b); }
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return _mm512_fmadd_pd(a, b, c); }
+          static double hsum(const vector_type a) { return _mm512_reduce_add_pd(a); }
+        }; // struct Avx512Double
+
+        struct Avx512Float {
+          typedef float value_type;
+          typedef __m512 vector_type;
+          static constexpr std::size_t width = 16ul;
+
+          static vector_type load(const float* const p) { return _mm512_loadu_ps(p); }
+          static void store(float* const p, const vector_type a) { _mm512_storeu_ps(p, a); }
+          static vector_type set1(const float a) { return _mm512_set1_ps(a); }
+          static vector_type zero() { return _mm512_setzero_ps(); }
+          static vector_type add(const vector_type a, const vector_type b) { return _mm512_add_ps(a, b); }
+          static vector_type sub(const vector_type a, const vector_type b) { return _mm512_sub_ps(a, b); }
+          static vector_type mul(const vector_type a, const vector_type b) { return _mm512_mul_ps(a, b); }
+          static vector_type fmadd(const vector_type a, const vector_type b,
+              const vector_type c) { return _mm512_fmadd_ps(a, b, c); }
+          static float hsum(const vector_type a) { return _mm512_reduce_add_ps(a); }
+        }; // struct Avx512Float
+
+      }  // namespace
+
+      void init_avx512_kernels(SimdKernelTable<double>& double_table,
+          SimdKernelTable<float>& float_table)
+      {
+        SimdKernels<Avx512Double>::make_table(double_table);
+        SimdKernels<Avx512Float>::make_table(float_table);
+      }
+
+    }  // namespace detail
+  }  // namespace math
+} // namespace TiledArray
@@ -0,0 +1,253 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  memory_governor.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include <TiledArray/memory_governor.h>
+#include <TiledArray/utility.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace TiledArray {
+  namespace {
+
+    /// Caches registered with the memory governor
+    class MemoryGovernor {
+      typedef std::tuple<CachePriority, std::function<std::size_t()>,
+          std::function<std::size_t(std::size_t)> > entry_type;
+          ///< Priority, size, and evict functions
+
+      std::mutex lock_; ///< Protects the caches and serializes eviction
+      std::map<std::size_t, entry_type> caches_; ///< The caches by id
+      std::size_t next_id_; ///< The id of the next cache
+      std::atomic<std::size_t> budget_; ///< Memory budget of this process
+      std::atomic<std::size_t> min_free_; ///< Free memory limit of this node
+      std::atomic<long long> last_poll_; ///< Time of the last poll, in ms
+
+      /// Read a size from the environment
+
+      /// \param name The environment variable
+      /// \return The value of \c name , or zero if it is not set
+      static std::size_t getenv_size(const char* name) {
+        const char* value = getenv(name);
+        return (value ? std::strtoul(value, nullptr, 10) : 0ul);
+      }
+
+      /// \return The size of the caches; the lock must be held
+      std::size_t size_locked() const {
+        std::size_t bytes = 0ul;
+        for(const auto& cache : caches_)
+          bytes += std::get<1>(cache.second)();
+        return bytes;
+      }
+
+      /// Evict caches in order of increasing priority
+
+      /// The lock must be held.
+      /// \param bytes The number of bytes to be freed
+      /// \return The number of bytes freed
+      std::size_t evict_locked(const std::size_t bytes) {
+        std::vector<const entry_type*> order;
+        order.reserve(caches_.size());
+        for(const auto& cache : caches_)
+          order.push_back(& cache.second);
+        std::stable_sort(order.begin(), order.end(),
+            [] (const entry_type* left, const entry_type* right) {
+              return std::get<0>(*left) < std::get<0>(*right);
+            });
+
+        std::size_t freed = 0ul;
+        for(const entry_type* cache : order) {
+          if(freed >= bytes)
+            break;
+          freed += std::get<2>(*cache)(bytes - freed);
+        }
+        return freed;
+      }
+
+      /// Free node memory available to this process
+
+      /// \return The free node memory above the limit, divided between the
+      /// processes of this node, or the largest size if that is not known
+      std::size_t free_memory() const {
+        const std::size_t min_free = min_free_.load();
+        const std::size_t available = detail::node_available_memory();
+        if((min_free == 0ul) || (available == 0ul))
+          return std::numeric_limits<std::size_t>::max();
+        return (available > min_free ?
+            (available - min_free) / detail::node_local_procs() : 0ul);
+      }
+
+    public:
+
+      MemoryGovernor() :
+        lock_(), caches_(), next_id_(0ul),
+        budget_(getenv_size("TA_MEMORY_BUDGET")),
+        min_free_(getenv_size("TA_MEMORY_MIN_FREE")), last_poll_(0ll)
+      { }
+
+      std::size_t budget() const { return budget_.load(); }
+      void budget(const std::size_t budget) { budget_.store(budget); }
+      std::size_t min_free() const { return min_free_.load(); }
+      void min_free(const std::size_t min_free) { min_free_.store(min_free); }
+
+      bool bounded() const { return budget_.load() || min_free_.load(); }
+
+      std::size_t insert(const CachePriority priority,
+          const std::function<std::size_t()>& size,
+          const std::function<std::size_t(std::size_t)>& evict)
+      {
+        std::lock_guard<std::mutex> locker(lock_);
+        caches_.emplace(next_id_, entry_type(priority, size, evict));
+        return next_id_++;
+      }
+
+      void erase(const std::size_t id) {
+        std::lock_guard<std::mutex> locker(lock_);
+        caches_.erase(id);
+      }
+
+      std::size_t size() {
+        std::lock_guard<std::mutex> locker(lock_);
+        return size_locked();
+      }
+
+      std::size_t headroom(const std::size_t bytes) {
+        if(! bounded())
+          return bytes;
+        std::lock_guard<std::mutex> locker(lock_);
+        std::size_t result = bytes;
+
+        const std::size_t budget = budget_.load();
+        if(budget) {
+          std::size_t cached = size_locked();
+          if(cached + bytes > budget)
+            cached -= std::min(cached, evict_locked(cached + bytes - budget));
+          result = std::min(result, (budget > cached ? budget - cached : 0ul));
+        }
+
+        if(min_free_.load()) {
+          std::size_t available = free_memory();
+          if(available < bytes) {
+            evict_locked(bytes - available);
+            available = free_memory();
+          }
+          result = std::min(result, available);
+        }
+
+        return result;
+      }
+
+      std::size_t relieve() {
+        if(! bounded())
+          return 0ul;
+        std::lock_guard<std::mutex> locker(lock_);
+        std::size_t freed = 0ul;
+
+        const std::size_t budget = budget_.load();
+        if(budget) {
+          const std::size_t cached = size_locked();
+          if(cached > budget)
+            freed += evict_locked(cached - budget);
+        }
+
+        const std::size_t min_free = min_free_.load();
+        if(min_free) {
+          const std::size_t available = detail::node_available_memory();
+          if(available && (available < min_free)) {
+            const std::size_t procs = detail::node_local_procs();
+            freed += evict_locked((min_free - available + procs - 1ul) / procs);
+          }
+        }
+
+        return freed;
+      }
+
+      void poll() {
+        if(! bounded())
+          return;
+        const long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long last = last_poll_.load(std::memory_order_relaxed);
+        if((now - last < 100ll) ||
+            ! last_poll_.compare_exchange_strong(last, now))
+          return;
+        relieve();
+      }
+
+    }; // class MemoryGovernor
+
+    /// The memory governor of this process
+
+    /// The governor is never destroyed, so that caches that are destroyed
+    /// during program exit can still unregister.
+    MemoryGovernor& memory_governor() {
+      static MemoryGovernor* const governor = new MemoryGovernor();
+      return *governor;
+    }
+
+  }  // namespace
+
+  std::size_t memory_budget() { return memory_governor().budget(); }
+
+  void memory_budget(const std::size_t budget) {
+    memory_governor().budget(budget);
+  }
+
+  std::size_t memory_min_free() { return memory_governor().min_free(); }
+
+  void memory_min_free(const std::size_t min_free) {
+    memory_governor().min_free(min_free);
+  }
+
+  std::size_t register_memory_cache(const CachePriority priority,
+      const std::function<std::size_t()>& size,
+      const std::function<std::size_t(std::size_t)>& evict)
+  {
+    return memory_governor().insert(priority, size, evict);
+  }
+
+  void unregister_memory_cache(const std::size_t id) {
+    memory_governor().erase(id);
+  }
+
+  std::size_t memory_cache_bytes() { return memory_governor().size(); }
+
+  std::size_t relieve_memory_pressure() { return memory_governor().relieve(); }
+
+  namespace detail {
+
+    bool memory_governor_bounded() { return memory_governor().bounded(); }
+
+    std::size_t memory_headroom(const std::size_t bytes) {
+      return memory_governor().headroom(bytes);
+    }
+
+    void memory_governor_poll() { memory_governor().poll(); }
+
+  }  // namespace detail
+} // namespace TiledArray
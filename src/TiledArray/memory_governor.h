@@ -0,0 +1,139 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  memory_governor.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MEMORY_GOVERNOR_H__INCLUDED
+#define TILEDARRAY_MEMORY_GOVERNOR_H__INCLUDED
+
+#include <cstddef>
+#include <functional>
+
+namespace TiledArray {
+
+  /// Eviction priority of a cache
+
+  /// When memory is needed, the caches with the lowest priority are evicted
+  /// first.
+  enum class CachePriority {
+    free_memory = 0,    ///< Free memory blocks held for reuse
+    lazy_tiles = 1,     ///< Converted tiles of the lazy tile cache
+    prefetch = 2,       ///< Tiles fetched ahead of their use
+    permuted_tiles = 3, ///< Permuted tiles of array permutation caches
+    replicas = 4        ///< Replicated arrays
+  }; // enum class CachePriority
+
+  /// Memory budget accessor
+
+  /// The memory governor keeps the caches that are registered with it (see
+  /// \c register_memory_cache() ) within a budget, and reports the memory
+  /// that is left to SUMMA, which reduces the number of concurrent
+  /// iterations instead of running out of memory. The budget is initialized
+  /// with the \c TA_MEMORY_BUDGET environment variable, in bytes per
+  /// process; the default budget is zero, which does not bound the caches.
+  /// \return The largest number of bytes held by the caches and SUMMA
+  /// iterations of this process, or zero
+  std::size_t memory_budget();
+
+  /// Set the memory budget
+
+  /// \param budget The largest number of bytes held by the caches and SUMMA
+  /// iterations of this process; zero does not bound them
+  void memory_budget(const std::size_t budget);
+
+  /// Free node memory accessor
+
+  /// The caches are also evicted when the physical memory that is free on
+  /// this node is less than this limit. The limit is initialized with the
+  /// \c TA_MEMORY_MIN_FREE environment variable, in bytes per node; the
+  /// default limit is zero, which does not check the free memory.
+  /// \return The smallest number of free bytes on this node, or zero
+  std::size_t memory_min_free();
+
+  /// Set the free node memory limit
+
+  /// \param min_free The smallest number of free bytes on this node; zero
+  /// does not check the free memory
+  void memory_min_free(const std::size_t min_free);
+
+  /// Register a cache with the memory governor
+
+  /// The functions may be called by any thread, and must not call the
+  /// functions of the memory governor.
+  /// \param priority The eviction priority of the cache
+  /// \param size A function that returns the number of bytes held by the
+  /// cache
+  /// \param evict A function that removes entries of the cache to free at
+  /// least the given number of bytes, if possible, and returns the number
+  /// of bytes freed
+  /// \return The id of the cache, which is given to
+  /// \c unregister_memory_cache()
+  std::size_t register_memory_cache(const CachePriority priority,
+      const std::function<std::size_t()>& size,
+      const std::function<std::size_t(std::size_t)>& evict);
+
+  /// Unregister a cache from the memory governor
+
+  /// The functions of the cache are not called after this returns.
+  /// \param id The id returned by \c register_memory_cache()
+  void unregister_memory_cache(const std::size_t id);
+
+  /// Size of the registered caches
+
+  /// \return The number of bytes held by the caches that are registered with
+  /// the memory governor
+  std::size_t memory_cache_bytes();
+
+  /// Evict caches that exceed the memory limits
+
+  /// Entries are evicted, in order of increasing priority, until the caches
+  /// fit in the memory budget and the free node memory is not less than
+  /// \c memory_min_free() .
+  /// \return The number of bytes evicted
+  std::size_t relieve_memory_pressure();
+
+  namespace detail {
+
+    /// Check for memory limits
+
+    /// \return \c true if the memory budget or the free node memory limit is
+    /// set
+    bool memory_governor_bounded();
+
+    /// Make room for memory that is about to be used
+
+    /// Caches are evicted, in order of increasing priority, so that
+    /// \c bytes fit in the memory budget with the caches, and in the free
+    /// node memory above \c memory_min_free() , which is divided evenly
+    /// between the processes of the node. The memory is not reserved.
+    /// \param bytes The number of bytes that will be used
+    /// \return The number of bytes, up to \c bytes , that fit in the memory
+    /// limits
+    std::size_t memory_headroom(const std::size_t bytes);
+
+    /// Evict caches that exceed the memory limits, at most every 100 ms
+
+    /// This is called when an entry is added to a registered cache.
+    void memory_governor_poll();
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MEMORY_GOVERNOR_H__INCLUDED
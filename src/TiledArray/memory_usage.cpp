@@ -0,0 +1,62 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  memory_usage.cpp
+ *  Feb 10, 2017
+ *
+ */
+
+#include <TiledArray/memory_usage.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace TiledArray {
+  namespace detail {
+
+    WorldMemoryTracker& world_memory_tracker(const World& world) {
+      // The trackers are never destroyed, since tiles may outlive their world
+      static std::mutex lock;
+      static std::unordered_map<unsigned long,
+          std::unique_ptr<WorldMemoryTracker> > trackers;
+
+      std::lock_guard<std::mutex> locker(lock);
+      std::unique_ptr<WorldMemoryTracker>& tracker = trackers[world.id()];
+      if(! tracker)
+        tracker.reset(new WorldMemoryTracker());
+      return *tracker;
+    }
+
+  }  // namespace detail
+
+  MemoryUsage memory_usage(const World& world) {
+    return detail::world_memory_tracker(world).usage();
+  }
+
+  std::size_t memory_high_water(const World& world) {
+    return detail::world_memory_tracker(world).high_water();
+  }
+
+  void reset_memory_high_water(const World& world) {
+    detail::world_memory_tracker(world).reset_high_water();
+  }
+
+  LazyCleanupStats lazy_cleanup_stats(const World& world) {
+    return detail::world_memory_tracker(world).cleanup();
+  }
+
+} // namespace TiledArray
@@ -0,0 +1,232 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  memory_usage.h
+ *  Feb 10, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_MEMORY_USAGE_H__INCLUDED
+#define TILEDARRAY_MEMORY_USAGE_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/tensor/type_traits.h>
+#include <atomic>
+
+namespace TiledArray {
+
+  // Forward declaration
+  template <typename> class Tile;
+
+  /// Memory footprint of tiles held by this process
+  struct MemoryUsage {
+    std::size_t local_bytes; ///< The size of the local tiles that have been set
+    std::size_t pending_bytes; ///< The expected size of the local tiles that have not been set
+    std::size_t cache_bytes; ///< The size of the remote tiles that are cached
+
+    /// Total footprint
+
+    /// \return The sum of the local, pending, and cache bytes
+    std::size_t total_bytes() const {
+      return local_bytes + pending_bytes + cache_bytes;
+    }
+  }; // struct MemoryUsage
+
+  /// Arrays that wait for lazy cleanup on this process
+  struct LazyCleanupStats {
+    std::size_t arrays; ///< The number of arrays that have not been deleted
+    std::size_t bytes; ///< The footprint of those arrays when they were released
+  }; // struct LazyCleanupStats
+
+  /// Memory footprint of all arrays in \c world on this process
+
+  /// \param world The world of the arrays
+  /// \return The current footprint of the tiles of all arrays in \c world
+  MemoryUsage memory_usage(const World& world);
+
+  /// Largest memory footprint of all arrays in \c world on this process
+
+  /// \param world The world of the arrays
+  /// \return The largest total footprint, in bytes, since \c world was first
+  /// used or since the last call to \c reset_memory_high_water()
+  std::size_t memory_high_water(const World& world);
+
+  /// Reset the high-water mark of \c world to the current footprint
+
+  /// \param world The world of the arrays
+  void reset_memory_high_water(const World& world);
+
+  /// Arrays of \c world that wait for lazy cleanup on this process
+
+  /// The implementation of an array is deleted once the array has been
+  /// released on all processes, see \c DistArray::wait_for_lazy_cleanup() .
+  /// \param world The world of the arrays
+  /// \return The number and footprint of the arrays that have been released
+  /// on this process but not deleted
+  LazyCleanupStats lazy_cleanup_stats(const World& world);
+
+  namespace detail {
+
+    /// Memory footprint categories
+    enum class MemoryCategory {
+      local,   ///< Local tiles that have been set
+      pending, ///< Local tiles that have not been set
+      cache    ///< Cached remote tiles
+    }; // enum class MemoryCategory
+
+    /// Memory footprint of a tile
+
+    /// The default footprint of a tile is the size of the tile object;
+    /// overload this function for tile types that hold heap memory.
+    /// \tparam T The tile type
+    /// \return The size of \c tile in bytes
+    template <typename T>
+    inline std::size_t tile_bytes(const T&) { return sizeof(T); }
+
+    template <typename T, typename A>
+    inline std::size_t tile_bytes(const Tensor<T, A>& tile) {
+      // Views of external data, e.g. memory mapped files, are not counted
+      return (tile.is_view() ? 0ul : tile.size() * sizeof(T));
+    }
+
+    template <typename T>
+    inline std::size_t tile_bytes(const Tile<T>& tile) {
+      return (tile.empty() ? 0ul : tile_bytes(tile.tensor()));
+    }
+
+    /// Memory footprint counters of a world
+    class WorldMemoryTracker {
+      std::atomic<std::size_t> bytes_[3]; ///< The footprint of each category
+      std::atomic<std::size_t> total_; ///< The total footprint
+      std::atomic<std::size_t> high_water_; ///< The largest total footprint
+      std::atomic<std::size_t> cleanup_arrays_; ///< Arrays waiting for lazy cleanup
+      std::atomic<std::size_t> cleanup_bytes_; ///< The footprint of those arrays
+
+    public:
+
+      WorldMemoryTracker() :
+        total_(0ul), high_water_(0ul), cleanup_arrays_(0ul), cleanup_bytes_(0ul)
+      {
+        for(std::atomic<std::size_t>& bytes : bytes_)
+          bytes.store(0ul);
+      }
+
+      /// Add \c bytes to \c category
+      void add(const MemoryCategory category, const std::size_t bytes) {
+        bytes_[static_cast<int>(category)].fetch_add(bytes, std::memory_order_relaxed);
+        const std::size_t total = total_.fetch_add(bytes) + bytes;
+        std::size_t high_water = high_water_.load(std::memory_order_relaxed);
+        while((total > high_water) &&
+            ! high_water_.compare_exchange_weak(high_water, total)) { }
+      }
+
+      /// Remove \c bytes from \c category
+      void sub(const MemoryCategory category, const std::size_t bytes) {
+        bytes_[static_cast<int>(category)].fetch_sub(bytes, std::memory_order_relaxed);
+        total_.fetch_sub(bytes);
+      }
+
+      /// \return The current footprint
+      MemoryUsage usage() const {
+        return MemoryUsage{ bytes_[0].load(), bytes_[1].load(), bytes_[2].load() };
+      }
+
+      /// \return The largest total footprint
+      std::size_t high_water() const { return high_water_.load(); }
+
+      /// Reset the high-water mark to the current footprint
+      void reset_high_water() { high_water_.store(total_.load()); }
+
+      /// Record an array, with a footprint of \c bytes , that waits for lazy cleanup
+      void cleanup_add(const std::size_t bytes) {
+        cleanup_arrays_.fetch_add(1ul);
+        cleanup_bytes_.fetch_add(bytes);
+      }
+
+      /// Record the lazy cleanup of an array with a footprint of \c bytes
+      void cleanup_sub(const std::size_t bytes) {
+        cleanup_arrays_.fetch_sub(1ul);
+        cleanup_bytes_.fetch_sub(bytes);
+      }
+
+      /// \return The arrays that wait for lazy cleanup
+      LazyCleanupStats cleanup() const {
+        return LazyCleanupStats{ cleanup_arrays_.load(), cleanup_bytes_.load() };
+      }
+
+    }; // class WorldMemoryTracker
+
+    /// Memory footprint counters of \c world
+
+    /// \param world The world
+    /// \return The counters that are shared by all arrays in \c world
+    WorldMemoryTracker& world_memory_tracker(const World& world);
+
+    /// Memory footprint counters of a distributed container
+
+    /// All changes are forwarded to the counters of the world, and the
+    /// remaining footprint is removed from the world when the counters are
+    /// destroyed.
+    class MemoryCounter {
+      WorldMemoryTracker& tracker_; ///< The world counters
+      std::atomic<std::size_t> bytes_[3]; ///< The footprint of each category
+
+    public:
+
+      explicit MemoryCounter(const World& world) :
+        tracker_(world_memory_tracker(world))
+      {
+        for(std::atomic<std::size_t>& bytes : bytes_)
+          bytes.store(0ul);
+      }
+
+      MemoryCounter(const MemoryCounter&) = delete;
+      MemoryCounter& operator=(const MemoryCounter&) = delete;
+
+      ~MemoryCounter() {
+        sub(MemoryCategory::local, bytes_[0].load());
+        sub(MemoryCategory::pending, bytes_[1].load());
+        sub(MemoryCategory::cache, bytes_[2].load());
+      }
+
+      /// Add \c bytes to \c category
+      void add(const MemoryCategory category, const std::size_t bytes) {
+        if(bytes == 0ul)
+          return;
+        bytes_[static_cast<int>(category)].fetch_add(bytes, std::memory_order_relaxed);
+        tracker_.add(category, bytes);
+      }
+
+      /// Remove \c bytes from \c category
+      void sub(const MemoryCategory category, const std::size_t bytes) {
+        if(bytes == 0ul)
+          return;
+        bytes_[static_cast<int>(category)].fetch_sub(bytes, std::memory_order_relaxed);
+        tracker_.sub(category, bytes);
+      }
+
+      /// \return The current footprint
+      MemoryUsage usage() const {
+        return MemoryUsage{ bytes_[0].load(), bytes_[1].load(), bytes_[2].load() };
+      }
+
+    }; // class MemoryCounter
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MEMORY_USAGE_H__INCLUDED
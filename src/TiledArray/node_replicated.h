@@ -0,0 +1,226 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  node_replicated.h
+ *  Feb 27, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_NODE_REPLICATED_H__INCLUDED
+#define TILEDARRAY_NODE_REPLICATED_H__INCLUDED
+
+#include <TiledArray/mapped_array.h>
+#include <TiledArray/proc_grid.h>
+#include <TiledArray/pmap/replicated_pmap.h>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// A POSIX shared memory segment
+
+    /// The segment is created by one process of a node and opened by the
+    /// other processes of the same node. Writable mappings are shared by all
+    /// processes, while read mappings are private and copy-on-write: pages
+    /// are shared until they are modified by a process.
+    class SharedSegment {
+      unsigned char* data_; ///< The mapped data
+      std::size_t size_; ///< The size of the mapped data
+
+    public:
+
+      /// Segment mapping modes
+      enum class Mode {
+        create, ///< Create a new segment and map it for writing
+        write,  ///< Map an existing segment for writing
+        read    ///< Map an existing segment privately
+      }; // enum class Mode
+
+      /// Map a shared memory segment
+
+      /// \param name The name of the segment
+      /// \param size The size of the segment in bytes
+      /// \param mode The mapping mode
+      /// \throw TiledArray::Exception When the segment cannot be mapped
+      SharedSegment(const std::string& name, const std::size_t size,
+          const Mode mode) :
+        data_(nullptr), size_(size)
+      {
+        TA_ASSERT(size_ > 0ul);
+        const int fd = (mode == Mode::create ?
+            ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) :
+            ::shm_open(name.c_str(), O_RDWR, 0600));
+        if(fd < 0)
+          TA_EXCEPTION("Unable to open shared memory segment.");
+        if((mode == Mode::create) && (::ftruncate(fd, size_) != 0)) {
+          ::close(fd);
+          ::shm_unlink(name.c_str());
+          TA_EXCEPTION("Unable to allocate shared memory segment.");
+        }
+
+        void* const data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+            (mode == Mode::read ? MAP_PRIVATE : MAP_SHARED), fd, 0);
+        ::close(fd);
+        if(data == MAP_FAILED)
+          TA_EXCEPTION("Unable to map shared memory segment.");
+        data_ = static_cast<unsigned char*>(data);
+      }
+
+      SharedSegment(const SharedSegment&) = delete;
+      SharedSegment& operator=(const SharedSegment&) = delete;
+
+      ~SharedSegment() { ::munmap(data_, size_); }
+
+      /// Remove the name of a segment
+
+      /// The memory of the segment is released once all processes have
+      /// unmapped it.
+      /// \param name The name of the segment
+      static void unlink(const std::string& name) { ::shm_unlink(name.c_str()); }
+
+      /// \return A pointer to the mapped data
+      unsigned char* data() const { return data_; }
+
+      /// \return The size of the mapped data in bytes
+      std::size_t size() const { return size_; }
+
+    }; // class SharedSegment
+
+  }  // namespace detail
+
+  /// Replicate an array once per node in shared memory
+
+  /// This is an alternative to \c DistArray::make_replicated() for processes
+  /// that share a node. The tiles are copied to a shared memory segment on
+  /// each node: the tiles owned by a process of the node are written by
+  /// their owner, and every other non-zero tile is fetched once per node, by
+  /// one of its processes. Every process then holds all tiles as views of
+  /// the segment, so each tile is received once per node and stored once per
+  /// node instead of once per process. The views are private copy-on-write
+  /// mappings: a process that modifies a tile modifies its own copy of the
+  /// modified pages. Views are not counted by \c memory_usage() . This
+  /// function is collective.
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Policy The array policy type
+  /// \param array The array to be replicated
+  /// \param node_procs The number of processes on each node; the processes
+  /// of each node must be consecutive ranks that share memory. The default
+  /// is the node layout of \c ProcGrid::node_procs() .
+  /// \throw TiledArray::Exception When the shared memory segment cannot be
+  /// created or mapped
+  template <typename T, typename A, typename Policy>
+  void make_node_replicated(DistArray<Tensor<T, A>, Policy>& array,
+      std::size_t node_procs = 0ul)
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "Node replicated arrays must have trivially copyable elements.");
+    typedef DistArray<Tensor<T, A>, Policy> array_type;
+    World& world = array.world();
+    const ProcessID rank = world.rank();
+    if(node_procs == 0ul)
+      node_procs = detail::ProcGrid::node_procs(world);
+    TA_USER_ASSERT(node_procs > 0ul,
+        "make_node_replicated(): the number of processes per node must be positive.");
+
+    // The processes of this node
+    const ProcessID leader = rank - (rank % node_procs);
+    const ProcessID node_size = std::min<ProcessID>(node_procs,
+        world.size() - leader);
+
+    // Lay out the non-zero tiles in the segment
+    std::vector<std::uint64_t> offsets(array.size(), 0ul);
+    std::uint64_t bytes = 0ul;
+    for(std::size_t i = 0ul; i < array.size(); ++i) {
+      if(array.is_zero(i))
+        continue;
+      offsets[i] = bytes;
+      bytes = detail::mapped_array_align(bytes +
+          array.trange().make_tile_range(i).volume() * sizeof(T));
+    }
+    if(bytes == 0ul) {
+      array.make_replicated();
+      return;
+    }
+
+    // The segment name is unique to the node leader and to this call, which
+    // is collective, so it is the same on all processes of the node.
+    static unsigned long count = 0ul;
+    ++count;
+    std::vector<long> pids(world.size(), 0l);
+    pids[rank] = ::getpid();
+    world.gop.sum(pids.data(), pids.size());
+    const std::string name = "/tiledarray." + std::to_string(pids[leader]) +
+        "." + std::to_string(leader) + "." + std::to_string(count);
+
+    std::shared_ptr<detail::SharedSegment> segment;
+    if(rank == leader)
+      segment = std::make_shared<detail::SharedSegment>(name, bytes,
+          detail::SharedSegment::Mode::create);
+    world.gop.fence();
+    if(rank != leader)
+      segment = std::make_shared<detail::SharedSegment>(name, bytes,
+          detail::SharedSegment::Mode::write);
+
+    // Write the local tiles, and the remote tiles that this process fetches
+    // for the node
+    std::vector<std::pair<std::size_t, Future<Tensor<T, A> > > > tiles;
+    for(std::size_t i = 0ul; i < array.size(); ++i) {
+      if(array.is_zero(i))
+        continue;
+      const ProcessID owner = array.owner(i);
+      if((owner == rank) || (((owner < leader) || (owner >= leader + node_size))
+          && (ProcessID(i % node_size) == (rank - leader))))
+        tiles.emplace_back(i, array.find(i));
+    }
+    for(auto& tile : tiles) {
+      const Tensor<T, A> value = tile.second.get();
+      TA_ASSERT(value.range() == array.trange().make_tile_range(tile.first));
+      std::memcpy(segment->data() + offsets[tile.first], value.data(),
+          value.size() * sizeof(T));
+    }
+    tiles.clear();
+    world.gop.fence();
+
+    // Map the segment privately and remove its name once all processes of
+    // the node have mapped it
+    std::shared_ptr<detail::SharedSegment> mapped =
+        std::make_shared<detail::SharedSegment>(name, bytes,
+            detail::SharedSegment::Mode::read);
+    segment.reset();
+    world.gop.fence();
+    if(rank == leader)
+      detail::SharedSegment::unlink(name);
+
+    // Construct the replicated tiles as views of the segment
+    std::shared_ptr<typename array_type::pmap_interface> pmap =
+        std::make_shared<detail::ReplicatedPmap>(world, array.size());
+    array_type result(world, array.trange(), array.shape(), pmap);
+    for(std::size_t i = 0ul; i < array.size(); ++i)
+      if(! result.is_zero(i))
+        result.set(i, Tensor<T, A>(array.trange().make_tile_range(i),
+            reinterpret_cast<T*>(mapped->data() + offsets[i]), mapped));
+
+    array = result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_NODE_REPLICATED_H__INCLUDED
@@ -0,0 +1,191 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  permuted_array.h
+ *  May 24, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_PERMUTED_ARRAY_H__INCLUDED
+#define TILEDARRAY_PERMUTED_ARRAY_H__INCLUDED
+
+#include <TiledArray/conversions/permute.h>
+#include <TiledArray/dist_array.h>
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+
+  /// An array that is stored in a permuted layout
+
+  /// The array is stored in the layout in which an expression evaluates it
+  /// most cheaply, which is called the physical layout, and it is used in
+  /// the layout that the user annotated, which is called the logical
+  /// layout. The two are related by a permutation, \c perm() , which maps
+  /// the physical dimensions to the logical dimensions, so the logical
+  /// tiled range is <tt>perm() * array().trange()</tt> . Physical tiles are
+  /// never permuted to the logical layout when the array is assigned: an
+  /// annotation of the logical dimensions, \c operator() , is translated to
+  /// an annotation of the physical array, so expressions that use the array
+  /// permute its tiles only if their own layout requires it, e.g. not at all
+  /// in contractions that permute their arguments in the kernel. Tiles are
+  /// permuted on demand by \c find() , and the whole array is permuted by
+  /// \c materialize() , e.g.
+  /// \code
+  /// PermutedArray<TensorD, DensePolicy> c;
+  /// c.assign("i,j,a,b", t("a,b,k,l") * v("k,l,i,j")); // stored as (a,b,i,j)
+  /// r("i,j,a,b") = c("i,j,a,b") + w("i,j,a,b");
+  /// \endcode
+  /// \tparam Tile The tile type
+  /// \tparam Policy The array policy type
+  template <typename Tile, typename Policy>
+  class PermutedArray {
+  public:
+    typedef DistArray<Tile, Policy> array_type; ///< The physical array type
+    typedef typename array_type::value_type value_type; ///< Tile type
+    typedef typename array_type::size_type size_type; ///< Size type
+
+  private:
+    array_type array_; ///< The array in its physical layout
+    Permutation perm_; ///< The map of the physical dimensions to the logical dimensions
+
+    /// Permute a tile to the logical layout
+    static value_type permute_tile(const value_type& tile, const Permutation& perm) {
+      return permute(tile, perm);
+    }
+
+  public:
+
+    /// Construct an empty array
+    PermutedArray() = default;
+
+    /// Construct a permuted view of an array
+
+    /// \param array The array in its physical layout
+    /// \param perm The map of the physical dimensions of \c array to the
+    /// logical dimensions
+    PermutedArray(const array_type& array, const Permutation& perm) :
+      array_(array), perm_(perm)
+    {
+      TA_ASSERT((! perm) || (perm.dim() == array.trange().tiles_range().rank()));
+    }
+
+    /// Evaluate an expression without permuting its result
+
+    /// The expression is evaluated in the layout that it prefers for the
+    /// logical annotation \c vars , which is the layout that
+    /// \c ExprEngine::init_vars() selects, and the permutation to \c vars is
+    /// only recorded. The previous data of this array is released. This
+    /// function is collective.
+    /// \tparam D The expression type
+    /// \param vars The logical annotation of the result
+    /// \param expr The expression
+    /// \return A reference to this array
+    template <typename D>
+    PermutedArray& assign(const std::string& vars,
+        const expressions::Expr<D>& expr)
+    {
+      const expressions::VariableList target_vars(vars);
+      typename expressions::Expr<D>::engine_type engine(expr.derived());
+      engine.init_vars(target_vars);
+      const expressions::VariableList physical_vars = engine.vars();
+
+      array_ = array_type();
+      array_(physical_vars.string()) = expr;
+      perm_ = target_vars.permutation(physical_vars);
+      if(perm_ == perm_.identity())
+        perm_ = Permutation();
+      return *this;
+    }
+
+    /// \return The array in its physical layout
+    const array_type& array() const { return array_; }
+
+    /// \return The map of the physical dimensions to the logical dimensions
+    const Permutation& perm() const { return perm_; }
+
+    /// \return The world of the array
+    World& world() const { return array_.world(); }
+
+    /// \return The tiled range of the array in its logical layout
+    TiledRange trange() const {
+      return (perm_ ? perm_ * array_.trange() : array_.trange());
+    }
+
+    /// Annotate the logical dimensions of the array
+
+    /// \param vars The annotation of the logical dimensions
+    /// \return An expression of the physical array, annotated with the
+    /// variables of its physical dimensions
+    expressions::TsrExpr<const array_type, true>
+    operator()(const std::string& vars) const {
+      if(! perm_)
+        return array_(vars);
+      const expressions::VariableList logical_vars(vars);
+      TA_USER_ASSERT(logical_vars.dim() == perm_.dim(),
+          "PermutedArray::operator(): the annotation does not match the rank of the array.");
+      std::string physical_vars;
+      for(unsigned int d = 0u; d < perm_.dim(); ++d) {
+        if(d)
+          physical_vars += ",";
+        physical_vars += logical_vars[perm_[d]];
+      }
+      return array_(physical_vars);
+    }
+
+    /// Check for a zero tile
+
+    /// \tparam Index The tile index type
+    /// \param i The tile index in the logical layout
+    /// \return \c true if tile \c i is zero
+    template <typename Index>
+    bool is_zero(const Index& i) const {
+      return array_.is_zero(perm_ ? -perm_ * i : i);
+    }
+
+    /// Find a tile
+
+    /// The tile is permuted to the logical layout in a task, on the process
+    /// that calls this function.
+    /// \tparam Index The tile index type
+    /// \param i The tile index in the logical layout
+    /// \return The future of the tile in the logical layout
+    template <typename Index>
+    Future<value_type> find(const Index& i) const {
+      if(! perm_)
+        return array_.find(i);
+      return array_.world().taskq.add(& PermutedArray::permute_tile,
+          array_.find(-perm_ * i), perm_);
+    }
+
+    /// Permute the array to its logical layout
+
+    /// The tiles are permuted once by the owners of the result tiles, and
+    /// sent to them in batches, see \c permute_array() ; the result is an
+    /// ordinary array. This function is collective.
+    /// \return The array in its logical layout
+    array_type materialize() const {
+      return permute_array(array_, perm_);
+    }
+
+  }; // class PermutedArray
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_PERMUTED_ARRAY_H__INCLUDED
@@ -52,6 +52,19 @@ namespace TiledArray {
       const size_type block_size_plus_1_times_remainder_; ///< Cached value
       const size_type local_first_; ///< First tile of this process's block
       const size_type local_last_; ///< Last tile + 1 of this process's block
+      const FastDivisor block_size_div_; ///< Division by \c block_size_
+      const FastDivisor block_size_plus_1_div_; ///< Division by \c block_size_plus_1_
+
+      /// Compute the owner of a tile
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      size_type compute_owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return (tile < block_size_plus_1_times_remainder_ ?
+            block_size_plus_1_div_.divide(tile) :
+            block_size_div_.divide(tile - block_size_plus_1_times_remainder_) + remainder_);
+      }
 
     public:
       typedef Pmap::size_type size_type; ///< Key type
@@ -67,16 +80,15 @@ namespace TiledArray {
           block_size_plus_1_(block_size_ + 1),
           block_size_plus_1_times_remainder_(remainder_ * block_size_plus_1_),
           local_first_(rank_ * block_size_ + std::min<size_type>(rank_, remainder_)),
-          local_last_((rank_ + 1) * block_size_ + std::min<size_type>((rank_ + 1), remainder_))
+          local_last_((rank_ + 1) * block_size_ + std::min<size_type>((rank_ + 1), remainder_)),
+          // block_size_ is zero only when all tiles are in the first branch
+          // of compute_owner()
+          block_size_div_(std::max<size_type>(block_size_, 1ul)),
+          block_size_plus_1_div_(block_size_plus_1_)
       {
-        local_.reserve(local_last_ - local_first_);
-
-
-        // Construct a map of all local processes
-        for(size_type first = local_first_; first < local_last_; ++first) {
-          TA_ASSERT(BlockedPmap::owner(first) == rank_);
-          local_.push_back(first);
-        }
+        // The local tiles are the contiguous block of this process
+        Pmap::set_local_pattern(local_first_, 1ul, local_last_ - local_first_,
+            0ul, 1ul);
       }
 
       virtual ~BlockedPmap() { }
@@ -86,11 +98,21 @@ namespace TiledArray {
       /// \param tile The tile to be queried
       /// \return Processor that logically owns \c tile
       virtual size_type owner(const size_type tile) const {
-        TA_ASSERT(tile < size_);
-        return (tile < block_size_plus_1_times_remainder_ ?
-            tile / block_size_plus_1_ :
-            ((tile - block_size_plus_1_times_remainder_) / block_size_) + remainder_);
+        return compute_owner(tile);
+      }
+
+      /// Maps many tiles to the processors that own them
+
+      /// \param first A pointer to the first tile to be queried
+      /// \param last A pointer past the last tile to be queried
+      /// \param[out] result The owners of the tiles, in the same order
+      virtual void owners(const size_type* first, const size_type* last,
+          size_type* result) const
+      {
+        for(; first != last; ++first, ++result)
+          *result = compute_owner(*first);
       }
+      using Pmap::owners;
 
 
       /// Check that the tile is owned by this process
@@ -58,6 +58,29 @@ namespace TiledArray {
       const size_type cols_; ///< Number of tile columns to be mapped
       const size_type proc_cols_; ///< Number of process columns
       const size_type proc_rows_; ///< Number of process rows
+      const FastDivisor cols_div_; ///< Division by \c cols_
+      const FastDivisor proc_cols_div_; ///< Division by \c proc_cols_
+      const FastDivisor proc_rows_div_; ///< Division by \c proc_rows_
+
+      /// Compute the owner of a tile
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      size_type compute_owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        // Compute tile coordinate in tile grid
+        const size_type tile_row = cols_div_.divide(tile);
+        const size_type tile_col = tile - tile_row * cols_;
+        // Compute process coordinate of tile in the process grid
+        const size_type proc_row = proc_rows_div_.modulo(tile_row);
+        const size_type proc_col = proc_cols_div_.modulo(tile_col);
+        // Compute the process that owns tile
+        const size_type proc = proc_row * proc_cols_ + proc_col;
+
+        TA_ASSERT(proc < procs_);
+
+        return proc;
+      }
 
     public:
       typedef Pmap::size_type size_type; ///< Size type
@@ -75,7 +98,8 @@ namespace TiledArray {
       CyclicPmap(World& world, size_type rows, size_type cols,
           size_type proc_rows, size_type proc_cols) :
         Pmap(world, rows * cols), rows_(rows), cols_(cols),
-        proc_cols_(proc_cols), proc_rows_(proc_rows)
+        proc_cols_(proc_cols), proc_rows_(proc_rows), cols_div_(cols),
+        proc_cols_div_(proc_cols), proc_rows_div_(proc_rows)
       {
         // Check that the size is non-zero
         TA_ASSERT(rows_ >= 1ul);
@@ -86,28 +110,20 @@ namespace TiledArray {
         TA_ASSERT(proc_cols_ >= 1ul);
         TA_ASSERT((proc_rows_ * proc_cols_) <= procs_);
 
-        // Initialize local tile list
+        // Describe the local tiles, which are the process columns of the
+        // process rows of this rank
         if(rank_ < (proc_rows_ * proc_cols_)) {
           // Compute rank coordinates
           const size_type rank_row = rank_ / proc_cols_;
           const size_type rank_col = rank_ % proc_cols_;
 
-          const size_type local_rows =
-              (rows_ / proc_rows_) + ((rows_ % proc_rows_) < rank_row ? 1ul : 0ul);
-          const size_type local_cols =
-              (cols_ / proc_cols_) + ((cols_ % proc_cols_) < rank_col ? 1ul : 0ul);
-
-          // Allocate memory for the local tile list
-          local_.reserve(local_rows * local_cols);
-
-          // Iterate over local tiles
-          for(size_type i = rank_row; i < rows_; i += proc_rows_) {
-            const size_type row_end = (i + 1) * cols_;
-            for(size_type tile = i * cols_ + rank_col; tile < row_end; tile += proc_cols_) {
-              TA_ASSERT(CyclicPmap::owner(tile) == rank_);
-              local_.push_back(tile);
-            }
-          }
+          const size_type local_rows = (rank_row < rows_ ?
+              (rows_ - rank_row + proc_rows_ - 1ul) / proc_rows_ : 0ul);
+          const size_type local_cols = (rank_col < cols_ ?
+              (cols_ - rank_col + proc_cols_ - 1ul) / proc_cols_ : 0ul);
+
+          Pmap::set_local_pattern(rank_row * cols_ + rank_col, proc_cols_,
+              local_cols, proc_rows_ * cols_, local_rows);
         }
       }
 
@@ -127,28 +143,28 @@ namespace TiledArray {
       /// \param tile The tile to be queried
       /// \return Processor that logically owns \c tile
       virtual size_type owner(const size_type tile) const {
-        TA_ASSERT(tile < size_);
-        // Compute tile coordinate in tile grid
-        const size_type tile_row = tile / cols_;
-        const size_type tile_col = tile % cols_;
-        // Compute process coordinate of tile in the process grid
-        const size_type proc_row = tile_row % proc_rows_;
-        const size_type proc_col = tile_col % proc_cols_;
-        // Compute the process that owns tile
-        const size_type proc = proc_row * proc_cols_ + proc_col;
+        return compute_owner(tile);
+      }
 
-        TA_ASSERT(proc < procs_);
+      /// Maps many tiles to the processors that own them
 
-        return proc;
+      /// \param first A pointer to the first tile to be queried
+      /// \param last A pointer past the last tile to be queried
+      /// \param[out] result The owners of the tiles, in the same order
+      virtual void owners(const size_type* first, const size_type* last,
+          size_type* result) const
+      {
+        for(; first != last; ++first, ++result)
+          *result = compute_owner(*first);
       }
-
+      using Pmap::owners;
 
       /// Check that the tile is owned by this process
 
       /// \param tile The tile to be checked
       /// \return \c true if \c tile is owned by this process, otherwise \c false .
       virtual bool is_local(const size_type tile) const {
-        return (CyclicPmap::owner(tile) == rank_);
+        return (compute_owner(tile) == rank_);
       }
 
     }; // class CyclicPmap
@@ -0,0 +1,158 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  hierarchical_pmap.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_HIERARCHICAL_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_HIERARCHICAL_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/blocked_pmap.h>
+#include <TiledArray/proc_grid.h>
+#include <algorithm>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// A two-level process map of nodes and of the processes of each node
+
+    /// The tiles are first blocked among nodes, where each node receives
+    /// the tiles that \c BlockedPmap gives to its processes, so neighboring
+    /// tiles are held by one node and moved through shared memory. Within a
+    /// node, the block is distributed cyclically among the processes of the
+    /// node, so tiles that are used together, e.g. the tiles of a row, are
+    /// evaluated in parallel by all processes of the node. The processes of
+    /// each node are consecutive ranks, as for \c ProcGrid::node_procs() ,
+    /// and the map reports its node layout with \c node_procs() , so
+    /// \c DistributedStorage can tell node-local transfers from inter-node
+    /// ones.
+    class HierarchicalPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      const BlockedPmap blocked_; ///< The map of the node blocks
+      const size_type node_procs_; ///< The number of processes on each node
+      const FastDivisor node_procs_div_; ///< Division by \c node_procs_
+
+      /// The first tile of the block of a process in \c blocked_
+
+      /// \param proc The process, which may be \c procs_
+      /// \return The first tile of \c proc
+      size_type first_tile(const size_type proc) const {
+        const size_type block_size = size_ / procs_;
+        const size_type remainder = size_ % procs_;
+        return proc * block_size + std::min(proc, remainder);
+      }
+
+      /// Compute the owner of a tile
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      size_type compute_owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        const size_type leader =
+            node_procs_div_.divide(blocked_.owner(tile)) * node_procs_;
+        const size_type node_size = std::min(node_procs_, procs_ - leader);
+        return leader + (tile - first_tile(leader)) % node_size;
+      }
+
+      /// Find the number of processes on each node
+
+      /// \param world The world where the tiles will be mapped
+      /// \param node_procs The number of processes on each node, or zero
+      /// \return \c node_procs , or the node layout of \c world when it is
+      /// zero
+      static size_type init_node_procs(World& world, const size_type node_procs) {
+        return std::max<size_type>(1ul,
+            (node_procs ? node_procs : ProcGrid::node_procs(world)));
+      }
+
+    public:
+      typedef Pmap::size_type size_type; ///< Key type
+
+      /// Construct a hierarchical map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param size The number of tiles to be mapped
+      /// \param node_procs The number of processes on each node; the default
+      /// is the node layout of \c ProcGrid::node_procs() , which is
+      /// collective the first time it is called for \c world
+      HierarchicalPmap(World& world, const size_type size,
+          const size_type node_procs = 0ul) :
+          Pmap(world, size), blocked_(world, size),
+          node_procs_(init_node_procs(world, node_procs)),
+          node_procs_div_(node_procs_)
+      {
+        // The local tiles are every node_size-th tile of the node block
+        const size_type leader = node_procs_div_.divide(rank_) * node_procs_;
+        const size_type node_size = std::min(node_procs_, procs_ - leader);
+        const size_type first = first_tile(leader) + (rank_ - leader);
+        const size_type last = first_tile(std::min(leader + node_size, procs_));
+        const size_type count = (first < last ?
+            (last - first + node_size - 1ul) / node_size : 0ul);
+        Pmap::set_local_pattern(first, node_size, count, 0ul, 1ul);
+      }
+
+      virtual ~HierarchicalPmap() { }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        return compute_owner(tile);
+      }
+
+      /// Maps many tiles to the processors that own them
+
+      /// \param first A pointer to the first tile to be queried
+      /// \param last A pointer past the last tile to be queried
+      /// \param[out] result The owners of the tiles, in the same order
+      virtual void owners(const size_type* first, const size_type* last,
+          size_type* result) const
+      {
+        for(; first != last; ++first, ++result)
+          *result = compute_owner(*first);
+      }
+      using Pmap::owners;
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return compute_owner(tile) == rank_;
+      }
+
+      /// \return The number of processes on each node
+      virtual size_type node_procs() const { return node_procs_; }
+
+    }; // class HierarchicalPmap
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_PMAP_HIERARCHICAL_PMAP_H__INCLUDED
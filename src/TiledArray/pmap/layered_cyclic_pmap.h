@@ -0,0 +1,212 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  layered_cyclic_pmap.h
+ *  Jan 16, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_LAYERED_CYCLIC_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_LAYERED_CYCLIC_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Maps cyclically a matrix of indices onto a stack of 2-d process matrices
+
+    /// The processes are organized into \f$ L \f$ layers, each of which is a
+    /// matrix of processes with \f$ P_{\rm row} \f$ rows and
+    /// \f$ P_{\rm col} \f$ columns, i.e. process
+    /// \f$ p \equiv \{ p_{\rm layer}, p_{\rm row}, p_{\rm col} \} \f$ with
+    /// \f$ p = p_{\rm layer} P_{\rm row} P_{\rm col} + p_{\rm row} P_{\rm col} + p_{\rm col} \f$.
+    /// The columns (or rows) of the index matrix are partitioned into \f$ L \f$
+    /// contiguous blocks of nearly equal size, and block \f$ l \f$ is mapped
+    /// cyclically, as with \c CyclicPmap, onto layer \f$ l \f$. This is the
+    /// distribution of the arguments of a layered (2.5D) SUMMA contraction,
+    /// where the layered dimension is the contracted dimension.
+    /// \note This class is used to map <em>tile</em> indices to processes.
+    class LayeredCyclicPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      const size_type rows_; ///< Number of tile rows to be mapped
+      const size_type cols_; ///< Number of tile columns to be mapped
+      const size_type proc_cols_; ///< Number of process columns in a layer
+      const size_type proc_rows_; ///< Number of process rows in a layer
+      const size_type layers_; ///< Number of process layers
+      const bool col_layers_; ///< \c true if columns are partitioned among layers
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// First index of a layer block
+
+      /// \param layer The layer index
+      /// \param layers The number of layers
+      /// \param n The number of indices partitioned among the layers
+      /// \return The first index assigned to \c layer ; the block of \c layer
+      /// is <tt>[layer_begin(layer, layers, n), layer_begin(layer + 1, layers, n))</tt>
+      static size_type layer_begin(const size_type layer, const size_type layers,
+          const size_type n)
+      {
+        TA_ASSERT(layers >= 1ul);
+        TA_ASSERT(layer <= layers);
+        return layer * (n / layers) + std::min(layer, n % layers);
+      }
+
+      /// Layer that holds an index
+
+      /// \param i The index
+      /// \param layers The number of layers
+      /// \param n The number of indices partitioned among the layers
+      /// \return The layer block that includes \c i
+      static size_type layer_index(const size_type i, const size_type layers,
+          const size_type n)
+      {
+        TA_ASSERT(layers >= 1ul);
+        TA_ASSERT(i < n);
+        const size_type block = n / layers;
+        const size_type rem = n % layers;
+        const size_type split = rem * (block + 1ul);
+        return (i < split ? i / (block + 1ul) : rem + (i - split) / block);
+      }
+
+      /// Construct process map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param rows The number of tile rows to be mapped
+      /// \param cols The number of tile columns to be mapped
+      /// \param proc_rows The number of process rows in each layer
+      /// \param proc_cols The number of process columns in each layer
+      /// \param layers The number of process layers
+      /// \param col_layers If \c true , the tile columns are partitioned among
+      /// the layers, otherwise the tile rows are partitioned
+      /// \throw TiledArray::Exception When <tt>layers</tt> is greater than the
+      /// number of partitioned rows or columns
+      /// \throw TiledArray::Exception When <tt>layers * proc_rows * proc_cols > world.size()</tt>
+      LayeredCyclicPmap(World& world, size_type rows, size_type cols,
+          size_type proc_rows, size_type proc_cols, size_type layers,
+          const bool col_layers) :
+        Pmap(world, rows * cols), rows_(rows), cols_(cols),
+        proc_cols_(proc_cols), proc_rows_(proc_rows), layers_(layers),
+        col_layers_(col_layers)
+      {
+        // Check that the size is non-zero
+        TA_ASSERT(rows_ >= 1ul);
+        TA_ASSERT(cols_ >= 1ul);
+
+        // Check limits of process rows, columns, and layers
+        TA_ASSERT(proc_rows_ >= 1ul);
+        TA_ASSERT(proc_cols_ >= 1ul);
+        TA_ASSERT(layers_ >= 1ul);
+        TA_ASSERT(layers_ <= (col_layers_ ? cols_ : rows_));
+        TA_ASSERT((layers_ * proc_rows_ * proc_cols_) <= procs_);
+
+        // Initialize local tile list
+        const size_type layer_size = proc_rows_ * proc_cols_;
+        if(rank_ < (layers_ * layer_size)) {
+          // Compute rank coordinates
+          const size_type rank_layer = rank_ / layer_size;
+          const size_type rank_row = (rank_ % layer_size) / proc_cols_;
+          const size_type rank_col = rank_ % proc_cols_;
+
+          // Compute the layer block of rows or columns
+          const size_type n = (col_layers_ ? cols_ : rows_);
+          const size_type begin = layer_begin(rank_layer, layers_, n);
+          const size_type end = layer_begin(rank_layer + 1ul, layers_, n);
+          const size_type row_begin = (col_layers_ ? 0ul : begin);
+          const size_type row_end = (col_layers_ ? rows_ : end);
+          const size_type col_begin = (col_layers_ ? begin : 0ul);
+          const size_type col_end = (col_layers_ ? end : cols_);
+
+          // Iterate over local tiles
+          for(size_type i = row_begin + (rank_row + proc_rows_ - (row_begin % proc_rows_)) % proc_rows_;
+              i < row_end; i += proc_rows_)
+          {
+            for(size_type j = col_begin + (rank_col + proc_cols_ - (col_begin % proc_cols_)) % proc_cols_;
+                j < col_end; j += proc_cols_)
+            {
+              const size_type tile = i * cols_ + j;
+              TA_ASSERT(LayeredCyclicPmap::owner(tile) == rank_);
+              local_.push_back(tile);
+            }
+          }
+        }
+      }
+
+      virtual ~LayeredCyclicPmap() { }
+
+      /// Access number of rows in the tile index matrix
+      size_type nrows() const { return rows_; }
+      /// Access number of columns in the tile index matrix
+      size_type ncols() const { return cols_; }
+      /// Access number of rows in each layer of the process matrix
+      size_type nrows_proc() const { return proc_rows_; }
+      /// Access number of columns in each layer of the process matrix
+      size_type ncols_proc() const { return proc_cols_; }
+      /// Access number of process layers
+      size_type nlayers_proc() const { return layers_; }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        // Compute tile coordinate in tile grid
+        const size_type tile_row = tile / cols_;
+        const size_type tile_col = tile % cols_;
+        // Compute process coordinate of tile in the process grid
+        const size_type proc_layer = (col_layers_ ?
+            layer_index(tile_col, layers_, cols_) :
+            layer_index(tile_row, layers_, rows_));
+        const size_type proc_row = tile_row % proc_rows_;
+        const size_type proc_col = tile_col % proc_cols_;
+        // Compute the process that owns tile
+        const size_type proc = (proc_layer * proc_rows_ + proc_row) * proc_cols_
+            + proc_col;
+
+        TA_ASSERT(proc < procs_);
+
+        return proc;
+      }
+
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return (LayeredCyclicPmap::owner(tile) == rank_);
+      }
+
+    }; // class LayeredCyclicPmap
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+
+#endif // TILEDARRAY_PMAP_LAYERED_CYCLIC_PMAP_H__INCLUDED
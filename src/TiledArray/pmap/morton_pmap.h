@@ -0,0 +1,168 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  morton_pmap.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_MORTON_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_MORTON_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/range.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// A process map that blocks tiles in Morton order
+
+    /// \c BlockedPmap assigns contiguous blocks of row-major tile ordinals
+    /// to processes, so tiles that are neighbors in a slow dimension of a
+    /// 3 or 4 dimensional array are usually owned by different processes.
+    /// This map assigns contiguous blocks of the Morton (Z-order) curve of
+    /// the tiles range instead, so each process owns compact
+    /// multidimensional neighborhoods, and blocks of the array, e.g. the
+    /// arguments of block expressions and the pieces of \c retile() , are
+    /// owned by fewer processes. The Morton key of a tile interleaves the
+    /// bits of its coordinates; dimensions whose extent needs fewer bits
+    /// drop out of the interleaving once their bits are exhausted, so the
+    /// curve also fits extents that are not powers of two. The owner of each
+    /// tile is computed when the map is constructed and stored, which takes
+    /// O(tiles) memory, like the replicated shape of a sparse array.
+    class MortonPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      std::vector<std::uint32_t> owners_; ///< The owner of each tile
+
+      /// The Morton key of each tile
+
+      /// \param tiles_range The tiles range of the array
+      /// \return The Morton key of each tile, by tile ordinal
+      static std::vector<std::uint64_t> morton_keys(const Range& tiles_range) {
+        const unsigned int rank = tiles_range.rank();
+        const size_type* const extent = tiles_range.extent_data();
+
+        // The number of bits of the coordinates of each dimension
+        std::vector<unsigned int> bits(rank, 0u);
+        unsigned int max_bits = 0u, total_bits = 0u;
+        for(unsigned int d = 0u; d < rank; ++d) {
+          while((size_type(1) << bits[d]) < extent[d])
+            ++bits[d];
+          max_bits = std::max(max_bits, bits[d]);
+          total_bits += bits[d];
+        }
+        TA_USER_ASSERT(total_bits <= 64u,
+            "The tiles range is too large for a Morton process map.");
+
+        const size_type volume = tiles_range.volume();
+        std::vector<std::uint64_t> keys(volume);
+        std::vector<size_type> coord(rank, 0ul);
+        for(size_type i = 0ul; i < volume; ++i) {
+          // Interleave the bits of the coordinates, the first dimension being
+          // the most significant at each level
+          std::uint64_t key = 0ul;
+          for(unsigned int b = max_bits; b-- > 0u; )
+            for(unsigned int d = 0u; d < rank; ++d)
+              if(b < bits[d])
+                key = (key << 1) | ((coord[d] >> b) & 1ul);
+          keys[i] = key;
+
+          // Increment the row-major coordinate of the tile
+          for(unsigned int d = rank; d-- > 0u; ) {
+            if(++coord[d] < extent[d])
+              break;
+            coord[d] = 0ul;
+          }
+        }
+
+        return keys;
+      }
+
+    public:
+      typedef Pmap::size_type size_type; ///< Key type
+
+      /// Construct a Morton process map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param tiles_range The tiles range of the array, e.g.
+      /// <tt>trange.tiles_range()</tt>
+      MortonPmap(World& world, const Range& tiles_range) :
+          Pmap(world, tiles_range.volume()), owners_(size_)
+      {
+        // Sort the tiles along the curve
+        const std::vector<std::uint64_t> keys = morton_keys(tiles_range);
+        std::vector<size_type> order(size_);
+        for(size_type i = 0ul; i < size_; ++i)
+          order[i] = i;
+        std::sort(order.begin(), order.end(),
+            [&keys] (const size_type l, const size_type r) {
+              return keys[l] < keys[r];
+            });
+
+        // Block the curve like BlockedPmap blocks the tile ordinals
+        const size_type block_size = size_ / procs_;
+        const size_type remainder = size_ % procs_;
+        size_type position = 0ul;
+        for(size_type p = 0ul; p < procs_; ++p) {
+          const size_type last = position + block_size + (p < remainder ? 1ul : 0ul);
+          for(; position < last; ++position)
+            owners_[order[position]] = p;
+        }
+
+        // Construct a map of all local processes
+        for(size_type i = 0ul; i < size_; ++i)
+          if(owners_[i] == rank_)
+            local_.push_back(i);
+      }
+
+      virtual ~MortonPmap() { }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return owners_[tile];
+      }
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return MortonPmap::owner(tile) == rank_;
+      }
+
+    }; // class MortonPmap
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_PMAP_MORTON_PMAP_H__INCLUDED
@@ -28,9 +28,70 @@
 
 #include <TiledArray/madness.h>
 #include <TiledArray/error.h>
+#include <cstdint>
+#include <iterator>
+#include <vector>
 
 namespace TiledArray {
 
+  namespace detail {
+
+    /// Division by an invariant divisor without a division instruction
+
+    /// The quotient and remainder of 32-bit dividends are computed with
+    /// 128-bit multiplications by a precomputed reciprocal (Lemire, Kaser,
+    /// and Kurz, "Faster remainder by direct computation", 2019). Larger
+    /// dividends, and compilers without 128-bit integers, use the division
+    /// instruction.
+    class FastDivisor {
+      std::size_t divisor_; ///< The divisor
+#ifdef __SIZEOF_INT128__
+      std::uint64_t reciprocal_; ///< ceil(2^64 / divisor), or 0 when divisor is 1
+#endif // __SIZEOF_INT128__
+
+      static constexpr std::size_t max_fast_dividend = 0xFFFFFFFFul;
+
+    public:
+
+      /// \param divisor The divisor, which must be positive
+      explicit FastDivisor(const std::size_t divisor = 1ul) :
+        divisor_(divisor)
+#ifdef __SIZEOF_INT128__
+        , reciprocal_(divisor > 1ul && divisor <= max_fast_dividend ?
+            (~std::uint64_t(0)) / divisor + 1ul : 0ul)
+#endif // __SIZEOF_INT128__
+      {
+        TA_ASSERT(divisor_ > 0ul);
+      }
+
+      /// \return The divisor
+      std::size_t divisor() const { return divisor_; }
+
+      /// \param n The dividend
+      /// \return <tt>n / divisor()</tt>
+      std::size_t divide(const std::size_t n) const {
+#ifdef __SIZEOF_INT128__
+        if(reciprocal_ && n <= max_fast_dividend)
+          return std::size_t((static_cast<unsigned __int128>(reciprocal_) * n) >> 64);
+#endif // __SIZEOF_INT128__
+        return n / divisor_;
+      }
+
+      /// \param n The dividend
+      /// \return <tt>n % divisor()</tt>
+      std::size_t modulo(const std::size_t n) const {
+#ifdef __SIZEOF_INT128__
+        if(reciprocal_ && n <= max_fast_dividend)
+          return std::size_t((static_cast<unsigned __int128>(reciprocal_ * n) *
+              divisor_) >> 64);
+#endif // __SIZEOF_INT128__
+        return n % divisor_;
+      }
+
+    }; // class FastDivisor
+
+  }  // namespace detail
+
   /// Process map
 
   /// This is the base and interface class for other process maps. It provides
@@ -38,15 +99,102 @@ namespace TiledArray {
   /// Derived classes are responsible for distribution of tiles. The general
   /// idea of process map objects is to compute process owners with an O(1)
   /// algorithm to provide fast access to tile owner information and avoid
-  /// storage of process map. A cache a list of local tiles is stored so that
-  /// algorithms that need to iterate over local tiles can do so without
-  /// computing the owner of all tiles. The algorithm to generate the cached
-  /// list of local tiles and the memory requirement should scale as
-  /// O(tiles/processes), if possible.
+  /// storage of process map. The local tiles are either stored in a list, or,
+  /// for maps whose local tiles form a regular pattern, described by two
+  /// nested arithmetic sequences, see \c set_local_pattern() , so that the
+  /// memory of the map is O(1) and local tiles are enumerated with additions
+  /// only. Otherwise, the algorithm to generate the list of local tiles and
+  /// its memory requirement should scale as O(tiles/processes), if possible.
   class Pmap {
   public:
     typedef std::size_t size_type; ///< Size type
-    typedef std::vector<size_type>::const_iterator const_iterator; ///< Iterator type
+
+    /// Local tile iterator
+
+    /// The iterator walks the list of local tiles, or the local tile
+    /// pattern of the map.
+    class Iterator {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef size_type value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const size_type* pointer;
+      typedef const size_type& reference;
+
+    private:
+      const size_type* list_; ///< The current list element, or nullptr
+      size_type tile_; ///< The current tile of the pattern
+      size_type outer_first_; ///< The first tile of the current outer step
+      size_type inner_; ///< The inner step of the pattern
+      size_type outer_; ///< The outer step of the pattern
+      size_type inner_stride_; ///< The inner stride of the pattern
+      size_type inner_count_; ///< The inner count of the pattern
+      size_type outer_stride_; ///< The outer stride of the pattern
+
+    public:
+
+      Iterator() :
+        list_(nullptr), tile_(0ul), outer_first_(0ul), inner_(0ul),
+        outer_(0ul), inner_stride_(0ul), inner_count_(0ul), outer_stride_(0ul)
+      { }
+
+      /// List iterator constructor
+
+      /// \param list The list element
+      explicit Iterator(const size_type* list) :
+        list_(list), tile_(0ul), outer_first_(0ul), inner_(0ul),
+        outer_(0ul), inner_stride_(0ul), inner_count_(0ul), outer_stride_(0ul)
+      { }
+
+      /// Pattern iterator constructor
+
+      /// \param first The first tile of the pattern
+      /// \param inner_stride The inner stride of the pattern
+      /// \param inner_count The inner count of the pattern
+      /// \param outer_stride The outer stride of the pattern
+      /// \param outer The outer step of the iterator
+      Iterator(const size_type first, const size_type inner_stride,
+          const size_type inner_count, const size_type outer_stride,
+          const size_type outer) :
+        list_(nullptr), tile_(first + outer * outer_stride),
+        outer_first_(tile_), inner_(0ul), outer_(outer),
+        inner_stride_(inner_stride), inner_count_(inner_count),
+        outer_stride_(outer_stride)
+      { }
+
+      reference operator*() const { return (list_ ? *list_ : tile_); }
+      pointer operator->() const { return (list_ ? list_ : & tile_); }
+
+      Iterator& operator++() {
+        if(list_) {
+          ++list_;
+        } else if(++inner_ < inner_count_) {
+          tile_ += inner_stride_;
+        } else {
+          inner_ = 0ul;
+          ++outer_;
+          outer_first_ += outer_stride_;
+          tile_ = outer_first_;
+        }
+        return *this;
+      }
+
+      Iterator operator++(int) {
+        Iterator temp(*this);
+        ++(*this);
+        return temp;
+      }
+
+      bool operator==(const Iterator& other) const {
+        return (list_ == other.list_) && (outer_ == other.outer_) &&
+            (inner_ == other.inner_);
+      }
+
+      bool operator!=(const Iterator& other) const { return ! (*this == other); }
+
+    }; // class Iterator
+
+    typedef Iterator const_iterator; ///< Iterator type
 
   protected:
     const size_type rank_; ///< The rank of this process
@@ -55,10 +203,42 @@ namespace TiledArray {
     std::vector<size_type> local_; ///< A list of local tiles
 
   private:
+    bool pattern_; ///< The local tiles are given by a pattern
+    size_type first_; ///< The first local tile of the pattern
+    size_type inner_stride_; ///< The distance between tiles of an outer step
+    size_type inner_count_; ///< The number of tiles of an outer step
+    size_type outer_stride_; ///< The distance between outer steps
+    size_type outer_count_; ///< The number of outer steps
+
     // Not allowed
     Pmap(const Pmap&);
     Pmap& operator=(const Pmap&);
 
+  protected:
+
+    /// Describe the local tiles with a pattern instead of a list
+
+    /// The local tiles are <tt>first + o * outer_stride + i * inner_stride</tt>
+    /// for \c o in <tt>[0, outer_count)</tt> and \c i in
+    /// <tt>[0, inner_count)</tt> , in this order; \c local_ must be empty.
+    /// \param first The first local tile
+    /// \param inner_stride The distance between the tiles of an outer step
+    /// \param inner_count The number of tiles of an outer step
+    /// \param outer_stride The distance between outer steps
+    /// \param outer_count The number of outer steps
+    void set_local_pattern(const size_type first, const size_type inner_stride,
+        const size_type inner_count, const size_type outer_stride,
+        const size_type outer_count)
+    {
+      TA_ASSERT(local_.empty());
+      pattern_ = true;
+      first_ = first;
+      inner_stride_ = inner_stride;
+      inner_count_ = inner_count;
+      outer_stride_ = outer_stride;
+      outer_count_ = (inner_count ? outer_count : 0ul);
+    }
+
   public:
 
     /// Process map constructor
@@ -66,7 +246,9 @@ namespace TiledArray {
     /// \param world The world where the tiles will be mapped
     /// \param size The number of processes to be mapped
     Pmap(World& world, const size_type size) :
-      rank_(world.rank()), procs_(world.size()), size_(size), local_()
+      rank_(world.rank()), procs_(world.size()), size_(size), local_(),
+      pattern_(false), first_(0ul), inner_stride_(0ul), inner_count_(0ul),
+      outer_stride_(0ul), outer_count_(0ul)
     {
       TA_ASSERT(size_ > 0ul);
     }
@@ -79,6 +261,31 @@ namespace TiledArray {
     /// \return Processor that logically owns \c tile
     virtual size_type owner(const size_type tile) const = 0;
 
+    /// Maps many tiles to the processors that own them
+
+    /// Derived classes may override this function to compute the owners in
+    /// one loop, without a virtual call per tile.
+    /// \param first A pointer to the first tile to be queried
+    /// \param last A pointer past the last tile to be queried
+    /// \param[out] result The owners of the tiles, in the same order
+    virtual void owners(const size_type* first, const size_type* last,
+        size_type* result) const
+    {
+      for(; first != last; ++first, ++result)
+        *result = owner(*first);
+    }
+
+    /// Maps many tiles to the processors that own them
+
+    /// \param tiles The tiles to be queried
+    /// \return The owners of \c tiles , in the same order
+    std::vector<size_type> owners(const std::vector<size_type>& tiles) const {
+      std::vector<size_type> result(tiles.size());
+      if(! tiles.empty())
+        owners(tiles.data(), tiles.data() + tiles.size(), result.data());
+      return result;
+    }
+
     /// Check that the tile is owned by this process
 
     /// \param tile The tile to be checked
@@ -103,27 +310,56 @@ namespace TiledArray {
     /// Local size accessor
 
     /// \return The number of local elements
-    size_type local_size() const { return local_.size(); }
+    size_type local_size() const {
+      return (pattern_ ? inner_count_ * outer_count_ : local_.size());
+    }
 
     /// Check if there are any local elements
 
     /// \return \c true when there are no local tiles, otherwise \c false .
-    bool empty() const { return local_.empty(); }
+    bool empty() const { return local_size() == 0ul; }
 
     /// Replicated array status
 
     /// \return \c true if the array is replicated, and false otherwise
     virtual bool is_replicated() const { return false; }
 
+    /// Node layout accessor
+
+    /// Maps that are aware of the nodes, e.g. \c HierarchicalPmap , return
+    /// the number of processes on each node, where the processes of each
+    /// node are consecutive ranks.
+    /// \return The number of processes on each node, or 1 if the map does
+    /// not know the node layout
+    virtual size_type node_procs() const { return 1ul; }
+
+    /// Check that the tile is owned by a process of this node
+
+    /// \param tile The tile to be checked
+    /// \return \c true if \c tile is owned by a process on the node of this
+    /// process, otherwise \c false .
+    bool is_node_local(const size_type tile) const {
+      const size_type procs = node_procs();
+      return (owner(tile) / procs) == (rank_ / procs);
+    }
+
     /// Begin local element iterator
 
     /// \return An iterator that points to the beginning of the local element set
-    const_iterator begin() const { return local_.begin(); }
+    const_iterator begin() const {
+      return (pattern_ ?
+          const_iterator(first_, inner_stride_, inner_count_, outer_stride_, 0ul) :
+          const_iterator(local_.data()));
+    }
 
     /// End local element iterator
 
     /// \return An iterator that points to the beginning of the local element set
-    const_iterator end() const { return local_.end(); }
+    const_iterator end() const {
+      return (pattern_ ?
+          const_iterator(first_, inner_stride_, inner_count_, outer_stride_, outer_count_) :
+          const_iterator(local_.data() + local_.size()));
+    }
 
   }; // class Pmap
 
@@ -0,0 +1,190 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_pmap.h
+ *  Feb 23, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_SPARSE_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_SPARSE_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/sparse_shape.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// A process map that balances the cost of the non-zero tiles
+
+    /// Tiles are mapped to processes in contiguous blocks, like
+    /// \c BlockedPmap , but the blocks are sized so that each process holds
+    /// approximately the same total cost, rather than the same number of
+    /// tiles. By default, each non-zero tile of the shape costs one unit and
+    /// zero tiles are free, so the non-zero tiles are evenly distributed; a
+    /// cost function may be given to balance, e.g., the flops of each tile,
+    /// or the cost of each tile may be given directly; see
+    /// \c balanced_pmap() .
+    /// The map is computed independently, and identically, on each process
+    /// from the replicated shape, so no communication is required.
+    class SparsePmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      std::vector<size_type> first_; ///< The first tile of each process block,
+          ///< followed by the number of tiles
+
+      /// The cost of each tile of a shape
+
+      /// \tparam T The shape norm type
+      /// \param shape The shape of the tiles
+      /// \param cost The cost function of the non-zero tiles, or empty
+      /// \return The cost of each tile, where zero tiles are free
+      template <typename T>
+      static std::vector<double>
+      shape_costs(const SparseShape<T>& shape,
+          const std::function<double(std::size_t)>& cost)
+      {
+        const std::size_t size = shape.data().size();
+        std::vector<double> costs(size, 0.0);
+        for(std::size_t i = 0ul; i < size; ++i)
+          if(! shape.is_zero(i))
+            costs[i] = (cost ? cost(i) : 1.0);
+        return costs;
+      }
+
+    public:
+      typedef Pmap::size_type size_type; ///< Key type
+      typedef std::function<double(size_type)> cost_type; ///< Tile cost function type
+
+      /// Construct a sparse process map
+
+      /// \tparam T The shape norm type
+      /// \param world The world where the tiles will be mapped
+      /// \param shape The shape of the tiles to be mapped
+      /// \param cost A function that returns the nonnegative cost of a
+      /// non-zero tile given its ordinal index; when it is empty, each
+      /// non-zero tile costs one unit
+      template <typename T>
+      SparsePmap(World& world, const SparseShape<T>& shape,
+          const cost_type& cost = cost_type()) :
+          SparsePmap(world, shape_costs(shape, cost))
+      { }
+
+      /// Construct a process map from the cost of each tile
+
+      /// \param world The world where the tiles will be mapped
+      /// \param costs The nonnegative cost of each tile; when all costs are
+      /// zero, the tiles are distributed evenly
+      SparsePmap(World& world, std::vector<double> costs) :
+          Pmap(world, costs.size()), first_(procs_ + 1ul, size_)
+      {
+        double total = 0.0;
+        for(const double c : costs) {
+          TA_ASSERT(c >= 0.0);
+          total += c;
+        }
+
+        // Distribute tiles evenly when no tile has a cost
+        if(total <= 0.0) {
+          std::fill(costs.begin(), costs.end(), 1.0);
+          total = double(size_);
+        }
+
+        // Assign each tile to the process whose share of the total cost
+        // contains the midpoint of the tile cost.
+        double sum = 0.0;
+        size_type p = 0ul;
+        first_[0] = 0ul;
+        for(size_type i = 0ul; i < size_; ++i) {
+          const size_type owner = std::min<size_type>(procs_ - 1ul,
+              size_type(double(procs_) * (sum + 0.5 * costs[i]) / total));
+          for(; p < owner; ++p)
+            first_[p + 1ul] = i;
+          sum += costs[i];
+        }
+
+        // Construct a map of all local processes
+        local_.reserve(first_[rank_ + 1ul] - first_[rank_]);
+        for(size_type i = first_[rank_]; i < first_[rank_ + 1ul]; ++i) {
+          TA_ASSERT(SparsePmap::owner(i) == rank_);
+          local_.push_back(i);
+        }
+      }
+
+      virtual ~SparsePmap() { }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return std::upper_bound(first_.begin(), first_.end(), tile) -
+            first_.begin() - 1ul;
+      }
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return ((tile >= first_[rank_]) && (tile < first_[rank_ + 1ul]));
+      }
+
+    }; // class SparsePmap
+
+  }  // namespace detail
+
+  /// Propose a process map that balances measured tile costs
+
+  /// Each process gives the cost, e.g. the measured evaluation time, of its
+  /// local tiles; the costs of the other tiles are ignored, and zero tiles
+  /// are free. The costs are combined across all processes and the returned
+  /// map assigns contiguous blocks of tiles with approximately equal total
+  /// cost to each process. This function is collective.
+  /// \tparam Array The array type
+  /// \param array The array whose tiles were measured
+  /// \param costs The nonnegative cost of each tile of \c array , indexed by
+  /// the tile ordinal
+  /// \return A process map for \c array
+  /// \sa DistArray::redistribute()
+  template <typename Array>
+  std::shared_ptr<Pmap>
+  balanced_pmap(const Array& array, std::vector<double> costs) {
+    TA_USER_ASSERT(costs.size() == array.size(),
+        "The tile costs must have the same size as the array.");
+    for(std::size_t i = 0ul; i < costs.size(); ++i)
+      if((! array.is_local(i)) || array.is_zero(i))
+        costs[i] = 0.0;
+    array.world().gop.sum(costs.data(), costs.size());
+    return std::make_shared<detail::SparsePmap>(array.world(), std::move(costs));
+  }
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_PMAP_SPARSE_PMAP_H__INCLUDED
@@ -0,0 +1,104 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  view_pmap.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_VIEW_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_VIEW_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/block_range.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Process map of a block of tiles of another process map
+
+    /// Tile \c i of this map is tile <tt>block.ordinal(i)</tt> of the parent
+    /// map, and it has the same owner, so a view of an array block (see
+    /// \c DistArray::view() ) holds its tiles where the array holds them.
+    class ViewPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      const std::shared_ptr<Pmap> parent_; ///< The process map of the array
+      const BlockRange block_; ///< The block of tiles of \c parent_
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// Construct a view process map
+
+      /// \param world The world where the tiles are mapped
+      /// \param parent The process map of the array
+      /// \param block The tiles of \c parent that are mapped by this map
+      ViewPmap(World& world, const std::shared_ptr<Pmap>& parent,
+          const BlockRange& block) :
+        Pmap(world, block.volume()), parent_(parent), block_(block)
+      {
+        TA_ASSERT(parent_);
+        for(size_type i = 0ul; i < size_; ++i)
+          if(parent_->is_local(block_.ordinal(i)))
+            local_.push_back(i);
+      }
+
+      virtual ~ViewPmap() { }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return parent_->owner(block_.ordinal(tile));
+      }
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return parent_->is_local(block_.ordinal(tile));
+      }
+
+      /// Replicated array status
+
+      /// \return \c true if the parent map is replicated
+      virtual bool is_replicated() const { return parent_->is_replicated(); }
+
+      /// Node layout accessor
+
+      /// \return The node layout of the parent map
+      virtual size_type node_procs() const { return parent_->node_procs(); }
+
+    }; // class ViewPmap
+
+  } // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_PMAP_VIEW_PMAP_H__INCLUDED
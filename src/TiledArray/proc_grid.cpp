@@ -0,0 +1,95 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  proc_grid.cpp
+ *  Feb 24, 2017
+ *
+ */
+
+#include <TiledArray/proc_grid.h>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace TiledArray {
+  namespace detail {
+
+    namespace {
+
+      /// Find the number of processes on each node of \c world
+
+      /// \param world The world
+      /// \return The number of processes that share memory with each
+      /// process, or 1 when the nodes are not uniform or their processes are
+      /// not consecutive ranks
+      ProcGrid::size_type shared_memory_procs(World& world) {
+        const SafeMPI::Intracomm node =
+            world.mpi.comm().Split_type(SafeMPI::Intracomm::SHARED_SPLIT_TYPE,
+            world.rank());
+        unsigned long min_procs = node.Get_size();
+        unsigned long max_procs = min_procs;
+        world.gop.min(min_procs);
+        world.gop.max(max_procs);
+        if(min_procs != max_procs)
+          return 1u;
+
+        // Check that the processes of each node are consecutive ranks
+        int mismatch = (node.Get_rank() != int(world.rank() % min_procs) ? 1 : 0);
+        world.gop.sum(mismatch);
+        return (mismatch == 0 ? min_procs : 1u);
+      }
+
+    } // namespace
+
+    ProcGrid::size_type ProcGrid::node_procs(World& world) {
+      static const std::string nodes = [] () -> std::string {
+        const char* nodes = getenv("TA_PROC_GRID_NODES");
+        return (nodes ? nodes : "");
+      }();
+      if(nodes.empty() || (nodes == "0"))
+        return 1u;
+      if(nodes != "auto")
+        return std::max(std::atol(nodes.c_str()), 1l);
+
+      // The layout of each world is found once.
+      static std::mutex lock;
+      static std::unordered_map<unsigned long, size_type> layouts;
+      {
+        std::lock_guard<std::mutex> locker(lock);
+        auto it = layouts.find(world.id());
+        if(it != layouts.end())
+          return it->second;
+      }
+      const size_type procs = shared_memory_procs(world);
+      std::lock_guard<std::mutex> locker(lock);
+      layouts[world.id()] = procs;
+      return procs;
+    }
+
+    double ProcGrid::flops_per_element() {
+      static const double flops = [] () {
+        const char* flops = getenv("TA_PROC_GRID_FLOPS_PER_ELEMENT");
+        const double value = (flops ? std::atof(flops) : 0.0);
+        return (value > 0.0 ? value : 1000.0);
+      }();
+      return flops;
+    }
+
+  } // namespace detail
+} // namespace TiledArray
@@ -27,6 +27,7 @@
 #define TILEDARRAY_GRID_H__INCLUDED
 
 #include <TiledArray/pmap/cyclic_pmap.h>
+#include <TiledArray/pmap/layered_cyclic_pmap.h>
 #include <TiledArray/math/eigen.h>
 
 namespace TiledArray {
@@ -56,6 +57,28 @@ namespace TiledArray {
     /// \f]
     /// where the positive, real root of \f$P_{\rm{row}}\f$ give the optimal
     /// optimal communication time.
+    ///
+    /// The process grid may also be replicated into \f$c\f$ layers of
+    /// \f$P/c\f$ processes each (2.5D SUMMA). Each layer evaluates SUMMA over a
+    /// contiguous block of the contracted dimension, and the partial results
+    /// of the layers are summed by the first layer. This reduces the number of
+    /// broadcasts per process by a factor of \f$c\f$, at the cost of \f$c\f$
+    /// copies of the result and the communication required for the final
+    /// reduction. See \c optimal_proc_layers() for the cost model used to
+    /// select \f$c\f$.
+    ///
+    /// The grid may also take the node layout into account; see
+    /// \c node_procs() . When the processes of each node are consecutive
+    /// ranks, the grid dimensions are chosen with \c node_comm_time() , which
+    /// favors grids where the processes of a row share a node, so that the
+    /// broadcasts along the rows stay within a node, where MPI uses shared
+    /// memory.
+    ///
+    /// For sparse contractions, the element rows and columns are weighted by
+    /// the fraction of non-zero tiles of the arguments, which skews the grid
+    /// toward the denser argument, and the grid may leave processes out
+    /// when the broadcasts to the extra processes cost more than the work
+    /// they take over; see \c optimal_proc_count() .
     class ProcGrid {
     public:
       typedef uint_fast32_t size_type;
@@ -67,8 +90,11 @@ namespace TiledArray {
       size_type size_; ///< Number of elements
       size_type proc_rows_; ///< Number of rows in the process grid
       size_type proc_cols_; ///< Number of columns in the process grid
-      size_type proc_size_; ///< Number of processes in the process grid. This
-                         ///<  may be less than the number of processes in world.
+      size_type proc_size_; ///< Number of processes in a layer of the process
+                         ///<  grid. This may be less than the number of
+                         ///<  processes in world.
+      size_type proc_layers_; ///< Number of layers in the process grid
+      size_type rank_layer_; ///< This process's layer in the process grid
       ProcessID rank_row_; ///< This process's row in the process grid
       ProcessID rank_col_; ///< This process's column in the process grid
       size_type local_rows_; ///< The number of local element rows
@@ -138,7 +164,7 @@ namespace TiledArray {
       /// \param[in] nprocs The number of available processes
       /// \param[in] min_x The minimum valid value for x
       /// \param[in] max_x The maximum valid value for x
-      void minimize_unused_procs(size_type& x, size_type& y,
+      static void minimize_unused_procs(size_type& x, size_type& y,
           const size_type nprocs, const size_type min_x, const size_type max_x)
       {
         // Check for the quick exit
@@ -168,12 +194,96 @@ namespace TiledArray {
         }
       }
 
+      /// Communication time model of a SUMMA on a multi-node layout
+
+      /// The model is the data volume received by a single process, as in
+      /// \c layered_comm_time() for a single layer, where the volume received
+      /// from processes on the same node is weighted by 0.1, because it is
+      /// exchanged through shared memory. The processes of each node are
+      /// assumed to be \c node_procs consecutive ranks.
+      /// \param proc_rows The number of process rows
+      /// \param proc_cols The number of process columns
+      /// \param node_procs The number of processes on each node
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      /// \return The modeled communication time
+      static double node_comm_time(const double proc_rows,
+          const double proc_cols, const double node_procs,
+          const double row_size, const double col_size)
+      {
+        const double intra_weight = 0.1;
+
+        // The fraction of the other processes of a row and of a column that
+        // are on a different node; rows that do not divide the node size
+        // straddle nodes about half of the time.
+        const double row_inter = (proc_cols > node_procs ?
+            (proc_cols - node_procs) / (proc_cols - 1.0) :
+            (std::fmod(node_procs, proc_cols) == 0.0 ? 0.0 : 0.5));
+        const double col_peers = (proc_cols < node_procs ?
+            std::min(proc_rows, std::floor(node_procs / proc_cols)) : 1.0);
+        const double col_inter = (proc_rows > 1.0 ?
+            (proc_rows - col_peers) / (proc_rows - 1.0) : 0.0);
+
+        const double local_row_size = row_size / proc_rows;
+        const double local_col_size = col_size / proc_cols;
+        return local_row_size * (1.0 - 1.0 / proc_cols) *
+              (row_inter + intra_weight * (1.0 - row_inter)) +
+            local_col_size * (1.0 - 1.0 / proc_rows) *
+              (col_inter + intra_weight * (1.0 - col_inter));
+      }
+
+      /// Align the process grid with the nodes
+
+      /// Among the grids that use at least as many processes as the grid of
+      /// \c x rows and \c y columns, select the one with the smallest
+      /// \c node_comm_time() . The grid is not changed unless the processes
+      /// fill whole nodes.
+      /// \param[in,out] x The number of rows
+      /// \param[in,out] y The number of columns
+      /// \param[in] nprocs The number of available processes
+      /// \param[in] node_procs The number of processes on each node
+      /// \param[in] min_x The minimum valid value for x
+      /// \param[in] max_x The maximum valid value for x
+      /// \param[in] row_size The number of element rows
+      /// \param[in] col_size The number of element columns
+      void align_to_nodes(size_type& x, size_type& y, const size_type nprocs,
+          const size_type node_procs, const size_type min_x,
+          const size_type max_x, const std::size_t row_size,
+          const std::size_t col_size) const
+      {
+        if((node_procs <= 1u) || (nprocs % node_procs != 0u))
+          return;
+
+        const size_type used = x * y;
+        double min_time = node_comm_time(x, y, node_procs, row_size, col_size);
+        for(size_type test_x = min_x; test_x <= max_x; ++test_x) {
+          const size_type test_y = std::min<size_type>(nprocs / test_x, cols_);
+          if((test_y == 0u) || (test_x * test_y < used))
+            continue;
+
+          const double time = node_comm_time(test_x, test_y, node_procs,
+              row_size, col_size);
+          if(time < min_time) {
+            x = test_x;
+            y = test_y;
+            min_time = time;
+          }
+        }
+      }
+
       /// Member variable initialization
 
       /// This function initializes the member variables with with the optimal
       /// sizes.
+      /// \param rank The rank of this process
+      /// \param nprocs The number of processes
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      /// \param node_procs The number of processes on each node, or 1 to
+      /// ignore the node layout
       void init(const size_type rank, const size_type nprocs,
-          const std::size_t row_size, const std::size_t col_size)
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type node_procs = 1u)
       {
         // Check for the simple cases first ...
         if(nprocs == 1u) { // Only one process
@@ -231,6 +341,10 @@ namespace TiledArray {
                 min_proc_rows, max_proc_rows);
           }
 
+          // Prefer rows that are within a node
+          align_to_nodes(proc_rows_, proc_cols_, nprocs, node_procs,
+              min_proc_rows, max_proc_rows, row_size, col_size);
+
           proc_size_ = proc_rows_ * proc_cols_;
 
           if(rank < proc_size_) {
@@ -246,14 +360,71 @@ namespace TiledArray {
         }
       }
 
+      /// Member variable initialization for a layered process grid
+
+      /// This function initializes the member variables with the optimal
+      /// sizes for each of the \c proc_layers_ layers. The layers have
+      /// identical dimensions, and the processes of layer \c l are
+      /// <tt>[l * proc_size_, (l + 1) * proc_size_)</tt>.
+      void init_layers(const size_type rank, const size_type nprocs,
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type node_procs = 1u)
+      {
+        TA_ASSERT(proc_layers_ >= 1u);
+        TA_ASSERT(proc_layers_ <= nprocs);
+        const size_type layer_nprocs = nprocs / proc_layers_;
+
+        // Compute the layer dimensions, which do not depend on the rank.
+        init(0u, layer_nprocs, row_size, col_size, node_procs);
+
+        // Reset the rank dependent members
+        rank_row_ = -1;
+        rank_col_ = -1;
+        local_rows_ = 0u;
+        local_cols_ = 0u;
+        local_size_ = 0u;
+
+        // Initialize this process's coordinates in its layer. Processes that
+        // are not in any layer keep the invalid rank set above.
+        const size_type layer = rank / proc_size_;
+        if(layer < proc_layers_) {
+          rank_layer_ = layer;
+          init(rank % proc_size_, layer_nprocs, row_size, col_size, node_procs);
+        }
+      }
+
+      /// Communication time model of a layered SUMMA
+
+      /// The model is the data volume received by a single process, in
+      /// elements, for a SUMMA with \c inner_size elements in the contracted
+      /// dimension on a \c proc_rows by \c proc_cols grid with \c layers
+      /// layers. It is the sum of the broadcast volume,
+      /// \f$ \frac{Kk}{c} \left[ \frac{Mm}{P_{\rm{row}}} \left(1 - \frac{1}{P_{\rm{col}}}\right)
+      ///    + \frac{Nn}{P_{\rm{col}}} \left(1 - \frac{1}{P_{\rm{row}}}\right) \right] \f$,
+      /// and the volume of the partial results that are reduced into the
+      /// first layer,
+      /// \f$ (c - 1) \frac{Mm}{P_{\rm{row}}} \frac{Nn}{P_{\rm{col}}} \f$.
+      static double layered_comm_time(const double proc_rows,
+          const double proc_cols, const double layers, const double row_size,
+          const double col_size, const double inner_size)
+      {
+        const double local_row_size = row_size / proc_rows;
+        const double local_col_size = col_size / proc_cols;
+        return (inner_size / layers) *
+            (local_row_size * (1.0 - 1.0 / proc_cols) +
+             local_col_size * (1.0 - 1.0 / proc_rows)) +
+            (layers - 1.0) * local_row_size * local_col_size;
+      }
+
     public:
       /// Default constructor
 
       /// All sizes are initialized to zero.
       ProcGrid() :
         world_(NULL), rows_(0u), cols_(0u), size_(0u), proc_rows_(0u),
-        proc_cols_(0u), proc_size_(0u), rank_row_(0), rank_col_(0),
-        local_rows_(0u), local_cols_(0u), local_size_(0u)
+        proc_cols_(0u), proc_size_(0u), proc_layers_(1u), rank_layer_(0u),
+        rank_row_(0), rank_col_(0), local_rows_(0u), local_cols_(0u),
+        local_size_(0u)
       { }
 
       /// Construct a process grid
@@ -270,6 +441,37 @@ namespace TiledArray {
           const std::size_t row_size, const std::size_t col_size) :
         world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
         proc_rows_(0ul), proc_cols_(0ul), proc_size_(0ul),
+        proc_layers_(1ul), rank_layer_(0ul),
+        rank_row_(-1), rank_col_(-1),
+        local_rows_(0ul), local_cols_(0ul), local_size_(0ul)
+      {
+        // Check for non-zero sizes
+        TA_ASSERT(rows_ >= 1u);
+        TA_ASSERT(cols_ >= 1u);
+        TA_ASSERT(row_size >= 1ul);
+        TA_ASSERT(col_size >= 1ul);
+
+        init(world_->rank(), world_->size(), row_size, col_size,
+            node_procs(world));
+      }
+
+      /// Construct a layered process grid
+
+      /// The processes of \c world are divided into \c layers layers, and a
+      /// process grid is constructed for each layer as for a 2D grid of
+      /// <tt>world.size() / layers</tt> processes.
+      /// \param world The world where the process grid will live
+      /// \param rows The number of tile rows
+      /// \param cols The number of tile columns
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      /// \param layers The number of process grid layers
+      ProcGrid(World& world, const size_type rows, const size_type cols,
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type layers) :
+        world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
+        proc_rows_(0ul), proc_cols_(0ul), proc_size_(0ul),
+        proc_layers_(layers), rank_layer_(0ul),
         rank_row_(-1), rank_col_(-1),
         local_rows_(0ul), local_cols_(0ul), local_size_(0ul)
       {
@@ -278,8 +480,85 @@ namespace TiledArray {
         TA_ASSERT(cols_ >= 1u);
         TA_ASSERT(row_size >= 1ul);
         TA_ASSERT(col_size >= 1ul);
+        TA_ASSERT(layers >= 1ul);
+
+        init_layers(world_->rank(), world_->size(), row_size, col_size,
+            node_procs(world));
+      }
+
+      /// Construct a process grid for a sparse contraction
+
+      /// The grid is constructed for <tt>optimal_proc_count()</tt> processes,
+      /// with the sparse element rows and columns, and the other processes of
+      /// \c world hold no tiles of the grid.
+      /// \param world The world where the process grid will live
+      /// \param rows The number of tile rows
+      /// \param cols The number of tile columns
+      /// \param row_size The number of element rows, weighted by the fraction
+      /// of non-zero tiles of the left-hand argument
+      /// \param col_size The number of element columns, weighted by the
+      /// fraction of non-zero tiles of the right-hand argument
+      /// \param inner_size The number of elements in the contracted dimension
+      /// \param inner_count The number of contracted tiles with non-zero
+      /// tiles in both arguments
+      /// \param flops The number of flops of the contraction
+      ProcGrid(World& world, const size_type rows, const size_type cols,
+          const double row_size, const double col_size,
+          const double inner_size, const double inner_count,
+          const double flops) :
+        world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
+        proc_rows_(0ul), proc_cols_(0ul), proc_size_(0ul),
+        proc_layers_(1ul), rank_layer_(0ul),
+        rank_row_(-1), rank_col_(-1),
+        local_rows_(0ul), local_cols_(0ul), local_size_(0ul)
+      {
+        // Check for non-zero sizes
+        TA_ASSERT(rows_ >= 1u);
+        TA_ASSERT(cols_ >= 1u);
+
+        const std::size_t rows_size = std::max(std::llround(row_size), 1ll);
+        const std::size_t cols_size = std::max(std::llround(col_size), 1ll);
+        const size_type procs = optimal_proc_count(world_->size(), rows_, cols_,
+            rows_size, cols_size, inner_size, inner_count, flops);
+        init(world_->rank(), procs, rows_size, cols_size, node_procs(world));
+      }
+
+      /// Construct a process grid with the layout of a cyclic process map
+
+      /// The process grid has the process rows and columns of \c layout , so
+      /// arrays that are distributed with the same process rows and columns
+      /// (see \c TiledArray::summa_pmap() ) are distributed like the
+      /// arguments of a contraction on this grid.
+      /// \param world The world where the process grid will live
+      /// \param rows The number of tile rows
+      /// \param cols The number of tile columns
+      /// \param layout The process map with the process grid dimensions
+      ProcGrid(World& world, const size_type rows, const size_type cols,
+          const CyclicPmap& layout) :
+        world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
+        proc_rows_(layout.nrows_proc()), proc_cols_(layout.ncols_proc()),
+        proc_size_(proc_rows_ * proc_cols_), proc_layers_(1ul),
+        rank_layer_(0ul), rank_row_(-1), rank_col_(-1),
+        local_rows_(0ul), local_cols_(0ul), local_size_(0ul)
+      {
+        // Check for non-zero sizes
+        TA_ASSERT(rows_ >= 1u);
+        TA_ASSERT(cols_ >= 1u);
+        TA_ASSERT(proc_rows_ <= rows_);
+        TA_ASSERT(proc_cols_ <= cols_);
+        TA_ASSERT(proc_size_ <= size_type(world.size()));
+
+        const size_type rank = world.rank();
+        if(rank < proc_size_) {
+          // Set this process rank
+          rank_row_ = rank / proc_cols_;
+          rank_col_ = rank % proc_cols_;
 
-        init(world_->rank(), world_->size(), row_size, col_size);
+          // Set local counts
+          local_rows_ = (rows_ / proc_rows_) + (size_type(rank_row_) < (rows_ % proc_rows_) ? 1u : 0u);
+          local_cols_ = (cols_ / proc_cols_) + (size_type(rank_col_) < (cols_ % proc_cols_) ? 1u : 0u);
+          local_size_ = local_rows_ * local_cols_;
+        }
       }
 
 #ifdef TILEDARRAY_ENABLE_TEST_PROC_GRID
@@ -304,8 +583,9 @@ namespace TiledArray {
           const size_type rows, const size_type cols,
           const std::size_t row_size, const std::size_t col_size) :
         world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
-        proc_rows_(0u), proc_cols_(0u), proc_size_(0u), rank_row_(-1),
-        rank_col_(-1), local_rows_(0u), local_cols_(0u), local_size_(0u)
+        proc_rows_(0u), proc_cols_(0u), proc_size_(0u), proc_layers_(1u),
+        rank_layer_(0u), rank_row_(-1), rank_col_(-1), local_rows_(0u),
+        local_cols_(0u), local_size_(0u)
       {
         // Check for non-zero sizes
         TA_ASSERT(rows >= 1u);
@@ -316,6 +596,37 @@ namespace TiledArray {
 
         init(test_rank, test_nprocs, row_size, col_size);
       }
+
+      /// Construct a layered process grid
+
+      /// \param world The world where the process grid will live
+      /// \param test_rank Test rank
+      /// \param test_nprocs Test number of procs
+      /// \param rows The number of tile rows
+      /// \param cols The number of tile columns
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      /// \param layers The number of process grid layers
+      /// \param node_procs The number of processes on each node
+      ProcGrid(World& world, const size_type test_rank, size_type test_nprocs,
+          const size_type rows, const size_type cols,
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type layers, const size_type node_procs = 1u) :
+        world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
+        proc_rows_(0u), proc_cols_(0u), proc_size_(0u), proc_layers_(layers),
+        rank_layer_(0u), rank_row_(-1), rank_col_(-1), local_rows_(0u),
+        local_cols_(0u), local_size_(0u)
+      {
+        // Check for non-zero sizes
+        TA_ASSERT(rows >= 1u);
+        TA_ASSERT(cols >= 1u);
+        TA_ASSERT(row_size >= 1u);
+        TA_ASSERT(col_size >= 1u);
+        TA_ASSERT(layers >= 1u);
+        TA_ASSERT(test_rank < test_nprocs);
+
+        init_layers(test_rank, test_nprocs, row_size, col_size, node_procs);
+      }
 #endif // TILEDARRAY_ENABLE_TEST_PROC_GRID
 
       /// Copy constructor
@@ -328,6 +639,7 @@ namespace TiledArray {
         world_(other.world_), rows_(other.rows_), cols_(other.cols_),
         size_(other.size_), proc_rows_(other.proc_rows_),
         proc_cols_(other.proc_cols_), proc_size_(other.proc_size_),
+        proc_layers_(other.proc_layers_), rank_layer_(other.rank_layer_),
         rank_row_(other.rank_row_), rank_col_(other.rank_col_),
         local_rows_(other.local_rows_), local_cols_(other.local_cols_),
         local_size_(other.local_size_)
@@ -344,6 +656,8 @@ namespace TiledArray {
         proc_rows_ = other.proc_rows_;
         proc_cols_ = other.proc_cols_;
         proc_size_ = other.proc_size_;
+        proc_layers_ = other.proc_layers_;
+        rank_layer_ = other.rank_layer_;
         rank_row_ = other.rank_row_;
         rank_col_ = other.rank_col_;
         local_rows_ = other.local_rows_;
@@ -405,10 +719,178 @@ namespace TiledArray {
 
       /// Process grid size accessor
 
-      /// \return The number of processes included in the process grid (may be
-      /// less than the number of process in world).
+      /// \return The number of processes included in a layer of the process
+      /// grid (may be less than the number of process in world).
       size_type proc_size() const { return proc_size_; }
 
+      /// Process layer count accessor
+
+      /// \return The number of layers in the process grid
+      size_type proc_layers() const { return proc_layers_; }
+
+      /// Rank layer accessor
+
+      /// \return The layer of this process in the process grid
+      size_type rank_layer() const { return rank_layer_; }
+
+      /// First contracted tile index of this process's layer
+
+      /// \param inner The number of tiles in the contracted dimension
+      /// \return The first contracted tile index evaluated by the layer of
+      /// this process
+      size_type layer_inner_begin(const size_type inner) const {
+        return LayeredCyclicPmap::layer_begin(rank_layer_, proc_layers_, inner);
+      }
+
+      /// End of the contracted tile range of this process's layer
+
+      /// \param inner The number of tiles in the contracted dimension
+      /// \return The end of the contracted tile range evaluated by the layer
+      /// of this process
+      size_type layer_inner_end(const size_type inner) const {
+        return LayeredCyclicPmap::layer_begin(rank_layer_ + 1u, proc_layers_, inner);
+      }
+
+      /// Map a layer to the process with this process's row and column
+
+      /// \param layer The layer to be mapped
+      /// \return The process the corresponds to the process coordinate
+      /// \c (layer,rank_row,rank_col)
+      ProcessID map_layer(const size_type layer) const {
+        TA_ASSERT(layer < proc_layers_);
+        return (layer * proc_rows_ + rank_row_) * proc_cols_ + rank_col_;
+      }
+
+      /// Number of processes on each node of \c world
+
+      /// The node layout is used when the \c TA_PROC_GRID_NODES environment
+      /// variable is set. When it is \c auto , the processes that share memory
+      /// are found with \c MPI_Comm_split_type ; the layout is used only if
+      /// all nodes hold the same number of processes and the processes of
+      /// each node are consecutive ranks. Otherwise, the variable gives the
+      /// number of processes on each node. The layout of each world is
+      /// computed once, by the first call, which is collective.
+      /// \param world The world of the process grid
+      /// \return The number of processes on each node, or 1 when the node
+      /// layout is not used
+      static size_type node_procs(World& world);
+
+      /// The number of flops that take as long as moving one element
+
+      /// The ratio of the flop rate of a process to the rate at which it
+      /// receives the elements of broadcast tiles, which is used by
+      /// \c optimal_proc_count() . It is set with the
+      /// \c TA_PROC_GRID_FLOPS_PER_ELEMENT environment variable; the default
+      /// is 1000.
+      /// \return The number of flops per element received
+      static double flops_per_element();
+
+      /// Select the number of processes of a sparse process grid
+
+      /// The number of processes, \f$P\f$, is selected to minimize
+      /// \f[
+      ///   T = \frac{W}{P f} + V(P_{\rm{row}}, P_{\rm{col}})
+      ///     + \lambda K' \left(\log_2 P_{\rm{row}} + \log_2 P_{\rm{col}}\right)
+      /// \f]
+      /// where \f$W\f$ is the number of flops, \f$f\f$ is
+      /// \c flops_per_element() , \f$V\f$ is the broadcast volume of
+      /// \c layered_comm_time() for a single layer, and the last term is the
+      /// latency of the \f$K'\f$ broadcasts, along trees of the process rows
+      /// and columns, with a latency \f$\lambda\f$ of 1000 elements. When
+      /// the arguments are very sparse, the work of each process is small and
+      /// fewer processes, with fewer and shorter broadcasts, are faster.
+      /// The tested numbers of processes are \c nprocs and its halves.
+      /// \param nprocs The number of processes
+      /// \param rows The number of tile rows
+      /// \param cols The number of tile columns
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      /// \param inner_size The number of elements in the contracted dimension
+      /// \param inner_count The number of broadcast steps
+      /// \param flops The number of flops of the contraction
+      /// \return The number of processes that minimizes \f$T\f$
+      static size_type optimal_proc_count(const size_type nprocs,
+          const size_type rows, const size_type cols,
+          const std::size_t row_size, const std::size_t col_size,
+          const double inner_size, const double inner_count, const double flops)
+      {
+        TA_ASSERT(nprocs >= 1u);
+        const double latency = 1000.0;
+        const double rate = flops_per_element();
+
+        size_type result = nprocs;
+        double min_time = 0.0;
+        for(size_type procs = nprocs; procs >= 1u; procs /= 2u) {
+          ProcGrid grid;
+          grid.rows_ = rows;
+          grid.cols_ = cols;
+          grid.size_ = rows * cols;
+          grid.init(0u, procs, row_size, col_size);
+
+          const double time = flops / (double(grid.proc_size_) * rate) +
+              layered_comm_time(grid.proc_rows_, grid.proc_cols_, 1.0,
+                  row_size, col_size, inner_size) +
+              latency * inner_count * (std::log2(double(grid.proc_rows_)) +
+                  std::log2(double(grid.proc_cols_)));
+          if((procs == nprocs) || (time < min_time)) {
+            result = procs;
+            min_time = time;
+          }
+        }
+
+        return result;
+      }
+
+      /// Select the number of process grid layers
+
+      /// The number of layers, \f$c\f$, is selected to minimize the
+      /// communication time of a layered SUMMA, as given by
+      /// \c layered_comm_time() for the process grid of each layer. The
+      /// number of layers is bounded by \f$P^{1/3}\f$, by the number of tiles
+      /// in the contracted dimension, and by \c max_layers, which the caller
+      /// uses to bound the memory required for the \f$c\f$ copies of the
+      /// result.
+      /// \param nprocs The number of processes
+      /// \param rows The number of tile rows
+      /// \param cols The number of tile columns
+      /// \param inner The number of tiles in the contracted dimension
+      /// \param row_size The number of element rows
+      /// \param col_size The number of element columns
+      /// \param inner_size The number of elements in the contracted dimension
+      /// \param max_layers The maximum number of layers
+      /// \return The number of layers that minimizes communication time
+      static size_type optimal_proc_layers(const size_type nprocs,
+          const size_type rows, const size_type cols, const size_type inner,
+          const std::size_t row_size, const std::size_t col_size,
+          const std::size_t inner_size, const size_type max_layers)
+      {
+        TA_ASSERT(nprocs >= 1u);
+
+        size_type layers_bound = std::min(max_layers, inner);
+        while((layers_bound > 1u) &&
+            (layers_bound * layers_bound * layers_bound > nprocs))
+          --layers_bound;
+
+        size_type result = 1u;
+        double min_time = 0.0;
+        for(size_type layers = 1u; layers <= layers_bound; ++layers) {
+          ProcGrid grid;
+          grid.rows_ = rows;
+          grid.cols_ = cols;
+          grid.size_ = rows * cols;
+          grid.init(0u, nprocs / layers, row_size, col_size);
+
+          const double time = layered_comm_time(grid.proc_rows_,
+              grid.proc_cols_, layers, row_size, col_size, inner_size);
+          if((layers == 1u) || (time < min_time)) {
+            result = layers;
+            min_time = time;
+          }
+        }
+
+        return result;
+      }
+
 
       /// Construct a row group
 
@@ -425,7 +907,7 @@ namespace TiledArray {
           proc_list.reserve(proc_cols_);
 
           // Populate the row process list
-          size_type p = rank_row_ * proc_cols_;
+          size_type p = (rank_layer_ * proc_rows_ + rank_row_) * proc_cols_;
           const size_type row_end = p + proc_cols_;
           for(; p < row_end; ++p)
             proc_list.push_back(p);
@@ -452,7 +934,9 @@ namespace TiledArray {
           proc_list.reserve(proc_rows_);
 
           // Populate the column process list
-          for(size_type p = rank_col_; p < proc_size_; p += proc_cols_)
+          const size_type layer_start = rank_layer_ * proc_size_;
+          const size_type layer_end = layer_start + proc_size_;
+          for(size_type p = layer_start + rank_col_; p < layer_end; p += proc_cols_)
             proc_list.push_back(p);
 
           // Construct the group
@@ -469,7 +953,7 @@ namespace TiledArray {
       /// \return The process the corresponds to the process coordinate \c (row,rank_col)
       ProcessID map_row(const size_type row) const {
         TA_ASSERT(row < proc_rows_);
-        return rank_col_ + row * proc_cols_;
+        return (rank_layer_ * proc_rows_ + row) * proc_cols_ + rank_col_;
       }
 
       /// Map a column to the process in this process's row
@@ -478,12 +962,13 @@ namespace TiledArray {
       /// \return The process the corresponds to the process coordinate \c (rank_row,col)
       ProcessID map_col(const size_type col) const {
         TA_ASSERT(col < proc_cols_);
-        return rank_row_ * proc_cols_ + col;
+        return (rank_layer_ * proc_rows_ + rank_row_) * proc_cols_ + col;
       }
 
       /// Construct a cyclic process
 
       /// Construct a cyclic process map with the same phase as the process grid.
+      /// For a layered process grid, the tiles are mapped to the first layer.
       /// \return Cyclic process map
       std::shared_ptr<Pmap> make_pmap() const {
         TA_ASSERT(world_);
@@ -494,29 +979,81 @@ namespace TiledArray {
       /// Construct column phased a cyclic process
 
       /// Construct a cyclic process map where the column phase of the process
-      /// matches that of this process grid.
+      /// matches that of this process grid. For a layered process grid, the
+      /// rows are partitioned among the layers.
       /// \param rows The number of rows in the process map
       /// \return Cyclic process map with matching column phase
       std::shared_ptr<Pmap> make_col_phase_pmap(const size_type rows) const {
         TA_ASSERT(world_);
 
+        if(proc_layers_ > 1u)
+          return std::shared_ptr<Pmap>(new LayeredCyclicPmap(*world_, rows,
+              cols_, proc_rows_, proc_cols_, proc_layers_, false));
+
         return std::shared_ptr<Pmap>(new CyclicPmap(*world_, rows, cols_, proc_rows_, proc_cols_));
       }
 
       /// Construct row phased a cyclic process
 
       /// Construct a cyclic process map where the column phase of the process
-      /// matches that of this process grid.
+      /// matches that of this process grid. For a layered process grid, the
+      /// columns are partitioned among the layers.
       /// \param cols The number of columns in the process map
       /// \return Cyclic process map with matching column phase
       std::shared_ptr<Pmap> make_row_phase_pmap(const size_type cols) const {
         TA_ASSERT(world_);
 
+        if(proc_layers_ > 1u)
+          return std::shared_ptr<Pmap>(new LayeredCyclicPmap(*world_, rows_,
+              cols, proc_rows_, proc_cols_, proc_layers_, true));
+
         return std::shared_ptr<Pmap>(new CyclicPmap(*world_, rows_, cols, proc_rows_, proc_cols_));
       }
     }; // class Grid
 
   } // namespace detail
+
+  /// Construct a process map that distributes an array for contractions
+
+  /// The tiles of the array are viewed as a matrix, where the leading
+  /// \c row_rank dimensions are fused into the rows, and the matrix is
+  /// distributed cyclically over a \c proc_rows by \c proc_cols process grid.
+  /// A contraction whose arguments are stored with the same process grid
+  /// dimensions, and whose contracted dimensions are the trailing dimensions
+  /// of the left-hand argument and the leading dimensions of the right-hand
+  /// argument, evaluates on that grid and does not redistribute them. This
+  /// is useful for long-lived arrays that are contracted many times.
+  /// \param world The world where the array will live
+  /// \param tiles_range The range of the tiles of the array
+  /// \param row_rank The number of dimensions that are fused into the rows
+  /// \param proc_rows The number of process rows
+  /// \param proc_cols The number of process columns
+  /// \return A cyclic process map for the array
+  /// \throw TiledArray::Exception When the process grid has more rows or
+  /// columns than the array, or more processes than \c world
+  template <typename Range>
+  inline std::shared_ptr<Pmap>
+  summa_pmap(World& world, const Range& tiles_range, const unsigned int row_rank,
+      const std::size_t proc_rows, const std::size_t proc_cols)
+  {
+    TA_USER_ASSERT(row_rank <= tiles_range.rank(),
+        "summa_pmap(): the number of row dimensions is larger than the rank.");
+
+    std::size_t rows = 1ul, cols = 1ul;
+    for(unsigned int i = 0u; i < tiles_range.rank(); ++i)
+      (i < row_rank ? rows : cols) *= tiles_range.extent_data()[i];
+
+    TA_USER_ASSERT((proc_rows >= 1ul) && (proc_rows <= rows),
+        "summa_pmap(): the number of process rows is not valid.");
+    TA_USER_ASSERT((proc_cols >= 1ul) && (proc_cols <= cols),
+        "summa_pmap(): the number of process columns is not valid.");
+    TA_USER_ASSERT((proc_rows * proc_cols) <= std::size_t(world.size()),
+        "summa_pmap(): the process grid is larger than the world.");
+
+    return std::make_shared<detail::CyclicPmap>(world, rows, cols, proc_rows,
+        proc_cols);
+  }
+
 } // namespace TiledArray
 
 #endif // TILEDARRAY_GRID_H__INCLUDED
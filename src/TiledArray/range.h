@@ -23,9 +23,63 @@
 #include <TiledArray/range_iterator.h>
 #include <TiledArray/permutation.h>
 #include <TiledArray/size_array.h>
+#include <atomic>
+#include <new>
 
 namespace TiledArray {
 
+  namespace detail {
+
+    /// Ordinal of the coordinate index given by an index pack
+
+    /// The sum over the dimensions is unrolled at compile time.
+    /// \tparam SizeType An unsigned integral type
+    /// \tparam Index0 The first index type
+    /// \param stride The strides of the dimensions of the index pack
+    /// \param index0 The first index
+    /// \return The sum of <tt>index[i] * stride[i]</tt>
+    template <typename SizeType, typename Index0>
+    inline SizeType unrolled_ordinal(const SizeType* const stride,
+        const Index0& index0)
+    { return static_cast<SizeType>(index0) * stride[0]; }
+
+    template <typename SizeType, typename Index0, typename... Index>
+    inline SizeType unrolled_ordinal(const SizeType* const stride,
+        const Index0& index0, const Index&... index)
+    {
+      return static_cast<SizeType>(index0) * stride[0] +
+          unrolled_ordinal(stride + 1, index...);
+    }
+
+    /// Inclusion test of the coordinate index given by an index pack
+
+    /// The test of each dimension is unrolled at compile time.
+    /// \tparam SizeType An unsigned integral type
+    /// \tparam Index0 The first index type
+    /// \param lower The lower bounds of the dimensions of the index pack
+    /// \param upper The upper bounds of the dimensions of the index pack
+    /// \param index0 The first index
+    /// \return \c true if <tt>lower[i] <= index[i] < upper[i]</tt> for all
+    /// dimensions
+    template <typename SizeType, typename Index0>
+    inline bool unrolled_includes(const SizeType* const lower,
+        const SizeType* const upper, const Index0& index0)
+    {
+      return (static_cast<SizeType>(index0) >= lower[0]) &&
+          (static_cast<SizeType>(index0) < upper[0]);
+    }
+
+    template <typename SizeType, typename Index0, typename... Index>
+    inline bool unrolled_includes(const SizeType* const lower,
+        const SizeType* const upper, const Index0& index0,
+        const Index&... index)
+    {
+      return unrolled_includes(lower, upper, index0) &&
+          unrolled_includes(lower + 1, upper + 1, index...);
+    }
+
+  }  // namespace detail
+
   /// \brief A (hyperrectangular) interval on \f$ Z^n \f$, space of integer n-indices
 
   /// This object represents an n-dimensional, hyperrectangular array
@@ -52,7 +106,8 @@ namespace TiledArray {
 
     size_type* data_ = nullptr;
                       ///< An array that holds the dimension information of the
-                      ///< range. The layout of the array is:
+                      ///< range, which is shared by copies of the range (see
+                      ///< \c allocate() ). The layout of the array is:
                       ///< \code
                       ///< { lobound[0], ..., lobound[rank_ - 1],
                       ///<   upbound[0], ..., upbound[rank_ - 1],
@@ -63,6 +118,75 @@ namespace TiledArray {
     size_type volume_ = 0ul; ///< Total number of elements
     unsigned int rank_ = 0u; ///< The rank (or number of dimensions) in the range
 
+    /// Reference count of a range data array
+    struct alignas(alignof(size_type)) DataHeader {
+      std::atomic<unsigned long> count; ///< The number of ranges that share the array
+    }; // struct DataHeader
+
+    /// Reference count accessor
+
+    /// \param data A range data array allocated by \c allocate()
+    /// \return A pointer to the header of \c data
+    static DataHeader* header(size_type* const data) {
+      return reinterpret_cast<DataHeader*>(data) - 1;
+    }
+
+    /// Allocate a range data array
+
+    /// Range data is immutable once it has been initialized, so copies of a
+    /// range share the same array, e.g. the ranges of the tiles that are
+    /// constructed from the cached ranges of \c TiledRange . The array is
+    /// copied before it is modified when it is shared, see \c unshare() .
+    /// \param rank The rank of the range
+    /// \return An array of <tt>4 * rank</tt> elements, or \c nullptr when
+    /// \c rank is zero
+    /// \throw std::bad_alloc When memory allocation fails.
+    static size_type* allocate(const unsigned int rank) {
+      if(rank == 0u)
+        return nullptr;
+      void* const memory = ::operator new(sizeof(DataHeader) + (sizeof(size_type) << 2) * rank);
+      DataHeader* const h = new(memory) DataHeader;
+      h->count.store(1ul, std::memory_order_relaxed);
+      return reinterpret_cast<size_type*>(h + 1);
+    }
+
+    /// Share a range data array
+
+    /// \param data A range data array allocated by \c allocate() , or
+    /// \c nullptr
+    /// \return \c data
+    static size_type* acquire(size_type* const data) {
+      if(data)
+        header(data)->count.fetch_add(1ul, std::memory_order_relaxed);
+      return data;
+    }
+
+    /// Release a range data array
+
+    /// \param data A range data array allocated by \c allocate() , or
+    /// \c nullptr
+    static void release(size_type* const data) {
+      if(data) {
+        DataHeader* const h = header(data);
+        if(h->count.fetch_sub(1ul, std::memory_order_acq_rel) == 1ul) {
+          h->~DataHeader();
+          ::operator delete(h);
+        }
+      }
+    }
+
+    /// Copy the range data when it is shared with another range
+
+    /// \post \c data_ is owned only by this range.
+    void unshare() {
+      if(data_ && (header(data_)->count.load(std::memory_order_acquire) != 1ul)) {
+        size_type* const data = allocate(rank_);
+        memcpy(data, data_, (sizeof(size_type) << 2) * rank_);
+        release(data_);
+        data_ = data;
+      }
+    }
+
   private:
 
     /// Initialize range data from sequences of lower and upper bounds
@@ -261,7 +385,7 @@ namespace TiledArray {
       TA_ASSERT(n == detail::size(upper_bound));
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
+        data_ = allocate(n);
         rank_ = n;
         init_range_data(lower_bound, upper_bound);
       }
@@ -285,7 +409,7 @@ namespace TiledArray {
       TA_ASSERT(n == detail::size(upper_bound));
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
+        data_ = allocate(n);
         rank_ = n;
         init_range_data(lower_bound, upper_bound);
       }
@@ -305,7 +429,7 @@ namespace TiledArray {
       const size_type n = detail::size(extent);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
+        data_ = allocate(n);
         rank_ = n;
         init_range_data(extent);
       }
@@ -323,7 +447,7 @@ namespace TiledArray {
       const size_type n = detail::size(extent);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
+        data_ = allocate(n);
         rank_ = n;
         init_range_data(extent);
       }
@@ -345,7 +469,7 @@ namespace TiledArray {
       const size_type n = detail::size(bounds);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
+        data_ = allocate(n);
         rank_ = n;
         init_range_data(bounds);
       }
@@ -365,7 +489,7 @@ namespace TiledArray {
       const size_type n = detail::size(bounds);
       if(n) {
         // Initialize array memory
-        data_ = new size_type[n << 2];
+        data_ = allocate(n);
         rank_ = n;
         init_range_data(bounds);
       }
@@ -385,17 +509,12 @@ namespace TiledArray {
 
     /// Copy Constructor
 
+    /// This is a shallow copy, the range data is shared with \c other .
     /// \param other The range to be copied
-    /// \throw std::bad_alloc When memory allocation fails.
-    Range(const Range_& other) {
-      if(other.rank_ > 0ul) {
-        data_ = new size_type[other.rank_ << 2];
-        offset_ = other.offset_;
-        volume_ = other.volume_;
-        rank_ = other.rank_;
-        memcpy(data_, other.data_, (sizeof(size_type) << 2) * other.rank_);
-      }
-    }
+    Range(const Range_& other) :
+      data_(acquire(other.data_)), offset_(other.offset_),
+      volume_(other.volume_), rank_(other.rank_)
+    { }
 
     /// Copy Constructor
 
@@ -420,14 +539,14 @@ namespace TiledArray {
       TA_ASSERT(perm.dim() == other.rank_);
 
       if(other.rank_ > 0ul) {
-        data_ = new size_type[other.rank_ << 2];
         rank_ = other.rank_;
 
         if(perm) {
+          data_ = allocate(other.rank_);
           init_range_data(perm, other.data_, other.data_ + rank_);
         } else {
-          // Simple copy will due.
-          memcpy(data_, other.data_, (sizeof(size_type) << 2) * rank_);
+          // Share the data of other
+          data_ = acquire(other.data_);
           offset_ = other.offset_;
           volume_ = other.volume_;
         }
@@ -435,22 +554,21 @@ namespace TiledArray {
     }
 
     /// Destructor
-    ~Range() { delete [] data_; }
+    ~Range() { release(data_); }
 
     /// Copy assignment operator
 
+    /// This is a shallow copy, the range data is shared with \c other .
     /// \param other The range to be copied
     /// \return A reference to this object
-    /// \throw std::bad_alloc When memory allocation fails.
     Range_& operator=(const Range_& other) {
-      if(rank_ != other.rank_) {
-        delete [] data_;
-        data_ = (other.rank_ > 0ul ? new size_type[other.rank_ << 2] : nullptr);
-        rank_ = other.rank_;
+      if(data_ != other.data_) {
+        release(data_);
+        data_ = acquire(other.data_);
       }
-      memcpy(data_, other.data_, (sizeof(size_type) << 2) * rank_);
       offset_ = other.offset_;
       volume_ = other.volume_;
+      rank_ = other.rank_;
 
       return *this;
     }
@@ -461,6 +579,9 @@ namespace TiledArray {
     /// \return A reference to this object
     /// \throw nothing
     Range_& operator=(Range_&& other) {
+      if(this == &other)
+        return *this;
+      release(data_);
       data_ = other.data_;
       offset_ = other.offset_;
       volume_ = other.volume_;
@@ -606,7 +727,9 @@ namespace TiledArray {
     /// the data layout of a dense tensor.
     /// \return An iterator that holds the lower bound element index of a tensor
     /// \throw nothing
-    const_iterator end() const { return const_iterator(data_ + rank_, this); }
+    const_iterator end() const {
+      return const_iterator(data_ + rank_, this, volume_);
+    }
 
     /// Check the coordinate to make sure it is within the range.
 
@@ -661,11 +784,21 @@ namespace TiledArray {
       return include_ordinal_(i);
     }
 
+    /// Check the coordinate to make sure it is within the range.
+
+    /// The test is unrolled over the dimensions of the index pack.
+    /// \tparam Index The index types
+    /// \param index The coordinate index, one element per dimension
+    /// \return \c true when <tt>i >= start</tt> and <tt>i < finish</tt>,
+    /// otherwise \c false
+    /// \throw TiledArray::Exception When the rank of this range is not
+    /// equal to the size of the index.
     template <typename... Index>
-    typename std::enable_if<(sizeof...(Index) > 1ul), size_type>::type
+    typename std::enable_if<(sizeof...(Index) > 1ul), bool>::type
     includes(const Index&... index) const {
-      const size_type i[sizeof...(Index)] = {static_cast<size_type>(index)...};
-      return includes(i);
+      TA_ASSERT(sizeof...(Index) == rank_);
+      return detail::unrolled_includes<size_type>(data_, data_ + rank_,
+          index...);
     }
 
 
@@ -696,9 +829,11 @@ namespace TiledArray {
 
       // Reallocate memory for range arrays
       if(rank_ != n) {
-        delete [] data_;
-        data_ = (n > 0ul ? new size_type[n << 2] : nullptr);
+        release(data_);
+        data_ = allocate(n);
         rank_ = n;
+      } else {
+        unshare();
       }
       if(n > 0ul)
         init_range_data(lower_bound, upper_bound);
@@ -717,6 +852,7 @@ namespace TiledArray {
     Range_& inplace_shift(const Index& bound_shift) {
       const unsigned int n = detail::size(bound_shift);
       TA_ASSERT(n == rank_);
+      unshare();
 
       const auto* MADNESS_RESTRICT const bound_shift_data = detail::data(bound_shift);
       size_type* MADNESS_RESTRICT const lower = data_;
@@ -795,16 +931,70 @@ namespace TiledArray {
 
     /// calculate the ordinal index of \c index
 
-    /// Convert a coordinate index to an ordinal index.
-    /// \tparam Index A coordinate index type (array type)
+    /// Convert a coordinate index to an ordinal index. The sum over the
+    /// dimensions is unrolled at compile time, so element access with an
+    /// index pack does not loop over the rank.
+    /// \tparam Index The index types
     /// \param index The index to be converted to an ordinal index
     /// \return The ordinal index of \c index
     /// \throw When \c index is not included in this range.
     template <typename... Index,
         typename std::enable_if<(sizeof...(Index) > 1ul)>::type* = nullptr>
     size_type ordinal(const Index&... index) const {
-      const size_type temp_index[sizeof...(Index)] = { static_cast<size_type>(index)... };
-      return ordinal(temp_index);
+      TA_ASSERT(sizeof...(Index) == rank_);
+      TA_ASSERT(includes(index...));
+      return detail::unrolled_ordinal<size_type>(data_ + rank_ + rank_ + rank_,
+          index...) - offset_;
+    }
+
+    /// calculate the ordinal indices of a sequence of indices
+
+    /// Convert a batch of coordinate indices to ordinal indices. The strides
+    /// and the offset are loaded once for the whole batch, and the sums for
+    /// rank 2 and 3 ranges are unrolled.
+    /// \tparam InIter An input iterator type that dereferences to a
+    /// coordinate index
+    /// \tparam OutIter An output iterator type of ordinal indices
+    /// \param first The first index in the sequence
+    /// \param last The end of the sequence
+    /// \param result The first ordinal index of the result
+    /// \return The end of the result sequence
+    /// \throw When an index is not included in this range.
+    template <typename InIter, typename OutIter>
+    OutIter ordinals(InIter first, InIter last, OutIter result) const {
+      const size_type* MADNESS_RESTRICT const stride = data_ + rank_ + rank_ + rank_;
+      const size_type offset = offset_;
+
+      switch(rank_) {
+        case 2u: {
+          const size_type stride0 = stride[0];
+          for(; first != last; ++first, ++result) {
+            const auto& index = *first;
+            TA_ASSERT(includes(index));
+            auto index_it = std::begin(index);
+            const size_type i0 = *index_it;
+            *result = i0 * stride0 + *(++index_it) - offset;
+          }
+          break;
+        }
+        case 3u: {
+          const size_type stride0 = stride[0], stride1 = stride[1];
+          for(; first != last; ++first, ++result) {
+            const auto& index = *first;
+            TA_ASSERT(includes(index));
+            auto index_it = std::begin(index);
+            const size_type i0 = *index_it;
+            const size_type i1 = *(++index_it);
+            *result = i0 * stride0 + i1 * stride1 + *(++index_it) - offset;
+          }
+          break;
+        }
+        default:
+          for(; first != last; ++first, ++result)
+            *result = ordinal(*first);
+      }
+
+      return result;
     }
 
     /// calculate the coordinate index of the ordinal index, \c index.
@@ -865,9 +1055,11 @@ namespace TiledArray {
       // Reallocate the array
       const unsigned int four_x_rank = rank << 2;
       if(rank_ != rank) {
-        delete [] data_;
-        data_ = (rank > 0u ? new size_type[four_x_rank] : nullptr);
+        release(data_);
+        data_ = allocate(rank);
         rank_ = rank;
+      } else {
+        unshare();
       }
 
       // Get range data
@@ -971,6 +1163,8 @@ namespace TiledArray {
   inline Range& Range::operator *=(const Permutation& perm) {
     TA_ASSERT(perm.dim() == rank_);
     if(rank_ > 1ul) {
+      unshare();
+
       // Copy the lower and upper bound data into a temporary array
       size_type* MADNESS_RESTRICT const temp_lower = new size_type[rank_ << 1];
       const size_type* MADNESS_RESTRICT const temp_upper = temp_lower + rank_;
@@ -999,6 +1193,40 @@ namespace TiledArray {
     return Range(perm, r);
   }
 
+  namespace detail {
+
+    /// Check that a permutation does not move the elements of a range
+
+    /// The ordinals of the elements of \c perm*range are equal to those of
+    /// \c range when the dimensions with an extent greater than one keep
+    /// their relative order, i.e. \c perm moves only unit dimensions. A
+    /// tile can then be permuted by permuting its range, without moving its
+    /// data.
+    /// \param perm The permutation to be applied to \c range
+    /// \param range The range to be permuted
+    /// \return \c true when \c perm does not reorder the elements of
+    /// \c range
+    inline bool is_layout_preserving(const Permutation& perm, const Range& range) {
+      if(! perm)
+        return true;
+      TA_ASSERT(perm.dim() == range.rank());
+
+      const auto* MADNESS_RESTRICT const extent = range.extent_data();
+      bool first = true;
+      unsigned int last = 0u;
+      for(unsigned int i = 0u; i < range.rank(); ++i) {
+        if(extent[i] == 1ul)
+          continue;
+        if(! first && (perm[i] < last))
+          return false;
+        last = perm[i];
+        first = false;
+      }
+      return true;
+    }
+
+  }  // namespace detail
+
   /// Range equality comparison
 
   /// \param r1 The first range to be compared
@@ -51,7 +51,9 @@ namespace TiledArray {
     /// Coordinate index iterate
 
     /// This is an input iterator that is used to iterate over the coordinate
-    /// indexes of a \c Range.
+    /// indexes of a \c Range. The iterator also tracks its position in the
+    /// range, which is updated with each increment, so comparison, distance,
+    /// and ordinal queries do not loop over the rank of the index.
     /// \tparam T The value type of the iterator
     /// \tparam Container The container that the iterator references
     /// \note The container object must define the function
@@ -73,15 +75,17 @@ namespace TiledArray {
 
       /// \param other The other iterator to be copied
       RangeIterator(const RangeIterator_& other) :
-        container_(other.container_), current_(other.current_) {
-      }
+        container_(other.container_), current_(other.current_),
+        ordinal_(other.ordinal_)
+      { }
 
       /// Construct an index iterator
 
       /// \param v The initial value of the iterator index
       /// \param c The container that the iterator will reference
-      RangeIterator(const T* v, const Container* c) :
-          container_(c), current_(v, v + c->rank())
+      /// \param o The position of \c v in \c c
+      RangeIterator(const T* v, const Container* c, const difference_type o = 0) :
+          container_(c), current_(v, v + c->rank()), ordinal_(o)
       { }
 
       /// Copy constructor
@@ -91,12 +95,19 @@ namespace TiledArray {
       RangeIterator_& operator=(const RangeIterator_& other) {
         current_ = other.current_;
         container_ = other.container_;
+        ordinal_ = other.ordinal_;
 
         return *this;
       }
 
       const Container* container() const { return container_; }
 
+      /// Position accessor
+
+      /// \return The position of the iterator in the container, which is
+      /// the ordinal index of the current index in a \c Range
+      difference_type ordinal() const { return ordinal_; }
+
       /// Dereference operator
 
       /// \return A \c reference to the current data
@@ -108,6 +119,7 @@ namespace TiledArray {
       /// \return The modified iterator
       RangeIterator_& operator++() {
         container_->increment(current_);
+        ++ordinal_;
         return *this;
       }
 
@@ -118,6 +130,7 @@ namespace TiledArray {
       RangeIterator_ operator++(int) {
         RangeIterator_ temp(*this);
         container_->increment(current_);
+        ++ordinal_;
         return temp;
       }
 
@@ -129,23 +142,26 @@ namespace TiledArray {
 
       void advance(difference_type n) {
         container_->advance(current_, n);
+        ordinal_ += n;
       }
 
       difference_type distance_to(const RangeIterator_& other) const {
         TA_ASSERT(container_ == other.container_);
-        return container_->distance_to(current_, other.current_);
+        return other.ordinal_ - ordinal_;
       }
 
     private:
 
       const Container* container_;  ///< The container that the iterator references
       std::vector<T> current_;      ///< The current value of the iterator
+      difference_type ordinal_;     ///< The position of the iterator
     }; // class RangeIterator
 
     /// Equality operator
 
     /// Compares the iterators for equality. They must reference the same range
-    /// object to be considered equal.
+    /// object to be considered equal. Iterators of the same range are compared
+    /// by position.
     /// \tparam T The value type of the iterator
     /// \tparam Container The container that the iterator references
     /// \param left_it The left-hand iterator to be compared
@@ -156,7 +172,7 @@ namespace TiledArray {
     bool operator==(const RangeIterator<T, Container>& left_it,
         const RangeIterator<T, Container>& right_it)
     {
-      return ((*left_it) == (*right_it)) &&
+      return (left_it.ordinal() == right_it.ordinal()) &&
           (left_it.container() == right_it.container());
     }
 
@@ -173,7 +189,7 @@ namespace TiledArray {
     bool operator!=(const RangeIterator<T, Container>& left_it,
         const RangeIterator<T, Container>& right_it)
     {
-      return ((*left_it) != (*right_it)) ||
+      return (left_it.ordinal() != right_it.ordinal()) ||
           (left_it.container() != right_it.container());
     }
 
@@ -22,10 +22,38 @@
 
 #include <TiledArray/error.h>
 #include <TiledArray/madness.h>
+#include <TiledArray/tile_interface/clone.h>
+#include <TiledArray/type_traits.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
 
+    GENERATE_HAS_MEMBER_FUNCTION_ANYRETURN(batch)
+
+    /// The default number of partial reductions of a reduce task
+
+    /// The arguments of a reduce task are distributed over its partial
+    /// reductions, each with its own lock and result object, and the
+    /// partial results are merged when the task runs. More partials reduce
+    /// the contention between threads that complete arguments of the same
+    /// reduction at the same time, at the cost of one result object per
+    /// partial. The number is read from the \c TA_REDUCE_PARTIALS
+    /// environment variable. The default is 1, i.e. a single shared result.
+    /// \return The default number of partial reductions
+    inline unsigned int reduce_task_partials() {
+      static const unsigned int partials = [] () -> unsigned int {
+        const char* partials = getenv("TA_REDUCE_PARTIALS");
+        if(partials)
+          return std::max(std::strtoul(partials, nullptr, 10), 1ul);
+        return 1u;
+      }();
+      return partials;
+    }
+
     template <typename T>
     struct ArgumentHelper {
       typedef Future<T> type;
@@ -62,6 +90,51 @@ namespace TiledArray {
     private:
       opT op_; ///< The pairwise reduction operation
 
+      /// Batch check for operations that support batched reduction
+      template <typename Op>
+      static typename std::enable_if<has_member_function_batch_anyreturn<const Op,
+          const first_argument_type&, const second_argument_type&>::value,
+          bool>::type
+      is_batch(const Op& op, const argument_type& arg) {
+        return op.batch(arg.first.get(), arg.second.get());
+      }
+
+      /// Batch check for operations that do not support batched reduction
+      template <typename Op>
+      static typename std::enable_if<! has_member_function_batch_anyreturn<const Op,
+          const first_argument_type&, const second_argument_type&>::value,
+          bool>::type
+      is_batch(const Op&, const argument_type&) { return false; }
+
+      /// Batched reduction for operations that support batched reduction
+      template <typename Op>
+      static typename std::enable_if<has_member_function_batch_anyreturn<const Op,
+          const first_argument_type&, const second_argument_type&>::value>::type
+      reduce_batch(const Op& op, result_type& result,
+          const std::vector<const argument_type*>& args)
+      {
+        std::vector<const first_argument_type*> left;
+        std::vector<const second_argument_type*> right;
+        left.reserve(args.size());
+        right.reserve(args.size());
+        for(const argument_type* arg : args) {
+          left.push_back(& arg->first.get());
+          right.push_back(& arg->second.get());
+        }
+        op(result, left, right);
+      }
+
+      /// Batched reduction for operations that do not support batched reduction
+      template <typename Op>
+      static typename std::enable_if<! has_member_function_batch_anyreturn<const Op,
+          const first_argument_type&, const second_argument_type&>::value>::type
+      reduce_batch(const Op& op, result_type& result,
+          const std::vector<const argument_type*>& args)
+      {
+        for(const argument_type* arg : args)
+          op(result, arg->first, arg->second);
+      }
+
     public:
       /// Default constructor
       ReducePairOpWrapper() : op_() { }
@@ -111,6 +184,23 @@ namespace TiledArray {
         op_(result, arg.first, arg.second);
       }
 
+      /// Check that an argument pair may be reduced in a batch
+
+      /// \param arg The argument pair, which must be ready
+      /// \return \c true if the base operation supports batched reduction and
+      /// reports that \c arg should be batched
+      bool batch(const argument_type& arg) const { return is_batch(op_, arg); }
+
+      /// Reduce a batch of argument pairs
+
+      /// \param[out] result The object that will hold the result of this reduction
+      /// \param[in] args The argument pairs to be reduced
+      void operator()(result_type& result,
+          const std::vector<const argument_type*>& args) const
+      {
+        reduce_batch(op_, result, args);
+      }
+
     }; // class ReducePairOpWrapper
 
 
@@ -156,6 +246,27 @@ namespace TiledArray {
     /// }; // struct ReductionOp
     /// \endcode
     ///
+    /// The reduction operation may also support batched reduction of
+    /// arguments, which is useful when the cost of an individual reduction is
+    /// dominated by overhead, by providing the following functions:
+    /// \code
+    ///     // Check that an argument should be reduced in a batch
+    ///     bool batch(const argument_type&) const;
+    ///
+    ///     // Reduce a batch of arguments
+    ///     void operator()(result_type&, const std::vector<const argument_type*>&) const;
+    /// \endcode
+    /// Arguments that should be batched are held while all result objects
+    /// are busy, instead of being paired for a new reduction task, and they
+    /// are reduced together by the next result object that becomes
+    /// available.
+    ///
+    /// The arguments may be distributed over several partial reductions, see
+    /// \c reduce_task_partials() . Each partial has its own lock and result
+    /// object, and the partial results are reduced with
+    /// <tt>void operator()(result_type&, const result_type&) const</tt> when
+    /// the task runs.
+    ///
     /// For example, a vector sum function might look like:
     ///
     /// \code
@@ -286,6 +397,24 @@ namespace TiledArray {
 
         }; // class ReduceObject
 
+        /// Partial reduction state
+
+        /// Each partial owns one or more result objects and the arguments
+        /// that are waiting for them. Arguments are distributed over the
+        /// partials, so concurrent callbacks only contend for the lock of
+        /// their partial, and the partial results are merged by \c run() .
+        struct Partial {
+          std::shared_ptr<result_type> ready_result_; ///< Result object that is ready to be reduced
+          ReduceObject* ready_object_; ///< Reduction argument that is ready to be reduced
+          std::vector<ReduceObject*> batch_objects_; ///< Reduction arguments that are ready to be reduced in a batch
+          madness::Spinlock lock_; ///< Partial lock
+          char pad_[64]; ///< Keep the locks of neighbouring partials off the same cache line
+
+          Partial() :
+            ready_result_(), ready_object_(nullptr), batch_objects_(), lock_()
+          { }
+        }; // struct Partial
+
         virtual void get_id(std::pair<void*,unsigned short>& id) const {
           return PoolTaskInterface::make_id(id, *this);
         }
@@ -298,14 +427,32 @@ namespace TiledArray {
         /// state.
         /// \param result The result object that will be used to reduce
         /// other data
-        void reduce(std::shared_ptr<result_type>& result) {
+        /// \param partial The partial that owns \c result
+        void reduce(std::shared_ptr<result_type>& result, Partial* partial) {
           while(result) {
-            lock_.lock(); // <<< Begin critical section
-            if(ready_object_) {
+            partial->lock_.lock(); // <<< Begin critical section
+            if(! partial->batch_objects_.empty()) {
+              // Get the batched arguments
+              std::vector<ReduceObject*> batch_objects;
+              batch_objects.swap(partial->batch_objects_);
+              partial->lock_.unlock(); // <<< End critical section
+
+              // Reduce the arguments that were held by batch_objects_
+              if(batch_objects.size() == 1ul)
+                op_(*result, batch_objects.front()->arg());
+              else
+                reduce_batch(*result, batch_objects);
+
+              // cleanup the arguments
+              for(ReduceObject* batch_object : batch_objects) {
+                ReduceObject::destroy(batch_object);
+                this->dec();
+              }
+            } else if(partial->ready_object_) {
               // Get the ready argument
-              ReduceObject* ready_object = const_cast<ReduceObject*>(ready_object_);
-              ready_object_ = nullptr;
-              lock_.unlock(); // <<< End critical section
+              ReduceObject* ready_object = partial->ready_object_;
+              partial->ready_object_ = nullptr;
+              partial->lock_.unlock(); // <<< End critical section
 
               // Reduce the argument that was held by ready_object_
               op_(*result, ready_object->arg());
@@ -313,11 +460,11 @@ namespace TiledArray {
               // cleanup the argument
               ReduceObject::destroy(ready_object);
               this->dec();
-            } else if(ready_result_) {
+            } else if(partial->ready_result_) {
               // Get the ready result
-              std::shared_ptr<result_type> ready_result = ready_result_;
-              ready_result_.reset();
-              lock_.unlock(); // <<< End critical section
+              std::shared_ptr<result_type> ready_result = partial->ready_result_;
+              partial->ready_result_.reset();
+              partial->lock_.unlock(); // <<< End critical section
 
               // Reduce the result that was held by ready_result_
               op_(*result, *ready_result);
@@ -326,9 +473,9 @@ namespace TiledArray {
               ready_result.reset();
             } else {
               // Nothing is ready, so place result in the ready state.
-              ready_result_ = result;
+              partial->ready_result_ = result;
               result.reset();
-              lock_.unlock(); // <<< End critical section
+              partial->lock_.unlock(); // <<< End critical section
             }
           }
         }
@@ -337,7 +484,12 @@ namespace TiledArray {
 
         /// \param result The target of the reduction
         /// \param object The reduction argument to be reduced
-        void reduce_result_object(std::shared_ptr<result_type> result, const ReduceObject* object) {
+        /// \param partial The partial that owns \c result
+        void reduce_result_object(std::shared_ptr<result_type> result,
+            const ReduceObject* object, Partial* partial)
+        {
+          TaskTraceScope trace("reduce");
+
           // Reduce the argument
           op_(*result, object->arg());
 
@@ -345,15 +497,89 @@ namespace TiledArray {
           ReduceObject::destroy(object);
 
           // Check for more reductions
-          reduce(result);
+          reduce(result, partial);
 
           // Decrement the dependency counter for the argument. This must
           // be done after the reduce call to avoid a race condition.
           this->dec();
         }
 
+        /// Reduce the initial value of the result
+
+        /// The seed is reduced by the first partial. It is cloned, since the
+        /// arguments are reduced into the result in place and the data of
+        /// \c seed may be shared with other objects, e.g. the tiles of an
+        /// array.
+        /// \param seed The initial value of the result
+        void reduce_seed(const result_type& seed) {
+          using TiledArray::clone;
+          std::shared_ptr<result_type> result =
+              std::make_shared<result_type>(clone(seed));
+
+          // Check for more reductions
+          reduce(result, partials_.get());
+
+          // Decrement the dependency counter for the initial value. This must
+          // be done after the reduce call to avoid a race condition.
+          this->dec();
+        }
+
+        /// Check that a reduction argument should be reduced in a batch
+
+        /// \param object The reduction object, which must be ready
+        /// \return \c true if \c object should be reduced in a batch
+        template <typename Op = opT>
+        typename std::enable_if<has_member_function_batch_anyreturn<const Op,
+            const argument_type&>::value, bool>::type
+        batch(const ReduceObject* object) const {
+          return op_.batch(object->arg());
+        }
+
+        /// Check that a reduction argument should be reduced in a batch
+
+        /// \return \c false , since \c opT does not support batched reduction
+        template <typename Op = opT>
+        typename std::enable_if<! has_member_function_batch_anyreturn<const Op,
+            const argument_type&>::value, bool>::type
+        batch(const ReduceObject*) const { return false; }
+
+        /// Reduce a batch of reduction arguments
+
+        /// \param result The target of the reduction
+        /// \param objects The reduction arguments to be reduced
+        template <typename Op = opT>
+        typename std::enable_if<has_member_function_batch_anyreturn<const Op,
+            const argument_type&>::value>::type
+        reduce_batch(result_type& result, const std::vector<ReduceObject*>& objects) {
+          std::vector<const argument_type*> args;
+          args.reserve(objects.size());
+          for(const ReduceObject* object : objects)
+            args.push_back(& object->arg());
+          op_(result, args);
+        }
+
+        /// Reduce a batch of reduction arguments
+
+        /// \param result The target of the reduction
+        /// \param objects The reduction arguments to be reduced
+        template <typename Op = opT>
+        typename std::enable_if<! has_member_function_batch_anyreturn<const Op,
+            const argument_type&>::value>::type
+        reduce_batch(result_type& result, const std::vector<ReduceObject*>& objects) {
+          for(const ReduceObject* object : objects)
+            op_(result, object->arg());
+        }
+
         /// Reduce two reduction arguments
-        void reduce_object_object(const ReduceObject* object1, const ReduceObject* object2) {
+
+        /// \param object1 The first reduction argument
+        /// \param object2 The second reduction argument
+        /// \param partial The partial that will own the new result
+        void reduce_object_object(const ReduceObject* object1,
+            const ReduceObject* object2, Partial* partial)
+        {
+          TaskTraceScope trace("reduce");
+
           // Construct an empty result object
           auto result = std::make_shared<result_type>(op_());
 
@@ -366,7 +592,7 @@ namespace TiledArray {
           ReduceObject::destroy(object2);
 
           // Check for more reductions
-          reduce(result);
+          reduce(result, partial);
 
           // Decrement the dependency counter for the two arguments. This
           // must be done after the reduce call to avoid a race condition.
@@ -374,13 +600,26 @@ namespace TiledArray {
           this->dec();
         }
 
+        /// Select the partial for a ready argument
+
+        /// Arguments are distributed round-robin over the partials with an
+        /// atomic counter, so no lock is held to select a partial.
+        /// \return The partial that will reduce the next ready argument
+        Partial* next_partial() {
+          if(npartials_ == 1u)
+            return partials_.get();
+          const unsigned int i = static_cast<unsigned int>(next_++);
+          return partials_.get() + (i % npartials_);
+        }
+
         World& world_; ///< The world that owns this task
         opT op_; ///< The reduction operation
-        std::shared_ptr<result_type> ready_result_; ///< Result object that is ready to be reduced
-        volatile ReduceObject* ready_object_; ///< Reduction argument that is ready to be reduced
+        unsigned int npartials_; ///< The number of partials
+        std::unique_ptr<Partial[]> partials_; ///< The partial reductions
+        madness::AtomicInt next_; ///< Round-robin partial counter
         Future<result_type> result_; ///< The result of the reduction task
-        madness::Spinlock lock_; ///< Task lock
         madness::CallbackInterface* callback_; ///< The completion callback
+        madness::TaskAttributes attr_; ///< The attributes of the reduction tasks
 
       public:
 
@@ -390,48 +629,100 @@ namespace TiledArray {
         /// \param op The reduction operation
         /// \param callback The callback that will be invoked when this task
         /// has completed
-        ReduceTaskImpl(World& world, opT op, madness::CallbackInterface* callback) :
+        /// \param attr The attributes of the tasks that reduce the arguments
+        /// \param npartials The number of partial reductions
+        ReduceTaskImpl(World& world, opT op, madness::CallbackInterface* callback,
+            const madness::TaskAttributes& attr, const unsigned int npartials) :
           madness::TaskInterface(1, TaskAttributes::hipri()),
-          world_(world), op_(op), ready_result_(std::make_shared<result_type>(op())),
-          ready_object_(nullptr), result_(), lock_(), callback_(callback)
-        { }
+          world_(world), op_(op), npartials_(std::max(npartials, 1u)),
+          partials_(new Partial[npartials_]), next_(), result_(),
+          callback_(callback), attr_(attr)
+        {
+          next_ = 0;
+          for(unsigned int i = 0u; i < npartials_; ++i)
+            partials_[i].ready_result_ = std::make_shared<result_type>(op_());
+        }
+
+        /// Implementation constructor
+
+        /// The arguments are reduced into a copy of \c seed instead of a new
+        /// result object constructed with <tt>op()</tt> ; \c seed itself is
+        /// not modified.
+        /// \param world The world that owns this task
+        /// \param op The reduction operation
+        /// \param seed The initial value of the result
+        /// \param callback The callback that will be invoked when this task
+        /// has completed
+        /// \param attr The attributes of the tasks that reduce the arguments
+        /// \param npartials The number of partial reductions
+        ReduceTaskImpl(World& world, opT op, const Future<result_type>& seed,
+            madness::CallbackInterface* callback, const madness::TaskAttributes& attr,
+            const unsigned int npartials) :
+          madness::TaskInterface(2, TaskAttributes::hipri()),
+          world_(world), op_(op), npartials_(std::max(npartials, 1u)),
+          partials_(new Partial[npartials_]), next_(), result_(),
+          callback_(callback), attr_(attr)
+        {
+          next_ = 0;
+          // The first partial reduces the seed, the others start empty
+          for(unsigned int i = 1u; i < npartials_; ++i)
+            partials_[i].ready_result_ = std::make_shared<result_type>(op_());
+          world_.taskq.add(this, & ReduceTaskImpl::reduce_seed, seed, attr_);
+        }
 
         virtual ~ReduceTaskImpl() { }
 
         /// Task function
+
+        /// Merge the partial results and set the result of the reduction.
         virtual void run(const madness::TaskThreadEnv&) {
-          MADNESS_ASSERT(ready_result_);
-          result_.set(op_(*ready_result_));
+          TaskTraceScope trace("reduce_result");
+          MADNESS_ASSERT(partials_[0].ready_result_);
+          result_type& result = *partials_[0].ready_result_;
+          for(unsigned int i = 1u; i < npartials_; ++i) {
+            MADNESS_ASSERT(partials_[i].ready_result_);
+            op_(result, *partials_[i].ready_result_);
+            partials_[i].ready_result_.reset();
+          }
+          result_.set(op_(result));
           if(callback_)
             callback_->notify();
         }
 
         /// Callback function invoked by \c ReductionObject
 
-        /// This function will place \c object in the ready state. If
-        /// another object is already in the ready state, then both objects
-        /// are used to spawn a task
+        /// This function will place \c object in the ready state of the next
+        /// partial. If another object is already in the ready state, then
+        /// both objects are used to spawn a task. Objects that should be
+        /// reduced in a batch are held until a result object of the partial
+        /// is available.
         /// \param object The reduction object that is ready to be reduced
         void ready(ReduceObject* object) {
           MADNESS_ASSERT(object);
-          lock_.lock(); // <<< Begin critical section
-          if(ready_result_) {
-            std::shared_ptr<result_type> ready_result = ready_result_;
-            ready_result_.reset();
-            lock_.unlock(); // <<< End critical section
+          Partial* const partial = next_partial();
+          partial->lock_.lock(); // <<< Begin critical section
+          if(partial->ready_result_) {
+            std::shared_ptr<result_type> ready_result = partial->ready_result_;
+            partial->ready_result_.reset();
+            partial->lock_.unlock(); // <<< End critical section
             MADNESS_ASSERT(ready_result);
             world_.taskq.add(this, & ReduceTaskImpl::reduce_result_object,
-                ready_result, object, TaskAttributes::hipri());
-          } else if(ready_object_) {
-            ReduceObject* ready_object = const_cast<ReduceObject*>(ready_object_);
-            ready_object_ = nullptr;
-            lock_.unlock(); // <<< End critical section
+                ready_result, object, partial, attr_);
+          } else if(batch(object)) {
+            // All result objects are busy, so the next one that is done will
+            // reduce object with the other batched objects.
+            partial->batch_objects_.push_back(object);
+            partial->lock_.unlock(); // <<< End critical section
+          } else if(partial->ready_object_) {
+            ReduceObject* ready_object = partial->ready_object_;
+            partial->ready_object_ = nullptr;
+            partial->lock_.unlock(); // <<< End critical section
             MADNESS_ASSERT(ready_object);
             world_.taskq.add(this, & ReduceTaskImpl::reduce_object_object,
-                object, ready_object, TaskAttributes::hipri());
+                object, ready_object, partial, attr_);
           } else {
-            ready_object_ = object;
-            lock_.unlock(); // <<< End critical section
+            partial->ready_object_ = object;
+            partial->lock_.unlock(); // <<< End critical section
           }
         }
 
@@ -463,9 +754,36 @@ namespace TiledArray {
       /// \param op The reduction operation [ default = opT() ]
       /// \param callback The callback that will be invoked when this task is
       /// complete
+      /// \param attr The attributes of the tasks that reduce the arguments
+      /// [ default = high priority ]
+      /// \param partials The number of partial reductions
+      /// [ default = reduce_task_partials() ]
       ReduceTask(World& world, const opT& op = opT(),
-          madness::CallbackInterface* callback = nullptr) :
-        pimpl_(new ReduceTaskImpl(world, op, callback)), count_(0ul)
+          madness::CallbackInterface* callback = nullptr,
+          const madness::TaskAttributes& attr = madness::TaskAttributes::hipri(),
+          const unsigned int partials = reduce_task_partials()) :
+        pimpl_(new ReduceTaskImpl(world, op, callback, attr, partials)), count_(0ul)
+      { }
+
+      /// Constructor
+
+      /// The arguments are reduced into a copy of \c seed , instead of a result
+      /// constructed with <tt>op()</tt> ; \c seed
+      /// itself is not modified.
+      /// \param world The world that owns this task
+      /// \param op The reduction operation
+      /// \param seed The initial value of the result
+      /// \param callback The callback that will be invoked when this task is
+      /// complete
+      /// \param attr The attributes of the tasks that reduce the arguments
+      /// [ default = high priority ]
+      /// \param partials The number of partial reductions
+      /// [ default = reduce_task_partials() ]
+      ReduceTask(World& world, const opT& op, const Future<result_type>& seed,
+          madness::CallbackInterface* callback = nullptr,
+          const madness::TaskAttributes& attr = madness::TaskAttributes::hipri(),
+          const unsigned int partials = reduce_task_partials()) :
+        pimpl_(new ReduceTaskImpl(world, op, seed, callback, attr, partials)), count_(0ul)
       { }
 
       /// Move constructor
@@ -654,8 +972,36 @@ namespace TiledArray {
       /// \param op The pair reduction operation [ default = opT() ]
       /// \param callback The callback that will be invoked when this task is
       /// complete
-      ReducePairTask(World& world, const opT& op = opT(), madness::CallbackInterface* callback = nullptr) :
-        ReduceTask_(world, op_type(op), callback)
+      /// \param attr The attributes of the tasks that reduce the pairs
+      /// [ default = high priority ]
+      /// \param partials The number of partial reductions
+      /// [ default = reduce_task_partials() ]
+      ReducePairTask(World& world, const opT& op = opT(), madness::CallbackInterface* callback = nullptr,
+          const madness::TaskAttributes& attr = madness::TaskAttributes::hipri(),
+          const unsigned int partials = reduce_task_partials()) :
+        ReduceTask_(world, op_type(op), callback, attr, partials)
+      { }
+
+      /// Constructor
+
+      /// The argument pairs are reduced into a copy of \c seed , instead of a result
+      /// constructed with <tt>op()</tt> ; \c seed
+      /// itself is not modified.
+      /// \param world The world that owns this task
+      /// \param op The pair reduction operation
+      /// \param seed The initial value of the result
+      /// \param callback The callback that will be invoked when this task is
+      /// complete
+      /// \param attr The attributes of the tasks that reduce the pairs
+      /// [ default = high priority ]
+      /// \param partials The number of partial reductions
+      /// [ default = reduce_task_partials() ]
+      ReducePairTask(World& world, const opT& op,
+          const Future<typename op_type::result_type>& seed,
+          madness::CallbackInterface* callback = nullptr,
+          const madness::TaskAttributes& attr = madness::TaskAttributes::hipri(),
+          const unsigned int partials = reduce_task_partials()) :
+        ReduceTask_(world, op_type(op), seed, callback, attr, partials)
       { }
 
       /// Move constructor
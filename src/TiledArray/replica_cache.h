@@ -0,0 +1,231 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  replica_cache.h
+ *  Mar 23, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_REPLICA_CACHE_H__INCLUDED
+#define TILEDARRAY_REPLICA_CACHE_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/pmap/replicated_pmap.h>
+#include <TiledArray/replicator.h>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// 64-bit FNV-1a checksum of a buffer
+
+    /// The buffer is hashed one 64-bit word at a time, and the trailing
+    /// bytes one byte at a time.
+    /// \param data The buffer
+    /// \param bytes The size of the buffer in bytes
+    /// \return The checksum of the buffer
+    inline std::uint64_t checksum(const void* data, const std::size_t bytes) {
+      const std::uint64_t prime = 1099511628211ull;
+      std::uint64_t hash = 14695981039346656037ull;
+      const unsigned char* p = static_cast<const unsigned char*>(data);
+      const std::size_t words = bytes / sizeof(std::uint64_t);
+      for(std::size_t i = 0ul; i < words; ++i, p += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(& word, p, sizeof(std::uint64_t));
+        hash = (hash ^ word) * prime;
+      }
+      for(std::size_t i = words * sizeof(std::uint64_t); i < bytes; ++i, ++p)
+        hash = (hash ^ std::uint64_t(*p)) * prime;
+      return hash;
+    }
+
+    /// Checksum of a tile
+
+    /// \param tile The tile
+    /// \return \c {true,checksum} for tensors of trivially copyable
+    /// elements, and \c {false,0} for other tiles, which cannot be compared
+    template <typename T, typename A>
+    inline typename std::enable_if<std::is_trivially_copyable<T>::value,
+        std::pair<bool, std::uint64_t> >::type
+    tile_checksum(const Tensor<T, A>& tile) {
+      return std::make_pair(true, (tile.empty() ? std::uint64_t(0) :
+          checksum(tile.data(), tile.size() * sizeof(T))));
+    }
+
+    template <typename Tile>
+    inline std::pair<bool, std::uint64_t> tile_checksum(const Tile&) {
+      return std::make_pair(false, std::uint64_t(0));
+    }
+
+  }  // namespace detail
+
+  /// Cache of the replica of a read-only array
+
+  /// Replicating the same array in every iteration of a loop, e.g. a Fock or
+  /// density matrix used by \c ReplicatedPmap expressions, communicates all
+  /// of its tiles each time. This cache keeps the last replica: when the
+  /// array is unchanged, i.e. it is the same array object with the same
+  /// \c DistArray::version() , the cached replica is returned after one
+  /// small reduction. When the array has changed but has the same tiled
+  /// range, e.g. it is the result of a new assignment, the owners of the
+  /// tiles compare checksums of their tiles with those of the last
+  /// replication, and only the modified tiles are sent, while the other
+  /// tiles are shared with the previous replica, e.g.
+  /// \code
+  /// TiledArray::ReplicaCache<TArrayD> fock_replica;
+  /// for(...) {
+  ///   const TArrayD& f = fock_replica(fock);
+  ///   ...
+  /// }
+  /// \endcode
+  /// The tiles of the replica must not be modified. Tile checksums are
+  /// computed for tensors of trivially copyable elements; other tiles are
+  /// sent whenever the array changes.
+  /// \tparam Array The array type
+  template <typename Array>
+  class ReplicaCache {
+  public:
+    typedef typename Array::size_type size_type; ///< Tile index type
+    typedef typename Array::value_type value_type; ///< Tile type
+
+  private:
+    Array replica_; ///< The last replica
+    madness::uniqueidT source_id_; ///< The id of the last replicated array
+    unsigned long version_; ///< The version of the last replicated array
+    std::vector<std::uint64_t> checksums_; ///< Checksums of the last local tiles
+    std::vector<char> known_; ///< Local tiles with a checksum
+    size_type replicated_; ///< The tiles sent by the last replication
+
+  public:
+
+    ReplicaCache() :
+      replica_(), source_id_(), version_(0ul), checksums_(), known_(),
+      replicated_(0ul)
+    { }
+
+    ReplicaCache(const ReplicaCache&) = delete;
+    ReplicaCache& operator=(const ReplicaCache&) = delete;
+
+    /// Replicate an array
+
+    /// This function is collective, and it waits for the local tiles of
+    /// \c source when \c source has changed since the last replication.
+    /// \param source The array to be replicated
+    /// \return The replica of \c source , which is valid until the next
+    /// call
+    const Array& operator()(const Array& source) {
+      World& world = source.world();
+      const size_type size = source.size();
+
+      int stale = ! (replica_.is_initialized() && (source_id_ == source.id())
+          && (version_ == source.version()));
+      world.gop.sum(stale);
+      if(! stale) {
+        replicated_ = 0ul;
+        return replica_;
+      }
+
+      if(source.pmap()->is_replicated()) {
+        replica_ = source;
+        replicated_ = 0ul;
+        source_id_ = source.id();
+        version_ = source.version();
+        return replica_;
+      }
+
+      const bool delta = replica_.is_initialized() &&
+          (& replica_.world() == & world) && (replica_.trange() == source.trange());
+      if(! delta) {
+        checksums_.assign(size, 0ull);
+        known_.assign(size, 0);
+      }
+
+      // Compare the checksums of the local tiles with the last replication
+      std::vector<std::pair<size_type, Future<std::pair<bool, std::uint64_t> > > > sums;
+      for(const auto i : *source.pmap()) {
+        if(source.is_zero(i)) {
+          known_[i] = 0;
+          continue;
+        }
+        sums.emplace_back(i, world.taskq.add([] (const value_type& tile) {
+          return detail::tile_checksum(tile);
+        }, source.find(i)));
+      }
+      std::vector<int> send(size, 0);
+      for(auto& sum : sums) {
+        const size_type i = sum.first;
+        const std::pair<bool, std::uint64_t> checksum = sum.second.get();
+        send[i] = ! (delta && checksum.first && known_[i] &&
+            (checksums_[i] == checksum.second) && ! replica_.is_zero(i));
+        checksums_[i] = checksum.second;
+        known_[i] = checksum.first;
+      }
+      world.gop.sum(send.data(), send.size());
+
+      // Share the unchanged tiles with the last replica, and replicate the
+      // others
+      std::shared_ptr<typename Array::pmap_interface> pmap =
+          std::make_shared<detail::ReplicatedPmap>(world, size);
+      Array result(world, source.trange(), source.shape(), pmap);
+      replicated_ = 0ul;
+      for(size_type i = 0ul; i < size; ++i) {
+        if(result.is_zero(i))
+          continue;
+        if(send[i]) {
+          ++replicated_;
+          if(world.size() == 1)
+            result.set(i, source.find(i));
+        } else {
+          result.set(i, replica_.find(i));
+        }
+      }
+      if((world.size() > 1) && replicated_) {
+        std::shared_ptr<detail::Replicator<Array> > replicator(
+            new detail::Replicator<Array>(source, result, send));
+
+        // Put the replicator pointer in the deferred cleanup object so it
+        // will be deleted at the end of the next fence.
+        TA_ASSERT(replicator.unique()); // Required for deferred_cleanup
+        madness::detail::deferred_cleanup(world, replicator);
+      }
+
+      replica_ = result;
+      source_id_ = source.id();
+      version_ = source.version();
+      return replica_;
+    }
+
+    /// \return The number of tiles that were sent by the last replication
+    size_type replicated_tiles() const { return replicated_; }
+
+    /// Release the cached replica
+    void clear() {
+      replica_ = Array();
+      checksums_.clear();
+      known_.clear();
+      replicated_ = 0ul;
+    }
+
+  }; // class ReplicaCache
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_REPLICA_CACHE_H__INCLUDED
@@ -20,15 +20,64 @@
 #ifndef TILEDARRAY_REPLICATOR_H__INCLUDED
 #define TILEDARRAY_REPLICATOR_H__INCLUDED
 
+#include <TiledArray/comm_stats.h>
 #include <TiledArray/madness.h>
+#include <TiledArray/memory_usage.h>
+#include <algorithm>
+#include <cstdlib>
+#include <stack>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
 
+    /// The size of the tile chunks sent by \c Replicator
+
+    /// The size is read from the \c TA_REPLICATE_CHUNK_BYTES environment
+    /// variable; the default size is 16 MB. A chunk holds at least one tile.
+    /// \return The largest chunk size in bytes
+    inline std::size_t replicate_chunk_bytes() {
+      static const std::size_t chunk_bytes = [] () -> std::size_t {
+        const char* chunk_bytes = getenv("TA_REPLICATE_CHUNK_BYTES");
+        if(chunk_bytes)
+          return std::strtoul(chunk_bytes, nullptr, 10);
+        return 16777216ul;
+      }();
+      return chunk_bytes;
+    }
+
+    /// The number of chunks of each process that \c Replicator keeps in flight
+
+    /// The number is read from the \c TA_REPLICATE_WINDOW environment
+    /// variable; the default is 2.
+    /// \return The largest number of chunks in flight per source process
+    inline std::size_t replicate_window() {
+      static const std::size_t window = [] () -> std::size_t {
+        const char* window = getenv("TA_REPLICATE_WINDOW");
+        if(window)
+          return std::max<std::size_t>(std::strtoul(window, nullptr, 10), 1ul);
+        return 2ul;
+      }();
+      return window;
+    }
+
     /// Replicate a \c Array object
 
     /// This object will create a replicated \c Array from a distributed
-    /// \c Array.
+    /// \c Array. The replicated tiles are stored by the destination array,
+    /// so their memory footprint is reported by
+    /// \c DistArray::memory_usage() of the destination.
+    ///
+    /// The local tiles of each process are split into chunks of at most
+    /// \c replicate_chunk_bytes() , which are passed around a ring: each
+    /// process stores the tiles of a chunk and forwards the chunk to the
+    /// next process, and the last process acknowledges the chunk to its
+    /// source. A chunk is sent as soon as its tiles are ready, and each
+    /// source keeps at most \c replicate_window() chunks in flight, so the
+    /// transfer of one chunk overlaps with the forwarding of the previous
+    /// ones, each process sends every tile once, and the memory held by
+    /// messages in flight is bounded. For processes that share a node, see
+    /// also \c make_node_replicated() , which stores one replica per node.
     /// \tparam A The array type
     /// Homeworld = M7R-227
     template <typename A>
@@ -37,14 +86,21 @@ namespace TiledArray {
       typedef Replicator<A> Replicator_; ///< This object type
       typedef madness::WorldObject<Replicator_> wobj_type; ///< The base object type
       typedef std::stack<madness::CallbackInterface*, std::vector<madness::CallbackInterface*> > callback_type; ///< Callback interface
+      typedef typename A::size_type size_type; ///< Tile index type
+      typedef typename A::value_type value_type; ///< Tile type
+
+      /// A chunk of local tiles
+      struct Chunk {
+        std::vector<size_type> indices; ///< The tile indices
+        std::vector<Future<value_type> > data; ///< The tiles
+      }; // struct Chunk
 
       A destination_; ///< The replicated array
-      std::vector<typename A::size_type> indices_; ///< List of local tile indices
-      std::vector<Future<typename A::value_type> > data_; ///< List of local tiles
-      madness::AtomicInt sent_; ///< The number of nodes the data has been sent to
+      std::vector<Chunk> chunks_; ///< The chunks of local tiles
+      std::size_t next_; ///< The next chunk to be sent
+      madness::AtomicInt acked_; ///< The number of chunks that reached all nodes
       World& world_;
       volatile callback_type callbacks_; ///< A callback stack
-      volatile mutable bool probe_; ///< Cache for local data probe
 
       /// \note Assume object is already locked
       void do_callbacks() {
@@ -55,26 +111,23 @@ namespace TiledArray {
         }
       }
 
-      /// Task that will call send when all local tiles are ready to be sent
+      /// Task that will send a chunk when all of its tiles are ready
       class DelaySend : public madness::TaskInterface {
       private:
         Replicator_& parent_; ///< The parent replicator operation
+        std::size_t chunk_; ///< The chunk to be sent
 
       public:
 
         /// Constructor
-        DelaySend(Replicator_& parent) :
+        DelaySend(Replicator_& parent, const std::size_t chunk) :
           madness::TaskInterface(madness::TaskAttributes::hipri()),
-          parent_(parent)
+          parent_(parent), chunk_(chunk)
         {
-          typename std::vector<Future<typename A::value_type> >::iterator it =
-              parent_.data_.begin();
-          typename std::vector<Future<typename A::value_type> >::iterator end =
-              parent_.data_.end();
-          for(; it != end; ++it) {
-            if(! it->probe()) {
+          for(Future<value_type>& tile : parent_.chunks_[chunk_].data) {
+            if(! tile.probe()) {
               madness::DependencyInterface::inc();
-              it->register_callback(this);
+              tile.register_callback(this);
             }
           }
         }
@@ -83,105 +136,146 @@ namespace TiledArray {
         virtual ~DelaySend() { }
 
         /// Task send task function
-        virtual void run(const madness::TaskThreadEnv&) { parent_.send(); }
+        virtual void run(const madness::TaskThreadEnv&) { parent_.send(chunk_); }
 
       }; // class DelaySend
 
-      /// Probe all local data has been set
+      /// \return The next process in the ring
+      ProcessID next() const { return (world_.rank() + 1) % world_.size(); }
 
-      /// \return \c true when all local tiles have been set
-      bool probe() const {
-        madness::ScopedMutex<madness::Spinlock> locker(this);
+      /// Send a chunk to the next node when its tiles are ready
 
-        if(! probe_) {
-          typename std::vector<Future<typename A::value_type> >::const_iterator it =
-              data_.begin();
-          typename std::vector<Future<typename A::value_type> >::const_iterator end =
-              data_.end();
-          for(; it != end; ++it)
-            if(! it->probe())
-              break;
+      /// \param chunk The chunk to be sent
+      void delay_send(const std::size_t chunk) {
+        bool ready = true;
+        for(const Future<value_type>& tile : chunks_[chunk].data)
+          if(! tile.probe()) {
+            ready = false;
+            break;
+          }
 
-          probe_ = (it == end);
-        }
+        if(ready)
+          send(chunk);
+        else
+          world_.taskq.add(new DelaySend(*this, chunk));
+      }
 
-        return probe_;
+      /// Count a chunk that is sent or forwarded
+
+      /// \param data The tiles of the chunk
+      static void count_chunk(const std::vector<value_type>& data) {
+        if(! comm_stats_enabled())
+          return;
+        std::size_t bytes = 0ul;
+        for(const value_type& tile : data)
+          bytes += detail::tile_bytes(tile);
+        detail::comm_stats_record(CommCategory::replication, 1ul, bytes);
       }
 
-      /// Send data to the next node when it is ready
-      void delay_send() {
-        if(probe()) {
-          // The data is ready so send it now.
-          send(); // Replication is done
-        } else {
-          // The local data is not ready to be sent, so create a task that will
-          // send it when it is ready.
-          DelaySend* delay_send_task = new DelaySend(*this);
-          world_.taskq.add(delay_send_task);
-        }
+      /// Send a chunk of local tiles to the next node
+      void send(const std::size_t chunk) {
+        std::vector<value_type> data;
+        data.reserve(chunks_[chunk].data.size());
+        for(const Future<value_type>& tile : chunks_[chunk].data)
+          data.push_back(tile.get());
+        count_chunk(data);
+        wobj_type::task(next(), & Replicator_::forward_handler, world_.rank(),
+            detail::comm_stats_time(), chunks_[chunk].indices, data,
+            madness::TaskAttributes::hipri());
       }
 
-      /// Send all local data to the next node
-      void send() {
-        const long sent = ++sent_;
-        const ProcessID dest = (world_.rank() + sent) % world_.size();
+      /// Store a chunk and forward it to the next node
 
-        if(dest != world_.rank()) {
-          wobj_type::task(dest, &  Replicator_::send_handler, indices_, data_,
+      /// \param source The process that owns the tiles of the chunk
+      /// \param begin The wall time of \c source when the chunk was sent
+      /// \param indices The tile indices
+      /// \param data The tiles
+      void forward_handler(const ProcessID source, const double begin,
+          const std::vector<size_type>& indices,
+          const std::vector<value_type>& data)
+      {
+        for(std::size_t i = 0ul; i < indices.size(); ++i)
+          destination_.set(indices[i], data[i]);
+
+        if(next() != source) {
+          count_chunk(data);
+          wobj_type::task(next(), & Replicator_::forward_handler, source,
+              begin, indices, data, madness::TaskAttributes::hipri());
+        } else {
+          wobj_type::task(source, & Replicator_::ack_handler, begin,
               madness::TaskAttributes::hipri());
-        } else
-          do_callbacks(); // Replication is done
+        }
       }
 
-      void send_handler(const std::vector<typename A::size_type>& indices,
-          const std::vector<Future<typename A::value_type> >& data)
-      {
-        typename std::vector<typename A::size_type>::const_iterator index_it =
-            indices.begin();
-        typename std::vector<Future<typename A::value_type> >::const_iterator data_it =
-            data.begin();
-        typename std::vector<Future<typename A::value_type> >::const_iterator data_end =
-            data.end();
-
-        for(; data_it != data_end; ++data_it, ++index_it)
-          destination_.set(*index_it, data_it->get());
+      /// Count a chunk that reached all nodes, and send the next chunk
 
-        delay_send();
+      /// \param begin The wall time when the chunk was sent
+      void ack_handler(const double begin) {
+        if(comm_stats_enabled())
+          detail::comm_stats_record_latency(CommCategory::replication, 0ul, begin);
+        std::size_t chunk = chunks_.size();
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          if(next_ < chunks_.size())
+            chunk = next_++;
+          if(std::size_t(++acked_) == chunks_.size())
+            do_callbacks(); // Replication is done
+        }
+        if(chunk < chunks_.size())
+          delay_send(chunk);
       }
 
     public:
 
-      Replicator(const A& source, const A destination) :
+      /// Constructor
+
+      /// \param source The distributed array
+      /// \param destination The replicated array
+      /// \param send The tiles to be replicated, by ordinal index; when
+      /// empty, all non-zero tiles are replicated. Tiles that are not
+      /// replicated must be set in \c destination by the caller.
+      Replicator(const A& source, const A destination,
+          const std::vector<int>& send = std::vector<int>()) :
         wobj_type(source.world()), madness::Spinlock(),
-        destination_(destination), indices_(), data_(), sent_(),
-        world_(source.world()), callbacks_(), probe_(false)
+        destination_(destination), chunks_(), next_(0ul), acked_(),
+        world_(source.world()), callbacks_()
       {
-        sent_ = 0;
+        acked_ = 0;
 
-        // Generate a list of local tiles from other.
+        // Split the local non-zero tiles into chunks
+        const std::size_t chunk_bytes = replicate_chunk_bytes();
+        std::size_t bytes = 0ul;
         typename A::pmap_interface::const_iterator end = source.pmap()->end();
         typename A::pmap_interface::const_iterator it = source.pmap()->begin();
-        indices_.reserve(source.pmap()->local_size());
-        data_.reserve(source.pmap()->local_size());
-        if(source.is_dense()) {
-          // When dense, all tiles are present
-          for(; it != end; ++it) {
-            indices_.push_back(*it);
-            data_.push_back(source.find(*it));
-            destination_.set(*it, data_.back());
+        for(; it != end; ++it) {
+          if(! source.is_dense() && source.is_zero(*it))
+            continue;
+          if(! send.empty() && ! send[*it])
+            continue;
+          const std::size_t tile_bytes =
+              source.trange().make_tile_range(*it).volume() *
+              sizeof(typename A::element_type);
+          if(chunks_.empty() || ((bytes + tile_bytes > chunk_bytes) &&
+              ! chunks_.back().indices.empty()))
+          {
+            chunks_.emplace_back();
+            bytes = 0ul;
           }
-        } else {
-          // When sparse, we need to generate a list
-          for(; it != end; ++it)
-            if(! source.is_zero(*it)) {
-              indices_.push_back(*it);
-              data_.push_back(source.find(*it));
-              destination_.set(*it, data_.back());
-            }
+          bytes += tile_bytes;
+          chunks_.back().indices.push_back(*it);
+          chunks_.back().data.push_back(source.find(*it));
+          destination_.set(*it, chunks_.back().data.back());
         }
 
-        /// Send the data to the first node
-        delay_send();
+        // Send the first chunks
+        std::size_t first = 0ul;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          next_ = std::min(chunks_.size(), replicate_window());
+          first = next_;
+        }
+        for(std::size_t chunk = 0ul; chunk < first; ++chunk)
+          delay_send(chunk);
 
         // Process any pending messages
         wobj_type::process_pending();
@@ -189,10 +283,10 @@ namespace TiledArray {
 
       /// Check that the replication is complete
 
-      /// \return \c true when all data has been transfered.
+      /// \return \c true when all local data has been transfered.
       bool done() {
         madness::ScopedMutex<madness::Spinlock> locker(this);
-        return sent_ == world_.size();
+        return std::size_t(acked_) == chunks_.size();
       }
 
 
@@ -204,7 +298,7 @@ namespace TiledArray {
       /// \param callback The callback object
       void register_callback(madness::CallbackInterface* callback) {
           madness::ScopedMutex<madness::Spinlock> locker(this);
-          if(sent_ == world_.size())
+          if(std::size_t(acked_) == chunks_.size())
             callback->notify();
           else
             const_cast<callback_type&>(callbacks_).push(callback);
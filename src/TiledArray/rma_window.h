@@ -0,0 +1,210 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  rma_window.h
+ *  May 20, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_RMA_WINDOW_H__INCLUDED
+#define TILEDARRAY_RMA_WINDOW_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/madness.h>
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/tiled_range.h>
+#include <TiledArray/zero_copy.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// One-sided access to the tiles of a read-only array
+
+    /// The local tiles of each process are copied into one buffer, which is
+    /// exposed in an MPI-3 window, and remote tiles are read from the
+    /// buffer of their owner with \c MPI_Get , so the owner takes no part in
+    /// the transfer and a busy task queue does not delay it. The tiles are
+    /// packed in the order of their ordinal index, and zero tiles are not
+    /// packed, so the offset of every tile is implied by the tiled range,
+    /// shape, and process map of the array, which all processes know, and no
+    /// offsets are exchanged. The window holds a passive-target epoch on all
+    /// processes from construction until \c release() . Freeing the window is
+    /// collective, so it is only freed by \c release() , which must be called
+    /// on all processes before the window is destroyed; the destructor does
+    /// not free it, since the last owner of a window may be released at a
+    /// different time on each process.
+    /// \tparam Tile The tile type, which must satisfy \c is_zero_copy_tile
+    template <typename Tile>
+    class RmaWindow {
+    public:
+      typedef std::size_t size_type; ///< Size type
+      typedef typename Tile::value_type value_type; ///< Element type
+
+      static_assert(is_zero_copy_tile<Tile>::value,
+          "RMA windows require tiles that hold their elements in one contiguous buffer.");
+
+    private:
+
+      World& world_; ///< The world of the array
+      TiledRange trange_; ///< The tiled range of the array
+      std::shared_ptr<Pmap> pmap_; ///< The process map of the array
+      std::vector<size_type> offsets_; ///< The element offset of each tile in the buffer of its owner
+      std::vector<value_type> buffer_; ///< The local tiles
+      MPI_Win win_; ///< The window of the buffer
+      bool active_; ///< \c true until the window is released
+
+      // Not allowed
+      RmaWindow(const RmaWindow&);
+      RmaWindow& operator=(const RmaWindow&);
+
+      /// Zero-tile offset marker
+      static constexpr size_type zero_offset() {
+        return std::numeric_limits<size_type>::max();
+      }
+
+      /// Check the return code of an MPI call
+      static void check(const int error) {
+        if(error != MPI_SUCCESS)
+          TA_EXCEPTION("An MPI one-sided operation failed.");
+      }
+
+    public:
+
+      /// Expose the local tiles of an array
+
+      /// The local tiles are waited for and copied into the window buffer.
+      /// This function is collective, and all local tiles must have been set.
+      /// \tparam Shape The shape type
+      /// \tparam Find The tile accessor type
+      /// \param world The world of the array
+      /// \param trange The tiled range of the array
+      /// \param shape The shape of the array
+      /// \param pmap The process map of the array
+      /// \param find A function that returns the future of a local tile
+      /// given its ordinal index
+      template <typename Shape, typename Find>
+      RmaWindow(World& world, const TiledRange& trange, const Shape& shape,
+          const std::shared_ptr<Pmap>& pmap, const Find& find) :
+        world_(world), trange_(trange), pmap_(pmap),
+        offsets_(trange.tiles_range().volume(), zero_offset()), buffer_(),
+        win_(MPI_WIN_NULL), active_(false)
+      {
+        // The same offsets are computed by all processes
+        std::vector<size_type> sizes(world.size(), 0ul);
+        std::vector<size_type> indices(offsets_.size());
+        for(size_type i = 0ul; i < indices.size(); ++i)
+          indices[i] = i;
+        const std::vector<size_type> owners = pmap->owners(indices);
+        for(size_type i = 0ul; i < offsets_.size(); ++i) {
+          if(shape.is_zero(i))
+            continue;
+          offsets_[i] = sizes[owners[i]];
+          sizes[owners[i]] += trange.make_tile_range(i).volume();
+        }
+
+        // Copy the local tiles into the buffer
+        buffer_.resize(sizes[world.rank()]);
+        for(const size_type i : *pmap) {
+          if(shape.is_zero(i))
+            continue;
+          const Tile tile = find(i).get();
+          TA_ASSERT(tile.size() == trange.make_tile_range(i).volume());
+          std::copy(tile.data(), tile.data() + tile.size(),
+              buffer_.data() + offsets_[i]);
+        }
+
+        SAFE_MPI_GLOBAL_MUTEX;
+        check(MPI_Win_create(buffer_.data(), buffer_.size() * sizeof(value_type),
+            sizeof(value_type), MPI_INFO_NULL, world.mpi.comm().Get_mpi_comm(),
+            & win_));
+        check(MPI_Win_lock_all(MPI_MODE_NOCHECK, win_));
+        active_ = true;
+      }
+
+      /// Destructor
+
+      /// \pre The window has been released with \c release()
+      ~RmaWindow() {
+        TA_ASSERT(! active_);
+      }
+
+      /// Release the window
+
+      /// The world is fenced first, so no read is in progress. This function
+      /// is collective.
+      void release() {
+        TA_ASSERT(active_);
+        world_.gop.fence();
+        SAFE_MPI_GLOBAL_MUTEX;
+        check(MPI_Win_unlock_all(win_));
+        check(MPI_Win_free(& win_));
+        active_ = false;
+      }
+
+      /// Read a tile
+
+      /// The tile is read from the buffer of its owner, in segments of at
+      /// most 1 GB. This function blocks until the tile has been read, so it
+      /// should be run in a task.
+      /// \param i The ordinal index of a non-zero tile
+      /// \return Tile \c i
+      Tile fetch(const size_type i) const {
+        TA_ASSERT(active_);
+        TA_ASSERT(offsets_[i] != zero_offset());
+        Tile tile(trange_.make_tile_range(i));
+        const ProcessID owner = pmap_->owner(i);
+        const size_type segment =
+            std::max<size_type>((size_type(1) << 30) / sizeof(value_type), 1ul);
+
+        SAFE_MPI_GLOBAL_MUTEX;
+        for(size_type first = 0ul; first < tile.size(); first += segment) {
+          const int bytes = std::min(segment, tile.size() - first) * sizeof(value_type);
+          check(MPI_Get(tile.data() + first, bytes, MPI_BYTE, owner,
+              offsets_[i] + first, bytes, MPI_BYTE, win_));
+        }
+        check(MPI_Win_flush(owner, win_));
+        return tile;
+      }
+
+    }; // class RmaWindow
+
+    /// Read a tile from an RMA window
+
+    /// Readers do not own the window, which is owned by its array and is
+    /// released collectively (see \c RmaWindow::release() ).
+    /// \tparam Tile The tile type
+    /// \param window The window
+    /// \param i The ordinal index of a non-zero tile
+    /// \return Tile \c i
+    /// \throw TiledArray::Exception When the window has been released
+    template <typename Tile>
+    Tile rma_fetch(const std::weak_ptr<RmaWindow<Tile> >& window,
+        const std::size_t i)
+    {
+      const std::shared_ptr<RmaWindow<Tile> > w = window.lock();
+      TA_USER_ASSERT(w, "The one-sided window of the array has been released.");
+      return w->fetch(i);
+    }
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_RMA_WINDOW_H__INCLUDED
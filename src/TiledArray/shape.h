@@ -22,6 +22,7 @@
 
 #include <TiledArray/sparse_shape.h>
 #include <TiledArray/dense_shape.h>
+#include <TiledArray/band_shape.h>
 
 namespace TiledArray {
 
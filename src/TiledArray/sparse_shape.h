@@ -26,14 +26,76 @@
 #ifndef TILEDARRAY_SPARSE_SHAPE_H__INCLUDED
 #define TILEDARRAY_SPARSE_SHAPE_H__INCLUDED
 
+#include <TiledArray/comm_stats.h>
 #include <TiledArray/tensor.h>
 #include <TiledArray/tiled_range.h>
 #include <TiledArray/val_array.h>
+#include <TiledArray/math/parallel_for.h>
+#include <TiledArray/math/screened_gemm.h>
 #include <TiledArray/tensor/shift_wrapper.h>
 #include <TiledArray/tensor/tensor_interface.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 namespace TiledArray {
+  namespace detail {
+
+    /// The block size of the coarse screening of sparse shape contractions
+
+    /// The block size is read from the \c TA_SPARSE_SHAPE_BLOCK_SIZE
+    /// environment variable. When it is zero, the default, shape
+    /// contractions are dense; see \c math::screened_gemm() .
+    /// \return The coarse block size, in tiles
+    inline integer sparse_shape_block_size() {
+      static const integer block_size = [] () -> integer {
+        const char* block_size = getenv("TA_SPARSE_SHAPE_BLOCK_SIZE");
+        if(block_size)
+          return std::strtol(block_size, nullptr, 10);
+        return 0;
+      }();
+      return block_size;
+    }
+
+    /// Sum of sparse norm vectors
+
+    /// The reduction operation of the sparse all-reduce of the tile norms of
+    /// \c SparseShape . The arguments and the result are sequences of
+    /// {ordinal,norm} pairs sorted by ordinal, and the norms of equal
+    /// ordinals are summed.
+    /// \tparam T The norm value type
+    template <typename T>
+    struct SparseNormSum {
+      typedef std::vector<std::pair<std::size_t, T> > result_type;
+
+      result_type operator()(const result_type& left, const result_type& right) const {
+        result_type result;
+        result.reserve(left.size() + right.size());
+        auto l = left.begin();
+        auto r = right.begin();
+        while((l != left.end()) && (r != right.end())) {
+          if(l->first < r->first) {
+            result.push_back(*l++);
+          } else if(r->first < l->first) {
+            result.push_back(*r++);
+          } else {
+            result.emplace_back(l->first, l->second + r->second);
+            ++l;
+            ++r;
+          }
+        }
+        result.insert(result.end(), l, left.end());
+        result.insert(result.end(), r, right.end());
+        return result;
+      }
+    }; // struct SparseNormSum
+
+    struct SparseNormSumTag { };
+
+  }  // namespace detail
 
   /// Arbitrary sparse shape
 
@@ -51,8 +113,13 @@ namespace TiledArray {
   /// \note Scaling operations, such as SparseShape<T>::scale , SparseShape<T>::gemm , etc.
   ///       accept generic scaling factors; internally (modulus of) the scaling factor is first
   ///       converted to T, then used (see SparseShape<T>::to_abs_factor).
+  template <typename T>
+  class CompactShape;
+
   template <typename T>
   class SparseShape {
+    template <typename> friend class CompactShape;
+
   public:
     typedef SparseShape<T> SparseShape_; ///< This object type
     typedef T value_type; ///< The norm value type
@@ -72,7 +139,10 @@ namespace TiledArray {
     Tensor<value_type> tile_norms_; ///< Tile magnitude data
     std::shared_ptr<vector_type> size_vectors_; ///< Tile size information; size_vectors_[d][i] reports the size of i-th tile in dimension d
     size_type zero_tile_count_; ///< Number of zero tiles
-    static value_type threshold_; ///< The zero threshold
+    value_type zero_threshold_; ///< The zero threshold of this shape
+    bool bounds_; ///< The norms are upper bounds, not computed norms
+    static value_type threshold_; ///< The default zero threshold
+    static value_type error_budget_; ///< The error budget of contractions
 
     template <typename Op>
     static vector_type
@@ -107,7 +177,7 @@ namespace TiledArray {
     /// tile. If the normalized norm is less than threshold, the value is set to
     /// zero.
     void normalize() {
-      const value_type threshold = threshold_;
+      const value_type threshold = zero_threshold_;
       const unsigned int dim = tile_norms_.range().rank();
       const vector_type* MADNESS_RESTRICT const size_vectors = size_vectors_.get();
       madness::AtomicInt zero_tile_count;
@@ -161,6 +231,110 @@ namespace TiledArray {
       zero_tile_count_ = zero_tile_count;
     }
 
+    /// Zero the norms that are below a threshold
+
+    /// The norms are thresholded by concurrent tasks for large shapes.
+    /// \param norms The norms to be thresholded
+    /// \param n The number of norms
+    /// \param threshold The zero threshold
+    /// \return The number of zero norms
+    static size_type apply_threshold(value_type* const norms, const size_type n,
+        const value_type threshold)
+    {
+      return math::parallel_count(0ul, n, math::parallel_grain_size(),
+          [=] (const std::size_t first, const std::size_t last) {
+            size_type count = 0ul;
+            for(std::size_t i = first; i < last; ++i) {
+              TA_ASSERT(norms[i] >= value_type(0));
+              if(norms[i] < threshold) {
+                norms[i] = value_type(0);
+                ++count;
+              }
+            }
+            return count;
+          });
+    }
+
+    /// Apply an operation to the rows of a block of the norms
+
+    /// The rows of the block are processed by concurrent tasks for large
+    /// shapes.
+    /// \tparam Op The row operation type
+    /// \param range The range of the block
+    /// \param op The row operation, <tt>op(i, j, n)</tt> , where \c i is the
+    /// ordinal of the first element of the row in the block, \c j is its
+    /// ordinal in the blocked tensor, and \c n is the length of the row,
+    /// which returns a count of the elements of the row
+    /// \return The sum of the counts of the rows
+    template <typename Op>
+    static size_type for_each_block_row(const BlockRange& range, const Op& op) {
+      const size_type n = range.extent_data()[range.rank() - 1u];
+      const size_type rows = range.volume() / n;
+      return math::parallel_count(0ul, rows,
+          std::max<std::size_t>(math::parallel_grain_size() / n, 1ul),
+          [&] (const std::size_t first, const std::size_t last) {
+            size_type count = 0ul;
+            for(std::size_t r = first; r < last; ++r)
+              count += op(r * n, range.ordinal(r * n), n);
+            return count;
+          });
+    }
+
+    /// Sum the tile norms of all processes
+
+    /// Only the non-zero norms of each process are communicated, as
+    /// {ordinal,norm} pairs, with an all-reduce that merges them; so the
+    /// communication scales with the number of non-zero tiles instead of
+    /// the number of tiles. When the non-zero norms are too many for the
+    /// pairs to be smaller than the norm tensor, the dense tensor is
+    /// summed instead. This function is collective.
+    /// \param world The world where the norms are summed
+    void sum_tile_norms(World& world) {
+      if(world.size() == 1)
+        return;
+
+      typedef detail::SparseNormSum<value_type> sum_op;
+      typedef typename sum_op::result_type sparse_type;
+      const size_type volume = tile_norms_.size();
+      const value_type* MADNESS_RESTRICT const norms = tile_norms_.data();
+
+      const bool stats = comm_stats_enabled();
+      const double begin = (stats ? detail::comm_stats_time() : 0.0);
+
+      sparse_type local;
+      for(size_type i = 0ul; i < volume; ++i)
+        if(norms[i] != value_type(0))
+          local.emplace_back(i, norms[i]);
+
+      size_type nonzeros = local.size();
+      world.gop.sum(nonzeros);
+      if((nonzeros * sizeof(typename sparse_type::value_type)) >=
+          (volume * sizeof(value_type)))
+      {
+        world.gop.sum(tile_norms_.data(), volume);
+        if(stats) {
+          detail::comm_stats_record(CommCategory::shape_reduce, 1ul, 0ul);
+          detail::comm_stats_record_latency(CommCategory::shape_reduce,
+              volume * sizeof(value_type), begin);
+        }
+        return;
+      }
+
+      if(stats)
+        detail::comm_stats_record(CommCategory::shape_reduce, 1ul,
+            local.size() * sizeof(typename sparse_type::value_type));
+
+      typedef madness::TaggedKey<madness::uniqueidT, detail::SparseNormSumTag> key_type;
+      const sparse_type global = world.gop.all_reduce(
+          key_type(world.unique_obj_id()), Future<sparse_type>(std::move(local)),
+          sum_op()).get();
+      std::fill_n(tile_norms_.data(), volume, value_type(0));
+      for(const auto& norm : global)
+        tile_norms_[norm.first] = norm.second;
+      if(stats)
+        detail::comm_stats_record_latency(CommCategory::shape_reduce, 0ul, begin);
+    }
+
     static std::shared_ptr<vector_type>
     initialize_size_vectors(const TiledRange& trange) {
       // Allocate memory for size vectors
@@ -197,9 +371,11 @@ namespace TiledArray {
     }
 
     SparseShape(const Tensor<T>& tile_norms, const std::shared_ptr<vector_type>& size_vectors,
-        const size_type zero_tile_count) :
+        const size_type zero_tile_count, const value_type zero_threshold,
+        const bool bounds) :
       tile_norms_(tile_norms), size_vectors_(size_vectors),
-      zero_tile_count_(zero_tile_count)
+      zero_tile_count_(zero_tile_count), zero_threshold_(zero_threshold),
+      bounds_(bounds)
     { }
 
   public:
@@ -207,7 +383,10 @@ namespace TiledArray {
     /// Default constructor
 
     /// Construct a shape with no data.
-    SparseShape() : tile_norms_(), size_vectors_(), zero_tile_count_(0ul) { }
+    SparseShape() :
+      tile_norms_(), size_vectors_(), zero_tile_count_(0ul),
+      zero_threshold_(threshold_), bounds_(false)
+    { }
 
     /// Constructor
 
@@ -216,9 +395,11 @@ namespace TiledArray {
     /// tile.
     /// \param tile_norms The Frobenius norm of tiles
     /// \param trange The tiled range of the tensor
-    SparseShape(const Tensor<value_type>& tile_norms, const TiledRange& trange) :
+    /// \param zero_threshold The zero threshold of this shape
+    SparseShape(const Tensor<value_type>& tile_norms, const TiledRange& trange,
+        const value_type zero_threshold = threshold_) :
       tile_norms_(tile_norms.clone()), size_vectors_(initialize_size_vectors(trange)),
-      zero_tile_count_(0ul)
+      zero_tile_count_(0ul), zero_threshold_(zero_threshold), bounds_(false)
     {
       TA_ASSERT(! tile_norms_.empty());
       TA_ASSERT(tile_norms_.range() == trange.tiles_range());
@@ -236,11 +417,14 @@ namespace TiledArray {
     ///         where \c index is a directly-addressable sequence indices.
     /// \param tile_norms The Frobenius norm of tiles
     /// \param trange The tiled range of the tensor
+    /// \param zero_threshold The zero threshold of this shape
     template<typename SparseNormSequence>
     SparseShape(const SparseNormSequence& tile_norms,
-                const TiledRange& trange) :
+                const TiledRange& trange,
+                const value_type zero_threshold = threshold_) :
       tile_norms_(trange.tiles_range(), value_type(0)), size_vectors_(initialize_size_vectors(trange)),
-      zero_tile_count_(trange.tiles_range().volume())
+      zero_tile_count_(trange.tiles_range().volume()),
+      zero_threshold_(zero_threshold), bounds_(false)
     {
       const auto dim = tile_norms_.range().rank();
       for(const auto& pair_idx_norm: tile_norms) {
@@ -251,7 +435,7 @@ namespace TiledArray {
           return tile_volume;
         };
         auto norm_per_element = pair_idx_norm.second / compute_tile_volume();
-        if (norm_per_element >= threshold()) {
+        if (norm_per_element >= zero_threshold_) {
           tile_norms_[pair_idx_norm.first] = norm_per_element;
           --zero_tile_count_;
         }
@@ -268,16 +452,18 @@ namespace TiledArray {
     /// \param world The world where the shape will live
     /// \param tile_norms The Frobenius norm of tiles
     /// \param trange The tiled range of the tensor
+    /// \param zero_threshold The zero threshold of this shape
     SparseShape(World& world, const Tensor<value_type>& tile_norms,
-                const TiledRange& trange) :
+                const TiledRange& trange,
+                const value_type zero_threshold = threshold_) :
       tile_norms_(tile_norms.clone()), size_vectors_(initialize_size_vectors(trange)),
-      zero_tile_count_(0ul)
+      zero_tile_count_(0ul), zero_threshold_(zero_threshold), bounds_(false)
     {
       TA_ASSERT(! tile_norms_.empty());
       TA_ASSERT(tile_norms_.range() == trange.tiles_range());
 
       // reduce norm data from all processors
-      world.gop.sum(tile_norms_.data(), tile_norms_.size());
+      sum_tile_norms(world);
 
       normalize();
     }
@@ -294,12 +480,38 @@ namespace TiledArray {
     /// \param world The world where the shape will live
     /// \param tile_norms The Frobenius norm of tiles
     /// \param trange The tiled range of the tensor
+    /// \param zero_threshold The zero threshold of this shape
     template<typename SparseNormSequence>
     SparseShape(World& world,
                 const SparseNormSequence& tile_norms,
-                const TiledRange& trange) : SparseShape(tile_norms, trange)
+                const TiledRange& trange,
+                const value_type zero_threshold = threshold_) :
+      SparseShape(tile_norms, trange, zero_threshold)
+    {
+      sum_tile_norms(world);
+      zero_tile_count_ = std::count(tile_norms_.data(),
+          tile_norms_.data() + tile_norms_.size(), value_type(0));
+    }
+
+    /// Construct a shape from upper bounds of the tile norms
+
+    /// The bounds are used in place of computed norms, e.g. Schwarz bounds
+    /// of integrals, so the tiles do not have to be read to make the shape.
+    /// The bounds are normalized as norms are, but they are not summed over
+    /// processes, so they must be equal on all processes. Since screening
+    /// only needs upper bounds of the norms, arrays with these shapes do not
+    /// need to be truncated, and \c truncate() , which computes the norms,
+    /// is optional (see \c is_bound() ).
+    /// \param tile_bounds Upper bounds of the Frobenius norms of the tiles
+    /// \param trange The tiled range of the tensor
+    /// \param zero_threshold The zero threshold of the shape
+    /// \return A shape that holds the normalized bounds
+    static SparseShape_ from_bounds(const Tensor<value_type>& tile_bounds,
+        const TiledRange& trange, const value_type zero_threshold = threshold_)
     {
-      world.gop.sum(tile_norms_.data(), tile_norms_.size());
+      SparseShape_ result(tile_bounds, trange, zero_threshold);
+      result.bounds_ = true;
+      return result;
     }
 
     /// Copy constructor
@@ -308,7 +520,8 @@ namespace TiledArray {
     /// \param other The other shape object to be copied
     SparseShape(const SparseShape<T>& other) :
       tile_norms_(other.tile_norms_), size_vectors_(other.size_vectors_),
-      zero_tile_count_(other.zero_tile_count_)
+      zero_tile_count_(other.zero_tile_count_),
+      zero_threshold_(other.zero_threshold_), bounds_(other.bounds_)
     { }
 
     /// Copy assignment operator
@@ -320,6 +533,8 @@ namespace TiledArray {
       tile_norms_ = other.tile_norms_;
       size_vectors_ = other.size_vectors_;
       zero_tile_count_ = other.zero_tile_count_;
+      zero_threshold_ = other.zero_threshold_;
+      bounds_ = other.bounds_;
       return *this;
     }
 
@@ -339,7 +554,7 @@ namespace TiledArray {
     template <typename Index>
     bool is_zero(const Index& i) const {
       TA_ASSERT(! tile_norms_.empty());
-      return tile_norms_[i] < threshold_;
+      return tile_norms_[i] < zero_threshold_;
     }
 
     /// Check density
@@ -355,16 +570,121 @@ namespace TiledArray {
       return float(zero_tile_count_) / float(tile_norms_.size());
     }
 
-    /// Threshold accessor
+    /// Frobenius norm of the tensor
+
+    /// The norm is computed from the tile norms held by this shape, without
+    /// reading tiles or communicating. It equals the norm of the tensor,
+    /// up to single precision rounding, if the tile norms were computed from
+    /// the tiles, e.g. by the constructors or by \c truncate() , and the
+    /// tiles were not modified since. Shapes that are computed from other
+    /// shapes, e.g. of sums and products, and shapes of bounds (see
+    /// \c is_bound() ) hold upper bounds of the tile norms, so their norm
+    /// is an upper bound of the norm of the tensor.
+    /// \return The square root of the sum of the squared tile norms
+    value_type norm() const {
+      TA_ASSERT(! tile_norms_.empty());
+      const unsigned int rank = tile_norms_.range().rank();
+      const vector_type* MADNESS_RESTRICT const size_vectors = size_vectors_.get();
+
+      // The index of the current tile in each dimension
+      std::vector<size_type> index(rank, 0ul);
+      double sum = 0.0;
+      for(size_type t = 0ul; t < tile_norms_.size(); ++t) {
+        if(tile_norms_[t] > value_type(0)) {
+          // The stored norms are per element
+          double tile_norm = tile_norms_[t];
+          for(unsigned int d = 0u; d < rank; ++d)
+            tile_norm *= size_vectors[d][index[d]];
+          sum += tile_norm * tile_norm;
+        }
+
+        for(unsigned int d = rank; d > 0u; --d) {
+          if(++index[d - 1u] < size_vectors[d - 1u].size())
+            break;
+          index[d - 1u] = 0ul;
+        }
+      }
+
+      return value_type(std::sqrt(sum));
+    }
 
-    /// \return The current threshold
+    /// Default threshold accessor
+
+    /// \return The zero threshold of shapes that are constructed without one
     static value_type threshold() { return threshold_; }
 
-    /// Set threshold to \c thresh
+    /// Set the default threshold to \c thresh
 
-    /// \param thresh The new threshold
+    /// Shapes that were constructed before the default threshold is changed
+    /// keep their threshold.
+    /// \param thresh The new default threshold
     static void threshold(const value_type thresh) { threshold_ = thresh; }
 
+    /// Error budget accessor
+
+    /// \return The error budget of contractions, or zero if it is not set
+    static value_type error_budget() { return error_budget_; }
+
+    /// Set the error budget of contractions
+
+    /// When the budget is set, the result tiles of \c gemm() are not
+    /// screened one by one against the zero threshold; instead, the tiles
+    /// are zeroed in increasing order of their estimated norm while the
+    /// Frobenius norm of all zeroed tiles of the result is at most
+    /// \c budget , so the error of the result is bounded no matter how many
+    /// tiles are neglected. Tiles below the zero threshold are always zero,
+    /// and their norm counts against the budget. Since the unscreened norms
+    /// are needed, the contractions of the shapes are not screened by
+    /// blocks while the budget is set.
+    /// \param budget The largest Frobenius norm of the neglected tiles of a
+    /// contraction; zero restores screening by the threshold
+    static void error_budget(const value_type budget) { error_budget_ = budget; }
+
+    /// Threshold accessor
+
+    /// Tiles whose normalized norms are less than the zero threshold of a
+    /// shape are zero tiles. Shapes that are computed from other shapes
+    /// inherit their threshold; the result of a binary operation takes the
+    /// smaller threshold of its arguments, so the more accurate argument is
+    /// not truncated further, and masking keeps the threshold of the masked
+    /// shape.
+    /// \return The zero threshold of this shape
+    value_type zero_threshold() const { return zero_threshold_; }
+
+    /// Change the threshold of this shape
+
+    /// The norms that are less than \c thresh are set to zero. Norms that
+    /// were zeroed by a larger threshold are not restored, so a smaller
+    /// threshold only affects shapes that are later computed from the
+    /// result.
+    /// \param thresh The new zero threshold
+    /// \return A copy of this shape with the threshold \c thresh
+    SparseShape_ with_threshold(const value_type thresh) const {
+      TA_ASSERT(! tile_norms_.empty());
+      madness::AtomicInt zero_tile_count;
+      zero_tile_count = 0;
+      auto op = [thresh, &zero_tile_count] (value_type value) {
+        if(value < thresh) {
+          value = value_type(0);
+          ++zero_tile_count;
+        }
+        return value;
+      };
+
+      Tensor<value_type> result_tile_norms = tile_norms_.unary(op);
+
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          thresh, bounds_);
+    }
+
+    /// Bound query
+
+    /// The shapes that are computed from bounds, with arithmetic on shapes,
+    /// are bounds too.
+    /// \return \c true if the norms of this shape are upper bounds, which
+    /// were not computed from the tiles (see \c from_bounds() )
+    bool is_bound() const { return bounds_; }
+
     /// Tile norm accessor
 
     /// \tparam Index The index type
@@ -389,23 +709,12 @@ namespace TiledArray {
     SparseShape_ transform(Op &&op) const { 
 
         Tensor<T> new_norms = op(tile_norms_);
-        madness::AtomicInt zero_tile_count;
-        zero_tile_count = 0;
-
-        const value_type threshold = threshold_;
-        auto apply_threshold = [threshold, &zero_tile_count](value_type &norm){
-            TA_ASSERT(norm >= value_type(0));
-            if(norm < threshold){
-                norm = value_type(0);
-                ++zero_tile_count;
-            }
-        };
-
-        math::inplace_vector_op(apply_threshold, new_norms.range().volume(), 
-                new_norms.data());
+        const value_type threshold = zero_threshold_;
+        const size_type zero_tile_count = apply_threshold(new_norms.data(),
+            new_norms.range().volume(), threshold);
 
-        return SparseShape_(std::move(new_norms), size_vectors_, 
-                            zero_tile_count); 
+        return SparseShape_(std::move(new_norms), size_vectors_,
+            zero_tile_count, threshold, bounds_);
     }
 
     /// Data accessor
@@ -427,24 +736,65 @@ namespace TiledArray {
       TA_ASSERT(!mask_shape.empty());
       TA_ASSERT(tile_norms_.range() == mask_shape.tile_norms_.range());
 
-      const value_type threshold = threshold_;
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = zero_tile_count_;
-      auto op = [threshold, &zero_tile_count] (value_type left,
-          const value_type right)
-      {
-        if(left >= threshold && right < threshold) {
-          left = value_type(0);
-          ++zero_tile_count;
-        }
+      const value_type threshold = zero_threshold_;
+      const value_type mask_threshold = mask_shape.zero_threshold_;
+      Tensor<value_type> result_tile_norms(tile_norms_.range());
+      value_type* const result = result_tile_norms.data();
+      const value_type* const left = tile_norms_.data();
+      const value_type* const right = mask_shape.tile_norms_.data();
+      const size_type zero_tile_count = zero_tile_count_ +
+          math::parallel_count(0ul, tile_norms_.size(), math::parallel_grain_size(),
+          [=] (const std::size_t first, const std::size_t last) {
+            size_type count = 0ul;
+            for(std::size_t i = first; i < last; ++i) {
+              if(left[i] >= threshold && right[i] < mask_threshold) {
+                result[i] = value_type(0);
+                ++count;
+              } else {
+                result[i] = left[i];
+              }
+            }
+            return count;
+          });
 
-        return left;
-      };
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_);
+    }
 
-      Tensor<value_type> result_tile_norms =
-          tile_norms_.binary(mask_shape.tile_norms_, op);
+    /// Mask the tiles of this shape
+
+    /// \tparam Block The bitset block type
+    /// \param tile_mask The tile mask, with one bit per tile in the ordinal
+    /// order of the tiles; tiles whose bits are cleared are zero in the
+    /// result
+    /// \return A shape that is masked by \c tile_mask
+    template <typename Block>
+    SparseShape_ mask(const detail::Bitset<Block>& tile_mask) const {
+      TA_ASSERT(!tile_norms_.empty());
+      TA_ASSERT(tile_mask.size() == tile_norms_.range().volume());
+
+      const value_type threshold = zero_threshold_;
+      Tensor<value_type> result_tile_norms(tile_norms_.range());
+      value_type* const result = result_tile_norms.data();
+      const value_type* const arg = tile_norms_.data();
+      const size_type zero_tile_count = zero_tile_count_ +
+          math::parallel_count(0ul, tile_norms_.size(), math::parallel_grain_size(),
+          [=, &tile_mask] (const std::size_t first, const std::size_t last) {
+            size_type count = 0ul;
+            for(std::size_t i = first; i < last; ++i) {
+              if(tile_mask[i]) {
+                result[i] = arg[i];
+              } else {
+                if(arg[i] >= threshold)
+                  ++count;
+                result[i] = value_type(0);
+              }
+            }
+            return count;
+          });
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_);
     }
 
     /// Update sub-block of shape
@@ -463,22 +813,38 @@ namespace TiledArray {
       Tensor<value_type> result_tile_norms = tile_norms_.clone();
 
       auto result_tile_norms_blk = result_tile_norms.block(lower_bound, upper_bound);
-      const value_type threshold = threshold_;
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = zero_tile_count_;
-      result_tile_norms_blk.inplace_binary(other.tile_norms_,
-          [threshold,&zero_tile_count] (value_type& l, const value_type r) {
-            // Update the zero tile count for the result
-            if((l < threshold) && (r >= threshold))
-              ++zero_tile_count;
-            else if((l >= threshold) && (r < threshold))
-              --zero_tile_count;
-
-            // Update the tile norm value
-            l = r;
+      TA_ASSERT(result_tile_norms_blk.range().volume() == other.tile_norms_.size());
+      const value_type threshold = zero_threshold_;
+      value_type* const result = result_tile_norms_blk.data();
+      const value_type* const arg = other.tile_norms_.data();
+
+      // Count the zero tiles that are replaced and those that replace them
+      const size_type removed_zero_tile_count =
+          for_each_block_row(result_tile_norms_blk.range(),
+          [=] (const size_type, const size_type j, const size_type n) {
+            size_type count = 0ul;
+            for(size_type x = 0ul; x < n; ++x)
+              if(result[j + x] < threshold)
+                ++count;
+            return count;
+          });
+      const size_type added_zero_tile_count =
+          for_each_block_row(result_tile_norms_blk.range(),
+          [=] (const size_type i, const size_type j, const size_type n) {
+            size_type count = 0ul;
+            for(size_type x = 0ul; x < n; ++x) {
+              const value_type norm = arg[i + x];
+              if(norm < threshold)
+                ++count;
+              result[j + x] = norm;
+            }
+            return count;
           });
+      const size_type zero_tile_count =
+          zero_tile_count_ + added_zero_tile_count - removed_zero_tile_count;
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
     }
 
   private:
@@ -531,26 +897,29 @@ namespace TiledArray {
       std::shared_ptr<vector_type> size_vectors =
           block_range(lower_bound, upper_bound);
 
-      // Copy the data from arg to result
-      const value_type threshold = threshold_;
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = 0;
-      auto copy_op = [threshold,&zero_tile_count] (value_type& MADNESS_RESTRICT result,
-          const value_type arg)
-      {
-        result = arg;
-        if(arg < threshold)
-          ++zero_tile_count;
-      };
-
-
       // Construct the result norms tensor
       TensorConstView<value_type> block_view =
           tile_norms_.block(lower_bound, upper_bound);
       Tensor<value_type> result_norms((Range(block_view.range().extent())));
-      result_norms.inplace_binary(shift(block_view), copy_op);
 
-      return SparseShape(result_norms, size_vectors, zero_tile_count);
+      // Copy the data from arg to result
+      const value_type threshold = zero_threshold_;
+      value_type* const result = result_norms.data();
+      const value_type* const arg = block_view.data();
+      const size_type zero_tile_count = for_each_block_row(block_view.range(),
+          [=] (const size_type i, const size_type j, const size_type n) {
+            size_type count = 0ul;
+            for(size_type x = 0ul; x < n; ++x) {
+              const value_type norm = arg[j + x];
+              if(norm < threshold)
+                ++count;
+              result[i + x] = norm;
+            }
+            return count;
+          });
+
+      return SparseShape(result_norms, size_vectors, zero_tile_count, threshold,
+          bounds_);
     }
 
 
@@ -569,27 +938,31 @@ namespace TiledArray {
       std::shared_ptr<vector_type> size_vectors =
           block_range(lower_bound, upper_bound);
 
-      // Copy the data from arg to result
-      const value_type threshold = threshold_;
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = 0;
-      auto copy_op = [abs_factor,threshold,&zero_tile_count] (value_type& MADNESS_RESTRICT result,
-              const value_type arg)
-      {
-        result = arg * abs_factor;
-        if(result < threshold) {
-          ++zero_tile_count;
-          result = value_type(0);
-        }
-      };
-
       // Construct the result norms tensor
       TensorConstView<value_type> block_view =
           tile_norms_.block(lower_bound, upper_bound);
       Tensor<value_type> result_norms((Range(block_view.range().extent())));
-      result_norms.inplace_binary(shift(block_view), copy_op);
 
-      return SparseShape(result_norms, size_vectors, zero_tile_count);
+      // Copy the scaled data from arg to result
+      const value_type threshold = zero_threshold_;
+      value_type* const result = result_norms.data();
+      const value_type* const arg = block_view.data();
+      const size_type zero_tile_count = for_each_block_row(block_view.range(),
+          [=] (const size_type i, const size_type j, const size_type n) {
+            size_type count = 0ul;
+            for(size_type x = 0ul; x < n; ++x) {
+              value_type norm = arg[j + x] * abs_factor;
+              if(norm < threshold) {
+                norm = value_type(0);
+                ++count;
+              }
+              result[i + x] = norm;
+            }
+            return count;
+          });
+
+      return SparseShape(result_norms, size_vectors, zero_tile_count, threshold,
+          bounds_);
     }
 
     /// Create a copy of a sub-block of the shape
@@ -623,7 +996,7 @@ namespace TiledArray {
     /// \return A new, permuted shape
     SparseShape_ perm(const Permutation& perm) const {
       return SparseShape_(tile_norms_.permute(perm), perm_size_vectors(perm),
-          zero_tile_count_);
+          zero_tile_count_, zero_threshold_, bounds_);
     }
 
     /// Scale shape
@@ -639,22 +1012,14 @@ namespace TiledArray {
     template <typename Factor>
     SparseShape_ scale(const Factor factor) const {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = zero_threshold_;
       const value_type abs_factor = to_abs_factor(factor);
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = 0;
-      auto op = [threshold, &zero_tile_count, abs_factor] (value_type value) {
-        value *= abs_factor;
-        if(value < threshold) {
-          value = value_type(0);
-          ++zero_tile_count;
-        }
-        return value;
-      };
-
-      Tensor<value_type> result_tile_norms = tile_norms_.unary(op);
+      Tensor<value_type> result_tile_norms = tile_norms_.scale(abs_factor);
+      const size_type zero_tile_count = apply_threshold(
+          result_tile_norms.data(), result_tile_norms.size(), threshold);
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_);
     }
 
     /// Scale and permute shape
@@ -671,23 +1036,14 @@ namespace TiledArray {
     template <typename Factor>
     SparseShape_ scale(const Factor factor, const Permutation& perm) const {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = zero_threshold_;
       const value_type abs_factor = to_abs_factor(factor);
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = 0;
-      auto op = [threshold, &zero_tile_count, abs_factor] (value_type value) {
-        value *= abs_factor;
-        if(value < threshold) {
-          value = value_type(0);
-          ++zero_tile_count;
-        }
-        return value;
-      };
-
-      Tensor<value_type> result_tile_norms = tile_norms_.unary(op, perm);
+      Tensor<value_type> result_tile_norms = tile_norms_.scale(abs_factor, perm);
+      const size_type zero_tile_count = apply_threshold(
+          result_tile_norms.data(), result_tile_norms.size(), threshold);
 
       return SparseShape_(result_tile_norms, perm_size_vectors(perm),
-          zero_tile_count);
+          zero_tile_count, threshold, bounds_);
     }
 
     /// Add shapes
@@ -700,7 +1056,7 @@ namespace TiledArray {
     /// \return A sum of shapes
     SparseShape_ add(const SparseShape_& other) const {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       madness::AtomicInt zero_tile_count;
       zero_tile_count = 0;
       auto op = [threshold, &zero_tile_count] (value_type left,
@@ -717,7 +1073,8 @@ namespace TiledArray {
       Tensor<value_type> result_tile_norms =
           tile_norms_.binary(other.tile_norms_, op);
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
     }
 
     /// Add and permute shapes
@@ -731,7 +1088,7 @@ namespace TiledArray {
     /// \return the new shape, equals \c this + \c other
     SparseShape_ add(const SparseShape_& other, const Permutation& perm) const {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       madness::AtomicInt zero_tile_count;
       zero_tile_count = 0;
       auto op = [threshold, &zero_tile_count] (value_type left,
@@ -749,7 +1106,7 @@ namespace TiledArray {
           tile_norms_.binary(other.tile_norms_, op, perm);
 
       return SparseShape_(result_tile_norms, perm_size_vectors(perm),
-          zero_tile_count);
+          zero_tile_count, threshold, bounds_ || other.bounds_);
     }
 
     /// Add and scale shapes
@@ -766,7 +1123,7 @@ namespace TiledArray {
     template <typename Factor>
     SparseShape_ add(const SparseShape_& other, const Factor factor) const {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       const value_type abs_factor = to_abs_factor(factor);
       madness::AtomicInt zero_tile_count;
       zero_tile_count = 0;
@@ -785,7 +1142,8 @@ namespace TiledArray {
       Tensor<value_type> result_tile_norms =
           tile_norms_.binary(other.tile_norms_, op);
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
     }
 
     /// Add, scale, and permute shapes
@@ -805,7 +1163,7 @@ namespace TiledArray {
         const Permutation& perm) const
     {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       const value_type abs_factor = to_abs_factor(factor);
       madness::AtomicInt zero_tile_count;
       zero_tile_count = 0;
@@ -825,12 +1183,12 @@ namespace TiledArray {
           tile_norms_.binary(other.tile_norms_, op, perm);
 
       return SparseShape_(result_tile_norms, perm_size_vectors(perm),
-          zero_tile_count);
+          zero_tile_count, threshold, bounds_ || other.bounds_);
     }
 
     SparseShape_ add(value_type value) const {
       TA_ASSERT(! tile_norms_.empty());
-      const value_type threshold = threshold_;
+      const value_type threshold = zero_threshold_;
       madness::AtomicInt zero_tile_count;
       zero_tile_count = 0;
 
@@ -885,7 +1243,8 @@ namespace TiledArray {
             });
       }
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_);
     }
 
     SparseShape_ add(const value_type value, const Permutation& perm) const {
@@ -925,10 +1284,10 @@ namespace TiledArray {
   private:
 
     static size_type scale_by_size(Tensor<T>& tile_norms,
-        const vector_type* MADNESS_RESTRICT const size_vectors)
+        const vector_type* MADNESS_RESTRICT const size_vectors,
+        const value_type threshold)
     {
       const unsigned int dim = tile_norms.range().rank();
-      const value_type threshold = threshold_;
       madness::AtomicInt zero_tile_count;
       zero_tile_count = 0;
 
@@ -973,6 +1332,57 @@ namespace TiledArray {
       return zero_tile_count;
     }
 
+    /// Zero the smallest tiles of a shape within an error budget
+
+    /// Tiles below the zero threshold are zeroed first. The other tiles are
+    /// then zeroed in increasing order of their norm, as long as the
+    /// Frobenius norm of all zeroed tiles does not exceed \c budget .
+    /// \param tile_norms The normalized tile norms
+    /// \param size_vectors The tile sizes of each dimension
+    /// \param threshold The zero threshold
+    /// \param budget The largest Frobenius norm of the zeroed tiles
+    /// \return The number of zero tiles
+    static size_type screen_by_budget(Tensor<T>& tile_norms,
+        const vector_type* MADNESS_RESTRICT const size_vectors,
+        const value_type threshold, const value_type budget)
+    {
+      // Compute the number of elements of each tile
+      const unsigned int dim = tile_norms.range().rank();
+      const vector_type volumes = recursive_outer_product(size_vectors, dim,
+          [] (const vector_type& size_vector) -> const vector_type&
+          { return size_vector; });
+
+      value_type* MADNESS_RESTRICT const norms = tile_norms.data();
+      const size_type n = tile_norms.size();
+      size_type zero_tile_count = 0ul;
+      double error = 0.0;
+      std::vector<std::pair<double, size_type> > candidates;
+      for(size_type i = 0ul; i < n; ++i) {
+        const double norm = double(norms[i]) * double(volumes[i]);
+        if(norms[i] < threshold) {
+          error += norm * norm;
+          norms[i] = value_type(0);
+          ++zero_tile_count;
+        } else {
+          candidates.emplace_back(norm, i);
+        }
+      }
+
+      // The order of equal norms is fixed by the index, so all processes
+      // zero the same tiles
+      std::sort(candidates.begin(), candidates.end());
+      const double limit = double(budget) * double(budget);
+      for(const auto& candidate : candidates) {
+        error += candidate.first * candidate.first;
+        if(error > limit)
+          break;
+        norms[candidate.second] = value_type(0);
+        ++zero_tile_count;
+      }
+
+      return zero_tile_count;
+    }
+
   public:
 
     SparseShape_ mult(const SparseShape_& other) const {
@@ -980,11 +1390,13 @@ namespace TiledArray {
       // scale_by_size operations are performed in one step instead of two.
 
       TA_ASSERT(! tile_norms_.empty());
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       Tensor<T> result_tile_norms = tile_norms_.mult(other.tile_norms_);
       const size_type zero_tile_count =
-          scale_by_size(result_tile_norms, size_vectors_.get());
+          scale_by_size(result_tile_norms, size_vectors_.get(), threshold);
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
     }
 
     SparseShape_ mult(const SparseShape_& other, const Permutation& perm) const {
@@ -992,12 +1404,14 @@ namespace TiledArray {
       // scale_by_size operations are performed in one step instead of two.
 
       TA_ASSERT(! tile_norms_.empty());
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       Tensor<T> result_tile_norms = tile_norms_.mult(other.tile_norms_, perm);
       std::shared_ptr<vector_type> result_size_vector = perm_size_vectors(perm);
       const size_type zero_tile_count =
-                scale_by_size(result_tile_norms, result_size_vector.get());
+                scale_by_size(result_tile_norms, result_size_vector.get(), threshold);
 
-      return SparseShape_(result_tile_norms, result_size_vector, zero_tile_count);
+      return SparseShape_(result_tile_norms, result_size_vector,
+          zero_tile_count, threshold, bounds_ || other.bounds_);
     }
 
     /// \tparam Factor The scaling factor type
@@ -1008,12 +1422,14 @@ namespace TiledArray {
       // scale_by_size operations are performed in one step instead of two.
 
       TA_ASSERT(! tile_norms_.empty());
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       const value_type abs_factor = to_abs_factor(factor);
       Tensor<T> result_tile_norms = tile_norms_.mult(other.tile_norms_, abs_factor);
       const size_type zero_tile_count =
-          scale_by_size(result_tile_norms, size_vectors_.get());
+          scale_by_size(result_tile_norms, size_vectors_.get(), threshold);
 
-      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count);
+      return SparseShape_(result_tile_norms, size_vectors_, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
     }
 
     /// \tparam Factor The scaling factor type
@@ -1026,13 +1442,15 @@ namespace TiledArray {
       // scale_by_size operations are performed in one step instead of two.
 
       TA_ASSERT(! tile_norms_.empty());
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
       const value_type abs_factor = to_abs_factor(factor);
       Tensor<T> result_tile_norms = tile_norms_.mult(other.tile_norms_, abs_factor, perm);
       std::shared_ptr<vector_type> result_size_vector = perm_size_vectors(perm);
       const size_type zero_tile_count =
-          scale_by_size(result_tile_norms, result_size_vector.get());
+          scale_by_size(result_tile_norms, result_size_vector.get(), threshold);
 
-      return SparseShape_(result_tile_norms, result_size_vector, zero_tile_count);
+      return SparseShape_(result_tile_norms, result_size_vector,
+          zero_tile_count, threshold, bounds_ || other.bounds_);
     }
 
     /// \tparam Factor The scaling factor type
@@ -1044,22 +1462,18 @@ namespace TiledArray {
       TA_ASSERT(! tile_norms_.empty());
 
       const value_type abs_factor = to_abs_factor(factor);
-      const value_type threshold = threshold_;
-      madness::AtomicInt zero_tile_count;
-      zero_tile_count = 0;
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
+      // Tiles are screened by the error budget, instead of the threshold,
+      // when it is set
+      const value_type budget = error_budget_;
+      const value_type screen = (budget > value_type(0) ? value_type(0) : threshold);
+      size_type zero_tile_count = 0ul;
       integer M = 0, N = 0, K = 0;
       gemm_helper.compute_matrix_sizes(M, N, K, tile_norms_.range(), other.tile_norms_.range());
 
-      // Allocate memory for the contracted size vectors
-      std::shared_ptr<vector_type> result_size_vectors(new vector_type[gemm_helper.result_rank()],
-          std::default_delete<vector_type[]>());
-
-      // Initialize the result size vectors
-      unsigned int x = 0ul;
-      for(unsigned int i = gemm_helper.left_outer_begin(); i < gemm_helper.left_outer_end(); ++i, ++x)
-        result_size_vectors.get()[x] = size_vectors_.get()[i];
-      for(unsigned int i = gemm_helper.right_outer_begin(); i < gemm_helper.right_outer_end(); ++i, ++x)
-        result_size_vectors.get()[x] = other.size_vectors_.get()[i];
+      // The result size vectors
+      std::shared_ptr<vector_type> result_size_vectors =
+          gemm_size_vectors(other, gemm_helper);
 
       // Compute the number of inner ranks
       const unsigned int k_rank = gemm_helper.left_inner_end() - gemm_helper.left_inner_begin();
@@ -1079,49 +1493,84 @@ namespace TiledArray {
         // TODO: Make this faster. It can be done without using temporaries
         // for the arguments, but requires a custom matrix multiply.
 
+        // Scale the rows of the arguments by the sizes of the inner tiles
         Tensor<value_type> left(tile_norms_.range());
-        const size_type mk = M * K;
-        auto left_op = [] (const value_type left, const value_type right)
-            { return left * right; };
-        for(size_type i = 0ul; i < mk; i += K)
-          math::vector_op(left_op, K, left.data() + i,
-              tile_norms_.data() + i, k_sizes.data());
+        {
+          value_type* const result = left.data();
+          const value_type* const arg = tile_norms_.data();
+          const value_type* const sizes = k_sizes.data();
+          math::parallel_for(0ul, M,
+              std::max<std::size_t>(math::parallel_grain_size() / K, 1ul),
+              [=] (const std::size_t first, const std::size_t last) {
+                for(std::size_t i = first * K; i < last * K; i += K)
+                  for(integer k = 0; k < K; ++k)
+                    result[i + k] = arg[i + k] * sizes[k];
+              });
+        }
 
         Tensor<value_type> right(other.tile_norms_.range());
-        for(integer i = 0ul, k = 0; k < K; i += N, ++k) {
-          const value_type factor = k_sizes[k];
-          auto right_op = [=] (const value_type arg) { return arg * factor; };
-          math::vector_op(right_op, N, right.data() + i, other.tile_norms_.data() + i);
+        {
+          value_type* const result = right.data();
+          const value_type* const arg = other.tile_norms_.data();
+          const value_type* const sizes = k_sizes.data();
+          math::parallel_for(0ul, K,
+              std::max<std::size_t>(math::parallel_grain_size() / N, 1ul),
+              [=] (const std::size_t first, const std::size_t last) {
+                for(std::size_t k = first; k < last; ++k) {
+                  const value_type factor = sizes[k];
+                  for(integer j = 0; j < N; ++j)
+                    result[k * N + j] = arg[k * N + j] * factor;
+                }
+              });
         }
 
-        result_norms = left.gemm(right, abs_factor, gemm_helper);
+        // Screen the contraction with coarse block norms, so that large,
+        // sparse shapes are contracted in time proportional to the number
+        // of non-zero blocks
+        const integer block_size = detail::sparse_shape_block_size();
+        if((block_size > 0) && (M > block_size || N > block_size) &&
+            (gemm_helper.left_op() == madness::cblas::NoTrans) &&
+            (gemm_helper.right_op() == madness::cblas::NoTrans))
+          math::screened_gemm(M, N, K, abs_factor, left.data(), right.data(),
+              screen, block_size, result_norms.data());
+        else
+          result_norms = left.gemm(right, abs_factor, gemm_helper);
 
         // Hard zero tiles that are below the zero threshold.
-        result_norms.inplace_unary(
-            [threshold, &zero_tile_count] (value_type& value) {
-              if(value < threshold) {
-                value = value_type(0);
-                ++zero_tile_count;
-              }
-            });
+        zero_tile_count = apply_threshold(result_norms.data(),
+            result_norms.size(), screen);
 
       } else {
 
         // This is an outer product, so the inputs can be used directly
-        math::outer_fill(M, N, tile_norms_.data(), other.tile_norms_.data(), result_norms.data(),
-            [threshold, &zero_tile_count, abs_factor] (const value_type left,
-                const value_type right)
-            {
-              value_type norm = left * right * abs_factor;
-              if(norm < threshold) {
-                norm = value_type(0);
-                ++zero_tile_count;
+        value_type* const result = result_norms.data();
+        const value_type* const left = tile_norms_.data();
+        const value_type* const right = other.tile_norms_.data();
+        zero_tile_count = math::parallel_count(0ul, M,
+            std::max<std::size_t>(math::parallel_grain_size() / N, 1ul),
+            [=] (const std::size_t first, const std::size_t last) {
+              size_type count = 0ul;
+              for(std::size_t i = first; i < last; ++i) {
+                const value_type left_i = left[i] * abs_factor;
+                for(integer j = 0; j < N; ++j) {
+                  value_type norm = left_i * right[j];
+                  if(norm < screen) {
+                    norm = value_type(0);
+                    ++count;
+                  }
+                  result[i * N + j] = norm;
+                }
               }
-              return norm;
+              return count;
             });
       }
 
-      return SparseShape_(result_norms, result_size_vectors, zero_tile_count);
+      if(budget > value_type(0))
+        zero_tile_count = screen_by_budget(result_norms,
+            result_size_vectors.get(), threshold, budget);
+
+      return SparseShape_(result_norms, result_size_vectors, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
     }
 
     /// \tparam Factor The scaling factor type
@@ -1133,7 +1582,235 @@ namespace TiledArray {
       return gemm(other, factor, gemm_helper).perm(perm);
     }
 
+    /// Contract only the result tiles of a mask
+
+    /// The result is equal to <tt>gemm(other, factor, gemm_helper).mask(tile_mask)</tt> ,
+    /// but when few result tiles are selected by \c tile_mask , only the
+    /// norms of the selected tiles are computed, in time proportional to the
+    /// number of selected tiles.
+    /// \tparam Factor The scaling factor type
+    /// \tparam Block The bitset block type
+    /// \param tile_mask The result tile mask, with one bit per tile in the
+    /// ordinal order of the result tiles; tiles whose bits are cleared are
+    /// zero in the result
+    /// \note expression abs(Factor) must be well defined (by default, std::abs will be used)
+    template <typename Factor, typename Block>
+    SparseShape_ gemm(const SparseShape_& other, const Factor factor,
+        const math::GemmHelper& gemm_helper,
+        const detail::Bitset<Block>& tile_mask) const
+    {
+      TA_ASSERT(! tile_norms_.empty());
+
+      integer M = 0, N = 0, K = 0;
+      gemm_helper.compute_matrix_sizes(M, N, K, tile_norms_.range(), other.tile_norms_.range());
+      TA_ASSERT(tile_mask.size() == std::size_t(M * N));
+      const unsigned int k_rank = gemm_helper.left_inner_end() - gemm_helper.left_inner_begin();
+
+      // Dense masks and outer products are not worth a separate pass
+      const size_type selected = tile_mask.count();
+      if((k_rank == 0u) || (selected * 4ul > size_type(M * N)) ||
+          (gemm_helper.left_op() != madness::cblas::NoTrans) ||
+          (gemm_helper.right_op() != madness::cblas::NoTrans))
+        return gemm(other, factor, gemm_helper).mask(tile_mask);
+
+      const value_type abs_factor = to_abs_factor(factor);
+      const value_type threshold = std::min(zero_threshold_, other.zero_threshold_);
+      const value_type budget = error_budget_;
+      const value_type screen = (budget > value_type(0) ? value_type(0) : threshold);
+
+      std::shared_ptr<vector_type> result_size_vectors =
+          gemm_size_vectors(other, gemm_helper);
+
+      const vector_type k_sizes =
+          recursive_outer_product(size_vectors_.get() + gemm_helper.left_inner_begin(),
+              k_rank, [] (const vector_type& size_vector) -> const vector_type&
+              { return size_vector; });
+
+      // Transpose the right-hand norms, scaled by the squared sizes of the
+      // inner tiles, so that each result norm is a contiguous dot product
+      std::vector<value_type> right(N * K);
+      {
+        const value_type* const arg = other.tile_norms_.data();
+        const value_type* const sizes = k_sizes.data();
+        for(integer k = 0; k < K; ++k) {
+          const value_type size2 = sizes[k] * sizes[k] * abs_factor;
+          for(integer j = 0; j < N; ++j)
+            right[j * K + k] = arg[k * N + j] * size2;
+        }
+      }
+
+      Tensor<value_type> result_norms(gemm_helper.make_result_range<typename Tensor<T>::range_type>(
+          tile_norms_.range(), other.tile_norms_.range()), 0);
+      value_type* const result = result_norms.data();
+      const value_type* const left = tile_norms_.data();
+      const value_type* const right_t = right.data();
+      const size_type non_zero = math::parallel_count(0ul, M,
+          std::max<std::size_t>(math::parallel_grain_size() / (N * K), 1ul),
+          [=, &tile_mask] (const std::size_t first, const std::size_t last) {
+            size_type count = 0ul;
+            for(std::size_t i = first; i < last; ++i) {
+              const value_type* const left_i = left + i * K;
+              for(integer j = 0; j < N; ++j) {
+                if(! tile_mask[i * N + j])
+                  continue;
+                const value_type* const right_j = right_t + j * K;
+                value_type norm = 0;
+                for(integer k = 0; k < K; ++k)
+                  norm += left_i[k] * right_j[k];
+                if(norm < screen)
+                  continue;
+                result[i * N + j] = norm;
+                ++count;
+              }
+            }
+            return count;
+          });
+
+      size_type zero_tile_count = size_type(M * N) - non_zero;
+      if(budget > value_type(0))
+        zero_tile_count = screen_by_budget(result_norms,
+            result_size_vectors.get(), threshold, budget);
+
+      return SparseShape_(result_norms, result_size_vectors, zero_tile_count,
+          threshold, bounds_ || other.bounds_);
+    }
+
+    /// Contract only the result tiles of a mask, and permute the result
+
+    /// \tparam Factor The scaling factor type
+    /// \tparam Block The bitset block type
+    /// \param tile_mask The result tile mask, with one bit per tile in the
+    /// ordinal order of the permuted result tiles
+    /// \note expression abs(Factor) must be well defined (by default, std::abs will be used)
+    template <typename Factor, typename Block>
+    SparseShape_ gemm(const SparseShape_& other, const Factor factor,
+        const math::GemmHelper& gemm_helper, const Permutation& perm,
+        const detail::Bitset<Block>& tile_mask) const
+    {
+      // Map the mask to the ordinal order of the unpermuted result
+      const typename Tensor<T>::range_type range =
+          gemm_helper.make_result_range<typename Tensor<T>::range_type>(
+          tile_norms_.range(), other.tile_norms_.range());
+      const typename Tensor<T>::range_type perm_range = perm * range;
+      detail::Bitset<Block> result_mask(range.volume());
+      for(const auto& index : range)
+        if(tile_mask[perm_range.ordinal(perm * index)])
+          result_mask.set(range.ordinal(index));
+
+      return gemm(other, factor, gemm_helper, result_mask).perm(perm);
+    }
+
+    /// Sum shape over dimensions
+
+    /// Construct the shape of the sum of a tensor over some of its
+    /// dimensions, e.g. \f$ R_i = \sum_j A_{ij} \f$ . The norm of each
+    /// result tile is bounded by
+    /// \f[
+    /// \|R_{i}\| \le \sum_j \sqrt{N_j} \|A_{ij}\|
+    /// \f]
+    /// where \f$N_j\f$ is the number of elements of tile \f$j\f$ in the
+    /// summed dimensions.
+    /// \param dims The summed dimensions, in increasing order
+    /// \return The shape of the sum, where the dimensions of this shape that
+    /// are not summed are kept in order
+    SparseShape_ sum_over(const std::vector<unsigned int>& dims) const {
+      TA_ASSERT(! tile_norms_.empty());
+      const unsigned int rank = tile_norms_.range().rank();
+      TA_ASSERT(dims.size() < rank);
+      const value_type threshold = zero_threshold_;
+
+      std::vector<bool> summed(rank, false);
+      for(const unsigned int d : dims) {
+        TA_ASSERT(d < rank);
+        summed[d] = true;
+      }
+
+      // Initialize the result size vectors and tile range
+      const unsigned int result_rank = rank - dims.size();
+      std::shared_ptr<vector_type> result_size_vectors(new vector_type[result_rank],
+          std::default_delete<vector_type[]>());
+      const size_type* MADNESS_RESTRICT const extent =
+          tile_norms_.range().extent_data();
+      std::vector<size_type> result_extent;
+      result_extent.reserve(result_rank);
+      for(unsigned int d = 0u, x = 0u; d < rank; ++d) {
+        if(! summed[d]) {
+          result_size_vectors.get()[x++] = size_vectors_.get()[d];
+          result_extent.push_back(extent[d]);
+        }
+      }
+      Tensor<value_type> result_norms(Range(result_extent), value_type(0));
+
+      // Compute the result weights of the dimensions of this shape
+      std::vector<size_type> weight(rank, 0ul);
+      size_type w = 1ul;
+      for(unsigned int d = rank; d > 0u; ) {
+        --d;
+        if(! summed[d]) {
+          weight[d] = w;
+          w *= extent[d];
+        }
+      }
+
+      // Accumulate the norm bounds of the summed tiles
+      std::vector<size_type> index(rank, 0ul);
+      const size_type volume = tile_norms_.range().volume();
+      for(size_type i = 0ul; i < volume; ++i) {
+        size_type r = 0ul;
+        value_type n = 1;
+        for(unsigned int d = 0u; d < rank; ++d) {
+          if(summed[d])
+            n *= size_vectors_.get()[d][index[d]];
+          else
+            r += weight[d] * index[d];
+        }
+        result_norms[r] += tile_norms_[i] * n * std::sqrt(n);
+
+        for(unsigned int d = rank; d > 0u; ) {
+          --d;
+          if(++index[d] < extent[d])
+            break;
+          index[d] = 0ul;
+        }
+      }
+
+      // Hard zero tiles that are below the zero threshold.
+      madness::AtomicInt zero_tile_count;
+      zero_tile_count = 0;
+      result_norms.inplace_unary(
+          [threshold, &zero_tile_count] (value_type& value) {
+            if(value < threshold) {
+              value = value_type(0);
+              ++zero_tile_count;
+            }
+          });
+
+      return SparseShape_(result_norms, result_size_vectors, zero_tile_count,
+          threshold, bounds_);
+    }
+
   private:
+    /// The size vectors of a contraction result
+
+    /// \param other The right-hand argument shape
+    /// \param gemm_helper The contraction helper
+    /// \return The size vectors of the outer dimensions of this shape and
+    /// \c other
+    std::shared_ptr<vector_type> gemm_size_vectors(const SparseShape_& other,
+        const math::GemmHelper& gemm_helper) const
+    {
+      std::shared_ptr<vector_type> result_size_vectors(new vector_type[gemm_helper.result_rank()],
+          std::default_delete<vector_type[]>());
+
+      unsigned int x = 0ul;
+      for(unsigned int i = gemm_helper.left_outer_begin(); i < gemm_helper.left_outer_end(); ++i, ++x)
+        result_size_vectors.get()[x] = size_vectors_.get()[i];
+      for(unsigned int i = gemm_helper.right_outer_begin(); i < gemm_helper.right_outer_end(); ++i, ++x)
+        result_size_vectors.get()[x] = other.size_vectors_.get()[i];
+
+      return result_size_vectors;
+    }
+
     template <typename Factor>
     static value_type to_abs_factor(const Factor factor) {
       using std::abs;
@@ -1145,6 +1822,8 @@ namespace TiledArray {
   // Static member initialization
   template <typename T>
   typename SparseShape<T>::value_type SparseShape<T>::threshold_ = std::numeric_limits<T>::epsilon();
+  template <typename T>
+  typename SparseShape<T>::value_type SparseShape<T>::error_budget_ = 0;
 
   /// Add the shape to an output stream
 
@@ -1159,6 +1838,30 @@ namespace TiledArray {
     return os;
   }
 
+  namespace detail {
+
+    /// Compare the tile norms of two shapes
+
+    /// \tparam T The numeric type of the shapes
+    /// \param left The left-hand shape
+    /// \param right The right-hand shape
+    /// \return \c true if \c left and \c right have the same zero threshold
+    /// and the same tile norms
+    template <typename T>
+    inline bool is_same_shape(const SparseShape<T>& left, const SparseShape<T>& right) {
+      const Tensor<T>& left_norms = left.data();
+      const Tensor<T>& right_norms = right.data();
+      if(left.zero_threshold() != right.zero_threshold())
+        return false;
+      if(left_norms.data() == right_norms.data())
+        return true;
+      return (left_norms.range() == right_norms.range()) &&
+          std::equal(left_norms.data(), left_norms.data() + left_norms.size(),
+              right_norms.data());
+    }
+
+  } // namespace detail
+
 
 #ifndef TILEDARRAY_HEADER_ONLY
 
@@ -0,0 +1,812 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_tile.h
+ *  May 22, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SPARSE_TILE_H__INCLUDED
+#define TILEDARRAY_SPARSE_TILE_H__INCLUDED
+
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/memory_usage.h>
+#include <TiledArray/tensor.h>
+#include <TiledArray/tensor/complex.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The default fill fraction of compressed sparse tiles
+
+    /// Tiles whose fraction of non-zero elements does not exceed the fill
+    /// fraction are stored in compressed form. The fill fraction is read
+    /// from the \c TA_SPARSE_TILE_FILL environment variable; the default
+    /// fill fraction is 0.25.
+    /// \return The default fill fraction
+    inline double sparse_tile_fill() {
+      static const double fill = [] () -> double {
+        const char* fill = getenv("TA_SPARSE_TILE_FILL");
+        if(fill)
+          return std::strtod(fill, nullptr);
+        return 0.25;
+      }();
+      return fill;
+    }
+
+  }  // namespace detail
+
+  /// A tile that stores only its non-zero elements
+
+  /// The non-zero elements are stored as a list of element ordinals, in
+  /// increasing order, and their values. Since the ordinals are row-major,
+  /// the list is the compressed sparse row form of the tile for any split
+  /// of its dimensions into rows and columns, which is the form that is used
+  /// by contractions. A tile is stored in compressed form only while the
+  /// fraction of its elements that are non-zero does not exceed its fill
+  /// fraction; otherwise it is stored as a dense tensor. The form is chosen
+  /// again for the result of every operation, so each tile is stored in the
+  /// cheaper form, and the memory and flops of the arithmetic of the tile
+  /// interface track the element sparsity of the data. Contractions of
+  /// compressed tiles accumulate into a dense buffer, row by row, with
+  /// sparse-dense or sparse-sparse (Gustavson) kernels.
+  /// Copies are shallow; see \c clone() for deep copies.
+  /// \tparam T The element type
+  template <typename T>
+  class SparseTile {
+  public:
+    typedef SparseTile<T> SparseTile_; ///< This object type
+    typedef Range range_type; ///< Tensor range type
+    typedef T value_type; ///< Element type
+    typedef T numeric_type; ///< The scalar type that is compatible with value_type
+    typedef std::size_t size_type; ///< Size type
+    typedef Tensor<T> dense_type; ///< Dense tensor type
+
+  private:
+
+    /// The tile data
+    struct Impl {
+      range_type range_; ///< The tile range
+      dense_type dense_; ///< The elements, when the tile is dense
+      std::vector<size_type> index_; ///< The ordinals of the non-zero elements, when the tile is compressed
+      std::vector<T> value_; ///< The non-zero elements, when the tile is compressed
+      double fill_; ///< The fill fraction
+    }; // struct Impl
+
+    std::shared_ptr<Impl> pimpl_; ///< The tile data
+
+    /// Construct a tile from its data
+    explicit SparseTile(std::shared_ptr<Impl> pimpl) : pimpl_(std::move(pimpl)) { }
+
+    /// Construct a tile from a dense tensor
+
+    /// The tensor is compressed when its fill does not exceed \c fill .
+    /// \param dense The elements of the tile
+    /// \param fill The fill fraction of the tile
+    static SparseTile_ make(dense_type dense, const double fill) {
+      const size_type volume = dense.size();
+      const T* MADNESS_RESTRICT const data = dense.data();
+      size_type nnz = 0ul;
+      for(size_type i = 0ul; i < volume; ++i)
+        nnz += (data[i] != T(0));
+      if(double(nnz) > fill * double(volume))
+        return SparseTile_(std::make_shared<Impl>(Impl{ dense.range(),
+            std::move(dense), std::vector<size_type>(), std::vector<T>(), fill }));
+
+      std::vector<size_type> index;
+      std::vector<T> value;
+      index.reserve(nnz);
+      value.reserve(nnz);
+      for(size_type i = 0ul; i < volume; ++i) {
+        if(data[i] != T(0)) {
+          index.push_back(i);
+          value.push_back(data[i]);
+        }
+      }
+      return SparseTile_(std::make_shared<Impl>(Impl{ dense.range(),
+          dense_type(), std::move(index), std::move(value), fill }));
+    }
+
+    /// Construct a tile from its non-zero elements
+
+    /// The elements are expanded to a dense tensor when their fill exceeds
+    /// \c fill .
+    /// \param range The range of the tile
+    /// \param index The ordinals of the elements, in increasing order
+    /// \param value The elements
+    /// \param fill The fill fraction of the tile
+    static SparseTile_ make(const range_type& range, std::vector<size_type> index,
+        std::vector<T> value, const double fill)
+    {
+      TA_ASSERT(index.size() == value.size());
+      if(double(index.size()) > fill * double(range.volume())) {
+        dense_type dense(range, T(0));
+        for(size_type i = 0ul; i < index.size(); ++i)
+          dense[index[i]] = value[i];
+        return SparseTile_(std::make_shared<Impl>(Impl{ range, std::move(dense),
+            std::vector<size_type>(), std::vector<T>(), fill }));
+      }
+      return SparseTile_(std::make_shared<Impl>(Impl{ range, dense_type(),
+          std::move(index), std::move(value), fill }));
+    }
+
+    /// Element-wise combination of this tile and \c right
+
+    /// \tparam Op The element operation type
+    /// \param right The right-hand argument
+    /// \param op The element operation, <tt>op(left, right)</tt> , which
+    /// maps two zeros to zero
+    /// \return The tile of <tt>op(left, right)</tt> for all elements
+    template <typename Op>
+    SparseTile_ merge(const SparseTile_& right, const Op& op) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(pimpl_->range_ == right.pimpl_->range_);
+
+      if(! (is_sparse() && right.is_sparse()))
+        return make(dense_type(dense(), right.dense(),
+            [&op] (const T l, const T r) { return op(l, r); }), pimpl_->fill_);
+
+      // Merge the element lists
+      const std::vector<size_type>& li = pimpl_->index_;
+      const std::vector<size_type>& ri = right.pimpl_->index_;
+      const std::vector<T>& lv = pimpl_->value_;
+      const std::vector<T>& rv = right.pimpl_->value_;
+      std::vector<size_type> index;
+      std::vector<T> value;
+      index.reserve(li.size() + ri.size());
+      value.reserve(li.size() + ri.size());
+      size_type l = 0ul, r = 0ul;
+      while((l < li.size()) || (r < ri.size())) {
+        size_type i;
+        T x;
+        if((r == ri.size()) || ((l < li.size()) && (li[l] < ri[r]))) {
+          i = li[l];
+          x = op(lv[l++], T(0));
+        } else if((l == li.size()) || (ri[r] < li[l])) {
+          i = ri[r];
+          x = op(T(0), rv[r++]);
+        } else {
+          i = li[l];
+          x = op(lv[l++], rv[r++]);
+        }
+        if(x != T(0)) {
+          index.push_back(i);
+          value.push_back(x);
+        }
+      }
+      return make(pimpl_->range_, std::move(index), std::move(value),
+          pimpl_->fill_);
+    }
+
+    /// The non-zero elements of a contraction argument, as matrix triplets
+
+    /// \param op The operation that is applied to the argument
+    /// \param rows The number of rows of the argument before \c op
+    /// \param cols The number of columns of the argument before \c op
+    /// \param[out] row The row of each element after \c op
+    /// \param[out] col The column of each element after \c op
+    /// \param[out] value The value of each element after \c op
+    void gemm_triplets(const madness::cblas::CBLAS_TRANSPOSE op,
+        const size_type rows, const size_type cols, std::vector<size_type>& row,
+        std::vector<size_type>& col, std::vector<T>& value) const
+    {
+      TA_ASSERT(is_sparse());
+      (void) rows;
+      const size_type nnz = pimpl_->index_.size();
+      row.resize(nnz);
+      col.resize(nnz);
+      value = pimpl_->value_;
+      for(size_type e = 0ul; e < nnz; ++e) {
+        const size_type o = pimpl_->index_[e];
+        if(op == madness::cblas::NoTrans) {
+          row[e] = o / cols;
+          col[e] = o % cols;
+        } else {
+          row[e] = o % cols;
+          col[e] = o / cols;
+        }
+      }
+      if(op == madness::cblas::ConjTrans)
+        for(T& x : value)
+          x = detail::conj(x);
+    }
+
+    /// Compressed rows of a contraction argument
+
+    /// \param op The operation that is applied to the argument
+    /// \param rows The number of rows of the argument after \c op
+    /// \param cols The number of columns of the argument after \c op
+    /// \param[out] start The first element of each row, and the number of
+    /// elements
+    /// \param[out] col The column of each element
+    /// \param[out] value The value of each element
+    void gemm_rows(const madness::cblas::CBLAS_TRANSPOSE op, const size_type rows,
+        const size_type cols, std::vector<size_type>& start,
+        std::vector<size_type>& col, std::vector<T>& value) const
+    {
+      std::vector<size_type> row;
+      std::vector<size_type> c;
+      std::vector<T> v;
+      gemm_triplets(op, (op == madness::cblas::NoTrans ? rows : cols),
+          (op == madness::cblas::NoTrans ? cols : rows), row, c, v);
+
+      // Bucket the elements by row; the ordinals are row-major, so the rows
+      // of untransposed arguments are already in order
+      start.assign(rows + 1ul, 0ul);
+      for(const size_type r : row)
+        ++start[r + 1ul];
+      std::partial_sum(start.begin(), start.end(), start.begin());
+      col.resize(c.size());
+      value.resize(v.size());
+      std::vector<size_type> next(start.begin(), start.end() - 1);
+      for(size_type e = 0ul; e < row.size(); ++e) {
+        const size_type p = next[row[e]]++;
+        col[p] = c[e];
+        value[p] = v[e];
+      }
+    }
+
+  public:
+
+    /// Construct an empty tile
+    SparseTile() = default;
+
+    /// Construct a zero tile
+
+    /// \param range The range of the tile
+    /// \param fill The fill fraction of the tile
+    explicit SparseTile(const range_type& range,
+        const double fill = detail::sparse_tile_fill()) :
+      pimpl_(std::make_shared<Impl>(Impl{ range, dense_type(),
+          std::vector<size_type>(), std::vector<T>(), fill }))
+    { }
+
+    /// Construct a tile from its non-zero elements
+
+    /// \param range The range of the tile
+    /// \param index The ordinals of the elements, in increasing order
+    /// \param value The elements
+    /// \param fill The fill fraction of the tile
+    SparseTile(const range_type& range, std::vector<size_type> index,
+        std::vector<T> value, const double fill = detail::sparse_tile_fill()) :
+      pimpl_(make(range, std::move(index), std::move(value), fill).pimpl_)
+    {
+      TA_ASSERT(std::is_sorted(pimpl_->index_.begin(), pimpl_->index_.end()));
+      TA_ASSERT(pimpl_->index_.empty() || (pimpl_->index_.back() < range.volume()));
+    }
+
+    /// Compress a dense tile
+
+    /// \tparam A The allocator type of the tensor
+    /// \param tensor The tensor to be compressed
+    /// \param fill The fill fraction of the tile
+    template <typename A>
+    explicit SparseTile(const Tensor<T, A>& tensor,
+        const double fill = detail::sparse_tile_fill()) :
+      pimpl_()
+    {
+      TA_ASSERT(! tensor.empty());
+      pimpl_ = make(dense_type(tensor.range(), tensor.data()), fill).pimpl_;
+    }
+
+    SparseTile(const SparseTile_&) = default;
+    SparseTile(SparseTile_&&) = default;
+    SparseTile_& operator=(const SparseTile_&) = default;
+    SparseTile_& operator=(SparseTile_&&) = default;
+
+    /// Deep copy
+
+    /// \return A copy of this tile that does not share data with this tile
+    SparseTile_ clone() const {
+      if(empty())
+        return SparseTile_();
+      return SparseTile_(std::make_shared<Impl>(Impl{ pimpl_->range_,
+          pimpl_->dense_.clone(), pimpl_->index_, pimpl_->value_,
+          pimpl_->fill_ }));
+    }
+
+    /// The elements of this tile as a dense tensor
+
+    /// \return A tensor that holds the elements of this tile; it shares the
+    /// data of dense tiles
+    dense_type dense() const {
+      TA_ASSERT(! empty());
+      if(! is_sparse())
+        return pimpl_->dense_;
+      dense_type result(pimpl_->range_, T(0));
+      for(size_type e = 0ul; e < pimpl_->index_.size(); ++e)
+        result[pimpl_->index_[e]] = pimpl_->value_[e];
+      return result;
+    }
+
+    /// Expand this tile to a dense tensor
+
+    /// \return A tensor that holds the elements of this tile
+    explicit operator Tensor<T>() const { return dense().clone(); }
+
+    /// \return \c true if this tile is not initialized
+    bool empty() const { return ! pimpl_; }
+
+    /// \return The range of this tile
+    const range_type& range() const {
+      TA_ASSERT(! empty());
+      return pimpl_->range_;
+    }
+
+    /// \return The number of elements of the dense tile
+    size_type size() const { return range().volume(); }
+
+    /// \return \c true if this tile is stored in compressed form
+    bool is_sparse() const {
+      TA_ASSERT(! empty());
+      return pimpl_->dense_.empty();
+    }
+
+    /// \return The number of stored elements of this tile
+    size_type nnz() const {
+      return (is_sparse() ? pimpl_->index_.size() : pimpl_->dense_.size());
+    }
+
+    /// \return The fill fraction of this tile
+    double fill() const {
+      TA_ASSERT(! empty());
+      return pimpl_->fill_;
+    }
+
+    /// \return The ordinals of the non-zero elements of a compressed tile
+    const std::vector<size_type>& index() const {
+      TA_ASSERT(is_sparse());
+      return pimpl_->index_;
+    }
+
+    /// \return The non-zero elements of a compressed tile
+    const std::vector<T>& value() const {
+      TA_ASSERT(is_sparse());
+      return pimpl_->value_;
+    }
+
+    /// Serialize the tile
+
+    /// \tparam Archive The output archive type
+    /// \param ar The output archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      const bool have_pimpl = ! empty();
+      ar & have_pimpl;
+      if(have_pimpl) {
+        const bool sparse = is_sparse();
+        ar & pimpl_->range_ & pimpl_->fill_ & sparse;
+        if(sparse)
+          ar & pimpl_->index_ & pimpl_->value_;
+        else
+          ar & pimpl_->dense_;
+      }
+    }
+
+    /// Deserialize the tile
+
+    /// \tparam Archive The input archive type
+    /// \param ar The input archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      bool have_pimpl = false;
+      ar & have_pimpl;
+      if(have_pimpl) {
+        pimpl_ = std::make_shared<Impl>();
+        bool sparse = true;
+        ar & pimpl_->range_ & pimpl_->fill_ & sparse;
+        if(sparse)
+          ar & pimpl_->index_ & pimpl_->value_;
+        else
+          ar & pimpl_->dense_;
+      } else {
+        pimpl_.reset();
+      }
+    }
+
+    // Permutation operations ------------------------------------------------
+
+    /// \param perm The permutation
+    /// \return A permuted copy of this tile
+    SparseTile_ permute(const Permutation& perm) const {
+      TA_ASSERT(! empty());
+      if(! is_sparse())
+        return SparseTile_(std::make_shared<Impl>(Impl{ perm * pimpl_->range_,
+            pimpl_->dense_.permute(perm), std::vector<size_type>(),
+            std::vector<T>(), pimpl_->fill_ }));
+
+      const range_type range = perm * pimpl_->range_;
+      std::vector<std::pair<size_type, T> > elements;
+      elements.reserve(pimpl_->index_.size());
+      for(size_type e = 0ul; e < pimpl_->index_.size(); ++e)
+        elements.emplace_back(range.ordinal(perm * pimpl_->range_.idx(pimpl_->index_[e])),
+            pimpl_->value_[e]);
+      std::sort(elements.begin(), elements.end(),
+          [] (const std::pair<size_type, T>& a, const std::pair<size_type, T>& b)
+          { return a.first < b.first; });
+
+      std::vector<size_type> index(elements.size());
+      std::vector<T> value(elements.size());
+      for(size_type e = 0ul; e < elements.size(); ++e) {
+        index[e] = elements[e].first;
+        value[e] = elements[e].second;
+      }
+      return SparseTile_(std::make_shared<Impl>(Impl{ range, dense_type(),
+          std::move(index), std::move(value), pimpl_->fill_ }));
+    }
+
+    // Addition operations ---------------------------------------------------
+
+    SparseTile_ add(const SparseTile_& right) const {
+      return merge(right, [] (const T l, const T r) { return l + r; });
+    }
+
+    SparseTile_ add(const SparseTile_& right, const Permutation& perm) const {
+      return add(right).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ add(const SparseTile_& right, const Scalar factor) const {
+      return merge(right, [factor] (const T l, const T r) { return (l + r) * factor; });
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ add(const SparseTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return add(right, factor).permute(perm);
+    }
+
+    SparseTile_& add_to(const SparseTile_& right) {
+      *pimpl_ = *add(right).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_& add_to(const SparseTile_& right, const Scalar factor) {
+      *pimpl_ = *add(right, factor).pimpl_;
+      return *this;
+    }
+
+    // Subtraction operations ------------------------------------------------
+
+    SparseTile_ subt(const SparseTile_& right) const {
+      return merge(right, [] (const T l, const T r) { return l - r; });
+    }
+
+    SparseTile_ subt(const SparseTile_& right, const Permutation& perm) const {
+      return subt(right).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ subt(const SparseTile_& right, const Scalar factor) const {
+      return merge(right, [factor] (const T l, const T r) { return (l - r) * factor; });
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ subt(const SparseTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return subt(right, factor).permute(perm);
+    }
+
+    SparseTile_& subt_to(const SparseTile_& right) {
+      *pimpl_ = *subt(right).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_& subt_to(const SparseTile_& right, const Scalar factor) {
+      *pimpl_ = *subt(right, factor).pimpl_;
+      return *this;
+    }
+
+    // Multiplication operations ---------------------------------------------
+
+    /// Element-wise product
+
+    /// Only the elements that are non-zero in both tiles are computed, so
+    /// the product of a compressed tile is compressed.
+    /// \param right The right-hand argument
+    /// \return The element-wise product of this tile and \c right
+    SparseTile_ mult(const SparseTile_& right) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(pimpl_->range_ == right.pimpl_->range_);
+      if(! (is_sparse() || right.is_sparse()))
+        return make(pimpl_->dense_.mult(right.pimpl_->dense_), pimpl_->fill_);
+      if(! is_sparse())
+        return right.mult(*this);
+
+      std::vector<size_type> index;
+      std::vector<T> value;
+      if(right.is_sparse()) {
+        const std::vector<size_type>& ri = right.pimpl_->index_;
+        size_type r = 0ul;
+        for(size_type l = 0ul; l < pimpl_->index_.size(); ++l) {
+          const size_type i = pimpl_->index_[l];
+          while((r < ri.size()) && (ri[r] < i))
+            ++r;
+          if((r < ri.size()) && (ri[r] == i)) {
+            index.push_back(i);
+            value.push_back(pimpl_->value_[l] * right.pimpl_->value_[r]);
+          }
+        }
+      } else {
+        index.reserve(pimpl_->index_.size());
+        value.reserve(pimpl_->index_.size());
+        for(size_type l = 0ul; l < pimpl_->index_.size(); ++l) {
+          const size_type i = pimpl_->index_[l];
+          const T x = pimpl_->value_[l] * right.pimpl_->dense_[i];
+          if(x != T(0)) {
+            index.push_back(i);
+            value.push_back(x);
+          }
+        }
+      }
+      return make(pimpl_->range_, std::move(index), std::move(value),
+          pimpl_->fill_);
+    }
+
+    SparseTile_ mult(const SparseTile_& right, const Permutation& perm) const {
+      return mult(right).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ mult(const SparseTile_& right, const Scalar factor) const {
+      return mult(right).scale_to(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ mult(const SparseTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return mult(right, factor).permute(perm);
+    }
+
+    SparseTile_& mult_to(const SparseTile_& right) {
+      *pimpl_ = *mult(right).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_& mult_to(const SparseTile_& right, const Scalar factor) {
+      return mult_to(right).scale_to(factor);
+    }
+
+    // Scaling operations ----------------------------------------------------
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ scale(const Scalar factor) const {
+      return clone().scale_to(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_ scale(const Scalar factor, const Permutation& perm) const {
+      return scale(factor).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    SparseTile_& scale_to(const Scalar factor) {
+      TA_ASSERT(! empty());
+      if(is_sparse()) {
+        for(T& x : pimpl_->value_)
+          x *= factor;
+      } else {
+        pimpl_->dense_.scale_to(factor);
+      }
+      return *this;
+    }
+
+    SparseTile_ neg() const { return scale(numeric_type(-1)); }
+
+    SparseTile_ neg(const Permutation& perm) const {
+      return scale(numeric_type(-1), perm);
+    }
+
+    SparseTile_& neg_to() { return scale_to(numeric_type(-1)); }
+
+    // Contraction operations ------------------------------------------------
+
+    /// Contract this tile with \c right
+
+    /// Dense arguments are contracted with \c Tensor::gemm() . Otherwise the
+    /// product is accumulated in a dense buffer: each non-zero element
+    /// \f$ a_{ip} \f$ of a compressed left-hand argument updates row \c i
+    /// with row \c p of the right-hand argument, which is a dense row or a
+    /// compressed row, and each non-zero element \f$ b_{pj} \f$ of a
+    /// compressed right-hand argument updates column \c j of a dense
+    /// left-hand argument. The flops are proportional to the number of
+    /// non-zero products. The result is compressed if it is sparse enough.
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of the product
+    /// \param gemm_helper The contraction plan
+    /// \return The scaled product of this tile and \c right
+    SparseTile_ gemm(const SparseTile_& right, const numeric_type factor,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.left_rank());
+      TA_ASSERT(right.range().rank() == gemm_helper.right_rank());
+
+      if(! (is_sparse() || right.is_sparse()))
+        return make(pimpl_->dense_.gemm(right.pimpl_->dense_, factor,
+            gemm_helper), pimpl_->fill_);
+
+      integer m = 1, n = 1, k = 1;
+      gemm_helper.compute_matrix_sizes(m, n, k, pimpl_->range_, right.range());
+      const size_type M = m, N = n, K = k;
+      dense_type result(gemm_helper.make_result_range<range_type>(pimpl_->range_,
+          right.range()), T(0));
+      T* MADNESS_RESTRICT const c = result.data();
+
+      const madness::cblas::CBLAS_TRANSPOSE left_op = gemm_helper.left_op();
+      const madness::cblas::CBLAS_TRANSPOSE right_op = gemm_helper.right_op();
+
+      if(is_sparse()) {
+        std::vector<size_type> row, col;
+        std::vector<T> value;
+        gemm_triplets(left_op, (left_op == madness::cblas::NoTrans ? M : K),
+            (left_op == madness::cblas::NoTrans ? K : M), row, col, value);
+
+        if(right.is_sparse()) {
+          // Sparse-sparse product
+          std::vector<size_type> start, right_col;
+          std::vector<T> right_value;
+          right.gemm_rows(right_op, K, N, start, right_col, right_value);
+          for(size_type e = 0ul; e < value.size(); ++e) {
+            const T a = value[e] * factor;
+            T* MADNESS_RESTRICT const c_row = c + row[e] * N;
+            for(size_type q = start[col[e]]; q < start[col[e] + 1ul]; ++q)
+              c_row[right_col[q]] += a * right_value[q];
+          }
+        } else {
+          // Sparse-dense product
+          const T* MADNESS_RESTRICT const b = right.pimpl_->dense_.data();
+          for(size_type e = 0ul; e < value.size(); ++e) {
+            const T a = value[e] * factor;
+            const size_type p = col[e];
+            T* MADNESS_RESTRICT const c_row = c + row[e] * N;
+            if(right_op == madness::cblas::NoTrans) {
+              const T* MADNESS_RESTRICT const b_row = b + p * N;
+              for(size_type j = 0ul; j < N; ++j)
+                c_row[j] += a * b_row[j];
+            } else if(right_op == madness::cblas::Trans) {
+              for(size_type j = 0ul; j < N; ++j)
+                c_row[j] += a * b[j * K + p];
+            } else {
+              for(size_type j = 0ul; j < N; ++j)
+                c_row[j] += a * detail::conj(b[j * K + p]);
+            }
+          }
+        }
+      } else {
+        // Dense-sparse product
+        std::vector<size_type> row, col;
+        std::vector<T> value;
+        right.gemm_triplets(right_op, (right_op == madness::cblas::NoTrans ? K : N),
+            (right_op == madness::cblas::NoTrans ? N : K), row, col, value);
+        const T* MADNESS_RESTRICT const a = pimpl_->dense_.data();
+        for(size_type e = 0ul; e < value.size(); ++e) {
+          const T x = value[e] * factor;
+          const size_type p = row[e];
+          const size_type j = col[e];
+          if(left_op == madness::cblas::NoTrans) {
+            for(size_type i = 0ul; i < M; ++i)
+              c[i * N + j] += a[i * K + p] * x;
+          } else {
+            const T* MADNESS_RESTRICT const a_row = a + p * M;
+            if(left_op == madness::cblas::Trans)
+              for(size_type i = 0ul; i < M; ++i)
+                c[i * N + j] += a_row[i] * x;
+            else
+              for(size_type i = 0ul; i < M; ++i)
+                c[i * N + j] += detail::conj(a_row[i]) * x;
+          }
+        }
+      }
+
+      return make(std::move(result), pimpl_->fill_);
+    }
+
+    /// Contract \c left and \c right and add the product to this tile
+
+    /// \param left The left-hand argument
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of the product
+    /// \param gemm_helper The contraction plan
+    /// \return A reference to this tile
+    SparseTile_& gemm(const SparseTile_& left, const SparseTile_& right,
+        const numeric_type factor, const math::GemmHelper& gemm_helper)
+    {
+      SparseTile_ product = left.gemm(right, factor, gemm_helper);
+      if(empty())
+        pimpl_ = product.pimpl_;
+      else
+        add_to(product);
+      return *this;
+    }
+
+    // Reduction operations --------------------------------------------------
+
+    /// \return The sum of the elements of this tile
+    numeric_type sum() const {
+      TA_ASSERT(! empty());
+      if(! is_sparse())
+        return pimpl_->dense_.sum();
+      return std::accumulate(pimpl_->value_.begin(), pimpl_->value_.end(),
+          numeric_type(0));
+    }
+
+    /// \return The squared Frobenius norm of this tile
+    double squared_norm() const {
+      TA_ASSERT(! empty());
+      if(! is_sparse())
+        return pimpl_->dense_.squared_norm();
+      double result = 0.0;
+      for(const T& x : pimpl_->value_)
+        result += detail::norm(x);
+      return result;
+    }
+
+    /// \return The Frobenius norm of this tile
+    double norm() const { return std::sqrt(squared_norm()); }
+
+  }; // class SparseTile
+
+  /// Memory footprint of a sparse tile
+
+  /// This overload is found by argument-dependent lookup, so it does not
+  /// need to be declared before the containers that count tiles.
+  /// \tparam T The element type
+  /// \param tile The tile
+  /// \return The size of the stored elements of \c tile , and of their
+  /// ordinals, in bytes
+  template <typename T>
+  inline std::size_t tile_bytes(const SparseTile<T>& tile) {
+    if(tile.empty())
+      return 0ul;
+    if(! tile.is_sparse())
+      return tile.nnz() * sizeof(T);
+    return tile.nnz() * (sizeof(T) + sizeof(std::size_t));
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPARSE_TILE_H__INCLUDED
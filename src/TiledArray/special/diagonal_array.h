@@ -28,9 +28,11 @@
 
 #include <TiledArray/dist_array.h>
 #include <TiledArray/range.h>
+#include <TiledArray/special/diagonal_gemm.h>
 #include <TiledArray/tensor.h>
 #include <TiledArray/tiled_range.h>
 
+#include <cmath>
 #include <vector>
 
 namespace TiledArray {
@@ -85,6 +87,19 @@ Tensor<float> diagonal_shape(TiledRange const &trange, T val) {
     return shape;
 }
 
+// The shape of a dense diagonal array
+template <typename T>
+DenseShape diagonal_array_shape(TiledRange const &, T, DenseShape const *) {
+    return DenseShape();
+}
+
+// The shape of a sparse diagonal array
+template <typename T>
+SparseShape<float> diagonal_array_shape(TiledRange const &trange, T val,
+                                        SparseShape<float> const *) {
+    return SparseShape<float>(diagonal_shape(trange, val), trange);
+}
+
 // Actually do all the work of writing the diagonal tiles
 template<typename Array, typename T>
 void write_tiles_to_array(Array &A, T val){
@@ -126,6 +141,267 @@ void write_tiles_to_array(Array &A, T val){
 
 }  // namespace detail
 
+/// A tile that stores only its diagonal elements
+
+/// The diagonal elements of the tile are the elements (n,n,n, ..., n) in
+/// \c detail::diagonal_range() of its range, and all other elements are
+/// zero. Contractions of a matrix \c DiagonalTile with a \c Tensor
+/// scale the rows or columns of the tensor, see \c detail::diagonal_gemm() ,
+/// instead of multiplying a dense matrix.
+/// \tparam T The element type
+template <typename T>
+class DiagonalTile {
+public:
+    typedef Range range_type; ///< Range type
+    typedef T value_type; ///< Element type
+    typedef T numeric_type; ///< Scalar type
+    typedef std::size_t size_type; ///< Size type
+
+private:
+    range_type range_; ///< The range of the tile
+    std::vector<T> values_; ///< The diagonal elements
+    size_type first_; ///< The index of the first diagonal element
+
+public:
+    /// Default constructor makes an empty tile
+    DiagonalTile() : range_(), values_(), first_(0ul) { }
+
+    /// Constructs a tile with a constant diagonal
+
+    /// \param range The range of the tile
+    /// \param val The value of the diagonal elements
+    DiagonalTile(const range_type& range, const T val) :
+        range_(range), values_(), first_(0ul)
+    {
+        const auto diags = detail::diagonal_range(range_);
+        if(diags.volume() > 0ul) {
+            first_ = diags.lobound_data()[0];
+            values_.assign(diags.volume(), val);
+        }
+    }
+
+    DiagonalTile(const DiagonalTile&) = default;
+    DiagonalTile(DiagonalTile&&) = default;
+    DiagonalTile& operator=(const DiagonalTile&) = default;
+    DiagonalTile& operator=(DiagonalTile&&) = default;
+
+    /// \return A deep copy of this tile
+    DiagonalTile clone() const { return *this; }
+
+    /// \return The range of the tile
+    const range_type& range() const { return range_; }
+
+    /// \return \c true when this tile was default constructed
+    bool empty() const { return range_.volume() == 0ul; }
+
+    /// \return The number of diagonal elements
+    size_type diagonal_size() const { return values_.size(); }
+
+    /// \return The index of the first diagonal element
+    size_type diagonal_lobound() const { return first_; }
+
+    /// Diagonal element accessor
+
+    /// \param e The index of the diagonal element, i.e. of element
+    /// (e,e, ..., e)
+    /// \return The diagonal element
+    T diagonal(const size_type e) const {
+        TA_ASSERT((e >= first_) && (e < (first_ + values_.size())));
+        return values_[e - first_];
+    }
+
+    /// Convert to a dense tensor
+
+    /// \return A tensor with the elements of this tile
+    Tensor<T> tensor() const {
+        Tensor<T> result(range_, T(0));
+        const auto ndims = range_.rank();
+        for(size_type i = 0ul; i < values_.size(); ++i)
+            result(std::vector<size_type>(ndims, first_ + i)) = values_[i];
+        return result;
+    }
+
+    /// Permute this tile
+
+    /// The diagonal of a tile is invariant under permutation of its
+    /// dimensions, so only the range is permuted.
+    /// \param perm The permutation
+    /// \return The permuted tile
+    DiagonalTile permute(const Permutation& perm) const {
+        DiagonalTile result(*this);
+        result.range_ = perm * range_;
+        return result;
+    }
+
+    /// Scale this tile
+
+    /// \param factor The scaling factor
+    /// \return A reference to this tile
+    DiagonalTile& scale_to(const T factor) {
+        for(auto& value : values_)
+            value *= factor;
+        return *this;
+    }
+
+    /// \return The Frobenius norm of this tile
+    typename detail::scalar_type<T>::type norm() const {
+        typename detail::scalar_type<T>::type result(0);
+        for(const auto& value : values_)
+            result += std::abs(value) * std::abs(value);
+        return std::sqrt(result);
+    }
+
+    /// MADNESS compliant serialization
+    template <typename Archive>
+    void serialize(Archive& ar) { ar & range_ & values_ & first_; }
+
+}; // class DiagonalTile
+
+/// Permute a diagonal tile
+
+/// \param tile The tile
+/// \param perm The permutation
+/// \return The permuted tile
+template <typename T>
+inline DiagonalTile<T> permute(const DiagonalTile<T>& tile, const Permutation& perm) {
+    return tile.permute(perm);
+}
+
+/// Scale a diagonal tile
+
+/// \param tile The tile
+/// \param factor The scaling factor
+/// \return The scaled tile
+template <typename T, typename Scalar,
+    typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+inline DiagonalTile<T> scale(const DiagonalTile<T>& tile, const Scalar factor) {
+    DiagonalTile<T> result(tile);
+    return std::move(result.scale_to(factor));
+}
+
+/// Frobenius norm of a diagonal tile
+
+/// \param tile The tile
+/// \return The norm of \c tile
+template <typename T>
+inline typename detail::scalar_type<T>::type norm(const DiagonalTile<T>& tile) {
+    return tile.norm();
+}
+
+/// Element-wise product of a diagonal tile and a tensor
+
+/// \param left The diagonal tile
+/// \param right The tensor
+/// \return A tensor that is zero except on the diagonal
+template <typename T, typename A>
+inline Tensor<T, A> mult(const DiagonalTile<T>& left, const Tensor<T, A>& right) {
+    TA_ASSERT(left.range() == right.range());
+    Tensor<T, A> result(right.range(), T(0));
+    const auto ndims = right.range().rank();
+    for(auto e = left.diagonal_lobound();
+        e < left.diagonal_lobound() + left.diagonal_size(); ++e)
+    {
+        const std::vector<std::size_t> index(ndims, e);
+        result(index) = left.diagonal(e) * right(index);
+    }
+    return result;
+}
+
+/// Element-wise product of a tensor and a diagonal tile
+
+/// \param left The tensor
+/// \param right The diagonal tile
+/// \return A tensor that is zero except on the diagonal
+template <typename T, typename A>
+inline Tensor<T, A> mult(const Tensor<T, A>& left, const DiagonalTile<T>& right) {
+    return mult(right, left);
+}
+
+/// Contract a diagonal tile with a tensor
+
+/// Matrix tiles with one contracted index are contracted with
+/// \c detail::diagonal_gemm() , other tiles are converted to a dense
+/// tensor.
+/// \param result The result tensor
+/// \param left The diagonal tile
+/// \param right The tensor
+/// \param factor The scaling factor
+/// \param gemm_config The contraction configuration
+/// \return A reference to \c result
+template <typename T, typename A>
+inline Tensor<T, A>& gemm(Tensor<T, A>& result, const DiagonalTile<T>& left,
+    const Tensor<T, A>& right, const typename Tensor<T, A>::numeric_type factor,
+    const math::GemmHelper& gemm_config)
+{
+    if(! detail::is_diagonal_gemm(left.range(), gemm_config))
+        return result.gemm(left.tensor(), right, factor, gemm_config);
+    if(left.diagonal_size())
+        detail::diagonal_gemm(result, left.range(),
+            [&left] (std::size_t e) { return left.diagonal(e); }, right, factor,
+            gemm_config);
+    return result;
+}
+
+/// Contract a diagonal tile with a tensor
+
+/// \param left The diagonal tile
+/// \param right The tensor
+/// \param factor The scaling factor
+/// \param gemm_config The contraction configuration
+/// \return The result tensor
+template <typename T, typename A>
+inline Tensor<T, A> gemm(const DiagonalTile<T>& left, const Tensor<T, A>& right,
+    const typename Tensor<T, A>::numeric_type factor,
+    const math::GemmHelper& gemm_config)
+{
+    Tensor<T, A> result(gemm_config.make_result_range<Range>(left.range(),
+        right.range()), T(0));
+    gemm(result, left, right, factor, gemm_config);
+    return result;
+}
+
+/// Contract a tensor with a diagonal tile
+
+/// Matrix tiles with one contracted index are contracted with
+/// \c detail::diagonal_gemm() , other tiles are converted to a dense
+/// tensor.
+/// \param result The result tensor
+/// \param left The tensor
+/// \param right The diagonal tile
+/// \param factor The scaling factor
+/// \param gemm_config The contraction configuration
+/// \return A reference to \c result
+template <typename T, typename A>
+inline Tensor<T, A>& gemm(Tensor<T, A>& result, const Tensor<T, A>& left,
+    const DiagonalTile<T>& right, const typename Tensor<T, A>::numeric_type factor,
+    const math::GemmHelper& gemm_config)
+{
+    if(! detail::is_diagonal_gemm(right.range(), gemm_config))
+        return result.gemm(left, right.tensor(), factor, gemm_config);
+    if(right.diagonal_size())
+        detail::diagonal_gemm(result, left, right.range(),
+            [&right] (std::size_t e) { return right.diagonal(e); }, factor,
+            gemm_config);
+    return result;
+}
+
+/// Contract a tensor with a diagonal tile
+
+/// \param left The tensor
+/// \param right The diagonal tile
+/// \param factor The scaling factor
+/// \param gemm_config The contraction configuration
+/// \return The result tensor
+template <typename T, typename A>
+inline Tensor<T, A> gemm(const Tensor<T, A>& left, const DiagonalTile<T>& right,
+    const typename Tensor<T, A>::numeric_type factor,
+    const math::GemmHelper& gemm_config)
+{
+    Tensor<T, A> result(gemm_config.make_result_range<Range>(left.range(),
+        right.range()), T(0));
+    gemm(result, left, right, factor, gemm_config);
+    return result;
+}
 
 /// Create a DensePolicy DistArray with only diagonal elements, 
 /// the expected behavior is that every element (n,n,n, ..., n) will be nonzero.
@@ -186,6 +462,34 @@ diagonal_array(World &world, TiledRange const &trange, T val = 1) {
   return sparse_diagonal_array<T>(world, trange, val);
 }
 
+/// Create a DistArray of \c DiagonalTile tiles
+
+/// Every element (n,n,n, ..., n) of the array is \c val , and only the
+/// diagonal elements are stored, so contractions with the array scale the
+/// rows or columns of the other argument.
+/// \tparam T The element type
+/// \tparam Policy The array policy type
+/// \param world The world for the array
+/// \param trange The trange for the array
+/// \param val The value to be written along the diagonal elements
+template <typename T, typename Policy>
+DistArray<DiagonalTile<T>, Policy> diagonal_tile_array(World &world,
+                                               TiledRange const &trange,
+                                               T val = 1) {
+    DistArray<DiagonalTile<T>, Policy> A(world, trange,
+        detail::diagonal_array_shape(trange, val,
+            static_cast<const typename Policy::shape_type*>(nullptr)));
+
+    const auto vol = trange.tiles_range().volume();
+    for (auto ord = 0ul; ord < vol; ++ord) {
+        if (A.is_local(ord) && !A.is_zero(ord))
+            A.set(ord, DiagonalTile<T>(trange.make_tile_range(ord), val));
+    }
+
+    world.gop.fence();
+    return A;
+}
+
 }  // namespace TiledArray
 
 #endif  // TILEDARRAY_SPECIALARRAYS_DIAGONAL_ARRAY_H__INCLUDED
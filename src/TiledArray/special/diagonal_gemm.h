@@ -0,0 +1,158 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  diagonal_gemm.h
+ *  Apr 3, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SPECIAL_DIAGONAL_GEMM_H__INCLUDED
+#define TILEDARRAY_SPECIAL_DIAGONAL_GEMM_H__INCLUDED
+
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/range.h>
+#include <TiledArray/tensor.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Check that a contraction with a diagonal matrix tile can be lowered
+
+    /// \param diag_range The range of the diagonal matrix tile
+    /// \param gemm_config The contraction configuration
+    /// \return \c true when the diagonal tile is a matrix with one
+    /// contracted dimension
+    inline bool is_diagonal_gemm(const Range& diag_range,
+        const math::GemmHelper& gemm_config)
+    {
+      return (diag_range.rank() == 2u) && (gemm_config.num_contract_ranks() == 1u);
+    }
+
+    /// Contract a diagonal matrix tile with a tensor
+
+    /// Computes <tt>result += factor * D * op(right)</tt> , where \c D is
+    /// the diagonal matrix tile, with one scaled copy of a row of
+    /// \c op(right) per diagonal element of \c D , so the cost is that of
+    /// the result instead of a matrix multiplication.
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    /// \tparam Diag The diagonal element type, with signature
+    /// <tt>T(std::size_t)</tt>
+    /// \param result The result tensor, which must be initialized
+    /// \param diag_range The range of the diagonal matrix tile
+    /// \param diag The function that returns the diagonal element with a
+    /// given element index
+    /// \param right The right-hand tensor
+    /// \param factor The scaling factor
+    /// \param gemm_config The contraction configuration
+    template <typename T, typename A, typename Diag>
+    inline void diagonal_gemm(Tensor<T, A>& result, const Range& diag_range,
+        const Diag& diag, const Tensor<T, A>& right, const T factor,
+        const math::GemmHelper& gemm_config)
+    {
+      TA_ASSERT(is_diagonal_gemm(diag_range, gemm_config));
+
+      // The rows of the diagonal tile are its outer dimension
+      const unsigned int r = (gemm_config.left_op() == madness::cblas::NoTrans ? 0u : 1u);
+      const unsigned int c = 1u - r;
+      const std::size_t row_lower = diag_range.lobound_data()[r];
+      const std::size_t m_size = diag_range.extent_data()[r];
+      const std::size_t col_lower = diag_range.lobound_data()[c];
+      const std::size_t col_upper = diag_range.upbound_data()[c];
+      const std::size_t k_size = diag_range.extent_data()[c];
+      const std::size_t n_size = right.range().volume() / k_size;
+      TA_ASSERT(result.range().volume() == m_size * n_size);
+
+      const bool transpose = (gemm_config.right_op() != madness::cblas::NoTrans);
+      const T* MADNESS_RESTRICT const right_data = right.data();
+      T* MADNESS_RESTRICT const result_data = result.data();
+      for(std::size_t m = 0ul; m < m_size; ++m) {
+        const std::size_t e = row_lower + m;
+        if((e < col_lower) || (e >= col_upper))
+          continue;
+        const std::size_t k = e - col_lower;
+        const T scale = factor * diag(e);
+        T* MADNESS_RESTRICT const result_row = result_data + m * n_size;
+        if(transpose) {
+          for(std::size_t n = 0ul; n < n_size; ++n)
+            result_row[n] += scale * right_data[n * k_size + k];
+        } else {
+          const T* MADNESS_RESTRICT const right_row = right_data + k * n_size;
+          for(std::size_t n = 0ul; n < n_size; ++n)
+            result_row[n] += scale * right_row[n];
+        }
+      }
+    }
+
+    /// Contract a tensor with a diagonal matrix tile
+
+    /// Computes <tt>result += factor * op(left) * D</tt> , where \c D is
+    /// the diagonal matrix tile, with one scaled copy of a column of
+    /// \c op(left) per diagonal element of \c D .
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    /// \tparam Diag The diagonal element type, with signature
+    /// <tt>T(std::size_t)</tt>
+    /// \param result The result tensor, which must be initialized
+    /// \param left The left-hand tensor
+    /// \param diag_range The range of the diagonal matrix tile
+    /// \param diag The function that returns the diagonal element with a
+    /// given element index
+    /// \param factor The scaling factor
+    /// \param gemm_config The contraction configuration
+    template <typename T, typename A, typename Diag>
+    inline void diagonal_gemm(Tensor<T, A>& result, const Tensor<T, A>& left,
+        const Range& diag_range, const Diag& diag, const T factor,
+        const math::GemmHelper& gemm_config)
+    {
+      TA_ASSERT(is_diagonal_gemm(diag_range, gemm_config));
+
+      // The columns of the diagonal tile are its outer dimension
+      const unsigned int c = (gemm_config.right_op() == madness::cblas::NoTrans ? 1u : 0u);
+      const unsigned int r = 1u - c;
+      const std::size_t col_lower = diag_range.lobound_data()[c];
+      const std::size_t n_size = diag_range.extent_data()[c];
+      const std::size_t row_lower = diag_range.lobound_data()[r];
+      const std::size_t row_upper = diag_range.upbound_data()[r];
+      const std::size_t k_size = diag_range.extent_data()[r];
+      const std::size_t m_size = left.range().volume() / k_size;
+      TA_ASSERT(result.range().volume() == m_size * n_size);
+
+      const bool transpose = (gemm_config.left_op() != madness::cblas::NoTrans);
+      const T* MADNESS_RESTRICT const left_data = left.data();
+      T* MADNESS_RESTRICT const result_data = result.data();
+      for(std::size_t n = 0ul; n < n_size; ++n) {
+        const std::size_t e = col_lower + n;
+        if((e < row_lower) || (e >= row_upper))
+          continue;
+        const std::size_t k = e - row_lower;
+        const T scale = factor * diag(e);
+        if(transpose) {
+          const T* MADNESS_RESTRICT const left_row = left_data + k * m_size;
+          for(std::size_t m = 0ul; m < m_size; ++m)
+            result_data[m * n_size + n] += scale * left_row[m];
+        } else {
+          for(std::size_t m = 0ul; m < m_size; ++m)
+            result_data[m * n_size + n] += scale * left_data[m * k_size + k];
+        }
+      }
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPECIAL_DIAGONAL_GEMM_H__INCLUDED
@@ -26,11 +26,13 @@
 #include <tiledarray_fwd.h>
 
 #include <TiledArray/madness.h>
+#include <TiledArray/error.h>
 
 // Array class
 #include <TiledArray/tensor.h>
 #include <TiledArray/tile.h>
 #include <TiledArray/tile_op/tile_interface.h>
+#include <TiledArray/special/diagonal_gemm.h>
 
 // Array policy classes
 #include <TiledArray/policies/dense_policy.h>
@@ -108,7 +110,7 @@ template<unsigned _N = 1>
         auto lobound = range.lobound_data();
         auto upbound = range.upbound_data();
         for(auto i=0; i!=2*N && not empty; i+=2)
-          empty = (upbound[i] > lobound[i+1] && upbound[i+1] > lobound[i]) ? true : false; // assumes extents > 0
+          empty = (upbound[i] > lobound[i+1] && upbound[i+1] > lobound[i]) ? false : true; // assumes extents > 0
         return empty;
       }
 
@@ -163,7 +165,29 @@ template<typename T, unsigned _N>
   TiledArray::Tensor<T>
   mult (const KroneckerDeltaTile<_N>& arg1,
         const TiledArray::Tensor<T>& arg2) {
-  abort();
+  // only the elements on the diagonal of arg1 survive
+  if (_N != 1)
+    TA_EXCEPTION("KroneckerDeltaTile: mult is only implemented for a single Kronecker delta.");
+  TA_ASSERT(arg1.range() == arg2.range());
+  TiledArray::Tensor<T> result (arg2.range(), 0);
+  if (not arg1.empty ()) {
+    const auto* lobound = arg2.range().lobound_data();
+    const auto* upbound = arg2.range().upbound_data();
+    const auto extent1 = arg2.range().extent_data()[1];
+    for (auto e = std::max (lobound[0], lobound[1]);
+        e < std::min (upbound[0], upbound[1]); ++e) {
+      const auto i = (e - lobound[0]) * extent1 + (e - lobound[1]);
+      result[i] = arg2[i];
+    }
+  }
+  return result;
+}
+// dense_result[i] = dense_arg1[i] * sparse_arg2[i]
+template<typename T, unsigned _N>
+  TiledArray::Tensor<T>
+  mult (const TiledArray::Tensor<T>& arg1,
+        const KroneckerDeltaTile<_N>& arg2) {
+  return mult (arg2, arg1);
 }
 // dense_result[perm ^ i] = dense_arg1[i] * sparse_arg2[i]
 template<typename T, unsigned _N>
@@ -185,76 +209,131 @@ template<typename T, unsigned N>
 
 // Contraction operation
 
+// Outer product: dense_result[i,j] += factor * delta[i] * dense_arg2[j]
+// only the blocks of result on the diagonal of delta are touched
+template<typename T, unsigned N>
+  void
+  kronecker_delta_outer_product (
+      TiledArray::Tensor<T>& result,
+      const KroneckerDeltaTile<N>& arg1,
+      const TiledArray::Tensor<T>& arg2,
+      const typename TiledArray::Tensor<T>::numeric_type factor) {
+  if (arg1.empty ())
+    return;
+
+  const auto arg1_range = arg1.range();
+  const auto* lobound = arg1_range.lobound_data();
+  const auto* upbound = arg1_range.upbound_data();
+  const auto* extent = arg1_range.extent_data();
+  const auto arg2_data = arg2.data();
+  const auto arg2_volume = arg2.range().volume();
+  auto result_data = result.data();
+
+  // result block at diagonal offset += factor * arg2
+  auto axpy = [=] (std::size_t offset) {
+    T* MADNESS_RESTRICT const block = result_data + offset * arg2_volume;
+    for (std::size_t j = 0ul; j != arg2_volume; ++j)
+      block[j] += factor * arg2_data[j];
+  };
+
+  switch (N) {
+    case 1: {
+      for (auto e0 = std::max (lobound[0], lobound[1]);
+          e0 < std::min (upbound[0], upbound[1]); ++e0)
+        axpy ((e0 - lobound[0]) * extent[1] + (e0 - lobound[1]));
+    }
+      break;
+    case 2: {
+      const auto ndim23 = extent[2] * extent[3];
+      for (auto e0 = std::max (lobound[0], lobound[1]);
+          e0 < std::min (upbound[0], upbound[1]); ++e0) {
+        const auto offset01 = ((e0 - lobound[0]) * extent[1] + (e0 - lobound[1])) * ndim23;
+        for (auto e1 = std::max (lobound[2], lobound[3]);
+            e1 < std::min (upbound[2], upbound[3]); ++e1)
+          axpy (offset01 + (e1 - lobound[2]) * extent[3] + (e1 - lobound[3]));
+      }
+    }
+      break;
+
+    default:
+      TA_EXCEPTION("KroneckerDeltaTile: the outer product is only implemented for one or two Kronecker deltas.");
+  }
+}
+
 // GEMM operation with fused indices as defined by gemm_config:
-// dense_result[i,j] = dense_arg1[i,k] * sparse_arg2[k,j]
+// dense_result[i,j] += dense_arg1[i,k] * sparse_arg2[k,j]
 template<typename T, unsigned N>
-  TiledArray::Tensor<T>
+  void
   gemm (
+      TiledArray::Tensor<T>& result,
       const KroneckerDeltaTile<N>& arg1,
       const TiledArray::Tensor<T>& arg2,
       const typename TiledArray::Tensor<T>::numeric_type factor,
       const TiledArray::math::GemmHelper& gemm_config) {
 
   // preconditions:
-  // 1. implemented only outer product
-  assert(gemm_config.result_rank() == gemm_config.left_rank() + gemm_config.right_rank());
-
-  auto arg1_range = arg1.range();
-  auto arg2_range = arg2.range();
-  auto result_range = gemm_config.make_result_range<TiledArray::Range> (
-      arg1_range, arg2_range);
-  TiledArray::Tensor<T> result (result_range, 0);
-
-  auto result_data = result.data();
-  auto arg1_extents = arg1_range.extent_data();
-  auto arg2_data = arg2.data();
-  auto arg2_volume = arg2_range.volume();
-
-  if (not arg1.empty ()) {
-    switch (N) {
-      case 1: {
-        auto i0_range = std::min (arg1_extents[0], arg1_extents[1]);
-        for (auto i0 = 0; i0 != i0_range; ++i0) {
-          auto result_i0i0_ptr = result_data
-              + (i0 * arg1_extents[1] + i0) * arg2_volume;
-          std::copy (arg2_data, arg2_data + arg2_volume, result_i0i0_ptr);
-        }
-      }
-        break;
-      case 2: {
-        auto i0_range = std::min (arg1_extents[0], arg1_extents[1]);
-        auto i1_range = std::min (arg1_extents[2], arg1_extents[3]);
-        auto ndim23 = arg1_extents[2] * arg1_extents[3];
-        for (auto i0 = 0; i0 != i0_range; ++i0) {
-          auto result_i0i0i1i1_ptr_offset = result_data
-              + (i0 * arg1_extents[1] + i0) * ndim23 * arg2_volume;
-          for (auto i1 = 0; i1 != i1_range; ++i1) {
-            auto result_i0i0i1i1_ptr = result_i0i0i1i1_ptr_offset
-                + (i1 * arg1_extents[3] + i1) * arg2_volume;
-            std::copy (arg2_data, arg2_data + arg2_volume, result_i0i0i1i1_ptr);
-          }
-        }
-      }
-        break;
-
-      default:
-        abort (); // not implemented
-    }
+  // 1. implemented only outer product, and contraction of one index of a
+  //    single Kronecker delta, which is a copy of the rows of arg2
+  if (gemm_config.num_contract_ranks() == 0u) {
+    kronecker_delta_outer_product (result, arg1, arg2, factor);
+  } else if (N == 1) {
+    if (not arg1.empty ())
+      TiledArray::detail::diagonal_gemm (result, arg1.range(),
+          [] (std::size_t) { return T(1); }, arg2, T(factor), gemm_config);
+  } else {
+    TA_EXCEPTION("KroneckerDeltaTile: gemm with a left-hand delta is only implemented for outer products and for a single Kronecker delta.");
   }
+}
 
+// GEMM operation with fused indices as defined by gemm_config:
+// dense_result[i,j] = dense_arg1[i,k] * sparse_arg2[k,j]
+template<typename T, unsigned N>
+  TiledArray::Tensor<T>
+  gemm (
+      const KroneckerDeltaTile<N>& arg1,
+      const TiledArray::Tensor<T>& arg2,
+      const typename TiledArray::Tensor<T>::numeric_type factor,
+      const TiledArray::math::GemmHelper& gemm_config) {
+  TiledArray::Tensor<T> result (gemm_config.make_result_range<TiledArray::Range> (
+      arg1.range(), arg2.range()), 0);
+  gemm (result, arg1, arg2, factor, gemm_config);
   return result;
 }
+
 // GEMM operation with fused indices as defined by gemm_config:
 // dense_result[i,j] += dense_arg1[i,k] * sparse_arg2[k,j]
 template<typename T, unsigned N>
   void
   gemm (
       TiledArray::Tensor<T>& result,
-      const KroneckerDeltaTile<N>& arg1,
-      const TiledArray::Tensor<T>& arg2,
+      const TiledArray::Tensor<T>& arg1,
+      const KroneckerDeltaTile<N>& arg2,
       const typename TiledArray::Tensor<T>::numeric_type factor,
       const TiledArray::math::GemmHelper& gemm_config) {
-  abort();
-  }
+
+  // preconditions:
+  // 1. implemented only contraction of one index of a single Kronecker
+  //    delta, which is a copy of the columns of arg1
+  if (N != 1 || gemm_config.num_contract_ranks() != 1u)
+    TA_EXCEPTION("KroneckerDeltaTile: gemm with a right-hand delta is only implemented for the contraction of one index of a single Kronecker delta.");
+  if (not arg2.empty ())
+    TiledArray::detail::diagonal_gemm (result, arg1, arg2.range(),
+        [] (std::size_t) { return T(1); }, T(factor), gemm_config);
+}
+
+// GEMM operation with fused indices as defined by gemm_config:
+// dense_result[i,j] = dense_arg1[i,k] * sparse_arg2[k,j]
+template<typename T, unsigned N>
+  TiledArray::Tensor<T>
+  gemm (
+      const TiledArray::Tensor<T>& arg1,
+      const KroneckerDeltaTile<N>& arg2,
+      const typename TiledArray::Tensor<T>::numeric_type factor,
+      const TiledArray::math::GemmHelper& gemm_config) {
+  TiledArray::Tensor<T> result (gemm_config.make_result_range<TiledArray::Range> (
+      arg1.range(), arg2.range()), 0);
+  gemm (result, arg1, arg2, factor, gemm_config);
+  return result;
+}
 
 #endif // TILEDARRAY_TEST_SPARSE_TILE_H__INCLUDED
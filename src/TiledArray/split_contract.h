@@ -0,0 +1,192 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  split_contract.h
+ *  Jun 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SPLIT_CONTRACT_H__INCLUDED
+#define TILEDARRAY_SPLIT_CONTRACT_H__INCLUDED
+
+#include <TiledArray/conversions/retile.h>
+#include <TiledArray/dist_array.h>
+#include <TiledArray/expressions/variable_list.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The largest tile extent, relative to the median, that is not split
+
+    /// The ratio is read from the \c TA_SPLIT_TILE_RATIO environment
+    /// variable; the default is 2.
+    /// \return The split ratio
+    inline double split_tile_ratio() {
+      static const double ratio = [] () -> double {
+        const char* ratio = getenv("TA_SPLIT_TILE_RATIO");
+        if(ratio)
+          return std::max(1.0, std::strtod(ratio, nullptr));
+        return 2.0;
+      }();
+      return ratio;
+    }
+
+  }  // namespace detail
+
+  /// Split the oversized tiles of a tiling
+
+  /// A tile is oversized when its extent is larger than \c ratio times the
+  /// median tile extent. Oversized tiles are split into the smallest number
+  /// of tiles whose extents are not larger than that and differ by at most
+  /// one; the other tiles are not changed, so every tile boundary of
+  /// \c trange1 is a boundary of the result.
+  /// \param trange1 The tiling
+  /// \param ratio The largest tile extent, relative to the median, that is
+  /// not split [ default = \c TA_SPLIT_TILE_RATIO or 2 ]
+  /// \return The tiling with the oversized tiles split
+  inline TiledRange1 split_oversized_tiles(const TiledRange1& trange1,
+      const double ratio = detail::split_tile_ratio())
+  {
+    std::vector<std::size_t> extents;
+    extents.reserve(trange1.tile_extent());
+    for(const TiledRange1::range_type& tile : trange1)
+      extents.push_back(tile.second - tile.first);
+    if(extents.empty())
+      return trange1;
+    std::nth_element(extents.begin(), extents.begin() + extents.size() / 2ul,
+        extents.end());
+    const std::size_t limit = std::max<std::size_t>(1ul,
+        std::floor(ratio * double(extents[extents.size() / 2ul])));
+
+    std::vector<std::size_t> boundaries;
+    boundaries.reserve(extents.size() + 1ul);
+    for(const TiledRange1::range_type& tile : trange1) {
+      const std::size_t extent = tile.second - tile.first;
+      const std::size_t pieces = (extent + limit - 1ul) / limit;
+      for(std::size_t p = 0ul; p < pieces; ++p)
+        boundaries.push_back(tile.first + (p * extent) / pieces);
+    }
+    boundaries.push_back(trange1.elements_range().second);
+    if(boundaries.size() == extents.size() + 1ul)
+      return trange1;
+    return TiledRange1(boundaries.begin(), boundaries.end());
+  }
+
+  /// Contraction that splits oversized tiles for load balance
+
+  /// Irregular tilings can have a few tiles that are much larger than the
+  /// others, and the processes that own the result tiles or the contraction
+  /// steps of these tiles take much longer than the rest. This evaluates
+  /// <tt>result(result_vars) = left(left_vars) * right(right_vars)</tt> with
+  /// the oversized tiles of every index split by \c split_oversized_tiles() ,
+  /// so their tile contractions are spread over more processes and SUMMA
+  /// steps, and their reductions over more tasks. The arguments are retiled
+  /// to the split tiling, and the result is retiled to the tiling of
+  /// its indices in the arguments, so the split is not visible to the caller.
+  /// When no tile is oversized, the contraction is evaluated directly. The
+  /// cost of the split is two retilings of the arguments and one of the
+  /// result, which only move the sub-blocks of the split tiles, so it pays
+  /// off when the contraction is much more expensive than its arguments.
+  /// This function is collective.
+  /// \tparam T The element type
+  /// \tparam A The tile allocator type
+  /// \tparam Policy The array policy type
+  /// \param left The left-hand array
+  /// \param left_vars The indices of the left-hand array
+  /// \param right The right-hand array
+  /// \param right_vars The indices of the right-hand array
+  /// \param result_vars The indices of the result
+  /// \param ratio The largest tile extent, relative to the median extent of
+  /// its index, that is not split [ default = \c TA_SPLIT_TILE_RATIO or 2 ]
+  /// \return The result array, with the tiling of its indices in the
+  /// arguments
+  /// \throw TiledArray::Exception When the indices do not match the arrays,
+  /// or the tiling of an index differs between the arguments
+  template <typename T, typename A, typename Policy>
+  inline DistArray<Tensor<T, A>, Policy>
+  split_contract(const DistArray<Tensor<T, A>, Policy>& left,
+      const std::string& left_vars,
+      const DistArray<Tensor<T, A>, Policy>& right,
+      const std::string& right_vars, const std::string& result_vars,
+      const double ratio = detail::split_tile_ratio())
+  {
+    typedef DistArray<Tensor<T, A>, Policy> array_type;
+
+    const expressions::VariableList lvars(left_vars), rvars(right_vars),
+        cvars(result_vars);
+    TA_USER_ASSERT(lvars.dim() == left.trange().tiles_range().rank(),
+        "split_contract(): the left-hand indices do not match the array.");
+    TA_USER_ASSERT(rvars.dim() == right.trange().tiles_range().rank(),
+        "split_contract(): the right-hand indices do not match the array.");
+
+    // The tiling of each index, and its split tiling
+    std::map<std::string, TiledRange1> tiling, split;
+    bool oversized = false;
+    auto add_tiling = [&] (const std::string& var, const TiledRange1& trange1) {
+      const auto it = tiling.find(var);
+      if(it != tiling.end()) {
+        TA_USER_ASSERT(it->second == trange1,
+            "split_contract(): the tiling of an index differs between the arguments.");
+        return;
+      }
+      tiling.emplace(var, trange1);
+      const TiledRange1 split_trange1 = split_oversized_tiles(trange1, ratio);
+      oversized = oversized || (split_trange1.tile_extent() != trange1.tile_extent());
+      split.emplace(var, split_trange1);
+    };
+    for(unsigned int i = 0u; i < lvars.dim(); ++i)
+      add_tiling(lvars[i], left.trange().data()[i]);
+    for(unsigned int i = 0u; i < rvars.dim(); ++i)
+      add_tiling(rvars[i], right.trange().data()[i]);
+
+    array_type result;
+    if(! oversized) {
+      result(result_vars) = left(left_vars) * right(right_vars);
+      return result;
+    }
+
+    auto make_trange = [] (const expressions::VariableList& vars,
+        const std::map<std::string, TiledRange1>& ranges)
+    {
+      std::vector<TiledRange1> result;
+      for(const std::string& var : vars) {
+        const auto it = ranges.find(var);
+        TA_USER_ASSERT(it != ranges.end(),
+            "split_contract(): a result index is not in the arguments.");
+        result.push_back(it->second);
+      }
+      return TiledRange(result.begin(), result.end());
+    };
+
+    // Evaluate the contraction with the split tiling
+    const array_type split_left = retile(left, make_trange(lvars, split));
+    const array_type split_right = retile(right, make_trange(rvars, split));
+    array_type split_result;
+    split_result(result_vars) = split_left(left_vars) * split_right(right_vars);
+
+    return retile(split_result, make_trange(cvars, tiling));
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPLIT_CONTRACT_H__INCLUDED
@@ -0,0 +1,327 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  strided_range.h
+ *  Mar 9, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_STRIDED_RANGE_H__INCLUDED
+#define TILEDARRAY_STRIDED_RANGE_H__INCLUDED
+
+#include <TiledArray/range.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Range that references the elements of another range with arbitrary strides
+
+  /// A strided range has a zero lower bound, and each of its dimensions
+  /// steps through the data of another range with an arbitrary stride, e.g.
+  /// every other element of a dimension, the diagonal of a matrix, or a
+  /// tensor with one coordinate index fixed. The ordinal indices of a
+  /// strided range are the offsets of its elements in the data of the other
+  /// range, so a \c TensorInterface with a \c StridedRange is a view of the
+  /// data of a tensor that is not copied.
+  class StridedRange : public Range {
+  private:
+    using Range::data_;
+    using Range::offset_;
+    using Range::volume_;
+    using Range::rank_;
+
+    Range::ordinal_type base_ = 0ul; ///< The offset of the first element
+
+    template <typename Extent, typename Stride>
+    void init(const unsigned int rank, const Extent* const extent_ptr,
+        const Stride* const stride_ptr, const ordinal_type base)
+    {
+      TA_ASSERT(rank);
+
+      // Initialize the strided range data members
+      data_ = allocate(rank);
+      offset_ = 0ul;
+      volume_ = 1ul;
+      rank_ = rank;
+      base_ = base;
+
+      // Construct temp pointers
+      auto* MADNESS_RESTRICT const lower  = data_;
+      auto* MADNESS_RESTRICT const upper  = lower + rank_;
+      auto* MADNESS_RESTRICT const extent = upper + rank_;
+      auto* MADNESS_RESTRICT const stride = extent + rank_;
+
+      // Compute range data
+      for(unsigned int i = 0u; i < rank_; ++i) {
+        const size_type extent_i = extent_ptr[i];
+        TA_ASSERT(extent_i > 0ul);
+
+        lower[i]  = 0ul;
+        upper[i]  = extent_i;
+        extent[i] = extent_i;
+        stride[i] = stride_ptr[i];
+        volume_  *= extent_i;
+      }
+    }
+
+    template <typename Index>
+    void init(const Range& range, const Index& lower_bound,
+        const Index& upper_bound, const Index& step)
+    {
+      TA_ASSERT(range.rank());
+      TA_ASSERT(detail::size(lower_bound) == range.rank());
+      TA_ASSERT(detail::size(upper_bound) == range.rank());
+      TA_ASSERT(detail::size(step) == range.rank());
+
+      const unsigned int rank = range.rank();
+      const auto* MADNESS_RESTRICT const range_stride = range.stride_data();
+      const auto* MADNESS_RESTRICT const lower_bound_ptr = detail::data(lower_bound);
+      const auto* MADNESS_RESTRICT const upper_bound_ptr = detail::data(upper_bound);
+      const auto* MADNESS_RESTRICT const step_ptr = detail::data(step);
+
+      std::vector<size_type> extent(rank), stride(rank);
+      size_type base = 0ul;
+      for(unsigned int i = 0u; i < rank; ++i) {
+        const size_type lower_bound_i = lower_bound_ptr[i];
+        const size_type upper_bound_i = upper_bound_ptr[i];
+        const size_type step_i = step_ptr[i];
+
+        // Check input dimensions
+        TA_ASSERT(lower_bound_i >= range.lobound(i));
+        TA_ASSERT(lower_bound_i < upper_bound_i);
+        TA_ASSERT(upper_bound_i <= range.upbound(i));
+        TA_ASSERT(step_i > 0ul);
+
+        extent[i] = (upper_bound_i - lower_bound_i + step_i - 1ul) / step_i;
+        stride[i] = range_stride[i] * step_i;
+        base     += lower_bound_i * range_stride[i];
+      }
+
+      init(rank, extent.data(), stride.data(), base - range.offset());
+    }
+
+  public:
+
+    // Compiler generated functions
+    StridedRange() = default;
+    StridedRange(const StridedRange&) = default;
+    StridedRange(StridedRange&&) = default;
+    ~StridedRange() = default;
+    StridedRange& operator=(const StridedRange&) = default;
+    StridedRange& operator=(StridedRange&&) = default;
+
+    /// Construct a strided range from its dimensions
+
+    /// \tparam Index An array type
+    /// \param extent The extent of each dimension
+    /// \param stride The distance between the offsets of consecutive
+    /// elements of each dimension
+    /// \param base The offset of the first element
+    template <typename Index,
+        typename std::enable_if<! std::is_integral<Index>::value>::type* = nullptr>
+    StridedRange(const Index& extent, const Index& stride,
+        const ordinal_type base) :
+      Range()
+    {
+      TA_ASSERT(detail::size(extent) == detail::size(stride));
+      init(detail::size(extent), detail::data(extent), detail::data(stride), base);
+    }
+
+    /// Construct a range that steps through a block of another range
+
+    /// Dimension \c i of the result references every <tt>step[i]</tt>-th
+    /// element of <tt>[lower_bound[i], upper_bound[i])</tt> in \c range .
+    /// \tparam Index An array type
+    /// \param range The range that is referenced
+    /// \param lower_bound The lower bound of the block
+    /// \param upper_bound The upper bound of the block
+    /// \param step The step of each dimension
+    template <typename Index>
+    StridedRange(const Range& range, const Index& lower_bound,
+        const Index& upper_bound, const Index& step) :
+      Range()
+    {
+      init(range, lower_bound, upper_bound, step);
+    }
+
+    StridedRange(const Range& range, const std::initializer_list<size_type>& lower_bound,
+        const std::initializer_list<size_type>& upper_bound,
+        const std::initializer_list<size_type>& step) :
+      Range()
+    {
+      init(range, lower_bound, upper_bound, step);
+    }
+
+    /// Offset of the first element accessor
+
+    /// \return The offset of the first element of this range in the data of
+    /// the range that it references
+    ordinal_type base() const { return base_; }
+
+    /// calculate the ordinal index of \c i
+
+    /// Convert a coordinate index to an ordinal index.
+    /// \tparam Index A coordinate index type (array type)
+    /// \param index The index to be converted to an ordinal index
+    /// \return The ordinal index of \c index
+    /// \throw When \c index is not included in this range.
+    template <typename Index,
+        typename std::enable_if<! std::is_integral<Index>::value>::type* = nullptr>
+    ordinal_type ordinal(const Index& index) const {
+      return Range::ordinal(index) + base_;
+    }
+
+    template <typename... Index,
+        typename std::enable_if<(sizeof...(Index) > 1ul)>::type* = nullptr>
+    ordinal_type ordinal(const Index&... index) const {
+      return Range::ordinal(index...) + base_;
+    }
+
+    /// calculate the offset of the ordinal index, \c index.
+
+    /// Convert an ordinal index of this range to the offset of the element in
+    /// the data of the range that it references.
+    /// \param index Ordinal index
+    /// \return The offset of the element \c index
+    /// \throw TiledArray::Exception When \c index is not included in this range
+    ordinal_type ordinal(ordinal_type index) const {
+      // Check that index is contained by range.
+      TA_ASSERT(includes(index));
+
+      ordinal_type result = 0ul;
+
+      // Get pointers to the data
+      const auto * MADNESS_RESTRICT const size = data_ + rank_ + rank_;
+      const auto * MADNESS_RESTRICT const stride = size + rank_;
+
+      // Compute the offset of index
+      for(int i = int(rank_) - 1; i >= 0; --i) {
+        const auto size_i = size[i];
+        const auto stride_i = stride[i];
+
+        result += (index % size_i) * stride_i;
+        index /= size_i;
+      }
+
+      return result + base_;
+    }
+
+    /// Resize of strided range is not supported
+    template <typename Index>
+    StridedRange& resize(const Index&, const Index&) {
+      // This function is here to shadow the base class resize function
+      TA_EXCEPTION("StridedRange::resize() is not supported");
+      return *this;
+    }
+
+    /// Shift the lower and upper bound of this range
+
+    /// \warning This function is here to shadow the base class inplace_shift
+    /// function, and disable it.
+    template <typename Index>
+    Range_& inplace_shift(const Index&) {
+      TA_EXCEPTION("StridedRange::inplace_shift() is not supported");
+      return *this;
+    }
+
+    /// Shift the lower and upper bound of this range
+
+    /// \warning This function is here to shadow the base class shift function,
+    /// and disable it.
+    template <typename Index>
+    Range_ shift(const Index&) {
+      TA_EXCEPTION("StridedRange::shift() is not supported");
+      return *this;
+    }
+
+    void swap(StridedRange& other) {
+      Range::swap(other);
+      std::swap(base_, other.base_);
+    }
+
+    /// Serialization strided range
+    template <typename Archive>
+    void serialize(const Archive& ar) const {
+      Range::serialize(ar);
+      ar & base_;
+    }
+  }; // StridedRange
+
+
+  /// Create a range that references the diagonal of another range
+
+  /// Element \c k of the result references the element
+  /// <tt>{ lobound[0] + k, lobound[1] + k, ... }</tt> of \c range .
+  /// \param range The range that is referenced
+  /// \return A rank-1 strided range with the extent of the smallest
+  /// dimension of \c range
+  inline StridedRange diagonal_range(const Range& range) {
+    TA_ASSERT(range.rank());
+
+    const auto* MADNESS_RESTRICT const lower = range.lobound_data();
+    const auto* MADNESS_RESTRICT const extent = range.extent_data();
+    const auto* MADNESS_RESTRICT const stride = range.stride_data();
+
+    Range::size_type n = extent[0], s = 0ul, base = 0ul;
+    for(unsigned int i = 0u; i < range.rank(); ++i) {
+      n = std::min(n, extent[i]);
+      s += stride[i];
+      base += lower[i] * stride[i];
+    }
+
+    return StridedRange(std::array<Range::size_type, 1>{{ n }},
+        std::array<Range::size_type, 1>{{ s }}, base - range.offset());
+  }
+
+  /// Create a range that references another range with one fixed index
+
+  /// \param range The range that is referenced, with a rank of at least two
+  /// \param dim The dimension that is fixed
+  /// \param index The coordinate index of dimension \c dim
+  /// \return A strided range with the other dimensions of \c range
+  inline StridedRange fixed_index_range(const Range& range,
+      const unsigned int dim, const Range::size_type index)
+  {
+    TA_ASSERT(range.rank() > 1u);
+    TA_ASSERT(dim < range.rank());
+    TA_ASSERT(index >= range.lobound(dim));
+    TA_ASSERT(index < range.upbound(dim));
+
+    const auto* MADNESS_RESTRICT const lower = range.lobound_data();
+    const auto* MADNESS_RESTRICT const range_extent = range.extent_data();
+    const auto* MADNESS_RESTRICT const range_stride = range.stride_data();
+
+    std::vector<Range::size_type> extent, stride;
+    extent.reserve(range.rank() - 1u);
+    stride.reserve(range.rank() - 1u);
+    Range::size_type base = index * range_stride[dim];
+    for(unsigned int i = 0u; i < range.rank(); ++i) {
+      if(i == dim)
+        continue;
+      extent.push_back(range_extent[i]);
+      stride.push_back(range_stride[i]);
+      base += lower[i] * range_stride[i];
+    }
+
+    return StridedRange(extent, stride, base - range.offset());
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_STRIDED_RANGE_H__INCLUDED
@@ -0,0 +1,188 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sub_world.h
+ *  May 15, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SUB_WORLD_H__INCLUDED
+#define TILEDARRAY_SUB_WORLD_H__INCLUDED
+
+#include <TiledArray/checkpoint.h>
+#include <TiledArray/dist_array.h>
+#include <TiledArray/error.h>
+#include <TiledArray/madness.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Split a world into disjoint sub-worlds
+
+  /// The processes of \c world that pass the same \c color form one
+  /// sub-world, where they are ordered by \c key and then by their rank in
+  /// \c world . Arrays can be created on a sub-world, and expressions of
+  /// sub-world arrays are evaluated by the processes of that sub-world only,
+  /// so independent expressions are evaluated concurrently on disjoint
+  /// sub-worlds, e.g.
+  /// \code
+  /// std::shared_ptr<World> sub = split_world(world, world.rank() % 2);
+  /// {
+  ///   auto popper = push_default_world(*sub);
+  ///   c("i,j") = a("i,k") * b("k,j"); // a, b, and c are arrays of *sub
+  /// }
+  /// \endcode
+  /// Arrays are moved between worlds with \c redistribute() . This function
+  /// is collective on \c world , and the sub-world is fenced before it is
+  /// destroyed, so all of its processes must release it.
+  /// \param world The world that is split
+  /// \param color The sub-world of this process, which must not be negative
+  /// \param key The order of this process in its sub-world
+  /// \return The sub-world of this process
+  inline std::shared_ptr<World>
+  split_world(World& world, const int color, const int key) {
+    TA_USER_ASSERT(color >= 0, "The color of a sub-world must not be negative.");
+    const SafeMPI::Intracomm comm = world.mpi.comm().Split(color, key);
+    return std::shared_ptr<World>(new World(comm),
+        [] (World* sub) { sub->gop.fence(); delete sub; });
+  }
+
+  /// Split a world into disjoint sub-worlds
+
+  /// The processes of each sub-world keep their order in \c world .
+  /// \param world The world that is split
+  /// \param color The sub-world of this process, which must not be negative
+  /// \return The sub-world of this process
+  inline std::shared_ptr<World> split_world(World& world, const int color) {
+    return split_world(world, color, world.rank());
+  }
+
+  namespace detail {
+
+    /// The rank in \c world of each process of a sub-world
+
+    /// This function is collective on \c world .
+    /// \param world The world that holds the sub-world
+    /// \param sub The sub-world of this process, or \c nullptr if this
+    /// process is not a member of the sub-world
+    /// \return The rank in \c world of each rank of the sub-world
+    inline std::vector<long> sub_world_ranks(World& world, const World* sub) {
+      std::vector<long> ranks(world.size(), -1l);
+      if(sub)
+        ranks[sub->rank()] = world.rank();
+      world.gop.max(ranks.data(), ranks.size());
+      while(ranks.back() < 0l)
+        ranks.pop_back();
+      return ranks;
+    }
+
+  } // namespace detail
+
+  /// Move an array to another world
+
+  /// The tiles of \c array are sent directly from their owners to their
+  /// owners in the result, which are given by the default process map of
+  /// \c target , with the active messages of \c world ; so moving an array
+  /// from the full world to a sub-world, or back, does not gather it. The
+  /// tiled range and the shape of \c array are broadcast from its first
+  /// process, since the processes that are not members of its world do not
+  /// hold it. This function is collective on \c world , which must hold
+  /// the worlds of \c array and of the result, e.g.
+  /// \code
+  /// TArrayD a_sub = redistribute(world, a, sub.get()); // world to sub-world
+  /// TArrayD a_full = redistribute(world, a_sub, &world); // and back
+  /// \endcode
+  /// \tparam Tile The array tile type
+  /// \tparam Policy The array policy type
+  /// \param world The world that holds the worlds of \c array and of the
+  /// result
+  /// \param array The array, which is not initialized on processes that
+  /// are not members of its world
+  /// \param target The world of the result, or \c nullptr on processes
+  /// that are not members of it
+  /// \return A copy of \c array on \c target , which is not initialized
+  /// when \c target is \c nullptr
+  template <typename Tile, typename Policy>
+  DistArray<Tile, Policy>
+  redistribute(World& world, const DistArray<Tile, Policy>& array, World* target) {
+    typedef DistArray<Tile, Policy> array_type;
+    typedef typename array_type::value_type value_type;
+    typedef typename array_type::shape_type shape_type;
+    typedef typename array_type::size_type size_type;
+
+    const std::vector<long> source_ranks =
+        detail::sub_world_ranks(world, (array.is_initialized() ? &array.world() : nullptr));
+    const std::vector<long> target_ranks = detail::sub_world_ranks(world, target);
+    TA_USER_ASSERT(! source_ranks.empty(), "The array is not initialized.");
+    TA_USER_ASSERT(! target_ranks.empty(), "The target world has no processes.");
+
+    // Broadcast the tiled range, the shape, and the owner of each tile
+    std::string meta;
+    if(world.rank() == source_ranks.front()) {
+      std::ostringstream os(std::ios::binary);
+      detail::checkpoint_write(os, array.trange());
+      detail::checkpoint_write(os, array.shape(), array.trange());
+      for(size_type i = 0ul; i < array.size(); ++i)
+        detail::checkpoint_write(os, source_ranks[array.owner(i)]);
+      meta = os.str();
+    }
+    world.gop.broadcast_serializable(meta, source_ranks.front());
+
+    // All processes read the same shape, so they agree on the zero tiles.
+    std::istringstream is(meta, std::ios::binary);
+    const TiledRange trange = detail::checkpoint_read_trange(is);
+    const shape_type shape = detail::checkpoint_read_shape(world, is, trange,
+        static_cast<const shape_type*>(nullptr));
+    const size_type volume = trange.tiles_range().volume();
+    std::vector<long> source_owners(volume);
+    for(long& owner : source_owners)
+      owner = detail::checkpoint_read(is);
+
+    array_type result;
+    std::vector<long> target_owners(volume);
+    if(target) {
+      result = array_type(*target, trange, shape);
+      for(size_type i = 0ul; i < volume; ++i)
+        target_owners[i] = target_ranks[result.owner(i)];
+    }
+    world.gop.broadcast_serializable(target_owners, target_ranks.front());
+
+    const madness::uniqueidT id = world.unique_obj_id();
+    const long me = world.rank();
+    for(size_type i = 0ul; i < volume; ++i) {
+      if(shape.is_zero(i))
+        continue;
+      const madness::DistributedID key(id, i);
+      if(source_owners[i] == me) {
+        if(target_owners[i] == me)
+          result.set(i, array.find(i));
+        else
+          world.gop.send(target_owners[i], key, array.find(i));
+      } else if(target_owners[i] == me) {
+        result.set(i, world.gop.template recv<value_type>(source_owners[i], key));
+      }
+    }
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SUB_WORLD_H__INCLUDED
@@ -0,0 +1,160 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  point_group.h
+ *  Mar 3, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SYMM_POINT_GROUP_H__INCLUDED
+#define TILEDARRAY_SYMM_POINT_GROUP_H__INCLUDED
+
+#include <TiledArray/sparse_shape.h>
+#include <TiledArray/tiled_range.h>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Construct a shape whose zero tiles are given exactly
+
+    /// The non-zero tiles have a normalized norm of 1, so they are only
+    /// screened by a zero threshold of 1 or larger.
+    /// \tparam T The norm type of the shape
+    /// \tparam Op The tile predicate type
+    /// \param trange The tiled range of the array
+    /// \param op A predicate that takes the index of a tile and returns
+    /// \c true if the tile is non-zero
+    /// \return The shape of the array
+    template <typename T, typename Op>
+    inline SparseShape<T> make_exact_shape(const TiledRange& trange, const Op& op) {
+      // The shape norms are set directly, since they are normalized norms
+      const auto& tiles_range = trange.tiles_range();
+      const SparseShape<T> shape(Tensor<T>(tiles_range, T(1)), trange);
+      return shape.transform([&] (const Tensor<T>& norms) {
+        Tensor<T> result(norms.range());
+        for(std::size_t i = 0ul; i < result.size(); ++i)
+          result[i] = (op(tiles_range.idx(i)) ? T(1) : T(0));
+        return result;
+      });
+    }
+
+  }  // namespace detail
+
+  namespace symmetry {
+
+    /// Product of the irreps of an abelian point group
+
+    /// The irreps of \f$ D_{2h} \f$ and its subgroups are labeled so that
+    /// the direct product of two irreps is the exclusive or of their labels,
+    /// e.g. the Cotton ordering; label 0 is the totally symmetric irrep.
+    /// \param a The label of the first irrep
+    /// \param b The label of the second irrep
+    /// \return The label of the direct product of \c a and \c b
+    inline unsigned int irrep_product(const unsigned int a, const unsigned int b) {
+      return a ^ b;
+    }
+
+    /// A tiled range whose tiles carry irrep labels
+
+    /// Every tile holds functions of a single irrep.
+    struct IrrepTiledRange1 {
+      TiledRange1 trange1; ///< The tiled range
+      std::vector<unsigned int> irreps; ///< The irrep label of each tile
+    }; // struct IrrepTiledRange1
+
+    /// Tile a dimension that is blocked by irrep
+
+    /// The elements of the dimension are ordered by irrep, and the elements
+    /// of each irrep are split into tiles with at most \c block_size
+    /// elements, so tiles never mix irreps. Irreps without elements have no
+    /// tiles.
+    /// \param irrep_sizes The number of elements of each irrep, indexed by
+    /// the irrep label
+    /// \param block_size The largest tile size
+    /// \return The tiled range and the irrep label of each tile
+    inline IrrepTiledRange1
+    make_irrep_trange1(const std::vector<std::size_t>& irrep_sizes,
+        const std::size_t block_size)
+    {
+      TA_USER_ASSERT(block_size > 0ul,
+          "make_irrep_trange1(): the block size must be positive.");
+      std::vector<std::size_t> boundaries(1, 0ul);
+      std::vector<unsigned int> irreps;
+      for(unsigned int irrep = 0u; irrep < irrep_sizes.size(); ++irrep) {
+        const std::size_t first = boundaries.back();
+        const std::size_t last = first + irrep_sizes[irrep];
+        if(first == last)
+          continue;
+        // Split the irrep into tiles of nearly equal size
+        const std::size_t tiles = (irrep_sizes[irrep] + block_size - 1ul) / block_size;
+        for(std::size_t t = 1ul; t <= tiles; ++t) {
+          boundaries.push_back(first + (irrep_sizes[irrep] * t) / tiles);
+          irreps.push_back(irrep);
+        }
+      }
+      TA_USER_ASSERT(! irreps.empty(),
+          "make_irrep_trange1(): the dimension must have at least one element.");
+      return IrrepTiledRange1{ TiledRange1(boundaries.begin(), boundaries.end()),
+          std::move(irreps) };
+    }
+
+    /// Construct the exact shape of an array with point-group symmetry
+
+    /// A tile is non-zero if, and only if, the product of the irreps of its
+    /// dimensions is \c irrep , so the shape has no threshold-dependent
+    /// error: symmetry-forbidden tiles are exactly zero and are never
+    /// allocated, communicated or contracted, and the other tiles have a
+    /// normalized norm of 1, so they are only screened by a zero threshold
+    /// of 1 or larger. The shapes of contractions of symmetric arrays are
+    /// also exact, since the product of two allowed tiles is allowed.
+    /// \tparam T The norm type of the shape
+    /// \param trange The tiled range of the array
+    /// \param tile_irreps The irrep label of each tile of each dimension
+    /// \param irrep The irrep of the array, e.g. 0 for totally symmetric
+    /// arrays
+    /// \return The shape of the array
+    /// \throw TiledArray::Exception When \c tile_irreps do not match
+    /// \c trange
+    template <typename T = float>
+    inline SparseShape<T>
+    make_irrep_shape(const TiledRange& trange,
+        const std::vector<std::vector<unsigned int> >& tile_irreps,
+        const unsigned int irrep = 0u)
+    {
+      const auto& tiles_range = trange.tiles_range();
+      const unsigned int rank = tiles_range.rank();
+      TA_USER_ASSERT(tile_irreps.size() == rank,
+          "make_irrep_shape(): an irrep list is required for each dimension.");
+      for(unsigned int d = 0u; d < rank; ++d)
+        TA_USER_ASSERT(tile_irreps[d].size() == trange.data()[d].tiles_range().second -
+            trange.data()[d].tiles_range().first,
+            "make_irrep_shape(): an irrep label is required for each tile.");
+
+      return detail::make_exact_shape<T>(trange, [&] (const Range::index& index) {
+        unsigned int product = 0u;
+        for(unsigned int d = 0u; d < rank; ++d)
+          product = irrep_product(product,
+              tile_irreps[d][index[d] - tiles_range.lobound_data()[d]]);
+        return product == irrep;
+      });
+    }
+
+  }  // namespace symmetry
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SYMM_POINT_GROUP_H__INCLUDED
@@ -0,0 +1,157 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  spin.h
+ *  Mar 3, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SYMM_SPIN_H__INCLUDED
+#define TILEDARRAY_SYMM_SPIN_H__INCLUDED
+
+#include <TiledArray/symm/point_group.h>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+  namespace symmetry {
+
+    /// Spin of the orbitals of a tile
+    enum class Spin {
+      alpha, ///< Spin up
+      beta   ///< Spin down
+    }; // enum class Spin
+
+    /// A spin-orbital tiled range
+
+    /// The tiles of the alpha orbitals are followed by the tiles of the beta
+    /// orbitals, so each spin case of an array is a contiguous block of
+    /// tiles.
+    struct SpinTiledRange1 {
+      TiledRange1 trange1; ///< The spin-orbital tiled range
+      std::size_t beta_tile; ///< The first tile of the beta orbitals
+
+      /// \param tile The tile index
+      /// \return The spin of \c tile
+      Spin spin(const std::size_t tile) const {
+        TA_ASSERT(tile >= trange1.tiles_range().first);
+        TA_ASSERT(tile < trange1.tiles_range().second);
+        return (tile < beta_tile ? Spin::alpha : Spin::beta);
+      }
+
+      /// \param spin The spin
+      /// \return The first and the last tile of \c spin
+      std::pair<std::size_t, std::size_t> tiles(const Spin spin) const {
+        return (spin == Spin::alpha ?
+            std::make_pair(trange1.tiles_range().first, beta_tile) :
+            std::make_pair(beta_tile, trange1.tiles_range().second));
+      }
+    }; // struct SpinTiledRange1
+
+    /// Construct a spin-orbital tiled range
+
+    /// \param alpha The tiled range of the alpha orbitals
+    /// \param beta The tiled range of the beta orbitals
+    /// \return The tiled range of the alpha orbitals followed by the beta
+    /// orbitals, with the tiling of \c alpha and \c beta
+    inline SpinTiledRange1 make_spin_trange1(const TiledRange1& alpha,
+        const TiledRange1& beta)
+    {
+      std::vector<std::size_t> boundaries;
+      for(std::size_t t = alpha.tiles_range().first; t < alpha.tiles_range().second; ++t)
+        boundaries.push_back(alpha.tile(t).first - alpha.elements_range().first);
+      const std::size_t offset = alpha.elements_range().second -
+          alpha.elements_range().first;
+      for(std::size_t t = beta.tiles_range().first; t <= beta.tiles_range().second; ++t)
+        boundaries.push_back(offset + (t < beta.tiles_range().second ?
+            beta.tile(t).first : beta.elements_range().second) -
+            beta.elements_range().first);
+      return SpinTiledRange1{ TiledRange1(boundaries.begin(), boundaries.end()),
+          alpha.tiles_range().second - alpha.tiles_range().first };
+    }
+
+    /// Construct the exact shape of a spin-conserving array
+
+    /// The first \c bra_rank dimensions of the array are the bra indices
+    /// and the others are the ket indices. A tile is non-zero if, and only
+    /// if, its bra and ket spins differ by \c sz2 alpha orbitals, e.g. the
+    /// (alpha alpha|alpha alpha), (alpha beta|alpha beta) and (alpha
+    /// beta|beta alpha) blocks of a two-electron quantity, so that a single
+    /// spin-orbital array holds all spin cases. Contractions of spin-orbital
+    /// arrays over a spin-orbital index sum over the spin cases in a single
+    /// expression, and the spin-forbidden tiles are exactly zero, so they
+    /// are never allocated, communicated or contracted. A spin case may be
+    /// used in expressions without a copy with a block expression, e.g.
+    /// <tt>t("a,b,i,j").block(lower, upper)</tt> , with the bounds given by
+    /// \c spin_block() .
+    /// \tparam T The norm type of the shape
+    /// \param trange The tiled range of the array
+    /// \param dims The spin-orbital tiled range of each dimension of the
+    /// array
+    /// \param bra_rank The number of bra dimensions
+    /// \param sz2 The number of alpha orbitals of the bra minus the number of
+    /// alpha orbitals of the ket
+    /// \return The shape of the array
+    template <typename T = float>
+    inline SparseShape<T>
+    make_spin_shape(const TiledRange& trange,
+        const std::vector<SpinTiledRange1>& dims, const unsigned int bra_rank,
+        const int sz2 = 0)
+    {
+      const unsigned int rank = trange.tiles_range().rank();
+      TA_USER_ASSERT(dims.size() == rank,
+          "make_spin_shape(): a spin tiled range is required for each dimension.");
+      TA_USER_ASSERT(bra_rank <= rank,
+          "make_spin_shape(): the bra rank is larger than the array rank.");
+      for(unsigned int d = 0u; d < rank; ++d)
+        TA_USER_ASSERT(dims[d].trange1 == trange.data()[d],
+            "make_spin_shape(): the spin tiled ranges do not match the array.");
+
+      return detail::make_exact_shape<T>(trange, [&] (const Range::index& index) {
+        int alpha = 0;
+        for(unsigned int d = 0u; d < rank; ++d)
+          if(dims[d].spin(index[d]) == Spin::alpha)
+            alpha += (d < bra_rank ? 1 : -1);
+        return alpha == sz2;
+      });
+    }
+
+    /// Tile bounds of a spin case
+
+    /// \param dims The spin-orbital tiled range of each dimension
+    /// \param spins The spin of each dimension
+    /// \return The lower and upper tile bounds of the block of \c spins ,
+    /// which may be given to a block expression
+    inline std::pair<std::vector<std::size_t>, std::vector<std::size_t> >
+    spin_block(const std::vector<SpinTiledRange1>& dims,
+        const std::vector<Spin>& spins)
+    {
+      TA_USER_ASSERT(dims.size() == spins.size(),
+          "spin_block(): a spin is required for each dimension.");
+      std::pair<std::vector<std::size_t>, std::vector<std::size_t> > result;
+      for(std::size_t d = 0ul; d < dims.size(); ++d) {
+        const std::pair<std::size_t, std::size_t> tiles = dims[d].tiles(spins[d]);
+        result.first.push_back(tiles.first);
+        result.second.push_back(tiles.second);
+      }
+      return result;
+    }
+
+  }  // namespace symmetry
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SYMM_SPIN_H__INCLUDED
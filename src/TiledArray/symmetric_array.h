@@ -0,0 +1,304 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  symmetric_array.h
+ *  Mar 2, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_SYMMETRIC_ARRAY_H__INCLUDED
+#define TILEDARRAY_SYMMETRIC_ARRAY_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/policies/sparse_policy.h>
+#include <TiledArray/symm/permutation_group.h>
+#include <TiledArray/symm/representation.h>
+#include <TiledArray/tile_op/tile_interface.h>
+#include <vector>
+
+namespace TiledArray {
+  namespace symmetry {
+
+    /// Parity of a permutation
+
+    /// \param p The permutation
+    /// \return \c 1 if \c p is an even permutation, or \c -1 if it is odd
+    inline int parity(const Permutation& p) {
+      unsigned int transpositions = 0u;
+      for(const auto& cycle : p.cycles())
+        transpositions += cycle.size() - 1u;
+      return ((transpositions & 1u) ? -1 : 1);
+    }
+
+  }  // namespace symmetry
+
+  /// A distributed array that stores the unique tiles of a symmetric array
+
+  /// The elements of the array are symmetric under the action of a
+  /// permutation group, \f$ A_{x_{p(0)} x_{p(1)} \dots} = f(p) A_{x_0 x_1
+  /// \dots} \f$ for each element \f$ p \f$ of the group, where \f$ f(p) \f$
+  /// is \c 1 for symmetric arrays, the parity of \f$ p \f$ for
+  /// antisymmetric arrays, or the factor given by a representation of the
+  /// group. Only the tile whose index is lexicographically smallest in its
+  /// orbit under the group is stored, and the other tiles of the orbit are
+  /// zero in the shape of the stored array; they are reconstructed by
+  /// permuting and scaling the stored tile when they are accessed. The
+  /// tiling of the permuted dimensions must be identical.
+  /// \tparam Tile The tile type
+  template <typename Tile>
+  class SymmetricArray {
+  public:
+    typedef SymmetricArray<Tile> SymmetricArray_; ///< This object type
+    typedef DistArray<Tile, SparsePolicy> array_type; ///< The array type
+    typedef typename array_type::value_type value_type; ///< Tile type
+    typedef typename array_type::scalar_type scalar_type; ///< The tile scalar type
+    typedef typename array_type::size_type size_type; ///< Size type
+    typedef symmetry::PermutationGroup group_type; ///< The symmetry group type
+
+  private:
+
+    /// A group element and the action on tiles
+    struct Element {
+      symmetry::Permutation symm_perm; ///< The group element
+      Permutation perm; ///< The tile permutation
+      scalar_type factor; ///< The scaling factor of the permuted tiles
+      bool identity; ///< \c true if the element does not change tiles
+    }; // struct Element
+
+    array_type array_; ///< The unique tiles
+    std::vector<Element> elements_; ///< The group elements
+
+    /// Initialize the group elements
+
+    /// \param element_factors The group elements and their factors
+    void init(const std::vector<std::pair<symmetry::Permutation, scalar_type> >& element_factors) {
+      const unsigned int rank = array_.trange().tiles_range().rank();
+      for(const auto& element : element_factors) {
+        std::vector<unsigned int> perm(rank);
+        bool identity = (element.second == scalar_type(1));
+        for(unsigned int d = 0u; d < rank; ++d) {
+          perm[d] = element.first[d];
+          identity = identity && (perm[d] == d);
+          TA_USER_ASSERT(perm[d] < rank,
+              "SymmetricArray: the group acts on dimensions outside the array.");
+          TA_USER_ASSERT(array_.trange().data()[d] == array_.trange().data()[perm[d]],
+              "SymmetricArray: the permuted dimensions must have the same tiling.");
+        }
+        // Tile index = p * stored index, so the factor of the tile is the
+        // factor of the inverse element
+        elements_.push_back(Element{ element.first, Permutation(std::move(perm)),
+            scalar_type(1) / element.second, identity });
+      }
+    }
+
+    /// The stored tile of an orbit
+
+    /// \param index The tile index
+    /// \return The ordinal of the stored tile of the orbit of \c index and
+    /// the element that maps the stored tile to tile \c index
+    template <typename Index>
+    std::pair<size_type, const Element*> canonical(const Index& index) const {
+      const unsigned int rank = array_.trange().tiles_range().rank();
+      TA_ASSERT(rank == index.size());
+      std::vector<std::size_t> result(index.begin(), index.end());
+      std::vector<std::size_t> candidate(rank);
+      const Element* result_element = nullptr;
+      for(const Element& element : elements_) {
+        for(unsigned int d = 0u; d < rank; ++d)
+          candidate[d] = index[element.symm_perm[d]];
+        if((result_element == nullptr) || (candidate < result)) {
+          result.swap(candidate);
+          result_element = & element;
+        }
+      }
+      return std::make_pair(array_.trange().tiles_range().ordinal(result),
+          result_element);
+    }
+
+    /// Construct a tile of an orbit from the stored tile
+
+    /// \param tile The stored tile
+    /// \param perm The tile permutation
+    /// \param factor The scaling factor
+    /// \return The permuted and scaled tile
+    static value_type make_tile(const value_type& tile, const Permutation& perm,
+        const scalar_type factor)
+    {
+      return (factor == scalar_type(1) ? permute(tile, perm) :
+          scale(tile, factor, perm));
+    }
+
+  public:
+
+    /// Construct a symmetric array from its unique tiles
+
+    /// \param array An array that holds the unique tiles; the other tiles
+    /// are ignored
+    /// \param group The symmetry group of the array
+    /// \param antisymmetric If \c true , the array is antisymmetric under the
+    /// odd permutations of \c group , otherwise it is symmetric.
+    /// \throw TiledArray::Exception When the tiling of the array is not
+    /// symmetric under \c group
+    SymmetricArray(const array_type& array, const group_type& group,
+        const bool antisymmetric = false) :
+      array_(array), elements_()
+    {
+      std::vector<std::pair<symmetry::Permutation, scalar_type> > element_factors;
+      for(const auto& p : group)
+        element_factors.emplace_back(p, (antisymmetric ?
+            scalar_type(symmetry::parity(p)) : scalar_type(1)));
+      init(element_factors);
+    }
+
+    /// Construct a symmetric array from its unique tiles
+
+    /// \tparam Scalar The representative type, which must be convertible to
+    /// \c scalar_type
+    /// \param array An array that holds the unique tiles; the other tiles
+    /// are ignored
+    /// \param representation The factors of the elements of the symmetry
+    /// group
+    /// \throw TiledArray::Exception When the tiling of the array is not
+    /// symmetric under the group
+    template <typename Scalar>
+    SymmetricArray(const array_type& array,
+        const symmetry::Representation<group_type, Scalar>& representation) :
+      array_(array), elements_()
+    {
+      std::vector<std::pair<symmetry::Permutation, scalar_type> > element_factors;
+      for(const auto& rep : representation.representatives())
+        element_factors.emplace_back(rep.first, scalar_type(rep.second));
+      init(element_factors);
+    }
+
+    SymmetricArray(const SymmetricArray_&) = default;
+    SymmetricArray(SymmetricArray_&&) = default;
+    SymmetricArray_& operator=(const SymmetricArray_&) = default;
+    SymmetricArray_& operator=(SymmetricArray_&&) = default;
+
+    /// \return The array of the unique tiles
+    const array_type& unique() const { return array_; }
+
+    /// \return The world of the array
+    World& world() const { return array_.world(); }
+
+    /// \return The tiled range of the array
+    const TiledRange& trange() const { return array_.trange(); }
+
+    /// Stored tile check
+
+    /// \tparam Index The tile index type
+    /// \param index The tile index
+    /// \return \c true if tile \c index is stored, i.e. it is the
+    /// lexicographically smallest tile of its orbit
+    template <typename Index>
+    bool is_unique(const Index& index) const {
+      return canonical(index).first == trange().tiles_range().ordinal(index);
+    }
+
+    /// Zero tile check
+
+    /// \tparam Index The tile index type
+    /// \param index The tile index
+    /// \return \c true if tile \c index is zero
+    template <typename Index>
+    bool is_zero(const Index& index) const {
+      return array_.is_zero(canonical(index).first);
+    }
+
+    /// Find a tile
+
+    /// Tiles that are not stored are constructed from the stored tile of
+    /// their orbit, which may be remote.
+    /// \tparam Index The tile index type
+    /// \param index The tile index
+    /// \return A future to tile \c index
+    /// \throw TiledArray::Exception When tile \c index is zero
+    template <typename Index>
+    Future<value_type> find(const Index& index) const {
+      const std::pair<size_type, const Element*> orbit = canonical(index);
+      Future<value_type> tile = array_.find(orbit.first);
+      const Element& element = *orbit.second;
+      if(element.identity)
+        return tile;
+      return world().taskq.add(& SymmetricArray_::make_tile, tile, element.perm,
+          element.factor);
+    }
+
+    /// Construct an array that holds all tiles
+
+    /// The full array may be used in expressions. This function is
+    /// collective.
+    /// \return An array that holds every tile of the symmetric array
+    array_type expand() const {
+      const auto& tiles_range = trange().tiles_range();
+      typedef typename array_type::shape_type shape_type;
+      const shape_type shape = array_.shape().transform(
+          [&] (const Tensor<typename shape_type::value_type>& norms) {
+            Tensor<typename shape_type::value_type> result(norms.range());
+            for(size_type i = 0ul; i < result.size(); ++i)
+              result[i] = norms[canonical(tiles_range.idx(i)).first];
+            return result;
+          });
+
+      array_type result(world(), trange(), shape);
+      for(const size_type i : *result.pmap())
+        if(! result.is_zero(i))
+          result.set(i, find(tiles_range.idx(i)));
+      return result;
+    }
+
+  }; // class SymmetricArray
+
+  /// Construct a symmetric array from an array that holds all tiles
+
+  /// The tiles that are not lexicographically smallest in their orbit under
+  /// \c group are dropped; the stored tiles are shared with \c array . This
+  /// function is collective.
+  /// \tparam Tile The tile type
+  /// \param array The symmetric array with all tiles
+  /// \param group The symmetry group of the array
+  /// \param antisymmetric If \c true , the array is antisymmetric under the
+  /// odd permutations of \c group , otherwise it is symmetric.
+  /// \return A symmetric array that stores the unique tiles of \c array
+  template <typename Tile>
+  inline SymmetricArray<Tile>
+  make_symmetric_array(const DistArray<Tile, SparsePolicy>& array,
+      const symmetry::PermutationGroup& group, const bool antisymmetric = false)
+  {
+    typedef DistArray<Tile, SparsePolicy> array_type;
+    typedef typename array_type::shape_type shape_type;
+    const auto& tiles_range = array.trange().tiles_range();
+    const shape_type shape = array.shape().transform(
+        [&] (const Tensor<typename shape_type::value_type>& norms) {
+          Tensor<typename shape_type::value_type> result = norms.clone();
+          for(std::size_t i = 0ul; i < result.size(); ++i)
+            if(! symmetry::is_lexicographically_smallest(tiles_range.idx(i), group))
+              result[i] = 0;
+          return result;
+        });
+
+    array_type unique(array.world(), array.trange(), shape);
+    for(const std::size_t i : *unique.pmap())
+      if(! unique.is_zero(i))
+        unique.set(i, array.find(i));
+    return SymmetricArray<Tile>(unique, group, antisymmetric);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SYMMETRIC_ARRAY_H__INCLUDED
@@ -0,0 +1,210 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  task_trace.cpp
+ *  Mar 15, 2017
+ *
+ */
+
+#include <TiledArray/task_trace.h>
+#include <TiledArray/madness.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace TiledArray {
+  namespace {
+
+    /// A task event
+    struct TaskEvent {
+      const char* name; ///< The event name
+      double begin; ///< The wall time at the beginning of the event
+      double end; ///< The wall time at the end of the event
+      std::size_t index; ///< The tile or step index
+    }; // struct TaskEvent
+
+    /// The events of one thread
+    struct ThreadEvents {
+      std::size_t thread; ///< The thread number, in order of the first event
+      std::vector<TaskEvent> events; ///< The events, in order of their end
+    }; // struct ThreadEvents
+
+    /// The event buffers of all threads of this process
+    class TaskTrace {
+      std::mutex lock_; ///< Protects the buffer list
+      std::vector<std::unique_ptr<ThreadEvents> > threads_; ///< Thread buffers
+
+    public:
+
+      /// \return The event buffer of the calling thread
+      ThreadEvents& local() {
+        static thread_local ThreadEvents* events = nullptr;
+        if(! events) {
+          std::lock_guard<std::mutex> guard(lock_);
+          threads_.emplace_back(new ThreadEvents{ threads_.size(), {} });
+          events = threads_.back().get();
+        }
+        return *events;
+      }
+
+      void clear() {
+        std::lock_guard<std::mutex> guard(lock_);
+        for(auto& thread : threads_)
+          thread->events.clear();
+      }
+
+      std::size_t size() {
+        std::lock_guard<std::mutex> guard(lock_);
+        std::size_t n = 0ul;
+        for(const auto& thread : threads_)
+          n += thread->events.size();
+        return n;
+      }
+
+      /// \return The earliest event time, or the largest double if there
+      /// are no events
+      double first() {
+        std::lock_guard<std::mutex> guard(lock_);
+        double time = std::numeric_limits<double>::max();
+        for(const auto& thread : threads_)
+          for(const TaskEvent& event : thread->events)
+            time = std::min(time, event.begin);
+        return time;
+      }
+
+      /// Write the events as Chrome trace events
+
+      /// \param os The output stream
+      /// \param rank The rank of this process
+      /// \param shift The offset that maps wall times to trace times, in s
+      void write(std::ostream& os, const ProcessID rank, const double shift) {
+        std::lock_guard<std::mutex> guard(lock_);
+        os.precision(3);
+        os << std::fixed;
+        for(const auto& thread : threads_) {
+          for(const TaskEvent& event : thread->events) {
+            os << ",\n{\"name\":\"" << event.name
+               << "\",\"cat\":\"TiledArray\",\"ph\":\"X\",\"ts\":"
+               << (event.begin + shift) * 1.0e6
+               << ",\"dur\":" << (event.end - event.begin) * 1.0e6
+               << ",\"pid\":" << rank << ",\"tid\":" << thread->thread
+               << ",\"args\":{\"index\":" << event.index << "}}";
+          }
+        }
+      }
+    }; // class TaskTrace
+
+    TaskTrace& task_trace() {
+      static TaskTrace trace;
+      return trace;
+    }
+
+    /// \return The trace file name given by \c TA_TASK_TRACE , or an empty
+    /// string
+    std::string task_trace_file() {
+      const char* file = getenv("TA_TASK_TRACE");
+      return (file ? std::string(file) : std::string());
+    }
+
+  }  // namespace
+
+  void task_trace_enable(const bool flag) {
+    detail::task_trace_flag() = flag;
+  }
+
+  void task_trace_clear() { task_trace().clear(); }
+
+  std::size_t task_trace_size() { return task_trace().size(); }
+
+  void write_task_trace(World& world, const std::string& filename) {
+    // Align the clocks of all processes at a fence, and shift the trace
+    // times so the earliest event of any process is at zero.
+    world.gop.fence();
+    const double now = madness::wall_time();
+    const double first = task_trace().first();
+    double lead = (first < now ? now - first : 0.0);
+    world.gop.max(lead);
+    const double shift = lead - now;
+
+    std::stringstream ss;
+    task_trace().write(ss, world.rank(), shift);
+    std::string events = ss.str();
+
+    // Gather the events of all processes on process 0
+    std::vector<unsigned long> sizes(world.size(), 0ul);
+    sizes[world.rank()] = events.size();
+    world.gop.sum(sizes.data(), sizes.size());
+    const int tag = world.mpi.unique_tag();
+    if(world.rank() == 0) {
+      std::vector<std::string> buffers(world.size());
+      std::vector<SafeMPI::Request> requests;
+      for(ProcessID p = 1; p < world.size(); ++p) {
+        if(sizes[p] == 0ul)
+          continue;
+        buffers[p].resize(sizes[p]);
+        requests.push_back(world.mpi.Irecv(& buffers[p][0], sizes[p],
+            MPI_BYTE, p, tag));
+      }
+      for(SafeMPI::Request& request : requests)
+        World::await(request);
+      buffers[0].swap(events);
+
+      std::ofstream file(filename);
+      TA_USER_ASSERT(file, "write_task_trace: the trace file could not be opened.");
+      file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+           << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"rank 0\"}}";
+      for(ProcessID p = 1; p < world.size(); ++p)
+        file << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << p
+             << ",\"args\":{\"name\":\"rank " << p << "\"}}";
+      for(const std::string& buffer : buffers)
+        file << buffer;
+      file << "\n]}\n";
+    } else if(! events.empty()) {
+      SafeMPI::Request request =
+          world.mpi.Isend(& events[0], events.size(), MPI_BYTE, 0, tag);
+      World::await(request);
+    }
+  }
+
+  namespace detail {
+
+    std::atomic<bool>& task_trace_flag() {
+      static std::atomic<bool> flag(! task_trace_file().empty());
+      return flag;
+    }
+
+    void task_trace_record(const char* name, const double begin,
+        const double end, const std::size_t index)
+    {
+      task_trace().local().events.push_back(TaskEvent{ name, begin, end, index });
+    }
+
+    double task_trace_time() { return madness::wall_time(); }
+
+    void task_trace_finalize(World& world) {
+      const std::string file = task_trace_file();
+      if(! file.empty())
+        write_task_trace(world, file);
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
@@ -0,0 +1,147 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  task_trace.h
+ *  Mar 15, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TASK_TRACE_H__INCLUDED
+#define TILEDARRAY_TASK_TRACE_H__INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace madness {
+  class World;
+} // namespace madness
+
+namespace TiledArray {
+
+  /// Task timeline tracing
+
+  /// When tracing is enabled, the tasks spawned by TiledArray record the
+  /// begin and end of their execution, with the thread that ran them: tile
+  /// evaluations, SUMMA steps, tile broadcasts, and reductions. The events
+  /// are held in per-thread buffers and exported with
+  /// \c write_task_trace() in the Chrome trace event format, which can be
+  /// viewed with \c chrome://tracing or Perfetto. Tracing is disabled by
+  /// default; it is enabled when the \c TA_TASK_TRACE environment variable
+  /// is set to a file name, in which case \c TiledArray::finalize() writes
+  /// the trace to that file, or by calling \c task_trace_enable(). A
+  /// disabled tracer costs one relaxed atomic load per task.
+  /// \return \c true if task tracing is enabled
+  inline bool task_trace_enabled();
+
+  /// Enable or disable task tracing
+
+  /// \param flag The new tracing flag
+  void task_trace_enable(const bool flag = true);
+
+  /// Remove all recorded events of this process
+
+  /// \note This must not be called while traced tasks are running.
+  void task_trace_clear();
+
+  /// Number of recorded events
+
+  /// \return The number of events recorded by this process
+  std::size_t task_trace_size();
+
+  /// Write the task timeline of all processes
+
+  /// The events of all processes are gathered by process 0, which writes a
+  /// Chrome trace JSON file with one process per rank and one thread per
+  /// worker thread. The clocks of the processes are aligned at a fence in
+  /// this function. This function is collective, and no traced tasks may
+  /// be running, e.g. it should be called after a fence.
+  /// \param world The world whose processes are traced
+  /// \param filename The name of the output file
+  void write_task_trace(madness::World& world, const std::string& filename);
+
+  namespace detail {
+
+    /// Task tracing flag
+
+    /// The flag is initialized with the \c TA_TASK_TRACE environment
+    /// variable.
+    /// \return A reference to the tracing flag
+    std::atomic<bool>& task_trace_flag();
+
+    /// Record a task event on this thread
+
+    /// \param name The event name, which must be a string literal
+    /// \param begin The wall time at the beginning of the event
+    /// \param end The wall time at the end of the event
+    /// \param index The tile or step index of the event
+    void task_trace_record(const char* name, const double begin,
+        const double end, const std::size_t index);
+
+    /// \return The wall time used for task events
+    double task_trace_time();
+
+    /// Write the trace to the file named by \c TA_TASK_TRACE , if set
+
+    /// \param world The world whose processes are traced
+    void task_trace_finalize(madness::World& world);
+
+    /// Scoped task event
+
+    /// The event starts at construction and is recorded at destruction, if
+    /// tracing was enabled at construction, e.g.
+    /// \code
+    /// void eval_tile(const size_type i, ...) {
+    ///   TiledArray::detail::TaskTraceScope trace("unary_eval", i);
+    ///   ...
+    /// }
+    /// \endcode
+    class TaskTraceScope {
+      const char* name_; ///< The event name, or \c nullptr when not tracing
+      double begin_; ///< The wall time at the beginning of the event
+      std::size_t index_; ///< The tile or step index
+
+    public:
+
+      /// Constructor
+
+      /// \param name The event name, which must be a string literal
+      /// \param index The tile or step index of the event [ default = 0 ]
+      explicit TaskTraceScope(const char* name, const std::size_t index = 0ul) :
+        name_(task_trace_enabled() ? name : nullptr),
+        begin_(name_ ? task_trace_time() : 0.0), index_(index)
+      { }
+
+      TaskTraceScope(const TaskTraceScope&) = delete;
+      TaskTraceScope& operator=(const TaskTraceScope&) = delete;
+
+      ~TaskTraceScope() {
+        if(name_)
+          task_trace_record(name_, begin_, task_trace_time(), index_);
+      }
+    }; // class TaskTraceScope
+
+  }  // namespace detail
+
+  inline bool task_trace_enabled() {
+    static std::atomic<bool>& flag = detail::task_trace_flag();
+    return flag.load(std::memory_order_relaxed);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TASK_TRACE_H__INCLUDED
@@ -31,7 +31,9 @@
 #include <TiledArray/tensor/tensor_interface.h>
 #include <TiledArray/tensor/shift_wrapper.h>
 #include <TiledArray/tensor/operators.h>
+#include <TiledArray/tensor/tensor_of_tensor.h>
 #include <TiledArray/block_range.h>
+#include <TiledArray/strided_range.h>
 
 namespace TiledArray {
 
@@ -45,6 +47,14 @@ namespace TiledArray {
   using TensorConstView =
       detail::TensorInterface<typename std::add_const<T>::type, BlockRange>;
 
+  template <typename T>
+  using TensorStridedView =
+      detail::TensorInterface<T, StridedRange>;
+
+  template <typename T>
+  using TensorConstStridedView =
+      detail::TensorInterface<typename std::add_const<T>::type, StridedRange>;
+
 
   /// Tensor output operator
 
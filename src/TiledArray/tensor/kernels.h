@@ -29,6 +29,9 @@
 #include <TiledArray/tensor/utility.h>
 #include <TiledArray/tensor/permute.h>
 #include <TiledArray/math/eigen.h>
+#include <TiledArray/math/parallel_for.h>
+#include <TiledArray/math/simd_vector_op.h>
+#include <memory>
 
 namespace TiledArray {
 
@@ -36,6 +39,151 @@ namespace TiledArray {
 
   namespace detail {
 
+    // -------------------------------------------------------------------------
+    // Element operations with vector kernels
+
+    /// Test for Tensor objects with elements of type \c T
+    template <typename T, typename...Ts>
+    struct is_simd_tensor : public std::false_type { };
+
+    template <typename T, typename A, typename...Ts>
+    struct is_simd_tensor<T, Tensor<T, A>, Ts...> :
+        public std::integral_constant<bool, sizeof...(Ts) == 0ul
+            || is_simd_tensor<T, Ts...>::value> { };
+
+    /// Test for element operations that are applied with a vector kernel
+
+    /// This is \c true when \c Op is one of the element operations of
+    /// math/simd_vector_op.h that has a vector kernel, and all tensors \c Ts
+    /// are Tensor objects with elements of the operation element type.
+    /// \tparam Op The element operation type
+    /// \tparam Ts The tensor types
+    template <typename Op, typename... Ts>
+    struct is_simd_tensor_op {
+      typedef typename std::decay<Op>::type op_type;
+      static constexpr bool value = math::detail::is_simd_op<op_type>::value
+          && is_simd_tensor<typename math::detail::simd_op_traits<op_type>::value_type,
+              Ts...>::value;
+    };
+
+
+    // -------------------------------------------------------------------------
+    // Packed tensors of tensors
+
+    /// \return The first tensor of \c tensors
+    template <typename T1, typename... Ts>
+    inline const T1& first_tensor(const T1& tensor1, const Ts&...) { return tensor1; }
+
+    /// \return \c true if \c tensor is not empty and none of its inner
+    /// tensors are empty, so it may be the layout of a packed tensor
+    template <typename T>
+    inline bool is_packable(const T& tensor) {
+      const auto volume = tensor.range().volume();
+      if(volume == 0ul)
+        return false;
+      for(decltype(tensor.range().volume()) i = 0ul; i < volume; ++i)
+        if(tensor.data()[i].empty())
+          return false;
+      return true;
+    }
+
+    /// \return The number of inner elements of \c tensor
+    template <typename T>
+    inline std::size_t inner_size_sum(const T& tensor) {
+      std::size_t size = 0ul;
+      const auto volume = tensor.range().volume();
+      for(decltype(tensor.range().volume()) i = 0ul; i < volume; ++i)
+        size += tensor.data()[i].range().volume();
+      return size;
+    }
+
+    /// Test for the inner tensors of a tensor of tensors that are packed
+
+    /// The inner tensors of \c tensor are packed like those of \c layout
+    /// when they are not empty, they have the ranges of the inner tensors
+    /// of \c layout , and they are stored back to back, so that the inner
+    /// elements of \c tensor form a single contiguous array.
+    /// \tparam T1 The layout tensor type
+    /// \tparam T2 The tensor type
+    /// \param layout A tensor of tensors with the inner ranges
+    /// \param tensor A tensor of tensors with the outer range of \c layout
+    /// \return \c true if the inner tensors of \c tensor are packed like
+    /// those of \c layout
+    template <typename T1, typename T2>
+    inline bool is_packed_like(const T1& layout, const T2& tensor) {
+      const auto volume = layout.range().volume();
+      if((volume == 0ul) || tensor.data()[0].empty())
+        return false;
+      auto next = tensor.data()[0].data();
+      for(decltype(layout.range().volume()) i = 0ul; i < volume; ++i) {
+        const auto& inner = tensor.data()[i];
+        if(inner.empty() || (inner.data() != next) ||
+            ! (inner.range() == layout.data()[i].range()))
+          return false;
+        next += inner.range().volume();
+      }
+      return true;
+    }
+
+    template <typename T1>
+    inline constexpr bool is_packed_set(const T1&) { return true; }
+
+    /// Test for tensors of tensors that are packed like \c layout
+
+    /// \return \c true if the inner tensors of all \c tensors are packed like
+    /// those of \c layout
+    template <typename T1, typename T2, typename... Ts>
+    inline bool is_packed_set(const T1& layout, const T2& tensor,
+        const Ts&... tensors)
+    {
+      return is_packed_like(layout, tensor) && is_packed_set(layout, tensors...);
+    }
+
+    /// A tensor that views the inner elements of a packed tensor of tensors
+
+    /// \tparam T The tensor of tensors type
+    /// \param tensor A tensor of tensors whose inner tensors are packed
+    /// \param size The number of inner elements of \c tensor
+    /// \return A rank-1 tensor of \c size elements that uses the inner
+    /// elements of \c tensor
+    template <typename T>
+    inline typename T::value_type packed_view(const T& tensor, const std::size_t size) {
+      typedef typename T::value_type inner_type;
+      // The view does not own the elements, which stay alive with the inner
+      // tensors of tensor. Arguments are only read through the view.
+      typename inner_type::pointer const data =
+          const_cast<typename inner_type::pointer>(tensor.data()[0].data());
+      return inner_type(typename inner_type::range_type(size), data,
+          std::shared_ptr<void>(std::shared_ptr<void>(), data));
+    }
+
+    /// Construct the inner tensors of a tensor of tensors in one buffer
+
+    /// The inner tensors of \c result are views of a single buffer, so they
+    /// are stored back to back and cost one allocation for all inner
+    /// tensors. The inner elements are not initialized.
+    /// \pre The memory of \c result has been allocated but not initialized.
+    /// \tparam TR The result tensor type
+    /// \tparam T1 The layout tensor type
+    /// \param[out] result The result tensor
+    /// \param[in] layout A tensor of tensors with the inner ranges of
+    /// \c result
+    /// \return The buffer that holds the inner elements of \c result
+    template <typename TR, typename T1>
+    inline typename TR::value_type make_packed(TR& result, const T1& layout) {
+      typedef typename TR::value_type inner_type;
+      const auto volume = result.range().volume();
+      auto buffer = std::make_shared<inner_type>(
+          typename inner_type::range_type(inner_size_sum(layout)));
+      auto data = buffer->data();
+      for(decltype(result.range().volume()) i = 0ul; i < volume; ++i) {
+        const auto& range = layout.data()[i].range();
+        new(result.data() + i) inner_type(range, data, buffer);
+        data += range.volume();
+      }
+      return *buffer;
+    }
+
     // -------------------------------------------------------------------------
     // Tensor kernel operations that generate a new tensor
 
@@ -97,15 +245,44 @@ namespace TiledArray {
     /// \param[in] tensors The argument tensors
     template <typename Op, typename TR, typename... Ts,
         typename std::enable_if<is_tensor<TR, Ts...>::value
-                 && is_contiguous_tensor<TR, Ts...>::value>::type* = nullptr>
+                 && is_contiguous_tensor<TR, Ts...>::value
+                 && ! is_simd_tensor_op<Op, TR, Ts...>::value>::type* = nullptr>
     inline void inplace_tensor_op(Op&& op, TR& result, const Ts&... tensors) {
       TA_ASSERT(! empty(result, tensors...));
       TA_ASSERT(is_range_set_congruent(result, tensors...));
 
       const auto volume = result.range().volume();
 
-      math::inplace_vector_op(op, volume, result.data(),
-          tensors.data()...);
+      // Very large tiles are split among the idle threads
+      math::parallel_vector_for(volume, sizeof(typename TR::value_type),
+          [&] (const std::size_t first, const std::size_t last) {
+            math::inplace_vector_op(op, last - first, result.data() + first,
+                (tensors.data() + first)...);
+          });
+    }
+
+    /// In-place tensor operations with a vector kernel
+
+    /// This function sets the elements of \c result with the result of
+    /// \c op(tensors[i]...) , using the vector kernel of \c op
+    /// \tparam Op The element operation type
+    /// \tparam TR The result tensor type
+    /// \tparam Ts The remaining argument tensor types
+    /// \param[in] op The element operation
+    /// \param[in,out] result The result tensor
+    /// \param[in] tensors The argument tensors
+    template <typename Op, typename TR, typename... Ts,
+        typename std::enable_if<is_simd_tensor_op<Op, TR, Ts...>::value>::type* = nullptr>
+    inline void inplace_tensor_op(Op&& op, TR& result, const Ts&... tensors) {
+      TA_ASSERT(! empty(result, tensors...));
+      TA_ASSERT(is_range_set_congruent(result, tensors...));
+
+      math::parallel_vector_for(result.range().volume(),
+          sizeof(typename TR::value_type),
+          [&] (const std::size_t first, const std::size_t last) {
+            op.vector(last - first, result.data() + first,
+                (tensors.data() + first)...);
+          });
     }
 
     /// In-place tensor of tensors operations with contiguous data
@@ -125,6 +302,14 @@ namespace TiledArray {
       TA_ASSERT(! empty(result, tensors...));
       TA_ASSERT(is_range_set_congruent(result, tensors...));
 
+      // Packed inner tensors are updated with a single kernel call
+      if(is_packed_set(result, result, tensors...)) {
+        auto packed_result = packed_view(result, inner_size_sum(result));
+        inplace_tensor_op(op, packed_result,
+            packed_view(tensors, packed_result.range().volume())...);
+        return;
+      }
+
       const auto volume = result.range().volume();
 
       for(decltype(result.range().volume()) i = 0ul; i < volume; ++i) {
@@ -225,6 +410,75 @@ namespace TiledArray {
           tensors...);
     }
 
+    // -------------------------------------------------------------------------
+    // Element operations on strided views
+
+    /// A pointer to elements with a fixed stride
+
+    /// \tparam T The element type
+    template <typename T>
+    class StridedPointer {
+      T* const data_; ///< The first element
+      const std::size_t stride_; ///< The distance between elements
+
+    public:
+      StridedPointer(T* const data, const std::size_t stride) :
+        data_(data), stride_(stride)
+      { }
+
+      /// \param i The element index
+      /// \return A reference to element \c i
+      T& operator[](const std::size_t i) const { return data_[i * stride_]; }
+    }; // class StridedPointer
+
+    /// The elements of a row of the inner dimension of a tensor
+
+    /// \tparam T A tensor type
+    /// \param tensor The tensor
+    /// \param i The ordinal index of the first element of the row
+    /// \return A strided pointer to the row elements
+    template <typename T>
+    inline auto strided_row(T& tensor, const std::size_t i) {
+      const auto& range = tensor.range();
+      auto* const data = tensor.data() + range.ordinal(i);
+      return StridedPointer<typename std::remove_pointer<decltype(data)>::type>(
+          data, range.stride_data()[range.rank() - 1u]);
+    }
+
+    /// The extent of the inner dimension of a tensor
+
+    /// \tparam T A tensor type
+    /// \param tensor The tensor
+    /// \return The number of elements in a row of the inner dimension
+    template <typename T>
+    inline std::size_t inner_extent(const T& tensor) {
+      return tensor.range().extent_data()[tensor.range().rank() - 1u];
+    }
+
+    template <typename Op, typename Result, typename... Args>
+    inline void strided_inplace_op(Op&& op, const std::size_t n,
+        const Result& result, const Args&... args)
+    {
+      for(std::size_t j = 0ul; j < n; ++j)
+        op(result[j], args[j]...);
+    }
+
+    template <typename Op, typename Result, typename... Args>
+    inline void strided_ptr_op(Op&& op, const std::size_t n,
+        Result* const result, const Args&... args)
+    {
+      for(std::size_t j = 0ul; j < n; ++j)
+        op(result + j, args[j]...);
+    }
+
+    template <typename Op, typename Result, typename... Args>
+    inline void strided_reduce_op(Op&& op, const std::size_t n, Result& result,
+        const Args&... args)
+    {
+      for(std::size_t j = 0ul; j < n; ++j)
+        op(result, args[j]...);
+    }
+
     /// In-place tensor operations with non-contiguous data
 
     /// This function sets the \c i -th element of \c result with the result of
@@ -242,9 +496,18 @@ namespace TiledArray {
       TA_ASSERT(! empty(result, tensors...));
       TA_ASSERT(is_range_set_congruent(result, tensors...));
 
-      const auto stride = inner_size(result, tensors...);
       const auto volume = result.range().volume();
 
+      if(! is_unit_inner_stride(result, tensors...)) {
+        // Apply op to the strided elements of each inner row
+        const auto n = inner_extent(result);
+        for(decltype(result.range().volume()) i = 0ul; i < volume; i += n)
+          strided_inplace_op(op, n, strided_row(result, i),
+              strided_row(tensors, i)...);
+        return;
+      }
+
+      const auto stride = inner_size(result, tensors...);
       for(decltype(result.range().volume()) i = 0ul; i < volume; i += stride)
         math::inplace_vector_op(op, stride, result.data() + result.range().ordinal(i),
           (tensors.data() + tensors.range().ordinal(i))...);
@@ -300,7 +563,8 @@ namespace TiledArray {
     /// \param[in] tensors The argument tensors
     template <typename Op, typename TR, typename... Ts,
         typename std::enable_if<is_tensor<TR, Ts...>::value
-               && is_contiguous_tensor<TR, Ts...>::value>::type* = nullptr>
+               && is_contiguous_tensor<TR, Ts...>::value
+               && ! is_simd_tensor_op<Op, TR, Ts...>::value>::type* = nullptr>
     inline void tensor_init(Op&& op, TR& result, const Ts&... tensors) {
       TA_ASSERT(! empty(result, tensors...));
       TA_ASSERT(is_range_set_congruent(result, tensors...));
@@ -311,7 +575,39 @@ namespace TiledArray {
               typename Ts::const_reference MADNESS_RESTRICT... ts)
           { new(result) typename TR::value_type(op(ts...)); };
 
-      math::vector_ptr_op(wrapper_op, volume, result.data(), tensors.data()...);
+      // Very large tiles are split among the idle threads
+      math::parallel_vector_for(volume, sizeof(typename TR::value_type),
+          [&] (const std::size_t first, const std::size_t last) {
+            math::vector_ptr_op(wrapper_op, last - first, result.data() + first,
+                (tensors.data() + first)...);
+          });
+    }
+
+    /// Initialize tensor with a vector kernel
+
+    /// This function initializes the \c i -th element of \c result with the
+    /// result of \c op(tensors[i]...) , using the vector kernel of \c op
+    /// \pre The memory of \c result has been allocated but not initialized.
+    /// \tparam Op The element operation type
+    /// \tparam TR The result tensor type
+    /// \tparam Ts The argument tensor types
+    /// \param[in] op The element operation
+    /// \param[out] result The result tensor
+    /// \param[in] tensors The argument tensors
+    template <typename Op, typename TR, typename... Ts,
+        typename std::enable_if<is_simd_tensor_op<Op, TR, Ts...>::value>::type* = nullptr>
+    inline void tensor_init(Op&& op, TR& result, const Ts&... tensors) {
+      TA_ASSERT(! empty(result, tensors...));
+      TA_ASSERT(is_range_set_congruent(result, tensors...));
+
+      // The elements are trivially constructible, so the kernel may write to
+      // the uninitialized memory.
+      math::parallel_vector_for(result.range().volume(),
+          sizeof(typename TR::value_type),
+          [&] (const std::size_t first, const std::size_t last) {
+            op.vector(last - first, result.data() + first,
+                (tensors.data() + first)...);
+          });
     }
 
     /// Initialize tensor of tensors with contiguous tensor arguments
@@ -334,6 +630,22 @@ namespace TiledArray {
 
       const auto volume = result.range().volume();
 
+      // The inner tensors of the result share one buffer, and packed
+      // arguments are evaluated with a single kernel call
+      const auto& layout = first_tensor(tensors...);
+      if(std::is_trivially_destructible<typename TR::value_type::value_type>::value
+          && is_packable(layout))
+      {
+        auto buffer = make_packed(result, layout);
+        if(is_packed_set(layout, tensors...)) {
+          tensor_init(op, buffer, packed_view(tensors, buffer.range().volume())...);
+        } else {
+          for(decltype(result.range().volume()) i = 0ul; i < volume; ++i)
+            tensor_init(op, result[i], tensors[i]...);
+        }
+        return;
+      }
+
       for(decltype(result.range().volume()) i = 0ul; i < volume; ++i) {
         new(result.data() + i)
             typename TR::value_type(tensor_op<typename TR::value_type>(op, tensors[i]...));
@@ -433,7 +745,6 @@ namespace TiledArray {
       TA_ASSERT(! empty(result, tensor1, tensors...));
       TA_ASSERT(is_range_set_congruent(result, tensor1, tensors...));
 
-      const auto stride = inner_size(tensor1, tensors...);
       const auto volume = tensor1.range().volume();
 
       auto wrapper_op = [=] (typename TR::pointer MADNESS_RESTRICT result_ptr,
@@ -441,6 +752,16 @@ namespace TiledArray {
               const typename Ts::value_type... values)
           { new(result_ptr) typename T1::value_type(op(value1, values...)); };
 
+      if(! is_unit_inner_stride(tensor1, tensors...)) {
+        // Read the strided elements of each inner row
+        const auto n = inner_extent(tensor1);
+        for(decltype(tensor1.range().volume()) i = 0ul; i < volume; i += n)
+          strided_ptr_op(wrapper_op, n, result.data() + i,
+              strided_row(tensor1, i), strided_row(tensors, i)...);
+        return;
+      }
+
+      const auto stride = inner_size(tensor1, tensors...);
       for(decltype(tensor1.range().volume()) i = 0ul; i < volume; i += stride)
         math::vector_ptr_op(wrapper_op, stride, result.data() + i,
             (tensor1.data() + tensor1.range().ordinal(i)),
@@ -509,7 +830,8 @@ namespace TiledArray {
     /// \return The reduced value of the tensor(s)
     template <typename ReduceOp, typename JoinOp, typename Scalar, typename T1, typename... Ts,
     typename std::enable_if<is_numeric<Scalar>::value && is_tensor<T1, Ts...>::value
-             && is_contiguous_tensor<T1, Ts...>::value>::type* = nullptr>
+             && is_contiguous_tensor<T1, Ts...>::value
+             && ! is_simd_tensor_op<ReduceOp, T1, Ts...>::value>::type* = nullptr>
     Scalar tensor_reduce(ReduceOp&& reduce_op, JoinOp&& join_op,
         Scalar identity, const T1& tensor1, const Ts&... tensors)
     {
@@ -524,6 +846,36 @@ namespace TiledArray {
       return identity;
     }
 
+    /// Tensor reduction operation with a vector kernel
+
+    /// Perform an element-wise reduction of the tensors, using the vector
+    /// kernel of \c reduce_op .
+    /// \tparam ReduceOp The element-wise reduction operation type
+    /// \tparam JoinOp The result operation type
+    /// \tparam Scalar A scalar type
+    /// \tparam T1 The first argument tensor type
+    /// \tparam Ts The argument tensor types
+    /// \param reduce_op The element-wise reduction operation
+    /// \param join_op The join result operation
+    /// \param identity The initial value for the reduction and the result
+    /// \param tensor1 The first tensor to be reduced
+    /// \param tensors The other tensors to be reduced
+    /// \return The reduced value of the tensor(s)
+    template <typename ReduceOp, typename JoinOp, typename Scalar, typename T1, typename... Ts,
+    typename std::enable_if<is_numeric<Scalar>::value
+             && is_simd_tensor_op<ReduceOp, T1, Ts...>::value>::type* = nullptr>
+    Scalar tensor_reduce(ReduceOp&& reduce_op, JoinOp&& join_op,
+        Scalar identity, const T1& tensor1, const Ts&... tensors)
+    {
+      TA_ASSERT(! empty(tensor1, tensors...));
+      TA_ASSERT(is_range_set_congruent(tensor1, tensors...));
+
+      join_op(identity, reduce_op.reduce(tensor1.range().volume(),
+          tensor1.data(), tensors.data()...));
+
+      return identity;
+    }
+
     /// Tensor of tensor reduction operation for contiguous tensors
 
     /// Perform an element-wise reduction of the tensors.
@@ -583,10 +935,22 @@ namespace TiledArray {
       TA_ASSERT(! empty(tensor1, tensors...));
       TA_ASSERT(is_range_set_congruent(tensor1, tensors...));
 
-      const auto stride = inner_size(tensor1, tensors...);
       const auto volume = tensor1.range().volume();
 
       Scalar result = identity;
+      if(! is_unit_inner_stride(tensor1, tensors...)) {
+        // Reduce the strided elements of each inner row
+        const auto n = inner_extent(tensor1);
+        for(decltype(tensor1.range().volume()) i = 0ul; i < volume; i += n) {
+          Scalar temp = identity;
+          strided_reduce_op(reduce_op, n, temp, strided_row(tensor1, i),
+              strided_row(tensors, i)...);
+          join_op(result, temp);
+        }
+        return result;
+      }
+
+      const auto stride = inner_size(tensor1, tensors...);
       for(decltype(tensor1.range().volume()) i = 0ul; i < volume; i += stride) {
         Scalar temp = identity;
         math::reduce_op(reduce_op,join_op, identity, stride, temp,
@@ -28,72 +28,199 @@
 
 #include <TiledArray/perm_index.h>
 #include <TiledArray/math/transpose.h>
+#include <map>
+#include <memory>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
 
 
-    /// Compute the fused dimensions for permutation
+    /// Iterate over the blocks of a permuted tensor
 
-    /// This function will compute the fused dimensions of a tensor for use in
-    /// permutation algorithms. The idea is to partition the stride 1 dimensions
-    /// in both the input and output tensor, which yields a forth-order tensor
-    /// (second- and third-order tensors have size of 1 and stride of 0 in the
-    /// unused dimensions).
+    /// This function visits the blocks of the argument tensor that are spanned
+    /// by the outer dimensions, \c dims , in row-major order, and calls
+    /// \c op(index,perm_index) with the ordinal offset of each block in the
+    /// argument tensor, \c index , and in the permuted result tensor,
+    /// \c perm_index . The offsets are updated incrementally, which avoids the
+    /// integer divisions of \c PermIndex::operator() for every block.
     /// \tparam SizeType An unsigned integral type
-    /// \param[out] fused_size An array for the fused size output
-    /// \param[out] fused_weight An array for the fused weight output
-    /// \param[in] size An array that holds the unfused size information of the
-    /// argument tensor
-    /// \param[in] perm The permutation that will be applied to the argument
-    /// tensor(s).
-    template <typename SizeType>
-    inline void fuse_dimensions(SizeType * MADNESS_RESTRICT const fused_size,
-        SizeType * MADNESS_RESTRICT const fused_weight,
-        const SizeType * MADNESS_RESTRICT const size, const Permutation& perm)
+    /// \tparam Op The block operation type
+    /// \param perm_index_op The index permutation functor of the argument
+    /// \param extent An array that holds the extent of the argument tensor
+    /// \param dims The outer dimensions of the argument tensor, in increasing
+    /// order
+    /// \param op The block operation
+    template <typename SizeType, typename Op>
+    inline void for_each_perm_block(const PermIndex& perm_index_op,
+        const SizeType* MADNESS_RESTRICT const extent,
+        const std::vector<unsigned int>& dims, Op&& op)
     {
-      const unsigned int ndim1 = perm.dim() - 1u;
-
-      int i = ndim1;
-      fused_size[3] = size[i--];
-      while((i >= 0) && (perm[i + 1u] == (perm[i] + 1u)))
-        fused_size[3] *= size[i--];
-      fused_weight[3] = 1u;
-
-
-      if((i >= 0) && (perm[i] != ndim1)) {
-        fused_size[2] = size[i--];
-        while((i >= 0) && (perm[i] != ndim1))
-          fused_size[2] *= size[i--];
-
-        fused_weight[2] = fused_size[3];
-
-        fused_size[1] = size[i--];
-        while((i >= 0) && (perm[i + 1] == (perm[i] + 1u)))
-          fused_size[1] *= size[i--];
-
-        fused_weight[1] = fused_size[2] * fused_weight[2];
-      } else {
-        fused_size[2] = 1ul;
-        fused_weight[2] = 0ul;
+      const std::size_t* MADNESS_RESTRICT const input_weight =
+          perm_index_op.data();
+      const std::size_t* MADNESS_RESTRICT const output_weight =
+          perm_index_op.data() + perm_index_op.dim();
+      const int n = dims.size();
+
+      std::vector<std::size_t> count(n, 0ul);
+      std::size_t index = 0ul, perm_index = 0ul;
+      int i = 0;
+      do {
+        op(index, perm_index);
+
+        // Increment the block offsets, last dimension first
+        for(i = n - 1; i >= 0; --i) {
+          const unsigned int d = dims[i];
+          if(++count[i] < std::size_t(extent[d])) {
+            index += input_weight[d];
+            perm_index += output_weight[d];
+            break;
+          }
 
-        fused_size[1] = size[i--];
-        while((i >= 0) && (perm[i + 1] == (perm[i] + 1u)))
-          fused_size[1] *= size[i--];
+          // Reset dimension d and carry to the next dimension
+          count[i] = 0ul;
+          index -= (extent[d] - 1ul) * input_weight[d];
+          perm_index -= (extent[d] - 1ul) * output_weight[d];
+        }
+      } while(i >= 0);
+    }
 
-        fused_weight[1] = fused_size[3];
+    /// The setup of a tensor permutation
+
+    /// A plan holds everything that the permutation of a tensor derives from
+    /// the permutation and the extent of the tensor: the index weights, the
+    /// outer dimensions that are iterated over by \c for_each_perm_block ,
+    /// and the kernel with its block sizes, which is either a copy of
+    /// contiguous blocks, when the last dimension is not permuted, or a
+    /// series of matrix transposes. Plans do not depend on the lower bound of
+    /// the tensor, so one plan serves all tiles with the same extent; see
+    /// \c perm_plan() .
+    class PermPlan {
+    public:
+      PermIndex perm_index_; ///< The index permutation functor
+      std::vector<std::size_t> extent_; ///< The extent of the argument tensor
+      std::vector<unsigned int> outer_dims_; ///< The outer dimensions of the argument tensor
+      bool transpose_; ///< \c true when the blocks are transposed
+      std::size_t block_size_; ///< The size of the copied blocks
+      std::size_t m_; ///< The number of rows of the transposed blocks
+      std::size_t n_; ///< The number of columns of the transposed blocks
+      std::size_t arg_stride_; ///< The row stride of the transposed blocks of the argument
+      std::size_t result_stride_; ///< The row stride of the transposed blocks of the result
+
+      /// Construct a permutation plan
+
+      /// \param range The range of the argument tensor
+      /// \param perm The permutation that will be applied to the argument
+      PermPlan(const Range& range, const Permutation& perm) :
+        perm_index_(range, perm),
+        extent_(range.extent_data(), range.extent_data() + range.rank()),
+        outer_dims_(), transpose_(false), block_size_(0ul), m_(0ul), n_(0ul),
+        arg_stride_(0ul), result_stride_(0ul)
+      {
+        const unsigned int ndim = range.rank();
+        const unsigned int ndim1 = ndim - 1;
+        const auto* MADNESS_RESTRICT const arg0_extent = range.extent_data();
+        outer_dims_.reserve(ndim);
+
+        if(perm[ndim1] == ndim1) {
+          // This is the simple case where the last dimension is not permuted.
+          // Therefore, it can be shuffled in chunks.
+
+          // Determine which dimensions can be permuted with the least
+          // significant dimension.
+          block_size_ = arg0_extent[ndim1];
+          int i = int(ndim1) - 1;
+          for(; i >= 0; --i) {
+            if(int(perm[i]) != i)
+              break;
+            block_size_ *= arg0_extent[i];
+          }
+          for(int d = 0; d <= i; ++d)
+            outer_dims_.push_back(d);
+
+        } else {
+          // This is the more complicated case. Here we permute in terms of
+          // matrix transposes. The data layout of the input and output
+          // matrices are chosen such that they both contain stride one
+          // dimensions.
+
+          // Here we partition the n dimensional index space, I, of the
+          // permute tensor with up to four parts
+          // {I_1, ..., I_i, I_i+1, ..., I_j, I_j+1, ..., I_k, I_k+1, ..., I_n}
+          // where the subrange {I_k+1, ..., I_n} is the (fused) inner
+          // dimension in the input tensor, and the subrange {I_i+1, ..., I_j}
+          // is the (fused) inner dimension in the output tensor that has been
+          // mapped to the input tensor. These ranges are used to form a set of
+          // matrices in the input tensor that are transposed and copied to the
+          // output tensor. The remaining (fused) index ranges {I_1, ..., I_i}
+          // and {I_j+1, ..., I_k} are used to form the outer loop around the
+          // matrix transpose operations. These outer ranges may or may not be
+          // zero size.
+          transpose_ = true;
+          unsigned int k = ndim1;
+          while((k > 0u) && (perm[k] == (perm[k - 1u] + 1u)))
+            --k;
+          unsigned int j = k;
+          while(perm[j - 1u] != ndim1)
+            --j;
+          unsigned int i = j - 1u;
+          while((i > 0u) && (perm[i] == (perm[i - 1u] + 1u)))
+            --i;
+
+          // Compute the size of the fused matrix dimensions
+          m_ = 1ul;
+          n_ = 1ul;
+          for(unsigned int d = i; d < j; ++d)
+            m_ *= arg0_extent[d];
+          for(unsigned int d = k; d < ndim; ++d)
+            n_ *= arg0_extent[d];
+          arg_stride_ = range.stride_data()[j - 1u];
+
+          for(unsigned int d = 0u; d < i; ++d)
+            outer_dims_.push_back(d);
+          for(unsigned int d = j; d < k; ++d)
+            outer_dims_.push_back(d);
+
+          // Compute the fused stride for the result matrix transpose; the
+          // extent of dimension d of the result is the extent of dimension
+          // inv_perm[d] of the argument.
+          const Permutation inv_perm = -perm;
+          result_stride_ = 1ul;
+          for(unsigned int d = perm[ndim1] + 1u; d < ndim; ++d)
+            result_stride_ *= arg0_extent[inv_perm[d]];
+        }
       }
 
-      if(i >= 0) {
-        fused_size[0] = size[i--];
-        while(i >= 0)
-          fused_size[0] *= size[i--];
-
-        fused_weight[0] = fused_size[1] * fused_weight[1];
-      } else {
-        fused_size[0] = 1ul;
-        fused_weight[0] = 0ul;
-      }
+    }; // class PermPlan
+
+    /// The plan of a tensor permutation
+
+    /// Plans are cached by each thread, keyed by the permutation and the
+    /// extent of the argument, so the tiles of an array that have the same
+    /// shape are permuted with one plan, and the setup of the permutation is
+    /// not repeated for each tile. Each thread holds at most 64 plans; the
+    /// cache is cleared when it is full.
+    /// \param perm The permutation that will be applied to the argument
+    /// \param range The range of the argument tensor
+    /// \return The permutation plan
+    inline std::shared_ptr<const PermPlan>
+    perm_plan(const Permutation& perm, const Range& range) {
+      typedef std::map<std::vector<std::size_t>, std::shared_ptr<const PermPlan> >
+          cache_type;
+      static thread_local cache_type cache;
+
+      const unsigned int ndim = range.rank();
+      std::vector<std::size_t> key(perm.data().begin(), perm.data().end());
+      key.insert(key.end(), range.extent_data(), range.extent_data() + ndim);
+      typename cache_type::iterator it = cache.find(key);
+      if(it != cache.end())
+        return it->second;
+
+      if(cache.size() >= 64ul)
+        cache.clear();
+      std::shared_ptr<const PermPlan> plan = std::make_shared<PermPlan>(range, perm);
+      cache.emplace(std::move(key), plan);
+      return plan;
     }
 
     /// Construct a permuted tensor copy
@@ -106,6 +233,7 @@ namespace TiledArray {
     /// \code
     /// void output_op(Result::value_type*, const Result::value_type)
     /// \endcode
+    /// The setup of the permutation is taken from \c perm_plan() .
     /// \tparam InputOp The input operation type
     /// \tparam OutputOp The output operation type
     /// \tparam Result The result tensor type
@@ -122,87 +250,130 @@ namespace TiledArray {
     inline void permute(InputOp&& input_op, OutputOp&& output_op, Result& result,
         const Permutation& perm, const Arg0& arg0, const Args&... args)
     {
-      detail::PermIndex perm_index_op(arg0.range(), perm);
-
-      // Cache constants
-      const unsigned int ndim = arg0.range().rank();
-      const unsigned int ndim1 = ndim - 1;
-      const typename Result::size_type volume = arg0.range().volume();
-
-      // Get pointer to arg extent
-      const auto* MADNESS_RESTRICT const arg0_extent = arg0.range().extent_data();
+      if(arg0.range().volume() == 0ul)
+        return;
 
-      if(perm[ndim1] == ndim1) {
-        // This is the simple case where the last dimension is not permuted.
-        // Therefore, it can be shuffled in chunks.
-
-        // Determine which dimensions can be permuted with the least significant
-        // dimension.
-        typename Result::size_type block_size = arg0_extent[ndim1];
-        for(int i = int(ndim1) - 1 ; i >= 0; --i) {
-          if(int(perm[i]) != i)
-            break;
-          block_size *= arg0_extent[i];
-        }
+      const std::shared_ptr<const PermPlan> plan = perm_plan(perm, arg0.range());
 
+      if(! plan->transpose_) {
         // Combine the input and output operations
         auto op = [=] (typename Result::pointer result,
             typename Arg0::const_reference a0, typename Args::const_reference... as)
         { output_op(result, input_op(a0, as...)); };
 
-        // Permute the data
-        for(typename Result::size_type index = 0ul; index < volume; index += block_size) {
-          const typename Result::size_type perm_index = perm_index_op(index);
-
-          // Copy the block
-          math::vector_ptr_op(op, block_size, result.data() + perm_index,
-              arg0.data() + index, (args.data() + index)...);
-        }
+        // Copy the data in contiguous blocks
+        const std::size_t block_size = plan->block_size_;
+        for_each_perm_block(plan->perm_index_, plan->extent_.data(),
+            plan->outer_dims_,
+            [&] (const std::size_t index, const std::size_t perm_index) {
+              math::vector_ptr_op(op, block_size, result.data() + perm_index,
+                  arg0.data() + index, (args.data() + index)...);
+            });
 
       } else {
-        // This is the more complicated case. Here we permute in terms of matrix
-        // transposes. The data layout of the input and output matrices are
-        // chosen such that they both contain stride one dimensions.
-
-        // Here we partition the n dimensional index space, I, of the permute
-        // tensor with up to four parts
-        // {I_1, ..., I_i, I_i+1, ..., I_j, I_j+1, ..., I_k, I_k+1, ..., I_n}
-        // where the subrange {I_k+1, ..., I_n} is the (fused) inner dimension
-        // in the input tensor, and the subrange {I_i+1, ..., I_j} is the
-        // (fused) inner dimension in the output tensor that has been mapped to
-        // the input tensor. These ranges are used to form a set of matrices in
-        // the input tensor that are transposed and copied to the output tensor.
-        // The remaining (fused) index ranges {I_1, ..., I_i} and
-        // {I_j+1, ..., I_k} are used to form the outer loop around the matrix
-        // transpose operations. These outer ranges may or may not be zero size.
-        typename Result::size_type other_fused_size[4];
-        typename Result::size_type other_fused_weight[4];
-        fuse_dimensions(other_fused_size, other_fused_weight,
-            arg0.range().extent_data(), perm);
-
-        // Compute the fused stride for the result matrix transpose.
-        const auto* MADNESS_RESTRICT const result_extent = result.range().extent_data();
-        typename Result::size_type  result_outer_stride = 1ul;
-        for(unsigned int i = perm[ndim1] + 1u; i < ndim; ++i)
-          result_outer_stride *= result_extent[i];
-
-        // Copy data from the input to the output matrix via a series of matrix
-        // transposes.
-        for(typename Result::size_type i = 0ul; i < other_fused_size[0]; ++i) {
-          typename Result::size_type index = i * other_fused_weight[0];
-          for(typename Result::size_type j = 0ul; j < other_fused_size[2]; ++j, index += other_fused_weight[2]) {
-            // Compute the ordinal index of the input and output matrices.
-            typename Result::size_type perm_index = perm_index_op(index);
-
-            math::transpose(input_op, output_op,
-                other_fused_size[1], other_fused_size[3],
-                result_outer_stride, result.data() + perm_index,
-                other_fused_weight[1], arg0.data() + index, (args.data() + index)...);
-          }
-        }
+        // Copy data from the input to the output matrix via a series of
+        // matrix transposes.
+        const std::size_t m = plan->m_, n = plan->n_;
+        const std::size_t arg_stride = plan->arg_stride_;
+        const std::size_t result_stride = plan->result_stride_;
+        for_each_perm_block(plan->perm_index_, plan->extent_.data(),
+            plan->outer_dims_,
+            [&] (const std::size_t index, const std::size_t perm_index) {
+              math::transpose(input_op, output_op, m, n, result_stride,
+                  result.data() + perm_index, arg_stride, arg0.data() + index,
+                  (args.data() + index)...);
+            });
+      }
+    }
+
+    /// Compute the element offsets of a group of permuted dimensions
+
+    /// This function computes the offsets, in the argument tensor, of the
+    /// elements spanned by dimensions <tt>[first,last)</tt> of the permuted
+    /// tensor, <tt>perm * range</tt>, in row-major order. Since the ordinal
+    /// index of an element is a linear function of its coordinate index, the
+    /// offset of an element of the permuted tensor is the sum of the offsets
+    /// of disjoint dimension groups, e.g. the rows and columns of a matrix.
+    /// \tparam Range The argument range type
+    /// \param perm The permutation that is applied to the argument tensor
+    /// \param range The range of the argument tensor
+    /// \param first The first permuted dimension of the group
+    /// \param last One past the last permuted dimension of the group
+    /// \return The offsets of the elements spanned by the group
+    template <typename Range>
+    inline std::vector<typename Range::size_type>
+    permuted_offsets(const Permutation& perm, const Range& range,
+        const unsigned int first, const unsigned int last)
+    {
+      typedef typename Range::size_type size_type;
+      TA_ASSERT(perm.dim() == range.rank());
+      TA_ASSERT(first <= last);
+      TA_ASSERT(last <= range.rank());
+
+      // Get the stride and extent of the argument in the permuted order
+      const unsigned int ndim = range.rank();
+      const auto* MADNESS_RESTRICT const extent = range.extent_data();
+      const auto* MADNESS_RESTRICT const stride = range.stride_data();
+      std::vector<size_type> perm_extent(ndim), perm_stride(ndim);
+      for(unsigned int i = 0u; i < ndim; ++i) {
+        perm_extent[perm[i]] = extent[i];
+        perm_stride[perm[i]] = stride[i];
+      }
+
+      // Expand the offsets one dimension at a time, slowest dimension first
+      std::vector<size_type> result(1, 0ul);
+      for(unsigned int d = first; d < last; ++d) {
+        std::vector<size_type> temp;
+        temp.reserve(result.size() * perm_extent[d]);
+        for(const size_type offset : result)
+          for(size_type i = 0ul; i < perm_extent[d]; ++i)
+            temp.push_back(offset + i * perm_stride[d]);
+        result.swap(temp);
+      }
+
+      return result;
+    }
+
+    /// Pack a block of a permuted matrix
+
+    /// Gather the elements <tt>arg[rows[i] + cols[j]]</tt> into the row-major
+    /// matrix \c result .
+    /// \tparam T The result element type
+    /// \tparam U The argument element type
+    /// \tparam SizeType An unsigned integral type
+    /// \param[out] result The packed matrix
+    /// \param[in] arg The argument tensor data
+    /// \param[in] rows The element offsets of the matrix rows
+    /// \param[in] nrows The number of matrix rows
+    /// \param[in] cols The element offsets of the matrix columns
+    /// \param[in] ncols The number of matrix columns
+    template <typename T, typename U, typename SizeType>
+    inline void pack_permuted(T* MADNESS_RESTRICT result,
+        const U* MADNESS_RESTRICT const arg,
+        const SizeType* MADNESS_RESTRICT const rows, const std::size_t nrows,
+        const SizeType* MADNESS_RESTRICT const cols, const std::size_t ncols)
+    {
+      for(std::size_t i = 0ul; i < nrows; ++i, result += ncols) {
+        const U* MADNESS_RESTRICT const arg_row = arg + rows[i];
+        for(std::size_t j = 0ul; j < ncols; ++j)
+          result[j] = arg_row[cols[j]];
       }
     }
 
+    /// Data of a matrix that is used without packing
+
+    /// A matrix with elements of another type is always packed, since the
+    /// elements are converted as they are packed (see \c pack_permuted() ),
+    /// so its data is never used directly.
+    /// \tparam T The element type of the matrix
+    /// \param data The data of the matrix
+    /// \return \c data
+    template <typename T>
+    inline const T* unpacked_data(const T* data) { return data; }
+
+    template <typename T, typename U,
+        typename std::enable_if<! std::is_same<T, U>::value>::type* = nullptr>
+    inline const T* unpacked_data(const U*) { return nullptr; }
 
   }  // namespace detail
 } // namespace TiledArray
@@ -0,0 +1,958 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  pool_allocator.h
+ *  Jan 23, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TENSOR_POOL_ALLOCATOR_H__INCLUDED
+#define TILEDARRAY_TENSOR_POOL_ALLOCATOR_H__INCLUDED
+
+#include <TiledArray/math/eigen.h>
+#include <TiledArray/memory_governor.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace TiledArray {
+
+  /// Pool allocator statistics
+
+  /// The statistics are collected by \c pool_allocator_stats() over all
+  /// threads, including threads that have finished.
+  struct PoolAllocatorStats {
+    std::size_t allocations; ///< Number of allocations
+    std::size_t hits; ///< Number of allocations served by a pool
+    std::size_t deallocations; ///< Number of deallocations
+    std::size_t pooled_bytes; ///< Bytes currently held by the pools
+    std::size_t peak_pooled_bytes; ///< Sum of the peak bytes held by each thread pool
+
+    /// Pool hit rate
+
+    /// \return The fraction of allocations that were served by a pool
+    double hit_rate() const {
+      return (allocations ? double(hits) / double(allocations) : 0.0);
+    }
+  }; // struct PoolAllocatorStats
+
+  namespace detail {
+
+    /// Parse a NUMA node list
+
+    /// \param list A node list in the format of
+    /// \c /sys/devices/system/node/online , e.g. "0-1,3"
+    /// \return A bit mask of the nodes in \c list
+    inline std::vector<unsigned long> numa_parse_nodes(const std::string& list) {
+      constexpr std::size_t word_bits = 8ul * sizeof(unsigned long);
+      std::vector<unsigned long> mask;
+      std::istringstream ss(list);
+      std::string item;
+      while(std::getline(ss, item, ',')) {
+        if(item.empty())
+          continue;
+        const std::size_t dash = item.find('-');
+        const std::size_t first = std::stoul(item.substr(0ul, dash));
+        const std::size_t last = (dash == std::string::npos ? first :
+            std::stoul(item.substr(dash + 1ul)));
+        for(std::size_t node = first; node <= last; ++node) {
+          if(mask.size() <= node / word_bits)
+            mask.resize(node / word_bits + 1ul, 0ul);
+          mask[node / word_bits] |= 1ul << (node % word_bits);
+        }
+      }
+      return mask;
+    }
+
+    /// The NUMA nodes of this system
+
+    /// \return A bit mask of the online NUMA nodes, which is empty when the
+    /// system has only one node or the node list is not available
+    inline const std::vector<unsigned long>& numa_nodes() {
+      static const std::vector<unsigned long> nodes = [] () {
+        std::vector<unsigned long> nodes;
+#ifdef __linux__
+        std::ifstream file("/sys/devices/system/node/online");
+        std::string list;
+        if(file >> list)
+          nodes = numa_parse_nodes(list);
+#endif
+        std::size_t count = 0ul;
+        for(const unsigned long word : nodes)
+          count += __builtin_popcountl(word);
+        if(count < 2ul)
+          nodes.clear();
+        return nodes;
+      }();
+      return nodes;
+    }
+
+    /// Smallest block that is interleaved across NUMA nodes
+
+    /// The size is read from the \c TA_NUMA_INTERLEAVE_BYTES environment
+    /// variable; the default, zero, disables interleaving. Blocks are never
+    /// interleaved on systems with a single NUMA node.
+    /// \return The smallest interleaved block size in bytes, or zero
+    inline std::size_t numa_interleave_bytes() {
+      static const std::size_t min_bytes = [] () -> std::size_t {
+        const char* min_bytes = getenv("TA_NUMA_INTERLEAVE_BYTES");
+        if((! min_bytes) || numa_nodes().empty())
+          return 0ul;
+        return std::strtoul(min_bytes, nullptr, 10);
+      }();
+      return min_bytes;
+    }
+
+    /// Check for an interleaved block
+
+    /// \param bytes The block size
+    /// \return \c true if blocks of \c bytes bytes are interleaved
+    inline bool is_numa_interleaved(const std::size_t bytes) {
+      const std::size_t min_bytes = numa_interleave_bytes();
+      return (min_bytes != 0ul) && (bytes >= min_bytes);
+    }
+
+    /// Allocate a block whose pages are interleaved across NUMA nodes
+
+    /// The block is mapped directly, and its pages are placed round robin on
+    /// all nodes when they are first touched, so a large tile that is read
+    /// by threads on every socket is not held by the socket of the thread
+    /// that allocated it.
+    /// \param bytes The size of the block
+    /// \return A pointer to a page aligned block of \c bytes bytes
+    /// \throw std::bad_alloc When the system is out of memory
+    inline void* numa_interleaved_malloc(const std::size_t bytes) {
+      void* const p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if(p == MAP_FAILED)
+        throw std::bad_alloc();
+#ifdef __linux__
+      // A failure only leaves the default placement
+      const std::vector<unsigned long>& nodes = numa_nodes();
+      ::syscall(SYS_mbind, p, bytes, MPOL_INTERLEAVE, nodes.data(),
+          nodes.size() * 8ul * sizeof(unsigned long), 0u);
+#endif
+      return p;
+    }
+
+    /// Free a block allocated by \c numa_interleaved_malloc()
+
+    /// \param p A pointer to the block
+    /// \param bytes The size of the block
+    inline void numa_interleaved_free(void* const p, const std::size_t bytes) {
+      ::munmap(p, bytes);
+    }
+
+    /// Size of a huge page
+
+    /// The size is read from \c /proc/meminfo ; the default is 2 MiB.
+    /// \return The huge page size in bytes
+    inline std::size_t huge_page_size() {
+      static const std::size_t page_size = [] () -> std::size_t {
+        std::size_t page_size = 2097152ul;
+#ifdef __linux__
+        std::ifstream file("/proc/meminfo");
+        std::string line;
+        while(std::getline(file, line)) {
+          if(line.compare(0ul, 13ul, "Hugepagesize:") == 0) {
+            const std::size_t kib = std::strtoul(line.c_str() + 13, nullptr, 10);
+            if(kib)
+              page_size = kib * 1024ul;
+            break;
+          }
+        }
+#endif
+        return page_size;
+      }();
+      return page_size;
+    }
+
+    /// Smallest block that is backed by huge pages
+
+    /// The size is read from the \c TA_HUGE_PAGE_BYTES environment variable;
+    /// the default, zero, disables huge page blocks.
+    /// \return The smallest huge page block size in bytes, or zero
+    inline std::size_t huge_page_bytes() {
+      static const std::size_t min_bytes = [] () -> std::size_t {
+        const char* min_bytes = getenv("TA_HUGE_PAGE_BYTES");
+        if(min_bytes)
+          return std::strtoul(min_bytes, nullptr, 10);
+        return 0ul;
+      }();
+      return min_bytes;
+    }
+
+    /// Check for a huge page block
+
+    /// \param bytes The block size
+    /// \return \c true if blocks of \c bytes bytes are backed by huge pages
+    inline bool is_huge_page(const std::size_t bytes) {
+      const std::size_t min_bytes = huge_page_bytes();
+      return (min_bytes != 0ul) && (bytes >= min_bytes);
+    }
+
+    /// A cache of huge page blocks and their memory registrations
+
+    /// Blocks are mapped with explicit huge pages ( \c MAP_HUGETLB ) when
+    /// these are requested and available, and otherwise with transparent huge
+    /// pages, for which the mapping is aligned to the huge page size. The
+    /// pages of blocks that are interleaved across NUMA nodes (see
+    /// \c numa_interleave_bytes() ) are interleaved as well. Each new block
+    /// is registered with the registration hook, if one is set, e.g. to pin
+    /// it for RDMA or for GPU transfers, and the registration is kept while
+    /// the block is held by the cache, so a block that is reused by another
+    /// tile of the same size is not registered again. Free blocks are held
+    /// up to a limit on their total size; blocks that would exceed the limit
+    /// are deregistered and returned to the system. A \c HugePageCache may
+    /// be used by any thread.
+    class HugePageCache {
+    public:
+      /// Memory registration hook
+
+      /// The hook is called with the block and its mapped size, and returns
+      /// a handle to the registration, which is given to the
+      /// deregistration hook.
+      typedef std::function<void*(void*, std::size_t)> register_type;
+      /// Memory deregistration hook
+
+      /// The hook is called with the block, its mapped size, and the handle
+      /// returned by the registration hook.
+      typedef std::function<void(void*, std::size_t, void*)> deregister_type;
+
+    private:
+
+      /// A mapped block
+      struct Block {
+        std::size_t mapped_bytes; ///< The mapped size of the block
+        void* handle; ///< The registration handle of the block
+        deregister_type deregister; ///< The hook that deregisters the block
+      }; // struct Block
+
+      mutable std::mutex mutex_; ///< Protects the cache data
+      std::size_t max_bytes_; ///< Limit on the bytes of the free blocks
+      bool explicit_pages_; ///< Map blocks with explicit huge pages
+      register_type register_; ///< Registration hook
+      deregister_type deregister_; ///< Deregistration hook
+      std::unordered_map<void*, Block> blocks_; ///< All blocks mapped by this cache
+      std::multimap<std::size_t, void*> free_; ///< Free blocks by mapped size
+      std::size_t free_bytes_; ///< Bytes of the free blocks
+      std::size_t reuses_; ///< Number of allocations served by a free block
+
+      /// Map a new block
+
+      /// \param mapped_bytes The mapped size of the block, which is a
+      /// multiple of the huge page size
+      /// \return A pointer to the block
+      /// \throw std::bad_alloc When the system is out of memory
+      void* map(const std::size_t mapped_bytes) const {
+        const std::size_t page_size = huge_page_size();
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if(explicit_pages_)
+          p = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if(p == MAP_FAILED) {
+          // Over-map so that the block can be aligned to a huge page, which
+          // transparent huge pages require
+          char* const q = static_cast<char*>(::mmap(nullptr,
+              mapped_bytes + page_size, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+          if(q == MAP_FAILED)
+            throw std::bad_alloc();
+          const std::size_t head = (page_size -
+              reinterpret_cast<std::size_t>(q) % page_size) % page_size;
+          if(head)
+            ::munmap(q, head);
+          if(page_size - head)
+            ::munmap(q + head + mapped_bytes, page_size - head);
+          p = q + head;
+#ifdef MADV_HUGEPAGE
+          ::madvise(p, mapped_bytes, MADV_HUGEPAGE);
+#endif
+        }
+#ifdef __linux__
+        // A failure only leaves the default placement
+        if(is_numa_interleaved(mapped_bytes)) {
+          const std::vector<unsigned long>& nodes = numa_nodes();
+          ::syscall(SYS_mbind, p, mapped_bytes, MPOL_INTERLEAVE, nodes.data(),
+              nodes.size() * 8ul * sizeof(unsigned long), 0u);
+        }
+#endif
+        return p;
+      }
+
+      /// Deregister and unmap a block
+
+      /// \param p A pointer to the block
+      /// \param block The block data
+      static void unmap(void* const p, const Block& block) {
+        if(block.deregister)
+          block.deregister(p, block.mapped_bytes, block.handle);
+        ::munmap(p, block.mapped_bytes);
+      }
+
+    public:
+
+      /// Construct an empty cache
+
+      /// \param max_bytes The limit on the total size of the free blocks held
+      /// by this cache
+      /// \param explicit_pages Map blocks with explicit huge pages when
+      /// these are available
+      HugePageCache(const std::size_t max_bytes, const bool explicit_pages) :
+        mutex_(), max_bytes_(max_bytes), explicit_pages_(explicit_pages),
+        register_(), deregister_(), blocks_(), free_(), free_bytes_(0ul),
+        reuses_(0ul)
+      { }
+
+      HugePageCache(const HugePageCache&) = delete;
+      HugePageCache& operator=(const HugePageCache&) = delete;
+
+      ~HugePageCache() { release(); }
+
+      /// Cache accessor
+
+      /// The limit on the free blocks is read from the
+      /// \c TA_HUGE_PAGE_CACHE_BYTES environment variable; the default is
+      /// 256 MiB. Explicit huge pages are used when \c TA_HUGE_PAGE_EXPLICIT
+      /// is set to a non-zero value. The free blocks are returned to the
+      /// system when the memory governor needs memory (see
+      /// \c memory_budget() ). The cache is never destroyed, so that tiles
+      /// that are destroyed during program exit can still be deallocated.
+      /// \return A reference to the cache
+      static HugePageCache& instance() {
+        static HugePageCache* const cache = [] () {
+          const char* max_bytes = getenv("TA_HUGE_PAGE_CACHE_BYTES");
+          const char* explicit_pages = getenv("TA_HUGE_PAGE_EXPLICIT");
+          HugePageCache* const cache = new HugePageCache((max_bytes ?
+              std::strtoul(max_bytes, nullptr, 10) : 268435456ul),
+              explicit_pages && std::strtol(explicit_pages, nullptr, 10));
+          register_memory_cache(CachePriority::free_memory,
+              [cache] () { return cache->free_bytes(); },
+              [cache] (std::size_t) {
+                const std::size_t bytes = cache->free_bytes();
+                cache->release();
+                return bytes;
+              });
+          return cache;
+        }();
+        return *cache;
+      }
+
+      /// Mapped size of a block
+
+      /// \param bytes The block size
+      /// \return \c bytes rounded up to a multiple of the huge page size
+      static std::size_t mapped_bytes(const std::size_t bytes) {
+        const std::size_t page_size = huge_page_size();
+        return ((bytes + page_size - 1ul) / page_size) * page_size;
+      }
+
+      /// Set the memory registration hooks
+
+      /// The free blocks are deregistered with the previous hook and returned
+      /// to the system; blocks in use keep their registration, and are
+      /// deregistered with the hook that was set when they were registered.
+      /// \param reg The registration hook, or an empty function
+      /// \param dereg The deregistration hook, or an empty function
+      void set_registration(const register_type& reg,
+          const deregister_type& dereg)
+      {
+        release();
+        std::lock_guard<std::mutex> lock(mutex_);
+        register_ = reg;
+        deregister_ = dereg;
+      }
+
+      /// Allocate a block
+
+      /// \param bytes The size of the block
+      /// \return A pointer to a huge page aligned block of at least \c bytes
+      /// bytes
+      /// \throw std::bad_alloc When the system is out of memory
+      void* allocate(const std::size_t bytes) {
+        const std::size_t size = mapped_bytes(bytes);
+        register_type reg;
+        deregister_type dereg;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          const auto it = free_.find(size);
+          if(it != free_.end()) {
+            void* const p = it->second;
+            free_.erase(it);
+            free_bytes_ -= size;
+            ++reuses_;
+            return p;
+          }
+          reg = register_;
+          dereg = deregister_;
+        }
+
+        // Map and register the block outside the lock
+        void* const p = map(size);
+        Block block{ size, nullptr, dereg };
+        if(reg)
+          block.handle = reg(p, size);
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocks_.emplace(p, std::move(block));
+        return p;
+      }
+
+      /// Deallocate a block
+
+      /// The block is held by this cache unless that exceeds the cache limit.
+      /// \param p A pointer to a block allocated by this cache
+      void deallocate(void* const p) {
+        Block block;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          const auto it = blocks_.find(p);
+          TA_ASSERT(it != blocks_.end());
+          if(free_bytes_ + it->second.mapped_bytes <= max_bytes_) {
+            free_.emplace(it->second.mapped_bytes, p);
+            free_bytes_ += it->second.mapped_bytes;
+            return;
+          }
+          block = std::move(it->second);
+          blocks_.erase(it);
+        }
+        unmap(p, block);
+      }
+
+      /// Registration handle of a block
+
+      /// \param p A pointer to a block allocated by this cache
+      /// \return The handle returned by the registration hook for \c p , or
+      /// \c nullptr if \c p is not a registered block of this cache
+      void* registration(const void* const p) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = blocks_.find(const_cast<void*>(p));
+        return (it != blocks_.end() ? it->second.handle : nullptr);
+      }
+
+      /// Bytes of the free blocks held by this cache
+      std::size_t free_bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_bytes_;
+      }
+
+      /// Number of allocations that were served by a free block
+      std::size_t reuses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return reuses_;
+      }
+
+      /// Deregister all free blocks and return them to the system
+      void release() {
+        std::vector<std::pair<void*, Block> > blocks;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          for(const auto& free_block : free_) {
+            const auto it = blocks_.find(free_block.second);
+            blocks.emplace_back(it->first, std::move(it->second));
+            blocks_.erase(it);
+          }
+          free_.clear();
+          free_bytes_ = 0ul;
+        }
+        for(const auto& block : blocks)
+          unmap(block.first, block.second);
+      }
+
+    }; // class HugePageCache
+
+    /// Allocate a block that is not pooled
+
+    /// \param bytes The size of the block
+    /// \return A pointer to an aligned block of \c bytes bytes
+    /// \throw std::bad_alloc When the system is out of memory
+    inline void* unpooled_malloc(const std::size_t bytes) {
+      if(is_huge_page(bytes))
+        return HugePageCache::instance().allocate(bytes);
+      if(is_numa_interleaved(bytes))
+        return numa_interleaved_malloc(bytes);
+      return Eigen::internal::aligned_malloc(bytes);
+    }
+
+    /// Free a block allocated by \c unpooled_malloc()
+
+    /// \param p A pointer to the block
+    /// \param bytes The size of the block
+    inline void unpooled_free(void* const p, const std::size_t bytes) {
+      if(is_huge_page(bytes))
+        HugePageCache::instance().deallocate(p);
+      else if(is_numa_interleaved(bytes))
+        numa_interleaved_free(p, bytes);
+      else
+        Eigen::internal::aligned_free(p);
+    }
+
+    /// A pool of free memory blocks sorted by size class
+
+    /// Block sizes are rounded up to one of four size classes per power of
+    /// two, from 64 bytes to 32 MiB, so at most 25% of a block is unused.
+    /// Larger blocks, blocks that are interleaved across NUMA nodes (see
+    /// \c numa_interleave_bytes() ), and blocks that are backed by huge pages
+    /// (see \c huge_page_bytes() ), are not pooled. Free blocks are kept in a singly linked
+    /// list per size class, up to a limit on the total size of the free
+    /// blocks; blocks that would exceed the limit are returned to the
+    /// system. A \c MemoryPool is used by only one thread, but its counters
+    /// may be read by other threads.
+    class MemoryPool {
+    public:
+      static constexpr std::size_t min_block_log2 = 6ul; ///< Smallest block size (log2)
+      static constexpr std::size_t max_block_log2 = 25ul; ///< Largest pooled block size (log2)
+      static constexpr std::size_t class_steps = 4ul; ///< Size classes per power of two
+      static constexpr std::size_t num_classes =
+          (max_block_log2 - min_block_log2) * class_steps + 1ul; ///< Number of size classes
+
+    private:
+
+      /// Free block list node
+      struct Block {
+        Block* next; ///< The next free block of the same size class
+      }; // struct Block
+
+      Block* free_[num_classes]; ///< Free block lists
+      std::size_t max_bytes_; ///< Limit on the bytes held by this pool
+      std::atomic<std::size_t> allocations_; ///< Allocation count
+      std::atomic<std::size_t> hits_; ///< Pool hit count
+      std::atomic<std::size_t> deallocations_; ///< Deallocation count
+      std::atomic<std::size_t> pooled_bytes_; ///< Bytes held by this pool
+      std::atomic<std::size_t> peak_pooled_bytes_; ///< Peak bytes held by this pool
+
+      /// Increment a counter that is only modified by the owning thread
+      static void increment(std::atomic<std::size_t>& counter, const std::size_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n,
+            std::memory_order_relaxed);
+      }
+
+    public:
+
+      /// Construct an empty pool
+
+      /// \param max_bytes The limit on the total size of the free blocks held
+      /// by this pool
+      explicit MemoryPool(const std::size_t max_bytes) :
+        max_bytes_(max_bytes), allocations_(0ul), hits_(0ul),
+        deallocations_(0ul), pooled_bytes_(0ul), peak_pooled_bytes_(0ul)
+      {
+        std::fill_n(free_, num_classes, nullptr);
+      }
+
+      MemoryPool(const MemoryPool&) = delete;
+      MemoryPool& operator=(const MemoryPool&) = delete;
+
+      ~MemoryPool() { release(); }
+
+      /// Pooled block query
+
+      /// \param bytes The block size
+      /// \return \c true if blocks of \c bytes bytes are held by pools
+      static bool is_pooled(const std::size_t bytes) {
+        return ! (is_huge_page(bytes) || is_numa_interleaved(bytes) ||
+            (bytes > (1ul << max_block_log2)));
+      }
+
+      /// Size class of a block
+
+      /// \param bytes The block size, which may not be larger than the
+      /// largest pooled block size
+      /// \return The smallest size class that holds \c bytes
+      static std::size_t size_class(const std::size_t bytes) {
+        TA_ASSERT(bytes <= (1ul << max_block_log2));
+        if(bytes <= (1ul << min_block_log2))
+          return 0ul;
+
+        // Find e such that 2^e < bytes <= 2^(e+1)
+        std::size_t e = min_block_log2;
+        while((2ul << e) < bytes)
+          ++e;
+        const std::size_t step = (1ul << e) / class_steps;
+        const std::size_t sub = (bytes - (1ul << e) + step - 1ul) / step;
+        return (e - min_block_log2) * class_steps + sub;
+      }
+
+      /// Block size of a size class
+
+      /// \param c The size class
+      /// \return The size, in bytes, of blocks in size class \c c
+      static std::size_t class_bytes(const std::size_t c) {
+        TA_ASSERT(c < num_classes);
+        if(c == 0ul)
+          return (1ul << min_block_log2);
+        const std::size_t e = min_block_log2 + (c - 1ul) / class_steps;
+        const std::size_t sub = (c - 1ul) % class_steps + 1ul;
+        return (1ul << e) + sub * ((1ul << e) / class_steps);
+      }
+
+      /// Allocate a block
+
+      /// \param bytes The size of the block
+      /// \return A pointer to an aligned block of at least \c bytes bytes
+      /// \throw std::bad_alloc When the system is out of memory
+      void* allocate(const std::size_t bytes) {
+        increment(allocations_, 1ul);
+        if(! is_pooled(bytes))
+          return unpooled_malloc(bytes);
+
+        const std::size_t c = size_class(bytes);
+        Block* const block = free_[c];
+        if(block) {
+          free_[c] = block->next;
+          increment(hits_, 1ul);
+          pooled_bytes_.store(pooled_bytes_.load(std::memory_order_relaxed)
+              - class_bytes(c), std::memory_order_relaxed);
+          return block;
+        }
+
+        return Eigen::internal::aligned_malloc(class_bytes(c));
+      }
+
+      /// Deallocate a block
+
+      /// The block is held by this pool unless that exceeds the pool limit.
+      /// \param p A pointer to a block allocated by any \c MemoryPool
+      /// \param bytes The size of the block given to \c allocate()
+      void deallocate(void* const p, const std::size_t bytes) {
+        increment(deallocations_, 1ul);
+        if(! is_pooled(bytes)) {
+          unpooled_free(p, bytes);
+          return;
+        }
+
+        const std::size_t c = size_class(bytes);
+        const std::size_t pooled_bytes =
+            pooled_bytes_.load(std::memory_order_relaxed) + class_bytes(c);
+        if(pooled_bytes > max_bytes_) {
+          Eigen::internal::aligned_free(p);
+          return;
+        }
+
+        Block* const block = static_cast<Block*>(p);
+        block->next = free_[c];
+        free_[c] = block;
+        pooled_bytes_.store(pooled_bytes, std::memory_order_relaxed);
+        if(pooled_bytes > peak_pooled_bytes_.load(std::memory_order_relaxed))
+          peak_pooled_bytes_.store(pooled_bytes, std::memory_order_relaxed);
+      }
+
+      /// Return all free blocks held by this pool to the system
+      void release() {
+        for(std::size_t c = 0ul; c < num_classes; ++c) {
+          while(free_[c]) {
+            Block* const block = free_[c];
+            free_[c] = block->next;
+            Eigen::internal::aligned_free(block);
+          }
+        }
+        pooled_bytes_.store(0ul, std::memory_order_relaxed);
+      }
+
+      /// Add the statistics of this pool to \c stats
+
+      /// \param[in,out] stats The statistics accumulator
+      void accumulate(PoolAllocatorStats& stats) const {
+        stats.allocations += allocations_.load(std::memory_order_relaxed);
+        stats.hits += hits_.load(std::memory_order_relaxed);
+        stats.deallocations += deallocations_.load(std::memory_order_relaxed);
+        stats.pooled_bytes += pooled_bytes_.load(std::memory_order_relaxed);
+        stats.peak_pooled_bytes +=
+            peak_pooled_bytes_.load(std::memory_order_relaxed);
+      }
+
+    }; // class MemoryPool
+
+
+    /// Registry of the memory pools of all threads
+    class MemoryPoolRegistry {
+    private:
+      mutable std::mutex mutex_; ///< Protects the registry data
+      std::vector<const MemoryPool*> pools_; ///< The pools of live threads
+      PoolAllocatorStats retired_; ///< The statistics of finished threads
+
+      MemoryPoolRegistry() : mutex_(), pools_(), retired_() { }
+
+    public:
+
+      /// Registry accessor
+
+      /// The registry is never destroyed, so that threads that finish
+      /// during program exit can still unregister their pools.
+      /// \return A reference to the registry
+      static MemoryPoolRegistry& instance() {
+        static MemoryPoolRegistry* const registry = new MemoryPoolRegistry();
+        return *registry;
+      }
+
+      /// Register a thread pool
+
+      /// \param pool The pool to be registered
+      void insert(const MemoryPool* pool) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pools_.push_back(pool);
+      }
+
+      /// Unregister a thread pool and keep its statistics
+
+      /// \param pool The pool to be unregistered
+      void erase(const MemoryPool* pool) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pool->accumulate(retired_);
+        for(auto it = pools_.begin(); it != pools_.end(); ++it) {
+          if(*it == pool) {
+            pools_.erase(it);
+            break;
+          }
+        }
+      }
+
+      /// Collect the statistics of all pools
+
+      /// \return The sum of the statistics of all live and finished threads
+      PoolAllocatorStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PoolAllocatorStats result = retired_;
+        for(const MemoryPool* pool : pools_)
+          pool->accumulate(result);
+        return result;
+      }
+
+    }; // class MemoryPoolRegistry
+
+
+    /// Limit on the bytes held by each thread pool
+
+    /// The limit is read from the \c TA_POOL_ALLOCATOR_MAX_BYTES environment
+    /// variable; the default is 64 MiB. A limit of zero disables pooling.
+    /// \return The limit on the bytes held by each thread pool
+    inline std::size_t memory_pool_max_bytes() {
+      static const std::size_t max_bytes = [] () -> std::size_t {
+        const char* max_bytes = getenv("TA_POOL_ALLOCATOR_MAX_BYTES");
+        if(max_bytes)
+          return std::strtoul(max_bytes, nullptr, 10);
+        return 67108864ul;
+      }();
+      return max_bytes;
+    }
+
+    /// Memory pool of the calling thread
+
+    /// \return A pointer to the pool of the calling thread, or \c nullptr if
+    /// the pool of this thread has already been destroyed
+    inline MemoryPool* thread_memory_pool() {
+      static thread_local bool destroyed = false;
+      if(destroyed)
+        return nullptr;
+
+      struct Holder {
+        MemoryPool pool;
+
+        Holder() : pool(memory_pool_max_bytes()) {
+          MemoryPoolRegistry::instance().insert(& pool);
+        }
+
+        ~Holder() {
+          pool.release();
+          MemoryPoolRegistry::instance().erase(& pool);
+          destroyed = true;
+        }
+      }; // struct Holder
+
+      static thread_local Holder holder;
+      return & holder.pool;
+    }
+
+  }  // namespace detail
+
+
+  /// Thread-local, size-class pool allocator
+
+  /// Memory is allocated from a pool owned by the calling thread, which
+  /// avoids contention in the system allocator when temporary tiles are
+  /// frequently created and destroyed. Memory may be deallocated by any
+  /// thread, in which case the block is returned to the pool of the
+  /// deallocating thread. The memory is aligned as with
+  /// \c Eigen::aligned_allocator . Blocks of at least \c TA_HUGE_PAGE_BYTES
+  /// bytes are backed by huge pages, which reduces TLB misses in GEMM and
+  /// permutation of large tiles, and are cached with their memory
+  /// registration (see \c set_memory_registration() ).
+  /// \tparam T The element type
+  template <typename T>
+  class PoolAllocator {
+  public:
+    typedef T value_type; ///< Element type
+    typedef T* pointer; ///< Element pointer type
+    typedef const T* const_pointer; ///< Element const pointer type
+    typedef T& reference; ///< Element reference type
+    typedef const T& const_reference; ///< Element const reference type
+    typedef std::size_t size_type; ///< Size type
+    typedef std::ptrdiff_t difference_type; ///< Difference type
+
+    /// Allocator of another element type
+    template <typename U>
+    struct rebind {
+      typedef PoolAllocator<U> other;
+    }; // struct rebind
+
+    PoolAllocator() noexcept { }
+    PoolAllocator(const PoolAllocator&) noexcept { }
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept { }
+    ~PoolAllocator() { }
+
+    /// Allocate an array
+
+    /// \param n The number of elements
+    /// \return A pointer to uninitialized memory for \c n elements, or
+    /// \c nullptr if \c n is zero
+    /// \throw std::bad_alloc When the system is out of memory
+    pointer allocate(const size_type n, const void* = nullptr) {
+      if(n == 0ul)
+        return nullptr;
+      if(n > max_size())
+        throw std::bad_alloc();
+      const std::size_t bytes = n * sizeof(T);
+      detail::MemoryPool* const pool = detail::thread_memory_pool();
+      if(pool)
+        return static_cast<pointer>(pool->allocate(bytes));
+
+      // A block of a pooled size may be deallocated into the pool of another
+      // thread, so it must have the size of its size class.
+      if(detail::MemoryPool::is_pooled(bytes))
+        return static_cast<pointer>(Eigen::internal::aligned_malloc(
+            detail::MemoryPool::class_bytes(
+            detail::MemoryPool::size_class(bytes))));
+      return static_cast<pointer>(detail::unpooled_malloc(bytes));
+    }
+
+    /// Deallocate an array
+
+    /// \param p A pointer returned by \c allocate()
+    /// \param n The number of elements given to \c allocate()
+    void deallocate(const pointer p, const size_type n) {
+      if(p == nullptr)
+        return;
+      const std::size_t bytes = n * sizeof(T);
+      detail::MemoryPool* const pool = detail::thread_memory_pool();
+      if(pool)
+        pool->deallocate(p, bytes);
+      else
+        detail::unpooled_free(p, bytes);
+    }
+
+    /// Maximum number of elements that may be allocated
+    size_type max_size() const noexcept {
+      return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    /// Construct an element
+
+    /// \param p The uninitialized element
+    /// \param value The value to copy into \c p
+    void construct(const pointer p, const_reference value) {
+      ::new(static_cast<void*>(p)) T(value);
+    }
+
+    /// Destroy an element
+
+    /// \param p The element to be destroyed
+    void destroy(const pointer p) { p->~T(); }
+
+  }; // class PoolAllocator
+
+  template <typename T, typename U>
+  inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return true;
+  }
+
+  template <typename T, typename U>
+  inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return false;
+  }
+
+  /// Pool allocator statistics
+
+  /// \return The statistics of the pool allocator for all threads
+  inline PoolAllocatorStats pool_allocator_stats() {
+    return detail::MemoryPoolRegistry::instance().stats();
+  }
+
+  /// Release the pool of the calling thread
+
+  /// All free blocks held by the pool of the calling thread are returned to
+  /// the system.
+  inline void pool_allocator_release() {
+    detail::MemoryPool* const pool = detail::thread_memory_pool();
+    if(pool)
+      pool->release();
+  }
+
+  /// Set the memory registration hooks of huge page blocks
+
+  /// Each huge page block is registered with \c reg when it is mapped, e.g.
+  /// with the network for RDMA or with a GPU driver for pinned transfers,
+  /// and deregistered with \c dereg when it is returned to the system.
+  /// Since freed blocks are cached, a registration is reused by later tiles
+  /// of the same size. The free blocks that are cached when the hooks are
+  /// changed are returned to the system.
+  /// \param reg The registration hook, which returns a handle to the
+  /// registration, or an empty function
+  /// \param dereg The deregistration hook, or an empty function
+  inline void set_memory_registration(
+      const detail::HugePageCache::register_type& reg,
+      const detail::HugePageCache::deregister_type& dereg)
+  {
+    detail::HugePageCache::instance().set_registration(reg, dereg);
+  }
+
+  /// Memory registration of a huge page block
+
+  /// \param p A pointer to the data of a tile
+  /// \return The handle returned by the registration hook for \c p , or
+  /// \c nullptr if \c p is not a registered huge page block
+  inline void* memory_registration(const void* const p) {
+    return detail::HugePageCache::instance().registration(p);
+  }
+
+  /// Release the huge page cache
+
+  /// All free huge page blocks are deregistered and returned to the system.
+  inline void huge_page_cache_release() {
+    detail::HugePageCache::instance().release();
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TENSOR_POOL_ALLOCATOR_H__INCLUDED
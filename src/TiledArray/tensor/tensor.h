@@ -20,10 +20,14 @@
 #ifndef TILEDARRAY_TENSOR_TENSOR_H__INCLUDED
 #define TILEDARRAY_TENSOR_TENSOR_H__INCLUDED
 
+#include <TiledArray/bitset.h>
 #include <TiledArray/math/gemm_helper.h>
 #include <TiledArray/math/blas.h>
+#include <TiledArray/math/outer.h>
+#include <TiledArray/math/parallel_gemm.h>
 #include <TiledArray/tensor/kernels.h>
 #include <TiledArray/tensor/complex.h>
+#include <TiledArray/tensor/pool_allocator.h>
 
 namespace TiledArray {
 
@@ -31,7 +35,8 @@ namespace TiledArray {
 
   /// \tparam T the value type of this tensor
   /// \tparam A The allocator type for the data
-  template <typename T, typename A = Eigen::aligned_allocator<T> >
+  template <typename T,
+      typename A = typename detail::default_tensor_allocator<T>::type>
   class Tensor {
   public:
     typedef Tensor<T, A> Tensor_; ///< This class type
@@ -65,25 +70,40 @@ namespace TiledArray {
       /// Default constructor
 
       /// Construct an empty tensor that has no data or dimensions
-      Impl() : allocator_type(), range_(), data_(NULL) { }
+      Impl() : allocator_type(), range_(), data_(NULL), owner_() { }
 
       /// Construct with range
 
       /// \param range The N-dimensional range for this tensor
       explicit Impl(const range_type& range) :
-        allocator_type(), range_(range), data_(NULL)
+        allocator_type(), range_(range), data_(NULL), owner_()
       {
         data_ = allocator_type::allocate(range.volume());
       }
 
+      /// Construct a view of external data
+
+      /// \param range The N-dimensional range for this tensor
+      /// \param data The tensor data, which is not freed by this object
+      /// \param owner The object that keeps \c data alive
+      Impl(const range_type& range, pointer data,
+          const std::shared_ptr<void>& owner) :
+        allocator_type(), range_(range), data_(data), owner_(owner)
+      {
+        TA_ASSERT(owner_);
+      }
+
       ~Impl() {
-        math::destroy_vector(range_.volume(), data_);
-        allocator_type::deallocate(data_, range_.volume());
+        if(! owner_) {
+          math::destroy_vector(range_.volume(), data_);
+          allocator_type::deallocate(data_, range_.volume());
+        }
         data_ = NULL;
       }
 
       range_type range_; ///< Tensor size info
       pointer data_; ///< Tensor data
+      std::shared_ptr<void> owner_; ///< The owner of external data
     }; // class Impl
 
     template <typename... Ts>
@@ -179,6 +199,26 @@ namespace TiledArray {
       math::uninitialized_copy_vector(range.volume(), u, pimpl_->data_);
     }
 
+    /// Construct a view of external data
+
+    /// The tensor, and all of its shallow copies, use \c data directly
+    /// instead of allocating a copy, and they hold a reference to \c owner
+    /// so that \c data remains valid while any copy exists. \c data is not
+    /// freed by the tensor. Operations that modify the tensor in place write
+    /// to \c data .
+    /// \param range The range of the tensor
+    /// \param data A pointer to \c range.volume() initialized elements
+    /// \param owner The object that owns \c data
+    Tensor(const range_type& range, pointer data,
+        const std::shared_ptr<void>& owner) :
+      pimpl_(new Impl(range, data, owner))
+    { }
+
+    /// External data query
+
+    /// \return \c true if this tensor is a view of external data
+    bool is_view() const { return pimpl_ && pimpl_->owner_; }
+
     /// Construct a copy of a tensor interface object
 
     /// \tparam T1 A tensor type
@@ -504,6 +544,87 @@ namespace TiledArray {
           lower_bound, upper_bound), pimpl_->data_);
     }
 
+    /// Create a view of every <tt>step[i]</tt>-th element of a block
+
+    /// \tparam Index An array type
+    /// \param lower_bound The lower bound of the block
+    /// \param upper_bound The upper bound of the block
+    /// \param step The step of each dimension
+    /// \return A strided view of the elements of this tensor
+    template <typename Index>
+    detail::TensorInterface<T, StridedRange>
+    slice(const Index& lower_bound, const Index& upper_bound, const Index& step) {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<T, StridedRange>(StridedRange(pimpl_->range_,
+          lower_bound, upper_bound, step), pimpl_->data_);
+    }
+
+    detail::TensorInterface<T, StridedRange>
+    slice(const std::initializer_list<size_type>& lower_bound,
+        const std::initializer_list<size_type>& upper_bound,
+        const std::initializer_list<size_type>& step)
+    {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<T, StridedRange>(StridedRange(pimpl_->range_,
+          lower_bound, upper_bound, step), pimpl_->data_);
+    }
+
+    template <typename Index>
+    detail::TensorInterface<const T, StridedRange>
+    slice(const Index& lower_bound, const Index& upper_bound,
+        const Index& step) const
+    {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<const T, StridedRange>(StridedRange(pimpl_->range_,
+          lower_bound, upper_bound, step), pimpl_->data_);
+    }
+
+    detail::TensorInterface<const T, StridedRange>
+    slice(const std::initializer_list<size_type>& lower_bound,
+        const std::initializer_list<size_type>& upper_bound,
+        const std::initializer_list<size_type>& step) const
+    {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<const T, StridedRange>(StridedRange(pimpl_->range_,
+          lower_bound, upper_bound, step), pimpl_->data_);
+    }
+
+    /// Create a view of the diagonal of this tensor
+
+    /// \return A rank-1 view of the elements with equal coordinate indices
+    /// (relative to the lower bound)
+    detail::TensorInterface<T, StridedRange> diagonal() {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<T, StridedRange>(
+          diagonal_range(pimpl_->range_), pimpl_->data_);
+    }
+
+    detail::TensorInterface<const T, StridedRange> diagonal() const {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<const T, StridedRange>(
+          diagonal_range(pimpl_->range_), pimpl_->data_);
+    }
+
+    /// Create a view of this tensor with one fixed coordinate index
+
+    /// \param dim The dimension that is fixed
+    /// \param index The coordinate index of dimension \c dim
+    /// \return A view of the elements with coordinate index \c index in
+    /// dimension \c dim , with the other dimensions of this tensor
+    detail::TensorInterface<T, StridedRange>
+    fix(const unsigned int dim, const size_type index) {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<T, StridedRange>(
+          fixed_index_range(pimpl_->range_, dim, index), pimpl_->data_);
+    }
+
+    detail::TensorInterface<const T, StridedRange>
+    fix(const unsigned int dim, const size_type index) const {
+      TA_ASSERT(pimpl_);
+      return detail::TensorInterface<const T, StridedRange>(
+          fixed_index_range(pimpl_->range_, dim, index), pimpl_->data_);
+    }
+
     /// Create a permuted copy of this tensor
 
     /// \param perm The permutation to be applied to this tensor
@@ -512,6 +633,24 @@ namespace TiledArray {
       return Tensor_(*this, perm);
     }
 
+    /// Permute this tensor in place
+
+    /// When \c perm moves only unit dimensions (see
+    /// \c detail::is_layout_preserving() ) the data is not moved; only the
+    /// range is permuted, like \c shift_to() , and the shallow copies of this
+    /// tensor are also permuted. Otherwise this tensor is replaced by a
+    /// permuted copy.
+    /// \param perm The permutation to be applied to this tensor
+    /// \return A reference to this tensor
+    Tensor_& permute_to(const Permutation& perm) {
+      TA_ASSERT(pimpl_);
+      if(detail::is_layout_preserving(perm, pimpl_->range_))
+        pimpl_->range_ = perm * pimpl_->range_;
+      else
+        *this = permute(perm);
+      return *this;
+    }
+
 
     /// Shift the lower and upper bound of this tensor
 
@@ -527,17 +666,38 @@ namespace TiledArray {
 
     /// Shift the lower and upper bound of this range
 
+    /// The data is not copied; like other shallow copies of this tensor, the
+    /// result shares the data of this tensor, which remains valid while the
+    /// result exists. Only the range of the result is shifted.
     /// \tparam Index The shift array type
     /// \param bound_shift The shift to be applied to the tensor range
-    /// \return A shifted copy of this tensor
+    /// \return A shifted shallow copy of this tensor
     template <typename Index>
     Tensor_ shift(const Index& bound_shift) const {
       TA_ASSERT(pimpl_);
-      Tensor_ result = clone();
+      Tensor_ result(pimpl_->range_, pimpl_->data_, (pimpl_->owner_ ?
+          pimpl_->owner_ : std::static_pointer_cast<void>(pimpl_)));
       result.shift_to(bound_shift);
       return result;
     }
 
+    /// Reinterpret the elements of this tensor with another range
+
+    /// The data is not copied; like \c shift() , the result shares the data of
+    /// this tensor and only has a different range. The elements keep their
+    /// row-major order, so e.g. a tensor with range <tt>[0,n)x[0,m)</tt>
+    /// reshaped to <tt>[0,n*m)</tt> holds element <tt>(i,j)</tt> at
+    /// <tt>i*m+j</tt> .
+    /// \param range The range of the result, which must have the same volume
+    /// as the range of this tensor
+    /// \return A shallow copy of this tensor with range \c range
+    Tensor_ reshape(const range_type& range) const {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(range.volume() == pimpl_->range_.volume());
+      return Tensor_(range, pimpl_->data_, (pimpl_->owner_ ?
+          pimpl_->owner_ : std::static_pointer_cast<void>(pimpl_)));
+    }
+
     // Generic vector operations
 
     /// Use a binary, element wise operation to construct a new tensor
@@ -588,6 +748,71 @@ namespace TiledArray {
       return *this;
     }
 
+    /// Use a binary, element wise operation with a permuted argument to construct a new tensor
+
+    /// This tensor is permuted by \c perm and combined with \c right , which
+    /// is already in the permuted layout, in a single pass; the permuted copy
+    /// of this tensor is never stored.
+    /// \tparam Right The right-hand tensor type
+    /// \tparam Op The binary operation type
+    /// \param perm The permutation to be applied to this tensor
+    /// \param right The right-hand argument in the binary operation
+    /// \param op The binary, element-wise operation
+    /// \return A tensor where element \c perm^i of the new tensor is equal to
+    /// \c op(*this[i],right[perm^i])
+    /// \throw TiledArray::Exception When this tensor is empty.
+    /// \throw TiledArray::Exception When \c right is empty.
+    /// \throw TiledArray::Exception When the range of \c right is not equal to
+    /// the permuted range of this tensor.
+    template <typename Right, typename Op,
+        typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
+    Tensor_ binary(const Permutation& perm, const Right& right, Op&& op) const {
+      TA_ASSERT(! right.empty());
+
+      Tensor_ result(right.range());
+      const pointer result_data = result.data();
+      const auto* MADNESS_RESTRICT const right_data = right.data();
+
+      auto input_op = [] (const numeric_type value) -> numeric_type
+      { return value; };
+      auto output_op = [=] (pointer MADNESS_RESTRICT const result_value,
+          const numeric_type value)
+      { *result_value = op(value, right_data[result_value - result_data]); };
+
+      detail::inplace_tensor_op(input_op, output_op, perm, result, *this);
+
+      return result;
+    }
+
+    /// Use a binary, element wise operation with a permuted argument to modify this tensor
+
+    /// \c arg is permuted by \c perm and combined with this tensor in a single
+    /// pass; the permuted copy of \c arg is never stored.
+    /// \tparam Arg The argument tensor type
+    /// \tparam Op The binary operation type
+    /// \param arg The argument in the binary operation
+    /// \param perm The permutation to be applied to \c arg
+    /// \param op The binary, element-wise operation, which is called as
+    /// \c op(*this[perm^i],arg[i])
+    /// \return A reference to this object
+    /// \throw TiledArray::Exception When this tensor is empty.
+    /// \throw TiledArray::Exception When \c arg is empty.
+    /// \throw TiledArray::Exception When the range of this tensor is not equal
+    /// to the permuted range of \c arg.
+    template <typename Arg, typename Op,
+        typename std::enable_if<is_tensor<Arg>::value>::type* = nullptr>
+    Tensor_& inplace_binary(const Arg& arg, const Permutation& perm, Op&& op) {
+      auto input_op = [] (const numeric_t<Arg> value) -> numeric_t<Arg>
+      { return value; };
+      auto output_op = [=] (pointer MADNESS_RESTRICT const result_value,
+          const numeric_t<Arg> value)
+      { op(*result_value, value); };
+
+      detail::inplace_tensor_op(input_op, output_op, perm, *this, arg);
+
+      return *this;
+    }
+
     /// Use a unary, element wise operation to construct a new tensor
 
     /// \tparam Op The unary operation type
@@ -637,8 +862,7 @@ namespace TiledArray {
     template <typename Scalar,
         typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_ scale(const Scalar factor) const {
-      return unary([=] (const numeric_type a) -> numeric_type
-          { return a * factor; });
+      return unary(math::SimdScaleOp<numeric_type, Scalar>(factor));
     }
 
     /// Construct a scaled and permuted copy of this tensor
@@ -663,7 +887,7 @@ namespace TiledArray {
     template <typename Scalar,
         typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_& scale_to(const Scalar factor) {
-      return inplace_unary([=] (numeric_type& MADNESS_RESTRICT res) { res *= factor; });
+      return inplace_unary(math::SimdScaleToOp<numeric_type, Scalar>(factor));
     }
 
     // Addition operations
@@ -677,9 +901,7 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_ add(const Right& right) const {
-      return binary(right, [] (const numeric_type l,
-          const numeric_t<Right> r)
-          -> numeric_type { return l + r; });
+      return binary(right, math::SimdBinaryOp<numeric_type, math::simd_add>());
     }
 
     /// Add this and \c other to construct a new, permuted tensor
@@ -709,9 +931,8 @@ namespace TiledArray {
         typename std::enable_if<is_tensor<Right>::value &&
         detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_ add(const Right& right, const Scalar factor) const {
-      return binary(right, [=] (const numeric_type l,
-          const numeric_t<Right> r)
-          -> numeric_type { return (l + r) * factor; });
+      return binary(right,
+          math::SimdScalBinaryOp<numeric_type, math::simd_add, Scalar>(factor));
     }
 
     /// Scale and add this and \c other to construct a new, permuted tensor
@@ -763,8 +984,8 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_& add_to(const Right& right) {
-      return inplace_binary(right, [] (numeric_type& MADNESS_RESTRICT l,
-          const numeric_t<Right> r) { l += r; });
+      return inplace_binary(right,
+          math::SimdInplaceOp<numeric_type, math::simd_add>());
     }
 
     /// Add \c other to this tensor, and scale the result
@@ -778,9 +999,8 @@ namespace TiledArray {
         typename std::enable_if<is_tensor<Right>::value &&
         detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_& add_to(const Right& right, const Scalar factor) {
-      return inplace_binary(right, [=] (numeric_type& MADNESS_RESTRICT l,
-          const numeric_t<Right> r)
-          { (l += r) *= factor; });
+      return inplace_binary(right,
+          math::SimdScalInplaceOp<numeric_type, math::simd_add, Scalar>(factor));
     }
 
     /// Add a constant to this tensor
@@ -802,9 +1022,7 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_ subt(const Right& right) const {
-      return binary(right, [] (const numeric_type l,
-          const numeric_t<Right> r)
-          -> numeric_type { return l - r; });
+      return binary(right, math::SimdBinaryOp<numeric_type, math::simd_subt>());
     }
 
     /// Subtract this and \c right to construct a new, permuted tensor
@@ -834,9 +1052,8 @@ namespace TiledArray {
         typename std::enable_if<is_tensor<Right>::value &&
         detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_ subt(const Right& right, const Scalar factor) const {
-      return binary(right, [=] (const numeric_type l,
-          const numeric_t<Right> r)
-          -> numeric_type { return (l - r) * factor; });
+      return binary(right,
+          math::SimdScalBinaryOp<numeric_type, math::simd_subt, Scalar>(factor));
     }
 
     /// Scale and subtract this and \c right to construct a new, permuted tensor
@@ -885,9 +1102,8 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_& subt_to(const Right& right) {
-      return inplace_binary(right, [] (numeric_type& MADNESS_RESTRICT l,
-          const numeric_t<Right> r)
-          { l -= r; });
+      return inplace_binary(right,
+          math::SimdInplaceOp<numeric_type, math::simd_subt>());
     }
 
     /// Subtract \c right from and scale this tensor
@@ -901,9 +1117,8 @@ namespace TiledArray {
         typename std::enable_if<is_tensor<Right>::value &&
         detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_& subt_to(const Right& right, const Scalar factor) {
-      return inplace_binary(right, [=] (numeric_type& MADNESS_RESTRICT l,
-          const numeric_t<Right> r)
-          { (l -= r) *= factor; });
+      return inplace_binary(right,
+          math::SimdScalInplaceOp<numeric_type, math::simd_subt, Scalar>(factor));
     }
 
     /// Subtract a constant from this tensor
@@ -924,9 +1139,7 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_ mult(const Right& right) const {
-      return binary(right, [] (const numeric_type l,
-          const numeric_t<Right> r)
-          -> numeric_type { return l * r; });
+      return binary(right, math::SimdBinaryOp<numeric_type, math::simd_mult>());
     }
 
     /// Multiply this by \c right to create a new, permuted tensor
@@ -956,9 +1169,8 @@ namespace TiledArray {
         typename std::enable_if<is_tensor<Right>::value &&
         detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_ mult(const Right& right, const Scalar factor) const {
-      return binary(right, [=] (const numeric_type l,
-          const numeric_t<Right> r)
-          -> numeric_type { return (l * r) * factor; });
+      return binary(right,
+          math::SimdScalBinaryOp<numeric_type, math::simd_mult, Scalar>(factor));
     }
 
     /// Scale and multiply this by \c right to create a new, permuted tensor
@@ -989,9 +1201,8 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     Tensor_& mult_to(const Right& right) {
-      return inplace_binary(right, [] (numeric_type& MADNESS_RESTRICT l,
-          const numeric_t<Right> r)
-          { l *= r; });
+      return inplace_binary(right,
+          math::SimdInplaceOp<numeric_type, math::simd_mult>());
     }
 
     /// Scale and multiply this tensor by \c right
@@ -1005,9 +1216,8 @@ namespace TiledArray {
         typename std::enable_if<is_tensor<Right>::value &&
         detail::is_numeric<Scalar>::value>::type* = nullptr>
     Tensor_& mult_to(const Right& right, const Scalar factor) {
-      return inplace_binary(right, [=] (numeric_type& MADNESS_RESTRICT l,
-          const numeric_t<Right> r)
-          { (l *= r) *= factor; });
+      return inplace_binary(right,
+          math::SimdScalInplaceOp<numeric_type, math::simd_mult, Scalar>(factor));
     }
 
     // Negation operations
@@ -1102,6 +1312,57 @@ namespace TiledArray {
       return scale_to(detail::conj_op(factor));
     }
 
+    // Mask operations
+
+    /// Create a masked copy of this tensor
+
+    /// The elements of the result whose bits are cleared in \c mask are
+    /// zero, and the others are copied from this tensor. The mask is applied
+    /// to runs of elements, so a bit-packed mask does not need to be
+    /// expanded into a tensor of the element type.
+    /// \tparam Block The bitset block type
+    /// \param mask The element mask, with one bit per element in the
+    /// ordinal order of the elements
+    /// \return A masked copy of this tensor
+    template <typename Block>
+    Tensor_ mask(const detail::Bitset<Block>& mask) const {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(mask.size() == pimpl_->range_.volume());
+      Tensor_ result(pimpl_->range_);
+      const_pointer MADNESS_RESTRICT const data = pimpl_->data_;
+      pointer MADNESS_RESTRICT const result_data = result.data();
+      detail::for_each_bit_run(mask, [=] (const std::size_t first,
+          const std::size_t last, const bool value)
+      {
+        if(value)
+          std::copy(data + first, data + last, result_data + first);
+        else
+          std::fill(result_data + first, result_data + last, value_type(0));
+      });
+      return result;
+    }
+
+    /// Mask this tensor
+
+    /// The elements whose bits are cleared in \c mask are set to zero.
+    /// \tparam Block The bitset block type
+    /// \param mask The element mask, with one bit per element in the
+    /// ordinal order of the elements
+    /// \return A reference to this tensor
+    template <typename Block>
+    Tensor_& mask_to(const detail::Bitset<Block>& mask) {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(mask.size() == pimpl_->range_.volume());
+      pointer MADNESS_RESTRICT const data = pimpl_->data_;
+      detail::for_each_bit_run(mask, [=] (const std::size_t first,
+          const std::size_t last, const bool value)
+      {
+        if(! value)
+          std::fill(data + first, data + last, value_type(0));
+      });
+      return *this;
+    }
+
     // GEMM operations
 
     /// Contract this tensor with \c other
@@ -1116,7 +1377,9 @@ namespace TiledArray {
     /// \c other and scaled by \c factor
     /// \throw TiledArray::Exception When this tensor is empty.
     /// \throw TiledArray::Exception When \c other is empty.
-    template <typename U, typename AU, typename V>
+    template <typename U, typename AU, typename V,
+        typename std::enable_if<! detail::is_mixed_arithmetic<U,
+            numeric_type>::value>::type* = nullptr>
     Tensor_ gemm(const Tensor<U, AU>& other, const V factor,
         const math::GemmHelper& gemm_helper) const
     {
@@ -1141,16 +1404,56 @@ namespace TiledArray {
       integer m = 1, n = 1, k = 1;
       gemm_helper.compute_matrix_sizes(m, n, k, pimpl_->range_, other.range());
 
+      // Compute outer products, which have no contracted dimensions, without
+      // a *GEMM call
+      if(gemm_helper.num_contract_ranks() == 0u) {
+        math::outer_fill(m, n, pimpl_->data_, other.data(), result.data(),
+            [factor] (const numeric_type left, const U right)
+            { return left * right * factor; });
+        return result;
+      }
+
       // Get the leading dimension for left and right matrices.
       const integer lda = (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
       const integer ldb = (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
 
-      math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
-          pimpl_->data_, lda, other.data(), ldb, numeric_type(0), result.data(), n);
+      math::parallel_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k,
+          factor, pimpl_->data_, lda, other.data(), ldb, numeric_type(0),
+          result.data(), n);
 
       return result;
     }
 
+    /// Contract this tensor with \c other , which has another real element type
+
+    /// The elements of \c other are converted to the element type of this
+    /// tensor as they are packed for the *GEMM call, so no converted copy of
+    /// \c other is stored.
+    /// \tparam U The other tensor element type
+    /// \tparam AU The other tensor allocator type
+    /// \tparam V The type of \c factor scalar
+    /// \param other The tensor that will be contracted with this tensor
+    /// \param factor Multiply the result by this constant
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \return A new tensor which is the result of contracting this tensor with
+    /// \c other and scaled by \c factor
+    /// \throw TiledArray::Exception When this tensor is empty.
+    /// \throw TiledArray::Exception When \c other is empty.
+    template <typename U, typename AU, typename V,
+        typename std::enable_if<detail::is_mixed_arithmetic<U,
+            numeric_type>::value>::type* = nullptr>
+    Tensor_ gemm(const Tensor<U, AU>& other, const V factor,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(!other.empty());
+
+      Tensor_ result(gemm_helper.make_result_range<range_type>(pimpl_->range_,
+          other.range()), numeric_type(0));
+      result.gemm(*this, other, factor, gemm_helper);
+      return result;
+    }
+
     /// Contract two tensors and store the result in this tensor
 
     /// Gemm is limited to matrix like contractions. For example, the following
@@ -1192,7 +1495,10 @@ namespace TiledArray {
     /// \return A new tensor which is the result of contracting this tensor with
     /// other
     /// \throw TiledArray::Exception When this tensor is empty.
-    template <typename U, typename AU, typename V, typename AV, typename W>
+    template <typename U, typename AU, typename V, typename AV, typename W,
+        typename std::enable_if<! (detail::is_mixed_arithmetic<U,
+            numeric_type>::value || detail::is_mixed_arithmetic<V,
+            numeric_type>::value)>::type* = nullptr>
     Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
         const W factor, const math::GemmHelper& gemm_helper)
     {
@@ -1236,14 +1542,320 @@ namespace TiledArray {
       integer m, n, k;
       gemm_helper.compute_matrix_sizes(m, n, k, left.range(), right.range());
 
+      // Compute outer products, which have no contracted dimensions, without
+      // a *GEMM call
+      if(gemm_helper.num_contract_ranks() == 0u) {
+        math::outer(m, n, left.data(), right.data(), pimpl_->data_,
+            [factor] (numeric_type& result, const U l, const V r)
+            { result += l * r * factor; });
+        return *this;
+      }
+
       // Get the leading dimension for left and right matrices.
       const integer lda =
           (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
       const integer ldb =
           (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
 
-      math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
-          left.data(), lda, right.data(), ldb, numeric_type(1), pimpl_->data_, n);
+      math::parallel_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k,
+          factor, left.data(), lda, right.data(), ldb, numeric_type(1),
+          pimpl_->data_, n);
+
+      return *this;
+    }
+
+    /// Contract two tensors, which have other real element types, and store the result in this tensor
+
+    /// The arguments with other element types are converted to the element
+    /// type of this tensor as they are packed for the *GEMM calls (see the
+    /// contraction of permuted tensors below), so no converted copy of an
+    /// argument is stored and the contraction is computed in the precision of
+    /// this tensor.
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam W The type of the scaling factor
+    /// \param left The left-hand tensor that will be contracted
+    /// \param right The right-hand tensor that will be contracted
+    /// \param factor The scaling factor
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \return A reference to this tensor
+    /// \throw TiledArray::Exception When this tensor is empty.
+    template <typename U, typename AU, typename V, typename AV, typename W,
+        typename std::enable_if<detail::is_mixed_arithmetic<U,
+            numeric_type>::value || detail::is_mixed_arithmetic<V,
+            numeric_type>::value>::type* = nullptr>
+    Tensor_& gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
+        const W factor, const math::GemmHelper& gemm_helper)
+    {
+      return gemm(left, Permutation(), right, Permutation(), factor,
+          gemm_helper);
+    }
+
+    /// Contract two permuted tensors and store the result in this tensor
+
+    /// This function evaluates
+    /// <tt>this += factor * (left_perm * left) * (right_perm * right)</tt>
+    /// without storing the permuted arguments, which allows contraction of
+    /// tensors whose inner and outer indices do not form two contiguous
+    /// groups, e.g.
+    /// \code
+    /// C[a,b] = A[i,a,j] * B[j,b,i]
+    /// \endcode
+    /// The rows of a permuted left-hand argument, or the columns of a permuted
+    /// right-hand argument, are packed into a buffer that fits in cache one
+    /// block at a time, and each block is contracted with a *GEMM call. The
+    /// permuted arguments must fit the non-transposed patterns above, that is
+    /// <tt>left_perm * left</tt> is <tt>[M...,K...]</tt> and
+    /// <tt>right_perm * right</tt> is <tt>[K...,N...]</tt>. An argument with
+    /// an empty permutation is used as is, and may be transposed, unless it
+    /// has another real element type than this tensor; such an argument is
+    /// packed too, and its elements are converted to the element type of
+    /// this tensor as they are packed, e.g. a \c float argument of a
+    /// \c double contraction, so no converted copy of it is stored.
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam W The type of the scaling factor
+    /// \param left The left-hand tensor that will be contracted
+    /// \param left_perm The permutation applied to \c left
+    /// \param right The right-hand tensor that will be contracted
+    /// \param right_perm The permutation applied to \c right
+    /// \param factor The scaling factor
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \return A reference to this tensor
+    /// \throw TiledArray::Exception When this tensor is empty.
+    template <typename U, typename AU, typename V, typename AV, typename W>
+    Tensor_& gemm(const Tensor<U, AU>& left, const Permutation& left_perm,
+        const Tensor<V, AV>& right, const Permutation& right_perm,
+        const W factor, const math::GemmHelper& gemm_helper)
+    {
+      // Element types of the packed arguments
+      typedef typename std::conditional<
+          detail::is_mixed_arithmetic<U, numeric_type>::value, numeric_type,
+          U>::type left_value_type;
+      typedef typename std::conditional<
+          detail::is_mixed_arithmetic<V, numeric_type>::value, numeric_type,
+          V>::type right_value_type;
+      const bool pack_left = left_perm ||
+          ! std::is_same<U, left_value_type>::value;
+      const bool pack_right = right_perm ||
+          ! std::is_same<V, right_value_type>::value;
+
+      if(! (pack_left || pack_right))
+        return gemm(left, right, factor, gemm_helper);
+
+      // Check that this tensor and the arguments are not empty and have the
+      // correct rank
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.result_rank());
+      TA_ASSERT(!left.empty());
+      TA_ASSERT(left.range().rank() == gemm_helper.left_rank());
+      TA_ASSERT(!right.empty());
+      TA_ASSERT(right.range().rank() == gemm_helper.right_rank());
+      TA_ASSERT((! left_perm) || (gemm_helper.left_op() == madness::cblas::NoTrans));
+      TA_ASSERT((! right_perm) || (gemm_helper.right_op() == madness::cblas::NoTrans));
+
+      // Get the ranges of the permuted arguments
+      const range_type left_range =
+          (left_perm ? left_perm * left.range() : left.range());
+      const range_type right_range =
+          (right_perm ? right_perm * right.range() : right.range());
+
+      // Check that the outer dimensions of the arguments match the
+      // corresponding dimensions in result, and that the inner dimensions of
+      // left and right match
+      TA_ASSERT(gemm_helper.left_result_coformal(left_range.extent_data(),
+          pimpl_->range_.extent_data()));
+      TA_ASSERT(gemm_helper.right_result_coformal(right_range.extent_data(),
+          pimpl_->range_.extent_data()));
+      TA_ASSERT(gemm_helper.left_right_coformal(left_range.extent_data(),
+          right_range.extent_data()));
+
+      // Compute gemm dimensions
+      integer m, n, k;
+      gemm_helper.compute_matrix_sizes(m, n, k, left_range, right_range);
+      const bool left_notrans = (gemm_helper.left_op() == madness::cblas::NoTrans);
+      const bool right_notrans = (gemm_helper.right_op() == madness::cblas::NoTrans);
+
+      // Packed blocks are not transposed. The elements of real matrices,
+      // which are the only ones that are converted, are not conjugated.
+      const madness::cblas::CBLAS_TRANSPOSE left_op =
+          (pack_left ? madness::cblas::NoTrans : gemm_helper.left_op());
+      const madness::cblas::CBLAS_TRANSPOSE right_op =
+          (pack_right ? madness::cblas::NoTrans : gemm_helper.right_op());
+      const integer lda = (left_notrans || pack_left ? k : m);
+      const integer ldb = (right_notrans ? n : k);
+
+      // Compute the element offsets of the rows and columns of the packed
+      // argument matrices
+      auto strided_offsets = [] (const integer size, const integer stride) {
+        std::vector<size_type> offsets(size);
+        for(integer i = 0; i < size; ++i)
+          offsets[i] = i * stride;
+        return offsets;
+      };
+      std::vector<size_type> left_rows, left_cols, right_rows, right_cols;
+      if(left_perm) {
+        const unsigned int inner = gemm_helper.left_inner_begin();
+        left_rows = detail::permuted_offsets(left_perm, left.range(), 0u, inner);
+        left_cols = detail::permuted_offsets(left_perm, left.range(), inner,
+            gemm_helper.left_rank());
+      } else if(pack_left) {
+        left_rows = strided_offsets(m, (left_notrans ? k : 1));
+        left_cols = strided_offsets(k, (left_notrans ? 1 : m));
+      }
+      if(right_perm) {
+        const unsigned int outer = gemm_helper.right_outer_begin();
+        right_rows = detail::permuted_offsets(right_perm, right.range(), 0u, outer);
+        right_cols = detail::permuted_offsets(right_perm, right.range(), outer,
+            gemm_helper.right_rank());
+      } else if(pack_right) {
+        right_rows = strided_offsets(k, (right_notrans ? n : 1));
+        right_cols = strided_offsets(n, (right_notrans ? 1 : k));
+      }
+
+      // Select the number of rows or columns in a packed block such that
+      // the packed blocks fit in cache
+      const integer block_size = std::max<integer>(16, 32768 / std::max<integer>(k, 1));
+      const integer mb = (pack_left ? std::min(m, block_size) : m);
+      const integer nb = (pack_right ? std::min(n, block_size) : n);
+      std::vector<left_value_type> a(pack_left ? mb * k : 0);
+      std::vector<right_value_type> b(pack_right ? k * nb : 0);
+
+      for(integer j = 0; j < n; j += nb) {
+        const integer nj = std::min(nb, n - j);
+
+        // Get the right-hand block
+        const right_value_type* b_data = b.data();
+        integer ldb_j = nj;
+        if(pack_right) {
+          detail::pack_permuted(b.data(), right.data(), right_rows.data(), k,
+              right_cols.data() + j, nj);
+        } else {
+          b_data = detail::unpacked_data<right_value_type>(right.data()) +
+              (right_notrans ? j : j * k);
+          ldb_j = ldb;
+        }
+
+        for(integer i = 0; i < m; i += mb) {
+          const integer mi = std::min(mb, m - i);
+
+          // Get the left-hand block
+          const left_value_type* a_data = a.data();
+          if(pack_left)
+            detail::pack_permuted(a.data(), left.data(), left_rows.data() + i,
+                mi, left_cols.data(), k);
+          else
+            a_data = detail::unpacked_data<left_value_type>(left.data()) +
+                (left_notrans ? i * k : i);
+
+          math::gemm(left_op, right_op, mi, nj, k, factor, a_data, lda, b_data,
+              ldb_j, numeric_type(1), pimpl_->data_ + (i * n + j), n);
+        }
+      }
+
+      return *this;
+    }
+
+    /// Contract a sequence of tensor pairs and add the sum to this tensor
+
+    /// This function evaluates
+    /// <tt>this += factor * (left[0] * right[0] + left[1] * right[1] + ...)</tt>
+    /// with a single *GEMM call. The argument pairs are packed into two
+    /// matrices where the inner (contracted) dimensions of all pairs are
+    /// concatenated, which avoids the overhead of a *GEMM call per pair when
+    /// the tensors are small. The outer dimensions of all pairs must match
+    /// this tensor, but the inner dimensions may differ between pairs.
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam W The type of the scaling factor
+    /// \param left The left-hand tensors that will be contracted
+    /// \param right The right-hand tensors that will be contracted
+    /// \param factor The scaling factor
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \return A reference to this tensor
+    /// \throw TiledArray::Exception When this tensor is empty.
+    /// \throw TiledArray::Exception When the sizes of \c left and \c right
+    /// are not equal.
+    template <typename U, typename AU, typename V, typename AV, typename W>
+    Tensor_& gemm(const std::vector<const Tensor<U, AU>*>& left,
+        const std::vector<const Tensor<V, AV>*>& right, const W factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(left.size() == right.size());
+
+      if(left.size() == 0ul)
+        return *this;
+      if(left.size() == 1ul)
+        return gemm(*left.front(), *right.front(), factor, gemm_helper);
+
+      // Compute gemm dimensions of the packed matrices
+      integer m = 1, n = 1, k = 0;
+      std::vector<integer> inner(left.size());
+      for(std::size_t p = 0ul; p < left.size(); ++p) {
+        TA_ASSERT(left[p] && ! left[p]->empty());
+        TA_ASSERT(right[p] && ! right[p]->empty());
+        TA_ASSERT(gemm_helper.left_result_coformal(left[p]->range().extent_data(),
+            pimpl_->range_.extent_data()));
+        TA_ASSERT(gemm_helper.right_result_coformal(right[p]->range().extent_data(),
+            pimpl_->range_.extent_data()));
+        TA_ASSERT(gemm_helper.left_right_coformal(left[p]->range().extent_data(),
+            right[p]->range().extent_data()));
+
+        gemm_helper.compute_matrix_sizes(m, n, inner[p], left[p]->range(),
+            right[p]->range());
+        k += inner[p];
+      }
+
+      // Pack the arguments. Transposed matrices are stored with the inner
+      // dimension as the slowest running index, so their blocks are
+      // contiguous in the packed matrix. Arguments with other real element
+      // types are converted to the element type of this tensor as they are
+      // packed.
+      const bool left_trans = (gemm_helper.left_op() != madness::cblas::NoTrans);
+      const bool right_trans = (gemm_helper.right_op() != madness::cblas::NoTrans);
+      std::vector<typename std::conditional<
+          detail::is_mixed_arithmetic<U, numeric_type>::value, numeric_type,
+          U>::type> a(m * k);
+      std::vector<typename std::conditional<
+          detail::is_mixed_arithmetic<V, numeric_type>::value, numeric_type,
+          V>::type> b(k * n);
+      integer offset = 0;
+      for(std::size_t p = 0ul; p < left.size(); ++p) {
+        const integer kp = inner[p];
+        const U* MADNESS_RESTRICT const left_data = left[p]->data();
+        const V* MADNESS_RESTRICT const right_data = right[p]->data();
+
+        if(left_trans)
+          std::copy(left_data, left_data + (kp * m), a.data() + (offset * m));
+        else
+          for(integer i = 0; i < m; ++i)
+            std::copy(left_data + (i * kp), left_data + ((i + 1) * kp),
+                a.data() + (i * k + offset));
+
+        if(right_trans)
+          for(integer j = 0; j < n; ++j)
+            std::copy(right_data + (j * kp), right_data + ((j + 1) * kp),
+                b.data() + (j * k + offset));
+        else
+          std::copy(right_data, right_data + (kp * n), b.data() + (offset * n));
+
+        offset += kp;
+      }
+
+      // Get the leading dimension for left and right matrices.
+      const integer lda = (left_trans ? m : k);
+      const integer ldb = (right_trans ? k : n);
+
+      math::parallel_gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k,
+          factor, a.data(), lda, b.data(), ldb, numeric_type(1), pimpl_->data_,
+          n);
 
       return *this;
     }
@@ -1340,7 +1952,7 @@ namespace TiledArray {
     numeric_type sum() const {
       auto sum_op = [] (numeric_type& MADNESS_RESTRICT res, const numeric_type arg)
               { res += arg; };
-      return reduce(sum_op, sum_op, numeric_type(0));
+      return reduce(math::SimdSumOp<numeric_type>(), sum_op, numeric_type(0));
     }
 
     /// Product of elements
@@ -1426,12 +2038,10 @@ namespace TiledArray {
     template <typename Right,
         typename std::enable_if<is_tensor<Right>::value>::type* = nullptr>
     numeric_type dot(const Right& other) const {
-      auto mult_add_op = [] (numeric_type& res, const numeric_type l,
-                const numeric_t<Right> r)
-                { res += l * r; };
       auto add_op = [] (numeric_type& MADNESS_RESTRICT res, const numeric_type value)
             { res += value; };
-      return reduce(other, mult_add_op, add_op, numeric_type(0));
+      return reduce(other, math::SimdDotOp<numeric_type>(), add_op,
+          numeric_type(0));
     }
 
   }; // class Tensor
@@ -1439,20 +2049,338 @@ namespace TiledArray {
   template <typename T, typename A>
   const typename Tensor<T, A>::range_type Tensor<T, A>::empty_range_;
 
+  // Element-wise operations on tensors with different real element types
+
+  // The result has the element type of the sum of the argument elements, e.g.
+  // double for float and double arguments (see detail::mixed_tensor ), so the
+  // result of an expression with mixed tiles is not cast to the precision of
+  // an array in a separate pass. The argument elements are converted as they
+  // are combined, so no converted copy of an argument is stored.
+
+  /// Add tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \param left The left-hand argument to be added
+  /// \param right The right-hand argument to be added
+  /// \return A tensor that is equal to <tt>(left + right)</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename std::enable_if<
+          detail::is_mixed_arithmetic<T1, T2>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  add(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right) {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    return result_type(left, right, math::SimdBinaryOp<
+        typename result_type::numeric_type, math::simd_add>());
+  }
+
+  /// Add and scale tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be added
+  /// \param right The right-hand argument to be added
+  /// \param factor The scaling factor
+  /// \return A tensor that is equal to <tt>(left + right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  add(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    return result_type(left, right, math::SimdScalBinaryOp<
+        typename result_type::numeric_type, math::simd_add, Scalar>(factor));
+  }
+
+  /// Add and permute tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \param left The left-hand argument to be added
+  /// \param right The right-hand argument to be added
+  /// \param perm The permutation to be applied to the result
+  /// \return A tensor that is equal to <tt>perm ^ (left + right)</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename std::enable_if<
+          detail::is_mixed_arithmetic<T1, T2>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  add(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Permutation& perm)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    typedef typename result_type::numeric_type numeric_type;
+    return result_type(left, right, [] (const T1 l, const T2 r)
+        -> numeric_type { return l + r; }, perm);
+  }
+
+  /// Add, scale, and permute tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be added
+  /// \param right The right-hand argument to be added
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return A tensor that is equal to <tt>perm ^ (left + right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  add(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    typedef typename result_type::numeric_type numeric_type;
+    return result_type(left, right, [factor] (const T1 l, const T2 r)
+        -> numeric_type { return (l + r) * factor; }, perm);
+  }
+
+  /// Subtract tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \param left The left-hand argument to be subtracted
+  /// \param right The right-hand argument to be subtracted
+  /// \return A tensor that is equal to <tt>(left - right)</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename std::enable_if<
+          detail::is_mixed_arithmetic<T1, T2>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  subt(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right) {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    return result_type(left, right, math::SimdBinaryOp<
+        typename result_type::numeric_type, math::simd_subt>());
+  }
+
+  /// Subtract and scale tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be subtracted
+  /// \param right The right-hand argument to be subtracted
+  /// \param factor The scaling factor
+  /// \return A tensor that is equal to <tt>(left - right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  subt(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    return result_type(left, right, math::SimdScalBinaryOp<
+        typename result_type::numeric_type, math::simd_subt, Scalar>(factor));
+  }
+
+  /// Subtract and permute tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \param left The left-hand argument to be subtracted
+  /// \param right The right-hand argument to be subtracted
+  /// \param perm The permutation to be applied to the result
+  /// \return A tensor that is equal to <tt>perm ^ (left - right)</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename std::enable_if<
+          detail::is_mixed_arithmetic<T1, T2>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  subt(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Permutation& perm)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    typedef typename result_type::numeric_type numeric_type;
+    return result_type(left, right, [] (const T1 l, const T2 r)
+        -> numeric_type { return l - r; }, perm);
+  }
+
+  /// Subtract, scale, and permute tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be subtracted
+  /// \param right The right-hand argument to be subtracted
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return A tensor that is equal to <tt>perm ^ (left - right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  subt(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    typedef typename result_type::numeric_type numeric_type;
+    return result_type(left, right, [factor] (const T1 l, const T2 r)
+        -> numeric_type { return (l - r) * factor; }, perm);
+  }
+
+  /// Multiply tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \param left The left-hand argument to be multiplied
+  /// \param right The right-hand argument to be multiplied
+  /// \return A tensor that is equal to <tt>(left * right)</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename std::enable_if<
+          detail::is_mixed_arithmetic<T1, T2>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  mult(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right) {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    return result_type(left, right, math::SimdBinaryOp<
+        typename result_type::numeric_type, math::simd_mult>());
+  }
+
+  /// Multiply and scale tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be multiplied
+  /// \param right The right-hand argument to be multiplied
+  /// \param factor The scaling factor
+  /// \return A tensor that is equal to <tt>(left * right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  mult(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    return result_type(left, right, math::SimdScalBinaryOp<
+        typename result_type::numeric_type, math::simd_mult, Scalar>(factor));
+  }
+
+  /// Multiply and permute tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \param left The left-hand argument to be multiplied
+  /// \param right The right-hand argument to be multiplied
+  /// \param perm The permutation to be applied to the result
+  /// \return A tensor that is equal to <tt>perm ^ (left * right)</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename std::enable_if<
+          detail::is_mixed_arithmetic<T1, T2>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  mult(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Permutation& perm)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    typedef typename result_type::numeric_type numeric_type;
+    return result_type(left, right, [] (const T1 l, const T2 r)
+        -> numeric_type { return l * r; }, perm);
+  }
+
+  /// Multiply, scale, and permute tensors with different real element types
+
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be multiplied
+  /// \param right The right-hand argument to be multiplied
+  /// \param factor The scaling factor
+  /// \param perm The permutation to be applied to the result
+  /// \return A tensor that is equal to <tt>perm ^ (left * right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  mult(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    typedef typename result_type::numeric_type numeric_type;
+    return result_type(left, right, [factor] (const T1 l, const T2 r)
+        -> numeric_type { return (l * r) * factor; }, perm);
+  }
+
+  /// Contract and scale tensors with different real element types
+
+  /// The contraction is computed in the precision of the result, and the
+  /// elements of the argument with the other element type are converted as
+  /// they are packed for the *GEMM calls (see \c Tensor::gemm() ).
+  /// \tparam T1 The left-hand element type
+  /// \tparam A1 The left-hand allocator type
+  /// \tparam T2 The right-hand element type
+  /// \tparam A2 The right-hand allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be contracted
+  /// \param right The right-hand argument to be contracted
+  /// \param factor The scaling factor
+  /// \param gemm_helper The *GEMM operation meta data
+  /// \return A tensor that is equal to <tt>(left * right) * factor</tt>
+  template <typename T1, typename A1, typename T2, typename A2,
+      typename Scalar,
+      typename std::enable_if<detail::is_mixed_arithmetic<T1, T2>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline detail::mixed_tensor_t<T1, A1, T2, A2>
+  gemm(const Tensor<T1, A1>& left, const Tensor<T2, A2>& right,
+      const Scalar factor, const math::GemmHelper& gemm_helper)
+  {
+    typedef detail::mixed_tensor_t<T1, A1, T2, A2> result_type;
+    TA_ASSERT(! left.empty());
+    TA_ASSERT(! right.empty());
+
+    result_type result(gemm_helper.make_result_range<
+        typename result_type::range_type>(left.range(), right.range()),
+        typename result_type::numeric_type(0));
+    result.gemm(left, right, factor, gemm_helper);
+    return result;
+  }
+
 #ifndef TILEDARRAY_HEADER_ONLY
 
   extern template
-  class Tensor<double, Eigen::aligned_allocator<double> >;
+  class Tensor<double, PoolAllocator<double> >;
   extern template
   class Tensor<float, Eigen::aligned_allocator<float> >;
   extern template
   class Tensor<int, Eigen::aligned_allocator<int> >;
   extern template
   class Tensor<long, Eigen::aligned_allocator<long> >;
-//  extern template
-//  class Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >;
-//  extern template
-//  class Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >;
+  extern template
+  class Tensor<std::complex<double>, Eigen::aligned_allocator<std::complex<double> > >;
+  extern template
+  class Tensor<std::complex<float>, Eigen::aligned_allocator<std::complex<float> > >;
 
 #endif // TILEDARRAY_HEADER_ONLY
 
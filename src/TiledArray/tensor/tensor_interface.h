@@ -97,7 +97,8 @@ namespace TiledArray {
       typedef typename detail::scalar_type<value_type>::type
           scalar_type; ///< the scalar type that supports T
 
-      typedef Tensor<T, Eigen::aligned_allocator<T> > result_tensor;
+      typedef Tensor<T, typename detail::default_tensor_allocator<T>::type>
+          result_tensor;
              ///< Tensor type used as the return type from arithmetic operations
 
     private:
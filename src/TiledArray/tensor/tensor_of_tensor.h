@@ -0,0 +1,126 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tensor_of_tensor.h
+ *  Mar 8, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TENSOR_TENSOR_OF_TENSOR_H__INCLUDED
+#define TILEDARRAY_TENSOR_TENSOR_OF_TENSOR_H__INCLUDED
+
+#include <TiledArray/tensor/tensor.h>
+
+namespace TiledArray {
+
+  /// Test for a tensor of tensors with packed inner tensors
+
+  /// The inner tensors of a packed tensor of tensors are stored back to
+  /// back in a single buffer. Element-wise operations of packed tensors of
+  /// tensors with the same inner ranges are evaluated with one kernel call
+  /// over all inner elements, and their results are packed. The inner
+  /// tensors of the results of element-wise operations and contractions are
+  /// always packed.
+  /// \tparam T The inner tensor element type
+  /// \tparam A The inner tensor allocator type
+  /// \tparam AT The outer tensor allocator type
+  /// \param tensor The tensor of tensors
+  /// \return \c true if the inner tensors of \c tensor are packed
+  template <typename T, typename A, typename AT>
+  inline bool is_packed(const Tensor<Tensor<T, A>, AT>& tensor) {
+    return (! tensor.empty()) && detail::is_packed_like(tensor, tensor);
+  }
+
+  /// Pack the inner tensors of a tensor of tensors
+
+  /// \tparam T The inner tensor element type
+  /// \tparam A The inner tensor allocator type
+  /// \tparam AT The outer tensor allocator type
+  /// \param tensor The tensor of tensors, which has no empty inner tensors
+  /// \return A deep copy of \c tensor whose inner tensors are packed
+  template <typename T, typename A, typename AT>
+  inline Tensor<Tensor<T, A>, AT> pack(const Tensor<Tensor<T, A>, AT>& tensor) {
+    TA_ASSERT(detail::is_packable(tensor));
+    return tensor.clone();
+  }
+
+  /// Batched contraction of the inner tensors of two tensors of tensors
+
+  /// Element \c i of the result is
+  /// <tt>factor * gemm(left[i], right[i])</tt> , i.e. the outer indices are
+  /// Hadamard indices and the inner tensors are contracted. The result is
+  /// packed, so the inner products are written directly into one buffer
+  /// without an allocation per inner tensor.
+  /// \tparam T The inner tensor element type
+  /// \tparam A The inner tensor allocator type
+  /// \tparam AT The outer tensor allocator type
+  /// \tparam Scalar The scaling factor type
+  /// \param left The left-hand tensor of tensors
+  /// \param right The right-hand tensor of tensors, with the outer range of
+  /// \c left
+  /// \param factor The scaling factor
+  /// \param gemm_helper The *GEMM operation meta data of the inner tensors
+  /// \return The tensor of tensors of the inner products
+  template <typename T, typename A, typename AT, typename Scalar>
+  inline Tensor<Tensor<T, A>, AT>
+  inner_gemm(const Tensor<Tensor<T, A>, AT>& left,
+      const Tensor<Tensor<T, A>, AT>& right, const Scalar factor,
+      const math::GemmHelper& gemm_helper)
+  {
+    typedef Tensor<T, A> inner_type;
+    TA_ASSERT(! left.empty());
+    TA_ASSERT(! right.empty());
+    TA_ASSERT(left.range() == right.range());
+    TA_ASSERT(detail::is_packable(left));
+    TA_ASSERT(detail::is_packable(right));
+
+    const std::size_t volume = left.range().volume();
+
+    // The inner result ranges and the size of the result buffer
+    std::vector<Range> ranges;
+    ranges.reserve(volume);
+    std::size_t size = 0ul;
+    for(std::size_t i = 0ul; i < volume; ++i) {
+      TA_ASSERT(left[i].range().rank() == gemm_helper.left_rank());
+      TA_ASSERT(right[i].range().rank() == gemm_helper.right_rank());
+      TA_ASSERT(gemm_helper.left_right_coformal(left[i].range().extent_data(),
+          right[i].range().extent_data()));
+      ranges.push_back(gemm_helper.make_result_range<Range>(left[i].range(),
+          right[i].range()));
+      size += ranges.back().volume();
+    }
+
+    auto buffer = std::make_shared<inner_type>(Range(size));
+    Tensor<inner_type, AT> result(left.range());
+    T* data = buffer->data();
+    for(std::size_t i = 0ul; i < volume; ++i) {
+      integer m = 1, n = 1, k = 1;
+      gemm_helper.compute_matrix_sizes(m, n, k, left[i].range(), right[i].range());
+      const integer lda = (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
+      const integer ldb = (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
+      math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k,
+          T(factor), left[i].data(), lda, right[i].data(), ldb, T(0), data, n);
+      result[i] = inner_type(ranges[i], data, buffer);
+      data += ranges[i].volume();
+    }
+
+    return result;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TENSOR_TENSOR_OF_TENSOR_H__INCLUDED
@@ -27,6 +27,14 @@
 #define TILEDARRAY_TENSOR_TYPE_TRAITS_H__INCLUDED
 
 #include <type_traits>
+#include <utility>
+
+namespace Eigen {
+
+  // Forward declarations
+  template <typename> class aligned_allocator;
+
+} // namespace Eigen
 
 namespace TiledArray {
 
@@ -34,9 +42,61 @@ namespace TiledArray {
   class Range;
   class BlockRange;
   template <typename, typename> class Tensor;
+  template <typename> class PoolAllocator;
 
   namespace detail {
 
+    /// The default allocator type of \c Tensor<T>
+
+    /// \c Tensor<double> tiles are the most frequently created temporaries,
+    /// so they are allocated with the thread-local \c PoolAllocator .
+    /// \tparam T The tensor element type
+    template <typename T>
+    struct default_tensor_allocator {
+      typedef Eigen::aligned_allocator<T> type;
+    }; // struct default_tensor_allocator
+
+    template <>
+    struct default_tensor_allocator<double> {
+      typedef PoolAllocator<double> type;
+    }; // struct default_tensor_allocator
+
+    /// Test for different real element types
+
+    /// Operations on tensors with different real element types, e.g.
+    /// \c float and \c double , convert the elements as they are used, so
+    /// no converted copy of an argument is stored.
+    /// \tparam T1 The first element type
+    /// \tparam T2 The second element type
+    template <typename T1, typename T2>
+    struct is_mixed_arithmetic :
+        public std::integral_constant<bool, std::is_arithmetic<T1>::value &&
+            std::is_arithmetic<T2>::value && ! std::is_same<T1, T2>::value>
+    { };
+
+    /// The result tensor type of an operation on tensors with different real element types
+
+    /// The result elements have the type of the sum of the argument elements,
+    /// e.g. \c double for \c float and \c double arguments, and the result
+    /// has the allocator of the argument with that element type.
+    /// \tparam T1 The left-hand element type
+    /// \tparam A1 The left-hand allocator type
+    /// \tparam T2 The right-hand element type
+    /// \tparam A2 The right-hand allocator type
+    template <typename T1, typename A1, typename T2, typename A2>
+    struct mixed_tensor {
+      typedef decltype(std::declval<T1>() + std::declval<T2>())
+          numeric_type; ///< The result element type
+      typedef Tensor<numeric_type,
+          typename std::conditional<std::is_same<numeric_type, T1>::value, A1,
+          typename std::conditional<std::is_same<numeric_type, T2>::value, A2,
+          typename default_tensor_allocator<numeric_type>::type>::type>::type>
+          type; ///< The result tensor type
+    }; // struct mixed_tensor
+
+    template <typename T1, typename A1, typename T2, typename A2>
+    using mixed_tensor_t = typename mixed_tensor<T1, A1, T2, A2>::type;
+
     // Forward declarations
     template <typename, typename> class TensorInterface;
     template <typename> class ShiftWrapper;
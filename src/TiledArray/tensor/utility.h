@@ -29,6 +29,7 @@
 #include <TiledArray/utility.h>
 #include <TiledArray/range.h>
 #include <TiledArray/block_range.h>
+#include <TiledArray/strided_range.h>
 #include <TiledArray/size_array.h>
 #include <TiledArray/tensor/type_traits.h>
 
@@ -184,11 +185,41 @@ namespace TiledArray {
     }
 
 
+    /// Test for a stride-one inner dimension
+
+    /// \tparam T A tensor type
+    /// \param tensor The tensor to be tested
+    /// \return \c true if the elements of the inner dimension of \c tensor
+    /// are contiguous
+    template <typename T>
+    inline bool is_unit_inner_stride(const T& tensor) {
+      return tensor.range().stride_data()[tensor.range().rank() - 1u] == 1ul;
+    }
+
+    /// Test for stride-one inner dimensions
+
+    /// \tparam T1 The first tensor type
+    /// \tparam T2 The second tensor type
+    /// \tparam Ts The remaining tensor types
+    /// \param tensor1 The first tensor to be tested
+    /// \param tensor2 The second tensor to be tested
+    /// \param tensors The remaining tensors to be tested
+    /// \return \c true if the elements of the inner dimension of each tensor
+    /// are contiguous
+    template <typename T1, typename T2, typename... Ts>
+    inline bool is_unit_inner_stride(const T1& tensor1, const T2& tensor2,
+        const Ts&... tensors)
+    {
+      return is_unit_inner_stride(tensor1)
+          && is_unit_inner_stride(tensor2, tensors...);
+    }
+
     /// Get the inner size
 
     /// This function searches of the largest contiguous size in the range of a
     /// non-contiguous tensor. At a minimum, this is equal to the size of the
-    /// stride-one dimension.
+    /// stride-one dimension, or one when the inner dimension of a strided
+    /// view is not stride-one.
     /// \tparam T A tensor type
     /// \param tensor The tensor to be tested
     /// \return The largest contiguous, inner-dimension size.
@@ -198,6 +229,8 @@ namespace TiledArray {
       const auto* MADNESS_RESTRICT const size = tensor.range().extent_data();
 
       int i = int(tensor.range().rank()) - 1;
+      if(stride[i] != 1ul)
+        return 1ul;
       auto volume = size[i];
 
       for(--i; i >= 0; --i) {
@@ -232,6 +265,8 @@ namespace TiledArray {
       const auto* MADNESS_RESTRICT const stride2 = tensor2.range().stride_data();
 
       int i = int(tensor1.range().rank()) - 1;
+      if((stride1[i] != 1ul) || (stride2[i] != 1ul))
+        return 1ul;
       auto volume1 = size1[i];
       auto volume2 = size2[i];
 
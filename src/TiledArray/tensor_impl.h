@@ -48,7 +48,7 @@ namespace TiledArray {
     private:
       World& world_; ///< World that contains
       const trange_type trange_; ///< Tiled range type
-      const shape_type shape_; ///< Tensor shape
+      shape_type shape_; ///< Tensor shape
       std::shared_ptr<pmap_interface> pmap_; ///< Process map for tiles
 
     public:
@@ -167,6 +167,17 @@ namespace TiledArray {
       /// \return A reference to the world that contains this tensor
       World& world() const { return world_; }
 
+    protected:
+
+      /// Replace the tensor shape
+
+      /// Copies of the current shape are not modified.
+      /// \param shape The new shape of the tensor
+      void shape(const shape_type& shape) {
+        TA_ASSERT(shape.validate(trange_.tiles_range()));
+        shape_ = shape;
+      }
+
     }; // class TensorImpl
 
 
@@ -41,10 +41,18 @@ namespace TiledArray {
    * @{
    */
 
-  /// An N-dimensional shallow copy wrapper for tile objects
+  /// An N-dimensional copy-on-write wrapper for tile objects
 
   /// \c Tile represents a block of an \c Array. The rank of the tile block is
-  /// the same as the owning \c Array object. In order for a user defined tensor
+  /// the same as the owning \c Array object. Copies of a tile share the
+  /// tensor object, and the tensor is cloned before it is modified through
+  /// a tile that shares it, i.e. by the non-const accessors and the in-place
+  /// (\c *_to ) operations; when the tile is the only owner of the tensor,
+  /// it is modified in place. So tiles may be copied into other arrays
+  /// without cloning them (see \c is_copy_on_write_tile ). Note that
+  /// sharing is tracked by the tile, not the tensor, and that a reference
+  /// returned by a non-const accessor must not be used after the tile has
+  /// been copied. In order for a user defined tensor
   /// object to be used in TiledArray expressions, users must also define the
   /// following functions:
   /// \li \c add
@@ -87,6 +95,12 @@ namespace TiledArray {
 
     std::shared_ptr<tensor_type> pimpl_;
 
+    /// Clone the tensor if it is shared with other tiles
+    void detach() {
+      if(pimpl_ && (pimpl_.use_count() > 1l))
+        pimpl_ = std::make_shared<tensor_type>(clone(*pimpl_));
+    }
+
   public:
 
     // Constructors and destructor ---------------------------------------------
@@ -126,12 +140,18 @@ namespace TiledArray {
     Tile_& operator=(const Tile_&) = default;
 
     Tile_& operator=(const tensor_type& tensor) {
-      *pimpl_ = tensor;
+      if(is_shared() || ! pimpl_)
+        pimpl_ = std::make_shared<tensor_type>(tensor);
+      else
+        *pimpl_ = tensor;
       return *this;
     }
 
     Tile_& operator=(tensor_type&& tensor) {
-      *pimpl_ = std::move(tensor);
+      if(is_shared() || ! pimpl_)
+        pimpl_ = std::make_shared<tensor_type>(std::move(tensor));
+      else
+        *pimpl_ = std::move(tensor);
       return *this;
     }
 
@@ -142,9 +162,22 @@ namespace TiledArray {
       return not bool(pimpl_);
     }
 
+    /// Check that the tensor is shared with other tiles
+
+    /// \return \c true if the tensor of this tile is shared, i.e. it will be
+    /// cloned by the next modification of this tile
+    bool is_shared() const { return pimpl_.use_count() > 1l; }
+
     // Tile accessor -----------------------------------------------------------
 
-    tensor_type& tensor() { return *pimpl_; }
+    /// Tensor accessor for modification
+
+    /// The tensor is cloned first if it is shared with other tiles.
+    /// \return A reference to the tensor, which is owned only by this tile
+    tensor_type& tensor() {
+      detach();
+      return *pimpl_;
+    }
 
     const tensor_type& tensor() const { return *pimpl_; }
 
@@ -319,6 +352,23 @@ namespace TiledArray {
     return Tile<Arg>(permute(arg.tensor(), perm));
   }
 
+  /// Permute \c arg in place
+
+  /// A shared tile is replaced by a permuted copy, since permuting the range
+  /// of its tensor would also permute the other copies.
+  /// \tparam Arg The tile argument type
+  /// \param arg The tile argument to be permuted
+  /// \param perm The permutation to be applied to \c arg
+  /// \return A reference to \c arg
+  template <typename Arg>
+  inline Tile<Arg>& permute_to(Tile<Arg>& arg, const Permutation& perm) {
+    if(arg.is_shared())
+      arg = permute(arg, perm);
+    else
+      permute_to(arg.tensor(), perm);
+    return arg;
+  }
+
 
   // Shift operations ----------------------------------------------------------
 
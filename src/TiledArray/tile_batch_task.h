@@ -0,0 +1,202 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_batch_task.h
+ *  May 19, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_BATCH_TASK_H__INCLUDED
+#define TILEDARRAY_TILE_BATCH_TASK_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/madness.h>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// A task that computes a batch of tiles
+
+    /// Each tile of the batch is computed by a call of the form
+    /// <tt>fn(index, args...)</tt> , where \c index is the tile ordinal and
+    /// \c args are the argument tiles, which are passed as non-const
+    /// references. The task runs once the argument tiles of all its tiles
+    /// have been set. The function is called directly, so it is inlined into
+    /// the task body, and it is copied once per task, not once per tile.
+    /// \tparam Result The result tile type
+    /// \tparam Fn The tile function type
+    /// \tparam Args The argument tile types
+    template <typename Result, typename Fn, typename... Args>
+    class TileBatchTask : public madness::TaskInterface {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+      typedef std::tuple<size_type, Future<Result>, Future<Args>...> item_type;
+
+      Fn fn_; ///< The tile function
+      std::vector<item_type> items_; ///< The tiles of this batch
+
+      /// Add a dependency on \c f when it is not set
+      template <typename T>
+      int depend(const Future<T>& f) {
+        if(! f.probe()) {
+          madness::DependencyInterface::inc();
+          const_cast<Future<T>&>(f).register_callback(this);
+        }
+        return 0;
+      }
+
+      template <std::size_t... Is>
+      void compute(item_type& item, std::index_sequence<Is...>) {
+        std::get<1>(item).set(fn_(std::get<0>(item), std::get<Is + 2>(item).get()...));
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param fn The tile function
+      explicit TileBatchTask(const Fn& fn) :
+        madness::TaskInterface(0, madness::TaskAttributes()), fn_(fn), items_()
+      { }
+
+      virtual ~TileBatchTask() { }
+
+      /// Add a tile to this batch
+
+      /// \param index The tile ordinal
+      /// \param args The argument tiles
+      /// \return The future of the result tile
+      Future<Result> add(const size_type index, const Future<Args>&... args) {
+        int dummy[] = { 0, depend(args)... };
+        (void) dummy;
+        items_.emplace_back(index, Future<Result>(), args...);
+        return std::get<1>(items_.back());
+      }
+
+      /// \return The number of tiles of this batch
+      size_type size() const { return items_.size(); }
+
+      virtual void run(const madness::TaskThreadEnv&) {
+        for(item_type& item : items_)
+          compute(item, std::index_sequence_for<Args...>());
+      }
+
+    }; // class TileBatchTask
+
+
+    /// Submit tile computations in batches of small tiles
+
+    /// Tiles with fewer elements than \c tile_batch_volume() are computed in
+    /// batches, with one \c TileBatchTask per batch, and larger tiles are
+    /// computed by one task each. Batches are submitted once their tiles
+    /// hold the batch volume, and when \c flush() is called.
+    /// \tparam Result The result tile type
+    /// \tparam Fn The tile function type
+    /// \tparam Args The argument tile types
+    template <typename Result, typename Fn, typename... Args>
+    class TileBatcher {
+    public:
+      typedef TileBatchTask<Result, Fn, Args...> task_type; ///< Batch task type
+      typedef typename task_type::size_type size_type; ///< Size type
+
+    private:
+      World& world_; ///< The world where tasks are submitted
+      Fn fn_; ///< The tile function
+      std::size_t max_volume_; ///< The batch volume
+      task_type* task_; ///< The current batch
+      std::size_t volume_; ///< The volume of the current batch
+
+      // Not allowed
+      TileBatcher(const TileBatcher&);
+      TileBatcher& operator=(const TileBatcher&);
+
+    public:
+
+      /// Constructor
+
+      /// \param world The world where tasks are submitted
+      /// \param fn The tile function
+      TileBatcher(World& world, const Fn& fn) :
+        world_(world), fn_(fn), max_volume_(tile_batch_volume()),
+        task_(nullptr), volume_(0ul)
+      { }
+
+      ~TileBatcher() { flush(); }
+
+      /// Compute a tile
+
+      /// \param index The tile ordinal
+      /// \param volume The number of elements of the tile
+      /// \param args The argument tiles
+      /// \return The future of the result tile
+      Future<Result> add(const size_type index, const std::size_t volume,
+          const Future<Args>&... args)
+      {
+        if((! max_volume_) || (volume >= max_volume_)) {
+          task_type* const task = new task_type(fn_);
+          const Future<Result> result = task->add(index, args...);
+          world_.taskq.add(task);
+          return result;
+        }
+
+        if(! task_)
+          task_ = new task_type(fn_);
+        const Future<Result> result = task_->add(index, args...);
+        volume_ += volume;
+        if(volume_ >= max_volume_)
+          flush();
+        return result;
+      }
+
+      /// Submit the current batch
+      void flush() {
+        if(task_) {
+          world_.taskq.add(task_);
+          task_ = nullptr;
+          volume_ = 0ul;
+        }
+      }
+
+    }; // class TileBatcher
+
+    /// Tile batcher factory function
+
+    /// \tparam Result The result tile type
+    /// \tparam Args The argument tile types
+    /// \tparam Fn The tile function type
+    /// \param world The world where tasks are submitted
+    /// \param fn The tile function
+    /// \return A pointer to a batcher, which submits its last batch when it
+    /// is destroyed
+    template <typename Result, typename... Args, typename Fn>
+    inline std::unique_ptr<TileBatcher<Result, Fn, Args...> >
+    make_tile_batcher(World& world, const Fn& fn) {
+      return std::unique_ptr<TileBatcher<Result, Fn, Args...> >(
+          new TileBatcher<Result, Fn, Args...>(world, fn));
+    }
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_BATCH_TASK_H__INCLUDED
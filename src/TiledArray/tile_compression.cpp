@@ -0,0 +1,256 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_compression.cpp
+ *  Feb 8, 2017
+ *
+ */
+
+#include <TiledArray/tile_compression.h>
+#include <TiledArray/error.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace TiledArray {
+  namespace detail {
+    namespace {
+
+      // Run-length encoding control bytes: a control byte c < 128 is followed
+      // by c + 1 literal bytes, and a control byte c >= 128 is followed by one
+      // byte that is repeated c - 128 + min_run times.
+      constexpr std::size_t min_run = 3ul;
+      constexpr std::size_t max_run = 127ul + min_run;
+      constexpr std::size_t max_literal = 128ul;
+
+      /// Tile compression settings and counters
+      class TileCompressionRegistry {
+        std::atomic<int> codec_;
+        std::atomic<double> tolerance_;
+        std::atomic<std::size_t> threshold_;
+        mutable std::mutex lock_;
+        TileCompressionStats stats_;
+
+        /// Read the initial codec from \c TA_TILE_COMPRESSION
+        static TileCodec init_codec() {
+          const char* name = getenv("TA_TILE_COMPRESSION");
+          if(name) {
+            if(std::strcmp(name, "lossless") == 0)
+              return TileCodec::lossless;
+            if(std::strcmp(name, "lossy") == 0)
+              return TileCodec::lossy;
+          }
+          return TileCodec::none;
+        }
+
+        /// Read the initial tolerance from \c TA_TILE_COMPRESSION_TOLERANCE
+        static double init_tolerance() {
+          const char* tolerance = getenv("TA_TILE_COMPRESSION_TOLERANCE");
+          if(tolerance)
+            return std::max(std::strtod(tolerance, nullptr), 0.0);
+          return 0.0;
+        }
+
+        /// Read the initial threshold from \c TA_TILE_COMPRESSION_THRESHOLD
+        static std::size_t init_threshold() {
+          const char* threshold = getenv("TA_TILE_COMPRESSION_THRESHOLD");
+          if(threshold)
+            return std::strtoul(threshold, nullptr, 10);
+          return 65536ul;
+        }
+
+      public:
+
+        TileCompressionRegistry() :
+          codec_(static_cast<int>(init_codec())), tolerance_(init_tolerance()),
+          threshold_(init_threshold()), lock_(), stats_()
+        { }
+
+        static TileCompressionRegistry& instance() {
+          static TileCompressionRegistry registry;
+          return registry;
+        }
+
+        TileCodec codec() const {
+          return static_cast<TileCodec>(codec_.load(std::memory_order_relaxed));
+        }
+
+        void codec(const TileCodec codec, const double tolerance) {
+          if(tolerance < 0.0)
+            TA_EXCEPTION("The tile compression tolerance must be non-negative.");
+          tolerance_.store(tolerance, std::memory_order_relaxed);
+          codec_.store(static_cast<int>(codec), std::memory_order_relaxed);
+        }
+
+        double tolerance() const { return tolerance_.load(std::memory_order_relaxed); }
+
+        std::size_t threshold() const { return threshold_.load(std::memory_order_relaxed); }
+
+        void threshold(const std::size_t bytes) {
+          threshold_.store(bytes, std::memory_order_relaxed);
+        }
+
+        TileCompressionStats stats() const {
+          std::lock_guard<std::mutex> locker(lock_);
+          return stats_;
+        }
+
+        void reset_stats() {
+          std::lock_guard<std::mutex> locker(lock_);
+          stats_ = TileCompressionStats();
+        }
+
+        void record_compression(const std::size_t uncompressed_bytes,
+            const std::size_t compressed_bytes, const double time)
+        {
+          std::lock_guard<std::mutex> locker(lock_);
+          ++stats_.tiles;
+          stats_.uncompressed_bytes += uncompressed_bytes;
+          stats_.compressed_bytes += compressed_bytes;
+          stats_.compress_time += time;
+        }
+
+        void record_decompression(const double time) {
+          std::lock_guard<std::mutex> locker(lock_);
+          stats_.decompress_time += time;
+        }
+
+      }; // class TileCompressionRegistry
+
+    }  // namespace
+
+    void compress_bytes(const unsigned char* const data, const std::size_t n,
+        const std::size_t width, std::vector<unsigned char>& result)
+    {
+      TA_ASSERT(width > 0ul);
+      TA_ASSERT((n % width) == 0ul);
+
+      // Group byte k of all elements together
+      const std::size_t count = n / width;
+      std::vector<unsigned char> shuffled(n);
+      for(std::size_t i = 0ul; i < count; ++i)
+        for(std::size_t k = 0ul; k < width; ++k)
+          shuffled[k * count + i] = data[i * width + k];
+
+      // Run-length encode the shuffled bytes
+      result.clear();
+      result.reserve(n / 4ul + 16ul);
+      const unsigned char* const s = shuffled.data();
+      std::size_t i = 0ul;
+      while(i < n) {
+        std::size_t run = 1ul;
+        while((i + run < n) && (run < max_run) && (s[i + run] == s[i]))
+          ++run;
+
+        if(run >= min_run) {
+          result.push_back(static_cast<unsigned char>(128ul + run - min_run));
+          result.push_back(s[i]);
+          i += run;
+        } else {
+          // Copy literal bytes up to the next run
+          const std::size_t first = i;
+          std::size_t size = 0ul;
+          while((i < n) && (size < max_literal)) {
+            if((i + 2ul < n) && (s[i] == s[i + 1ul]) && (s[i] == s[i + 2ul]))
+              break;
+            ++i;
+            ++size;
+          }
+          result.push_back(static_cast<unsigned char>(size - 1ul));
+          result.insert(result.end(), s + first, s + first + size);
+        }
+      }
+    }
+
+    void decompress_bytes(const std::vector<unsigned char>& data,
+        const std::size_t width, unsigned char* const result, const std::size_t n)
+    {
+      TA_ASSERT(width > 0ul);
+      TA_ASSERT((n % width) == 0ul);
+
+      // Decode the runs
+      std::vector<unsigned char> shuffled(n);
+      std::size_t j = 0ul;
+      for(std::size_t i = 0ul; i < data.size(); ) {
+        const std::size_t control = data[i++];
+        if(control < 128ul) {
+          const std::size_t size = control + 1ul;
+          if((i + size > data.size()) || (j + size > n))
+            TA_EXCEPTION("Invalid compressed tile data.");
+          std::memcpy(shuffled.data() + j, data.data() + i, size);
+          i += size;
+          j += size;
+        } else {
+          const std::size_t size = control - 128ul + min_run;
+          if((i >= data.size()) || (j + size > n))
+            TA_EXCEPTION("Invalid compressed tile data.");
+          std::memset(shuffled.data() + j, data[i++], size);
+          j += size;
+        }
+      }
+      if(j != n)
+        TA_EXCEPTION("Invalid compressed tile data.");
+
+      // Restore the element byte order
+      const std::size_t count = n / width;
+      for(std::size_t i = 0ul; i < count; ++i)
+        for(std::size_t k = 0ul; k < width; ++k)
+          result[i * width + k] = shuffled[k * count + i];
+    }
+
+    void record_tile_compression(const std::size_t uncompressed_bytes,
+        const std::size_t compressed_bytes, const double time)
+    {
+      TileCompressionRegistry::instance().record_compression(uncompressed_bytes,
+          compressed_bytes, time);
+    }
+
+    void record_tile_decompression(const double time) {
+      TileCompressionRegistry::instance().record_decompression(time);
+    }
+
+  }  // namespace detail
+
+  TileCodec tile_codec() { return detail::TileCompressionRegistry::instance().codec(); }
+
+  void tile_codec(const TileCodec codec, const double tolerance) {
+    detail::TileCompressionRegistry::instance().codec(codec, tolerance);
+  }
+
+  double tile_codec_tolerance() {
+    return detail::TileCompressionRegistry::instance().tolerance();
+  }
+
+  std::size_t tile_compression_threshold() {
+    return detail::TileCompressionRegistry::instance().threshold();
+  }
+
+  void tile_compression_threshold(const std::size_t bytes) {
+    detail::TileCompressionRegistry::instance().threshold(bytes);
+  }
+
+  TileCompressionStats tile_compression_stats() {
+    return detail::TileCompressionRegistry::instance().stats();
+  }
+
+  void reset_tile_compression_stats() {
+    detail::TileCompressionRegistry::instance().reset_stats();
+  }
+
+} // namespace TiledArray
@@ -0,0 +1,306 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_compression.h
+ *  Feb 8, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_COMPRESSION_H__INCLUDED
+#define TILEDARRAY_TILE_COMPRESSION_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/type_traits.h>
+#include <TiledArray/tensor/type_traits.h>
+#include <cmath>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Compression codecs of broadcast tiles
+  enum class TileCodec {
+    none,     ///< Tiles are not compressed
+    lossless, ///< Byte shuffle followed by run-length encoding
+    lossy     ///< Elements below the tolerance are zeroed, then lossless
+  }; // enum class TileCodec
+
+  /// Tile compression counters
+  struct TileCompressionStats {
+    std::size_t tiles; ///< The number of compressed tiles
+    std::size_t uncompressed_bytes; ///< The size of the tiles before compression
+    std::size_t compressed_bytes; ///< The size of the tiles after compression
+    double compress_time; ///< The time spent compressing tiles, in seconds
+    double decompress_time; ///< The time spent decompressing tiles, in seconds
+
+    /// The number of bytes that were not sent
+
+    /// \return The difference between the uncompressed and compressed sizes
+    std::size_t saved_bytes() const {
+      return (uncompressed_bytes > compressed_bytes ?
+          uncompressed_bytes - compressed_bytes : 0ul);
+    }
+  }; // struct TileCompressionStats
+
+  /// Compression codec of broadcast tiles
+
+  /// The codec is read from the \c TA_TILE_COMPRESSION environment variable
+  /// (\c none , \c lossless , or \c lossy ); the default codec is \c none .
+  /// \return The codec of broadcast tiles
+  TileCodec tile_codec();
+
+  /// Select the compression codec of broadcast tiles
+
+  /// The lossy codec replaces all elements with an absolute value less than
+  /// \c tolerance with zero, so the error of each element is bounded by
+  /// \c tolerance .
+  /// \note The codec, tolerance, and threshold must be the same on all
+  /// processes, so this function should be called collectively and outside
+  /// of expression evaluation.
+  /// \param codec The codec
+  /// \param tolerance The element tolerance of the lossy codec
+  /// \throw TiledArray::Exception When \c tolerance is negative.
+  void tile_codec(const TileCodec codec, const double tolerance = 0.0);
+
+  /// Element tolerance of the lossy codec
+
+  /// The initial tolerance is read from the
+  /// \c TA_TILE_COMPRESSION_TOLERANCE environment variable.
+  /// \return The element tolerance of the lossy codec
+  double tile_codec_tolerance();
+
+  /// The smallest tile, in bytes, that is compressed
+
+  /// The initial threshold is read from the
+  /// \c TA_TILE_COMPRESSION_THRESHOLD environment variable; the default
+  /// threshold is 64 kB.
+  /// \return The compression threshold in bytes
+  std::size_t tile_compression_threshold();
+
+  /// Set the smallest tile, in bytes, that is compressed
+
+  /// \note See \c tile_codec()
+  /// \param bytes The compression threshold
+  void tile_compression_threshold(const std::size_t bytes);
+
+  /// Tile compression counters of this process
+
+  /// \return The counters accumulated since the last reset
+  TileCompressionStats tile_compression_stats();
+
+  /// Reset the tile compression counters of this process
+  void reset_tile_compression_stats();
+
+  namespace detail {
+
+    /// Compress a byte buffer
+
+    /// The bytes of the \c n / \c width elements in \c data are shuffled, so
+    /// that byte \c k of all elements is contiguous, and the result is
+    /// run-length encoded.
+    /// \param data The buffer to be compressed
+    /// \param n The size of \c data in bytes
+    /// \param width The element size in bytes
+    /// \param[out] result The compressed buffer
+    void compress_bytes(const unsigned char* const data, const std::size_t n,
+        const std::size_t width, std::vector<unsigned char>& result);
+
+    /// Decompress a byte buffer that was compressed by \c compress_bytes()
+
+    /// \param data The compressed buffer
+    /// \param width The element size in bytes
+    /// \param[out] result The decompressed buffer
+    /// \param n The size of \c result in bytes
+    /// \throw TiledArray::Exception When \c data is not a valid compressed
+    /// buffer of \c n bytes.
+    void decompress_bytes(const std::vector<unsigned char>& data,
+        const std::size_t width, unsigned char* const result, const std::size_t n);
+
+    /// Add a compressed tile to the compression counters
+    void record_tile_compression(const std::size_t uncompressed_bytes,
+        const std::size_t compressed_bytes, const double time);
+
+    /// Add a decompressed tile to the compression counters
+    void record_tile_decompression(const double time);
+
+    /// Compressible tile type trait
+
+    /// Tiles that satisfy this trait hold their elements in a single
+    /// contiguous buffer of real or complex floating point values.
+    /// \tparam T The tile type
+    template <typename T>
+    struct is_compressible_tile : public std::false_type { };
+
+    template <typename T, typename A>
+    struct is_compressible_tile<Tensor<T, A> > :
+        public std::integral_constant<bool, std::is_floating_point<T>::value ||
+            (is_complex<T>::value && is_numeric<T>::value)> { };
+
+    /// Check that a tile with \c volume elements is compressed
+
+    /// \tparam Tile The tile type
+    /// \param volume The number of elements in the tile
+    /// \return \c true if \c Tile satisfies \c is_compressible_tile , a codec
+    /// is selected, and the tile is not smaller than the compression
+    /// threshold.
+    template <typename Tile>
+    inline typename std::enable_if<is_compressible_tile<Tile>::value, bool>::type
+    is_compressed(const std::size_t volume) {
+      return (tile_codec() != TileCodec::none) && (volume != 0ul) &&
+          ((volume * sizeof(typename Tile::value_type)) >= tile_compression_threshold());
+    }
+
+    template <typename Tile>
+    inline typename std::enable_if<! is_compressible_tile<Tile>::value, bool>::type
+    is_compressed(const std::size_t) { return false; }
+
+    /// A compressed tile
+
+    /// \tparam Tile The uncompressed tile type
+    template <typename Tile>
+    class CompressedTile {
+    public:
+      typedef typename Tile::range_type range_type; ///< Tile range type
+      typedef typename Tile::value_type value_type; ///< Tile element type
+
+    private:
+      range_type range_; ///< The range of the tile
+      std::vector<unsigned char> data_; ///< The compressed tile data
+
+    public:
+
+      CompressedTile() = default;
+
+      /// Compress \c tile
+
+      /// \param tile The tile to be compressed
+      /// \param codec The compression codec
+      /// \param tolerance The element tolerance of the lossy codec
+      CompressedTile(const Tile& tile, const TileCodec codec, const double tolerance) :
+        range_(tile.range()), data_()
+      {
+        TA_ASSERT(codec != TileCodec::none);
+
+        const std::size_t bytes = tile.size() * sizeof(value_type);
+        if((codec == TileCodec::lossy) && (tolerance > 0.0)) {
+          std::vector<value_type> truncated(tile.data(), tile.data() + tile.size());
+          for(value_type& value : truncated)
+            if(std::abs(value) < tolerance)
+              value = value_type(0);
+          compress_bytes(reinterpret_cast<const unsigned char*>(truncated.data()),
+              bytes, sizeof(value_type), data_);
+        } else {
+          compress_bytes(reinterpret_cast<const unsigned char*>(tile.data()),
+              bytes, sizeof(value_type), data_);
+        }
+      }
+
+      /// Decompress the tile
+
+      /// \return The uncompressed tile
+      Tile decompress() const {
+        Tile result(range_);
+        decompress_bytes(data_, sizeof(value_type),
+            reinterpret_cast<unsigned char*>(result.data()),
+            result.size() * sizeof(value_type));
+        return result;
+      }
+
+      /// Compressed size accessor
+
+      /// \return The size of the compressed data in bytes
+      std::size_t size() const { return data_.size(); }
+
+      template <typename Archive>
+      void serialize(Archive& ar) { ar & range_ & data_; }
+
+    }; // class CompressedTile
+
+    /// Compress a tile with the selected codec
+
+    /// \tparam Tile The tile type
+    /// \param tile The tile to be compressed
+    /// \return The compressed tile
+    template <typename Tile>
+    CompressedTile<Tile> compress_tile(const Tile& tile) {
+      const double start = madness::wall_time();
+      CompressedTile<Tile> result(tile, tile_codec(), tile_codec_tolerance());
+      record_tile_compression(tile.size() * sizeof(typename Tile::value_type),
+          result.size(), madness::wall_time() - start);
+      return result;
+    }
+
+    /// Decompress a tile
+
+    /// \tparam Tile The tile type
+    /// \param tile The compressed tile
+    /// \return The uncompressed tile
+    template <typename Tile>
+    Tile decompress_tile(const CompressedTile<Tile>& tile) {
+      const double start = madness::wall_time();
+      Tile result = tile.decompress();
+      record_tile_decompression(madness::wall_time() - start);
+      return result;
+    }
+
+    /// Broadcast a compressed tile to a process group
+
+    /// The root process compresses the tile once, the compressed tile is
+    /// broadcast with \c madness::WorldGopInterface::bcast() , and all other
+    /// processes decompress it. All processes in \c group must call this
+    /// function with the same \c volume .
+    /// \tparam Tile The tile type
+    /// \param world The world where the tile is broadcast
+    /// \param key The broadcast key
+    /// \param[in,out] tile The tile on the root process; on all other
+    /// processes it is set with the broadcast tile.
+    /// \param group_root The group rank of the root process
+    /// \param group The broadcast group
+    /// \param volume The number of elements in the tile
+    /// \return \c true if the tile is broadcast, or \c false if it does not
+    /// satisfy \c is_compressed() .
+    template <typename Tile>
+    typename std::enable_if<is_compressible_tile<Tile>::value, bool>::type
+    compressed_bcast(World& world, const madness::DistributedID& key,
+        Future<Tile>& tile, const ProcessID group_root,
+        const madness::Group& group, const std::size_t volume)
+    {
+      if(! is_compressed<Tile>(volume))
+        return false;
+
+      const bool is_root = (group.rank() == group_root);
+      Future<CompressedTile<Tile> > compressed;
+      if(is_root)
+        compressed = world.taskq.add(& compress_tile<Tile>, tile,
+            madness::TaskAttributes::hipri());
+      world.gop.bcast(key, compressed, group_root, group);
+      if(! is_root)
+        tile.set(world.taskq.add(& decompress_tile<Tile>, compressed,
+            madness::TaskAttributes::hipri()));
+
+      return true;
+    }
+
+    template <typename Tile>
+    typename std::enable_if<! is_compressible_tile<Tile>::value, bool>::type
+    compressed_bcast(World&, const madness::DistributedID&, Future<Tile>&,
+        const ProcessID, const madness::Group&, const std::size_t)
+    { return false; }
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_COMPRESSION_H__INCLUDED
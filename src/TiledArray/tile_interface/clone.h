@@ -41,6 +41,25 @@ namespace TiledArray {
     return arg.clone();
   }
 
+  /// Create a copy of \c arg that another array may hold
+
+  /// Copy-on-write tiles (see \c is_copy_on_write_tile ) are shared, other
+  /// tiles are cloned so that modifying one copy does not modify the other.
+  /// \tparam Arg The tile argument type
+  /// \param arg The tile argument to be copied
+  /// \return A copy of \c arg that does not alias \c arg on write
+  template <typename Arg,
+      typename std::enable_if<is_copy_on_write_tile<Arg>::value>::type* = nullptr>
+  inline Arg share_or_clone(const Arg& arg) {
+    return arg;
+  }
+
+  template <typename Arg,
+      typename std::enable_if<! is_copy_on_write_tile<Arg>::value>::type* = nullptr>
+  inline auto share_or_clone(const Arg& arg) {
+    return clone(arg);
+  }
+
   namespace tile_interface {
 
     using TiledArray::clone;
@@ -108,6 +127,25 @@ namespace TiledArray {
         public TiledArray::Cast<Result, Arg>
     { };
 
+    // Internal copy-on-write tile clone operation
+
+    /// Copy-on-write tiles are shared instead of cloned, since the tile data
+    /// is cloned when a shared copy is modified.
+    /// \tparam Arg The argument tile type
+    template <typename Arg>
+    class Clone<Arg, Arg,
+        typename std::enable_if<
+            TiledArray::is_copy_on_write_tile<Arg>::value
+        >::type>
+    {
+    public:
+
+      typedef Arg result_type; ///< Result tile type
+      typedef Arg argument_type; ///< Argument tile type
+
+      result_type operator()(const argument_type& arg) const { return arg; }
+    };
+
   } // namespace tile_interface
 
 
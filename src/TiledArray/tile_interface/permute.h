@@ -27,6 +27,8 @@
 #define TILEDARRAY_TILE_INTERFACE_PERMUTE_H__INCLUDED
 
 #include "../type_traits.h"
+#include "../range.h"
+#include "../zero_tensor.h"
 #include "../tile_interface/cast.h"
 
 namespace TiledArray {
@@ -43,6 +45,51 @@ namespace TiledArray {
   inline auto permute(const Arg& arg, const Permutation& perm)
   { return arg.permute(perm); }
 
+  namespace detail {
+
+    template <typename Arg>
+    inline auto permute_to(Arg& arg, const Permutation& perm, int)
+        -> decltype(arg.permute_to(perm), void())
+    { arg.permute_to(perm); }
+
+    template <typename Arg>
+    inline void permute_to(Arg& arg, const Permutation& perm, long) {
+      using TiledArray::permute;
+      arg = permute(arg, perm);
+    }
+
+    /// Check that a permutation does not move the elements of a tile
+
+    /// \tparam Arg The tile argument type
+    /// \param perm The permutation to be applied to \c arg
+    /// \param arg The tile argument
+    /// \return \c true when \c arg can be permuted by permuting its range
+    template <typename Arg>
+    inline bool is_layout_preserving(const Permutation& perm, const Arg& arg) {
+      return is_layout_preserving(perm, arg.range());
+    }
+
+    inline bool is_layout_preserving(const Permutation&, const ZeroTensor&) {
+      return false;
+    }
+
+  }  // namespace detail
+
+  /// Permute \c arg in place
+
+  /// Tiles that define a \c permute_to() member function reuse their data
+  /// when they can (see \c Tensor::permute_to() ), other tiles are replaced
+  /// by a permuted copy.
+  /// \tparam Arg The tile argument type
+  /// \param arg The tile argument to be permuted
+  /// \param perm The permutation to be applied to \c arg
+  /// \return A reference to \c arg
+  template <typename Arg>
+  inline Arg& permute_to(Arg& arg, const Permutation& perm) {
+    detail::permute_to(arg, perm, 0);
+    return arg;
+  }
+
   template <typename> struct permute_trait;
 
   namespace tile_interface {
@@ -86,7 +133,9 @@ namespace TiledArray {
     template <typename Result, typename Arg>
     class Permute<Result, Arg,
         typename std::enable_if<
-            ! std::is_same<Result, result_of_permute_t<Arg> >::value
+            ! std::is_same<Result, result_of_permute_t<Arg> >::value &&
+            ! std::is_constructible<Result, const Arg&,
+                const Permutation&>::value
         >::type> :
         public TiledArray::Cast<Result, result_of_permute_t<Arg> >
     {
@@ -106,6 +155,30 @@ namespace TiledArray {
 
     };
 
+    // Result tiles that can be constructed from a permuted argument, e.g.
+    // Tensor<double> from Tensor<float>, are converted as they are permuted,
+    // instead of permuting and then casting the argument.
+    template <typename Result, typename Arg>
+    class Permute<Result, Arg,
+        typename std::enable_if<
+            ! std::is_same<Result, result_of_permute_t<Arg> >::value &&
+            std::is_constructible<Result, const Arg&,
+                const Permutation&>::value
+        >::type>
+    {
+    public:
+
+      typedef Result result_type; ///< Result tile type
+      typedef Arg argument_type; ///< Argument tile type
+
+      result_type operator()(const argument_type& arg,
+          const Permutation& perm) const
+      {
+        return result_type(arg, perm);
+      }
+
+    };
+
   } // namespace tile_interface
 
 
@@ -71,7 +71,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       static result_type eval(const left_type& first, const right_type& second,
           const Permutation& perm)
@@ -162,6 +163,16 @@ namespace TiledArray {
       template <typename L, typename R>
       result_type
       operator()(L&& left, R&& right, const Permutation& perm) const {
+        if((left_is_consumable && is_layout_preserving(perm, left)) ||
+            (right_is_consumable && is_layout_preserving(perm, right)))
+        {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result = Add_::template eval<left_is_consumable,
+              right_is_consumable>(std::forward<L>(left), std::forward<R>(right));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(std::forward<L>(left), std::forward<R>(right), perm);
       }
 
@@ -221,6 +232,46 @@ namespace TiledArray {
             std::forward<L>(left), right);
       }
 
+      /// Evaluate with a permuted left-hand argument
+
+      /// Compute the sum of `perm * left` and `right` in a single pass,
+      /// without storing the permuted left-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param perm The permutation applied to `left`
+      /// \param right The right-hand tile argument
+      /// \param consume If `true`, the result is stored in `right`
+      /// \return The sum of the permuted `left` and `right`
+      result_type permute_left(const left_type& left, const Permutation& perm,
+          right_type& right, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        if(consume)
+          return right.inplace_binary(left, perm,
+              [] (numeric_type& r, const numeric_type l) { r = l + r; });
+        return left.binary(perm, right,
+            [] (const numeric_type l, const numeric_type r) { return l + r; });
+      }
+
+      /// Evaluate with a permuted right-hand argument
+
+      /// Compute the sum of `left` and `perm * right` in a single pass,
+      /// without storing the permuted right-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \param perm The permutation applied to `right`
+      /// \param consume If `true`, the result is stored in `left`
+      /// \return The sum of `left` and the permuted `right`
+      result_type permute_right(left_type& left, const right_type& right,
+          const Permutation& perm, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        if(consume)
+          return left.inplace_binary(right, perm,
+              [] (numeric_type& l, const numeric_type r) { l = l + r; });
+        return right.binary(perm, left,
+            [] (const numeric_type r, const numeric_type l) { return l + r; });
+      }
+
     }; // class Add
 
     /// Tile scale-addition operation
@@ -263,7 +314,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       result_type eval(const left_type& first, const right_type& second,
           const Permutation& perm) const
@@ -367,6 +419,16 @@ namespace TiledArray {
       template <typename L, typename R>
       result_type
       operator()(L&& left, R&& right, const Permutation& perm) const {
+        if((left_is_consumable && is_layout_preserving(perm, left)) ||
+            (right_is_consumable && is_layout_preserving(perm, right)))
+        {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result = ScalAdd_::template eval<left_is_consumable,
+              right_is_consumable>(std::forward<L>(left), std::forward<R>(right));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(std::forward<L>(left), std::forward<R>(right), perm);
       }
 
@@ -426,6 +488,52 @@ namespace TiledArray {
             std::forward<L>(left), right);
       }
 
+      /// Evaluate with a permuted left-hand argument
+
+      /// Compute the scaled sum of `perm * left` and `right` in a single
+      /// pass, without storing the permuted left-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param perm The permutation applied to `left`
+      /// \param right The right-hand tile argument
+      /// \param consume If `true`, the result is stored in `right`
+      /// \return The scaled sum of the permuted `left` and `right`
+      result_type permute_left(const left_type& left, const Permutation& perm,
+          right_type& right, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        const scalar_type factor = factor_;
+        if(consume)
+          return right.inplace_binary(left, perm,
+              [factor] (numeric_type& r, const numeric_type l)
+                  { r = (l + r) * factor; });
+        return left.binary(perm, right,
+            [factor] (const numeric_type l, const numeric_type r)
+                { return (l + r) * factor; });
+      }
+
+      /// Evaluate with a permuted right-hand argument
+
+      /// Compute the scaled sum of `left` and `perm * right` in a single
+      /// pass, without storing the permuted right-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \param perm The permutation applied to `right`
+      /// \param consume If `true`, the result is stored in `left`
+      /// \return The scaled sum of `left` and the permuted `right`
+      result_type permute_right(left_type& left, const right_type& right,
+          const Permutation& perm, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        const scalar_type factor = factor_;
+        if(consume)
+          return left.inplace_binary(right, perm,
+              [factor] (numeric_type& l, const numeric_type r)
+                  { l = (l + r) * factor; });
+        return right.binary(perm, left,
+            [factor] (const numeric_type r, const numeric_type l)
+                { return (l + r) * factor; });
+      }
+
     }; // class ScalAdd
 
   } // namespace detail
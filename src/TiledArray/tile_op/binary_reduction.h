@@ -27,12 +27,94 @@
 #define TILEDARRAY_TILE_OP_BINARY_REDUCTION_H__INCLUDED
 
 #include <TiledArray/tile_op/tile_interface.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/tensor/type_traits.h>
+#include <vector>
 
 namespace TiledArray {
+  namespace detail {
+
+    /// Dot product of a tile and a permuted tile
+
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \param left The left-hand tile
+    /// \param right The right-hand tile
+    /// \param perm The permutation that maps \c right to the layout of
+    /// \c left
+    /// \return The dot product of \c left and <tt>perm * right</tt>
+    template <typename Left, typename Right,
+        typename std::enable_if<! is_tensor<Left, Right>::value>::type* = nullptr>
+    inline auto permuted_dot(const Left& left, const Right& right,
+        const Permutation& perm) -> decltype(dot(left, right))
+    {
+      using TiledArray::dot;
+      using TiledArray::permute;
+      return dot(left, permute(right, perm));
+    }
+
+    /// Dot product of a tensor and a permuted tensor
+
+    /// The elements of \c right are visited in memory order, and the
+    /// matching elements of \c left are visited with the permuted strides,
+    /// so the permuted tensor is never constructed.
+    /// \tparam Left The left-hand tensor type
+    /// \tparam Right The right-hand tensor type
+    /// \param left The left-hand tensor
+    /// \param right The right-hand tensor
+    /// \param perm The permutation that maps \c right to the layout of
+    /// \c left
+    /// \return The dot product of \c left and <tt>perm * right</tt>
+    template <typename Left, typename Right,
+        typename std::enable_if<is_tensor<Left, Right>::value>::type* = nullptr>
+    inline auto permuted_dot(const Left& left, const Right& right,
+        const Permutation& perm) -> decltype(left.dot(right))
+    {
+      typedef decltype(left.dot(right)) result_type;
+      TA_ASSERT(left.range() == perm * right.range());
+
+      result_type result(0);
+      if(right.empty())
+        return result;
+
+      // The stride of left for each dimension of right
+      const auto& range = right.range();
+      const unsigned int rank = range.rank();
+      std::vector<std::size_t> left_stride(rank);
+      for(unsigned int d = 0u; d < rank; ++d)
+        left_stride[d] = left.range().stride(perm[d]);
+
+      const auto* MADNESS_RESTRICT const left_data = left.data();
+      const auto* MADNESS_RESTRICT const right_data = right.data();
+      const std::size_t inner_extent = range.extent(rank - 1u);
+      const std::size_t inner_stride = left_stride[rank - 1u];
+      std::vector<std::size_t> index(rank, 0ul);
+      std::size_t left_offset = 0ul;
+      for(std::size_t i = 0ul; i < range.volume(); i += inner_extent) {
+        for(std::size_t j = 0ul; j < inner_extent; ++j)
+          result += left_data[left_offset + j * inner_stride] * right_data[i + j];
+
+        // Increment the outer index of right
+        for(unsigned int d = rank - 1u; d > 0u; --d) {
+          left_offset += left_stride[d - 1u];
+          if(++index[d - 1u] < range.extent(d - 1u))
+            break;
+          left_offset -= left_stride[d - 1u] * range.extent(d - 1u);
+          index[d - 1u] = 0ul;
+        }
+      }
+
+      return result;
+    }
+
+  }  // namespace detail
 
   /// Vector dot product tile reduction
 
   /// This reduction operation computes the vector dot product of a tile.
+  /// The right-hand tile may be given in a permuted layout, in which case
+  /// the permutation is applied while the dot product is evaluated.
   /// \tparam Left The left-hand tile type
   /// \tparam Right The right-hand tile type
   template <typename Left, typename Right>
@@ -44,6 +126,17 @@ namespace TiledArray {
     typedef Left first_argument_type;
     typedef Right second_argument_type;
 
+  private:
+    Permutation perm_; ///< The permutation applied to the right-hand tiles
+
+  public:
+
+    /// Constructor
+
+    /// \param perm The permutation that maps the right-hand tiles to the
+    /// layout of the left-hand tiles
+    DotReduction(const Permutation& perm = Permutation()) : perm_(perm) { }
+
     // Reduction functions
 
     // Make an empty result object
@@ -61,11 +154,29 @@ namespace TiledArray {
     void operator()(result_type& result, const first_argument_type& left,
         const second_argument_type& right) const {
       using TiledArray::dot;
-      result += dot(left, right);
+      if(perm_)
+        result += detail::permuted_dot(left, right, perm_);
+      else
+        result += dot(left, right);
     }
 
   }; // class DotReduction
 
+  namespace detail {
+
+    /// Check that a binary reduction can permute its right-hand tiles
+
+    /// \tparam Op The reduction operation type
+    template <typename Op>
+    struct is_permuting_reduction : public std::false_type { };
+
+    template <typename Left, typename Right>
+    struct is_permuting_reduction<DotReduction<Left, Right> > :
+        public std::true_type
+    { };
+
+  }  // namespace detail
+
 } // namespace TiledArray
 
 #endif // TILEDARRAY_TILE_OP_BINARY_REDUCTION_H__INCLUDED
@@ -29,10 +29,31 @@
 #include <TiledArray/tile_op/tile_interface.h>
 #include <TiledArray/permutation.h>
 #include <TiledArray/zero_tensor.h>
+#include <TiledArray/tensor/type_traits.h>
 
 namespace TiledArray {
   namespace detail {
 
+    // Forward declarations
+    template <typename> class UnaryWrapper;
+    template <typename, typename, bool> class Noop;
+
+    /// Detect a lazy array tile that is, at most, permuted
+
+    /// \c is_permute_array_tile evaluates to \c std::true_type when \c T is a
+    /// \c LazyArrayTile that evaluates to its own tile type without
+    /// modification, other than a permutation, otherwise it evaluates to
+    /// \c std::false_type .
+    /// \tparam T The tile type to test
+    template <typename T>
+    struct is_permute_array_tile : public std::false_type { };
+
+    template <typename Tile, bool Consumable>
+    struct is_permute_array_tile<LazyArrayTile<Tile,
+        UnaryWrapper<Noop<Tile, Tile, Consumable> > > > :
+        public std::true_type
+    { }; // struct is_permute_array_tile
+
     /// Binary tile operation wrapper
 
     /// This wrapper class is handles evaluation of lazily evaluated tiles in binary operations and
@@ -82,6 +103,15 @@ namespace TiledArray {
     ///   template <typename L>
     ///   result_type consume_right(L&& left, right_type& right) const;
     ///
+    ///   // Evaluate the operation with a permuted left or right argument in a
+    ///   // single pass. These are only used with tensor tiles, when the result
+    ///   // and argument types are the same and the result is not permuted. If
+    ///   // consume is true, the non-permuted argument may be consumed.
+    ///   result_type permute_left(const left_type& left, const Permutation& perm,
+    ///       right_type& right, const bool consume) const;
+    ///   result_type permute_right(left_type& left, const right_type& right,
+    ///       const Permutation& perm, const bool consume) const;
+    ///
     /// }; // class Operator
     /// \endcode
     /// \tparam Op The base binary operation type
@@ -111,11 +141,63 @@ namespace TiledArray {
       template <typename T>
       using eval_t = typename eval_trait<std::decay_t<T> >::type;
 
+      template <typename T>
+      static constexpr auto is_permute_tile_v =
+          is_permute_array_tile<std::decay_t<T> >::value;
+
+      /// Indicates that the permutation of an argument can be fused with the
+      /// base operation, which is the case for tensor tiles when one argument
+      /// is a, possibly permuted, array tile and the other argument is
+      /// either an array tile or an evaluated tile
+      template <typename L, typename R>
+      static constexpr auto is_fusable_v =
+          is_tensor<result_type>::value &&
+          std::is_same<left_type, result_type>::value &&
+          std::is_same<right_type, result_type>::value &&
+          (is_permute_tile_v<L> || is_permute_tile_v<R>) &&
+          (is_permute_tile_v<L> || std::is_same<std::decay_t<L>, result_type>::value) &&
+          (is_permute_tile_v<R> || std::is_same<std::decay_t<R>, result_type>::value);
+
     private:
 
       Op op_; ///< Tile operation
       Permutation perm_; ///< Permuation applied to the result
 
+      // Argument accessors for the fused permutation evaluation
+
+      template <typename T, std::enable_if_t<is_array_tile_v<T> >* = nullptr>
+      static const Permutation* fused_perm(const T& arg) {
+        const Permutation& perm = arg.op().permutation();
+        return (perm ? &perm : nullptr);
+      }
+
+      template <typename T, std::enable_if_t<!is_array_tile_v<T> >* = nullptr>
+      static const Permutation* fused_perm(const T&) { return nullptr; }
+
+      template <typename T, std::enable_if_t<is_array_tile_v<T> >* = nullptr>
+      static const result_type& fused_tile(const T& arg) { return arg.tile(); }
+
+      template <typename T, std::enable_if_t<!is_array_tile_v<T> >* = nullptr>
+      static const result_type& fused_tile(const T& arg) { return arg; }
+
+      template <typename T, std::enable_if_t<is_array_tile_v<T> >* = nullptr>
+      static result_type fused_eval(T&& arg) {
+        return invoke_cast(std::forward<T>(arg));
+      }
+
+      template <typename T, std::enable_if_t<!is_array_tile_v<T> >* = nullptr>
+      static result_type fused_eval(T&& arg) { return arg; }
+
+      template <bool C, typename T,
+          std::enable_if_t<is_array_tile_v<T> >* = nullptr>
+      static bool fused_consumable(const T& arg) { return arg.is_consumable(); }
+
+      template <bool C, typename T,
+          std::enable_if_t<!is_array_tile_v<T> >* = nullptr>
+      static constexpr bool fused_consumable(T&&) {
+        return C && ! std::is_const<std::remove_reference_t<T> >::value;
+      }
+
     public:
 
       // Compiler generated functions
@@ -208,8 +290,8 @@ namespace TiledArray {
       /// evaluated \c left and \c right .
       template <typename L, typename R,
                 std::enable_if_t<is_lazy_tile_v<L> && is_lazy_tile_v<R> &&
-                                 (left_is_consumable || right_is_consumable)>* =
-                    nullptr>
+                                 (left_is_consumable || right_is_consumable) &&
+                                 ! is_fusable_v<L, R> >* = nullptr>
       auto operator()(L&& left, R&& right) const {
         auto eval_left = invoke_cast(std::forward<L>(left));
         auto eval_right = invoke_cast(std::forward<R>(right));
@@ -234,8 +316,8 @@ namespace TiledArray {
       template <typename L, typename R,
                 std::enable_if_t<is_lazy_tile_v<L> &&
                                  (!is_lazy_tile_v<R>)&&(left_is_consumable ||
-                                                        right_is_consumable)>* =
-                    nullptr>
+                                                        right_is_consumable) &&
+                                 ! is_fusable_v<L, R> >* = nullptr>
       auto operator()(L&& left, R&& right) const {
         auto eval_left = invoke_cast(std::forward<L>(left));
         auto continuation = [this](decltype(eval_left)& l, R&& r) {
@@ -258,8 +340,8 @@ namespace TiledArray {
       /// evaluated \c left and \c right .
       template <typename L, typename R,
                 std::enable_if_t<(!is_lazy_tile_v<L>)&&is_lazy_tile_v<R> &&
-                                 (left_is_consumable || right_is_consumable)>* =
-                    nullptr>
+                                 (left_is_consumable || right_is_consumable) &&
+                                 ! is_fusable_v<L, R> >* = nullptr>
       auto operator()(L&& left, R&& right) const {
         auto eval_right = invoke_cast(std::forward<R>(right));
         return BinaryWrapper_::operator()(std::forward<L>(left), eval_right);
@@ -279,7 +361,8 @@ namespace TiledArray {
       template <typename L, typename R,
                 std::enable_if_t<is_array_tile_v<L> && is_array_tile_v<R> &&
                                  !(left_is_consumable ||
-                                   right_is_consumable)>* = nullptr>
+                                   right_is_consumable) &&
+                                 ! is_fusable_v<L, R> >* = nullptr>
       auto operator()(L&& left, R&& right) const {
         auto eval_left = invoke_cast(std::forward<L>(left));
         auto eval_right = invoke_cast(std::forward<R>(right));
@@ -308,7 +391,8 @@ namespace TiledArray {
                 std::enable_if_t<
                     is_array_tile_v<L> &&
                     (!is_lazy_tile_v<R>)&&!(left_is_consumable ||
-                                            right_is_consumable)>* = nullptr>
+                                            right_is_consumable) &&
+                    ! is_fusable_v<L, R> >* = nullptr>
       auto operator()(L&& left, R&& right) const {
         auto eval_left = invoke_cast(std::forward<L>(left));
 
@@ -343,7 +427,8 @@ namespace TiledArray {
       template <typename L, typename R,
                 std::enable_if_t<(!is_lazy_tile_v<L>)&&is_array_tile_v<R> &&
                                  !(left_is_consumable ||
-                                   right_is_consumable)>* = nullptr>
+                                   right_is_consumable) &&
+                                 ! is_fusable_v<L, R> >* = nullptr>
       auto operator()(L&& left, R&& right) const {
         auto eval_right = invoke_cast(std::forward<R>(right));
 
@@ -375,6 +460,52 @@ namespace TiledArray {
         return op_(eval_left, eval_right);
       }
 
+      /// Evaluate tiles with a fused permutation
+
+      /// When one argument is an array tile that is permuted, and the result is
+      /// not permuted, the base operation applies the permutation in the same
+      /// pass as the element-wise operation, so the permuted argument is never
+      /// stored in a temporary tile. Otherwise the arguments are evaluated and
+      /// passed to the base operation as usual.
+      /// \tparam L The left-hand tile type
+      /// \tparam R The right-hand tile type
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \return The result tile from the binary operation applied to the
+      /// evaluated \c left and \c right .
+      template <typename L, typename R,
+                std::enable_if_t<is_fusable_v<L, R> >* = nullptr>
+      result_type operator()(L&& left, R&& right) const {
+        if(! perm_) {
+          if(const Permutation* left_perm = fused_perm(left)) {
+            const bool consume = fused_consumable<right_is_consumable>(right);
+            result_type eval_right = fused_eval(std::forward<R>(right));
+            return op_.permute_left(fused_tile(left), *left_perm, eval_right,
+                consume);
+          }
+          if(const Permutation* right_perm = fused_perm(right)) {
+            const bool consume = fused_consumable<left_is_consumable>(left);
+            result_type eval_left = fused_eval(std::forward<L>(left));
+            return op_.permute_right(eval_left, fused_tile(right), *right_perm,
+                consume);
+          }
+        }
+
+        const bool consume_left = fused_consumable<left_is_consumable>(left);
+        const bool consume_right = fused_consumable<right_is_consumable>(right);
+        result_type eval_left = fused_eval(std::forward<L>(left));
+        result_type eval_right = fused_eval(std::forward<R>(right));
+
+        if(perm_)
+          return op_(eval_left, eval_right, perm_);
+        if(consume_left)
+          return op_.consume_left(eval_left, eval_right);
+        if(consume_right)
+          return op_.consume_right(eval_left, eval_right);
+
+        return op_(eval_left, eval_right);
+      }
+
     }; // class BinaryWrapper
 
   } // namespace detail
@@ -26,16 +26,345 @@
 #ifndef TILEDARRAY_CONTRACT_REDUCE_H__INCLUDED
 #define TILEDARRAY_CONTRACT_REDUCE_H__INCLUDED
 
+#include <TiledArray/madness.h>
 #include <TiledArray/permutation.h>
 #include <TiledArray/math/gemm_helper.h>
 #include <TiledArray/tile_op/tile_interface.h>
 #include "../tile_interface/add.h"
 #include "../tile_interface/permute.h"
 #include <TiledArray/tensor/complex.h>
+#include <TiledArray/tensor/type_traits.h>
+#include <TiledArray/cuda_gemm.h>
+#include <cstdlib>
+#include <functional>
 
 namespace TiledArray {
   namespace detail {
 
+    /// Check that a tile contraction may be evaluated in a batch
+
+    /// Batched contraction is only supported for \c Tensor tiles.
+    /// \return \c false
+    template <typename Left, typename Right>
+    inline bool is_batch_gemm(const Left&, const Right&,
+        const math::GemmHelper&, const std::size_t)
+    { return false; }
+
+    /// Check that a tensor contraction may be evaluated in a batch
+
+    /// \tparam T The left-hand tensor element type
+    /// \tparam AT The left-hand tensor allocator type
+    /// \tparam U The right-hand tensor element type
+    /// \tparam AU The right-hand tensor allocator type
+    /// \param left The left-hand tensor
+    /// \param right The right-hand tensor
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \param threshold The largest number of multiply-adds, \f$ m n k \f$, of
+    /// a batched contraction
+    /// \return \c true if the contraction of \c left and \c right is not
+    /// larger than \c threshold , or if contractions are streamed through
+    /// the device (see \c cuda_batch_gemm() ), in which case all
+    /// contractions are batched
+    template <typename T, typename AT, typename U, typename AU>
+    inline bool is_batch_gemm(const Tensor<T, AT>& left,
+        const Tensor<U, AU>& right, const math::GemmHelper& gemm_helper,
+        const std::size_t threshold)
+    {
+      if(left.empty() || right.empty())
+        return false;
+#ifdef TILEDARRAY_HAS_CUDA
+      if(cuda_gemm_enabled())
+        return true;
+#endif // TILEDARRAY_HAS_CUDA
+      integer m = 1, n = 1, k = 1;
+      gemm_helper.compute_matrix_sizes(m, n, k, left.range(), right.range());
+      return (std::size_t(m) * std::size_t(n) * std::size_t(k)) <= threshold;
+    }
+
+    /// Contract a batch of tile pairs and add the sum to a result tile
+
+    /// This is the fallback for tile types that do not support batched
+    /// contraction; the pairs are contracted one at a time.
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tile
+    /// \param[in] left The left-hand tiles to be contracted
+    /// \param[in] right The right-hand tiles to be contracted
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    inline void batch_gemm(Result& result, const std::vector<const Left*>& left,
+        const std::vector<const Right*>& right, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      using TiledArray::empty;
+      using TiledArray::gemm;
+      TA_ASSERT(left.size() == right.size());
+      for(std::size_t p = 0ul; p < left.size(); ++p) {
+        if(empty(result))
+          result = gemm(*left[p], *right[p], factor, gemm_helper);
+        else
+          gemm(result, *left[p], *right[p], factor, gemm_helper);
+      }
+    }
+
+    /// Contract a batch of tensor pairs and add the sum to a result tensor
+
+    /// The tensor pairs are contracted with a single *GEMM call, or streamed
+    /// through the device when \c TA_CUDA_GEMM_MAX_MEMORY is set.
+    /// \tparam T The result tensor element type
+    /// \tparam AT The result tensor allocator type
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tensor
+    /// \param[in] left The left-hand tensors to be contracted
+    /// \param[in] right The right-hand tensors to be contracted
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename T, typename AT, typename U, typename AU, typename V,
+        typename AV, typename Scalar>
+    inline void batch_gemm(Tensor<T, AT>& result,
+        const std::vector<const Tensor<U, AU>*>& left,
+        const std::vector<const Tensor<V, AV>*>& right, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      TA_ASSERT(left.size() == right.size());
+      if(left.empty())
+        return;
+#ifdef TILEDARRAY_HAS_CUDA
+      if(cuda_batch_gemm(result, left, right, factor, gemm_helper))
+        return;
+#endif // TILEDARRAY_HAS_CUDA
+      if(result.empty())
+        result = Tensor<T, AT>(gemm_helper.make_result_range<
+            typename Tensor<T, AT>::range_type>(left.front()->range(),
+            right.front()->range()), T(0));
+      result.gemm(left, right, factor, gemm_helper);
+    }
+
+    /// Contract a pair of tiles and add the result to a result tile
+
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tile
+    /// \param[in] left The left-hand tile to be contracted
+    /// \param[in] right The right-hand tile to be contracted
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    inline void gemm_to(Result& result, const Left& left, const Right& right,
+        const Scalar factor, const math::GemmHelper& gemm_helper)
+    {
+      using TiledArray::empty;
+      using TiledArray::gemm;
+      if(empty(result))
+        result = gemm(left, right, factor, gemm_helper);
+      else
+        gemm(result, left, right, factor, gemm_helper);
+    }
+
+    /// Contract a pair of permuted tiles and add the result to a result tile
+
+    /// This is the fallback for tile types that do not support the
+    /// contraction of permuted arguments; the arguments are permuted before
+    /// they are contracted.
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tile
+    /// \param[in] left The left-hand tile to be contracted
+    /// \param[in] left_perm The permutation applied to \c left
+    /// \param[in] right The right-hand tile to be contracted
+    /// \param[in] right_perm The permutation applied to \c right
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    inline void permute_gemm(Result& result, const Left& left,
+        const Permutation& left_perm, const Right& right,
+        const Permutation& right_perm, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      using TiledArray::permute;
+      if(left_perm && right_perm)
+        gemm_to(result, permute(left, left_perm), permute(right, right_perm),
+            factor, gemm_helper);
+      else if(left_perm)
+        gemm_to(result, permute(left, left_perm), right, factor, gemm_helper);
+      else if(right_perm)
+        gemm_to(result, left, permute(right, right_perm), factor, gemm_helper);
+      else
+        gemm_to(result, left, right, factor, gemm_helper);
+    }
+
+    /// Contract a pair of permuted tensors and add the result to a result tensor
+
+    /// The permutations are applied while the tensors are contracted, without
+    /// storing the permuted arguments.
+    /// \tparam T The result tensor element type
+    /// \tparam AT The result tensor allocator type
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tensor
+    /// \param[in] left The left-hand tensor to be contracted
+    /// \param[in] left_perm The permutation applied to \c left
+    /// \param[in] right The right-hand tensor to be contracted
+    /// \param[in] right_perm The permutation applied to \c right
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename T, typename AT, typename U, typename AU, typename V,
+        typename AV, typename Scalar>
+    inline void permute_gemm(Tensor<T, AT>& result, const Tensor<U, AU>& left,
+        const Permutation& left_perm, const Tensor<V, AV>& right,
+        const Permutation& right_perm, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      if(result.empty())
+        result = Tensor<T, AT>(gemm_helper.make_result_range<
+            typename Tensor<T, AT>::range_type>(
+            (left_perm ? left_perm * left.range() : left.range()),
+            (right_perm ? right_perm * right.range() : right.range())), T(0));
+      result.gemm(left, left_perm, right, right_perm, factor, gemm_helper);
+    }
+
+    /// Accumulation element type of mixed precision contractions
+
+    /// Single precision tensors are contracted in double precision when mixed
+    /// precision is selected; no other element type is widened.
+    /// \tparam T The tensor element type
+    template <typename T>
+    struct mixed_precision_accumulator { typedef void type; };
+
+    template <>
+    struct mixed_precision_accumulator<float> { typedef double type; };
+
+    template <>
+    struct mixed_precision_accumulator<std::complex<float> > {
+      typedef std::complex<double> type;
+    };
+
+    /// Contract a pair of tiles in mixed precision and add the result to a result tile
+
+    /// This is the fallback for tile types that do not support mixed
+    /// precision; the tiles are contracted in their own precision.
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tile
+    /// \param[in] left The left-hand tile to be contracted
+    /// \param[in] left_perm The permutation applied to \c left
+    /// \param[in] right The right-hand tile to be contracted
+    /// \param[in] right_perm The permutation applied to \c right
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    inline void mixed_gemm(Result& result, const Left& left,
+        const Permutation& left_perm, const Right& right,
+        const Permutation& right_perm, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      permute_gemm(result, left, left_perm, right, right_perm, factor,
+          gemm_helper);
+    }
+
+    /// Contract a pair of real tensors and add the result to a wide result tensor
+
+    /// The arguments are converted as they are packed (see \c Tensor::gemm() ).
+    template <typename T, typename AT, typename U, typename AU, typename V,
+        typename AV, typename Scalar,
+        typename std::enable_if<std::is_arithmetic<U>::value &&
+            std::is_arithmetic<V>::value>::type* = nullptr>
+    inline void mixed_gemm_to(Tensor<T, AT>& result, const Tensor<U, AU>& left,
+        const Permutation& left_perm, const Tensor<V, AV>& right,
+        const Permutation& right_perm, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      result.gemm(left, left_perm, right, right_perm, factor, gemm_helper);
+    }
+
+    /// Contract a pair of complex tensors and add the result to a wide result tensor
+
+    /// The arguments are widened, and permuted, by a copy.
+    template <typename T, typename AT, typename U, typename AU, typename V,
+        typename AV, typename Scalar,
+        typename std::enable_if<! (std::is_arithmetic<U>::value &&
+            std::is_arithmetic<V>::value)>::type* = nullptr>
+    inline void mixed_gemm_to(Tensor<T, AT>& result, const Tensor<U, AU>& left,
+        const Permutation& left_perm, const Tensor<V, AV>& right,
+        const Permutation& right_perm, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      typedef Tensor<T, AT> wide_tensor_type;
+      const wide_tensor_type wide_left = (left_perm ?
+          wide_tensor_type(left, left_perm) : wide_tensor_type(left));
+      const wide_tensor_type wide_right = (right_perm ?
+          wide_tensor_type(right, right_perm) : wide_tensor_type(right));
+      result.gemm(wide_left, wide_right, factor, gemm_helper);
+    }
+
+    /// Contract a pair of single precision tensors in double precision
+
+    /// The dot products of the contraction of one pair of tensors are
+    /// accumulated in double precision, and are added to the result in double
+    /// precision; the sum is then rounded to the precision of the result. The
+    /// result is thus rounded once per pair of tensors, not once per
+    /// element product, so the storage of the tensors is in single precision
+    /// while the dot products within a tile are not. The arguments are widened to double precision, and permuted, as they are
+    /// packed for the *GEMM calls (see \c Tensor::gemm() ), so no widened
+    /// copies of the arguments are stored. Complex arguments, which may be
+    /// conjugated, are widened by a copy.
+    /// \tparam T The result tensor element type
+    /// \tparam AT The result tensor allocator type
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam Scalar The scaling factor type
+    /// \param[in,out] result The result tensor
+    /// \param[in] left The left-hand tensor to be contracted
+    /// \param[in] left_perm The permutation applied to \c left
+    /// \param[in] right The right-hand tensor to be contracted
+    /// \param[in] right_perm The permutation applied to \c right
+    /// \param[in] factor The scaling factor
+    /// \param[in] gemm_helper The *GEMM operation meta data
+    template <typename T, typename AT, typename U, typename AU, typename V,
+        typename AV, typename Scalar>
+    inline typename std::enable_if<
+        ! std::is_void<typename mixed_precision_accumulator<T>::type>::value>::type
+    mixed_gemm(Tensor<T, AT>& result, const Tensor<U, AU>& left,
+        const Permutation& left_perm, const Tensor<V, AV>& right,
+        const Permutation& right_perm, const Scalar factor,
+        const math::GemmHelper& gemm_helper)
+    {
+      typedef typename mixed_precision_accumulator<T>::type accumulator_type;
+      typedef Tensor<accumulator_type,
+          typename default_tensor_allocator<accumulator_type>::type>
+          wide_tensor_type;
+
+      wide_tensor_type wide_result = (result.empty() ?
+          wide_tensor_type(gemm_helper.make_result_range<
+              typename wide_tensor_type::range_type>(
+              (left_perm ? left_perm * left.range() : left.range()),
+              (right_perm ? right_perm * right.range() : right.range())),
+              accumulator_type(0)) :
+          wide_tensor_type(result));
+      mixed_gemm_to(wide_result, left, left_perm, right, right_perm, factor,
+          gemm_helper);
+
+      result = Tensor<T, AT>(wide_result);
+    }
+
     /// Contract and reduce base
 
     /// This object uses a tile contraction operation to form a pair reduction
@@ -61,9 +390,13 @@ namespace TiledArray {
             const madness::cblas::CBLAS_TRANSPOSE right_op,
             const scalar_type alpha, const unsigned int result_rank,
             const unsigned int left_rank, const unsigned int right_rank,
-            const Permutation& perm = Permutation()) :
+            const Permutation& perm = Permutation(),
+            const Permutation& left_perm = Permutation(),
+            const Permutation& right_perm = Permutation()) :
           gemm_helper_(left_op, right_op, result_rank, left_rank, right_rank),
-          alpha_(alpha), perm_(perm)
+          alpha_(alpha), perm_(perm), left_perm_(left_perm),
+          right_perm_(right_perm), batch_threshold_(init_batch_threshold()),
+          mixed_precision_(false), epilogue_(), seed_()
         { }
 
         math::GemmHelper gemm_helper_; ///< Gemm helper object
@@ -71,10 +404,40 @@ namespace TiledArray {
             ///< the left- and right-hand arguments
         Permutation perm_; ///< Permutation that is applied to the final result
             ///< tensor
+        Permutation left_perm_; ///< Permutation that is applied to the
+            ///< left-hand tiles while they are contracted
+        Permutation right_perm_; ///< Permutation that is applied to the
+            ///< right-hand tiles while they are contracted
+        std::size_t batch_threshold_; ///< The largest batched contraction
+        bool mixed_precision_; ///< Accumulate single precision contractions
+            ///< in double precision
+        std::function<void(Result&)> epilogue_; ///< The operation that is
+            ///< applied to each result tile
+        std::function<bool(std::size_t, Future<Result>&)> seed_; ///< The
+            ///< initial values of the result tiles
       };
 
       std::shared_ptr<Impl> pimpl_;
 
+      /// Initialize the batched contraction threshold
+
+      /// The threshold is the largest number of multiply-adds,
+      /// \f$ m n k \f$, of a tile contraction that is batched with other
+      /// contractions into the same result tile. It is read from the
+      /// \c TA_GEMM_BATCH_THRESHOLD environment variable; a value of zero
+      /// disables batching. The default threshold, \f$ 2^{16} \f$,
+      /// corresponds to tiles that are about 40 elements wide.
+      /// \return The batched contraction threshold
+      static std::size_t init_batch_threshold() {
+        static const std::size_t threshold = [] () -> std::size_t {
+          const char* batch_threshold = getenv("TA_GEMM_BATCH_THRESHOLD");
+          if(batch_threshold)
+            return std::strtoul(batch_threshold, nullptr, 10);
+          return 65536ul;
+        }();
+        return threshold;
+      }
+
     public:
 
       /// Compiler generated functions
@@ -95,13 +458,19 @@ namespace TiledArray {
       /// \param right_rank The rank of the right-hand tensor
       /// \param perm The permutation to be applied to the result tensor
       /// (default = no permute)
+      /// \param left_perm The permutation that is applied to the left-hand
+      /// tiles while they are contracted (default = no permute)
+      /// \param right_perm The permutation that is applied to the right-hand
+      /// tiles while they are contracted (default = no permute)
       ContractReduceBase(const madness::cblas::CBLAS_TRANSPOSE left_op,
           const madness::cblas::CBLAS_TRANSPOSE right_op,
           const scalar_type alpha, const unsigned int result_rank,
           const unsigned int left_rank, const unsigned int right_rank,
-          const Permutation& perm = Permutation()) :
+          const Permutation& perm = Permutation(),
+          const Permutation& left_perm = Permutation(),
+          const Permutation& right_perm = Permutation()) :
         pimpl_(new Impl(left_op, right_op, alpha, result_rank, left_rank,
-            right_rank, perm))
+            right_rank, perm, left_perm, right_perm))
       { }
 
 
@@ -122,6 +491,24 @@ namespace TiledArray {
       }
 
 
+      /// Left-hand argument permutation accessor
+
+      /// \return A const reference to the permutation that is applied to the
+      /// left-hand tiles while they are contracted
+      const Permutation& left_perm() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->left_perm_;
+      }
+
+      /// Right-hand argument permutation accessor
+
+      /// \return A const reference to the permutation that is applied to the
+      /// right-hand tiles while they are contracted
+      const Permutation& right_perm() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->right_perm_;
+      }
+
       /// Scaling factor accessor
 
       /// \return The scaling factor for this operation
@@ -130,6 +517,92 @@ namespace TiledArray {
         return pimpl_->alpha_;
       }
 
+      /// Batched contraction threshold accessor
+
+      /// \return The largest number of multiply-adds of a tile contraction
+      /// that is batched with other contractions
+      std::size_t batch_threshold() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->batch_threshold_;
+      }
+
+      /// Set the batched contraction threshold
+
+      /// \param threshold The largest number of multiply-adds of a tile
+      /// contraction that is batched with other contractions; zero disables
+      /// batching
+      /// \note The threshold is shared by all copies of this object.
+      void batch_threshold(const std::size_t threshold) {
+        TA_ASSERT(pimpl_);
+        pimpl_->batch_threshold_ = threshold;
+      }
+
+      /// Mixed precision flag accessor
+
+      /// \return \c true if single precision tiles are contracted in double
+      /// precision
+      bool mixed_precision() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->mixed_precision_;
+      }
+
+      /// Select mixed precision contraction
+
+      /// When mixed precision is selected, single precision \c Tensor tiles
+      /// are contracted with double precision accumulation, and
+      /// contractions are not batched. The result tile is held in single
+      /// precision between tile pairs, so it is rounded once for each pair
+      /// of tiles that is contracted into it. Other tile types are not affected.
+      /// \param mixed_precision The mixed precision flag
+      /// \note The flag is shared by all copies of this object.
+      void mixed_precision(const bool mixed_precision) {
+        TA_ASSERT(pimpl_);
+        pimpl_->mixed_precision_ = mixed_precision;
+      }
+
+      /// Epilogue accessor
+
+      /// \return The operation that is applied in place to each result tile
+      /// once the contraction of the tile is complete; it is empty if the
+      /// result tiles are not modified
+      const std::function<void(Result&)>& epilogue() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->epilogue_;
+      }
+
+      /// Set the epilogue
+
+      /// \param epilogue The operation that is applied in place to each
+      /// result tile once the contraction of the tile is complete, i.e. after
+      /// the result permutation and the sum of all partial results
+      /// \note The epilogue is shared by all copies of this object.
+      void epilogue(const std::function<void(Result&)>& epilogue) {
+        TA_ASSERT(pimpl_);
+        pimpl_->epilogue_ = epilogue;
+      }
+
+      /// Seed accessor
+
+      /// \return The function that gives the initial value of result tiles;
+      /// it is empty if the result tiles are initialized to zero
+      const std::function<bool(std::size_t, Future<Result>&)>& seed() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->seed_;
+      }
+
+      /// Set the seed
+
+      /// \param seed A function that takes the (permuted) ordinal index of a
+      /// result tile, and returns \c true and assigns the initial value of
+      /// the tile to its second argument if the tile has an initial value.
+      /// The contraction is accumulated into a copy of the initial value,
+      /// which must have the range of the result tile.
+      /// \note The seed is shared by all copies of this object.
+      void seed(const std::function<bool(std::size_t, Future<Result>&)>& seed) {
+        TA_ASSERT(pimpl_);
+        pimpl_->seed_ = seed;
+      }
+
       /// Compute the number of contracted ranks
 
       /// \return The number of ranks that are summed by this operation
@@ -206,13 +679,19 @@ namespace TiledArray {
       /// \param right_rank The rank of the right-hand tensor
       /// \param perm The permutation to be applied to the result tensor
       /// (default = no permute)
+      /// \param left_perm The permutation that is applied to the left-hand
+      /// tiles while they are contracted (default = no permute)
+      /// \param right_perm The permutation that is applied to the right-hand
+      /// tiles while they are contracted (default = no permute)
       ContractReduce(const madness::cblas::CBLAS_TRANSPOSE left_op,
           const madness::cblas::CBLAS_TRANSPOSE right_op,
           const scalar_type alpha, const unsigned int result_rank,
           const unsigned int left_rank, const unsigned int right_rank,
-          const Permutation& perm = Permutation()) :
+          const Permutation& perm = Permutation(),
+          const Permutation& left_perm = Permutation(),
+          const Permutation& right_perm = Permutation()) :
         ContractReduceBase_(left_op, right_op, alpha, result_rank, left_rank,
-            right_rank, perm)
+            right_rank, perm, left_perm, right_perm)
       { }
 
 
@@ -231,6 +710,14 @@ namespace TiledArray {
         if(! ContractReduceBase_::perm())
           return temp;
 
+        // The reduction target is not used after this step, so it is
+        // permuted in place when the permutation moves only unit dimensions
+        if(is_layout_preserving(ContractReduceBase_::perm(), temp)) {
+          result_type result = temp;
+          using TiledArray::permute_to;
+          return permute_to(result, ContractReduceBase_::perm());
+        }
+
         TiledArray::Permute<result_type, result_type> permute;
         return permute(temp, ContractReduceBase_::perm());
       }
@@ -258,7 +745,21 @@ namespace TiledArray {
       {
         using TiledArray::empty;
         using TiledArray::gemm;
-        if(empty(result))
+        if(ContractReduceBase_::mixed_precision())
+          mixed_gemm(result, left, ContractReduceBase_::left_perm(), right,
+              ContractReduceBase_::right_perm(), ContractReduceBase_::factor(),
+              ContractReduceBase_::gemm_helper());
+        else if(ContractReduceBase_::left_perm() || ContractReduceBase_::right_perm())
+          permute_gemm(result, left, ContractReduceBase_::left_perm(), right,
+              ContractReduceBase_::right_perm(), ContractReduceBase_::factor(),
+              ContractReduceBase_::gemm_helper());
+#ifdef TILEDARRAY_HAS_CUDA
+        else if(batch(left, right) && cuda_batch_gemm(result,
+            std::vector<const Left*>(1, &left), std::vector<const Right*>(1, &right),
+            ContractReduceBase_::factor(), ContractReduceBase_::gemm_helper()))
+          return;
+#endif // TILEDARRAY_HAS_CUDA
+        else if(empty(result))
           result = gemm(left, right, ContractReduceBase_::factor(),
               ContractReduceBase_::gemm_helper());
         else
@@ -266,6 +767,39 @@ namespace TiledArray {
               ContractReduceBase_::gemm_helper());
       }
 
+      /// Check that a pair of tiles may be contracted in a batch
+
+      /// Small tile contractions, where the cost of a *GEMM call dominates,
+      /// are accumulated and contracted in a batch. Contractions of permuted
+      /// arguments and mixed precision contractions are not batched.
+      /// \param left The left-hand tile to be contracted
+      /// \param right The right-hand tile to be contracted
+      /// \return \c true if the contraction of \c left and \c right should be
+      /// batched with other contractions
+      bool batch(first_argument_type left, second_argument_type right) const {
+        if(ContractReduceBase_::left_perm() || ContractReduceBase_::right_perm() ||
+            ContractReduceBase_::mixed_precision())
+          return false;
+        return is_batch_gemm(left, right, ContractReduceBase_::gemm_helper(),
+            ContractReduceBase_::batch_threshold());
+      }
+
+      /// Contract a batch of tile pairs and add to a target tile
+
+      /// Contract the pairs <tt>(left[i], right[i])</tt> and add the sum of
+      /// the products to \c result.
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] left The left-hand tiles to be contracted
+      /// \param[in] right The right-hand tiles to be contracted
+      void operator()(result_type& result,
+          const std::vector<const Left*>& left,
+          const std::vector<const Right*>& right) const
+      {
+        batch_gemm(result, left, right, ContractReduceBase_::factor(),
+            ContractReduceBase_::gemm_helper());
+      }
+
     }; // class ContractReduce
 
 
@@ -316,13 +850,19 @@ namespace TiledArray {
       /// \param right_rank The rank of the right-hand tensor
       /// \param perm The permutation to be applied to the result tensor
       /// (default = no permute)
+      /// \param left_perm The permutation that is applied to the left-hand
+      /// tiles while they are contracted (default = no permute)
+      /// \param right_perm The permutation that is applied to the right-hand
+      /// tiles while they are contracted (default = no permute)
       ContractReduce(const madness::cblas::CBLAS_TRANSPOSE left_op,
           const madness::cblas::CBLAS_TRANSPOSE right_op,
           const scalar_type alpha, const unsigned int result_rank,
           const unsigned int left_rank, const unsigned int right_rank,
-          const Permutation& perm = Permutation()) :
+          const Permutation& perm = Permutation(),
+          const Permutation& left_perm = Permutation(),
+          const Permutation& right_perm = Permutation()) :
         ContractReduceBase_(left_op, right_op, alpha, result_rank, left_rank,
-            right_rank, perm)
+            right_rank, perm, left_perm, right_perm)
       { }
 
 
@@ -342,6 +882,12 @@ namespace TiledArray {
         if(! ContractReduceBase_::perm())
           return conj_to(temp);
 
+        if(is_layout_preserving(ContractReduceBase_::perm(), temp)) {
+          using TiledArray::permute_to;
+          conj_to(temp);
+          return permute_to(temp, ContractReduceBase_::perm());
+        }
+
         return conj(temp, ContractReduceBase_::perm());
       }
 
@@ -368,7 +914,15 @@ namespace TiledArray {
       {
         using TiledArray::empty;
         using TiledArray::gemm;
-        if(empty(result))
+        if(ContractReduceBase_::mixed_precision())
+          mixed_gemm(result, left, ContractReduceBase_::left_perm(), right,
+              ContractReduceBase_::right_perm(), 1,
+              ContractReduceBase_::gemm_helper());
+        else if(ContractReduceBase_::left_perm() || ContractReduceBase_::right_perm())
+          permute_gemm(result, left, ContractReduceBase_::left_perm(), right,
+              ContractReduceBase_::right_perm(), 1,
+              ContractReduceBase_::gemm_helper());
+        else if(empty(result))
           result = gemm(left, right, 1, ContractReduceBase_::gemm_helper());
         else
           gemm(result, left, right, 1, ContractReduceBase_::gemm_helper());
@@ -425,13 +979,19 @@ namespace TiledArray {
       /// \param right_rank The rank of the right-hand tensor
       /// \param perm The permutation to be applied to the result tensor
       /// (default = no permute)
+      /// \param left_perm The permutation that is applied to the left-hand
+      /// tiles while they are contracted (default = no permute)
+      /// \param right_perm The permutation that is applied to the right-hand
+      /// tiles while they are contracted (default = no permute)
       ContractReduce(const madness::cblas::CBLAS_TRANSPOSE left_op,
           const madness::cblas::CBLAS_TRANSPOSE right_op,
           const scalar_type alpha, const unsigned int result_rank,
           const unsigned int left_rank, const unsigned int right_rank,
-          const Permutation& perm = Permutation()) :
+          const Permutation& perm = Permutation(),
+          const Permutation& left_perm = Permutation(),
+          const Permutation& right_perm = Permutation()) :
         ContractReduceBase_(left_op, right_op, alpha, result_rank, left_rank,
-            right_rank, perm)
+            right_rank, perm, left_perm, right_perm)
       { }
 
 
@@ -451,6 +1011,12 @@ namespace TiledArray {
         if(! ContractReduceBase_::perm())
           return conj_to(temp, ContractReduceBase_::factor().factor());
 
+        if(is_layout_preserving(ContractReduceBase_::perm(), temp)) {
+          using TiledArray::permute_to;
+          conj_to(temp, ContractReduceBase_::factor().factor());
+          return permute_to(temp, ContractReduceBase_::perm());
+        }
+
         return conj(temp, ContractReduceBase_::factor().factor(),
             ContractReduceBase_::perm());
       }
@@ -478,7 +1044,15 @@ namespace TiledArray {
       {
         using TiledArray::empty;
         using TiledArray::gemm;
-        if(empty(result))
+        if(ContractReduceBase_::mixed_precision())
+          mixed_gemm(result, left, ContractReduceBase_::left_perm(), right,
+              ContractReduceBase_::right_perm(), 1,
+              ContractReduceBase_::gemm_helper());
+        else if(ContractReduceBase_::left_perm() || ContractReduceBase_::right_perm())
+          permute_gemm(result, left, ContractReduceBase_::left_perm(), right,
+              ContractReduceBase_::right_perm(), 1,
+              ContractReduceBase_::gemm_helper());
+        else if(empty(result))
           result = gemm(left, right, 1, ContractReduceBase_::gemm_helper());
         else
           gemm(result, left, right, 1, ContractReduceBase_::gemm_helper());
@@ -29,6 +29,7 @@
 #include <TiledArray/error.h>
 #include <TiledArray/tile_op/tile_interface.h>
 #include <TiledArray/zero_tensor.h>
+#include "../tile_interface/permute.h"
 
 namespace TiledArray {
   namespace detail {
@@ -67,7 +68,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       static result_type eval(const left_type& first, const right_type& second,
           const Permutation& perm)
@@ -158,6 +160,16 @@ namespace TiledArray {
       template <typename L, typename R>
       result_type
       operator()(L&& left, R&& right, const Permutation& perm) const {
+        if((left_is_consumable && is_layout_preserving(perm, left)) ||
+            (right_is_consumable && is_layout_preserving(perm, right)))
+        {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result = Mult_::template eval<left_is_consumable,
+              right_is_consumable>(std::forward<L>(left), std::forward<R>(right));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(std::forward<L>(left), std::forward<R>(right), perm);
       }
 
@@ -211,6 +223,46 @@ namespace TiledArray {
             std::forward<L>(left), right);
       }
 
+      /// Evaluate with a permuted left-hand argument
+
+      /// Compute the product of `perm * left` and `right` in a single pass,
+      /// without storing the permuted left-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param perm The permutation applied to `left`
+      /// \param right The right-hand tile argument
+      /// \param consume If `true`, the result is stored in `right`
+      /// \return The product of the permuted `left` and `right`
+      result_type permute_left(const left_type& left, const Permutation& perm,
+          right_type& right, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        if(consume)
+          return right.inplace_binary(left, perm,
+              [] (numeric_type& r, const numeric_type l) { r = l * r; });
+        return left.binary(perm, right,
+            [] (const numeric_type l, const numeric_type r) { return l * r; });
+      }
+
+      /// Evaluate with a permuted right-hand argument
+
+      /// Compute the product of `left` and `perm * right` in a single pass,
+      /// without storing the permuted right-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \param perm The permutation applied to `right`
+      /// \param consume If `true`, the result is stored in `left`
+      /// \return The product of `left` and the permuted `right`
+      result_type permute_right(left_type& left, const right_type& right,
+          const Permutation& perm, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        if(consume)
+          return left.inplace_binary(right, perm,
+              [] (numeric_type& l, const numeric_type r) { l = l * r; });
+        return right.binary(perm, left,
+            [] (const numeric_type r, const numeric_type l) { return l * r; });
+      }
+
     }; // class Mult
 
     /// Tile scale-multiplication operation
@@ -253,7 +305,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       result_type eval(const left_type& first, const right_type& second,
           const Permutation& perm) const
@@ -355,6 +408,16 @@ namespace TiledArray {
       template <typename L, typename R>
       result_type
       operator()(L&& left, R&& right, const Permutation& perm) const {
+        if((left_is_consumable && is_layout_preserving(perm, left)) ||
+            (right_is_consumable && is_layout_preserving(perm, right)))
+        {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result = ScalMult_::template eval<left_is_consumable,
+              right_is_consumable>(std::forward<L>(left), std::forward<R>(right));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(std::forward<L>(left), std::forward<R>(right), perm);
       }
 
@@ -409,6 +472,52 @@ namespace TiledArray {
             std::forward<L>(left), right);
       }
 
+      /// Evaluate with a permuted left-hand argument
+
+      /// Compute the scaled product of `perm * left` and `right` in a single
+      /// pass, without storing the permuted left-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param perm The permutation applied to `left`
+      /// \param right The right-hand tile argument
+      /// \param consume If `true`, the result is stored in `right`
+      /// \return The scaled product of the permuted `left` and `right`
+      result_type permute_left(const left_type& left, const Permutation& perm,
+          right_type& right, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        const scalar_type factor = factor_;
+        if(consume)
+          return right.inplace_binary(left, perm,
+              [factor] (numeric_type& r, const numeric_type l)
+                  { r = (l * r) * factor; });
+        return left.binary(perm, right,
+            [factor] (const numeric_type l, const numeric_type r)
+                { return (l * r) * factor; });
+      }
+
+      /// Evaluate with a permuted right-hand argument
+
+      /// Compute the scaled product of `left` and `perm * right` in a single
+      /// pass, without storing the permuted right-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \param perm The permutation applied to `right`
+      /// \param consume If `true`, the result is stored in `left`
+      /// \return The scaled product of `left` and the permuted `right`
+      result_type permute_right(left_type& left, const right_type& right,
+          const Permutation& perm, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        const scalar_type factor = factor_;
+        if(consume)
+          return left.inplace_binary(right, perm,
+              [factor] (numeric_type& l, const numeric_type r)
+                  { l = (l * r) * factor; });
+        return right.binary(perm, left,
+            [factor] (const numeric_type r, const numeric_type l)
+                { return (l * r) * factor; });
+      }
+
     }; // class ScalMult
 
   } // namespace detail
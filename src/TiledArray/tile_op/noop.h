@@ -53,7 +53,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       result_type eval(const Arg& arg, const Permutation& perm) const {
         TiledArray::Permute<Result, Arg> permute;
@@ -81,8 +82,16 @@ namespace TiledArray {
       /// \param arg The tile argument
       /// \param perm The permutation applied to the result tile
       /// \return A permuted copy of `arg`
-      result_type
-      operator()(const argument_type& arg, const Permutation& perm) const {
+      template <typename A>
+      result_type operator()(A&& arg, const Permutation& perm) const {
+        if(is_consumable && is_layout_preserving(perm, arg)) {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result =
+              Noop_::template eval<is_consumable>(arg);
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(arg, perm);
       }
 
@@ -29,6 +29,7 @@
 #include <type_traits>
 #include "../tile_interface/scale.h"
 #include <TiledArray/tile_op/tile_interface.h>
+#include "../tile_interface/permute.h"
 
 namespace TiledArray {
   namespace detail {
@@ -59,7 +60,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       result_type eval(const Arg& arg, const Permutation& perm) const {
         using TiledArray::scale;
@@ -99,11 +101,20 @@ namespace TiledArray {
 
       /// Scale and permute operator
 
+      /// \tparam A The tile argument type
       /// \param arg The tile argument
       /// \param perm The permutation applied to the result tile
       /// \return A permuted and scaled copy of `arg`
-      result_type
-      operator()(const argument_type& arg, const Permutation& perm) const {
+      template <typename A>
+      result_type operator()(A&& arg, const Permutation& perm) const {
+        if(is_consumable && is_layout_preserving(perm, arg)) {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result =
+              Scal_::template eval<is_consumable>(std::forward<A>(arg));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(arg, perm);
       }
 
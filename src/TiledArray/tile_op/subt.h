@@ -69,7 +69,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       static result_type eval(const left_type& first, const right_type& second,
           const Permutation& perm)
@@ -159,6 +160,16 @@ namespace TiledArray {
       /// \return The permuted and scaled difference of `left` and `right`.
       template <typename L, typename R>
       result_type operator()(L&& left, R&& right, const Permutation& perm) const {
+        if((left_is_consumable && is_layout_preserving(perm, left)) ||
+            (right_is_consumable && is_layout_preserving(perm, right)))
+        {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result = Subt_::template eval<left_is_consumable,
+              right_is_consumable>(std::forward<L>(left), std::forward<R>(right));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(std::forward<L>(left), std::forward<R>(right), perm);
       }
 
@@ -218,6 +229,46 @@ namespace TiledArray {
             std::forward<L>(left), right);
       }
 
+      /// Evaluate with a permuted left-hand argument
+
+      /// Compute the difference of `perm * left` and `right` in a single pass,
+      /// without storing the permuted left-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param perm The permutation applied to `left`
+      /// \param right The right-hand tile argument
+      /// \param consume If `true`, the result is stored in `right`
+      /// \return The difference of the permuted `left` and `right`
+      result_type permute_left(const left_type& left, const Permutation& perm,
+          right_type& right, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        if(consume)
+          return right.inplace_binary(left, perm,
+              [] (numeric_type& r, const numeric_type l) { r = l - r; });
+        return left.binary(perm, right,
+            [] (const numeric_type l, const numeric_type r) { return l - r; });
+      }
+
+      /// Evaluate with a permuted right-hand argument
+
+      /// Compute the difference of `left` and `perm * right` in a single pass,
+      /// without storing the permuted right-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \param perm The permutation applied to `right`
+      /// \param consume If `true`, the result is stored in `left`
+      /// \return The difference of `left` and the permuted `right`
+      result_type permute_right(left_type& left, const right_type& right,
+          const Permutation& perm, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        if(consume)
+          return left.inplace_binary(right, perm,
+              [] (numeric_type& l, const numeric_type r) { l = l - r; });
+        return right.binary(perm, left,
+            [] (const numeric_type r, const numeric_type l) { return l - r; });
+      }
+
     }; // class Subt
 
     /// Tile scale-subtraction operation
@@ -258,7 +309,8 @@ namespace TiledArray {
 
       // Permuting tile evaluation function
       // These operations cannot consume the argument tile since this operation
-      // requires temporary storage space.
+      // requires temporary storage space, unless the permutation moves only
+      // unit dimensions (see operator()).
 
       result_type eval(const left_type& first, const right_type& second,
           const Permutation& perm) const
@@ -362,6 +414,16 @@ namespace TiledArray {
       template <typename L, typename R>
       result_type
       operator()(L&& left, R&& right, const Permutation& perm) const {
+        if((left_is_consumable && is_layout_preserving(perm, left)) ||
+            (right_is_consumable && is_layout_preserving(perm, right)))
+        {
+          // The permutation moves only unit dimensions, so the result of the
+          // consuming operation is permuted in place
+          result_type result = ScalSubt_::template eval<left_is_consumable,
+              right_is_consumable>(std::forward<L>(left), std::forward<R>(right));
+          using TiledArray::permute_to;
+          return permute_to(result, perm);
+        }
         return eval(std::forward<L>(left), std::forward<R>(right), perm);
       }
 
@@ -421,6 +483,52 @@ namespace TiledArray {
             std::forward<L>(left), right);
       }
 
+      /// Evaluate with a permuted left-hand argument
+
+      /// Compute the scaled difference of `perm * left` and `right` in a single
+      /// pass, without storing the permuted left-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param perm The permutation applied to `left`
+      /// \param right The right-hand tile argument
+      /// \param consume If `true`, the result is stored in `right`
+      /// \return The scaled difference of the permuted `left` and `right`
+      result_type permute_left(const left_type& left, const Permutation& perm,
+          right_type& right, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        const scalar_type factor = factor_;
+        if(consume)
+          return right.inplace_binary(left, perm,
+              [factor] (numeric_type& r, const numeric_type l)
+                  { r = (l - r) * factor; });
+        return left.binary(perm, right,
+            [factor] (const numeric_type l, const numeric_type r)
+                { return (l - r) * factor; });
+      }
+
+      /// Evaluate with a permuted right-hand argument
+
+      /// Compute the scaled difference of `left` and `perm * right` in a single
+      /// pass, without storing the permuted right-hand tile.
+      /// \param left The left-hand tile argument
+      /// \param right The right-hand tile argument
+      /// \param perm The permutation applied to `right`
+      /// \param consume If `true`, the result is stored in `left`
+      /// \return The scaled difference of `left` and the permuted `right`
+      result_type permute_right(left_type& left, const right_type& right,
+          const Permutation& perm, const bool consume) const
+      {
+        typedef typename result_type::numeric_type numeric_type;
+        const scalar_type factor = factor_;
+        if(consume)
+          return left.inplace_binary(right, perm,
+              [factor] (numeric_type& l, const numeric_type r)
+                  { l = (l - r) * factor; });
+        return right.binary(perm, left,
+            [factor] (const numeric_type r, const numeric_type l)
+                { return (l - r) * factor; });
+      }
+
     }; // class ScalSubt
 
   } // namespace detail
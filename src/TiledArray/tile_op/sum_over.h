@@ -0,0 +1,214 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sum_over.h
+ *  May 10, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_OP_SUM_OVER_H__INCLUDED
+#define TILEDARRAY_TILE_OP_SUM_OVER_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/math/partial_reduce.h>
+#include <TiledArray/math/vector_op.h>
+#include <TiledArray/permutation.h>
+#include <algorithm>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Tile partial sum operation
+
+    /// This operation sums the elements of a tile over some of its
+    /// dimensions, e.g. \f$ r_i = \sum_j a_{ij} \f$ . The other dimensions
+    /// of the tile are kept in order. When the summed dimensions are the
+    /// trailing or the leading dimensions of the tile, the sum is computed
+    /// with \c math::row_reduce or \c math::col_reduce , respectively;
+    /// otherwise the contiguous blocks of the tile that follow the last
+    /// summed dimension are added to the result. The permutation of the
+    /// operation is applied to the sum of the tiles of a result tile, by its
+    /// owner, so it is not applied by the call operators.
+    /// \tparam Result The result tile type
+    /// \tparam Arg The argument tile type
+    template <typename Result, typename Arg>
+    class SumOver {
+    public:
+      typedef SumOver<Result, Arg> SumOver_; ///< This object type
+      typedef Arg argument_type; ///< The argument type
+      typedef Result result_type; ///< The result tile type
+      typedef typename result_type::value_type value_type; ///< The result element type
+      typedef typename result_type::range_type range_type; ///< The result range type
+      typedef typename range_type::size_type size_type; ///< Size type
+
+    private:
+
+      std::vector<unsigned int> dims_; ///< The summed dimensions, in increasing order
+      Permutation perm_; ///< The permutation of the result tiles
+
+      /// Check that a dimension is summed
+
+      /// \param d The dimension of the argument
+      /// \return \c true if \c d is summed
+      bool is_summed(const unsigned int d) const {
+        return std::binary_search(dims_.begin(), dims_.end(), d);
+      }
+
+      /// Construct the range of a result tile
+
+      /// \param arg_range The range of the argument tile
+      /// \return The range of the dimensions of \c arg_range that are not
+      /// summed
+      range_type make_range(const range_type& arg_range) const {
+        const unsigned int rank = arg_range.rank();
+        std::vector<size_type> lobound, upbound;
+        lobound.reserve(rank - dims_.size());
+        upbound.reserve(rank - dims_.size());
+        for(unsigned int d = 0u; d < rank; ++d) {
+          if(! is_summed(d)) {
+            lobound.push_back(arg_range.lobound(d));
+            upbound.push_back(arg_range.upbound(d));
+          }
+        }
+        return range_type(lobound, upbound);
+      }
+
+      /// Add the partial sum of a tile to a result tile
+
+      /// \param result The result tile
+      /// \param arg The argument tile
+      void sum_to(result_type& result, const argument_type& arg) const {
+        const unsigned int rank = arg.range().rank();
+        const unsigned int summed_rank = dims_.size();
+        const size_type* MADNESS_RESTRICT const extent = arg.range().extent_data();
+        const size_type volume = arg.range().volume();
+        const size_type result_volume = result.range().volume();
+        TA_ASSERT(result_volume * (volume / result_volume) == volume);
+
+        auto add_op = [] (value_type& r,
+            const typename argument_type::value_type a) { r += a; };
+
+        if(dims_.front() == (rank - summed_rank)) {
+          // The summed dimensions are the trailing dimensions
+          math::row_reduce(result_volume, volume / result_volume, arg.data(),
+              result.data(), add_op);
+        } else if(dims_.back() == (summed_rank - 1u)) {
+          // The summed dimensions are the leading dimensions
+          math::col_reduce(volume / result_volume, result_volume, arg.data(),
+              result.data(), add_op);
+        } else {
+          // The dimensions that follow the last summed dimension are kept, so
+          // they are contiguous blocks in the argument and result tiles.
+          const unsigned int outer_rank = dims_.back() + 1u;
+          size_type inner = 1ul;
+          for(unsigned int d = outer_rank; d < rank; ++d)
+            inner *= extent[d];
+
+          // Compute the result weights of the outer dimensions
+          std::vector<size_type> weight(outer_rank, 0ul);
+          size_type w = inner;
+          for(unsigned int d = outer_rank; d > 0u; ) {
+            --d;
+            if(! is_summed(d)) {
+              weight[d] = w;
+              w *= extent[d];
+            }
+          }
+
+          std::vector<size_type> index(outer_rank, 0ul);
+          size_type offset = 0ul;
+          const size_type outer = volume / inner;
+          for(size_type i = 0ul; i < outer; ++i) {
+            math::inplace_vector_op(add_op, inner, result.data() + offset,
+                arg.data() + (i * inner));
+
+            // Increment the outer index and the result offset
+            for(unsigned int d = outer_rank; d > 0u; ) {
+              --d;
+              offset += weight[d];
+              if(++index[d] < extent[d])
+                break;
+              offset -= weight[d] * index[d];
+              index[d] = 0ul;
+            }
+          }
+        }
+      }
+
+    public:
+
+      // Compiler generated functions
+      SumOver() = default;
+      SumOver(const SumOver_&) = default;
+      SumOver(SumOver_&&) = default;
+      ~SumOver() = default;
+      SumOver_& operator=(const SumOver_&) = default;
+      SumOver_& operator=(SumOver_&&) = default;
+
+      /// Constructor
+
+      /// \param dims The summed dimensions of the argument tiles, in
+      /// increasing order
+      /// \param perm The permutation of the result tiles
+      explicit SumOver(const std::vector<unsigned int>& dims,
+          const Permutation& perm = Permutation()) :
+        dims_(dims), perm_(perm)
+      {
+        TA_ASSERT(! dims_.empty());
+        TA_ASSERT(std::is_sorted(dims_.begin(), dims_.end()));
+      }
+
+      /// Summed dimensions accessor
+
+      /// \return The summed dimensions of the argument tiles
+      const std::vector<unsigned int>& dims() const { return dims_; }
+
+      /// Permutation accessor
+
+      /// \return The permutation of the result tiles
+      const Permutation& perm() const { return perm_; }
+
+      /// Sum a tile
+
+      /// \param arg The argument tile
+      /// \return The sum of \c arg over the summed dimensions
+      result_type operator()(const argument_type& arg) const {
+        TA_ASSERT(dims_.back() < arg.range().rank());
+        TA_ASSERT(dims_.size() < arg.range().rank());
+        result_type result(make_range(arg.range()), value_type(0));
+        sum_to(result, arg);
+        return result;
+      }
+
+      /// Accumulate the sum of a tile
+
+      /// \param[in,out] result The result tile, which may be empty
+      /// \param arg The argument tile
+      void operator()(result_type& result, const argument_type& arg) const {
+        if(result.empty())
+          result = operator()(arg);
+        else
+          sum_to(result, arg);
+      }
+
+    }; // class SumOver
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_OP_SUM_OVER_H__INCLUDED
@@ -0,0 +1,189 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tuple_reduction.h
+ *  May 9, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_OP_TUPLE_REDUCTION_H__INCLUDED
+#define TILEDARRAY_TILE_OP_TUPLE_REDUCTION_H__INCLUDED
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The result of a tuple reduction
+
+    /// This is a \c std::tuple that can be serialized, so the results of
+    /// all reductions are combined by one collective operation.
+    /// \tparam Ts The result types of the reductions
+    template <typename... Ts>
+    class ReductionTuple : public std::tuple<Ts...> {
+    public:
+      typedef std::tuple<Ts...> tuple_type; ///< The tuple base class type
+
+      ReductionTuple() = default;
+
+      /// Construct from the results of the reductions
+
+      /// \param results The results of the reductions
+      explicit ReductionTuple(const Ts&... results) : tuple_type(results...) { }
+
+      /// Serialize the results
+
+      /// \tparam Archive The archive type
+      /// \param ar The archive
+      template <typename Archive>
+      void serialize(Archive& ar) {
+        serialize(ar, std::index_sequence_for<Ts...>());
+      }
+
+    private:
+
+      template <typename Archive, std::size_t... Is>
+      void serialize(Archive& ar, std::index_sequence<Is...>) {
+        const int expand[] = { 0, ((ar & std::get<Is>(*this)), 0)... };
+        (void)expand;
+      }
+
+    }; // class ReductionTuple
+
+    /// Check that reduction operations have the same argument type
+
+    /// \tparam Arg The argument type
+    /// \tparam Ops The reduction operation types
+    template <typename Arg, typename... Ops>
+    struct all_same_argument : public std::true_type { };
+
+    template <typename Arg, typename Op, typename... Ops>
+    struct all_same_argument<Arg, Op, Ops...> :
+        public std::integral_constant<bool,
+            std::is_same<Arg, typename Op::argument_type>::value &&
+            all_same_argument<Arg, Ops...>::value>
+    { };
+
+  } // namespace detail
+
+  /// Tuple of tile reductions
+
+  /// This reduction operation computes several reductions of the same
+  /// tiles in one pass, e.g. the sum, minimum, and maximum of an expression
+  /// are computed from one evaluation of the expression, and their results
+  /// are combined with a single collective operation. Lazy tiles are
+  /// evaluated once for all reductions.
+  /// \tparam Ops The reduction operation types, which have the same
+  /// argument type
+  template <typename Op, typename... Ops>
+  class TupleReduction {
+  public:
+    // typedefs
+    typedef detail::ReductionTuple<typename Op::result_type,
+        typename Ops::result_type...> result_type;
+    typedef typename Op::argument_type argument_type;
+
+  private:
+
+    std::tuple<Op, Ops...> ops_; ///< The reduction operations
+
+    typedef std::index_sequence_for<Op, Ops...> indices;
+
+    template <std::size_t... Is>
+    result_type init(std::index_sequence<Is...>) const {
+      return result_type(std::get<Is>(ops_)()...);
+    }
+
+    template <std::size_t... Is>
+    result_type post(const result_type& result, std::index_sequence<Is...>) const {
+      return result_type(std::get<Is>(ops_)(std::get<Is>(result))...);
+    }
+
+    template <typename Arg, std::size_t... Is>
+    void reduce(result_type& result, const Arg& arg, std::index_sequence<Is...>) const {
+      const int expand[] = { 0,
+          (std::get<Is>(ops_)(std::get<Is>(result), select(arg,
+          std::integral_constant<std::size_t, Is>())), 0)... };
+      (void)expand;
+    }
+
+    /// Select the argument of a reduction
+
+    /// \return The argument tile, which is shared by all reductions
+    template <std::size_t I>
+    static const argument_type&
+    select(const argument_type& arg, std::integral_constant<std::size_t, I>)
+    { return arg; }
+
+    /// Select the argument of a reduction
+
+    /// \return The result of reduction \c I of \c arg
+    template <std::size_t I>
+    static const typename std::tuple_element<I, typename result_type::tuple_type>::type&
+    select(const result_type& arg, std::integral_constant<std::size_t, I>)
+    { return std::get<I>(arg); }
+
+  public:
+
+    TupleReduction() = default;
+
+    /// Construct a tuple of reductions
+
+    /// \param op The first reduction operation
+    /// \param ops The other reduction operations
+    TupleReduction(const Op& op, const Ops&... ops) : ops_(op, ops...) {
+      static_assert(detail::all_same_argument<argument_type, Ops...>::value,
+          "The reductions of a tuple reduction must have the same argument type.");
+    }
+
+    // Reduction functions
+
+    // Make an empty result object
+    result_type operator()() const { return init(indices()); }
+
+    // Post process the result
+    result_type operator()(const result_type& result) const {
+      return post(result, indices());
+    }
+
+    // Reduce two result objects
+    void operator()(result_type& result, const result_type& arg) const {
+      reduce(result, arg, indices());
+    }
+
+    // Reduce an argument
+    void operator()(result_type& result, const argument_type& arg) const {
+      reduce(result, arg, indices());
+    }
+
+  }; // class TupleReduction
+
+  /// Tuple reduction factory function
+
+  /// \tparam Ops The reduction operation types
+  /// \param ops The reduction operations, which have the same argument type
+  /// \return A reduction that computes all of \c ops in one pass
+  template <typename... Ops>
+  inline TupleReduction<Ops...> make_tuple_reduction(const Ops&... ops) {
+    return TupleReduction<Ops...>(ops...);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_OP_TUPLE_REDUCTION_H__INCLUDED
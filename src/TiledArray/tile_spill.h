@@ -0,0 +1,265 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_spill.h
+ *  Feb 13, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_SPILL_H__INCLUDED
+#define TILEDARRAY_TILE_SPILL_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <madness/world/binary_fstream_archive.h>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The default spill directory
+
+    /// The directory is read from the \c TA_SPILL_DIR environment variable.
+    /// When it is not set, tiles are not spilled by default.
+    /// \return The default spill directory, or an empty string
+    inline const std::string& spill_directory() {
+      static const std::string directory = [] () -> std::string {
+        const char* directory = getenv("TA_SPILL_DIR");
+        return (directory ? directory : "");
+      }();
+      return directory;
+    }
+
+    /// The default working-set limit of a spilled container
+
+    /// The limit is read from the \c TA_SPILL_MAX_BYTES environment variable;
+    /// the default limit is 1 GB.
+    /// \return The default working-set limit in bytes
+    inline std::size_t spill_max_bytes() {
+      static const std::size_t max_bytes = [] () -> std::size_t {
+        const char* max_bytes = getenv("TA_SPILL_MAX_BYTES");
+        if(max_bytes)
+          return std::strtoul(max_bytes, nullptr, 10);
+        return 1073741824ul;
+      }();
+      return max_bytes;
+    }
+
+    /// Working set of the local tiles of a container
+
+    /// This object tracks the local tiles that are held in memory, in least
+    /// recently used order, and the tiles that have been written to disk.
+    /// The files of tiles that are still on disk are removed when this object
+    /// is destroyed.
+    class TileSpill {
+      typedef std::size_t key_type; ///< Tile key type
+
+      /// A tile that is held in memory
+      struct Resident {
+        std::list<key_type>::iterator it; ///< The position in the LRU list
+        std::size_t bytes; ///< The size of the tile
+      };
+
+      const std::string prefix_; ///< The path prefix of spilled tiles
+      const std::size_t max_bytes_; ///< The working-set limit
+      std::mutex lock_; ///< Protects the working set
+      std::list<key_type> lru_; ///< The resident tiles, most recently used first
+      std::unordered_map<key_type, Resident> resident_; ///< The resident tiles
+      std::size_t resident_bytes_; ///< The total size of the resident tiles
+      std::unordered_map<key_type, Future<bool> > spilled_;
+          ///< The spilled tiles and the completion of their writes
+
+    public:
+
+      /// Constructor
+
+      /// \param prefix The path prefix of the spilled tile files
+      /// \param max_bytes The largest total size of the resident tiles
+      TileSpill(const std::string& prefix, const std::size_t max_bytes) :
+        prefix_(prefix), max_bytes_(max_bytes), lock_(), lru_(), resident_(),
+        resident_bytes_(0ul), spilled_()
+      { }
+
+      TileSpill(const TileSpill&) = delete;
+      TileSpill& operator=(const TileSpill&) = delete;
+
+      ~TileSpill() {
+        for(const auto& spilled : spilled_)
+          std::remove(path(spilled.first).c_str());
+      }
+
+      /// Spill file path
+
+      /// \param i The tile key
+      /// \return The path of the file that holds tile \c i
+      std::string path(const key_type i) const {
+        return prefix_ + std::to_string(i);
+      }
+
+      /// Working-set limit accessor
+
+      /// \return The largest total size of the resident tiles
+      std::size_t max_bytes() const { return max_bytes_; }
+
+      /// Add a tile to the working set
+
+      /// \param i The tile key
+      /// \param bytes The size of the tile
+      void insert(const key_type i, const std::size_t bytes) {
+        std::lock_guard<std::mutex> locker(lock_);
+        if(resident_.count(i))
+          return;
+        lru_.push_front(i);
+        resident_[i] = Resident{ lru_.begin(), bytes };
+        resident_bytes_ += bytes;
+      }
+
+      /// Mark a resident tile as the most recently used
+
+      /// \param i The tile key
+      void touch(const key_type i) {
+        std::lock_guard<std::mutex> locker(lock_);
+        auto it = resident_.find(i);
+        if(it != resident_.end())
+          lru_.splice(lru_.begin(), lru_, it->second.it);
+      }
+
+      /// Remove the least recently used tile when the working set is too large
+
+      /// \param[out] i The key of the removed tile
+      /// \param[out] bytes The size of the removed tile
+      /// \return \c true if a tile was removed from the working set
+      bool victim(key_type& i, std::size_t& bytes) {
+        std::lock_guard<std::mutex> locker(lock_);
+        if((resident_bytes_ <= max_bytes_) || lru_.empty())
+          return false;
+
+        i = lru_.back();
+        lru_.pop_back();
+        auto it = resident_.find(i);
+        bytes = it->second.bytes;
+        resident_bytes_ -= bytes;
+        resident_.erase(it);
+        return true;
+      }
+
+      /// Record a tile that is written to disk
+
+      /// \param i The tile key
+      /// \param written A future that is set when the file is complete
+      void spilled(const key_type i, const Future<bool>& written) {
+        std::lock_guard<std::mutex> locker(lock_);
+        spilled_[i] = written;
+      }
+
+      /// Remove a tile from the spilled tiles
+
+      /// \param i The tile key
+      /// \param[out] written A future that is set when the file is complete
+      /// \return \c true if tile \c i was spilled
+      bool restore(const key_type i, Future<bool>& written) {
+        std::lock_guard<std::mutex> locker(lock_);
+        auto it = spilled_.find(i);
+        if(it == spilled_.end())
+          return false;
+        written = it->second;
+        spilled_.erase(it);
+        return true;
+      }
+
+      /// Remove a tile from the working set and the spilled tiles
+
+      /// The spill file of the tile is removed once it has been written; a
+      /// file that is still being written is removed with the others when
+      /// this object is destroyed.
+      /// \param i The tile key
+      /// \return The size of the tile, if it was resident, otherwise zero
+      std::size_t erase(const key_type i) {
+        std::lock_guard<std::mutex> locker(lock_);
+        std::size_t bytes = 0ul;
+        auto it = resident_.find(i);
+        if(it != resident_.end()) {
+          bytes = it->second.bytes;
+          resident_bytes_ -= bytes;
+          lru_.erase(it->second.it);
+          resident_.erase(it);
+        }
+
+        auto spilled_it = spilled_.find(i);
+        if((spilled_it != spilled_.end()) && spilled_it->second.probe()) {
+          std::remove(path(i).c_str());
+          spilled_.erase(spilled_it);
+        }
+
+        return bytes;
+      }
+
+      /// Number of spilled tiles
+
+      /// \return The number of tiles that are held on disk
+      std::size_t spilled_size() {
+        std::lock_guard<std::mutex> locker(lock_);
+        return spilled_.size();
+      }
+
+    }; // class TileSpill
+
+    /// Write a tile to its spill file
+
+    /// \tparam T The tile type
+    /// \param spill The working set that owns the tile
+    /// \param i The tile key
+    /// \param tile The tile
+    /// \return \c true
+    template <typename T>
+    bool spill_tile(const std::shared_ptr<TileSpill>& spill, const std::size_t i,
+        const T& tile)
+    {
+      madness::archive::BinaryFstreamOutputArchive ar(spill->path(i).c_str());
+      ar & tile;
+      ar.close();
+      return true;
+    }
+
+    /// Read a tile from its spill file and remove the file
+
+    /// \tparam T The tile type
+    /// \param spill The working set that owns the tile
+    /// \param i The tile key
+    /// \return The tile
+    template <typename T>
+    T unspill_tile(const std::shared_ptr<TileSpill>& spill, const std::size_t i,
+        const bool)
+    {
+      const std::string path = spill->path(i);
+      T tile;
+      {
+        madness::archive::BinaryFstreamInputArchive ar(path.c_str());
+        ar & tile;
+      }
+      std::remove(path.c_str());
+      return tile;
+    }
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_SPILL_H__INCLUDED
@@ -0,0 +1,83 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tiled_range.cpp
+ *  Mar 30, 2017
+ *
+ */
+
+#include <TiledArray/tiled_range.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace TiledArray {
+  namespace detail {
+
+    std::shared_ptr<const TiledRangeData>
+    intern_tiled_range(std::vector<TiledRange1> ranges) {
+      typedef std::unordered_multimap<std::size_t,
+          std::weak_ptr<const TiledRangeData> > registry_type;
+      static std::mutex lock;
+      static registry_type registry;
+      static std::size_t sweep_size = 64ul;
+
+      // Hash the tile boundaries
+      std::size_t hash = ranges.size();
+      std::hash<std::size_t> hasher;
+      for(const TiledRange1& r : ranges) {
+        hash ^= hasher(r.tiles_range().first) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        for(const auto& tile : r)
+          hash ^= hasher(tile.second) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      }
+
+      std::lock_guard<std::mutex> locker(lock);
+
+      // Look for an interned range with the same boundaries
+      auto bucket = registry.equal_range(hash);
+      for(auto it = bucket.first; it != bucket.second;) {
+        std::shared_ptr<const TiledRangeData> data = it->second.lock();
+        if(! data) {
+          it = registry.erase(it);
+          continue;
+        }
+        if((data->ranges.size() == ranges.size()) &&
+            std::equal(ranges.begin(), ranges.end(), data->ranges.begin()))
+          return data;
+        ++it;
+      }
+
+      // Remove the expired entries when the registry has grown
+      if(registry.size() >= sweep_size) {
+        for(auto it = registry.begin(); it != registry.end();) {
+          if(it->second.expired())
+            it = registry.erase(it);
+          else
+            ++it;
+        }
+        sweep_size = std::max(64ul, registry.size() * 2ul);
+      }
+
+      std::shared_ptr<const TiledRangeData> data =
+          std::make_shared<const TiledRangeData>(std::move(ranges));
+      registry.emplace(hash, data);
+      return data;
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
@@ -22,42 +22,151 @@
 
 #include <TiledArray/tiled_range1.h>
 #include <TiledArray/range.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 namespace TiledArray {
+  namespace detail {
+
+    /// Cache of the tile ranges of a tiled range
+
+    /// The tile ranges are constructed on first use, and they are shared by
+    /// all tiled ranges with the same data, see \c TiledRangeData , e.g. the
+    /// tiled ranges of arrays and of distributed evaluators.
+    class TileRangeCache {
+      std::unique_ptr<std::atomic<const Range*>[]> ranges_; ///< The cached tile ranges
+      std::size_t size_; ///< The number of tiles
+
+    public:
+
+      /// The largest number of tiles of a cached tiled range
+
+      /// The limit is read from the \c TA_TILE_RANGE_CACHE_SIZE environment
+      /// variable; zero disables the cache.
+      /// \return The largest number of tiles [default = 2^20]
+      static std::size_t max_size() {
+        static const std::size_t max_size = [] () -> std::size_t {
+          const char* max_size = getenv("TA_TILE_RANGE_CACHE_SIZE");
+          if(max_size)
+            return std::strtoul(max_size, nullptr, 10);
+          return 1ul << 20;
+        }();
+        return max_size;
+      }
 
-  /// Range data of a tiled array
+      /// Constructor
 
-  /// TiledRange is a direct (Cartesian) product of 1-dimensional tiled ranges (TiledRange1)
-  class TiledRange {
-  private:
+      /// \param size The number of tiles
+      explicit TileRangeCache(const std::size_t size) :
+        ranges_(new std::atomic<const Range*>[size]()), size_(size)
+      { }
 
-    /// Constructed with a set of ranges pointed to by [ first, last ).
-    void init() {
-      const std::size_t rank = this->rank();
-
-      // Indices used to store range start and finish.
-      std::vector<size_type> start;
-      std::vector<size_type> finish;
-      std::vector<size_type> start_element;
-      std::vector<size_type> finish_element;
-
-      start.reserve(rank);
-      finish.reserve(rank);
-      start_element.reserve(rank);
-      finish_element.reserve(rank);
-
-      // Find the start and finish of the over all tiles and element ranges.
-      for(unsigned int i = 0; i < rank; ++i) {
-        start.push_back(ranges_[i].tiles_range().first);
-        finish.push_back(ranges_[i].tiles_range().second);
-
-        start_element.push_back(ranges_[i].elements_range().first);
-        finish_element.push_back(ranges_[i].elements_range().second);
+      TileRangeCache(const TileRangeCache&) = delete;
+      TileRangeCache& operator=(const TileRangeCache&) = delete;
+
+      ~TileRangeCache() {
+        for(std::size_t i = 0ul; i < size_; ++i)
+          delete ranges_[i].load();
+      }
+
+      /// Tile range accessor
+
+      /// \tparam Op The tile range construction function type
+      /// \param i The ordinal index of the tile
+      /// \param op The function that constructs the range of tile \c i
+      /// \return A const reference to the range of tile \c i
+      template <typename Op>
+      const Range& get(const std::size_t i, const Op& op) {
+        TA_ASSERT(i < size_);
+        const Range* range = ranges_[i].load(std::memory_order_acquire);
+        if(! range) {
+          const Range* result = new Range(op());
+          if(ranges_[i].compare_exchange_strong(range, result,
+              std::memory_order_acq_rel, std::memory_order_acquire))
+            range = result;
+          else
+            delete result;
+        }
+        return *range;
       }
-      range_type(start, finish).swap(range_);
-      tiles_range_type(start_element, finish_element).swap(elements_range_);
+
+    }; // class TileRangeCache
+
+    /// The immutable data of a tiled range
+    struct TiledRangeData {
+      Range tiles_range; ///< Stores information on tile indexing for the range.
+      Range elements_range; ///< Stores information on element indexing for the range.
+      std::vector<TiledRange1> ranges; ///< Stores tile boundaries for each dimension.
+      std::unique_ptr<TileRangeCache> cache; ///< The tile range cache
+
+      /// Constructor
+
+      /// \param r The tiled range of each dimension
+      explicit TiledRangeData(std::vector<TiledRange1> r) :
+        tiles_range(), elements_range(), ranges(std::move(r)), cache()
+      {
+        const std::size_t rank = ranges.size();
+
+        // Indices used to store range start and finish.
+        std::vector<std::size_t> start;
+        std::vector<std::size_t> finish;
+        std::vector<std::size_t> start_element;
+        std::vector<std::size_t> finish_element;
+
+        start.reserve(rank);
+        finish.reserve(rank);
+        start_element.reserve(rank);
+        finish_element.reserve(rank);
+
+        // Find the start and finish of the over all tiles and element ranges.
+        for(unsigned int i = 0; i < rank; ++i) {
+          start.push_back(ranges[i].tiles_range().first);
+          finish.push_back(ranges[i].tiles_range().second);
+
+          start_element.push_back(ranges[i].elements_range().first);
+          finish_element.push_back(ranges[i].elements_range().second);
+        }
+        Range(start, finish).swap(tiles_range);
+        Range(start_element, finish_element).swap(elements_range);
+
+        const std::size_t volume = tiles_range.volume();
+        if(rank && volume && (volume <= TileRangeCache::max_size()))
+          cache.reset(new TileRangeCache(volume));
+      }
+
+      TiledRangeData(const TiledRangeData&) = delete;
+      TiledRangeData& operator=(const TiledRangeData&) = delete;
+
+    }; // struct TiledRangeData
+
+    /// Intern the data of a tiled range
+
+    /// Tiled ranges that are constructed with the same boundaries share
+    /// one immutable \c TiledRangeData object, and its cached tile ranges,
+    /// while any of them is alive.
+    /// \param ranges The tiled range of each dimension
+    /// \return The data of the tiled range given by \c ranges
+    std::shared_ptr<const TiledRangeData>
+    intern_tiled_range(std::vector<TiledRange1> ranges);
+
+    /// \return The data of an empty tiled range
+    inline const std::shared_ptr<const TiledRangeData>& empty_tiled_range() {
+      static const std::shared_ptr<const TiledRangeData> empty =
+          std::make_shared<const TiledRangeData>(std::vector<TiledRange1>());
+      return empty;
     }
 
+  }  // namespace detail
+
+  /// Range data of a tiled array
+
+  /// TiledRange is a direct (Cartesian) product of 1-dimensional tiled ranges (TiledRange1)
+  /// The range data is immutable, and it is shared by all copies of a tiled
+  /// range and by all tiled ranges that are constructed with the same
+  /// boundaries, see \c detail::intern_tiled_range() .
+  class TiledRange {
   public:
     // typedefs
     typedef TiledRange TiledRange_;
@@ -68,35 +177,33 @@ namespace TiledArray {
     typedef range_type::size_array size_array;
     typedef std::vector<TiledRange1> Ranges;
 
+  private:
+
+    std::shared_ptr<const detail::TiledRangeData> pimpl_; ///< The shared range data
+
+  public:
+
     /// Default constructor
-    TiledRange() : range_(), elements_range_(), ranges_() { }
+    TiledRange() : pimpl_(detail::empty_tiled_range()) { }
 
     /// Constructed with a set of ranges pointed to by [ first, last ).
     template <typename InIter>
     TiledRange(InIter first, InIter last) :
-      range_(), elements_range_(), ranges_(first, last)
-    {
-      init();
-    }
+      pimpl_(detail::intern_tiled_range(Ranges(first, last)))
+    { }
 
     /// Constructed with a set of ranges pointed to by [ first, last ).
     TiledRange(const std::initializer_list<std::initializer_list<size_type> >& list) :
-      range_(), elements_range_(), ranges_(list.begin(), list.end())
-    {
-      init();
-    }
+      pimpl_(detail::intern_tiled_range(Ranges(list.begin(), list.end())))
+    { }
 
     /// Constructed with an initializer_list of TiledRange1's
     TiledRange(const std::initializer_list<TiledRange1>& list) :
-      range_(), elements_range_(), ranges_(list.begin(), list.end())
-    {
-      init();
-    }
+      pimpl_(detail::intern_tiled_range(Ranges(list.begin(), list.end())))
+    { }
 
     /// Copy constructor
-    TiledRange(const TiledRange_& other) :
-        range_(other.range_), elements_range_(other.elements_range_), ranges_(other.ranges_)
-    { }
+    TiledRange(const TiledRange_& other) : pimpl_(other.pimpl_) { }
 
     /// TiledRange assignment operator
 
@@ -111,9 +218,8 @@ namespace TiledArray {
 
     /// \return A reference to this object
     TiledRange_& operator *=(const Permutation& p) {
-      TA_ASSERT(p.dim() == range_.rank());
-      Ranges temp = p * ranges_;
-      TiledRange(temp.begin(), temp.end()).swap(*this);
+      TA_ASSERT(p.dim() == rank());
+      pimpl_ = detail::intern_tiled_range(p * pimpl_->ranges);
       return *this;
     }
 
@@ -121,7 +227,7 @@ namespace TiledArray {
 
     /// \return A const reference to the tile range object
     const range_type& tiles_range() const {
-      return range_;
+      return pimpl_->tiles_range;
     }
 
     /// Access the tile range
@@ -136,7 +242,7 @@ namespace TiledArray {
 
     /// \return A const reference to the element range object
     const tiles_range_type& elements_range() const {
-      return elements_range_;
+      return pimpl_->elements_range;
     }
 
     /// Access the element range
@@ -160,11 +266,15 @@ namespace TiledArray {
 
     /// Construct a range for the tile indexed by the given ordinal index.
 
+    /// The tile ranges are cached, see \c detail::TileRangeCache .
     /// \param i The ordinal index of the tile range to be constructed
     /// \throw std::runtime_error Throws if i is not included in the range
     /// \return The constructed range object
     tiles_range_type make_tile_range(const size_type& i) const {
       TA_ASSERT(tiles_range().includes(i));
+      if(pimpl_->cache)
+        return pimpl_->cache->get(i, [this,i] () {
+          return make_tile_range(tiles_range().idx(i)); });
       return make_tile_range(tiles_range().idx(i));
     }
 
@@ -190,9 +300,9 @@ namespace TiledArray {
     template <typename Index>
     typename std::enable_if<! std::is_integral<Index>::value, tiles_range_type>::type
     make_tile_range(const Index& index) const {
-      const auto rank = range_.rank();
+      const auto rank = tiles_range().rank();
       TA_ASSERT(index.size() == rank);
-      TA_ASSERT(range_.includes(index));
+      TA_ASSERT(tiles_range().includes(index));
       typename tiles_range_type::index lower;
       typename tiles_range_type::index upper;
       lower.reserve(rank);
@@ -239,11 +349,11 @@ namespace TiledArray {
     template <typename Index>
     typename std::enable_if<! std::is_integral<Index>::value, typename range_type::index>::type
     element_to_tile(const Index& index) const {
-      const unsigned int rank = range_.rank();
+      const unsigned int rank = tiles_range().rank();
       typename range_type::index result;
       result.reserve(rank);
       for(size_type i = 0; i < rank; ++i)
-        result.push_back(ranges_[i].element_to_tile(index[i]));
+        result.push_back(pimpl_->ranges[i].element_to_tile(index[i]));
 
       return result;
     }
@@ -251,7 +361,7 @@ namespace TiledArray {
     /// The rank accessor
 
     /// \return the rank (=number of dimensions) of this object
-    std::size_t rank() const { return ranges_.size(); }
+    std::size_t rank() const { return pimpl_->ranges.size(); }
 
     /// Accessor of the tiled range for one of the dimensions
 
@@ -259,26 +369,20 @@ namespace TiledArray {
     /// \return TIledRange1 object for dimension \c d
     const TiledRange1& dim(std::size_t d) const {
       TA_ASSERT(d < rank());
-      return ranges_[d];
+      return pimpl_->ranges[d];
     }
 
     /// Tile dimension boundary array accessor
 
     /// \return A reference to the array of Range1 objects.
     /// \throw nothing
-    const Ranges& data() const { return ranges_; }
+    const Ranges& data() const { return pimpl_->ranges; }
 
 
     void swap(TiledRange_& other) {
-      range_.swap(other.range_);
-      elements_range_.swap(other.elements_range_);
-      std::swap(ranges_, other.ranges_);
+      std::swap(pimpl_, other.pimpl_);
     }
 
-  private:
-    range_type range_; ///< Stores information on tile indexing for the range.
-    tiles_range_type elements_range_; ///< Stores information on element indexing for the range.
-    Ranges ranges_; ///< Stores tile boundaries for each dimension.
   };
 
   /// TiledRange permutation operator.
@@ -298,6 +402,9 @@ namespace TiledArray {
 
   /// Returns true when all tile and element ranges are the same.
   inline bool operator ==(const TiledRange& r1, const TiledRange& r2) {
+    // Interned tiled ranges with the same boundaries share their data
+    if(& r1.data() == & r2.data())
+      return true;
     return (r1.tiles_range().rank() == r2.tiles_range().rank()) &&
         (r1.tiles_range() == r2.tiles_range()) && (r1.elements_range() == r2.elements_range()) &&
         std::equal(r1.data().begin(), r1.data().end(), r2.data().begin());
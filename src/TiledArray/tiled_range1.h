@@ -22,6 +22,7 @@
 
 #include <TiledArray/error.h>
 #include <TiledArray/type_traits.h>
+#include <algorithm>
 #include <vector>
 #include <initializer_list>
 
@@ -43,7 +44,7 @@ namespace TiledArray {
     /// Default constructor, range of 0 tiles and elements.
     TiledRange1() :
         range_(0,0), elements_range_(0,0),
-        tiles_ranges_(1, range_type(0,0)), elem2tile_(1, 0)
+        tiles_ranges_(1, range_type(0,0)), block_size_(0)
     {
       init_map_();
     }
@@ -53,7 +54,7 @@ namespace TiledArray {
     template <typename RandIter,
         typename std::enable_if<detail::is_random_iterator<RandIter>::value>::type* = nullptr>
     TiledRange1(RandIter first, RandIter last) :
-        range_(), elements_range_(), tiles_ranges_(), elem2tile_()
+        range_(), elements_range_(), tiles_ranges_(), block_size_(0)
     {
       init_tiles_(first, last, 0);
       init_map_();
@@ -62,7 +63,7 @@ namespace TiledArray {
     /// Copy constructor
     TiledRange1(const TiledRange1& rng) :
         range_(rng.range_), elements_range_(rng.elements_range_),
-        tiles_ranges_(rng.tiles_ranges_), elem2tile_(rng.elem2tile_)
+        tiles_ranges_(rng.tiles_ranges_), block_size_(rng.block_size_)
     { }
 
     /// Construct a 1D tiled range.
@@ -73,7 +74,8 @@ namespace TiledArray {
     /// \param t0 The starting index of the first tile
     /// \param t_rest The rest of tile boundaries
     template<typename... _sizes>
-    explicit TiledRange1(const size_type& t0, const _sizes&... t_rest)
+    explicit TiledRange1(const size_type& t0, const _sizes&... t_rest) :
+        range_(), elements_range_(), tiles_ranges_(), block_size_(0)
     {
       const size_type n = sizeof...(_sizes) + 1;
       size_type tile_boundaries[n] = {t0, static_cast<size_type>(t_rest)...};
@@ -87,7 +89,8 @@ namespace TiledArray {
     /// The number of tile boundaries is n + 1, where n is the number of tiles.
     /// Tiles are defined as [t0, t1), [t1, t2), [t2, t3), ...
     /// \param list The list of tile boundaries in order from smallest to largest
-    explicit TiledRange1(const std::initializer_list<size_type>& list)
+    explicit TiledRange1(const std::initializer_list<size_type>& list) :
+        range_(), elements_range_(), tiles_ranges_(), block_size_(0)
     {
       init_tiles_(list.begin(), list.end(), 0);
       init_map_();
@@ -146,12 +149,25 @@ namespace TiledArray {
       return tiles_ranges_[i - range_.first];
     }
 
-    const size_type& element_to_tile(const size_type& i) const {
+    /// Convert an element index to a tile index
+
+    /// When all tiles, except the last one, have the same size, the tile is
+    /// computed with one division; otherwise the tile boundaries are
+    /// searched.
+    /// \param i The element index
+    /// \return The index of the tile that contains element \c i
+    size_type element_to_tile(const size_type& i) const {
       TA_ASSERT( includes(elements_range_, i) );
-      return elem2tile_[i - elements_range_.first];
+      if(block_size_)
+        return range_.first + (i - elements_range_.first) / block_size_;
+      const_iterator it = std::upper_bound(tiles_ranges_.begin(),
+          tiles_ranges_.end(), i, [] (const size_type e, const range_type& tile) {
+            return e < tile.second;
+          });
+      return range_.first + (it - tiles_ranges_.begin());
     }
 
-    DEPRECATED const size_type& element2tile(const size_type& i) const {
+    DEPRECATED size_type element2tile(const size_type& i) const {
       return element_to_tile(i);
     }
 
@@ -159,7 +175,7 @@ namespace TiledArray {
       std::swap(range_, other.range_);
       std::swap(elements_range_, other.elements_range_);
       std::swap(tiles_ranges_, other.tiles_ranges_);
-      std::swap(elem2tile_, other.elem2tile_);
+      std::swap(block_size_, other.block_size_);
     }
 
   private:
@@ -195,15 +211,18 @@ namespace TiledArray {
     /// Initialize secondary data
     void init_map_() {
       // check for 0 size range.
+      block_size_ = 0;
       if((elements_range_.second - elements_range_.first) == 0)
         return;
 
-      // initialize elem2tile map
-      elem2tile_.resize(elements_range_.second - elements_range_.first);
-      const size_type end = range_.second - range_.first;
-      for(size_type t = 0; t < end; ++t)
-        for(size_type e = tiles_ranges_[t].first; e < tiles_ranges_[t].second; ++e)
-          elem2tile_[e - elements_range_.first] = t + range_.first;
+      // Check for uniform tiles, where only the last tile may be smaller
+      const size_type block_size = tiles_ranges_.front().second - tiles_ranges_.front().first;
+      const size_type end = tiles_ranges_.size() - 1;
+      for(size_type t = 1; t < end; ++t)
+        if((tiles_ranges_[t].second - tiles_ranges_[t].first) != block_size)
+          return;
+      if((tiles_ranges_.back().second - tiles_ranges_.back().first) <= block_size)
+        block_size_ = block_size;
     }
 
     friend std::ostream& operator <<(std::ostream&, const TiledRange1&);
@@ -212,7 +231,7 @@ namespace TiledArray {
     range_type range_; ///< the range of tile indices
     range_type elements_range_; ///< the range of element indices
     std::vector<range_type> tiles_ranges_; ///< ranges of each tile.
-    std::vector<size_type> elem2tile_; ///< maps element index to tile index (secondary data).
+    size_type block_size_; ///< The size of uniform tiles, or zero for non-uniform tiles (secondary data).
 
   }; // class TiledRange1
 
@@ -0,0 +1,219 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tiling_tuner.cpp
+ *  Mar 8, 2017
+ *
+ */
+
+#include <TiledArray/tiling_tuner.h>
+#include <TiledArray/dist_eval/contraction_eval.h>
+#include <TiledArray/math/blas.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace TiledArray {
+
+  namespace {
+
+    /// Time a function
+
+    /// \param op The function to be timed
+    /// \param repeat The number of calls
+    /// \return The shortest time of one call, in s
+    template <typename Op>
+    double best_time(Op&& op, const unsigned int repeat) {
+      double best = std::numeric_limits<double>::max();
+      for(unsigned int r = 0u; r < repeat; ++r) {
+        const double start = madness::wall_time();
+        op();
+        best = std::min(best, madness::wall_time() - start);
+      }
+      return std::max(best, 1.0e-9);
+    }
+
+    /// The number of rows of the most square process grid
+
+    /// \param nproc The number of processes
+    /// \return The largest divisor of \c nproc that is not greater than its
+    /// square root
+    std::size_t grid_rows(const std::size_t nproc) {
+      std::size_t rows = std::max<std::size_t>(std::sqrt(double(nproc)), 1ul);
+      while(nproc % rows)
+        --rows;
+      return rows;
+    }
+
+    /// Split an extent into tiles whose extents differ by at most one
+
+    /// \param extent The extent
+    /// \param ntiles The number of tiles
+    /// \return The tiling
+    TiledRange1 even_tiling(const std::size_t extent, const std::size_t ntiles) {
+      std::vector<std::size_t> bounds;
+      bounds.reserve(ntiles + 1ul);
+      for(std::size_t t = 0ul; t <= ntiles; ++t)
+        bounds.push_back((extent * t) / ntiles);
+      return TiledRange1(bounds.begin(), bounds.end());
+    }
+
+  } // namespace
+
+  double MachineRates::gemm_rate(const std::size_t size) const {
+    TA_USER_ASSERT(! gemm_sizes.empty() && gemm_sizes.size() == gemm_rates.size(),
+        "MachineRates: the GEMM rates have not been set.");
+    if(size <= gemm_sizes.front())
+      return gemm_rates.front();
+    if(size >= gemm_sizes.back())
+      return gemm_rates.back();
+    const std::size_t i =
+        std::upper_bound(gemm_sizes.begin(), gemm_sizes.end(), size)
+        - gemm_sizes.begin();
+    const double x = double(size - gemm_sizes[i - 1]) /
+        double(gemm_sizes[i] - gemm_sizes[i - 1]);
+    return gemm_rates[i - 1] + x * (gemm_rates[i] - gemm_rates[i - 1]);
+  }
+
+  MachineRates probe_machine_rates(World& world) {
+    MachineRates rates;
+    rates.threads = madness::ThreadPool::size() + 1ul;
+
+    // GEMM rate of one thread
+    for(const std::size_t size : { 32ul, 64ul, 128ul, 256ul, 512ul }) {
+      std::vector<double> a(size * size, 1.0), b(size * size, 1.0),
+          c(size * size, 0.0);
+      const integer n = size;
+      const double time = best_time([&] () {
+        math::gemm(madness::cblas::NoTrans, madness::cblas::NoTrans, n, n, n,
+            1.0, a.data(), n, b.data(), n, 0.0, c.data(), n);
+      }, (size <= 128ul ? 5u : 2u));
+      rates.gemm_sizes.push_back(size);
+      rates.gemm_rates.push_back(2.0 * double(size * size * size) / time);
+    }
+
+    // Task overhead
+    {
+      const unsigned int ntasks = 10000u;
+      const double start = madness::wall_time();
+      for(unsigned int i = 0u; i < ntasks; ++i)
+        world.taskq.add([] () { });
+      world.taskq.fence();
+      rates.task_overhead = (madness::wall_time() - start) * double(rates.threads)
+          / double(ntasks);
+    }
+
+    // Broadcast latency and bandwidth
+    if(world.size() > 1) {
+      const std::size_t large = 1ul << 24;
+      std::vector<char> buffer(large, 0);
+      const double small_time = best_time([&] () {
+        world.gop.broadcast(buffer.data(), 8ul, 0);
+      }, 5u);
+      const double large_time = best_time([&] () {
+        world.gop.broadcast(buffer.data(), large, 0);
+      }, 2u);
+      // Broadcasts take log2(P) point-to-point steps
+      const double steps = std::max(std::log2(double(world.size())), 1.0);
+      rates.latency = small_time / steps;
+      rates.bandwidth = double(large) * steps /
+          std::max(large_time - small_time, 1.0e-9);
+    }
+
+    // Use the worst rates of all processes
+    std::vector<double> worst(rates.gemm_rates);
+    worst.push_back(rates.bandwidth);
+    for(double& rate : worst)
+      rate = -rate;
+    worst.push_back(rates.latency);
+    worst.push_back(rates.task_overhead);
+    world.gop.max(worst.data(), worst.size());
+    const std::size_t n = rates.gemm_rates.size();
+    for(std::size_t i = 0ul; i < n; ++i)
+      rates.gemm_rates[i] = -worst[i];
+    rates.bandwidth = -worst[n];
+    rates.latency = worst[n + 1];
+    rates.task_overhead = worst[n + 2];
+    world.gop.min(rates.threads);
+
+    return rates;
+  }
+
+  TilingRecommendation recommend_tiling(const std::size_t extent,
+      const std::size_t nproc, const MachineRates& rates,
+      const std::size_t min_block, const std::size_t max_block)
+  {
+    TA_USER_ASSERT(extent > 0ul, "recommend_tiling: the extent must be positive.");
+    TA_USER_ASSERT(nproc > 0ul, "recommend_tiling: the number of processes must be positive.");
+    TA_USER_ASSERT(min_block > 0ul && min_block <= max_block,
+        "recommend_tiling: invalid block size range.");
+
+    const std::size_t prow = grid_rows(nproc);
+    const std::size_t pcol = nproc / prow;
+
+    TilingRecommendation best;
+    best.time = std::numeric_limits<double>::max();
+
+    // Each number of tiles gives a distinct tiling, so scan the tile counts
+    const std::size_t min_tiles = std::max<std::size_t>((extent + max_block - 1ul) / max_block, 1ul);
+    const std::size_t max_tiles = std::max<std::size_t>(extent / min_block, min_tiles);
+    for(std::size_t ntiles = min_tiles; ntiles <= max_tiles; ++ntiles) {
+      const std::size_t block = (extent + ntiles - 1ul) / ntiles;
+
+      // Local result tiles and the work of one SUMMA step
+      const double row_tiles = std::ceil(double(ntiles) / double(prow));
+      const double col_tiles = std::ceil(double(ntiles) / double(pcol));
+      const double local_tiles = row_tiles * col_tiles;
+      const double threads = std::min(double(rates.threads), local_tiles);
+      const double flops = 2.0 * local_tiles * double(block) * double(block)
+          * double(block);
+      const double compute = flops / (rates.gemm_rate(block) * threads)
+          + local_tiles * rates.task_overhead / threads;
+
+      // Broadcast of a block column of the left and a block row of the right
+      const double bytes = double(block) * double(block) * sizeof(double);
+      const double row_bcast = std::log2(double(pcol)) *
+          (rates.latency + row_tiles * bytes / rates.bandwidth);
+      const double col_bcast = std::log2(double(prow)) *
+          (rates.latency + col_tiles * bytes / rates.bandwidth);
+      const double communicate = row_bcast + col_bcast;
+
+      // Steps overlap communication with computation, and the first
+      // broadcast is not hidden.
+      const double time = double(ntiles) * std::max(compute, communicate)
+          + communicate;
+      if(time < best.time) {
+        best.time = time;
+        best.block_size = block;
+        best.trange1 = even_tiling(extent, ntiles);
+        best.summa_depth = std::min<std::size_t>(ntiles,
+            2ul + std::size_t(communicate / std::max(compute, 1.0e-12)));
+      }
+    }
+
+    return best;
+  }
+
+  TilingRecommendation recommend_tiling(World& world, const std::size_t extent) {
+    return recommend_tiling(extent, world.size(), probe_machine_rates(world));
+  }
+
+  void apply_summa_depth(const TilingRecommendation& recommendation) {
+    detail::summa_max_depth() = recommendation.summa_depth;
+  }
+
+} // namespace TiledArray
@@ -0,0 +1,111 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tiling_tuner.h
+ *  Mar 8, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_TILING_TUNER_H__INCLUDED
+#define TILEDARRAY_TILING_TUNER_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/tiled_range1.h>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Machine rates used by the tiling cost model
+
+  /// All rates are per process. They can be measured with
+  /// \c probe_machine_rates() or filled in from known machine parameters.
+  struct MachineRates {
+    /// Block sizes at which the GEMM rates were measured, in ascending order
+    std::vector<std::size_t> gemm_sizes;
+    /// GEMM rate of one thread at each block size, in flop/s
+    std::vector<double> gemm_rates;
+    double bandwidth = 1.0e9; ///< Point-to-point bandwidth, in bytes/s
+    double latency = 1.0e-5; ///< Point-to-point message latency, in s
+    double task_overhead = 1.0e-6; ///< Time to schedule and run one task, in s
+    std::size_t threads = 1ul; ///< The number of threads of each process
+
+    /// GEMM rate of one thread
+
+    /// The rate is interpolated linearly between the measured block sizes
+    /// and held constant outside of them.
+    /// \param size The block size
+    /// \return The GEMM rate of one thread for \c size blocks, in flop/s
+    double gemm_rate(const std::size_t size) const;
+  }; // struct MachineRates
+
+  /// A tiling recommended by the cost model
+  struct TilingRecommendation {
+    TiledRange1 trange1; ///< The recommended tiling of the extent
+    std::size_t block_size = 0ul; ///< The largest tile extent of \c trange1
+    std::size_t summa_depth = 0ul; ///< The recommended SUMMA depth
+    double time = 0.0; ///< The estimated time of one matrix multiplication, in s
+  }; // struct TilingRecommendation
+
+  /// Measure the machine rates with a short probe
+
+  /// The probe times GEMMs of a few block sizes, broadcasts of a small and a
+  /// large message, and a batch of empty tasks. It takes well under a second
+  /// and is collective; the rates are the worst rates of all processes, so
+  /// every process gets the same rates and the same recommendation.
+  /// \param world The world to be probed
+  /// \return The measured rates
+  MachineRates probe_machine_rates(World& world);
+
+  /// Recommend a tiling for matrix multiplications
+
+  /// The cost model estimates the time of a SUMMA multiplication of two
+  /// square \c extent by \c extent matrices on \c nproc processes for a range
+  /// of block sizes. Each SUMMA step is bound by the larger of the GEMM time
+  /// of the local result tiles, at the measured rate for the block size and
+  /// with no more busy threads than local tiles, and the time to broadcast a
+  /// block row and block column over the process grid. Each tile contraction
+  /// adds the task overhead. The tiling of the cheapest block size splits
+  /// \c extent into tiles whose extents differ by at most one, and the SUMMA
+  /// depth is the number of steps whose broadcasts are needed to hide the
+  /// communication of a step behind its computation.
+  /// \param extent The extent of the matrix dimensions
+  /// \param nproc The number of processes
+  /// \param rates The machine rates
+  /// \param min_block The smallest block size to be considered [ default = 16 ]
+  /// \param max_block The largest block size to be considered [ default = 2048 ]
+  /// \return The recommended tiling
+  TilingRecommendation recommend_tiling(const std::size_t extent,
+      const std::size_t nproc, const MachineRates& rates,
+      const std::size_t min_block = 16ul, const std::size_t max_block = 2048ul);
+
+  /// Recommend a tiling for matrix multiplications in \c world
+
+  /// This probes the machine rates of \c world and recommends a tiling for
+  /// its processes. It is collective.
+  /// \param world The world
+  /// \param extent The extent of the matrix dimensions
+  /// \return The recommended tiling
+  TilingRecommendation recommend_tiling(World& world, const std::size_t extent);
+
+  /// Use the recommended SUMMA depth for later contractions
+
+  /// \param recommendation The recommended tiling
+  void apply_summa_depth(const TilingRecommendation& recommendation);
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILING_TUNER_H__INCLUDED
@@ -399,6 +399,22 @@ namespace TiledArray {
   struct is_consumable_tile<ZeroTensor> : public std::false_type { };
 
 
+  /// Copy-on-write tile type trait
+
+  /// This trait is used to determine if copies of a tile type are safe to
+  /// share between arrays, i.e. if a tile copies its data before the data
+  /// is modified through a copy that shares it with other tiles. Tiles of
+  /// these types are not cloned when they are copied into another array.
+  /// By default, tile types are shallow copies and this trait evaluates to
+  /// \c std::false_type ; \c Tile is copy-on-write.
+  /// \tparam T The tile type
+  template <typename T>
+  struct is_copy_on_write_tile : public std::false_type { };
+
+  template <typename T>
+  struct is_copy_on_write_tile<Tile<T> > : public std::true_type { };
+
+
 
   /** @}*/
 
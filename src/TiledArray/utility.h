@@ -30,9 +30,14 @@
 #include <TiledArray/error.h>
 #include <TiledArray/type_traits.h>
 #include <iosfwd>
+#include <fstream>
+#include <limits>
+#include <string>
 #include <vector>
 #include <array>
 #include <initializer_list>
+#include <cstdlib>
+#include <unistd.h>
 
 namespace TiledArray {
   namespace detail {
@@ -162,6 +167,58 @@ namespace TiledArray {
       print_array(out, a, size(a));
     }
 
+    /// Available physical memory of this node
+
+    /// The available memory is read from \c MemAvailable in
+    /// <tt>/proc/meminfo</tt>, which includes the page cache that the kernel
+    /// can reclaim; where that is not available, the number of free pages is
+    /// used.
+    /// \return The number of bytes of physical memory that are currently
+    /// available on this node, or 0 if that cannot be determined.
+    inline std::size_t node_available_memory() {
+      {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string key;
+        std::size_t kib = 0ul;
+        while(meminfo >> key >> kib) {
+          if(key == "MemAvailable:")
+            return kib * 1024ul;
+          meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+      }
+
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+      const long pages = sysconf(_SC_AVPHYS_PAGES);
+      const long page_size = sysconf(_SC_PAGESIZE);
+      if((pages > 0l) && (page_size > 0l))
+        return std::size_t(pages) * std::size_t(page_size);
+#endif // defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+      return 0ul;
+    }
+
+    /// Number of processes that share this node
+
+    /// The number of processes per node is read from the environment
+    /// variables set by common MPI launchers (Open MPI, MPICH/Hydra,
+    /// MVAPICH2, and SLURM). The \c TA_LOCAL_PROCS environment variable
+    /// takes precedence over the launcher variables.
+    /// \return The number of processes on this node, or 1 if it cannot be
+    /// determined.
+    inline std::size_t node_local_procs() {
+      const char* const vars[] = { "TA_LOCAL_PROCS",
+          "OMPI_COMM_WORLD_LOCAL_SIZE", "MPI_LOCALNRANKS",
+          "MV2_COMM_WORLD_LOCAL_SIZE", "SLURM_NTASKS_PER_NODE" };
+      for(const char* var : vars) {
+        const char* value = getenv(var);
+        if(value) {
+          const long n = std::atol(value);
+          if(n > 0l)
+            return n;
+        }
+      }
+      return 1ul;
+    }
+
   } // namespace detail
 } // namespace TiledArray
 
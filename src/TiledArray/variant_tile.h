@@ -0,0 +1,840 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  variant_tile.h
+ *  May 23, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_VARIANT_TILE_H__INCLUDED
+#define TILEDARRAY_VARIANT_TILE_H__INCLUDED
+
+#include <TiledArray/low_rank_tile.h>
+#include <TiledArray/sparse_tile.h>
+#include <TiledArray/tensor.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The largest relative storage cost of low-rank variant tiles
+
+    /// A variant tile is kept in low-rank form while the number of elements
+    /// of its factors, \f$ r (m + n) \f$ , does not exceed this fraction of
+    /// \f$ m n \f$ ; otherwise it is expanded to a dense tile. The fraction
+    /// is read from the \c TA_VARIANT_TILE_LOW_RANK environment variable;
+    /// the default fraction is 0.5.
+    /// \return The largest relative storage cost of low-rank tiles
+    inline double variant_tile_low_rank_ratio() {
+      static const double ratio = [] () -> double {
+        const char* ratio = getenv("TA_VARIANT_TILE_LOW_RANK");
+        if(ratio)
+          return std::strtod(ratio, nullptr);
+        return 0.5;
+      }();
+      return ratio;
+    }
+
+    /// The number of diagonal elements of a range
+
+    /// \param range The range
+    /// \return The smallest extent of \c range
+    inline std::size_t diagonal_size(const Range& range) {
+      return *std::min_element(range.extent_data(),
+          range.extent_data() + range.rank());
+    }
+
+    /// The ordinal distance of consecutive diagonal elements of a range
+
+    /// \param range The range
+    /// \return The sum of the strides of \c range
+    inline std::size_t diagonal_stride(const Range& range) {
+      return std::accumulate(range.stride_data(),
+          range.stride_data() + range.rank(), std::size_t(0));
+    }
+
+  }  // namespace detail
+
+  /// A tile whose representation is chosen by its data
+
+  /// Each tile is held in one of five forms: a zero tile, which stores only
+  /// its range; a dense \c Tensor ; a compressed \c SparseTile ; a factored
+  /// \c LowRankTile , for matrices; or a diagonal tile, which stores the
+  /// elements whose indices are all equal. An array of variant tiles can
+  /// therefore hold each block in the form that fits it. The arithmetic of
+  /// the tile interface, which is called by the element-wise tile
+  /// operations and by \c ContractReduce , dispatches on the forms of both
+  /// arguments: products with zero tiles are zero tiles, pairs of low-rank
+  /// or dense tiles use their own kernels, diagonal and compressed tiles use
+  /// the compressed kernels, and other pairs are expanded to dense tiles.
+  /// Every result is converted to its cheapest form by the cost thresholds:
+  /// a tile is compressed while its fill does not exceed
+  /// \c detail::sparse_tile_fill() , and a low-rank tile is kept while its
+  /// factors cost at most \c detail::variant_tile_low_rank_ratio() of the
+  /// dense tile. Dense tiles are factored only by \c compress() .
+  /// Copies are shallow; see \c clone() for deep copies.
+  /// \tparam T The element type
+  template <typename T>
+  class VariantTile {
+  public:
+    typedef VariantTile<T> VariantTile_; ///< This object type
+    typedef Range range_type; ///< Tensor range type
+    typedef T value_type; ///< Element type
+    typedef T numeric_type; ///< The scalar type that is compatible with value_type
+    typedef std::size_t size_type; ///< Size type
+    typedef Tensor<T> dense_type; ///< Dense tile type
+    typedef SparseTile<T> sparse_type; ///< Compressed tile type
+    typedef LowRankTile<T> low_rank_type; ///< Low-rank tile type
+
+    /// The representation of a tile
+    enum class Kind { zero, dense, sparse, low_rank, diagonal };
+
+  private:
+
+    /// The tile data; only the member of \c kind_ is set
+    struct Impl {
+      Kind kind_; ///< The representation of the tile
+      range_type range_; ///< The tile range
+      dense_type dense_; ///< The elements of a dense tile
+      sparse_type sparse_; ///< The elements of a compressed tile
+      low_rank_type low_rank_; ///< The factors of a low-rank tile
+      std::vector<T> diagonal_; ///< The elements of a diagonal tile
+    }; // struct Impl
+
+    std::shared_ptr<Impl> pimpl_; ///< The tile data
+
+    /// Construct a tile from its data
+    explicit VariantTile(Impl impl) :
+      pimpl_(std::make_shared<Impl>(std::move(impl)))
+    { }
+
+    /// \return \c true when \c kind is stored as a list of elements
+    static bool is_sparse_kind(const Kind kind) {
+      return (kind == Kind::sparse) || (kind == Kind::diagonal);
+    }
+
+    /// Construct a tile from a dense tensor
+
+    /// \param dense The elements of the tile
+    /// \return A zero, compressed, or dense tile
+    static VariantTile_ from_dense(dense_type dense) {
+      const size_type volume = dense.size();
+      const T* MADNESS_RESTRICT const data = dense.data();
+      size_type nnz = 0ul;
+      for(size_type i = 0ul; i < volume; ++i)
+        nnz += (data[i] != T(0));
+      if(nnz == 0ul)
+        return VariantTile_(dense.range());
+      if(double(nnz) <= detail::sparse_tile_fill() * double(volume))
+        return from_sparse(sparse_type(dense, detail::sparse_tile_fill()));
+      return VariantTile_(Impl{ Kind::dense, dense.range(), std::move(dense),
+          sparse_type(), low_rank_type(), std::vector<T>() });
+    }
+
+    /// Construct a tile from a compressed tile
+
+    /// \param sparse The elements of the tile
+    /// \return A zero, diagonal, compressed, or dense tile
+    static VariantTile_ from_sparse(sparse_type sparse) {
+      const range_type& range = sparse.range();
+      if(! sparse.is_sparse())
+        return VariantTile_(Impl{ Kind::dense, range, sparse.dense(),
+            sparse_type(), low_rank_type(), std::vector<T>() });
+      if(sparse.nnz() == 0ul)
+        return VariantTile_(range);
+
+      // Detect diagonal tiles
+      const size_type size = detail::diagonal_size(range);
+      const size_type stride = detail::diagonal_stride(range);
+      const std::vector<size_type>& index = sparse.index();
+      if((range.rank() > 1u) && std::all_of(index.begin(), index.end(),
+          [=] (const size_type o)
+          { return ((o % stride) == 0ul) && ((o / stride) < size); }))
+      {
+        std::vector<T> diagonal(size, T(0));
+        for(size_type e = 0ul; e < index.size(); ++e)
+          diagonal[index[e] / stride] = sparse.value()[e];
+        return VariantTile_(Impl{ Kind::diagonal, range, dense_type(),
+            sparse_type(), low_rank_type(), std::move(diagonal) });
+      }
+
+      return VariantTile_(Impl{ Kind::sparse, range, dense_type(),
+          std::move(sparse), low_rank_type(), std::vector<T>() });
+    }
+
+    /// Construct a tile from a low-rank tile
+
+    /// \param low_rank The factors of the tile
+    /// \return A zero, low-rank, or dense tile
+    static VariantTile_ from_low_rank(low_rank_type low_rank) {
+      const range_type& range = low_rank.range();
+      if(low_rank.rank() == 0ul)
+        return VariantTile_(range);
+      const double cost = double(low_rank.rank()) *
+          double(range.extent_data()[0] + range.extent_data()[1]);
+      if(cost > detail::variant_tile_low_rank_ratio() * double(range.volume()))
+        return from_dense(static_cast<dense_type>(low_rank));
+      return VariantTile_(Impl{ Kind::low_rank, range, dense_type(),
+          sparse_type(), std::move(low_rank), std::vector<T>() });
+    }
+
+    /// Construct a tile from its diagonal
+
+    /// \param range The range of the tile
+    /// \param diagonal The diagonal elements
+    /// \return A zero or diagonal tile
+    static VariantTile_ from_diagonal(const range_type& range,
+        std::vector<T> diagonal)
+    {
+      if(std::all_of(diagonal.begin(), diagonal.end(),
+          [] (const T x) { return x == T(0); }))
+        return VariantTile_(range);
+      return VariantTile_(Impl{ Kind::diagonal, range, dense_type(),
+          sparse_type(), low_rank_type(), std::move(diagonal) });
+    }
+
+    /// \return The diagonal elements of this tile
+    std::vector<T> diagonal_of() const {
+      const range_type& range = pimpl_->range_;
+      const size_type size = detail::diagonal_size(range);
+      const size_type stride = detail::diagonal_stride(range);
+      std::vector<T> result(size, T(0));
+      switch(pimpl_->kind_) {
+        case Kind::zero:
+          break;
+        case Kind::dense:
+          for(size_type d = 0ul; d < size; ++d)
+            result[d] = pimpl_->dense_[d * stride];
+          break;
+        case Kind::sparse:
+          {
+            const std::vector<size_type>& index = pimpl_->sparse_.index();
+            for(size_type e = 0ul; e < index.size(); ++e)
+              if((index[e] % stride) == 0ul)
+                result[index[e] / stride] = pimpl_->sparse_.value()[e];
+          }
+          break;
+        case Kind::low_rank:
+          for(size_type d = 0ul; d < size; ++d)
+            result[d] = pimpl_->low_rank_.u().row(d).cwiseProduct(
+                pimpl_->low_rank_.v().row(d)).sum();
+          break;
+        case Kind::diagonal:
+          result = pimpl_->diagonal_;
+          break;
+      }
+      return result;
+    }
+
+    /// \return This tile as a compressed tile
+    sparse_type to_sparse() const {
+      const range_type& range = pimpl_->range_;
+      switch(pimpl_->kind_) {
+        case Kind::sparse:
+          return pimpl_->sparse_;
+        case Kind::diagonal:
+          {
+            const size_type stride = detail::diagonal_stride(range);
+            std::vector<size_type> index;
+            std::vector<T> value;
+            for(size_type d = 0ul; d < pimpl_->diagonal_.size(); ++d) {
+              if(pimpl_->diagonal_[d] != T(0)) {
+                index.push_back(d * stride);
+                value.push_back(pimpl_->diagonal_[d]);
+              }
+            }
+            return sparse_type(range, std::move(index), std::move(value),
+                detail::sparse_tile_fill());
+          }
+        case Kind::zero:
+          return sparse_type(range, detail::sparse_tile_fill());
+        default:
+          return sparse_type(dense(), detail::sparse_tile_fill());
+      }
+    }
+
+    /// Sum of this tile and a scaled tile
+
+    /// \param right The tile to be added
+    /// \param factor The scaling factor of \c right
+    /// \return A tile that is equal to <tt>(*this) + factor * right</tt>
+    VariantTile_ axpy(const VariantTile_& right, const numeric_type factor) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(pimpl_->range_ == right.pimpl_->range_);
+      const Kind left_kind = pimpl_->kind_;
+      const Kind right_kind = right.pimpl_->kind_;
+
+      if(right_kind == Kind::zero)
+        return clone();
+      if(left_kind == Kind::zero)
+        return right.scale(factor);
+      if((left_kind == Kind::diagonal) && (right_kind == Kind::diagonal)) {
+        std::vector<T> diagonal = pimpl_->diagonal_;
+        for(size_type d = 0ul; d < diagonal.size(); ++d)
+          diagonal[d] += right.pimpl_->diagonal_[d] * factor;
+        return from_diagonal(pimpl_->range_, std::move(diagonal));
+      }
+      if((left_kind == Kind::low_rank) && (right_kind == Kind::low_rank))
+        return from_low_rank(pimpl_->low_rank_.add(
+            right.pimpl_->low_rank_.scale(factor)));
+      if(is_sparse_kind(left_kind) && is_sparse_kind(right_kind))
+        return from_sparse(to_sparse().add(right.to_sparse().scale(factor)));
+      return from_dense(dense_type(dense(), right.dense(),
+          [factor] (const T l, const T r) { return l + r * factor; }));
+    }
+
+  public:
+
+    /// Construct an empty tile
+    VariantTile() = default;
+
+    /// Construct a zero tile
+
+    /// \param range The range of the tile
+    explicit VariantTile(const range_type& range) :
+      pimpl_(std::make_shared<Impl>(Impl{ Kind::zero, range, dense_type(),
+          sparse_type(), low_rank_type(), std::vector<T>() }))
+    { }
+
+    /// Construct a tile from a dense tensor
+
+    /// The tile is a zero, diagonal, compressed, or dense tile, depending on
+    /// the elements of \c tensor .
+    /// \tparam A The allocator type of the tensor
+    /// \param tensor The elements of the tile
+    template <typename A>
+    explicit VariantTile(const Tensor<T, A>& tensor) :
+      pimpl_(from_dense(dense_type(tensor.range(), tensor.data())).pimpl_)
+    { }
+
+    /// Construct a tile from a compressed tile
+
+    /// \param sparse The elements of the tile
+    explicit VariantTile(const sparse_type& sparse) :
+      pimpl_(from_sparse(sparse).pimpl_)
+    { }
+
+    /// Construct a tile from a low-rank tile
+
+    /// \param low_rank The factors of the tile
+    explicit VariantTile(const low_rank_type& low_rank) :
+      pimpl_(from_low_rank(low_rank).pimpl_)
+    { }
+
+    /// Construct a diagonal tile
+
+    /// \param range The range of the tile
+    /// \param diagonal The diagonal elements, one for each index in
+    /// <tt>[0, detail::diagonal_size(range))</tt>
+    VariantTile(const range_type& range, std::vector<T> diagonal) :
+      pimpl_(from_diagonal(range, std::move(diagonal)).pimpl_)
+    {
+      TA_ASSERT(pimpl_->kind_ == Kind::zero ||
+          pimpl_->diagonal_.size() == detail::diagonal_size(range));
+    }
+
+    /// Construct a tile from a dense tensor, which may be factored
+
+    /// Dense matrices are factored with a truncated singular value
+    /// decomposition, and the factors are kept when they are cheap enough.
+    /// \tparam A The allocator type of the tensor
+    /// \param tensor The elements of the tile
+    /// \param tolerance The truncation tolerance of low-rank tiles
+    /// \return The tile of \c tensor in its cheapest form
+    template <typename A>
+    static VariantTile_ compress(const Tensor<T, A>& tensor,
+        const double tolerance = detail::low_rank_tolerance())
+    {
+      VariantTile_ result(tensor);
+      if((result.kind() == Kind::dense) && (tensor.range().rank() == 2u))
+        result = from_low_rank(low_rank_type(tensor, tolerance));
+      return result;
+    }
+
+    VariantTile(const VariantTile_&) = default;
+    VariantTile(VariantTile_&&) = default;
+    VariantTile_& operator=(const VariantTile_&) = default;
+    VariantTile_& operator=(VariantTile_&&) = default;
+
+    /// Deep copy
+
+    /// \return A copy of this tile that does not share data with this tile
+    VariantTile_ clone() const {
+      if(empty())
+        return VariantTile_();
+      return VariantTile_(Impl{ pimpl_->kind_, pimpl_->range_,
+          pimpl_->dense_.clone(), pimpl_->sparse_.clone(),
+          pimpl_->low_rank_.clone(), pimpl_->diagonal_ });
+    }
+
+    /// The elements of this tile as a dense tensor
+
+    /// \return A tensor that holds the elements of this tile; it shares the
+    /// data of dense tiles
+    dense_type dense() const {
+      TA_ASSERT(! empty());
+      switch(pimpl_->kind_) {
+        case Kind::dense:
+          return pimpl_->dense_;
+        case Kind::sparse:
+          return pimpl_->sparse_.dense();
+        case Kind::low_rank:
+          return static_cast<dense_type>(pimpl_->low_rank_);
+        default:
+          {
+            dense_type result(pimpl_->range_, T(0));
+            const size_type stride = detail::diagonal_stride(pimpl_->range_);
+            for(size_type d = 0ul; d < pimpl_->diagonal_.size(); ++d)
+              result[d * stride] = pimpl_->diagonal_[d];
+            return result;
+          }
+      }
+    }
+
+    /// Expand this tile to a dense tensor
+
+    /// \return A tensor that holds the elements of this tile
+    explicit operator Tensor<T>() const { return dense().clone(); }
+
+    /// \return \c true if this tile is not initialized
+    bool empty() const { return ! pimpl_; }
+
+    /// \return The representation of this tile
+    Kind kind() const {
+      TA_ASSERT(! empty());
+      return pimpl_->kind_;
+    }
+
+    /// \return The range of this tile
+    const range_type& range() const {
+      TA_ASSERT(! empty());
+      return pimpl_->range_;
+    }
+
+    /// \return The number of elements of the dense tile
+    size_type size() const { return range().volume(); }
+
+    /// \return The elements of a compressed tile
+    const sparse_type& sparse() const {
+      TA_ASSERT(kind() == Kind::sparse);
+      return pimpl_->sparse_;
+    }
+
+    /// \return The factors of a low-rank tile
+    const low_rank_type& low_rank() const {
+      TA_ASSERT(kind() == Kind::low_rank);
+      return pimpl_->low_rank_;
+    }
+
+    /// \return The elements of a diagonal tile
+    const std::vector<T>& diagonal() const {
+      TA_ASSERT(kind() == Kind::diagonal);
+      return pimpl_->diagonal_;
+    }
+
+    /// Serialize the tile
+
+    /// \tparam Archive The output archive type
+    /// \param ar The output archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      const bool have_pimpl = ! empty();
+      ar & have_pimpl;
+      if(have_pimpl) {
+        const int kind = int(pimpl_->kind_);
+        ar & kind & pimpl_->range_;
+        switch(pimpl_->kind_) {
+          case Kind::zero: break;
+          case Kind::dense: ar & pimpl_->dense_; break;
+          case Kind::sparse: ar & pimpl_->sparse_; break;
+          case Kind::low_rank: ar & pimpl_->low_rank_; break;
+          case Kind::diagonal: ar & pimpl_->diagonal_; break;
+        }
+      }
+    }
+
+    /// Deserialize the tile
+
+    /// \tparam Archive The input archive type
+    /// \param ar The input archive
+    template <typename Archive,
+        typename std::enable_if<madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      bool have_pimpl = false;
+      ar & have_pimpl;
+      if(have_pimpl) {
+        int kind = 0;
+        pimpl_ = std::make_shared<Impl>();
+        ar & kind & pimpl_->range_;
+        pimpl_->kind_ = Kind(kind);
+        switch(pimpl_->kind_) {
+          case Kind::zero: break;
+          case Kind::dense: ar & pimpl_->dense_; break;
+          case Kind::sparse: ar & pimpl_->sparse_; break;
+          case Kind::low_rank: ar & pimpl_->low_rank_; break;
+          case Kind::diagonal: ar & pimpl_->diagonal_; break;
+        }
+      } else {
+        pimpl_.reset();
+      }
+    }
+
+    // Permutation operations ------------------------------------------------
+
+    /// \param perm The permutation
+    /// \return A permuted copy of this tile
+    VariantTile_ permute(const Permutation& perm) const {
+      TA_ASSERT(! empty());
+      const range_type range = perm * pimpl_->range_;
+      switch(pimpl_->kind_) {
+        case Kind::zero:
+          return VariantTile_(range);
+        case Kind::dense:
+          return VariantTile_(Impl{ Kind::dense, range,
+              pimpl_->dense_.permute(perm), sparse_type(), low_rank_type(),
+              std::vector<T>() });
+        case Kind::sparse:
+          return VariantTile_(Impl{ Kind::sparse, range, dense_type(),
+              pimpl_->sparse_.permute(perm), low_rank_type(), std::vector<T>() });
+        case Kind::low_rank:
+          return VariantTile_(Impl{ Kind::low_rank, range, dense_type(),
+              sparse_type(), pimpl_->low_rank_.permute(perm), std::vector<T>() });
+        default:
+          // The diagonal is invariant under permutations
+          return VariantTile_(Impl{ Kind::diagonal, range, dense_type(),
+              sparse_type(), low_rank_type(), pimpl_->diagonal_ });
+      }
+    }
+
+    // Addition operations ---------------------------------------------------
+
+    VariantTile_ add(const VariantTile_& right) const {
+      return axpy(right, numeric_type(1));
+    }
+
+    VariantTile_ add(const VariantTile_& right, const Permutation& perm) const {
+      return add(right).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ add(const VariantTile_& right, const Scalar factor) const {
+      return add(right).scale(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ add(const VariantTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return add(right).scale(factor, perm);
+    }
+
+    VariantTile_& add_to(const VariantTile_& right) {
+      *pimpl_ = *axpy(right, numeric_type(1)).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_& add_to(const VariantTile_& right, const Scalar factor) {
+      *pimpl_ = *add(right, factor).pimpl_;
+      return *this;
+    }
+
+    // Subtraction operations ------------------------------------------------
+
+    VariantTile_ subt(const VariantTile_& right) const {
+      return axpy(right, numeric_type(-1));
+    }
+
+    VariantTile_ subt(const VariantTile_& right, const Permutation& perm) const {
+      return subt(right).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ subt(const VariantTile_& right, const Scalar factor) const {
+      return subt(right).scale(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ subt(const VariantTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return subt(right).scale(factor, perm);
+    }
+
+    VariantTile_& subt_to(const VariantTile_& right) {
+      *pimpl_ = *axpy(right, numeric_type(-1)).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_& subt_to(const VariantTile_& right, const Scalar factor) {
+      *pimpl_ = *subt(right, factor).pimpl_;
+      return *this;
+    }
+
+    // Multiplication operations ---------------------------------------------
+
+    /// Element-wise product
+
+    /// Products with zero tiles are zero tiles, products with diagonal
+    /// tiles are diagonal tiles, and products with compressed tiles are
+    /// computed only for the stored elements.
+    /// \param right The right-hand argument
+    /// \return The element-wise product of this tile and \c right
+    VariantTile_ mult(const VariantTile_& right) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      TA_ASSERT(pimpl_->range_ == right.pimpl_->range_);
+      const Kind left_kind = pimpl_->kind_;
+      const Kind right_kind = right.pimpl_->kind_;
+
+      if((left_kind == Kind::zero) || (right_kind == Kind::zero))
+        return VariantTile_(pimpl_->range_);
+      if((left_kind == Kind::diagonal) || (right_kind == Kind::diagonal)) {
+        std::vector<T> diagonal = diagonal_of();
+        const std::vector<T> other = right.diagonal_of();
+        for(size_type d = 0ul; d < diagonal.size(); ++d)
+          diagonal[d] *= other[d];
+        return from_diagonal(pimpl_->range_, std::move(diagonal));
+      }
+      if((left_kind == Kind::sparse) || (right_kind == Kind::sparse))
+        return from_sparse(to_sparse().mult(right.to_sparse()));
+      return from_dense(dense().mult(right.dense()));
+    }
+
+    VariantTile_ mult(const VariantTile_& right, const Permutation& perm) const {
+      return mult(right).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ mult(const VariantTile_& right, const Scalar factor) const {
+      return mult(right).scale(factor);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ mult(const VariantTile_& right, const Scalar factor,
+        const Permutation& perm) const
+    {
+      return mult(right).scale(factor, perm);
+    }
+
+    VariantTile_& mult_to(const VariantTile_& right) {
+      *pimpl_ = *mult(right).pimpl_;
+      return *this;
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_& mult_to(const VariantTile_& right, const Scalar factor) {
+      *pimpl_ = *mult(right, factor).pimpl_;
+      return *this;
+    }
+
+    // Scaling operations ----------------------------------------------------
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ scale(const Scalar factor) const {
+      TA_ASSERT(! empty());
+      const range_type& range = pimpl_->range_;
+      switch(pimpl_->kind_) {
+        case Kind::zero:
+          return VariantTile_(range);
+        case Kind::dense:
+          return VariantTile_(Impl{ Kind::dense, range,
+              pimpl_->dense_.scale(factor), sparse_type(), low_rank_type(),
+              std::vector<T>() });
+        case Kind::sparse:
+          return VariantTile_(Impl{ Kind::sparse, range, dense_type(),
+              pimpl_->sparse_.scale(factor), low_rank_type(), std::vector<T>() });
+        case Kind::low_rank:
+          return VariantTile_(Impl{ Kind::low_rank, range, dense_type(),
+              sparse_type(), pimpl_->low_rank_.scale(factor), std::vector<T>() });
+        default:
+          {
+            std::vector<T> diagonal = pimpl_->diagonal_;
+            for(T& x : diagonal)
+              x *= factor;
+            return VariantTile_(Impl{ Kind::diagonal, range, dense_type(),
+                sparse_type(), low_rank_type(), std::move(diagonal) });
+          }
+      }
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_ scale(const Scalar factor, const Permutation& perm) const {
+      return scale(factor).permute(perm);
+    }
+
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    VariantTile_& scale_to(const Scalar factor) {
+      *pimpl_ = *scale(factor).pimpl_;
+      return *this;
+    }
+
+    VariantTile_ neg() const { return scale(numeric_type(-1)); }
+
+    VariantTile_ neg(const Permutation& perm) const {
+      return scale(numeric_type(-1), perm);
+    }
+
+    VariantTile_& neg_to() { return scale_to(numeric_type(-1)); }
+
+    // Contraction operations ------------------------------------------------
+
+    /// Contract this tile with \c right
+
+    /// Products with zero tiles are zero tiles, products of two low-rank
+    /// tiles are formed in factored form, products of two dense tiles use
+    /// \c Tensor::gemm() , and products with diagonal or compressed tiles
+    /// use the compressed kernels of \c SparseTile , unless the other
+    /// argument is a low-rank tile. Other products are expanded to dense
+    /// tiles.
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of the product
+    /// \param gemm_helper The contraction plan
+    /// \return The scaled product of this tile and \c right
+    VariantTile_ gemm(const VariantTile_& right, const numeric_type factor,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_ASSERT(! empty());
+      TA_ASSERT(! right.empty());
+      const Kind left_kind = pimpl_->kind_;
+      const Kind right_kind = right.pimpl_->kind_;
+
+      if((left_kind == Kind::zero) || (right_kind == Kind::zero))
+        return VariantTile_(gemm_helper.make_result_range<range_type>(
+            pimpl_->range_, right.pimpl_->range_));
+      if((left_kind == Kind::low_rank) && (right_kind == Kind::low_rank))
+        return from_low_rank(pimpl_->low_rank_.gemm(right.pimpl_->low_rank_,
+            factor, gemm_helper));
+      if((left_kind == Kind::dense) && (right_kind == Kind::dense))
+        return from_dense(pimpl_->dense_.gemm(right.pimpl_->dense_, factor,
+            gemm_helper));
+      if((is_sparse_kind(left_kind) || is_sparse_kind(right_kind)) &&
+          (left_kind != Kind::low_rank) && (right_kind != Kind::low_rank))
+        return from_sparse(to_sparse().gemm(right.to_sparse(), factor,
+            gemm_helper));
+      return from_dense(dense().gemm(right.dense(), factor, gemm_helper));
+    }
+
+    /// Contract \c left and \c right and add the product to this tile
+
+    /// Dense products are accumulated in place in dense tiles.
+    /// \param left The left-hand argument
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor of the product
+    /// \param gemm_helper The contraction plan
+    /// \return A reference to this tile
+    VariantTile_& gemm(const VariantTile_& left, const VariantTile_& right,
+        const numeric_type factor, const math::GemmHelper& gemm_helper)
+    {
+      if((! empty()) && (pimpl_->kind_ == Kind::dense) &&
+          (left.kind() == Kind::dense) && (right.kind() == Kind::dense))
+      {
+        pimpl_->dense_.gemm(left.pimpl_->dense_, right.pimpl_->dense_, factor,
+            gemm_helper);
+        return *this;
+      }
+
+      VariantTile_ product = left.gemm(right, factor, gemm_helper);
+      if(empty())
+        pimpl_ = product.pimpl_;
+      else
+        add_to(product);
+      return *this;
+    }
+
+    // Reduction operations --------------------------------------------------
+
+    /// \return The sum of the elements of this tile
+    numeric_type sum() const {
+      TA_ASSERT(! empty());
+      switch(pimpl_->kind_) {
+        case Kind::zero: return numeric_type(0);
+        case Kind::dense: return pimpl_->dense_.sum();
+        case Kind::sparse: return pimpl_->sparse_.sum();
+        case Kind::low_rank: return pimpl_->low_rank_.sum();
+        default:
+          return std::accumulate(pimpl_->diagonal_.begin(),
+              pimpl_->diagonal_.end(), numeric_type(0));
+      }
+    }
+
+    /// \return The squared Frobenius norm of this tile
+    double squared_norm() const {
+      TA_ASSERT(! empty());
+      switch(pimpl_->kind_) {
+        case Kind::zero: return 0.0;
+        case Kind::dense: return pimpl_->dense_.squared_norm();
+        case Kind::sparse: return pimpl_->sparse_.squared_norm();
+        case Kind::low_rank: return pimpl_->low_rank_.squared_norm();
+        default:
+          {
+            double result = 0.0;
+            for(const T& x : pimpl_->diagonal_)
+              result += detail::norm(x);
+            return result;
+          }
+      }
+    }
+
+    /// \return The Frobenius norm of this tile
+    double norm() const { return std::sqrt(squared_norm()); }
+
+  }; // class VariantTile
+
+  /// Memory footprint of a variant tile
+
+  /// This overload is found by argument-dependent lookup, so it does not
+  /// need to be declared before the containers that count tiles.
+  /// \tparam T The element type
+  /// \param tile The tile
+  /// \return The size of the data of the representation of \c tile in bytes
+  template <typename T>
+  inline std::size_t tile_bytes(const VariantTile<T>& tile) {
+    typedef typename VariantTile<T>::Kind Kind;
+    if(tile.empty())
+      return 0ul;
+    switch(tile.kind()) {
+      case Kind::zero: return 0ul;
+      case Kind::dense: return tile.size() * sizeof(T);
+      case Kind::sparse: return tile_bytes(tile.sparse());
+      case Kind::low_rank: return tile_bytes(tile.low_rank());
+      default: return tile.diagonal().size() * sizeof(T);
+    }
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_VARIANT_TILE_H__INCLUDED
@@ -0,0 +1,460 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  zero_copy.h
+ *  Feb 6, 2017
+ *
+ */
+
+#ifndef TILEDARRAY_ZERO_COPY_H__INCLUDED
+#define TILEDARRAY_ZERO_COPY_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/range.h>
+#include <TiledArray/type_traits.h>
+#include <TiledArray/tensor/type_traits.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Zero-copy tile type trait
+
+    /// Tiles that satisfy this trait hold their elements in a single
+    /// contiguous buffer, so large tiles can be sent directly from that
+    /// buffer instead of being packed into an archive. By default, no tile
+    /// type is sent with the zero-copy protocol.
+    /// \tparam T The tile type
+    template <typename T>
+    struct is_zero_copy_tile : public std::false_type { };
+
+    template <typename T, typename A>
+    struct is_zero_copy_tile<Tensor<T, A> > :
+        public std::integral_constant<bool, is_numeric<T>::value> { };
+
+
+    /// The smallest tile, in bytes, that is sent with the zero-copy protocol
+
+    /// The threshold is read from the \c TA_ZERO_COPY_THRESHOLD environment
+    /// variable; the default threshold is 4 MB. A threshold of zero disables
+    /// zero-copy transfers.
+    /// \return The zero-copy threshold in bytes
+    inline std::size_t zero_copy_threshold() {
+      static const std::size_t threshold = [] () -> std::size_t {
+        const char* threshold = getenv("TA_ZERO_COPY_THRESHOLD");
+        if(threshold)
+          return std::strtoul(threshold, nullptr, 10);
+        return 4194304ul;
+      }();
+      return threshold;
+    }
+
+    /// Check that a tile with \c volume elements uses the zero-copy protocol
+
+    /// Smaller tiles are serialized with the standard archive, which is
+    /// cheaper than the extra message round trip of the zero-copy protocol.
+    /// \tparam Tile The tile type
+    /// \param volume The number of elements in the tile
+    /// \return \c true if \c Tile satisfies \c is_zero_copy_tile and the tile
+    /// size is between the zero-copy threshold and the largest MPI message.
+    template <typename Tile>
+    inline typename std::enable_if<is_zero_copy_tile<Tile>::value, bool>::type
+    is_zero_copy(const std::size_t volume) {
+      const std::size_t threshold = zero_copy_threshold();
+      const std::size_t bytes = volume * sizeof(typename Tile::value_type);
+      return (threshold != 0ul) && (bytes >= threshold) &&
+          (bytes <= std::size_t(std::numeric_limits<int>::max()));
+    }
+
+    template <typename Tile>
+    inline typename std::enable_if<! is_zero_copy_tile<Tile>::value, bool>::type
+    is_zero_copy(const std::size_t) { return false; }
+
+    /// Zero-copy transfer header
+
+    /// The header is sent with the active message that announces a zero-copy
+    /// transfer; it holds the MPI tag of the tile data message and the range
+    /// of the tile.
+    struct ZeroCopyHeader {
+      int tag; ///< The MPI tag of the tile data message
+      Range range; ///< The range of the tile
+
+      template <typename Archive>
+      void serialize(Archive& ar) { ar & tag & range; }
+    }; // struct ZeroCopyHeader
+
+    /// Start a zero-copy send of \c tile to \c dest
+
+    /// The tile data is sent with a nonblocking MPI send directly from the
+    /// tile buffer. The tile is held by a task until the send is complete, so
+    /// the caller does not need to keep it alive. The returned header must be
+    /// delivered to \c dest , where it is passed to \c zero_copy_recv() .
+    /// \tparam Tile The tile type
+    /// \param world The world that will be used to send the tile
+    /// \param dest The destination process
+    /// \param tile The tile to be sent
+    /// \return The header of the transfer
+    template <typename Tile>
+    ZeroCopyHeader zero_copy_send(World& world, const ProcessID dest, const Tile& tile) {
+      TA_ASSERT(! tile.empty());
+      TA_ASSERT(is_zero_copy<Tile>(tile.size()));
+
+      ZeroCopyHeader header;
+      header.tag = world.mpi.unique_tag();
+      header.range = tile.range();
+
+      SafeMPI::Request request = world.mpi.Isend(tile.data(),
+          tile.size() * sizeof(typename Tile::value_type), MPI_BYTE, dest,
+          header.tag);
+      world.taskq.add([] (SafeMPI::Request req, const Tile&)
+          { World::await(req); }, request, tile,
+          madness::TaskAttributes::hipri());
+
+      return header;
+    }
+
+    /// Receive a tile that was sent with \c zero_copy_send()
+
+    /// The tile is allocated with the range in \c header and the data is
+    /// received directly into the tile buffer. This function blocks until
+    /// the data has been received, so it should be run in a task.
+    /// \tparam Tile The tile type
+    /// \param world The world that will be used to receive the tile
+    /// \param source The process that sent the tile
+    /// \param header The header of the transfer
+    /// \return The received tile
+    template <typename Tile>
+    Tile zero_copy_recv(World* world, const ProcessID source,
+        const ZeroCopyHeader& header)
+    {
+      Tile tile(header.range);
+      SafeMPI::Request request = world->mpi.Irecv(tile.data(),
+          tile.size() * sizeof(typename Tile::value_type), MPI_BYTE, source,
+          header.tag);
+      World::await(request);
+      return tile;
+    }
+
+    /// The key of a zero-copy broadcast header
+
+    /// The header key pairs the broadcast key with the rank of the sender.
+    /// It is a distinct type from the broadcast key, so that headers do not
+    /// collide with other values that are sent with the same key.
+    typedef std::pair<madness::DistributedID, ProcessID> ZeroCopyKey;
+
+    template <typename Tile>
+    void zero_copy_bcast_children(World* world, const madness::DistributedID& key,
+        const std::vector<ProcessID>& children, const Tile& tile)
+    {
+      const ZeroCopyKey header_key(key, world->rank());
+      for(const ProcessID child : children)
+        world->gop.send(child, header_key, zero_copy_send(*world, child, tile));
+    }
+
+    /// Zero-copy broadcast algorithms
+    enum class BcastAlgorithm {
+      automatic, ///< Select the algorithm from the tile and group sizes
+      tree,      ///< Binary tree of \c madness::Group::make_tree()
+      binomial,  ///< Binomial tree
+      chain      ///< Pipelined chain of tile segments
+    }; // enum class BcastAlgorithm
+
+    /// The zero-copy broadcast algorithm
+
+    /// The algorithm is read from the \c TA_BCAST_ALGORITHM environment
+    /// variable, which may be \c auto (the default), \c tree , \c binomial ,
+    /// or \c chain .
+    /// \return The broadcast algorithm
+    inline BcastAlgorithm bcast_algorithm() {
+      static const BcastAlgorithm algorithm = [] () -> BcastAlgorithm {
+        const char* algorithm = getenv("TA_BCAST_ALGORITHM");
+        const std::string name = (algorithm ? algorithm : "auto");
+        if(name == "tree")
+          return BcastAlgorithm::tree;
+        if(name == "binomial")
+          return BcastAlgorithm::binomial;
+        if(name == "chain")
+          return BcastAlgorithm::chain;
+        return BcastAlgorithm::automatic;
+      }();
+      return algorithm;
+    }
+
+    /// The segment size of chain broadcasts
+
+    /// The size is read from the \c TA_BCAST_SEGMENT_BYTES environment
+    /// variable; the default is 256 KB. It must be the same on all processes.
+    /// \return The segment size in bytes
+    inline std::size_t bcast_segment_bytes() {
+      static const std::size_t segment = [] () -> std::size_t {
+        const char* segment = getenv("TA_BCAST_SEGMENT_BYTES");
+        if(segment)
+          return std::max<std::size_t>(std::strtoul(segment, nullptr, 10), 1ul);
+        return 262144ul;
+      }();
+      return segment;
+    }
+
+    /// Select a zero-copy broadcast algorithm
+
+    /// The times of a binomial tree and of a pipelined chain are modeled with
+    /// a latency that is equal to the transfer time of 16 KB. The binomial
+    /// tree takes \f$\lceil \log_2 n \rceil\f$ steps that each move the whole
+    /// tile, while the chain takes \f$n - 2 + s\f$ steps that each move one
+    /// of the \f$s\f$ segments, so the chain approaches the link bandwidth
+    /// for large tiles and the tree is faster for small groups and tiles.
+    /// \param algorithm The requested algorithm
+    /// \param group_size The number of processes in the group
+    /// \param bytes The size of the tile in bytes
+    /// \return \c algorithm , or the faster of the binomial tree and
+    /// the chain when \c algorithm is \c BcastAlgorithm::automatic
+    inline BcastAlgorithm select_bcast_algorithm(const BcastAlgorithm algorithm,
+        const ProcessID group_size, const std::size_t bytes)
+    {
+      if(algorithm != BcastAlgorithm::automatic)
+        return algorithm;
+
+      const double latency = 16384.0;
+      const double n = group_size;
+      const double m = bytes;
+      const double segment = std::min<double>(m, bcast_segment_bytes());
+      const double binomial = std::ceil(std::log2(n)) * (latency + m);
+      const double chain = (n - 2.0 + std::ceil(m / segment)) * (latency + segment);
+      return (chain < binomial ? BcastAlgorithm::chain : BcastAlgorithm::binomial);
+    }
+
+    /// Binomial broadcast tree
+
+    /// \param group_root The group rank of the root process
+    /// \param group_rank The group rank of this process
+    /// \param group_size The number of processes in the group
+    /// \param[out] parent The group rank of the parent, or -1 for the root
+    /// \param[out] children The group ranks of the children, in send order
+    inline void make_binomial_tree(const ProcessID group_root,
+        const ProcessID group_rank, const ProcessID group_size,
+        ProcessID& parent, std::vector<ProcessID>& children)
+    {
+      // Ranks relative to the root
+      const ProcessID rank = (group_rank - group_root + group_size) % group_size;
+
+      // The parent clears the highest set bit of the relative rank
+      ProcessID mask = 1;
+      while(mask <= rank)
+        mask <<= 1;
+      parent = (rank == 0 ? -1 :
+          ((rank - (mask >> 1)) + group_root) % group_size);
+
+      // The children set each higher bit, largest subtree first
+      children.clear();
+      for(ProcessID bit = mask; rank + bit < group_size; bit <<= 1)
+        children.push_back((rank + bit + group_root) % group_size);
+      std::reverse(children.begin(), children.end());
+    }
+
+    /// Wait for the send requests of a tile
+
+    /// \tparam Tile The tile type
+    /// \param requests The send requests
+    /// \param tile The tile that is sent, which is held until the sends are
+    /// complete
+    template <typename Tile>
+    void zero_copy_await(std::vector<SafeMPI::Request> requests, const Tile&) {
+      for(SafeMPI::Request& request : requests)
+        World::await(request);
+    }
+
+    /// Start a chain broadcast from the root
+
+    /// The tile is sent to the next process of the chain in segments of
+    /// \c bcast_segment_bytes() bytes.
+    /// \tparam Tile The tile type
+    /// \param world The world that will be used to send the tile
+    /// \param key The broadcast key
+    /// \param next The next process of the chain
+    /// \param tile The tile
+    template <typename Tile>
+    void zero_copy_chain_send(World* world, const madness::DistributedID& key,
+        const ProcessID next, const Tile& tile)
+    {
+      TA_ASSERT(! tile.empty());
+      ZeroCopyHeader header;
+      header.tag = world->mpi.unique_tag();
+      header.range = tile.range();
+
+      const std::size_t bytes = tile.size() * sizeof(typename Tile::value_type);
+      const std::size_t segment = bcast_segment_bytes();
+      const unsigned char* const data =
+          reinterpret_cast<const unsigned char*>(tile.data());
+      std::vector<SafeMPI::Request> requests;
+      for(std::size_t offset = 0ul; offset < bytes; offset += segment)
+        requests.push_back(world->mpi.Isend(data + offset,
+            std::min(segment, bytes - offset), MPI_BYTE, next, header.tag));
+      world->gop.send(next, ZeroCopyKey(key, world->rank()), header);
+      world->taskq.add(& zero_copy_await<Tile>, requests, tile,
+          madness::TaskAttributes::hipri());
+    }
+
+    /// Receive a tile from the previous process of a chain
+
+    /// Each segment is forwarded to the next process of the chain as soon as
+    /// it is received, so the transfers of all processes overlap. This
+    /// function blocks until the tile has been received, so it should be run
+    /// in a task.
+    /// \tparam Tile The tile type
+    /// \param world The world that will be used to receive the tile
+    /// \param key The broadcast key
+    /// \param source The previous process of the chain
+    /// \param next The next process of the chain, or -1 for the last process
+    /// \param header The header of the transfer
+    /// \return The received tile
+    template <typename Tile>
+    Tile zero_copy_chain_recv(World* world, const madness::DistributedID& key,
+        const ProcessID source, const ProcessID next, const ZeroCopyHeader& header)
+    {
+      Tile tile(header.range);
+      const std::size_t bytes = tile.size() * sizeof(typename Tile::value_type);
+      const std::size_t segment = bcast_segment_bytes();
+      unsigned char* const data = reinterpret_cast<unsigned char*>(tile.data());
+
+      // Post all receives; MPI delivers the segments in order
+      std::vector<SafeMPI::Request> recvs;
+      for(std::size_t offset = 0ul; offset < bytes; offset += segment)
+        recvs.push_back(world->mpi.Irecv(data + offset,
+            std::min(segment, bytes - offset), MPI_BYTE, source, header.tag));
+
+      if(next == -1) {
+        for(SafeMPI::Request& request : recvs)
+          World::await(request);
+        return tile;
+      }
+
+      ZeroCopyHeader next_header;
+      next_header.tag = world->mpi.unique_tag();
+      next_header.range = header.range;
+      world->gop.send(next, ZeroCopyKey(key, world->rank()), next_header);
+      std::vector<SafeMPI::Request> sends;
+      for(std::size_t s = 0ul, offset = 0ul; s < recvs.size(); ++s, offset += segment) {
+        World::await(recvs[s]);
+        sends.push_back(world->mpi.Isend(data + offset,
+            std::min(segment, bytes - offset), MPI_BYTE, next, next_header.tag));
+      }
+      world->taskq.add(& zero_copy_await<Tile>, sends, tile,
+          madness::TaskAttributes::hipri());
+      return tile;
+    }
+
+    /// Broadcast a tile to a process group
+
+    /// Tiles that satisfy \c is_zero_copy() are broadcast with \c algorithm ,
+    /// where each edge moves the tile data directly from the tile buffer; see
+    /// \c select_bcast_algorithm() . All other tiles are broadcast with
+    /// \c madness::WorldGopInterface::bcast() . All processes in \c group
+    /// must call this function with the same \c volume and \c algorithm .
+    /// \tparam Tile The tile type
+    /// \param world The world where the tile is broadcast
+    /// \param key The broadcast key
+    /// \param[in,out] tile The tile on the root process; on all other
+    /// processes it is set with the broadcast tile.
+    /// \param group_root The group rank of the root process
+    /// \param group The broadcast group
+    /// \param volume The number of elements in the tile
+    /// \param algorithm The broadcast algorithm
+    template <typename Tile>
+    typename std::enable_if<is_zero_copy_tile<Tile>::value>::type
+    zero_copy_bcast(World& world, const madness::DistributedID& key,
+        Future<Tile>& tile, const ProcessID group_root,
+        const madness::Group& group, const std::size_t volume,
+        BcastAlgorithm algorithm = bcast_algorithm())
+    {
+      if(! is_zero_copy<Tile>(volume)) {
+        world.gop.bcast(key, tile, group_root, group);
+        return;
+      }
+      if(group.size() == 1)
+        return;
+
+      algorithm = select_bcast_algorithm(algorithm, group.size(),
+          volume * sizeof(typename Tile::value_type));
+
+      if(algorithm == BcastAlgorithm::chain) {
+        const ProcessID rank = group.rank();
+        const ProcessID next_rank = (rank + 1) % group.size();
+        const ProcessID next = (next_rank == group_root ? -1 :
+            group.world_rank(next_rank));
+        if(rank == group_root) {
+          world.taskq.add(& zero_copy_chain_send<Tile>, & world, key, next,
+              tile, madness::TaskAttributes::hipri());
+        } else {
+          const ProcessID source =
+              group.world_rank((rank + group.size() - 1) % group.size());
+          Future<ZeroCopyHeader> header =
+              world.gop.recv<ZeroCopyHeader>(source, ZeroCopyKey(key, source));
+          tile.set(world.taskq.add(& zero_copy_chain_recv<Tile>, & world, key,
+              source, next, header, madness::TaskAttributes::hipri()));
+        }
+        return;
+      }
+
+      ProcessID parent = -1;
+      std::vector<ProcessID> children;
+      if(algorithm == BcastAlgorithm::binomial) {
+        make_binomial_tree(group_root, group.rank(), group.size(), parent, children);
+        if(parent != -1)
+          parent = group.world_rank(parent);
+        for(ProcessID& child : children)
+          child = group.world_rank(child);
+      } else {
+        ProcessID child0 = -1, child1 = -1;
+        group.make_tree(group_root, parent, child0, child1);
+        for(const ProcessID child : { child0, child1 })
+          if(child != -1)
+            children.push_back(child);
+      }
+
+      if(parent != -1) {
+        // Receive the tile from the parent, once its header has arrived
+        Future<ZeroCopyHeader> header =
+            world.gop.recv<ZeroCopyHeader>(parent, ZeroCopyKey(key, parent));
+        tile.set(world.taskq.add(& zero_copy_recv<Tile>, & world, parent,
+            header, madness::TaskAttributes::hipri()));
+      }
+
+      if(! children.empty())
+        world.taskq.add(& zero_copy_bcast_children<Tile>, & world, key,
+            children, tile, madness::TaskAttributes::hipri());
+    }
+
+    template <typename Tile>
+    typename std::enable_if<! is_zero_copy_tile<Tile>::value>::type
+    zero_copy_bcast(World& world, const madness::DistributedID& key,
+        Future<Tile>& tile, const ProcessID group_root,
+        const madness::Group& group, const std::size_t,
+        const BcastAlgorithm = bcast_algorithm())
+    {
+      world.gop.bcast(key, tile, group_root, group);
+    }
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_ZERO_COPY_H__INCLUDED
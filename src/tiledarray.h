@@ -25,35 +25,76 @@
 #include <TiledArray/madness.h>
 
 // Array class
+#include <TiledArray/fixed_range.h>
 #include <TiledArray/tensor.h>
 #include <TiledArray/tile.h>
 
 // Array policy classes
 #include <TiledArray/policies/dense_policy.h>
 #include <TiledArray/policies/sparse_policy.h>
+#include <TiledArray/policies/band_policy.h>
+#include <TiledArray/compact_shape.h>
 
 // Expression functionality
 #include <TiledArray/expressions/scal_expr.h>
 #include <TiledArray/expressions/tsr_expr.h>
+#include <TiledArray/expressions/index_list.h>
+#include <TiledArray/expressions/sum_over_expr.h>
+#include <TiledArray/expressions/expr_batch.h>
+#include <TiledArray/expressions/expr_plan.h>
 #include <TiledArray/conversions/sparse_to_dense.h>
 #include <TiledArray/conversions/dense_to_sparse.h>
 #include <TiledArray/conversions/to_new_tile_type.h>
 #include <TiledArray/conversions/truncate.h>
 #include <TiledArray/conversions/foreach.h>
 #include <TiledArray/conversions/make_array.h>
+#include <TiledArray/conversions/coo.h>
+#include <TiledArray/conversions/retile.h>
+#include <TiledArray/conversions/reshape.h>
+#include <TiledArray/conversions/delta.h>
+#include <TiledArray/conversions/broadcast_op.h>
+#include <TiledArray/conversions/permute.h>
 
 // Special Arrays
 #include <TiledArray/special/diagonal_array.h>
 
 // Process maps
 #include <TiledArray/pmap/hash_pmap.h>
+#include <TiledArray/pmap/hierarchical_pmap.h>
+#include <TiledArray/pmap/morton_pmap.h>
 #include <TiledArray/pmap/replicated_pmap.h>
+#include <TiledArray/pmap/sparse_pmap.h>
+#include <TiledArray/pmap/view_pmap.h>
 
 // Utility functionality
 #include <TiledArray/conversions/eigen.h>
+#include <TiledArray/conversions/block_cyclic.h>
+#include <TiledArray/conversions/binary_input.h>
+#include <TiledArray/checkpoint.h>
+#include <TiledArray/sub_world.h>
+#include <TiledArray/mapped_array.h>
+#include <TiledArray/node_replicated.h>
+#include <TiledArray/replica_cache.h>
+#include <TiledArray/memory_governor.h>
+#include <TiledArray/low_rank_tile.h>
+#include <TiledArray/sparse_tile.h>
+#include <TiledArray/variant_tile.h>
+#include <TiledArray/symmetric_array.h>
+#include <TiledArray/symm/point_group.h>
+#include <TiledArray/symm/spin.h>
+#include <TiledArray/batched_contract.h>
+#include <TiledArray/split_contract.h>
+#include <TiledArray/permuted_array.h>
+#include <TiledArray/df_exchange.h>
+#include <TiledArray/fused_contract.h>
+#include <TiledArray/tiling_tuner.h>
+#include <TiledArray/cuda_tensor.h>
 
 // Linear algebra
+#include <TiledArray/algebra/cholesky.h>
 #include <TiledArray/algebra/conjgrad.h>
+#include <TiledArray/algebra/davidson.h>
+#include <TiledArray/algebra/orthogonalize.h>
 #include "TiledArray/dist_array.h"
 
 #ifdef TILEDARRAY_HAS_ELEMENTAL
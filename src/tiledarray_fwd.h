@@ -21,11 +21,7 @@
 #define TILEDARRAY_FWD_H__INCLUDED
 
 #include <complex>
-
-namespace Eigen { // Eigen Alligned allocator for TA::Tensor
-  template<class>
-  class aligned_allocator;
-} // namespace Eigen
+#include <TiledArray/tensor/type_traits.h>
 
 namespace TiledArray {
 
@@ -37,7 +33,7 @@ namespace TiledArray {
   template<typename, typename>
   class Tensor;
 
-  typedef Tensor<double, Eigen::aligned_allocator<double> > TensorD;
+  typedef Tensor<double, PoolAllocator<double> > TensorD;
   typedef Tensor<int, Eigen::aligned_allocator<int> > TensorI;
   typedef Tensor<float, Eigen::aligned_allocator<float> > TensorF;
   typedef Tensor<long, Eigen::aligned_allocator<long> > TensorL;
@@ -50,7 +46,8 @@ namespace TiledArray {
 
   // Dense Array Typedefs
   template <typename T>
-  using TArray = DistArray<Tensor<T, Eigen::aligned_allocator<T> >, DensePolicy>;
+  using TArray = DistArray<Tensor<T,
+      typename detail::default_tensor_allocator<T>::type>, DensePolicy>;
   typedef TArray<double>                  TArrayD;
   typedef TArray<int>                     TArrayI;
   typedef TArray<float>                   TArrayF;
@@ -60,7 +57,8 @@ namespace TiledArray {
 
   // Sparse Array Typedefs
   template <typename T>
-  using TSpArray = DistArray<Tensor<T, Eigen::aligned_allocator<T> >, SparsePolicy>;
+  using TSpArray = DistArray<Tensor<T,
+      typename detail::default_tensor_allocator<T>::type>, SparsePolicy>;
   typedef TSpArray<double>                TSpArrayD;
   typedef TSpArray<int>                   TSpArrayI;
   typedef TSpArray<float>                 TSpArrayF;
@@ -69,7 +67,8 @@ namespace TiledArray {
   typedef TSpArray<std::complex<float> >  TSpArrayC;
 
   // type alias for backward compatibility: the old Array has static type, DistArray is rank-polymorphic
-  template <typename T, unsigned int = 0, typename Tile = Tensor<T, Eigen::aligned_allocator<T> >, typename Policy = DensePolicy>
+  template <typename T, unsigned int = 0, typename Tile = Tensor<T,
+      typename detail::default_tensor_allocator<T>::type>, typename Policy = DensePolicy>
   using Array = DistArray<Tile, Policy>;
 
 } // namespace TiledArray
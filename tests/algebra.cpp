@@ -0,0 +1,364 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TiledArray/algebra/diis.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct AlgebraFixture {
+
+  AlgebraFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 10 }, { 0, 4, 9 } },
+    trange1{ 0, 5, 12, 20 }
+  { }
+
+  ~AlgebraFixture() {
+    world.gop.fence();
+  }
+
+  /// An array with known, non-trivial values
+  template <typename T>
+  TArray<T> make_array(const double seed) {
+    TArray<T> array(world, trange);
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      Tensor<T> tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = T(std::sin(seed + 0.37 * double(i) + 1.1 * double(it.ordinal())));
+      *it = tile;
+    }
+    return array;
+  }
+
+  /// Check that two arrays have the same elements
+
+  /// \param tolerance The absolute tolerance
+  static void check(const TArrayD& result, const TArrayD& reference,
+      const double tolerance)
+  {
+    for(auto it = reference.begin(); it != reference.end(); ++it) {
+      const TensorD tile = result.find(it.ordinal()).get();
+      const TensorD ref = it->get();
+      BOOST_REQUIRE_EQUAL(tile.size(), ref.size());
+      for(std::size_t i = 0ul; i < ref.size(); ++i)
+        BOOST_CHECK_SMALL(tile[i] - ref[i], tolerance);
+    }
+  }
+
+  /// An element of a symmetric, diagonally dominant matrix
+  static double matrix_element(const std::size_t i, const std::size_t j) {
+    return (i == j ? double(i + 1ul) :
+        0.1 / double(1ul + (i > j ? i - j : j - i)));
+  }
+
+  /// A matrix with the elements of \c matrix_element()
+  TArrayD make_matrix(const TiledRange& tr) {
+    TArrayD array(world, tr);
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      const auto* lo = tile.range().lobound_data();
+      const auto* up = tile.range().upbound_data();
+      for(std::size_t i = lo[0]; i < up[0]; ++i)
+        for(std::size_t j = lo[1]; j < up[1]; ++j)
+          tile(i, j) = matrix_element(i, j);
+      *it = tile;
+    }
+    return array;
+  }
+
+  World& world;
+  TiledRange trange;
+  TiledRange1 trange1;
+}; // struct AlgebraFixture
+
+BOOST_FIXTURE_TEST_SUITE( algebra_suite, AlgebraFixture )
+
+BOOST_AUTO_TEST_CASE( linear_combination_axpy )
+{
+  const std::vector<TArrayD> x = { make_array<double>(0.0),
+      make_array<double>(1.0), make_array<double>(2.0) };
+  const std::vector<double> c = { 0.5, -2.0, 3.0 };
+
+  TArrayD y;
+  BOOST_REQUIRE_NO_THROW(TiledArray::linear_combination(x.begin(), x.end(), c, y));
+
+  // Check against the combination computed with axpy
+  TArrayD reference;
+  reference("i,j") = c[0] * x[0]("i,j");
+  axpy(reference, c[1], x[1]);
+  axpy(reference, c[2], x[2]);
+  check(y, reference, 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( linear_combination_mixed_precision )
+{
+  const std::vector<TArrayF> x = { make_array<float>(0.0),
+      make_array<float>(1.0), make_array<float>(2.0) };
+  const std::vector<double> c = { 0.5, -2.0, 3.0 };
+
+  // Single precision arrays are combined into a double precision array
+  TArrayD y;
+  BOOST_REQUIRE_NO_THROW(TiledArray::linear_combination(x.begin(), x.end(), c, y));
+
+  // Check against the combination of the widened arrays computed with axpy
+  std::vector<TArrayD> wide;
+  for(const TArrayF& array : x)
+    wide.push_back(to_new_tile_type(array,
+        [] (const TensorF& tile) { return TensorD(tile); }));
+  TArrayD reference;
+  reference("i,j") = c[0] * wide[0]("i,j");
+  axpy(reference, c[1], wide[1]);
+  axpy(reference, c[2], wide[2]);
+  check(y, reference, 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( diis_extrapolate )
+{
+  const TArrayD x0 = make_array<double>(0.0);
+  const TArrayD x1 = make_array<double>(0.5);
+  const TArrayD e0 = make_array<double>(1.0);
+  const TArrayD e1 = make_array<double>(1.3);
+
+  // The coefficients that minimize |c0 e0 + c1 e1| with c0 + c1 = 1
+  const double b00 = dot_product(e0, e0);
+  const double b01 = dot_product(e0, e1);
+  const double b11 = dot_product(e1, e1);
+  const double c1 = (b00 - b01) / (b00 - 2.0 * b01 + b11);
+  const double c0 = 1.0 - c1;
+
+  // The extrapolation computed with axpy, which adds the combination of the
+  // errors to the input error
+  TArrayD x_reference;
+  x_reference("i,j") = c0 * x0("i,j");
+  axpy(x_reference, c1, x1);
+  TArrayD e_reference;
+  e_reference("i,j") = e1("i,j");
+  axpy(e_reference, c0, e0);
+  axpy(e_reference, c1, e1);
+
+  // Check the extrapolation with full precision and single precision history
+  for(const DIISStorage storage : { DIISStorage::full, DIISStorage::reduced }) {
+    DIIS<TArrayD> diis(1, 5);
+    diis.set_storage(storage);
+    const double tolerance = (storage == DIISStorage::full ? 1.0e-10 : 1.0e-5);
+
+    TArrayD x = copy(x0);
+    TArrayD e = copy(e0);
+    diis.extrapolate(x, e, true);
+
+    x = copy(x1);
+    e = copy(e1);
+    diis.extrapolate(x, e, true);
+
+    check(x, x_reference, tolerance);
+    check(e, e_reference, tolerance);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( davidson_lowest_roots )
+{
+  const std::size_t n = trange1.extent();
+  const TArrayD a = make_matrix(TiledRange{ trange1, trange1 });
+
+  // Guesses near the unit vectors of the two smallest diagonal elements
+  std::vector<TArrayD> x;
+  for(std::size_t root = 0ul; root < 2ul; ++root) {
+    TArrayD guess(world, TiledRange{ trange1 });
+    for(auto it = guess.begin(); it != guess.end(); ++it) {
+      TensorD tile(it.make_range());
+      const std::size_t lo = tile.range().lobound_data()[0];
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = (lo + i == root ? 1.0 : 0.01 * std::cos(double(lo + i)));
+      *it = tile;
+    }
+    x.push_back(guess);
+  }
+
+  const DavidsonSolver<TArrayD>::sigma_type sigma =
+      [&a] (const std::vector<TArrayD>& v, std::vector<TArrayD>& av) {
+        for(std::size_t i = 0ul; i < v.size(); ++i)
+          av[i]("i") = a("i,j") * v[i]("j");
+      };
+
+  // Diagonal (Jacobi) preconditioner
+  const DavidsonSolver<TArrayD>::preconditioner_type preconditioner =
+      [] (const std::vector<double>& shift, std::vector<TArrayD>& v) {
+        for(std::size_t r = 0ul; r < v.size(); ++r) {
+          TArrayD result(v[r].world(), v[r].trange());
+          for(auto it = result.begin(); it != result.end(); ++it) {
+            const TensorD tile = v[r].find(it.ordinal()).get();
+            TensorD scaled(tile.range());
+            const std::size_t lo = tile.range().lobound_data()[0];
+            for(std::size_t i = 0ul; i < tile.size(); ++i) {
+              const double d = matrix_element(lo + i, lo + i) - shift[r];
+              scaled[i] = tile[i] / (std::abs(d) > 1.0e-8 ? d : 1.0e-8);
+            }
+            *it = scaled;
+          }
+          v[r] = result;
+        }
+      };
+
+  DavidsonSolver<TArrayD> solver(10u, 50u, 1.0e-8);
+  std::vector<double> theta;
+  BOOST_REQUIRE_NO_THROW(theta = solver(sigma, preconditioner, x));
+  BOOST_REQUIRE_EQUAL(theta.size(), 2ul);
+  BOOST_REQUIRE_EQUAL(x.size(), 2ul);
+  BOOST_CHECK_LT(solver.iterations(), 50u);
+
+  // Check the eigenvalues against the dense eigensolver
+  Eigen::MatrixXd reference(n, n);
+  for(std::size_t i = 0ul; i < n; ++i)
+    for(std::size_t j = 0ul; j < n; ++j)
+      reference(i, j) = matrix_element(i, j);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(reference);
+  for(std::size_t root = 0ul; root < 2ul; ++root) {
+    BOOST_CHECK_SMALL(theta[root] - eig.eigenvalues()(root), 1.0e-10);
+
+    // The eigenvectors are normalized and satisfy A x = theta x
+    BOOST_CHECK_SMALL(dot_product(x[root], x[root]) - 1.0, 1.0e-10);
+    TArrayD residual;
+    residual("i") = a("i,j") * x[root]("j") - theta[root] * x[root]("i");
+    BOOST_CHECK_SMALL(norm2(residual), 1.0e-7);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( orthonormalize_arrays )
+{
+  const std::vector<TArrayD> v = { make_array<double>(0.0),
+      make_array<double>(0.2), make_array<double>(2.0) };
+
+  std::vector<TArrayD> q;
+  BOOST_REQUIRE_NO_THROW(q = orthonormalize(v));
+  BOOST_REQUIRE_EQUAL(q.size(), v.size());
+
+  // The arrays are orthonormal
+  const std::vector<double> products = inner_products(q, q);
+  for(std::size_t i = 0ul; i < q.size(); ++i)
+    for(std::size_t j = 0ul; j < q.size(); ++j)
+      BOOST_CHECK_SMALL(products[i * q.size() + j] - (i == j ? 1.0 : 0.0), 1.0e-10);
+
+  // The first array is normalized, and the others are orthogonal to the
+  // arrays before them, so that q spans v in order
+  TArrayD q0;
+  q0("i,j") = (1.0 / norm2(v[0])) * v[0]("i,j");
+  check(q[0], q0, 1.0e-10);
+  const std::vector<double> qv = inner_products(q, v);
+  for(std::size_t i = 1ul; i < q.size(); ++i)
+    for(std::size_t j = 0ul; j < i; ++j)
+      BOOST_CHECK_SMALL(qv[i * v.size() + j], 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( cholesky_qr2_factors )
+{
+  // A tall-skinny matrix with one column tile
+  const std::size_t n = 3ul;
+  TArrayD a(world, TiledRange{ trange1, TiledRange1{ 0, n } });
+  for(auto it = a.begin(); it != a.end(); ++it) {
+    TensorD tile(it.make_range());
+    const auto* lo = tile.range().lobound_data();
+    const auto* up = tile.range().upbound_data();
+    for(std::size_t i = lo[0]; i < up[0]; ++i)
+      for(std::size_t j = lo[1]; j < up[1]; ++j)
+        tile(i, j) = std::sin(0.3 * double(i) + 1.7 * double(j)) + (i == j ? 1.0 : 0.0);
+    *it = tile;
+  }
+
+  Eigen::MatrixXd r;
+  TArrayD q;
+  BOOST_REQUIRE_NO_THROW(q = cholesky_qr2(a, &r));
+  BOOST_REQUIRE_EQUAL(r.rows(), long(n));
+  BOOST_REQUIRE_EQUAL(r.cols(), long(n));
+
+  // Check that Q^T Q = I and Q R = A, one tile row at a time
+  Eigen::MatrixXd qtq = Eigen::MatrixXd::Zero(n, n);
+  for(auto it = a.begin(); it != a.end(); ++it) {
+    const TensorD a_tile = it->get();
+    const TensorD q_tile = q.find(it.ordinal()).get();
+    const std::size_t m = a_tile.range().extent_data()[0];
+    const auto a_map = eigen_map(a_tile, m, n);
+    const auto q_map = eigen_map(q_tile, m, n);
+    qtq += q_map.transpose() * q_map;
+    const Eigen::MatrixXd qr = q_map * r;
+    for(std::size_t i = 0ul; i < m; ++i)
+      for(std::size_t j = 0ul; j < n; ++j)
+        BOOST_CHECK_SMALL(qr(i, j) - a_map(i, j), 1.0e-10);
+  }
+  world.gop.sum(qtq.data(), n * n);
+  for(std::size_t i = 0ul; i < n; ++i)
+    for(std::size_t j = 0ul; j < n; ++j)
+      BOOST_CHECK_SMALL(qtq(i, j) - (i == j ? 1.0 : 0.0), 1.0e-10);
+
+  // R is upper triangular
+  for(std::size_t i = 1ul; i < n; ++i)
+    for(std::size_t j = 0ul; j < i; ++j)
+      BOOST_CHECK_EQUAL(r(i, j), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( cholesky_factor )
+{
+  const TArrayD a = make_matrix(TiledRange{ trange1, trange1 });
+
+  TArrayD l;
+  BOOST_REQUIRE_NO_THROW(l = cholesky(a));
+
+  // L is lower triangular
+  for(auto it = l.begin(); it != l.end(); ++it) {
+    const TensorD tile = it->get();
+    const auto* lo = tile.range().lobound_data();
+    const auto* up = tile.range().upbound_data();
+    for(std::size_t i = lo[0]; i < up[0]; ++i)
+      for(std::size_t j = std::max(i + 1ul, lo[1]); j < up[1]; ++j)
+        BOOST_CHECK_EQUAL(tile(i, j), 0.0);
+  }
+
+  // L L^T = A
+  TArrayD llt;
+  llt("i,j") = l("i,k") * l("j,k");
+  check(llt, a, 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( cholesky_triangular_solve )
+{
+  const TArrayD l = cholesky(make_matrix(TiledRange{ trange1, trange1 }));
+  TArrayD b(world, TiledRange{ trange1, TiledRange1{ 0, 2, 4 } });
+  for(auto it = b.begin(); it != b.end(); ++it) {
+    TensorD tile(it.make_range());
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      tile[i] = std::cos(0.7 * double(i) + 1.3 * double(it.ordinal()));
+    *it = tile;
+  }
+
+  // L X = B
+  TArrayD x;
+  BOOST_REQUIRE_NO_THROW(x = triangular_solve(l, b));
+  TArrayD lx;
+  lx("i,j") = l("i,k") * x("k,j");
+  check(lx, b, 1.0e-10);
+
+  // L^T Y = B
+  TArrayD y;
+  BOOST_REQUIRE_NO_THROW(y = triangular_solve(l, b, true));
+  TArrayD lty;
+  lty("i,j") = l("k,i") * y("k,j");
+  check(lty, b, 1.0e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
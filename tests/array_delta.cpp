@@ -0,0 +1,122 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  array_delta.cpp
+ *  Mar 24, 2017
+ *
+ */
+
+#include "TiledArray/conversions/delta.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct ArrayDeltaFixture {
+
+  ArrayDeltaFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10, 14 } }
+  { }
+
+  ~ArrayDeltaFixture() {
+    world.gop.fence();
+  }
+
+  /// A sparse array with known values and non-zero diagonal tiles
+  TSpArrayD make_array() {
+    Tensor<float> norms(trange.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; i < 3ul; ++i)
+      norms(i, i) = 100.0f;
+    norms(0, 2) = 100.0f;
+    TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = double(it.ordinal() * 100ul + i + 1ul);
+      *it = tile;
+    }
+    return array;
+  }
+
+  /// Check that two arrays have the same tiles
+  static void check(const TSpArrayD& result, const TSpArrayD& reference) {
+    for(std::size_t i = 0ul; i < reference.size(); ++i) {
+      if(reference.is_zero(i)) {
+        if(! result.is_zero(i))
+          BOOST_CHECK_SMALL(result.find(i).get().norm(), 1.0e-10);
+        continue;
+      }
+      BOOST_REQUIRE(! result.is_zero(i));
+      const TensorD tile = result.find(i).get();
+      const TensorD ref = reference.find(i).get();
+      for(std::size_t j = 0ul; j < ref.size(); ++j)
+        BOOST_CHECK_CLOSE(tile[j], ref[j], 1.0e-10);
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct ArrayDeltaFixture
+
+BOOST_FIXTURE_TEST_SUITE( array_delta_suite, ArrayDeltaFixture )
+
+BOOST_AUTO_TEST_CASE( delta )
+{
+  TSpArrayD previous = make_array();
+  TSpArrayD current = previous.clone();
+  if(current.is_local(0))
+    current.find(0).get()[0] += 1.0;
+  world.gop.fence();
+
+  TSpArrayD delta = array_delta(current, previous);
+  for(std::size_t i = 0ul; i < delta.size(); ++i)
+    BOOST_CHECK_EQUAL(delta.is_zero(i), i != 0ul);
+  const TensorD tile = delta.find(0).get();
+  BOOST_CHECK_EQUAL(tile[0], 1.0);
+  for(std::size_t j = 1ul; j < tile.size(); ++j)
+    BOOST_CHECK_EQUAL(tile[j], 0.0);
+
+  check(apply_delta(previous, delta), current);
+}
+
+BOOST_AUTO_TEST_CASE( incremental_contraction )
+{
+  TSpArrayD v = make_array();
+  TSpArrayD t = make_array();
+  TSpArrayD w;
+  w("i,j") = v("i,k") * t("k,j");
+
+  DeltaTracker<TensorD> tracker;
+  tracker.update(v);
+
+  TSpArrayD v_new = v.clone();
+  if(v_new.is_local(4))
+    v_new.find(4).get()[3] = -2.0;
+  world.gop.fence();
+
+  TSpArrayD dv = tracker.update(v_new);
+  TSpArrayD dw;
+  dw("i,j") = dv("i,k") * t("k,j");
+  TSpArrayD w_new = apply_delta(w, dw);
+
+  TSpArrayD reference;
+  reference("i,j") = v_new("i,k") * t("k,j");
+  check(w_new, reference);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
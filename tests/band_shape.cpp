@@ -0,0 +1,171 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  band_shape.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/band_shape.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct BandShapeFixture {
+  BandShapeFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 2, 5, 7, 10, 12, 15 }, { 0, 3, 5, 8, 10, 13, 15 } },
+    tiles(trange.tiles_range())
+  { }
+
+  ~BandShapeFixture() {
+    world.gop.fence();
+  }
+
+  /// Check that a shape has the non-zero tiles of a predicate
+  template <typename Pred>
+  static void check(const BandShape& shape, const Range& range, const Pred& pred) {
+    BOOST_REQUIRE(shape.range() == range);
+    std::size_t nonzero = 0ul;
+    for(std::size_t i = 0ul; i < range.extent_data()[0]; ++i)
+      for(std::size_t j = 0ul; j < range.extent_data()[1]; ++j) {
+        BOOST_CHECK_EQUAL(shape.is_zero({ i, j }), ! pred(i, j));
+        nonzero += (pred(i, j) ? 1ul : 0ul);
+      }
+    BOOST_CHECK_CLOSE(shape.sparsity(),
+        1.0f - float(nonzero) / float(range.volume()), 1.0e-4);
+  }
+
+  /// Fill the non-zero tiles of an array, and the same tiles of a dense array
+  template <typename Array>
+  static void fill(Array& array, TArrayD& dense) {
+    for(std::size_t i = 0ul; i < array.size(); ++i) {
+      if(! dense.is_local(i))
+        continue;
+      TensorD tile(dense.trange().make_tile_range(i), 0.0);
+      if(! array.is_zero(i))
+        for(std::size_t x = 0ul; x < tile.size(); ++x)
+          tile[x] = double((i + x) % 7ul) - 3.0;
+      if(array.is_local(i) && ! array.is_zero(i))
+        array.set(i, tile.clone());
+      dense.set(i, tile);
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+  Range tiles;
+}; // struct BandShapeFixture
+
+BOOST_FIXTURE_TEST_SUITE( band_shape_suite, BandShapeFixture )
+
+BOOST_AUTO_TEST_CASE( constructors )
+{
+  BOOST_CHECK(BandShape().empty());
+
+  const BandShape band = BandShape::band(tiles, 1ul, 2ul);
+  BOOST_CHECK(! band.empty());
+  BOOST_CHECK(band.validate(tiles));
+  BOOST_CHECK(band.is_monotone());
+  check(band, tiles, [] (std::size_t i, std::size_t j) {
+    return (j + 1ul >= i) && (j <= i + 2ul); });
+
+  const BandShape blocks = BandShape::block_diagonal(tiles, { 2ul, 3ul, 1ul });
+  BOOST_CHECK(blocks.is_monotone());
+  check(blocks, tiles, [] (std::size_t i, std::size_t j) {
+    const auto block = [] (std::size_t x) { return (x < 2ul ? 0 : (x < 5ul ? 1 : 2)); };
+    return block(i) == block(j); });
+
+  // Explicit ranges, with an empty row
+  const BandShape rows(tiles, { 4ul, 0ul, 0ul, 1ul, 2ul, 5ul },
+      { 6ul, 2ul, 0ul, 3ul, 4ul, 6ul });
+  BOOST_CHECK(! rows.is_monotone());
+  check(rows, tiles, [&rows] (std::size_t i, std::size_t j) {
+    return (j >= rows.first(i)) && (j < rows.last(i)); });
+}
+
+BOOST_AUTO_TEST_CASE( add_mult_perm )
+{
+  const BandShape lower = BandShape::band(tiles, 2ul, 0ul);
+  const BandShape upper = BandShape::band(tiles, 0ul, 1ul);
+
+  check(lower.add(upper), tiles, [] (std::size_t i, std::size_t j) {
+    return (j + 2ul >= i) && (j <= i + 1ul); });
+  check(lower.mult(upper), tiles, [] (std::size_t i, std::size_t j) {
+    return i == j; });
+  check(lower.add(1.0), tiles, [] (std::size_t, std::size_t) { return true; });
+
+  // The transpose of a lower band is an upper band, for monotone and other rows
+  check(lower.perm(Permutation{ 1, 0 }), tiles, [] (std::size_t i, std::size_t j) {
+    return (i + 2ul >= j) && (i <= j); });
+  const BandShape rows(tiles, { 4ul, 0ul, 0ul, 1ul, 2ul, 5ul },
+      { 6ul, 2ul, 0ul, 3ul, 4ul, 6ul });
+  check(rows.perm(Permutation{ 1, 0 }), tiles, [&rows] (std::size_t i, std::size_t j) {
+    return (i >= rows.first(j)) && (i < rows.last(j)); });
+
+  const BandShape block = lower.block(std::vector<std::size_t>{ 1ul, 2ul },
+      std::vector<std::size_t>{ 5ul, 6ul });
+  check(block, Range(4ul, 4ul), [] (std::size_t i, std::size_t j) {
+    return (j + 2ul + 2ul >= i + 1ul) && (j + 2ul <= i + 1ul); });
+}
+
+BOOST_AUTO_TEST_CASE( gemm )
+{
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  // The product of bands is a band with the sum of their widths
+  const BandShape band = BandShape::band(tiles, 1ul, 1ul);
+  check(band.gemm(band, 1.0, gemm_helper), tiles, [] (std::size_t i, std::size_t j) {
+    return (j + 2ul >= i) && (j <= i + 2ul); });
+
+  // The product of block-diagonal shapes keeps the blocks
+  const BandShape blocks = BandShape::block_diagonal(tiles, { 2ul, 3ul, 1ul });
+  check(blocks.gemm(blocks, 1.0, gemm_helper), tiles,
+      [&blocks] (std::size_t i, std::size_t j) { return ! blocks.is_zero({ i, j }); });
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  DistArray<TensorD, BandPolicy> a(world, trange, BandShape::band(tiles, 1ul, 0ul));
+  DistArray<TensorD, BandPolicy> b(world, trange, BandShape::band(tiles, 0ul, 2ul));
+  TArrayD a_dense(world, trange), b_dense(world, trange);
+  fill(a, a_dense);
+  fill(b, b_dense);
+
+  DistArray<TensorD, BandPolicy> c;
+  TArrayD c_dense;
+  c("i,j") = a("i,k") * b("k,j");
+  c_dense("i,j") = a_dense("i,k") * b_dense("k,j");
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    if(! (c.is_local(i) && c_dense.is_local(i)))
+      continue;
+    const TensorD ref = c_dense.find(i).get();
+    if(c.is_zero(i)) {
+      for(std::size_t x = 0ul; x < ref.size(); ++x)
+        BOOST_CHECK_EQUAL(ref[x], 0.0);
+    } else {
+      const TensorD tile = c.find(i).get();
+      for(std::size_t x = 0ul; x < ref.size(); ++x)
+        BOOST_CHECK_CLOSE(tile[x], ref[x], 1.0e-10);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
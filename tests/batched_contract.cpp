@@ -0,0 +1,152 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  batched_contract.cpp
+ *  Mar 6, 2017
+ *
+ */
+
+#include "TiledArray/batched_contract.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct BatchedContractFixture {
+
+  BatchedContractFixture() :
+    world(* GlobalFixture::world),
+    i{ 0, 2, 5 }, j{ 0, 3, 4, 7 }, k{ 0, 1, 4 }, a{ 0, 2, 6 }
+  { }
+
+  ~BatchedContractFixture() {
+    world.gop.fence();
+  }
+
+  /// An element of the left-hand array, with indices (i,j,k)
+  template <typename Index>
+  static double left_value(const Index& x) {
+    return 1.0 + double(x[0]) - 0.5 * double(x[1]) + 0.25 * double(x[2]);
+  }
+
+  /// An element of the right-hand array, with indices (k,j,a)
+  template <typename Index>
+  static double right_value(const Index& x) {
+    return 0.5 + double(x[0] * x[1]) - double(x[2]);
+  }
+
+  /// Fill an array with the elements given by a function
+  template <typename A, typename Op>
+  static void fill(A& array, const Op& op) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = op(*idx);
+      *it = tile;
+    }
+  }
+
+  /// Check the result of c("i,j,a") = left("i,j,k") * right("k,j,a")
+  template <typename A>
+  static void check(const A& result, const std::array<unsigned int, 3>& dims) {
+    for(std::size_t t = 0ul; t < result.size(); ++t) {
+      if(result.is_zero(t))
+        continue;
+      const TensorD tile = result.find(t).get();
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx) {
+        const std::size_t x[3] = { (*idx)[dims[0]], (*idx)[dims[1]], (*idx)[dims[2]] };
+        double expected = 0.0;
+        for(std::size_t kk = 0ul; kk < 4ul; ++kk)
+          expected += left_value(std::array<std::size_t, 3>{{ x[0], x[1], kk }}) *
+              right_value(std::array<std::size_t, 3>{{ kk, x[1], x[2] }});
+        BOOST_CHECK_CLOSE(tile[*idx], expected, 1.0e-10);
+      }
+    }
+  }
+
+  World& world;
+  TiledRange1 i, j, k, a;
+}; // struct BatchedContractFixture
+
+BOOST_FIXTURE_TEST_SUITE( batched_contract_suite, BatchedContractFixture )
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD left(world, TiledRange{ i, j, k });
+  TArrayD right(world, TiledRange{ k, j, a });
+  fill(left, [] (const auto& x) { return left_value(x); });
+  fill(right, [] (const auto& x) { return right_value(x); });
+
+  TArrayD result;
+  BOOST_REQUIRE_NO_THROW(result = batched_contract(left, "i,j,k", right, "k,j,a", "i,j,a"));
+  BOOST_CHECK_EQUAL(result.trange(), (TiledRange{ i, j, a }));
+  check(result, {{ 0u, 1u, 2u }});
+
+  // The result indices may be in any order
+  BOOST_REQUIRE_NO_THROW(result = batched_contract(left, "i,j,k", right, "k,j,a", "a,i,j"));
+  BOOST_CHECK_EQUAL(result.trange(), (TiledRange{ a, i, j }));
+  check(result, {{ 1u, 2u, 0u }});
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  // The left-hand tiles in the first tile of k are zero
+  const TiledRange left_trange{ i, j, k };
+  Tensor<float> norms(left_trange.tiles_range(), 1.0f);
+  for(std::size_t t = 0ul; t < norms.size(); ++t)
+    if(left_trange.tiles_range().idx(t)[2] == 0ul)
+      norms[t] = 0.0f;
+  TSpArrayD left(world, left_trange, SparseShape<float>(norms, left_trange));
+  fill(left, [] (const auto& x) { return left_value(x); });
+  const TiledRange right_trange{ k, j, a };
+  TSpArrayD right(world, right_trange, SparseShape<float>(
+      Tensor<float>(right_trange.tiles_range(), 1.0f), right_trange));
+  fill(right, [] (const auto& x) { return right_value(x); });
+
+  TSpArrayD result;
+  BOOST_REQUIRE_NO_THROW(result = batched_contract(left, "i,j,k", right, "k,j,a", "i,j,a"));
+
+  // The result only includes the contributions of the non-zero tiles
+  TArrayD dense_left(world, left_trange);
+  fill(dense_left, [] (const auto& x) {
+    return (x[2] < 1ul ? 0.0 : left_value(x)); });
+  TArrayD dense_right(world, right_trange);
+  fill(dense_right, [] (const auto& x) { return right_value(x); });
+  const TArrayD reference =
+      batched_contract(dense_left, "i,j,k", dense_right, "k,j,a", "i,j,a");
+  for(std::size_t t = 0ul; t < result.size(); ++t) {
+    BOOST_REQUIRE(! result.is_zero(t));
+    const TensorD tile = result.find(t).get();
+    const TensorD reference_tile = reference.find(t).get();
+    for(std::size_t e = 0ul; e < tile.size(); ++e)
+      BOOST_CHECK_CLOSE(tile[e], reference_tile[e], 1.0e-10);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( invalid )
+{
+  TArrayD left(world, TiledRange{ i, j, k });
+  TArrayD right(world, TiledRange{ k, j, a });
+  fill(left, [] (const auto& x) { return left_value(x); });
+  fill(right, [] (const auto& x) { return right_value(x); });
+
+  // Indices that are only in one argument must be in the result
+  BOOST_CHECK_THROW(batched_contract(left, "i,j,k", right, "k,j,a", "i,j"),
+      TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  binary_input.cpp
+ *  May 17, 2017
+ *
+ */
+
+#include "TiledArray/conversions/binary_input.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include <cstdint>
+#include <fstream>
+
+using namespace TiledArray;
+
+struct BinaryInputFixture {
+
+  BinaryInputFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 }, { 0, 4, 8, 9 } },
+    path("binary_input_test")
+  { }
+
+  ~BinaryInputFixture() {
+    world.gop.fence();
+  }
+
+  /// The value of element \c i of the elements range, or zero when it is
+  /// in the first tile of the first dimension
+  double value(const std::size_t i) const {
+    const Range& elements = trange.elements_range();
+    return (elements.idx(i)[0] < 3ul ? 0.0 : double(i + 1ul));
+  }
+
+  /// Check that all elements of \c array have the values of \c value()
+  template <typename Array>
+  void check(const Array& array) const {
+    const Range& elements = trange.elements_range();
+    BOOST_CHECK_EQUAL(array.trange(), trange);
+    for(std::size_t t = 0ul; t < array.size(); ++t) {
+      const Range range = trange.make_tile_range(t);
+      if(array.is_zero(t)) {
+        for(const auto& index : range)
+          BOOST_CHECK_EQUAL(value(elements.ordinal(index)), 0.0);
+        continue;
+      }
+      const TensorD tile = array.find(t).get();
+      BOOST_CHECK_EQUAL(tile.range(), range);
+      for(const auto& index : range)
+        BOOST_CHECK_EQUAL(tile[index], value(elements.ordinal(index)));
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+  std::string path;
+}; // struct BinaryInputFixture
+
+BOOST_FIXTURE_TEST_SUITE( binary_input_suite, BinaryInputFixture )
+
+BOOST_AUTO_TEST_CASE( dense_file )
+{
+  if(world.rank() == 0) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for(std::size_t i = 0ul; i < trange.elements_range().volume(); ++i) {
+      const double v = value(i);
+      file.write(reinterpret_cast<const char*>(& v), sizeof(double));
+    }
+  }
+  world.gop.fence();
+
+  TArrayD dense;
+  read_dense_binary(dense, world, path, trange);
+  check(dense);
+
+  TSpArrayD sparse;
+  read_dense_binary(sparse, world, path, trange);
+  check(sparse);
+  BOOST_CHECK(sparse.is_zero(0));
+  BOOST_CHECK(! sparse.is_zero(trange.tiles_range().volume() - 1ul));
+}
+
+BOOST_AUTO_TEST_CASE( element_list )
+{
+  // Write the non-zero elements in reverse order, with one element split
+  // into two records
+  if(world.rank() == 0) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    const Range& elements = trange.elements_range();
+    for(std::size_t i = elements.volume(); i > 0ul; --i) {
+      const double v = value(i - 1ul);
+      if(v == 0.0)
+        continue;
+      for(const double part : (i == 300ul ? std::vector<double>{ 0.25 * v, 0.75 * v } :
+          std::vector<double>{ v }))
+      {
+        for(const auto x : elements.idx(i - 1ul)) {
+          const std::uint64_t x64 = x;
+          file.write(reinterpret_cast<const char*>(& x64), sizeof(std::uint64_t));
+        }
+        file.write(reinterpret_cast<const char*>(& part), sizeof(double));
+      }
+    }
+  }
+  world.gop.fence();
+
+  TArrayD dense;
+  read_element_list_binary(dense, world, path, trange);
+  check(dense);
+
+  TSpArrayD sparse;
+  read_element_list_binary(sparse, world, path, trange);
+  check(sparse);
+  BOOST_CHECK(sparse.is_zero(0));
+}
+
+BOOST_AUTO_TEST_CASE( missing_file )
+{
+  TArrayD array;
+  BOOST_CHECK_THROW(read_dense_binary(array, world, "binary_input_missing", trange),
+      TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
  */
 
 #include "TiledArray/bitset.h"
+#include "TiledArray/compressed_bitset.h"
 #include "tiledarray.h"
 #include "unit_test_config.h"
 #include <algorithm>
@@ -706,5 +707,108 @@ BOOST_AUTO_TEST_CASE( operator_not )
   BOOST_CHECK_EQUAL(!set, false);
 }
 
+BOOST_AUTO_TEST_CASE( bit_runs )
+{
+  // Fill bitset with runs that are shorter and longer than a block
+  for(std::size_t i = 3ul; i < 10ul; ++i)
+    set.set(i);
+  set.set_range(70ul, 300ul);
+  set.set(size - 1ul);
+
+  // Check that the runs cover the bitset in order, with alternating values
+  std::size_t next = 0ul;
+  std::size_t runs = 0ul;
+  bool last_value = true;
+  TiledArray::detail::for_each_bit_run(set, [&] (const std::size_t first,
+      const std::size_t last, const bool value)
+  {
+    BOOST_CHECK_EQUAL(first, next);
+    BOOST_CHECK(first < last);
+    BOOST_CHECK(value != last_value);
+    for(std::size_t i = first; i < last; ++i)
+      BOOST_CHECK_EQUAL(set[i] != 0ul, value);
+    next = last;
+    last_value = value;
+    ++runs;
+  });
+  BOOST_CHECK_EQUAL(next, size);
+  BOOST_CHECK_EQUAL(runs, 6ul);
+}
+
+BOOST_AUTO_TEST_CASE( find_set_bits )
+{
+  BOOST_CHECK_EQUAL(set.find_first(), size);
+
+  std::vector<std::size_t> bits = { 0ul, 5ul, 63ul, 64ul, 200ul, size - 1ul };
+  for(const std::size_t i : bits)
+    set.set(i);
+
+  // Check that the set bits are found in order
+  std::vector<std::size_t> found;
+  for(std::size_t i = set.find_first(); i < size; i = set.find_next(i))
+    found.push_back(i);
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), bits.begin(), bits.end());
+
+  found.clear();
+  TiledArray::detail::for_each_set_bit(set, [&] (const std::size_t i) {
+    found.push_back(i);
+  });
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), bits.begin(), bits.end());
+}
+
+BOOST_AUTO_TEST_CASE( count_and )
+{
+  Bitset other(size);
+  set.set_range(10ul, 400ul);
+  other.set_stride(1ul, 3ul);
+
+  BOOST_CHECK_EQUAL(set.count_and(other), (set & other).count());
+  BOOST_CHECK(set.intersects(other));
+  BOOST_CHECK(! set.intersects(other - set));
+  BOOST_CHECK_EQUAL((other - set).count(), other.count() - set.count_and(other));
+}
+
+BOOST_AUTO_TEST_CASE( compressed )
+{
+  typedef TiledArray::detail::CompressedBitset CompressedBitset;
+  const std::size_t n = 300000ul;
+
+  // Sparse bits, and a dense run of bits
+  Bitset left(n);
+  Bitset right(n);
+  for(std::size_t i = 0ul; i < n; i += 97ul)
+    left.set(i);
+  left.set_range(70000ul, 80000ul);
+  for(std::size_t i = 0ul; i < n; i += 89ul)
+    right.set(i);
+
+  CompressedBitset cleft(left);
+  CompressedBitset cright(right);
+  BOOST_CHECK_EQUAL(cleft.size(), n);
+  BOOST_CHECK_EQUAL(cleft.count(), left.count());
+  BOOST_CHECK_EQUAL(cright.count(), right.count());
+  BOOST_CHECK_EQUAL(cleft.count_and(cright), left.count_and(right));
+  BOOST_CHECK(cleft.intersects(cright));
+
+  // Check the intersection and union against the uncompressed bitsets
+  const Bitset intersection = (cleft & cright).to_bitset();
+  const Bitset expected_intersection = left & right;
+  const Bitset uni = (cleft | cright).to_bitset();
+  const Bitset expected_uni = left | right;
+  for(std::size_t i = 0ul; i < n; ++i) {
+    BOOST_CHECK_EQUAL(intersection[i], expected_intersection[i]);
+    BOOST_CHECK_EQUAL(uni[i], expected_uni[i]);
+  }
+
+  // Check that bits are set and reset
+  cleft.set(1ul);
+  BOOST_CHECK(cleft[1ul]);
+  cleft.reset(1ul);
+  BOOST_CHECK(! cleft[1ul]);
+  for(std::size_t i = 70000ul; i <= 80000ul; ++i)
+    cleft.reset(i);
+  BOOST_CHECK_EQUAL(cleft.count(), left.count() - 10001ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,143 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/conversions/block_cyclic.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct BlockCyclicFixture {
+  BlockCyclicFixture() :
+    trange({ TiledRange1{0, 3, 8, 10, 17}, TiledRange1{0, 5, 6, 13} }),
+    layout(17, 13, 2, 3, GlobalFixture::world->size())
+  { }
+
+  static int value(const std::size_t i, const std::size_t j) {
+    return i * 13 + j;
+  }
+
+  template <typename Policy>
+  void fill(DistArray<Tensor<int>, Policy>& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      Tensor<int> tile(array.trange().make_tile_range(it.ordinal()));
+      for(std::size_t i = tile.range().lobound(0); i < tile.range().upbound(0); ++i)
+        for(std::size_t j = tile.range().lobound(1); j < tile.range().upbound(1); ++j)
+          tile(i, j) = value(i, j);
+      *it = tile;
+    }
+  }
+
+  TiledRange trange;
+  BlockCyclicLayout layout;
+};
+
+BOOST_FIXTURE_TEST_SUITE( block_cyclic_suite , BlockCyclicFixture )
+
+BOOST_AUTO_TEST_CASE( layout )
+{
+  BlockCyclicLayout l(10, 7, 3, 2, 2, 3);
+
+  std::size_t rows = 0ul, cols = 0ul;
+  for(std::size_t p = 0ul; p < l.nprow(); ++p) {
+    rows += l.local_rows(p);
+    for(std::size_t li = 0ul; li < l.local_rows(p); ++li) {
+      const std::size_t i = l.global_row(li, p);
+      BOOST_CHECK_EQUAL(l.grid_row(i), p);
+      BOOST_CHECK_EQUAL(l.local_row(i), li);
+    }
+  }
+  for(std::size_t q = 0ul; q < l.npcol(); ++q) {
+    cols += l.local_cols(q);
+    for(std::size_t lj = 0ul; lj < l.local_cols(q); ++lj) {
+      const std::size_t j = l.global_col(lj, q);
+      BOOST_CHECK_EQUAL(l.grid_col(j), q);
+      BOOST_CHECK_EQUAL(l.local_col(j), lj);
+    }
+  }
+  BOOST_CHECK_EQUAL(rows, 10ul);
+  BOOST_CHECK_EQUAL(cols, 7ul);
+
+  BOOST_CHECK_EQUAL(l.rank(1, 2), 5);
+  BlockCyclicLayout c(10, 7, 3, 2, 2, 3, false);
+  BOOST_CHECK_EQUAL(c.rank(1, 2), 5);
+  BOOST_CHECK_EQUAL(c.rank(1, 0), 1);
+
+  const std::array<int, 9> desc = l.descriptor(7, 4);
+  BOOST_CHECK_EQUAL(desc[1], 7);
+  BOOST_CHECK_EQUAL(desc[2], 10);
+  BOOST_CHECK_EQUAL(desc[3], 7);
+  BOOST_CHECK_EQUAL(desc[4], 3);
+  BOOST_CHECK_EQUAL(desc[5], 2);
+  BOOST_CHECK_EQUAL(desc[8], 4);
+}
+
+BOOST_AUTO_TEST_CASE( array_to_block_cyclic_dense )
+{
+  TArrayI array(*GlobalFixture::world, trange);
+  fill(array);
+
+  BlockCyclicMatrix<int> matrix = array_to_block_cyclic(array, layout);
+
+  for(std::size_t li = 0ul; li < matrix.local_rows(); ++li)
+    for(std::size_t lj = 0ul; lj < matrix.local_cols(); ++lj)
+      BOOST_CHECK_EQUAL(matrix.local(li, lj),
+          value(layout.global_row(li, matrix.grid_row()),
+                layout.global_col(lj, matrix.grid_col())));
+}
+
+BOOST_AUTO_TEST_CASE( array_to_block_cyclic_sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 1.0f);
+  norms[1] = 0.0f;
+  norms[6] = 0.0f;
+  TSpArrayI array(*GlobalFixture::world, trange,
+      SparseShape<float>(norms, trange));
+  fill(array);
+
+  BlockCyclicMatrix<int> matrix = array_to_block_cyclic(array, layout);
+
+  for(std::size_t li = 0ul; li < matrix.local_rows(); ++li) {
+    for(std::size_t lj = 0ul; lj < matrix.local_cols(); ++lj) {
+      const std::size_t i = layout.global_row(li, matrix.grid_row());
+      const std::size_t j = layout.global_col(lj, matrix.grid_col());
+      const auto tile = trange.element_to_tile(std::array<std::size_t, 2>{{i, j}});
+      BOOST_CHECK_EQUAL(matrix.local(li, lj),
+          (array.is_zero(tile) ? 0 : value(i, j)));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( block_cyclic_to_array_round_trip )
+{
+  TArrayI array(*GlobalFixture::world, trange);
+  fill(array);
+
+  BlockCyclicMatrix<int> matrix = array_to_block_cyclic(array, layout);
+  TArrayI result = block_cyclic_to_array(*GlobalFixture::world, matrix, trange);
+
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const Tensor<int> tile = it->get();
+    for(std::size_t i = tile.range().lobound(0); i < tile.range().upbound(0); ++i)
+      for(std::size_t j = tile.range().lobound(1); j < tile.range().upbound(1); ++j)
+        BOOST_CHECK_EQUAL(tile(i, j), value(i, j));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
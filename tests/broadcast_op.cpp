@@ -0,0 +1,147 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  broadcast_op.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/conversions/broadcast_op.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct BroadcastOpFixture {
+  BroadcastOpFixture() :
+    world(* GlobalFixture::world),
+    occ{ 0, 2, 5 }, vir{ 0, 3, 7 },
+    trange{ occ, occ, vir, vir }
+  { }
+
+  ~BroadcastOpFixture() {
+    world.gop.fence();
+  }
+
+  /// Orbital energies of the occupied orbitals
+  static double e_occ(const std::size_t i) { return -1.0 - double(i); }
+
+  /// Orbital energies of the virtual orbitals
+  static double e_vir(const std::size_t a) { return 1.0 + 0.5 * double(a); }
+
+  /// Elements of the amplitudes
+  static double t_value(const std::vector<std::size_t>& idx) {
+    return 1.0 + double(idx[0]) + 2.0 * double(idx[1]) + 3.0 * double(idx[2])
+        + 4.0 * double(idx[3]);
+  }
+
+  /// A vector array with the values of \c f
+  TArrayD make_vector(const TiledRange1& tr1, double (*f)(std::size_t)) {
+    TArrayD array(world, TiledRange{ tr1 });
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      const std::size_t lobound = tile.range().lobound_data()[0];
+      for(std::size_t x = 0ul; x < tile.size(); ++x)
+        tile[x] = f(lobound + x);
+      *it = tile;
+    }
+    return array;
+  }
+
+  /// Fill the local tiles of the amplitudes
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t x = 0ul; x < tile.size(); ++x) {
+        const auto idx = tile.range().idx(x);
+        tile[x] = t_value(std::vector<std::size_t>(idx.begin(), idx.end()));
+      }
+      *it = tile;
+    }
+  }
+
+  /// Check the local tiles of the result
+  template <typename Array>
+  static void check(const Array& result) {
+    for(const auto i : *result.pmap()) {
+      if(result.is_zero(i))
+        continue;
+      const TensorD tile = result.find(i).get();
+      for(std::size_t x = 0ul; x < tile.size(); ++x) {
+        const auto idx = tile.range().idx(x);
+        const std::vector<std::size_t> index(idx.begin(), idx.end());
+        const double d = e_occ(index[0]) + e_occ(index[1]) - e_vir(index[2])
+            - e_vir(index[3]);
+        BOOST_CHECK_CLOSE(tile[x], t_value(index) / d, 1.0e-10);
+      }
+    }
+  }
+
+  World& world;
+  TiledRange1 occ;
+  TiledRange1 vir;
+  TiledRange trange;
+}; // struct BroadcastOpFixture
+
+BOOST_FIXTURE_TEST_SUITE( broadcast_op_suite, BroadcastOpFixture )
+
+BOOST_AUTO_TEST_CASE( denominator )
+{
+  TArrayD t(world, trange);
+  fill(t);
+  const TArrayD eo = make_vector(occ, &e_occ);
+  const TArrayD ev = make_vector(vir, &e_vir);
+
+  const TArrayD r = broadcast_op(t, "i,j,a,b",
+      { BroadcastVector<double>(eo, "i"), BroadcastVector<double>(eo, "j"),
+        BroadcastVector<double>(ev, "a", -1.0),
+        BroadcastVector<double>(ev, "b", -1.0) },
+      [] (const double value, const double d) { return value / d; });
+  check(r);
+
+  // Operands must match a variable of the array
+  BOOST_CHECK_THROW(broadcast_op(t, "i,j,a,b",
+      { BroadcastVector<double>(eo, "k") },
+      [] (const double value, const double d) { return value / d; }),
+      TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( sparse_denominator )
+{
+  Tensor<float> norms(trange.tiles_range(), 1.0f);
+  norms[0] = 0.0f;
+  TSpArrayD t(world, trange, SparseShape<float>(norms, trange));
+  fill(t);
+
+  // The vector operands are given by their elements; the shift is added
+  std::vector<double> eo, ev;
+  for(std::size_t i = 0ul; i < 5ul; ++i)
+    eo.push_back(e_occ(i) - 0.5);
+  for(std::size_t a = 0ul; a < 7ul; ++a)
+    ev.push_back(e_vir(a));
+
+  const TSpArrayD r = broadcast_op(t, "i,j,a,b",
+      { BroadcastVector<double>(eo, "i"), BroadcastVector<double>(eo, "j"),
+        BroadcastVector<double>(ev, "a", -1.0),
+        BroadcastVector<double>(ev, "b", -1.0) },
+      [] (const double value, const double d) { return value / d; }, 1.0);
+  BOOST_CHECK(r.is_zero(0ul));
+  check(r);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
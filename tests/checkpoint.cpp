@@ -0,0 +1,148 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  checkpoint.cpp
+ *  Feb 15, 2017
+ *
+ */
+
+#include "TiledArray/checkpoint.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct CheckpointFixture {
+
+  CheckpointFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 }, { 0, 4, 8, 9 } },
+    prefix("checkpoint_test")
+  { }
+
+  ~CheckpointFixture() {
+    world.gop.fence();
+  }
+
+  /// The value of element \c i of tile \c index
+  static double value(const std::size_t index, const std::size_t i) {
+    return double(index * 1000ul + i);
+  }
+
+  /// Fill the local tiles of \c array with known values
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = value(it.ordinal(), i);
+      *it = tile;
+    }
+  }
+
+  /// Check that all tiles of \c array hold the values set by \c fill()
+  template <typename Array>
+  static void check(const Array& array) {
+    for(std::size_t t = 0ul; t < array.size(); ++t) {
+      if(array.is_zero(t))
+        continue;
+      const TensorD tile = array.find(t).get();
+      BOOST_CHECK_EQUAL(tile.range(), array.trange().make_tile_range(t));
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        BOOST_CHECK_EQUAL(tile[i], value(t, i));
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+  std::string prefix;
+}; // struct CheckpointFixture
+
+BOOST_FIXTURE_TEST_SUITE( checkpoint_suite, CheckpointFixture )
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD array(world, trange);
+  fill(array);
+  save_array(array, prefix);
+
+  // Load the checkpoint with a different process map
+  TArrayD result;
+  load_array(result, world, prefix, std::shared_ptr<TArrayD::pmap_interface>(
+      new detail::HashPmap(world, trange.tiles_range().volume(), 7ul)));
+  BOOST_CHECK_EQUAL(result.trange(), array.trange());
+  check(result);
+
+  // Check that the policy is checked
+  TSpArrayD sparse;
+  BOOST_CHECK_THROW(load_array(sparse, world, prefix), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    if(i % 3ul)
+      norms[i] = 100.0f;
+  TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+  fill(array);
+  save_array(array, prefix);
+
+  TSpArrayD result;
+  load_array(result, world, prefix);
+  BOOST_CHECK_EQUAL(result.trange(), array.trange());
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    BOOST_CHECK_EQUAL(result.is_zero(i), array.is_zero(i));
+  check(result);
+}
+
+BOOST_AUTO_TEST_CASE( expression )
+{
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    if(i % 3ul)
+      norms[i] = 100.0f;
+  TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+  fill(array);
+
+  // The result of the expression is written without being stored
+  save_expr(2.0 * array("a,b,c"), prefix, world);
+  TSpArrayD reference;
+  reference("a,b,c") = 2.0 * array("a,b,c");
+
+  TSpArrayD result;
+  load_array(result, world, prefix);
+  BOOST_CHECK_EQUAL(result.trange(), reference.trange());
+  for(std::size_t t = 0ul; t < result.size(); ++t) {
+    BOOST_CHECK_EQUAL(result.is_zero(t), reference.is_zero(t));
+    if(result.is_zero(t))
+      continue;
+    const TensorD tile = result.find(t).get();
+    const TensorD reference_tile = reference.find(t).get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(),
+        reference_tile.begin(), reference_tile.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( missing_file )
+{
+  TArrayD result;
+  BOOST_CHECK_THROW(load_array(result, world, "checkpoint_missing"),
+      TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
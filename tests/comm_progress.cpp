@@ -0,0 +1,89 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  comm_progress.cpp
+ *  May 27, 2017
+ *
+ */
+
+#include "TiledArray/comm_progress.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct CommProgressFixture {
+  CommProgressFixture() :
+    trange({ TiledRange1{0, 3, 8, 10}, TiledRange1{0, 2, 7, 11} }),
+    running(comm_progress_running())
+  { }
+
+  ~CommProgressFixture() {
+    GlobalFixture::world->gop.fence();
+    if(running)
+      comm_progress_start(*GlobalFixture::world);
+    else
+      comm_progress_stop();
+  }
+
+  TiledRange trange;
+  bool running;
+};
+
+BOOST_FIXTURE_TEST_SUITE( comm_progress_suite , CommProgressFixture )
+
+BOOST_AUTO_TEST_CASE( start_stop )
+{
+  comm_progress_stop();
+  BOOST_CHECK(! comm_progress_running());
+
+  int level = MPI_THREAD_SINGLE;
+  MPI_Query_thread(&level);
+  const bool started = comm_progress_start(*GlobalFixture::world);
+  BOOST_CHECK_EQUAL(started, level == MPI_THREAD_MULTIPLE);
+  BOOST_CHECK_EQUAL(comm_progress_running(), started);
+
+  // Starting a running thread does nothing
+  BOOST_CHECK_EQUAL(comm_progress_start(*GlobalFixture::world), started);
+
+  comm_progress_stop();
+  BOOST_CHECK(! comm_progress_running());
+}
+
+BOOST_AUTO_TEST_CASE( expression )
+{
+  if(! comm_progress_start(*GlobalFixture::world))
+    return;
+
+  // Expressions are not affected by the progress thread
+  TArrayD a(*GlobalFixture::world, trange), b(*GlobalFixture::world, trange), c;
+  a.fill(1.0);
+  b.fill(2.0);
+  c("i,j") = a("i,k") * b("j,k");
+  GlobalFixture::world->gop.fence();
+
+  for(auto it = c.begin(); it != c.end(); ++it) {
+    const TensorD tile = it->get();
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      BOOST_CHECK_EQUAL(tile[i], 22.0);
+  }
+
+  comm_progress_stop();
+  BOOST_CHECK_GT(comm_progress_stats().polls, 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,126 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  comm_stats.cpp
+ *  May 29, 2017
+ *
+ */
+
+#include "TiledArray/comm_stats.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include <sstream>
+
+using namespace TiledArray;
+
+struct CommStatsFixture {
+  CommStatsFixture() :
+    trange({ TiledRange1{0, 3, 8, 10}, TiledRange1{0, 2, 7, 11} }),
+    enabled(comm_stats_enabled())
+  {
+    GlobalFixture::world->gop.fence();
+    reset_comm_stats();
+    comm_stats_enable();
+  }
+
+  ~CommStatsFixture() {
+    GlobalFixture::world->gop.fence();
+    comm_stats_enable(enabled);
+    reset_comm_stats();
+  }
+
+  TiledRange trange;
+  bool enabled;
+};
+
+BOOST_FIXTURE_TEST_SUITE( comm_stats_suite , CommStatsFixture )
+
+BOOST_AUTO_TEST_CASE( record )
+{
+  detail::comm_stats_record(CommCategory::storage_set, 2ul, 100ul);
+  detail::comm_stats_record(CommCategory::storage_set, 1ul, 50ul);
+  for(int i = 0; i < 100; ++i)
+    detail::comm_stats_record_latency(CommCategory::storage_get, 10ul,
+        detail::comm_stats_time());
+
+  const CommCounters set = comm_stats(CommCategory::storage_set);
+  BOOST_CHECK_EQUAL(set.messages, 3ul);
+  BOOST_CHECK_EQUAL(set.bytes, 150ul);
+  BOOST_CHECK_EQUAL(set.latency_count, 0ul);
+  BOOST_CHECK_EQUAL(set.latency_mean, 0.0);
+
+  const CommCounters get = comm_stats(CommCategory::storage_get);
+  BOOST_CHECK_EQUAL(get.messages, 0ul);
+  BOOST_CHECK_EQUAL(get.bytes, 1000ul);
+  BOOST_CHECK_EQUAL(get.latency_count, 100ul);
+  BOOST_CHECK_GE(get.latency_mean, 0.0);
+  BOOST_CHECK_LE(get.latency_p50, get.latency_p90);
+  BOOST_CHECK_LE(get.latency_p90, get.latency_p99);
+
+  // Other categories are not affected
+  BOOST_CHECK_EQUAL(comm_stats(CommCategory::summa_bcast).messages, 0ul);
+
+  reset_comm_stats();
+  BOOST_CHECK_EQUAL(comm_stats(CommCategory::storage_set).messages, 0ul);
+  BOOST_CHECK_EQUAL(comm_stats(CommCategory::storage_get).latency_count, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( aggregate )
+{
+  detail::comm_stats_record(CommCategory::replication, 1ul, 8ul);
+
+  const CommCounters global =
+      comm_stats(*GlobalFixture::world, CommCategory::replication);
+  const std::size_t size = GlobalFixture::world->size();
+  BOOST_CHECK_EQUAL(global.messages, size);
+  BOOST_CHECK_EQUAL(global.bytes, 8ul * size);
+
+  std::stringstream ss;
+  print_comm_stats(*GlobalFixture::world, ss);
+  if(GlobalFixture::world->rank() == 0)
+    BOOST_CHECK(ss.str().find(comm_category_name(CommCategory::replication))
+        != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( expression )
+{
+  TArrayD a(*GlobalFixture::world, trange), b(*GlobalFixture::world, trange), c;
+  a.fill(1.0);
+  b.fill(2.0);
+  c("i,j") = a("i,k") * b("j,k");
+  GlobalFixture::world->gop.fence();
+
+  const CommCounters bcast =
+      comm_stats(*GlobalFixture::world, CommCategory::summa_bcast);
+  if(GlobalFixture::world->size() == 1) {
+    BOOST_CHECK_EQUAL(bcast.messages, 0ul);
+  } else {
+    // Every broadcast tile is received by the other processes of its group
+    BOOST_CHECK_GT(bcast.messages, 0ul);
+    BOOST_CHECK_EQUAL(bcast.latency_count, bcast.messages);
+  }
+
+  // Disabled counters do not count
+  comm_stats_enable(false);
+  reset_comm_stats();
+  c("i,j") = a("i,k") * b("j,k");
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(comm_stats(CommCategory::summa_bcast).messages, 0ul);
+  BOOST_CHECK_EQUAL(comm_stats(CommCategory::summa_bcast).latency_count, 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  compact_shape.cpp
+ *  May 26, 2017
+ *
+ */
+
+#include "TiledArray/compact_shape.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include "sparse_shape_fixture.h"
+
+using namespace TiledArray;
+
+BOOST_FIXTURE_TEST_SUITE( compact_shape_suite, SparseShapeFixture )
+
+BOOST_AUTO_TEST_CASE( sparse_storage )
+{
+  const CompactShape<float> compact(sparse_shape, ShapeStorage::sparse);
+  const std::size_t volume = tr.tiles_range().volume();
+
+  BOOST_CHECK(! compact.empty());
+  BOOST_CHECK_EQUAL(compact.range(), tr.tiles_range());
+  BOOST_CHECK_CLOSE(compact.sparsity(), sparse_shape.sparsity(), tolerance);
+  BOOST_CHECK_EQUAL(compact.tolerance(), 0.0);
+  BOOST_CHECK_EQUAL(compact.bytes(),
+      compact.nnz() * (sizeof(std::size_t) + sizeof(float)));
+
+  // The norms are stored exactly
+  for(std::size_t i = 0ul; i < volume; ++i) {
+    BOOST_CHECK_EQUAL(compact.is_zero(i), sparse_shape.is_zero(i));
+    BOOST_CHECK_EQUAL(compact[i], sparse_shape[i]);
+  }
+
+  const SparseShape<float> shape = compact.shape();
+  BOOST_CHECK(! shape.is_bound());
+  BOOST_CHECK_CLOSE(shape.sparsity(), sparse_shape.sparsity(), tolerance);
+  for(std::size_t i = 0ul; i < volume; ++i)
+    BOOST_CHECK_EQUAL(shape[i], sparse_shape[i]);
+}
+
+BOOST_AUTO_TEST_CASE( quantized_storage )
+{
+  const std::size_t volume = tr.tiles_range().volume();
+
+  for(ShapeStorage storage : { ShapeStorage::log16, ShapeStorage::log8 }) {
+    const CompactShape<float> compact(sparse_shape, storage);
+    const std::size_t code_size = (storage == ShapeStorage::log8 ? 1ul : 2ul);
+    BOOST_CHECK_EQUAL(compact.bytes(),
+        compact.nnz() * (sizeof(std::size_t) + code_size));
+    BOOST_CHECK_GT(compact.tolerance(), 0.0);
+
+    // The norms are rounded up, within the tolerance
+    const double tol = compact.tolerance() + 1.0e-6;
+    for(std::size_t i = 0ul; i < volume; ++i) {
+      BOOST_CHECK_EQUAL(compact.is_zero(i), sparse_shape.is_zero(i));
+      if(! sparse_shape.is_zero(i)) {
+        BOOST_CHECK_GE(compact[i], sparse_shape[i] * (1.0f - 1.0e-6f));
+        BOOST_CHECK_LE(compact[i], sparse_shape[i] * (1.0 + tol));
+      }
+    }
+
+    // Quantized norms are bounds
+    const SparseShape<float> shape = compact.shape();
+    BOOST_CHECK(shape.is_bound());
+    BOOST_CHECK_CLOSE(shape.sparsity(), sparse_shape.sparsity(), tolerance);
+  }
+
+  // The 16-bit codes are more precise than the 8-bit codes
+  BOOST_CHECK_LT(CompactShape<float>(sparse_shape, ShapeStorage::log16).tolerance(),
+      CompactShape<float>(sparse_shape, ShapeStorage::log8).tolerance());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  coo.cpp
+ *  May 18, 2017
+ *
+ */
+
+#include "TiledArray/conversions/coo.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include <array>
+
+using namespace TiledArray;
+
+struct CooFixture {
+  typedef std::vector<std::pair<std::array<std::size_t, 2>, double> > elements_type;
+
+  CooFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 } }
+  {
+    // The elements of the diagonal and of the last row, which are split
+    // among the processes
+    std::size_t n = 0ul;
+    for(std::size_t i = 0ul; i < 10ul; ++i, ++n)
+      if(int(n % world.size()) == world.rank())
+        elements.push_back({ {{ i, i }}, double(i + 1ul) });
+    for(std::size_t j = 0ul; j < 10ul; ++j, ++n)
+      if(int(n % world.size()) == world.rank())
+        elements.push_back({ {{ 11ul, j }}, 0.5 * double(j + 1ul) });
+  }
+
+  ~CooFixture() {
+    world.gop.fence();
+  }
+
+  /// The expected value of element \c (i,j)
+  static double value(const std::size_t i, const std::size_t j) {
+    return (i == 11ul ? 0.5 * double(j + 1ul) : 0.0) +
+        (i == j ? double(i + 1ul) : 0.0);
+  }
+
+  /// Check that all elements of \c array have the values of \c value()
+  template <typename Array>
+  void check(const Array& array) const {
+    BOOST_CHECK_EQUAL(array.trange(), trange);
+    for(std::size_t t = 0ul; t < array.size(); ++t) {
+      const Range range = trange.make_tile_range(t);
+      if(array.is_zero(t)) {
+        for(const auto& index : range)
+          BOOST_CHECK_EQUAL(value(index[0], index[1]), 0.0);
+        continue;
+      }
+      const TensorD tile = array.find(t).get();
+      BOOST_CHECK_EQUAL(tile.range(), range);
+      for(const auto& index : range)
+        BOOST_CHECK_EQUAL(tile[index], value(index[0], index[1]));
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+  elements_type elements;
+}; // struct CooFixture
+
+BOOST_FIXTURE_TEST_SUITE( coo_suite, CooFixture )
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  TSpArrayD array;
+  BOOST_REQUIRE_NO_THROW(array = coo_to_array<TSpArrayD>(world, trange, elements));
+  check(array);
+
+  // Only tiles that hold elements are non-zero
+  BOOST_CHECK(! array.is_zero(0));
+  BOOST_CHECK(array.is_zero(1));
+  BOOST_CHECK(! array.is_zero(4));
+  BOOST_CHECK(! array.is_zero(5));
+}
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD array;
+  BOOST_REQUIRE_NO_THROW(array = coo_to_array<TArrayD>(world, trange, elements));
+  check(array);
+}
+
+BOOST_AUTO_TEST_CASE( out_of_range )
+{
+  elements_type bad = { { {{ 12ul, 0ul }}, 1.0 } };
+  BOOST_CHECK_THROW(coo_to_array<TSpArrayD>(world, trange, bad), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
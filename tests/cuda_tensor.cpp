@@ -0,0 +1,153 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  cuda_tensor.cpp
+ *  Mar 7, 2017
+ *
+ */
+
+#include "TiledArray/cuda_tensor.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+#ifdef TILEDARRAY_HAS_CUDA
+
+using namespace TiledArray;
+
+struct CudaTensorFixture {
+  typedef CudaTensor<double> tile_type;
+
+  CudaTensorFixture() :
+    left_range({ 0, 0 }, { 12, 9 }), right_range({ 0, 0 }, { 9, 7 })
+  { }
+
+  static TensorD make_tensor(const Range& range) {
+    TensorD result(range);
+    for(std::size_t i = 0ul; i < result.size(); ++i)
+      result[i] = GlobalFixture::world->rand() % 101;
+    return result;
+  }
+
+  /// The largest absolute difference of the elements of \c tile and \c tensor
+  static double max_error(const tile_type& tile, const TensorD& tensor) {
+    const TensorD host = static_cast<TensorD>(tile);
+    BOOST_REQUIRE_EQUAL(host.range(), tensor.range());
+    return host.subt(tensor).abs_max();
+  }
+
+  Range left_range;
+  Range right_range;
+}; // struct CudaTensorFixture
+
+BOOST_FIXTURE_TEST_SUITE( cuda_tensor_suite, CudaTensorFixture )
+
+BOOST_AUTO_TEST_CASE( copy )
+{
+  const TensorD tensor = make_tensor(left_range);
+  const tile_type tile(tensor);
+
+  BOOST_CHECK(! tile.empty());
+  BOOST_CHECK_EQUAL(tile.range(), left_range);
+  BOOST_CHECK_EQUAL(max_error(tile, tensor), 0.0);
+  BOOST_CHECK_EQUAL(max_error(tile.clone(), tensor), 0.0);
+  BOOST_CHECK_CLOSE(tile.norm(), tensor.norm(), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( permute )
+{
+  const TensorD tensor = make_tensor(left_range);
+  const tile_type tile(tensor);
+  const Permutation perm({ 1, 0 });
+
+  BOOST_CHECK_EQUAL(max_error(permute(tile, perm), tensor.permute(perm)), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( element_wise )
+{
+  const TensorD a = make_tensor(left_range);
+  const TensorD b = make_tensor(left_range);
+  const tile_type x(a), y(b);
+
+  BOOST_CHECK_EQUAL(max_error(add(x, y), a.add(b)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(subt(x, y, 2.0), a.subt(b, 2.0)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(mult(x, y), a.mult(b)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(scale(x, 3.0), a.scale(3.0)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(neg(x), a.neg()), 0.0);
+
+  tile_type z = x.clone();
+  add_to(z, y);
+  BOOST_CHECK_EQUAL(max_error(z, a.add(b)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(x, a), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( contract )
+{
+  const TensorD a = make_tensor(left_range);
+  const TensorD b = make_tensor(right_range);
+  const tile_type x(a), y(b);
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  const TensorD reference = a.gemm(b, 2.0, gemm_helper);
+  const tile_type product = gemm(x, y, 2.0, gemm_helper);
+  BOOST_CHECK_EQUAL(max_error(product, reference), 0.0);
+
+  tile_type result = product.clone();
+  gemm(result, x, y, 2.0, gemm_helper);
+  BOOST_CHECK_EQUAL(max_error(result, reference.scale(2.0)), 0.0);
+
+  // Transposed arguments
+  const math::GemmHelper trans_helper(madness::cblas::Trans,
+      madness::cblas::Trans, 2u, 2u, 2u);
+  const TensorD at = a.permute(Permutation({ 1, 0 }));
+  const TensorD bt = b.permute(Permutation({ 1, 0 }));
+  BOOST_CHECK_EQUAL(max_error(gemm(tile_type(at), tile_type(bt), 2.0, trans_helper),
+      reference), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( array )
+{
+  World& world = * GlobalFixture::world;
+  const TiledRange trange{ { 0, 4, 9, 12 }, { 0, 5, 9 } };
+  TArrayD a(world, trange), b(world, trange);
+  for(auto it = a.begin(); it != a.end(); ++it)
+    *it = make_tensor(it.make_range());
+  for(auto it = b.begin(); it != b.end(); ++it)
+    *it = make_tensor(it.make_range());
+
+  // Tiles stay on the device across expressions
+  auto to_device = [] (tile_type& result, const TensorD& arg) {
+    result = tile_type(arg);
+  };
+  DistArray<tile_type> x = foreach<tile_type>(a, to_device);
+  DistArray<tile_type> y = foreach<tile_type>(b, to_device);
+  DistArray<tile_type> z;
+  z("i,k") = x("i,j") * y("k,j");
+  z("i,k") = 2.0 * z("i,k") - x("i,j") * y("k,j");
+
+  TArrayD reference;
+  reference("i,k") = a("i,j") * b("k,j");
+  for(std::size_t i = 0ul; i < z.size(); ++i) {
+    if(! z.is_local(i))
+      continue;
+    BOOST_CHECK_SMALL(max_error(z.find(i).get(), reference.find(i).get()), 1.0e-10);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // TILEDARRAY_HAS_CUDA
@@ -180,5 +180,31 @@ BOOST_AUTO_TEST_CASE( local_group )
   }
 }
 
+BOOST_AUTO_TEST_CASE( owners )
+{
+  for(std::size_t x = 1ul; x < 10ul; ++x) {
+    for(std::size_t y = 1ul; y < 10ul; ++y) {
+      TiledArray::detail::CyclicPmap pmap(* GlobalFixture::world, x, y, 1ul,
+          GlobalFixture::world->size());
+
+      // Check that the bulk owners match the owner of each tile
+      std::vector<std::size_t> tiles(x * y);
+      for(std::size_t tile = 0ul; tile < tiles.size(); ++tile)
+        tiles[tile] = tiles.size() - tile - 1ul;
+      const std::vector<std::size_t> owners = pmap.owners(tiles);
+      BOOST_REQUIRE_EQUAL(owners.size(), tiles.size());
+      for(std::size_t n = 0ul; n < tiles.size(); ++n)
+        BOOST_CHECK_EQUAL(owners[n], pmap.owner(tiles[n]));
+
+      // Check that the local tiles are the tiles owned by this rank
+      std::size_t local = 0ul;
+      for(std::size_t tile = 0ul; tile < tiles.size(); ++tile)
+        if(pmap.is_local(tile))
+          ++local;
+      BOOST_CHECK_EQUAL(std::size_t(std::distance(pmap.begin(), pmap.end())), local);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
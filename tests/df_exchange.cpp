@@ -0,0 +1,144 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  df_exchange.cpp
+ *  Apr 4, 2017
+ *
+ */
+
+#include "TiledArray/df_exchange.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct DFExchangeFixture {
+
+  DFExchangeFixture() :
+    world(* GlobalFixture::world),
+    df{ 0, 3, 5, 9, 10 }, ao{ 0, 2, 6, 7 }, occ{ 0, 1, 3 }
+  { }
+
+  ~DFExchangeFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill an array with the elements given by a function
+  template <typename A, typename Op>
+  static void fill(A& array, const Op& op) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = op(*idx);
+      *it = tile;
+    }
+  }
+
+  /// Check df_exchange() against the expression with the full three-index
+  /// half-transformed tensor
+  template <typename A>
+  void check(const A& B, const A& C) {
+    A W, reference;
+    W("X,mu,i") = B("X,mu,nu") * C("nu,i");
+    reference("mu,nu") = W("X,mu,i") * W("X,nu,i");
+
+    const A K = df_exchange(B, C);
+    BOOST_CHECK(K.trange() == reference.trange());
+    for(std::size_t t = 0ul; t < K.size(); ++t) {
+      if(! K.is_local(t))
+        continue;
+      BOOST_REQUIRE_EQUAL(K.is_zero(t), reference.is_zero(t));
+      if(K.is_zero(t))
+        continue;
+      const TensorD tile = K.find(t).get();
+      const TensorD reference_tile = reference.find(t).get();
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        BOOST_CHECK_CLOSE(tile[i], reference_tile[i], 1.0e-10);
+    }
+  }
+
+  World& world;
+  TiledRange1 df, ao, occ;
+}; // DFExchangeFixture
+
+BOOST_FIXTURE_TEST_SUITE( df_exchange_suite, DFExchangeFixture )
+
+BOOST_AUTO_TEST_CASE( batches )
+{
+  // one batch without a budget
+  std::vector<std::size_t> bounds =
+      detail::df_exchange_batches(df, 7ul, 3ul, 8ul, 1ul, 0ul);
+  BOOST_CHECK_EQUAL(bounds.size(), 2ul);
+  BOOST_CHECK_EQUAL(bounds.back(), 4ul);
+
+  // half of the budget per batch, and at least one tile per batch
+  bounds = detail::df_exchange_batches(df, 7ul, 3ul, 8ul, 1ul, 2ul * 168ul * 6ul);
+  BOOST_CHECK_EQUAL(bounds.size(), 3ul);
+  BOOST_CHECK_EQUAL(bounds[1], 2ul);
+  BOOST_CHECK_EQUAL(bounds[2], 4ul);
+  bounds = detail::df_exchange_batches(df, 7ul, 3ul, 8ul, 1ul, 1ul);
+  BOOST_CHECK_EQUAL(bounds.size(), 5ul);
+}
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD B(world, TiledRange{ df, ao, ao });
+  TArrayD C(world, TiledRange{ ao, occ });
+  fill(B, [] (const Range::index& x) {
+    return 1.0 / (1.0 + double(x[0]) + double(x[1] * x[2])); });
+  fill(C, [] (const Range::index& x) {
+    return 0.5 - double(x[0]) * 0.1 + double(x[1]); });
+  world.gop.fence();
+
+  check(B, C);
+
+  // stream the density-fitting index in batches
+  const std::size_t budget = contraction_max_memory();
+  contraction_max_memory(1ul);
+  check(B, C);
+  contraction_max_memory(budget);
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  // the (X,mu) rows of B with X and mu in different halves are zero
+  const TiledRange trange{ df, ao, ao };
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t t = 0ul; t < norms.size(); ++t) {
+    const auto index = trange.tiles_range().idx(t);
+    if((index[0] < 2ul) == (index[1] < 2ul))
+      norms[t] = 1.0f;
+  }
+  TSpArrayD B(world, trange, SparseShape<float>(norms, trange));
+  const TiledRange coeff_trange{ ao, occ };
+  TSpArrayD C(world, coeff_trange, SparseShape<float>(
+      Tensor<float>(coeff_trange.tiles_range(), 1.0f), coeff_trange));
+  fill(B, [] (const Range::index& x) {
+    return 1.0 / (1.0 + double(x[0]) + double(x[1] * x[2])); });
+  fill(C, [] (const Range::index& x) {
+    return 0.5 - double(x[0]) * 0.1 + double(x[1]); });
+  world.gop.fence();
+
+  check(B, C);
+
+  const std::size_t budget = contraction_max_memory();
+  contraction_max_memory(1ul);
+  check(B, C);
+  contraction_max_memory(budget);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,9 @@
 #include "tiledarray.h"
 #include "unit_test_config.h"
 #include "../src/TiledArray/dist_array.h"
+#include <algorithm>
+#include <atomic>
+#include <numeric>
 #include <random>
 #include <chrono>
 
@@ -163,6 +166,40 @@ BOOST_AUTO_TEST_CASE( find_remote )
   }
 }
 
+BOOST_AUTO_TEST_CASE( prefetch_remote )
+{
+  // Check the prefetch cache capacity
+  const ArrayN::size_type capacity = a.prefetch_capacity();
+  a.prefetch_capacity(2ul);
+  BOOST_CHECK_EQUAL(a.prefetch_capacity(), 2ul);
+
+  // Prefetch more tiles than fit in the cache, by index and by ordinal, and
+  // check that all tiles are found
+  for(int pass = 0; pass < 2; ++pass) {
+    BOOST_REQUIRE_NO_THROW(a.prefetch(a.range()));
+    std::vector<ArrayN::size_type> ordinals(a.size());
+    std::iota(ordinals.begin(), ordinals.end(), 0ul);
+    BOOST_REQUIRE_NO_THROW(a.prefetch(ordinals.rbegin(), ordinals.rend()));
+
+    for(ArrayN::range_type::const_iterator it = a.range().begin(); it != a.range().end(); ++it) {
+      Future<ArrayN::value_type> tile = a.find(*it);
+
+      const int owner = a.owner(*it);
+      for(ArrayN::value_type::iterator it = tile.get().begin(); it != tile.get().end(); ++it)
+        BOOST_CHECK_EQUAL(*it, owner + 1);
+    }
+
+    a.prefetch_capacity(0ul);
+  }
+
+  a.prefetch_capacity(capacity);
+
+#ifdef TA_EXCEPTION_ERROR
+  // Check that out of range indices are rejected
+  BOOST_CHECK_THROW(a.prefetch({ a.size() }), TiledArray::Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
 BOOST_AUTO_TEST_CASE( fill_tiles )
 {
   ArrayN a(world, tr);
@@ -206,6 +243,164 @@ BOOST_AUTO_TEST_CASE( assign_tiles )
   }
 }
 
+BOOST_AUTO_TEST_CASE( init_tiles_bulk )
+{
+  ArrayN a(world, tr);
+
+  // Set every other local tile in bulk, and then the others
+  std::vector<ArrayN::size_type> even, odd;
+  for(const ArrayN::size_type i : *a.pmap())
+    (i % 2 ? odd : even).push_back(i);
+  std::atomic<std::size_t> calls(0ul);
+  a.init_tiles(even, [&] (const Range& range) -> TensorI {
+    ++calls;
+    return TensorI(range, int(range.volume()));
+  });
+  world.gop.fence();
+  a.init_tiles([&] (const Range& range) -> TensorI {
+    ++calls;
+    return TensorI(range, -1);
+  }, true);
+
+  for(const ArrayN::size_type i : *a.pmap()) {
+    const TensorI tile = a.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), tr.make_tile_range(i));
+    for(const int value : tile)
+      BOOST_CHECK_EQUAL(value, (i % 2 ? -1 : int(tile.range().volume())));
+  }
+  BOOST_CHECK_EQUAL(calls.load(), even.size() + odd.size());
+}
+
+BOOST_AUTO_TEST_CASE( fill_random )
+{
+  TArrayD a(world, tr), b(world, tr), c(world, tr);
+  a.fill_random(-2.0, 3.0, 42ul);
+  b.fill_random(-2.0, 3.0, 42ul);
+  c.fill_random(-2.0, 3.0, 43ul);
+
+  for(const TArrayD::size_type i : *a.pmap()) {
+    const TensorD tile = a.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), tr.make_tile_range(i));
+
+    // Check that the values are given by the tile ordinal and the seed
+    std::vector<double> expected(tile.size());
+    math::uniform_fill(expected.size(), expected.data(), i, 42ul, -2.0, 3.0);
+    for(std::size_t e = 0ul; e < tile.size(); ++e) {
+      BOOST_CHECK_EQUAL(tile[e], expected[e]);
+      BOOST_CHECK_GE(tile[e], -2.0);
+      BOOST_CHECK_LE(tile[e], 3.0);
+    }
+
+    // Check that the fill is reproducible and depends on the seed
+    const TensorD same = b.find(i).get();
+    const TensorD other = c.find(i).get();
+    BOOST_CHECK(std::equal(tile.begin(), tile.end(), same.begin()));
+    BOOST_CHECK(! std::equal(tile.begin(), tile.end(), other.begin()));
+  }
+
+  // Check that tiles do not share values
+  if(a.is_local(0ul) && a.is_local(1ul))
+    BOOST_CHECK_NE(a.find(0ul).get()[0], a.find(1ul).get()[0]);
+}
+
+BOOST_AUTO_TEST_CASE( fill_identity )
+{
+  TArrayD a(world, tr);
+  a.fill_identity();
+
+  for(const TArrayD::size_type i : *a.pmap()) {
+    const TensorD tile = a.find(i).get();
+    for(auto it = tile.range().begin(); it != tile.range().end(); ++it) {
+      const auto& index = *it;
+      const bool diagonal = std::all_of(index.begin(), index.end(),
+          [&] (const std::size_t x) { return x == index[0]; });
+      BOOST_CHECK_EQUAL(tile[index], (diagonal ? 1.0 : 0.0));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( accumulate_tiles )
+{
+  ArrayN a(world, tr);
+
+  // Every process contributes twice to every tile
+  for(ArrayN::size_type i = 0ul; i < a.size(); ++i) {
+    const Range range = a.trange().make_tile_range(i);
+    a.accumulate(i, TensorI(range, world.rank() + 1));
+    a.accumulate(i, TensorI(range, 1));
+  }
+  world.gop.fence();
+
+  const int nprocs = world.size();
+  const int expected = nprocs * (nprocs + 1) / 2 + nprocs;
+  for(const ArrayN::size_type i : *a.pmap()) {
+    const TensorI tile = a.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), tr.make_tile_range(i));
+    for(const int value : tile)
+      BOOST_CHECK_EQUAL(value, expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( rma_expose )
+{
+  ArrayN b(world, tr);
+  for(const ArrayN::size_type i : *b.pmap())
+    b.set(i, TensorI(tr.make_tile_range(i), int(i)));
+  world.gop.fence();
+
+  b.rma_expose();
+  BOOST_CHECK(b.is_rma_exposed());
+
+  // Check that local and remote tiles are read
+  for(ArrayN::size_type i = 0ul; i < b.size(); ++i) {
+    const TensorI tile = b.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), tr.make_tile_range(i));
+    for(const int value : tile)
+      BOOST_CHECK_EQUAL(value, int(i));
+  }
+
+  b.rma_release();
+  BOOST_CHECK(! b.is_rma_exposed());
+}
+
+BOOST_AUTO_TEST_CASE( freeze )
+{
+  ArrayN b(world, tr);
+  for(const ArrayN::size_type i : *b.pmap())
+    b.set(i, TensorI(tr.make_tile_range(i), int(i)));
+
+  BOOST_CHECK(! b.is_frozen());
+  b.freeze();
+  BOOST_CHECK(b.is_frozen());
+
+  // Check that local and remote tiles are read, and that remote tiles are
+  // cached
+  for(unsigned int pass = 0u; pass < 2u; ++pass) {
+    for(ArrayN::size_type i = 0ul; i < b.size(); ++i) {
+      const TensorI tile = b.find(i).get();
+      BOOST_CHECK_EQUAL(tile.range(), tr.make_tile_range(i));
+      for(const int value : tile)
+        BOOST_CHECK_EQUAL(value, int(i));
+    }
+  }
+  if(b.size() > b.pmap()->local_size())
+    BOOST_CHECK_GT(b.memory_usage().cache_bytes, 0ul);
+
+  // Check that frozen tiles are not consumed by expressions
+  ArrayN c;
+  c("a,b,c") = b("a,b,c");
+  c("a,b,c") = b("a,b,c") + c("a,b,c");
+  for(const ArrayN::size_type i : *c.pmap())
+    for(const int value : c.find(i).get())
+      BOOST_CHECK_EQUAL(value, 2 * int(i));
+
+#ifdef TA_EXCEPTION_ERROR
+  // Check that tiles of a frozen array cannot be set
+  BOOST_CHECK_THROW(b.set(0, TensorI(tr.make_tile_range(0), 0)),
+      TiledArray::Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
 BOOST_AUTO_TEST_CASE( clone )
 {
   std::vector<int> data;
@@ -253,6 +448,49 @@ BOOST_AUTO_TEST_CASE( clone )
   }
 }
 
+BOOST_AUTO_TEST_CASE( lazy_tiles )
+{
+  const SparseShape<float> shape(shape_tensor, tr);
+  for(const bool cache : { true, false }) {
+    std::atomic<std::size_t> count(0ul);
+    SpArrayN lazy = make_lazy_array<SpArrayN>(world, tr, shape,
+        [&count] (TensorI& tile, const Range& range) {
+          tile = TensorI(range, int(range.lobound()[0]) + 1);
+          ++count;
+        }, cache);
+    BOOST_CHECK(lazy.is_lazy());
+    world.gop.fence();
+
+    // Check that no tiles are generated before they are requested
+    BOOST_CHECK_EQUAL(count.load(), 0ul);
+
+    std::size_t local_tiles = 0ul;
+    for(std::size_t i = 0ul; i < lazy.size(); ++i)
+      if(lazy.is_local(i) && ! lazy.is_zero(i))
+        ++local_tiles;
+
+    // Evaluate two expressions that consume the lazy array
+    for(int pass = 0; pass < 2; ++pass) {
+      SpArrayN b;
+      b("a,b,c") = 2 * lazy("a,b,c");
+      for(std::size_t i = 0ul; i < b.size(); ++i) {
+        BOOST_CHECK_EQUAL(b.is_zero(i), shape.is_zero(i));
+        if(! b.is_local(i) || b.is_zero(i))
+          continue;
+        const TensorI tile = b.find(i).get();
+        const Range range = tr.make_tile_range(i);
+        BOOST_CHECK_EQUAL(tile.range(), range);
+        for(const int value : tile)
+          BOOST_CHECK_EQUAL(value, 2 * (int(range.lobound()[0]) + 1));
+      }
+      world.gop.fence();
+    }
+
+    // Check that generated tiles are reused only when they are cached
+    BOOST_CHECK_EQUAL(count.load(), (cache ? 1ul : 2ul) * local_tiles);
+  }
+}
+
 BOOST_AUTO_TEST_CASE( make_replicated )
 {
   // Get a copy of the original process map
@@ -277,5 +515,120 @@ BOOST_AUTO_TEST_CASE( make_replicated )
   }
 }
 
+BOOST_AUTO_TEST_CASE( redistribute )
+{
+  std::shared_ptr<ArrayN::pmap_interface> distributed_pmap = a.pmap();
+  ArrayN b = a;
+
+  // Make a map where the cost of the tiles in the first half is twice the
+  // cost of the remaining tiles
+  std::vector<double> costs(a.size());
+  for(std::size_t i = 0ul; i < a.size(); ++i)
+    costs[i] = (i < a.size() / 2ul ? 2.0 : 1.0);
+  std::shared_ptr<ArrayN::pmap_interface> pmap =
+      TiledArray::balanced_pmap(a, costs);
+  BOOST_CHECK_EQUAL(pmap->size(), a.size());
+
+  BOOST_REQUIRE_NO_THROW(a.redistribute(pmap));
+  BOOST_CHECK_EQUAL(a.pmap(), pmap);
+  BOOST_CHECK_EQUAL(b.pmap(), distributed_pmap);
+
+  // Check that the tiles were moved to their new owners
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(a.is_local(i), pmap->is_local(i));
+    Future<ArrayN::value_type> tile = a.find(i);
+    BOOST_CHECK_EQUAL(tile.get().range(), a.trange().make_tile_range(i));
+    for(ArrayN::value_type::const_iterator it = tile.get().begin(); it != tile.get().end(); ++it)
+      BOOST_CHECK_EQUAL(*it, distributed_pmap->owner(i) + 1);
+  }
+
+  BOOST_CHECK_THROW(a.redistribute(std::make_shared<TiledArray::detail::BlockedPmap>(
+      world, a.size() + 1ul)), TiledArray::Exception);
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( view )
+{
+  const TiledRange trange({ TiledRange1{ 0, 2, 5, 7, 10 },
+      TiledRange1{ 0, 3, 4, 8 } });
+  TArrayD a(world, trange);
+  a.fill_random();
+  world.gop.fence();
+
+  // Check the meta data of a view of tiles [1,3) x [1,3)
+  TArrayD v = a.view({ 1, 1 }, { 3, 3 });
+  BOOST_CHECK(v.is_view());
+  BOOST_CHECK(! a.is_view());
+  BOOST_CHECK_EQUAL(v.trange(), TiledRange({ TiledRange1{ 0, 3, 5 },
+      TiledRange1{ 0, 1, 5 } }));
+  for(std::size_t i = 0ul; i < v.size(); ++i) {
+    const std::size_t j = v.view_block().ordinal(i);
+    BOOST_CHECK_EQUAL(v.owner(i), a.owner(j));
+
+    // Check that the tiles share the data of the array tiles
+    const TensorD tile = v.find(i).get();
+    const TensorD parent_tile = a.find(j).get();
+    BOOST_CHECK_EQUAL(tile.range(), v.trange().make_tile_range(i));
+    if(a.is_local(j))
+      BOOST_CHECK_EQUAL(tile.data(), parent_tile.data());
+    BOOST_CHECK(std::equal(tile.begin(), tile.end(), parent_tile.begin()));
+  }
+
+  // Check that a view is an expression argument
+  TArrayD b, c;
+  b("i,j") = v("i,j") * 2.0;
+  c("i,j") = a("i,j").block({ 1, 1 }, { 3, 3 }) * 2.0;
+  world.gop.fence();
+  for(std::size_t i = 0ul; i < b.size(); ++i) {
+    const TensorD b_tile = b.find(i).get();
+    const TensorD c_tile = c.find(i).get();
+    BOOST_CHECK(std::equal(b_tile.begin(), b_tile.end(), c_tile.begin()));
+  }
+
+  // Check that a view is assigned in place
+  const TArrayD before = a.clone();
+  v("i,j") = 3.0 * v("i,j");
+  world.gop.fence();
+  BOOST_CHECK(v.is_view());
+  const BlockRange block(a.trange().tiles_range(), { 1, 1 }, { 3, 3 });
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    const TensorD tile = a.find(i).get();
+    const TensorD old_tile = before.find(i).get();
+    const double factor = (block.includes(a.trange().tiles_range().idx(i)) ?
+        3.0 : 1.0);
+    for(std::size_t e = 0ul; e < tile.size(); ++e)
+      BOOST_CHECK_CLOSE(tile[e], factor * old_tile[e], 1.0e-10);
+  }
+
+  // Check that setting the tiles of a view sets the tiles of the array
+  TArrayD d(world, trange);
+  TArrayD w = d.view({ 1, 1 }, { 3, 3 });
+  w.fill_local(1.0);
+  world.gop.fence();
+  for(std::size_t i = 0ul; i < w.size(); ++i) {
+    const TensorD tile = d.find(w.view_block().ordinal(i)).get();
+    BOOST_CHECK_EQUAL(tile.range(),
+        trange.make_tile_range(w.view_block().ordinal(i)));
+    for(const double value : tile)
+      BOOST_CHECK_EQUAL(value, 1.0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( lazy_cleanup )
+{
+  {
+    ArrayN b(world, tr);
+    b.fill_local(1);
+    for(ArrayN::const_iterator it = b.begin(); it != b.end(); ++it)
+      it->get();
+  }
+
+  // The array is released on all processes, so it is deleted without a fence
+  ArrayN::wait_for_lazy_cleanup(world);
+  const TiledArray::LazyCleanupStats stats = TiledArray::lazy_cleanup_stats(world);
+  BOOST_CHECK_EQUAL(stats.arrays, 0ul);
+  BOOST_CHECK_EQUAL(stats.bytes, 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -26,6 +26,7 @@
 #include "array_fixture.h"
 
 #include "../src/TiledArray/dist_eval/contraction_eval.h"
+#include "../src/TiledArray/band_shape.h"
 #include "../src/tiledarray.h"
 #include "unit_test_config.h"
 #include "sparse_shape_fixture.h"
@@ -153,6 +154,47 @@ struct ContractionEvalFixture : public SparseShapeFixture {
   }
 
 
+  /// A tile of the arrays of chained contractions
+
+  /// \param range The tile range
+  /// \param i The tile index
+  /// \param scale The scaling factor of the tile, or zero for a zero tile
+  /// \return The tile
+  static TensorD chain_tile(const Range& range, const std::size_t i,
+      const double scale)
+  {
+    TensorD tile(range, 0.0);
+    if(scale != 0.0)
+      for(std::size_t x = 0ul; x < tile.size(); ++x)
+        tile[x] = scale * (double((i + x) % 7ul) - 3.0);
+    return tile;
+  }
+
+  /// Check the result of a chained contraction against a dense reference
+
+  /// \param result The result of the chained contraction
+  /// \param reference The dense reference
+  /// \param tolerance The absolute tolerance
+  template <typename Array>
+  static void check_chain(const Array& result, const TArrayD& reference,
+      const double tolerance)
+  {
+    for(std::size_t i = 0ul; i < result.size(); ++i) {
+      if(! result.is_local(i))
+        continue;
+      const TensorD ref = reference.find(i).get();
+      if(result.is_zero(i)) {
+        for(std::size_t x = 0ul; x < ref.size(); ++x)
+          BOOST_CHECK_SMALL(ref[x], tolerance);
+      } else {
+        const TensorD tile = result.find(i).get();
+        BOOST_REQUIRE_EQUAL(tile.size(), ref.size());
+        for(std::size_t x = 0ul; x < ref.size(); ++x)
+          BOOST_CHECK_SMALL(tile[x] - ref[x], tolerance);
+      }
+    }
+  }
+
   /// Distributed contraction evaluator factory function
 
   /// Construct a distributed contraction evaluator, which constructs a new
@@ -449,4 +491,121 @@ BOOST_AUTO_TEST_CASE( sparse_eval )
   do_sparse_eval(true);
 }
 
+BOOST_AUTO_TEST_CASE( trace_eval )
+{
+  detail::SummaTrace& summa_trace = detail::SummaTrace::instance();
+  const bool enabled = summa_trace.enabled();
+  summa_trace.clear();
+  summa_trace.enable();
+
+  auto contract = make_contract_eval(left_arg, right_arg,
+      left_arg.world(), DenseShape(), pmap, Permutation(), make_contract(2u,
+      left_arg.trange().tiles_range().rank(), right_arg.trange().tiles_range().rank()));
+
+  BOOST_REQUIRE_NO_THROW(contract.eval());
+  BOOST_REQUIRE_NO_THROW(contract.wait());
+  for(auto index : *contract.pmap())
+    contract.get(index).get();
+  GlobalFixture::world->gop.fence();
+
+  summa_trace.enable(enabled);
+
+  // Check that one trace was recorded for each iteration that has local tiles
+  const std::size_t K = left_arg.trange().tiles_range().extent(
+      left_arg.trange().tiles_range().rank() - 1);
+  const std::vector<detail::SummaIterationTrace> traces = summa_trace.traces();
+  if(proc_grid.local_size() > 0ul) {
+    BOOST_CHECK_EQUAL(traces.size(), K);
+  } else {
+    BOOST_CHECK_EQUAL(traces.size(), 0ul);
+  }
+  for(const detail::SummaIterationTrace& t : traces) {
+    BOOST_CHECK(t.id == contract.id());
+    BOOST_CHECK_LT(t.k, K);
+    BOOST_CHECK_EQUAL(t.tiles, proc_grid.local_rows() + proc_grid.local_cols());
+    BOOST_CHECK_EQUAL(t.skipped_tiles, 0ul);
+    BOOST_CHECK_EQUAL(t.contractions, proc_grid.local_size());
+    BOOST_CHECK_GT(t.bytes, 0ul);
+    BOOST_CHECK_GE(t.wait_time, 0.0);
+    BOOST_CHECK_GE(t.contract_time, 0.0);
+  }
+
+  summa_trace.clear();
+}
+
+BOOST_AUTO_TEST_CASE( chained_band_contraction )
+{
+  World& world = *GlobalFixture::world;
+  const TiledRange trange{ { 0, 2, 5, 7, 10, 12, 15 }, { 0, 3, 5, 8, 10, 13, 15 } };
+  const Range tiles = trange.tiles_range();
+
+  DistArray<TensorD, BandPolicy> a(world, trange, BandShape::band(tiles, 1ul, 0ul));
+  DistArray<TensorD, BandPolicy> b(world, trange, BandShape::band(tiles, 0ul, 2ul));
+  DistArray<TensorD, BandPolicy> c(world, trange, BandShape::block_diagonal(tiles, { 2ul, 3ul, 1ul }));
+  TArrayD a_dense(world, trange), b_dense(world, trange), c_dense(world, trange);
+  for(DistArray<TensorD, BandPolicy>* array : { & a, & b, & c })
+    for(auto it = array->begin(); it != array->end(); ++it)
+      *it = chain_tile(it.make_range(), it.ordinal(), 1.0);
+  for(auto it = a_dense.begin(); it != a_dense.end(); ++it)
+    *it = chain_tile(it.make_range(), it.ordinal(), a.is_zero(it.ordinal()) ? 0.0 : 1.0);
+  for(auto it = b_dense.begin(); it != b_dense.end(); ++it)
+    *it = chain_tile(it.make_range(), it.ordinal(), b.is_zero(it.ordinal()) ? 0.0 : 1.0);
+  for(auto it = c_dense.begin(); it != c_dense.end(); ++it)
+    *it = chain_tile(it.make_range(), it.ordinal(), c.is_zero(it.ordinal()) ? 0.0 : 1.0);
+
+  // The tiles of the inner contraction are used by the outer one as soon as
+  // their last step is done
+  DistArray<TensorD, BandPolicy> d;
+  TArrayD d_dense;
+  d("i,j") = (a("i,k") * b("k,l")) * c("l,j");
+  d_dense("i,j") = (a_dense("i,k") * b_dense("k,l")) * c_dense("l,j");
+
+  check_chain(d, d_dense, 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( chained_sparse_contraction )
+{
+  World& world = *GlobalFixture::world;
+  const TiledRange trange{ { 0, 2, 5, 7, 10, 12, 15 }, { 0, 2, 5, 7, 10, 12, 15 } };
+  const std::size_t n = trange.tiles_range().extent(1);
+
+  // The tiles of the second column of a and of the second row of b are
+  // small, so their pairs are screened out; a and b are banded, and c has
+  // zero tiles below the diagonal.
+  TArrayD a_dense(world, trange), b_dense(world, trange), c_dense(world, trange);
+  for(auto it = a_dense.begin(); it != a_dense.end(); ++it) {
+    const std::size_t i = it.ordinal() / n, k = it.ordinal() % n;
+    *it = chain_tile(it.make_range(), it.ordinal(),
+        (std::max(i, k) - std::min(i, k) > 2ul ? 0.0 : (k == 1ul ? 1.0e-3 : 1.0)));
+  }
+  for(auto it = b_dense.begin(); it != b_dense.end(); ++it) {
+    const std::size_t k = it.ordinal() / n, j = it.ordinal() % n;
+    *it = chain_tile(it.make_range(), it.ordinal(),
+        (std::max(k, j) - std::min(k, j) > 2ul ? 0.0 : (k == 1ul ? 1.0e-3 : 1.0)));
+  }
+  for(auto it = c_dense.begin(); it != c_dense.end(); ++it) {
+    const std::size_t i = it.ordinal() / n, j = it.ordinal() % n;
+    *it = chain_tile(it.make_range(), it.ordinal(), (i > j ? 0.0 : 1.0));
+  }
+  const TSpArrayD a = to_sparse(a_dense);
+  const TSpArrayD b = to_sparse(b_dense);
+  const TSpArrayD c = to_sparse(c_dense);
+
+  TArrayD d_dense;
+  d_dense("i,j") = (a_dense("i,k") * b_dense("k,l")) * c_dense("l,j");
+
+  // Check the chained contraction without and with pair screening; the
+  // screened pairs contribute less than the tolerance
+  std::atomic<bool>& screen = detail::summa_screen();
+  const bool screen_default = screen;
+  for(const bool screened : { false, true }) {
+    screen = screened;
+    TSpArrayD d;
+    d("i,j") = (a("i,k") * b("k,l")) * c("l,j");
+    check_chain(d, d_dense, (screened ? 1.0e-2 : 1.0e-10));
+    world.gop.fence();
+  }
+  screen = screen_default;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
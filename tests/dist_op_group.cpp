@@ -24,6 +24,8 @@
  */
 
 #include "TiledArray/madness.h"
+#include "TiledArray/zero_copy.h"
+#include "tiledarray.h"
 #include "unit_test_config.h"
 
 using madness::Group;
@@ -134,4 +136,75 @@ BOOST_AUTO_TEST_CASE( copy_group )
   BOOST_CHECK((child2 == -1) || (std::find(group_list.begin(), group_list.end(), child2) != group_list.end()));
 }
 
+BOOST_AUTO_TEST_CASE( binomial_tree )
+{
+  // Check that every process is reached exactly once from any root
+  for(ProcessID size = 1; size < 20; ++size) {
+    for(ProcessID root = 0; root < size; ++root) {
+      std::vector<int> parents(size, -2);
+      for(ProcessID rank = 0; rank < size; ++rank) {
+        ProcessID parent = -1;
+        std::vector<ProcessID> children;
+        TiledArray::detail::make_binomial_tree(root, rank, size, parent, children);
+        BOOST_CHECK_EQUAL(parent == -1, rank == root);
+        for(const ProcessID child : children) {
+          BOOST_CHECK_EQUAL(parents[child], -2);
+          parents[child] = rank;
+        }
+      }
+      BOOST_CHECK_EQUAL(parents[root], -2);
+      BOOST_CHECK_EQUAL(std::count(parents.begin(), parents.end(), -2), 1);
+    }
+  }
+
+  // Check that the chain is selected for large tiles and long groups
+  using TiledArray::detail::BcastAlgorithm;
+  BOOST_CHECK(TiledArray::detail::select_bcast_algorithm(BcastAlgorithm::tree,
+      16, 1ul << 26) == BcastAlgorithm::tree);
+  BOOST_CHECK(TiledArray::detail::select_bcast_algorithm(BcastAlgorithm::automatic,
+      2, 1ul << 20) == BcastAlgorithm::binomial);
+  BOOST_CHECK(TiledArray::detail::select_bcast_algorithm(BcastAlgorithm::automatic,
+      16, 1ul << 26) == BcastAlgorithm::chain);
+}
+
+BOOST_AUTO_TEST_CASE( zero_copy_bcast )
+{
+  using TiledArray::detail::BcastAlgorithm;
+  madness::World& world = * GlobalFixture::world;
+  std::vector<ProcessID> procs;
+  for(ProcessID p = 0; p < world.size(); ++p)
+    procs.push_back(p);
+  Group group(world, procs, did);
+
+  // Use tiles that are larger than the zero-copy threshold
+  const std::size_t volume = std::max(TiledArray::detail::zero_copy_threshold(),
+      sizeof(double)) / sizeof(double) + 1ul;
+  const ProcessID root = world.size() - 1;
+
+  std::size_t k = 0ul;
+  for(const BcastAlgorithm algorithm : { BcastAlgorithm::tree,
+      BcastAlgorithm::binomial, BcastAlgorithm::chain, BcastAlgorithm::automatic })
+  {
+    madness::Future<TiledArray::TensorD> tile;
+    if(world.rank() == root) {
+      TiledArray::TensorD value(TiledArray::Range(volume));
+      for(std::size_t i = 0ul; i < volume; ++i)
+        value[i] = double(i + k);
+      tile.set(value);
+    }
+
+    const DistributedID key(did.first, ++k);
+    TiledArray::detail::zero_copy_bcast(world, key, tile, root, group, volume,
+        algorithm);
+    const TiledArray::TensorD result = tile.get();
+    BOOST_CHECK_EQUAL(result.size(), volume);
+    bool equal = true;
+    for(std::size_t i = 0ul; i < volume; ++i)
+      equal = equal && (result[i] == double(i + k - 1ul));
+    BOOST_CHECK(equal);
+  }
+
+  world.gop.fence();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
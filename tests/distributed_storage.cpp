@@ -121,5 +121,212 @@ BOOST_AUTO_TEST_CASE( array_operator )
 #endif // TA_EXCEPTION_ERROR
 }
 
+BOOST_AUTO_TEST_CASE( zero_copy_tensor )
+{
+  BOOST_CHECK(detail::is_zero_copy_tile<TensorD>::value);
+  BOOST_CHECK(! detail::is_zero_copy_tile<int>::value);
+  BOOST_CHECK(! detail::is_zero_copy<TensorD>(1ul));
+
+  // Use tiles that are larger than the zero-copy threshold
+  const std::size_t volume =
+      detail::zero_copy_threshold() / sizeof(double) + 1ul;
+  BOOST_CHECK_EQUAL(detail::is_zero_copy<TensorD>(volume),
+      detail::zero_copy_threshold() != 0ul);
+
+  std::shared_ptr<detail::BlockedPmap> tensor_pmap(
+      new detail::BlockedPmap(world, 4));
+  detail::DistributedStorage<TensorD> s(world, 4, tensor_pmap);
+
+  // Set each element from a process that does not own it
+  for(std::size_t i = 0; i < s.max_size(); ++i) {
+    if(ProcessID((s.owner(i) + 1) % world.size()) == world.rank())
+      s.set(i, TensorD(Range(volume), double(i + 1)));
+  }
+
+  world.gop.fence();
+
+  // Check that all elements are received by the owner and by remote processes
+  for(std::size_t i = 0; i < s.max_size(); ++i) {
+    const TensorD tile = s.get(i).get();
+    BOOST_CHECK_EQUAL(tile.size(), volume);
+    BOOST_CHECK_EQUAL(tile[0], double(i + 1));
+    BOOST_CHECK_EQUAL(tile[volume - 1], double(i + 1));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( memory_usage )
+{
+  std::shared_ptr<detail::BlockedPmap> tensor_pmap(
+      new detail::BlockedPmap(world, 4));
+  const std::size_t world_bytes = TiledArray::memory_usage(world).local_bytes;
+  {
+    detail::DistributedStorage<TensorD> s(world, 4, tensor_pmap);
+    s.expected_bytes([] (const std::size_t) { return 80ul; });
+    BOOST_CHECK_EQUAL(s.memory_usage().total_bytes(), 0ul);
+
+    // Check that local elements are pending until they are set
+    std::size_t local_size = 0ul;
+    for(std::size_t i = 0; i < s.max_size(); ++i) {
+      if(s.is_local(i)) {
+        s.get(i);
+        ++local_size;
+      }
+    }
+    BOOST_CHECK_EQUAL(s.memory_usage().pending_bytes, local_size * 80ul);
+    BOOST_CHECK_EQUAL(s.memory_usage().local_bytes, 0ul);
+
+    for(std::size_t i = 0; i < s.max_size(); ++i)
+      if(s.is_local(i))
+        s.set(i, TensorD(Range(i + 1), 1.0));
+
+    std::size_t local_bytes = 0ul;
+    for(std::size_t i = 0; i < s.max_size(); ++i)
+      if(s.is_local(i))
+        local_bytes += (i + 1) * sizeof(double);
+    BOOST_CHECK_EQUAL(s.memory_usage().pending_bytes, 0ul);
+    BOOST_CHECK_EQUAL(s.memory_usage().local_bytes, local_bytes);
+    BOOST_CHECK_GE(TiledArray::memory_usage(world).local_bytes,
+        world_bytes + local_bytes);
+    BOOST_CHECK_GE(TiledArray::memory_high_water(world),
+        TiledArray::memory_usage(world).total_bytes());
+
+    world.gop.fence();
+
+    // Check that prefetched elements are cached until they are retrieved
+    for(std::size_t i = 0; i < s.max_size(); ++i) {
+      if(! s.is_local(i)) {
+        s.prefetch(i);
+        s.get(i).get();
+      }
+    }
+    BOOST_CHECK_EQUAL(s.memory_usage().cache_bytes, 0ul);
+
+    s.prefetch_capacity(s.max_size());
+    std::size_t cache_bytes = 0ul;
+    for(std::size_t i = 0; i < s.max_size(); ++i) {
+      if(! s.is_local(i)) {
+        s.prefetch(i);
+        cache_bytes += (i + 1) * sizeof(double);
+        world.await([&] () { return s.memory_usage().cache_bytes == cache_bytes; });
+      }
+    }
+    BOOST_CHECK_EQUAL(s.memory_usage().cache_bytes, cache_bytes);
+    s.clear_prefetch();
+    BOOST_CHECK_EQUAL(s.memory_usage().cache_bytes, 0ul);
+
+    world.gop.fence();
+  }
+}
+
+BOOST_AUTO_TEST_CASE( indexed_storage )
+{
+  Storage s(world, 10, pmap);
+  s.indexed_storage();
+  BOOST_CHECK(s.is_indexed());
+  BOOST_CHECK_EQUAL(s.size(), 0ul);
+
+  // Access some elements before they are set, and set the others directly
+  for(std::size_t i = 0; i < s.max_size(); ++i) {
+    if(s.is_local(i)) {
+      if(i % 2)
+        s.get(i).probe();
+      s.set(i, int(i) + 1);
+    }
+  }
+  BOOST_CHECK_EQUAL(s.size(), pmap->local_size());
+
+  world.gop.fence();
+
+  // Check that elements are read by local and remote requests
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    BOOST_CHECK_EQUAL(s.get(i).get(), int(i) + 1);
+
+  world.gop.fence();
+
+  // Check that erased elements are released and can be set again
+  for(std::size_t i = 0; i < s.max_size(); ++i) {
+    if(s.is_local(i)) {
+      s.erase(i);
+      s.set(i, -1);
+      BOOST_CHECK_EQUAL(s.get(i).get(), -1);
+    }
+  }
+  BOOST_CHECK_EQUAL(s.size(), pmap->local_size());
+}
+
+BOOST_AUTO_TEST_CASE( aggregate )
+{
+  Storage s(world, 10, pmap);
+  s.aggregate_bytes(1024ul);
+  BOOST_CHECK_EQUAL(s.aggregate_bytes(), 1024ul);
+  world.gop.fence();
+
+  // Set all elements from the first process
+  if(world.rank() == 0)
+    for(std::size_t i = 0; i < s.max_size(); ++i)
+      s.set(i, int(i) + 1);
+
+  world.gop.fence();
+  std::size_t n = s.size();
+  world.gop.sum(n);
+  BOOST_CHECK_EQUAL(n, s.max_size());
+
+  // Check that elements are read by local and remote requests
+  std::vector<Storage::future> elements;
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    elements.push_back(s.get(i));
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    BOOST_CHECK_EQUAL(elements[i].get(), int(i) + 1);
+
+  // Each message moves at least one element
+  BOOST_CHECK_LE(s.messages_sent(), s.elements_sent());
+  if(world.size() == 1)
+    BOOST_CHECK_EQUAL(s.messages_sent(), 0ul);
+
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( spill )
+{
+  std::shared_ptr<detail::BlockedPmap> tensor_pmap(
+      new detail::BlockedPmap(world, 8));
+  detail::DistributedStorage<TensorD> s(world, 8, tensor_pmap);
+
+  // Keep at most two tiles of 100 elements in memory
+  s.spill(".", 200ul * sizeof(double));
+
+  std::size_t local_size = 0ul;
+  for(std::size_t i = 0; i < s.max_size(); ++i) {
+    if(s.is_local(i)) {
+      s.set(i, TensorD(Range(100), double(i + 1)));
+      ++local_size;
+    }
+  }
+  BOOST_CHECK_EQUAL(s.spilled_size(), (local_size > 2ul ? local_size - 2ul : 0ul));
+  BOOST_CHECK_LE(s.memory_usage().local_bytes, 200ul * sizeof(double));
+
+  // Check that prefetching the least recently used tile reads it back
+  if(local_size > 2ul) {
+    for(std::size_t i = 0; i < s.max_size(); ++i) {
+      if(s.is_local(i)) {
+        s.prefetch(i);
+        break;
+      }
+    }
+    BOOST_CHECK_EQUAL(s.spilled_size(), local_size - 3ul);
+  }
+
+  world.gop.fence();
+
+  // Check that spilled tiles are read back by local and remote requests
+  for(std::size_t i = 0; i < s.max_size(); ++i) {
+    const TensorD tile = s.get(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), Range(100));
+    BOOST_CHECK_EQUAL(tile[0], double(i + 1));
+    BOOST_CHECK_EQUAL(tile[99], double(i + 1));
+  }
+
+  world.gop.fence();
+}
 
 BOOST_AUTO_TEST_SUITE_END()
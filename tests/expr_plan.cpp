@@ -0,0 +1,152 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_plan.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/dist_eval/summa_schedule.h"
+#include "TiledArray/expressions/expr_plan.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::expressions::make_plan;
+
+struct ExprPlanFixture {
+  ExprPlanFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 3, 7, 12 } }
+  { }
+
+  ~ExprPlanFixture() {
+    world.gop.fence();
+  }
+
+  /// A sparse array with non-zero diagonal tiles
+
+  /// \param tr The tiled range of the array
+  /// \param scale The factor of the tile values
+  /// \param fill_corner Add the non-zero tile {0,2}
+  TSpArrayD make_array(const TiledRange& tr, const double scale,
+      const bool fill_corner = false)
+  {
+    Tensor<float> norms(tr.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; i < 3ul; ++i)
+      norms(i, i) = 100.0f;
+    if(fill_corner)
+      norms(0, 2) = 100.0f;
+    TSpArrayD array(world, tr, SparseShape<float>(norms, tr));
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = scale * double(it.ordinal() * 100ul + i + 1ul);
+      *it = tile;
+    }
+    return array;
+  }
+
+  /// Check that two arrays have the same tiles
+  static void check(const TSpArrayD& result, const TSpArrayD& reference) {
+    BOOST_REQUIRE(result.trange() == reference.trange());
+    for(std::size_t i = 0ul; i < reference.size(); ++i) {
+      if(reference.is_zero(i)) {
+        if(! result.is_zero(i))
+          BOOST_CHECK_SMALL(result.find(i).get().norm(), 1.0e-10);
+        continue;
+      }
+      BOOST_REQUIRE(! result.is_zero(i));
+      const TensorD tile = result.find(i).get();
+      const TensorD ref = reference.find(i).get();
+      for(std::size_t j = 0ul; j < ref.size(); ++j)
+        BOOST_CHECK_CLOSE(tile[j], ref[j], 1.0e-10);
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct ExprPlanFixture
+
+BOOST_FIXTURE_TEST_SUITE( expr_plan_suite, ExprPlanFixture )
+
+BOOST_AUTO_TEST_CASE( execute )
+{
+  TSpArrayD a = make_array(trange, 1.0);
+  TSpArrayD b = make_array(trange, 2.0);
+  TSpArrayD c, ref;
+
+  auto plan = make_plan(2.0 * a("i,k") * b("j,k") + a("j,i"), "i,j", world);
+
+  plan.execute(c);
+  ref("i,j") = 2.0 * a("i,k") * b("j,k") + a("j,i");
+  check(c, ref);
+  BOOST_CHECK_EQUAL(plan.builds(), 1ul);
+
+  // New arrays with the same shapes reuse the engine
+  a = make_array(trange, 3.0);
+  b = make_array(trange, 0.5);
+  plan.execute(c);
+  ref("i,j") = 2.0 * a("i,k") * b("j,k") + a("j,i");
+  check(c, ref);
+  BOOST_CHECK_EQUAL(plan.builds(), 1ul);
+  BOOST_CHECK_EQUAL(plan.reuses(), 1ul);
+
+  // A new shape is propagated to the result
+  b = make_array(trange, 1.0, true);
+  plan.execute(c);
+  ref("i,j") = 2.0 * a("i,k") * b("j,k") + a("j,i");
+  check(c, ref);
+  BOOST_CHECK_EQUAL(plan.builds(), 1ul);
+  BOOST_CHECK_EQUAL(plan.shape_updates(), 1ul);
+  BOOST_CHECK(! c.is_zero(std::vector<std::size_t>{2ul, 0ul}));
+
+  // A new tiled range rebuilds the engine
+  const TiledRange tr{ { 0, 4, 8, 12 }, { 0, 4, 8, 12 } };
+  a = make_array(tr, 1.0);
+  b = make_array(tr, 1.0);
+  plan.execute(c);
+  ref("i,j") = 2.0 * a("i,k") * b("j,k") + a("j,i");
+  check(c, ref);
+  BOOST_CHECK_EQUAL(plan.builds(), 2ul);
+}
+
+BOOST_AUTO_TEST_CASE( schedule )
+{
+  detail::SummaSchedule schedule;
+  std::size_t searches = 0ul;
+  auto search = [&searches] () -> std::size_t { ++searches; return 3ul; };
+
+  // The first search is recorded and replayed
+  BOOST_CHECK_EQUAL(schedule.step(1ul, search), 3ul);
+  BOOST_CHECK_EQUAL(schedule.step(1ul, search), 3ul);
+  BOOST_CHECK_EQUAL(searches, 1ul);
+  BOOST_CHECK_EQUAL(schedule.step(2ul, search), 3ul);
+  BOOST_CHECK_EQUAL(searches, 2ul);
+
+  std::vector<bool> left, right;
+  std::vector<double> threshold;
+  std::vector<std::size_t> order;
+  BOOST_CHECK(! schedule.replay_screen(left, right, threshold, order));
+  schedule.record_screen({ true, false }, { }, { 0.5 }, { 1ul, 0ul });
+  BOOST_CHECK(schedule.replay_screen(left, right, threshold, order));
+  BOOST_CHECK(left == std::vector<bool>({ true, false }));
+  BOOST_CHECK(right.empty());
+  BOOST_CHECK(order == std::vector<std::size_t>({ 1ul, 0ul }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/expressions/expr_estimate.h"
+#include "TiledArray/expressions/expr_profile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::expressions::ExprEstimate;
+using TiledArray::expressions::ExprProfile;
+using TiledArray::expressions::ExprProfiler;
+
+struct ExprProfileFixture {
+  ExprProfileFixture() :
+    tr_mk({ TiledRange1{0, 3, 8, 10}, TiledRange1{0, 4, 9, 12, 14} }),
+    tr_kn({ TiledRange1{0, 4, 9, 12, 14}, TiledRange1{0, 2, 7, 11} }),
+    tr_mn({ TiledRange1{0, 3, 8, 10}, TiledRange1{0, 2, 7, 11} })
+  {
+    ExprProfiler::instance().enable();
+  }
+
+  ~ExprProfileFixture() {
+    ExprProfiler::instance().enable(false);
+  }
+
+  TiledRange tr_mk;
+  TiledRange tr_kn;
+  TiledRange tr_mn;
+};
+
+BOOST_FIXTURE_TEST_SUITE( expr_profile_suite , ExprProfileFixture )
+
+BOOST_AUTO_TEST_CASE( contraction_sum )
+{
+  World& world = *GlobalFixture::world;
+  TArrayD a(world, tr_mk), b(world, tr_kn), d(world, tr_mn), c;
+  a.fill(1.0);
+  b.fill(1.0);
+  d.fill(1.0);
+
+  c("i,j") = a("i,k") * b("k,j") + d("i,j");
+  world.gop.fence();
+
+  const std::shared_ptr<ExprProfile> profile = ExprProfiler::instance().last();
+  BOOST_REQUIRE(profile);
+  profile->reduce(world);
+
+  // [+] with the contraction and d as children
+  BOOST_CHECK_EQUAL(profile->children().size(), 2ul);
+  BOOST_CHECK_EQUAL(profile->tiles(), tr_mn.tiles_range().volume());
+  BOOST_CHECK_GE(profile->time(), 0.0);
+
+  // The sum is accumulated in the consumed contraction tiles
+  BOOST_CHECK_EQUAL(profile->in_place(), tr_mn.tiles_range().volume());
+
+  // The contraction counts 2 m n k flops, and its arguments all of their tiles
+  const std::shared_ptr<ExprProfile> cont = profile->children()[0];
+  BOOST_CHECK_EQUAL(cont->children().size(), 2ul);
+  BOOST_CHECK_EQUAL(cont->flops(), 2ull * 10ull * 11ull * 14ull);
+  BOOST_CHECK_EQUAL(cont->children()[0]->tiles(), tr_mk.tiles_range().volume());
+  BOOST_CHECK_EQUAL(cont->children()[1]->tiles(), tr_kn.tiles_range().volume());
+  BOOST_CHECK_EQUAL(cont->children()[0]->in_place(), 0ull);
+  if(world.size() == 1)
+    BOOST_CHECK_EQUAL(cont->bytes(), 0ull);
+
+  // The tree is printed with one line per node
+  std::stringstream ss;
+  profile->print(expressions::ExprOStream(ss));
+  const std::string tree = ss.str();
+  BOOST_CHECK_EQUAL(std::count(tree.begin(), tree.end(), '\n'), 5);
+  BOOST_CHECK_NE(tree.find("GFLOPS"), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( estimate )
+{
+  World& world = *GlobalFixture::world;
+  TArrayD a(world, tr_mk), b(world, tr_kn), d(world, tr_mn), c;
+  a.fill(1.0);
+  b.fill(1.0);
+  d.fill(1.0);
+
+  // The estimate does not evaluate the expression
+  const std::shared_ptr<ExprEstimate> estimate =
+      (a("i,k") * b("k,j") + d("i,j")).estimate("i,j", world);
+  BOOST_REQUIRE(estimate);
+  BOOST_CHECK_EQUAL(estimate->children().size(), 2ul);
+  BOOST_CHECK_EQUAL(estimate->tiles(), tr_mn.tiles_range().volume());
+  BOOST_CHECK_EQUAL(estimate->bytes(), 10ull * 11ull * sizeof(double));
+  BOOST_CHECK_LE(estimate->process_bytes(), estimate->bytes());
+  BOOST_CHECK_GE(estimate->process_bytes() * world.size(), estimate->bytes());
+
+  // The contraction is estimated with the flops that it is profiled with
+  const std::shared_ptr<ExprEstimate> cont = estimate->children()[0];
+  BOOST_CHECK_EQUAL(cont->children().size(), 2ul);
+  BOOST_CHECK_EQUAL(cont->flops(), 2ull * 10ull * 11ull * 14ull);
+  BOOST_CHECK_EQUAL(estimate->total_flops(), cont->flops());
+  if(world.size() == 1)
+    BOOST_CHECK_EQUAL(estimate->total_comm_bytes(), 0ull);
+
+  // Array arguments that are not permuted are not allocated
+  BOOST_CHECK_EQUAL(estimate->children()[1]->bytes(), 0ull);
+  BOOST_CHECK_EQUAL(estimate->peak_bytes(), estimate->bytes() + cont->bytes());
+
+  c("i,j") = a("i,k") * b("k,j") + d("i,j");
+  world.gop.fence();
+  const std::shared_ptr<ExprProfile> profile = ExprProfiler::instance().last();
+  BOOST_REQUIRE(profile);
+  profile->reduce(world);
+  BOOST_CHECK_EQUAL(profile->children()[0]->flops(), cont->flops());
+
+  std::stringstream ss;
+  estimate->print(expressions::ExprOStream(ss));
+  const std::string tree = ss.str();
+  BOOST_CHECK_EQUAL(std::count(tree.begin(), tree.end(), '\n'), 5);
+}
+
+BOOST_AUTO_TEST_CASE( disabled )
+{
+  ExprProfiler::instance().enable(false);
+  ExprProfiler::instance().record("", nullptr);
+
+  World& world = *GlobalFixture::world;
+  TArrayD a(world, tr_mn), c;
+  a.fill(1.0);
+  c("i,j") = 2.0 * a("i,j");
+  world.gop.fence();
+
+  BOOST_CHECK(! ExprProfiler::instance().last());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,8 @@
 #include "tiledarray.h"
 #include "unit_test_config.h"
 #include "range_fixture.h"
+#include <map>
+#include <mutex>
 
 using namespace TiledArray;
 
@@ -607,6 +609,53 @@ BOOST_AUTO_TEST_CASE( assign_sub_block )
     }
   }
 }
+BOOST_AUTO_TEST_CASE( assign_sub_block_in_place )
+{
+  c.fill_local(1);
+  GlobalFixture::world->gop.fence();
+
+  const madness::uniqueidT id = c.id();
+  BlockRange block_range(c.trange().tiles_range(), {3,3,3}, {5,5,5});
+
+  // Keep the tiles outside the block
+  std::vector<std::pair<std::size_t, Tensor<int> > > outside;
+  for(const auto index : *c.pmap()) {
+    if(! block_range.includes(c.trange().tiles_range().idx(index)))
+      outside.emplace_back(index, c.find(index).get());
+  }
+
+  // The block is assigned from the same block of the same array
+  BOOST_REQUIRE_NO_THROW(c("a,b,c").block({3,3,3}, {5,5,5}) =
+      2 * c("a,b,c").block({3,3,3}, {5,5,5}));
+
+  BOOST_CHECK(c.id() == id);
+
+  for(std::size_t index = 0ul; index < block_range.volume(); ++index) {
+    Tensor<int> result_tile = c.find(block_range.ordinal(index)).get();
+    for(std::size_t j = 0ul; j < result_tile.range().volume(); ++j)
+      BOOST_CHECK_EQUAL(result_tile[j], 2);
+  }
+
+  // The tiles outside the block are not copied
+  for(const auto& tile : outside)
+    BOOST_CHECK_EQUAL(c.find(tile.first).get().data(), tile.second.data());
+
+  // A cached result of an expression with the array is not reused after the
+  // block is assigned
+  TArrayI w1, w2;
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = (3 * c("a,b,c")).set_cache());
+  BOOST_REQUIRE_NO_THROW(c("a,b,c").block({3,3,3}, {5,5,5}) =
+      2 * c("a,b,c").block({3,3,3}, {5,5,5}));
+  BOOST_CHECK(c.id() == id);
+  BOOST_REQUIRE_NO_THROW(w2("a,b,c") = (3 * c("a,b,c")).set_cache());
+  for(std::size_t index = 0ul; index < block_range.volume(); ++index) {
+    const std::size_t ordinal = block_range.ordinal(index);
+    Tensor<int> result_tile = w2.find(ordinal).get();
+    for(std::size_t j = 0ul; j < result_tile.range().volume(); ++j)
+      BOOST_CHECK_EQUAL(result_tile[j], 12);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(assign_subblock_block_contract)
 {
   w.fill_local(0.0);
@@ -683,6 +732,71 @@ BOOST_AUTO_TEST_CASE( add )
   }
 }
 
+BOOST_AUTO_TEST_CASE( add_pmap_mismatch )
+{
+  // Distribute a copy of b differently from a
+  TArrayI b_hash(*GlobalFixture::world, tr,
+      std::make_shared<TiledArray::detail::HashPmap>(*GlobalFixture::world,
+      tr.tiles_range().volume()));
+  for(const auto i : *b_hash.pmap())
+    b_hash.set(i, b.find(i));
+
+  // Without a result distribution, the result is distributed like one of
+  // the arguments
+  TArrayI x;
+  BOOST_REQUIRE_NO_THROW(x("a,b,c") = a("a,b,c") + b_hash("a,b,c"));
+  BOOST_CHECK((x.pmap() == a.pmap()) || (x.pmap() == b_hash.pmap()));
+
+  for(std::size_t i = 0ul; i < x.size(); ++i) {
+    TArrayI::value_type x_tile = x.find(i).get();
+    TArrayI::value_type a_tile = a.find(i).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < x_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(x_tile[j], a_tile[j] + b_tile[j]);
+  }
+
+  // The distribution of the result is a preference
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = b_hash("a,b,c") - a("a,b,c"));
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    TArrayI::value_type c_tile = c.find(i).get();
+    TArrayI::value_type a_tile = a.find(i).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(c_tile[j], b_tile[j] - a_tile[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( pmap_hint )
+{
+  std::shared_ptr<TArrayI::pmap_interface> hash =
+      std::make_shared<TiledArray::detail::HashPmap>(*GlobalFixture::world,
+      tr.tiles_range().volume());
+
+  // The result is distributed like an argument or like the hint
+  TArrayI x;
+  BOOST_REQUIRE_NO_THROW(x("a,b,c") =
+      (a("a,b,c") + b("a,b,c")).set_pmap_hint(hash));
+  BOOST_CHECK((x.pmap() == a.pmap()) || (x.pmap() == hash));
+
+  for(std::size_t i = 0ul; i < x.size(); ++i) {
+    TArrayI::value_type x_tile = x.find(i).get();
+    TArrayI::value_type a_tile = a.find(i).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < x_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(x_tile[j], a_tile[j] + b_tile[j]);
+  }
+
+  // The process map set for the result is not replaced by the hint
+  TArrayI y;
+  BOOST_REQUIRE_NO_THROW(y("a,b,c") =
+      (a("a,b,c") - b("a,b,c")).set_pmap_hint(hash).set_pmap(b.pmap()));
+  BOOST_CHECK(y.pmap() == b.pmap());
+}
+
 BOOST_AUTO_TEST_CASE( add_to )
 {
   c("a,b,c") = a("a,b,c");
@@ -1099,6 +1213,91 @@ BOOST_AUTO_TEST_CASE( cont )
   }
 }
 
+BOOST_AUTO_TEST_CASE( cont_summa_pmap )
+{
+  World& world = *GlobalFixture::world;
+  const std::size_t proc_cols = std::min<std::size_t>(world.size(),
+      tr.tiles_range().extent(2));
+
+  // Store copies of a and b in a SUMMA distribution
+  TArrayI a_summa(world, tr, summa_pmap(world, tr.tiles_range(), 1u, 1ul, proc_cols));
+  TArrayI b_summa(world, tr, summa_pmap(world, tr.tiles_range(), 2u, 1ul, proc_cols));
+  for(const auto i : *a_summa.pmap())
+    a_summa.set(i, a.find(i));
+  for(const auto i : *b_summa.pmap())
+    b_summa.set(i, b.find(i));
+
+  TArrayI x, y;
+  BOOST_REQUIRE_NO_THROW(x("i,j") = a("i,k,l") * b("k,l,j"));
+  BOOST_REQUIRE_NO_THROW(y("i,j") = a_summa("i,k,l") * b_summa("k,l,j"));
+
+  for(std::size_t i = 0ul; i < x.size(); ++i) {
+    TArrayI::value_type x_tile = x.find(i).get();
+    TArrayI::value_type y_tile = y.find(i).get();
+
+    BOOST_CHECK_EQUAL(y_tile.range(), x_tile.range());
+    for(std::size_t j = 0ul; j < x_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(y_tile[j], x_tile[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( summa_bcast_cache )
+{
+  const std::size_t capacity = summa_bcast_cache_capacity();
+  summa_bcast_cache_capacity(1ul << 30);
+
+  TArrayI x, y, z;
+  BOOST_REQUIRE_NO_THROW(x("i,j") = a("i,k,l") * b("k,l,j"));
+  BOOST_CHECK_GT(summa_bcast_cache_size(), 0ul);
+  const std::size_t size = summa_bcast_cache_size();
+
+  // The columns of a are reused with another right-hand argument
+  BOOST_REQUIRE_NO_THROW(y("i,j") = a("i,k,l") * (2 * b("k,l,j")));
+  BOOST_REQUIRE_NO_THROW(z("i,j") = a("i,k,l") * b("k,l,j"));
+  BOOST_CHECK_EQUAL(summa_bcast_cache_size(), size);
+
+  for(std::size_t i = 0ul; i < x.size(); ++i) {
+    TArrayI::value_type x_tile = x.find(i).get();
+    TArrayI::value_type y_tile = y.find(i).get();
+    TArrayI::value_type z_tile = z.find(i).get();
+
+    for(std::size_t j = 0ul; j < x_tile.size(); ++j) {
+      BOOST_CHECK_EQUAL(y_tile[j], 2 * x_tile[j]);
+      BOOST_CHECK_EQUAL(z_tile[j], x_tile[j]);
+    }
+  }
+
+  GlobalFixture::world->gop.fence();
+  clear_summa_bcast_cache();
+  BOOST_CHECK_EQUAL(summa_bcast_cache_size(), 0ul);
+  summa_bcast_cache_capacity(capacity);
+}
+
+BOOST_AUTO_TEST_CASE( fused_contract )
+{
+  TArrayI x, y;
+  BOOST_REQUIRE_NO_THROW(x("i,j") = a("i,k,l") * b("k,l,j"));
+  BOOST_REQUIRE_NO_THROW(y("k,l,j") = 2 * b("k,l,j"));
+
+  std::vector<TArrayI> rights{ b, y };
+  std::vector<TArrayI> results;
+  BOOST_REQUIRE_NO_THROW(results = TiledArray::fused_contract(a, "i,k,l",
+      rights, "k,l,j", "i,j"));
+  BOOST_REQUIRE_EQUAL(results.size(), 2ul);
+  BOOST_CHECK(! TiledArray::detail::summa_bcast_scope_active());
+
+  for(std::size_t i = 0ul; i < x.size(); ++i) {
+    TArrayI::value_type x_tile = x.find(i).get();
+    TArrayI::value_type tile0 = results[0].find(i).get();
+    TArrayI::value_type tile1 = results[1].find(i).get();
+
+    for(std::size_t j = 0ul; j < x_tile.size(); ++j) {
+      BOOST_CHECK_EQUAL(tile0[j], x_tile[j]);
+      BOOST_CHECK_EQUAL(tile1[j], 2 * x_tile[j]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE( scale_cont )
 {
   const std::size_t m = a.trange().elements_range().extent(0);
@@ -1213,6 +1412,38 @@ BOOST_AUTO_TEST_CASE( scale_cont )
 }
 
 
+BOOST_AUTO_TEST_CASE( cont_sliced )
+{
+  TArrayI ref_left, ref_right, left, right;
+  ref_left("i,j") = a("i,b,c") * b("j,b,c");
+  ref_right("j,i") = a("i,b,c") * b("j,b,c");
+
+  // Slice the contractions along the first target index, which belongs to
+  // the left and to the right argument, respectively
+  const std::size_t max_memory = TiledArray::contraction_max_memory();
+  TiledArray::contraction_max_memory(1ul);
+  BOOST_REQUIRE_NO_THROW(left("i,j") = a("i,b,c") * b("j,b,c"));
+  BOOST_REQUIRE_NO_THROW(right("j,i") = a("i,b,c") * b("j,b,c"));
+  TiledArray::contraction_max_memory(max_memory);
+
+  BOOST_CHECK_EQUAL(left.trange(), ref_left.trange());
+  BOOST_CHECK_EQUAL(right.trange(), ref_right.trange());
+  for(std::size_t i = 0ul; i < ref_left.size(); ++i) {
+    TArrayI::value_type ref_tile = ref_left.find(i).get();
+    TArrayI::value_type tile = left.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), ref_tile.range());
+    for(std::size_t j = 0ul; j < ref_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], ref_tile[j]);
+  }
+  for(std::size_t i = 0ul; i < ref_right.size(); ++i) {
+    TArrayI::value_type ref_tile = ref_right.find(i).get();
+    TArrayI::value_type tile = right.find(i).get();
+    BOOST_CHECK_EQUAL(tile.range(), ref_tile.range());
+    for(std::size_t j = 0ul; j < ref_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], ref_tile[j]);
+  }
+}
+
 BOOST_AUTO_TEST_CASE( cont_non_uniform1 )
 {
   // Construct the tiled range
@@ -1257,6 +1488,276 @@ BOOST_AUTO_TEST_CASE( cont_non_uniform1 )
 }
 
 
+BOOST_AUTO_TEST_CASE( cont_layers )
+{
+  // Construct the tiled range
+  std::array<std::size_t, 6> tiling1 = {{ 0, 1, 2, 3, 4, 5 }};
+  TiledRange1 tr1_1(tiling1.begin(), tiling1.end());
+  std::array<TiledRange1, 3> tiling3 = {{ tr1_1, tr1_1, tr1_1 }};
+  TiledRange trange(tiling3.begin(), tiling3.end());
+
+  const std::size_t m = 5;
+  const std::size_t k = 5 * 5;
+  const std::size_t n = 5;
+
+  // Construct the test arguments
+  TArrayI left(*GlobalFixture::world, trange);
+  TArrayI right(*GlobalFixture::world, trange);
+
+  // Construct the reference matrices
+  TiledArray::EigenMatrixXi left_ref(m, k);
+  TiledArray::EigenMatrixXi right_ref(n, k);
+
+  // Initialize input
+  rand_fill_matrix_and_array(left_ref, left, 23);
+  rand_fill_matrix_and_array(right_ref, right, 42);
+
+  // Compute the reference result
+  TiledArray::EigenMatrixXi result_ref = left_ref * right_ref.transpose();
+
+  // Check the result for each number of process grid layers
+  for(unsigned int layers = 1u; layers <= unsigned(GlobalFixture::world->size()); ++layers) {
+    TArrayI result;
+    BOOST_REQUIRE_NO_THROW(result("x,y") =
+        (left("x,i,j") * right("y,i,j")).set_summa_layers(layers));
+
+    for(TArrayI::iterator it = result.begin(); it != result.end(); ++it) {
+      const TArrayI::value_type tile = *it;
+      for(Range::const_iterator rit = tile.range().begin(); rit != tile.range().end(); ++rit) {
+        const std::size_t elem_index = result.elements_range().ordinal(*rit);
+        BOOST_CHECK_EQUAL(result_ref.array()(elem_index), tile[*rit]);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( cont_epilogue )
+{
+  // The epilogue sees each result tile in the layout of the target
+  const auto epilogue = [] (TensorI& tile) {
+    for(Range::const_iterator rit = tile.range().begin(); rit != tile.range().end(); ++rit)
+      tile[*rit] = 2 * tile[*rit] + int((*rit)[0]) - int((*rit)[1]);
+  };
+
+  for(const char* target : { "x,y", "y,x" }) {
+    TArrayI reference;
+    reference(target) = a("x,i,j") * b("y,i,j");
+
+    TArrayI result;
+    BOOST_REQUIRE_NO_THROW(result(target) =
+        (a("x,i,j") * b("y,i,j")).set_epilogue(epilogue));
+
+    for(TArrayI::iterator it = result.begin(); it != result.end(); ++it) {
+      const TArrayI::value_type tile = *it;
+      const TArrayI::value_type reference_tile = reference.find(it.ordinal()).get();
+      BOOST_REQUIRE_EQUAL(tile.range(), reference_tile.range());
+      for(Range::const_iterator rit = tile.range().begin(); rit != tile.range().end(); ++rit)
+        BOOST_CHECK_EQUAL(tile[*rit], 2 * reference_tile[*rit] +
+            int((*rit)[0]) - int((*rit)[1]));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( cont_accumulate )
+{
+  for(const char* target : { "x,y", "y,x" }) {
+    TArrayI reference;
+    reference(target) = a("x,i,j") * b("y,i,j");
+
+    // Contractions are accumulated into the result tiles
+    TArrayI result;
+    result(target) = a("x,i,j") * b("y,i,j");
+
+    // A shallow copy of the result, which shares its tiles
+    const TArrayI copy = result;
+
+    BOOST_REQUIRE_NO_THROW(result(target).no_alias() += a("x,i,j") * b("y,i,j"));
+    BOOST_REQUIRE_NO_THROW(result(target).no_alias() += 2 * (a("x,i,j") * b("y,i,j")));
+
+    for(TArrayI::iterator it = result.begin(); it != result.end(); ++it) {
+      const TArrayI::value_type tile = *it;
+      const TArrayI::value_type copy_tile = copy.find(it.ordinal()).get();
+      const TArrayI::value_type reference_tile = reference.find(it.ordinal()).get();
+      BOOST_REQUIRE_EQUAL(tile.range(), reference_tile.range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i) {
+        BOOST_CHECK_EQUAL(tile[i], 4 * reference_tile[i]);
+
+        // The shallow copy keeps its old values
+        BOOST_CHECK_EQUAL(copy_tile[i], reference_tile[i]);
+      }
+    }
+  }
+
+  // Hadamard products are added to the result
+  c("a,b,c") = 2 * a("a,b,c");
+  BOOST_REQUIRE_NO_THROW(c("a,b,c").no_alias() += a("a,b,c") * b("a,b,c"));
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    const TArrayI::value_type tile = c.find(i).get();
+    const TArrayI::value_type a_tile = a.find(i).get();
+    const TArrayI::value_type b_tile = b.find(i).get();
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], 2 * a_tile[j] + a_tile[j] * b_tile[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( cont_cache )
+{
+  TiledArray::clear_expression_cache();
+  const std::size_t capacity = TiledArray::expression_cache_capacity();
+  TiledArray::expression_cache_capacity(2ul);
+
+  TArrayI reference;
+  reference("x,y") = a("x,i,j") * b("y,i,j");
+
+  // Check that an identical expression reuses the cached result
+  TArrayI w1, w2;
+  BOOST_REQUIRE_NO_THROW(w1("x,y") = (a("x,i,j") * b("y,i,j")).set_cache());
+  BOOST_CHECK_EQUAL(TiledArray::expression_cache_size(), 1ul);
+  BOOST_REQUIRE_NO_THROW(w2("x,y") = (a("x,i,j") * b("y,i,j")).set_cache());
+  BOOST_CHECK(w2.id() == w1.id());
+  BOOST_CHECK_EQUAL(TiledArray::expression_cache_size(), 1ul);
+  for(TArrayI::iterator it = w2.begin(); it != w2.end(); ++it) {
+    const TArrayI::value_type tile = *it;
+    const TArrayI::value_type reference_tile = reference.find(it.ordinal()).get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(),
+        reference_tile.begin(), reference_tile.end());
+  }
+
+  // Check that expressions with different factors, annotations, or inputs
+  // are evaluated
+  TArrayI w3, w4, w5;
+  BOOST_REQUIRE_NO_THROW(w3("x,y") = (2 * (a("x,i,j") * b("y,i,j"))).set_cache());
+  BOOST_CHECK(! (w3.id() == w1.id()));
+  BOOST_REQUIRE_NO_THROW(w4("y,x") = (a("x,i,j") * b("y,i,j")).set_cache());
+  BOOST_CHECK(! (w4.id() == w1.id()));
+  TArrayI a2 = a;
+  a2("a,b,c") = a("a,b,c");
+  BOOST_REQUIRE_NO_THROW(w5("x,y") = (a2("x,i,j") * b("y,i,j")).set_cache());
+  BOOST_CHECK(! (w5.id() == w1.id()));
+
+  // Check that the least recently used results are removed
+  BOOST_CHECK_EQUAL(TiledArray::expression_cache_size(), 2ul);
+  TArrayI w6;
+  BOOST_REQUIRE_NO_THROW(w6("x,y") = (a("x,i,j") * b("y,i,j")).set_cache());
+  BOOST_CHECK(! (w6.id() == w1.id()));
+
+  // Check that uncached expressions are always evaluated
+  TArrayI w7;
+  BOOST_REQUIRE_NO_THROW(w7("x,y") = a("x,i,j") * b("y,i,j"));
+  BOOST_CHECK(! (w7.id() == w6.id()));
+
+  TiledArray::clear_expression_cache();
+  BOOST_CHECK_EQUAL(TiledArray::expression_cache_size(), 0ul);
+  TiledArray::expression_cache_capacity(capacity);
+}
+
+BOOST_AUTO_TEST_CASE( lazy_tile_cache )
+{
+  TiledArray::clear_lazy_tile_cache();
+  const std::size_t capacity = TiledArray::lazy_tile_cache_capacity();
+
+  TiledArray::lazy_tile_cache_capacity(0ul);
+  TArrayI reference, reference_sum;
+  reference("a,b,c") = 2 * a("c,b,a");
+  reference_sum("a,b,c") = 2 * a("c,b,a") + b("a,b,c");
+
+  auto check = [] (const TArrayI& x, const TArrayI& ref) {
+    for(TArrayI::const_iterator it = x.begin(); it != x.end(); ++it) {
+      const TArrayI::value_type tile = *it;
+      const TArrayI::value_type ref_tile = ref.find(it.ordinal()).get();
+      BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(),
+          ref_tile.begin(), ref_tile.end());
+    }
+  };
+
+  // Check that the converted local tiles of a are cached once
+  TiledArray::lazy_tile_cache_capacity(1ul << 30);
+  TArrayI w1, w2, w3;
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = 2 * a("c,b,a"));
+  GlobalFixture::world->gop.fence();
+  const std::size_t size = TiledArray::lazy_tile_cache_size();
+  BOOST_CHECK_EQUAL(size > 0ul, a.pmap()->local_size() > 0ul);
+  BOOST_REQUIRE_NO_THROW(w2("a,b,c") = 2 * a("c,b,a"));
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(TiledArray::lazy_tile_cache_size(), size);
+  check(w1, reference);
+  check(w2, reference);
+
+  // Check that consuming a converted tile does not modify the cached tile
+  BOOST_REQUIRE_NO_THROW(w3("a,b,c") = 2 * a("c,b,a") + b("a,b,c"));
+  check(w3, reference_sum);
+  BOOST_REQUIRE_NO_THROW(w2("a,b,c") = 2 * a("c,b,a"));
+  check(w2, reference);
+
+  // Check that tiles that exceed the capacity are not cached
+  TiledArray::clear_lazy_tile_cache();
+  TiledArray::lazy_tile_cache_capacity(1ul);
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = 2 * a("c,b,a"));
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(TiledArray::lazy_tile_cache_size(), 0ul);
+  check(w1, reference);
+
+  TiledArray::clear_lazy_tile_cache();
+  TiledArray::lazy_tile_cache_capacity(capacity);
+}
+
+BOOST_AUTO_TEST_CASE( permutation_cache )
+{
+  TArrayI reference;
+  reference("a,b,c") = 2 * a("c,b,a");
+
+  auto check = [] (const TArrayI& x, const TArrayI& ref) {
+    for(TArrayI::const_iterator it = x.begin(); it != x.end(); ++it) {
+      const TArrayI::value_type tile = *it;
+      const TArrayI::value_type ref_tile = ref.find(it.ordinal()).get();
+      BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(),
+          ref_tile.begin(), ref_tile.end());
+    }
+  };
+
+  // Check that the permuted local tiles are cached once
+  BOOST_CHECK_EQUAL(a.permutation_cache_capacity(), 0ul);
+  a.permutation_cache_capacity(1ul << 30);
+  BOOST_CHECK_EQUAL(a.permutation_cache_capacity(), 1ul << 30);
+  TArrayI w1, w2;
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = 2 * a("c,b,a"));
+  GlobalFixture::world->gop.fence();
+  const std::size_t size = a.permutation_cache_size();
+  BOOST_CHECK_EQUAL(size > 0ul, a.pmap()->local_size() > 0ul);
+  BOOST_REQUIRE_NO_THROW(w2("a,b,c") = 2 * a("c,b,a"));
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(a.permutation_cache_size(), size);
+  check(w1, reference);
+  check(w2, reference);
+
+  // Check that tiles without a permutation are not cached
+  TArrayI w3;
+  BOOST_REQUIRE_NO_THROW(w3("a,b,c") = 2 * a("a,b,c"));
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(a.permutation_cache_size(), size);
+
+  // Check that the cache is cleared when tiles are modified
+  TArrayI x(*GlobalFixture::world, tr);
+  x.permutation_cache_capacity(1ul << 30);
+  for(const std::size_t i : *x.pmap())
+    x.accumulate(i, a.find(i).get().clone());
+  GlobalFixture::world->gop.fence();
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = 2 * x("c,b,a"));
+  GlobalFixture::world->gop.fence();
+  for(const std::size_t i : *x.pmap())
+    x.accumulate(i, b.find(i).get().clone());
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(x.permutation_cache_size(), 0ul);
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = 2 * x("c,b,a"));
+  reference("a,b,c") = 2 * (a("c,b,a") + b("c,b,a"));
+  check(w1, reference);
+
+  // Check that disabling the cache releases the cached tiles
+  x.permutation_cache_capacity(0ul);
+  BOOST_CHECK_EQUAL(x.permutation_cache_size(), 0ul);
+}
+
 BOOST_AUTO_TEST_CASE( cont_non_uniform2 )
 {
   // Construct the tiled range
@@ -1437,6 +1938,26 @@ BOOST_AUTO_TEST_CASE( outer_product )
   BOOST_CHECK_EQUAL(ew, ew_test);
 }
 
+BOOST_AUTO_TEST_CASE( outer_product_permute )
+{
+  // Generate Eigen matrices from input arrays.
+  EigenMatrixXi ev = make_matrix(v);
+  EigenMatrixXi eu = make_matrix(u);
+
+  // Generate the expected result
+  EigenMatrixXi ew_test = 2 * ev * eu.transpose();
+
+  // Test that permuted, scaled, and accumulated outer products work
+  BOOST_REQUIRE_NO_THROW(w("j,i") = u("i") * v("j"));
+  BOOST_REQUIRE_NO_THROW(w("j,i") += u("i") * v("j"));
+
+  GlobalFixture::world->gop.fence();
+
+  EigenMatrixXi ew = make_matrix(w);
+
+  BOOST_CHECK_EQUAL(ew, ew_test);
+}
+
 BOOST_AUTO_TEST_CASE( dot )
 {
   // Test the dot expression function
@@ -1481,6 +2002,203 @@ BOOST_AUTO_TEST_CASE( dot_expr )
   BOOST_CHECK_EQUAL(result, expected);
 }
 
+BOOST_AUTO_TEST_CASE( dot_permute )
+{
+  // The right-hand tiles are permuted in the reduction
+  int result = 0;
+  BOOST_REQUIRE_NO_THROW(result = a("a,b,c").dot(b("c,a,b")).get() );
+  TArrayI reference;
+  reference("a,b,c") = b("c,a,b");
+  BOOST_CHECK_EQUAL(result, a("a,b,c").dot(reference("a,b,c")).get());
+
+  BOOST_REQUIRE_NO_THROW(result = a("a,b,c").dot(2 * b("b,c,a")).get() );
+  reference("a,b,c") = 2 * b("b,c,a");
+  BOOST_CHECK_EQUAL(result, a("a,b,c").dot(reference("a,b,c")).get());
+}
+
+BOOST_AUTO_TEST_CASE( dot_scal )
+{
+  // Scaled products over all indices are scaled dot products
+  int result = 0;
+  BOOST_REQUIRE_NO_THROW(result = 2 * (a("a,b,c") * b("c,b,a")) );
+  const int expected = a("a,b,c").dot(b("c,b,a")).get();
+  BOOST_CHECK_EQUAL(result, 2 * expected);
+
+  BOOST_REQUIRE_NO_THROW(result += 3 * (a("a,b,c") * b("c,b,a")) );
+  BOOST_CHECK_EQUAL(result, 5 * expected);
+  BOOST_REQUIRE_NO_THROW(result -= 5 * (a("a,b,c") * b("c,b,a")) );
+  BOOST_CHECK_EQUAL(result, 0);
+}
+
+BOOST_AUTO_TEST_CASE( reduce_all )
+{
+  // Several reductions are computed from one evaluation of the expression
+  typedef TArrayI::value_type value_type;
+  TiledArray::detail::ReductionTuple<int, int, int> result;
+  BOOST_REQUIRE_NO_THROW(result = (2 * a("a,b,c")).reduce_all(
+      TiledArray::SumReduction<value_type>(),
+      TiledArray::MinReduction<value_type>(),
+      TiledArray::MaxReduction<value_type>()).get());
+
+  BOOST_CHECK_EQUAL(std::get<0>(result), (2 * a("a,b,c")).sum().get());
+  BOOST_CHECK_EQUAL(std::get<1>(result), (2 * a("a,b,c")).min().get());
+  BOOST_CHECK_EQUAL(std::get<2>(result), (2 * a("a,b,c")).max().get());
+}
+
+BOOST_AUTO_TEST_CASE( eval_to_callback )
+{
+  TArrayI ref;
+  ref("a,b,c") = 2 * (a("a,b,c") + b("a,b,c"));
+
+  // Collect the tiles that are passed to the callback
+  std::mutex lock;
+  std::map<std::size_t, TArrayI::value_type> tiles;
+  BOOST_REQUIRE_NO_THROW((2 * (a("a,b,c") + b("a,b,c"))).eval_to_callback(
+      [&] (const std::size_t index, const TArrayI::value_type& tile) {
+        std::lock_guard<std::mutex> guard(lock);
+        tiles.emplace(index, tile);
+      }));
+
+  std::size_t count = tiles.size();
+  GlobalFixture::world->gop.sum(count);
+  BOOST_CHECK_EQUAL(count, ref.size());
+
+  for(const auto& tile : tiles) {
+    const TArrayI::value_type ref_tile = ref.find(tile.first).get();
+    BOOST_REQUIRE_EQUAL(tile.second.range(), ref_tile.range());
+    for(std::size_t j = 0ul; j < ref_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile.second[j], ref_tile[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( sum_over )
+{
+  TArrayI x, y, z;
+  BOOST_REQUIRE_NO_THROW(x("a,c") = a("a,b,c").sum_over("b"));
+  BOOST_REQUIRE_NO_THROW(y("c,a") = a("a,b,c").sum_over("b"));
+  BOOST_REQUIRE_NO_THROW(z("b") = (2 * a("a,b,c")).sum_over("c,a"));
+  BOOST_CHECK_EQUAL(x.trange().tiles_range().rank(), 2u);
+  BOOST_CHECK_EQUAL(z.trange().tiles_range().rank(), 1u);
+
+  // Compute the expected sums from the elements of a
+  const Range& range = a.trange().elements_range();
+  const std::size_t n0 = range.extent(0), n1 = range.extent(1), n2 = range.extent(2);
+  std::vector<int> xy_ref(n0 * n2, 0), z_ref(n1, 0);
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    TArrayI::value_type tile = a.find(i).get();
+    for(Range::const_iterator it = tile.range().begin(); it != tile.range().end(); ++it) {
+      const std::size_t i0 = (*it)[0] - range.lobound(0);
+      const std::size_t i1 = (*it)[1] - range.lobound(1);
+      const std::size_t i2 = (*it)[2] - range.lobound(2);
+      xy_ref[i0 * n2 + i2] += tile[*it];
+      z_ref[i1] += 2 * tile[*it];
+    }
+  }
+
+  for(std::size_t i = 0ul; i < x.size(); ++i) {
+    TArrayI::value_type x_tile = x.find(i).get();
+    for(Range::const_iterator it = x_tile.range().begin(); it != x_tile.range().end(); ++it)
+      BOOST_CHECK_EQUAL(x_tile[*it], xy_ref[((*it)[0] - range.lobound(0)) * n2 +
+          ((*it)[1] - range.lobound(2))]);
+  }
+
+  for(std::size_t i = 0ul; i < y.size(); ++i) {
+    TArrayI::value_type y_tile = y.find(i).get();
+    for(Range::const_iterator it = y_tile.range().begin(); it != y_tile.range().end(); ++it)
+      BOOST_CHECK_EQUAL(y_tile[*it], xy_ref[((*it)[1] - range.lobound(0)) * n2 +
+          ((*it)[0] - range.lobound(2))]);
+  }
+
+  for(std::size_t i = 0ul; i < z.size(); ++i) {
+    TArrayI::value_type z_tile = z.find(i).get();
+    for(Range::const_iterator it = z_tile.range().begin(); it != z_tile.range().end(); ++it)
+      BOOST_CHECK_EQUAL(z_tile[*it], z_ref[(*it)[0] - range.lobound(1)]);
+  }
+
+  // All variables cannot be summed
+  BOOST_CHECK_THROW(x("a,c") = a("a,b,c").sum_over("a,b,c"), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( assign_async )
+{
+  TArrayI d;
+  TiledArray::expressions::ExprHandle<TArrayI> hc = c("a,b,c").assign_async(a("a,b,c") + b("a,b,c"));
+  TiledArray::expressions::ExprHandle<TArrayI> hd = d("a,b,c").assign_async(a("a,b,c") - b("a,b,c"));
+
+  // The results are assigned before their tiles are evaluated
+  BOOST_CHECK(c.is_initialized());
+  BOOST_CHECK(d.is_initialized());
+
+  // Expressions of the results depend on their tiles
+  TArrayI e;
+  e("a,b,c") = c("a,b,c") + d("a,b,c");
+
+  hc.wait();
+  hd.wait();
+  BOOST_CHECK(hc.ready());
+  BOOST_CHECK(hd.ready());
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    TArrayI::value_type c_tile = c.find(i).get();
+    TArrayI::value_type d_tile = d.find(i).get();
+    TArrayI::value_type e_tile = e.find(i).get();
+    TArrayI::value_type a_tile = a.find(i).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j) {
+      BOOST_CHECK_EQUAL(c_tile[j], a_tile[j] + b_tile[j]);
+      BOOST_CHECK_EQUAL(d_tile[j], a_tile[j] - b_tile[j]);
+      BOOST_CHECK_EQUAL(e_tile[j], 2 * a_tile[j]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( expr_batch )
+{
+  TArrayI t, d;
+  TiledArray::expressions::ExprBatch batch(2ul);
+  batch.temporary(t)
+       .assign(c("a,b,c"), 2 * t("a,b,c"))
+       .assign(d("a,b,c"), a("a,b,c") - b("a,b,c"))
+       .accumulate(d("a,b,c"), t("a,b,c"))
+       .assign(t("a,b,c"), a("a,b,c") + b("a,b,c"));
+
+  // The terms that read t must be submitted before the term that writes it
+  const std::vector<std::size_t> order = batch.schedule();
+  BOOST_REQUIRE_EQUAL(order.size(), 4ul);
+  BOOST_CHECK_EQUAL(order[0], 0ul);
+  BOOST_CHECK_EQUAL(order.back(), 3ul);
+}
+
+BOOST_AUTO_TEST_CASE( expr_batch_run )
+{
+  TArrayI t, d;
+  TiledArray::expressions::ExprBatch batch(2ul);
+  batch.temporary(t)
+       .assign(t("a,b,c"), a("a,b,c") + b("a,b,c"))
+       .assign(d("a,b,c"), a("a,b,c") - b("a,b,c"))
+       .assign(c("a,b,c"), 2 * t("a,b,c"))
+       .accumulate(d("a,b,c"), t("a,b,c"));
+  BOOST_CHECK_EQUAL(batch.size(), 4ul);
+  BOOST_REQUIRE_NO_THROW(batch.run());
+  BOOST_CHECK_EQUAL(batch.size(), 0ul);
+
+  // The temporary has been released
+  BOOST_CHECK(! t.is_initialized());
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    TArrayI::value_type c_tile = c.find(i).get();
+    TArrayI::value_type d_tile = d.find(i).get();
+    TArrayI::value_type a_tile = a.find(i).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j) {
+      BOOST_CHECK_EQUAL(c_tile[j], 2 * (a_tile[j] + b_tile[j]));
+      BOOST_CHECK_EQUAL(d_tile[j], 2 * a_tile[j]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE( dot_contr )
 {
   int result = 0;
@@ -0,0 +1,149 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expressions_cont_order.cpp
+ *  Feb 22, 2017
+ *
+ */
+
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::expressions::ContOperand;
+using TiledArray::expressions::ContOrder;
+using TiledArray::expressions::VariableList;
+using TiledArray::expressions::cont_chain_order;
+
+struct ContOrderFixture {
+
+  /// Make an operand summary with tiles of 10 elements
+  static ContOperand make_operand(const std::string& vars,
+      const std::vector<double>& extents, const double density = 1.0)
+  {
+    const VariableList v(vars);
+    ContOperand result;
+    result.vars.assign(v.begin(), v.end());
+    result.extents = extents;
+    for(const double extent : extents)
+      result.tiles.push_back(extent / 10.0);
+    result.density = density;
+    return result;
+  }
+
+  /// Make a matrix with a tile for each block of 10 elements
+  static TArrayI make_matrix(const std::size_t m, const std::size_t n, const int seed) {
+    std::vector<std::size_t> rows, cols;
+    for(std::size_t i = 0ul; i <= m; i += 10ul)
+      rows.push_back(i);
+    for(std::size_t i = 0ul; i <= n; i += 10ul)
+      cols.push_back(i);
+    TiledRange trange{ TiledRange1(rows.begin(), rows.end()),
+        TiledRange1(cols.begin(), cols.end()) };
+
+    TArrayI result(*GlobalFixture::world, trange);
+    result.init_tiles([=] (const Range& range) {
+      TensorI tile(range);
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = int((range.lobound()[0] + range.lobound()[1] + i + seed) % 5) - 2;
+      return tile;
+    });
+    return result;
+  }
+
+  /// Check that two arrays are equal
+  static void check_equal(const TArrayI& result, TArrayI& reference) {
+    BOOST_CHECK_EQUAL(result.trange(), reference.trange());
+    for(TArrayI::const_iterator it = result.begin(); it != result.end(); ++it) {
+      const TensorI tile = *it;
+      const TensorI reference_tile = reference.find(it.ordinal()).get();
+      BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(),
+          reference_tile.begin(), reference_tile.end());
+    }
+  }
+
+}; // ContOrderFixture
+
+BOOST_FIXTURE_TEST_SUITE( expressions_cont_order_suite, ContOrderFixture )
+
+BOOST_AUTO_TEST_CASE( cost_model )
+{
+  const VariableList target("a,b");
+
+  // A narrow left operand should be contracted first
+  const ContOperand a = make_operand("a,i", { 10, 1000 });
+  const ContOperand b = make_operand("i,j", { 1000, 1000 });
+  const ContOperand c = make_operand("j,b", { 1000, 1000 });
+  BOOST_CHECK(cont_chain_order(a, b, c, target, ContOrder::right) == ContOrder::left);
+
+  // A narrow right operand should be contracted first
+  const ContOperand d = make_operand("a,i", { 1000, 1000 });
+  const ContOperand e = make_operand("j,b", { 1000, 10 });
+  BOOST_CHECK(cont_chain_order(d, b, e, target, ContOrder::left) == ContOrder::right);
+
+  // Outer products should be avoided
+  const ContOperand f = make_operand("a,i", { 100, 100 });
+  const ContOperand g = make_operand("j,b", { 100, 100 });
+  const ContOperand h = make_operand("i,j", { 100, 100 });
+  BOOST_CHECK(cont_chain_order(f, g, h, target, ContOrder::left) != ContOrder::left);
+
+  // Sparse operands should be contracted first
+  const ContOperand s = make_operand("i,j", { 1000, 1000 }, 0.01);
+  const ContOperand t = make_operand("j,b", { 1000, 1000 }, 0.01);
+  const ContOperand u = make_operand("a,i", { 1000, 1000 });
+  BOOST_CHECK(cont_chain_order(u, s, t, target, ContOrder::left) == ContOrder::right);
+
+  // Check that chains with equal costs keep their order
+  BOOST_CHECK(cont_chain_order(f, h, g, target, ContOrder::right) == ContOrder::right);
+
+  // Check that Hadamard products are not reordered
+  const ContOperand x = make_operand("a,b", { 1000, 10 });
+  BOOST_CHECK(cont_chain_order(x, x, a, VariableList("a,i,b"),
+      ContOrder::left) == ContOrder::left);
+}
+
+BOOST_AUTO_TEST_CASE( reordered_chain )
+{
+  TArrayI a = make_matrix(20, 60, 1);
+  TArrayI b = make_matrix(60, 60, 2);
+  TArrayI c = make_matrix(60, 10, 3);
+
+  TArrayI ab, reference_left, reference_right;
+  ab("a,j") = a("a,i") * b("i,j");
+  reference_left("a,b") = ab("a,j") * c("j,b");
+  TArrayI bc;
+  bc("i,b") = b("i,j") * c("j,b");
+  reference_right("a,b") = a("a,i") * bc("i,b");
+
+  // Check that both orders of the chain give the exact result
+  TArrayI left, right, transposed;
+  BOOST_REQUIRE_NO_THROW(left("a,b") = (a("a,i") * b("i,j")) * c("j,b"));
+  check_equal(left, reference_left);
+  BOOST_REQUIRE_NO_THROW(right("a,b") = a("a,i") * (b("i,j") * c("j,b")));
+  check_equal(right, reference_right);
+  BOOST_REQUIRE_NO_THROW(transposed("b,a") = a("a,i") * b("i,j") * c("j,b"));
+  TArrayI reference_transposed;
+  reference_transposed("b,a") = reference_left("a,b");
+  check_equal(transposed, reference_transposed);
+
+  // Check that the outer product order gives the exact result
+  TArrayI outer;
+  BOOST_REQUIRE_NO_THROW(outer("a,b") = a("a,i") * c("j,b") * b("i,j"));
+  check_equal(outer, reference_left);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -28,6 +28,7 @@
 #include "range_fixture.h"
 #include "sparse_tile.h"
 #include "TiledArray/special/kronecker_delta.h"
+#include "TiledArray/special/diagonal_array.h"
 
 using namespace TiledArray;
 
@@ -242,4 +243,104 @@ BOOST_AUTO_TEST_CASE( outer_product_factories )
   }
 }
 
+BOOST_AUTO_TEST_CASE( diagonal_contraction )
+{
+  // compare the local tiles of two arrays
+  auto check_equal = [] (const TArrayD& result, const TArrayD& reference) {
+    for(const auto i : *result.pmap()) {
+      const auto tile = result.find(i).get();
+      const auto reference_tile = reference.find(i).get();
+      for(std::size_t j = 0ul; j < tile.size(); ++j)
+        BOOST_CHECK_EQUAL(tile[j], reference_tile[j]);
+    }
+  };
+
+  // these can only work if nproc == 1 since KroneckerDelta does not travel
+  if (GlobalFixture::world->nproc() == 1) {
+    TArrayD r;
+    BOOST_CHECK_NO_THROW(r("a,c") = delta1e("a,b") * e2("b,c"));
+    check_equal(r, e2);
+
+    BOOST_CHECK_NO_THROW(r("a,c") = e2("a,b") * delta1e("b,c"));
+    check_equal(r, e2);
+
+    BOOST_CHECK_NO_THROW(r("a,c") = delta1e("b,a") * e2("b,c"));
+    check_equal(r, e2);
+  }
+
+  auto diag = diagonal_tile_array<double, DensePolicy>(*GlobalFixture::world, trange2e, 3.0);
+  auto dense_diag = dense_diagonal_array<double>(*GlobalFixture::world, trange2e, 3.0);
+  TArrayD r, reference;
+
+  BOOST_CHECK_NO_THROW(r("a,c") = diag("a,b") * e2("b,c"));
+  reference("a,c") = dense_diag("a,b") * e2("b,c");
+  check_equal(r, reference);
+
+  BOOST_CHECK_NO_THROW(r("a,c") = e2("a,b") * diag("b,c"));
+  reference("a,c") = e2("a,b") * dense_diag("b,c");
+  check_equal(r, reference);
+
+  BOOST_CHECK_NO_THROW(r("a,c") = e2("b,a") * diag("c,b"));
+  reference("a,c") = e2("b,a") * dense_diag("c,b");
+  check_equal(r, reference);
+}
+
+BOOST_AUTO_TEST_CASE( float_double )
+{
+  // The result of an operation on float and double tiles is a double tile
+  static_assert(std::is_same<decltype(add(std::declval<TensorF>(),
+      std::declval<TensorD>())), TensorD>::value,
+      "The sum of float and double tensors is not a double tensor");
+  static_assert(std::is_same<decltype(gemm(std::declval<TensorF>(),
+      std::declval<TensorD>(), 1.0, std::declval<math::GemmHelper>())),
+      TensorD>::value,
+      "The product of float and double tensors is not a double tensor");
+
+  // compare the local tiles of two arrays
+  auto check_equal = [] (const auto& result, const auto& reference) {
+    for(const auto i : *result.pmap()) {
+      const auto tile = result.find(i).get();
+      const auto reference_tile = reference.find(i).get();
+      for(std::size_t j = 0ul; j < tile.size(); ++j)
+        BOOST_CHECK_EQUAL(tile[j], reference_tile[j]);
+    }
+  };
+
+  // The elements are integers, so the float and double results are exact
+  TArrayF f(*GlobalFixture::world, trange2e);
+  random_fill(f);
+  GlobalFixture::world->gop.fence();
+  TArrayD d;
+  d("a,b") = f("a,b");
+
+  TArrayD r, reference;
+  BOOST_CHECK_NO_THROW(r("a,b") = f("a,b") + e2("a,b"));
+  reference("a,b") = d("a,b") + e2("a,b");
+  check_equal(r, reference);
+
+  BOOST_CHECK_NO_THROW(r("a,b") = 2 * (e2("a,b") - f("b,a")));
+  reference("a,b") = 2 * (e2("a,b") - d("b,a"));
+  check_equal(r, reference);
+
+  BOOST_CHECK_NO_THROW(r("a,b") = f("a,b") * e2("a,b"));
+  reference("a,b") = d("a,b") * e2("a,b");
+  check_equal(r, reference);
+
+  BOOST_CHECK_NO_THROW(r("a,b") = f("a,k") * e2("k,b"));
+  reference("a,b") = d("a,k") * e2("k,b");
+  check_equal(r, reference);
+
+  BOOST_CHECK_NO_THROW(r("a,b") = e2("k,a") * f("b,k"));
+  reference("a,b") = e2("k,a") * d("b,k");
+  check_equal(r, reference);
+
+  // A double result is converted once when it is assigned to a float array
+  TArrayF fr;
+  BOOST_CHECK_NO_THROW(fr("a,b") = f("a,b") + e2("a,b"));
+  reference("a,b") = d("a,b") + e2("a,b");
+  TArrayD dr;
+  BOOST_CHECK_NO_THROW(dr("a,b") = fr("a,b"));
+  check_equal(dr, reference);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
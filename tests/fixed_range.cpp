@@ -0,0 +1,106 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fixed_range.cpp
+ *  Mar 9, 2017
+ *
+ */
+
+#include "TiledArray/fixed_range.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct FixedRangeFixture {
+
+  FixedRangeFixture() :
+    range(std::vector<std::size_t>{ 1, 2, 0, 3 },
+        std::vector<std::size_t>{ 4, 5, 6, 7 })
+  { }
+
+  ~FixedRangeFixture() { }
+
+  Range range;
+}; // FixedRangeFixture
+
+BOOST_FIXTURE_TEST_SUITE( fixed_range_suite, FixedRangeFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  BOOST_REQUIRE_NO_THROW(FixedRange<4> r(range));
+  FixedRange<4> r(range);
+
+  BOOST_CHECK_EQUAL(r.rank(), 4u);
+  BOOST_CHECK_EQUAL(r.volume(), range.volume());
+  for(unsigned int i = 0u; i < 4u; ++i) {
+    BOOST_CHECK_EQUAL(r.lobound()[i], range.lobound_data()[i]);
+    BOOST_CHECK_EQUAL(r.upbound()[i], range.upbound_data()[i]);
+    BOOST_CHECK_EQUAL(r.extent()[i], range.extent_data()[i]);
+    BOOST_CHECK_EQUAL(r.stride()[i], range.stride_data()[i]);
+  }
+
+#ifdef TA_EXCEPTION_ERROR
+  // Check that the rank must match
+  BOOST_CHECK_THROW(FixedRange<2> r2(range), Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
+BOOST_AUTO_TEST_CASE( ordinal )
+{
+  FixedRange<4> r(range);
+
+  // Check that the ordinals and coordinate indices match those of range
+  for(Range::const_iterator it = range.begin(); it != range.end(); ++it) {
+    const Range::index& i = *it;
+    const FixedRange<4>::index fi = {{ i[0], i[1], i[2], i[3] }};
+    const std::size_t o = range.ordinal(i);
+
+    BOOST_CHECK(r.includes(i[0], i[1], i[2], i[3]));
+    BOOST_CHECK(r.includes(fi));
+    BOOST_CHECK_EQUAL(r.ordinal(i[0], i[1], i[2], i[3]), o);
+    BOOST_CHECK_EQUAL(r.ordinal(fi), o);
+    BOOST_CHECK_EQUAL(range.ordinal(i[0], i[1], i[2], i[3]), o);
+    BOOST_CHECK(r.idx(o) == fi);
+  }
+
+  // Check indices outside the range
+  BOOST_CHECK(! r.includes(0, 2, 0, 3));
+  BOOST_CHECK(! r.includes(1, 5, 0, 3));
+  BOOST_CHECK(! r.includes(3, 4, 6, 3));
+  BOOST_CHECK(! range.includes(3, 4, 5, 7));
+  BOOST_CHECK(range.includes(3, 4, 5, 6));
+}
+
+BOOST_AUTO_TEST_CASE( matrix )
+{
+  Tensor<int> t(Range(std::vector<std::size_t>{ 3, 4 },
+      std::vector<std::size_t>{ 7, 9 }));
+  FixedRange<2> r(t.range());
+
+  // Check that a matrix is filled in row-major order
+  int value = 0;
+  for(std::size_t i = 3ul; i < 7ul; ++i)
+    for(std::size_t j = 4ul; j < 9ul; ++j)
+      t[r.ordinal(i, j)] = value++;
+
+  for(std::size_t o = 0ul; o < t.size(); ++o)
+    BOOST_CHECK_EQUAL(t[o], int(o));
+  BOOST_CHECK_EQUAL(t(6, 8), int(t.size()) - 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
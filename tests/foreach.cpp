@@ -20,6 +20,7 @@
 #include "tiledarray.h"
 #include "unit_test_config.h"
 #include "range_fixture.h"
+#include <atomic>
 
 
 using namespace TiledArray;
@@ -341,4 +342,202 @@ BOOST_AUTO_TEST_CASE( foreach_binary_sparse_inplace )
 
 }
 
+BOOST_AUTO_TEST_CASE( foreach_estimated_unary_sparse )
+{
+  TSpArrayI result = foreach_estimated(c,
+      [] (TensorI& result, const TensorI& arg) { result = arg.scale(2); },
+      [] (const float norm) { return 2.0f * norm; });
+
+  for(std::size_t index = 0ul; index < result.size(); ++index) {
+    BOOST_CHECK_EQUAL(result.is_zero(index), c.is_zero(index));
+    if(result.is_zero(index) || ! result.is_local(index))
+      continue;
+
+    TensorI tile0 = c.find(index).get();
+    TensorI tile = result.find(index).get();
+    for(std::size_t i = 0; i < tile.size(); ++i) {
+      BOOST_CHECK_EQUAL(tile[i], 2 * tile0[i]);
+    }
+  }
+
+  // Tiles that are estimated to be zero are not computed
+  std::atomic<int> count(0);
+  TSpArrayI zero = foreach_estimated(c,
+      [&count] (TensorI& result, const TensorI& arg) {
+        ++count;
+        result = arg.clone();
+      },
+      [] (const float) { return 0.0f; });
+  GlobalFixture::world->gop.fence();
+
+  BOOST_CHECK_EQUAL(count.load(), 0);
+  for(std::size_t index = 0ul; index < zero.size(); ++index)
+    BOOST_CHECK(zero.is_zero(index));
+}
+
+BOOST_AUTO_TEST_CASE( foreach_estimated_binary_sparse )
+{
+  TSpArrayI result = foreach_estimated(c, d,
+      [] (TensorI& result, const TensorI& l, const TensorI& r) { result = l.add(r); },
+      [] (const float l, const float r) { return l + r; });
+
+  for(std::size_t index = 0ul; index < result.size(); ++index) {
+    BOOST_CHECK_EQUAL(result.is_zero(index), c.is_zero(index) || d.is_zero(index));
+    if(result.is_zero(index) || ! result.is_local(index))
+      continue;
+
+    TensorI tilec = c.find(index).get();
+    TensorI tiled = d.find(index).get();
+    TensorI tile = result.find(index).get();
+    for(std::size_t i = 0; i < tile.size(); ++i) {
+      BOOST_CHECK_EQUAL(tile[i], tilec[i] + tiled[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( elementwise_dense )
+{
+  TArrayI result = elementwise([] (const int x, const int y, const int z) {
+    return 2 * (x + y) - z;
+  }, a, b, a);
+
+  for(auto index : * result.pmap()) {
+    TensorI tilea = a.find(index).get();
+    TensorI tileb = b.find(index).get();
+    TensorI tile = result.find(index).get();
+    for(std::size_t i = 0; i < tile.size(); ++i) {
+      BOOST_CHECK_EQUAL(tile[i], 2 * (tilea[i] + tileb[i]) - tilea[i]);
+    }
+  }
+
+}
+
+
+BOOST_AUTO_TEST_CASE( elementwise_sparse )
+{
+  TSpArrayD result = elementwise([] (const int x, const int y) -> double {
+    return 2.0 * x - y;
+  }, c, d);
+
+  for(auto index : * result.pmap()) {
+    if(c.is_zero(index) && d.is_zero(index))
+      BOOST_CHECK(result.is_zero(index));
+    if(result.is_zero(index))
+      continue;
+
+    TensorI tilec = (c.is_zero(index) ? TensorI() : c.find(index).get());
+    TensorI tiled = (d.is_zero(index) ? TensorI() : d.find(index).get());
+    TensorD tile = result.find(index).get();
+    for(std::size_t i = 0; i < tile.size(); ++i) {
+      const int x = (tilec.empty() ? 0 : tilec[i]);
+      const int y = (tiled.empty() ? 0 : tiled[i]);
+      BOOST_CHECK_EQUAL(tile[i], 2.0 * x - y);
+    }
+  }
+
+}
+
+BOOST_AUTO_TEST_CASE( truncate_sparse )
+{
+  TSpArrayI e(*GlobalFixture::world, tr, c.shape());
+  for(auto index : * e.pmap()) {
+    if(e.is_zero(index))
+      continue;
+    if(index % 3ul)
+      e.set(index, c.find(index));
+    else
+      e.set(index, TensorI(e.trange().make_tile_range(index), 0));
+  }
+  GlobalFixture::world->gop.fence();
+
+  // An expression with the array that is cached before the truncation
+  TSpArrayI w1, w2;
+  BOOST_REQUIRE_NO_THROW(w1("a,b,c") = (3 * e("a,b,c")).set_cache());
+
+  const madness::uniqueidT id = e.id();
+  BOOST_REQUIRE_NO_THROW(e.truncate());
+
+  // The array is truncated in place
+  BOOST_CHECK(e.id() == id);
+
+  // The cached result of the expression is not reused after the truncation
+  BOOST_REQUIRE_NO_THROW(w2("a,b,c") = (3 * e("a,b,c")).set_cache());
+  for(std::size_t index = 0ul; index < e.size(); ++index) {
+    BOOST_CHECK_EQUAL(w2.is_zero(index), e.is_zero(index));
+    if(w2.is_zero(index))
+      continue;
+    const TensorI tile = w2.find(index).get();
+    const TensorI c_tile = c.find(index).get();
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      BOOST_CHECK_EQUAL(tile[i], 3 * c_tile[i]);
+  }
+
+  for(std::size_t index = 0ul; index < e.size(); ++index) {
+    BOOST_CHECK_EQUAL(e.is_zero(index), c.is_zero(index) || ((index % 3ul) == 0ul));
+    if(e.is_zero(index) || ! e.is_local(index))
+      continue;
+
+    // The remaining tiles are not copied
+    BOOST_CHECK_EQUAL(e.find(index).get().data(), c.find(index).get().data());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( cached_tile_norms )
+{
+  TSpArrayI result = foreach(c, [] (TensorI& result, const TensorI& arg) -> float {
+    result = arg.scale(2);
+    return result.norm();
+  });
+
+  // The norms computed by foreach are cached with the tiles
+  for(auto index : * result.pmap()) {
+    if(result.is_zero(index))
+      continue;
+    BOOST_CHECK_CLOSE(result.tile_norm(index),
+        float(result.find(index).get().norm()), 1.0e-4);
+  }
+
+  // Tiles modified in place do not keep their cached norms
+  TSpArrayI copy = result;
+  foreach_inplace(result, [] (TensorI& tile) -> float {
+    tile.scale_to(2);
+    return tile.norm();
+  });
+  for(auto index : * copy.pmap()) {
+    if(! copy.is_zero(index))
+      BOOST_CHECK_LT(copy.tile_norm(index), 0.0f);
+  }
+
+  // truncate uses the cached norms
+  const madness::uniqueidT id = result.id();
+  result.truncate();
+  BOOST_CHECK(result.id() == id);
+  for(std::size_t index = 0ul; index < result.size(); ++index)
+    BOOST_CHECK_EQUAL(result.is_zero(index), c.is_zero(index));
+}
+
+BOOST_AUTO_TEST_CASE( to_sparse_move )
+{
+  TArrayI e(*GlobalFixture::world, tr);
+  for(auto index : * e.pmap()) {
+    if(index % 3ul)
+      e.set(index, a.find(index));
+    else
+      e.set(index, TensorI(e.trange().make_tile_range(index), 0));
+  }
+
+  TSpArrayI result = to_sparse(std::move(e));
+  BOOST_CHECK(! e.is_initialized());
+
+  for(std::size_t index = 0ul; index < result.size(); ++index) {
+    BOOST_CHECK_EQUAL(result.is_zero(index), (index % 3ul) == 0ul);
+    if(result.is_zero(index) || ! result.is_local(index))
+      continue;
+
+    // The tiles are moved, not cloned
+    BOOST_CHECK_EQUAL(result.find(index).get().data(), a.find(index).get().data());
+    BOOST_CHECK_GE(result.tile_norm(index), 0.0f);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  hierarchical_pmap.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/pmap/hierarchical_pmap.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct HierarchicalPmapFixture {
+
+  HierarchicalPmapFixture() { }
+
+};
+
+
+// =============================================================================
+// HierarchicalPmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( hierarchical_pmap_suite, HierarchicalPmapFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+    BOOST_REQUIRE_NO_THROW(TiledArray::detail::HierarchicalPmap pmap(* GlobalFixture::world, tiles, 2ul));
+    TiledArray::detail::HierarchicalPmap pmap(* GlobalFixture::world, tiles, 2ul);
+    BOOST_CHECK_EQUAL(pmap.rank(), GlobalFixture::world->rank());
+    BOOST_CHECK_EQUAL(pmap.procs(), GlobalFixture::world->size());
+    BOOST_CHECK_EQUAL(pmap.size(), tiles);
+    BOOST_CHECK_EQUAL(pmap.node_procs(), 2ul);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  std::vector<ProcessID> p_owner(size);
+
+  for(std::size_t node_procs = 1ul; node_procs <= 3ul; ++node_procs) {
+    for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+      TiledArray::detail::HierarchicalPmap pmap(* GlobalFixture::world, tiles,
+          node_procs);
+
+      std::size_t node = 0ul;
+      for(std::size_t tile = 0; tile < tiles; ++tile) {
+        std::fill(p_owner.begin(), p_owner.end(), 0);
+        p_owner[rank] = pmap.owner(tile);
+        // check that the value is in range
+        BOOST_CHECK_LT(p_owner[rank], size);
+        GlobalFixture::world->gop.sum(p_owner.data(), size);
+
+        // Make sure everyone agrees on who owns what.
+        for(std::size_t p = 0ul; p < size; ++p)
+          BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+
+        // The tiles of each node are contiguous
+        BOOST_CHECK_GE(pmap.owner(tile) / node_procs, node);
+        node = pmap.owner(tile) / node_procs;
+        BOOST_CHECK_EQUAL(pmap.is_node_local(tile), node == (rank / node_procs));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( local_size )
+{
+  for(std::size_t node_procs = 1ul; node_procs <= 3ul; ++node_procs) {
+    for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+      TiledArray::detail::HierarchicalPmap pmap(* GlobalFixture::world, tiles,
+          node_procs);
+
+      std::size_t total_size = pmap.local_size();
+      GlobalFixture::world->gop.sum(total_size);
+
+      // Check that the total number of elements in all local groups is equal to
+      // the number of tiles in the map.
+      BOOST_CHECK_EQUAL(total_size, tiles);
+      BOOST_CHECK(pmap.empty() == (pmap.local_size() == 0ul));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  ProcessID tile_owners[100];
+
+  for(std::size_t node_procs = 1ul; node_procs <= 3ul; ++node_procs) {
+    for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+      TiledArray::detail::HierarchicalPmap pmap(* GlobalFixture::world, tiles,
+          node_procs);
+
+      // Check that all local elements map to this rank
+      for(detail::HierarchicalPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+        BOOST_CHECK(pmap.is_local(*it));
+      }
+
+      std::fill_n(tile_owners, tiles, 0);
+      for(detail::HierarchicalPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        tile_owners[*it] += GlobalFixture::world->rank();
+      }
+
+      GlobalFixture::world->gop.sum(tile_owners, tiles);
+      for(std::size_t tile = 0; tile < tiles; ++tile) {
+        BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
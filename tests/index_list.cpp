@@ -0,0 +1,146 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  index_list.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/expressions/index_list.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include <numeric>
+
+using namespace TiledArray;
+using namespace TiledArray::expressions;
+using namespace TiledArray::indices;
+
+struct IndexListFixture {
+
+  IndexListFixture() :
+    world(* GlobalFixture::world),
+    trange({ TiledRange1{ 0, 2, 5 }, TiledRange1{ 0, 2, 5 } })
+  { }
+
+  ~IndexListFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill an array with values that depend on the element indices
+  static void fill(TArrayD& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = double(((*idx)[0] * 5ul + (*idx)[1] * 3ul) % 7ul) - 3.0;
+      *it = tile;
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct IndexListFixture
+
+BOOST_FIXTURE_TEST_SUITE( index_list_suite, IndexListFixture )
+
+BOOST_AUTO_TEST_CASE( index_list )
+{
+  typedef decltype(make_index_list(i, Index<'a','1'>(), k)) list_type;
+  BOOST_CHECK_EQUAL(list_type::size(), 3u);
+  BOOST_CHECK_EQUAL(list_type::string(), "i,a1,k");
+  BOOST_CHECK_EQUAL(list_type::variable_list(), VariableList("i,a1,k"));
+  BOOST_CHECK_EQUAL(list_type::position<decltype(k)>(), 2u);
+  BOOST_CHECK_EQUAL(list_type::position<decltype(j)>(), 3u);
+
+  // Check that permutations match those of variable lists
+  constexpr auto ijk = make_index_list(i, j, k);
+  constexpr auto kij = make_index_list(k, i, j);
+  static_assert(decltype(ijk)::positions(kij)[0] == 2u,
+      "The index positions are not computed at compile time");
+  BOOST_CHECK_EQUAL(ijk.permutation(kij),
+      VariableList("i,j,k").permutation(VariableList("k,i,j")));
+  BOOST_CHECK_EQUAL(kij.permutation(ijk),
+      VariableList("k,i,j").permutation(VariableList("i,j,k")));
+  BOOST_CHECK(! ijk.permutation(ijk));
+}
+
+BOOST_AUTO_TEST_CASE( contraction_layout )
+{
+  // c(j,a,i) = a(i,k,l) * b(l,k,j,a)
+  constexpr auto contraction = make_index_contraction(make_index_list(i, k, l),
+      make_index_list(l, k, j, a), make_index_list(j, a, i));
+  static_assert(contraction.contracted_rank() == 2u,
+      "The contraction layout is not computed at compile time");
+  static_assert(! contraction.permute_left(),
+      "The contraction layout is not computed at compile time");
+  BOOST_CHECK_EQUAL(contraction.left_rank(), 3u);
+  BOOST_CHECK_EQUAL(contraction.right_rank(), 4u);
+  BOOST_CHECK_EQUAL(contraction.result_rank(), 3u);
+  BOOST_CHECK(contraction.permute_right());
+  BOOST_CHECK(contraction.permute_result());
+  BOOST_CHECK(! contraction.left_permutation());
+  BOOST_CHECK_EQUAL(contraction.right_permutation(), Permutation({1, 0, 2, 3}));
+  BOOST_CHECK_EQUAL(contraction.result_permutation(), Permutation({2, 0, 1}));
+
+  const math::GemmHelper gemm_helper = contraction.gemm_helper();
+  BOOST_CHECK_EQUAL(gemm_helper.num_contract_ranks(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE( tile_contraction )
+{
+  // c(i,j) = a(k,i) * b(j,k)
+  constexpr auto contraction = make_index_contraction(make_index_list(k, i),
+      make_index_list(j, k), make_index_list(i, j));
+  TensorD left(Range(4ul, 3ul)), right(Range(5ul, 4ul));
+  std::iota(left.data(), left.data() + left.size(), 1.0);
+  std::iota(right.data(), right.data() + right.size(), -7.0);
+
+  const TensorD result = contraction.contract(left, right, 2.0);
+  BOOST_REQUIRE_EQUAL(result.range(), Range(3ul, 5ul));
+  for(std::size_t m = 0ul; m < 3ul; ++m) {
+    for(std::size_t n = 0ul; n < 5ul; ++n) {
+      double expected = 0.0;
+      for(std::size_t p = 0ul; p < 4ul; ++p)
+        expected += left(p, m) * right(n, p);
+      BOOST_CHECK_CLOSE(result(m, n), 2.0 * expected, 1.0e-10);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( array_expression )
+{
+  TArrayD a(world, trange), b(world, trange);
+  fill(a);
+  fill(b);
+
+  TArrayD reference, result;
+  reference("i,j") = a("i,k") * b("j,k") + a("i,j");
+  BOOST_REQUIRE_NO_THROW(result(i, j) = a(i, k) * b(j, k) + a(i, j));
+
+  for(std::size_t t = 0ul; t < result.size(); ++t) {
+    if(! result.is_local(t))
+      continue;
+    const TensorD tile = result.find(t).get();
+    const TensorD ref_tile = reference.find(t).get();
+    for(std::size_t e = 0ul; e < tile.size(); ++e)
+      BOOST_CHECK_CLOSE(tile[e], ref_tile[e], 1.0e-10);
+  }
+
+  // Check that the number of indices is checked
+  BOOST_CHECK_THROW(a(i, j, k), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,183 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/pmap/layered_cyclic_pmap.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct LayeredCyclicPmapFixture {
+
+  LayeredCyclicPmapFixture() { }
+
+  /// Compute the process rows and columns of a layer
+  static void layer_grid(const std::size_t layers, const std::size_t x,
+      const std::size_t y, std::size_t& p_rows, std::size_t& p_cols)
+  {
+    const std::size_t nprocs = GlobalFixture::world->size() / layers;
+
+    // Compute the limits for process rows
+    const std::size_t min_proc_rows =
+        std::max<std::size_t>(((nprocs + y - 1ul) / y), 1ul);
+    const std::size_t max_proc_rows = std::min<std::size_t>(nprocs, x);
+
+    // Compute process rows and process columns
+    p_rows = std::max<std::size_t>(min_proc_rows,
+        std::min<std::size_t>(std::sqrt(nprocs * x / y), max_proc_rows));
+    p_cols = std::max<std::size_t>(nprocs / p_rows, 1ul);
+  }
+
+};
+
+
+// =============================================================================
+// LayeredCyclicPmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( layered_cyclic_pmap_suite, LayeredCyclicPmapFixture )
+
+BOOST_AUTO_TEST_CASE( layer_partition )
+{
+  for(std::size_t n = 1ul; n < 20ul; ++n) {
+    for(std::size_t layers = 1ul; layers <= n; ++layers) {
+      BOOST_CHECK_EQUAL(detail::LayeredCyclicPmap::layer_begin(0ul, layers, n), 0ul);
+      BOOST_CHECK_EQUAL(detail::LayeredCyclicPmap::layer_begin(layers, layers, n), n);
+
+      for(std::size_t layer = 0ul; layer < layers; ++layer) {
+        const std::size_t begin = detail::LayeredCyclicPmap::layer_begin(layer, layers, n);
+        const std::size_t end = detail::LayeredCyclicPmap::layer_begin(layer + 1ul, layers, n);
+
+        // Check that the blocks are non-empty and nearly equal in size
+        BOOST_CHECK_GE(end - begin, n / layers);
+        BOOST_CHECK_LE(end - begin, (n + layers - 1ul) / layers);
+
+        // Check that the indices in the block map to the layer
+        for(std::size_t i = begin; i < end; ++i)
+          BOOST_CHECK_EQUAL(detail::LayeredCyclicPmap::layer_index(i, layers, n), layer);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  for(std::size_t layers = 1ul; layers <= std::size_t(GlobalFixture::world->size()); ++layers) {
+    for(std::size_t x = 1ul; x < 10ul; ++x) {
+      for(std::size_t y = layers; y < 10ul; ++y) {
+        std::size_t p_rows = 0ul, p_cols = 0ul;
+        layer_grid(layers, x, y, p_rows, p_cols);
+
+        BOOST_REQUIRE_NO_THROW(detail::LayeredCyclicPmap pmap(* GlobalFixture::world, x, y, p_rows, p_cols, layers, true));
+        detail::LayeredCyclicPmap pmap(* GlobalFixture::world, x, y, p_rows, p_cols, layers, true);
+        BOOST_CHECK_EQUAL(pmap.rank(), GlobalFixture::world->rank());
+        BOOST_CHECK_EQUAL(pmap.procs(), GlobalFixture::world->size());
+        BOOST_CHECK_EQUAL(pmap.size(), x * y);
+        BOOST_CHECK_EQUAL(pmap.nlayers_proc(), layers);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  ProcessID* p_owner = new ProcessID[size];
+
+  // Check various pmap sizes
+  for(std::size_t layers = 1ul; layers <= size; ++layers) {
+    for(std::size_t x = layers; x < 10ul; ++x) {
+      for(std::size_t y = layers; y < 10ul; ++y) {
+        std::size_t p_rows = 0ul, p_cols = 0ul;
+        layer_grid(layers, x, y, p_rows, p_cols);
+
+        const std::size_t tiles = x * y;
+        for(int col_layers = 0; col_layers < 2; ++col_layers) {
+          detail::LayeredCyclicPmap pmap(* GlobalFixture::world, x, y, p_rows,
+              p_cols, layers, col_layers);
+
+          for(std::size_t tile = 0; tile < tiles; ++tile) {
+            std::fill_n(p_owner, size, 0);
+            p_owner[rank] = pmap.owner(tile);
+            // check that the value is in range
+            BOOST_CHECK_LT(p_owner[rank], size);
+            GlobalFixture::world->gop.sum(p_owner, size);
+
+            // Make sure everyone agrees on who owns what.
+            for(std::size_t p = 0ul; p < size; ++p)
+              BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+
+            // Check that the tile is owned by the layer of its column or row
+            const std::size_t layer = (col_layers ?
+                detail::LayeredCyclicPmap::layer_index(tile % y, layers, y) :
+                detail::LayeredCyclicPmap::layer_index(tile / y, layers, x));
+            BOOST_CHECK_EQUAL(pmap.owner(tile) / (p_rows * p_cols), layer);
+          }
+        }
+      }
+    }
+  }
+
+  delete [] p_owner;
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  ProcessID tile_owners[100];
+
+  for(std::size_t layers = 1ul; layers <= std::size_t(GlobalFixture::world->size()); ++layers) {
+    for(std::size_t x = layers; x < 10ul; ++x) {
+      for(std::size_t y = layers; y < 10ul; ++y) {
+        std::size_t p_rows = 0ul, p_cols = 0ul;
+        layer_grid(layers, x, y, p_rows, p_cols);
+
+        const std::size_t tiles = x * y;
+        for(int col_layers = 0; col_layers < 2; ++col_layers) {
+          detail::LayeredCyclicPmap pmap(* GlobalFixture::world, x, y, p_rows,
+              p_cols, layers, col_layers);
+
+          // Check that the total number of local tiles is equal to the number
+          // of tiles in the map.
+          std::size_t total_size = pmap.local_size();
+          GlobalFixture::world->gop.sum(total_size);
+          BOOST_CHECK_EQUAL(total_size, tiles);
+
+          // Check that all local elements map to this rank
+          for(detail::LayeredCyclicPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+            BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+          }
+
+          std::fill_n(tile_owners, tiles, 0);
+          for(detail::LayeredCyclicPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+            tile_owners[*it] += GlobalFixture::world->rank();
+          }
+
+          GlobalFixture::world->gop.sum(tile_owners, tiles);
+          for(std::size_t tile = 0; tile < tiles; ++tile) {
+            BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+          }
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  low_rank_tile.cpp
+ *  Feb 28, 2017
+ *
+ */
+
+#include "TiledArray/low_rank_tile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct LowRankTileFixture {
+  typedef LowRankTile<double> tile_type;
+  typedef tile_type::matrix_type matrix_type;
+
+  LowRankTileFixture() :
+    left_range({ 0, 0 }, { 12, 9 }), right_range({ 0, 0 }, { 9, 7 })
+  { }
+
+  /// Construct a dense tensor of rank \c rank
+  static TensorD make_tensor(const Range& range, const int rank) {
+    const matrix_type u = matrix_type::Random(range.extent_data()[0], rank);
+    const matrix_type v = matrix_type::Random(range.extent_data()[1], rank);
+    TensorD result(range);
+    math::eigen_map(result.data(), u.rows(), v.rows()) = u * v.transpose();
+    return result;
+  }
+
+  /// The largest absolute difference of the elements of \c tile and \c tensor
+  static double max_error(const tile_type& tile, const TensorD& tensor) {
+    const TensorD dense = static_cast<TensorD>(tile);
+    BOOST_REQUIRE_EQUAL(dense.range(), tensor.range());
+    return dense.subt(tensor).abs_max();
+  }
+
+  Range left_range;
+  Range right_range;
+}; // struct LowRankTileFixture
+
+BOOST_FIXTURE_TEST_SUITE( low_rank_tile_suite, LowRankTileFixture )
+
+BOOST_AUTO_TEST_CASE( compress )
+{
+  const TensorD tensor = make_tensor(left_range, 3);
+  const tile_type tile(tensor, 1.0e-10);
+
+  BOOST_CHECK(! tile.empty());
+  BOOST_CHECK_EQUAL(tile.range(), left_range);
+  BOOST_CHECK_EQUAL(tile.rank(), 3ul);
+  BOOST_CHECK_SMALL(max_error(tile, tensor), 1.0e-10);
+  BOOST_CHECK_EQUAL(tile_bytes(tile), 3ul * (12ul + 9ul) * sizeof(double));
+  BOOST_CHECK_CLOSE(tile.norm(), tensor.norm(), 1.0e-8);
+
+  // Zero tiles have rank zero
+  const tile_type zero(left_range);
+  BOOST_CHECK_EQUAL(zero.rank(), 0ul);
+  BOOST_CHECK_EQUAL(zero.norm(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( permute )
+{
+  const TensorD tensor = make_tensor(left_range, 2);
+  const tile_type tile(tensor, 1.0e-10);
+  const Permutation perm({ 1, 0 });
+
+  const tile_type result = permute(tile, perm);
+  BOOST_CHECK_EQUAL(result.rank(), 2ul);
+  BOOST_CHECK_SMALL(max_error(result, tensor.permute(perm)), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( add )
+{
+  const TensorD a = make_tensor(left_range, 2);
+  const TensorD b = make_tensor(left_range, 3);
+  const tile_type x(a, 1.0e-10), y(b, 1.0e-10);
+
+  const tile_type sum = add(x, y);
+  BOOST_CHECK_LE(sum.rank(), 5ul);
+  BOOST_CHECK_SMALL(max_error(sum, a.add(b)), 1.0e-10);
+
+  const tile_type difference = subt(x, y);
+  BOOST_CHECK_SMALL(max_error(difference, a.subt(b)), 1.0e-10);
+
+  // The sum of a tile and itself does not increase the rank
+  tile_type z = x.clone();
+  add_to(z, x);
+  BOOST_CHECK_EQUAL(z.rank(), 2ul);
+  BOOST_CHECK_SMALL(max_error(z, a.scale(2.0)), 1.0e-10);
+  BOOST_CHECK_SMALL(max_error(x, a), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( scale )
+{
+  const TensorD tensor = make_tensor(left_range, 2);
+  const tile_type tile(tensor, 1.0e-10);
+
+  BOOST_CHECK_SMALL(max_error(scale(tile, 3.0), tensor.scale(3.0)), 1.0e-10);
+  BOOST_CHECK_SMALL(max_error(neg(tile), tensor.neg()), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( contract )
+{
+  const TensorD a = make_tensor(left_range, 2);
+  const TensorD b = make_tensor(right_range, 4);
+  const tile_type x(a, 1.0e-10), y(b, 1.0e-10);
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  const tile_type product = gemm(x, y, 2.0, gemm_helper);
+  const TensorD reference = a.gemm(b, 2.0, gemm_helper);
+  BOOST_CHECK_EQUAL(product.rank(), 2ul);
+  BOOST_CHECK_SMALL(max_error(product, reference), 1.0e-9);
+
+  // Accumulate in factored form
+  tile_type result = product.clone();
+  gemm(result, x, y, 2.0, gemm_helper);
+  BOOST_CHECK_EQUAL(result.rank(), 2ul);
+  BOOST_CHECK_SMALL(max_error(result, reference.scale(2.0)), 1.0e-9);
+
+  // Transposed arguments
+  const math::GemmHelper trans_helper(madness::cblas::Trans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+  const TensorD c = make_tensor(Range({ 0, 0 }, { 12, 5 }), 3);
+  const tile_type w(c, 1.0e-10);
+  BOOST_CHECK_SMALL(max_error(gemm(x, w, 1.0, trans_helper),
+      a.gemm(c, 1.0, trans_helper)), 1.0e-9);
+}
+
+BOOST_AUTO_TEST_CASE( costs )
+{
+  TiledRange trange{ { 0, 12, 24 }, { 0, 9, 18 } };
+  DistArray<tile_type, DensePolicy> array(*GlobalFixture::world, trange);
+  for(auto it = array.begin(); it != array.end(); ++it)
+    *it = tile_type(make_tensor(it.make_range(), 1 + int(it.ordinal())), 1.0e-10);
+
+  const std::vector<unsigned long> ranks = low_rank_ranks(array);
+  BOOST_REQUIRE_EQUAL(ranks.size(), 4ul);
+  for(std::size_t i = 0ul; i < ranks.size(); ++i)
+    BOOST_CHECK_EQUAL(ranks[i], 1ul + i);
+
+  const std::vector<double> costs = low_rank_costs(array);
+  for(std::size_t i = 0ul; i < costs.size(); ++i)
+    BOOST_CHECK_EQUAL(costs[i], (array.is_local(i) ? (1.0 + i) * 21.0 : 0.0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  mapped_array.cpp
+ *  Feb 17, 2017
+ *
+ */
+
+#include "TiledArray/mapped_array.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct MappedArrayFixture {
+
+  MappedArrayFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 }, { 0, 4, 8, 9 } },
+    path("mapped_array_test.tamap")
+  { }
+
+  ~MappedArrayFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill the local tiles of \c array with known values
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = double(it.ordinal() * 1000ul + i);
+      *it = tile;
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+  std::string path;
+}; // struct MappedArrayFixture
+
+BOOST_FIXTURE_TEST_SUITE( mapped_array_suite, MappedArrayFixture )
+
+BOOST_AUTO_TEST_CASE( tensor_view )
+{
+  std::shared_ptr<std::vector<double> > data =
+      std::make_shared<std::vector<double> >(24ul, 3.0);
+  TensorD view(Range(2, 3, 4), data->data(), data);
+  BOOST_CHECK(view.is_view());
+  BOOST_CHECK_EQUAL(view.data(), data->data());
+  BOOST_CHECK_EQUAL(detail::tile_bytes(view), 0ul);
+
+  // Check that the data is shared and kept alive by the view
+  std::weak_ptr<std::vector<double> > weak = data;
+  data.reset();
+  BOOST_CHECK(! weak.expired());
+  view[0] = 1.0;
+  BOOST_CHECK_EQUAL(view[0], 1.0);
+  BOOST_CHECK_EQUAL(view[1], 3.0);
+
+  // Check that clones are not views
+  TensorD copy = view.clone();
+  BOOST_CHECK(! copy.is_view());
+  BOOST_CHECK_EQUAL(copy[0], 1.0);
+
+  view = TensorD();
+  BOOST_CHECK(weak.expired());
+}
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD array(world, trange);
+  fill(array);
+  save_mapped_array(array, path);
+
+  TArrayD result;
+  load_mapped_array(result, world, path);
+  BOOST_CHECK_EQUAL(result.trange(), array.trange());
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const TensorD tile = (*it).get();
+    const TensorD reference = array.find(it.ordinal()).get();
+    BOOST_CHECK(tile.is_view());
+    BOOST_CHECK_EQUAL(tile.range(), reference.range());
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      BOOST_CHECK_EQUAL(tile[i], reference[i]);
+  }
+
+  // Check that the mapped tiles can be used in expressions
+  TArrayD sum;
+  sum("a,b,c") = result("a,b,c") + array("a,b,c");
+  for(auto it = sum.begin(); it != sum.end(); ++it) {
+    const TensorD tile = (*it).get();
+    const TensorD reference = array.find(it.ordinal()).get();
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      BOOST_CHECK_EQUAL(tile[i], 2.0 * reference[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    if(i % 2ul)
+      norms[i] = 100.0f;
+  TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+  fill(array);
+  save_mapped_array(array, path);
+
+  TSpArrayD result;
+  load_mapped_array(result, world, path);
+  for(std::size_t i = 0ul; i < norms.size(); ++i) {
+    BOOST_CHECK_EQUAL(result.is_zero(i), array.is_zero(i));
+    if(result.is_zero(i))
+      continue;
+    const TensorD tile = result.find(i).get();
+    const TensorD reference = array.find(i).get();
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], reference[j]);
+  }
+
+  // Check that the policy is checked
+  TArrayD dense;
+  BOOST_CHECK_THROW(load_mapped_array(dense, world, path), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
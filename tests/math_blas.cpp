@@ -24,6 +24,8 @@
  */
 
 #include "TiledArray/math/blas.h"
+#include "TiledArray/math/parallel_gemm.h"
+#include "TiledArray/math/screened_gemm.h"
 #include "tiledarray.h"
 #include "unit_test_config.h"
 
@@ -350,4 +352,81 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( complex_gemm_ld , T, floating_point_types )
   delete [] c;
 }
 
+BOOST_AUTO_TEST_CASE( block_max )
+{
+  const double a[] = { 1, 2, 3,
+                       4, 0, 6 };
+  const std::vector<double> result = TiledArray::math::block_max(2, 3, a, 2);
+  BOOST_REQUIRE_EQUAL(result.size(), 2ul);
+  BOOST_CHECK_EQUAL(result[0], 4.0);
+  BOOST_CHECK_EQUAL(result[1], 6.0);
+}
+
+BOOST_AUTO_TEST_CASE( screened_gemm )
+{
+  // Block diagonal, nonnegative arguments with tiny off-diagonal blocks
+  std::vector<double> a(m * k), b(k * n), c(m * n), reference(m * n);
+  for(integer i = 0; i < m; ++i)
+    for(integer l = 0; l < k; ++l)
+      a[i * k + l] = (i / 8 == l / 8 ? double(1 + (i + l) % 7) :
+          (std::abs(i / 8 - l / 8) == 1 ? 1.0e-12 : 0.0));
+  for(integer l = 0; l < k; ++l)
+    for(integer j = 0; j < n; ++j)
+      b[l * n + j] = (l / 8 == j / 8 ? double(1 + (l * j) % 5) : 0.0);
+
+  const double threshold = 1.0e-6;
+  TiledArray::math::gemm(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      m, n, k, 2.0, a.data(), k, b.data(), n, 0.0, reference.data(), n);
+  TiledArray::math::screened_gemm(m, n, k, 2.0, a.data(), b.data(),
+      threshold, 8, c.data());
+
+  // Elements that are screened out are below the threshold, and the other
+  // elements are exact
+  std::size_t zeros = 0ul;
+  for(integer i = 0; i < m * n; ++i) {
+    if(c[i] == 0.0 && reference[i] != 0.0) {
+      BOOST_CHECK_LT(reference[i], threshold);
+      ++zeros;
+    } else {
+      BOOST_CHECK_CLOSE(c[i], reference[i], tol);
+    }
+  }
+  BOOST_CHECK_GT(zeros, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( parallel_gemm )
+{
+  // The multiply-adds of the product exceed the default threshold
+  const integer pm = 520, pn = 530, pk = 512;
+  std::vector<double> a(pk * pm), b(pn * pk), c(pm * pn), reference(pm * pn);
+  rand_fill(a.data(), a.size(), 29);
+  rand_fill(b.data(), b.size(), 47);
+  rand_fill(c.data(), c.size(), 99);
+  reference = c;
+
+  // Transposed arguments test the offsets of the blocks of a and b
+  TiledArray::math::gemm(madness::cblas::Trans, madness::cblas::Trans,
+      pm, pn, pk, 2.0, a.data(), pm, b.data(), pk, 1.0, reference.data(), pn);
+  BOOST_REQUIRE_NO_THROW(TiledArray::math::parallel_gemm(madness::cblas::Trans,
+      madness::cblas::Trans, pm, pn, pk, 2.0, a.data(), pm, b.data(), pk, 1.0,
+      c.data(), pn));
+
+  for(integer i = 0; i < pm * pn; ++i)
+    BOOST_CHECK_CLOSE(c[i], reference[i], tol);
+}
+
+BOOST_AUTO_TEST_CASE( blas_thread_scope )
+{
+  // Small products are single-threaded, unless the BLAS threads are not
+  // controlled
+  {
+    TiledArray::math::BlasThreadScope threads(m, n, k);
+    BOOST_CHECK_EQUAL(threads.threads(),
+        (TiledArray::math::blas_max_threads() > 0 ? 1 : 0));
+  }
+
+  // Threads are released at the end of the scope
+  BOOST_CHECK_EQUAL(TiledArray::math::detail::blas_busy_threads().load(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,226 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  math_simd_vector_op.cpp
+ *  Jan 30, 2017
+ *
+ */
+
+#include "TiledArray/math/simd_vector_op.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using TiledArray::math::SimdIsa;
+
+struct SimdVectorOpFixture {
+
+  SimdVectorOpFixture() : isa(TiledArray::math::simd_isa()) { }
+
+  ~SimdVectorOpFixture() { TiledArray::math::simd_isa(isa); }
+
+  /// The instruction sets supported by this build and processor
+  static std::vector<SimdIsa> isa_list() {
+    std::vector<SimdIsa> result;
+    for(SimdIsa i : { SimdIsa::scalar, SimdIsa::neon, SimdIsa::avx2, SimdIsa::avx512 })
+      if(TiledArray::math::simd_isa_supported(i))
+        result.push_back(i);
+    return result;
+  }
+
+  /// Vector sizes that include all loop remainders of the kernels
+  static std::vector<std::size_t> size_list() {
+    return std::vector<std::size_t>{ 0ul, 1ul, 3ul, 7ul, 8ul, 15ul, 16ul, 31ul,
+        33ul, 64ul, 65ul, 1000ul, 4097ul };
+  }
+
+  template <typename T>
+  static std::vector<T> make_vector(const std::size_t n, const int seed) {
+    std::vector<T> result(n);
+    GlobalFixture::world->srand(seed);
+    for(T& value : result)
+      value = T(GlobalFixture::world->rand() % 101 - 50) / T(8);
+    return result;
+  }
+
+  template <typename T>
+  static void check_kernels() {
+    const T factor = T(3) / T(4);
+    for(SimdIsa i : isa_list()) {
+      TiledArray::math::simd_isa(i);
+      BOOST_CHECK(TiledArray::math::simd_isa() == i);
+
+      for(std::size_t n : size_list()) {
+        const std::vector<T> a = make_vector<T>(n, 27);
+        const std::vector<T> b = make_vector<T>(n, 42);
+        std::vector<T> c(n);
+
+        // Check binary and scaled binary kernels
+        TiledArray::math::simd_binary_vector_op(TiledArray::math::simd_add, n,
+            c.data(), a.data(), b.data());
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], a[j] + b[j]);
+        TiledArray::math::simd_binary_vector_op(TiledArray::math::simd_subt, n,
+            c.data(), a.data(), b.data());
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], a[j] - b[j]);
+        TiledArray::math::simd_scal_binary_vector_op(TiledArray::math::simd_mult,
+            n, c.data(), a.data(), b.data(), factor);
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], (a[j] * b[j]) * factor);
+
+        // Check in-place and scale kernels
+        c = a;
+        TiledArray::math::simd_scal_inplace_vector_op(TiledArray::math::simd_add,
+            n, c.data(), b.data(), factor);
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], (a[j] + b[j]) * factor);
+        c = a;
+        TiledArray::math::simd_inplace_vector_op(TiledArray::math::simd_mult, n,
+            c.data(), b.data());
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], a[j] * b[j]);
+        TiledArray::math::simd_scale_vector(n, c.data(), a.data(), factor);
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], a[j] * factor);
+        TiledArray::math::simd_scale_vector_to(n, c.data(), factor);
+        for(std::size_t j = 0ul; j < n; ++j)
+          BOOST_CHECK_EQUAL(c[j], (a[j] * factor) * factor);
+
+        // Check reductions; the sums are exact in both float and double
+        T sum = 0, dot = 0;
+        for(std::size_t j = 0ul; j < n; ++j) {
+          sum += a[j];
+          dot += a[j] * b[j];
+        }
+        BOOST_CHECK_EQUAL(TiledArray::math::simd_sum_vector(n, a.data()), sum);
+        BOOST_CHECK_EQUAL(TiledArray::math::simd_dot_vector(n, a.data(), b.data()), dot);
+      }
+    }
+  }
+
+  SimdIsa isa;
+}; // SimdVectorOpFixture
+
+BOOST_FIXTURE_TEST_SUITE( simd_vector_op_suite, SimdVectorOpFixture )
+
+BOOST_AUTO_TEST_CASE( isa )
+{
+  // Check that the portable kernels are always available
+  BOOST_CHECK(TiledArray::math::simd_isa_supported(SimdIsa::scalar));
+  BOOST_CHECK(TiledArray::math::simd_isa_supported(TiledArray::math::simd_isa()));
+  BOOST_CHECK_EQUAL(std::string(TiledArray::math::simd_isa_name(SimdIsa::avx2)),
+      std::string("avx2"));
+
+  // Check that unsupported instruction sets cannot be selected
+  for(SimdIsa i : { SimdIsa::neon, SimdIsa::avx2, SimdIsa::avx512 }) {
+    if(! TiledArray::math::simd_isa_supported(i))
+      BOOST_CHECK_THROW(TiledArray::math::simd_isa(i), TiledArray::Exception);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( kernels_double )
+{
+  check_kernels<double>();
+}
+
+BOOST_AUTO_TEST_CASE( kernels_float )
+{
+  check_kernels<float>();
+}
+
+BOOST_AUTO_TEST_CASE( tensor )
+{
+  TiledArray::Range range(std::vector<std::size_t>{ 7, 11, 13 });
+  TiledArray::TensorD a(range), b(range);
+  GlobalFixture::world->srand(27);
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    a[i] = GlobalFixture::world->rand() % 42;
+    b[i] = GlobalFixture::world->rand() % 42 + 1;
+  }
+
+  // Check that the tensor arithmetic is the same with all instruction sets
+  TiledArray::math::simd_isa(SimdIsa::scalar);
+  const TiledArray::TensorD add = a.add(b, 2.0);
+  const TiledArray::TensorD mult = a.mult(b);
+  TiledArray::TensorD subt_to = a.clone();
+  subt_to.subt_to(b, 3);
+  const TiledArray::TensorD scale = a.scale(0.5);
+  const double sum = a.sum();
+  const double dot = a.dot(b);
+
+  for(SimdIsa i : isa_list()) {
+    TiledArray::math::simd_isa(i);
+    const TiledArray::TensorD add_i = a.add(b, 2.0);
+    const TiledArray::TensorD mult_i = a.mult(b);
+    TiledArray::TensorD subt_to_i = a.clone();
+    subt_to_i.subt_to(b, 3);
+    const TiledArray::TensorD scale_i = a.scale(0.5);
+    for(std::size_t j = 0ul; j < a.size(); ++j) {
+      BOOST_CHECK_EQUAL(add_i[j], add[j]);
+      BOOST_CHECK_EQUAL(mult_i[j], mult[j]);
+      BOOST_CHECK_EQUAL(subt_to_i[j], subt_to[j]);
+      BOOST_CHECK_EQUAL(scale_i[j], scale[j]);
+    }
+    BOOST_CHECK_EQUAL(a.sum(), sum);
+    BOOST_CHECK_EQUAL(a.dot(b), dot);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( complex_tensor )
+{
+  TiledArray::Range range(std::vector<std::size_t>{ 7, 11 });
+  TiledArray::TensorZ a(range), b(range);
+  GlobalFixture::world->srand(27);
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    a[i] = std::complex<double>(GlobalFixture::world->rand() % 42,
+        GlobalFixture::world->rand() % 42);
+    b[i] = std::complex<double>(GlobalFixture::world->rand() % 42 + 1,
+        GlobalFixture::world->rand() % 42);
+  }
+
+  // Check that the complex arithmetic with the real kernels is exact
+  for(SimdIsa i : isa_list()) {
+    TiledArray::math::simd_isa(i);
+    const TiledArray::TensorZ add = a.add(b, 2.0);
+    const TiledArray::TensorZ subt = a.subt(b);
+    const TiledArray::TensorZ mult = a.mult(b);
+    TiledArray::TensorZ add_to = a.clone();
+    add_to.add_to(b);
+    const TiledArray::TensorZ scale = a.scale(0.5);
+    for(std::size_t j = 0ul; j < a.size(); ++j) {
+      BOOST_CHECK_EQUAL(add[j], (a[j] + b[j]) * 2.0);
+      BOOST_CHECK_EQUAL(subt[j], a[j] - b[j]);
+      BOOST_CHECK_EQUAL(mult[j], a[j] * b[j]);
+      BOOST_CHECK_EQUAL(add_to[j], a[j] + b[j]);
+      BOOST_CHECK_EQUAL(scale[j], a[j] * 0.5);
+    }
+  }
+
+  // Check that a conjugate-transposed contraction does not need a
+  // conjugated copy
+  const TiledArray::math::GemmHelper conj_trans(madness::cblas::ConjTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+  const TiledArray::math::GemmHelper trans(madness::cblas::Trans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+  const TiledArray::TensorZ c = a.gemm(b, 1, conj_trans);
+  const TiledArray::TensorZ c_ref = a.conj().gemm(b, 1, trans);
+  BOOST_CHECK_EQUAL(c.range(), c_ref.range());
+  for(std::size_t j = 0ul; j < c.size(); ++j)
+    BOOST_CHECK_EQUAL(c[j], c_ref[j]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
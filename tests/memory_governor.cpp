@@ -0,0 +1,139 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  memory_governor.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/memory_governor.h"
+#include "TiledArray/dist_eval/lazy_tile_cache.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct MemoryGovernorFixture {
+
+  /// A cache of fixed size entries
+  struct FakeCache {
+    std::size_t bytes; ///< The bytes held by the cache
+    std::size_t entry_bytes; ///< The size of each entry
+    std::size_t evictions; ///< The number of evicted entries
+    std::size_t id; ///< The id of the cache in the memory governor
+
+    FakeCache(const std::size_t b, const std::size_t e,
+        const CachePriority priority) :
+      bytes(b), entry_bytes(e), evictions(0ul),
+      id(register_memory_cache(priority,
+          [this] () { return bytes; },
+          [this] (const std::size_t request) {
+            std::size_t freed = 0ul;
+            while((freed < request) && bytes) {
+              freed += entry_bytes;
+              bytes -= entry_bytes;
+              ++evictions;
+            }
+            return freed;
+          }))
+    { }
+
+    ~FakeCache() { unregister_memory_cache(id); }
+  }; // struct FakeCache
+
+  MemoryGovernorFixture() :
+    budget(memory_budget()), min_free(memory_min_free())
+  {
+    memory_budget(0ul);
+    memory_min_free(0ul);
+  }
+
+  ~MemoryGovernorFixture() {
+    memory_budget(budget);
+    memory_min_free(min_free);
+  }
+
+  std::size_t budget; ///< The budget before the test
+  std::size_t min_free; ///< The free memory limit before the test
+}; // MemoryGovernorFixture
+
+BOOST_FIXTURE_TEST_SUITE( memory_governor_suite, MemoryGovernorFixture )
+
+BOOST_AUTO_TEST_CASE( unbounded )
+{
+  FakeCache cache(1000ul, 100ul, CachePriority::lazy_tiles);
+  BOOST_CHECK(! detail::memory_governor_bounded());
+  BOOST_CHECK_GE(memory_cache_bytes(), 1000ul);
+
+  // Check that nothing is evicted without memory limits
+  BOOST_CHECK_EQUAL(relieve_memory_pressure(), 0ul);
+  BOOST_CHECK_EQUAL(detail::memory_headroom(1ul << 40), 1ul << 40);
+  BOOST_CHECK_EQUAL(cache.evictions, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( budget )
+{
+  // Empty the other caches
+  memory_budget(1ul);
+  relieve_memory_pressure();
+  memory_budget(0ul);
+
+  FakeCache high(1000ul, 100ul, CachePriority::replicas);
+  FakeCache low(1000ul, 100ul, CachePriority::lazy_tiles);
+
+  // Check that the lowest priority cache is evicted first
+  memory_budget(1500ul);
+  BOOST_CHECK(detail::memory_governor_bounded());
+  BOOST_CHECK_EQUAL(relieve_memory_pressure(), 500ul);
+  BOOST_CHECK_EQUAL(low.bytes, 500ul);
+  BOOST_CHECK_EQUAL(high.bytes, 1000ul);
+  BOOST_CHECK_EQUAL(memory_cache_bytes(), 1500ul);
+
+  // Check that caches are evicted to make room, in order of priority
+  BOOST_CHECK_EQUAL(detail::memory_headroom(800ul), 800ul);
+  BOOST_CHECK_EQUAL(low.bytes, 0ul);
+  BOOST_CHECK_EQUAL(high.bytes, 700ul);
+
+  // Check that the headroom is bounded when the caches are empty
+  BOOST_CHECK_EQUAL(detail::memory_headroom(2000ul), 1500ul);
+  BOOST_CHECK_EQUAL(high.bytes, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( tile_cache )
+{
+  memory_budget(1ul);
+  relieve_memory_pressure();
+  memory_budget(0ul);
+
+  detail::TileCache cache(1000ul, CachePriority::permuted_tiles);
+  for(int i = 0; i < 5; ++i)
+    BOOST_CHECK(cache.insert(std::to_string(i), std::make_shared<int>(i), 100ul));
+
+  // Check that the least recently used tiles are evicted
+  BOOST_CHECK(cache.find("0"));
+  memory_budget(300ul);
+  BOOST_CHECK_EQUAL(relieve_memory_pressure(), 200ul);
+  BOOST_CHECK_EQUAL(cache.size(), 300ul);
+  BOOST_CHECK(cache.find("0"));
+  BOOST_CHECK(! cache.find("1"));
+  BOOST_CHECK(! cache.find("2"));
+  BOOST_CHECK(cache.find("4"));
+
+  BOOST_CHECK_EQUAL(cache.evict(1000ul), 300ul);
+  BOOST_CHECK_EQUAL(cache.size(), 0ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,136 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  morton_pmap.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/pmap/morton_pmap.h"
+#include "TiledArray/pmap/blocked_pmap.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+#include <set>
+
+using namespace TiledArray;
+
+struct MortonPmapFixture {
+
+  MortonPmapFixture() :
+    ranges{ Range(7), Range(3, 5), Range(4, 1, 6), Range(4, 4, 4, 4) }
+  { }
+
+  std::vector<Range> ranges;
+};
+
+
+// =============================================================================
+// MortonPmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( morton_pmap_suite, MortonPmapFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  for(const Range& range : ranges) {
+    BOOST_REQUIRE_NO_THROW(TiledArray::detail::MortonPmap pmap(* GlobalFixture::world, range));
+    TiledArray::detail::MortonPmap pmap(* GlobalFixture::world, range);
+    BOOST_CHECK_EQUAL(pmap.rank(), GlobalFixture::world->rank());
+    BOOST_CHECK_EQUAL(pmap.procs(), GlobalFixture::world->size());
+    BOOST_CHECK_EQUAL(pmap.size(), range.volume());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( owner )
+{
+  const std::size_t rank = GlobalFixture::world->rank();
+  const std::size_t size = GlobalFixture::world->size();
+
+  std::vector<ProcessID> p_owner(size);
+
+  for(const Range& range : ranges) {
+    TiledArray::detail::MortonPmap pmap(* GlobalFixture::world, range);
+
+    for(std::size_t tile = 0; tile < range.volume(); ++tile) {
+      std::fill(p_owner.begin(), p_owner.end(), 0);
+      p_owner[rank] = pmap.owner(tile);
+      // check that the value is in range
+      BOOST_CHECK_LT(p_owner[rank], size);
+      GlobalFixture::world->gop.sum(p_owner.data(), size);
+
+      // Make sure everyone agrees on who owns what.
+      for(std::size_t p = 0ul; p < size; ++p)
+        BOOST_CHECK_EQUAL(p_owner[p], p_owner[rank]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( local_size )
+{
+  for(const Range& range : ranges) {
+    TiledArray::detail::MortonPmap pmap(* GlobalFixture::world, range);
+    TiledArray::detail::BlockedPmap blocked(* GlobalFixture::world, range.volume());
+
+    // The curve is blocked like BlockedPmap blocks the tiles
+    BOOST_CHECK_EQUAL(pmap.local_size(), blocked.local_size());
+
+    std::size_t total_size = pmap.local_size();
+    GlobalFixture::world->gop.sum(total_size);
+    BOOST_CHECK_EQUAL(total_size, range.volume());
+    BOOST_CHECK(pmap.empty() == (pmap.local_size() == 0ul));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  for(const Range& range : ranges) {
+    TiledArray::detail::MortonPmap pmap(* GlobalFixture::world, range);
+    std::vector<ProcessID> tile_owners(range.volume(), 0);
+
+    // Check that all local elements map to this rank
+    for(detail::MortonPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+      BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+      tile_owners[*it] += GlobalFixture::world->rank();
+    }
+
+    GlobalFixture::world->gop.sum(tile_owners.data(), tile_owners.size());
+    for(std::size_t tile = 0; tile < range.volume(); ++tile)
+      BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( locality )
+{
+  const Range& range = ranges.back();
+  TiledArray::detail::MortonPmap morton(* GlobalFixture::world, range);
+  TiledArray::detail::BlockedPmap blocked(* GlobalFixture::world, range.volume());
+
+  // A block expression of the first 2x2x2x2 tiles is a contiguous segment
+  // of the curve, so it is owned by fewer processes than with BlockedPmap
+  const Range block({ 0, 0, 0, 0 }, { 2, 2, 2, 2 });
+  std::set<std::size_t> morton_owners, blocked_owners;
+  for(const auto& index : block) {
+    const std::size_t tile = range.ordinal(index);
+    morton_owners.insert(morton.owner(tile));
+    blocked_owners.insert(blocked.owner(tile));
+  }
+  BOOST_CHECK_LE(morton_owners.size(), blocked_owners.size());
+  if(GlobalFixture::world->size() == 4)
+    BOOST_CHECK_EQUAL(morton_owners.size(), 1ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  node_replicated.cpp
+ *  Feb 27, 2017
+ *
+ */
+
+#include "TiledArray/node_replicated.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct NodeReplicatedFixture {
+
+  NodeReplicatedFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 }, { 0, 4, 8, 9 } }
+  { }
+
+  ~NodeReplicatedFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill the local tiles of \c array with known values
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = double(it.ordinal() * 1000ul + i);
+      *it = tile;
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct NodeReplicatedFixture
+
+BOOST_FIXTURE_TEST_SUITE( node_replicated_suite, NodeReplicatedFixture )
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD array(world, trange);
+  fill(array);
+  TArrayD result = array.clone();
+
+  // All processes of the test are assumed to be on one node
+  make_node_replicated(result, world.size());
+  BOOST_CHECK(result.pmap()->is_replicated());
+  for(std::size_t i = 0ul; i < result.size(); ++i) {
+    BOOST_CHECK(result.is_local(i));
+    const TensorD tile = result.find(i).get();
+    const TensorD reference = array.find(i).get();
+    BOOST_CHECK(tile.is_view());
+    BOOST_CHECK_EQUAL(tile.range(), reference.range());
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], reference[j]);
+  }
+
+  // Check that modified tiles are private to each process
+  if(world.rank() == 0) {
+    TensorD tile = result.find(0).get();
+    tile[0] = -1.0;
+  }
+  world.gop.fence();
+  BOOST_CHECK_EQUAL(result.find(0).get()[0], (world.rank() == 0 ? -1.0 : 0.0));
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    if(i % 2ul)
+      norms[i] = 100.0f;
+  TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+  fill(array);
+  TSpArrayD result = array.clone();
+
+  // Check that each process may be its own node
+  make_node_replicated(result, 1ul);
+  for(std::size_t i = 0ul; i < norms.size(); ++i) {
+    BOOST_CHECK_EQUAL(result.is_zero(i), array.is_zero(i));
+    if(result.is_zero(i))
+      continue;
+    const TensorD tile = result.find(i).get();
+    const TensorD reference = array.find(i).get();
+    BOOST_CHECK(tile.is_view());
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], reference[j]);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
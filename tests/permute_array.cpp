@@ -0,0 +1,107 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  permute_array.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/conversions/permute.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct PermuteArrayFixture {
+  PermuteArrayFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 2, 5, 9 }, { 0, 3, 7 }, { 0, 1, 4, 6, 8 } }
+  { }
+
+  ~PermuteArrayFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill the local tiles of an array with their element ordinals
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t x = 0ul; x < tile.size(); ++x)
+        tile[x] = double(array.trange().elements_range().ordinal(
+            tile.range().idx(x)));
+      *it = tile;
+    }
+  }
+
+  /// Check that \c result is equal to the expression permutation of \c array
+  template <typename Array>
+  static void check(const Array& result, const Array& array,
+      const std::string& source_vars, const std::string& target_vars)
+  {
+    Array reference;
+    reference(target_vars) = array(source_vars);
+    BOOST_REQUIRE(result.trange() == reference.trange());
+    for(std::size_t i = 0ul; i < reference.size(); ++i) {
+      BOOST_CHECK_EQUAL(result.is_zero(i), reference.is_zero(i));
+      if(reference.is_zero(i) || ! result.is_local(i))
+        continue;
+      const TensorD tile = result.find(i).get();
+      const TensorD ref = reference.find(i).get();
+      BOOST_REQUIRE(tile.range() == ref.range());
+      for(std::size_t x = 0ul; x < ref.size(); ++x)
+        BOOST_CHECK_EQUAL(tile[x], ref[x]);
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct PermuteArrayFixture
+
+BOOST_FIXTURE_TEST_SUITE( permute_array_suite, PermuteArrayFixture )
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD a(world, trange);
+  fill(a);
+
+  const TArrayD b = permute_array(a, Permutation{ 2, 0, 1 });
+  check(b, a, "i,j,k", "j,k,i");
+
+  // One message per tile
+  const TArrayD c = permute_array(a, Permutation{ 1, 2, 0 }, 0ul);
+  check(c, a, "i,j,k", "k,i,j");
+
+  // The identity is a copy of the array
+  const TArrayD d = permute_array(a, Permutation{ 0, 1, 2 });
+  check(d, a, "i,j,k", "i,j,k");
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 1.0f);
+  for(std::size_t i = 0ul; i < norms.size(); i += 3ul)
+    norms[i] = 0.0f;
+  TSpArrayD a(world, trange, SparseShape<float>(norms, trange));
+  fill(a);
+
+  // Small batches, so each process sends several messages to the others
+  const TSpArrayD b = permute_array(a, Permutation{ 2, 0, 1 }, 64ul);
+  check(b, a, "i,j,k", "j,k,i");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
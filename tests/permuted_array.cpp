@@ -0,0 +1,118 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  permuted_array.cpp
+ *  May 24, 2017
+ *
+ */
+
+#include "TiledArray/permuted_array.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct PermutedArrayFixture {
+  typedef PermutedArray<TensorD, DensePolicy> permuted_type;
+
+  PermutedArrayFixture() :
+    world(* GlobalFixture::world),
+    a(world, TiledRange{ { 0, 2, 5 }, { 0, 3, 7 } }),
+    b(world, TiledRange{ { 0, 3, 7 }, { 0, 4, 6, 9 } })
+  {
+    fill(a, 1.0);
+    fill(b, -2.0);
+  }
+
+  ~PermutedArrayFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill an array with elements that depend on their index
+  static void fill(TArrayD& array, const double offset) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = offset + double((*idx)[0]) - 0.5 * double((*idx)[1]);
+      *it = tile;
+    }
+  }
+
+  /// The largest absolute difference of the elements of two arrays
+  static double max_error(const TArrayD& x, const TArrayD& y) {
+    BOOST_REQUIRE_EQUAL(x.trange(), y.trange());
+    double result = 0.0;
+    for(std::size_t t = 0ul; t < x.size(); ++t)
+      if(x.is_local(t))
+        result = std::max(result, x.find(t).get().subt(y.find(t).get()).abs_max());
+    return result;
+  }
+
+  World& world;
+  TArrayD a;
+  TArrayD b;
+}; // struct PermutedArrayFixture
+
+BOOST_FIXTURE_TEST_SUITE( permuted_array_suite, PermutedArrayFixture )
+
+BOOST_AUTO_TEST_CASE( assign )
+{
+  TArrayD reference;
+  reference("j,i") = a("i,k") * b("k,j");
+
+  // The contraction is stored in its natural (i,j) layout
+  permuted_type c;
+  c.assign("j,i", a("i,k") * b("k,j"));
+  BOOST_CHECK_EQUAL(c.array().trange(), (Permutation({ 1, 0 }) * reference.trange()));
+  BOOST_CHECK_EQUAL(c.trange(), reference.trange());
+  BOOST_CHECK(c.perm());
+  BOOST_CHECK_SMALL(max_error(c.materialize(), reference), 1.0e-10);
+
+  // Tiles are permuted on demand
+  for(std::size_t i = 0ul; i < 3ul; ++i) {
+    for(std::size_t j = 0ul; j < 2ul; ++j) {
+      const std::array<std::size_t, 2> index = {{ i, j }};
+      const TensorD tile = c.find(index).get();
+      BOOST_CHECK_EQUAL(tile.subt(reference.find(index).get()).abs_max(), 0.0);
+    }
+  }
+
+  // Results that are not permuted by the expression have no permutation
+  permuted_type d;
+  d.assign("i,j", a("i,k") * b("k,j"));
+  BOOST_CHECK(! d.perm());
+}
+
+BOOST_AUTO_TEST_CASE( use_in_expression )
+{
+  permuted_type c;
+  c.assign("j,i", a("i,k") * b("k,j"));
+  TArrayD reference;
+  reference("j,i") = a("i,k") * b("k,j");
+
+  // Logical annotations are mapped to the physical array
+  TArrayD x, y;
+  x("j,i") = c("j,i") * 2.0;
+  y("j,i") = reference("j,i") * 2.0;
+  BOOST_CHECK_SMALL(max_error(x, y), 1.0e-10);
+
+  x("m,n") = c("m,k") * c("n,k");
+  y("m,n") = reference("m,k") * reference("n,k");
+  BOOST_CHECK_SMALL(max_error(x, y), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -193,6 +193,127 @@ BOOST_AUTO_TEST_CASE( make_groups )
   }
 }
 
+BOOST_AUTO_TEST_CASE( layered_constructor_test )
+{
+  const std::size_t rows = 42;
+  const std::size_t cols = 84;
+  const std::size_t row_size = rows * 16;
+  const std::size_t col_size = cols * 8;
+
+  for(std::size_t nprocs = 1ul; nprocs < 64ul; ++nprocs) {
+    for(std::size_t layers = 1ul; layers <= std::min<std::size_t>(nprocs, 4ul); ++layers) {
+      TiledArray::detail::ProcGrid proc_grid0(*GlobalFixture::world, 0, nprocs,
+          rows, cols, row_size, col_size, layers);
+
+      // Check that the layers fit in the available processes
+      BOOST_CHECK_EQUAL(proc_grid0.proc_layers(), layers);
+      BOOST_CHECK_LE(proc_grid0.proc_size() * layers, nprocs);
+
+      std::size_t local_size = 0ul;
+      for(std::size_t rank = 0ul; rank < nprocs; ++rank) {
+        TiledArray::detail::ProcGrid proc_grid(*GlobalFixture::world, rank, nprocs,
+            rows, cols, row_size, col_size, layers);
+
+        // Check process grid dimensions are equal for all ranks
+        BOOST_CHECK_EQUAL(proc_grid.proc_rows(), proc_grid0.proc_rows());
+        BOOST_CHECK_EQUAL(proc_grid.proc_cols(), proc_grid0.proc_cols());
+        BOOST_CHECK_EQUAL(proc_grid.proc_size(), proc_grid0.proc_size());
+
+        if(rank < proc_grid0.proc_size() * layers) {
+          // Check the process coordinates
+          const std::size_t layer_rank = rank % proc_grid0.proc_size();
+          BOOST_CHECK_EQUAL(proc_grid.rank_layer(), rank / proc_grid0.proc_size());
+          BOOST_CHECK_EQUAL(proc_grid.rank_row(), ProcessID(layer_rank / proc_grid0.proc_cols()));
+          BOOST_CHECK_EQUAL(proc_grid.rank_col(), ProcessID(layer_rank % proc_grid0.proc_cols()));
+        } else {
+          BOOST_CHECK_EQUAL(proc_grid.rank_row(), -1);
+          BOOST_CHECK_EQUAL(proc_grid.rank_col(), -1);
+          BOOST_CHECK_EQUAL(proc_grid.local_size(), 0ul);
+        }
+
+        local_size += proc_grid.local_size();
+      }
+
+      // Each layer holds a copy of the grid
+      BOOST_CHECK_EQUAL(local_size, rows * cols * layers);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( node_layout )
+{
+  const std::size_t rows = 64;
+  const std::size_t cols = 64;
+  const std::size_t row_size = rows * 32;
+  const std::size_t col_size = cols * 32;
+
+  for(std::size_t node_procs = 2ul; node_procs <= 16ul; node_procs *= 2ul) {
+    for(std::size_t nodes = 1ul; nodes <= 8ul; ++nodes) {
+      const std::size_t nprocs = nodes * node_procs;
+      TiledArray::detail::ProcGrid grid(*GlobalFixture::world, 0, nprocs,
+          rows, cols, row_size, col_size, 1ul);
+      TiledArray::detail::ProcGrid node_grid(*GlobalFixture::world, 0, nprocs,
+          rows, cols, row_size, col_size, 1ul, node_procs);
+
+      // Check that the node layout does not leave more processes unused
+      BOOST_CHECK_GE(node_grid.proc_size(), grid.proc_size());
+      BOOST_CHECK_LE(node_grid.proc_size(), nprocs);
+
+      // Check that the rows of large nodes are within a node, or span whole
+      // nodes
+      if(node_procs >= 8ul)
+        BOOST_CHECK((node_procs % node_grid.proc_cols() == 0ul) ||
+            (node_grid.proc_cols() % node_procs == 0ul));
+
+      // Check that all processes agree on the grid
+      std::size_t local_size = 0ul;
+      for(std::size_t rank = 0ul; rank < nprocs; ++rank) {
+        TiledArray::detail::ProcGrid proc_grid(*GlobalFixture::world, rank,
+            nprocs, rows, cols, row_size, col_size, 1ul, node_procs);
+        BOOST_CHECK_EQUAL(proc_grid.proc_rows(), node_grid.proc_rows());
+        BOOST_CHECK_EQUAL(proc_grid.proc_cols(), node_grid.proc_cols());
+        local_size += proc_grid.local_size();
+      }
+      BOOST_CHECK_EQUAL(local_size, rows * cols);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( optimal_proc_layers )
+{
+  // Small process counts use the 2D grid
+  for(std::size_t nprocs = 1ul; nprocs < 8ul; ++nprocs)
+    BOOST_CHECK_EQUAL(TiledArray::detail::ProcGrid::optimal_proc_layers(nprocs,
+        32, 32, 32, 32 * 64, 32 * 64, 32 * 64, 64), 1ul);
+
+  // The number of layers is bounded by the maximum
+  BOOST_CHECK_EQUAL(TiledArray::detail::ProcGrid::optimal_proc_layers(4096,
+      64, 64, 64, 64 * 64, 64 * 64, 64 * 64, 1), 1ul);
+
+  // Large process counts with a long inner dimension use layers
+  const std::size_t layers = TiledArray::detail::ProcGrid::optimal_proc_layers(
+      4096, 64, 64, 4096, 64 * 64, 64 * 64, 4096 * 64, 64);
+  BOOST_CHECK_GT(layers, 1ul);
+  BOOST_CHECK_LE(layers * layers * layers, 4096ul);
+}
+
+BOOST_AUTO_TEST_CASE( optimal_proc_count )
+{
+  // Dense work keeps all processes busy
+  BOOST_CHECK_EQUAL(TiledArray::detail::ProcGrid::optimal_proc_count(64,
+      100, 100, 100 * 100, 100 * 100, 100 * 100, 100, 2.0e12), 64ul);
+
+  // Very sparse arguments with little work use fewer processes
+  const std::size_t procs = TiledArray::detail::ProcGrid::optimal_proc_count(
+      64, 100, 100, 100, 100, 100 * 100, 100, 1.0e3);
+  BOOST_CHECK_GE(procs, 1ul);
+  BOOST_CHECK_LT(procs, 64ul);
+
+  // No work
+  BOOST_CHECK_EQUAL(TiledArray::detail::ProcGrid::optimal_proc_count(64,
+      100, 100, 1, 1, 100 * 100, 0, 0.0), 1ul);
+}
+
 #if 0
 // This test case us used to evaluate distribute statistics. This unit test
 // should only be enabled when changes are made to the ProcGrid algorithm, and
@@ -167,6 +167,26 @@ BOOST_AUTO_TEST_CASE( assignment )
   BOOST_CHECK_EQUAL(r2, r); // check construction assignment.
 }
 
+BOOST_AUTO_TEST_CASE( shared_data )
+{
+  // Copies share the range data
+  Range r1 = r;
+  BOOST_CHECK_EQUAL(r1.lobound_data(), r.lobound_data());
+  Range r2;
+  r2 = r;
+  BOOST_CHECK_EQUAL(r2.lobound_data(), r.lobound_data());
+
+  // Modifying a copy does not modify the original range
+  std::vector<long> shift(r.rank(), 1l);
+  r1.inplace_shift(shift);
+  BOOST_CHECK_NE(r1.lobound_data(), r.lobound_data());
+  BOOST_CHECK_EQUAL(r2, r);
+  for(unsigned int d = 0u; d < r.rank(); ++d) {
+    BOOST_CHECK_EQUAL(r1.lobound(d), r.lobound(d) + 1ul);
+    BOOST_CHECK_EQUAL(r1.upbound(d), r.upbound(d) + 1ul);
+  }
+}
+
 BOOST_AUTO_TEST_CASE( resize )
 {
   Range r1;
@@ -298,6 +318,38 @@ BOOST_AUTO_TEST_CASE( iteration )
   BOOST_CHECK_EQUAL_COLLECTIONS(rc.begin(), rc.end(), tc.begin(), tc.end() - 1);
 }
 
+BOOST_AUTO_TEST_CASE( iterator_ordinal )
+{
+  Range rc({ 1, 2, 3 }, { 4, 6, 5 });
+
+  // The iterator position is the ordinal index of the current index
+  std::size_t n = 0ul;
+  for(auto it = rc.begin(); it != rc.end(); ++it, ++n) {
+    BOOST_CHECK_EQUAL(std::size_t(it.ordinal()), rc.ordinal(*it));
+    BOOST_CHECK_EQUAL(std::size_t(it.ordinal()), n);
+  }
+  BOOST_CHECK_EQUAL(n, rc.volume());
+  BOOST_CHECK_EQUAL(std::size_t(std::distance(rc.begin(), rc.end())), rc.volume());
+
+  // Ranges with a zero extent have no elements
+  Range empty({ 0, 0 }, { 0, 3 });
+  BOOST_CHECK(empty.begin() == empty.end());
+}
+
+BOOST_AUTO_TEST_CASE( bulk_ordinal )
+{
+  for(Range rc : { Range({ 1, 2 }, { 4, 6 }), Range({ 1, 2, 3 }, { 4, 6, 5 }),
+      Range({ 1, 2, 3, 0 }, { 3, 4, 5, 3 }) })
+  {
+    const std::vector<Range::index> indices(rc.begin(), rc.end());
+    std::vector<std::size_t> ordinals(indices.size());
+    BOOST_CHECK(rc.ordinals(indices.begin(), indices.end(), ordinals.begin())
+        == ordinals.end());
+    for(std::size_t i = 0ul; i < indices.size(); ++i)
+      BOOST_CHECK_EQUAL(ordinals[i], rc.ordinal(indices[i]));
+  }
+}
+
 BOOST_AUTO_TEST_CASE( serialization )
 {
   std::size_t buf_size = 2 * (sizeof(Range) + sizeof(std::size_t) * (4 * GlobalFixture::dim + 1));
@@ -137,6 +137,51 @@ BOOST_AUTO_TEST_CASE( reduce_future )
 
 }
 
+BOOST_AUTO_TEST_CASE( reduce_partials )
+{
+  ReduceTask<plus<int> > partial_rt(world, plus<int>(), nullptr,
+      madness::TaskAttributes::hipri(), 4u);
+
+  std::vector<Future<int> > fut_vec;
+  int sum = 0;
+  for(int i = 0; i < 100; ++i) {
+    sum += i;
+    if(i % 2) {
+      partial_rt.add(i);
+    } else {
+      Future<int> f;
+      fut_vec.push_back(f);
+      partial_rt.add(f);
+    }
+  }
+
+  Future<int> result = partial_rt.submit();
+
+  for(std::size_t i = 0ul; i < fut_vec.size(); ++i)
+    fut_vec[i].set(int(i * 2ul));
+
+  BOOST_CHECK_EQUAL(result.get(), sum);
+}
+
+BOOST_AUTO_TEST_CASE( reduce_partials_seed )
+{
+  Future<int> seed;
+  ReduceTask<plus<int> > partial_rt(world, plus<int>(), seed, nullptr,
+      madness::TaskAttributes::hipri(), 3u);
+
+  int sum = 42;
+  for(int i = 0; i < 10; ++i) {
+    sum += i;
+    partial_rt.add(i);
+  }
+
+  Future<int> result = partial_rt.submit();
+  BOOST_CHECK(!(result.probe()));
+  seed.set(42);
+
+  BOOST_CHECK_EQUAL(result.get(), sum);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
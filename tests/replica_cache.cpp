@@ -0,0 +1,139 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  replica_cache.cpp
+ *  Mar 23, 2017
+ *
+ */
+
+#include "TiledArray/replica_cache.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct ReplicaCacheFixture {
+
+  ReplicaCacheFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 } }
+  { }
+
+  ~ReplicaCacheFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill the local tiles of \c array with known values
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = double(it.ordinal() * 1000ul + i);
+      *it = tile;
+    }
+  }
+
+  /// Check that \c replica is a replica of \c array
+  template <typename Array>
+  void check(const Array& replica, const Array& array) {
+    BOOST_CHECK(replica.pmap()->is_replicated());
+    for(std::size_t i = 0ul; i < array.size(); ++i) {
+      BOOST_CHECK_EQUAL(replica.is_zero(i), array.is_zero(i));
+      if(replica.is_zero(i))
+        continue;
+      const TensorD tile = replica.find(i).get();
+      const TensorD reference = array.find(i).get();
+      BOOST_CHECK_EQUAL(tile.range(), reference.range());
+      for(std::size_t j = 0ul; j < tile.size(); ++j)
+        BOOST_CHECK_EQUAL(tile[j], reference[j]);
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct ReplicaCacheFixture
+
+BOOST_FIXTURE_TEST_SUITE( replica_cache_suite, ReplicaCacheFixture )
+
+BOOST_AUTO_TEST_CASE( version )
+{
+  TArrayD array(world, trange);
+  const unsigned long version = array.version();
+  fill(array);
+  BOOST_CHECK_EQUAL(array.version(), version + array.pmap()->local_size());
+}
+
+BOOST_AUTO_TEST_CASE( unchanged )
+{
+  TArrayD array(world, trange);
+  fill(array);
+
+  ReplicaCache<TArrayD> cache;
+  const TArrayD first = cache(array);
+  BOOST_CHECK_EQUAL(cache.replicated_tiles(), array.size());
+  check(first, array);
+
+  // Replicating the same array again does not send any tile
+  const TArrayD second = cache(array);
+  BOOST_CHECK_EQUAL(cache.replicated_tiles(), 0ul);
+  BOOST_CHECK(second.id() == first.id());
+  check(second, array);
+}
+
+BOOST_AUTO_TEST_CASE( modified )
+{
+  TArrayD array(world, trange);
+  fill(array);
+
+  ReplicaCache<TArrayD> cache;
+  cache(array);
+
+  // Only the modified tile of a new array is sent
+  TArrayD copy = array.clone();
+  if(copy.is_local(0))
+    copy.find(0).get()[0] = -1.0;
+  world.gop.fence();
+  const TArrayD replica = cache(copy);
+  BOOST_CHECK_EQUAL(cache.replicated_tiles(), 1ul);
+  check(replica, copy);
+  BOOST_CHECK_EQUAL(replica.find(0).get()[0], -1.0);
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    if(i % 2ul)
+      norms[i] = 100.0f;
+  TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+  fill(array);
+
+  std::size_t nonzero = 0ul;
+  for(std::size_t i = 0ul; i < array.size(); ++i)
+    if(! array.is_zero(i))
+      ++nonzero;
+
+  ReplicaCache<TSpArrayD> cache;
+  check(cache(array), array);
+  BOOST_CHECK_EQUAL(cache.replicated_tiles(), nonzero);
+
+  cache.clear();
+  check(cache(array), array);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
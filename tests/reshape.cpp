@@ -0,0 +1,137 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/conversions/reshape.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct ReshapeFixture {
+  ReshapeFixture() :
+    source({ TiledRange1{0, 2, 5}, TiledRange1{0, 3}, TiledRange1{0, 4, 8} }),
+    fused(fuse_tiled_range(source, 0u, 2u))
+  { }
+
+  static int value(const std::size_t ij, const std::size_t k) {
+    return ij * 8 + k;
+  }
+
+  template <typename Policy>
+  void fill(DistArray<Tensor<int>, Policy>& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      Tensor<int> tile(array.trange().make_tile_range(it.ordinal()));
+      for(std::size_t i = tile.range().lobound(0); i < tile.range().upbound(0); ++i)
+        for(std::size_t j = 0ul; j < 3ul; ++j)
+          for(std::size_t k = tile.range().lobound(2); k < tile.range().upbound(2); ++k)
+            tile(i, j, k) = value(i * 3ul + j, k);
+      *it = tile;
+    }
+  }
+
+  TiledRange source;
+  TiledRange fused;
+};
+
+BOOST_FIXTURE_TEST_SUITE( reshape_suite , ReshapeFixture )
+
+BOOST_AUTO_TEST_CASE( tiled_range )
+{
+  BOOST_CHECK_EQUAL(fused,
+      TiledRange({ TiledRange1{0, 6, 15}, TiledRange1{0, 4, 8} }));
+  BOOST_CHECK_EQUAL(split_tiled_range(fused, 0u, { 5ul, 3ul }), source);
+  BOOST_CHECK(detail::is_reshape_aligned(source, fused));
+  BOOST_CHECK(detail::is_reshape_aligned(fused, source));
+
+  // Dimensions with one element may be added or removed
+  const TiledRange unit({ TiledRange1{0, 1}, TiledRange1{0, 6, 15},
+      TiledRange1{0, 4, 8}, TiledRange1{0, 1} });
+  BOOST_CHECK(detail::is_reshape_aligned(unit, fused));
+
+  // Tiles of inner dimensions are not contiguous
+  const TiledRange inner({ TiledRange1{0, 2, 5}, TiledRange1{0, 1, 3},
+      TiledRange1{0, 4, 8} });
+  BOOST_CHECK(! detail::is_reshape_aligned(inner, fused));
+
+  // Tile boundaries differ
+  const TiledRange bounds({ TiledRange1{0, 3, 5}, TiledRange1{0, 3},
+      TiledRange1{0, 4, 8} });
+  BOOST_CHECK(! detail::is_reshape_aligned(bounds, fused));
+
+#ifdef TA_EXCEPTION_ERROR
+  BOOST_CHECK_THROW(fuse_tiled_range(inner, 0u, 2u), TiledArray::Exception);
+  BOOST_CHECK_THROW(split_tiled_range(fused, 0u, { 3ul, 5ul }),
+      TiledArray::Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
+BOOST_AUTO_TEST_CASE( reshape_dense )
+{
+  TArrayI array(*GlobalFixture::world, source);
+  fill(array);
+
+  TArrayI result;
+  BOOST_REQUIRE_NO_THROW(result = reshape(array, fused));
+  BOOST_CHECK_EQUAL(result.trange(), fused);
+
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const Tensor<int> tile = it->get();
+    BOOST_CHECK_EQUAL(tile.range(), fused.make_tile_range(it.ordinal()));
+    for(std::size_t ij = tile.range().lobound(0); ij < tile.range().upbound(0); ++ij)
+      for(std::size_t k = tile.range().lobound(1); k < tile.range().upbound(1); ++k)
+        BOOST_CHECK_EQUAL(tile(ij, k), value(ij, k));
+
+    // Check that the data is shared with the source tile
+    BOOST_CHECK_EQUAL(tile.data(), array.find(it.ordinal()).get().data());
+  }
+
+  // Check that the reshaped array is split back
+  TArrayI split = reshape(result, source);
+  for(auto it = split.begin(); it != split.end(); ++it)
+    BOOST_CHECK_EQUAL(it->get().range(), source.make_tile_range(it.ordinal()));
+
+#ifdef TA_EXCEPTION_ERROR
+  const TiledRange bounds({ TiledRange1{0, 9, 15}, TiledRange1{0, 4, 8} });
+  BOOST_CHECK_THROW(reshape(array, bounds), TiledArray::Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
+BOOST_AUTO_TEST_CASE( reshape_sparse )
+{
+  // Only source tiles {0,0,0} and {1,0,1} are non-zero
+  Tensor<float> norms(source.tiles_range(), 0.0f);
+  norms[0] = 100.0f;
+  norms[3] = 100.0f;
+  TSpArrayI array(*GlobalFixture::world, source,
+      SparseShape<float>(norms, source));
+  fill(array);
+
+  TSpArrayI result = reshape(array, fused);
+  for(std::size_t t = 0ul; t < fused.tiles_range().volume(); ++t)
+    BOOST_CHECK_EQUAL(result.is_zero(t), array.is_zero(t));
+
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const Tensor<int> tile = it->get();
+    for(std::size_t ij = tile.range().lobound(0); ij < tile.range().upbound(0); ++ij)
+      for(std::size_t k = tile.range().lobound(1); k < tile.range().upbound(1); ++k)
+        BOOST_CHECK_EQUAL(tile(ij, k), value(ij, k));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,136 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/conversions/retile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct RetileFixture {
+  RetileFixture() :
+    source({ TiledRange1{0, 3, 8, 10, 17}, TiledRange1{0, 5, 6, 13} }),
+    target({ TiledRange1{0, 6, 17}, TiledRange1{0, 2, 4, 9, 11, 13} })
+  { }
+
+  static int value(const std::size_t i, const std::size_t j) {
+    return i * 13 + j;
+  }
+
+  template <typename Policy>
+  void fill(DistArray<Tensor<int>, Policy>& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      Tensor<int> tile(array.trange().make_tile_range(it.ordinal()));
+      for(std::size_t i = tile.range().lobound(0); i < tile.range().upbound(0); ++i)
+        for(std::size_t j = tile.range().lobound(1); j < tile.range().upbound(1); ++j)
+          tile(i, j) = value(i, j);
+      *it = tile;
+    }
+  }
+
+  TiledRange source;
+  TiledRange target;
+};
+
+BOOST_FIXTURE_TEST_SUITE( retile_suite , RetileFixture )
+
+BOOST_AUTO_TEST_CASE( retile_dense )
+{
+  TArrayI array(*GlobalFixture::world, source);
+  fill(array);
+
+  TArrayI result;
+  BOOST_REQUIRE_NO_THROW(result = retile(array, target));
+  BOOST_CHECK_EQUAL(result.trange(), target);
+
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const Tensor<int> tile = it->get();
+    BOOST_CHECK_EQUAL(tile.range(), target.make_tile_range(it.ordinal()));
+    for(std::size_t i = tile.range().lobound(0); i < tile.range().upbound(0); ++i)
+      for(std::size_t j = tile.range().lobound(1); j < tile.range().upbound(1); ++j)
+        BOOST_CHECK_EQUAL(tile(i, j), value(i, j));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( retile_sparse )
+{
+  // Only source tiles {0,0} and {3,2} are non-zero
+  Tensor<float> norms(source.tiles_range(), 0.0f);
+  norms[0] = 100.0f;
+  norms[11] = 100.0f;
+  TSpArrayI array(*GlobalFixture::world, source,
+      SparseShape<float>(norms, source));
+  fill(array);
+
+  TSpArrayI result = retile(array, target);
+  GlobalFixture::world->gop.fence();
+
+  // Target tiles that overlap a non-zero source tile are non-zero
+  for(std::size_t i = 0ul; i < target.tiles_range().volume(); ++i) {
+    const Range range = target.make_tile_range(i);
+    const bool overlap =
+        (range.lobound(0) < 3ul && range.lobound(1) < 5ul) ||
+        (range.upbound(0) > 10ul && range.upbound(1) > 6ul);
+    BOOST_CHECK_EQUAL(result.is_zero(i), ! overlap);
+  }
+
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const Tensor<int> tile = it->get();
+    for(std::size_t i = tile.range().lobound(0); i < tile.range().upbound(0); ++i) {
+      for(std::size_t j = tile.range().lobound(1); j < tile.range().upbound(1); ++j) {
+        const bool nonzero = (i < 3ul && j < 5ul) || (i >= 10ul && j >= 6ul);
+        BOOST_CHECK_EQUAL(tile(i, j), (nonzero ? value(i, j) : 0));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( retile_sparse_threshold )
+{
+  // Source tile {0,0}, with 15 elements, has twice the threshold norm per
+  // element, and the other tiles are zero
+  const float threshold = SparseShape<float>::threshold();
+  Tensor<float> norms(source.tiles_range(), 0.0f);
+  norms[0] = 2.0f * threshold * 15.0f;
+  TSpArrayI array(*GlobalFixture::world, source,
+      SparseShape<float>(norms, source));
+  fill(array);
+
+  TSpArrayI result = retile(array, target);
+  GlobalFixture::world->gop.fence();
+
+  // Target tiles {0,0} and {0,1}, with 12 elements, each hold 6 elements of
+  // source tile {0,0}, so their norm per element is
+  // 2 * threshold * sqrt(15 * 6) / 12, which is above the threshold
+  BOOST_CHECK(! result.is_zero(0ul));
+  BOOST_CHECK(! result.is_zero(1ul));
+  for(std::size_t i = 0ul; i < 2ul; ++i) {
+    if(! result.is_local(i))
+      continue;
+    const Tensor<int> tile = result.find(i).get();
+    for(std::size_t r = 0ul; r < 3ul; ++r)
+      for(std::size_t c = tile.range().lobound(1); c < tile.range().upbound(1); ++c)
+        BOOST_CHECK_EQUAL(tile(r, c), value(r, c));
+  }
+
+  // Target tiles that only overlap zero source tiles are zero
+  BOOST_CHECK(result.is_zero(target.tiles_range().volume() - 1ul));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
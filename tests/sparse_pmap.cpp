@@ -0,0 +1,163 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_pmap.cpp
+ *  Feb 23, 2017
+ *
+ */
+
+#include "TiledArray/pmap/sparse_pmap.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include "global_fixture.h"
+
+using namespace TiledArray;
+
+struct SparsePmapFixture {
+
+  SparsePmapFixture() { }
+
+  /// Make a shape where the tiles of the first third are non-zero
+  static SparseShape<float> make_shape(const std::size_t tiles,
+      const bool zero = false)
+  {
+    std::vector<std::size_t> tiling;
+    for(std::size_t i = 0ul; i <= tiles; ++i)
+      tiling.push_back(i * 10ul);
+    const TiledRange trange{ TiledRange1(tiling.begin(), tiling.end()) };
+    Tensor<float> norms(trange.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; (! zero) && (i < (tiles + 2ul) / 3ul); ++i)
+      norms[i] = 1.0f;
+    return SparseShape<float>(norms, trange);
+  }
+
+};
+
+// =============================================================================
+// SparsePmap Test Suite
+
+
+BOOST_FIXTURE_TEST_SUITE( sparse_pmap_suite, SparsePmapFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+    const SparseShape<float> shape = make_shape(tiles);
+    BOOST_REQUIRE_NO_THROW(TiledArray::detail::SparsePmap pmap(* GlobalFixture::world, shape));
+    TiledArray::detail::SparsePmap pmap(* GlobalFixture::world, shape);
+    BOOST_CHECK_EQUAL(pmap.rank(), GlobalFixture::world->rank());
+    BOOST_CHECK_EQUAL(pmap.procs(), GlobalFixture::world->size());
+    BOOST_CHECK_EQUAL(pmap.size(), tiles);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( local_group )
+{
+  ProcessID tile_owners[100];
+
+  for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+    TiledArray::detail::SparsePmap pmap(* GlobalFixture::world, make_shape(tiles));
+
+    // Check that all local elements map to this rank
+    for(detail::SparsePmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+      BOOST_CHECK_EQUAL(pmap.owner(*it), GlobalFixture::world->rank());
+      BOOST_CHECK(pmap.is_local(*it));
+    }
+
+    std::fill_n(tile_owners, tiles, 0);
+    for(detail::SparsePmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+      tile_owners[*it] += GlobalFixture::world->rank();
+    }
+
+    // Check that every tile is owned by exactly one process
+    std::size_t total_size = pmap.local_size();
+    GlobalFixture::world->gop.sum(total_size);
+    BOOST_CHECK_EQUAL(total_size, tiles);
+
+    GlobalFixture::world->gop.sum(tile_owners, tiles);
+    for(std::size_t tile = 0; tile < tiles; ++tile) {
+      BOOST_CHECK_EQUAL(tile_owners[tile], pmap.owner(tile));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( balance )
+{
+  const std::size_t procs = GlobalFixture::world->size();
+  const std::size_t tiles = 99ul;
+  const SparseShape<float> shape = make_shape(tiles);
+  const std::size_t non_zero = (tiles + 2ul) / 3ul;
+
+  // Check that the non-zero tiles are evenly distributed
+  TiledArray::detail::SparsePmap pmap(* GlobalFixture::world, shape);
+  std::size_t local_non_zero = 0ul;
+  for(detail::SparsePmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it)
+    if(! shape.is_zero(*it))
+      ++local_non_zero;
+  BOOST_CHECK_LE(local_non_zero, non_zero / procs + 1ul);
+  BOOST_CHECK_GE(local_non_zero + 1ul, non_zero / procs);
+
+  // Check that the cost of the tiles is balanced
+  auto cost = [] (const std::size_t i) { return double(i + 1ul); };
+  TiledArray::detail::SparsePmap weighted_pmap(* GlobalFixture::world, shape, cost);
+  double local_cost = 0.0, total_cost = 0.0, max_cost = 0.0;
+  for(std::size_t i = 0ul; i < tiles; ++i) {
+    if(shape.is_zero(i))
+      continue;
+    total_cost += cost(i);
+    max_cost = std::max(max_cost, cost(i));
+    if(weighted_pmap.is_local(i))
+      local_cost += cost(i);
+  }
+  BOOST_CHECK_LE(local_cost, total_cost / double(procs) + max_cost);
+  BOOST_CHECK_GE(local_cost + max_cost, total_cost / double(procs));
+
+  // Check that the tiles of a shape without non-zero tiles are evenly
+  // distributed
+  TiledArray::detail::SparsePmap zero_pmap(* GlobalFixture::world,
+      make_shape(tiles, true));
+  BOOST_CHECK_LE(zero_pmap.local_size(), tiles / procs + 1ul);
+  BOOST_CHECK_GE(zero_pmap.local_size() + 1ul, tiles / procs);
+}
+
+BOOST_AUTO_TEST_CASE( tile_costs )
+{
+  const std::size_t procs = GlobalFixture::world->size();
+  const std::size_t tiles = 99ul;
+
+  // Check that a map constructed from the cost of each tile is balanced
+  std::vector<double> costs(tiles);
+  for(std::size_t i = 0ul; i < tiles; ++i)
+    costs[i] = double(i % 7ul);
+  TiledArray::detail::SparsePmap pmap(* GlobalFixture::world, costs);
+  BOOST_CHECK_EQUAL(pmap.size(), tiles);
+  double local_cost = 0.0, total_cost = 0.0;
+  for(std::size_t i = 0ul; i < tiles; ++i) {
+    total_cost += costs[i];
+    if(pmap.is_local(i))
+      local_cost += costs[i];
+  }
+  BOOST_CHECK_LE(local_cost, total_cost / double(procs) + 6.0);
+  BOOST_CHECK_GE(local_cost + 6.0, total_cost / double(procs));
+
+  // Check that every tile is owned by exactly one process
+  std::size_t total_size = pmap.local_size();
+  GlobalFixture::world->gop.sum(total_size);
+  BOOST_CHECK_EQUAL(total_size, tiles);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -207,6 +207,37 @@ BOOST_AUTO_TEST_CASE( comm_constructor )
 }
 
 
+BOOST_AUTO_TEST_CASE( comm_constructor_few_nonzeros )
+{
+  // Construct tile norms where a few tiles are non-zero, so that the norms
+  // are summed as sparse data
+  Tensor<float> tile_norms(tr.tiles_range(), 0.0f);
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); i += 7ul) {
+    const TiledRange::range_type range = tr.make_tile_range(i);
+    tile_norms[i] = float(range.volume());
+  }
+  Tensor<float> tile_norms_ref = tile_norms.clone();
+
+  // Zero non-local tiles
+  TiledArray::detail::BlockedPmap pmap(*GlobalFixture::world, tr.tiles_range().volume());
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i)
+    if(! pmap.is_local(i))
+      tile_norms[i] = 0.0f;
+
+  SparseShape<float> x(*GlobalFixture::world, tile_norms, tr);
+
+  size_type zero_tile_count = 0ul;
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i) {
+    const float expected = (tile_norms_ref[i] > 0.0f ? 1.0f : 0.0f);
+    BOOST_CHECK_CLOSE(x[i], expected, tolerance);
+    BOOST_CHECK_EQUAL(x.is_zero(i), expected == 0.0f);
+    if(expected == 0.0f)
+      ++zero_tile_count;
+  }
+
+  BOOST_CHECK_CLOSE(x.sparsity(), float(zero_tile_count) / float(tr.tiles_range().volume()), tolerance);
+}
+
 BOOST_AUTO_TEST_CASE( copy_constructor )
 {
   // Construct the shape
@@ -227,6 +258,24 @@ BOOST_AUTO_TEST_CASE( copy_constructor )
   BOOST_CHECK_EQUAL(y.sparsity(), sparse_shape.sparsity());
 }
 
+BOOST_AUTO_TEST_CASE( norm )
+{
+  Tensor<float> tile_norms = make_norm_tensor(tr, 0.5, 42);
+  SparseShape<float> x(tile_norms, tr);
+
+  // Tiles below the zero threshold do not contribute
+  double expected = 0.0;
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i) {
+    const float volume = tr.make_tile_range(i).volume();
+    if(tile_norms[i] / volume >= SparseShape<float>::threshold())
+      expected += double(tile_norms[i]) * double(tile_norms[i]);
+  }
+  BOOST_CHECK_CLOSE(x.norm(), std::sqrt(expected), tolerance);
+
+  // Check that the norm is scaled with the shape
+  BOOST_CHECK_CLOSE(x.scale(-2.0).norm(), 2.0 * std::sqrt(expected), tolerance);
+}
+
 BOOST_AUTO_TEST_CASE( permute )
 {
   SparseShape<float> result;
@@ -1181,6 +1230,56 @@ BOOST_AUTO_TEST_CASE( gemm )
   BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(result_norms.size()), tolerance);
 }
 
+BOOST_AUTO_TEST_CASE( gemm_error_budget )
+{
+  const std::size_t m = left.data().range().extent(0);
+  const std::size_t n = right.data().range().extent(right.data().range().rank() - 1);
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, left.data().range().rank(), right.data().range().rank());
+  const SparseShape<float> reference = left.gemm(right, -7.2, gemm_helper);
+
+  // Compute the number of elements of each result tile
+  Tensor<float> volumes(reference.data().range(), 0.0f);
+  std::array<std::size_t, 2> i = {{ 0, 0 }};
+  for(i[0] = 0ul; i[0] < m; ++i[0]) {
+    const TiledRange1::range_type r_0 = tr.data()[0].tile(i[0]);
+    for(i[1] = 0ul; i[1] < n; ++i[1]) {
+      const TiledRange1::range_type r_1 = tr.data()[2].tile(i[1]);
+      volumes[i] = float((r_0.second - r_0.first) * (r_1.second - r_1.first));
+    }
+  }
+
+  // Use a tenth of the norm of the result as the budget
+  double total = 0.0;
+  for(std::size_t x = 0ul; x < volumes.size(); ++x) {
+    const double norm = double(reference[x]) * double(volumes[x]);
+    total += norm * norm;
+  }
+  const float budget = 0.1f * float(std::sqrt(total));
+
+  SparseShape<float>::error_budget(budget);
+  SparseShape<float> result;
+  BOOST_CHECK_NO_THROW(result = left.gemm(right, -7.2, gemm_helper));
+  SparseShape<float>::error_budget(0.0f);
+  BOOST_REQUIRE(! result.empty());
+
+  // The neglected tiles are within the budget, and the others are unchanged
+  double error = 0.0;
+  size_type zero_tile_count = 0ul;
+  for(std::size_t x = 0ul; x < volumes.size(); ++x) {
+    if(result.is_zero(x)) {
+      const double norm = double(reference[x]) * double(volumes[x]);
+      error += norm * norm;
+      ++zero_tile_count;
+    } else {
+      BOOST_CHECK_CLOSE(result[x], reference[x], tolerance);
+    }
+  }
+  BOOST_CHECK(std::sqrt(error) <= double(budget) * 1.001);
+  BOOST_CHECK(result.sparsity() >= reference.sparsity());
+  BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(volumes.size()), tolerance);
+}
+
 BOOST_AUTO_TEST_CASE( gemm_perm )
 {
   const Permutation perm({1,0});
@@ -1240,4 +1339,135 @@ BOOST_AUTO_TEST_CASE( gemm_perm )
   BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(result_norms.size()), tolerance);
 }
 
+BOOST_AUTO_TEST_CASE( tile_mask )
+{
+  const std::size_t volume = tr.tiles_range().volume();
+  TiledArray::detail::Bitset<> mask(volume);
+  for(std::size_t i = 0ul; i < volume; i += 2ul)
+    mask.set(i);
+
+  SparseShape<float> result;
+  BOOST_REQUIRE_NO_THROW(result = sparse_shape.mask(mask));
+
+  size_type zero_tile_count = 0ul;
+  for(Tensor<float>::size_type i = 0ul; i < volume; ++i) {
+    const float expected = (mask[i] ? sparse_shape[i] : 0.0f);
+    BOOST_CHECK_CLOSE(result[i], expected, tolerance);
+    BOOST_CHECK_EQUAL(result.is_zero(i), (! mask[i]) || sparse_shape.is_zero(i));
+    if(result.is_zero(i))
+      ++zero_tile_count;
+  }
+
+  BOOST_CHECK_CLOSE(result.sparsity(), float(zero_tile_count) / float(volume), tolerance);
+}
+
+BOOST_AUTO_TEST_CASE( gemm_tile_mask )
+{
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, left.data().range().rank(), right.data().range().rank());
+  const SparseShape<float> reference = left.gemm(right, -7.2, gemm_helper);
+  const std::size_t volume = reference.data().range().volume();
+
+  // Sparse masks are contracted tile by tile, dense masks are applied to the
+  // full contraction
+  for(std::size_t stride : { 7ul, 2ul }) {
+    TiledArray::detail::Bitset<> mask(volume);
+    for(std::size_t i = 0ul; i < volume; i += stride)
+      mask.set(i);
+    const SparseShape<float> expected = reference.mask(mask);
+
+    SparseShape<float> result;
+    BOOST_REQUIRE_NO_THROW(result = left.gemm(right, -7.2, gemm_helper, mask));
+    for(std::size_t i = 0ul; i < volume; ++i) {
+      BOOST_CHECK_CLOSE(result[i], expected[i], tolerance);
+      BOOST_CHECK_EQUAL(result.is_zero(i), expected.is_zero(i));
+    }
+    BOOST_CHECK_CLOSE(result.sparsity(), expected.sparsity(), tolerance);
+
+    // The mask of a permuted result is in the permuted order
+    const Permutation transpose({1, 0});
+    const SparseShape<float> perm_expected = reference.perm(transpose).mask(mask);
+    BOOST_REQUIRE_NO_THROW(result = left.gemm(right, -7.2, gemm_helper, transpose, mask));
+    for(std::size_t i = 0ul; i < volume; ++i)
+      BOOST_CHECK_EQUAL(result.is_zero(i), perm_expected.is_zero(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( zero_threshold )
+{
+  BOOST_CHECK_EQUAL(sparse_shape.zero_threshold(), SparseShape<float>::threshold());
+
+  // Use the median of the non-zero norms as the threshold
+  std::vector<float> norms;
+  for(Tensor<float>::size_type i = 0ul; i < sparse_shape.data().size(); ++i)
+    if(! sparse_shape.is_zero(i))
+      norms.push_back(sparse_shape[i]);
+  BOOST_REQUIRE(! norms.empty());
+  std::sort(norms.begin(), norms.end());
+  const float threshold = norms[norms.size() / 2ul];
+
+  SparseShape<float> result;
+  BOOST_REQUIRE_NO_THROW(result = sparse_shape.with_threshold(threshold));
+  BOOST_CHECK_EQUAL(result.zero_threshold(), threshold);
+
+  size_type zero_tile_count = 0ul;
+  for(Tensor<float>::size_type i = 0ul; i < result.data().size(); ++i) {
+    const bool is_zero = sparse_shape[i] < threshold;
+    BOOST_CHECK_EQUAL(result.is_zero(i), is_zero);
+    BOOST_CHECK_EQUAL(result[i], (is_zero ? 0.0f : sparse_shape[i]));
+    if(is_zero)
+      ++zero_tile_count;
+  }
+  BOOST_CHECK_CLOSE(result.sparsity(),
+      float(zero_tile_count) / float(result.data().size()), tolerance);
+
+  // The threshold is carried by unary operations and masks
+  BOOST_CHECK_EQUAL(result.scale(2.0).zero_threshold(), threshold);
+  BOOST_CHECK_EQUAL(result.perm(perm).zero_threshold(), threshold);
+  BOOST_CHECK_EQUAL(result.mask(left).zero_threshold(), threshold);
+
+  // Binary operations take the smaller threshold of their arguments
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, left.data().range().rank(), right.data().range().rank());
+  BOOST_CHECK_EQUAL(result.add(left).zero_threshold(), left.zero_threshold());
+  BOOST_CHECK_EQUAL(result.mult(left).zero_threshold(), left.zero_threshold());
+  BOOST_CHECK_EQUAL(left.with_threshold(threshold).add(result).zero_threshold(), threshold);
+  BOOST_CHECK_EQUAL(left.gemm(right.with_threshold(threshold), 1.0,
+      gemm_helper).zero_threshold(), left.zero_threshold());
+
+  // Constructors take a threshold
+  const SparseShape<float> x(make_norm_tensor(tr, 0.5, 42), tr, threshold);
+  BOOST_CHECK_EQUAL(x.zero_threshold(), threshold);
+  for(Tensor<float>::size_type i = 0ul; i < x.data().size(); ++i)
+    BOOST_CHECK_EQUAL(x.is_zero(i), result.is_zero(i));
+}
+
+BOOST_AUTO_TEST_CASE( from_bounds )
+{
+  BOOST_CHECK(! sparse_shape.is_bound());
+
+  SparseShape<float> x;
+  BOOST_REQUIRE_NO_THROW(x = SparseShape<float>::from_bounds(
+      make_norm_tensor(tr, 0.5, 42), tr));
+  BOOST_CHECK(x.is_bound());
+
+  // Bounds are normalized as norms are
+  for(Tensor<float>::size_type i = 0ul; i < x.data().size(); ++i) {
+    BOOST_CHECK_EQUAL(x[i], sparse_shape[i]);
+    BOOST_CHECK_EQUAL(x.is_zero(i), sparse_shape.is_zero(i));
+  }
+  BOOST_CHECK_EQUAL(x.sparsity(), sparse_shape.sparsity());
+
+  // Shapes that are computed from bounds are bounds
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, left.data().range().rank(), right.data().range().rank());
+  BOOST_CHECK(x.scale(2.0).is_bound());
+  BOOST_CHECK(x.perm(perm).is_bound());
+  BOOST_CHECK(x.add(left).is_bound());
+  BOOST_CHECK(left.add(x).is_bound());
+  BOOST_CHECK(! left.add(right).is_bound());
+  BOOST_CHECK(x.gemm(right, 1.0, gemm_helper).is_bound());
+  BOOST_CHECK(x.with_threshold(0.5f).is_bound());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,179 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_tile.cpp
+ *  May 22, 2017
+ *
+ */
+
+#include "TiledArray/sparse_tile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SparseTileFixture {
+  typedef SparseTile<double> tile_type;
+
+  SparseTileFixture() :
+    left_range({ 0, 0 }, { 12, 9 }), right_range({ 0, 0 }, { 9, 7 })
+  { }
+
+  /// Construct a tensor in which every \c stride -th element is non-zero
+  static TensorD make_tensor(const Range& range, const std::size_t stride) {
+    TensorD result(range, 0.0);
+    for(std::size_t i = 0ul; i < result.size(); i += stride)
+      result[i] = double(GlobalFixture::world->rand() % 101) + 1.0;
+    return result;
+  }
+
+  /// The largest absolute difference of the elements of \c tile and \c tensor
+  static double max_error(const tile_type& tile, const TensorD& tensor) {
+    const TensorD dense = static_cast<TensorD>(tile);
+    BOOST_REQUIRE_EQUAL(dense.range(), tensor.range());
+    return dense.subt(tensor).abs_max();
+  }
+
+  Range left_range;
+  Range right_range;
+}; // struct SparseTileFixture
+
+BOOST_FIXTURE_TEST_SUITE( sparse_tile_suite, SparseTileFixture )
+
+BOOST_AUTO_TEST_CASE( compress )
+{
+  // One element in seven is non-zero, so the tile is compressed
+  const TensorD tensor = make_tensor(left_range, 7ul);
+  const tile_type tile(tensor, 0.25);
+
+  BOOST_CHECK(! tile.empty());
+  BOOST_CHECK_EQUAL(tile.range(), left_range);
+  BOOST_CHECK(tile.is_sparse());
+  BOOST_CHECK_EQUAL(tile.nnz(), (108ul + 6ul) / 7ul);
+  BOOST_CHECK_EQUAL(max_error(tile, tensor), 0.0);
+  BOOST_CHECK_EQUAL(tile_bytes(tile),
+      tile.nnz() * (sizeof(double) + sizeof(std::size_t)));
+  BOOST_CHECK_CLOSE(tile.norm(), tensor.norm(), 1.0e-10);
+  BOOST_CHECK_CLOSE(tile.sum(), tensor.sum(), 1.0e-10);
+
+  // One element in two is non-zero, so the tile is dense
+  const tile_type dense(make_tensor(left_range, 2ul), 0.25);
+  BOOST_CHECK(! dense.is_sparse());
+  BOOST_CHECK_EQUAL(dense.nnz(), 108ul);
+
+  // Zero tiles are compressed
+  const tile_type zero(left_range);
+  BOOST_CHECK(zero.is_sparse());
+  BOOST_CHECK_EQUAL(zero.nnz(), 0ul);
+  BOOST_CHECK_EQUAL(zero.norm(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( permute )
+{
+  const TensorD tensor = make_tensor(left_range, 5ul);
+  const tile_type tile(tensor, 0.25);
+  const Permutation perm({ 1, 0 });
+
+  const tile_type result = permute(tile, perm);
+  BOOST_CHECK(result.is_sparse());
+  BOOST_CHECK(std::is_sorted(result.index().begin(), result.index().end()));
+  BOOST_CHECK_EQUAL(max_error(result, tensor.permute(perm)), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( add )
+{
+  const TensorD a = make_tensor(left_range, 7ul);
+  const TensorD b = make_tensor(left_range, 11ul);
+  const tile_type x(a, 0.25), y(b, 0.25);
+
+  const tile_type sum = add(x, y);
+  BOOST_CHECK(sum.is_sparse());
+  BOOST_CHECK_EQUAL(max_error(sum, a.add(b)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(subt(x, y), a.subt(b)), 0.0);
+
+  // Cancelled elements are not stored
+  BOOST_CHECK_EQUAL(subt(x, x).nnz(), 0ul);
+
+  // Sums that fill the tile are dense
+  const TensorD c = make_tensor(left_range, 2ul);
+  const tile_type z(c, 0.25);
+  const tile_type mixed = add(x, z);
+  BOOST_CHECK(! mixed.is_sparse());
+  BOOST_CHECK_EQUAL(max_error(mixed, a.add(c)), 0.0);
+
+  // In-place addition
+  tile_type w = x.clone();
+  add_to(w, y);
+  BOOST_CHECK_EQUAL(max_error(w, a.add(b)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(x, a), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( mult )
+{
+  const TensorD a = make_tensor(left_range, 5ul);
+  const TensorD b = make_tensor(left_range, 2ul);
+  const tile_type x(a, 0.25), y(b, 0.25);
+
+  // The product of a compressed tile and a dense tile is compressed
+  const tile_type product = mult(x, y);
+  BOOST_CHECK(product.is_sparse());
+  BOOST_CHECK_EQUAL(max_error(product, a.mult(b)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(scale(x, 3.0), a.scale(3.0)), 0.0);
+  BOOST_CHECK_EQUAL(max_error(neg(x), a.neg()), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( contract )
+{
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  for(std::size_t left_stride : { 1ul, 7ul }) {
+    for(std::size_t right_stride : { 1ul, 5ul }) {
+      const TensorD a = make_tensor(left_range, left_stride);
+      const TensorD b = make_tensor(right_range, right_stride);
+      const tile_type x(a, 0.25), y(b, 0.25);
+
+      const TensorD reference = a.gemm(b, 2.0, gemm_helper);
+      tile_type result = gemm(x, y, 2.0, gemm_helper);
+      BOOST_CHECK_SMALL(max_error(result, reference), 1.0e-10);
+
+      // Accumulate
+      gemm(result, x, y, 2.0, gemm_helper);
+      BOOST_CHECK_SMALL(max_error(result, reference.scale(2.0)), 1.0e-10);
+    }
+  }
+
+  // Transposed arguments
+  const math::GemmHelper trans_helper(madness::cblas::Trans,
+      madness::cblas::Trans, 2u, 2u, 2u);
+  const TensorD a = make_tensor(Range({ 0, 0 }, { 9, 12 }), 7ul);
+  const TensorD b = make_tensor(Range({ 0, 0 }, { 7, 9 }), 5ul);
+  const TensorD c = make_tensor(Range({ 0, 0 }, { 7, 9 }), 1ul);
+  const tile_type x(a, 0.25), y(b, 0.25), z(c, 0.25);
+  BOOST_CHECK_SMALL(max_error(gemm(x, y, 1.0, trans_helper),
+      a.gemm(b, 1.0, trans_helper)), 1.0e-10);
+  BOOST_CHECK_SMALL(max_error(gemm(x, z, 1.0, trans_helper),
+      a.gemm(c, 1.0, trans_helper)), 1.0e-10);
+
+  // Dense-sparse product
+  const math::GemmHelper mixed_helper(madness::cblas::NoTrans,
+      madness::cblas::Trans, 2u, 2u, 2u);
+  BOOST_CHECK_SMALL(max_error(gemm(z, y, 1.0, mixed_helper),
+      c.gemm(b, 1.0, mixed_helper)), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  split_contract.cpp
+ *  Jun 2, 2017
+ *
+ */
+
+#include "TiledArray/split_contract.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SplitContractFixture {
+
+  SplitContractFixture() :
+    world(* GlobalFixture::world),
+    i{ 0, 2, 4, 24, 26 }, k{ 0, 3, 6, 9, 40 }, j{ 0, 4, 8, 12 }
+  { }
+
+  ~SplitContractFixture() {
+    world.gop.fence();
+  }
+
+  /// Fill an array with values that depend on the element indices
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = double(((*idx)[0] * 7ul + (*idx)[1] * 3ul) % 11ul) - 5.0;
+      *it = tile;
+    }
+  }
+
+  World& world;
+  TiledRange1 i, k, j;
+}; // struct SplitContractFixture
+
+BOOST_FIXTURE_TEST_SUITE( split_contract_suite, SplitContractFixture )
+
+BOOST_AUTO_TEST_CASE( split_oversized_tiles )
+{
+  // Tiles larger than twice the median extent are split evenly
+  BOOST_CHECK_EQUAL(split_oversized_tiles(i, 2.0),
+      (TiledRange1{ 0, 2, 4, 8, 12, 16, 20, 24, 26 }));
+  BOOST_CHECK_EQUAL(split_oversized_tiles(k, 2.0),
+      (TiledRange1{ 0, 3, 6, 9, 14, 19, 24, 29, 34, 40 }));
+
+  // Tilings without oversized tiles are not changed
+  BOOST_CHECK_EQUAL(split_oversized_tiles(j, 2.0), j);
+  BOOST_CHECK_EQUAL(split_oversized_tiles(k, 20.0), k);
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  TArrayD left(world, TiledRange{ i, k });
+  TArrayD right(world, TiledRange{ k, j });
+  fill(left);
+  fill(right);
+
+  TArrayD reference;
+  reference("i,j") = left("i,k") * right("k,j");
+
+  TArrayD result;
+  BOOST_REQUIRE_NO_THROW(result = split_contract(left, "i,k", right, "k,j",
+      "j,i", 2.0));
+  BOOST_CHECK_EQUAL(result.trange(), (TiledRange{ j, i }));
+  for(std::size_t t = 0ul; t < result.size(); ++t) {
+    const TensorD tile = result.find(t).get();
+    for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx) {
+      const std::array<std::size_t, 2> ref_idx = {{ (*idx)[1], (*idx)[0] }};
+      const TensorD ref_tile = reference.find(
+          reference.trange().element_to_tile(ref_idx)).get();
+      BOOST_CHECK_CLOSE(tile[*idx], ref_tile[ref_idx], 1.0e-10);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( invalid )
+{
+  TArrayD left(world, TiledRange{ i, k });
+  TArrayD right(world, TiledRange{ j, j });
+
+  // The tiling of k differs between the arguments
+  BOOST_CHECK_THROW(split_contract(left, "i,k", right, "k,j", "i,j"),
+      TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sub_world.cpp
+ *  May 15, 2017
+ *
+ */
+
+#include "TiledArray/sub_world.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SubWorldFixture {
+
+  SubWorldFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 3, 7, 12 }, { 0, 5, 10 }, { 0, 4, 8, 9 } }
+  { }
+
+  ~SubWorldFixture() {
+    world.gop.fence();
+  }
+
+  /// The value of element \c i of tile \c index
+  static double value(const std::size_t index, const std::size_t i) {
+    return double(index * 1000ul + i);
+  }
+
+  /// Fill the local tiles of \c array with known values
+  template <typename Array>
+  static void fill(Array& array) {
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        tile[i] = value(it.ordinal(), i);
+      *it = tile;
+    }
+  }
+
+  /// Check that all tiles of \c array hold \c factor times the values set
+  /// by \c fill()
+  template <typename Array>
+  static void check(const Array& array, const double factor = 1.0) {
+    for(std::size_t t = 0ul; t < array.size(); ++t) {
+      if(array.is_zero(t))
+        continue;
+      const TensorD tile = array.find(t).get();
+      BOOST_CHECK_EQUAL(tile.range(), array.trange().make_tile_range(t));
+      for(std::size_t i = 0ul; i < tile.size(); ++i)
+        BOOST_CHECK_EQUAL(tile[i], factor * value(t, i));
+    }
+  }
+
+  World& world;
+  TiledRange trange;
+}; // struct SubWorldFixture
+
+BOOST_FIXTURE_TEST_SUITE( sub_world_suite, SubWorldFixture )
+
+BOOST_AUTO_TEST_CASE( split )
+{
+  std::shared_ptr<World> sub = split_world(world, world.rank() % 2);
+  BOOST_CHECK_EQUAL(sub->size(), (world.size() + 1 - world.rank() % 2) / 2);
+  BOOST_CHECK_EQUAL(sub->rank(), world.rank() / 2);
+  BOOST_CHECK_THROW(split_world(world, -1), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( dense )
+{
+  TArrayD array(world, trange);
+  fill(array);
+
+  // Move the array to the sub-worlds of the even and of the odd processes
+  std::shared_ptr<World> sub = split_world(world, world.rank() % 2);
+  TArrayD even = redistribute(world, array, (world.rank() % 2 ? nullptr : sub.get()));
+  TArrayD odd;
+  if(world.size() > 1)
+    odd = redistribute(world, array, (world.rank() % 2 ? sub.get() : nullptr));
+  TArrayD& local = (world.rank() % 2 ? odd : even);
+  BOOST_CHECK(! (world.rank() % 2 ? even : odd).is_initialized());
+  BOOST_CHECK_EQUAL(&local.world(), sub.get());
+  BOOST_CHECK_EQUAL(local.trange(), trange);
+  check(local);
+
+  // Evaluate an expression on each sub-world, and move the results back
+  TArrayD result;
+  {
+    auto popper = push_default_world(*sub);
+    result("i,j,k") = (world.rank() % 2 ? 3.0 : 2.0) * local("i,j,k");
+  }
+  TArrayD even_result = redistribute(world,
+      (world.rank() % 2 ? TArrayD() : result), &world);
+  BOOST_CHECK_EQUAL(&even_result.world(), &world);
+  check(even_result, 2.0);
+  if(world.size() > 1) {
+    TArrayD odd_result = redistribute(world,
+        (world.rank() % 2 ? result : TArrayD()), &world);
+    check(odd_result, 3.0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( sparse )
+{
+  Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    if(i % 3ul)
+      norms[i] = 100.0f;
+  TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+  fill(array);
+
+  std::shared_ptr<World> sub = split_world(world, 0, world.size() - world.rank());
+  TSpArrayD result = redistribute(world, array, sub.get());
+  for(std::size_t i = 0ul; i < norms.size(); ++i)
+    BOOST_CHECK_EQUAL(result.is_zero(i), array.is_zero(i));
+  check(result);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
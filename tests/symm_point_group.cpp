@@ -0,0 +1,88 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  symm_point_group.cpp
+ *  Mar 3, 2017
+ *
+ */
+
+#include "TiledArray/symm/point_group.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct PointGroupFixture {
+
+  PointGroupFixture() :
+    dim(symmetry::make_irrep_trange1({ 5, 0, 3, 2 }, 2))
+  { }
+
+  ~PointGroupFixture() { }
+
+  symmetry::IrrepTiledRange1 dim;
+}; // PointGroupFixture
+
+BOOST_FIXTURE_TEST_SUITE( symm_point_group_suite, PointGroupFixture )
+
+BOOST_AUTO_TEST_CASE( irrep_product )
+{
+  BOOST_CHECK_EQUAL(symmetry::irrep_product(0u, 5u), 5u);
+  BOOST_CHECK_EQUAL(symmetry::irrep_product(3u, 3u), 0u);
+  BOOST_CHECK_EQUAL(symmetry::irrep_product(1u, 2u), 3u);
+}
+
+BOOST_AUTO_TEST_CASE( trange1 )
+{
+  // Tiles do not mix irreps, and empty irreps have no tiles
+  BOOST_CHECK_EQUAL(dim.trange1, TiledRange1({ 0, 1, 3, 5, 6, 8, 10 }));
+  const std::vector<unsigned int> irreps = { 0u, 0u, 0u, 2u, 2u, 3u };
+  BOOST_CHECK_EQUAL_COLLECTIONS(dim.irreps.begin(), dim.irreps.end(),
+      irreps.begin(), irreps.end());
+}
+
+BOOST_AUTO_TEST_CASE( shape )
+{
+  const TiledRange trange{ dim.trange1, dim.trange1 };
+  for(unsigned int irrep = 0u; irrep < 4u; ++irrep) {
+    const SparseShape<float> shape =
+        symmetry::make_irrep_shape(trange, { dim.irreps, dim.irreps }, irrep);
+    for(std::size_t i = 0ul; i < 6ul; ++i)
+      for(std::size_t j = 0ul; j < 6ul; ++j)
+        BOOST_CHECK_EQUAL(shape.is_zero(trange.tiles_range().ordinal(i, j)),
+            (dim.irreps[i] ^ dim.irreps[j]) != irrep);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  // The shape of a contraction of symmetric arrays is exact
+  const TiledRange trange{ dim.trange1, dim.trange1 };
+  const SparseShape<float> left =
+      symmetry::make_irrep_shape(trange, { dim.irreps, dim.irreps }, 0u);
+  const SparseShape<float> right =
+      symmetry::make_irrep_shape(trange, { dim.irreps, dim.irreps }, 1u);
+  const SparseShape<float> reference =
+      symmetry::make_irrep_shape(trange, { dim.irreps, dim.irreps }, 1u);
+  math::GemmHelper gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+      2u, 2u, 2u);
+
+  const SparseShape<float> result = left.gemm(right, 1.0, gemm_helper);
+  for(std::size_t i = 0ul; i < trange.tiles_range().volume(); ++i)
+    BOOST_CHECK_EQUAL(result.is_zero(i), reference.is_zero(i));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  symm_spin.cpp
+ *  Mar 3, 2017
+ *
+ */
+
+#include "TiledArray/symm/spin.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using symmetry::Spin;
+
+struct SpinFixture {
+
+  SpinFixture() :
+    world(* GlobalFixture::world),
+    dim(symmetry::make_spin_trange1(TiledRange1({ 0, 2, 4 }), TiledRange1({ 0, 3 })))
+  { }
+
+  ~SpinFixture() {
+    world.gop.fence();
+  }
+
+  /// Construct a spin-conserving two-index array
+  TSpArrayD make_array(const double offset) const {
+    const TiledRange trange{ dim.trange1, dim.trange1 };
+    TSpArrayD array(world, trange,
+        symmetry::make_spin_shape(trange, { dim, dim }, 1u));
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = offset + double((*idx)[0]) - 0.5 * double((*idx)[1]);
+      *it = tile;
+    }
+    return array;
+  }
+
+  World& world;
+  symmetry::SpinTiledRange1 dim;
+}; // SpinFixture
+
+BOOST_FIXTURE_TEST_SUITE( symm_spin_suite, SpinFixture )
+
+BOOST_AUTO_TEST_CASE( trange1 )
+{
+  // The beta orbitals follow the alpha orbitals
+  BOOST_CHECK_EQUAL(dim.trange1, TiledRange1({ 0, 2, 4, 7 }));
+  BOOST_CHECK_EQUAL(dim.beta_tile, 2ul);
+  BOOST_CHECK(dim.spin(0ul) == Spin::alpha);
+  BOOST_CHECK(dim.spin(1ul) == Spin::alpha);
+  BOOST_CHECK(dim.spin(2ul) == Spin::beta);
+  BOOST_CHECK(dim.tiles(Spin::alpha) == std::make_pair(0ul, 2ul));
+  BOOST_CHECK(dim.tiles(Spin::beta) == std::make_pair(2ul, 3ul));
+}
+
+BOOST_AUTO_TEST_CASE( shape )
+{
+  // Only the spin-conserving tiles of a two-electron quantity are non-zero
+  const TiledRange trange{ dim.trange1, dim.trange1, dim.trange1, dim.trange1 };
+  const SparseShape<float> shape =
+      symmetry::make_spin_shape(trange, { dim, dim, dim, dim }, 2u);
+  for(std::size_t i = 0ul; i < trange.tiles_range().volume(); ++i) {
+    const auto index = trange.tiles_range().idx(i);
+    int alpha = 0;
+    for(unsigned int d = 0u; d < 4u; ++d)
+      if(index[d] < dim.beta_tile)
+        alpha += (d < 2u ? 1 : -1);
+    BOOST_CHECK_EQUAL(shape.is_zero(i), alpha != 0);
+  }
+
+  // A spin-flip quantity
+  const TiledRange trange2{ dim.trange1, dim.trange1 };
+  const SparseShape<float> shape2 =
+      symmetry::make_spin_shape(trange2, { dim, dim }, 1u, 1);
+  for(std::size_t i = 0ul; i < 3ul; ++i)
+    for(std::size_t j = 0ul; j < 3ul; ++j)
+      BOOST_CHECK_EQUAL(shape2.is_zero(trange2.tiles_range().ordinal(i, j)),
+          ! ((i < 2ul) && (j >= 2ul)));
+}
+
+BOOST_AUTO_TEST_CASE( block )
+{
+  const auto bounds = symmetry::spin_block({ dim, dim }, { Spin::alpha, Spin::beta });
+  BOOST_CHECK(bounds.first == std::vector<std::size_t>({ 0ul, 2ul }));
+  BOOST_CHECK(bounds.second == std::vector<std::size_t>({ 2ul, 3ul }));
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  const TSpArrayD a = make_array(1.0);
+  const TSpArrayD b = make_array(-2.0);
+
+  // Contract over all spin cases in a single expression
+  TSpArrayD c;
+  c("i,j") = a("i,k") * b("k,j");
+  for(std::size_t i = 0ul; i < 3ul; ++i)
+    for(std::size_t j = 0ul; j < 3ul; ++j)
+      BOOST_CHECK_EQUAL(c.is_zero(c.trange().tiles_range().ordinal(i, j)),
+          dim.spin(i) != dim.spin(j));
+
+  // Each spin case is the contraction of the blocks of that spin case
+  for(const Spin spin : { Spin::alpha, Spin::beta }) {
+    const auto block = symmetry::spin_block({ dim, dim }, { spin, spin });
+    TSpArrayD d;
+    d("i,j") = a("i,k").block(block.first, block.second) *
+        b("k,j").block(block.first, block.second);
+    const double error =
+        (c("i,j").block(block.first, block.second) - d("i,j")).norm().get();
+    BOOST_CHECK_SMALL(error, 1.0e-10);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  symmetric_array.cpp
+ *  Mar 2, 2017
+ *
+ */
+
+#include "TiledArray/symmetric_array.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct SymmetricArrayFixture {
+
+  SymmetricArrayFixture() :
+    world(* GlobalFixture::world),
+    trange{ { 0, 2, 5, 6 }, { 0, 2, 5, 6 }, { 0, 3, 7 }, { 0, 3, 7 } },
+    group(std::vector<symmetry::Permutation>{ symmetry::Permutation{ 1, 0, 2, 3 },
+        symmetry::Permutation{ 0, 1, 3, 2 } })
+  { }
+
+  ~SymmetricArrayFixture() {
+    world.gop.fence();
+  }
+
+  /// An element of an array that is (anti)symmetric in (0,1) and in (2,3)
+  template <typename Index>
+  static double value(const Index& i, const bool antisymmetric) {
+    const double sign = (antisymmetric ? -1.0 : 1.0);
+    const double shift = (antisymmetric ? 0.0 : 0.5);
+    return (double(i[0]) + sign * double(i[1]) + shift) *
+        (double(i[2]) + sign * double(i[3]) + shift) *
+        (1.0 + double(i[0] + i[1]) + 2.0 * double(i[2] + i[3]));
+  }
+
+  /// Construct an array with all tiles
+  TSpArrayD make_array(const bool antisymmetric) {
+    Tensor<float> norms(trange.tiles_range(), 1.0f);
+    TSpArrayD array(world, trange, SparseShape<float>(norms, trange));
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TensorD tile(it.make_range());
+      for(auto idx = tile.range().begin(); idx != tile.range().end(); ++idx)
+        tile[*idx] = value(*idx, antisymmetric);
+      *it = tile;
+    }
+    return array;
+  }
+
+  World& world;
+  TiledRange trange;
+  symmetry::PermutationGroup group;
+}; // struct SymmetricArrayFixture
+
+BOOST_FIXTURE_TEST_SUITE( symmetric_array_suite, SymmetricArrayFixture )
+
+BOOST_AUTO_TEST_CASE( parity )
+{
+  BOOST_CHECK_EQUAL(symmetry::parity(symmetry::Permutation()), 1);
+  BOOST_CHECK_EQUAL(symmetry::parity(symmetry::Permutation{ 1, 0, 2, 3 }), -1);
+  BOOST_CHECK_EQUAL(symmetry::parity(symmetry::Permutation{ 1, 0, 3, 2 }), 1);
+  BOOST_CHECK_EQUAL(symmetry::parity(symmetry::Permutation{ 1, 2, 0 }), 1);
+}
+
+BOOST_AUTO_TEST_CASE( unique_tiles )
+{
+  const TSpArrayD array = make_array(false);
+  const SymmetricArray<TensorD> symm = make_symmetric_array(array, group);
+
+  // 6 of the 3x3 tiles of dimensions (0,1) and 3 of the 2x2 tiles of
+  // dimensions (2,3) are unique
+  std::size_t unique = 0ul;
+  for(std::size_t i = 0ul; i < array.size(); ++i) {
+    const auto index = trange.tiles_range().idx(i);
+    const bool is_unique = (index[0] <= index[1]) && (index[2] <= index[3]);
+    BOOST_CHECK_EQUAL(symm.is_unique(index), is_unique);
+    BOOST_CHECK_EQUAL(symm.unique().is_zero(i), ! is_unique);
+    BOOST_CHECK(! symm.is_zero(index));
+    if(is_unique)
+      ++unique;
+  }
+  BOOST_CHECK_EQUAL(unique, 6ul * 3ul);
+}
+
+BOOST_AUTO_TEST_CASE( symmetric )
+{
+  const TSpArrayD array = make_array(false);
+  const SymmetricArray<TensorD> symm = make_symmetric_array(array, group);
+
+  for(std::size_t i = 0ul; i < array.size(); ++i) {
+    const TensorD tile = symm.find(trange.tiles_range().idx(i)).get();
+    const TensorD reference = array.find(i).get();
+    BOOST_REQUIRE_EQUAL(tile.range(), reference.range());
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], reference[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( antisymmetric )
+{
+  const TSpArrayD array = make_array(true);
+  const SymmetricArray<TensorD> symm = make_symmetric_array(array, group, true);
+
+  const TSpArrayD result = symm.expand();
+  BOOST_CHECK_EQUAL(result.trange(), trange);
+  for(auto it = result.begin(); it != result.end(); ++it) {
+    const TensorD tile = *it;
+    const TensorD reference = array.find(it.ordinal()).get();
+    BOOST_REQUIRE_EQUAL(tile.range(), reference.range());
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_CLOSE(tile[j], reference[j], 1.0e-10);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/task_trace.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using namespace TiledArray;
+
+struct TaskTraceFixture {
+  TaskTraceFixture() :
+    trange({ TiledRange1{0, 3, 8, 10}, TiledRange1{0, 2, 7, 11} }),
+    enabled(task_trace_enabled())
+  {
+    GlobalFixture::world->gop.fence();
+    task_trace_clear();
+  }
+
+  ~TaskTraceFixture() {
+    GlobalFixture::world->gop.fence();
+    task_trace_enable(enabled);
+    task_trace_clear();
+  }
+
+  TiledRange trange;
+  bool enabled;
+};
+
+BOOST_FIXTURE_TEST_SUITE( task_trace_suite , TaskTraceFixture )
+
+BOOST_AUTO_TEST_CASE( disabled )
+{
+  task_trace_enable(false);
+
+  TArrayD a(*GlobalFixture::world, trange), c;
+  a.fill(1.0);
+  c("i,j") = a("i,j") + a("i,j");
+  GlobalFixture::world->gop.fence();
+
+  BOOST_CHECK_EQUAL(task_trace_size(), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( chrome_trace )
+{
+  task_trace_enable();
+
+  TArrayD a(*GlobalFixture::world, trange), b(*GlobalFixture::world, trange), c;
+  a.fill(1.0);
+  b.fill(2.0);
+  c("i,j") = a("i,j") + 2.0 * b("i,j");
+  c("i,j") = a("i,k") * b("k,j");
+  GlobalFixture::world->gop.fence();
+
+  // Every local tile of the sum is evaluated by a traced task
+  BOOST_CHECK_GE(task_trace_size(), c.pmap()->local_size());
+
+  const std::string filename = "task_trace_test.json";
+  BOOST_REQUIRE_NO_THROW(write_task_trace(*GlobalFixture::world, filename));
+
+  if(GlobalFixture::world->rank() == 0) {
+    std::ifstream file(filename);
+    const std::string trace((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    BOOST_CHECK_EQUAL(trace.find("{\"displayTimeUnit\""), 0ul);
+    BOOST_CHECK_NE(trace.find("\"binary_eval\""), std::string::npos);
+    BOOST_CHECK_NE(trace.find("\"summa_step\""), std::string::npos);
+    BOOST_CHECK_EQUAL(trace.substr(trace.size() - 4ul), "\n]}\n");
+    std::remove(filename.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,6 +21,7 @@
 #include "tiledarray.h"
 #include "unit_test_config.h"
 #include "tensor_fixture.h"
+#include <algorithm>
 #include <iterator>
 
 
@@ -169,6 +170,52 @@ BOOST_AUTO_TEST_CASE( permute_constructor_tensor ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( permute_constructor_tensor_5d ) {
+  const std::array<std::size_t, 5> start = {{0ul, 0ul, 0ul, 0ul, 0ul}};
+  const std::array<std::size_t, 5> finish = {{3ul, 5ul, 2ul, 7ul, 4ul}};
+  TensorN x(range_type(start, finish));
+  rand_fill(1693, x.size(), x.data());
+
+  std::array<unsigned int, 5> p = {{0,1,2,3,4}};
+
+  while(std::next_permutation(p.begin(), p.end())) {
+    Permutation perm(p.begin(), p.end());
+
+    TensorN px;
+    // check constructor
+    BOOST_REQUIRE_NO_THROW(px = TensorN(x, perm));
+    BOOST_CHECK(! px.empty());
+
+    for(std::size_t i = 0ul; i < x.size(); ++i) {
+      std::size_t pi = px.range().ordinal(perm * x.range().idx(i));
+      BOOST_CHECK_EQUAL(px[pi], x[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( permute_plan_cache ) {
+  const Permutation perm({ 2, 0, 1 });
+  const range_type r1({ 0ul, 0ul, 0ul }, { 3ul, 5ul, 7ul });
+  const range_type r2({ 3ul, 5ul, 7ul }, { 6ul, 10ul, 14ul });
+
+  // Tensors with the same extent share a plan
+  const auto plan = detail::perm_plan(perm, r1);
+  BOOST_CHECK_EQUAL(plan, detail::perm_plan(perm, r2));
+  BOOST_CHECK_NE(plan, detail::perm_plan(perm,
+      range_type({ 0ul, 0ul, 0ul }, { 3ul, 5ul, 8ul })));
+  BOOST_CHECK_NE(plan, detail::perm_plan(Permutation({ 1, 2, 0 }), r1));
+
+  TensorN x(r2);
+  rand_fill(1693, x.size(), x.data());
+  for(int repeat = 0; repeat < 2; ++repeat) {
+    TensorN px(x, perm);
+    for(std::size_t i = 0ul; i < x.size(); ++i) {
+      std::size_t pi = px.range().ordinal(perm * x.range().idx(i));
+      BOOST_CHECK_EQUAL(px[pi], x[i]);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE( unary_constructor ) {
   // check constructor
   BOOST_REQUIRE_NO_THROW(TensorN x(t, [] (const int arg) { return arg * 83; }));
@@ -269,6 +316,45 @@ BOOST_AUTO_TEST_CASE( clone ) {
   BOOST_CHECK_EQUAL_COLLECTIONS(tc.begin(), tc.end(), t.begin(), t.end());
 }
 
+BOOST_AUTO_TEST_CASE( shift ) {
+  std::vector<long> bound_shift(t.range().rank(), 2l);
+  TensorN ts;
+  BOOST_REQUIRE_NO_THROW(ts = t.shift(bound_shift));
+
+  // Check that the data is shared and only the range is shifted
+  BOOST_CHECK_EQUAL(ts.data(), t.data());
+  BOOST_CHECK_EQUAL(ts.range(), Range(t.range()).inplace_shift(bound_shift));
+  BOOST_CHECK_EQUAL(t.range(), r);
+  BOOST_CHECK_EQUAL(ts[ts.range().lobound()], t[t.range().lobound()]);
+}
+
+BOOST_AUTO_TEST_CASE( permute_to ) {
+  const std::array<std::size_t, 3> start = {{0ul, 0ul, 0ul}};
+  const std::array<std::size_t, 3> finish = {{5ul, 1ul, 3ul}};
+  TensorN x(range_type(start, finish));
+  rand_fill(431, x.size(), x.data());
+
+  // A permutation that moves only the unit dimension permutes the range
+  Permutation unit_perm({1, 0, 2});
+  BOOST_CHECK(detail::is_layout_preserving(unit_perm, x.range()));
+  TensorN px = x.permute(unit_perm);
+  TensorN y = x.clone();
+  const int* const data = y.data();
+  BOOST_REQUIRE_NO_THROW(y.permute_to(unit_perm));
+  BOOST_CHECK_EQUAL(y.data(), data);
+  BOOST_CHECK_EQUAL(y.range(), px.range());
+  BOOST_CHECK_EQUAL_COLLECTIONS(y.begin(), y.end(), px.begin(), px.end());
+
+  // Other permutations replace the tensor with a permuted copy
+  Permutation perm({2, 1, 0});
+  BOOST_CHECK(! detail::is_layout_preserving(perm, x.range()));
+  px = x.permute(perm);
+  y = x.clone();
+  BOOST_REQUIRE_NO_THROW(y.permute_to(perm));
+  BOOST_CHECK_EQUAL(y.range(), px.range());
+  BOOST_CHECK_EQUAL_COLLECTIONS(y.begin(), y.end(), px.begin(), px.end());
+}
+
 BOOST_AUTO_TEST_CASE( range_accessor )
 {
   BOOST_CHECK_EQUAL_COLLECTIONS(t.range().lobound_data(), t.range().lobound_data() + t.range().rank(),
@@ -531,5 +617,40 @@ BOOST_AUTO_TEST_CASE( inplace_conj_scal_op ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( mask_op ) {
+  TiledArray::detail::Bitset<> mask(t.size());
+  for(std::size_t i = 0ul; i < t.size(); i += 3ul)
+    mask.set(i);
+
+  TensorN s;
+  BOOST_REQUIRE_NO_THROW(s = t.mask(mask));
+  BOOST_CHECK_EQUAL(s.range(), t.range());
+  for(std::size_t i = 0ul; i < t.size(); ++i)
+    BOOST_CHECK_EQUAL(s[i], (i % 3ul ? 0 : t[i]));
+
+  TensorN u = t.clone();
+  BOOST_REQUIRE_NO_THROW(u.mask_to(mask));
+  for(std::size_t i = 0ul; i < t.size(); ++i)
+    BOOST_CHECK_EQUAL(u[i], s[i]);
+}
+
+BOOST_AUTO_TEST_CASE( large_op ) {
+  // The tensors are larger than the threshold, so the kernels are split
+  const std::size_t n = std::max<std::size_t>(
+      math::parallel_vector_threshold() / sizeof(double), 1ul << 16) + 1001ul;
+  TensorD x(Range(n / 7ul + 1ul, 7ul));
+  for(std::size_t i = 0ul; i < x.size(); ++i)
+    x[i] = double(i % 97ul);
+
+  TensorD y;
+  BOOST_REQUIRE_NO_THROW(y = x.scale(3.0));
+  BOOST_REQUIRE_NO_THROW(y.add_to(x));
+  std::size_t errors = 0ul;
+  for(std::size_t i = 0ul; i < y.size(); ++i)
+    if(y[i] != 4.0 * double(i % 97ul))
+      ++errors;
+  BOOST_CHECK_EQUAL(errors, 0ul);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -863,4 +863,53 @@ BOOST_AUTO_TEST_CASE( dot )
   BOOST_CHECK_EQUAL(x, expected);
 }
 
+BOOST_AUTO_TEST_CASE( packed )
+{
+  // The results of element-wise operations are packed
+  BOOST_CHECK(! is_packed(a));
+  BOOST_CHECK(is_packed(c));
+
+  Tensor<Tensor<int> > pa = pack(a), pb = pack(b);
+  BOOST_CHECK(is_packed(pa));
+  BOOST_CHECK(is_packed(pb));
+
+  // Packed arguments are evaluated over all inner elements at once
+  Tensor<Tensor<int> > t = pa.add(pb);
+  BOOST_CHECK(is_packed(t));
+  pa.subt_to(pb);
+  BOOST_CHECK(is_packed(pa));
+
+  for(std::size_t i = 0ul; i < t.size(); ++i) {
+    BOOST_CHECK_EQUAL(t[i].range(), a[i].range());
+    BOOST_CHECK_EQUAL(pa[i].range(), a[i].range());
+    for(std::size_t j = 0ul; j < t[i].size(); ++j) {
+      BOOST_CHECK_EQUAL(t[i][j], a[i][j] + b[i][j]);
+      BOOST_CHECK_EQUAL(pa[i][j], a[i][j] - b[i][j]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( inner_gemm )
+{
+  Tensor<Tensor<int> > left(Range(size)), right(Range(size));
+  for(std::size_t i = 0ul; i < left.size(); ++i) {
+    left[i] = make_rand_tensor(Range(4, 3));
+    right[i] = make_rand_tensor(Range(3, 5));
+  }
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  Tensor<Tensor<int> > t;
+  BOOST_CHECK_NO_THROW(t = TiledArray::inner_gemm(left, right, 2, gemm_helper));
+  BOOST_CHECK(is_packed(t));
+  BOOST_CHECK_EQUAL(t.range(), left.range());
+
+  for(std::size_t i = 0ul; i < t.size(); ++i) {
+    const Tensor<int> reference = left[i].gemm(right[i], 2, gemm_helper);
+    BOOST_CHECK_EQUAL(t[i].range(), reference.range());
+    for(std::size_t j = 0ul; j < reference.size(); ++j)
+      BOOST_CHECK_EQUAL(t[i][j], reference[j]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,241 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tensor_pool_allocator.cpp
+ *  Jan 23, 2017
+ *
+ */
+
+#include "TiledArray/tensor/pool_allocator.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using TiledArray::PoolAllocator;
+using TiledArray::PoolAllocatorStats;
+using TiledArray::detail::MemoryPool;
+
+struct PoolAllocatorFixture {
+
+  PoolAllocatorFixture() { }
+
+  ~PoolAllocatorFixture() { }
+
+}; // PoolAllocatorFixture
+
+BOOST_FIXTURE_TEST_SUITE( pool_allocator_suite, PoolAllocatorFixture )
+
+BOOST_AUTO_TEST_CASE( size_class )
+{
+  // Check the first size classes
+  BOOST_CHECK_EQUAL(MemoryPool::size_class(1ul), 0ul);
+  BOOST_CHECK_EQUAL(MemoryPool::size_class(64ul), 0ul);
+  BOOST_CHECK_EQUAL(MemoryPool::size_class(65ul), 1ul);
+  BOOST_CHECK_EQUAL(MemoryPool::class_bytes(0ul), 64ul);
+  BOOST_CHECK_EQUAL(MemoryPool::class_bytes(1ul), 80ul);
+  BOOST_CHECK_EQUAL(MemoryPool::class_bytes(4ul), 128ul);
+
+  // Check the largest size class
+  BOOST_CHECK_EQUAL(MemoryPool::size_class(1ul << MemoryPool::max_block_log2),
+      MemoryPool::num_classes - 1ul);
+  BOOST_CHECK_EQUAL(MemoryPool::class_bytes(MemoryPool::num_classes - 1ul),
+      1ul << MemoryPool::max_block_log2);
+
+  // Check that each size is held by the smallest size class that fits
+  for(std::size_t bytes = 1ul; bytes < 100000ul; bytes += 7ul) {
+    const std::size_t c = MemoryPool::size_class(bytes);
+    BOOST_CHECK_GE(MemoryPool::class_bytes(c), bytes);
+    if(c > 0ul)
+      BOOST_CHECK_LT(MemoryPool::class_bytes(c - 1ul), bytes);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( pool )
+{
+  MemoryPool pool(1ul << 20);
+
+  // Check that a deallocated block is reused for a block of the same class
+  void* p = pool.allocate(1000ul);
+  BOOST_CHECK(p != nullptr);
+  pool.deallocate(p, 1000ul);
+  void* q = pool.allocate(1010ul);
+  BOOST_CHECK_EQUAL(q, p);
+
+  // Check that blocks of another size class are not reused
+  pool.deallocate(q, 1010ul);
+  q = pool.allocate(4000ul);
+  BOOST_CHECK_NE(q, p);
+  pool.deallocate(q, 4000ul);
+
+  PoolAllocatorStats stats = PoolAllocatorStats();
+  pool.accumulate(stats);
+  BOOST_CHECK_EQUAL(stats.allocations, 3ul);
+  BOOST_CHECK_EQUAL(stats.hits, 1ul);
+  BOOST_CHECK_EQUAL(stats.deallocations, 3ul);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, MemoryPool::class_bytes(
+      MemoryPool::size_class(1000ul)) + MemoryPool::class_bytes(
+      MemoryPool::size_class(4000ul)));
+  BOOST_CHECK_EQUAL(stats.peak_pooled_bytes, stats.pooled_bytes);
+  BOOST_CHECK_CLOSE(stats.hit_rate(), 100.0 / 3.0, 1.0e-6);
+
+  // Check that release returns all blocks to the system
+  pool.release();
+  stats = PoolAllocatorStats();
+  pool.accumulate(stats);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( pool_limit )
+{
+  MemoryPool pool(1000ul);
+
+  // Check that blocks are not held beyond the pool limit
+  void* p = pool.allocate(2000ul);
+  pool.deallocate(p, 2000ul);
+  PoolAllocatorStats stats = PoolAllocatorStats();
+  pool.accumulate(stats);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, 0ul);
+
+  // Check that large blocks are not pooled
+  MemoryPool large_pool(1ul << 30);
+  const std::size_t large = (1ul << MemoryPool::max_block_log2) + 1ul;
+  BOOST_CHECK(MemoryPool::is_pooled(2000ul));
+  BOOST_CHECK(! MemoryPool::is_pooled(large));
+  p = large_pool.allocate(large);
+  BOOST_CHECK(p != nullptr);
+  large_pool.deallocate(p, large);
+  stats = PoolAllocatorStats();
+  large_pool.accumulate(stats);
+  BOOST_CHECK_EQUAL(stats.pooled_bytes, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( numa_nodes )
+{
+  // Check the node list parser
+  std::vector<unsigned long> mask = TiledArray::detail::numa_parse_nodes("0");
+  BOOST_CHECK_EQUAL(mask.size(), 1ul);
+  BOOST_CHECK_EQUAL(mask[0], 1ul);
+  mask = TiledArray::detail::numa_parse_nodes("0-1,3");
+  BOOST_CHECK_EQUAL(mask.size(), 1ul);
+  BOOST_CHECK_EQUAL(mask[0], 11ul);
+  mask = TiledArray::detail::numa_parse_nodes("2,64-65");
+  BOOST_CHECK_EQUAL(mask.size(), 2ul);
+  BOOST_CHECK_EQUAL(mask[0], 4ul);
+  BOOST_CHECK_EQUAL(mask[1], 3ul);
+
+  // Check that interleaved blocks can be used
+  const std::size_t bytes = 1ul << 20;
+  double* const p = static_cast<double*>(
+      TiledArray::detail::numa_interleaved_malloc(bytes));
+  BOOST_CHECK(p != nullptr);
+  std::fill_n(p, bytes / sizeof(double), 1.0);
+  BOOST_CHECK_EQUAL(p[bytes / sizeof(double) - 1ul], 1.0);
+  TiledArray::detail::numa_interleaved_free(p, bytes);
+}
+
+BOOST_AUTO_TEST_CASE( huge_pages )
+{
+  using TiledArray::detail::HugePageCache;
+  const std::size_t page_size = TiledArray::detail::huge_page_size();
+  BOOST_CHECK_EQUAL(HugePageCache::mapped_bytes(1ul), page_size);
+  BOOST_CHECK_EQUAL(HugePageCache::mapped_bytes(page_size + 1ul),
+      2ul * page_size);
+
+  HugePageCache cache(4ul * page_size, false);
+  std::size_t registrations = 0ul, deregistrations = 0ul;
+  cache.set_registration(
+      [&] (void*, std::size_t) -> void* { ++registrations; return & registrations; },
+      [&] (void*, std::size_t, void*) { ++deregistrations; });
+
+  // Check that blocks are aligned to huge pages, usable, and registered
+  const std::size_t bytes = page_size + 100ul;
+  double* const p = static_cast<double*>(cache.allocate(bytes));
+  BOOST_REQUIRE(p != nullptr);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(p) % page_size, 0ul);
+  std::fill_n(p, bytes / sizeof(double), 1.0);
+  BOOST_CHECK_EQUAL(p[bytes / sizeof(double) - 1ul], 1.0);
+  BOOST_CHECK_EQUAL(cache.registration(p), & registrations);
+  BOOST_CHECK_EQUAL(registrations, 1ul);
+
+  // Check that a freed block is reused with its registration
+  cache.deallocate(p);
+  BOOST_CHECK_EQUAL(cache.free_bytes(), 2ul * page_size);
+  void* const q = cache.allocate(bytes + 100ul);
+  BOOST_CHECK_EQUAL(q, static_cast<void*>(p));
+  BOOST_CHECK_EQUAL(cache.reuses(), 1ul);
+  BOOST_CHECK_EQUAL(registrations, 1ul);
+  BOOST_CHECK_EQUAL(deregistrations, 0ul);
+
+  // Check that blocks beyond the cache limit are returned to the system
+  void* const r = cache.allocate(3ul * page_size);
+  cache.deallocate(q);
+  cache.deallocate(r);
+  BOOST_CHECK_EQUAL(cache.free_bytes(), 2ul * page_size);
+  BOOST_CHECK_EQUAL(deregistrations, 1ul);
+
+  // Check that release deregisters the free blocks
+  cache.release();
+  BOOST_CHECK_EQUAL(cache.free_bytes(), 0ul);
+  BOOST_CHECK_EQUAL(deregistrations, 2ul);
+  BOOST_CHECK(cache.registration(q) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( allocator )
+{
+  PoolAllocator<double> alloc;
+  BOOST_CHECK(alloc == PoolAllocator<int>());
+
+  // Check that zero sized allocations do not allocate
+  BOOST_CHECK(alloc.allocate(0ul) == nullptr);
+  BOOST_CHECK_NO_THROW(alloc.deallocate(nullptr, 0ul));
+
+  // Check that memory is usable and aligned
+  double* p = alloc.allocate(100ul);
+  BOOST_REQUIRE(p != nullptr);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(p) % 16ul, 0ul);
+  for(std::size_t i = 0ul; i < 100ul; ++i)
+    p[i] = i;
+  alloc.deallocate(p, 100ul);
+
+  // Check that the statistics count pool hits
+  const PoolAllocatorStats before = TiledArray::pool_allocator_stats();
+  double* q = alloc.allocate(100ul);
+  alloc.deallocate(q, 100ul);
+  const PoolAllocatorStats after = TiledArray::pool_allocator_stats();
+  BOOST_CHECK_EQUAL(after.allocations - before.allocations, 1ul);
+  BOOST_CHECK_EQUAL(after.hits - before.hits, 1ul);
+  BOOST_CHECK_EQUAL(after.deallocations - before.deallocations, 1ul);
+
+  BOOST_CHECK_NO_THROW(TiledArray::pool_allocator_release());
+}
+
+BOOST_AUTO_TEST_CASE( tensor )
+{
+  // Check that the pool allocator is the default for double tensors
+  BOOST_CHECK((std::is_same<TiledArray::Tensor<double>::allocator_type,
+      PoolAllocator<double> >::value));
+  BOOST_CHECK((std::is_same<TiledArray::TensorD,
+      TiledArray::Tensor<double> >::value));
+
+  // Check that tensors allocated with the pool allocator are usable
+  TiledArray::Range range(std::vector<std::size_t>{ 10, 20, 30 });
+  TiledArray::TensorD t(range, 1.0);
+  TiledArray::TensorD s = t.add(t);
+  for(const double value : s)
+    BOOST_CHECK_EQUAL(value, 2.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -406,4 +406,78 @@ BOOST_AUTO_TEST_CASE( scale_to_view )
   }
 }
 
+BOOST_AUTO_TEST_CASE( strided_view )
+{
+  TensorStridedView<int> view = t.slice({0,1,2}, {5,7,11}, {2,3,4});
+
+  // Check the range of the view
+  BOOST_CHECK_EQUAL(view.range().rank(), 3u);
+  BOOST_CHECK_EQUAL(view.range().extent(0), 3ul);
+  BOOST_CHECK_EQUAL(view.range().extent(1), 2ul);
+  BOOST_CHECK_EQUAL(view.range().extent(2), 3ul);
+  BOOST_CHECK_EQUAL(view.size(), 18ul);
+
+  // Check that the view references every step-th element of t
+  int sum = 0;
+  std::size_t o = 0ul;
+  for(std::size_t i = 0ul; i < 3ul; ++i)
+    for(std::size_t j = 0ul; j < 2ul; ++j)
+      for(std::size_t k = 0ul; k < 3ul; ++k, ++o) {
+        BOOST_CHECK_EQUAL(view(i, j, k), t(2ul * i, 1ul + 3ul * j, 2ul + 4ul * k));
+        BOOST_CHECK_EQUAL(view[o], view(i, j, k));
+        sum += view(i, j, k);
+      }
+
+  // Check that the kernels operate on the strided elements
+  BOOST_CHECK_EQUAL(view.sum(), sum);
+  Tensor<int> scaled = view.scale(2);
+  for(std::size_t i = 0ul; i < view.size(); ++i)
+    BOOST_CHECK_EQUAL(scaled[i], 2 * view[i]);
+
+  // Check that the writes into the view are visible in t
+  Tensor<int> tensor = random_tensor(Range(view.range().lobound(),
+      view.range().upbound()));
+  BOOST_CHECK_NO_THROW(view = tensor);
+  for(std::size_t i = 0ul; i < tensor.size(); ++i)
+    BOOST_CHECK_EQUAL(view[i], tensor[i]);
+  BOOST_CHECK_EQUAL(t(4, 4, 10), tensor(2, 1, 2));
+}
+
+BOOST_AUTO_TEST_CASE( diagonal_view )
+{
+  TensorConstStridedView<int> view = static_cast<const Tensor<int>&>(t).diagonal();
+
+  BOOST_CHECK_EQUAL(view.range().rank(), 1u);
+  BOOST_CHECK_EQUAL(view.size(), 5ul);
+
+  int trace = 0;
+  for(std::size_t k = 0ul; k < 5ul; ++k) {
+    BOOST_CHECK_EQUAL(view[k], t(k, 1ul + k, 2ul + k));
+    trace += t(k, 1ul + k, 2ul + k);
+  }
+  BOOST_CHECK_EQUAL(view.sum(), trace);
+  BOOST_CHECK_EQUAL(view.dot(view), view.squared_norm());
+}
+
+BOOST_AUTO_TEST_CASE( fixed_index_view )
+{
+  Tensor<int> t0 = t.clone();
+  TensorStridedView<int> view = t.fix(1, 3);
+
+  BOOST_CHECK_EQUAL(view.range().rank(), 2u);
+  BOOST_CHECK_EQUAL(view.range().extent(0), 5ul);
+  BOOST_CHECK_EQUAL(view.range().extent(1), 9ul);
+
+  for(std::size_t i = 0ul; i < 5ul; ++i)
+    for(std::size_t k = 0ul; k < 9ul; ++k)
+      BOOST_CHECK_EQUAL(view(i, k), t(i, 3ul, 2ul + k));
+
+  // Check that an in-place operation only modifies the referenced elements
+  view.scale_to(2);
+  for(auto it = t.range().begin(); it != t.range().end(); ++it) {
+    const auto& idx = *it;
+    BOOST_CHECK_EQUAL(t(idx), (idx[1] == 3ul ? 2 : 1) * t0(idx));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,105 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile.cpp
+ *  Apr 5, 2017
+ *
+ */
+
+#include "TiledArray/tile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct TileFixture {
+  typedef Tile<TensorD> tile_type;
+
+  TileFixture() : tile(Range(3, 4), 1.0) { }
+
+  ~TileFixture() { }
+
+  tile_type tile;
+}; // TileFixture
+
+BOOST_FIXTURE_TEST_SUITE( tile_suite, TileFixture )
+
+BOOST_AUTO_TEST_CASE( copy_on_write )
+{
+  BOOST_CHECK(! tile.is_shared());
+  const double* const data = static_cast<const tile_type&>(tile).tensor().data();
+
+  // an unshared tile is modified in place
+  tile[0] = 2.0;
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(tile).tensor().data(), data);
+
+  // copies share the tensor until one of them is modified
+  tile_type copy = tile;
+  BOOST_CHECK(tile.is_shared());
+  BOOST_CHECK(copy.is_shared());
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(copy).tensor().data(), data);
+
+  copy[1] = 3.0;
+  BOOST_CHECK(! tile.is_shared());
+  BOOST_CHECK(! copy.is_shared());
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(tile).tensor().data(), data);
+  BOOST_CHECK_NE(static_cast<const tile_type&>(copy).tensor().data(), data);
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(tile)[1], 1.0);
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(copy)[0], 2.0);
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(copy)[1], 3.0);
+}
+
+BOOST_AUTO_TEST_CASE( in_place_operations )
+{
+  const tile_type copy = tile;
+  tile_type result = tile;
+
+  // the in-place operations do not modify the other copies
+  add_to(result, copy);
+  scale_to(result, 2.0);
+  for(std::size_t i = 0ul; i < copy.size(); ++i) {
+    BOOST_CHECK_EQUAL(copy[i], 1.0);
+    BOOST_CHECK_EQUAL(static_cast<const tile_type&>(result)[i], 4.0);
+  }
+
+  // assignment of a tensor does not modify the other copies
+  tile_type other = copy;
+  other = TensorD(Range(3, 4), 5.0);
+  BOOST_CHECK_EQUAL(copy[0], 1.0);
+  BOOST_CHECK_EQUAL(static_cast<const tile_type&>(other)[0], 5.0);
+}
+
+BOOST_AUTO_TEST_CASE( share_instead_of_clone )
+{
+  BOOST_CHECK(is_copy_on_write_tile<tile_type>::value);
+  BOOST_CHECK(! is_copy_on_write_tile<TensorD>::value);
+
+  // copy-on-write tiles are shared
+  const tile_type shared = share_or_clone(tile);
+  BOOST_CHECK(tile.is_shared());
+  TiledArray::Clone<tile_type, tile_type> clone_op;
+  const tile_type cloned = clone_op(tile);
+  BOOST_CHECK_EQUAL(cloned.tensor().data(), shared.tensor().data());
+
+  // other tiles are cloned
+  const TensorD tensor = static_cast<const tile_type&>(tile).tensor();
+  const TensorD tensor_copy = share_or_clone(tensor);
+  BOOST_CHECK_NE(tensor_copy.data(), tensor.data());
+  BOOST_CHECK_EQUAL(tensor_copy[0], tensor[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,167 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_compression.cpp
+ *  Feb 8, 2017
+ *
+ */
+
+#include "TiledArray/tile_compression.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using TiledArray::TileCodec;
+using TiledArray::TensorD;
+
+struct TileCompressionFixture {
+
+  TileCompressionFixture() :
+    codec(TiledArray::tile_codec()),
+    tolerance(TiledArray::tile_codec_tolerance()),
+    threshold(TiledArray::tile_compression_threshold())
+  { }
+
+  ~TileCompressionFixture() {
+    TiledArray::tile_codec(codec, tolerance);
+    TiledArray::tile_compression_threshold(threshold);
+  }
+
+  /// A tensor where most elements are zero or small
+  static TensorD make_tensor() {
+    TensorD result(TiledArray::Range(31, 37));
+    GlobalFixture::world->srand(27);
+    for(std::size_t i = 0ul; i < result.size(); ++i) {
+      const int r = GlobalFixture::world->rand() % 10;
+      result[i] = (r == 0 ? double(GlobalFixture::world->rand() % 101) / 8.0 :
+          (r == 1 ? 1.0e-9 * r : 0.0));
+    }
+    return result;
+  }
+
+  TileCodec codec;
+  double tolerance;
+  std::size_t threshold;
+}; // TileCompressionFixture
+
+BOOST_FIXTURE_TEST_SUITE( tile_compression_suite, TileCompressionFixture )
+
+BOOST_AUTO_TEST_CASE( settings )
+{
+  TiledArray::tile_codec(TileCodec::lossy, 1.0e-6);
+  BOOST_CHECK(TiledArray::tile_codec() == TileCodec::lossy);
+  BOOST_CHECK_EQUAL(TiledArray::tile_codec_tolerance(), 1.0e-6);
+  BOOST_CHECK_THROW(TiledArray::tile_codec(TileCodec::lossy, -1.0),
+      TiledArray::Exception);
+
+  // Check that only tiles above the threshold are compressed
+  TiledArray::tile_compression_threshold(800ul);
+  BOOST_CHECK(! TiledArray::detail::is_compressed<TensorD>(99ul));
+  BOOST_CHECK(TiledArray::detail::is_compressed<TensorD>(100ul));
+  BOOST_CHECK(! TiledArray::detail::is_compressed<TiledArray::TensorI>(100ul));
+
+  TiledArray::tile_codec(TileCodec::none);
+  BOOST_CHECK(! TiledArray::detail::is_compressed<TensorD>(100ul));
+}
+
+BOOST_AUTO_TEST_CASE( lossless )
+{
+  const TensorD tensor = make_tensor();
+  TiledArray::tile_codec(TileCodec::lossless);
+  TiledArray::reset_tile_compression_stats();
+
+  const TiledArray::detail::CompressedTile<TensorD> compressed =
+      TiledArray::detail::compress_tile(tensor);
+  BOOST_CHECK_LT(compressed.size(), tensor.size() * sizeof(double));
+
+  const TensorD result = TiledArray::detail::decompress_tile(compressed);
+  BOOST_CHECK_EQUAL(result.range(), tensor.range());
+  for(std::size_t i = 0ul; i < tensor.size(); ++i)
+    BOOST_CHECK_EQUAL(result[i], tensor[i]);
+
+  // Check the counters
+  const TiledArray::TileCompressionStats stats =
+      TiledArray::tile_compression_stats();
+  BOOST_CHECK_EQUAL(stats.tiles, 1ul);
+  BOOST_CHECK_EQUAL(stats.uncompressed_bytes, tensor.size() * sizeof(double));
+  BOOST_CHECK_EQUAL(stats.compressed_bytes, compressed.size());
+  BOOST_CHECK_EQUAL(stats.saved_bytes(),
+      stats.uncompressed_bytes - stats.compressed_bytes);
+  BOOST_CHECK_GE(stats.compress_time, 0.0);
+  BOOST_CHECK_GE(stats.decompress_time, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( lossy )
+{
+  const TensorD tensor = make_tensor();
+  const double tolerance = 1.0e-6;
+  TiledArray::tile_codec(TileCodec::lossy, tolerance);
+
+  const TiledArray::detail::CompressedTile<TensorD> compressed =
+      TiledArray::detail::compress_tile(tensor);
+  const TensorD result = TiledArray::detail::decompress_tile(compressed);
+
+  // Check that the error of each element is bounded by the tolerance
+  for(std::size_t i = 0ul; i < tensor.size(); ++i) {
+    BOOST_CHECK_LT(std::abs(result[i] - tensor[i]), tolerance);
+    if(std::abs(tensor[i]) >= tolerance)
+      BOOST_CHECK_EQUAL(result[i], tensor[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( invalid_data )
+{
+  std::vector<unsigned char> data(64ul, 0);
+  std::vector<double> buffer(64ul);
+  BOOST_CHECK_THROW(TiledArray::detail::decompress_bytes(data, sizeof(double),
+      reinterpret_cast<unsigned char*>(buffer.data()),
+      buffer.size() * sizeof(double)), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  TiledArray::TiledRange trange{ { 0, 10, 20, 30, 40 }, { 0, 10, 20, 30, 40 } };
+  TiledArray::TArrayD a(*GlobalFixture::world, trange);
+  TiledArray::TArrayD b(*GlobalFixture::world, trange);
+  a.init_tiles([] (const TiledArray::Range& range) {
+    TensorD tile(range);
+    for(std::size_t i = 0ul; i < tile.size(); ++i)
+      tile[i] = double((range.ordinal(range.lobound()) + i) % 7);
+    return tile;
+  });
+  b.fill_local(0.5);
+
+  TiledArray::tile_codec(TileCodec::none);
+  TiledArray::TArrayD reference;
+  reference("i,j") = a("i,k") * b("k,j");
+
+  // Check that contractions with compressed broadcasts are exact
+  TiledArray::tile_codec(TileCodec::lossless);
+  TiledArray::tile_compression_threshold(0ul);
+  TiledArray::TArrayD result;
+  result("i,j") = a("i,k") * b("k,j");
+
+  for(std::size_t i = 0ul; i < result.size(); ++i) {
+    if(! result.is_local(i))
+      continue;
+    const TensorD tile = result.find(i).get();
+    const TensorD reference_tile = reference.find(i).get();
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_EQUAL(tile[j], reference_tile[j]);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
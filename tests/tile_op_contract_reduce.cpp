@@ -214,6 +214,69 @@ BOOST_AUTO_TEST_CASE( matrix_multiply )
   BOOST_CHECK_EQUAL(result_map, C);
 }
 
+BOOST_AUTO_TEST_CASE( batch_threshold )
+{
+  ContractReduce<TensorI, TensorI, TensorI, int>
+  op(madness::cblas::NoTrans, madness::cblas::NoTrans, 1, 2u, 2u, 2u);
+
+  TensorI left1 = make_tensor(2, 3, 20, 30), right1 = make_tensor(3, 4, 30, 40);
+  TensorI left2 = make_tensor(2, 30, 20, 42), right2 = make_tensor(30, 4, 42, 40);
+
+  // Check that batching is disabled by a zero threshold
+  op.batch_threshold(0ul);
+  BOOST_CHECK(! op.batch(left1, right1));
+  BOOST_CHECK(! op.batch(left2, right2));
+
+  // Check that only contractions below the threshold are batched
+  op.batch_threshold(18ul * 36ul * 12ul);
+  BOOST_CHECK(! op.batch(left1, right1));
+  BOOST_CHECK(op.batch(left2, right2));
+
+  // Check that empty tensors are not batched
+  BOOST_CHECK(! op.batch(TensorI(), right2));
+}
+
+BOOST_AUTO_TEST_CASE( batch_matrix_multiply )
+{
+  // Construct tensor pairs with different inner dimensions
+  TensorI left1 = make_tensor(2, 3, 20, 30), left2 = make_tensor(2, 30, 20, 42);
+  TensorI leftT1 = make_tensor(3, 2, 30, 20), leftT2 = make_tensor(30, 2, 42, 20);
+  TensorI right1 = make_tensor(3, 4, 30, 40), right2 = make_tensor(30, 4, 42, 40);
+  TensorI rightT1 = make_tensor(4, 3, 40, 30), rightT2 = make_tensor(4, 30, 40, 42);
+
+  const madness::cblas::CBLAS_TRANSPOSE ops[2] =
+      { madness::cblas::NoTrans, madness::cblas::Trans };
+
+  for(const madness::cblas::CBLAS_TRANSPOSE left_op : ops) {
+    for(const madness::cblas::CBLAS_TRANSPOSE right_op : ops) {
+      ContractReduce<TensorI, TensorI, TensorI, int>
+      op(left_op, right_op, 3, 2u, 2u, 2u);
+
+      const TensorI& l1 = (left_op == madness::cblas::NoTrans ? left1 : leftT1);
+      const TensorI& l2 = (left_op == madness::cblas::NoTrans ? left2 : leftT2);
+      const TensorI& r1 = (right_op == madness::cblas::NoTrans ? right1 : rightT1);
+      const TensorI& r2 = (right_op == madness::cblas::NoTrans ? right2 : rightT2);
+      const std::vector<const TensorI*> left = { &l1, &l2 };
+      const std::vector<const TensorI*> right = { &r1, &r2 };
+
+      // Contract the pairs in a batch, into an empty and a non-empty result
+      TensorI result, reference;
+      BOOST_REQUIRE_NO_THROW(op(result, left, right));
+      op(reference, l1, r1);
+      op(reference, l2, r2);
+      BOOST_CHECK_EQUAL(result.range(), reference.range());
+      BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+          reference.begin(), reference.end());
+
+      BOOST_REQUIRE_NO_THROW(op(result, left, right));
+      op(reference, l1, r1);
+      op(reference, l2, r2);
+      BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+          reference.begin(), reference.end());
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE( tensor_contract1 )
 {
   // Set dimension constants
@@ -471,5 +534,91 @@ BOOST_AUTO_TEST_CASE( tensor_contract2 )
   BOOST_CHECK_EQUAL(result_map, C);
 }
 
+BOOST_AUTO_TEST_CASE( permuted_tensor_contract )
+{
+  // Contract C[a,b] = A[i,a,j] * B[j,b,i], where the argument tiles are
+  // permuted to A[a,i,j] and B[i,j,b] while they are contracted. The large
+  // tensors are packed in more than one block.
+  const Permutation left_perm({1,0,2}), right_perm({1,2,0});
+  const std::size_t sizes[2][4] = { { 4, 5, 3, 9 }, { 40, 64, 32, 37 } };
+
+  for(const auto& size : sizes) {
+    TensorI left = make_tensor(3, 2, 4, 3 + size[1], 2 + size[0], 4 + size[2]);
+    TensorI right = make_tensor(4, 1, 3, 4 + size[2], 1 + size[3], 3 + size[1]);
+    const TensorI perm_left = left.permute(left_perm);
+    const TensorI perm_right = right.permute(right_perm);
+
+    ContractReduce<TensorI, TensorI, TensorI, int>
+    ref_op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 3u, 3u);
+    ContractReduce<TensorI, TensorI, TensorI, int>
+    op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 3u, 3u,
+        Permutation(), left_perm, right_perm);
+    ContractReduce<TensorI, TensorI, TensorI, int>
+    left_op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 3u, 3u,
+        Permutation(), left_perm);
+    ContractReduce<TensorI, TensorI, TensorI, int>
+    right_op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 3u, 3u,
+        Permutation(), Permutation(), right_perm);
+
+    // Check that permuted contractions are not batched
+    BOOST_CHECK(! op.batch(left, right));
+
+    // Contract into an empty and a non-empty result
+    TensorI reference, result, left_result, right_result;
+    for(int x = 0; x < 2; ++x) {
+      ref_op(reference, perm_left, perm_right);
+      BOOST_REQUIRE_NO_THROW(op(result, left, right));
+      BOOST_REQUIRE_NO_THROW(left_op(left_result, left, perm_right));
+      BOOST_REQUIRE_NO_THROW(right_op(right_result, perm_left, right));
+
+      BOOST_CHECK_EQUAL(result.range(), reference.range());
+      BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+          reference.begin(), reference.end());
+      BOOST_CHECK_EQUAL_COLLECTIONS(left_result.begin(), left_result.end(),
+          reference.begin(), reference.end());
+      BOOST_CHECK_EQUAL_COLLECTIONS(right_result.begin(), right_result.end(),
+          reference.begin(), reference.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( mixed_precision )
+{
+  ContractReduce<TensorF, TensorF, TensorF, float>
+  op(madness::cblas::NoTrans, madness::cblas::NoTrans, 1.0f, 2u, 2u, 2u);
+  BOOST_CHECK(! op.mixed_precision());
+
+  // The sum of the row of left and the column of right is only exact with
+  // double precision accumulation.
+  TensorF left(Range(1, 3)), right(Range(3, 1), 1.0f);
+  left[0] = 1.0e8f;
+  left[1] = 1.0f;
+  left[2] = -1.0e8f;
+
+  op.mixed_precision(true);
+  BOOST_CHECK(op.mixed_precision());
+  BOOST_CHECK(! op.batch(left, right));
+
+  TensorF result;
+  BOOST_REQUIRE_NO_THROW(op(result, left, right));
+  BOOST_CHECK_EQUAL(result.range(), Range(1, 1));
+  BOOST_CHECK_EQUAL(result[0], 1.0f);
+
+  // Check accumulation into a non-empty result
+  BOOST_REQUIRE_NO_THROW(op(result, left, right));
+  BOOST_CHECK_EQUAL(result[0], 2.0f);
+
+  // Check that mixed precision does not change integer contractions
+  ContractReduce<TensorI, TensorI, TensorI, int>
+  int_op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 2u, 2u);
+  int_op.mixed_precision(true);
+  TensorI l = make_tensor(2, 3, 20, 30), r = make_tensor(3, 4, 30, 40);
+  TensorI int_result, int_reference;
+  int_op(int_result, l, r);
+  int_op.mixed_precision(false);
+  int_op(int_reference, l, r);
+  BOOST_CHECK_EQUAL_COLLECTIONS(int_result.begin(), int_result.end(),
+      int_reference.begin(), int_reference.end());
+}
 
 BOOST_AUTO_TEST_SUITE_END()
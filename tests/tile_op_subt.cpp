@@ -418,4 +418,84 @@ BOOST_AUTO_TEST_CASE( binary_subt_right_zero_perm_consume_right )
   }
 }
 
+BOOST_AUTO_TEST_CASE( binary_subt_permute_left )
+{
+  Subt<TensorI, TensorI, TensorI, false, false> subt_op;
+
+  // Store the difference of the permuted a and b in c
+  BOOST_CHECK_NO_THROW(c = subt_op.permute_left(a, perm, b, false));
+
+  // Check that the result range is correct
+  BOOST_CHECK_EQUAL(c.range(), b.range());
+
+  // Check that a nor b were consumed
+  BOOST_CHECK_NE(c.data(), a.data());
+  BOOST_CHECK_NE(c.data(), b.data());
+
+  // Check that the data in the new tile is correct
+  for(std::size_t i = 0ul; i < r.volume(); ++i) {
+    const std::size_t pi = b.range().ordinal(perm * a.range().idx(i));
+    BOOST_CHECK_EQUAL(c[pi], a[i] - b[pi]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_subt_permute_left_consume )
+{
+  Subt<TensorI, TensorI, TensorI, false, true> subt_op;
+  const TensorI ax(a.range(), a.begin());
+  const TensorI bx(b.range(), b.begin());
+
+  // Store the difference of the permuted a and b in c
+  BOOST_CHECK_NO_THROW(c = subt_op.permute_left(a, perm, b, true));
+
+  // Check that b was consumed
+  BOOST_CHECK_EQUAL(c.data(), b.data());
+
+  // Check that the data in the new tile is correct
+  for(std::size_t i = 0ul; i < r.volume(); ++i) {
+    const std::size_t pi = bx.range().ordinal(perm * ax.range().idx(i));
+    BOOST_CHECK_EQUAL(c[pi], ax[i] - bx[pi]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_subt_permute_right )
+{
+  Subt<TensorI, TensorI, TensorI, false, false> subt_op;
+
+  // Store the difference of a and the permuted b in c
+  BOOST_CHECK_NO_THROW(c = subt_op.permute_right(a, b, perm, false));
+
+  // Check that the result range is correct
+  BOOST_CHECK_EQUAL(c.range(), a.range());
+
+  // Check that a nor b were consumed
+  BOOST_CHECK_NE(c.data(), a.data());
+  BOOST_CHECK_NE(c.data(), b.data());
+
+  // Check that the data in the new tile is correct
+  for(std::size_t i = 0ul; i < r.volume(); ++i) {
+    const std::size_t pi = a.range().ordinal(perm * b.range().idx(i));
+    BOOST_CHECK_EQUAL(c[pi], a[pi] - b[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( binary_subt_permute_right_consume )
+{
+  Subt<TensorI, TensorI, TensorI, true, false> subt_op;
+  const TensorI ax(a.range(), a.begin());
+  const TensorI bx(b.range(), b.begin());
+
+  // Store the difference of a and the permuted b in c
+  BOOST_CHECK_NO_THROW(c = subt_op.permute_right(a, b, perm, true));
+
+  // Check that a was consumed
+  BOOST_CHECK_EQUAL(c.data(), a.data());
+
+  // Check that the data in the new tile is correct
+  for(std::size_t i = 0ul; i < r.volume(); ++i) {
+    const std::size_t pi = ax.range().ordinal(perm * bx.range().idx(i));
+    BOOST_CHECK_EQUAL(c[pi], ax[pi] - bx[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
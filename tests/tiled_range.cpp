@@ -149,5 +149,35 @@ BOOST_AUTO_TEST_CASE( make_tiles_range )
   }
 }
 
+BOOST_AUTO_TEST_CASE( interned )
+{
+  // Tiled ranges with the same boundaries share their data
+  TiledRange r1(dims.begin(), dims.end());
+  BOOST_CHECK_EQUAL(& r1.data(), & tr.data());
+  BOOST_CHECK_EQUAL(r1, tr);
+
+  // Tiled ranges with other boundaries do not
+  std::vector<TiledRange1> other_dims(GlobalFixture::dim, TiledRange1{0, 2, 5});
+  TiledRange r2(other_dims.begin(), other_dims.end());
+  BOOST_CHECK_NE(& r2.data(), & tr.data());
+  BOOST_CHECK_NE(r2, tr);
+}
+
+BOOST_AUTO_TEST_CASE( make_tiles_range_cached )
+{
+  // Copies of a tiled range share the cached tile ranges
+  TiledRange r1(tr);
+  for(TiledRange::size_type i = 0ul; i < tr.tiles_range().volume(); ++i) {
+    BOOST_CHECK_EQUAL(r1.make_tile_range(i), tr.make_tile_range(tr.tiles_range().idx(i)));
+    BOOST_CHECK_EQUAL(tr.make_tile_range(i), r1.make_tile_range(i));
+  }
+
+  // The cache of a permuted range is not shared
+  Permutation p({2,0,1});
+  TiledRange r2 = p * tr;
+  for(TiledRange::size_type i = 0ul; i < r2.tiles_range().volume(); ++i)
+    BOOST_CHECK_EQUAL(r2.make_tile_range(i), r2.make_tile_range(r2.tiles_range().idx(i)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -184,6 +184,19 @@ BOOST_AUTO_TEST_CASE( element_to_tile )
   BOOST_CHECK_EQUAL_COLLECTIONS(c.begin(), c.end(), e.begin(), e.end());
 }
 
+BOOST_AUTO_TEST_CASE( element_to_tile_uniform )
+{
+  // Uniform tiles with a smaller last tile
+  TiledRange1 r1{ 2, 5, 8, 11, 13 };
+  // Non-uniform tiles
+  TiledRange1 r2{ 2, 5, 6, 11, 13 };
+
+  for(const TiledRange1& r : { r1, r2 })
+    for(std::size_t t = r.tiles_range().first; t < r.tiles_range().second; ++t)
+      for(std::size_t i = r.tile(t).first; i < r.tile(t).second; ++i)
+        BOOST_CHECK_EQUAL(r.element_to_tile(i), t);
+}
+
 BOOST_AUTO_TEST_CASE( comparison )
 {
   TiledRange1 r1{ 1, 2, 4, 6, 8, 10 };
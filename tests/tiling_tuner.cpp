@@ -0,0 +1,90 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledArray/tiling_tuner.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct TilingTunerFixture {
+  TilingTunerFixture() {
+    rates.gemm_sizes = { 32ul, 64ul, 128ul, 256ul, 512ul };
+    rates.gemm_rates = { 2.0e9, 5.0e9, 8.0e9, 9.0e9, 9.5e9 };
+    rates.bandwidth = 5.0e9;
+    rates.latency = 2.0e-6;
+    rates.task_overhead = 1.0e-6;
+    rates.threads = 8ul;
+  }
+
+  MachineRates rates;
+};
+
+BOOST_FIXTURE_TEST_SUITE( tiling_tuner_suite , TilingTunerFixture )
+
+BOOST_AUTO_TEST_CASE( gemm_rate )
+{
+  BOOST_CHECK_EQUAL(rates.gemm_rate(16ul), 2.0e9);
+  BOOST_CHECK_EQUAL(rates.gemm_rate(1024ul), 9.5e9);
+  BOOST_CHECK_CLOSE(rates.gemm_rate(96ul), 6.5e9, 1.0e-6);
+}
+
+BOOST_AUTO_TEST_CASE( recommendation )
+{
+  const std::size_t extent = 4399ul;
+  TilingRecommendation r = recommend_tiling(extent, 16ul, rates);
+
+  // The tiling covers the extent with tiles that differ by at most one
+  BOOST_CHECK_EQUAL(r.trange1.elements_range().first, 0ul);
+  BOOST_CHECK_EQUAL(r.trange1.elements_range().second, extent);
+  std::size_t min_extent = extent, max_extent = 0ul;
+  for(const auto& tile : r.trange1) {
+    min_extent = std::min(min_extent, tile.second - tile.first);
+    max_extent = std::max(max_extent, tile.second - tile.first);
+  }
+  BOOST_CHECK_LE(max_extent - min_extent, 1ul);
+  BOOST_CHECK_EQUAL(r.block_size, max_extent);
+  BOOST_CHECK_GE(r.block_size, 16ul);
+  BOOST_CHECK_LE(r.block_size, 2048ul);
+  BOOST_CHECK_GE(r.summa_depth, 2ul);
+  BOOST_CHECK_GT(r.time, 0.0);
+
+  // Slower communication makes every tiling slower
+  MachineRates slow = rates;
+  slow.bandwidth = 1.0e7;
+  TilingRecommendation s = recommend_tiling(extent, 16ul, slow);
+  BOOST_CHECK_GT(s.time, r.time);
+}
+
+BOOST_AUTO_TEST_CASE( probe )
+{
+  MachineRates probed;
+  BOOST_REQUIRE_NO_THROW(probed = probe_machine_rates(*GlobalFixture::world));
+  BOOST_CHECK_EQUAL(probed.gemm_sizes.size(), probed.gemm_rates.size());
+  for(const double rate : probed.gemm_rates)
+    BOOST_CHECK_GT(rate, 0.0);
+  BOOST_CHECK_GT(probed.bandwidth, 0.0);
+  BOOST_CHECK_GT(probed.threads, 0ul);
+
+  TilingRecommendation r = recommend_tiling(1000ul,
+      GlobalFixture::world->size(), probed);
+  BOOST_CHECK_EQUAL(r.trange1.elements_range().second, 1000ul);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2017  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  variant_tile.cpp
+ *  May 23, 2017
+ *
+ */
+
+#include "TiledArray/variant_tile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct VariantTileFixture {
+  typedef VariantTile<double> tile_type;
+  typedef tile_type::Kind Kind;
+
+  VariantTileFixture() : range({ 0, 0 }, { 12, 12 }) { }
+
+  /// Construct a dense tensor with random elements
+  static TensorD make_dense(const Range& range) {
+    TensorD result(range);
+    for(std::size_t i = 0ul; i < result.size(); ++i)
+      result[i] = double(GlobalFixture::world->rand() % 101) + 1.0;
+    return result;
+  }
+
+  /// Construct a tensor in which every seventh element is non-zero
+  static TensorD make_sparse(const Range& range) {
+    TensorD result(range, 0.0);
+    for(std::size_t i = 0ul; i < result.size(); i += 7ul)
+      result[i] = double(GlobalFixture::world->rand() % 101) + 1.0;
+    return result;
+  }
+
+  /// Construct a diagonal matrix
+  static TensorD make_diagonal(const Range& range) {
+    TensorD result(range, 0.0);
+    const std::size_t stride = detail::diagonal_stride(range);
+    for(std::size_t d = 0ul; d < detail::diagonal_size(range); ++d)
+      result[d * stride] = double(d) + 1.0;
+    return result;
+  }
+
+  /// Construct a rank-one matrix
+  static TensorD make_rank_one(const Range& range) {
+    TensorD result(range);
+    const std::size_t n = range.extent_data()[1];
+    for(std::size_t i = 0ul; i < result.size(); ++i)
+      result[i] = double(i / n + 1ul) * double(i % n + 2ul);
+    return result;
+  }
+
+  /// The largest absolute difference of the elements of \c tile and \c tensor
+  static double max_error(const tile_type& tile, const TensorD& tensor) {
+    const TensorD dense = static_cast<TensorD>(tile);
+    BOOST_REQUIRE_EQUAL(dense.range(), tensor.range());
+    return dense.subt(tensor).abs_max();
+  }
+
+  Range range;
+}; // struct VariantTileFixture
+
+BOOST_FIXTURE_TEST_SUITE( variant_tile_suite, VariantTileFixture )
+
+BOOST_AUTO_TEST_CASE( kinds )
+{
+  BOOST_CHECK(tile_type(range).kind() == Kind::zero);
+  BOOST_CHECK(tile_type(TensorD(range, 0.0)).kind() == Kind::zero);
+  BOOST_CHECK(tile_type(make_dense(range)).kind() == Kind::dense);
+  BOOST_CHECK(tile_type(make_sparse(range)).kind() == Kind::sparse);
+  BOOST_CHECK(tile_type(make_diagonal(range)).kind() == Kind::diagonal);
+  BOOST_CHECK_EQUAL(tile_bytes(tile_type(make_diagonal(range))),
+      12ul * sizeof(double));
+
+  // Rank-one matrices are factored by compress()
+  const TensorD rank_one = make_rank_one(range);
+  BOOST_CHECK(tile_type(rank_one).kind() == Kind::dense);
+  const tile_type low_rank = tile_type::compress(rank_one, 1.0e-10);
+  BOOST_CHECK(low_rank.kind() == Kind::low_rank);
+  BOOST_CHECK_SMALL(max_error(low_rank, rank_one), 1.0e-9);
+  BOOST_CHECK_CLOSE(low_rank.norm(), rank_one.norm(), 1.0e-8);
+}
+
+BOOST_AUTO_TEST_CASE( elementwise )
+{
+  const std::vector<TensorD> tensors = { TensorD(range, 0.0),
+      make_dense(range), make_sparse(range), make_diagonal(range),
+      make_rank_one(range) };
+  std::vector<tile_type> tiles;
+  for(std::size_t i = 0ul; i < tensors.size(); ++i)
+    tiles.push_back(i == 4ul ? tile_type::compress(tensors[i], 1.0e-10) :
+        tile_type(tensors[i]));
+  const Permutation perm({ 1, 0 });
+
+  // Every pair of representations
+  for(std::size_t l = 0ul; l < tiles.size(); ++l) {
+    for(std::size_t r = 0ul; r < tiles.size(); ++r) {
+      BOOST_CHECK_SMALL(max_error(add(tiles[l], tiles[r]),
+          tensors[l].add(tensors[r])), 1.0e-9);
+      BOOST_CHECK_SMALL(max_error(subt(tiles[l], tiles[r], 2.0),
+          tensors[l].subt(tensors[r], 2.0)), 1.0e-9);
+      BOOST_CHECK_SMALL(max_error(mult(tiles[l], tiles[r]),
+          tensors[l].mult(tensors[r])), 1.0e-8);
+    }
+    BOOST_CHECK_SMALL(max_error(permute(tiles[l], perm),
+        tensors[l].permute(perm)), 1.0e-9);
+    BOOST_CHECK_SMALL(max_error(scale(tiles[l], 3.0), tensors[l].scale(3.0)),
+        1.0e-9);
+  }
+
+  // Products with diagonal tiles are diagonal
+  BOOST_CHECK(mult(tiles[3], tiles[1]).kind() == Kind::diagonal);
+  BOOST_CHECK(mult(tiles[0], tiles[1]).kind() == Kind::zero);
+}
+
+BOOST_AUTO_TEST_CASE( contract )
+{
+  const std::vector<TensorD> tensors = { TensorD(range, 0.0),
+      make_dense(range), make_sparse(range), make_diagonal(range),
+      make_rank_one(range) };
+  std::vector<tile_type> tiles;
+  for(std::size_t i = 0ul; i < tensors.size(); ++i)
+    tiles.push_back(i == 4ul ? tile_type::compress(tensors[i], 1.0e-10) :
+        tile_type(tensors[i]));
+  const math::GemmHelper gemm_helper(madness::cblas::NoTrans,
+      madness::cblas::NoTrans, 2u, 2u, 2u);
+
+  // Every pair of representations
+  for(std::size_t l = 0ul; l < tiles.size(); ++l) {
+    for(std::size_t r = 0ul; r < tiles.size(); ++r) {
+      const TensorD reference = tensors[l].gemm(tensors[r], 2.0, gemm_helper);
+      tile_type result = gemm(tiles[l], tiles[r], 2.0, gemm_helper);
+      BOOST_CHECK_SMALL(max_error(result, reference), 1.0e-6);
+
+      // Accumulate
+      gemm(result, tiles[l], tiles[r], 2.0, gemm_helper);
+      BOOST_CHECK_SMALL(max_error(result, reference.scale(2.0)), 1.0e-6);
+    }
+  }
+
+  // Products with zero tiles are zero, and products of low-rank tiles are
+  // low-rank
+  BOOST_CHECK(gemm(tiles[0], tiles[1], 1.0, gemm_helper).kind() == Kind::zero);
+  BOOST_CHECK(gemm(tiles[4], tiles[4], 1.0, gemm_helper).kind() == Kind::low_rank);
+}
+
+BOOST_AUTO_TEST_CASE( array )
+{
+  // Mix representations in one array
+  TiledRange trange{ { 0, 12, 24 }, { 0, 12, 24 } };
+  DistArray<tile_type, DensePolicy> a(*GlobalFixture::world, trange);
+  for(auto it = a.begin(); it != a.end(); ++it) {
+    const Range r = it.make_range();
+    switch(it.ordinal()) {
+      case 0ul: *it = tile_type(make_dense(r)); break;
+      case 1ul: *it = tile_type(make_sparse(r)); break;
+      case 2ul: *it = tile_type(r); break;
+      default: *it = tile_type(make_diagonal(r)); break;
+    }
+  }
+
+  DistArray<tile_type, DensePolicy> b;
+  b("i,j") = a("i,k") * a("k,j") + a("j,i");
+
+  // Compare with the same expression of dense tiles
+  auto expand = [] (const tile_type& tile) { return static_cast<TensorD>(tile); };
+  TArrayD a_dense = to_new_tile_type(a, expand);
+  TArrayD b_dense;
+  b_dense("i,j") = a_dense("i,k") * a_dense("k,j") + a_dense("j,i");
+  for(auto it = b.begin(); it != b.end(); ++it)
+    BOOST_CHECK_SMALL(max_error(it->get(), b_dense.find(it.ordinal()).get()),
+        1.0e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()